@@ -16,6 +16,7 @@
 
 #include "ClangTidy.h"
 #include "ClangTidyDiagnosticConsumer.h"
+#include "ClangTidyHeaderCache.h"
 #include "ClangTidyModuleRegistry.h"
 #include "ClangTidyProfiling.h"
 #include "ExpandModularHeadersPPCallbacks.h"
@@ -42,7 +43,11 @@
 #include "clang/Tooling/Tooling.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/ThreadPool.h"
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <utility>
 
 #if CLANG_ENABLE_STATIC_ANALYZER
@@ -293,12 +298,30 @@ public:
   ClangTidyASTConsumer(std::vector<std::unique_ptr<ASTConsumer>> Consumers,
                        std::unique_ptr<ClangTidyProfiling> Profiling,
                        std::unique_ptr<ast_matchers::MatchFinder> Finder,
-                       std::vector<std::unique_ptr<ClangTidyCheck>> Checks)
+                       std::vector<std::unique_ptr<ClangTidyCheck>> Checks,
+                       std::unique_ptr<ClangTidyHeaderCache> HeaderCache,
+                       ClangTidyContext &Context)
       : MultiplexConsumer(std::move(Consumers)),
+        HeaderCache(std::move(HeaderCache)), Context(Context),
         Profiling(std::move(Profiling)), Finder(std::move(Finder)),
-        Checks(std::move(Checks)) {}
+        Checks(std::move(Checks)) {
+    Context.setHeaderCache(this->HeaderCache.get());
+  }
+
+  ~ClangTidyASTConsumer() override {
+    if (HeaderCache && Context.getHeaderCache() == HeaderCache.get())
+      Context.setHeaderCache(nullptr);
+  }
+
+  void HandleTranslationUnit(ASTContext &Ctx) override {
+    if (HeaderCache)
+      HeaderCache->beginMatching(Ctx);
+    MultiplexConsumer::HandleTranslationUnit(Ctx);
+  }
 
 private:
+  std::unique_ptr<ClangTidyHeaderCache> HeaderCache;
+  ClangTidyContext &Context;
   // Destructor order matters! Profiling must be destructed last.
   // Or at least after Finder.
   std::unique_ptr<ClangTidyProfiling> Profiling;
@@ -391,8 +414,11 @@ ClangTidyASTConsumerFactory::CreateASTConsumer(
 
   std::unique_ptr<ClangTidyProfiling> Profiling;
   if (Context.getEnableProfiling()) {
-    Profiling = std::make_unique<ClangTidyProfiling>(
-        Context.getProfileStorageParams());
+    if (ClangTidyProfiling *Total = Context.getTotalProfile())
+      Profiling = std::make_unique<ClangTidyProfiling>(Total);
+    else
+      Profiling = std::make_unique<ClangTidyProfiling>(
+          Context.getProfileStorageParams());
     FinderOptions.CheckProfiling.emplace(Profiling->Records);
   }
 
@@ -402,6 +428,16 @@ ClangTidyASTConsumerFactory::CreateASTConsumer(
   Preprocessor *PP = &Compiler.getPreprocessor();
   Preprocessor *ModuleExpanderPP = PP;
 
+  // The line filter selects diagnostics by translation unit.
+  std::unique_ptr<ClangTidyHeaderCache> HeaderCache;
+  if (!Context.getHeaderCacheDirectory().empty() &&
+      Context.getGlobalOptions().LineFilter.empty())
+    HeaderCache = std::make_unique<ClangTidyHeaderCache>(
+        Context.getHeaderCacheDirectory(),
+        configurationAsText(Context.getOptions()) +
+            (Context.canEnableAnalyzerAlphaCheckers() ? "alpha" : ""),
+        *PP);
+
   if (Context.getLangOpts().Modules && OverlayFS != nullptr) {
     auto ModuleExpander = std::make_unique<ExpandModularHeadersPPCallbacks>(
         &Compiler, OverlayFS);
@@ -437,7 +473,7 @@ ClangTidyASTConsumerFactory::CreateASTConsumer(
 #endif // CLANG_ENABLE_STATIC_ANALYZER
   return std::make_unique<ClangTidyASTConsumer>(
       std::move(Consumers), std::move(Profiling), std::move(Finder),
-      std::move(Checks));
+      std::move(Checks), std::move(HeaderCache), Context);
 }
 
 std::vector<std::string> ClangTidyASTConsumerFactory::getCheckNames() {
@@ -488,14 +524,38 @@ getCheckOptions(const ClangTidyOptions &Options,
   return Factory.getCheckOptions();
 }
 
-std::vector<ClangTidyError>
-runClangTidy(clang::tidy::ClangTidyContext &Context,
-             const CompilationDatabase &Compilations,
-             ArrayRef<std::string> InputFiles,
-             llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> BaseFS,
-             bool EnableCheckProfile, llvm::StringRef StoreCheckProfile) {
+namespace {
+// Provides the options of a context to the contexts of the threads that run
+// clang-tidy in parallel. The options providers cache the configuration files
+// they read, so they are queried under a lock.
+class SharedOptionsProvider : public ClangTidyOptionsProvider {
+public:
+  SharedOptionsProvider(ClangTidyContext &Context, std::mutex &Mutex)
+      : Context(Context), Mutex(Mutex) {}
+
+  const ClangTidyGlobalOptions &getGlobalOptions() override {
+    return Context.getGlobalOptions();
+  }
+
+  std::vector<OptionsSource> getRawOptions(llvm::StringRef FileName) override {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return {OptionsSource(Context.getOptionsForFile(FileName),
+                          "shared clang-tidy context")};
+  }
+
+private:
+  ClangTidyContext &Context;
+  std::mutex &Mutex;
+};
+} // namespace
+
+static std::vector<ClangTidyError> runClangTidyOnFiles(
+    ClangTidyContext &Context, const CompilationDatabase &Compilations,
+    ArrayRef<std::string> InputFiles,
+    llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> BaseFS,
+    llvm::IntrusiveRefCntPtr<FileManager> Files = nullptr) {
   ClangTool Tool(Compilations, InputFiles,
-                 std::make_shared<PCHContainerOperations>(), BaseFS);
+                 std::make_shared<PCHContainerOperations>(), BaseFS, Files);
 
   // Add extra arguments passed by the clang-tidy command-line.
   ArgumentsAdjuster PerFileExtraArgumentsInserter =
@@ -517,8 +577,6 @@ runClangTidy(clang::tidy::ClangTidyContext &Context,
 
   Tool.appendArgumentsAdjuster(PerFileExtraArgumentsInserter);
   Tool.appendArgumentsAdjuster(getStripPluginsAdjuster());
-  Context.setEnableProfiling(EnableCheckProfile);
-  Context.setProfileStoragePrefix(StoreCheckProfile);
 
   ClangTidyDiagnosticConsumer DiagConsumer(Context);
   DiagnosticsEngine DE(new DiagnosticIDs(), new DiagnosticOptions(),
@@ -568,6 +626,60 @@ runClangTidy(clang::tidy::ClangTidyContext &Context,
   return DiagConsumer.take();
 }
 
+std::vector<ClangTidyError>
+runClangTidy(clang::tidy::ClangTidyContext &Context,
+             const CompilationDatabase &Compilations,
+             ArrayRef<std::string> InputFiles,
+             llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> BaseFS,
+             bool EnableCheckProfile, llvm::StringRef StoreCheckProfile,
+             unsigned NumThreads) {
+  Context.setEnableProfiling(EnableCheckProfile);
+  Context.setProfileStoragePrefix(StoreCheckProfile);
+  if (NumThreads == 0)
+    NumThreads = llvm::heavyweight_hardware_concurrency();
+  NumThreads = std::min<size_t>(NumThreads, InputFiles.size());
+  if (NumThreads <= 1)
+    return runClangTidyOnFiles(Context, Compilations, InputFiles, BaseFS);
+
+  // Each thread processes one file at a time with its own context, and keeps
+  // its file manager so that the headers it already found are not looked up
+  // again. The profiles of all the files are printed together.
+  llvm::Optional<ClangTidyProfiling> TotalProfile;
+  if (EnableCheckProfile && StoreCheckProfile.empty())
+    TotalProfile.emplace();
+  std::mutex OptionsMutex, StatsMutex;
+  std::atomic<size_t> NextFile(0);
+  std::vector<std::vector<ClangTidyError>> ErrorsByFile(InputFiles.size());
+  {
+    llvm::ThreadPool Pool(NumThreads);
+    for (unsigned I = 0; I < NumThreads; ++I)
+      Pool.async([&] {
+        ClangTidyContext ThreadContext(
+            std::make_unique<SharedOptionsProvider>(Context, OptionsMutex),
+            Context.canEnableAnalyzerAlphaCheckers());
+        ThreadContext.setEnableProfiling(EnableCheckProfile);
+        ThreadContext.setProfileStoragePrefix(StoreCheckProfile);
+        ThreadContext.setHeaderCacheDirectory(
+            Context.getHeaderCacheDirectory());
+        if (TotalProfile)
+          ThreadContext.setTotalProfile(TotalProfile.getPointer());
+        llvm::IntrusiveRefCntPtr<FileManager> Files(
+            new FileManager(FileSystemOptions(), BaseFS));
+        for (size_t File = NextFile++; File < InputFiles.size();
+             File = NextFile++)
+          ErrorsByFile[File] = runClangTidyOnFiles(
+              ThreadContext, Compilations, InputFiles[File], BaseFS, Files);
+        std::lock_guard<std::mutex> Lock(StatsMutex);
+        Context.addStats(ThreadContext.getStats());
+      });
+  }
+
+  std::vector<ClangTidyError> Errors;
+  for (std::vector<ClangTidyError> &FileErrors : ErrorsByFile)
+    std::move(FileErrors.begin(), FileErrors.end(), std::back_inserter(Errors));
+  return Errors;
+}
+
 void handleErrors(llvm::ArrayRef<ClangTidyError> Errors,
                   ClangTidyContext &Context, bool Fix,
                   unsigned &WarningsAsErrorsCount,
@@ -16,6 +16,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "ClangTidyDiagnosticConsumer.h"
+#include "ClangTidyHeaderCache.h"
 #include "ClangTidyOptions.h"
 #include "GlobList.h"
 #include "clang/AST/ASTDiagnostic.h"
@@ -147,7 +148,7 @@ ClangTidyContext::ClangTidyContext(
     std::unique_ptr<ClangTidyOptionsProvider> OptionsProvider,
     bool AllowEnablingAnalyzerAlphaCheckers)
     : DiagEngine(nullptr), OptionsProvider(std::move(OptionsProvider)),
-      Profile(false),
+      Profile(false), TotalProfile(nullptr), HeaderCache(nullptr),
       AllowEnablingAnalyzerAlphaCheckers(AllowEnablingAnalyzerAlphaCheckers) {
   // Before the first translation unit we can get errors related to command-line
   // parsing, use empty string for the file name in this case.
@@ -198,6 +199,14 @@ ClangTidyOptions ClangTidyContext::getOptionsForFile(StringRef File) const {
       OptionsProvider->getOptions(File));
 }
 
+void ClangTidyContext::addStats(const ClangTidyStats &Other) {
+  Stats.ErrorsDisplayed += Other.ErrorsDisplayed;
+  Stats.ErrorsIgnoredCheckFilter += Other.ErrorsIgnoredCheckFilter;
+  Stats.ErrorsIgnoredNOLINT += Other.ErrorsIgnoredNOLINT;
+  Stats.ErrorsIgnoredNonUserCode += Other.ErrorsIgnoredNonUserCode;
+  Stats.ErrorsIgnoredLineFilter += Other.ErrorsIgnoredLineFilter;
+}
+
 void ClangTidyContext::setEnableProfiling(bool P) { Profile = P; }
 
 void ClangTidyContext::setProfileStoragePrefix(StringRef Prefix) {
@@ -238,12 +247,12 @@ ClangTidyDiagnosticConsumer::ClangTidyDiagnosticConsumer(
     ClangTidyContext &Ctx, DiagnosticsEngine *ExternalDiagEngine,
     bool RemoveIncompatibleErrors)
     : Context(Ctx), ExternalDiagEngine(ExternalDiagEngine),
-      RemoveIncompatibleErrors(RemoveIncompatibleErrors),
+      RemoveIncompatibleErrors(RemoveIncompatibleErrors), FirstErrorOfFile(0),
       LastErrorRelatesToUserCode(false), LastErrorPassesLineFilter(false),
       LastErrorWasIgnored(false) {}
 
 void ClangTidyDiagnosticConsumer::finalizeLastError() {
-  if (!Errors.empty()) {
+  if (Errors.size() > FirstErrorOfFile) {
     ClangTidyError &Error = Errors.back();
     if (!Context.isCheckEnabled(Error.DiagnosticName) &&
         Error.DiagLevel != ClangTidyError::Error) {
@@ -715,8 +724,29 @@ struct EqualClangTidyError {
 };
 } // end anonymous namespace
 
+void ClangTidyDiagnosticConsumer::EndSourceFile() {
+  finalizeLastError();
+  if (ClangTidyHeaderCache *Cache = Context.getHeaderCache()) {
+    std::vector<ClangTidyError> FileErrors(
+        std::make_move_iterator(Errors.begin() + FirstErrorOfFile),
+        std::make_move_iterator(Errors.end()));
+    Errors.erase(Errors.begin() + FirstErrorOfFile, Errors.end());
+    Context.Stats.ErrorsDisplayed -= FileErrors.size();
+    Cache->endTranslationUnit(FileErrors, Context.getCurrentBuildDirectory(),
+                              [this](StringRef CheckName) {
+                                return Context.treatAsError(CheckName);
+                              });
+    Context.Stats.ErrorsDisplayed += FileErrors.size();
+    Errors.insert(Errors.end(), std::make_move_iterator(FileErrors.begin()),
+                  std::make_move_iterator(FileErrors.end()));
+    Context.setHeaderCache(nullptr);
+  }
+  FirstErrorOfFile = Errors.size();
+}
+
 std::vector<ClangTidyError> ClangTidyDiagnosticConsumer::take() {
   finalizeLastError();
+  FirstErrorOfFile = 0;
 
   std::sort(Errors.begin(), Errors.end(), LessClangTidyError());
   Errors.erase(std::unique(Errors.begin(), Errors.end(), EqualClangTidyError()),
@@ -31,6 +31,7 @@ class CompilationDatabase;
 }
 
 namespace tidy {
+class ClangTidyHeaderCache;
 
 /// A detected error complete with information to display diagnostic and
 /// automatic fix.
@@ -143,6 +144,10 @@ public:
   /// counters.
   const ClangTidyStats &getStats() const { return Stats; }
 
+  /// Adds the counters of another context, e.g. of one that processed some
+  /// of the translation units in parallel.
+  void addStats(const ClangTidyStats &Other);
+
   /// Control profile collection in clang-tidy.
   void setEnableProfiling(bool Profile);
   bool getEnableProfiling() const { return Profile; }
@@ -152,6 +157,23 @@ public:
   llvm::Optional<ClangTidyProfiling::StorageParams>
   getProfileStorageParams() const;
 
+  /// If set, the profiles of the translation units are added to \p Total
+  /// rather than reported one by one.
+  void setTotalProfile(ClangTidyProfiling *Total) { TotalProfile = Total; }
+  ClangTidyProfiling *getTotalProfile() const { return TotalProfile; }
+
+  /// If set, the diagnostics of the headers are cached in \p Directory.
+  void setHeaderCacheDirectory(StringRef Directory) {
+    HeaderCacheDirectory = Directory;
+  }
+  const std::string &getHeaderCacheDirectory() const {
+    return HeaderCacheDirectory;
+  }
+
+  /// Sets the header cache of the current translation unit, if any.
+  void setHeaderCache(ClangTidyHeaderCache *Cache) { HeaderCache = Cache; }
+  ClangTidyHeaderCache *getHeaderCache() const { return HeaderCache; }
+
   /// Should be called when starting to process new translation unit.
   void setCurrentBuildDirectory(StringRef BuildDirectory) {
     CurrentBuildDirectory = BuildDirectory;
@@ -200,6 +222,10 @@ private:
 
   bool Profile;
   std::string ProfilePrefix;
+  ClangTidyProfiling *TotalProfile;
+
+  std::string HeaderCacheDirectory;
+  ClangTidyHeaderCache *HeaderCache;
 
   bool AllowEnablingAnalyzerAlphaCheckers;
 };
@@ -238,6 +264,9 @@ public:
   void HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
                         const Diagnostic &Info) override;
 
+  /// Replays the diagnostics of the cached headers of the translation unit.
+  void EndSourceFile() override;
+
   // Retrieve the diagnostics that were captured.
   std::vector<ClangTidyError> take();
 
@@ -260,6 +289,9 @@ private:
   DiagnosticsEngine *ExternalDiagEngine;
   bool RemoveIncompatibleErrors;
   std::vector<ClangTidyError> Errors;
+  /// The errors before this index are from the previous translation units,
+  /// and are final.
+  size_t FirstErrorOfFile;
   std::unique_ptr<llvm::Regex> HeaderFilter;
   bool LastErrorRelatesToUserCode;
   bool LastErrorPassesLineFilter;
@@ -0,0 +1,306 @@
+//===--- ClangTidyHeaderCache.cpp - clang-tidy ------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "ClangTidyHeaderCache.h"
+#include "ClangTidyDiagnosticConsumer.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/Basic/Version.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Tooling/DiagnosticsYaml.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/YAMLTraits.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace clang {
+namespace tidy {
+
+namespace {
+// Separates the strings added to a digest.
+void addString(llvm::SHA1 &Digest, llvm::StringRef S) {
+  Digest.update(S);
+  Digest.update(llvm::StringRef("\0", 1));
+}
+
+// Returns whether the messages and the fixes of \p Diag are all in \p Path, so
+// that it can be replayed for another translation unit.
+bool isLocalTo(const tooling::Diagnostic &Diag, llvm::StringRef Path) {
+  auto IsLocal = [&](const tooling::DiagnosticMessage &Message) {
+    if (Message.FilePath != Path)
+      return false;
+    for (const auto &FileAndReplacements : Message.Fix)
+      if (FileAndReplacements.first() != Path)
+        return false;
+    return true;
+  };
+  return Diag.DiagLevel == tooling::Diagnostic::Warning &&
+         IsLocal(Diag.Message) && llvm::all_of(Diag.Notes, IsLocal);
+}
+} // namespace
+
+class ClangTidyHeaderCache::Recorder : public PPCallbacks {
+public:
+  Recorder(ClangTidyHeaderCache &Cache, const SourceManager &SM)
+      : Cache(Cache), SM(SM) {}
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override {
+    if (Reason == EnterFile)
+      Cache.enterFile(SM.getFileID(Loc));
+    else if (Reason == ExitFile)
+      Cache.exitFile(PrevFID);
+  }
+
+  void FileSkipped(const FileEntryRef &SkippedFile, const Token &FilenameTok,
+                   SrcMgr::CharacteristicKind FileType) override {
+    Cache.skipFile(SkippedFile.getFileEntry());
+  }
+
+  void MacroExpands(const Token &MacroNameTok, const MacroDefinition &MD,
+                    SourceRange Range, const MacroArgs *Args) override {
+    Cache.useMacro(MacroNameTok, MD);
+  }
+
+  void Defined(const Token &MacroNameTok, const MacroDefinition &MD,
+               SourceRange Range) override {
+    Cache.useMacro(MacroNameTok, MD);
+  }
+
+  void Ifdef(SourceLocation Loc, const Token &MacroNameTok,
+             const MacroDefinition &MD) override {
+    Cache.useMacro(MacroNameTok, MD);
+  }
+
+  void Ifndef(SourceLocation Loc, const Token &MacroNameTok,
+              const MacroDefinition &MD) override {
+    Cache.useMacro(MacroNameTok, MD);
+  }
+
+private:
+  ClangTidyHeaderCache &Cache;
+  const SourceManager &SM;
+};
+
+ClangTidyHeaderCache::ClangTidyHeaderCache(llvm::StringRef Directory,
+                                           std::string Configuration,
+                                           Preprocessor &PP)
+    : Directory(Directory), Configuration(std::move(Configuration)), PP(PP) {
+  PP.addPPCallbacks(std::make_unique<Recorder>(*this, PP.getSourceManager()));
+}
+
+ClangTidyHeaderCache::~ClangTidyHeaderCache() = default;
+
+void ClangTidyHeaderCache::enterFile(FileID FID) {
+  FileID Parent = IncludeStack.empty() ? FileID() : IncludeStack.back();
+  IncludeStack.push_back(FID);
+  const SourceManager &SM = PP.getSourceManager();
+  const FileEntry *File = SM.getFileEntryForID(FID);
+  if (!File || FID == SM.getMainFileID())
+    return;
+  auto Inserted = HeadersByFile.try_emplace(File, FID);
+  Header &H = Headers[FID];
+  H.Path = File->getName();
+  H.Parent = Parent;
+  if (!Inserted.second) {
+    // The diagnostics of the header may differ between its inclusions.
+    setUncacheable(Inserted.first->second);
+    setUncacheable(FID);
+  }
+}
+
+void ClangTidyHeaderCache::exitFile(FileID FID) {
+  if (IncludeStack.empty() || IncludeStack.back() != FID) {
+    Disabled = true;
+    return;
+  }
+  IncludeStack.pop_back();
+  auto It = Headers.find(FID);
+  if (It == Headers.end())
+    return;
+  Header &H = It->second;
+  addString(H.Digest, PP.getSourceManager().getBufferData(FID));
+  H.Exited = true;
+  H.FinalDigest = H.Digest.final().str();
+  if (Header *Parent = currentHeader())
+    addString(Parent->Digest, H.FinalDigest);
+  Digests[PP.getSourceManager().getFileEntryForID(FID)] = H.FinalDigest;
+}
+
+void ClangTidyHeaderCache::skipFile(const FileEntry &File) {
+  Header *Current = currentHeader();
+  if (!Current)
+    return;
+  // The header depends on the declarations of the skipped one.
+  auto It = Digests.find(&File);
+  if (It != Digests.end())
+    addString(Current->Digest, It->second);
+  else
+    setUncacheable(IncludeStack.back());
+}
+
+void ClangTidyHeaderCache::useMacro(const Token &MacroNameTok,
+                                    const MacroDefinition &MD) {
+  Header *Current = currentHeader();
+  if (!Current || !MacroNameTok.getIdentifierInfo())
+    return;
+  addString(Current->Digest, MacroNameTok.getIdentifierInfo()->getName());
+  const MacroInfo *MI = MD.getMacroInfo();
+  if (!MI)
+    addString(Current->Digest, "<undefined>");
+  else if (MI->isBuiltinMacro())
+    addString(Current->Digest, "<builtin>");
+  else
+    addString(Current->Digest,
+              Lexer::getSourceText(
+                  CharSourceRange::getTokenRange(MI->getDefinitionLoc(),
+                                                 MI->getDefinitionEndLoc()),
+                  PP.getSourceManager(), PP.getLangOpts()));
+}
+
+void ClangTidyHeaderCache::setUncacheable(FileID FID) {
+  // The headers that include this one are not cacheable either.
+  for (auto It = Headers.find(FID); It != Headers.end();
+       It = Headers.find(It->second.Parent))
+    It->second.Cacheable = false;
+}
+
+ClangTidyHeaderCache::Header *ClangTidyHeaderCache::currentHeader() {
+  if (IncludeStack.empty())
+    return nullptr;
+  auto It = Headers.find(IncludeStack.back());
+  return It == Headers.end() ? nullptr : &It->second;
+}
+
+std::string ClangTidyHeaderCache::getCachePath(const Header &H) const {
+  llvm::SHA1 Key;
+  addString(Key, getClangFullRepositoryVersion());
+  addString(Key, Configuration);
+  addString(Key, PP.getPredefines());
+  addString(Key, H.Path);
+  addString(Key, H.FinalDigest);
+  llvm::SmallString<256> Path(Directory);
+  llvm::sys::path::append(Path, llvm::toHex(Key.final()) + ".yaml");
+  return Path.str();
+}
+
+void ClangTidyHeaderCache::beginMatching(ASTContext &Ctx) {
+  if (Ctx.getDiagnostics().hasErrorOccurred())
+    Disabled = true;
+  if (Disabled)
+    return;
+
+  bool AnyCached = false;
+  for (auto &FIDAndHeader : Headers) {
+    Header &H = FIDAndHeader.second;
+    if (!H.Exited || !H.Cacheable)
+      continue;
+    auto Buffer = llvm::MemoryBuffer::getFile(getCachePath(H));
+    if (!Buffer)
+      continue;
+    tooling::TranslationUnitDiagnostics Diags;
+    llvm::yaml::Input YAML((*Buffer)->getBuffer());
+    YAML >> Diags;
+    if (YAML.error() || Diags.MainSourceFile != H.Path)
+      continue;
+    H.Cached = std::move(Diags.Diagnostics);
+    AnyCached = true;
+  }
+  if (!AnyCached)
+    return;
+
+  const SourceManager &SM = Ctx.getSourceManager();
+  std::vector<Decl *> Scope;
+  for (Decl *D : Ctx.getTranslationUnitDecl()->decls()) {
+    auto It = Headers.find(SM.getFileID(SM.getExpansionLoc(D->getLocation())));
+    if (It == Headers.end() || !It->second.Cached)
+      Scope.push_back(D);
+  }
+  Ctx.setTraversalScope(Scope);
+}
+
+void ClangTidyHeaderCache::endTranslationUnit(
+    std::vector<ClangTidyError> &Errors, llvm::StringRef BuildDirectory,
+    llvm::function_ref<bool(llvm::StringRef CheckName)> TreatAsError) {
+  if (Disabled)
+    return;
+
+  llvm::StringMap<Header *> HeadersByPath;
+  for (auto &FIDAndHeader : Headers) {
+    Header &H = FIDAndHeader.second;
+    if (H.Exited && H.Cacheable)
+      HeadersByPath[H.Path] = &H;
+  }
+
+  // Keep the diagnostics of the other headers, unless some of them can't be
+  // replayed since they refer to other files.
+  llvm::StringMap<std::vector<tooling::Diagnostic>> NewDiagnostics;
+  llvm::StringMap<bool> NotReplayable;
+  std::vector<ClangTidyError> Kept;
+  for (ClangTidyError &Error : Errors) {
+    auto It = HeadersByPath.find(Error.Message.FilePath);
+    if (It == HeadersByPath.end()) {
+      Kept.push_back(std::move(Error));
+      continue;
+    }
+    // The diagnostics found again in the cached headers are replaced.
+    if (It->second->Cached)
+      continue;
+    if (isLocalTo(Error, It->first()))
+      NewDiagnostics[It->first()].push_back(Error);
+    else
+      NotReplayable[It->first()] = true;
+    Kept.push_back(std::move(Error));
+  }
+  Errors = std::move(Kept);
+
+  for (const auto &PathAndHeader : HeadersByPath) {
+    const Header &H = *PathAndHeader.second;
+    if (H.Cached) {
+      for (const tooling::Diagnostic &Diag : *H.Cached) {
+        Errors.emplace_back(Diag.DiagnosticName, Diag.DiagLevel,
+                            BuildDirectory, TreatAsError(Diag.DiagnosticName));
+        Errors.back().Message = Diag.Message;
+        Errors.back().Notes = Diag.Notes;
+      }
+      continue;
+    }
+    if (NotReplayable.count(H.Path))
+      continue;
+    if (std::error_code EC = llvm::sys::fs::create_directories(Directory)) {
+      llvm::errs() << "Unable to create header cache directory '" << Directory
+                   << "': " << EC.message() << "\n";
+      return;
+    }
+    // Write to a temporary file first, the cache may be used concurrently.
+    std::string Path = getCachePath(H);
+    int FD;
+    llvm::SmallString<256> TempPath;
+    if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%.tmp", FD, TempPath))
+      continue;
+    {
+      llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+      tooling::TranslationUnitDiagnostics Diags;
+      Diags.MainSourceFile = H.Path;
+      Diags.Diagnostics = std::move(NewDiagnostics[H.Path]);
+      llvm::yaml::Output YAML(OS);
+      YAML << Diags;
+    }
+    if (llvm::sys::fs::rename(TempPath, Path))
+      llvm::sys::fs::remove(TempPath);
+  }
+}
+
+} // end namespace tidy
+} // end namespace clang
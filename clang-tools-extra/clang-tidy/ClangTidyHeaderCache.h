@@ -0,0 +1,104 @@
+//===--- ClangTidyHeaderCache.h - clang-tidy --------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYHEADERCACHE_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYHEADERCACHE_H
+
+#include "clang/Basic/SourceLocation.h"
+#include "clang/Tooling/Core/Diagnostic.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/SHA1.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+
+class ASTContext;
+class FileEntry;
+class MacroDefinition;
+class Preprocessor;
+class Token;
+
+namespace tidy {
+
+struct ClangTidyError;
+
+/// Stores the diagnostics found in the headers of a translation unit in a
+/// directory, and replays them in the translation units that include the same
+/// headers, instead of matching the declarations of these headers again.
+///
+/// The diagnostics of a header are keyed by its path and contents, by the
+/// contents of the headers it includes, by the definitions of the macros these
+/// files expand or test, by the predefined macros and by the clang-tidy
+/// configuration. The headers must be self-contained: their diagnostics must
+/// not depend on the declarations that precede their inclusion. Headers that
+/// are entered more than once, and the headers of translation units with
+/// compilation errors, are not cached.
+///
+/// An instance handles a single translation unit.
+class ClangTidyHeaderCache {
+public:
+  /// Records the headers that \p PP enters. \p Configuration identifies the
+  /// options that the diagnostics depend on.
+  ClangTidyHeaderCache(llvm::StringRef Directory, std::string Configuration,
+                       Preprocessor &PP);
+  ~ClangTidyHeaderCache();
+
+  /// Reads the diagnostics of the cached headers, and stops \p Ctx from
+  /// traversing the declarations of these headers.
+  void beginMatching(ASTContext &Ctx);
+
+  /// Replaces the diagnostics found in the cached headers by the cached ones,
+  /// and stores the diagnostics of the other headers. \p Errors are the
+  /// diagnostics of the translation unit.
+  void endTranslationUnit(
+      std::vector<ClangTidyError> &Errors, llvm::StringRef BuildDirectory,
+      llvm::function_ref<bool(llvm::StringRef CheckName)> TreatAsError);
+
+private:
+  class Recorder;
+
+  struct Header {
+    std::string Path;
+    // The file that includes this one.
+    FileID Parent;
+    // The digest of the contents and of the macros of the header and of the
+    // files it includes, and its value once the header is exited.
+    llvm::SHA1 Digest;
+    std::string FinalDigest;
+    bool Exited = false;
+    bool Cacheable = true;
+    llvm::Optional<std::vector<tooling::Diagnostic>> Cached;
+  };
+
+  void enterFile(FileID FID);
+  void exitFile(FileID FID);
+  void skipFile(const FileEntry &File);
+  void useMacro(const Token &MacroNameTok, const MacroDefinition &MD);
+  void setUncacheable(FileID FID);
+  /// Returns the header that is being lexed, if any.
+  Header *currentHeader();
+  std::string getCachePath(const Header &H) const;
+
+  std::string Directory;
+  std::string Configuration;
+  Preprocessor &PP;
+  llvm::DenseMap<FileID, Header> Headers;
+  llvm::DenseMap<const FileEntry *, FileID> HeadersByFile;
+  // The digest of each header once it is exited.
+  llvm::DenseMap<const FileEntry *, std::string> Digests;
+  std::vector<FileID> IncludeStack;
+  bool Disabled = false;
+};
+
+} // end namespace tidy
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYHEADERCACHE_H
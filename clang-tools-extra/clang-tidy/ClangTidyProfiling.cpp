@@ -79,7 +79,21 @@ void ClangTidyProfiling::storeProfileData() {
 ClangTidyProfiling::ClangTidyProfiling(llvm::Optional<StorageParams> Storage)
     : Storage(std::move(Storage)) {}
 
+ClangTidyProfiling::ClangTidyProfiling(ClangTidyProfiling *Total)
+    : Total(Total) {}
+
+void ClangTidyProfiling::add(const llvm::StringMap<llvm::TimeRecord> &Other) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  for (const auto &Record : Other)
+    Records[Record.getKey()] += Record.getValue();
+}
+
 ClangTidyProfiling::~ClangTidyProfiling() {
+  if (Total) {
+    Total->add(Records);
+    return;
+  }
+
   TG.emplace("clang-tidy", "clang-tidy checks profiling", Records);
 
   if (!Storage.hasValue())
@@ -14,6 +14,7 @@
 #include "llvm/Support/Chrono.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -38,6 +39,13 @@ private:
 
   llvm::Optional<StorageParams> Storage;
 
+  // The profile this one is added to when it is destroyed, if any.
+  ClangTidyProfiling *Total = nullptr;
+  // Guards Records while other profiles are added to this one.
+  std::mutex Mutex;
+
+  void add(const llvm::StringMap<llvm::TimeRecord> &Other);
+
   void printUserFriendlyTable(llvm::raw_ostream &OS);
   void printAsJSON(llvm::raw_ostream &OS);
 
@@ -50,6 +58,11 @@ public:
 
   ClangTidyProfiling(llvm::Optional<StorageParams> Storage);
 
+  /// Creates a profile whose records are added to \p Total when it is
+  /// destroyed, instead of being printed or stored, so that several
+  /// translation units can be reported together.
+  explicit ClangTidyProfiling(ClangTidyProfiling *Total);
+
   ~ClangTidyProfiling();
 };
 
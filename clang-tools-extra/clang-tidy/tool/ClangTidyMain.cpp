@@ -192,6 +192,22 @@ these per-TU profiles are instead stored as JSON.
                                               cl::value_desc("prefix"),
                                               cl::cat(ClangTidyCategory));
 
+static cl::opt<unsigned> NumThreads("j", cl::desc(R"(
+Number of translation units to process in
+parallel. 0 uses all the hardware threads.
+)"),
+                                    cl::init(1), cl::cat(ClangTidyCategory));
+
+static cl::opt<std::string> HeaderCache("header-cache", cl::desc(R"(
+Directory where the diagnostics of the headers
+are stored, and replayed from in the next runs
+instead of checking the unchanged headers again.
+The headers must be self-contained. Not used
+with -line-filter.
+)"),
+                                        cl::value_desc("directory"),
+                                        cl::cat(ClangTidyCategory));
+
 /// This option allows enabling the experimental alpha checkers from the static
 /// analyzer. This option is set to false and not visible in help, because it is
 /// highly not recommended for users.
@@ -427,9 +443,10 @@ static int clangTidyMain(int argc, const char **argv) {
 
   ClangTidyContext Context(std::move(OwningOptionsProvider),
                            AllowEnablingAnalyzerAlphaCheckers);
+  Context.setHeaderCacheDirectory(HeaderCache);
   std::vector<ClangTidyError> Errors =
       runClangTidy(Context, OptionsParser.getCompilations(), PathList, BaseFS,
-                   EnableCheckProfile, ProfilePrefix);
+                   EnableCheckProfile, ProfilePrefix, NumThreads);
   bool FoundErrors = llvm::find_if(Errors, [](const ClangTidyError &E) {
                        return E.DiagLevel == ClangTidyError::Error;
                      }) != Errors.end();
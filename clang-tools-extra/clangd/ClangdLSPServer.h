@@ -109,6 +109,7 @@ private:
                     Callback<std::vector<SymbolDetails>>);
   void onSelectionRange(const SelectionRangeParams &,
                         Callback<std::vector<SelectionRange>>);
+  void onMemoryUsage(const NoParams &, Callback<MemoryUsage>);
 
   std::vector<Fix> getFixes(StringRef File, const clangd::Diagnostic &D);
 
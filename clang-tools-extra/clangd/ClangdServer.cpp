@@ -74,8 +74,14 @@ struct UpdateIndexCallbacks : public ParsingCallbacks {
 
     std::vector<Diag> Diagnostics = AST.getDiagnostics();
     std::vector<HighlightingToken> Highlightings;
-    if (SemanticHighlighting)
-      Highlightings = getSemanticHighlightings(AST);
+    if (SemanticHighlighting) {
+      SemanticHighlightingCache *Cache;
+      {
+        std::lock_guard<std::mutex> Lock(HighlightingCachesMutex);
+        Cache = &HighlightingCaches[Path];
+      }
+      Highlightings = getSemanticHighlightings(AST, Cache);
+    }
 
     Publish([&]() {
       DiagConsumer.onDiagnosticsReady(Path, std::move(Diagnostics));
@@ -97,6 +103,9 @@ private:
   FileIndex *FIndex;
   DiagnosticsConsumer &DiagConsumer;
   bool SemanticHighlighting;
+  // The highlightings of the previous AST of each file.
+  std::mutex HighlightingCachesMutex;
+  llvm::StringMap<SemanticHighlightingCache> HighlightingCaches;
 };
 } // namespace
 
@@ -171,9 +180,13 @@ void ClangdServer::addDocument(PathRef File, llvm::StringRef Contents,
   Inputs.Opts = std::move(Opts);
   Inputs.Index = Index;
   bool NewFile = WorkScheduler.update(File, Inputs, WantDiags);
-  // If we loaded Foo.h, we want to make sure Foo.cpp is indexed.
-  if (NewFile && BackgroundIdx)
-    BackgroundIdx->boostRelated(File);
+  if (BackgroundIdx) {
+    // If we loaded Foo.h, we want to make sure Foo.cpp is indexed.
+    if (NewFile)
+      BackgroundIdx->boostRelated(File);
+    else
+      BackgroundIdx->pauseForEdit();
+  }
 }
 
 void ClangdServer::removeDocument(PathRef File) { WorkScheduler.remove(File); }
@@ -211,6 +224,8 @@ void ClangdServer::codeComplete(PathRef File, Position Pos,
               CachedCompletionFuzzyFindRequestMutex);
           SpecFuzzyFind->CachedReq =
               CachedCompletionFuzzyFindRequestByFile[File];
+          SpecFuzzyFind->CachedResults =
+              CachedCompletionIndexResultsByFile[File];
         }
       }
     }
@@ -227,6 +242,8 @@ void ClangdServer::codeComplete(PathRef File, Position Pos,
       std::lock_guard<std::mutex> Lock(CachedCompletionFuzzyFindRequestMutex);
       CachedCompletionFuzzyFindRequestByFile[File] =
           SpecFuzzyFind->NewReq.getValue();
+      CachedCompletionIndexResultsByFile[File] =
+          std::move(SpecFuzzyFind->NewResults);
     }
     // SpecFuzzyFind is only destroyed after speculative fuzzy find finishes.
     // We don't want `codeComplete` to wait for the async call if it doesn't use
@@ -601,6 +618,19 @@ ClangdServer::getUsedBytesPerFile() const {
   return WorkScheduler.getUsedBytesPerFile();
 }
 
+MemoryUsage ClangdServer::getMemoryUsage() const {
+  MemoryUsage Result;
+  Result.preambles = WorkScheduler.getUsedPreambleBytes();
+  Result.asts = WorkScheduler.getUsedASTBytes();
+  if (DynamicIdx)
+    Result.dynamicIndex = DynamicIdx->estimateMemoryUsage();
+  if (BackgroundIdx)
+    Result.backgroundIndex = BackgroundIdx->estimateMemoryUsage();
+  if (Index)
+    Result.index = Index->estimateMemoryUsage();
+  return Result;
+}
+
 LLVM_NODISCARD bool
 ClangdServer::blockUntilIdleForTest(llvm::Optional<double> TimeoutSeconds) {
   return WorkScheduler.blockUntilIdle(timeoutSeconds(TimeoutSeconds)) &&
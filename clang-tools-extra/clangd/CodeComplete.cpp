@@ -1147,16 +1147,36 @@ bool allowIndex(CodeCompletionContext &CC) {
   llvm_unreachable("invalid NestedNameSpecifier kind");
 }
 
-std::future<SymbolSlab> startAsyncFuzzyFind(const SymbolIndex &Index,
-                                            const FuzzyFindRequest &Req) {
-  return runAsync<SymbolSlab>([&Index, Req]() {
+CompletionIndexResults fuzzyFind(const SymbolIndex &Index,
+                                 const FuzzyFindRequest &Req) {
+  SymbolSlab::Builder Syms;
+  CompletionIndexResults Results;
+  Results.Incomplete =
+      Index.fuzzyFind(Req, [&Syms](const Symbol &Sym) { Syms.insert(Sym); });
+  Results.Symbols = std::make_shared<SymbolSlab>(std::move(Syms).build());
+  return Results;
+}
+
+std::future<CompletionIndexResults>
+startAsyncFuzzyFind(const SymbolIndex &Index, const FuzzyFindRequest &Req) {
+  return runAsync<CompletionIndexResults>([&Index, Req]() {
     trace::Span Tracer("Async fuzzyFind");
-    SymbolSlab::Builder Syms;
-    Index.fuzzyFind(Req, [&Syms](const Symbol &Sym) { Syms.insert(Sym); });
-    return std::move(Syms).build();
+    return fuzzyFind(Index, Req);
   });
 }
 
+// Whether the results of \p Cached, if complete, contain the results of \p Req,
+// which only differs by extending the query. Indexes may only match a short
+// query against the start of the names (Dex does), so this needs the cached
+// query to be long enough to be matched anywhere.
+bool coversRequest(FuzzyFindRequest Cached, const FuzzyFindRequest &Req) {
+  if (Cached.Query.size() < 3 ||
+      !llvm::StringRef(Req.Query).startswith(Cached.Query))
+    return false;
+  Cached.Query = Req.Query;
+  return Cached == Req;
+}
+
 // Creates a `FuzzyFindRequest` based on the cached index request from the
 // last completion, if any, and the speculated completion filter text in the
 // source code.
@@ -1226,6 +1246,8 @@ class CodeCompleteFlow {
   /// Initialized right before sema run. This is only set if `SpecFuzzyFind` is
   /// set and contains a cached request.
   llvm::Optional<FuzzyFindRequest> SpecReq;
+  /// When the asynchronous index requests stop being waited for.
+  Deadline Budget = Deadline::infinity();
 
 public:
   // A CodeCompleteFlow object is only useful for calling run() exactly once.
@@ -1240,11 +1262,16 @@ public:
     HeuristicPrefix =
         guessCompletionPrefix(SemaCCInput.Contents, SemaCCInput.Offset);
     populateContextWords(SemaCCInput.Contents);
+    if (Opts.LatencyBudget.count())
+      Budget = std::chrono::steady_clock::now() + Opts.LatencyBudget;
     if (Opts.Index && SpecFuzzyFind && SpecFuzzyFind->CachedReq.hasValue()) {
       assert(!SpecFuzzyFind->Result.valid());
       SpecReq = speculativeFuzzyFindRequestForCompletion(
           *SpecFuzzyFind->CachedReq, HeuristicPrefix);
-      SpecFuzzyFind->Result = startAsyncFuzzyFind(*Opts.Index, *SpecReq);
+      // No need to ask the index if the cached results will do.
+      if (!SpecFuzzyFind->CachedResults ||
+          !coversRequest(*SpecFuzzyFind->CachedReq, *SpecReq))
+        SpecFuzzyFind->Result = startAsyncFuzzyFind(*Opts.Index, *SpecReq);
     }
 
     // We run Sema code completion first. It builds an AST and calculates:
@@ -1375,10 +1402,11 @@ public:
     QueryScopes = Scopes.scopesForIndexQuery();
     ScopeProximity.emplace(QueryScopes);
 
-    SymbolSlab IndexResults = Opts.Index ? queryIndex() : SymbolSlab();
+    auto IndexResults =
+        Opts.Index ? queryIndex() : std::make_shared<SymbolSlab>();
 
     CodeCompleteResult Output = toCodeCompleteResult(mergeResults(
-        /*SemaResults=*/{}, IndexResults, IdentifierResults));
+        /*SemaResults=*/{}, *IndexResults, IdentifierResults));
     Output.RanParser = false;
     logResults(Output, Tracer);
     return Output;
@@ -1438,11 +1466,11 @@ private:
     // We must copy index results to preserve them, but there are at most Limit.
     auto IndexResults = (Opts.Index && allowIndex(Recorder->CCContext))
                             ? queryIndex()
-                            : SymbolSlab();
+                            : std::make_shared<SymbolSlab>();
     trace::Span Tracer("Populate CodeCompleteResult");
     // Merge Sema and Index results, score them, and pick the winners.
     auto Top =
-        mergeResults(Recorder->Results, IndexResults, /*Identifiers*/ {});
+        mergeResults(Recorder->Results, *IndexResults, /*Identifiers*/ {});
     return toCodeCompleteResult(Top);
   }
 
@@ -1461,7 +1489,7 @@ private:
     return Output;
   }
 
-  SymbolSlab queryIndex() {
+  std::shared_ptr<const SymbolSlab> queryIndex() {
     trace::Span Tracer("Query index");
     SPAN_ATTACH(Tracer, "limit", int64_t(Opts.Limit));
 
@@ -1481,23 +1509,62 @@ private:
 
     if (SpecFuzzyFind)
       SpecFuzzyFind->NewReq = Req;
+    if (SpecFuzzyFind && SpecFuzzyFind->CachedResults &&
+        coversRequest(*SpecFuzzyFind->CachedReq, Req)) {
+      vlog("Code complete: the last index results contain all the results of "
+           "the index request. Filtering them.");
+      SPAN_ATTACH(Tracer, "Cached results", true);
+      SymbolSlab::Builder ResultsBuilder;
+      for (const Symbol &Sym : *SpecFuzzyFind->CachedResults)
+        if (Filter->match(Sym.Name))
+          ResultsBuilder.insert(Sym);
+      CompletionIndexResults Results;
+      Results.Symbols =
+          std::make_shared<SymbolSlab>(std::move(ResultsBuilder).build());
+      return useIndexResults(std::move(Results));
+    }
     if (SpecFuzzyFind && SpecFuzzyFind->Result.valid() && (*SpecReq == Req)) {
       vlog("Code complete: speculative fuzzy request matches the actual index "
            "request. Waiting for the speculative index results.");
       SPAN_ATTACH(Tracer, "Speculative results", true);
 
       trace::Span WaitSpec("Wait speculative results");
-      return SpecFuzzyFind->Result.get();
+      return waitForIndexResults(SpecFuzzyFind->Result);
     }
 
     SPAN_ATTACH(Tracer, "Speculative results", false);
 
-    // Run the query against the index.
-    SymbolSlab::Builder ResultsBuilder;
-    if (Opts.Index->fuzzyFind(
-            Req, [&](const Symbol &Sym) { ResultsBuilder.insert(Sym); }))
+    // Run the query against the index, in parallel if we may stop waiting.
+    if (SpecFuzzyFind && !(Budget == Deadline::infinity())) {
+      SpecFuzzyFind->NewResult = startAsyncFuzzyFind(*Opts.Index, Req);
+      return waitForIndexResults(SpecFuzzyFind->NewResult);
+    }
+    return useIndexResults(fuzzyFind(*Opts.Index, Req));
+  }
+
+  // Waits for the results of an asynchronous index request, unless they miss
+  // the latency budget: then the completion goes without them.
+  std::shared_ptr<const SymbolSlab>
+  waitForIndexResults(std::future<CompletionIndexResults> &Results) {
+    if (!(Budget == Deadline::infinity()) &&
+        Results.wait_until(Budget.time()) == std::future_status::timeout) {
+      log("Code complete: index results missed the latency budget of {0}ms",
+          Opts.LatencyBudget.count());
+      Incomplete = true;
+      return std::make_shared<SymbolSlab>();
+    }
+    return useIndexResults(Results.get());
+  }
+
+  // Keeps complete results for the next completion as well.
+  std::shared_ptr<const SymbolSlab>
+  useIndexResults(CompletionIndexResults Results) {
+    if (Results.Incomplete)
       Incomplete = true;
-    return std::move(ResultsBuilder).build();
+    // Without a limit, complete results could be much of the index.
+    else if (SpecFuzzyFind && Opts.Limit)
+      SpecFuzzyFind->NewResults = Results.Symbols;
+    return std::move(Results.Symbols);
   }
 
   // Merges Sema and Index results where possible, to form CompletionCandidates.
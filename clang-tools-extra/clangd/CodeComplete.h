@@ -29,7 +29,9 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
+#include <chrono>
 #include <future>
+#include <memory>
 
 namespace clang {
 class NamedDecl;
@@ -95,6 +97,13 @@ struct CodeCompleteOptions {
   /// this should be effective for a number of code completions.
   bool SpeculativeIndexRequest = false;
 
+  /// If non-zero, code completion doesn't wait for index results past this
+  /// long after it started: it returns the results it has and marks the list
+  /// incomplete, so that the client asks again on the next keystroke.
+  /// This only applies to index requests that run in parallel with Sema, which
+  /// requires SpeculativeIndexRequest.
+  std::chrono::milliseconds LatencyBudget = std::chrono::milliseconds::zero();
+
   // Populated internally by clangd, do not set.
   /// If `Index` is set, it is used to augment the code completion
   /// results.
@@ -222,6 +231,13 @@ struct CodeCompleteResult {
 };
 raw_ostream &operator<<(raw_ostream &, const CodeCompleteResult &);
 
+/// The symbols an index request of code completion returned.
+struct CompletionIndexResults {
+  std::shared_ptr<const SymbolSlab> Symbols;
+  /// Whether the index may have more results than it returned.
+  bool Incomplete = false;
+};
+
 /// A speculative and asynchronous fuzzy find index request (based on cached
 /// request) that can be sent before parsing sema. This would reduce completion
 /// latency if the speculation succeeds.
@@ -229,12 +245,23 @@ struct SpeculativeFuzzyFind {
   /// A cached request from past code completions.
   /// Set by caller of `codeComplete()`.
   llvm::Optional<FuzzyFindRequest> CachedReq;
+  /// The results of CachedReq, if they were complete. They are reused without
+  /// querying the index while the user keeps typing the same identifier.
+  /// Set by caller of `codeComplete()`.
+  std::shared_ptr<const SymbolSlab> CachedResults;
   /// The actual request used by `codeComplete()`.
   /// Set by `codeComplete()`. This can be used by callers to update cache.
   llvm::Optional<FuzzyFindRequest> NewReq;
+  /// The results of NewReq, if they are complete.
+  /// Set by `codeComplete()`. This can be used by callers to update cache.
+  std::shared_ptr<const SymbolSlab> NewResults;
   /// The result is consumed by `codeComplete()` if speculation succeeded.
   /// NOTE: the destructor will wait for the async call to finish.
-  std::future<SymbolSlab> Result;
+  std::future<CompletionIndexResults> Result;
+  /// The actual request, sent asynchronously if the speculation failed and
+  /// the completion has a latency budget.
+  /// NOTE: the destructor will wait for the async call to finish.
+  std::future<CompletionIndexResults> NewResult;
 };
 
 /// Gets code completions at a specified \p Pos in \p FileName.
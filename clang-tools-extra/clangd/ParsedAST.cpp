@@ -362,6 +362,7 @@ ParsedAST::build(std::unique_ptr<clang::CompilerInvocation> CI,
 
   // Collect tokens of the main file.
   syntax::TokenCollector CollectTokens(Clang->getPreprocessor());
+  CollectTokens.recordMainFileOnly();
 
   if (llvm::Error Err = Action->Execute())
     log("Execute() failed when building AST for {0}: {1}", MainInput.getFile(),
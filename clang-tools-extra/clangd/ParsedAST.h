@@ -93,6 +93,8 @@ public:
   /// Gets all macro references (definition, expansions) present in the main
   /// file, including those in the preamble region.
   const MainFileMacros &getMacros() const;
+  /// The preamble the AST was built with, if any.
+  std::shared_ptr<const PreambleData> getPreamble() const { return Preamble; }
   /// Tokens recorded while parsing the main file.
   /// (!) does not have tokens from the preamble.
   const syntax::TokenBuffer &getTokens() const { return Tokens; }
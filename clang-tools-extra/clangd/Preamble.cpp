@@ -12,6 +12,9 @@
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Lex/PPCallbacks.h"
 #include "clang/Lex/PreprocessorOptions.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/Path.h"
 
 namespace clang {
 namespace clangd {
@@ -24,6 +27,53 @@ bool compileCommandsAreEqual(const tooling::CompileCommand &LHS,
          llvm::makeArrayRef(LHS.CommandLine).equals(RHS.CommandLine);
 }
 
+// Two files can share a preamble if it is built from the same text with the
+// same compile command, up to the name of the file itself.
+std::string getPreambleCacheKey(PathRef FileName, const ParseInputs &Inputs,
+                                PreambleBounds Bounds) {
+  const tooling::CompileCommand &Cmd = Inputs.CompileCommand;
+  std::string Key = Cmd.Directory;
+  Key += '\0';
+  for (const std::string &Arg : Cmd.CommandLine) {
+    // Stand for the file and its output with characters no argument contains.
+    if (Arg == FileName || Arg == Cmd.Filename)
+      Key += '\1';
+    else if (!Cmd.Output.empty() && Arg == Cmd.Output)
+      Key += '\2';
+    else
+      Key += Arg;
+    Key += '\0';
+  }
+  Key += llvm::StringRef(Inputs.Contents).take_front(Bounds.Size);
+  return Key;
+}
+
+// The directives of a preamble region which a patch may need to repeat, along
+// with the line they start on.
+std::vector<std::pair<unsigned, std::string>>
+scanPatchableDirectives(llvm::StringRef Region) {
+  std::vector<std::pair<unsigned, std::string>> Directives;
+  llvm::SmallVector<llvm::StringRef, 32> Lines;
+  Region.split(Lines, '\n');
+  for (unsigned I = 0; I < Lines.size(); ++I) {
+    unsigned Line = I + 1;
+    std::string Text = Lines[I].rtrim("\r").str();
+    // Join the continued lines.
+    while (llvm::StringRef(Text).endswith("\\") && I + 1 < Lines.size()) {
+      Text.pop_back();
+      Text += Lines[++I].rtrim("\r");
+    }
+    llvm::StringRef Directive = llvm::StringRef(Text).ltrim();
+    if (!Directive.consume_front("#"))
+      continue;
+    llvm::StringRef Name = Directive.ltrim().take_while(llvm::isAlpha);
+    if (Name == "include" || Name == "include_next" || Name == "import" ||
+        Name == "define" || Name == "undef")
+      Directives.emplace_back(Line, llvm::StringRef(Text).trim());
+  }
+  return Directives;
+}
+
 class CppFilePreambleCallbacks : public PreambleCallbacks {
 public:
   CppFilePreambleCallbacks(PathRef File, PreambleParsedCallback ParsedCallback)
@@ -85,12 +135,53 @@ PreambleData::PreambleData(PrecompiledPreamble Preamble,
       StatCache(std::move(StatCache)), CanonIncludes(std::move(CanonIncludes)) {
 }
 
+std::shared_ptr<const PreambleData>
+PreambleCache::get(PathRef FileName, const CompilerInvocation &CI,
+                   const llvm::MemoryBuffer &Contents, PreambleBounds Bounds,
+                   const ParseInputs &Inputs) {
+  std::shared_ptr<const PreambleData> Preamble;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto It = Preambles.find(getPreambleCacheKey(FileName, Inputs, Bounds));
+    if (It == Preambles.end())
+      return nullptr;
+    Preamble = It->second.lock();
+    if (!Preamble) {
+      Preambles.erase(It);
+      return nullptr;
+    }
+  }
+  // The headers may have changed since the preamble was built.
+  if (!Preamble->Preamble.CanReuse(CI, &Contents, Bounds, Inputs.FS.get()))
+    return nullptr;
+  return Preamble;
+}
+
+void PreambleCache::put(PathRef FileName, const ParseInputs &Inputs,
+                        PreambleBounds Bounds,
+                        std::shared_ptr<const PreambleData> Preamble) {
+  // The macros defined in the preamble region would be located in the file
+  // the preamble was built for, rather than in the file reusing it.
+  if (Bounds.Size == 0 || !Preamble->Macros.Names.empty())
+    return;
+  std::lock_guard<std::mutex> Lock(Mutex);
+  // Forget about the preambles that were freed.
+  for (auto It = Preambles.begin(); It != Preambles.end();) {
+    auto Next = std::next(It);
+    if (It->second.expired())
+      Preambles.erase(It);
+    It = Next;
+  }
+  Preambles[getPreambleCacheKey(FileName, Inputs, Bounds)] =
+      std::move(Preamble);
+}
+
 std::shared_ptr<const PreambleData>
 buildPreamble(PathRef FileName, CompilerInvocation &CI,
               std::shared_ptr<const PreambleData> OldPreamble,
               const tooling::CompileCommand &OldCompileCommand,
               const ParseInputs &Inputs, bool StoreInMemory,
-              PreambleParsedCallback PreambleCallback) {
+              PreambleParsedCallback PreambleCallback, PreambleCache *Cache) {
   // Note that we don't need to copy the input contents, preamble can live
   // without those.
   auto ContentsBuffer =
@@ -100,11 +191,18 @@ buildPreamble(PathRef FileName, CompilerInvocation &CI,
 
   if (OldPreamble &&
       compileCommandsAreEqual(Inputs.CompileCommand, OldCompileCommand) &&
-      OldPreamble->Preamble.CanReuse(CI, ContentsBuffer.get(), Bounds,
-                                     Inputs.FS.get())) {
+      isPreambleCompatible(*OldPreamble, FileName, Inputs, CI)) {
     vlog("Reusing preamble for file {0}", llvm::Twine(FileName));
     return OldPreamble;
   }
+  if (Cache) {
+    if (auto SharedPreamble =
+            Cache->get(FileName, CI, *ContentsBuffer, Bounds, Inputs)) {
+      vlog("Reusing preamble of another file for file {0}",
+           llvm::Twine(FileName));
+      return SharedPreamble;
+    }
+  }
   vlog("Preamble for file {0} cannot be reused. Attempting to rebuild it.",
        FileName);
 
@@ -147,16 +245,81 @@ buildPreamble(PathRef FileName, CompilerInvocation &CI,
     vlog("Built preamble of size {0} for file {1}", BuiltPreamble->getSize(),
          FileName);
     std::vector<Diag> Diags = PreambleDiagnostics.take();
-    return std::make_shared<PreambleData>(
+    auto Preamble = std::make_shared<PreambleData>(
         std::move(*BuiltPreamble), std::move(Diags),
         SerializedDeclsCollector.takeIncludes(),
         SerializedDeclsCollector.takeMacros(), std::move(StatCache),
         SerializedDeclsCollector.takeCanonicalIncludes());
+    Preamble->PreambleContents = Inputs.Contents.substr(0, Bounds.Size);
+    if (Cache)
+      Cache->put(FileName, Inputs, Bounds, Preamble);
+    return Preamble;
   } else {
     elog("Could not build a preamble for file {0}", FileName);
     return nullptr;
   }
 }
 
+bool isPreambleCompatible(const PreambleData &Preamble, PathRef FileName,
+                          const ParseInputs &Inputs,
+                          const CompilerInvocation &CI) {
+  auto ContentsBuffer =
+      llvm::MemoryBuffer::getMemBuffer(Inputs.Contents, FileName);
+  auto Bounds =
+      ComputePreambleBounds(*CI.getLangOpts(), ContentsBuffer.get(), 0);
+  return Preamble.Preamble.CanReuse(CI, ContentsBuffer.get(), Bounds,
+                                    Inputs.FS.get());
+}
+
+PreamblePatch PreamblePatch::create(PathRef FileName,
+                                    const ParseInputs &Modified,
+                                    const CompilerInvocation &CI,
+                                    const PreambleData &Baseline) {
+  trace::Span Tracer("CreatePreamblePatch");
+  SPAN_ATTACH(Tracer, "File", FileName);
+  PreamblePatch Patch;
+  // The patch lives next to the main file, so that the quoted includes are
+  // found relative to the same directory.
+  llvm::SmallString<128> PatchFileName(llvm::sys::path::parent_path(FileName));
+  llvm::sys::path::append(PatchFileName, "__preamble_patch__.h");
+  Patch.PatchFileName = PatchFileName.str();
+
+  auto ContentsBuffer =
+      llvm::MemoryBuffer::getMemBuffer(Modified.Contents, FileName);
+  auto Bounds =
+      ComputePreambleBounds(*CI.getLangOpts(), ContentsBuffer.get(), 0);
+  llvm::StringSet<> BaselineDirectives;
+  for (const auto &Directive :
+       scanPatchableDirectives(Baseline.PreambleContents))
+    BaselineDirectives.insert(Directive.second);
+
+  llvm::raw_string_ostream OS(Patch.PatchContents);
+  for (const auto &Directive : scanPatchableDirectives(
+           llvm::StringRef(Modified.Contents).take_front(Bounds.Size))) {
+    if (BaselineDirectives.count(Directive.second))
+      continue;
+    // Attribute the diagnostics to the directive in the main file.
+    OS << "#line " << Directive.first << " \"";
+    OS.write_escaped(FileName);
+    OS << "\"\n" << Directive.second << '\n';
+  }
+  OS.flush();
+  vlog("Patching the preamble of file {0} with {1} bytes", FileName,
+       Patch.PatchContents.size());
+  return Patch;
+}
+
+void PreamblePatch::apply(CompilerInvocation &CI) const {
+  if (empty())
+    return;
+  auto &PPOpts = CI.getPreprocessorOpts();
+  // The CompilerInstance takes ownership of the remapped buffer.
+  PPOpts.addRemappedFile(
+      PatchFileName,
+      llvm::MemoryBuffer::getMemBufferCopy(PatchContents, PatchFileName)
+          .release());
+  PPOpts.Includes.push_back(PatchFileName);
+}
+
 } // namespace clangd
 } // namespace clang
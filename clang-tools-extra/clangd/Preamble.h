@@ -32,6 +32,7 @@
 #include "clang/Tooling/CompilationDatabase.h"
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -62,24 +63,88 @@ struct PreambleData {
   // When reusing a preamble, this cache can be consumed to save IO.
   std::unique_ptr<PreambleFileStatusCache> StatCache;
   CanonicalIncludes CanonIncludes;
+  // The preamble region of the main file the preamble was built from, used to
+  // patch the preamble once the region changed.
+  std::string PreambleContents;
 };
 
 using PreambleParsedCallback =
     std::function<void(ASTContext &, std::shared_ptr<clang::Preprocessor>,
                        const CanonicalIncludes &)>;
 
+/// Preambles shared between the files that start with the same preamble and
+/// have the same compile command, e.g. the files of a library that include
+/// the same headers first. The cache only holds weak references: a preamble is
+/// freed when no file uses it anymore. Thread-safe.
+class PreambleCache {
+public:
+  /// Returns a preamble built for another file that can be reused for
+  /// \p FileName, or null if there is none.
+  std::shared_ptr<const PreambleData>
+  get(PathRef FileName, const CompilerInvocation &CI,
+      const llvm::MemoryBuffer &Contents, PreambleBounds Bounds,
+      const ParseInputs &Inputs);
+
+  /// Makes \p Preamble, built for \p FileName, available to other files.
+  void put(PathRef FileName, const ParseInputs &Inputs, PreambleBounds Bounds,
+           std::shared_ptr<const PreambleData> Preamble);
+
+private:
+  std::mutex Mutex;
+  llvm::StringMap<std::weak_ptr<const PreambleData>> Preambles;
+};
+
 /// Build a preamble for the new inputs unless an old one can be reused.
 /// If \p OldPreamble can be reused, it is returned unchanged.
 /// If \p OldPreamble is null, always builds the preamble.
+/// If \p Cache is set, a preamble built for another file with the same
+/// preamble and compile command is reused as well, and a newly built preamble
+/// is added to the cache.
 /// If \p PreambleCallback is set, it will be run on top of the AST while
-/// building the preamble. Note that if the old preamble was reused, no AST is
-/// built and, therefore, the callback will not be executed.
+/// building the preamble. Note that if the old preamble or one from the cache
+/// was reused, no AST is built and, therefore, the callback will not be
+/// executed.
 std::shared_ptr<const PreambleData>
 buildPreamble(PathRef FileName, CompilerInvocation &CI,
               std::shared_ptr<const PreambleData> OldPreamble,
               const tooling::CompileCommand &OldCompileCommand,
               const ParseInputs &Inputs, bool StoreInMemory,
-              PreambleParsedCallback PreambleCallback);
+              PreambleParsedCallback PreambleCallback,
+              PreambleCache *Cache = nullptr);
+
+/// Returns true if \p Preamble can be used for the new \p Inputs of
+/// \p FileName as is, i.e. its preamble region and the files it includes
+/// did not change. The compile command is not checked.
+bool isPreambleCompatible(const PreambleData &Preamble, PathRef FileName,
+                          const ParseInputs &Inputs,
+                          const CompilerInvocation &CI);
+
+/// The directives added to the preamble region of a file since its preamble
+/// was built. Including them before the main file lets that stale preamble be
+/// used to build an AST reflecting the new includes and macros, while the
+/// preamble is rebuilt.
+///
+/// Removed directives are not undone, and the positions of the includes the
+/// stale preamble recorded are not updated, so such an AST is only meant to be
+/// used until the new preamble is ready.
+class PreamblePatch {
+public:
+  /// Returns the patch for the preamble region of \p Modified, the new inputs
+  /// of \p FileName compiled with \p CI, over the one \p Baseline was built
+  /// from.
+  static PreamblePatch create(PathRef FileName, const ParseInputs &Modified,
+                              const CompilerInvocation &CI,
+                              const PreambleData &Baseline);
+
+  /// Makes \p CI include the patch before the main file.
+  void apply(CompilerInvocation &CI) const;
+
+  bool empty() const { return PatchContents.empty(); }
+
+private:
+  std::string PatchFileName;
+  std::string PatchContents;
+};
 
 
 } // namespace clangd
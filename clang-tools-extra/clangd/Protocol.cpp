@@ -909,6 +909,16 @@ llvm::json::Value toJSON(const FileStatus &FStatus) {
   };
 }
 
+llvm::json::Value toJSON(const MemoryUsage &Usage) {
+  return llvm::json::Object{
+      {"preambles", Usage.preambles},
+      {"asts", Usage.asts},
+      {"dynamicIndex", Usage.dynamicIndex},
+      {"backgroundIndex", Usage.backgroundIndex},
+      {"index", Usage.index},
+  };
+}
+
 llvm::raw_ostream &operator<<(llvm::raw_ostream &O,
                               const DocumentHighlight &V) {
   O << V.range;
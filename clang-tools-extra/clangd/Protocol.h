@@ -1202,6 +1202,22 @@ struct FileStatus {
 };
 llvm::json::Value toJSON(const FileStatus &FStatus);
 
+/// Clangd extension: the estimated memory usage of clangd, in bytes, sent from
+/// server in response to the `$/memoryUsage` request.
+struct MemoryUsage {
+  /// The preambles of the open files.
+  size_t preambles = 0;
+  /// The ASTs of the open files that are kept while the files are idle.
+  size_t asts = 0;
+  /// The index of the open files.
+  size_t dynamicIndex = 0;
+  /// The index of the project built in the background.
+  size_t backgroundIndex = 0;
+  /// All the indexes, including the static one.
+  size_t index = 0;
+};
+llvm::json::Value toJSON(const MemoryUsage &);
+
 /// Represents a semantic highlighting information that has to be applied on a
 /// specific line of the text document.
 struct SemanticHighlightingInformation {
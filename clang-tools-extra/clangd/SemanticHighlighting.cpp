@@ -19,6 +19,8 @@
 #include "clang/AST/Type.h"
 #include "clang/AST/TypeLoc.h"
 #include "clang/Basic/SourceLocation.h"
+#include "clang/Lex/Lexer.h"
+#include "llvm/ADT/Hashing.h"
 #include <algorithm>
 
 namespace clang {
@@ -96,7 +98,7 @@ llvm::Optional<HighlightingKind> kindForType(const Type *TP) {
   return llvm::None;
 }
 
-// Collects all semantic tokens in an ASTContext.
+// Collects the semantic tokens of the declarations it traverses.
 class HighlightingTokenCollector
     : public RecursiveASTVisitor<HighlightingTokenCollector> {
   std::vector<HighlightingToken> Tokens;
@@ -105,39 +107,18 @@ class HighlightingTokenCollector
 public:
   HighlightingTokenCollector(ParsedAST &AST) : AST(AST) {}
 
-  std::vector<HighlightingToken> collectTokens() {
-    Tokens.clear();
-    TraverseAST(AST.getASTContext());
-    // Add highlightings for macro expansions as they are not traversed by the
-    // visitor.
-    for (const auto &M : AST.getMacros().Ranges)
-      Tokens.push_back({HighlightingKind::Macro, M});
-    // Initializer lists can give duplicates of tokens, therefore all tokens
-    // must be deduplicated.
-    llvm::sort(Tokens);
-    auto Last = std::unique(Tokens.begin(), Tokens.end());
-    Tokens.erase(Last, Tokens.end());
-    // Macros can give tokens that have the same source range but conflicting
-    // kinds. In this case all tokens sharing this source range should be
-    // removed.
-    std::vector<HighlightingToken> NonConflicting;
-    NonConflicting.reserve(Tokens.size());
-    for (ArrayRef<HighlightingToken> TokRef = Tokens; !TokRef.empty();) {
-      ArrayRef<HighlightingToken> Conflicting =
-          TokRef.take_while([&](const HighlightingToken &T) {
-            // TokRef is guaranteed at least one element here because otherwise
-            // this predicate would never fire.
-            return T.R == TokRef.front().R;
-          });
-      // If there is exactly one token with this range it's non conflicting and
-      // should be in the highlightings.
-      if (Conflicting.size() == 1)
-        NonConflicting.push_back(TokRef.front());
-      // TokRef[Conflicting.size()] is the next token with a different range (or
-      // the end of the Tokens).
-      TokRef = TokRef.drop_front(Conflicting.size());
-    }
-    return NonConflicting;
+  // Returns the tokens collected since the last call.
+  std::vector<HighlightingToken> takeTokens() {
+    std::vector<HighlightingToken> Result;
+    std::swap(Result, Tokens);
+    return Result;
+  }
+
+  // Collects the tokens of a namespace or a linkage specification, but not of
+  // the declarations in it.
+  void collectContextTokens(Decl *D) {
+    if (auto *ND = dyn_cast<NamespaceDecl>(D))
+      WalkUpFromNamespaceDecl(ND);
   }
 
   bool VisitNamespaceAliasDecl(NamespaceAliasDecl *NAD) {
@@ -258,6 +239,142 @@ private:
   }
 };
 
+// Adds the tokens that are not part of any declaration to \p Tokens, and sorts
+// and deduplicates them.
+std::vector<HighlightingToken>
+finishTokens(ParsedAST &AST, std::vector<HighlightingToken> Tokens) {
+  // Add highlightings for macro expansions as they are not traversed by the
+  // visitor.
+  for (const auto &M : AST.getMacros().Ranges)
+    Tokens.push_back({HighlightingKind::Macro, M});
+  // Initializer lists can give duplicates of tokens, therefore all tokens
+  // must be deduplicated.
+  llvm::sort(Tokens);
+  auto Last = std::unique(Tokens.begin(), Tokens.end());
+  Tokens.erase(Last, Tokens.end());
+  // Macros can give tokens that have the same source range but conflicting
+  // kinds. In this case all tokens sharing this source range should be
+  // removed.
+  std::vector<HighlightingToken> NonConflicting;
+  NonConflicting.reserve(Tokens.size());
+  for (ArrayRef<HighlightingToken> TokRef = Tokens; !TokRef.empty();) {
+    ArrayRef<HighlightingToken> Conflicting =
+        TokRef.take_while([&](const HighlightingToken &T) {
+          // TokRef is guaranteed at least one element here because otherwise
+          // this predicate would never fire.
+          return T.R == TokRef.front().R;
+        });
+    // If there is exactly one token with this range it's non conflicting and
+    // should be in the highlightings.
+    if (Conflicting.size() == 1)
+      NonConflicting.push_back(TokRef.front());
+    // TokRef[Conflicting.size()] is the next token with a different range (or
+    // the end of the Tokens).
+    TokRef = TokRef.drop_front(Conflicting.size());
+  }
+  return NonConflicting;
+}
+
+// Collects the tokens of the top-level declarations of an AST, and of the
+// declarations in the namespaces among them, reusing the tokens of the previous
+// AST for the declarations that can't have changed.
+//
+// The tokens of a declaration only depend on the preamble, on the files that
+// are included after it and on the text of the main file up to the end of the
+// declaration. The key of a declaration is a hash of the latter two, the cache
+// is dropped when the preamble changes.
+class IncrementalTokenCollector {
+public:
+  using TokenMap =
+      llvm::DenseMap<llvm::hash_code, std::vector<HighlightingToken>>;
+
+  IncrementalTokenCollector(ParsedAST &AST, TokenMap &OldTokensByDecl,
+                            std::vector<HighlightingToken> &Out)
+      : AST(AST), SM(AST.getSourceManager()), Collector(AST),
+        OldTokensByDecl(OldTokensByDecl), Out(Out),
+        MainCode(SM.getBufferData(SM.getMainFileID())) {
+    FileID MainFileID = SM.getMainFileID();
+    for (unsigned I = 0, E = SM.local_sloc_entry_size(); I != E; ++I) {
+      const SrcMgr::SLocEntry &Entry = SM.getLocalSLocEntry(I);
+      if (!Entry.isFile())
+        continue;
+      FileID FID = SM.getFileID(SourceLocation::getFromRawEncoding(
+          static_cast<unsigned>(Entry.getOffset())));
+      if (FID != MainFileID)
+        HashedCode = llvm::hash_combine(HashedCode, SM.getBufferData(FID));
+    }
+  }
+
+  void collect(Decl *D) {
+    if (isa<NamespaceDecl>(D) || isa<LinkageSpecDecl>(D)) {
+      Collector.collectContextTokens(D);
+      append(Collector.takeTokens());
+      for (Decl *Child : cast<DeclContext>(D)->decls())
+        if (!Collector.canIgnoreChildDeclWhileTraversingDeclContext(Child))
+          collect(Child);
+      return;
+    }
+    llvm::Optional<llvm::hash_code> Key = key(D);
+    if (Key) {
+      auto It = OldTokensByDecl.find(*Key);
+      if (It != OldTokensByDecl.end()) {
+        append(It->second);
+        NewTokensByDecl.insert({*Key, std::move(It->second)});
+        ++ReusedDecls;
+        return;
+      }
+    }
+    Collector.TraverseDecl(D);
+    std::vector<HighlightingToken> Tokens = Collector.takeTokens();
+    append(Tokens);
+    if (Key)
+      NewTokensByDecl.insert({*Key, std::move(Tokens)});
+  }
+
+  // Returns the tokens of the declarations of this AST, by key.
+  TokenMap takeTokensByDecl() { return std::move(NewTokensByDecl); }
+
+  unsigned reusedDecls() const { return ReusedDecls; }
+
+private:
+  void append(llvm::ArrayRef<HighlightingToken> Tokens) {
+    Out.insert(Out.end(), Tokens.begin(), Tokens.end());
+  }
+
+  // Returns the key of \p D, or None if its tokens are not cached because it
+  // is not in the main file.
+  llvm::Optional<llvm::hash_code> key(const Decl *D) {
+    SourceLocation Begin = SM.getExpansionLoc(D->getBeginLoc());
+    SourceLocation End = SM.getExpansionRange(D->getEndLoc()).getEnd();
+    if (!isInsideMainFile(Begin, SM) || !isInsideMainFile(End, SM))
+      return llvm::None;
+    End = Lexer::getLocForEndOfToken(End, 0, SM,
+                                     AST.getASTContext().getLangOpts());
+    if (End.isInvalid())
+      return llvm::None;
+    unsigned BeginOffset = SM.getFileOffset(Begin);
+    unsigned EndOffset = SM.getFileOffset(End);
+    if (EndOffset > HashedOffset) {
+      HashedCode = llvm::hash_combine(
+          HashedCode, MainCode.slice(HashedOffset, EndOffset));
+      HashedOffset = EndOffset;
+    }
+    return llvm::hash_combine(HashedCode, BeginOffset, EndOffset);
+  }
+
+  ParsedAST &AST;
+  const SourceManager &SM;
+  HighlightingTokenCollector Collector;
+  TokenMap &OldTokensByDecl;
+  std::vector<HighlightingToken> &Out;
+  llvm::StringRef MainCode;
+  // The hash of the included files and of the main file up to HashedOffset.
+  llvm::hash_code HashedCode = 0;
+  unsigned HashedOffset = 0;
+  TokenMap NewTokensByDecl;
+  unsigned ReusedDecls = 0;
+};
+
 // Encode binary data into base64.
 // This was copied from compiler-rt/lib/fuzzer/FuzzerUtil.cpp.
 // FIXME: Factor this out into llvm/Support?
@@ -408,8 +525,33 @@ bool operator==(const LineHighlightings &L, const LineHighlightings &R) {
   return std::tie(L.Line, L.Tokens) == std::tie(R.Line, R.Tokens);
 }
 
-std::vector<HighlightingToken> getSemanticHighlightings(ParsedAST &AST) {
-  return HighlightingTokenCollector(AST).collectTokens();
+unsigned SemanticHighlightingCache::reusedDecls() const {
+  std::lock_guard<std::mutex> Lock(Mu);
+  return ReusedDecls;
+}
+
+std::vector<HighlightingToken>
+getSemanticHighlightings(ParsedAST &AST, SemanticHighlightingCache *Cache) {
+  std::vector<HighlightingToken> Tokens;
+  // With delayed template parsing, the bodies of templates are parsed at the
+  // end of the file and may depend on the declarations that follow them.
+  if (!Cache || AST.getASTContext().getLangOpts().DelayedTemplateParsing) {
+    HighlightingTokenCollector Collector(AST);
+    Collector.TraverseAST(AST.getASTContext());
+    return finishTokens(AST, Collector.takeTokens());
+  }
+
+  std::lock_guard<std::mutex> Lock(Cache->Mu);
+  if (Cache->Preamble.lock() != AST.getPreamble()) {
+    Cache->TokensByDecl.clear();
+    Cache->Preamble = AST.getPreamble();
+  }
+  IncrementalTokenCollector Collector(AST, Cache->TokensByDecl, Tokens);
+  for (Decl *D : AST.getLocalTopLevelDecls())
+    Collector.collect(D);
+  Cache->TokensByDecl = Collector.takeTokensByDecl();
+  Cache->ReusedDecls = Collector.reusedDecls();
+  return finishTokens(AST, std::move(Tokens));
 }
 
 std::vector<SemanticHighlightingInformation>
@@ -18,11 +18,16 @@
 #define LLVM_CLANG_TOOLS_EXTRA_CLANGD_SEMANTICHIGHLIGHTING_H
 
 #include "Protocol.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/Support/raw_ostream.h"
+#include <memory>
+#include <mutex>
 
 namespace clang {
 namespace clangd {
 class ParsedAST;
+struct PreambleData;
 
 enum class HighlightingKind {
   Variable = 0,
@@ -63,9 +68,33 @@ struct LineHighlightings {
 
 bool operator==(const LineHighlightings &L, const LineHighlightings &R);
 
+/// Keeps the highlightings of the declarations of a file between the builds of
+/// its AST, so that the declarations which can't have changed are not
+/// traversed again. Declarations are reused when the preamble, the files
+/// included after it and the text of the main file up to their end are the
+/// same.
+class SemanticHighlightingCache {
+public:
+  /// The number of declarations whose highlightings were reused by the last
+  /// call to getSemanticHighlightings.
+  unsigned reusedDecls() const;
+
+private:
+  friend std::vector<HighlightingToken>
+  getSemanticHighlightings(ParsedAST &AST, SemanticHighlightingCache *Cache);
+
+  mutable std::mutex Mu;
+  std::weak_ptr<const PreambleData> Preamble;
+  llvm::DenseMap<llvm::hash_code, std::vector<HighlightingToken>> TokensByDecl;
+  unsigned ReusedDecls = 0;
+};
+
 // Returns all HighlightingTokens from an AST. Only generates highlights for the
-// main AST.
-std::vector<HighlightingToken> getSemanticHighlightings(ParsedAST &AST);
+// main AST. If \p Cache is set, the highlightings of the declarations that
+// did not change since the previous call are reused.
+std::vector<HighlightingToken>
+getSemanticHighlightings(ParsedAST &AST,
+                         SemanticHighlightingCache *Cache = nullptr);
 
 /// Converts a HighlightingKind to a corresponding TextMate scope
 /// (https://manual.macromates.com/en/language_grammars).
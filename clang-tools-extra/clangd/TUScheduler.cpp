@@ -53,6 +53,7 @@
 #include "index/CanonicalIncludes.h"
 #include "clang/Frontend/CompilerInvocation.h"
 #include "clang/Tooling/CompilationDatabase.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/ScopeExit.h"
 #include "llvm/Support/Errc.h"
@@ -80,40 +81,56 @@ llvm::Optional<llvm::StringRef> TUScheduler::getFileBeingProcessedInContext() {
 }
 
 /// An LRU cache of idle ASTs.
-/// Because we want to limit the overall number of these we retain, the cache
-/// owns ASTs (and may evict them) while their workers are idle.
+/// Because we want to limit the overall number and size of these we retain,
+/// the cache owns ASTs (and may evict them) while their workers are idle.
 /// Workers borrow ASTs when active, and return them when done.
 class TUScheduler::ASTCache {
 public:
   using Key = const ASTWorker *;
 
-  ASTCache(unsigned MaxRetainedASTs) : MaxRetainedASTs(MaxRetainedASTs) {}
+  ASTCache(const ASTRetentionPolicy &Policy)
+      : MaxRetainedASTs(Policy.MaxRetainedASTs),
+        MaxRetainedBytes(Policy.MaxRetainedASTBytes) {}
 
   /// Returns result of getUsedBytes() for the AST cached by \p K.
   /// If no AST is cached, 0 is returned.
   std::size_t getUsedBytes(Key K) {
     std::lock_guard<std::mutex> Lock(Mut);
     auto It = findByKey(K);
-    if (It == LRU.end() || !It->second)
+    if (It == LRU.end())
       return 0;
-    return It->second->getUsedBytes();
+    return It->Bytes;
   }
 
-  /// Store the value in the pool, possibly removing the last used AST.
+  /// Returns the total getUsedBytes() of the cached ASTs.
+  std::size_t getTotalBytes() {
+    std::lock_guard<std::mutex> Lock(Mut);
+    return TotalBytes;
+  }
+
+  /// Store the value in the pool, possibly removing the last used ASTs.
   /// The value should not be in the pool when this function is called.
   void put(Key K, std::unique_ptr<ParsedAST> V) {
+    // Measuring the AST walks its allocators, do it outside the lock.
+    std::size_t Bytes = V ? V->getUsedBytes() : 0;
     std::unique_lock<std::mutex> Lock(Mut);
     assert(findByKey(K) == LRU.end());
 
-    LRU.insert(LRU.begin(), {K, std::move(V)});
-    if (LRU.size() <= MaxRetainedASTs)
-      return;
-    // We're past the limit, remove the last element.
-    std::unique_ptr<ParsedAST> ForCleanup = std::move(LRU.back().second);
-    LRU.pop_back();
-    // Run the expensive destructor outside the lock.
+    LRU.insert(LRU.begin(), {K, std::move(V), Bytes});
+    TotalBytes += Bytes;
+    std::vector<std::unique_ptr<ParsedAST>> ForCleanup;
+    while (!LRU.empty() &&
+           (LRU.size() > MaxRetainedASTs ||
+            (LRU.size() > 1 && MaxRetainedBytes &&
+             TotalBytes > MaxRetainedBytes))) {
+      // We're past the limit, remove the last element.
+      TotalBytes -= LRU.back().Bytes;
+      ForCleanup.push_back(std::move(LRU.back().AST));
+      LRU.pop_back();
+    }
+    // Run the expensive destructors outside the lock.
     Lock.unlock();
-    ForCleanup.reset();
+    ForCleanup.clear();
   }
 
   /// Returns the cached value for \p K, or llvm::None if the value is not in
@@ -124,7 +141,8 @@ public:
     auto Existing = findByKey(K);
     if (Existing == LRU.end())
       return None;
-    std::unique_ptr<ParsedAST> V = std::move(Existing->second);
+    std::unique_ptr<ParsedAST> V = std::move(Existing->AST);
+    TotalBytes -= Existing->Bytes;
     LRU.erase(Existing);
     // GCC 4.8 fails to compile `return V;`, as it tries to call the copy
     // constructor of unique_ptr, so we call the move ctor explicitly to avoid
@@ -133,17 +151,24 @@ public:
   }
 
 private:
-  using KVPair = std::pair<Key, std::unique_ptr<ParsedAST>>;
+  struct Entry {
+    Key K;
+    std::unique_ptr<ParsedAST> AST;
+    /// The result of getUsedBytes(), which doesn't change while it is idle.
+    std::size_t Bytes;
+  };
 
-  std::vector<KVPair>::iterator findByKey(Key K) {
-    return llvm::find_if(LRU, [K](const KVPair &P) { return P.first == K; });
+  std::vector<Entry>::iterator findByKey(Key K) {
+    return llvm::find_if(LRU, [K](const Entry &E) { return E.K == K; });
   }
 
   std::mutex Mut;
   unsigned MaxRetainedASTs;
+  std::size_t MaxRetainedBytes;
   /// Items sorted in LRU order, i.e. first item is the most recently accessed
   /// one.
-  std::vector<KVPair> LRU; /* GUARDED_BY(Mut) */
+  std::vector<Entry> LRU;     /* GUARDED_BY(Mut) */
+  std::size_t TotalBytes = 0; /* GUARDED_BY(Mut) */
 };
 
 namespace {
@@ -162,7 +187,8 @@ class ASTWorkerHandle;
 class ASTWorker {
   friend class ASTWorkerHandle;
   ASTWorker(PathRef FileName, const GlobalCompilationDatabase &CDB,
-            TUScheduler::ASTCache &LRUCache, Semaphore &Barrier, bool RunSync,
+            TUScheduler::ASTCache &LRUCache, PreambleCache &Preambles,
+            Semaphore &Barrier, bool RunSync,
             steady_clock::duration UpdateDebounce, bool StorePreamblesInMemory,
             ParsingCallbacks &Callbacks);
 
@@ -174,12 +200,16 @@ public:
   /// request, it is used to limit the number of actively running threads.
   static ASTWorkerHandle
   create(PathRef FileName, const GlobalCompilationDatabase &CDB,
-         TUScheduler::ASTCache &IdleASTs, AsyncTaskRunner *Tasks,
-         Semaphore &Barrier, steady_clock::duration UpdateDebounce,
-         bool StorePreamblesInMemory, ParsingCallbacks &Callbacks);
+         TUScheduler::ASTCache &IdleASTs, PreambleCache &Preambles,
+         AsyncTaskRunner *Tasks, Semaphore &Barrier,
+         steady_clock::duration UpdateDebounce, bool StorePreamblesInMemory,
+         ParsingCallbacks &Callbacks);
   ~ASTWorker();
 
-  void update(ParseInputs Inputs, WantDiagnostics);
+  /// If \p PatchPreamble is true and the preamble must be rebuilt, an AST is
+  /// first built with the old preamble and a PreamblePatch, and the preamble
+  /// is rebuilt by a separate request.
+  void update(ParseInputs Inputs, WantDiagnostics, bool PatchPreamble = true);
   void
   runWithAST(llvm::StringRef Name,
              llvm::unique_function<void(llvm::Expected<InputsAndAST>)> Action);
@@ -239,6 +269,8 @@ private:
 
   /// Handles retention of ASTs.
   TUScheduler::ASTCache &IdleASTs;
+  /// Preambles shared with the other workers.
+  PreambleCache &Preambles;
   const bool RunSync;
   /// Time to wait after an update to see whether another update obsoletes it.
   const steady_clock::duration UpdateDebounce;
@@ -324,12 +356,13 @@ private:
 
 ASTWorkerHandle
 ASTWorker::create(PathRef FileName, const GlobalCompilationDatabase &CDB,
-                  TUScheduler::ASTCache &IdleASTs, AsyncTaskRunner *Tasks,
-                  Semaphore &Barrier, steady_clock::duration UpdateDebounce,
+                  TUScheduler::ASTCache &IdleASTs, PreambleCache &Preambles,
+                  AsyncTaskRunner *Tasks, Semaphore &Barrier,
+                  steady_clock::duration UpdateDebounce,
                   bool StorePreamblesInMemory, ParsingCallbacks &Callbacks) {
-  std::shared_ptr<ASTWorker> Worker(
-      new ASTWorker(FileName, CDB, IdleASTs, Barrier, /*RunSync=*/!Tasks,
-                    UpdateDebounce, StorePreamblesInMemory, Callbacks));
+  std::shared_ptr<ASTWorker> Worker(new ASTWorker(
+      FileName, CDB, IdleASTs, Preambles, Barrier, /*RunSync=*/!Tasks,
+      UpdateDebounce, StorePreamblesInMemory, Callbacks));
   if (Tasks)
     Tasks->runAsync("worker:" + llvm::sys::path::filename(FileName),
                     [Worker]() { Worker->run(); });
@@ -338,10 +371,12 @@ ASTWorker::create(PathRef FileName, const GlobalCompilationDatabase &CDB,
 }
 
 ASTWorker::ASTWorker(PathRef FileName, const GlobalCompilationDatabase &CDB,
-                     TUScheduler::ASTCache &LRUCache, Semaphore &Barrier,
-                     bool RunSync, steady_clock::duration UpdateDebounce,
+                     TUScheduler::ASTCache &LRUCache, PreambleCache &Preambles,
+                     Semaphore &Barrier, bool RunSync,
+                     steady_clock::duration UpdateDebounce,
                      bool StorePreamblesInMemory, ParsingCallbacks &Callbacks)
-    : IdleASTs(LRUCache), RunSync(RunSync), UpdateDebounce(UpdateDebounce),
+    : IdleASTs(LRUCache), Preambles(Preambles), RunSync(RunSync),
+      UpdateDebounce(UpdateDebounce),
       FileName(FileName), CDB(CDB),
       StorePreambleInMemory(StorePreamblesInMemory),
       Callbacks(Callbacks), Status{TUAction(TUAction::Idle, ""),
@@ -365,9 +400,15 @@ ASTWorker::~ASTWorker() {
 #endif
 }
 
-void ASTWorker::update(ParseInputs Inputs, WantDiagnostics WantDiags) {
+void ASTWorker::update(ParseInputs Inputs, WantDiagnostics WantDiags,
+                       bool PatchPreamble) {
   llvm::StringRef TaskName = "Update";
   auto Task = [=]() mutable {
+    // The rebuild of a patched preamble is obsolete once a later update
+    // changed the file, that update takes care of the preamble instead.
+    if (!PatchPreamble && getCurrentFileInputs()->Contents != Inputs.Contents)
+      return;
+
     auto RunPublish = [&](llvm::function_ref<void()> Publish) {
       // Ensure we only publish results from the worker if the file was not
       // removed, making sure there are not race conditions.
@@ -428,13 +469,42 @@ void ASTWorker::update(ParseInputs Inputs, WantDiagnostics WantDiags) {
 
     std::shared_ptr<const PreambleData> OldPreamble =
         getPossiblyStalePreamble();
+
+    // Rebuilding the preamble takes much longer than building the AST, so
+    // publish the diagnostics of the old preamble with a patch for the new
+    // directives first. The rebuild is a separate request, which lets the
+    // reads scheduled meanwhile use the patched AST rather than wait.
+    if (PatchPreamble && OldPreamble && WantDiags != WantDiagnostics::No &&
+        OldCommand == Inputs.CompileCommand &&
+        !isPreambleCompatible(*OldPreamble, FileName, Inputs, *Invocation)) {
+      IdleASTs.take(this);
+      emitTUStatus({TUAction::BuildingFile, TaskName});
+      PreamblePatch Patch =
+          PreamblePatch::create(FileName, Inputs, *Invocation, *OldPreamble);
+      auto PatchedInvocation =
+          std::make_unique<CompilerInvocation>(*Invocation);
+      Patch.apply(*PatchedInvocation);
+      llvm::Optional<ParsedAST> PatchedAST =
+          buildAST(FileName, std::move(PatchedInvocation),
+                   CompilerInvocationDiags, Inputs, OldPreamble);
+      if (PatchedAST) {
+        trace::Span Span("Running main AST callback");
+        Callbacks.onMainAST(FileName, *PatchedAST, RunPublish);
+        RanASTCallback = true;
+        IdleASTs.put(this, std::make_unique<ParsedAST>(std::move(*PatchedAST)));
+      }
+      update(std::move(Inputs), WantDiags, /*PatchPreamble=*/false);
+      return;
+    }
+
     std::shared_ptr<const PreambleData> NewPreamble = buildPreamble(
         FileName, *Invocation, OldPreamble, OldCommand, Inputs,
         StorePreambleInMemory,
         [this](ASTContext &Ctx, std::shared_ptr<clang::Preprocessor> PP,
                const CanonicalIncludes &CanonIncludes) {
           Callbacks.onPreambleAST(FileName, Ctx, std::move(PP), CanonIncludes);
-        });
+        },
+        &Preambles);
 
     bool CanReuseAST = InputsAreTheSame && (OldPreamble == NewPreamble);
     {
@@ -519,7 +589,24 @@ void ASTWorker::update(ParseInputs Inputs, WantDiagnostics WantDiags) {
     // Stash the AST in the cache for further use.
     IdleASTs.put(this, std::move(*AST));
   };
-  startTask(TaskName, std::move(Task), WantDiags);
+  if (PatchPreamble) {
+    startTask(TaskName, std::move(Task), WantDiags);
+    return;
+  }
+  // The rebuild is scheduled by the worker thread, after stop() may have been
+  // called. It is not an update for the purpose of skipping either: it must
+  // neither be skipped, nor make the updates before it be skipped.
+  if (RunSync)
+    return startTask(TaskName, std::move(Task), None);
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (Done)
+      return;
+    Requests.push_back(
+        {std::move(Task), TaskName, steady_clock::now(),
+         Context::current().derive(kFileBeingProcessed, FileName), None});
+  }
+  RequestsCV.notify_all();
 }
 
 void ASTWorker::runWithAST(
@@ -851,7 +938,8 @@ TUScheduler::TUScheduler(const GlobalCompilationDatabase &CDB,
       Callbacks(Callbacks ? move(Callbacks)
                           : std::make_unique<ParsingCallbacks>()),
       Barrier(AsyncThreadsCount),
-      IdleASTs(std::make_unique<ASTCache>(RetentionPolicy.MaxRetainedASTs)),
+      IdleASTs(std::make_unique<ASTCache>(RetentionPolicy)),
+      Preambles(std::make_unique<PreambleCache>()),
       UpdateDebounce(UpdateDebounce) {
   if (0 < AsyncThreadsCount) {
     PreambleTasks.emplace();
@@ -887,7 +975,7 @@ bool TUScheduler::update(PathRef File, ParseInputs Inputs,
   if (!FD) {
     // Create a new worker to process the AST-related tasks.
     ASTWorkerHandle Worker = ASTWorker::create(
-        File, CDB, *IdleASTs,
+        File, CDB, *IdleASTs, *Preambles,
         WorkerThreads ? WorkerThreads.getPointer() : nullptr, Barrier,
         UpdateDebounce, StorePreamblesInMemory, *Callbacks);
     FD = std::unique_ptr<FileData>(
@@ -1010,6 +1098,21 @@ TUScheduler::getUsedBytesPerFile() const {
   return Result;
 }
 
+std::size_t TUScheduler::getUsedPreambleBytes() const {
+  llvm::DenseSet<const PreambleData *> Seen;
+  std::size_t Result = 0;
+  for (auto &&PathAndFile : Files) {
+    auto Preamble = PathAndFile.second->Worker->getPossiblyStalePreamble();
+    if (Preamble && Seen.insert(Preamble.get()).second)
+      Result += Preamble->Preamble.getSize();
+  }
+  return Result;
+}
+
+std::size_t TUScheduler::getUsedASTBytes() const {
+  return IdleASTs->getTotalBytes();
+}
+
 std::vector<Path> TUScheduler::getFilesWithCachedAST() const {
   std::vector<Path> Result;
   for (auto &&PathAndFile : Files) {
@@ -24,6 +24,7 @@
 namespace clang {
 namespace clangd {
 class ParsedAST;
+class PreambleCache;
 struct PreambleData;
 
 /// Returns a number of a default async threads to use for TUScheduler.
@@ -58,6 +59,10 @@ struct ASTRetentionPolicy {
   /// Maximum number of ASTs to be retained in memory when there are no pending
   /// requests for them.
   unsigned MaxRetainedASTs = 3;
+  /// Maximum total size of the ASTs retained when there are no pending
+  /// requests for them, as estimated by ParsedAST::getUsedBytes(). The most
+  /// recently used AST is always retained. 0 means no limit.
+  std::size_t MaxRetainedASTBytes = 0;
 };
 
 struct TUAction {
@@ -157,6 +162,13 @@ public:
   /// The order of results is unspecified.
   std::vector<std::pair<Path, std::size_t>> getUsedBytesPerFile() const;
 
+  /// Returns estimated memory usage of the preambles of the open files.
+  /// A preamble shared by several files is only counted once.
+  std::size_t getUsedPreambleBytes() const;
+
+  /// Returns estimated memory usage of the idle ASTs of the open files.
+  std::size_t getUsedASTBytes() const;
+
   /// Returns a list of files with ASTs currently stored in memory. This method
   /// is not very reliable and is only used for test. E.g., the results will not
   /// contain files that currently run something over their AST.
@@ -251,6 +263,8 @@ private:
   Semaphore Barrier;
   llvm::StringMap<std::unique_ptr<FileData>> Files;
   std::unique_ptr<ASTCache> IdleASTs;
+  /// Preambles shared by the files that have the same preamble.
+  std::unique_ptr<PreambleCache> Preambles;
   // None when running tasks synchronously and non-None when running tasks
   // asynchronously.
   llvm::Optional<AsyncTaskRunner> PreambleTasks;
@@ -8,6 +8,8 @@
 
 #include "../index/Serialization.h"
 #include "../index/dex/Dex.h"
+#include "../index/dex/Iterator.h"
+#include "../index/dex/PostingList.h"
 #include "benchmark/benchmark.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
@@ -83,6 +85,27 @@ static void DexQueries(benchmark::State &State) {
 }
 BENCHMARK(DexQueries);
 
+// Intersects a dense and a sparse posting list, as the trigrams of a query
+// are, to track the cost of advanceTo() on its own.
+static void DexIntersection(benchmark::State &State) {
+  constexpr dex::DocID Size = 1000000;
+  std::vector<dex::DocID> Dense, Sparse;
+  for (dex::DocID ID = 0; ID < Size; ID += 3)
+    Dense.push_back(ID);
+  for (dex::DocID ID = 0; ID < Size; ID += 97)
+    Sparse.push_back(ID);
+  const dex::PostingList DenseList(Dense), SparseList(Sparse);
+  const dex::Corpus Corpus(Size);
+  for (auto _ : State) {
+    std::vector<std::unique_ptr<dex::Iterator>> Children;
+    Children.push_back(DenseList.iterator());
+    Children.push_back(SparseList.iterator());
+    auto And = Corpus.intersect(std::move(Children));
+    benchmark::DoNotOptimize(dex::consume(*And).size());
+  }
+}
+BENCHMARK(DexIntersection);
+
 } // namespace
 } // namespace clangd
 } // namespace clang
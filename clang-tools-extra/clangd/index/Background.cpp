@@ -201,11 +201,14 @@ BackgroundIndex::indexFileTask(tooling::CompileCommand Cmd) {
   });
   T.QueuePri = IndexFile;
   T.Tag = filenameWithoutExtension(Cmd.Filename);
+  T.Directory = llvm::sys::path::parent_path(getAbsolutePath(Cmd));
   return T;
 }
 
 void BackgroundIndex::boostRelated(llvm::StringRef Path) {
   namespace types = clang::driver::types;
+  // The files next to the ones the user works on are likely to be used next.
+  Queue.boostDirectory(llvm::sys::path::parent_path(Path), IndexNearbyFile);
   auto Type =
       types::lookupTypeForExtension(llvm::sys::path::extension(Path).substr(1));
   // is this a header?
@@ -213,6 +216,12 @@ void BackgroundIndex::boostRelated(llvm::StringRef Path) {
     Queue.boost(filenameWithoutExtension(Path), IndexBoostedFile);
 }
 
+void BackgroundIndex::pauseForEdit() {
+  // Long enough to cover the requests that follow an edit, e.g. completion.
+  constexpr std::chrono::milliseconds PauseAfterEdit(500);
+  Queue.pauseUntil(std::chrono::steady_clock::now() + PauseAfterEdit);
+}
+
 /// Given index results from a TU, only update symbols coming from files that
 /// are different or missing from than \p ShardVersionsSnapshot. Also stores new
 /// index information on IndexStorage.
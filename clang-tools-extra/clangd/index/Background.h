@@ -23,6 +23,7 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Threading.h"
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <mutex>
@@ -74,6 +75,7 @@ public:
     llvm::ThreadPriority ThreadPri = llvm::ThreadPriority::Background;
     unsigned QueuePri = 0; // Higher-priority tasks will run first.
     std::string Tag;       // Allows priority to be boosted later.
+    std::string Directory; // Allows priority to be boosted by directory.
 
     bool operator<(const Task &O) const { return QueuePri < O.QueuePri; }
   };
@@ -85,6 +87,12 @@ public:
   // lower priority.
   // Reducing the boost of a tag affects future tasks but not current ones.
   void boost(llvm::StringRef Tag, unsigned NewPriority);
+  // Same as boost(), for the tasks with a matching Directory.
+  void boostDirectory(llvm::StringRef Directory, unsigned NewPriority);
+
+  // Don't start any task before Until, e.g. while the user is typing, so that
+  // interactive requests get the CPU. Running tasks are not interrupted.
+  void pauseUntil(std::chrono::steady_clock::time_point Until);
 
   // Process items on the queue until the queue is stopped.
   // If the queue becomes empty, OnIdle will be called (on one worker).
@@ -106,6 +114,12 @@ private:
   bool ShouldStop = false;
   std::vector<Task> Queue; // max-heap
   llvm::StringMap<unsigned> Boosts;
+  llvm::StringMap<unsigned> DirectoryBoosts;
+  std::chrono::steady_clock::time_point PausedUntil;
+
+  unsigned boostedPriority(const Task &T) const;
+  void boost(llvm::StringMap<unsigned> &Boosts, llvm::StringRef Key,
+             std::string Task::*KeyOf, unsigned NewPriority);
 };
 
 // Builds an in-memory index by by running the static indexer action over
@@ -131,10 +145,15 @@ public:
     Queue.push(changedFilesTask(ChangedFiles));
   }
 
-  /// Boosts priority of indexing related to Path.
-  /// Typically used to index TUs when headers are opened.
+  /// Boosts priority of indexing related to Path, i.e. of the files in its
+  /// directory and, if it is a header, of the TUs with the same file name.
+  /// Typically used when files are opened.
   void boostRelated(llvm::StringRef Path);
 
+  /// Pauses indexing for a short while, as the user edited a file and expects
+  /// quick responses to the requests that follow.
+  void pauseForEdit();
+
   // Cause background threads to stop after ther current task, any remaining
   // tasks will be discarded.
   void stop() {
@@ -186,6 +205,7 @@ private:
   // from lowest to highest priority
   enum QueuePriority {
     IndexFile,
+    IndexNearbyFile,
     IndexBoostedFile,
     LoadShards,
   };
@@ -16,6 +16,8 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include <string>
 #include <utility>
 #include <vector>
@@ -30,18 +32,19 @@ class BackgroundIndexLoader {
 public:
   BackgroundIndexLoader(BackgroundIndexStorage::Factory &IndexStorageFactory)
       : IndexStorageFactory(IndexStorageFactory) {}
-  /// Load the shards for \p MainFile and all of its dependencies.
-  void load(PathRef MainFile);
+  /// Load the shards for \p MainFiles and all of their dependencies.
+  void load(llvm::ArrayRef<Path> MainFiles);
 
   /// Consumes the loader and returns all shards.
   std::vector<LoadedShard> takeResult() &&;
 
 private:
-  /// Returns the Shard for \p StartSourceFile from cache or loads it from \p
-  /// Storage. Also returns paths for dependencies of \p StartSourceFile if it
-  /// wasn't cached yet.
-  std::pair<const LoadedShard &, std::vector<Path>>
-  loadShard(PathRef StartSourceFile, PathRef DependentTU);
+  /// Loads the shard for \p LS.AbsolutePath from storage into \p LS, and
+  /// returns the paths of its dependencies. Thread-safe.
+  std::vector<Path> loadShard(LoadedShard &LS);
+
+  /// Returns the entry for \p SourceFile if it is not in the cache yet.
+  LoadedShard *addShard(PathRef SourceFile, PathRef DependentTU);
 
   /// Cache for Storage lookups.
   llvm::StringMap<LoadedShard> LoadedShards;
@@ -49,33 +52,24 @@ private:
   BackgroundIndexStorage::Factory &IndexStorageFactory;
 };
 
-std::pair<const LoadedShard &, std::vector<Path>>
-BackgroundIndexLoader::loadShard(PathRef StartSourceFile, PathRef DependentTU) {
-  auto It = LoadedShards.try_emplace(StartSourceFile);
-  LoadedShard &LS = It.first->getValue();
+std::vector<Path> BackgroundIndexLoader::loadShard(LoadedShard &LS) {
   std::vector<Path> Edges = {};
-  // Return the cached shard.
-  if (!It.second)
-    return {LS, Edges};
-
-  LS.AbsolutePath = StartSourceFile.str();
-  LS.DependentTU = DependentTU;
   BackgroundIndexStorage *Storage = IndexStorageFactory(LS.AbsolutePath);
-  auto Shard = Storage->loadShard(StartSourceFile);
+  auto Shard = Storage->loadShard(LS.AbsolutePath);
   if (!Shard || !Shard->Sources) {
-    vlog("Failed to load shard: {0}", StartSourceFile);
-    return {LS, Edges};
+    vlog("Failed to load shard: {0}", LS.AbsolutePath);
+    return Edges;
   }
 
   LS.Shard = std::move(Shard);
   for (const auto &It : *LS.Shard->Sources) {
-    auto AbsPath = URI::resolve(It.getKey(), StartSourceFile);
+    auto AbsPath = URI::resolve(It.getKey(), LS.AbsolutePath);
     if (!AbsPath) {
       elog("Failed to resolve URI: {0}", AbsPath.takeError());
       continue;
     }
     // A shard contains only edges for non main-file sources.
-    if (*AbsPath != StartSourceFile) {
+    if (*AbsPath != LS.AbsolutePath) {
       Edges.push_back(*AbsPath);
       continue;
     }
@@ -87,26 +81,44 @@ BackgroundIndexLoader::loadShard(PathRef StartSourceFile, PathRef DependentTU) {
     LS.HadErrors = IGN.Flags & IncludeGraphNode::SourceFlag::HadErrors;
   }
   assert(LS.Digest != FileDigest{{0}} && "Digest is empty?");
-  return {LS, Edges};
+  return Edges;
 }
 
-void BackgroundIndexLoader::load(PathRef MainFile) {
-  llvm::StringSet<> InQueue;
-  // Following containers points to strings inside InQueue.
-  std::queue<PathRef> ToVisit;
-  InQueue.insert(MainFile);
-  ToVisit.push(MainFile);
-
-  while (!ToVisit.empty()) {
-    PathRef SourceFile = ToVisit.front();
-    ToVisit.pop();
-
-    auto ShardAndEdges = loadShard(SourceFile, MainFile);
-    for (PathRef Edge : ShardAndEdges.second) {
-      auto It = InQueue.insert(Edge);
-      if (It.second)
-        ToVisit.push(It.first->getKey());
-    }
+LoadedShard *BackgroundIndexLoader::addShard(PathRef SourceFile,
+                                             PathRef DependentTU) {
+  auto It = LoadedShards.try_emplace(SourceFile);
+  if (!It.second)
+    return nullptr;
+  LoadedShard &LS = It.first->getValue();
+  LS.AbsolutePath = SourceFile.str();
+  LS.DependentTU = DependentTU;
+  return &LS;
+}
+
+void BackgroundIndexLoader::load(llvm::ArrayRef<Path> MainFiles) {
+  // Reading and parsing the shards dominate the startup of a large project, so
+  // the include graphs are walked breadth-first, loading all the shards of a
+  // level in parallel. The entries of the StringMap don't move as it grows.
+  std::vector<LoadedShard *> ToLoad;
+  for (PathRef MainFile : MainFiles) {
+    assert(llvm::sys::path::is_absolute(MainFile));
+    if (LoadedShard *LS = addShard(MainFile, MainFile))
+      ToLoad.push_back(LS);
+  }
+
+  llvm::ThreadPool Pool(llvm::heavyweight_hardware_concurrency());
+  while (!ToLoad.empty()) {
+    std::vector<std::vector<Path>> Edges(ToLoad.size());
+    for (size_t I = 0; I < ToLoad.size(); ++I)
+      Pool.async([&, I] { Edges[I] = loadShard(*ToLoad[I]); });
+    Pool.wait();
+
+    std::vector<LoadedShard *> NextLevel;
+    for (size_t I = 0; I < ToLoad.size(); ++I)
+      for (PathRef Edge : Edges[I])
+        if (LoadedShard *LS = addShard(Edge, ToLoad[I]->DependentTU))
+          NextLevel.push_back(LS);
+    ToLoad = std::move(NextLevel);
   }
 }
 
@@ -124,10 +136,7 @@ loadIndexShards(llvm::ArrayRef<Path> MainFiles,
                 BackgroundIndexStorage::Factory &IndexStorageFactory,
                 const GlobalCompilationDatabase &CDB) {
   BackgroundIndexLoader Loader(IndexStorageFactory);
-  for (llvm::StringRef MainFile : MainFiles) {
-    assert(llvm::sys::path::is_absolute(MainFile));
-    Loader.load(MainFile);
-  }
+  Loader.load(MainFiles);
   return std::move(Loader).takeResult();
 }
 
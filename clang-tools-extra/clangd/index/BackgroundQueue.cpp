@@ -22,7 +22,13 @@ void BackgroundQueue::work(std::function<void()> OnIdle) {
     llvm::Optional<Task> Task;
     {
       std::unique_lock<std::mutex> Lock(Mu);
-      CV.wait(Lock, [&] { return ShouldStop || !Queue.empty(); });
+      while (true) {
+        CV.wait(Lock, [&] { return ShouldStop || !Queue.empty(); });
+        if (ShouldStop || std::chrono::steady_clock::now() >= PausedUntil)
+          break;
+        // Another worker may take the task meanwhile, check again afterwards.
+        CV.wait_until(Lock, PausedUntil);
+      }
       if (ShouldStop) {
         Queue.clear();
         CV.notify_all();
@@ -67,7 +73,7 @@ void BackgroundQueue::stop() {
 void BackgroundQueue::push(Task T) {
   {
     std::lock_guard<std::mutex> Lock(Mu);
-    T.QueuePri = std::max(T.QueuePri, Boosts.lookup(T.Tag));
+    T.QueuePri = boostedPriority(T);
     Queue.push_back(std::move(T));
     std::push_heap(Queue.begin(), Queue.end());
   }
@@ -78,16 +84,33 @@ void BackgroundQueue::append(std::vector<Task> Tasks) {
   {
     std::lock_guard<std::mutex> Lock(Mu);
     for (Task &T : Tasks)
-      T.QueuePri = std::max(T.QueuePri, Boosts.lookup(T.Tag));
+      T.QueuePri = boostedPriority(T);
     std::move(Tasks.begin(), Tasks.end(), std::back_inserter(Queue));
     std::make_heap(Queue.begin(), Queue.end());
   }
   CV.notify_all();
 }
 
+unsigned BackgroundQueue::boostedPriority(const Task &T) const {
+  return std::max(
+      {T.QueuePri, Boosts.lookup(T.Tag), DirectoryBoosts.lookup(T.Directory)});
+}
+
 void BackgroundQueue::boost(llvm::StringRef Tag, unsigned NewPriority) {
   std::lock_guard<std::mutex> Lock(Mu);
-  unsigned &Boost = Boosts[Tag];
+  boost(Boosts, Tag, &Task::Tag, NewPriority);
+}
+
+void BackgroundQueue::boostDirectory(llvm::StringRef Directory,
+                                     unsigned NewPriority) {
+  std::lock_guard<std::mutex> Lock(Mu);
+  boost(DirectoryBoosts, Directory, &Task::Directory, NewPriority);
+}
+
+void BackgroundQueue::boost(llvm::StringMap<unsigned> &Boosts,
+                            llvm::StringRef Key, std::string Task::*KeyOf,
+                            unsigned NewPriority) {
+  unsigned &Boost = Boosts[Key];
   bool Increase = NewPriority > Boost;
   Boost = NewPriority;
   if (!Increase)
@@ -95,7 +118,7 @@ void BackgroundQueue::boost(llvm::StringRef Tag, unsigned NewPriority) {
 
   unsigned Changes = 0;
   for (Task &T : Queue)
-    if (Tag == T.Tag && NewPriority > T.QueuePri) {
+    if (Key == T.*KeyOf && NewPriority > T.QueuePri) {
       T.QueuePri = NewPriority;
       ++Changes;
     }
@@ -104,6 +127,12 @@ void BackgroundQueue::boost(llvm::StringRef Tag, unsigned NewPriority) {
   // No need to signal, only rearranged items in the queue.
 }
 
+void BackgroundQueue::pauseUntil(std::chrono::steady_clock::time_point Until) {
+  std::lock_guard<std::mutex> Lock(Mu);
+  PausedUntil = std::max(PausedUntil, Until);
+  // No need to signal, the workers check the pause before running a task.
+}
+
 bool BackgroundQueue::blockUntilIdleForTest(
     llvm::Optional<double> TimeoutSeconds) {
   std::unique_lock<std::mutex> Lock(Mu);
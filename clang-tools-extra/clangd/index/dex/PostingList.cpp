@@ -26,7 +26,7 @@ public:
   explicit ChunkIterator(const Token *Tok, llvm::ArrayRef<Chunk> Chunks)
       : Tok(Tok), Chunks(Chunks), CurrentChunk(Chunks.begin()) {
     if (!Chunks.empty()) {
-      DecompressedChunk = CurrentChunk->decompress();
+      CurrentChunk->decompress(DecompressedChunk);
       CurrentID = DecompressedChunk.begin();
     }
   }
@@ -41,17 +41,19 @@ public:
     normalizeCursor();
   }
 
-  /// Applies binary search to advance cursor to the next item with DocID
-  /// equal or higher than the given one.
+  /// Advances cursor to the next item with DocID equal or higher than the
+  /// given one.
   void advanceTo(DocID ID) override {
     assert(!reachedEnd() &&
            "Posting List iterator can't advance() at the end.");
     if (ID <= peek())
       return;
     advanceToChunk(ID);
-    // Try to find ID within current chunk.
-    CurrentID = std::partition_point(CurrentID, DecompressedChunk.end(),
-                                     [&](const DocID D) { return D < ID; });
+    // Try to find ID within current chunk. Chunks hold at most 29 items, so
+    // counting the smaller ones is faster than a binary search: the loop has
+    // no branch to mispredict and is vectorized.
+    CurrentID += std::count_if(CurrentID, DecompressedChunk.end(),
+                               [&](const DocID D) { return D < ID; });
     normalizeCursor();
   }
 
@@ -94,7 +96,7 @@ private:
     ++CurrentChunk;
     if (CurrentChunk == Chunks.end()) // Reached the end of PostingList.
       return;
-    DecompressedChunk = CurrentChunk->decompress();
+    CurrentChunk->decompress(DecompressedChunk);
     CurrentID = DecompressedChunk.begin();
   }
 
@@ -102,11 +104,19 @@ private:
   void advanceToChunk(DocID ID) {
     if ((CurrentChunk != Chunks.end() - 1) &&
         ((CurrentChunk + 1)->Head <= ID)) {
-      CurrentChunk =
-          std::partition_point(CurrentChunk + 1, Chunks.end(),
-                               [&](const Chunk &C) { return C.Head < ID; });
+      // In an intersection the target is usually a few chunks ahead, so gallop
+      // with growing steps to bound the binary search instead of searching all
+      // the remaining chunks. All the chunks before Lo start before ID, and Hi
+      // is the end or starts at or after ID.
+      auto Lo = CurrentChunk + 1, Hi = Lo;
+      for (size_t Step = 1; Hi != Chunks.end() && Hi->Head < ID; Step *= 2) {
+        Lo = Hi + 1;
+        Hi = Lo + std::min<size_t>(Step, Chunks.end() - Lo);
+      }
+      CurrentChunk = std::partition_point(
+          Lo, Hi, [&](const Chunk &C) { return C.Head < ID; });
       --CurrentChunk;
-      DecompressedChunk = CurrentChunk->decompress();
+      CurrentChunk->decompress(DecompressedChunk);
       CurrentID = DecompressedChunk.begin();
     }
   }
@@ -182,38 +192,33 @@ std::vector<Chunk> encodeStream(llvm::ArrayRef<DocID> Documents) {
   return std::vector<Chunk>(Result); // no move, shrink-to-fit
 }
 
-/// Reads variable length DocID from the buffer and updates the buffer size. If
-/// the stream is terminated, return None.
-llvm::Optional<DocID> readVByte(llvm::ArrayRef<uint8_t> &Bytes) {
-  if (Bytes.front() == 0 || Bytes.empty())
-    return None;
-  DocID Result = 0;
-  bool HasNextByte = true;
-  for (size_t Length = 0; HasNextByte && !Bytes.empty(); ++Length) {
-    assert(Length <= 5 && "Malformed VByte encoding sequence.");
-    // Write meaningful bits to the correct place in the document decoding.
-    Result |= (Bytes.front() & 0x7f) << (BitsPerEncodingByte * Length);
-    if ((Bytes.front() & 0x80) == 0)
-      HasNextByte = false;
-    Bytes = Bytes.drop_front();
-  }
-  return Result;
-}
-
 } // namespace
 
 llvm::SmallVector<DocID, Chunk::PayloadSize + 1> Chunk::decompress() const {
-  llvm::SmallVector<DocID, Chunk::PayloadSize + 1> Result{Head};
-  llvm::ArrayRef<uint8_t> Bytes(Payload);
-  DocID Delta;
-  for (DocID Current = Head; !Bytes.empty(); Current += Delta) {
-    auto MaybeDelta = readVByte(Bytes);
-    if (!MaybeDelta)
-      break;
-    Delta = *MaybeDelta;
-    Result.push_back(Current + Delta);
+  llvm::SmallVector<DocID, Chunk::PayloadSize + 1> Result;
+  decompress(Result);
+  return Result;
+}
+
+/// Decodes the VByte deltas in place. The payload is terminated by a zero
+/// byte or by its end, and a delta never starts with a zero byte.
+void Chunk::decompress(llvm::SmallVectorImpl<DocID> &Out) const {
+  Out.clear();
+  Out.push_back(Head);
+  DocID Current = Head;
+  for (size_t I = 0; I < PayloadSize && Payload[I] != 0;) {
+    // Most deltas fit in a single byte.
+    uint8_t Byte = Payload[I++];
+    DocID Delta = Byte & 0x7f;
+    for (unsigned Shift = BitsPerEncodingByte; Byte & 0x80;
+         Shift += BitsPerEncodingByte) {
+      assert(I < PayloadSize && "Malformed VByte encoding sequence.");
+      Byte = Payload[I++];
+      Delta |= static_cast<DocID>(Byte & 0x7f) << Shift;
+    }
+    Current += Delta;
+    Out.push_back(Current);
   }
-  return llvm::SmallVector<DocID, Chunk::PayloadSize + 1>{Result};
 }
 
 PostingList::PostingList(llvm::ArrayRef<DocID> Documents)
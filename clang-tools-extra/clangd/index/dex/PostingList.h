@@ -44,6 +44,9 @@ struct Chunk {
   static constexpr size_t PayloadSize = 32 - sizeof(DocID);
 
   llvm::SmallVector<DocID, PayloadSize + 1> decompress() const;
+  /// Decompresses the chunk into \p Out, replacing its contents, so that
+  /// iterators can reuse their buffer.
+  void decompress(llvm::SmallVectorImpl<DocID> &Out) const;
 
   /// The first element of decompressed Chunk.
   DocID Head;
@@ -0,0 +1,117 @@
+//===--- Client.cpp ----------------------------------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <grpcpp/grpcpp.h>
+
+#include "Client.h"
+#include "Index.grpc.pb.h"
+#include "Logger.h"
+#include "Trace.h"
+#include "marshalling/Marshalling.h"
+#include <chrono>
+
+namespace clang {
+namespace clangd {
+namespace remote {
+namespace {
+
+class IndexClient : public clangd::SymbolIndex {
+  template <typename RequestT, typename ReplyT>
+  using StreamingCall = std::unique_ptr<grpc::ClientReader<ReplyT>> (
+      remote::SymbolIndex::Stub::*)(grpc::ClientContext *, const RequestT &);
+
+  /// Sends \p Request and calls \p Callback on each result as it arrives.
+  /// Returns the final result of the stream.
+  template <typename ClangdRequestT, typename RequestT, typename ReplyT,
+            typename CallbackT>
+  bool streamRPC(const ClangdRequestT &Request,
+                 StreamingCall<RequestT, ReplyT> RPCCall,
+                 CallbackT Callback) const {
+    trace::Span Tracer(RequestT::descriptor()->name());
+    const RequestT RPCRequest = toProtobuf(Request);
+    grpc::ClientContext Context;
+    Context.set_deadline(std::chrono::system_clock::now() + Deadline);
+    std::unique_ptr<grpc::ClientReader<ReplyT>> Reader =
+        (Stub.get()->*RPCCall)(&Context, RPCRequest);
+    bool FinalResult = false;
+    unsigned Results = 0;
+    ReplyT Reply;
+    while (Reader->Read(&Reply)) {
+      if (!Reply.has_stream_result()) {
+        FinalResult = Reply.final_result();
+        continue;
+      }
+      auto Result = fromProtobuf(Reply.stream_result());
+      if (!Result) {
+        elog("Remote index sent an invalid result: {0}", Result.takeError());
+        continue;
+      }
+      ++Results;
+      Callback(*Result);
+    }
+    grpc::Status Status = Reader->Finish();
+    if (!Status.ok())
+      elog("Remote index {0} failed: {1}", RequestT::descriptor()->name(),
+           Status.error_message());
+    SPAN_ATTACH(Tracer, "results", Results);
+    return FinalResult;
+  }
+
+public:
+  IndexClient(std::shared_ptr<grpc::ChannelInterface> Channel,
+              std::chrono::milliseconds Deadline)
+      : Stub(remote::SymbolIndex::NewStub(Channel)), Deadline(Deadline) {}
+
+  void lookup(const clangd::LookupRequest &Request,
+              llvm::function_ref<void(const clangd::Symbol &)> Callback)
+      const override {
+    streamRPC(Request, &remote::SymbolIndex::Stub::Lookup, Callback);
+  }
+
+  bool
+  fuzzyFind(const clangd::FuzzyFindRequest &Request,
+            llvm::function_ref<void(const clangd::Symbol &)> Callback)
+      const override {
+    return streamRPC(Request, &remote::SymbolIndex::Stub::FuzzyFind,
+                     Callback);
+  }
+
+  void refs(const clangd::RefsRequest &Request,
+            llvm::function_ref<void(const clangd::Ref &)> Callback)
+      const override {
+    streamRPC(Request, &remote::SymbolIndex::Stub::Refs, Callback);
+  }
+
+  // FIXME: Add relations to the protocol.
+  void relations(const clangd::RelationsRequest &,
+                 llvm::function_ref<void(const SymbolID &,
+                                         const clangd::Symbol &)>)
+      const override {}
+
+  // The index lives on the server.
+  size_t estimateMemoryUsage() const override { return 0; }
+
+private:
+  std::unique_ptr<remote::SymbolIndex::Stub> Stub;
+  std::chrono::milliseconds Deadline;
+};
+
+} // namespace
+
+std::unique_ptr<clangd::SymbolIndex> getClient(llvm::StringRef Address) {
+  const auto Channel =
+      grpc::CreateChannel(Address.str(), grpc::InsecureChannelCredentials());
+  // Start connecting now rather than on the first request.
+  Channel->GetState(/*try_to_connect=*/true);
+  return std::make_unique<IndexClient>(Channel,
+                                       std::chrono::milliseconds(1000));
+}
+
+} // namespace remote
+} // namespace clangd
+} // namespace clang
@@ -0,0 +1,209 @@
+//===--- Marshalling.cpp -----------------------------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "Marshalling.h"
+#include "llvm/ADT/Twine.h"
+
+namespace clang {
+namespace clangd {
+namespace remote {
+namespace {
+
+llvm::Error makeError(const llvm::Twine &Msg) {
+  return llvm::make_error<llvm::StringError>(Msg,
+                                             llvm::inconvertibleErrorCode());
+}
+
+llvm::Expected<SymbolID> fromProtobuf(const std::string &ID) {
+  if (ID.size() != SymbolID::RawSize)
+    return makeError("Malformed SymbolID of size " + llvm::Twine(ID.size()));
+  return SymbolID::fromRaw(ID);
+}
+
+template <typename IDs>
+llvm::Expected<llvm::DenseSet<SymbolID>> fromProtobuf(const IDs &Messages) {
+  llvm::DenseSet<SymbolID> Result;
+  for (const std::string &Message : Messages) {
+    auto ID = fromProtobuf(Message);
+    if (!ID)
+      return ID.takeError();
+    Result.insert(*ID);
+  }
+  return std::move(Result);
+}
+
+template <typename IDs>
+void toProtobuf(const llvm::DenseSet<SymbolID> &From, IDs *Messages) {
+  for (const SymbolID &ID : From)
+    Messages->Add(ID.raw().str());
+}
+
+clangd::SymbolLocation fromProtobuf(const SymbolLocation &Message) {
+  clangd::SymbolLocation Result;
+  Result.Start.setLine(Message.start().line());
+  Result.Start.setColumn(Message.start().column());
+  Result.End.setLine(Message.end().line());
+  Result.End.setColumn(Message.end().column());
+  Result.FileURI = Message.file_uri().c_str();
+  return Result;
+}
+
+SymbolLocation toProtobuf(const clangd::SymbolLocation &From) {
+  SymbolLocation Result;
+  Result.mutable_start()->set_line(From.Start.line());
+  Result.mutable_start()->set_column(From.Start.column());
+  Result.mutable_end()->set_line(From.End.line());
+  Result.mutable_end()->set_column(From.End.column());
+  Result.set_file_uri(From.FileURI);
+  return Result;
+}
+
+} // namespace
+
+llvm::Expected<clangd::LookupRequest>
+fromProtobuf(const LookupRequest *Request) {
+  auto IDs = fromProtobuf(Request->ids());
+  if (!IDs)
+    return IDs.takeError();
+  clangd::LookupRequest Result;
+  Result.IDs = std::move(*IDs);
+  return std::move(Result);
+}
+
+clangd::FuzzyFindRequest fromProtobuf(const FuzzyFindRequest *Request) {
+  clangd::FuzzyFindRequest Result;
+  Result.Query = Request->query();
+  for (const std::string &Scope : Request->scopes())
+    Result.Scopes.push_back(Scope);
+  Result.AnyScope = Request->any_scope();
+  if (Request->limit())
+    Result.Limit = Request->limit();
+  Result.RestrictForCodeCompletion = Request->restricted_for_code_completion();
+  for (const std::string &Path : Request->proximity_paths())
+    Result.ProximityPaths.push_back(Path);
+  for (const std::string &Type : Request->preferred_types())
+    Result.PreferredTypes.push_back(Type);
+  return Result;
+}
+
+llvm::Expected<clangd::RefsRequest> fromProtobuf(const RefsRequest *Request) {
+  auto IDs = fromProtobuf(Request->ids());
+  if (!IDs)
+    return IDs.takeError();
+  clangd::RefsRequest Result;
+  Result.IDs = std::move(*IDs);
+  Result.Filter = static_cast<RefKind>(Request->filter());
+  if (Request->limit())
+    Result.Limit = Request->limit();
+  return std::move(Result);
+}
+
+llvm::Expected<clangd::Symbol> fromProtobuf(const Symbol &Message) {
+  auto ID = fromProtobuf(Message.id());
+  if (!ID)
+    return ID.takeError();
+  clangd::Symbol Result;
+  Result.ID = *ID;
+  Result.SymInfo.Kind = static_cast<index::SymbolKind>(Message.kind());
+  Result.SymInfo.Lang = static_cast<index::SymbolLanguage>(Message.language());
+  Result.Name = Message.name();
+  Result.Scope = Message.scope();
+  Result.Definition = fromProtobuf(Message.definition());
+  Result.CanonicalDeclaration = fromProtobuf(Message.canonical_declaration());
+  Result.References = Message.references();
+  Result.Origin = static_cast<SymbolOrigin>(Message.origin());
+  Result.Signature = Message.signature();
+  Result.TemplateSpecializationArgs = Message.template_specialization_args();
+  Result.CompletionSnippetSuffix = Message.completion_snippet_suffix();
+  Result.Documentation = Message.documentation();
+  Result.ReturnType = Message.return_type();
+  Result.Type = Message.type();
+  for (const HeaderWithReferences &Header : Message.headers())
+    Result.IncludeHeaders.emplace_back(Header.header(), Header.references());
+  Result.Flags = static_cast<clangd::Symbol::SymbolFlag>(Message.flags());
+  return Result;
+}
+
+llvm::Expected<clangd::Ref> fromProtobuf(const Ref &Message) {
+  if (Message.location().file_uri().empty())
+    return makeError("Reference without a location");
+  clangd::Ref Result;
+  Result.Location = fromProtobuf(Message.location());
+  Result.Kind = static_cast<RefKind>(Message.kind());
+  return Result;
+}
+
+LookupRequest toProtobuf(const clangd::LookupRequest &From) {
+  LookupRequest Result;
+  toProtobuf(From.IDs, Result.mutable_ids());
+  return Result;
+}
+
+FuzzyFindRequest toProtobuf(const clangd::FuzzyFindRequest &From) {
+  FuzzyFindRequest Result;
+  Result.set_query(From.Query);
+  for (const std::string &Scope : From.Scopes)
+    Result.add_scopes(Scope);
+  Result.set_any_scope(From.AnyScope);
+  if (From.Limit)
+    Result.set_limit(*From.Limit);
+  Result.set_restricted_for_code_completion(From.RestrictForCodeCompletion);
+  for (const std::string &Path : From.ProximityPaths)
+    Result.add_proximity_paths(Path);
+  for (const std::string &Type : From.PreferredTypes)
+    Result.add_preferred_types(Type);
+  return Result;
+}
+
+RefsRequest toProtobuf(const clangd::RefsRequest &From) {
+  RefsRequest Result;
+  toProtobuf(From.IDs, Result.mutable_ids());
+  Result.set_filter(static_cast<uint32_t>(From.Filter));
+  if (From.Limit)
+    Result.set_limit(*From.Limit);
+  return Result;
+}
+
+Symbol toProtobuf(const clangd::Symbol &From) {
+  Symbol Result;
+  Result.set_id(From.ID.raw().str());
+  Result.set_kind(static_cast<uint32_t>(From.SymInfo.Kind));
+  Result.set_language(static_cast<uint32_t>(From.SymInfo.Lang));
+  Result.set_name(From.Name.str());
+  Result.set_scope(From.Scope.str());
+  *Result.mutable_definition() = toProtobuf(From.Definition);
+  *Result.mutable_canonical_declaration() =
+      toProtobuf(From.CanonicalDeclaration);
+  Result.set_references(From.References);
+  Result.set_origin(static_cast<uint32_t>(From.Origin));
+  Result.set_signature(From.Signature.str());
+  Result.set_template_specialization_args(
+      From.TemplateSpecializationArgs.str());
+  Result.set_completion_snippet_suffix(From.CompletionSnippetSuffix.str());
+  Result.set_documentation(From.Documentation.str());
+  Result.set_return_type(From.ReturnType.str());
+  Result.set_type(From.Type.str());
+  for (const auto &Header : From.IncludeHeaders) {
+    HeaderWithReferences *NextHeader = Result.add_headers();
+    NextHeader->set_header(Header.IncludeHeader.str());
+    NextHeader->set_references(Header.References);
+  }
+  Result.set_flags(static_cast<uint32_t>(From.Flags));
+  return Result;
+}
+
+Ref toProtobuf(const clangd::Ref &From) {
+  Ref Result;
+  *Result.mutable_location() = toProtobuf(From.Location);
+  Result.set_kind(static_cast<uint32_t>(From.Kind));
+  return Result;
+}
+
+} // namespace remote
+} // namespace clangd
+} // namespace clang
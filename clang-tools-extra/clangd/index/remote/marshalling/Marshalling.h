@@ -0,0 +1,45 @@
+//===--- Marshalling.h -------------------------------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Transformations between the clangd index structures and the Protocol Buffers
+// messages of the remote index.
+//
+// The clangd structures returned by fromProtobuf() do not own their strings:
+// they point into the message, which must outlive them.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_REMOTE_MARSHALLING_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_REMOTE_MARSHALLING_H
+
+#include "Index.pb.h"
+#include "index/Index.h"
+#include "llvm/Support/Error.h"
+
+namespace clang {
+namespace clangd {
+namespace remote {
+
+llvm::Expected<clangd::LookupRequest>
+fromProtobuf(const LookupRequest *Request);
+clangd::FuzzyFindRequest fromProtobuf(const FuzzyFindRequest *Request);
+llvm::Expected<clangd::RefsRequest> fromProtobuf(const RefsRequest *Request);
+llvm::Expected<clangd::Symbol> fromProtobuf(const Symbol &Message);
+llvm::Expected<clangd::Ref> fromProtobuf(const Ref &Message);
+
+LookupRequest toProtobuf(const clangd::LookupRequest &From);
+FuzzyFindRequest toProtobuf(const clangd::FuzzyFindRequest &From);
+RefsRequest toProtobuf(const clangd::RefsRequest &From);
+Symbol toProtobuf(const clangd::Symbol &From);
+Ref toProtobuf(const clangd::Ref &From);
+
+} // namespace remote
+} // namespace clangd
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_REMOTE_MARSHALLING_H
@@ -15,6 +15,9 @@
 #include "Transport.h"
 #include "index/Background.h"
 #include "index/Serialization.h"
+#if CLANGD_ENABLE_REMOTE
+#include "index/remote/Client.h"
+#endif
 #include "clang/Basic/Version.h"
 #include "clang/Format/Format.h"
 #include "llvm/ADT/Optional.h"
@@ -247,6 +250,16 @@ opt<int> LimitResults{
     init(100),
 };
 
+opt<unsigned> CompletionLatencyBudget{
+    "completion-latency-budget",
+    cat(Features),
+    desc("Return code completion results after this many milliseconds, "
+         "without the index results that are still pending. "
+         "0 means no budget (default=0)"),
+    init(0),
+    Hidden,
+};
+
 opt<bool> SuggestMissingIncludes{
     "suggest-missing-includes",
     cat(Features),
@@ -271,6 +284,15 @@ opt<unsigned> WorkerThreadsCount{
     init(getDefaultAsyncThreadsCount()),
 };
 
+opt<unsigned> RetainedASTMemoryLimit{
+    "retained-ast-memory-limit",
+    cat(Misc),
+    desc("Maximum memory in MB used by the ASTs of idle files. The most "
+         "recently used one is always kept. 0 means no limit"),
+    init(0),
+    Hidden,
+};
+
 opt<Path> IndexFile{
     "index-file",
     cat(Misc),
@@ -283,6 +305,17 @@ opt<Path> IndexFile{
     Hidden,
 };
 
+opt<std::string> RemoteIndexAddress{
+    "remote-index-address",
+    cat(Misc),
+    desc("Address of the clangd-index-server serving the static index, e.g. "
+         "localhost:50051. Replaces -index-file.\n"
+         "WARNING: This option is experimental only, and will be removed "
+         "eventually. Don't rely on it"),
+    init(""),
+    Hidden,
+};
+
 opt<bool> Test{
     "lit-test",
     cat(Misc),
@@ -579,9 +612,19 @@ clangd accepts flags on the commandline, and in the CLANGD_FLAGS environment var
     Opts.ResourceDir = ResourceDir;
   Opts.BuildDynamicSymbolIndex = EnableIndex;
   Opts.BackgroundIndex = EnableBackgroundIndex;
+  Opts.RetentionPolicy.MaxRetainedASTBytes =
+      std::size_t(RetainedASTMemoryLimit) * 1024 * 1024;
   std::unique_ptr<SymbolIndex> StaticIdx;
   std::future<void> AsyncIndexLoad; // Block exit while loading the index.
-  if (EnableIndex && !IndexFile.empty()) {
+  if (EnableIndex && !RemoteIndexAddress.empty()) {
+    if (!IndexFile.empty())
+      elog("-index-file is ignored in favor of -remote-index-address");
+#if CLANGD_ENABLE_REMOTE
+    StaticIdx = remote::getClient(RemoteIndexAddress);
+#else
+    elog("This clangd binary wasn't built with remote index support");
+#endif
+  } else if (EnableIndex && !IndexFile.empty()) {
     // Load the index asynchronously. Meanwhile SwapIndex returns no results.
     SwapIndex *Placeholder;
     StaticIdx.reset(Placeholder = new SwapIndex(std::make_unique<MemIndex>()));
@@ -607,6 +650,7 @@ clangd accepts flags on the commandline, and in the CLANGD_FLAGS environment var
     CCOpts.IncludeIndicator.NoInsert.clear();
   }
   CCOpts.SpeculativeIndexRequest = Opts.StaticIndex;
+  CCOpts.LatencyBudget = std::chrono::milliseconds(CompletionLatencyBudget);
   CCOpts.EnableFunctionArgSnippets = EnableFunctionArgSnippets;
   CCOpts.AllScopes = AllScopesCompletion;
   CCOpts.RunParser = CodeCompletionParse;
@@ -713,5 +713,34 @@ TEST(BackgroundQueueTest, Boost) {
   }
 }
 
+TEST(BackgroundQueueTest, BoostDirectory) {
+  std::string Sequence;
+
+  BackgroundQueue::Task A([&] { Sequence.push_back('A'); });
+  A.Directory = "/a";
+  A.QueuePri = 1;
+
+  BackgroundQueue::Task B([&] { Sequence.push_back('B'); });
+  B.QueuePri = 2;
+  B.Directory = "/b";
+
+  BackgroundQueue Q;
+  Q.append({A, B});
+  Q.boostDirectory("/a", 3);
+  Q.work([&] { Q.stop(); });
+  EXPECT_EQ("AB", Sequence) << "A's directory was boosted";
+}
+
+TEST(BackgroundQueueTest, Pause) {
+  BackgroundQueue Q;
+  auto Start = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point Ran;
+  Q.pauseUntil(Start + std::chrono::milliseconds(100));
+  Q.push(
+      BackgroundQueue::Task([&] { Ran = std::chrono::steady_clock::now(); }));
+  Q.work([&] { Q.stop(); });
+  EXPECT_GE(Ran - Start, std::chrono::milliseconds(100));
+}
+
 } // namespace clangd
 } // namespace clang
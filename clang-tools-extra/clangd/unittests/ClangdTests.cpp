@@ -503,6 +503,8 @@ struct Something {
 
   EXPECT_THAT(Server.getUsedBytesPerFile(),
               UnorderedElementsAre(Pair(FooCpp, Gt(0u)), Pair(BarCpp, Gt(0u))));
+  EXPECT_GT(Server.getMemoryUsage().preambles, 0u);
+  EXPECT_GT(Server.getMemoryUsage().asts, 0u);
 
   Server.removeDocument(FooCpp);
   ASSERT_TRUE(Server.blockUntilIdleForTest());
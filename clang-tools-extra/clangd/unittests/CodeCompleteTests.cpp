@@ -1112,13 +1112,15 @@ TEST(SignatureHelpTest, OpeningParen) {
 
 class IndexRequestCollector : public SymbolIndex {
 public:
+  IndexRequestCollector(bool Incomplete = true) : Incomplete(Incomplete) {}
+
   bool
   fuzzyFind(const FuzzyFindRequest &Req,
             llvm::function_ref<void(const Symbol &)> Callback) const override {
     std::unique_lock<std::mutex> Lock(Mut);
     Requests.push_back(Req);
     ReceivedRequestCV.notify_one();
-    return true;
+    return Incomplete;
   }
 
   void lookup(const LookupRequest &,
@@ -1145,6 +1147,7 @@ public:
   }
 
 private:
+  bool Incomplete;
   // We need a mutex to handle async fuzzy find requests.
   mutable std::condition_variable ReceivedRequestCV;
   mutable std::mutex Mut;
@@ -2129,6 +2132,80 @@ TEST(CompletionTest, EnableSpeculativeIndexRequest) {
   ASSERT_EQ(Reqs3.size(), 2u);
 }
 
+TEST(CompletionTest, ReuseCompleteIndexResults) {
+  MockFSProvider FS;
+  MockCompilationDatabase CDB;
+  IgnoreDiagnostics DiagConsumer;
+  ClangdServer Server(CDB, FS, DiagConsumer, ClangdServer::optsForTest());
+
+  auto File = testPath("foo.cpp");
+  Annotations Test(R"cpp(
+      namespace ns1 { int abcd; }
+      void f() { ns1::abc$1^; ns1::abcd$2^; ns1::ab$3^; }
+  )cpp");
+  runAddDocument(Server, File, Test.code());
+  clangd::CodeCompleteOptions Opts = {};
+
+  IndexRequestCollector Requests(/*Incomplete=*/false);
+  Opts.Index = &Requests;
+  Opts.SpeculativeIndexRequest = true;
+  Opts.Limit = 10;
+
+  auto CompleteAtPoint = [&](StringRef P) {
+    cantFail(runCodeComplete(Server, File, Test.point(P), Opts));
+  };
+
+  CompleteAtPoint("1");
+  EXPECT_EQ(Requests.consumeRequests(1).size(), 1u);
+
+  // The query extends the last one, whose results were complete.
+  CompleteAtPoint("2");
+  EXPECT_THAT(Requests.consumeRequests(0), IsEmpty());
+
+  // The query is shorter: the speculative request is sent, and used.
+  CompleteAtPoint("3");
+  EXPECT_EQ(Requests.consumeRequests(1).size(), 1u);
+}
+
+TEST(CompletionTest, LatencyBudget) {
+  MockFSProvider FS;
+  MockCompilationDatabase CDB;
+  IgnoreDiagnostics DiagConsumer;
+  ClangdServer Server(CDB, FS, DiagConsumer, ClangdServer::optsForTest());
+
+  auto File = testPath("foo.cpp");
+  Annotations Test(R"cpp(
+      namespace ns1 { int abc; }
+      void f() { ns1::ab^; }
+  )cpp");
+  runAddDocument(Server, File, Test.code());
+  clangd::CodeCompleteOptions Opts = {};
+  IndexRequestCollector Requests;
+  Opts.Index = &Requests;
+  Opts.SpeculativeIndexRequest = true;
+  cantFail(runCodeComplete(Server, File, Test.point(), Opts));
+  ASSERT_EQ(Requests.consumeRequests(1).size(), 1u);
+
+  // The speculative request doesn't return until the completion is done.
+  class BlockingIndex : public IndexRequestCollector {
+  public:
+    bool fuzzyFind(const FuzzyFindRequest &Req,
+                   llvm::function_ref<void(const Symbol &)> Callback)
+        const override {
+      Unblock.wait();
+      return IndexRequestCollector::fuzzyFind(Req, Callback);
+    }
+    Notification Unblock;
+  } Blocking;
+  Opts.Index = &Blocking;
+  Opts.LatencyBudget = std::chrono::milliseconds(10);
+  auto Results = cantFail(runCodeComplete(Server, File, Test.point(), Opts));
+  Blocking.Unblock.notify();
+  ASSERT_TRUE(Server.blockUntilIdleForTest());
+  EXPECT_TRUE(Results.HasMore);
+  EXPECT_THAT(Results.Completions, ElementsAre(Named("abc")));
+}
+
 TEST(CompletionTest, InsertTheMostPopularHeader) {
   std::string DeclFile = URI::create(testPath("foo")).toString();
   Symbol sym = func("Func");
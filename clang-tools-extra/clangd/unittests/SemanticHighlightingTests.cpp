@@ -577,6 +577,52 @@ TEST(SemanticHighlighting, GeneratesHighlightsWhenFileChange) {
   ASSERT_EQ(DiagConsumer.Count, 1);
 }
 
+TEST(SemanticHighlighting, ReusesUnchangedDecls) {
+  TestTU TU = TestTU::withCode(R"cpp(
+    namespace ns {
+    struct A {};
+    void foo(A a) {}
+    int x;
+    }
+    void bar() { ns::foo(ns::A()); }
+  )cpp");
+  auto Preamble = TU.preamble();
+  SemanticHighlightingCache Cache;
+  auto Check = [&](unsigned ReusedDecls) {
+    ParsedAST AST = TU.build(Preamble);
+    EXPECT_EQ(getSemanticHighlightings(AST),
+              getSemanticHighlightings(AST, &Cache))
+        << TU.Code;
+    EXPECT_EQ(ReusedDecls, Cache.reusedDecls()) << TU.Code;
+  };
+  Check(0);
+  Check(4);
+
+  // The declarations before the edit are reused.
+  TU.Code = R"cpp(
+    namespace ns {
+    struct A {};
+    void foo(A a) {}
+    int x;
+    }
+    void bar() { int y = ns::x; }
+  )cpp";
+  Check(3);
+  TU.Code = R"cpp(
+    namespace ns {
+    struct A {};
+    void foo(A b) {}
+    int x;
+    }
+    void bar() { int y = ns::x; }
+  )cpp";
+  Check(1);
+
+  // Nothing is reused with another preamble.
+  Preamble = TU.preamble();
+  Check(0);
+}
+
 TEST(SemanticHighlighting, toSemanticHighlightingInformation) {
   auto CreatePosition = [](int Line, int Character) -> Position {
     Position Pos;
@@ -513,6 +513,30 @@ TEST_F(TUSchedulerTests, EvictedAST) {
               UnorderedElementsAre(Foo, AnyOf(Bar, Baz)));
 }
 
+TEST_F(TUSchedulerTests, EvictedASTBySize) {
+  ASTRetentionPolicy Policy;
+  Policy.MaxRetainedASTs = 3;
+  // Any AST is larger than this.
+  Policy.MaxRetainedASTBytes = 1;
+  TUScheduler S(CDB,
+                /*AsyncThreadsCount=*/1, /*StorePreambleInMemory=*/true,
+                /*ASTCallbacks=*/nullptr,
+                /*UpdateDebounce=*/std::chrono::steady_clock::duration::zero(),
+                Policy);
+
+  auto Foo = testPath("foo.cpp");
+  auto Bar = testPath("bar.cpp");
+  updateWithCallback(S, Foo, "int a;", WantDiagnostics::Yes, [] {});
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  // The most recently used AST is retained even if it is too large.
+  EXPECT_THAT(S.getFilesWithCachedAST(), ElementsAre(Foo));
+  EXPECT_GT(S.getUsedASTBytes(), 0u);
+
+  updateWithCallback(S, Bar, "int b;", WantDiagnostics::Yes, [] {});
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  EXPECT_THAT(S.getFilesWithCachedAST(), ElementsAre(Bar));
+}
+
 TEST_F(TUSchedulerTests, EmptyPreamble) {
   TUScheduler S(CDB,
                 /*AsyncThreadsCount=*/4, /*StorePreambleInMemory=*/true,
@@ -590,6 +614,88 @@ TEST_F(TUSchedulerTests, RunWaitsForPreamble) {
   ASSERT_THAT(Preambles, Each(Preambles[0]));
 }
 
+TEST_F(TUSchedulerTests, SharedPreamble) {
+  TUScheduler S(CDB,
+                /*AsyncThreadsCount=*/getDefaultAsyncThreadsCount(),
+                /*StorePreambleInMemory=*/true, /*ASTCallbacks=*/nullptr,
+                /*UpdateDebounce=*/std::chrono::steady_clock::duration::zero(),
+                ASTRetentionPolicy());
+  auto Foo = testPath("foo.cpp");
+  auto Bar = testPath("bar.cpp");
+  auto Baz = testPath("baz.cpp");
+  auto Header = testPath("foo.h");
+  Files[Header] = "void foo();";
+  Timestamps[Header] = time_t(0);
+
+  auto getPreamble = [&](PathRef File) {
+    const PreambleData *Result = nullptr;
+    S.runWithPreamble("test", File, TUScheduler::Stale,
+                      [&](Expected<InputsAndPreamble> IP) {
+                        Result = cantFail(std::move(IP)).Preamble;
+                      });
+    EXPECT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+    return Result;
+  };
+
+  // The files that start with the same includes share their preamble.
+  S.update(Foo, getInputs(Foo, "#include \"foo.h\"\nint x;"),
+           WantDiagnostics::Auto);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  S.update(Bar, getInputs(Bar, "#include \"foo.h\"\nint y;"),
+           WantDiagnostics::Auto);
+  S.update(Baz, getInputs(Baz, "#include \"foo.h\"\n#include \"foo.h\"\n"),
+           WantDiagnostics::Auto);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  const PreambleData *FooPreamble = getPreamble(Foo);
+  ASSERT_NE(FooPreamble, nullptr);
+  EXPECT_EQ(getPreamble(Bar), FooPreamble);
+  EXPECT_NE(getPreamble(Baz), FooPreamble);
+
+  // Once the header changes, the shared preamble is not reused anymore.
+  Timestamps[Header] = time_t(1);
+  S.remove(Bar);
+  S.update(Bar, getInputs(Bar, "#include \"foo.h\"\nint y;"),
+           WantDiagnostics::Auto);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  EXPECT_NE(getPreamble(Bar), FooPreamble);
+}
+
+TEST_F(TUSchedulerTests, PatchedPreamble) {
+  TUScheduler S(CDB,
+                /*AsyncThreadsCount=*/getDefaultAsyncThreadsCount(),
+                /*StorePreambleInMemory=*/true, captureDiags(),
+                /*UpdateDebounce=*/std::chrono::steady_clock::duration::zero(),
+                ASTRetentionPolicy());
+  auto Foo = testPath("foo.cpp");
+  auto FooHeader = testPath("foo.h");
+  auto BarHeader = testPath("bar.h");
+  Files[FooHeader] = "int foo();";
+  Timestamps[FooHeader] = time_t(0);
+  Files[BarHeader] = "int bar();";
+  Timestamps[BarHeader] = time_t(0);
+
+  std::atomic<int> BuiltASTCount(0);
+  updateWithDiags(S, Foo, "#include \"foo.h\"\nint x = foo();",
+                  WantDiagnostics::Yes, [&](std::vector<Diag> Diags) {
+                    EXPECT_THAT(Diags, IsEmpty());
+                    ++BuiltASTCount;
+                  });
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  ASSERT_EQ(BuiltASTCount.load(), 1);
+
+  // The AST built with the patched old preamble already sees the new include,
+  // the one built with the new preamble follows.
+  updateWithDiags(S, Foo,
+                  "#include \"foo.h\"\n#include \"bar.h\"\n"
+                  "#define BAZ 1\nint x = foo() + bar() + BAZ;",
+                  WantDiagnostics::Yes, [&](std::vector<Diag> Diags) {
+                    EXPECT_THAT(Diags, IsEmpty());
+                    ++BuiltASTCount;
+                  });
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  EXPECT_EQ(BuiltASTCount.load(), 3);
+}
+
 TEST_F(TUSchedulerTests, NoopOnEmptyChanges) {
   TUScheduler S(CDB,
                 /*AsyncThreadsCount=*/getDefaultAsyncThreadsCount(),
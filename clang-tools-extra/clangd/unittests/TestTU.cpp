@@ -19,7 +19,7 @@
 namespace clang {
 namespace clangd {
 
-ParsedAST TestTU::build() const {
+ParseInputs TestTU::inputs() const {
   std::string FullFilename = testPath(Filename),
               FullHeaderName = testPath(HeaderFilename),
               ImportThunk = testPath("import_thunk.h");
@@ -61,16 +61,29 @@ ParsedAST TestTU::build() const {
   Inputs.Index = ExternalIndex;
   if (Inputs.Index)
     Inputs.Opts.SuggestMissingIncludes = true;
+  return Inputs;
+}
+
+std::shared_ptr<const PreambleData> TestTU::preamble() const {
+  ParseInputs Inputs = inputs();
+  StoreDiags Diags;
+  auto CI = buildCompilerInvocation(Inputs, Diags);
+  assert(CI && "Failed to build compilation invocation.");
+  return buildPreamble(Inputs.CompileCommand.Filename, *CI,
+                       /*OldPreamble=*/nullptr,
+                       /*OldCompileCommand=*/Inputs.CompileCommand, Inputs,
+                       /*StoreInMemory=*/true, /*PreambleCallback=*/nullptr);
+}
+
+ParsedAST TestTU::build() const { return build(preamble()); }
+
+ParsedAST TestTU::build(std::shared_ptr<const PreambleData> Preamble) const {
+  ParseInputs Inputs = inputs();
   StoreDiags Diags;
   auto CI = buildCompilerInvocation(Inputs, Diags);
   assert(CI && "Failed to build compilation invocation.");
-  auto Preamble =
-      buildPreamble(FullFilename, *CI,
-                    /*OldPreamble=*/nullptr,
-                    /*OldCompileCommand=*/Inputs.CompileCommand, Inputs,
-                    /*StoreInMemory=*/true, /*PreambleCallback=*/nullptr);
-  auto AST =
-      buildAST(FullFilename, std::move(CI), Diags.take(), Inputs, Preamble);
+  auto AST = buildAST(Inputs.CompileCommand.Filename, std::move(CI),
+                      Diags.take(), Inputs, std::move(Preamble));
   if (!AST.hasValue()) {
     ADD_FAILURE() << "Failed to build code:\n" << Code;
     llvm_unreachable("Failed to build TestTU!");
@@ -65,6 +65,11 @@ struct TestTU {
   bool ImplicitHeaderGuard = true;
 
   ParsedAST build() const;
+  // Builds the AST with a preamble built earlier, e.g. for an older version
+  // of Code that has the same preamble region.
+  ParsedAST build(std::shared_ptr<const PreambleData> Preamble) const;
+  std::shared_ptr<const PreambleData> preamble() const;
+  ParseInputs inputs() const;
   SymbolSlab headerSymbols() const;
   std::unique_ptr<SymbolIndex> index() const;
 };
@@ -1,5 +1,8 @@
 #include "ClangTidy.h"
 #include "ClangTidyTest.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/VirtualFileSystem.h"
 #include "gtest/gtest.h"
 
 namespace clang {
@@ -29,6 +32,79 @@ TEST(ClangTidyDiagnosticConsumer, SortsErrors) {
   EXPECT_EQ("variable", Errors[1].Message.Message);
 }
 
+TEST(RunClangTidy, ParallelRunKeepsFileOrder) {
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> FS(
+      new llvm::vfs::InMemoryFileSystem);
+  std::vector<std::string> Files;
+  for (unsigned I = 0; I < 8; ++I) {
+    Files.push_back("/src/file" + std::to_string(I) + ".cpp");
+    FS->addFile(Files.back(), 0,
+                llvm::MemoryBuffer::getMemBufferCopy(
+                    "int f() { return undeclared" + std::to_string(I) + "; }"));
+  }
+  tooling::FixedCompilationDatabase Compilations("/src", {});
+
+  auto Run = [&](unsigned NumThreads) {
+    ClangTidyContext Context(std::make_unique<DefaultOptionsProvider>(
+        ClangTidyGlobalOptions(), ClangTidyOptions::getDefaults()));
+    std::vector<ClangTidyError> Errors = runClangTidy(
+        Context, Compilations, Files,
+        new llvm::vfs::OverlayFileSystem(FS), /*EnableCheckProfile=*/false,
+        /*StoreCheckProfile=*/"", NumThreads);
+    EXPECT_EQ(Files.size(), Context.getStats().ErrorsDisplayed);
+    std::vector<std::string> Paths;
+    for (const ClangTidyError &Error : Errors)
+      Paths.push_back(Error.Message.FilePath);
+    return Paths;
+  };
+  EXPECT_EQ(Files, Run(1));
+  EXPECT_EQ(Files, Run(4));
+}
+
+TEST(RunClangTidy, HeaderCacheReplaysDiagnostics) {
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> FS(
+      new llvm::vfs::InMemoryFileSystem);
+  FS->addFile("/src/header.h", 0,
+              llvm::MemoryBuffer::getMemBuffer("#ifndef HEADER_H\n"
+                                               "#define HEADER_H\n"
+                                               "#warning in header\n"
+                                               "#endif\n"));
+  FS->addFile("/src/main.cpp", 0,
+              llvm::MemoryBuffer::getMemBuffer("#include \"header.h\"\n"));
+  tooling::FixedCompilationDatabase Compilations("/src", {});
+  SmallString<128> CacheDir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("tidy-cache", CacheDir));
+
+  auto Run = [&] {
+    ClangTidyOptions Options = ClangTidyOptions::getDefaults();
+    Options.HeaderFilterRegex = ".*";
+    ClangTidyContext Context(std::make_unique<DefaultOptionsProvider>(
+        ClangTidyGlobalOptions(), Options));
+    Context.setHeaderCacheDirectory(CacheDir);
+    std::vector<ClangTidyError> Errors =
+        runClangTidy(Context, Compilations, {"/src/main.cpp"},
+                     new llvm::vfs::OverlayFileSystem(FS));
+    EXPECT_EQ(1u, Context.getStats().ErrorsDisplayed);
+    std::vector<std::string> Messages;
+    for (const ClangTidyError &Error : Errors)
+      Messages.push_back(Error.Message.FilePath + ": " + Error.Message.Message);
+    return Messages;
+  };
+  std::vector<std::string> Expected = {"/src/header.h: in header"};
+  EXPECT_EQ(Expected, Run());
+
+  unsigned CachedHeaders = 0;
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator It(CacheDir, EC), End;
+       !EC && It != End; It.increment(EC))
+    ++CachedHeaders;
+  EXPECT_EQ(1u, CachedHeaders);
+
+  // The second run replays the cached diagnostics.
+  EXPECT_EQ(Expected, Run());
+  llvm::sys::fs::remove_directories(CacheDir);
+}
+
 } // namespace test
 } // namespace tidy
 } // namespace clang
@@ -283,6 +283,15 @@ public:
   virtual bool dynMatches(const ast_type_traits::DynTypedNode &DynNode,
                           ASTMatchFinder *Finder,
                           BoundNodesTreeBuilder *Builder) const = 0;
+
+  /// Returns the names of which the matched nodes must have one, if they
+  /// must be declarations with a given unqualified name, e.g. as required by
+  /// \c hasName().
+  ///
+  /// Used to skip the matcher on the declarations with other names.
+  virtual llvm::Optional<std::vector<StringRef>> getRequiredNames() const {
+    return llvm::None;
+  }
 };
 
 /// Generic interface for matchers on an AST node of type T.
@@ -404,6 +413,15 @@ public:
   ///   binding. Otherwise, returns an empty \c Optional<>.
   llvm::Optional<DynTypedMatcher> tryBind(StringRef ID) const;
 
+  /// Returns the unqualified names of which the matched nodes must have one,
+  /// or \c None if the matcher can match nodes of any name.
+  ///
+  /// Only the nodes that are \c NamedDecls with an identifier can have one of
+  /// these names.
+  llvm::Optional<std::vector<StringRef>> getRequiredNames() const {
+    return Implementation->getRequiredNames();
+  }
+
   /// Returns a unique \p ID for the matcher.
   ///
   /// Casting a Matcher<T> to Matcher<U> creates a matcher that has the
@@ -708,6 +726,8 @@ class HasNameMatcher : public SingleNodeMatcherInterface<NamedDecl> {
 
   bool matchesNode(const NamedDecl &Node) const override;
 
+  llvm::Optional<std::vector<StringRef>> getRequiredNames() const override;
+
  private:
   /// Unqualified match routine.
   ///
@@ -21,6 +21,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Error.h"
+#include <functional>
 
 namespace clang {
 class CompilerInstance;
@@ -191,6 +192,10 @@ private:
   const T *findDefInDeclContext(const DeclContext *DC,
                                 StringRef LookupName);
   template <typename T>
+  const T *findDefByName(const T *D, ASTContext &From, StringRef LookupName);
+  /// Forgets the importer and the imported FileIDs of an unloaded ASTUnit.
+  void forgetASTUnit(ASTUnit &Unit);
+  template <typename T>
   llvm::Expected<const T *> importDefinitionImpl(const T *D, ASTUnit *Unit);
 
   using ImporterMapTy =
@@ -272,10 +277,18 @@ private:
                                                    StringRef CrossTUDir,
                                                    StringRef IndexName);
 
+    /// Set a callback that is called before an ASTUnit is unloaded.
+    void setUnloadHandler(std::function<void(ASTUnit &)> Handler) {
+      UnloadHandler = std::move(Handler);
+    }
+
   private:
     llvm::Error ensureCTUIndexLoaded(StringRef CrossTUDir, StringRef IndexName);
     llvm::Expected<ASTUnit *> getASTUnitForFile(StringRef FileName,
                                                 bool DisplayCTUProgress);
+    /// Unloads the least recently used ASTUnits, except \p InUse, while the
+    /// loaded ones take more memory than the limit.
+    void unloadLeastRecentlyUsed(const ASTUnit *InUse, bool DisplayCTUProgress);
 
     template <typename... T> using BaseMapTy = llvm::StringMap<T...>;
     using OwningMapTy = BaseMapTy<std::unique_ptr<clang::ASTUnit>>;
@@ -295,6 +308,14 @@ private:
     /// actually loaded or returned from cache. This information is needed to
     /// maintain the counter.
     ASTLoadGuard LoadGuard;
+
+    /// The last use of each loaded ASTUnit, by the number of uses before it.
+    BaseMapTy<unsigned> LastUseOfFile;
+    unsigned UseCount{0u};
+    /// The maximal amount of memory the loaded ASTUnits may take, in bytes,
+    /// or 0 if there is no limit.
+    const uint64_t MemoryLimit;
+    std::function<void(ASTUnit &)> UnloadHandler;
   };
 
   ASTUnitStorage ASTStorage;
@@ -199,6 +199,12 @@ public:
   /// Whether the driver is generating diagnostics for debugging purposes.
   unsigned CCGenDiagnostics : 1;
 
+  /// Pointer to the -cc1 tool of the executable, to run the -cc1 jobs in the
+  /// driver's process instead of spawning a new one. The arguments start with
+  /// the executable and the -cc1 option.
+  typedef int (*CC1ToolFunc)(ArrayRef<const char *> Argv);
+  CC1ToolFunc CC1Main = nullptr;
+
 private:
   /// Raw target triple.
   std::string TargetTriple;
@@ -85,6 +85,10 @@ class Command {
   /// The results are the contents of a response file, written into a raw_ostream.
   void writeResponseFile(raw_ostream &OS) const;
 
+protected:
+  /// Prints the input filenames if requested by setPrintInputFilenames().
+  void PrintFileNames() const;
+
 public:
   Command(const Action &Source, const Tool &Creator, const char *Executable,
           const llvm::opt::ArgStringList &Arguments,
@@ -132,6 +136,19 @@ public:
   void setPrintInputFilenames(bool P) { PrintInputFilenames = P; }
 };
 
+/// Like Command, but runs the -cc1 tool in the driver's process through
+/// Driver::CC1Main, which saves the cost of starting a new one.
+class CC1Command : public Command {
+public:
+  using Command::Command;
+
+  void Print(llvm::raw_ostream &OS, const char *Terminator, bool Quote,
+             CrashReportInfo *CrashInfo = nullptr) const override;
+
+  int Execute(ArrayRef<Optional<StringRef>> Redirects, std::string *ErrMsg,
+              bool *ExecutionFailed) const override;
+};
+
 /// Like Command, but with a fallback which is executed in case
 /// the primary command crashes.
 class FallbackCommand : public Command {
@@ -10,10 +10,13 @@
 #define LLVM_CLANG_INDEX_INDEXINGOPTIONS_H
 
 #include "clang/Frontend/FrontendOptions.h"
+#include <functional>
 #include <memory>
 #include <string>
 
 namespace clang {
+class Decl;
+
 namespace index {
 
 struct IndexingOptions {
@@ -34,6 +37,11 @@ struct IndexingOptions {
   // Has no effect if IndexFunctionLocals are false.
   bool IndexParametersInDeclarations = false;
   bool IndexTemplateParameters = false;
+  // If set, top-level declarations for which this returns false are not
+  // traversed, e.g. because their file was already indexed. Neither they nor
+  // the declarations nested in them are reported, but references to them from
+  // other declarations are.
+  std::function<bool(const Decl *)> ShouldTraverseDecl;
 };
 
 } // namespace index
@@ -214,6 +214,34 @@ class HeaderSearch {
   };
   llvm::StringMap<LookupFileCacheInfo, llvm::BumpPtrAllocator> LookupFileCache;
 
+  /// A controlling macro saved in the persistent cache, which is only used
+  /// while its file keeps the size and modification time it had then.
+  struct PersistentGuardInfo {
+    off_t Size = 0;
+    time_t ModTime = 0;
+    std::string Macro;
+  };
+
+  /// Whether the persistent cache named by HeaderSearchOptions::
+  /// HeaderSearchCachePath has been read.
+  bool PersistentCacheLoaded = false;
+
+  /// Whether the persistent cache has to be written back.
+  bool PersistentCacheChanged = false;
+
+  /// The search path list and directory modification times that the
+  /// persistent lookups are valid for.
+  std::string PersistentCacheKey;
+
+  /// Maps the file names found by LookupFile in earlier invocations with the
+  /// same search paths to the indices in SearchDirs the search started from
+  /// and found them in.
+  llvm::StringMap<std::pair<unsigned, unsigned>> PersistentLookups;
+
+  /// Maps the absolute paths of headers to their controlling macros as seen
+  /// by earlier invocations.
+  llvm::StringMap<PersistentGuardInfo> PersistentGuards;
+
   /// Collection mapping a framework or subframework
   /// name like "Carbon" to the Carbon.framework directory.
   llvm::StringMap<FrameworkCacheEntry, llvm::BumpPtrAllocator> FrameworkMap;
@@ -255,6 +283,8 @@ class HeaderSearch {
   unsigned NumMultiIncludeFileOptzn = 0;
   unsigned NumFrameworkLookups = 0;
   unsigned NumSubFrameworkLookups = 0;
+  unsigned NumPersistentLookups = 0;
+  unsigned NumPersistentGuards = 0;
 
 public:
   HeaderSearch(std::shared_ptr<HeaderSearchOptions> HSOpts,
@@ -738,7 +768,25 @@ public:
 
   size_t getTotalMemory() const;
 
+  /// Write the lookups and controlling macros of this invocation to the
+  /// persistent cache, if HeaderSearchOptions::HeaderSearchCachePath names
+  /// one.
+  ///
+  /// Errors are ignored, as the cache only saves work.
+  void savePersistentCache();
+
 private:
+  /// Read the persistent cache the first time it is needed.
+  void loadPersistentCache();
+
+  /// Compute the key of the current search paths for the persistent cache.
+  std::string getPersistentCacheKey() const;
+
+  /// Use the controlling macro that the persistent cache has for \p File,
+  /// if the file has not changed since.
+  void usePersistentGuard(Preprocessor &PP, const FileEntry *File,
+                          HeaderFileInfo &HFI);
+
   /// Describes what happened when we tried to load a module map file.
   enum LoadModuleMapResult {
     /// The module map file had already been loaded.
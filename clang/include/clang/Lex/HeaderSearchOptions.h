@@ -113,6 +113,10 @@ public:
   /// The directory used for a user build.
   std::string ModuleUserBuildPath;
 
+  /// If non-empty, the file that keeps header lookups and controlling macros
+  /// across invocations with the same search paths.
+  std::string HeaderSearchCachePath;
+
   /// The mapping of module names to prebuilt module files.
   std::map<std::string, std::string> PrebuiltModuleFiles;
 
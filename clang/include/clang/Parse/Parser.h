@@ -368,6 +368,12 @@ class Parser : public CodeCompletionHandler {
   /// declarations/definitions when indexing.
   bool SkipFunctionBodies;
 
+  /// The function bodies deferred by -fdefer-function-bodies, in the order
+  /// they appeared, and the next one to parse once the end of the translation
+  /// unit is reached.
+  SmallVector<std::unique_ptr<LateParsedTemplate>, 0> DeferredFunctionBodies;
+  unsigned NextDeferredFunctionBody = 0;
+
   /// The location of the expression statement that is being parsed right now.
   /// Used to determine if an expression that is being parsed is a statement or
   /// just a regular sub-expression.
@@ -62,6 +62,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/VersionTuple.h"
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -73,6 +74,12 @@
 #include <utility>
 #include <vector>
 
+namespace llvm {
+
+class ThreadPool;
+
+} // namespace llvm
+
 namespace clang {
 
 class ASTConsumer;
@@ -923,6 +930,13 @@ private:
   /// Whether to accept an AST file with compiler errors.
   bool AllowASTWithCompilerErrors;
 
+  /// The thread that reads the declarations and types blocks of the mapped
+  /// precompiled headers into memory ahead of their lazy deserialization.
+  std::unique_ptr<llvm::ThreadPool> PrefetchThread;
+
+  /// Set when the reader is destroyed, to stop the prefetching early.
+  std::atomic<bool> CancelPrefetch{false};
+
   /// Whether to accept an AST file that has a different configuration
   /// from the current compiler instance.
   bool AllowConfigurationMismatch;
@@ -1300,6 +1314,11 @@ private:
   ASTReadResult ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities);
   ASTReadResult ReadExtensionBlock(ModuleFile &F);
   void ReadModuleOffsetMap(ModuleFile &F) const;
+
+  /// Start reading the pages of the declarations and types block of \p F on
+  /// the prefetch thread, so that the first deserialization of each
+  /// declaration does not wait for the file system.
+  void prefetchDeclsBlock(ModuleFile &F);
   bool ParseLineTable(ModuleFile &F, const RecordData &Record);
   bool ReadSourceManagerBlock(ModuleFile &F);
   llvm::BitstreamCursor &SLocCursorForID(int ID);
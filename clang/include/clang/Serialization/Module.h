@@ -404,6 +404,11 @@ public:
   /// jump around with these in context.
   llvm::BitstreamCursor DeclsCursor;
 
+  /// The offsets of the first and one past the last byte of the
+  /// DECLTYPES_BLOCK within \c Data.
+  uint64_t DeclsBlockStart = 0;
+  uint64_t DeclsBlockEnd = 0;
+
   /// The number of declarations in this AST file.
   unsigned LocalNumDecls = 0;
 
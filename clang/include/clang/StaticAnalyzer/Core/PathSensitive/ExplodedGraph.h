@@ -329,6 +329,10 @@ protected:
   /// A list of recently allocated nodes that can potentially be recycled.
   NodeVector ChangedNodes;
 
+  /// The recently allocated nodes that had no successor yet at the last
+  /// reclamation, and are considered again at the next one.
+  NodeVector FrontierNodes;
+
   /// A list of nodes that can be reused.
   NodeVector FreeNodes;
 
@@ -1269,6 +1269,9 @@ public:
 
   llvm::BumpPtrAllocator &getAllocator() { return A; }
 
+  /// Returns the number of regions created so far.
+  unsigned getNumRegions() const { return Regions.size(); }
+
   /// getStackLocalsRegion - Retrieve the memory region associated with the
   ///  specified stack frame.
   const StackLocalsSpaceRegion *
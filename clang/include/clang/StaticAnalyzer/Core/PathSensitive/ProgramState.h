@@ -520,6 +520,9 @@ public:
 
   llvm::BumpPtrAllocator& getAllocator() { return Alloc; }
 
+  /// Returns the number of distinct states that are in use.
+  unsigned getNumStates() const { return StateSet.size(); }
+
   MemRegionManager& getRegionManager() {
     return svalBuilder->getRegionManager();
   }
@@ -480,6 +480,9 @@ public:
 
   static bool canSymbolicate(QualType T);
 
+  /// Returns the number of symbolic expressions created so far.
+  unsigned getNumSymbols() const { return DataSet.size(); }
+
   /// Make a unique symbol for MemRegion R according to its kind.
   const SymbolRegionValue* getRegionValueSymbol(const TypedValueRegion* R);
 
@@ -15,6 +15,8 @@
 #include "clang/Frontend/PCHContainerOperations.h"
 #include "clang/Lex/PreprocessorExcludedConditionalDirectiveSkipMapping.h"
 #include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/DependencyScanning/DependencyScanningService.h"
+#include "clang/Tooling/DependencyScanning/ModuleDepCollector.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
 #include <string>
@@ -26,17 +28,29 @@ class DependencyOutputOptions;
 namespace tooling {
 namespace dependencies {
 
-class DependencyScanningService;
 class DependencyScanningWorkerFilesystem;
 
 class DependencyConsumer {
 public:
   virtual ~DependencyConsumer() {}
 
+  /// Called for each file the translation unit depends on. With the
+  /// ScanningOutputFormat::Full format, these are only the files it includes
+  /// textually.
   virtual void handleFileDependency(const DependencyOutputOptions &Opts,
                                     StringRef Filename) = 0;
 
-  // FIXME: Add support for reporting modular dependencies.
+  /// Called with the ScanningOutputFormat::Full format for each Clang module
+  /// the translation unit depends on, directly or transitively.
+  virtual void handleModuleDependency(const ModuleDeps &MD) {}
+
+  /// Called with the ScanningOutputFormat::Full format for each top level
+  /// module the translation unit imports directly.
+  virtual void handleDirectModuleDependency(StringRef ModuleName) {}
+
+  /// Called with the ScanningOutputFormat::Full format with the context hash
+  /// of the modules of the translation unit.
+  virtual void handleContextHash(std::string Hash) {}
 };
 
 /// An individual dependency scanning worker that is able to run on its own
@@ -73,6 +87,9 @@ private:
   /// The file manager that is reused accross multiple invocations by this
   /// worker. If null, the file manager will not be reused.
   llvm::IntrusiveRefCntPtr<FileManager> Files;
+  ScanningOutputFormat Format;
+  /// The modules found by all the workers of the service.
+  ModuleDepsCache &ModuleCache;
 };
 
 } // end namespace dependencies
@@ -0,0 +1,142 @@
+//===- ModuleDepCollector.h - Callbacks to collect deps ---------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_MODULE_DEP_COLLECTOR_H
+#define LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_MODULE_DEP_COLLECTOR_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/Utils.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace clang {
+
+class CompilerInstance;
+
+namespace tooling {
+namespace dependencies {
+
+class DependencyConsumer;
+
+/// The dependencies of a Clang module, which are the same for every
+/// translation unit that imports it with the same context hash.
+struct ModuleDeps {
+  /// The full name of the top level module.
+  std::string ModuleName;
+
+  /// The context hash of a module represents the set of compiler options that
+  /// may make one version of a module incompatible with another. This includes
+  /// things like language mode, predefined macros, header search paths, etc...
+  ///
+  /// Modules with the same name but a different \c ContextHash should be
+  /// treated as separate modules for the purpose of a build.
+  std::string ContextHash;
+
+  /// The path to the modulemap file which defines this module.
+  ///
+  /// This can be used to explicitly build this module. This file will
+  /// additionally appear in \c FileDeps as a dependency.
+  std::string ClangModuleMapFile;
+
+  /// The path at which the module was built by the scan, which the explicit
+  /// build may write the module to as well.
+  std::string ModulePCMPath;
+
+  /// A collection of absolute paths to files that this module directly
+  /// depends on, not including transitive dependencies.
+  llvm::StringSet<> FileDeps;
+
+  /// The names of the modules this module directly imports, not including
+  /// transitive dependencies.
+  llvm::StringSet<> ClangModuleDeps;
+};
+
+/// The modules found by all the workers of a dependency scanning service, so
+/// that the input files of each module are only collected once.
+class ModuleDepsCache {
+public:
+  /// Return the dependencies of the module \p ModuleName with the context
+  /// hash \p ContextHash, or null if no worker has collected them yet.
+  std::shared_ptr<const ModuleDeps> lookup(StringRef ContextHash,
+                                           StringRef ModuleName);
+
+  /// Record the dependencies of a module, and return the ones that are kept
+  /// if another worker recorded them first.
+  std::shared_ptr<const ModuleDeps> insert(ModuleDeps MD);
+
+private:
+  std::mutex Lock;
+  llvm::StringMap<std::shared_ptr<const ModuleDeps>> Cache;
+};
+
+class ModuleDepCollector;
+
+/// Reports the files and modules the main file depends on when it is done.
+class ModuleDepCollectorPP final : public PPCallbacks {
+public:
+  ModuleDepCollectorPP(CompilerInstance &I, ModuleDepCollector &MDC)
+      : Instance(I), MDC(MDC) {}
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override;
+  void InclusionDirective(SourceLocation HashLoc, const Token &IncludeTok,
+                          StringRef FileName, bool IsAngled,
+                          CharSourceRange FilenameRange, const FileEntry *File,
+                          StringRef SearchPath, StringRef RelativePath,
+                          const Module *Imported,
+                          SrcMgr::CharacteristicKind FileType) override;
+  void moduleImport(SourceLocation ImportLoc, ModuleIdPath Path,
+                    const Module *Imported) override;
+
+  void EndOfMainFile() override;
+
+private:
+  CompilerInstance &Instance;
+  ModuleDepCollector &MDC;
+  /// The top level modules the main file imports.
+  llvm::SetVector<const Module *> DirectDeps;
+
+  void handleImport(const Module *Imported);
+
+  /// Collect the dependencies of \p M and of the modules it imports.
+  void handleTopLevelModule(const Module *M);
+};
+
+/// Collects the modular and textual dependencies of a translation unit, and
+/// passes them to a \c DependencyConsumer.
+class ModuleDepCollector final : public DependencyCollector {
+public:
+  ModuleDepCollector(CompilerInstance &I, DependencyConsumer &C,
+                     ModuleDepsCache &Cache);
+
+  void attachToPreprocessor(Preprocessor &PP) override;
+  void attachToASTReader(ASTReader &R) override;
+
+private:
+  friend ModuleDepCollectorPP;
+
+  CompilerInstance &Instance;
+  DependencyConsumer &Consumer;
+  ModuleDepsCache &Cache;
+  std::string ContextHash;
+  /// The modules of the translation unit, by name.
+  llvm::StringMap<std::shared_ptr<const ModuleDeps>> Deps;
+};
+
+} // end namespace dependencies
+} // end namespace tooling
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_MODULE_DEP_COLLECTOR_H
@@ -20,8 +20,10 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/StringSaver.h"
 #include "llvm/Support/YAMLParser.h"
 #include <memory>
 #include <string>
@@ -97,7 +99,7 @@ private:
   JSONCompilationDatabase(std::unique_ptr<llvm::MemoryBuffer> Database,
                           JSONCommandLineSyntax Syntax)
       : Database(std::move(Database)), Syntax(Syntax),
-        YAMLStream(this->Database->getBuffer(), SM) {}
+        YAMLStream(this->Database->getBuffer(), SM), Saver(Alloc) {}
 
   /// Parses the database file and creates the index.
   ///
@@ -105,17 +107,31 @@ private:
   /// failed.
   bool parse(std::string &ErrorMessage);
 
-  // Tuple (directory, filename, commandline, output) where 'commandline'
-  // points to the corresponding scalar nodes in the YAML stream.
+  /// Creates the index of a database in strict JSON, without building the
+  /// YAML nodes of its contents. The command lines are only decoded when they
+  /// are requested.
+  ///
+  /// Returns false if the database is not in the JSON subset that is
+  /// supported, in which case it is parsed as YAML.
+  bool scan();
+
+  // A compile command of the database. Its command line is either the JSON
+  // text of the 'arguments' or 'command' value, decoded on demand, or the
+  // corresponding scalar nodes in the YAML stream.
   // If the command line contains a single argument, it is a shell-escaped
   // command line.
-  // Otherwise, each entry in the command line vector is a literal
-  // argument to the compiler.
-  // The output field may be a nullptr.
-  using CompileCommandRef =
-      std::tuple<llvm::yaml::ScalarNode *, llvm::yaml::ScalarNode *,
-                 std::vector<llvm::yaml::ScalarNode *>,
-                 llvm::yaml::ScalarNode *>;
+  // Otherwise, each entry in the command line is a literal argument to the
+  // compiler.
+  struct CompileCommandRef {
+    StringRef Directory;
+    StringRef Filename;
+    StringRef Output;
+    StringRef CommandLineText;
+    std::vector<llvm::yaml::ScalarNode *> CommandLine;
+  };
+
+  /// Adds a compile command to the index.
+  void addCommand(CompileCommandRef Command);
 
   /// Converts the given array of CompileCommandRefs to CompileCommands.
   void getCommands(ArrayRef<CompileCommandRef> CommandsRef,
@@ -134,6 +150,9 @@ private:
   JSONCommandLineSyntax Syntax;
   llvm::SourceMgr SM;
   llvm::yaml::Stream YAMLStream;
+  // The decoded fields of the compile commands.
+  llvm::BumpPtrAllocator Alloc;
+  llvm::StringSaver Saver;
 };
 
 } // namespace tooling
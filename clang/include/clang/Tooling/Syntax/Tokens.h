@@ -232,6 +232,8 @@ public:
   ///     #define DECL(name) int name = 10
   ///     DECL(a);
   /// spelledTokens() returns {"#", "define", "DECL", "(", "name", ")", "eof"}.
+  /// The files that were not recorded by the TokenCollector are lexed on the
+  /// first request. The expanded tokens can not be mapped to their tokens.
   /// FIXME: we do not yet store tokens of directives, like #include, #define,
   ///        #pragma, etc.
   llvm::ArrayRef<syntax::Token> spelledTokens(FileID FID) const;
@@ -299,9 +301,14 @@ private:
   /// #file, etc.).
   std::vector<syntax::Token> ExpandedTokens;
   llvm::DenseMap<FileID, MarkedFile> Files;
+  /// Spelled tokens of the files that are not in Files, lexed on demand.
+  mutable llvm::DenseMap<FileID, std::vector<syntax::Token>> LexedFiles;
   // The value is never null, pointer instead of reference to avoid disabling
   // implicit assignment operator.
   const SourceManager *SourceMgr;
+  /// Used to lex the files on demand. Null if the buffer was not built by a
+  /// TokenCollector.
+  const LangOptions *LangOpts = nullptr;
 };
 
 /// Lex the text buffer, corresponding to \p FID, in raw mode and record the
@@ -326,6 +333,12 @@ public:
   /// CreateASTConsumer().
   TokenCollector(Preprocessor &P);
 
+  /// Only record the spelled tokens of the main file, and the mappings of the
+  /// expanded tokens to them. The spelled tokens of the other files are lexed
+  /// when they are requested, and their expanded tokens are not mapped back to
+  /// them. This saves memory when the main file includes large headers.
+  void recordMainFileOnly() { MainFileOnly = true; }
+
   /// Finalizes token collection. Should be called after preprocessing is
   /// finished, i.e. after running Execute().
   LLVM_NODISCARD TokenBuffer consume() &&;
@@ -357,6 +370,7 @@ private:
   PPExpansions Expansions;
   Preprocessor &PP;
   CollectPPExpansions *Collector;
+  bool MainFileOnly = false;
 };
 
 } // namespace syntax
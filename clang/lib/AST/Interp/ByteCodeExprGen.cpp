@@ -155,6 +155,11 @@ bool ByteCodeExprGen<Emitter>::VisitBinaryOperator(const BinaryOperator *BO) {
     if (!this->Visit(RHS))
       return false;
     return true;
+  case BO_Assign:
+  case BO_AddAssign:
+  case BO_SubAssign:
+  case BO_MulAssign:
+    return visitAssignment(BO);
   default:
     break;
   }
@@ -205,6 +210,113 @@ bool ByteCodeExprGen<Emitter>::VisitBinaryOperator(const BinaryOperator *BO) {
   return this->bail(BO);
 }
 
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::visitAssignment(const BinaryOperator *BO) {
+  const Expr *LHS = BO->getLHS();
+  const Expr *RHS = BO->getRHS();
+  Optional<PrimType> LT = classify(LHS->getType());
+  if (!LT || LHS->refersToBitField() || !BO->isGLValue())
+    return this->bail(BO);
+
+  if (BO->getOpcode() == BO_Assign) {
+    return dereference(
+        LHS, DerefKind::Write,
+        [this, RHS](PrimType) { return visit(RHS); },
+        [this, RHS, BO](PrimType T) {
+          // Pointer on stack - store the value through it.
+          if (!visit(RHS))
+            return false;
+          return DiscardResult ? this->emitStorePop(T, BO)
+                               : this->emitStore(T, BO);
+        });
+  }
+
+  // Compound assignments which convert their operands are not supported.
+  auto *CAO = cast<CompoundAssignOperator>(BO);
+  ASTContext &ASTCtx = Ctx.getASTContext();
+  if (*LT == PT_Ptr || *LT == PT_Bool ||
+      !ASTCtx.hasSameType(CAO->getComputationLHSType(), LHS->getType()) ||
+      !ASTCtx.hasSameType(CAO->getComputationResultType(), LHS->getType()) ||
+      !ASTCtx.hasSameType(RHS->getType(), LHS->getType()))
+    return this->bail(BO);
+
+  BinaryOperatorKind Op = BinaryOperator::getOpForCompoundAssignment(
+      BO->getOpcode());
+  return dereference(
+      LHS, DerefKind::ReadWrite,
+      [this, Op, RHS, BO](PrimType T) {
+        // Value on stack - combine it with the right-hand side.
+        if (!visit(RHS))
+          return false;
+        return emitArith(Op, T, BO);
+      },
+      [this, Op, RHS, BO](PrimType T) {
+        // Pointer on stack - load, combine and store the value.
+        if (!this->emitLoad(T, BO))
+          return false;
+        if (!visit(RHS))
+          return false;
+        if (!emitArith(Op, T, BO))
+          return false;
+        return DiscardResult ? this->emitStorePop(T, BO)
+                             : this->emitStore(T, BO);
+      });
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitUnaryOperator(const UnaryOperator *UO) {
+  const Expr *SubExpr = UO->getSubExpr();
+  switch (UO->getOpcode()) {
+  case UO_PreInc:
+  case UO_PreDec:
+  case UO_PostInc:
+  case UO_PostDec:
+    break;
+  default:
+    return this->bail(UO);
+  }
+
+  // A postfix increment whose old value is used is not supported, nor are
+  // the types which are promoted before the arithmetic.
+  QualType Ty = SubExpr->getType();
+  Optional<PrimType> ST = classify(Ty);
+  if (!ST || *ST == PT_Ptr || *ST == PT_Bool || Ty->isPromotableIntegerType() ||
+      SubExpr->refersToBitField() || (UO->isPostfix() && !DiscardResult))
+    return this->bail(UO);
+
+  BinaryOperatorKind Op = UO->isIncrementOp() ? BO_Add : BO_Sub;
+  auto Step = [this, Op, SubExpr, UO](PrimType T) {
+    if (!this->emitConst(SubExpr, 1))
+      return false;
+    return emitArith(Op, T, UO);
+  };
+  return dereference(
+      SubExpr, DerefKind::ReadWrite, Step, [this, Step, UO](PrimType T) {
+        // Pointer on stack - load, step and store the value.
+        if (!this->emitLoad(T, UO))
+          return false;
+        if (!Step(T))
+          return false;
+        return DiscardResult ? this->emitStorePop(T, UO)
+                             : this->emitStore(T, UO);
+      });
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::emitArith(BinaryOperatorKind Op, PrimType T,
+                                         const Expr *E) {
+  switch (Op) {
+  case BO_Add:
+    return this->emitAdd(T, E);
+  case BO_Sub:
+    return this->emitSub(T, E);
+  case BO_Mul:
+    return this->emitMul(T, E);
+  default:
+    return this->bail(E);
+  }
+}
+
 template <class Emitter>
 bool ByteCodeExprGen<Emitter>::discard(const Expr *E) {
   OptionScope<Emitter> Scope(this, /*discardResult=*/true);
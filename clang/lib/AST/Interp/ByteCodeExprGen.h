@@ -70,6 +70,7 @@ public:
   bool VisitIntegerLiteral(const IntegerLiteral *E);
   bool VisitParenExpr(const ParenExpr *E);
   bool VisitBinaryOperator(const BinaryOperator *E);
+  bool VisitUnaryOperator(const UnaryOperator *E);
 
 protected:
   bool visitExpr(const Expr *E) override;
@@ -189,6 +190,12 @@ private:
                       DerefKind AK, llvm::function_ref<bool(PrimType)> Direct,
                       llvm::function_ref<bool(PrimType)> Indirect);
 
+  /// Compiles simple and compound assignments to primitive lvalues.
+  bool visitAssignment(const BinaryOperator *BO);
+
+  /// Emits the arithmetic of a compound assignment or an increment.
+  bool emitArith(BinaryOperatorKind Op, PrimType T, const Expr *E);
+
   /// Emits an APInt constant.
   bool emitConst(PrimType T, unsigned NumBits, const llvm::APInt &Value,
                  const Expr *E);
@@ -44,19 +44,23 @@ public:
   LoopScope(ByteCodeStmtGen<Emitter> *Ctx, LabelTy BreakLabel,
             LabelTy ContinueLabel)
       : LabelScope<Emitter>(Ctx), OldBreakLabel(Ctx->BreakLabel),
-        OldContinueLabel(Ctx->ContinueLabel) {
+        OldContinueLabel(Ctx->ContinueLabel),
+        OldLoopVarScope(Ctx->LoopVarScope) {
     this->Ctx->BreakLabel = BreakLabel;
     this->Ctx->ContinueLabel = ContinueLabel;
+    this->Ctx->LoopVarScope = Ctx->VarScope;
   }
 
   ~LoopScope() {
     this->Ctx->BreakLabel = OldBreakLabel;
     this->Ctx->ContinueLabel = OldContinueLabel;
+    this->Ctx->LoopVarScope = OldLoopVarScope;
   }
 
 private:
   OptLabelTy OldBreakLabel;
   OptLabelTy OldContinueLabel;
+  VariableScope<Emitter> *OldLoopVarScope;
 };
 
 // Sets the context for a switch scope, mapping labels.
@@ -122,6 +126,16 @@ bool ByteCodeStmtGen<Emitter>::visitStmt(const Stmt *S) {
     return visitReturnStmt(cast<ReturnStmt>(S));
   case Stmt::IfStmtClass:
     return visitIfStmt(cast<IfStmt>(S));
+  case Stmt::WhileStmtClass:
+    return visitWhileStmt(cast<WhileStmt>(S));
+  case Stmt::DoStmtClass:
+    return visitDoStmt(cast<DoStmt>(S));
+  case Stmt::ForStmtClass:
+    return visitForStmt(cast<ForStmt>(S));
+  case Stmt::BreakStmtClass:
+    return visitBreakStmt(cast<BreakStmt>(S));
+  case Stmt::ContinueStmtClass:
+    return visitContinueStmt(cast<ContinueStmt>(S));
   case Stmt::NullStmtClass:
     return true;
   default: {
@@ -226,6 +240,113 @@ bool ByteCodeStmtGen<Emitter>::visitIfStmt(const IfStmt *IS) {
   return true;
 }
 
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitWhileStmt(const WhileStmt *S) {
+  if (S->getConditionVariableDeclStmt())
+    return this->bail(S);
+
+  LabelTy CondLabel = this->getLabel();
+  LabelTy EndLabel = this->getLabel();
+  LoopScope<Emitter> LS(this, EndLabel, CondLabel);
+
+  this->emitLabel(CondLabel);
+  if (!this->visitBool(S->getCond()))
+    return false;
+  if (!this->jumpFalse(EndLabel))
+    return false;
+  if (!visitLoopBody(S->getBody()))
+    return false;
+  if (!this->jump(CondLabel))
+    return false;
+  this->emitLabel(EndLabel);
+  return true;
+}
+
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitDoStmt(const DoStmt *S) {
+  LabelTy StartLabel = this->getLabel();
+  LabelTy CondLabel = this->getLabel();
+  LabelTy EndLabel = this->getLabel();
+  LoopScope<Emitter> LS(this, EndLabel, CondLabel);
+
+  this->emitLabel(StartLabel);
+  if (!visitLoopBody(S->getBody()))
+    return false;
+  this->emitLabel(CondLabel);
+  if (!this->visitBool(S->getCond()))
+    return false;
+  if (!this->jumpTrue(StartLabel))
+    return false;
+  this->emitLabel(EndLabel);
+  return true;
+}
+
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitForStmt(const ForStmt *S) {
+  if (S->getConditionVariableDeclStmt())
+    return this->bail(S);
+
+  // The variables of the init statement live until the end of the loop.
+  BlockScope<Emitter> ForScope(this);
+  if (const Stmt *Init = S->getInit())
+    if (!visitStmt(Init))
+      return false;
+
+  LabelTy CondLabel = this->getLabel();
+  LabelTy IncLabel = this->getLabel();
+  LabelTy EndLabel = this->getLabel();
+  LoopScope<Emitter> LS(this, EndLabel, IncLabel);
+
+  this->emitLabel(CondLabel);
+  if (const Expr *Cond = S->getCond()) {
+    if (!this->visitBool(Cond))
+      return false;
+    if (!this->jumpFalse(EndLabel))
+      return false;
+  }
+  if (!visitLoopBody(S->getBody()))
+    return false;
+  this->emitLabel(IncLabel);
+  if (const Expr *Inc = S->getInc()) {
+    ExprScope<Emitter> IncScope(this);
+    if (!this->discard(Inc))
+      return false;
+  }
+  if (!this->jump(CondLabel))
+    return false;
+  this->emitLabel(EndLabel);
+  return true;
+}
+
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitBreakStmt(const BreakStmt *S) {
+  if (!BreakLabel)
+    return this->bail(S);
+  emitLoopCleanup();
+  return this->jump(*BreakLabel);
+}
+
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitContinueStmt(const ContinueStmt *S) {
+  if (!ContinueLabel)
+    return this->bail(S);
+  emitLoopCleanup();
+  return this->jump(*ContinueLabel);
+}
+
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitLoopBody(const Stmt *S) {
+  BlockScope<Emitter> BodyScope(this);
+  return visitStmt(S);
+}
+
+template <class Emitter>
+void ByteCodeStmtGen<Emitter>::emitLoopCleanup() {
+  for (VariableScope<Emitter> *C = this->VarScope; C != LoopVarScope;
+       C = C->getParent())
+    C->emitDestruction();
+}
+
 template <class Emitter>
 bool ByteCodeStmtGen<Emitter>::visitVarDecl(const VarDecl *VD) {
   auto DT = VD->getType();
@@ -247,7 +368,11 @@ bool ByteCodeStmtGen<Emitter>::visitVarDecl(const VarDecl *VD) {
     // Set the value.
     return this->emitSetLocal(*T, Off, VD);
   } else {
-    // Composite types - allocate storage and initialize it.
+    // Composite types - allocate storage and initialize it. The storage of
+    // a local is only constructed once per frame, so composite locals cannot
+    // be initialized again by the next iteration of a loop.
+    if (ContinueLabel)
+      return this->bail(VD);
     if (auto Off = this->allocateLocal(VD)) {
       return this->visitLocalInitializer(VD->getInit(), *Off);
     } else {
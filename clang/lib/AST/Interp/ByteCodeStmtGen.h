@@ -62,10 +62,21 @@ private:
   bool visitDeclStmt(const DeclStmt *DS);
   bool visitReturnStmt(const ReturnStmt *RS);
   bool visitIfStmt(const IfStmt *IS);
+  bool visitWhileStmt(const WhileStmt *S);
+  bool visitDoStmt(const DoStmt *S);
+  bool visitForStmt(const ForStmt *S);
+  bool visitBreakStmt(const BreakStmt *S);
+  bool visitContinueStmt(const ContinueStmt *S);
+
+  /// Compiles the body of a loop in its own scope.
+  bool visitLoopBody(const Stmt *S);
 
   /// Compiles a variable declaration.
   bool visitVarDecl(const VarDecl *VD);
 
+  /// Emits the destruction of the scopes a break or a continue leaves.
+  void emitLoopCleanup();
+
 private:
   /// Type of the expression returned by the function.
   llvm::Optional<PrimType> ReturnType;
@@ -79,6 +90,8 @@ private:
   OptLabelTy ContinueLabel;
   /// Default case label.
   OptLabelTy DefaultLabel;
+  /// Scope enclosing the innermost loop.
+  VariableScope<Emitter> *LoopVarScope = nullptr;
 };
 
 extern template class ByteCodeExprGen<EvalEmitter>;
@@ -559,11 +559,32 @@ private:
     }
   }
 
+  /// The matchers that can match the nodes of a kind.
+  ///
+  /// The declarations with an identifier are only matched against the
+  /// matchers that don't require a name, e.g. with \c hasName(), and the ones
+  /// that require this name.
+  struct MatcherFilter {
+    std::vector<unsigned short> All;
+    std::vector<unsigned short> Unnamed;
+    llvm::StringMap<std::vector<unsigned short>> ByName;
+  };
+
   void matchWithFilter(const ast_type_traits::DynTypedNode &DynNode) {
     auto Kind = DynNode.getNodeKind();
     auto it = MatcherFiltersMap.find(Kind);
-    const auto &Filter =
+    const MatcherFilter &Filters =
         it != MatcherFiltersMap.end() ? it->second : getFilterForKind(Kind);
+    const std::vector<unsigned short> *Indices = &Filters.All;
+    if (!Filters.ByName.empty()) {
+      const auto *ND = DynNode.get<NamedDecl>();
+      if (const IdentifierInfo *II = ND ? ND->getIdentifier() : nullptr) {
+        auto ByName = Filters.ByName.find(II->getName());
+        Indices = ByName != Filters.ByName.end() ? &ByName->second
+                                                 : &Filters.Unnamed;
+      }
+    }
+    const std::vector<unsigned short> &Filter = *Indices;
 
     if (Filter.empty())
       return;
@@ -583,14 +604,35 @@ private:
     }
   }
 
-  const std::vector<unsigned short> &
-  getFilterForKind(ast_type_traits::ASTNodeKind Kind) {
+  const MatcherFilter &getFilterForKind(ast_type_traits::ASTNodeKind Kind) {
     auto &Filter = MatcherFiltersMap[Kind];
     auto &Matchers = this->Matchers->DeclOrStmt;
     assert((Matchers.size() < USHRT_MAX) && "Too many matchers.");
+    if (RequiredNames.empty()) {
+      RequiredNames.reserve(Matchers.size());
+      for (const auto &MP : Matchers)
+        RequiredNames.push_back(MP.first.getRequiredNames());
+    }
     for (unsigned I = 0, E = Matchers.size(); I != E; ++I) {
       if (Matchers[I].first.canMatchNodesOfKind(Kind)) {
-        Filter.push_back(I);
+        Filter.All.push_back(I);
+        if (RequiredNames[I])
+          for (StringRef Name : *RequiredNames[I])
+            Filter.ByName.try_emplace(Name);
+      }
+    }
+    // Each list of ByName keeps the order of the matchers.
+    for (unsigned short I : Filter.All) {
+      if (!RequiredNames[I]) {
+        Filter.Unnamed.push_back(I);
+        for (auto &NameAndIndices : Filter.ByName)
+          NameAndIndices.second.push_back(I);
+        continue;
+      }
+      for (StringRef Name : *RequiredNames[I]) {
+        std::vector<unsigned short> &Indices = Filter.ByName[Name];
+        if (Indices.empty() || Indices.back() != I)
+          Indices.push_back(I);
       }
     }
     return Filter;
@@ -806,9 +848,12 @@ private:
   /// We precalculate a list of matchers that pass the toplevel restrict check.
   /// This also allows us to skip the restrict check at matching time. See
   /// use \c matchesNoKindCheck() above.
-  llvm::DenseMap<ast_type_traits::ASTNodeKind, std::vector<unsigned short>>
+  llvm::DenseMap<ast_type_traits::ASTNodeKind, MatcherFilter>
       MatcherFiltersMap;
 
+  /// The names required by each of the \c DeclOrStmt matchers.
+  std::vector<llvm::Optional<std::vector<StringRef>>> RequiredNames;
+
   const MatchFinder::MatchFinderOptions &Options;
   ASTContext *ActiveASTContext;
 
@@ -82,6 +82,31 @@ using VariadicOperatorFunction = bool (*)(
     const ast_type_traits::DynTypedNode &DynNode, ASTMatchFinder *Finder,
     BoundNodesTreeBuilder *Builder, ArrayRef<DynTypedMatcher> InnerMatchers);
 
+/// Returns the names required by the operator \p Func applied to
+/// \p InnerMatchers.
+llvm::Optional<std::vector<StringRef>>
+getVariadicRequiredNames(VariadicOperatorFunction Func,
+                         ArrayRef<DynTypedMatcher> InnerMatchers) {
+  if (Func == NotUnaryOperator)
+    return llvm::None;
+  // Any of the names of one of the inner matchers are needed by allOf().
+  if (Func == AllOfVariadicOperator) {
+    for (const DynTypedMatcher &InnerMatcher : InnerMatchers)
+      if (auto Names = InnerMatcher.getRequiredNames())
+        return Names;
+    return llvm::None;
+  }
+  // The node must have one of the names of the matcher that matches it.
+  std::vector<StringRef> Names;
+  for (const DynTypedMatcher &InnerMatcher : InnerMatchers) {
+    auto InnerNames = InnerMatcher.getRequiredNames();
+    if (!InnerNames)
+      return llvm::None;
+    Names.insert(Names.end(), InnerNames->begin(), InnerNames->end());
+  }
+  return Names;
+}
+
 template <VariadicOperatorFunction Func>
 class VariadicMatcher : public DynMatcherInterface {
 public:
@@ -94,6 +119,10 @@ public:
     return Func(DynNode, Finder, Builder, InnerMatchers);
   }
 
+  llvm::Optional<std::vector<StringRef>> getRequiredNames() const override {
+    return getVariadicRequiredNames(Func, InnerMatchers);
+  }
+
 private:
   std::vector<DynTypedMatcher> InnerMatchers;
 };
@@ -112,6 +141,10 @@ public:
     return Result;
   }
 
+  llvm::Optional<std::vector<StringRef>> getRequiredNames() const override {
+    return InnerMatcher->getRequiredNames();
+  }
+
 private:
   const std::string ID;
   const IntrusiveRefCntPtr<DynMatcherInterface> InnerMatcher;
@@ -545,6 +578,18 @@ bool HasNameMatcher::matchesNode(const NamedDecl &Node) const {
   return matchesNodeFullFast(Node);
 }
 
+llvm::Optional<std::vector<StringRef>>
+HasNameMatcher::getRequiredNames() const {
+  // A declaration with an identifier only matches the patterns that end with
+  // this identifier.
+  std::vector<StringRef> Result;
+  for (StringRef Name : Names) {
+    size_t Pos = Name.rfind("::");
+    Result.push_back(Pos == StringRef::npos ? Name : Name.substr(Pos + 2));
+  }
+  return Result;
+}
+
 } // end namespace internal
 
 const internal::VariadicDynCastAllOfMatcher<Stmt, ObjCAutoreleasePoolStmt>
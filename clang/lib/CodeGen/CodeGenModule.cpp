@@ -2069,15 +2069,11 @@ void CodeGenModule::EmitModuleLinkOptions() {
     NMD->addOperand(MD);
 }
 
-void CodeGenModule::EmitDeferred() {
+bool CodeGenModule::takeDeferredDecls(std::vector<GlobalDecl> &Decls) {
   // Emit deferred declare target declarations.
   if (getLangOpts().OpenMP && !getLangOpts().OpenMPSimd)
     getOpenMPRuntime().emitDeferredTargetDecls();
 
-  // Emit code for any potentially referenced deferred decls.  Since a
-  // previously unused static decl may become used during the generation of code
-  // for a static function, iterate until no changes are made.
-
   if (!DeferredVTables.empty()) {
     EmitDeferredVTables();
 
@@ -2089,14 +2085,41 @@ void CodeGenModule::EmitDeferred() {
 
   // Stop if we're out of both deferred vtables and deferred declarations.
   if (DeferredDeclsToEmit.empty())
-    return;
+    return false;
 
   // Grab the list of decls to emit. If EmitGlobalDefinition schedules more
   // work, it will not interfere with this.
+  Decls.swap(DeferredDeclsToEmit);
+  return true;
+}
+
+void CodeGenModule::EmitDeferred() {
+  // Emit code for any potentially referenced deferred decls.  Since a
+  // previously unused static decl may become used during the generation of code
+  // for a static function, iterate until no changes are made.
+  //
+  // The decls are emitted in a DFS, so that related ones are close together,
+  // which is convenient for testing. The DFS keeps its own stack of pending
+  // lists rather than recursing, as generated code can have call chains deep
+  // enough to exhaust the stack otherwise.
+  struct PendingDecls {
+    std::vector<GlobalDecl> Decls;
+    size_t Next = 0;
+  };
+  SmallVector<PendingDecls, 8> Stack;
   std::vector<GlobalDecl> CurDeclsToEmit;
-  CurDeclsToEmit.swap(DeferredDeclsToEmit);
+  if (!takeDeferredDecls(CurDeclsToEmit))
+    return;
+  Stack.push_back({std::move(CurDeclsToEmit)});
+
+  while (!Stack.empty()) {
+    PendingDecls &Top = Stack.back();
+    if (Top.Next == Top.Decls.size()) {
+      Stack.pop_back();
+      continue;
+    }
+    GlobalDecl D = Top.Decls[Top.Next++];
 
-  for (GlobalDecl &D : CurDeclsToEmit) {
     // We should call GetAddrOfGlobal with IsForDefinition set to true in order
     // to get GlobalValue with exactly the type we need, not something that
     // might had been created for another decl with the same mangled name but
@@ -2129,14 +2152,15 @@ void CodeGenModule::EmitDeferred() {
     // Otherwise, emit the definition and move on to the next one.
     EmitGlobalDefinition(D, GV);
 
-    // If we found out that we need to emit more decls, do that recursively.
-    // This has the advantage that the decls are emitted in a DFS and related
-    // ones are close together, which is convenient for testing.
+    // If we found out that we need to emit more decls, do that before the
+    // rest of the current list.
     if (!DeferredVTables.empty() || !DeferredDeclsToEmit.empty()) {
-      EmitDeferred();
-      assert(DeferredVTables.empty() && DeferredDeclsToEmit.empty());
+      std::vector<GlobalDecl> NewDecls;
+      if (takeDeferredDecls(NewDecls))
+        Stack.push_back({std::move(NewDecls)});
     }
   }
+  assert(DeferredVTables.empty() && DeferredDeclsToEmit.empty());
 }
 
 void CodeGenModule::EmitVTablesOpportunistically() {
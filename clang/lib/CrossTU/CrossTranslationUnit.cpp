@@ -18,6 +18,7 @@
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Index/USRGeneration.h"
+#include "clang/Serialization/ASTReader.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -49,6 +50,9 @@ STATISTIC(NumLangMismatch, "The # of language mismatches");
 STATISTIC(NumLangDialectMismatch, "The # of language dialect mismatches");
 STATISTIC(NumASTLoadThresholdReached,
           "The # of ASTs not loaded because of threshold");
+STATISTIC(NumASTUnloaded,
+          "The # of ASTs unloaded because of the memory limit");
+STATISTIC(NumDefFoundByName, "The # of definitions found by name lookup");
 
 // Same as Triple's equality operator, but we check a field only if that is
 // known in both instances.
@@ -79,6 +83,22 @@ bool hasEqualKnownFields(const llvm::Triple &Lhs, const llvm::Triple &Rhs) {
   return true;
 }
 
+// Returns the memory taken by the AST and the source files of a unit, and by
+// the AST files it was loaded from.
+uint64_t getMemoryUsage(const ASTUnit &Unit) {
+  const ASTContext &Ctx = Unit.getASTContext();
+  const SourceManager &SM = Unit.getSourceManager();
+  SourceManager::MemoryBufferSizes Buffers = SM.getMemoryBufferSizes();
+  uint64_t Size = Ctx.getASTAllocatedMemory() +
+                  Ctx.getSideTableAllocatedMemory() +
+                  SM.getDataStructureSizes() + Buffers.malloc_bytes +
+                  Buffers.mmap_bytes;
+  if (IntrusiveRefCntPtr<ASTReader> Reader = Unit.getASTReader())
+    for (const serialization::ModuleFile &MF : Reader->getModuleManager())
+      Size += MF.Buffer->getBufferSize();
+  return Size;
+}
+
 // FIXME: This class is will be removed after the transition to llvm::Error.
 class IndexErrorCategory : public std::error_category {
 public:
@@ -188,7 +208,9 @@ template <typename T> static bool hasBodyOrInit(const T *D) {
 }
 
 CrossTranslationUnitContext::CrossTranslationUnitContext(CompilerInstance &CI)
-    : Context(CI.getASTContext()), ASTStorage(CI) {}
+    : Context(CI.getASTContext()), ASTStorage(CI) {
+  ASTStorage.setUnloadHandler([this](ASTUnit &Unit) { forgetASTUnit(Unit); });
+}
 
 CrossTranslationUnitContext::~CrossTranslationUnitContext() {}
 
@@ -226,6 +248,60 @@ CrossTranslationUnitContext::findDefInDeclContext(const DeclContext *DC,
   return nullptr;
 }
 
+/// Looks up the definition with the given USR by the names of \p D and of its
+/// enclosing namespaces and classes. Unlike findDefInDeclContext, this only
+/// deserializes the declarations with these names from the AST file. Returns
+/// null if the definition is not found this way, e.g. since some of these
+/// names is not an identifier.
+template <typename T>
+const T *CrossTranslationUnitContext::findDefByName(const T *D,
+                                                    ASTContext &From,
+                                                    StringRef LookupName) {
+  auto GetName = [&From](const NamedDecl *ND) -> DeclarationName {
+    if (const IdentifierInfo *II = ND->getIdentifier())
+      return &From.Idents.get(II->getName());
+    return DeclarationName();
+  };
+
+  SmallVector<const NamedDecl *, 4> Contexts;
+  for (const DeclContext *DC = D->getDeclContext()->getRedeclContext();
+       !DC->isTranslationUnit(); DC = DC->getParent()->getRedeclContext()) {
+    if (!isa<NamespaceDecl>(DC) && !isa<CXXRecordDecl>(DC))
+      return nullptr;
+    Contexts.push_back(cast<NamedDecl>(DC));
+  }
+
+  const DeclContext *DC = From.getTranslationUnitDecl();
+  for (const NamedDecl *Context : llvm::reverse(Contexts)) {
+    DeclarationName Name = GetName(Context);
+    if (!Name)
+      return nullptr;
+    const DeclContext *Found = nullptr;
+    for (const NamedDecl *ND : DC->lookup(Name))
+      if (ND->getKind() == Context->getKind()) {
+        Found = cast<DeclContext>(ND);
+        break;
+      }
+    if (!Found)
+      return nullptr;
+    DC = Found;
+  }
+
+  DeclarationName Name = GetName(D);
+  if (!Name)
+    return nullptr;
+  for (const NamedDecl *ND : DC->lookup(Name)) {
+    const auto *Candidate = dyn_cast<T>(ND);
+    const T *ResultDecl;
+    if (!Candidate || !hasBodyOrInit(Candidate, ResultDecl))
+      continue;
+    llvm::Optional<std::string> ResultLookupName = getLookupName(ResultDecl);
+    if (ResultLookupName && *ResultLookupName == LookupName)
+      return ResultDecl;
+  }
+  return nullptr;
+}
+
 template <typename T>
 llvm::Expected<const T *> CrossTranslationUnitContext::getCrossTUDefinitionImpl(
     const T *D, StringRef CrossTUDir, StringRef IndexName,
@@ -294,6 +370,13 @@ llvm::Expected<const T *> CrossTranslationUnitContext::getCrossTUDefinitionImpl(
         index_error_code::lang_dialect_mismatch);
   }
 
+  // Visiting all the declarations of the unit would deserialize them, so the
+  // definition is looked up by name first.
+  if (const T *ResultDecl =
+          findDefByName(D, Unit->getASTContext(), *LookupName)) {
+    ++NumDefFoundByName;
+    return importDefinition(ResultDecl, Unit);
+  }
   TranslationUnitDecl *TU = Unit->getASTContext().getTranslationUnitDecl();
   if (const T *ResultDecl = findDefInDeclContext<T>(TU, *LookupName))
     return importDefinition(ResultDecl, Unit);
@@ -364,7 +447,11 @@ CrossTranslationUnitContext::ASTUnitStorage::ASTUnitStorage(
     const CompilerInstance &CI)
     : FileAccessor(CI), LoadGuard(const_cast<CompilerInstance &>(CI)
                                       .getAnalyzerOpts()
-                                      ->CTUImportThreshold) {}
+                                      ->CTUImportThreshold),
+      MemoryLimit(uint64_t(const_cast<CompilerInstance &>(CI)
+                               .getAnalyzerOpts()
+                               ->CTUMaxLoadedASTMemory)
+                  << 20) {}
 
 llvm::Expected<ASTUnit *>
 CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFile(
@@ -388,17 +475,63 @@ CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFile(
 
     // Update the cache.
     FileASTUnitMap[FileName] = std::move(LoadedUnit);
+    LastUseOfFile[FileName] = ++UseCount;
 
     LoadGuard.indicateLoadSuccess();
 
     if (DisplayCTUProgress)
       llvm::errs() << "CTU loaded AST file: " << FileName << "\n";
 
+    unloadLeastRecentlyUsed(Unit, DisplayCTUProgress);
     return Unit;
 
   } else {
     // Found in the cache.
-    return ASTCacheEntry->second.get();
+    ASTUnit *Unit = ASTCacheEntry->second.get();
+    LastUseOfFile[FileName] = ++UseCount;
+    unloadLeastRecentlyUsed(Unit, DisplayCTUProgress);
+    return Unit;
+  }
+}
+
+void CrossTranslationUnitContext::ASTUnitStorage::unloadLeastRecentlyUsed(
+    const ASTUnit *InUse, bool DisplayCTUProgress) {
+  if (!MemoryLimit)
+    return;
+
+  // The memory of a unit grows as its declarations are deserialized, so it is
+  // computed again each time.
+  uint64_t Used = 0;
+  for (const auto &FileAndUnit : FileASTUnitMap)
+    Used += getMemoryUsage(*FileAndUnit.second);
+
+  while (Used > MemoryLimit) {
+    auto Victim = FileASTUnitMap.end();
+    for (auto I = FileASTUnitMap.begin(), E = FileASTUnitMap.end(); I != E;
+         ++I)
+      if (I->second.get() != InUse &&
+          (Victim == E ||
+           LastUseOfFile[I->first()] < LastUseOfFile[Victim->first()]))
+        Victim = I;
+    if (Victim == FileASTUnitMap.end())
+      return;
+
+    ASTUnit *Unit = Victim->second.get();
+    Used -= getMemoryUsage(*Unit);
+    if (UnloadHandler)
+      UnloadHandler(*Unit);
+    for (auto I = NameASTUnitMap.begin(), E = NameASTUnitMap.end(); I != E;) {
+      auto Cur = I++;
+      if (Cur->second == Unit)
+        NameASTUnitMap.erase(Cur);
+    }
+
+    ++NumASTUnloaded;
+    if (DisplayCTUProgress)
+      llvm::errs() << "CTU unloaded AST file: " << Victim->first() << "\n";
+
+    LastUseOfFile.erase(Victim->first());
+    FileASTUnitMap.erase(Victim);
   }
 }
 
@@ -436,6 +569,7 @@ CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFunction(
     }
   } else {
     // Found in the cache.
+    LastUseOfFile[NameFileMap[FunctionName]] = ++UseCount;
     return ASTCacheEntry->second;
   }
 }
@@ -566,6 +700,17 @@ CrossTranslationUnitContext::getOrCreateASTImporter(ASTUnit *Unit) {
   return *NewImporter;
 }
 
+void CrossTranslationUnitContext::forgetASTUnit(ASTUnit &Unit) {
+  ASTUnitImporterMap.erase(Unit.getASTContext().getTranslationUnitDecl());
+  // The imported declarations are kept, but their locations can not be mapped
+  // back to the unloaded unit any more.
+  for (auto I = ImportedFileIDs.begin(), E = ImportedFileIDs.end(); I != E;) {
+    auto Cur = I++;
+    if (Cur->second.second == &Unit)
+      ImportedFileIDs.erase(Cur);
+  }
+}
+
 llvm::Optional<std::pair<SourceLocation, ASTUnit *>>
 CrossTranslationUnitContext::getImportedFromSourceLocation(
     const clang::SourceLocation &ToLoc) const {
@@ -2426,7 +2426,9 @@ reformat(const FormatStyle &Style, StringRef Code,
     if (NewCode) {
       Fixes = Fixes.merge(PassFixes.first);
       Penalty += PassFixes.second;
-      if (I + 1 < E) {
+      // Keep the environment, and the tokens and lines parsed in it, if the
+      // pass did not change the code.
+      if (I + 1 < E && !PassFixes.first.empty()) {
         CurrentCode = std::move(*NewCode);
         Env = std::make_unique<Environment>(
             *CurrentCode, FileName,
@@ -64,12 +64,24 @@ TokenAnalyzer::TokenAnalyzer(const Environment &Env, const FormatStyle &Style)
 
 std::pair<tooling::Replacements, unsigned> TokenAnalyzer::process() {
   tooling::Replacements Result;
-  FormatTokenLexer Tokens(Env.getSourceManager(), Env.getFileID(),
-                          Env.getFirstStartColumn(), Style, Encoding);
-
-  UnwrappedLineParser Parser(Style, Tokens.getKeywords(),
-                             Env.getFirstStartColumn(), Tokens.lex(), *this);
-  Parser.parse();
+  Environment::ParseResult *Parsed = Env.getParseResult(Style);
+  if (!Parsed) {
+    auto NewParsed = std::make_unique<Environment::ParseResult>();
+    NewParsed->Style = Style;
+    NewParsed->Tokens = std::make_unique<FormatTokenLexer>(
+        Env.getSourceManager(), Env.getFileID(), Env.getFirstStartColumn(),
+        Style, Encoding);
+    UnwrappedLineParser Parser(Style, NewParsed->Tokens->getKeywords(),
+                               Env.getFirstStartColumn(),
+                               NewParsed->Tokens->lex(), *this);
+    Parser.parse();
+    NewParsed->UnwrappedLines = std::move(UnwrappedLines);
+    Parsed = NewParsed.get();
+    Env.setParseResult(std::move(NewParsed));
+  }
+  // Like the runs, the analyzers sharing the tokens annotate them again.
+  FormatTokenLexer &Tokens = *Parsed->Tokens;
+  const auto &UnwrappedLines = Parsed->UnwrappedLines;
   assert(UnwrappedLines.rbegin()->empty());
   unsigned Penalty = 0;
   for (unsigned Run = 0, RunE = UnwrappedLines.size(); Run + 1 != RunE; ++Run) {
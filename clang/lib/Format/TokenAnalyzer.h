@@ -62,6 +62,24 @@ public:
   // environment should end if it ends in a newline.
   unsigned getLastStartColumn() const { return LastStartColumn; }
 
+  // The tokens of the code and its unwrapped lines, for each run.
+  struct ParseResult {
+    FormatStyle Style;
+    std::unique_ptr<FormatTokenLexer> Tokens;
+    SmallVector<SmallVector<UnwrappedLine, 16>, 2> UnwrappedLines;
+  };
+
+  // Returns the result of parsing the code with \p Style, if an analyzer did
+  // so already. The analyzers that run on the same environment share it
+  // instead of lexing and parsing the code again.
+  ParseResult *getParseResult(const FormatStyle &Style) const {
+    return Parsed && Parsed->Style == Style ? Parsed.get() : nullptr;
+  }
+
+  void setParseResult(std::unique_ptr<ParseResult> Result) const {
+    Parsed = std::move(Result);
+  }
+
 private:
   // This is only set if constructed from string.
   std::unique_ptr<SourceManagerForFile> VirtualSM;
@@ -75,6 +93,8 @@ private:
   unsigned FirstStartColumn;
   unsigned NextStartColumn;
   unsigned LastStartColumn;
+
+  mutable std::unique_ptr<ParseResult> Parsed;
 };
 
 class TokenAnalyzer : public UnwrappedLineConsumer {
@@ -974,6 +974,14 @@ private:
         // State already examined with lower penalty.
         continue;
 
+      // Bound the time spent on a single line, e.g. on the long braced lists
+      // of generated tables: complete the most promising solution found so
+      // far, without exploring the alternatives any more.
+      if (Count > 200000) {
+        LLVM_DEBUG(llvm::dbgs() << "Too many states, completing greedily.\n");
+        return completeGreedily(InitialState, Node, Penalty, DryRun);
+      }
+
       FormatDecision LastFormat = Node->State.NextToken->Decision;
       if (LastFormat == FD_Unformatted || LastFormat == FD_Continue)
         addNextStateToQueue(Penalty, Node, /*NewLine=*/false, &Count, &Queue);
@@ -999,6 +1007,46 @@ private:
     return Penalty;
   }
 
+  /// Complete the solution from \p Node, which has been reached with a penalty
+  /// of \p Penalty, by breaking the line only when the next token must be or no
+  /// longer fits. Returns the penalty.
+  ///
+  /// If \p DryRun is \c false, directly applies the changes.
+  unsigned completeGreedily(LineState &InitialState, StateNode *Node,
+                            unsigned Penalty, bool DryRun) {
+    while (Node->State.NextToken) {
+      const LineState &State = Node->State;
+      const FormatToken &Next = *State.NextToken;
+      bool NewLine;
+      if (Next.Decision != FD_Unformatted)
+        NewLine = Next.Decision == FD_Break;
+      else
+        NewLine = State.Column + Next.SpacesRequiredBefore + Next.ColumnWidth >
+                  Indenter->getColumnLimit(State);
+      if (Indenter->mustBreak(State))
+        NewLine = true;
+      else if (!Indenter->canBreak(State))
+        NewLine = false;
+
+      auto *NextNode =
+          new (Allocator.Allocate()) StateNode(State, NewLine, Node);
+      if (!formatChildren(NextNode->State, NewLine, /*DryRun=*/true,
+                          Penalty)) {
+        // The children do not fit on this line, put them on their own lines.
+        NextNode->NewLine = true;
+        formatChildren(NextNode->State, /*NewLine=*/true, /*DryRun=*/true,
+                       Penalty);
+      }
+      Penalty +=
+          Indenter->addTokenToState(NextNode->State, NextNode->NewLine, true);
+      Node = NextNode;
+    }
+
+    if (!DryRun)
+      reconstructPath(InitialState, Node);
+    return Penalty;
+  }
+
   /// Add the following state to the analysis queue \c Queue.
   ///
   /// Assume the current state is \p PreviousNode and has been reached with a
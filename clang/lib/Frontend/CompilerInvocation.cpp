@@ -500,6 +500,10 @@ static void parseAnalyzerConfigs(AnalyzerOptions &AnOpts,
     Diags->Report(diag::err_analyzer_config_invalid_input)
         << "track-conditions-debug" << "'track-conditions' to also be enabled";
 
+  if (AnOpts.ShardIndex >= AnOpts.ShardCount)
+    Diags->Report(diag::err_analyzer_config_invalid_input)
+        << "shard-index" << "a value less than 'shard-count'";
+
   if (!AnOpts.CTUDir.empty() && !llvm::sys::fs::is_directory(AnOpts.CTUDir))
     Diags->Report(diag::err_analyzer_config_invalid_input) << "ctu-dir"
                                                            << "a filename";
@@ -2028,8 +2032,47 @@ std::string CompilerInvocation::GetResourcesPath(const char *Argv0,
   return Driver::GetResourcesPath(ClangExecutable, CLANG_RESOURCE_DIR);
 }
 
+/// Add the <name>=<file> lines of the -fmodule-file-map file \p A names to
+/// the prebuilt module files.
+static void parseModuleFileMap(HeaderSearchOptions &Opts, const Arg *A,
+                               ArgList &Args, const std::string &WorkingDir,
+                               DiagnosticsEngine &Diags) {
+  SmallString<128> MapPath(A->getValue());
+  if (!WorkingDir.empty())
+    llvm::sys::fs::make_absolute(WorkingDir, MapPath);
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(MapPath);
+  if (!Buffer) {
+    Diags.Report(diag::err_cannot_open_file)
+        << MapPath << Buffer.getError().message();
+    return;
+  }
+
+  SmallVector<StringRef, 64> Lines;
+  (*Buffer)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                               /*KeepEmpty=*/false);
+  for (StringRef Line : Lines) {
+    Line = Line.trim();
+    if (Line.empty() || Line.startswith("#"))
+      continue;
+    StringRef Name, File;
+    std::tie(Name, File) = Line.split('=');
+    if (Name.empty() || File.empty()) {
+      Diags.Report(diag::err_drv_invalid_value) << A->getAsString(Args) << Line;
+      continue;
+    }
+    SmallString<128> Path(File);
+    if (!llvm::sys::path::is_absolute(Path)) {
+      Path = llvm::sys::path::parent_path(MapPath);
+      llvm::sys::path::append(Path, File);
+    }
+    Opts.PrebuiltModuleFiles.insert(std::make_pair(Name.str(), Path.str()));
+  }
+}
+
 static void ParseHeaderSearchArgs(HeaderSearchOptions &Opts, ArgList &Args,
-                                  const std::string &WorkingDir) {
+                                  const std::string &WorkingDir,
+                                  DiagnosticsEngine &Diags) {
   Opts.Sysroot = Args.getLastArgValue(OPT_isysroot, "/");
   Opts.Verbose = Args.hasArg(OPT_v);
   Opts.UseBuiltinIncludes = !Args.hasArg(OPT_nobuiltininc);
@@ -2051,12 +2094,16 @@ static void ParseHeaderSearchArgs(HeaderSearchOptions &Opts, ArgList &Args,
   Opts.ModuleCachePath = P.str();
 
   Opts.ModuleUserBuildPath = Args.getLastArgValue(OPT_fmodules_user_build_path);
+  Opts.HeaderSearchCachePath = Args.getLastArgValue(OPT_header_search_cache);
   // Only the -fmodule-file=<name>=<file> form.
   for (const auto *A : Args.filtered(OPT_fmodule_file)) {
     StringRef Val = A->getValue();
     if (Val.find('=') != StringRef::npos)
       Opts.PrebuiltModuleFiles.insert(Val.split('='));
   }
+  // The mappings of -fmodule-file= take precedence over the maps.
+  for (const auto *A : Args.filtered(OPT_fmodule_file_map_EQ))
+    parseModuleFileMap(Opts, A, Args, WorkingDir, Diags);
   for (const auto *A : Args.filtered(OPT_fprebuilt_module_path))
     Opts.AddPrebuiltModulePath(A->getValue());
   Opts.DisableModuleHash = Args.hasArg(OPT_fdisable_module_hash);
@@ -2802,6 +2849,7 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
       Args.hasArg(OPT_fforce_experimental_new_constant_interpreter);
   Opts.BracketDepth = getLastArgIntValue(Args, OPT_fbracket_depth, 256, Diags);
   Opts.DelayedTemplateParsing = Args.hasArg(OPT_fdelayed_template_parsing);
+  Opts.DeferFunctionBodies = Args.hasArg(OPT_fdefer_function_bodies);
   Opts.NumLargeByValueCopy =
       getLastArgIntValue(Args, OPT_Wlarge_by_value_copy_EQ, 0, Diags);
   Opts.MSBitfields = Args.hasArg(OPT_mms_bitfields);
@@ -3192,6 +3240,7 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
 
   Opts.CompleteMemberPointers = Args.hasArg(OPT_fcomplete_member_pointers);
   Opts.BuildingPCHWithObjectFile = Args.hasArg(OPT_building_pch_with_obj);
+  Opts.PCHInstantiateTemplates = Args.hasArg(OPT_fpch_instantiate_templates);
 }
 
 static bool isStrictlyPreprocessorAction(frontend::ActionKind Action) {
@@ -3441,7 +3490,7 @@ bool CompilerInvocation::CreateFromArgs(CompilerInvocation &Res,
   Success &= ParseCodeGenArgs(Res.getCodeGenOpts(), Args, DashX, Diags,
                               Res.getTargetOpts(), Res.getFrontendOpts());
   ParseHeaderSearchArgs(Res.getHeaderSearchOpts(), Args,
-                        Res.getFileSystemOpts().WorkingDir);
+                        Res.getFileSystemOpts().WorkingDir, Diags);
   llvm::Triple T(Res.getTargetOpts().Triple);
   if (DashX.getFormat() == InputKind::Precompiled ||
       DashX.getLanguage() == Language::LLVM_IR) {
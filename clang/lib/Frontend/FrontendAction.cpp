@@ -961,8 +961,10 @@ void FrontendAction::EndSourceFile() {
   CI.getDiagnosticClient().EndSourceFile();
 
   // Inform the preprocessor we are done.
-  if (CI.hasPreprocessor())
+  if (CI.hasPreprocessor()) {
     CI.getPreprocessor().EndSourceFile();
+    CI.getPreprocessor().getHeaderSearchInfo().savePersistentCache();
+  }
 
   // Finalize the action.
   EndSourceFileAction();
@@ -30,11 +30,14 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Capacity.h"
+#include "llvm/Support/Chrono.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
@@ -95,6 +98,167 @@ void HeaderSearch::PrintStats() {
 
   fprintf(stderr, "%d framework lookups.\n", NumFrameworkLookups);
   fprintf(stderr, "%d subframework lookups.\n", NumSubFrameworkLookups);
+
+  if (!HSOpts->HeaderSearchCachePath.empty()) {
+    fprintf(stderr, "%d lookups from the header search cache.\n",
+            NumPersistentLookups);
+    fprintf(stderr, "%d controlling macros from the header search cache.\n",
+            NumPersistentGuards);
+  }
+}
+
+/// The first word of a persistent cache file. Changes to the format of the
+/// file must change it.
+static const char PersistentCacheMagic[] = "clang-header-search-cache-v1";
+
+std::string HeaderSearch::getPersistentCacheKey() const {
+  llvm::vfs::FileSystem &FS = FileMgr.getVirtualFileSystem();
+  llvm::hash_code Hash =
+      llvm::hash_combine(AngledDirIdx, SystemDirIdx, NoCurDirSearch);
+  // Relative search paths name different directories in different working
+  // directories.
+  if (llvm::ErrorOr<std::string> CWD = FS.getCurrentWorkingDirectory())
+    Hash = llvm::hash_combine(Hash, *CWD);
+  // Adding or removing a header in a search directory updates the
+  // modification time of the directory.
+  for (const DirectoryLookup &DL : SearchDirs) {
+    Hash = llvm::hash_combine(Hash, DL.getName(), DL.getLookupType(),
+                              DL.getDirCharacteristic());
+    if (llvm::ErrorOr<llvm::vfs::Status> Status = FS.status(DL.getName()))
+      Hash = llvm::hash_combine(
+          Hash, llvm::sys::toTimeT(Status->getLastModificationTime()));
+  }
+  return llvm::APInt(64, size_t(Hash)).toString(36, /*Signed=*/false);
+}
+
+void HeaderSearch::loadPersistentCache() {
+  if (PersistentCacheLoaded)
+    return;
+  PersistentCacheLoaded = true;
+  PersistentCacheKey = getPersistentCacheKey();
+
+  // Large caches are mapped rather than read.
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(HSOpts->HeaderSearchCachePath);
+  if (!Buffer)
+    return;
+
+  // The first line is the magic word and the key of the search paths. Each of
+  // the others is either "L <start index> <hit index> <file name>" or
+  // "G <size> <modification time> <macro> <path>".
+  StringRef Line, Rest = (*Buffer)->getBuffer();
+  std::tie(Line, Rest) = Rest.split('\n');
+  StringRef Magic, Key;
+  std::tie(Magic, Key) = Line.split(' ');
+  if (Magic != PersistentCacheMagic)
+    return;
+
+  // The controlling macros do not depend on the search paths, so only the
+  // lookups are dropped when they change.
+  bool KeyMatches = Key == PersistentCacheKey;
+  if (!KeyMatches)
+    PersistentCacheChanged = true;
+
+  while (!Rest.empty()) {
+    std::tie(Line, Rest) = Rest.split('\n');
+    StringRef Kind, First, Second, Name;
+    std::tie(Kind, Line) = Line.split(' ');
+    std::tie(First, Line) = Line.split(' ');
+    std::tie(Second, Name) = Line.split(' ');
+    if (Kind == "L") {
+      unsigned StartIdx, HitIdx;
+      if (KeyMatches && !First.getAsInteger(10, StartIdx) &&
+          !Second.getAsInteger(10, HitIdx) && StartIdx <= HitIdx &&
+          HitIdx < SearchDirs.size() && !Name.empty())
+        PersistentLookups[Name] = std::make_pair(StartIdx, HitIdx);
+    } else if (Kind == "G") {
+      PersistentGuardInfo Guard;
+      StringRef Macro, Path;
+      std::tie(Macro, Path) = Name.split(' ');
+      if (!First.getAsInteger(10, Guard.Size) &&
+          !Second.getAsInteger(10, Guard.ModTime) && !Macro.empty() &&
+          !Path.empty()) {
+        Guard.Macro = Macro;
+        PersistentGuards[Path] = std::move(Guard);
+      }
+    }
+  }
+}
+
+void HeaderSearch::savePersistentCache() {
+  StringRef CachePath = HSOpts->HeaderSearchCachePath;
+  if (CachePath.empty())
+    return;
+  loadPersistentCache();
+
+  // Remember the controlling macros of the headers lexed by this invocation.
+  SmallVector<const FileEntry *, 16> UIDToFiles;
+  FileMgr.GetUniqueIDMapping(UIDToFiles);
+  for (unsigned UID = 0, E = std::min<size_t>(UIDToFiles.size(),
+                                              FileInfo.size());
+       UID != E; ++UID) {
+    const HeaderFileInfo &HFI = FileInfo[UID];
+    const FileEntry *FE = UIDToFiles[UID];
+    if (!FE || HFI.External || !HFI.ControllingMacro)
+      continue;
+    SmallString<256> Path(FE->getName());
+    FileMgr.makeAbsolutePath(Path);
+    PersistentGuardInfo &Guard = PersistentGuards[Path];
+    if (Guard.Size == FE->getSize() &&
+        Guard.ModTime == FE->getModificationTime() &&
+        Guard.Macro == HFI.ControllingMacro->getName())
+      continue;
+    Guard.Size = FE->getSize();
+    Guard.ModTime = FE->getModificationTime();
+    Guard.Macro = HFI.ControllingMacro->getName();
+    PersistentCacheChanged = true;
+  }
+
+  if (!PersistentCacheChanged)
+    return;
+
+  // Write a temporary file and rename it over the cache, so that concurrent
+  // invocations read either the old or the new cache.
+  int FD;
+  SmallString<128> TempPath;
+  if (llvm::sys::fs::createUniqueFile(CachePath + "-%%%%%%%%", FD, TempPath))
+    return;
+  llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+  OS << PersistentCacheMagic << ' ' << PersistentCacheKey << '\n';
+  for (const auto &Lookup : PersistentLookups)
+    if (Lookup.first().find('\n') == StringRef::npos)
+      OS << "L " << Lookup.second.first << ' ' << Lookup.second.second << ' '
+         << Lookup.first() << '\n';
+  for (const auto &Guard : PersistentGuards)
+    if (Guard.first().find('\n') == StringRef::npos)
+      OS << "G " << static_cast<int64_t>(Guard.second.Size) << ' '
+         << static_cast<int64_t>(Guard.second.ModTime) << ' '
+         << Guard.second.Macro << ' ' << Guard.first() << '\n';
+  OS.close();
+  if (OS.has_error() || llvm::sys::fs::rename(TempPath, CachePath)) {
+    OS.clear_error();
+    llvm::sys::fs::remove(TempPath);
+    return;
+  }
+  PersistentCacheChanged = false;
+}
+
+void HeaderSearch::usePersistentGuard(Preprocessor &PP, const FileEntry *File,
+                                      HeaderFileInfo &HFI) {
+  loadPersistentCache();
+  SmallString<256> Path(File->getName());
+  FileMgr.makeAbsolutePath(Path);
+  auto Guard = PersistentGuards.find(Path);
+  if (Guard == PersistentGuards.end())
+    return;
+  if (Guard->second.Size != File->getSize() ||
+      Guard->second.ModTime != File->getModificationTime()) {
+    PersistentGuards.erase(Guard);
+    PersistentCacheChanged = true;
+    return;
+  }
+  HFI.ControllingMacro = PP.getIdentifierInfo(Guard->second.Macro);
+  ++NumPersistentGuards;
 }
 
 /// CreateHeaderMap - This method returns a HeaderMap for the specified
@@ -861,6 +1025,19 @@ Optional<FileEntryRef> HeaderSearch::LookupFile(
   // (potentially huge) series of SearchDirs to find it.
   LookupFileCacheInfo &CacheLookup = LookupFileCache[Filename];
 
+  // The persistent cache has the lookups of earlier invocations with the same
+  // search paths.
+  bool UsePersistentCache = !HSOpts->HeaderSearchCachePath.empty();
+  if (UsePersistentCache && !CacheLookup.StartIdx) {
+    loadPersistentCache();
+    auto Lookup = PersistentLookups.find(Filename);
+    if (Lookup != PersistentLookups.end()) {
+      CacheLookup.StartIdx = Lookup->second.first + 1;
+      CacheLookup.HitIdx = Lookup->second.second;
+      ++NumPersistentLookups;
+    }
+  }
+
   // If the entry has been previously looked up, the first value will be
   // non-zero.  If the value is equal to i (the start point of our search), then
   // this is a matching hit.
@@ -956,9 +1133,23 @@ Optional<FileEntryRef> HeaderSearch::LookupFile(
 
     // Remember this location for the next lookup we do.
     CacheLookup.HitIdx = i;
+
+    // Header maps may map the name differently in other invocations.
+    if (UsePersistentCache && !CacheLookup.MappedName &&
+        !CurDir->isHeaderMap()) {
+      std::pair<unsigned, unsigned> Lookup(CacheLookup.StartIdx - 1, i);
+      auto Inserted = PersistentLookups.insert({Filename, Lookup});
+      if (Inserted.second || Inserted.first->second != Lookup) {
+        Inserted.first->second = Lookup;
+        PersistentCacheChanged = true;
+      }
+    }
     return File;
   }
 
+  if (UsePersistentCache && PersistentLookups.erase(Filename))
+    PersistentCacheChanged = true;
+
   // If we are including a file with a quoted include "foo.h" from inside
   // a header in a framework that is currently being built, and we couldn't
   // resolve "foo.h" any other way, change the include to <Foo/foo.h>, where
@@ -1297,6 +1488,13 @@ bool HeaderSearch::ShouldEnterIncludeFile(Preprocessor &PP,
       return false;
   }
 
+  // The persistent cache may know the controlling macro of a header this
+  // invocation has not lexed yet.
+  if (!FileInfo.NumIncludes && !FileInfo.ControllingMacro &&
+      !FileInfo.ControllingMacroID && !ModulesEnabled &&
+      !HSOpts->HeaderSearchCachePath.empty())
+    usePersistentGuard(PP, File, FileInfo);
+
   // Next, check to see if the file is wrapped with #ifndef guards.  If so, and
   // if the macro that guards it is defined, we know the #include has no effect.
   if (const IdentifierInfo *ControllingMacro
@@ -1634,9 +1634,139 @@ bool Lexer::tryConsumeIdentifierUTF8Char(const char *&CurPtr) {
   return true;
 }
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif __ALTIVEC__
+#include <altivec.h>
+#undef bool
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// The scanning loops over identifiers, whitespace, line comments and raw
+// string bodies first skip whole 16-byte blocks of bytes that cannot stop
+// them, and leave the byte that may stop them, or the last bytes before the
+// end of the buffer, to their scalar loop. The buffer is terminated early by a
+// nul at a code-completion point, which stops all of the loops.
+#if defined(__SSE2__)
+#define LEXER_HAS_BYTE_VECTORS
+using ByteVector = __m128i;
+
+static ByteVector loadBytes(const char *Ptr) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(Ptr));
+}
+static ByteVector splatByte(char C) { return _mm_set1_epi8(C); }
+static ByteVector matchByte(ByteVector V, char C) {
+  return _mm_cmpeq_epi8(V, _mm_set1_epi8(C));
+}
+/// Match the bytes in [Lo, Hi], which must be ASCII.
+static ByteVector matchRange(ByteVector V, char Lo, char Hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(V, _mm_set1_epi8(Lo - 1)),
+                       _mm_cmplt_epi8(V, _mm_set1_epi8(Hi + 1)));
+}
+static ByteVector orBytes(ByteVector A, ByteVector B) {
+  return _mm_or_si128(A, B);
+}
+/// Return the index of the first matched byte, or 16 if there is none.
+static unsigned findFirstMatch(ByteVector Matches) {
+  unsigned Mask = _mm_movemask_epi8(Matches);
+  return Mask ? llvm::countTrailingZeros(Mask) : 16;
+}
+/// Return the index of the first byte that did not match, or 16.
+static unsigned findFirstMismatch(ByteVector Matches) {
+  unsigned Mask = ~_mm_movemask_epi8(Matches) & 0xFFFF;
+  return Mask ? llvm::countTrailingZeros(Mask) : 16;
+}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define LEXER_HAS_BYTE_VECTORS
+using ByteVector = uint8x16_t;
+
+static ByteVector loadBytes(const char *Ptr) {
+  return vld1q_u8(reinterpret_cast<const uint8_t *>(Ptr));
+}
+static ByteVector splatByte(char C) { return vdupq_n_u8(C); }
+static ByteVector matchByte(ByteVector V, char C) {
+  return vceqq_u8(V, vdupq_n_u8(C));
+}
+/// Match the bytes in [Lo, Hi], which must be ASCII.
+static ByteVector matchRange(ByteVector V, char Lo, char Hi) {
+  return vandq_u8(vcgeq_u8(V, vdupq_n_u8(Lo)), vcleq_u8(V, vdupq_n_u8(Hi)));
+}
+static ByteVector orBytes(ByteVector A, ByteVector B) {
+  return vorrq_u8(A, B);
+}
+/// Return the index of the first matched byte, or 16 if there is none.
+static unsigned findFirstMatch(ByteVector Matches) {
+  // Narrow each byte of the mask to 4 bits of a 64-bit integer.
+  uint64_t Mask = vget_lane_u64(
+      vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(Matches), 4)), 0);
+  return Mask ? llvm::countTrailingZeros(Mask) / 4 : 16;
+}
+/// Return the index of the first byte that did not match, or 16.
+static unsigned findFirstMismatch(ByteVector Matches) {
+  return findFirstMatch(vmvnq_u8(Matches));
+}
+#endif
+
+/// Skip the bytes at \p CurPtr that are certainly part of the body of an
+/// identifier, [_A-Za-z0-9].
+static const char *skipIdentifierBody(const char *CurPtr,
+                                      const char *BufferEnd) {
+#ifdef LEXER_HAS_BYTE_VECTORS
+  while (BufferEnd - CurPtr >= 16) {
+    ByteVector V = loadBytes(CurPtr);
+    // Setting bit 5 maps upper case letters to lower case ones, and no other
+    // byte to a lower case letter.
+    ByteVector Lower = orBytes(V, splatByte(0x20));
+    unsigned Index = findFirstMismatch(
+        orBytes(orBytes(matchRange(Lower, 'a', 'z'), matchRange(V, '0', '9')),
+                matchByte(V, '_')));
+    if (Index != 16)
+      return CurPtr + Index;
+    CurPtr += 16;
+  }
+#endif
+  return CurPtr;
+}
+
+/// Skip the bytes at \p CurPtr that are certainly horizontal whitespace.
+static const char *skipHorizontalWhitespace(const char *CurPtr,
+                                            const char *BufferEnd) {
+#ifdef LEXER_HAS_BYTE_VECTORS
+  while (BufferEnd - CurPtr >= 16) {
+    ByteVector V = loadBytes(CurPtr);
+    unsigned Index = findFirstMismatch(
+        orBytes(orBytes(matchByte(V, ' '), matchByte(V, '\t')),
+                orBytes(matchByte(V, '\f'), matchByte(V, '\v'))));
+    if (Index != 16)
+      return CurPtr + Index;
+    CurPtr += 16;
+  }
+#endif
+  return CurPtr;
+}
+
+/// Skip the bytes at \p CurPtr up to the first one that is \p C1, \p C2 or
+/// \p C3.
+static const char *skipUntil(const char *CurPtr, const char *BufferEnd,
+                             char C1, char C2, char C3) {
+#ifdef LEXER_HAS_BYTE_VECTORS
+  while (BufferEnd - CurPtr >= 16) {
+    ByteVector V = loadBytes(CurPtr);
+    unsigned Index = findFirstMatch(orBytes(
+        orBytes(matchByte(V, C1), matchByte(V, C2)), matchByte(V, C3)));
+    if (Index != 16)
+      return CurPtr + Index;
+    CurPtr += 16;
+  }
+#endif
+  return CurPtr;
+}
+
 bool Lexer::LexIdentifier(Token &Result, const char *CurPtr) {
   // Match [_A-Za-z0-9]*, we have already matched [_A-Za-z$]
   unsigned Size;
+  CurPtr = skipIdentifierBody(CurPtr, BufferEnd);
   unsigned char C = *CurPtr++;
   while (isIdentifierBody(C))
     C = *CurPtr++;
@@ -2013,6 +2143,7 @@ bool Lexer::LexRawStringLiteral(Token &Result, const char *CurPtr,
   CurPtr += PrefixLen + 1; // skip over prefix and '('
 
   while (true) {
+    CurPtr = skipUntil(CurPtr, BufferEnd, ')', 0, 0);
     char C = *CurPtr++;
 
     if (C == ')') {
@@ -2192,6 +2323,10 @@ bool Lexer::SkipWhitespace(Token &Result, const char *CurPtr,
   // Skip consecutive spaces efficiently.
   while (true) {
     // Skip horizontal whitespace very aggressively.
+    if (isHorizontalWhitespace(Char)) {
+      CurPtr = skipHorizontalWhitespace(CurPtr, BufferEnd);
+      Char = *CurPtr;
+    }
     while (isHorizontalWhitespace(Char))
       Char = *++CurPtr;
 
@@ -2261,6 +2396,7 @@ bool Lexer::SkipLineComment(Token &Result, const char *CurPtr,
   // character that ends the line comment.
   char C;
   while (true) {
+    CurPtr = skipUntil(CurPtr, BufferEnd, 0, '\n', '\r');
     C = *CurPtr;
     // Skip over characters in the fast loop.
     while (C != 0 &&                // Potentially EOF.
@@ -2468,13 +2604,6 @@ static bool isEndOfBlockCommentWithEscapedNewLine(const char *CurPtr,
   return true;
 }
 
-#ifdef __SSE2__
-#include <emmintrin.h>
-#elif __ALTIVEC__
-#include <altivec.h>
-#undef bool
-#endif
-
 /// We have just read from input the / and * characters that started a comment.
 /// Read until we find the * and / characters that terminate the comment.
 /// Note that we don't bother decoding trigraphs or escaped newlines in block
@@ -646,6 +646,19 @@ bool Parser::ParseTopLevelDecl(DeclGroupPtrTy &Result, bool IsFirstDecl) {
     return false;
 
   case tok::eof:
+    // Parse the deferred function bodies, one per call so that the consumer
+    // sees each definition as a top-level declaration. Each one ends on the
+    // end of file again.
+    if (NextDeferredFunctionBody != DeferredFunctionBodies.size()) {
+      LateParsedTemplate &Body =
+          *DeferredFunctionBodies[NextDeferredFunctionBody++];
+      ParseLateTemplatedFuncDef(Body);
+      Result = Actions.ConvertDeclToDeclGroup(Body.D);
+      return false;
+    }
+    DeferredFunctionBodies.clear();
+    NextDeferredFunctionBody = 0;
+
     // Late template parsing can begin.
     if (getLangOpts().DelayedTemplateParsing)
       Actions.SetLateTemplateParser(LateTemplateParserCallback,
@@ -1210,6 +1223,42 @@ Decl *Parser::ParseFunctionDefinition(ParsingDeclarator &D,
     }
     return DP;
   }
+  // With -fdefer-function-bodies, the bodies of other function definitions
+  // are stored in the same way, and parsed in order once every declaration of
+  // the translation unit has been seen. Bodies whose contents can affect the
+  // rest of the translation unit, like those of constexpr functions, are not.
+  else if (getLangOpts().DeferFunctionBodies && getLangOpts().CPlusPlus &&
+           Tok.isOneOf(tok::l_brace, tok::colon, tok::kw_try) &&
+           TemplateInfo.Kind == ParsedTemplateInfo::NonTemplate &&
+           !CurParsedObjCImpl && !PP.isIncrementalProcessingEnabled() &&
+           (!LateParsedAttrs || LateParsedAttrs->empty()) &&
+           Actions.canDelayFunctionBody(D)) {
+    ParseScope BodyScope(this, Scope::FnScope | Scope::DeclScope |
+                                   Scope::CompoundStmtScope);
+    Scope *ParentScope = getCurScope()->getParent();
+
+    D.setFunctionDefinitionKind(FDK_Definition);
+    Decl *DP = Actions.HandleDeclarator(ParentScope, D,
+                                        MultiTemplateParamsArg());
+    D.complete(DP);
+    D.getMutableDeclSpec().abort();
+
+    if (SkipFunctionBodies && (!DP || Actions.canSkipFunctionBody(DP)) &&
+        trySkippingFunctionBody()) {
+      BodyScope.Exit();
+      return Actions.ActOnSkippedFunctionBody(DP);
+    }
+
+    auto Body = std::make_unique<LateParsedTemplate>();
+    LexTemplateFunctionForLateParsing(Body->Toks);
+
+    if (FunctionDecl *FnD = DP ? DP->getAsFunction() : nullptr) {
+      Actions.CheckForFunctionRedefinition(FnD);
+      Body->D = DP;
+      DeferredFunctionBodies.push_back(std::move(Body));
+    }
+    return DP;
+  }
   else if (CurParsedObjCImpl &&
            !TemplateInfo.TemplateParams &&
            (Tok.is(tok::l_brace) || Tok.is(tok::kw_try) ||
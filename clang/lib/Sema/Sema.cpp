@@ -973,6 +973,16 @@ void Sema::ActOnEndOfTranslationUnit() {
                                  LateParsedInstantiations.begin(),
                                  LateParsedInstantiations.end());
     LateParsedInstantiations.clear();
+
+    // Perform the instantiations the header needs once here, so that the
+    // translation units that include the PCH deserialize them instead of
+    // instantiating them again. The ones that only the translation unit
+    // triggers are still instantiated at its end.
+    if (LangOpts.PCHInstantiateTemplates) {
+      llvm::TimeTraceScope TimeScope("PerformPendingInstantiations",
+                                     StringRef(""));
+      PerformPendingInstantiations();
+    }
   }
 
   DiagnoseUnterminatedPragmaPack();
@@ -102,6 +102,7 @@
 #include "llvm/ADT/Triple.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Bitstream/BitstreamReader.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Compression.h"
@@ -112,7 +113,9 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/VersionTuple.h"
 #include "llvm/Support/raw_ostream.h"
@@ -1257,6 +1260,26 @@ void ASTReader::Error(llvm::Error &&Err) const {
 
 /// Read the line table in the source manager block.
 /// \returns true if there was an error.
+void ASTReader::prefetchDeclsBlock(ModuleFile &F) {
+#if LLVM_ENABLE_THREADS
+  // Buffers that are not mapped are already in memory.
+  if (F.Buffer->getBufferKind() != llvm::MemoryBuffer::MemoryBuffer_MMap ||
+      F.DeclsBlockEnd <= F.DeclsBlockStart || F.DeclsBlockEnd > F.Data.size())
+    return;
+
+  if (!PrefetchThread)
+    PrefetchThread = std::make_unique<llvm::ThreadPool>(1);
+  const char *Begin = F.Data.data() + F.DeclsBlockStart;
+  const char *End = F.Data.data() + F.DeclsBlockEnd;
+  PrefetchThread->async([this, Begin, End] {
+    unsigned PageSize = llvm::sys::Process::getPageSizeEstimate();
+    // Touch one byte per page to fault it in.
+    for (const char *P = Begin; P < End && !CancelPrefetch; P += PageSize)
+      (void)*static_cast<const volatile char *>(P);
+  });
+#endif
+}
+
 bool ASTReader::ParseLineTable(ModuleFile &F,
                                const RecordData &Record) {
   unsigned Idx = 0;
@@ -2902,10 +2925,12 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
         // cursor to it, enter the block and read the abbrevs in that block.
         // With the main cursor, we just skip over it.
         F.DeclsCursor = Stream;
+        F.DeclsBlockStart = Stream.GetCurrentBitNo() / 8;
         if (llvm::Error Err = Stream.SkipBlock()) {
           Error(std::move(Err));
           return Failure;
         }
+        F.DeclsBlockEnd = Stream.GetCurrentBitNo() / 8;
         if (ReadBlockAbbrevs(F.DeclsCursor, DECLTYPES_BLOCK_ID)) {
           Error("malformed block record in AST file");
           return Failure;
@@ -4215,6 +4240,12 @@ ASTReader::ASTReadResult ASTReader::ReadAST(StringRef FileName,
 
     ModuleMgr.moduleFileAccepted(&F);
 
+    // The declarations of a precompiled header are mostly deserialized
+    // lazily. Prefetch them now that the file is committed to, so that the
+    // pages are in memory by the time the parser needs them.
+    if (F.Kind == MK_PCH || F.Kind == MK_Preamble)
+      prefetchDeclsBlock(F);
+
     // Set the import location.
     F.DirectImportLoc = ImportLoc;
     // FIXME: We assume that locations from PCH / preamble do not need
@@ -12184,6 +12215,11 @@ ASTReader::ASTReader(Preprocessor &PP, InMemoryModuleCache &ModuleCache,
 }
 
 ASTReader::~ASTReader() {
+  // The module files may be unmapped once the reader is gone.
+  if (PrefetchThread) {
+    CancelPrefetch = true;
+    PrefetchThread->wait();
+  }
   if (OwnsDeserializationListener)
     delete DeserializationListener;
 }
@@ -28,6 +28,7 @@
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Casting.h"
 #include <cassert>
 #include <memory>
@@ -35,6 +36,10 @@
 using namespace clang;
 using namespace ento;
 
+#define DEBUG_TYPE "ExplodedGraph"
+
+STATISTIC(NumReclaimedNodes, "The # of exploded nodes reclaimed.");
+
 //===----------------------------------------------------------------------===//
 // Cleanup.
 //===----------------------------------------------------------------------===//
@@ -165,6 +170,7 @@ void ExplodedGraph::collectNode(ExplodedNode *node) {
   FreeNodes.push_back(node);
   Nodes.RemoveNode(node);
   --NumNodes;
+  ++NumReclaimedNodes;
   node->~ExplodedNode();
 }
 
@@ -180,9 +186,19 @@ void ExplodedGraph::reclaimRecentlyAllocatedNodes() {
     return;
   ReclaimCounter = ReclaimNodeInterval;
 
-  for (const auto node : ChangedNodes)
+  for (const auto node : FrontierNodes)
+    if (shouldCollect(node))
+      collectNode(node);
+  FrontierNodes.clear();
+
+  // The nodes allocated just before this reclamation usually get their
+  // successor soon after, give them another chance.
+  for (const auto node : ChangedNodes) {
     if (shouldCollect(node))
       collectNode(node);
+    else if (node->succ_empty())
+      FrontierNodes.push_back(node);
+  }
   ChangedNodes.clear();
 }
 
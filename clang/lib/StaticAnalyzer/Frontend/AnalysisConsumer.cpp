@@ -33,6 +33,8 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
 #include "clang/StaticAnalyzer/Frontend/CheckerRegistration.h"
+#include "llvm/ADT/EquivalenceClasses.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/FileSystem.h"
@@ -59,6 +61,19 @@ STATISTIC(NumVisitedBlocksInAnalyzedFunctions,
           "The # of visited basic blocks in the analyzed functions.");
 STATISTIC(PercentReachableBlocks, "The % of reachable basic blocks.");
 STATISTIC(MaxCFGSize, "The maximum number of basic blocks in a function.");
+STATISTIC(MaxAnalysisMemory,
+          "The maximum memory allocated to analyze a top level function, in "
+          "bytes.");
+STATISTIC(MaxExplodedNodesMemory,
+          "The maximum memory taken by the exploded nodes of a top level "
+          "function, in bytes.");
+STATISTIC(MaxProgramStatesMemory,
+          "The maximum memory taken by the program states of a top level "
+          "function, in bytes.");
+STATISTIC(MaxSymbols,
+          "The maximum # of symbols created to analyze a top level function.");
+STATISTIC(MaxMemRegions,
+          "The maximum # of regions created to analyze a top level function.");
 
 //===----------------------------------------------------------------------===//
 // Special PathDiagnosticConsumers.
@@ -206,6 +221,10 @@ public:
   /// working with a PCH file.
   SetOfDecls LocalTUDecls;
 
+  /// The shard of the top level functions, with the \c shard-count option.
+  llvm::DenseMap<const Decl *, unsigned> ShardOfDecl;
+  unsigned NextShard = 0;
+
   // Set of PathDiagnosticConsumers.  Owned by AnalysisManager.
   PathDiagnosticConsumers PathConsumers;
 
@@ -465,6 +484,12 @@ private:
 
   /// Check if we should skip (not analyze) the given function.
   AnalysisMode getModeForDecl(Decl *D, AnalysisMode Mode);
+
+  /// Assigns the functions of the call graph to the shards.
+  void assignShards(llvm::ReversePostOrderTraversal<clang::CallGraph *> &RPOT);
+  /// Returns whether this invocation runs the path-sensitive analysis of \p D.
+  bool isInShard(const Decl *D);
+
   void runAnalysisOnTranslationUnit(ASTContext &C);
 
   /// Print \p S to stderr if \c Opts->AnalyzerDisplayProgress is set.
@@ -558,6 +583,8 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   SetOfConstDecls Visited;
   SetOfConstDecls VisitedAsTopLevel;
   llvm::ReversePostOrderTraversal<clang::CallGraph*> RPOT(&CG);
+  if (Opts->ShardCount > 1)
+    assignShards(RPOT);
   for (llvm::ReversePostOrderTraversal<clang::CallGraph*>::rpo_iterator
          I = RPOT.begin(), E = RPOT.end(); I != E; ++I) {
     NumFunctionTopLevel++;
@@ -590,6 +617,56 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   }
 }
 
+void AnalysisConsumer::assignShards(
+    llvm::ReversePostOrderTraversal<clang::CallGraph *> &RPOT) {
+  // A function is only inlined into its callers, so the connected components
+  // of the call graph are analyzed independently of each other.
+  llvm::EquivalenceClasses<const Decl *> Components;
+  for (CallGraphNode *N : RPOT) {
+    if (!N->getDecl())
+      continue;
+    Components.insert(N->getDecl());
+    for (CallGraphNode *Callee : *N)
+      Components.unionSets(N->getDecl(), Callee->getDecl());
+  }
+
+  // Give the largest components first to the shard with the fewest functions.
+  // The components are ordered the same way in every invocation.
+  llvm::MapVector<const Decl *, unsigned> SizeOfComponent;
+  for (CallGraphNode *N : RPOT)
+    if (const Decl *D = N->getDecl())
+      ++SizeOfComponent[Components.getLeaderValue(D)];
+  std::vector<std::pair<const Decl *, unsigned>> BySize(
+      SizeOfComponent.begin(), SizeOfComponent.end());
+  llvm::stable_sort(BySize, [](const std::pair<const Decl *, unsigned> &LHS,
+                               const std::pair<const Decl *, unsigned> &RHS) {
+    return LHS.second > RHS.second;
+  });
+  std::vector<unsigned> Load(Opts->ShardCount);
+  llvm::DenseMap<const Decl *, unsigned> ShardOfComponent;
+  for (const auto &LeaderAndSize : BySize) {
+    unsigned Shard = std::min_element(Load.begin(), Load.end()) - Load.begin();
+    Load[Shard] += LeaderAndSize.second;
+    ShardOfComponent[LeaderAndSize.first] = Shard;
+  }
+
+  for (CallGraphNode *N : RPOT)
+    if (const Decl *D = N->getDecl())
+      ShardOfDecl[D->getCanonicalDecl()] =
+          ShardOfComponent[Components.getLeaderValue(D)];
+}
+
+bool AnalysisConsumer::isInShard(const Decl *D) {
+  if (Opts->ShardCount <= 1)
+    return true;
+  // The functions that are not in the call graph, e.g. without inlining, are
+  // assigned in turn.
+  auto Inserted = ShardOfDecl.try_emplace(D->getCanonicalDecl(), NextShard);
+  if (Inserted.second)
+    NextShard = (NextShard + 1) % Opts->ShardCount;
+  return Inserted.first->second == Opts->ShardIndex;
+}
+
 static bool isBisonFile(ASTContext &C) {
   const SourceManager &SM = C.getSourceManager();
   FileID FID = SM.getMainFileID();
@@ -604,7 +681,8 @@ void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
   TranslationUnitDecl *TU = C.getTranslationUnitDecl();
   if (SyntaxCheckTimer)
     SyntaxCheckTimer->startTimer();
-  checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
+  if (Opts->ShardIndex == 0)
+    checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
   if (SyntaxCheckTimer)
     SyntaxCheckTimer->stopTimer();
 
@@ -743,6 +821,10 @@ AnalysisConsumer::getModeForDecl(Decl *D, AnalysisMode Mode) {
       getFunctionName(D) != Opts->AnalyzeSpecificFunction)
     return AM_None;
 
+  // The AST checkers only run in one of the shards.
+  if (Opts->ShardIndex != 0)
+    Mode &= ~AM_Syntax;
+
   // Unless -analyze-all is specified, treat decls differently depending on
   // where they came from:
   // - Main source file: run both path-sensitive and non-path-sensitive checks.
@@ -768,6 +850,8 @@ void AnalysisConsumer::HandleCode(Decl *D, AnalysisMode Mode,
   if (!D->hasBody())
     return;
   Mode = getModeForDecl(D, Mode);
+  if ((Mode & AM_Path) && !isInShard(D))
+    Mode &= ~AM_Path;
   if (Mode == AM_None)
     return;
 
@@ -827,6 +911,17 @@ void AnalysisConsumer::RunPathSensitiveChecks(Decl *D,
   if (ExprEngineTimer)
     ExprEngineTimer->stopTimer();
 
+  // The graph, the states, the store bindings, the symbols and the regions
+  // share the allocator of the graph.
+  ExplodedGraph &G = Eng.getGraph();
+  ProgramStateManager &StateMgr = Eng.getStateManager();
+  MaxAnalysisMemory.updateMax(G.getAllocator().getTotalMemory());
+  MaxExplodedNodesMemory.updateMax(G.size() * sizeof(ExplodedNode));
+  MaxProgramStatesMemory.updateMax(StateMgr.getNumStates() *
+                                   sizeof(ProgramState));
+  MaxSymbols.updateMax(StateMgr.getSymbolManager().getNumSymbols());
+  MaxMemRegions.updateMax(StateMgr.getRegionManager().getNumRegions());
+
   if (!Mgr->options.DumpExplodedGraphTo.empty())
     Eng.DumpGraph(Mgr->options.TrimGraph, Mgr->options.DumpExplodedGraphTo);
 
@@ -0,0 +1,167 @@
+//===- ModuleDepCollector.cpp - Callbacks to collect deps -------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Tooling/DependencyScanning/ModuleDepCollector.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/DependencyOutputOptions.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Serialization/ASTReader.h"
+#include "clang/Tooling/DependencyScanning/DependencyScanningWorker.h"
+#include "llvm/Support/Path.h"
+
+using namespace clang;
+using namespace tooling;
+using namespace dependencies;
+
+static std::string getCacheKey(StringRef ContextHash, StringRef ModuleName) {
+  return (ContextHash + ":" + ModuleName).str();
+}
+
+std::shared_ptr<const ModuleDeps>
+ModuleDepsCache::lookup(StringRef ContextHash, StringRef ModuleName) {
+  std::lock_guard<std::mutex> LockGuard(Lock);
+  auto It = Cache.find(getCacheKey(ContextHash, ModuleName));
+  if (It == Cache.end())
+    return nullptr;
+  return It->second;
+}
+
+std::shared_ptr<const ModuleDeps> ModuleDepsCache::insert(ModuleDeps MD) {
+  std::string Key = getCacheKey(MD.ContextHash, MD.ModuleName);
+  std::lock_guard<std::mutex> LockGuard(Lock);
+  std::shared_ptr<const ModuleDeps> &Entry = Cache[Key];
+  if (!Entry)
+    Entry = std::make_shared<const ModuleDeps>(std::move(MD));
+  return Entry;
+}
+
+/// Add the top level modules other than \p M that \p M or its submodules
+/// import to \p Imports.
+static void collectImports(const Module *M, const Module *TopLevel,
+                           llvm::SetVector<const Module *> &Imports) {
+  for (const Module *Import : M->Imports)
+    if (Import->getTopLevelModule() != TopLevel)
+      Imports.insert(Import->getTopLevelModule());
+  for (const Module *SubM : M->submodules())
+    collectImports(SubM, TopLevel, Imports);
+}
+
+void ModuleDepCollectorPP::FileChanged(SourceLocation Loc,
+                                       FileChangeReason Reason,
+                                       SrcMgr::CharacteristicKind FileType,
+                                       FileID PrevFID) {
+  if (Reason != PPCallbacks::EnterFile)
+    return;
+
+  // Dependency generation really does want to go all the way to the
+  // file entry for a source location to find out what is depended on.
+  // We do not want #line markers to affect dependency generation!
+  SourceManager &SM = Instance.getSourceManager();
+  const FileEntry *File =
+      SM.getFileEntryForID(SM.getFileID(SM.getExpansionLoc(Loc)));
+  if (!File)
+    return;
+
+  SmallString<256> FileName(
+      llvm::sys::path::remove_leading_dotslash(File->getName()));
+  llvm::sys::path::remove_dots(FileName, /*remove_dot_dot=*/true);
+  MDC.addDependency(FileName);
+}
+
+void ModuleDepCollectorPP::InclusionDirective(
+    SourceLocation HashLoc, const Token &IncludeTok, StringRef FileName,
+    bool IsAngled, CharSourceRange FilenameRange, const FileEntry *File,
+    StringRef SearchPath, StringRef RelativePath, const Module *Imported,
+    SrcMgr::CharacteristicKind FileType) {
+  // This is a non-modular include that HeaderSearch failed to find. Add it
+  // here as FileChanged will never see it.
+  if (!File && !Imported)
+    MDC.addDependency(FileName);
+  handleImport(Imported);
+}
+
+void ModuleDepCollectorPP::moduleImport(SourceLocation ImportLoc,
+                                        ModuleIdPath Path,
+                                        const Module *Imported) {
+  handleImport(Imported);
+}
+
+void ModuleDepCollectorPP::handleImport(const Module *Imported) {
+  if (Imported)
+    DirectDeps.insert(Imported->getTopLevelModule());
+}
+
+void ModuleDepCollectorPP::EndOfMainFile() {
+  for (const Module *M : DirectDeps)
+    handleTopLevelModule(M);
+
+  MDC.Consumer.handleContextHash(MDC.ContextHash);
+  for (const auto &Dep : MDC.Deps)
+    MDC.Consumer.handleModuleDependency(*Dep.second);
+  for (const Module *M : DirectDeps)
+    MDC.Consumer.handleDirectModuleDependency(M->getFullModuleName());
+
+  DependencyOutputOptions Opts;
+  for (const std::string &File : MDC.getDependencies())
+    MDC.Consumer.handleFileDependency(Opts, File);
+}
+
+void ModuleDepCollectorPP::handleTopLevelModule(const Module *M) {
+  assert(M == M->getTopLevelModule() && "Expected top level module!");
+  std::shared_ptr<const ModuleDeps> &Deps = MDC.Deps[M->getFullModuleName()];
+  if (Deps)
+    return;
+
+  llvm::SetVector<const Module *> Imports;
+  collectImports(M, M, Imports);
+
+  // Another translation unit with the same context hash may have collected
+  // the input files of the module already.
+  Deps = MDC.Cache.lookup(MDC.ContextHash, M->getFullModuleName());
+  if (!Deps) {
+    ModuleDeps MD;
+    MD.ModuleName = M->getFullModuleName();
+    MD.ContextHash = MDC.ContextHash;
+    if (const FileEntry *ModuleMap = Instance.getPreprocessor()
+                                         .getHeaderSearchInfo()
+                                         .getModuleMap()
+                                         .getContainingModuleMapFile(M))
+      MD.ClangModuleMapFile = ModuleMap->getName();
+    if (const FileEntry *ASTFile = M->getASTFile()) {
+      MD.ModulePCMPath = ASTFile->getName();
+      ASTReader &Reader = *Instance.getModuleManager();
+      if (serialization::ModuleFile *MF =
+              Reader.getModuleManager().lookup(ASTFile))
+        Reader.visitInputFiles(
+            *MF, /*IncludeSystem=*/true, /*Complain=*/false,
+            [&](const serialization::InputFile &IF, bool IsSystem) {
+              if (const FileEntry *File = IF.getFile())
+                MD.FileDeps.insert(File->getName());
+            });
+    }
+    for (const Module *Import : Imports)
+      MD.ClangModuleDeps.insert(Import->getFullModuleName());
+    Deps = MDC.Cache.insert(std::move(MD));
+  }
+
+  for (const Module *Import : Imports)
+    handleTopLevelModule(Import);
+}
+
+ModuleDepCollector::ModuleDepCollector(CompilerInstance &I,
+                                       DependencyConsumer &C,
+                                       ModuleDepsCache &Cache)
+    : Instance(I), Consumer(C), Cache(Cache),
+      ContextHash(I.getInvocation().getModuleHash()) {}
+
+void ModuleDepCollector::attachToPreprocessor(Preprocessor &PP) {
+  PP.addPPCallbacks(std::make_unique<ModuleDepCollectorPP>(Instance, *this));
+}
+
+void ModuleDepCollector::attachToASTReader(ASTReader &R) {}
@@ -158,6 +158,126 @@ std::vector<std::string> unescapeCommandLine(JSONCommandLineSyntax Syntax,
   return parser.parse();
 }
 
+/// A scanner for the subset of JSON that compilation databases are usually
+/// written in: strings without \\u escapes, arrays and objects.
+class JSONScanner {
+public:
+  JSONScanner(StringRef Text) : Text(Text) {}
+
+  /// Consumes \p C, after any whitespace, if it is the next character.
+  bool consume(char C) {
+    skipWhitespace();
+    if (Position == Text.size() || Text[Position] != C)
+      return false;
+    ++Position;
+    return true;
+  }
+
+  /// Returns whether the whole text has been consumed, but whitespace.
+  bool done() {
+    skipWhitespace();
+    return Position == Text.size();
+  }
+
+  /// Reads a string into \p Value, which refers to the text if the string has
+  /// no escapes, and to \p Storage otherwise.
+  bool readString(StringRef &Value, SmallVectorImpl<char> &Storage) {
+    if (!consume('"'))
+      return false;
+    size_t Start = Position;
+    while (Position != Text.size() && Text[Position] != '"' &&
+           Text[Position] != '\\' && (unsigned char)Text[Position] >= 0x20)
+      ++Position;
+    if (Position == Text.size())
+      return false;
+    if (Text[Position] == '"') {
+      Value = Text.slice(Start, Position++);
+      return true;
+    }
+    Storage.assign(Text.begin() + Start, Text.begin() + Position);
+    while (Position != Text.size()) {
+      char C = Text[Position++];
+      if (C == '"') {
+        Value = StringRef(Storage.data(), Storage.size());
+        return true;
+      }
+      if ((unsigned char)C < 0x20)
+        return false;
+      if (C != '\\') {
+        Storage.push_back(C);
+        continue;
+      }
+      if (Position == Text.size())
+        return false;
+      switch (Text[Position++]) {
+      case '"': Storage.push_back('"'); break;
+      case '\\': Storage.push_back('\\'); break;
+      case '/': Storage.push_back('/'); break;
+      case 'b': Storage.push_back('\b'); break;
+      case 'f': Storage.push_back('\f'); break;
+      case 'n': Storage.push_back('\n'); break;
+      case 'r': Storage.push_back('\r'); break;
+      case 't': Storage.push_back('\t'); break;
+      default:
+        return false;
+      }
+    }
+    return false;
+  }
+
+  /// Reads an array of strings into \p Values.
+  bool readStrings(std::vector<std::string> &Values) {
+    if (!consume('['))
+      return false;
+    if (consume(']'))
+      return true;
+    SmallString<128> Storage;
+    do {
+      StringRef Value;
+      if (!readString(Value, Storage))
+        return false;
+      Values.push_back(Value);
+    } while (consume(','));
+    return consume(']');
+  }
+
+  /// Skips a string, or an array of strings if \p Array is true, and returns
+  /// its text.
+  bool skipValue(bool Array, StringRef &Value) {
+    skipWhitespace();
+    size_t Start = Position;
+    SmallString<128> Storage;
+    StringRef String;
+    if (Array) {
+      if (!consume('['))
+        return false;
+      if (!consume(']')) {
+        do {
+          if (!readString(String, Storage))
+            return false;
+        } while (consume(','));
+        if (!consume(']'))
+          return false;
+      }
+    } else if (!readString(String, Storage)) {
+      return false;
+    }
+    Value = Text.slice(Start, Position);
+    return true;
+  }
+
+private:
+  void skipWhitespace() {
+    while (Position != Text.size() &&
+           (Text[Position] == ' ' || Text[Position] == '\t' ||
+            Text[Position] == '\n' || Text[Position] == '\r'))
+      ++Position;
+  }
+
+  StringRef Text;
+  size_t Position = 0;
+};
+
 // This plugin locates a nearby compile_command.json file, and also infers
 // compile commands for files not present in the database.
 class JSONCompilationDatabasePlugin : public CompilationDatabasePlugin {
@@ -310,23 +430,118 @@ nodeToCommandLine(JSONCommandLineSyntax Syntax,
   return Arguments;
 }
 
+// Decodes a command line that was checked by JSONCompilationDatabase::scan.
+static std::vector<std::string> textToCommandLine(JSONCommandLineSyntax Syntax,
+                                                  StringRef Text) {
+  JSONScanner Scanner(Text);
+  std::vector<std::string> Arguments;
+  SmallString<1024> Storage;
+  StringRef Value;
+  if (!Scanner.readStrings(Arguments) && Scanner.readString(Value, Storage))
+    Arguments = unescapeCommandLine(Syntax, Value);
+  else if (Arguments.size() == 1)
+    Arguments = unescapeCommandLine(Syntax, Arguments.front());
+  while (unwrapCommand(Arguments))
+    ;
+  return Arguments;
+}
+
 void JSONCompilationDatabase::getCommands(
     ArrayRef<CompileCommandRef> CommandsRef,
     std::vector<CompileCommand> &Commands) const {
-  for (const auto &CommandRef : CommandsRef) {
-    SmallString<8> DirectoryStorage;
-    SmallString<32> FilenameStorage;
-    SmallString<32> OutputStorage;
-    auto Output = std::get<3>(CommandRef);
+  for (const auto &CommandRef : CommandsRef)
     Commands.emplace_back(
-        std::get<0>(CommandRef)->getValue(DirectoryStorage),
-        std::get<1>(CommandRef)->getValue(FilenameStorage),
-        nodeToCommandLine(Syntax, std::get<2>(CommandRef)),
-        Output ? Output->getValue(OutputStorage) : "");
+        CommandRef.Directory, CommandRef.Filename,
+        CommandRef.CommandLineText.empty()
+            ? nodeToCommandLine(Syntax, CommandRef.CommandLine)
+            : textToCommandLine(Syntax, CommandRef.CommandLineText),
+        CommandRef.Output);
+}
+
+void JSONCompilationDatabase::addCommand(CompileCommandRef Command) {
+  SmallString<128> NativeFilePath;
+  if (llvm::sys::path::is_relative(Command.Filename)) {
+    SmallString<128> AbsolutePath(Command.Directory);
+    llvm::sys::path::append(AbsolutePath, Command.Filename);
+    llvm::sys::path::remove_dots(AbsolutePath, /*remove_dot_dot=*/ true);
+    llvm::sys::path::native(AbsolutePath, NativeFilePath);
+  } else {
+    llvm::sys::path::native(Command.Filename, NativeFilePath);
+  }
+  IndexByFile[NativeFilePath].push_back(Command);
+  AllCommands.push_back(std::move(Command));
+  MatchTrie.insert(NativeFilePath);
+}
+
+bool JSONCompilationDatabase::scan() {
+  JSONScanner Scanner(Database->getBuffer());
+  std::vector<CompileCommandRef> Commands;
+  if (!Scanner.consume('['))
+    return false;
+  if (!Scanner.consume(']')) {
+    do {
+      if (!Scanner.consume('{'))
+        return false;
+      CompileCommandRef Command;
+      StringRef Arguments, CommandString;
+      bool HasDirectory = false, HasFile = false;
+      if (!Scanner.consume('}')) {
+        do {
+          SmallString<16> KeyStorage;
+          StringRef Key;
+          if (!Scanner.readString(Key, KeyStorage) || !Scanner.consume(':'))
+            return false;
+          if (Key == "arguments" || Key == "command") {
+            if (!Scanner.skipValue(/*Array=*/Key == "arguments",
+                                   Key == "arguments" ? Arguments
+                                                      : CommandString))
+              return false;
+            continue;
+          }
+          SmallString<128> Storage;
+          StringRef Value;
+          if (!Scanner.readString(Value, Storage))
+            return false;
+          if (Value.data() == Storage.data())
+            Value = Saver.save(Value);
+          if (Key == "directory") {
+            Command.Directory = Value;
+            HasDirectory = true;
+          } else if (Key == "file") {
+            Command.Filename = Value;
+            HasFile = true;
+          } else if (Key == "output") {
+            Command.Output = Value;
+          } else {
+            return false;
+          }
+        } while (Scanner.consume(','));
+        if (!Scanner.consume('}'))
+          return false;
+      }
+      // As for the YAML nodes, the arguments are preferred over the command.
+      Command.CommandLineText = Arguments.empty() ? CommandString : Arguments;
+      if (!HasDirectory || !HasFile || Command.CommandLineText.empty())
+        return false;
+      Commands.push_back(std::move(Command));
+    } while (Scanner.consume(','));
+    if (!Scanner.consume(']'))
+      return false;
   }
+  if (!Scanner.done())
+    return false;
+
+  for (CompileCommandRef &Command : Commands)
+    addCommand(std::move(Command));
+  return true;
 }
 
 bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
+  // Most databases are strict JSON, which is indexed without keeping a node
+  // for each argument. The others, and the invalid ones, are parsed as YAML.
+  if (scan())
+    return true;
+
   llvm::yaml::document_iterator I = YAMLStream.begin();
   if (I == YAMLStream.end()) {
     ErrorMessage = "Error while parsing YAML.";
@@ -411,23 +626,14 @@ bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
       ErrorMessage = "Missing key: \"directory\".";
       return false;
     }
-    SmallString<8> FileStorage;
-    StringRef FileName = File->getValue(FileStorage);
-    SmallString<128> NativeFilePath;
-    if (llvm::sys::path::is_relative(FileName)) {
-      SmallString<8> DirectoryStorage;
-      SmallString<128> AbsolutePath(
-          Directory->getValue(DirectoryStorage));
-      llvm::sys::path::append(AbsolutePath, FileName);
-      llvm::sys::path::remove_dots(AbsolutePath, /*remove_dot_dot=*/ true);
-      llvm::sys::path::native(AbsolutePath, NativeFilePath);
-    } else {
-      llvm::sys::path::native(FileName, NativeFilePath);
-    }
-    auto Cmd = CompileCommandRef(Directory, File, *Command, Output);
-    IndexByFile[NativeFilePath].push_back(Cmd);
-    AllCommands.push_back(Cmd);
-    MatchTrie.insert(NativeFilePath);
+    SmallString<128> Storage;
+    CompileCommandRef Cmd;
+    Cmd.Directory = Saver.save(Directory->getValue(Storage));
+    Cmd.Filename = Saver.save(File->getValue(Storage));
+    if (Output)
+      Cmd.Output = Saver.save(Output->getValue(Storage));
+    Cmd.CommandLine = std::move(*Command);
+    addCommand(std::move(Cmd));
   }
   return true;
 }
@@ -127,7 +127,8 @@ TokenBuffer::spelledForExpandedToken(const syntax::Token *Expanded) const {
 
   auto FileIt = Files.find(
       SourceMgr->getFileID(SourceMgr->getExpansionLoc(Expanded->location())));
-  assert(FileIt != Files.end() && "no file for an expanded token");
+  if (FileIt == Files.end())
+    return {nullptr, nullptr}; // The file was not recorded.
 
   const MarkedFile &File = FileIt->second;
 
@@ -156,8 +157,14 @@ TokenBuffer::spelledForExpandedToken(const syntax::Token *Expanded) const {
 
 llvm::ArrayRef<syntax::Token> TokenBuffer::spelledTokens(FileID FID) const {
   auto It = Files.find(FID);
-  assert(It != Files.end());
-  return It->second.SpelledTokens;
+  if (It != Files.end())
+    return It->second.SpelledTokens;
+  auto Lexed = LexedFiles.try_emplace(FID);
+  if (Lexed.second) {
+    assert(LangOpts && "file not tracked by token buffer");
+    Lexed.first->second = tokenize(FID, *SourceMgr, *LangOpts);
+  }
+  return Lexed.first->second;
 }
 
 std::string TokenBuffer::Mapping::str() const {
@@ -183,6 +190,8 @@ TokenBuffer::spelledForExpanded(llvm::ArrayRef<syntax::Token> Expanded) const {
   const Mapping *LastMapping;
   std::tie(LastSpelled, LastMapping) =
       spelledForExpandedToken(&Expanded.back());
+  if (!BeginSpelled || !LastSpelled)
+    return llvm::None;
 
   FileID FID = SourceMgr->getFileID(BeginSpelled->location());
   // FIXME: Handle multi-file changes by trying to map onto a common root.
@@ -211,7 +220,8 @@ TokenBuffer::expansionStartingAt(const syntax::Token *Spelled) const {
   assert(Spelled);
   assert(Spelled->location().isFileID() && "not a spelled token");
   auto FileIt = Files.find(SourceMgr->getFileID(Spelled->location()));
-  assert(FileIt != Files.end() && "file not tracked by token buffer");
+  if (FileIt == Files.end())
+    return llvm::None; // The file was not recorded.
 
   auto &File = FileIt->second;
   assert(File.SpelledTokens.data() <= Spelled &&
@@ -235,7 +245,8 @@ TokenBuffer::expansionStartingAt(const syntax::Token *Spelled) const {
 std::vector<const syntax::Token *>
 TokenBuffer::macroExpansions(FileID FID) const {
   auto FileIt = Files.find(FID);
-  assert(FileIt != Files.end() && "file not tracked by token buffer");
+  if (FileIt == Files.end())
+    return {}; // The file was not recorded.
   auto &File = FileIt->second;
   std::vector<const syntax::Token *> Expansions;
   auto &Spelled = File.SpelledTokens;
@@ -346,10 +357,12 @@ TokenCollector::TokenCollector(Preprocessor &PP) : PP(PP) {
 class TokenCollector::Builder {
 public:
   Builder(std::vector<syntax::Token> Expanded, PPExpansions CollectedExpansions,
-          const SourceManager &SM, const LangOptions &LangOpts)
+          const SourceManager &SM, const LangOptions &LangOpts,
+          bool MainFileOnly)
       : Result(SM), CollectedExpansions(std::move(CollectedExpansions)), SM(SM),
-        LangOpts(LangOpts) {
+        LangOpts(LangOpts), MainFileOnly(MainFileOnly) {
     Result.ExpandedTokens = std::move(Expanded);
+    Result.LangOpts = &LangOpts;
   }
 
   TokenBuffer build() && {
@@ -391,6 +404,9 @@ private:
   /// (!) \p I will be updated if this had to skip tokens, e.g. for macros.
   void processExpandedToken(unsigned &I) {
     auto L = Result.ExpandedTokens[I].location();
+    if (MainFileOnly &&
+        SM.getFileID(SM.getExpansionLoc(L)) != SM.getMainFileID())
+      return;
     if (L.isMacroID()) {
       processMacroExpansion(SM.getExpansionRange(L), I);
       return;
@@ -439,6 +455,8 @@ private:
     for (unsigned I = 0; I < Result.ExpandedTokens.size(); ++I) {
       auto FID =
           SM.getFileID(SM.getExpansionLoc(Result.ExpandedTokens[I].location()));
+      if (MainFileOnly && FID != SM.getMainFileID())
+        continue;
       auto It = Result.Files.try_emplace(FID);
       TokenBuffer::MarkedFile &File = It.first->second;
 
@@ -547,13 +565,14 @@ private:
   PPExpansions CollectedExpansions;
   const SourceManager &SM;
   const LangOptions &LangOpts;
+  bool MainFileOnly;
 };
 
 TokenBuffer TokenCollector::consume() && {
   PP.setTokenWatcher(nullptr);
   Collector->disable();
   return Builder(std::move(Expanded), std::move(Expansions),
-                 PP.getSourceManager(), PP.getLangOpts())
+                 PP.getSourceManager(), PP.getLangOpts(), MainFileOnly)
       .build();
 }
 
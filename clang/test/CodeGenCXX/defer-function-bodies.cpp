@@ -0,0 +1,27 @@
+// RUN: %clang_cc1 -emit-llvm -fdefer-function-bodies -std=c++11 -triple x86_64-linux-gnu -o - %s | FileCheck %s
+
+// Deferred definitions are still emitted, including those of functions that
+// are only emitted when used.
+
+// CHECK-LABEL: define {{.*}}void @_Z5firstv()
+// CHECK: call void @_Z6secondv()
+void second();
+void first() { second(); }
+
+// CHECK-LABEL: define {{.*}}i32 @_Z5useItv()
+// CHECK: call i32 @_Z10usedInlinev()
+inline int usedInline() { return 1; }
+int useIt() { return usedInline(); }
+
+// CHECK-LABEL: define {{.*}}void @_Z13callsInternalv()
+// CHECK: call void @_ZN12_GLOBAL__N_110internalFnEv()
+namespace {
+void internalFn();
+}
+void callsInternal() { internalFn(); }
+namespace {
+void internalFn() {}
+}
+
+// CHECK-DAG: define linkonce_odr {{.*}}i32 @_Z10usedInlinev()
+// CHECK-DAG: define internal void @_ZN12_GLOBAL__N_110internalFnEv()
@@ -0,0 +1,7 @@
+// Check that -fcompile-time-budget is forwarded to the backend.
+
+// RUN: %clang -### -c -fcompile-time-budget=100000 %s 2>&1 | FileCheck %s
+// CHECK: "-mllvm" "-compile-time-budget=100000"
+
+// RUN: %clang -### -c %s 2>&1 | FileCheck -check-prefix=NOBUDGET %s
+// NOBUDGET-NOT: "-compile-time-budget
@@ -0,0 +1,33 @@
+// RUN: %clang_cc1 -fdefer-function-bodies -fsyntax-only -verify -std=c++14 %s
+
+// Deferred bodies are parsed once the whole translation unit has been seen.
+void usesLaterDecl() { later(); }
+void later();
+
+namespace N {
+struct S {
+  S();
+  int get();
+  int Value;
+};
+S::S() : Value(declaredAfterCtor()) {}
+int S::get() try { return Value; } catch (...) { return 0; }
+}
+int declaredAfterCtor();
+
+// Errors in deferred bodies are still diagnosed.
+void bad() { undeclared(); } // expected-error {{use of undeclared identifier 'undeclared'}}
+
+void redefined() {} // expected-note {{previous definition is here}}
+void redefined() {} // expected-error {{redefinition of 'redefined'}}
+
+// Bodies that can be needed before the end of the translation unit are
+// parsed in place.
+constexpr int five() { return 5; }
+static_assert(five() == 5, "");
+
+auto deduced() { return 1; }
+int X = deduced();
+
+template <typename T> T identity(T t) { return t; }
+int Y = identity(1);
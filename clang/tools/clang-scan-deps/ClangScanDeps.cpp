@@ -6,17 +6,26 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "clang/Driver/Types.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/DependencyScanning/DependencyScanningService.h"
 #include "clang/Tooling/DependencyScanning/DependencyScanningWorker.h"
 #include "clang/Tooling/JSONCompilationDatabase.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/Options.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/Threading.h"
+#include <atomic>
+#include <map>
 #include <mutex>
+#include <set>
 #include <thread>
 
 using namespace clang;
@@ -38,6 +47,301 @@ private:
   raw_ostream &OS;
 };
 
+/// The translation units and modules found by all the workers with the
+/// experimental-full format, which are printed as one JSON object when the
+/// scan is done.
+class FullDeps {
+public:
+  struct TranslationUnitDeps {
+    std::string Input;
+    std::string ContextHash;
+    std::vector<std::string> FileDeps;
+    std::vector<std::string> ClangModuleDeps;
+  };
+
+  /// \param ModuleBuildDir If non-empty, the directory the modules are built
+  /// into explicitly.
+  FullDeps(StringRef ModuleBuildDir) : ModuleBuildDir(ModuleBuildDir) {}
+
+  /// Record the compile command of a translation unit, which the explicit
+  /// builds of its modules start from.
+  void addCompileCommand(const tooling::CompileCommand &Command) {
+    Commands.insert({Command.Filename, Command});
+  }
+
+  /// Record the dependencies of a module, unless another translation unit
+  /// already did.
+  void addModule(const ModuleDeps &MD) {
+    std::unique_lock<std::mutex> LockGuard(Lock);
+    Modules.insert({{MD.ContextHash, MD.ModuleName}, MD});
+  }
+
+  void addTranslationUnit(TranslationUnitDeps TU) {
+    std::unique_lock<std::mutex> LockGuard(Lock);
+    Inputs.push_back(std::move(TU));
+  }
+
+  /// Build the modules into the module build directory, and write a
+  /// -fmodule-file-map file for each context hash next to them.
+  ///
+  /// Each module is built with the compile command of the first translation
+  /// unit that needs it. The modules that do not depend on each other are
+  /// built in parallel by \p NumWorkers processes.
+  ///
+  /// \returns True on error.
+  bool buildModules(unsigned NumWorkers, SharedStream &Errs) {
+    sortInputs();
+    std::map<ModuleKey, const tooling::CompileCommand *> BaseCommands;
+    for (const TranslationUnitDeps &TU : Inputs) {
+      auto Command = Commands.find(TU.Input);
+      if (Command == Commands.end())
+        continue;
+      for (const ModuleDeps *MD :
+           getTransitiveModules(TU.ContextHash, TU.ClangModuleDeps))
+        BaseCommands.insert(
+            {{MD->ContextHash, MD->ModuleName}, &Command->second});
+    }
+
+    // The modules of the same depth in the module graph do not depend on each
+    // other, and only depend on modules of smaller depths.
+    std::map<ModuleKey, unsigned> Depths;
+    std::vector<std::vector<ModuleKey>> Levels;
+    for (const auto &Entry : BaseCommands) {
+      unsigned Depth = getDepth(Entry.first, Depths);
+      if (Levels.size() <= Depth)
+        Levels.resize(Depth + 1);
+      Levels[Depth].push_back(Entry.first);
+    }
+
+    std::atomic<bool> HadErrors(false);
+    llvm::ThreadPool Pool(NumWorkers);
+    for (const std::vector<ModuleKey> &Level : Levels) {
+      for (const ModuleKey &Key : Level)
+        Pool.async([&, Key] {
+          if (!buildModule(Modules.at(Key), *BaseCommands.at(Key), Errs))
+            HadErrors = true;
+        });
+      Pool.wait();
+    }
+
+    // Map the module names to the module files relative to the map.
+    std::map<std::string, std::string> ModuleFileMaps;
+    for (const auto &Entry : BaseCommands)
+      ModuleFileMaps[Entry.first.first] +=
+          Entry.first.second + "=" + Entry.first.second + ".pcm\n";
+    for (const auto &Entry : ModuleFileMaps) {
+      SmallString<128> MapPath(ModuleBuildDir);
+      llvm::sys::path::append(MapPath, Entry.first, "module-files.map");
+      std::error_code EC;
+      llvm::raw_fd_ostream OS(MapPath, EC, llvm::sys::fs::OF_Text);
+      if (!EC)
+        OS << Entry.second;
+      if (EC || OS.has_error()) {
+        Errs.applyLocked([&](raw_ostream &ErrOS) {
+          ErrOS << "Error while writing " << MapPath << "\n";
+        });
+        OS.clear_error();
+        HadErrors = true;
+      }
+    }
+    return HadErrors;
+  }
+
+  void printFullOutput(raw_ostream &OS) {
+    llvm::json::Array OutModules;
+    for (const auto &Entry : Modules) {
+      const ModuleDeps &MD = Entry.second;
+      std::vector<std::string> CommandLine = {"-Xclang", "-emit-module",
+                                              "-fmodule-name=" + MD.ModuleName};
+      appendModuleArgs(MD.ContextHash, MD.ClangModuleDeps.keys(), CommandLine);
+      OutModules.push_back(llvm::json::Object{
+          {"name", MD.ModuleName},
+          {"context-hash", MD.ContextHash},
+          {"clang-modulemap-file", MD.ClangModuleMapFile},
+          {"pcm-path", getPCMPath(MD)},
+          {"file-deps", toSortedJSON(MD.FileDeps.keys())},
+          {"clang-module-deps", toSortedJSON(MD.ClangModuleDeps.keys())},
+          {"command-line", std::move(CommandLine)},
+      });
+    }
+
+    sortInputs();
+    llvm::json::Array OutTUs;
+    for (const TranslationUnitDeps &TU : Inputs) {
+      std::vector<std::string> CommandLine;
+      appendModuleArgs(TU.ContextHash, TU.ClangModuleDeps, CommandLine);
+      OutTUs.push_back(llvm::json::Object{
+          {"input-file", TU.Input},
+          {"context-hash", TU.ContextHash},
+          {"file-deps", TU.FileDeps},
+          {"clang-module-deps", toSortedJSON(TU.ClangModuleDeps)},
+          {"command-line", std::move(CommandLine)},
+      });
+    }
+
+    llvm::json::Object Output{{"modules", std::move(OutModules)},
+                              {"translation-units", std::move(OutTUs)}};
+    OS << llvm::formatv("{0:2}\n", llvm::json::Value(std::move(Output)));
+  }
+
+private:
+  /// The context hash and the name of a module.
+  using ModuleKey = std::pair<std::string, std::string>;
+
+  template <typename Range>
+  static llvm::json::Array toSortedJSON(const Range &Strings) {
+    std::vector<std::string> Sorted(Strings.begin(), Strings.end());
+    llvm::sort(Sorted);
+    return llvm::json::Array(Sorted);
+  }
+
+  void sortInputs() {
+    std::sort(Inputs.begin(), Inputs.end(),
+              [](const TranslationUnitDeps &A, const TranslationUnitDeps &B) {
+                return A.Input < B.Input;
+              });
+  }
+
+  /// The module file the explicit build writes, or the one the scan built
+  /// implicitly if there is no explicit build.
+  std::string getPCMPath(const ModuleDeps &MD) const {
+    if (ModuleBuildDir.empty())
+      return MD.ModulePCMPath;
+    SmallString<128> Path(ModuleBuildDir);
+    llvm::sys::path::append(Path, MD.ContextHash, MD.ModuleName + ".pcm");
+    return Path.str();
+  }
+
+  /// Return the modules \p ModuleNames with the context hash \p ContextHash
+  /// and the modules they import.
+  template <typename Range>
+  std::vector<const ModuleDeps *>
+  getTransitiveModules(StringRef ContextHash, const Range &ModuleNames) const {
+    std::vector<const ModuleDeps *> Result;
+    std::set<StringRef> Visited;
+    std::vector<StringRef> Worklist(ModuleNames.begin(), ModuleNames.end());
+    llvm::sort(Worklist);
+    while (!Worklist.empty()) {
+      StringRef Name = Worklist.back();
+      Worklist.pop_back();
+      if (!Visited.insert(Name).second)
+        continue;
+      auto It = Modules.find({ContextHash, Name});
+      if (It == Modules.end())
+        continue;
+      Result.push_back(&It->second);
+      for (const auto &Dep : It->second.ClangModuleDeps)
+        Worklist.push_back(Dep.getKey());
+    }
+    return Result;
+  }
+
+  /// Append the arguments that make a compilation with the context hash
+  /// \p ContextHash use the explicitly built modules \p ModuleNames and the
+  /// modules they import, instead of building modules implicitly.
+  template <typename Range>
+  void appendModuleArgs(StringRef ContextHash, const Range &ModuleNames,
+                        std::vector<std::string> &CommandLine) const {
+    CommandLine.push_back("-fno-implicit-modules");
+    CommandLine.push_back("-fno-implicit-module-maps");
+    for (const ModuleDeps *MD :
+         getTransitiveModules(ContextHash, ModuleNames)) {
+      if (!MD->ClangModuleMapFile.empty())
+        CommandLine.push_back("-fmodule-map-file=" + MD->ClangModuleMapFile);
+      CommandLine.push_back("-fmodule-file=" + getPCMPath(*MD));
+    }
+  }
+
+  /// Return the length of the longest path of imports from the module \p Key.
+  unsigned getDepth(const ModuleKey &Key,
+                    std::map<ModuleKey, unsigned> &Depths) const {
+    auto Known = Depths.find(Key);
+    if (Known != Depths.end())
+      return Known->second;
+    unsigned Depth = 0;
+    auto It = Modules.find(Key);
+    if (It != Modules.end())
+      for (const auto &Dep : It->second.ClangModuleDeps)
+        Depth = std::max(
+            Depth, getDepth({Key.first, Dep.getKey()}, Depths) + 1);
+    Depths[Key] = Depth;
+    return Depth;
+  }
+
+  /// Build \p MD from the module map with the command \p Base of a
+  /// translation unit that imports it.
+  ///
+  /// \returns True on success.
+  bool buildModule(const ModuleDeps &MD, const tooling::CompileCommand &Base,
+                   SharedStream &Errs) const {
+    std::string PCMPath = getPCMPath(MD);
+    llvm::sys::fs::create_directories(llvm::sys::path::parent_path(PCMPath));
+
+    // Drop the input, the output and the dependency file options of the
+    // translation unit.
+    std::vector<std::string> Args;
+    const std::vector<std::string> &BaseArgs = Base.CommandLine;
+    for (size_t I = 0, E = BaseArgs.size(); I != E; ++I) {
+      StringRef Arg = BaseArgs[I];
+      if (I != 0 && (Arg == Base.Filename || Arg == "-c" || Arg == "-M" ||
+                     Arg == "-MM" || Arg == "-MD" || Arg == "-MMD"))
+        continue;
+      if (Arg == "-o" || Arg == "-MF" || Arg == "-MT" || Arg == "-MQ") {
+        ++I;
+        continue;
+      }
+      Args.push_back(Arg);
+    }
+    if (Args.empty())
+      return false;
+
+    Args.push_back("-working-directory=" + Base.Directory);
+    Args.push_back("-Xclang");
+    Args.push_back("-emit-module");
+    Args.push_back("-fmodule-name=" + MD.ModuleName);
+    appendModuleArgs(MD.ContextHash, MD.ClangModuleDeps.keys(), Args);
+    // The module map is compiled as the language of the translation unit.
+    driver::types::ID Type = driver::types::lookupTypeForExtension(
+        llvm::sys::path::extension(Base.Filename).drop_front());
+    if (Type != driver::types::TY_INVALID) {
+      Args.push_back("-x");
+      Args.push_back(driver::types::getTypeName(Type));
+    }
+    SmallString<128> ModuleMap(MD.ClangModuleMapFile);
+    llvm::sys::fs::make_absolute(Base.Directory, ModuleMap);
+    Args.push_back("-c");
+    Args.push_back(ModuleMap.str());
+    Args.push_back("-o");
+    Args.push_back(PCMPath);
+
+    std::string Program = Args.front();
+    if (!llvm::sys::path::is_absolute(Program))
+      if (llvm::ErrorOr<std::string> Path =
+              llvm::sys::findProgramByName(Program))
+        Program = *Path;
+    SmallVector<StringRef, 64> ArgRefs(Args.begin(), Args.end());
+    std::string ErrMsg;
+    if (llvm::sys::ExecuteAndWait(Program, ArgRefs, /*Env=*/None,
+                                  /*Redirects=*/{}, /*SecondsToWait=*/0,
+                                  /*MemoryLimit=*/0, &ErrMsg) == 0)
+      return true;
+    Errs.applyLocked([&](raw_ostream &OS) {
+      OS << "Error while building module " << MD.ModuleName << ":\n";
+      if (!ErrMsg.empty())
+        OS << ErrMsg << "\n";
+    });
+    return false;
+  }
+
+  std::string ModuleBuildDir;
+  /// The compile commands of the translation units, by input file.
+  std::map<std::string, tooling::CompileCommand> Commands;
+  std::mutex Lock;
+  /// The modules by context hash and name, sorted for a stable output.
+  std::map<ModuleKey, ModuleDeps> Modules;
+  std::vector<TranslationUnitDeps> Inputs;
+};
+
 /// The high-level implementation of the dependency discovery tool that runs on
 /// an individual worker thread.
 class DependencyScanningTool {
@@ -48,8 +352,9 @@ public:
   /// used by the clang tool.
   DependencyScanningTool(DependencyScanningService &Service,
                          const tooling::CompilationDatabase &Compilations,
-                         SharedStream &OS, SharedStream &Errs)
-      : Worker(Service), Compilations(Compilations), OS(OS), Errs(Errs) {}
+                         SharedStream &OS, SharedStream &Errs, FullDeps &FD)
+      : Worker(Service), Format(Service.getFormat()),
+        Compilations(Compilations), OS(OS), Errs(Errs), FD(FD) {}
 
   /// Print out the dependency information into a string using the dependency
   /// file format that is specified in the options (-MD is the default) and
@@ -107,30 +412,84 @@ public:
     return Output;
   }
 
-  /// Computes the dependencies for the given file and prints them out.
+  /// Collect the files and modules the given file depends on into the full
+  /// dependency graph.
+  ///
+  /// \returns A \c StringError with the diagnostic output if clang errors
+  /// occurred, success otherwise.
+  llvm::Error addFullDependencies(const std::string &Input, StringRef CWD) {
+    class FullDependencyConsumer : public DependencyConsumer {
+    public:
+      FullDependencyConsumer(FullDeps &FD) : FD(FD) {}
+
+      void handleFileDependency(const DependencyOutputOptions &Opts,
+                                StringRef File) override {
+        TU.FileDeps.push_back(File);
+      }
+
+      void handleModuleDependency(const ModuleDeps &MD) override {
+        FD.addModule(MD);
+      }
+
+      void handleDirectModuleDependency(StringRef ModuleName) override {
+        TU.ClangModuleDeps.push_back(ModuleName);
+      }
+
+      void handleContextHash(std::string Hash) override {
+        TU.ContextHash = std::move(Hash);
+      }
+
+      FullDeps &FD;
+      FullDeps::TranslationUnitDeps TU;
+    };
+
+    FullDependencyConsumer Consumer(FD);
+    if (llvm::Error Err =
+            Worker.computeDependencies(Input, CWD, Compilations, Consumer))
+      return Err;
+    Consumer.TU.Input = Input;
+    FD.addTranslationUnit(std::move(Consumer.TU));
+    return llvm::Error::success();
+  }
+
+  /// Computes the dependencies for the given file and prints them out, or
+  /// adds them to the full dependency graph.
   ///
   /// \returns True on error.
   bool runOnFile(const std::string &Input, StringRef CWD) {
+    if (Format == ScanningOutputFormat::Full)
+      return handleError(addFullDependencies(Input, CWD), Input);
+
     auto MaybeFile = getDependencyFile(Input, CWD);
-    if (!MaybeFile) {
-      llvm::handleAllErrors(
-          MaybeFile.takeError(), [this, &Input](llvm::StringError &Err) {
-            Errs.applyLocked([&](raw_ostream &OS) {
-              OS << "Error while scanning dependencies for " << Input << ":\n";
-              OS << Err.getMessage();
-            });
-          });
-      return true;
-    }
+    if (!MaybeFile)
+      return handleError(MaybeFile.takeError(), Input);
     OS.applyLocked([&](raw_ostream &OS) { OS << *MaybeFile; });
     return false;
   }
 
 private:
+  /// Prints out the diagnostics of a failed scan.
+  ///
+  /// \returns True on error.
+  bool handleError(llvm::Error Err, const std::string &Input) {
+    if (!Err)
+      return false;
+    llvm::handleAllErrors(
+        std::move(Err), [this, &Input](llvm::StringError &Err) {
+          Errs.applyLocked([&](raw_ostream &OS) {
+            OS << "Error while scanning dependencies for " << Input << ":\n";
+            OS << Err.getMessage();
+          });
+        });
+    return true;
+  }
+
   DependencyScanningWorker Worker;
+  ScanningOutputFormat Format;
   const tooling::CompilationDatabase &Compilations;
   SharedStream &OS;
   SharedStream &Errs;
+  FullDeps &FD;
 };
 
 llvm::cl::opt<bool> Help("h", llvm::cl::desc("Alias for -help"),
@@ -153,6 +512,29 @@ static llvm::cl::opt<ScanningMode> ScanMode(
     llvm::cl::init(ScanningMode::MinimizedSourcePreprocessing),
     llvm::cl::cat(DependencyScannerCategory));
 
+static llvm::cl::opt<ScanningOutputFormat> Format(
+    "format", llvm::cl::desc("The output format for the dependencies"),
+    llvm::cl::values(
+        clEnumValN(ScanningOutputFormat::Make, "make",
+                   "Makefile compatible dep file"),
+        clEnumValN(ScanningOutputFormat::Full, "experimental-full",
+                   "Full dependency graph suitable for explicitly building "
+                   "modules, as one JSON object. The command line of each "
+                   "module and translation unit is to be appended to the "
+                   "command of the translation unit. This format is "
+                   "experimental and will change.")),
+    llvm::cl::init(ScanningOutputFormat::Make),
+    llvm::cl::cat(DependencyScannerCategory));
+
+llvm::cl::opt<std::string> ModuleBuildDir(
+    "build-modules-dir",
+    llvm::cl::desc("With -format=experimental-full, build the modules "
+                   "explicitly into <dir>/<context hash>/<module>.pcm, the "
+                   "ones that do not depend on each other in parallel, and "
+                   "write <dir>/<context hash>/module-files.map for "
+                   "-fmodule-file-map="),
+    llvm::cl::value_desc("dir"), llvm::cl::cat(DependencyScannerCategory));
+
 llvm::cl::opt<unsigned>
     NumThreads("j", llvm::cl::Optional,
                llvm::cl::desc("Number of worker threads to use (default: use "
@@ -211,8 +593,14 @@ int main(int argc, const char **argv) {
 
   // By default the tool runs on all inputs in the CDB.
   std::vector<std::pair<std::string, std::string>> Inputs;
-  for (const auto &Command : Compilations->getAllCompileCommands())
+  SmallString<128> AbsoluteModuleBuildDir(ModuleBuildDir);
+  if (!AbsoluteModuleBuildDir.empty())
+    llvm::sys::fs::make_absolute(AbsoluteModuleBuildDir);
+  FullDeps FD(AbsoluteModuleBuildDir);
+  for (const auto &Command : Compilations->getAllCompileCommands()) {
     Inputs.emplace_back(Command.Filename, Command.Directory);
+    FD.addCompileCommand(Command);
+  }
 
   // The command options are rewritten to run Clang in preprocessor only mode.
   auto AdjustingCompilations =
@@ -273,7 +661,7 @@ int main(int argc, const char **argv) {
   // Print out the dependency results to STDOUT by default.
   SharedStream DependencyOS(llvm::outs());
 
-  DependencyScanningService Service(ScanMode, ReuseFileManager,
+  DependencyScanningService Service(ScanMode, Format, ReuseFileManager,
                                     SkipExcludedPPRanges);
 #if LLVM_ENABLE_THREADS
   unsigned NumWorkers =
@@ -284,7 +672,7 @@ int main(int argc, const char **argv) {
   std::vector<std::unique_ptr<DependencyScanningTool>> WorkerTools;
   for (unsigned I = 0; I < NumWorkers; ++I)
     WorkerTools.push_back(std::make_unique<DependencyScanningTool>(
-        Service, *AdjustingCompilations, DependencyOS, Errs));
+        Service, *AdjustingCompilations, DependencyOS, Errs, FD));
 
   std::vector<std::thread> WorkerThreads;
   std::atomic<bool> HadErrors(false);
@@ -324,5 +712,11 @@ int main(int argc, const char **argv) {
   for (auto &W : WorkerThreads)
     W.join();
 
+  if (Format == ScanningOutputFormat::Full) {
+    if (!ModuleBuildDir.empty() && FD.buildModules(NumWorkers, Errs))
+      HadErrors = true;
+    FD.printFullOutput(llvm::outs());
+  }
+
   return HadErrors;
 }
@@ -0,0 +1,219 @@
+//===- ClangTimeTraceSummary.cpp - Summarize -ftime-trace output ----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Reads the traces that -ftime-trace wrote for the translation units of a
+// build, and prints the template instantiations, headers, optimization passes
+// and other traced entities that took the most time across all of them. The
+// traces are read in parallel, and directories are searched for them.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/WithColor.h"
+#include "llvm/Support/raw_ostream.h"
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+static cl::OptionCategory SummaryCategory("clang-time-trace-summary options");
+
+static cl::list<std::string> InputFiles(cl::Positional, cl::OneOrMore,
+                                        cl::desc("<trace.json|directory>..."),
+                                        cl::cat(SummaryCategory));
+
+static cl::list<std::string>
+    EventNames("event", cl::CommaSeparated,
+               cl::desc("The events to summarize (default: "
+                        "InstantiateClass,InstantiateFunction,"
+                        "InstantiateVariable,Source,EvaluateAsInitializer,"
+                        "EvaluateAsConstantExpr,OverloadResolution,"
+                        "CodeGen Function,OptFunction,RunPass,"
+                        "ExecuteCompiler)"),
+               cl::cat(SummaryCategory));
+
+static cl::opt<unsigned> Top("top", cl::init(10),
+                             cl::desc("The number of entries to print for "
+                                      "each event (default: 10)"),
+                             cl::cat(SummaryCategory));
+
+static cl::opt<unsigned>
+    NumThreads("j", cl::init(0),
+               cl::desc("The number of traces to read at once (default: "
+                        "all the hardware threads)"),
+               cl::cat(SummaryCategory));
+
+namespace {
+
+/// The time spent in one traced entity, such as the instantiation of a
+/// specialization or the parsing of a header, over all the traces.
+struct Entry {
+  uint64_t TotalUs = 0;
+  unsigned Count = 0;
+};
+
+/// The entities of one event, by detail.
+using EventSummary = StringMap<Entry>;
+
+} // namespace
+
+/// Add the complete events of the trace \p Path to \p Summaries, whose set
+/// of events is not changed.
+static Error addTrace(StringRef Path, StringMap<EventSummary> &Summaries) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer = MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return createStringError(Buffer.getError(), Path + ": " +
+                                                    Buffer.getError().message());
+  Expected<json::Value> Trace = json::parse((*Buffer)->getBuffer());
+  if (!Trace)
+    return createStringError(inconvertibleErrorCode(),
+                             Path + ": " + toString(Trace.takeError()));
+  const json::Object *Root = Trace->getAsObject();
+  const json::Array *Events = Root ? Root->getArray("traceEvents") : nullptr;
+  if (!Events)
+    return createStringError(inconvertibleErrorCode(),
+                             Path + ": not a -ftime-trace file");
+
+  for (const json::Value &Value : *Events) {
+    const json::Object *Event = Value.getAsObject();
+    if (!Event || Event->getString("ph") != StringRef("X"))
+      continue;
+    Optional<StringRef> Name = Event->getString("name");
+    Optional<int64_t> Duration = Event->getInteger("dur");
+    const json::Object *Args = Event->getObject("args");
+    Optional<StringRef> Detail = Args ? Args->getString("detail") : None;
+    // The whole compilation has no detail; it is named after its trace.
+    if (Name && *Name == "ExecuteCompiler")
+      Detail = Path;
+    if (!Name || !Duration || !Detail || Detail->empty())
+      continue;
+    auto Summary = Summaries.find(*Name);
+    if (Summary == Summaries.end())
+      continue;
+    Entry &E = Summary->second[*Detail];
+    E.TotalUs += *Duration;
+    ++E.Count;
+  }
+  return Error::success();
+}
+
+/// Add the traces in \p Path to \p Traces: \p Path itself, or the ".json"
+/// files under it if it is a directory.
+static Error findTraces(StringRef Path, std::vector<std::string> &Traces) {
+  if (!sys::fs::is_directory(Path)) {
+    Traces.push_back(Path);
+    return Error::success();
+  }
+  std::error_code EC;
+  for (sys::fs::recursive_directory_iterator I(Path, EC), E; I != E && !EC;
+       I.increment(EC))
+    if (sys::path::extension(I->path()) == ".json" &&
+        !sys::fs::is_directory(I->path()))
+      Traces.push_back(I->path());
+  if (EC)
+    return createStringError(EC, Path + ": " + EC.message());
+  return Error::success();
+}
+
+int main(int argc, const char **argv) {
+  InitLLVM X(argc, argv);
+  cl::HideUnrelatedOptions(SummaryCategory);
+  cl::ParseCommandLineOptions(
+      argc, argv,
+      "Summarize the -ftime-trace output of the translation units of a "
+      "build.\n\nThe time of an entity includes the time of the entities "
+      "nested in it, such as the headers included by a header.\n");
+
+  StringMap<EventSummary> Summaries;
+  if (EventNames.empty())
+    for (StringRef Name :
+         {"InstantiateClass", "InstantiateFunction", "InstantiateVariable",
+          "Source", "EvaluateAsInitializer", "EvaluateAsConstantExpr",
+          "OverloadResolution", "CodeGen Function", "OptFunction", "RunPass",
+          "ExecuteCompiler"})
+      Summaries[Name];
+  else
+    for (const std::string &Name : EventNames)
+      Summaries[Name];
+
+  bool HadErrors = false;
+  auto ReportError = [&](Error E) {
+    if (!E)
+      return;
+    WithColor::error() << toString(std::move(E)) << "\n";
+    HadErrors = true;
+  };
+
+  std::vector<std::string> Traces;
+  for (const std::string &Path : InputFiles)
+    ReportError(findTraces(Path, Traces));
+
+  // Each trace is summarized on its own, then merged.
+  std::vector<StringRef> Events;
+  for (const auto &Summary : Summaries)
+    Events.push_back(Summary.getKey());
+  std::mutex Mutex;
+  ThreadPool Pool(hardware_concurrency_strategy(NumThreads));
+  for (const std::string &Path : Traces)
+    Pool.async([&] {
+      StringMap<EventSummary> TraceSummaries;
+      for (StringRef Event : Events)
+        TraceSummaries[Event];
+      Error Err = addTrace(Path, TraceSummaries);
+      std::lock_guard<std::mutex> Lock(Mutex);
+      ReportError(std::move(Err));
+      for (const auto &TraceSummary : TraceSummaries) {
+        EventSummary &Summary = Summaries[TraceSummary.getKey()];
+        for (const auto &TraceEntry : TraceSummary.second) {
+          Entry &E = Summary[TraceEntry.getKey()];
+          E.TotalUs += TraceEntry.second.TotalUs;
+          E.Count += TraceEntry.second.Count;
+        }
+      }
+    });
+  Pool.wait();
+
+  std::vector<StringRef> Names;
+  for (const auto &Summary : Summaries)
+    if (!Summary.second.empty())
+      Names.push_back(Summary.getKey());
+  llvm::sort(Names);
+
+  for (StringRef Name : Names) {
+    std::vector<const StringMapEntry<Entry> *> Entries;
+    for (const auto &E : Summaries[Name])
+      Entries.push_back(&E);
+    llvm::sort(Entries, [](const StringMapEntry<Entry> *A,
+                           const StringMapEntry<Entry> *B) {
+      if (A->second.TotalUs != B->second.TotalUs)
+        return A->second.TotalUs > B->second.TotalUs;
+      return A->getKey() < B->getKey();
+    });
+    if (Entries.size() > Top)
+      Entries.resize(Top);
+
+    outs() << "**** " << Name << " (" << Summaries[Name].size()
+           << " distinct):\n";
+    for (const StringMapEntry<Entry> *E : Entries)
+      outs() << formatv("{0,10:F1} ms {1,6}x  {2}\n",
+                        E->second.TotalUs / 1000.0, E->second.Count,
+                        E->getKey());
+    outs() << "\n";
+  }
+  return HadErrors;
+}
@@ -12,6 +12,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "clang/Basic/FileManager.h"
 #include "clang/Basic/Stack.h"
 #include "clang/Basic/TargetOptions.h"
 #include "clang/CodeGen/ObjectFilePCHContainerOperations.h"
@@ -244,6 +245,20 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
   if (!Success)
     return 1;
 
+  // The jobs that the driver runs in its own process share the stat cache of
+  // their file manager, as long as they see the same file system. Modules are
+  // written and read back during a build, so they do not share it.
+  static IntrusiveRefCntPtr<FileManager> SharedFileManager;
+  if (Clang->getHeaderSearchOpts().VFSOverlayFiles.empty() &&
+      !Clang->getLangOpts().Modules) {
+    StringRef WorkingDir = Clang->getFileSystemOpts().WorkingDir;
+    if (SharedFileManager &&
+        SharedFileManager->getFileSystemOpts().WorkingDir == WorkingDir)
+      Clang->setFileManager(SharedFileManager.get());
+    else
+      SharedFileManager = Clang->createFileManager();
+  }
+
   // Execute the frontend actions.
   {
     llvm::TimeTraceScope TimeScope("ExecuteCompiler", StringRef(""));
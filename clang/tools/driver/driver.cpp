@@ -318,6 +318,14 @@ static int ExecuteCC1Tool(ArrayRef<const char *> argv, StringRef Tool) {
   return 1;
 }
 
+/// Runs a -cc1 job of the driver in this process. The options of the LLVM
+/// libraries are global, so the uses of them by the driver and by the earlier
+/// jobs are reset first.
+static int ExecuteInProcessCC1Tool(ArrayRef<const char *> Argv) {
+  llvm::cl::ResetAllOptionOccurrences();
+  return ExecuteCC1Tool(Argv, Argv[1] + 4);
+}
+
 int main(int argc_, const char **argv_) {
   noteBottomOfStack();
   llvm::InitLLVM X(argc_, argv_);
@@ -450,6 +458,7 @@ int main(int argc_, const char **argv_) {
   Driver TheDriver(Path, llvm::sys::getDefaultTargetTriple(), Diags);
   SetInstallDir(argv, TheDriver, CanonicalPrefixes);
   TheDriver.setTargetAndMode(TargetAndMode);
+  TheDriver.CC1Main = &ExecuteInProcessCC1Tool;
 
   insertTargetAndModeArgs(TargetAndMode, argv, SavedStrings);
 
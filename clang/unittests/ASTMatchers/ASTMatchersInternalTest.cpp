@@ -163,6 +163,48 @@ TEST(MatchFinder, InterceptsEndOfTranslationUnit) {
   EXPECT_TRUE(VerifyCallback.Called);
 }
 
+TEST(DynTypedMatcher, RequiredNames) {
+  using Names = llvm::Optional<std::vector<StringRef>>;
+  auto RequiredNames = [](const internal::DynTypedMatcher &M) {
+    return M.getRequiredNames();
+  };
+  EXPECT_EQ(Names({"f"}),
+            RequiredNames(functionDecl(hasName("::ns::f"), isInline())));
+  EXPECT_EQ(Names({"f"}), RequiredNames(functionDecl(hasName("f")).bind("f")));
+  EXPECT_EQ(Names({"a", "b"}),
+            RequiredNames(namedDecl(anyOf(hasName("a"), hasName("b")))));
+  EXPECT_EQ(llvm::None,
+            RequiredNames(namedDecl(anyOf(hasName("a"), isImplicit()))));
+  EXPECT_EQ(llvm::None, RequiredNames(namedDecl(unless(hasName("a")))));
+  EXPECT_EQ(llvm::None, RequiredNames(functionDecl()));
+}
+
+TEST(MatchFinder, SkipsMatchersOfOtherNames) {
+  struct RecordingCallback : public MatchFinder::MatchCallback {
+    RecordingCallback(std::string Tag, std::vector<std::string> &Matches)
+        : Tag(Tag), Matches(Matches) {}
+    void run(const MatchFinder::MatchResult &Result) override {
+      const auto *D = Result.Nodes.getNodeAs<NamedDecl>("decl");
+      Matches.push_back(Tag + D->getNameAsString());
+    }
+    std::string Tag;
+    std::vector<std::string> &Matches;
+  };
+  std::vector<std::string> Matches;
+  RecordingCallback Any("any:", Matches), F("f:", Matches), G("g:", Matches);
+  MatchFinder Finder;
+  Finder.addMatcher(functionDecl(hasName("g")).bind("decl"), &G);
+  Finder.addMatcher(functionDecl().bind("decl"), &Any);
+  Finder.addMatcher(functionDecl(hasAnyName("::f", "h")).bind("decl"), &F);
+  std::unique_ptr<FrontendActionFactory> Factory(
+      newFrontendActionFactory(&Finder));
+  ASSERT_TRUE(tooling::runToolOnCode(Factory->create(),
+                                     "void f(); void g(); void i();"));
+  std::vector<std::string> Expected = {"any:f", "f:f", "g:g",
+                                       "any:g", "any:i"};
+  EXPECT_EQ(Expected, Matches);
+}
+
 TEST(Matcher, matchOverEntireASTContext) {
   std::unique_ptr<ASTUnit> AST =
       clang::tooling::buildASTFromCode("struct { int *foo; };");
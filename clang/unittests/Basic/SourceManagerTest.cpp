@@ -200,6 +200,28 @@ TEST_F(SourceManagerTest, locationPrintTest) {
             "</mainFile.cpp:1:1, /test-header.h:1:1>");
 }
 
+TEST(LineOffsetMappingTest, get) {
+  // Line endings of every kind, a "\r\n" split across the 16-byte chunks the
+  // buffer may be scanned in, and a tail shorter than a chunk with NULs in it.
+  std::string Source = "a\nb\r\nc\rd\n\re" + std::string(20, 'x') + "\r\n" +
+                       std::string(30, 'y') + "\n" + std::string(7, '\0') +
+                       "\r";
+  std::vector<unsigned> Expected = {0, 2, 5, 7, 9, 10, 33, 64, 72};
+
+  llvm::BumpPtrAllocator Alloc;
+  std::unique_ptr<llvm::MemoryBuffer> Buf =
+      llvm::MemoryBuffer::getMemBufferCopy(Source);
+  SrcMgr::LineOffsetMapping Mapping =
+      SrcMgr::LineOffsetMapping::get(*Buf, Alloc);
+  ASSERT_TRUE(bool(Mapping));
+  EXPECT_EQ(Expected, std::vector<unsigned>(Mapping.begin(), Mapping.end()));
+
+  Buf = llvm::MemoryBuffer::getMemBufferCopy("");
+  Mapping = SrcMgr::LineOffsetMapping::get(*Buf, Alloc);
+  EXPECT_EQ(1u, Mapping.size());
+  EXPECT_EQ(0u, Mapping[0]);
+}
+
 #if defined(LLVM_ON_UNIX)
 
 TEST_F(SourceManagerTest, getMacroArgExpandedLocation) {
@@ -115,19 +115,23 @@ private:
 
 class CTUAction : public clang::ASTFrontendAction {
 public:
-  CTUAction(bool *Success, unsigned OverrideLimit)
-      : Success(Success), OverrideLimit(OverrideLimit) {}
+  CTUAction(bool *Success, unsigned OverrideLimit,
+            unsigned MemoryLimit = 0)
+      : Success(Success), OverrideLimit(OverrideLimit),
+        MemoryLimit(MemoryLimit) {}
 
 protected:
   std::unique_ptr<clang::ASTConsumer>
   CreateASTConsumer(clang::CompilerInstance &CI, StringRef) override {
     CI.getAnalyzerOpts()->CTUImportThreshold = OverrideLimit;
+    CI.getAnalyzerOpts()->CTUMaxLoadedASTMemory = MemoryLimit;
     return std::make_unique<CTUASTConsumer>(CI, Success);
   }
 
 private:
   bool *Success;
   const unsigned OverrideLimit;
+  const unsigned MemoryLimit;
 };
 
 } // end namespace
@@ -146,6 +150,15 @@ TEST(CrossTranslationUnit, RespectsLoadThreshold) {
   EXPECT_FALSE(Success);
 }
 
+TEST(CrossTranslationUnit, KeepsASTInUseOverMemoryLimit) {
+  // The AST that the definition is imported from is not unloaded, even if it
+  // takes more memory than the limit.
+  bool Success = false;
+  EXPECT_TRUE(tooling::runToolOnCode(
+      std::make_unique<CTUAction>(&Success, 1u, 1u), "int f(int);"));
+  EXPECT_TRUE(Success);
+}
+
 TEST(CrossTranslationUnit, IndexFormatCanBeParsed) {
   llvm::StringMap<std::string> Index;
   Index["a"] = "/b/f1";
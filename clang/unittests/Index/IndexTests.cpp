@@ -267,6 +267,27 @@ TEST(IndexTest, UsingDecls) {
               Contains(AllOf(QName("std::foo"), Kind(SymbolKind::Using))));
 }
 
+TEST(IndexTest, ShouldTraverseDecl) {
+  std::string Code = R"cpp(
+    struct Skipped { int Member; };
+    struct Indexed { Skipped S; };
+  )cpp";
+  auto Index = std::make_shared<Indexer>();
+  IndexingOptions Opts;
+  Opts.ShouldTraverseDecl = [](const Decl *D) {
+    const auto *ND = dyn_cast<NamedDecl>(D);
+    return !ND || ND->getName() != "Skipped";
+  };
+  tooling::runToolOnCode(std::make_unique<IndexAction>(Index, Opts), Code);
+  EXPECT_THAT(Index->Symbols,
+              AllOf(Not(Contains(AllOf(QName("Skipped"),
+                                       HasRole(SymbolRole::Definition)))),
+                    Not(Contains(QName("Skipped::Member"))),
+                    Contains(QName("Indexed")),
+                    Contains(AllOf(QName("Skipped"),
+                                   HasRole(SymbolRole::Reference)))));
+}
+
 TEST(IndexTest, Constructors) {
   std::string Code = R"cpp(
     struct Foo {
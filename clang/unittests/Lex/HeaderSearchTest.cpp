@@ -17,6 +17,8 @@
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/HeaderSearchOptions.h"
 #include "clang/Serialization/InMemoryModuleCache.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
 #include "gtest/gtest.h"
 
 namespace clang {
@@ -45,6 +47,31 @@ protected:
     Search.AddSearchPath(DL, /*isAngled=*/false);
   }
 
+  // Looks Filename up in a new header search over the existing directories
+  // Dirs, and returns the path of the file found.
+  std::string lookupWithCache(std::shared_ptr<HeaderSearchOptions> Opts,
+                              ArrayRef<StringRef> Dirs, StringRef Filename) {
+    FileManager FM(FileMgrOpts, VFS);
+    SourceManager SM(Diags, FM);
+    HeaderSearch HS(Opts, SM, Diags, LangOpts, Target.get());
+    for (StringRef Dir : Dirs) {
+      auto DE = FM.getOptionalDirectoryRef(Dir);
+      assert(DE);
+      HS.AddSearchPath(DirectoryLookup(*DE, SrcMgr::C_User,
+                                       /*isFramework=*/false),
+                       /*isAngled=*/false);
+    }
+    const DirectoryLookup *CurDir;
+    Optional<FileEntryRef> File = HS.LookupFile(
+        Filename, SourceLocation(), /*isAngled=*/false, /*FromDir=*/nullptr,
+        CurDir, /*Includers=*/None, /*SearchPath=*/nullptr,
+        /*RelativePath=*/nullptr, /*RequestingModule=*/nullptr,
+        /*SuggestedModule=*/nullptr, /*IsMapped=*/nullptr,
+        /*IsFrameworkFound=*/nullptr);
+    HS.savePersistentCache();
+    return File ? File->getName().str() : "";
+  }
+
   IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> VFS;
   FileSystemOptions FileMgrOpts;
   FileManager FileMgr;
@@ -136,5 +163,28 @@ TEST_F(HeaderSearchTest, IncludeFromSameDirectory) {
             "y/z/t.h");
 }
 
+TEST_F(HeaderSearchTest, PersistentCache) {
+  SmallString<128> CachePath;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("header-search", "cache",
+                                                  CachePath));
+  llvm::FileRemover Cleanup(CachePath);
+  auto Opts = std::make_shared<HeaderSearchOptions>();
+  Opts->HeaderSearchCachePath = CachePath.str();
+
+  for (StringRef Dir : {"/a", "/c"})
+    VFS->addFile(Dir, 0, llvm::MemoryBuffer::getMemBuffer(""), /*User=*/None,
+                 /*Group=*/None, llvm::sys::fs::file_type::directory_file);
+  VFS->addFile("/b/h.h", 0, llvm::MemoryBuffer::getMemBuffer(""));
+  EXPECT_EQ("/b/h.h", lookupWithCache(Opts, {"/a", "/b"}, "h.h"));
+
+  // The in-memory file system keeps the modification time of /a, so the
+  // cached lookup still goes straight to /b.
+  VFS->addFile("/a/h.h", 0, llvm::MemoryBuffer::getMemBuffer(""));
+  EXPECT_EQ("/b/h.h", lookupWithCache(Opts, {"/a", "/b"}, "h.h"));
+
+  // Other search paths do not use the lookups of these.
+  EXPECT_EQ("/a/h.h", lookupWithCache(Opts, {"/a", "/b", "/c"}, "h.h"));
+}
+
 } // namespace
 } // namespace clang
@@ -11,10 +11,12 @@
 #include "clang/StaticAnalyzer/Core/BugReporter/BugType.h"
 #include "clang/StaticAnalyzer/Core/Checker.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/CheckerContext.h"
 #include "clang/StaticAnalyzer/Frontend/AnalysisConsumer.h"
 #include "clang/StaticAnalyzer/Frontend/CheckerRegistry.h"
 #include "clang/Tooling/Tooling.h"
 #include "gtest/gtest.h"
+#include <functional>
 
 namespace clang {
 namespace ento {
@@ -37,12 +39,17 @@ class TestAction : public ASTFrontendAction {
   };
 
   llvm::raw_ostream &DiagsOutput;
+  std::function<void(AnalyzerOptions &)> SetOptions;
 
 public:
-  TestAction(llvm::raw_ostream &DiagsOutput) : DiagsOutput(DiagsOutput) {}
+  TestAction(llvm::raw_ostream &DiagsOutput,
+             std::function<void(AnalyzerOptions &)> SetOptions = nullptr)
+      : DiagsOutput(DiagsOutput), SetOptions(std::move(SetOptions)) {}
 
   std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &Compiler,
                                                  StringRef File) override {
+    if (SetOptions)
+      SetOptions(*Compiler.getAnalyzerOpts());
     std::unique_ptr<AnalysisASTConsumer> AnalysisConsumer =
         CreateAnalysisConsumer(Compiler);
     AnalysisConsumer->AddDiagnosticConsumer(new DiagConsumer(DiagsOutput));
@@ -100,6 +107,44 @@ TEST(RegisterCustomCheckers, CheckLocationIncDec) {
       runCheckerOnCode<LocIncDecChecker>("void f() { int *p; (*p)++; }"));
 }
 
+class TopLevelFunctionChecker : public Checker<check::BeginFunction> {
+public:
+  void checkBeginFunction(CheckerContext &C) const {
+    if (!C.inTopFrame())
+      return;
+    const Decl *D = C.getLocationContext()->getDecl();
+    std::string Name = cast<NamedDecl>(D)->getNameAsString();
+    C.getBugReporter().EmitBasicReport(
+        D, this, Name, categories::LogicError, Name + ";",
+        PathDiagnosticLocation(D, C.getSourceManager()), {});
+  }
+};
+
+TEST(AnalysisConsumer, ShardsTopLevelFunctions) {
+  // 'a' is only analyzed when inlined into 'b', in the same shard.
+  const char *Code = "void a() {} void b() { a(); } void c() {} void d() {}";
+  auto Run = [&](unsigned ShardIndex) {
+    std::string Diags;
+    llvm::raw_string_ostream OS(Diags);
+    EXPECT_TRUE(tooling::runToolOnCode(
+        std::make_unique<TestAction<TopLevelFunctionChecker>>(
+            OS,
+            [&](AnalyzerOptions &Opts) {
+              Opts.ShardCount = 2;
+              Opts.ShardIndex = ShardIndex;
+            }),
+        Code));
+    return OS.str();
+  };
+  std::string Diags;
+  EXPECT_TRUE(runCheckerOnCode<TopLevelFunctionChecker>(Code, Diags));
+  EXPECT_EQ("custom.CustomChecker:b;custom.CustomChecker:c;"
+            "custom.CustomChecker:d;",
+            Diags);
+  EXPECT_EQ("custom.CustomChecker:b;", Run(0));
+  EXPECT_EQ("custom.CustomChecker:c;custom.CustomChecker:d;", Run(1));
+}
+
 }
 }
 }
@@ -349,6 +349,29 @@ TEST(findCompileArgsInJsonDatabase, ReadsDirectoryWithSpaces) {
   EXPECT_EQ(Directory, FoundCommand.Directory) << ErrorMessage;
 }
 
+TEST(findCompileArgsInJsonDatabase, ReadsEscapedStrings) {
+  std::string ErrorMessage;
+  CompileCommand FoundCommand = findCompileArgsInJsonDatabase(
+    "//net/path/to/a-file.cpp",
+    "[{\"directory\":\"//net/some\\/directory\\\\with\\tescapes\","
+    "\"arguments\":[\"compiler\", \"-DA=\\\"b\\\"\"],"
+    "\"file\":\"//net/path/to/a-file.cpp\"}]",
+    ErrorMessage);
+  EXPECT_EQ("//net/some/directory\\with\tescapes", FoundCommand.Directory)
+      << ErrorMessage;
+  ASSERT_EQ(2u, FoundCommand.CommandLine.size()) << ErrorMessage;
+  EXPECT_EQ("-DA=\"b\"", FoundCommand.CommandLine[1]) << ErrorMessage;
+
+  // The escapes that the index does not support are decoded by the YAML parser.
+  FoundCommand = findCompileArgsInJsonDatabase(
+    "//net/path/to/a-file.cpp",
+    "[{\"directory\":\"//net/some/\\u0064irectory\","
+    "\"command\":\"compiler\",\"file\":\"//net/path/to/a-file.cpp\"}]",
+    ErrorMessage);
+  EXPECT_EQ("//net/some/directory", FoundCommand.Directory) << ErrorMessage;
+  ASSERT_EQ(1u, FoundCommand.CommandLine.size()) << ErrorMessage;
+}
+
 TEST(findCompileArgsInJsonDatabase, FindsEntry) {
   StringRef Directory("//net/directory");
   StringRef FileName("file");
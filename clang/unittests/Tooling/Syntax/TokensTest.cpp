@@ -89,14 +89,17 @@ public:
   /// Run the clang frontend, collect the preprocessed tokens from the frontend
   /// invocation and store them in this->Buffer.
   /// This also clears SourceManager before running the compiler.
-  void recordTokens(llvm::StringRef Code) {
+  void recordTokens(llvm::StringRef Code, bool MainFileOnly = false) {
     class RecordTokens : public ASTFrontendAction {
     public:
-      explicit RecordTokens(TokenBuffer &Result) : Result(Result) {}
+      RecordTokens(TokenBuffer &Result, bool MainFileOnly)
+          : Result(Result), MainFileOnly(MainFileOnly) {}
 
       bool BeginSourceFileAction(CompilerInstance &CI) override {
         assert(!Collector && "expected only a single call to BeginSourceFile");
         Collector.emplace(CI.getPreprocessor());
+        if (MainFileOnly)
+          Collector->recordMainFileOnly();
         return true;
       }
       void EndSourceFileAction() override {
@@ -111,6 +114,7 @@ public:
 
     private:
       TokenBuffer &Result;
+      bool MainFileOnly;
       llvm::Optional<TokenCollector> Collector;
     };
 
@@ -133,7 +137,7 @@ public:
     Compiler.setSourceManager(SourceMgr.get());
 
     this->Buffer = TokenBuffer(*SourceMgr);
-    RecordTokens Recorder(this->Buffer);
+    RecordTokens Recorder(this->Buffer, MainFileOnly);
     ASSERT_TRUE(Compiler.ExecuteAction(Recorder))
         << "failed to run the frontend";
   }
@@ -574,6 +578,37 @@ file './bar.h'
       << "input: " << Code << "\nresults: " << collectAndDump(Code);
 }
 
+TEST_F(TokenCollectorTest, MainFileOnly) {
+  addFile("./foo.h", R"cpp(
+    #define ADD(X, Y) X+Y
+    int a = 100;
+  )cpp");
+  llvm::StringLiteral Code = R"cpp(
+    #include "foo.h"
+    int c = ADD(1, 2);
+  )cpp";
+  recordTokens(Code, /*MainFileOnly=*/true);
+
+  std::string Expected = R"(expanded tokens:
+  int a = 100 ; int c = 1 + 2 ;
+file './input.cpp'
+  spelled tokens:
+    # include "foo.h" int c = ADD ( 1 , 2 ) ;
+  mappings:
+    ['#'_0, 'int'_3) => ['int'_5, 'int'_5)
+    ['ADD'_6, ';'_12) => ['1'_8, ';'_11)
+)";
+  EXPECT_EQ(Expected, Buffer.dumpForTests());
+
+  // The tokens of the header are lexed on request, but are not mapped.
+  auto Header = findExpanded("int a = 100 ;");
+  FileID HeaderFID = SourceMgr->getFileID(Header.front().location());
+  auto Spelled = findSpelled("int a = 100 ;", HeaderFID);
+  EXPECT_EQ(Spelled.front().location(), Header.front().location());
+  EXPECT_EQ(Buffer.spelledForExpanded(Header), llvm::None);
+  EXPECT_EQ(Buffer.expansionStartingAt(&Spelled.front()), llvm::None);
+}
+
 class TokenBufferTest : public TokenCollectorTest {};
 
 TEST_F(TokenBufferTest, SpelledByExpanded) {
@@ -33,6 +33,35 @@ void PoisonShadowPartialRightRedzone(uptr addr,
                                      uptr redzone_size,
                                      u8 value);
 
+// Shadow ranges up to this size are filled inline rather than with memset.
+// Most heap and stack redzones are below it.
+const uptr kInlineShadowFillSize = 64;
+
+// Sets [shadow_beg, shadow_end) to value, using word stores for the aligned
+// part, which for small ranges is cheaper than a call to memset.
+ALWAYS_INLINE void FillShadowInline(uptr shadow_beg, uptr shadow_end,
+                                    u8 value) {
+  DCHECK_LE(shadow_end - shadow_beg, kInlineShadowFillSize);
+  u8 *beg = reinterpret_cast<u8 *>(shadow_beg);
+  u8 *end = reinterpret_cast<u8 *>(shadow_end);
+  uptr *word_beg =
+      reinterpret_cast<uptr *>(RoundUpTo(shadow_beg, sizeof(uptr)));
+  uptr *word_end =
+      reinterpret_cast<uptr *>(RoundDownTo(shadow_end, sizeof(uptr)));
+  if (word_beg >= word_end) {
+    for (u8 *p = beg; p < end; p++)
+      *p = value;
+    return;
+  }
+  const uptr word = value * (~(uptr)0 / 0xff);
+  for (u8 *p = beg; p < reinterpret_cast<u8 *>(word_beg); p++)
+    *p = value;
+  for (uptr *p = word_beg; p < word_end; p++)
+    *p = word;
+  for (u8 *p = reinterpret_cast<u8 *>(word_end); p < end; p++)
+    *p = value;
+}
+
 // Fast versions of PoisonShadow and PoisonShadowPartialRightRedzone that
 // assume that memory addresses are properly aligned. Use in
 // performance-critical code with care.
@@ -46,6 +75,10 @@ ALWAYS_INLINE void FastPoisonShadow(uptr aligned_beg, uptr aligned_size,
   uptr shadow_beg = MEM_TO_SHADOW(aligned_beg);
   uptr shadow_end = MEM_TO_SHADOW(
       aligned_beg + aligned_size - SHADOW_GRANULARITY) + 1;
+  if (shadow_end - shadow_beg <= kInlineShadowFillSize) {
+    FillShadowInline(shadow_beg, shadow_end, value);
+    return;
+  }
   // FIXME: Page states are different on Windows, so using the same interface
   // for mapping shadow and zeroing out pages doesn't "just work", so we should
   // probably provide higher-level interface for these operations.
@@ -80,17 +113,37 @@ ALWAYS_INLINE void FastPoisonShadowPartialRightRedzone(
     uptr aligned_addr, uptr size, uptr redzone_size, u8 value) {
   DCHECK(CanPoisonMemory());
   bool poison_partial = flags()->poison_partial;
-  u8 *shadow = (u8*)MEM_TO_SHADOW(aligned_addr);
-  for (uptr i = 0; i < redzone_size; i += SHADOW_GRANULARITY, shadow++) {
-    if (i + SHADOW_GRANULARITY <= size) {
-      *shadow = 0;  // fully addressable
-    } else if (i >= size) {
-      *shadow = (SHADOW_GRANULARITY == 128) ? 0xff : value;  // unaddressable
-    } else {
-      // first size-i bytes are addressable
-      *shadow = poison_partial ? static_cast<u8>(size - i) : 0;
+  uptr shadow = MEM_TO_SHADOW(aligned_addr);
+  uptr shadow_end = shadow + RoundUpTo(redzone_size, SHADOW_GRANULARITY) /
+                                 SHADOW_GRANULARITY;
+  if (shadow_end - shadow > kInlineShadowFillSize) {
+    // Rare for redzones, keep the simple loop.
+    u8 *p = reinterpret_cast<u8 *>(shadow);
+    for (uptr i = 0; i < redzone_size; i += SHADOW_GRANULARITY, p++) {
+      if (i + SHADOW_GRANULARITY <= size) {
+        *p = 0;  // fully addressable
+      } else if (i >= size) {
+        *p = (SHADOW_GRANULARITY == 128) ? 0xff : value;  // unaddressable
+      } else {
+        // first size-i bytes are addressable
+        *p = poison_partial ? static_cast<u8>(size - i) : 0;
+      }
     }
+    return;
+  }
+  // The shadow is made of fully addressable granules, then at most one
+  // partially addressable granule, then unaddressable ones.
+  uptr addressable_end =
+      Min<uptr>(shadow + size / SHADOW_GRANULARITY, shadow_end);
+  FillShadowInline(shadow, addressable_end, 0);
+  uptr unaddressable_beg = addressable_end;
+  if (size % SHADOW_GRANULARITY && addressable_end < shadow_end) {
+    *reinterpret_cast<u8 *>(addressable_end) =
+        poison_partial ? static_cast<u8>(size % SHADOW_GRANULARITY) : 0;
+    unaddressable_beg++;
   }
+  FillShadowInline(unaddressable_beg, shadow_end,
+                   (SHADOW_GRANULARITY == 128) ? 0xff : value);
 }
 
 // Calls __sanitizer::ReleaseMemoryPagesToOS() on
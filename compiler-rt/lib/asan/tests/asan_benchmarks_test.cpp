@@ -78,6 +78,37 @@ TEST(AddressSanitizer, FakeStackBenchmark) {
     Ident(&FunctionWithLargeStack)();
 }
 
+// Small heap chunks, whose redzones are poisoned and unpoisoned on every
+// malloc and free.
+TEST(AddressSanitizer, SmallMallocFreeBenchmark) {
+  const size_t kNumChunks = 64;
+  void *chunks[kNumChunks];
+  for (int iter = 0; iter < 200000; iter++) {
+    for (size_t i = 0; i < kNumChunks; i++)
+      chunks[i] = Ident(malloc(16 + (i % 8) * 24));
+    for (size_t i = 0; i < kNumChunks; i++)
+      free(chunks[i]);
+  }
+}
+
+// A frame with many small variables, whose stack redzones are poisoned on
+// entry and unpoisoned on exit.
+__attribute__((noinline))
+static void FunctionWithManySmallLocals() {
+  char a[3], b[7], c[13], d[21], e[34], f[55];
+  Ident(a);
+  Ident(b);
+  Ident(c);
+  Ident(d);
+  Ident(e);
+  Ident(f);
+}
+
+TEST(AddressSanitizer, StackRedzoneBenchmark) {
+  for (int i = 0; i < 50000000; i++)
+    Ident(&FunctionWithManySmallLocals)();
+}
+
 int main(int argc, char **argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -61,6 +61,14 @@ static Stats ParseFinalStatsFromLog(const std::string &LogPath) {
   return Res;
 }
 
+static Vector<uint32_t> ReadUint32sFromFile(const std::string &Path) {
+  auto Bytes = FileToVector(Path, 0, false);
+  assert((Bytes.size() % sizeof(uint32_t)) == 0);
+  Vector<uint32_t> Res(Bytes.size() / sizeof(uint32_t));
+  memcpy(Res.data(), Bytes.data(), Res.size() * sizeof(uint32_t));
+  return Res;
+}
+
 struct FuzzJob {
   // Inputs.
   Command Cmd;
@@ -68,7 +76,6 @@ struct FuzzJob {
   std::string FeaturesDir;
   std::string LogPath;
   std::string SeedListPath;
-  std::string CFPath;
   size_t      JobId;
 
   int         DftTimeInSeconds = 0;
@@ -77,7 +84,6 @@ struct FuzzJob {
   int ExitCode;
 
   ~FuzzJob() {
-    RemoveFile(CFPath);
     RemoveFile(LogPath);
     RemoveFile(SeedListPath);
     RmDirRecursive(CorpusDir);
@@ -153,7 +159,6 @@ struct GlobalEnv {
     Job->LogPath = DirPlusFile(TempDir, std::to_string(JobId) + ".log");
     Job->CorpusDir = DirPlusFile(TempDir, "C" + std::to_string(JobId));
     Job->FeaturesDir = DirPlusFile(TempDir, "F" + std::to_string(JobId));
-    Job->CFPath = DirPlusFile(TempDir, std::to_string(JobId) + ".merge");
     Job->JobId = JobId;
 
 
@@ -181,25 +186,30 @@ struct GlobalEnv {
     auto Stats = ParseFinalStatsFromLog(Job->LogPath);
     NumRuns += Stats.number_of_executed_units;
 
-    Vector<SizedFile> TempFiles, MergeCandidates;
-    // Read all newly created inputs and their feature sets.
-    // Choose only those inputs that have new features.
+    // Read all newly created inputs and their feature sets, and choose the
+    // inputs that have new features, smallest first. The job wrote the
+    // features that each input added to its own corpus, so any feature that
+    // is new to us is in the set of some input, and the inputs don't need to
+    // be re-run to merge them.
+    Vector<SizedFile> TempFiles;
+    Vector<std::string> FilesToAdd;
+    Set<uint32_t> NewFeatures, NewCov;
     GetSizedFilesFromDir(Job->CorpusDir, &TempFiles);
     std::sort(TempFiles.begin(), TempFiles.end());
     for (auto &F : TempFiles) {
       auto FeatureFile = F.File;
       FeatureFile.replace(0, Job->CorpusDir.size(), Job->FeaturesDir);
-      auto FeatureBytes = FileToVector(FeatureFile, 0, false);
-      assert((FeatureBytes.size() % sizeof(uint32_t)) == 0);
-      Vector<uint32_t> NewFeatures(FeatureBytes.size() / sizeof(uint32_t));
-      memcpy(NewFeatures.data(), FeatureBytes.data(), FeatureBytes.size());
-      for (auto Ft : NewFeatures) {
-        if (!Features.count(Ft)) {
-          MergeCandidates.push_back(F);
-          break;
-        }
-      }
+      bool HasNewFeatures = false;
+      for (auto Ft : ReadUint32sFromFile(FeatureFile))
+        if (!Features.count(Ft) && NewFeatures.insert(Ft).second)
+          HasNewFeatures = true;
+      if (HasNewFeatures)
+        FilesToAdd.push_back(F.File);
     }
+    for (auto Idx :
+         ReadUint32sFromFile(DirPlusFile(Job->FeaturesDir, kObservedPCsFile)))
+      if (!Cov.count(Idx))
+        NewCov.insert(Idx);
     // if (!FilesToAdd.empty() || Job->ExitCode != 0)
     Printf("#%zd: cov: %zd ft: %zd corp: %zd exec/s %zd "
            "oom/timeout/crash: %zd/%zd/%zd time: %zds job: %zd dft_time: %d\n",
@@ -207,12 +217,6 @@ struct GlobalEnv {
            Stats.average_exec_per_sec, NumOOMs, NumTimeouts, NumCrashes,
            secondsSinceProcessStartUp(), Job->JobId, Job->DftTimeInSeconds);
 
-    if (MergeCandidates.empty()) return;
-
-    Vector<std::string> FilesToAdd;
-    Set<uint32_t> NewFeatures, NewCov;
-    CrashResistantMerge(Args, {}, MergeCandidates, &FilesToAdd, Features,
-                        &NewFeatures, Cov, &NewCov, Job->CFPath, false);
     for (auto &Path : FilesToAdd) {
       auto U = FileToVector(Path);
       auto NewPath = DirPlusFile(MainCorpusDir, Hash(U));
@@ -16,6 +16,10 @@
 #include <string>
 
 namespace fuzzer {
+// Name of the file in the -features_dir of a fork mode job where the job
+// writes the indices of the PCs it has covered when it exits.
+const char kObservedPCsFile[] = "observed_pcs";
+
 void FuzzWithFork(Random &Rand, const FuzzingOptions &Options,
                   const Vector<std::string> &Args,
                   const Vector<std::string> &CorpusDirs, int NumJobs);
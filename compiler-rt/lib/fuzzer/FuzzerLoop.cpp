@@ -9,6 +9,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "FuzzerCorpus.h"
+#include "FuzzerFork.h"
 #include "FuzzerIO.h"
 #include "FuzzerInternal.h"
 #include "FuzzerMutate.h"
@@ -352,7 +353,22 @@ void Fuzzer::PrintStats(const char *Where, const char *End, size_t Units,
   Printf("%s", End);
 }
 
+// Lets the parent of a fork mode job update its coverage without re-running
+// the inputs found by the job.
+static void WriteObservedPCsToFile(const std::string &FeaturesDir) {
+  if (FeaturesDir.empty()) return;
+  Vector<uint32_t> Idxs;
+  TPC.ForEachObservedPC([&](const TracePC::PCTableEntry *TE) {
+    Idxs.push_back(static_cast<uint32_t>(TPC.PCTableEntryIdx(TE)));
+  });
+  WriteToFile(reinterpret_cast<const uint8_t *>(Idxs.data()),
+              Idxs.size() * sizeof(Idxs[0]),
+              DirPlusFile(FeaturesDir, kObservedPCsFile));
+}
+
 void Fuzzer::PrintFinalStats() {
+  // This is called on all the exit paths.
+  WriteObservedPCsToFile(Options.FeaturesDir);
   if (Options.PrintCoverage)
     TPC.PrintCoverage();
   if (Options.PrintCorpusStats)
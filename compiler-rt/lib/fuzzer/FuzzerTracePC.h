@@ -186,18 +186,37 @@ size_t ForEachNonZeroByte(const uint8_t *Begin, const uint8_t *End,
   typedef uintptr_t LargeType;
   const size_t Step = sizeof(LargeType) / sizeof(uint8_t);
   const size_t StepMask = Step - 1;
+  // Number of words checked at once for non-zero bytes. Most counters are
+  // zero after an execution, so whole blocks can usually be skipped after a
+  // single check, and the OR of a block compiles to a few vector instructions.
+  const size_t WordsPerBlock = 8;
   auto P = Begin;
+  auto HandleWord = [&](const uint8_t *W) {
+    if (LargeType Bundle = *reinterpret_cast<const LargeType *>(W))
+      for (size_t I = 0; I < Step; I++, Bundle >>= 8)
+        if (uint8_t V = Bundle & 0xff)
+          Handle8bitCounter(FirstFeature, W - Begin + I, V);
+  };
   // Iterate by 1 byte until either the alignment boundary or the end.
   for (; reinterpret_cast<uintptr_t>(P) & StepMask && P < End; P++)
     if (uint8_t V = *P)
       Handle8bitCounter(FirstFeature, P - Begin, V);
 
+  // Iterate by blocks of WordsPerBlock * Step bytes at a time.
+  for (; static_cast<size_t>(End - P) >= WordsPerBlock * Step;
+       P += WordsPerBlock * Step) {
+    auto Words = reinterpret_cast<const LargeType *>(P);
+    LargeType Any = 0;
+    for (size_t I = 0; I < WordsPerBlock; I++)
+      Any |= Words[I];
+    if (!Any) continue;
+    for (size_t I = 0; I < WordsPerBlock; I++)
+      HandleWord(P + I * Step);
+  }
+
   // Iterate by Step bytes at a time.
-  for (; P < End; P += Step)
-    if (LargeType Bundle = *reinterpret_cast<const LargeType *>(P))
-      for (size_t I = 0; I < Step; I++, Bundle >>= 8)
-        if (uint8_t V = Bundle & 0xff)
-          Handle8bitCounter(FirstFeature, P - Begin + I, V);
+  for (; static_cast<size_t>(End - P) >= Step; P += Step)
+    HandleWord(P);
 
   // Iterate by 1 byte until the end.
   for (; P < End; P++)
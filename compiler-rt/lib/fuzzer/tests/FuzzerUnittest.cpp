@@ -888,6 +888,36 @@ TEST(Fuzzer, ForEachNonZeroByte) {
   Expected = {          {109, 2}, {118, 3}, {120, 4},
               {135, 5}, {137, 6}, {146, 7}};
   EXPECT_EQ(Res, Expected);
+
+  // Nothing past the end is reported, even within the last word.
+  Res.clear();
+  ForEachNonZeroByte(Ar, Ar + N + 3, 100, CB);
+  Expected = {{108, 1}, {109, 2}, {118, 3}, {120, 4}, {135, 5},
+              {137, 6}, {146, 7}, {163, 8}, {164, 9}, {165, 9}, {166, 9}};
+  EXPECT_EQ(Res, Expected);
+}
+
+TEST(Fuzzer, ForEachNonZeroByteSparse) {
+  // Large enough for the all-zero blocks to be skipped.
+  const size_t N = 4096;
+  alignas(64) uint8_t Ar[N] = {};
+  const size_t NonZero[] = {0, 63, 64, 130, 1000, 2047, 2048, 4000, 4095};
+  for (size_t I : NonZero)
+    Ar[I] = static_cast<uint8_t>(I % 251 + 1);
+  typedef Vector<std::pair<size_t, uint8_t> > Vec;
+  Vec Res, Expected;
+  auto CB = [&](size_t FirstFeature, size_t Idx, uint8_t V) {
+    Res.push_back({FirstFeature + Idx, V});
+  };
+  for (size_t Begin : {0, 1, 7, 63}) {
+    Res.clear();
+    Expected.clear();
+    for (size_t I : NonZero)
+      if (I >= Begin)
+        Expected.push_back({I, Ar[I]});
+    EXPECT_EQ(ForEachNonZeroByte(Ar + Begin, Ar + N, Begin, CB), N - Begin);
+    EXPECT_EQ(Res, Expected);
+  }
 }
 
 // FuzzerCommand unit tests. The arguments in the two helper methods below must
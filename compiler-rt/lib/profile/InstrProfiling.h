@@ -176,6 +176,18 @@ void __llvm_profile_set_filename(const char *Name);
  */
 void __llvm_profile_set_file_object(FILE *File, int EnableMerge);
 
+/*!
+ * \brief Return non-zero if the profile counters are kept in the profile file.
+ *
+ * Continuous mode is requested with the \c %c specifier in the profile file
+ * name. The counters are then updated in a shared mapping of the raw profile
+ * file, so the profile is up to date even if the program doesn't exit
+ * normally, and it isn't written again at exit. This needs every instrumented
+ * file in the module to be compiled with -mllvm -runtime-counter-relocation.
+ * Value profiles are not kept up to date.
+ */
+int __llvm_profile_is_continuous_mode_enabled(void);
+
 /*! \brief Register to write instrumentation data to file at exit. */
 int __llvm_profile_register_write_file_atexit(void);
 
@@ -83,11 +83,14 @@ typedef struct lprofFilename {
    * 2 profile data files. %1m is equivalent to %m. Also %m specifier
    * can only appear once at the end of the name pattern. */
   unsigned MergePoolSize;
+  /* Set if the %c specifier requests continuous mode, in which the counters
+   * are kept in a shared mapping of the profile file. */
+  unsigned ContinuousMode;
   ProfileNameSpecifier PNS;
 } lprofFilename;
 
-COMPILER_RT_WEAK lprofFilename lprofCurFilename = {0,   0, 0, 0, {0},
-                                                   {0}, 0, 0, 0, PNS_unknown};
+COMPILER_RT_WEAK lprofFilename lprofCurFilename = {
+    0, 0, 0, 0, {0}, {0}, 0, 0, 0, 0, PNS_unknown};
 
 static int ProfileMergeRequested = 0;
 static int isProfileMergeRequested() { return ProfileMergeRequested; }
@@ -435,6 +438,13 @@ static int parseFilenamePattern(const char *FilenamePat,
           lprofCurFilename.MergePoolSize = FilenamePat[I] - '0';
           I++; /* advance to 'm' */
         }
+      } else if (FilenamePat[I] == 'c') {
+        if (lprofCurFilename.ContinuousMode) {
+          PROF_WARN("%%c specifier can only be specified once in %s.\n",
+                    FilenamePat);
+          return -1;
+        }
+        lprofCurFilename.ContinuousMode = 1;
       }
     }
 
@@ -490,7 +500,7 @@ static int getCurFilenameLength() {
     return 0;
 
   if (!(lprofCurFilename.NumPids || lprofCurFilename.NumHosts ||
-        lprofCurFilename.MergePoolSize))
+        lprofCurFilename.MergePoolSize || lprofCurFilename.ContinuousMode))
     return strlen(lprofCurFilename.FilenamePat);
 
   Len = strlen(lprofCurFilename.FilenamePat) +
@@ -514,7 +524,7 @@ static const char *getCurFilename(char *FilenameBuf, int ForceUseBuf) {
     return 0;
 
   if (!(lprofCurFilename.NumPids || lprofCurFilename.NumHosts ||
-        lprofCurFilename.MergePoolSize)) {
+        lprofCurFilename.MergePoolSize || lprofCurFilename.ContinuousMode)) {
     if (!ForceUseBuf)
       return lprofCurFilename.FilenamePat;
 
@@ -619,6 +629,148 @@ const char *__llvm_profile_get_filename(void) {
   return FilenameBuf;
 }
 
+/* Set once the counters have been relocated into the profile file. */
+static int ContinuousModeEnabled = 0;
+
+COMPILER_RT_VISIBILITY int __llvm_profile_is_continuous_mode_enabled(void) {
+  return ContinuousModeEnabled;
+}
+
+#if defined(__ELF__)
+/* This variable is defined by the instrumented code when it is compiled with
+ * -runtime-counter-relocation, the weak reference is null otherwise. */
+COMPILER_RT_VISIBILITY COMPILER_RT_WEAK extern intptr_t
+    INSTR_PROF_PROFILE_COUNTER_BIAS_VAR;
+
+/* Write the profile data of this process to \c File, through a shared mapping
+ * of \c Size bytes of the file that is returned in \c *Profile. Returns -1 if
+ * there is an error, otherwise 0. */
+static int writeMMappedFile(FILE *File, uint64_t Size, char **Profile) {
+  if (COMPILER_RT_FTRUNCATE(File, Size) == -1) {
+    PROF_ERR("Unable to resize profile file: %s\n", strerror(errno));
+    return -1;
+  }
+  *Profile = mmap(NULL, Size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FILE,
+                  fileno(File), 0);
+  if (*Profile == MAP_FAILED) {
+    PROF_ERR("Unable to map profile file: %s\n", strerror(errno));
+    return -1;
+  }
+  if (__llvm_profile_write_buffer(*Profile)) {
+    PROF_ERR("Unable to write profile file: %s\n", "writing data failed");
+    (void)munmap(*Profile, Size);
+    return -1;
+  }
+  return 0;
+}
+
+/* Map the profile data that earlier runs left in \c File, which is \c
+ * ProfileFileSize bytes long, into \c *Profile and add the counts of this
+ * process to it. Returns -1 if there is an error or the data is not
+ * compatible with this process, otherwise 0. */
+static int mmapProfileForMerging(FILE *File, uint64_t ProfileFileSize,
+                                 uint64_t CountersOffset, char **Profile) {
+  const uint64_t *CountersBegin = __llvm_profile_begin_counters();
+  const uint64_t *CountersEnd = __llvm_profile_end_counters();
+  uint64_t *FileCounters;
+  uint64_t I;
+
+  *Profile = mmap(NULL, ProfileFileSize, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_FILE, fileno(File), 0);
+  if (*Profile == MAP_FAILED) {
+    PROF_ERR("Unable to merge profile data, mmap failed: %s\n",
+             strerror(errno));
+    return -1;
+  }
+  if (__llvm_profile_check_compatibility(*Profile, ProfileFileSize)) {
+    PROF_WARN("Unable to merge profile data: %s\n",
+              "source profile file is not compatible.");
+    (void)munmap(*Profile, ProfileFileSize);
+    return -1;
+  }
+  FileCounters = (uint64_t *)(*Profile + CountersOffset);
+  for (I = 0; I < (uint64_t)(CountersEnd - CountersBegin); ++I)
+    FileCounters[I] += CountersBegin[I];
+  return 0;
+}
+
+/* Map the profile file and make the instrumented code update the counters in
+ * the mapping, so the profile doesn't need to be written at exit. If that
+ * fails, the profile is written at exit as usual. */
+static void initializeProfileForContinuousMode(void) {
+  const uint64_t *CountersBegin = __llvm_profile_begin_counters();
+  const uint64_t CountersOffset =
+      sizeof(__llvm_profile_header) +
+      __llvm_profile_get_data_size(__llvm_profile_begin_data(),
+                                   __llvm_profile_end_data()) *
+          sizeof(__llvm_profile_data);
+  const char *Filename;
+  char *FilenameBuf;
+  char *Profile = NULL;
+  FILE *File;
+  int Length, rc;
+
+  if (!lprofCurFilename.ContinuousMode || ContinuousModeEnabled)
+    return;
+  if (!&INSTR_PROF_PROFILE_COUNTER_BIAS_VAR) {
+    PROF_WARN("Continuous mode needs the code to be compiled with %s, the "
+              "profile will be written at exit.\n",
+              "-mllvm -runtime-counter-relocation");
+    return;
+  }
+
+  Length = getCurFilenameLength();
+  FilenameBuf = (char *)COMPILER_RT_ALLOCA(Length + 1);
+  Filename = getCurFilename(FilenameBuf, 0);
+  if (!Filename)
+    return;
+
+  createProfileDir(Filename);
+  if (doMerging()) {
+    uint64_t ProfileFileSize;
+    File = lprofOpenFileEx(Filename);
+    if (!File)
+      return;
+    if (fseek(File, 0L, SEEK_END) == -1) {
+      lprofUnlockFileHandle(File);
+      fclose(File);
+      return;
+    }
+    ProfileFileSize = ftell(File);
+    if (ProfileFileSize)
+      rc = mmapProfileForMerging(File, ProfileFileSize, CountersOffset,
+                                 &Profile);
+    else
+      rc = writeMMappedFile(File, __llvm_profile_get_size_for_buffer(),
+                            &Profile);
+    lprofUnlockFileHandle(File);
+  } else {
+    File = fopen(Filename, "w+b");
+    if (!File) {
+      PROF_ERR("Failed to open profile file \"%s\": %s\n", Filename,
+               strerror(errno));
+      return;
+    }
+    rc = writeMMappedFile(File, __llvm_profile_get_size_for_buffer(),
+                          &Profile);
+  }
+  /* The mapping stays valid after the file is closed. */
+  fclose(File);
+  if (rc)
+    return;
+
+  INSTR_PROF_PROFILE_COUNTER_BIAS_VAR =
+      (intptr_t)(Profile + CountersOffset) - (intptr_t)CountersBegin;
+  ContinuousModeEnabled = 1;
+}
+#else
+static void initializeProfileForContinuousMode(void) {
+  if (lprofCurFilename.ContinuousMode)
+    PROF_WARN("Continuous mode is not supported on this platform, %s.\n",
+              "the profile will be written at exit");
+}
+#endif
+
 /* This method is invoked by the runtime initialization hook
  * InstrProfilingRuntime.o if it is linked in. Both user specified
  * profile path via -fprofile-instr-generate= and LLVM_PROFILE_FILE
@@ -635,6 +787,7 @@ void __llvm_profile_initialize_file(void) {
     /* Pass CopyFilenamePat = 1, to ensure that the filename would be valid
        at the  moment when __llvm_profile_write_file() gets executed. */
     parseAndSetFilename(EnvFilenamePat, PNS_environment, 1);
+    initializeProfileForContinuousMode();
     return;
   } else if (hasCommandLineOverrider) {
     SelectedPat = INSTR_PROF_PROFILE_NAME_VAR;
@@ -645,6 +798,7 @@ void __llvm_profile_initialize_file(void) {
   }
 
   parseAndSetFilename(SelectedPat, PNS, 0);
+  initializeProfileForContinuousMode();
 }
 
 /* This API is directly called by the user application code. It has the
@@ -653,7 +807,14 @@ void __llvm_profile_initialize_file(void) {
  */
 COMPILER_RT_VISIBILITY
 void __llvm_profile_set_filename(const char *FilenamePat) {
+  /* The counters are already kept in the current file. */
+  if (__llvm_profile_is_continuous_mode_enabled()) {
+    PROF_WARN("Profile file name not changed to \"%s\": %s.\n", FilenamePat,
+              "continuous mode is on");
+    return;
+  }
   parseAndSetFilename(FilenamePat, PNS_runtime_api, 1);
+  initializeProfileForContinuousMode();
 }
 
 /* The public API for writing profile data into the file with name
@@ -667,6 +828,10 @@ int __llvm_profile_write_file(void) {
   char *FilenameBuf;
   int PDeathSig = 0;
 
+  /* The counters in the file are always up to date in continuous mode. */
+  if (__llvm_profile_is_continuous_mode_enabled())
+    return 0;
+
   if (lprofProfileDumped()) {
     PROF_NOTE("Profile data not written to file: %s.\n", "already written");
     return 0;
@@ -708,7 +873,7 @@ int __llvm_profile_write_file(void) {
 
 COMPILER_RT_VISIBILITY
 int __llvm_profile_dump(void) {
-  if (!doMerging())
+  if (!doMerging() && !__llvm_profile_is_continuous_mode_enabled())
     PROF_WARN("Later invocation of __llvm_profile_dump can lead to clobbering "
               " of previously dumped profile data : %s. Either use %%m "
               "in profile name or change profile name before dumping.\n",
@@ -16,6 +16,7 @@
 #include "primary64.h"
 #include "size_class_map.h"
 #include "tsd_exclusive.h"
+#include "tsd_percpu.h"
 #include "tsd_shared.h"
 
 namespace scudo {
@@ -34,6 +35,21 @@ struct DefaultConfig {
   template <class A> using TSDRegistryT = TSDRegistryExT<A>; // Exclusive
 };
 
+#if SCUDO_LINUX
+struct PerCPUConfig {
+  using SizeClassMap = DefaultSizeClassMap;
+#if SCUDO_CAN_USE_PRIMARY64
+  // 1GB Regions
+  typedef SizeClassAllocator64<SizeClassMap, 30U> Primary;
+#else
+  // 512KB regions
+  typedef SizeClassAllocator32<SizeClassMap, 19U> Primary;
+#endif
+  template <class A>
+  using TSDRegistryT = TSDRegistryPerCPUT<A, 256U>; // Per-CPU, max 256 TSDs.
+};
+#endif
+
 struct AndroidConfig {
   using SizeClassMap = AndroidSizeClassMap;
 #if SCUDO_CAN_USE_PRIMARY64
@@ -71,6 +87,8 @@ struct FuchsiaConfig {
 typedef AndroidConfig Config;
 #elif SCUDO_FUCHSIA
 typedef FuchsiaConfig Config;
+#elif SCUDO_LINUX && SCUDO_PER_CPU_CACHES
+typedef PerCPUConfig Config;
 #else
 typedef DefaultConfig Config;
 #endif
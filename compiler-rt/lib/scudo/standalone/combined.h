@@ -20,6 +20,8 @@
 #include "secondary.h"
 #include "tsd.h"
 
+#include <pthread.h>
+
 namespace scudo {
 
 template <class Params> class Allocator {
@@ -133,11 +135,20 @@ public:
     Quarantine.init(
         static_cast<uptr>(getFlags()->quarantine_size_kb << 10),
         static_cast<uptr>(getFlags()->thread_local_quarantine_size_kb << 10));
+
+    // The release thread is started by the first deallocation, as creating a
+    // thread can allocate memory, which isn't possible during initialization.
+    ReleaseIntervalMs = getFlags()->release_to_os_interval_ms;
+    if (getFlags()->release_to_os_in_background && ReleaseIntervalMs >= 0) {
+      Primary.setReleaseInBackground(true);
+      atomic_store_relaxed(&ReleaseThreadState, ReleaseThreadPending);
+    }
   }
 
   void reset() { memset(this, 0, sizeof(*this)); }
 
   void unmapTestOnly() {
+    stopReleaseThread();
     TSDRegistry.unmapTestOnly();
     Primary.unmapTestOnly();
   }
@@ -284,6 +295,10 @@ public:
     }
 
     quarantineOrDeallocateChunk(Ptr, &Header, Size);
+
+    if (UNLIKELY(atomic_load_relaxed(&ReleaseThreadState) ==
+                 ReleaseThreadPending))
+      startReleaseThread();
   }
 
   void *reallocate(void *OldPtr, uptr NewSize, uptr Alignment = MinAlignment) {
@@ -427,6 +442,7 @@ public:
   void getStats(StatCounters S) {
     initThreadMaybe();
     Stats.get(S);
+    Primary.getReleaseStats().get(S);
   }
 
 private:
@@ -452,6 +468,17 @@ private:
 
   u32 Cookie;
 
+  enum : u8 {
+    ReleaseThreadDisabled = 0,
+    ReleaseThreadPending = 1,
+    ReleaseThreadStarting = 2,
+    ReleaseThreadRunning = 3,
+    ReleaseThreadStopping = 4,
+  };
+  atomic_u8 ReleaseThreadState;
+  pthread_t ReleaseThread;
+  s32 ReleaseIntervalMs;
+
   struct {
     u8 MayReturnNull : 1;       // may_return_null
     u8 ZeroContents : 1;        // zero_contents
@@ -511,6 +538,51 @@ private:
            reinterpret_cast<uptr>(Ptr) - SizeOrUnusedBytes;
   }
 
+  NOINLINE void startReleaseThread() {
+    u8 State = ReleaseThreadPending;
+    if (!atomic_compare_exchange_strong(&ReleaseThreadState, &State,
+                                        ReleaseThreadStarting,
+                                        memory_order_acquire))
+      return;
+    if (pthread_create(&ReleaseThread, nullptr, releaseThreadLoop, this)) {
+      // Fall back to releasing memory on deallocation.
+      Primary.setReleaseInBackground(false);
+      atomic_store_relaxed(&ReleaseThreadState, ReleaseThreadDisabled);
+      return;
+    }
+    atomic_store(&ReleaseThreadState, ReleaseThreadRunning,
+                 memory_order_release);
+  }
+
+  void stopReleaseThread() {
+    u8 State = ReleaseThreadRunning;
+    if (atomic_compare_exchange_strong(&ReleaseThreadState, &State,
+                                       ReleaseThreadStopping,
+                                       memory_order_acquire))
+      pthread_join(ReleaseThread, nullptr);
+  }
+
+  static void *releaseThreadLoop(void *Arg) {
+    ThisT *Instance = reinterpret_cast<ThisT *>(Arg);
+    // Sleep in short steps so that stopping the thread doesn't take up to a
+    // whole interval.
+    const u32 StepMs = 100U;
+    const u32 IntervalMs =
+        Max(static_cast<u32>(Instance->ReleaseIntervalMs), 1U);
+    // The state is still Starting until pthread_create has returned.
+    while (atomic_load_relaxed(&Instance->ReleaseThreadState) !=
+           ReleaseThreadStopping) {
+      Instance->Primary.releaseToOSPeriodically();
+      for (u32 SleptMs = 0; SleptMs < IntervalMs; SleptMs += StepMs) {
+        if (atomic_load_relaxed(&Instance->ReleaseThreadState) ==
+            ReleaseThreadStopping)
+          break;
+        sleepMilliseconds(Min(StepMs, IntervalMs - SleptMs));
+      }
+    }
+    return nullptr;
+  }
+
   ALWAYS_INLINE void initThreadMaybe(bool MinimalInit = false) {
     TSDRegistry.initThreadMaybe(this, MinimalInit);
   }
@@ -168,6 +168,10 @@ void HybridMutex::unlock() __TA_NO_THREAD_SAFETY_ANALYSIS {
 
 u64 getMonotonicTime() { return _zx_clock_get_monotonic(); }
 
+void sleepMilliseconds(u32 Milliseconds) {
+  _zx_nanosleep(_zx_deadline_after(ZX_MSEC(Milliseconds)));
+}
+
 u32 getNumberOfCPUs() { return _zx_system_get_num_cpus(); }
 
 bool getRandom(void *Buffer, uptr Length, UNUSED bool Blocking) {
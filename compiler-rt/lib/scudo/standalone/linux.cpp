@@ -122,12 +122,27 @@ u64 getMonotonicTime() {
          static_cast<u64>(TS.tv_nsec);
 }
 
+void sleepMilliseconds(u32 Milliseconds) {
+  struct timespec TS;
+  TS.tv_sec = Milliseconds / 1000;
+  TS.tv_nsec = static_cast<long>(Milliseconds % 1000) * 1000000L;
+  while (nanosleep(&TS, &TS) == -1 && errno == EINTR) {
+  }
+}
+
 u32 getNumberOfCPUs() {
   cpu_set_t CPUs;
   CHECK_EQ(sched_getaffinity(0, sizeof(cpu_set_t), &CPUs), 0);
   return static_cast<u32>(CPU_COUNT(&CPUs));
 }
 
+u32 getCurrentCPU() {
+  // This is served by the vDSO, or by the rseq area with recent libcs, so it
+  // doesn't enter the kernel.
+  const int CPU = sched_getcpu();
+  return CPU < 0 ? 0U : static_cast<u32>(CPU);
+}
+
 // Blocking is possibly unused if the getrandom block is not compiled in.
 bool getRandom(void *Buffer, uptr Length, UNUSED bool Blocking) {
   if (!Buffer || !Length || Length > MaxRandomLength)
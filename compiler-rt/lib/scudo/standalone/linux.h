@@ -18,6 +18,10 @@ namespace scudo {
 // MapPlatformData is unused on Linux, define it as a minimally sized structure.
 struct MapPlatformData {};
 
+// Returns the CPU the calling thread is running on. The thread may have moved
+// to another CPU by the time the result is used.
+u32 getCurrentCPU();
+
 #if SCUDO_ANDROID
 
 #if defined(__aarch64__)
@@ -43,6 +43,12 @@
 #define SCUDO_CAN_USE_PRIMARY64 (SCUDO_WORDSIZE == 64U)
 #endif
 
+// Use per-CPU rather than per-thread caches on Linux. This bounds the memory
+// held in caches by the number of CPUs rather than the number of threads.
+#ifndef SCUDO_PER_CPU_CACHES
+#define SCUDO_PER_CPU_CACHES 0
+#endif
+
 #ifndef SCUDO_MIN_ALIGNMENT_LOG
 // We force malloc-type functions to be aligned to std::max_align_t, but there
 // is no reason why the minimum alignment for all other functions can't be 8
@@ -118,7 +118,7 @@ public:
     ScopedLock L(Sci->Mutex);
     Sci->FreeList.push_front(B);
     Sci->Stats.PushedBlocks += B->getCount();
-    if (Sci->CanRelease)
+    if (Sci->CanRelease && !atomic_load_relaxed(&ReleaseInBackground))
       releaseToOSMaybe(Sci, ClassId);
   }
 
@@ -173,6 +173,28 @@ public:
     return TotalReleasedBytes;
   }
 
+  // Stop releasing memory to the OS when blocks are freed, leaving it to
+  // periodic calls to releaseToOSPeriodically, e.g. from a background thread.
+  void setReleaseInBackground(bool Enabled) {
+    atomic_store_relaxed(&ReleaseInBackground, Enabled ? 1U : 0U);
+  }
+
+  // Release the memory of the size classes that have not been released for
+  // the release interval.
+  uptr releaseToOSPeriodically() {
+    uptr TotalReleasedBytes = 0;
+    for (uptr I = 0; I < NumClasses; I++) {
+      SizeClassInfo *Sci = getSizeClassInfo(I);
+      if (!Sci->CanRelease)
+        continue;
+      ScopedLock L(Sci->Mutex);
+      TotalReleasedBytes += releaseToOSMaybe(Sci, I);
+    }
+    return TotalReleasedBytes;
+  }
+
+  const ReleaseStats &getReleaseStats() const { return Releases; }
+
 private:
   static const uptr NumClasses = SizeClassMap::NumClasses;
   static const uptr RegionSize = 1UL << RegionSizeLog;
@@ -372,6 +394,7 @@ private:
     // TODO(kostyak): currently not ideal as we loop over all regions and
     // iterate multiple times over the same freelist if a ClassId spans multiple
     // regions. But it will have to do for now.
+    const u64 StartNs = getMonotonicTime();
     uptr TotalReleasedBytes = 0;
     for (uptr I = MinRegionIndex; I <= MaxRegionIndex; I++) {
       if (PossibleRegions[I] == ClassId) {
@@ -386,7 +409,9 @@ private:
         }
       }
     }
-    Sci->ReleaseInfo.LastReleaseAtNs = getMonotonicTime();
+    const u64 EndNs = getMonotonicTime();
+    Releases.record(TotalReleasedBytes, EndNs - StartNs);
+    Sci->ReleaseInfo.LastReleaseAtNs = EndNs;
     return TotalReleasedBytes;
   }
 
@@ -398,6 +423,8 @@ private:
   uptr MinRegionIndex;
   uptr MaxRegionIndex;
   s32 ReleaseToOsIntervalMs;
+  atomic_u8 ReleaseInBackground;
+  ReleaseStats Releases;
   // Unless several threads request regions simultaneously from different size
   // classes, the stash rarely contains more than 1 entry.
   static constexpr uptr MaxStashedRegions = 4;
@@ -120,7 +120,7 @@ public:
     ScopedLock L(Region->Mutex);
     Region->FreeList.push_front(B);
     Region->Stats.PushedBlocks += B->getCount();
-    if (Region->CanRelease)
+    if (Region->CanRelease && !atomic_load_relaxed(&ReleaseInBackground))
       releaseToOSMaybe(Region, ClassId);
   }
 
@@ -179,6 +179,28 @@ public:
     return TotalReleasedBytes;
   }
 
+  // Stop releasing memory to the OS when blocks are freed, leaving it to
+  // periodic calls to releaseToOSPeriodically, e.g. from a background thread.
+  void setReleaseInBackground(bool Enabled) {
+    atomic_store_relaxed(&ReleaseInBackground, Enabled ? 1U : 0U);
+  }
+
+  // Release the memory of the size classes that have not been released for
+  // the release interval.
+  uptr releaseToOSPeriodically() {
+    uptr TotalReleasedBytes = 0;
+    for (uptr I = 0; I < NumClasses; I++) {
+      RegionInfo *Region = getRegionInfo(I);
+      if (!Region->CanRelease)
+        continue;
+      ScopedLock L(Region->Mutex);
+      TotalReleasedBytes += releaseToOSMaybe(Region, I);
+    }
+    return TotalReleasedBytes;
+  }
+
+  const ReleaseStats &getReleaseStats() const { return Releases; }
+
 private:
   static const uptr RegionSize = 1UL << RegionSizeLog;
   static const uptr NumClasses = SizeClassMap::NumClasses;
@@ -218,6 +240,8 @@ private:
   RegionInfo *RegionInfoArray;
   MapPlatformData Data;
   s32 ReleaseToOsIntervalMs;
+  atomic_u8 ReleaseInBackground;
+  ReleaseStats Releases;
 
   RegionInfo *getRegionInfo(uptr ClassId) const {
     DCHECK_LT(ClassId, NumClasses);
@@ -368,6 +392,7 @@ private:
       }
     }
 
+    const u64 StartNs = getMonotonicTime();
     ReleaseRecorder Recorder(Region->RegionBeg, &Region->Data);
     releaseFreeMemoryToOS(&Region->FreeList, Region->RegionBeg,
                           roundUpTo(Region->AllocatedUser, PageSize) / PageSize,
@@ -379,7 +404,9 @@ private:
       Region->ReleaseInfo.RangesReleased += Recorder.getReleasedRangesCount();
       Region->ReleaseInfo.LastReleasedBytes = Recorder.getReleasedBytes();
     }
-    Region->ReleaseInfo.LastReleaseAtNs = getMonotonicTime();
+    const u64 EndNs = getMonotonicTime();
+    Releases.record(Recorder.getReleasedBytes(), EndNs - StartNs);
+    Region->ReleaseInfo.LastReleaseAtNs = EndNs;
     return Recorder.getReleasedBytes();
   }
 };
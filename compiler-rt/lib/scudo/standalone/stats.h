@@ -16,8 +16,17 @@
 
 namespace scudo {
 
-// Memory allocator statistics
-enum StatType { StatAllocated, StatFree, StatMapped, StatCount };
+// Memory allocator statistics. The release statistics are kept by the Primary
+// in a ReleaseStats, rather than in the local stats.
+enum StatType {
+  StatAllocated,
+  StatFree,
+  StatMapped,
+  StatReleased,       // Bytes released to the OS.
+  StatReleaseTimeUs,  // Total time spent releasing memory to the OS.
+  StatReleaseMaxUs,   // Longest time spent in a single release.
+  StatCount
+};
 
 typedef uptr StatCounters[StatCount];
 
@@ -100,6 +109,35 @@ private:
   mutable HybridMutex Mutex;
 };
 
+// Statistics about the memory released to the OS. Releases are rare and
+// expensive, and can happen concurrently for different size classes, so plain
+// atomic operations are used. The counters are zero initialized along with
+// the Primary.
+class ReleaseStats {
+public:
+  void record(uptr ReleasedBytes, u64 ElapsedNs) {
+    const uptr ElapsedUs = static_cast<uptr>(ElapsedNs / 1000);
+    atomic_fetch_add(&Released, ReleasedBytes, memory_order_relaxed);
+    atomic_fetch_add(&TimeUs, ElapsedUs, memory_order_relaxed);
+    uptr Max = atomic_load_relaxed(&MaxUs);
+    while (ElapsedUs > Max &&
+           !atomic_compare_exchange_weak(&MaxUs, &Max, ElapsedUs,
+                                         memory_order_relaxed)) {
+    }
+  }
+
+  void get(uptr *S) const {
+    S[StatReleased] = atomic_load_relaxed(&Released);
+    S[StatReleaseTimeUs] = atomic_load_relaxed(&TimeUs);
+    S[StatReleaseMaxUs] = atomic_load_relaxed(&MaxUs);
+  }
+
+private:
+  atomic_uptr Released;
+  atomic_uptr TimeUs;
+  atomic_uptr MaxUs;
+};
+
 } // namespace scudo
 
 #endif // SCUDO_STATS_H_
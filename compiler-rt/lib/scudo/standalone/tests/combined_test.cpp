@@ -25,7 +25,10 @@ static constexpr scudo::Chunk::Origin Origin = scudo::Chunk::Origin::Malloc;
 // parameters are on the low end, to avoid having to loop excessively in some
 // tests.
 static bool UseQuarantine = false;
+static bool ReleaseInBackground = false;
 extern "C" const char *__scudo_default_options() {
+  if (ReleaseInBackground)
+    return "release_to_os_in_background=true:release_to_os_interval_ms=0";
   if (!UseQuarantine)
     return "";
   return "quarantine_size_kb=256:thread_local_quarantine_size_kb=128:"
@@ -205,6 +208,39 @@ TEST(ScudoCombinedTest, ThreadedCombined) {
   testAllocatorThreaded<scudo::AndroidSvelteConfig>();
 }
 
+TEST(ScudoCombinedTest, ReleaseInBackground) {
+  using AllocatorT = scudo::Allocator<scudo::DefaultConfig>;
+  auto Deleter = [](AllocatorT *A) {
+    A->unmapTestOnly();
+    delete A;
+  };
+  ReleaseInBackground = true;
+  std::unique_ptr<AllocatorT, decltype(Deleter)> Allocator(new AllocatorT,
+                                                           Deleter);
+  Allocator->reset();
+
+  // Free enough blocks for some to make it back to the Primary, then wait for
+  // the release thread, started by the first deallocation, to release them.
+  // This is done from a new thread, as the TSD of this one might already be
+  // tied to an allocator from a previous test.
+  std::thread T([&Allocator]() {
+    std::vector<void *> V;
+    for (scudo::uptr I = 0; I < 256U; I++)
+      V.push_back(Allocator->allocate(scudo::getPageSizeCached() * 2, Origin));
+    for (void *P : V)
+      Allocator->deallocate(P, Origin);
+  });
+  T.join();
+
+  scudo::uptr Stats[scudo::StatCount] = {};
+  for (scudo::uptr I = 0; I < 1000U && !Stats[scudo::StatReleased]; I++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    Allocator->getStats(Stats);
+  }
+  EXPECT_GT(Stats[scudo::StatReleased], 0U);
+  ReleaseInBackground = false;
+}
+
 struct DeathConfig {
   // Tiny allocator, its Primary only serves chunks of 1024 bytes.
   using DeathSizeClassMap = scudo::SizeClassMap<1U, 10U, 10U, 10U, 1U, 10U>;
@@ -217,3 +217,37 @@ TEST(ScudoPrimaryTest, ReleaseToOS) {
   testReleaseToOS<scudo::SizeClassAllocator32<SizeClassMap, 18U>>();
   testReleaseToOS<scudo::SizeClassAllocator64<SizeClassMap, 24U>>();
 }
+
+// With releases left to the background, freeing blocks must not release
+// memory, and the next periodic release must, updating the release stats.
+template <typename Primary> static void testReleaseInBackground() {
+  auto Deleter = [](Primary *P) {
+    P->unmapTestOnly();
+    delete P;
+  };
+  std::unique_ptr<Primary, decltype(Deleter)> Allocator(new Primary, Deleter);
+  Allocator->init(/*ReleaseToOsInterval=*/0);
+  Allocator->setReleaseInBackground(true);
+  typename Primary::CacheT Cache;
+  Cache.init(nullptr, Allocator.get());
+  const scudo::uptr Size = scudo::getPageSizeCached() * 2;
+  const scudo::uptr ClassId = Primary::SizeClassMap::getClassIdBySize(Size);
+  void *P = Cache.allocate(ClassId);
+  EXPECT_NE(P, nullptr);
+  Cache.deallocate(ClassId, P);
+  Cache.destroy(nullptr);
+  scudo::uptr Stats[scudo::StatCount] = {};
+  Allocator->getReleaseStats().get(Stats);
+  EXPECT_EQ(Stats[scudo::StatReleased], 0U);
+  const scudo::uptr Released = Allocator->releaseToOSPeriodically();
+  EXPECT_GT(Released, 0U);
+  Allocator->getReleaseStats().get(Stats);
+  EXPECT_EQ(Stats[scudo::StatReleased], Released);
+  EXPECT_GE(Stats[scudo::StatReleaseTimeUs], Stats[scudo::StatReleaseMaxUs]);
+}
+
+TEST(ScudoPrimaryTest, ReleaseInBackground) {
+  using SizeClassMap = scudo::DefaultSizeClassMap;
+  testReleaseInBackground<scudo::SizeClassAllocator32<SizeClassMap, 18U>>();
+  testReleaseInBackground<scudo::SizeClassAllocator64<SizeClassMap, 24U>>();
+}
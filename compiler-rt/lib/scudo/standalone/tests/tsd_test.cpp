@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "tsd_exclusive.h"
+#include "tsd_percpu.h"
 #include "tsd_shared.h"
 
 #include "gtest/gtest.h"
@@ -59,6 +60,13 @@ struct ExclusiveCaches {
   using TSDRegistryT = scudo::TSDRegistryExT<Allocator>;
 };
 
+#if SCUDO_LINUX
+struct PerCPUCaches {
+  template <class Allocator>
+  using TSDRegistryT = scudo::TSDRegistryPerCPUT<Allocator, 16U>;
+};
+#endif
+
 TEST(ScudoTSDTest, TSDRegistryInit) {
   using AllocatorT = MockAllocator<OneCache>;
   auto Deleter = [](AllocatorT *A) {
@@ -109,6 +117,9 @@ TEST(ScudoTSDTest, TSDRegistryBasic) {
   testRegistry<MockAllocator<OneCache>>();
   testRegistry<MockAllocator<SharedCaches>>();
   testRegistry<MockAllocator<ExclusiveCaches>>();
+#if SCUDO_LINUX
+  testRegistry<MockAllocator<PerCPUCaches>>();
+#endif
 }
 
 static std::mutex Mutex;
@@ -165,4 +176,7 @@ TEST(ScudoTSDTest, TSDRegistryThreaded) {
   testRegistryThreaded<MockAllocator<OneCache>>();
   testRegistryThreaded<MockAllocator<SharedCaches>>();
   testRegistryThreaded<MockAllocator<ExclusiveCaches>>();
+#if SCUDO_LINUX
+  testRegistryThreaded<MockAllocator<PerCPUCaches>>();
+#endif
 }
@@ -0,0 +1,97 @@
+//===-- tsd_percpu.h --------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SCUDO_TSD_PERCPU_H_
+#define SCUDO_TSD_PERCPU_H_
+
+#include "linux.h" // for getCurrentCPU()
+#include "tsd.h"
+
+#if SCUDO_LINUX
+
+namespace scudo {
+
+// A registry with one TSD per CPU, chosen by the CPU the thread is running on
+// at the time of the call. Unlike the exclusive registry, the memory held in
+// caches doesn't grow with the number of threads. Unlike the shared registry,
+// threads don't stick to a TSD, so two threads only contend for one if they
+// run on the same CPU, which mostly happens when one of them was preempted or
+// migrated while holding it.
+template <class Allocator, u32 MaxTSDCount> struct TSDRegistryPerCPUT {
+  void initLinkerInitialized(Allocator *Instance) {
+    Instance->initLinkerInitialized();
+    NumberOfTSDs = Min(Max(1U, getNumberOfCPUs()), MaxTSDCount);
+    TSDs = reinterpret_cast<TSD<Allocator> *>(
+        map(nullptr, sizeof(TSD<Allocator>) * NumberOfTSDs, "scudo:tsd"));
+    for (u32 I = 0; I < NumberOfTSDs; I++)
+      TSDs[I].initLinkerInitialized(Instance);
+    atomic_store(&Initialized, 1U, memory_order_release);
+  }
+  void init(Allocator *Instance) {
+    memset(this, 0, sizeof(*this));
+    initLinkerInitialized(Instance);
+  }
+
+  void unmapTestOnly() {
+    unmap(reinterpret_cast<void *>(TSDs),
+          sizeof(TSD<Allocator>) * NumberOfTSDs);
+  }
+
+  ALWAYS_INLINE void initThreadMaybe(Allocator *Instance,
+                                     UNUSED bool MinimalInit) {
+    // There is no per-thread state, only the registry to set up.
+    if (LIKELY(atomic_load(&Initialized, memory_order_acquire)))
+      return;
+    initOnceMaybe(Instance);
+  }
+
+  ALWAYS_INLINE TSD<Allocator> *getTSDAndLock(bool *UnlockRequired) {
+    *UnlockRequired = true;
+    TSD<Allocator> *CurrentTSD = getCurrentTSD();
+    if (CurrentTSD->tryLock())
+      return CurrentTSD;
+    return getTSDAndLockSlow(CurrentTSD);
+  }
+
+private:
+  ALWAYS_INLINE TSD<Allocator> *getCurrentTSD() {
+    // CPU numbers can be sparse, or exceed MaxTSDCount. Those CPUs share a
+    // TSD with another one.
+    return &TSDs[getCurrentCPU() % NumberOfTSDs];
+  }
+
+  void initOnceMaybe(Allocator *Instance) {
+    ScopedLock L(Mutex);
+    if (LIKELY(atomic_load_relaxed(&Initialized)))
+      return;
+    initLinkerInitialized(Instance); // Sets Initialized.
+  }
+
+  NOINLINE TSD<Allocator> *getTSDAndLockSlow(TSD<Allocator> *CurrentTSD) {
+    // The thread may have moved to another CPU since the TSD was picked. If
+    // so, try the TSD of the new CPU.
+    TSD<Allocator> *NewTSD = getCurrentTSD();
+    if (NewTSD != CurrentTSD && NewTSD->tryLock())
+      return NewTSD;
+    // Otherwise wait for the TSD of this CPU rather than taking another CPU's,
+    // whose owner is likely to be running and to want it back soon.
+    NewTSD->lock();
+    return NewTSD;
+  }
+
+  u32 NumberOfTSDs;
+  TSD<Allocator> *TSDs;
+  atomic_u8 Initialized;
+  HybridMutex Mutex;
+};
+
+} // namespace scudo
+
+#endif // SCUDO_LINUX
+
+#endif // SCUDO_TSD_PERCPU_H_
@@ -66,8 +66,8 @@
 //   reused counter);
 //   if acquried == thr->reused_, then the respective thread has already
 //   acquired this clock (except possibly for dirty elements).
-// dirty_ - holds up to two indeces in the vector clock that other threads
-//   need to acquire regardless of "acquired" flag value;
+// dirty_ - holds up to kDirtyTids indeces in the vector clock that other
+//   threads need to acquire regardless of "acquired" flag value;
 // release_store_tid_ - denotes that the clock state is a result of
 //   release-store operation by the thread with release_store_tid_ index.
 // release_store_reused_ - reuse count of release_store_tid_.
@@ -213,17 +213,16 @@ void ThreadClock::release(ClockCache *c, SyncClock *dst) {
     CPP_STAT_INC(StatClockReleaseAcquired);
   // Update dst->clk_.
   dst->FlushDirty();
+  // This also clears the 'acquired' flag in the elements past nclk_, where
+  // clk_ is zero.
+  if (nclk_ < dst->size_)
+    CPP_STAT_INC(StatClockReleaseClearTail);
   uptr i = 0;
   for (ClockElem &ce : *dst) {
     ce.epoch = max(ce.epoch, clk_[i]);
     ce.reused = 0;
     i++;
   }
-  // Clear 'acquired' flag in the remaining elements.
-  if (nclk_ < dst->size_)
-    CPP_STAT_INC(StatClockReleaseClearTail);
-  for (uptr i = nclk_; i < dst->size_; i++)
-    dst->elem(i).reused = 0;
   dst->release_store_tid_ = kInvalidTid;
   dst->release_store_reused_ = 0;
   // If we've acquired dst, remember this fact,
@@ -566,10 +565,10 @@ void SyncClock::DebugDump(int(*printf)(const char *s, ...)) {
   printf("] reused=[");
   for (uptr i = 0; i < size_; i++)
     printf("%s%llu", i == 0 ? "" : ",", elem(i).reused);
-  printf("] release_store_tid=%d/%d dirty_tids=%d[%llu]/%d[%llu]",
-      release_store_tid_, release_store_reused_,
-      dirty_[0].tid, dirty_[0].epoch,
-      dirty_[1].tid, dirty_[1].epoch);
+  printf("] release_store_tid=%d/%d dirty_tids=",
+      release_store_tid_, release_store_reused_);
+  for (uptr i = 0; i < kDirtyTids; i++)
+    printf("%s%d[%llu]", i == 0 ? "" : "/", dirty_[i].tid, dirty_[i].epoch);
 }
 
 void SyncClock::Iter::Next() {
@@ -62,7 +62,10 @@ class SyncClock {
  private:
   friend class ThreadClock;
   friend class Iter;
-  static const uptr kDirtyTids = 2;
+  // Each dirty entry lets one more thread release to the clock without O(N)
+  // work, and lets acquirers that have acquired the rest skip the O(N) scan.
+  // This matters for clocks shared by many threads.
+  static const uptr kDirtyTids = 4;
 
   struct Dirty {
     u64 epoch  : kClkBits;
@@ -91,6 +91,12 @@ class DenseSlabAlloc {
     internal_memset(c->cache, 0, sizeof(c->cache));
   }
 
+  // Returns the number of bytes mapped for objects, free or not.
+  uptr AllocatedMemory() {
+    SpinMutexLock lock(&mtx_);
+    return fillpos_ * kL2Size * sizeof(T);
+  }
+
  private:
   T *map_[kL1Size];
   SpinMutex mtx_;
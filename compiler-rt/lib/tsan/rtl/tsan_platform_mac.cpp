@@ -165,6 +165,7 @@ void WriteMemoryProfile(char *buf, uptr buf_size, uptr nthread, uptr nlive) {
 #else  // !SANITIZER_GO
     "app      (0x%016zx-0x%016zx): resident %zd kB, dirty %zd kB\n"
 #endif
+    "clocks: %zd kB allocated\n"
     "stacks: %zd unique IDs, %zd kB allocated\n"
     "threads: %zd total, %zd live\n"
     "------------------------------\n",
@@ -178,6 +179,7 @@ void WriteMemoryProfile(char *buf, uptr buf_size, uptr nthread, uptr nlive) {
 #else  // !SANITIZER_GO
     AppMemBeg(), AppMemEnd(), app_res / 1024, app_dirty / 1024,
 #endif
+    ctx->clock_alloc.AllocatedMemory() / 1024,
     stacks->n_uniq_ids, stacks->allocated / 1024,
     nthread, nlive);
 }
@@ -134,6 +134,29 @@ TEST(Clock, ManyThreads) {
   chunked.Reset(&cache);
 }
 
+// Several threads releasing to a clock that a reader has already acquired.
+// Up to 4 of them are kept in the dirty entries, more are flushed to the
+// table, and the reader must see all of them either way.
+TEST(Clock, ManyReleasers) {
+  for (unsigned nrel = 1; nrel <= 6; nrel++) {
+    SyncClock sync;
+    ThreadClock reader(0);
+    reader.tick();
+    reader.release(&cache, &sync);
+    reader.acquire(&cache, &sync);
+    for (unsigned i = 1; i <= nrel; i++) {
+      ThreadClock writer(i);
+      writer.acquire(&cache, &sync);
+      writer.set(&cache, i, i + 10);
+      writer.release(&cache, &sync);
+    }
+    reader.acquire(&cache, &sync);
+    for (unsigned i = 1; i <= nrel; i++)
+      ASSERT_EQ(i + 10, reader.get(i));
+    sync.Reset(&cache);
+  }
+}
+
 TEST(Clock, DifferentSizes) {
   {
     ThreadClock vector1(10);
@@ -120,6 +120,24 @@ TEST(BufferQueueTest, Apply) {
   ASSERT_EQ(Count, 10);
 }
 
+TEST(BufferQueueTest, GetAllBuffersFromOneThread) {
+  // The buffers are split between shards, but a single thread can still get
+  // all of them.
+  bool Success = false;
+  BufferQueue Buffers(kSize, 10, Success);
+  ASSERT_TRUE(Success);
+  BufferQueue::Buffer B[10];
+  for (auto &Buf : B)
+    ASSERT_EQ(Buffers.getBuffer(Buf), BufferQueue::ErrorCode::Ok);
+  BufferQueue::Buffer Extra;
+  EXPECT_EQ(Buffers.getBuffer(Extra), BufferQueue::ErrorCode::NotEnoughMemory);
+  for (auto &Buf : B)
+    ASSERT_EQ(Buffers.releaseBuffer(Buf), BufferQueue::ErrorCode::Ok);
+  auto Count = 0;
+  Buffers.apply([&](const BufferQueue::Buffer &) { ++Count; });
+  ASSERT_EQ(Count, 10);
+}
+
 TEST(BufferQueueTest, GenerationalSupport) {
   bool Success = false;
   BufferQueue Buffers(kSize, 10, Success);
@@ -67,8 +67,21 @@ constexpr size_t kExtentsSize = sizeof(ExtentsPadded);
 
 } // namespace
 
+void BufferQueue::lockAllShards() {
+  for (size_t I = 0; I < ShardCount; ++I)
+    Shards[I].Mutex.Lock();
+}
+
+void BufferQueue::unlockAllShards() {
+  for (size_t I = ShardCount; I > 0; --I)
+    Shards[I - 1].Mutex.Unlock();
+}
+
 BufferQueue::ErrorCode BufferQueue::init(size_t BS, size_t BC) {
-  SpinMutexLock Guard(&Mutex);
+  if (Shards == nullptr)
+    return BufferQueue::ErrorCode::NotEnoughMemory;
+  lockAllShards();
+  auto UnlockShards = at_scope_exit([this] { unlockAllShards(); });
 
   if (!finalizing())
     return BufferQueue::ErrorCode::AlreadyInitialized;
@@ -134,9 +147,21 @@ BufferQueue::ErrorCode BufferQueue::init(size_t BS, size_t BC) {
     T.Used = false;
   }
 
-  Next = Buffers;
-  First = Buffers;
-  LiveBuffers = 0;
+  // Split the buffers between as many shards as we can, each shard taking a
+  // contiguous range. The remaining shards have no buffers.
+  const size_t Active = BufferCount < ShardCount ? BufferCount : ShardCount;
+  for (size_t I = 0; I < ShardCount; ++I) {
+    auto &S = Shards[I];
+    const size_t Begin = I < Active ? I * BufferCount / Active : BufferCount;
+    const size_t End =
+        I < Active ? (I + 1) * BufferCount / Active : BufferCount;
+    S.Buffers = Buffers + Begin;
+    S.Count = End - Begin;
+    S.Next = S.Buffers;
+    S.First = S.Buffers;
+    S.LiveBuffers = 0;
+  }
+  atomic_store(&ActiveShards, Active, memory_order_relaxed);
   atomic_store(&Finalizing, 0, memory_order_release);
   Success = true;
   return BufferQueue::ErrorCode::Ok;
@@ -146,15 +171,17 @@ BufferQueue::BufferQueue(size_t B, size_t N,
                          bool &Success) XRAY_NEVER_INSTRUMENT
     : BufferSize(B),
       BufferCount(N),
-      Mutex(),
+      Shards(nullptr),
+      ShardCount(GetNumberOfCPUsCached()),
+      ActiveShards{0},
       Finalizing{1},
       BackingStore(nullptr),
       ExtentsBackingStore(nullptr),
       Buffers(nullptr),
-      Next(Buffers),
-      First(Buffers),
-      LiveBuffers(0),
       Generation{0} {
+  if (ShardCount == 0)
+    ShardCount = 1;
+  Shards = initArray<Shard>(ShardCount);
   Success = init(B, N) == BufferQueue::ErrorCode::Ok;
 }
 
@@ -162,48 +189,74 @@ BufferQueue::ErrorCode BufferQueue::getBuffer(Buffer &Buf) {
   if (atomic_load(&Finalizing, memory_order_acquire))
     return ErrorCode::QueueFinalizing;
 
-  BufferRep *B = nullptr;
-  {
-    SpinMutexLock Guard(&Mutex);
-    if (LiveBuffers == BufferCount)
-      return ErrorCode::NotEnoughMemory;
-    B = Next++;
-    if (Next == (Buffers + BufferCount))
-      Next = Buffers;
-    ++LiveBuffers;
+  // Pick the shard owning the slot this Buffer has rotated to, starting from
+  // a shard picked by the thread ID, and fall back to the other shards if
+  // that one has no buffers left.
+  const size_t Active = atomic_load(&ActiveShards, memory_order_relaxed);
+  const size_t Count = BufferCount;
+  const size_t Rotation = Buf.Rotation;
+  size_t Start = 0;
+  if (Active != 0 && Count != 0) {
+    const size_t Home = static_cast<size_t>(GetTid()) % Active;
+    const size_t Slot = (Home * Count / Active + Rotation) % Count;
+    Start = ((Slot + 1) * Active - 1) / Count;
   }
-
-  incRefCount(BackingStore);
-  incRefCount(ExtentsBackingStore);
-  Buf = B->Buff;
-  Buf.Generation = generation();
-  B->Used = true;
-  return ErrorCode::Ok;
+  for (size_t I = 0; I < ShardCount; ++I) {
+    const size_t Index = (Start + I) % ShardCount;
+    auto &S = Shards[Index];
+    SpinMutexLock Guard(&S.Mutex);
+    if (S.LiveBuffers == S.Count)
+      continue;
+    BufferRep *B = S.Next++;
+    if (S.Next == (S.Buffers + S.Count))
+      S.Next = S.Buffers;
+    ++S.LiveBuffers;
+
+    incRefCount(BackingStore);
+    incRefCount(ExtentsBackingStore);
+    Buf = B->Buff;
+    Buf.Generation = generation();
+    Buf.Shard = Index;
+    Buf.Rotation = Rotation + 1;
+    B->Used = true;
+    return ErrorCode::Ok;
+  }
+  return ErrorCode::NotEnoughMemory;
 }
 
 BufferQueue::ErrorCode BufferQueue::releaseBuffer(Buffer &Buf) {
-  // Check whether the buffer being referred to is within the bounds of the
-  // backing store's range.
-  BufferRep *B = nullptr;
-  {
-    SpinMutexLock Guard(&Mutex);
-    if (Buf.Generation != generation() || LiveBuffers == 0) {
-      Buf = {};
-      decRefCount(Buf.BackingStore, Buf.Size, Buf.Count);
-      decRefCount(Buf.ExtentsBackingStore, kExtentsSize, Buf.Count);
-      return BufferQueue::ErrorCode::Ok;
-    }
-
-    if (Buf.Data < &BackingStore->Data ||
-        Buf.Data > &BackingStore->Data + (BufferCount * BufferSize))
-      return BufferQueue::ErrorCode::UnrecognizedBuffer;
-
-    --LiveBuffers;
-    B = First++;
-    if (First == (Buffers + BufferCount))
-      First = Buffers;
+  if (Buf.Shard >= ShardCount)
+    return BufferQueue::ErrorCode::UnrecognizedBuffer;
+
+  // The buffer goes back to the shard it was taken from, which owns the range
+  // of the backing store it points into.
+  auto &S = Shards[Buf.Shard];
+  SpinMutexLock Guard(&S.Mutex);
+  if (Buf.Generation != generation() || S.LiveBuffers == 0) {
+    auto *BackingStore = Buf.BackingStore;
+    auto *ExtentsBackingStore = Buf.ExtentsBackingStore;
+    auto Size = Buf.Size;
+    auto Count = Buf.Count;
+    auto Rotation = Buf.Rotation;
+    Buf = {};
+    Buf.Rotation = Rotation;
+    decRefCount(BackingStore, Size, Count);
+    decRefCount(ExtentsBackingStore, kExtentsSize, Count);
+    return BufferQueue::ErrorCode::Ok;
   }
 
+  // Check whether the buffer being referred to is within the bounds of the
+  // shard's range of the backing store.
+  auto *ShardData =
+      &BackingStore->Data + (BufferSize * (S.Buffers - Buffers));
+  if (Buf.Data < ShardData || Buf.Data >= ShardData + (S.Count * BufferSize))
+    return BufferQueue::ErrorCode::UnrecognizedBuffer;
+
+  --S.LiveBuffers;
+  BufferRep *B = S.First++;
+  if (S.First == (S.Buffers + S.Count))
+    S.First = S.Buffers;
+
   // Now that the buffer has been released, we mark it as "used".
   B->Buff = Buf;
   B->Used = true;
@@ -211,7 +264,9 @@ BufferQueue::ErrorCode BufferQueue::releaseBuffer(Buffer &Buf) {
   decRefCount(Buf.ExtentsBackingStore, kExtentsSize, Buf.Count);
   atomic_store(B->Buff.Extents, atomic_load(Buf.Extents, memory_order_acquire),
                memory_order_release);
+  auto Rotation = Buf.Rotation;
   Buf = {};
+  Buf.Rotation = Rotation;
   return ErrorCode::Ok;
 }
 
@@ -234,4 +289,11 @@ void BufferQueue::cleanupBuffers() {
   BufferSize = 0;
 }
 
-BufferQueue::~BufferQueue() { cleanupBuffers(); }
+BufferQueue::~BufferQueue() {
+  cleanupBuffers();
+  if (Shards != nullptr) {
+    for (auto S = Shards, E = Shards + ShardCount; S != E; ++S)
+      S->~Shard();
+    deallocateBuffer(Shards, ShardCount);
+  }
+}
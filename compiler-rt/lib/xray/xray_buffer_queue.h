@@ -28,6 +28,13 @@ namespace __xray {
 /// get from or return buffers to the queue. This is one key component of the
 /// "flight data recorder" (FDR) mode to support ongoing XRay function call
 /// trace collection.
+///
+/// The buffers are split between shards, one per CPU, each with its own lock
+/// and circular queue, so that threads rotating buffers at the same time
+/// don't all contend on a single lock. Threads start from different shards,
+/// and each Buffer then walks through the shards in proportion to their sizes
+/// so that a single thread still cycles through all the buffers of the queue.
+/// A buffer is always returned to the shard it came from.
 class BufferQueue {
 public:
   /// ControlBlock represents the memory layout of how we interpret the backing
@@ -62,6 +69,8 @@ public:
     ControlBlock *BackingStore = nullptr;
     ControlBlock *ExtentsBackingStore = nullptr;
     size_t Count = 0;
+    size_t Shard = 0;
+    size_t Rotation = 0;
   };
 
   struct BufferRep {
@@ -131,13 +140,40 @@ private:
     }
   };
 
+  // A circular queue over a contiguous range of the buffers, guarded by its
+  // own lock. Each shard is on its own cache line.
+  struct alignas(kCacheLineSize) Shard {
+    SpinMutex Mutex;
+
+    // The range of buffers managed by this shard.
+    BufferRep *Buffers = nullptr;
+    size_t Count = 0;
+
+    // Pointer to the next buffer to be handed out.
+    BufferRep *Next = nullptr;
+
+    // Pointer to the entry in the range where the next released buffer will
+    // be placed.
+    BufferRep *First = nullptr;
+
+    // Count of buffers that have been handed out through 'getBuffer'.
+    size_t LiveBuffers = 0;
+  };
+
   // Size of each individual Buffer.
   size_t BufferSize;
 
   // Amount of pre-allocated buffers.
   size_t BufferCount;
 
-  SpinMutex Mutex;
+  // The shards, allocated once for the lifetime of the queue so that buffers
+  // from previous generations can still be released to them.
+  Shard *Shards;
+  size_t ShardCount;
+
+  // The number of shards which have buffers in the current generation.
+  atomic_uint64_t ActiveShards;
+
   atomic_uint8_t Finalizing;
 
   // The collocated ControlBlock and buffer storage.
@@ -149,16 +185,6 @@ private:
   // A dynamically allocated array of BufferRep instances.
   BufferRep *Buffers;
 
-  // Pointer to the next buffer to be handed out.
-  BufferRep *Next;
-
-  // Pointer to the entry in the array where the next released buffer will be
-  // placed.
-  BufferRep *First;
-
-  // Count of buffers that have been handed out through 'getBuffer'.
-  size_t LiveBuffers;
-
   // We use a generation number to identify buffers and which generation they're
   // associated with.
   atomic_uint64_t Generation;
@@ -166,6 +192,11 @@ private:
   /// Releases references to the buffers backed by the current buffer queue.
   void cleanupBuffers();
 
+  /// Locks and unlocks all the shards, for the operations which work on the
+  /// whole queue.
+  void lockAllShards();
+  void unlockAllShards();
+
 public:
   enum class ErrorCode : unsigned {
     Ok,
@@ -253,9 +284,10 @@ public:
   /// Buffer is marked 'used' (i.e. has been the result of getBuffer(...) and a
   /// releaseBuffer(...) operation).
   template <class F> void apply(F Fn) XRAY_NEVER_INSTRUMENT {
-    SpinMutexLock G(&Mutex);
+    lockAllShards();
     for (auto I = begin(), E = end(); I != E; ++I)
       Fn(*I);
+    unlockAllShards();
   }
 
   using const_iterator = Iterator<const Buffer>;
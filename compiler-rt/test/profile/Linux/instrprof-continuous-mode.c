@@ -0,0 +1,42 @@
+// RUN: %clang_profgen -O2 -mllvm -runtime-counter-relocation -o %t %s
+
+// The counters are in the file even though the profile is never written.
+// RUN: rm -f %t.profraw
+// RUN: env LLVM_PROFILE_FILE="%c%t.profraw" %run %t
+// RUN: llvm-profdata show --counts --all-functions %t.profraw | FileCheck %s
+
+// Later runs add their counts to the ones in the file with %m.
+// RUN: rm -fr %t.dir && mkdir -p %t.dir
+// RUN: env LLVM_PROFILE_FILE="%t.dir/%c%m.profraw" %run %t
+// RUN: env LLVM_PROFILE_FILE="%t.dir/%c%m.profraw" %run %t
+// RUN: llvm-profdata merge -o %t.profdata %t.dir
+// RUN: llvm-profdata show --counts --function=bar %t.profdata | FileCheck %s --check-prefix=MERGE
+
+#include <unistd.h>
+
+int g;
+__attribute__((noinline)) void bar(int i) { g += i; }
+
+__attribute__((noinline)) void foo(int n) {
+  int i;
+  for (i = 0; i < n; ++i)
+    bar(i);
+}
+
+int main() {
+  foo(10);
+  // Exit without running the atexit handler that writes the profile.
+  _exit(0);
+}
+
+// CHECK-LABEL: Counters:
+// CHECK:   bar:
+// CHECK:     Function count: 10
+// CHECK:   foo:
+// CHECK:     Function count: 1
+// CHECK:   main:
+// CHECK:     Function count: 1
+
+// MERGE-LABEL: Counters:
+// MERGE:   bar:
+// MERGE:     Function count: 20
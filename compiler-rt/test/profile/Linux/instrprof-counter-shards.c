@@ -0,0 +1,29 @@
+// RUN: %clang_profgen -O2 -mllvm -instrprof-counter-shard-period=16 -o %t %s -pthread
+// RUN: env LLVM_PROFILE_FILE=%t.profraw %run %t
+// RUN: llvm-profdata show --counts --function=bar %t.profraw | FileCheck %s
+
+// Each thread adds its counts to the profile 16 at a time, so a count that is
+// a multiple of 16 in every thread is exact.
+// CHECK: Function count: 256
+
+#include <pthread.h>
+
+int g;
+__attribute__((noinline)) void bar(int i) { __atomic_fetch_add(&g, i, 0); }
+
+static void *run(void *arg) {
+  int i;
+  for (i = 0; i < 64; ++i)
+    bar(i);
+  return 0;
+}
+
+int main() {
+  pthread_t threads[4];
+  int i;
+  for (i = 0; i < 4; ++i)
+    pthread_create(&threads[i], 0, run, 0);
+  for (i = 0; i < 4; ++i)
+    pthread_join(threads[i], 0);
+  return 0;
+}
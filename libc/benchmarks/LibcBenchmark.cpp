@@ -0,0 +1,59 @@
+//===-------- Measurement and reporting for the libc benchmarks ----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "LibcBenchmark.h"
+#include "llvm/Support/Host.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace llvm {
+namespace libc_benchmarks {
+
+// The smallest sample such that at least `Fraction` of the samples are less
+// than or equal to it.
+static double percentile(const std::vector<double> &Sorted, double Fraction) {
+  size_t Rank = static_cast<size_t>(std::ceil(Fraction * Sorted.size()));
+  return Sorted[std::max<size_t>(Rank, 1) - 1];
+}
+
+Statistics computeStatistics(std::vector<double> Samples) {
+  Statistics S;
+  if (Samples.empty())
+    return S;
+  std::sort(Samples.begin(), Samples.end());
+  double Sum = 0;
+  for (double Sample : Samples)
+    Sum += Sample;
+  S.Count = Samples.size();
+  S.Mean = Sum / Samples.size();
+  S.Min = Samples.front();
+  S.P50 = percentile(Samples, 0.50);
+  S.P90 = percentile(Samples, 0.90);
+  S.P99 = percentile(Samples, 0.99);
+  S.Max = Samples.back();
+  return S;
+}
+
+json::Value toJSON(const Statistics &S) {
+  return json::Object{{"samples", static_cast<int64_t>(S.Count)},
+                      {"mean", S.Mean},
+                      {"min", S.Min},
+                      {"p50", S.P50},
+                      {"p90", S.P90},
+                      {"p99", S.P99},
+                      {"max", S.Max}};
+}
+
+json::Value describeHost() {
+  return json::Object{{"cpu", sys::getHostCPUName()},
+                      {"physical_cores", sys::getHostNumPhysicalCores()}};
+}
+
+} // namespace libc_benchmarks
+} // namespace llvm
@@ -0,0 +1,85 @@
+//===-------- Measurement and reporting for the libc benchmarks --*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// The parts of the benchmarks that don't depend on what is measured: timing
+// batches of calls, summarizing the samples, and describing the host in the
+// JSON reports.
+//
+// Calls that take a few nanoseconds are too short to time one at a time, so a
+// sample is the average latency of the calls in a batch. The percentiles are
+// those of the batches, which is what spikes in a real workload look like at
+// this scale: interrupts, frequency changes and cache misses hit batches.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_BENCHMARKS_LIBCBENCHMARK_H
+#define LLVM_LIBC_BENCHMARKS_LIBCBENCHMARK_H
+
+#include "llvm/Support/JSON.h"
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace llvm {
+namespace libc_benchmarks {
+
+using Clock = std::chrono::steady_clock;
+
+// How long to measure a function for.
+struct BenchmarkOptions {
+  // Stop once both the minimum duration and number of samples are reached, or
+  // at the maximum number of samples.
+  std::chrono::milliseconds MinDuration{500};
+  size_t MinSamples = 100;
+  size_t MaxSamples = 1000000;
+};
+
+// The summary of a set of samples.
+struct Statistics {
+  size_t Count = 0;
+  double Mean = 0;
+  double Min = 0;
+  double P50 = 0;
+  double P90 = 0;
+  double P99 = 0;
+  double Max = 0;
+};
+
+// Summarizes `Samples`, with nearest-rank percentiles.
+Statistics computeStatistics(std::vector<double> Samples);
+
+// Calls `RunBatch(Index)` for Index = 0, 1, ... as long as `Options` asks,
+// and returns the duration of each call in nanoseconds.
+template <typename BatchFn>
+std::vector<double> sampleBatches(const BenchmarkOptions &Options,
+                                  BatchFn RunBatch) {
+  std::vector<double> Durations;
+  const Clock::time_point Start = Clock::now();
+  for (size_t Index = 0; Index < Options.MaxSamples; ++Index) {
+    const Clock::time_point Before = Clock::now();
+    RunBatch(Index);
+    const Clock::time_point After = Clock::now();
+    Durations.push_back(
+        std::chrono::duration<double, std::nano>(After - Before).count());
+    if (Durations.size() >= Options.MinSamples &&
+        After - Start >= Options.MinDuration)
+      break;
+  }
+  return Durations;
+}
+
+json::Value toJSON(const Statistics &S);
+
+// The CPU the benchmarks ran on.
+json::Value describeHost();
+
+} // namespace libc_benchmarks
+} // namespace llvm
+
+#endif // LLVM_LIBC_BENCHMARKS_LIBCBENCHMARK_H
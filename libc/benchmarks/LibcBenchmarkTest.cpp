@@ -0,0 +1,96 @@
+//===-------- Unittests for the libc benchmark framework -----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "LibcBenchmark.h"
+#include "LibcMemoryBenchmark.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::libc_benchmarks;
+
+namespace {
+
+TEST(LibcBenchmarkTest, Statistics) {
+  std::vector<double> Samples;
+  for (int I = 100; I >= 1; --I)
+    Samples.push_back(I);
+  const Statistics S = computeStatistics(Samples);
+  EXPECT_EQ(S.Count, 100u);
+  EXPECT_EQ(S.Mean, 50.5);
+  EXPECT_EQ(S.Min, 1);
+  EXPECT_EQ(S.P50, 50);
+  EXPECT_EQ(S.P90, 90);
+  EXPECT_EQ(S.P99, 99);
+  EXPECT_EQ(S.Max, 100);
+
+  const Statistics One = computeStatistics({7});
+  EXPECT_EQ(One.P50, 7);
+  EXPECT_EQ(One.P99, 7);
+  EXPECT_EQ(computeStatistics({}).Count, 0u);
+}
+
+TEST(LibcBenchmarkTest, SampleBatches) {
+  BenchmarkOptions Options;
+  Options.MinDuration = std::chrono::milliseconds(0);
+  Options.MinSamples = 10;
+  size_t Batches = 0;
+  const std::vector<double> Durations =
+      sampleBatches(Options, [&](size_t Index) {
+        EXPECT_EQ(Index, Batches);
+        ++Batches;
+      });
+  EXPECT_EQ(Durations.size(), 10u);
+  EXPECT_EQ(Batches, 10u);
+}
+
+TEST(LibcBenchmarkTest, ParseSizeDistribution) {
+  Expected<SizeDistribution> Distribution =
+      parseSizeDistribution("test", "# size weight\n8 3\n\n  64 1.5\n");
+  ASSERT_THAT_EXPECTED(Distribution, Succeeded());
+  EXPECT_EQ(Distribution->Name, "test");
+  EXPECT_EQ(Distribution->Sizes, (std::vector<size_t>{8, 64}));
+  EXPECT_EQ(Distribution->Weights, (std::vector<double>{3, 1.5}));
+  EXPECT_EQ(Distribution->maxSize(), 64u);
+
+  EXPECT_THAT_EXPECTED(parseSizeDistribution("test", "8\n"), Failed());
+  EXPECT_THAT_EXPECTED(parseSizeDistribution("test", "8 -1\n"), Failed());
+  EXPECT_THAT_EXPECTED(parseSizeDistribution("test", "# empty\n"), Failed());
+}
+
+TEST(LibcBenchmarkTest, Workload) {
+  SizeDistribution Distribution;
+  Distribution.Sizes = {1, 100, 1000};
+  Distribution.Weights = {1, 1, 1};
+  MemoryConfiguration Config;
+  Config.WorkingSetSize = 4096;
+  Config.DstOffset = 3;
+  Expected<MemoryWorkload> Workload =
+      MemoryWorkload::create(Distribution, Config);
+  ASSERT_THAT_EXPECTED(Workload, Succeeded());
+  ASSERT_EQ(Workload->calls().size(), Config.NumCalls);
+  size_t TotalBytes = 0;
+  for (const MemoryCall &Call : Workload->calls()) {
+    TotalBytes += Call.Size;
+    EXPECT_LE(Call.SrcPosition + Call.Size, Config.WorkingSetSize);
+    EXPECT_LE(Call.DstPosition + Call.Size, Config.WorkingSetSize);
+    EXPECT_EQ(Call.DstPosition % MemoryWorkload::CacheLineSize, 3u);
+    // The halves are disjoint.
+    EXPECT_TRUE(Workload->src(Call) + Call.Size <= Workload->dst(Call) ||
+                Workload->dst(Call) + Call.Size <= Workload->src(Call));
+  }
+  EXPECT_EQ(Workload->totalBytes(), TotalBytes);
+
+  Config.WorkingSetSize = 1024;
+  EXPECT_THAT_EXPECTED(MemoryWorkload::create(Distribution, Config), Failed());
+  Config.WorkingSetSize = 4096;
+  Config.SrcOffset = 64;
+  EXPECT_THAT_EXPECTED(MemoryWorkload::create(Distribution, Config), Failed());
+}
+
+} // namespace
@@ -0,0 +1,146 @@
+//===------- Workloads for benchmarking the memory functions -------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "LibcMemoryBenchmark.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+namespace llvm {
+namespace libc_benchmarks {
+
+size_t SizeDistribution::maxSize() const {
+  return Sizes.empty() ? 0 : *std::max_element(Sizes.begin(), Sizes.end());
+}
+
+Expected<SizeDistribution> parseSizeDistribution(StringRef Name,
+                                                 StringRef Text) {
+  SizeDistribution Distribution;
+  Distribution.Name = Name.str();
+  double TotalWeight = 0;
+  for (size_t LineNumber = 1; !Text.empty(); ++LineNumber) {
+    StringRef Line;
+    std::tie(Line, Text) = Text.split('\n');
+    Line = Line.trim();
+    if (Line.empty() || Line.startswith("#"))
+      continue;
+    StringRef SizeField, WeightField;
+    std::tie(SizeField, WeightField) = Line.split(' ');
+    WeightField = WeightField.trim();
+    size_t Size;
+    double Weight;
+    if (SizeField.getAsInteger(10, Size) || WeightField.empty() ||
+        WeightField.getAsDouble(Weight) || Weight < 0)
+      return createStringError(inconvertibleErrorCode(),
+                               "%s:%zu: expected '<size> <weight>'",
+                               Distribution.Name.c_str(), LineNumber);
+    Distribution.Sizes.push_back(Size);
+    Distribution.Weights.push_back(Weight);
+    TotalWeight += Weight;
+  }
+  if (TotalWeight == 0)
+    return createStringError(inconvertibleErrorCode(),
+                             "%s: the distribution has no weight",
+                             Distribution.Name.c_str());
+  return Distribution;
+}
+
+Expected<SizeDistribution> loadSizeDistribution(StringRef Path) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer = MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return createStringError(Buffer.getError(), "cannot read " + Path + ": " +
+                                                    Buffer.getError().message());
+  return parseSizeDistribution(sys::path::stem(Path), (*Buffer)->getBuffer());
+}
+
+SizeDistribution getSyntheticDistribution() {
+  SizeDistribution Distribution;
+  Distribution.Name = "synthetic";
+  double Weight = 1;
+  for (size_t Size = 1; Size <= 4096; Size *= 2, Weight /= 2)
+    for (size_t I = Size; I < 2 * Size; ++I) {
+      Distribution.Sizes.push_back(I);
+      // Spreads the weight of the range over its sizes.
+      Distribution.Weights.push_back(Weight / Size);
+    }
+  return Distribution;
+}
+
+Expected<MemoryWorkload>
+MemoryWorkload::create(const SizeDistribution &Distribution,
+                       const MemoryConfiguration &Config) {
+  const size_t MaxSize = Distribution.maxSize();
+  // Each call needs room for its largest buffer past its offset.
+  const size_t Half = alignTo(Config.WorkingSetSize, CacheLineSize);
+  if (Half < alignTo(MaxSize, CacheLineSize) + CacheLineSize)
+    return createStringError(
+        inconvertibleErrorCode(),
+        "a working set of %zu bytes cannot hold buffers of %zu bytes",
+        Config.WorkingSetSize, MaxSize);
+  for (const Optional<size_t> &Offset : {Config.SrcOffset, Config.DstOffset})
+    if (Offset && *Offset >= CacheLineSize)
+      return createStringError(inconvertibleErrorCode(),
+                               "offsets must be less than %zu",
+                               CacheLineSize);
+
+  MemoryWorkload Workload;
+  Workload.DistributionName = Distribution.Name;
+  Workload.Config = Config;
+  // Both halves, aligned on a cache line.
+  Workload.Storage.reset(new char[2 * Half + CacheLineSize]);
+  Workload.Src = reinterpret_cast<char *>(
+      alignTo(reinterpret_cast<uintptr_t>(Workload.Storage.get()),
+              CacheLineSize));
+  Workload.Dst = Workload.Src + Half;
+  // Equal contents, so that the comparisons look at every byte. The calls
+  // keep them equal: copies and sets only ever write that byte.
+  std::memset(Workload.Src, 'a', 2 * Half);
+
+  std::mt19937_64 Generator(Config.Seed);
+  std::discrete_distribution<size_t> PickSize(Distribution.Weights.begin(),
+                                              Distribution.Weights.end());
+  std::uniform_int_distribution<size_t> PickOffset(0, CacheLineSize - 1);
+  // The cache lines a buffer can start on are those from which it fits in
+  // its half whatever its offset.
+  auto PickPosition = [&](size_t Size, const Optional<size_t> &Offset) {
+    const size_t Lines = (Half - Size) / CacheLineSize;
+    std::uniform_int_distribution<size_t> PickLine(0, Lines - 1);
+    return PickLine(Generator) * CacheLineSize +
+           (Offset ? *Offset : PickOffset(Generator));
+  };
+  for (size_t I = 0; I < Config.NumCalls; ++I) {
+    MemoryCall Call;
+    Call.Size = Distribution.Sizes[PickSize(Generator)];
+    Call.SrcPosition = PickPosition(Call.Size, Config.SrcOffset);
+    Call.DstPosition = PickPosition(Call.Size, Config.DstOffset);
+    Workload.Calls.push_back(Call);
+    Workload.TotalBytes += Call.Size;
+  }
+  return Workload;
+}
+
+json::Value MemoryWorkload::describe() const {
+  auto DescribeOffset = [](const Optional<size_t> &Offset) -> json::Value {
+    if (Offset)
+      return static_cast<int64_t>(*Offset);
+    return "random";
+  };
+  return json::Object{
+      {"size_distribution", DistributionName},
+      {"working_set_size", static_cast<int64_t>(Config.WorkingSetSize)},
+      {"src_offset", DescribeOffset(Config.SrcOffset)},
+      {"dst_offset", DescribeOffset(Config.DstOffset)},
+      {"calls", static_cast<int64_t>(Calls.size())},
+      {"seed", static_cast<int64_t>(Config.Seed)}};
+}
+
+} // namespace libc_benchmarks
+} // namespace llvm
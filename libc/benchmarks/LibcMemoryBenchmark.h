@@ -0,0 +1,114 @@
+//===------- Workloads for benchmarking the memory functions ----*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// A workload is a sequence of calls to a memory function whose sizes follow a
+// distribution recorded from a real program: which size class a call falls
+// in is then as hard to predict as it is in production, and so are the
+// branches that dispatch on it.
+//
+// The buffers of the calls are spread over a working set whose size decides
+// which cache level they are found in, and start at a chosen or random
+// offset from a cache line.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_BENCHMARKS_LIBCMEMORYBENCHMARK_H
+#define LLVM_LIBC_BENCHMARKS_LIBCMEMORYBENCHMARK_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/JSON.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace llvm {
+namespace libc_benchmarks {
+
+// The sizes passed to a function and how often each one is.
+struct SizeDistribution {
+  std::string Name;
+  std::vector<size_t> Sizes;
+  std::vector<double> Weights;
+
+  size_t maxSize() const;
+};
+
+// Parses a recorded distribution: one "<size> <weight>" pair per line, where
+// the weights need not be normalized. Lines starting with '#' are comments.
+// A sampler only has to count the calls of each size to produce one.
+Expected<SizeDistribution> parseSizeDistribution(StringRef Name,
+                                                 StringRef Text);
+
+// Reads a distribution in the format above, named after its file.
+Expected<SizeDistribution> loadSizeDistribution(StringRef Path);
+
+// A distribution in which each power-of-two range of sizes up to 8KiB is half
+// as likely as the previous one. It is only meant as a sanity check when no
+// recorded one is at hand.
+SizeDistribution getSyntheticDistribution();
+
+struct MemoryConfiguration {
+  // The bytes the source buffers are spread over, and as many for the
+  // destinations: 16KiB stays in the L1 cache of any core, while hundreds of
+  // megabytes make the calls go to memory.
+  size_t WorkingSetSize = 16 * 1024;
+  // The offset of each buffer from the start of a cache line, or None for a
+  // random one.
+  Optional<size_t> SrcOffset;
+  Optional<size_t> DstOffset;
+  size_t NumCalls = 4096;
+  // The calls are drawn from a generator with a fixed seed, so that runs are
+  // comparable.
+  uint64_t Seed = 42;
+};
+
+// The arguments of one call, with its buffers as positions in the source and
+// destination halves of the working set.
+struct MemoryCall {
+  size_t Size;
+  size_t SrcPosition;
+  size_t DstPosition;
+};
+
+class MemoryWorkload {
+public:
+  static constexpr size_t CacheLineSize = 64;
+
+  static Expected<MemoryWorkload> create(const SizeDistribution &Distribution,
+                                         const MemoryConfiguration &Config);
+
+  ArrayRef<MemoryCall> calls() const { return Calls; }
+  char *src(const MemoryCall &Call) const { return Src + Call.SrcPosition; }
+  char *dst(const MemoryCall &Call) const { return Dst + Call.DstPosition; }
+  // The bytes passed to all the calls.
+  size_t totalBytes() const { return TotalBytes; }
+
+  json::Value describe() const;
+
+private:
+  MemoryWorkload() = default;
+
+  std::string DistributionName;
+  MemoryConfiguration Config;
+  std::vector<MemoryCall> Calls;
+  std::unique_ptr<char[]> Storage;
+  char *Src = nullptr;
+  char *Dst = nullptr;
+  size_t TotalBytes = 0;
+};
+
+} // namespace libc_benchmarks
+} // namespace llvm
+
+#endif // LLVM_LIBC_BENCHMARKS_LIBCMEMORYBENCHMARK_H
@@ -0,0 +1,244 @@
+//===------- Benchmark driver for the memory functions -------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Replays a workload against the memory functions of this libc and of the
+// system one, and writes the throughput and latency of each as JSON.
+//
+//===----------------------------------------------------------------------===//
+
+#include "LibcBenchmark.h"
+#include "LibcMemoryBenchmark.h"
+#include "src/string/bcmp/bcmp.h"
+#include "src/string/memcmp/memcmp.h"
+#include "src/string/memcpy/memcpy.h"
+#include "src/string/memmove/memmove.h"
+#include "src/string/memset/memset.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/WithColor.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstring>
+
+// The system bcmp is not declared by every string.h.
+extern "C" int bcmp(const void *, const void *, size_t);
+
+namespace llvm {
+namespace libc_benchmarks {
+
+static cl::list<std::string>
+    Functions("function", cl::CommaSeparated,
+              cl::desc("The functions to measure (default: all)"));
+
+static cl::opt<std::string> SizeDistributionPath(
+    "size-distribution",
+    cl::desc("A file of '<size> <weight>' lines (default: synthetic)"),
+    cl::value_desc("file"));
+
+static cl::opt<size_t> WorkingSetSize(
+    "working-set-size",
+    cl::desc("The bytes the source buffers are spread over, and as many for "
+             "the destinations"),
+    cl::init(16 * 1024));
+
+static cl::opt<int>
+    SrcOffset("src-offset",
+              cl::desc("The offset of the sources from a cache line, or -1 "
+                       "for random offsets"),
+              cl::init(-1));
+
+static cl::opt<int>
+    DstOffset("dst-offset",
+              cl::desc("The offset of the destinations from a cache line, or "
+                       "-1 for random offsets"),
+              cl::init(-1));
+
+static cl::opt<size_t> NumCalls("calls",
+                                cl::desc("The calls in the workload"),
+                                cl::init(4096));
+
+static cl::opt<size_t> BatchSize("batch-size",
+                                 cl::desc("The calls timed together"),
+                                 cl::init(64));
+
+static cl::opt<unsigned>
+    MinDurationMs("min-duration-ms",
+                  cl::desc("The minimum time to measure each function for"),
+                  cl::init(500));
+
+static cl::opt<std::string> Output("o", cl::desc("The JSON report"),
+                                   cl::value_desc("file"), cl::init("-"));
+
+// Every function is called as a copy, with its result folded into a sink so
+// that calls to the functions the compiler knows aren't optimized away.
+using MemoryFunction = int (*)(char *Dst, const char *Src, size_t Size);
+
+struct Implementation {
+  const char *Function;
+  const char *Name;
+  MemoryFunction Call;
+};
+
+static const Implementation Implementations[] = {
+    {"memcpy", "llvm-libc",
+     [](char *Dst, const char *Src, size_t Size) {
+       return __llvm_libc::memcpy(Dst, Src, Size) != nullptr ? 0 : 1;
+     }},
+    {"memcpy", "system",
+     [](char *Dst, const char *Src, size_t Size) {
+       return ::memcpy(Dst, Src, Size) != nullptr ? 0 : 1;
+     }},
+    {"memmove", "llvm-libc",
+     [](char *Dst, const char *Src, size_t Size) {
+       return __llvm_libc::memmove(Dst, Src, Size) != nullptr ? 0 : 1;
+     }},
+    {"memmove", "system",
+     [](char *Dst, const char *Src, size_t Size) {
+       return ::memmove(Dst, Src, Size) != nullptr ? 0 : 1;
+     }},
+    {"memset", "llvm-libc",
+     [](char *Dst, const char *Src, size_t Size) {
+       return __llvm_libc::memset(Dst, Src[0], Size) != nullptr ? 0 : 1;
+     }},
+    {"memset", "system",
+     [](char *Dst, const char *Src, size_t Size) {
+       return ::memset(Dst, Src[0], Size) != nullptr ? 0 : 1;
+     }},
+    {"memcmp", "llvm-libc",
+     [](char *Dst, const char *Src, size_t Size) {
+       return __llvm_libc::memcmp(Dst, Src, Size);
+     }},
+    {"memcmp", "system",
+     [](char *Dst, const char *Src, size_t Size) {
+       return ::memcmp(Dst, Src, Size);
+     }},
+    {"bcmp", "llvm-libc",
+     [](char *Dst, const char *Src, size_t Size) {
+       return __llvm_libc::bcmp(Dst, Src, Size);
+     }},
+    {"bcmp", "system",
+     [](char *Dst, const char *Src, size_t Size) {
+       return ::bcmp(Dst, Src, Size);
+     }},
+};
+
+static volatile int Sink;
+
+static int runCalls(const MemoryWorkload &Workload, MemoryFunction Function,
+                    size_t Begin, size_t Count) {
+  ArrayRef<MemoryCall> Calls = Workload.calls();
+  int Result = 0;
+  for (size_t I = 0; I < Count; ++I) {
+    const MemoryCall &Call = Calls[(Begin + I) % Calls.size()];
+    Result |= Function(Workload.dst(Call), Workload.src(Call), Call.Size);
+  }
+  return Result;
+}
+
+static json::Value measure(const MemoryWorkload &Workload,
+                           const Implementation &Impl,
+                           const BenchmarkOptions &Options) {
+  const size_t NumCalls = Workload.calls().size();
+  // Brings the working set into the caches it fits in.
+  Sink = runCalls(Workload, Impl.Call, 0, NumCalls);
+  std::vector<double> Durations = sampleBatches(Options, [&](size_t Index) {
+    Sink = runCalls(Workload, Impl.Call, Index * BatchSize, BatchSize);
+  });
+  double TotalDuration = 0;
+  for (double &Duration : Durations) {
+    TotalDuration += Duration;
+    Duration /= BatchSize;
+  }
+  // The batches run over the workload in order, so the bytes they passed are
+  // those of the whole workload, pro rata.
+  const double CallsMade = static_cast<double>(Durations.size()) * BatchSize;
+  const double BytesPassed =
+      CallsMade / NumCalls * static_cast<double>(Workload.totalBytes());
+  return json::Object{
+      {"function", Impl.Function},
+      {"implementation", Impl.Name},
+      {"bytes_per_second", BytesPassed / (TotalDuration * 1e-9)},
+      {"latency_ns", toJSON(computeStatistics(std::move(Durations)))}};
+}
+
+static Optional<size_t> getOffset(int Offset) {
+  if (Offset < 0)
+    return None;
+  return static_cast<size_t>(Offset);
+}
+
+static int run() {
+  for (const std::string &Function : Functions)
+    if (none_of(Implementations, [&](const Implementation &Impl) {
+          return Function == Impl.Function;
+        })) {
+      WithColor::error() << "unknown function '" << Function << "'\n";
+      return 1;
+    }
+  if (BatchSize == 0) {
+    WithColor::error() << "the batch size must be positive\n";
+    return 1;
+  }
+
+  SizeDistribution Distribution = getSyntheticDistribution();
+  if (!SizeDistributionPath.empty()) {
+    Expected<SizeDistribution> Loaded =
+        loadSizeDistribution(SizeDistributionPath);
+    if (!Loaded) {
+      WithColor::error() << toString(Loaded.takeError()) << "\n";
+      return 1;
+    }
+    Distribution = std::move(*Loaded);
+  }
+
+  MemoryConfiguration Config;
+  Config.WorkingSetSize = WorkingSetSize;
+  Config.SrcOffset = getOffset(SrcOffset);
+  Config.DstOffset = getOffset(DstOffset);
+  Config.NumCalls = NumCalls;
+  Expected<MemoryWorkload> Workload =
+      MemoryWorkload::create(Distribution, Config);
+  if (!Workload) {
+    WithColor::error() << toString(Workload.takeError()) << "\n";
+    return 1;
+  }
+
+  BenchmarkOptions Options;
+  Options.MinDuration = std::chrono::milliseconds(MinDurationMs);
+
+  std::error_code EC;
+  raw_fd_ostream OS(Output, EC, sys::fs::OF_Text);
+  if (EC) {
+    WithColor::error() << "cannot write " << Output << ": " << EC.message()
+                       << "\n";
+    return 1;
+  }
+  json::OStream JOS(OS, 2);
+  JOS.object([&] {
+    JOS.attribute("host", describeHost());
+    JOS.attribute("workload", Workload->describe());
+    JOS.attribute("batch_size", static_cast<int64_t>(BatchSize));
+    JOS.attributeArray("results", [&] {
+      for (const Implementation &Impl : Implementations)
+        if (Functions.empty() || is_contained(Functions, Impl.Function))
+          JOS.value(measure(*Workload, Impl, Options));
+    });
+  });
+  OS << "\n";
+  return 0;
+}
+
+} // namespace libc_benchmarks
+} // namespace llvm
+
+int main(int argc, char **argv) {
+  llvm::cl::ParseCommandLineOptions(argc, argv,
+                                    "libc memory function benchmarks\n");
+  return llvm::libc_benchmarks::run();
+}
@@ -61,6 +61,10 @@ char *strerror(int);
 
 size_t strlen(const char *);
 
+// POSIX extensions.
+
+int bcmp(const void *, const void *, size_t);
+
 __END_C_DECLS
 
 #endif // LLVM_LIBC_STRING_H
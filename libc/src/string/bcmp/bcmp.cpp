@@ -0,0 +1,89 @@
+//===--------------------- Implementation of bcmp ------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/string/bcmp/bcmp.h"
+
+#include "src/__support/common.h"
+#include "src/string/memory_utils/dispatch.h"
+#include "src/string/memory_utils/elements.h"
+
+namespace __llvm_libc {
+
+// bcmp only tells whether the buffers differ, so unlike memcmp it never needs
+// to find where.
+
+// Compares more than 128 bytes, in 64-byte blocks.
+static uint64_t differ_large_baseline(const char *lhs, const char *rhs,
+                                      size_t count) {
+  return differ_blocks<64>(lhs, rhs, count);
+}
+
+#if LLVM_LIBC_HAS_MEMORY_DISPATCH
+using DifferFn = uint64_t (*)(const char *, const char *, size_t);
+
+LLVM_LIBC_TARGET_AVX2 static uint64_t
+differ_large_avx2(const char *lhs, const char *rhs, size_t count) {
+  return differ_blocks<64>(lhs, rhs, count);
+}
+
+LLVM_LIBC_TARGET_AVX512 static uint64_t
+differ_large_avx512(const char *lhs, const char *rhs, size_t count) {
+  return differ_blocks<64>(lhs, rhs, count);
+}
+
+static uint64_t differ_large_resolver(const char *lhs, const char *rhs,
+                                      size_t count);
+static DifferFn differ_large_variant = differ_large_resolver;
+
+static uint64_t differ_large_resolver(const char *lhs, const char *rhs,
+                                      size_t count) {
+  const DifferFn fn = select_variant<DifferFn>(
+      differ_large_baseline, differ_large_avx2, differ_large_avx512);
+  store_variant(&differ_large_variant, fn);
+  return fn(lhs, rhs, count);
+}
+
+static inline uint64_t differ_large(const char *lhs, const char *rhs,
+                                    size_t count) {
+  return load_variant(&differ_large_variant)(lhs, rhs, count);
+}
+#else
+static inline uint64_t differ_large(const char *lhs, const char *rhs,
+                                    size_t count) {
+  return differ_large_baseline(lhs, rhs, count);
+}
+#endif
+
+static inline uint64_t inline_bcmp(const char *lhs, const char *rhs,
+                                   size_t count) {
+  if (count == 0)
+    return 0;
+  if (count == 1)
+    return differ<1>(lhs, rhs);
+  if (count <= 4)
+    return differ_overlap<2>(lhs, rhs, count);
+  if (count <= 8)
+    return differ_overlap<4>(lhs, rhs, count);
+  if (count <= 16)
+    return differ_overlap<8>(lhs, rhs, count);
+  if (count <= 32)
+    return differ_overlap<16>(lhs, rhs, count);
+  if (count <= 64)
+    return differ_overlap<32>(lhs, rhs, count);
+  if (count <= 128)
+    return differ_overlap<64>(lhs, rhs, count);
+  return differ_large(lhs, rhs, count);
+}
+
+int LLVM_LIBC_ENTRYPOINT(bcmp)(const void *lhs, const void *rhs,
+                               size_t count) {
+  return inline_bcmp(reinterpret_cast<const char *>(lhs),
+                     reinterpret_cast<const char *>(rhs), count) != 0;
+}
+
+} // namespace __llvm_libc
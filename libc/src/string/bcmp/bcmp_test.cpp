@@ -0,0 +1,32 @@
+//===------------------------ Unittests for bcmp --------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "src/string/bcmp/bcmp.h"
+#include "gtest/gtest.h"
+
+// For every size class, a difference at any position is found.
+TEST(BcmpTest, AnyDifference) {
+  const size_t kMaxSize = 300;
+  std::vector<char> lhs(kMaxSize + 1), rhs(kMaxSize + 1);
+  for (size_t size = 0; size <= kMaxSize; ++size) {
+    for (size_t i = 0; i <= size; ++i)
+      lhs[i] = rhs[i] = static_cast<char>(i * 3);
+    // The byte past the end doesn't count.
+    rhs[size] = 1;
+    ASSERT_EQ(__llvm_libc::bcmp(lhs.data(), rhs.data(), size), 0)
+        << "size " << size;
+    for (size_t pos = 0; pos < size; ++pos) {
+      rhs[pos] ^= 0x40;
+      ASSERT_NE(__llvm_libc::bcmp(lhs.data(), rhs.data(), size), 0)
+          << "size " << size << ", pos " << pos;
+      rhs[pos] ^= 0x40;
+    }
+  }
+}
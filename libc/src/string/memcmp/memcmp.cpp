@@ -0,0 +1,86 @@
+//===-------------------- Implementation of memcmp -----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/string/memcmp/memcmp.h"
+
+#include "src/__support/common.h"
+#include "src/string/memory_utils/dispatch.h"
+#include "src/string/memory_utils/elements.h"
+
+namespace __llvm_libc {
+
+// Compares more than 128 bytes, in 64-byte blocks.
+static int compare_large_baseline(const char *lhs, const char *rhs,
+                                  size_t count) {
+  return compare_blocks<64>(lhs, rhs, count);
+}
+
+#if LLVM_LIBC_HAS_MEMORY_DISPATCH
+using CompareFn = int (*)(const char *, const char *, size_t);
+
+LLVM_LIBC_TARGET_AVX2 static int
+compare_large_avx2(const char *lhs, const char *rhs, size_t count) {
+  return compare_blocks<64>(lhs, rhs, count);
+}
+
+LLVM_LIBC_TARGET_AVX512 static int
+compare_large_avx512(const char *lhs, const char *rhs, size_t count) {
+  return compare_blocks<64>(lhs, rhs, count);
+}
+
+static int compare_large_resolver(const char *lhs, const char *rhs,
+                                  size_t count);
+static CompareFn compare_large_variant = compare_large_resolver;
+
+static int compare_large_resolver(const char *lhs, const char *rhs,
+                                  size_t count) {
+  const CompareFn fn = select_variant<CompareFn>(
+      compare_large_baseline, compare_large_avx2, compare_large_avx512);
+  store_variant(&compare_large_variant, fn);
+  return fn(lhs, rhs, count);
+}
+
+static inline int compare_large(const char *lhs, const char *rhs,
+                                size_t count) {
+  return load_variant(&compare_large_variant)(lhs, rhs, count);
+}
+#else
+static inline int compare_large(const char *lhs, const char *rhs,
+                                size_t count) {
+  return compare_large_baseline(lhs, rhs, count);
+}
+#endif
+
+static inline int inline_memcmp(const char *lhs, const char *rhs,
+                                size_t count) {
+  if (count == 0)
+    return 0;
+  if (count == 1)
+    return Ordered<1>::compare(lhs, rhs);
+  if (count <= 4)
+    return compare_overlap<2>(lhs, rhs, count);
+  if (count <= 8)
+    return compare_overlap<4>(lhs, rhs, count);
+  if (count <= 16)
+    return compare_overlap<8>(lhs, rhs, count);
+  if (count <= 32)
+    return compare_overlap<16>(lhs, rhs, count);
+  if (count <= 64)
+    return compare_overlap<32>(lhs, rhs, count);
+  if (count <= 128)
+    return compare_overlap<64>(lhs, rhs, count);
+  return compare_large(lhs, rhs, count);
+}
+
+int LLVM_LIBC_ENTRYPOINT(memcmp)(const void *lhs, const void *rhs,
+                                 size_t count) {
+  return inline_memcmp(reinterpret_cast<const char *>(lhs),
+                       reinterpret_cast<const char *>(rhs), count);
+}
+
+} // namespace __llvm_libc
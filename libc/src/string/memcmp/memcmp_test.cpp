@@ -0,0 +1,47 @@
+//===----------------------- Unittests for memcmp -------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "src/string/memcmp/memcmp.h"
+#include "gtest/gtest.h"
+
+static int sign(int value) { return (value > 0) - (value < 0); }
+
+// For every size class, a difference at each position decides the result,
+// whatever follows it.
+TEST(MemcmpTest, FirstDifferenceDecides) {
+  const size_t kMaxSize = 300;
+  std::vector<char> lhs(kMaxSize + 1), rhs(kMaxSize + 1);
+  for (size_t size = 0; size <= kMaxSize; ++size) {
+    for (size_t i = 0; i <= size; ++i)
+      lhs[i] = rhs[i] = static_cast<char>(i);
+    ASSERT_EQ(__llvm_libc::memcmp(lhs.data(), rhs.data(), size), 0);
+    for (size_t pos = 0; pos < size; ++pos) {
+      // Bytes compare as unsigned char, and later bytes that differ the
+      // other way don't matter.
+      lhs[pos] = '\x80';
+      rhs[pos] = '\x7f';
+      if (pos + 1 < size)
+        rhs[size - 1] = '\xff';
+      ASSERT_GT(__llvm_libc::memcmp(lhs.data(), rhs.data(), size), 0)
+          << "size " << size << ", pos " << pos;
+      ASSERT_LT(__llvm_libc::memcmp(rhs.data(), lhs.data(), size), 0)
+          << "size " << size << ", pos " << pos;
+      lhs[pos] = rhs[pos] = static_cast<char>(pos);
+      rhs[size - 1] = static_cast<char>(size - 1);
+    }
+  }
+}
+
+TEST(MemcmpTest, Unaligned) {
+  const char lhs[] = "xxabcdefghijklmnopqrstuvwxyz0123456789";
+  const char rhs[] = "yabcdefghijklmnopqrstuvwxyz0123456788";
+  ASSERT_EQ(__llvm_libc::memcmp(lhs + 2, rhs + 1, 35), 0);
+  ASSERT_EQ(sign(__llvm_libc::memcmp(lhs + 2, rhs + 1, 36)), 1);
+}
@@ -0,0 +1,90 @@
+//===-------------------- Implementation of memcpy -----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/string/memcpy/memcpy.h"
+
+#include "src/__support/common.h"
+#include "src/string/memory_utils/dispatch.h"
+#include "src/string/memory_utils/elements.h"
+
+namespace __llvm_libc {
+
+// Copies of more than 128 bytes, in 64-byte blocks.
+static void copy_large_baseline(char *__restrict dst,
+                                const char *__restrict src, size_t count) {
+  copy_aligned_blocks<64>(dst, src, count);
+}
+
+#if LLVM_LIBC_HAS_MEMORY_DISPATCH
+using CopyFn = void (*)(char *__restrict, const char *__restrict, size_t);
+
+LLVM_LIBC_TARGET_AVX2 static void copy_large_avx2(char *__restrict dst,
+                                                  const char *__restrict src,
+                                                  size_t count) {
+  copy_aligned_blocks<64>(dst, src, count);
+}
+
+LLVM_LIBC_TARGET_AVX512 static void
+copy_large_avx512(char *__restrict dst, const char *__restrict src,
+                  size_t count) {
+  copy_aligned_blocks<64>(dst, src, count);
+}
+
+static void copy_large_resolver(char *__restrict dst,
+                                const char *__restrict src, size_t count);
+static CopyFn copy_large_variant = copy_large_resolver;
+
+static void copy_large_resolver(char *__restrict dst,
+                                const char *__restrict src, size_t count) {
+  const CopyFn fn = select_variant<CopyFn>(copy_large_baseline,
+                                           copy_large_avx2, copy_large_avx512);
+  store_variant(&copy_large_variant, fn);
+  fn(dst, src, count);
+}
+
+static inline void copy_large(char *__restrict dst, const char *__restrict src,
+                              size_t count) {
+  load_variant(&copy_large_variant)(dst, src, count);
+}
+#else
+static inline void copy_large(char *__restrict dst, const char *__restrict src,
+                              size_t count) {
+  copy_large_baseline(dst, src, count);
+}
+#endif
+
+// Each size class is handled by two blocks that may overlap, without a loop.
+static inline void inline_memcpy(char *__restrict dst,
+                                 const char *__restrict src, size_t count) {
+  if (count == 0)
+    return;
+  if (count == 1)
+    return copy<1>(dst, src);
+  if (count <= 4)
+    return copy_overlap<2>(dst, src, count);
+  if (count <= 8)
+    return copy_overlap<4>(dst, src, count);
+  if (count <= 16)
+    return copy_overlap<8>(dst, src, count);
+  if (count <= 32)
+    return copy_overlap<16>(dst, src, count);
+  if (count <= 64)
+    return copy_overlap<32>(dst, src, count);
+  if (count <= 128)
+    return copy_overlap<64>(dst, src, count);
+  return copy_large(dst, src, count);
+}
+
+void *LLVM_LIBC_ENTRYPOINT(memcpy)(void *__restrict dst,
+                                   const void *__restrict src, size_t count) {
+  inline_memcpy(reinterpret_cast<char *>(dst),
+                reinterpret_cast<const char *>(src), count);
+  return dst;
+}
+
+} // namespace __llvm_libc
@@ -0,0 +1,50 @@
+//===----------------------- Unittests for memcpy -------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "src/string/memcpy/memcpy.h"
+#include "gtest/gtest.h"
+
+// Every size class, up to the loop over blocks, at every alignment of the
+// destination and source within a block.
+TEST(MemcpyTest, SizesAndAlignments) {
+  const size_t kMaxSize = 400;
+  const size_t kMaxOffset = 64;
+  std::vector<char> src(kMaxSize + kMaxOffset);
+  for (size_t i = 0; i < src.size(); ++i)
+    src[i] = static_cast<char>(i * 7 + 1);
+  std::vector<char> dst(kMaxSize + 2 * kMaxOffset);
+  for (size_t size = 0; size <= kMaxSize; ++size) {
+    for (size_t offset : {size_t(0), size_t(1), size_t(7), size_t(31),
+                          size_t(63)}) {
+      std::fill(dst.begin(), dst.end(), 0);
+      const char *from = src.data() + (size * 3) % kMaxOffset;
+      char *to = dst.data() + offset;
+      ASSERT_EQ(__llvm_libc::memcpy(to, from, size), to);
+      for (size_t i = 0; i < size; ++i)
+        ASSERT_EQ(to[i], from[i]) << "size " << size << ", offset " << offset;
+      // Nothing around the destination is touched.
+      for (size_t i = 0; i < offset; ++i)
+        ASSERT_EQ(dst[i], 0);
+      for (size_t i = offset + size; i < dst.size(); ++i)
+        ASSERT_EQ(dst[i], 0);
+    }
+  }
+}
+
+TEST(MemcpyTest, Large) {
+  const size_t kSize = 1 << 20;
+  std::vector<char> src(kSize + 3);
+  for (size_t i = 0; i < src.size(); ++i)
+    src[i] = static_cast<char>(i ^ (i >> 8));
+  std::vector<char> dst(kSize + 3);
+  __llvm_libc::memcpy(dst.data() + 1, src.data() + 3, kSize);
+  for (size_t i = 0; i < kSize; ++i)
+    ASSERT_EQ(dst[i + 1], src[i + 3]);
+}
@@ -0,0 +1,94 @@
+//===-------------------- Implementation of memmove ----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/string/memmove/memmove.h"
+
+#include "src/__support/common.h"
+#include "src/string/memory_utils/dispatch.h"
+#include "src/string/memory_utils/elements.h"
+
+namespace __llvm_libc {
+
+// Moves of more than 128 bytes, in 64-byte blocks, in the direction that
+// never overwrites source bytes before they are read. Going forward is safe
+// unless the destination starts inside the source.
+LLVM_LIBC_INLINE void move_aligned_blocks(char *dst, const char *src,
+                                          size_t count) {
+  if (reinterpret_cast<uintptr_t>(dst) - reinterpret_cast<uintptr_t>(src) >=
+      count)
+    move_forward_aligned_blocks<64>(dst, src, count);
+  else
+    move_backward_aligned_blocks<64>(dst, src, count);
+}
+
+static void move_large_baseline(char *dst, const char *src, size_t count) {
+  move_aligned_blocks(dst, src, count);
+}
+
+#if LLVM_LIBC_HAS_MEMORY_DISPATCH
+using MoveFn = void (*)(char *, const char *, size_t);
+
+LLVM_LIBC_TARGET_AVX2 static void move_large_avx2(char *dst, const char *src,
+                                                  size_t count) {
+  move_aligned_blocks(dst, src, count);
+}
+
+LLVM_LIBC_TARGET_AVX512 static void move_large_avx512(char *dst,
+                                                      const char *src,
+                                                      size_t count) {
+  move_aligned_blocks(dst, src, count);
+}
+
+static void move_large_resolver(char *dst, const char *src, size_t count);
+static MoveFn move_large_variant = move_large_resolver;
+
+static void move_large_resolver(char *dst, const char *src, size_t count) {
+  const MoveFn fn = select_variant<MoveFn>(move_large_baseline,
+                                           move_large_avx2, move_large_avx512);
+  store_variant(&move_large_variant, fn);
+  fn(dst, src, count);
+}
+
+static inline void move_large(char *dst, const char *src, size_t count) {
+  load_variant(&move_large_variant)(dst, src, count);
+}
+#else
+static inline void move_large(char *dst, const char *src, size_t count) {
+  move_large_baseline(dst, src, count);
+}
+#endif
+
+// Up to 128 bytes, all the loads happen before the stores, so the direction
+// doesn't matter.
+static inline void inline_memmove(char *dst, const char *src, size_t count) {
+  if (count == 0)
+    return;
+  if (count == 1)
+    return copy<1>(dst, src);
+  if (count <= 4)
+    return move_overlap<2>(dst, src, count);
+  if (count <= 8)
+    return move_overlap<4>(dst, src, count);
+  if (count <= 16)
+    return move_overlap<8>(dst, src, count);
+  if (count <= 32)
+    return move_overlap<16>(dst, src, count);
+  if (count <= 64)
+    return move_overlap<32>(dst, src, count);
+  if (count <= 128)
+    return move_overlap<64>(dst, src, count);
+  return move_large(dst, src, count);
+}
+
+void *LLVM_LIBC_ENTRYPOINT(memmove)(void *dst, const void *src, size_t count) {
+  inline_memmove(reinterpret_cast<char *>(dst),
+                 reinterpret_cast<const char *>(src), count);
+  return dst;
+}
+
+} // namespace __llvm_libc
@@ -0,0 +1,50 @@
+//===----------------------- Unittests for memmove ------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "src/string/memmove/memmove.h"
+#include "gtest/gtest.h"
+
+// Moves within one buffer, with the destination before, on and after the
+// source, for every size class.
+TEST(MemmoveTest, Overlapping) {
+  const size_t kMaxSize = 300;
+  const size_t kBuffer = 3 * kMaxSize;
+  std::vector<char> buffer(kBuffer), expected(kBuffer);
+  for (size_t size = 0; size <= kMaxSize; ++size) {
+    for (ptrdiff_t distance : {-130, -65, -64, -17, -1, 0, 1, 3, 16, 63, 64,
+                               129}) {
+      for (size_t i = 0; i < kBuffer; ++i)
+        buffer[i] = expected[i] = static_cast<char>(i * 13 + 5);
+      const size_t from = kMaxSize;
+      const size_t to = from + distance;
+      // The reference result, copied through a temporary.
+      std::vector<char> moved(expected.begin() + from,
+                              expected.begin() + from + size);
+      std::copy(moved.begin(), moved.end(), expected.begin() + to);
+
+      ASSERT_EQ(__llvm_libc::memmove(buffer.data() + to, buffer.data() + from,
+                                     size),
+                buffer.data() + to);
+      ASSERT_EQ(buffer, expected)
+          << "size " << size << ", distance " << distance;
+    }
+  }
+}
+
+TEST(MemmoveTest, Disjoint) {
+  std::vector<char> src(1000), dst(1000, 0);
+  for (size_t i = 0; i < src.size(); ++i)
+    src[i] = static_cast<char>(i);
+  __llvm_libc::memmove(dst.data() + 5, src.data() + 1, 900);
+  for (size_t i = 0; i < 900; ++i)
+    ASSERT_EQ(dst[i + 5], src[i + 1]);
+  ASSERT_EQ(dst[4], 0);
+  ASSERT_EQ(dst[905], 0);
+}
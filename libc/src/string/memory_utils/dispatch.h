@@ -0,0 +1,92 @@
+//===---------------- Runtime selection of memory functions --------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// The loops handling large buffers are compiled once per vector width. Each
+// function keeps a pointer to its variant, which starts out pointing to a
+// resolver: on the first call, the resolver checks the CPU, stores the best
+// variant, and forwards the call. This is what an ifunc resolver does, but
+// it neither needs the dynamic loader nor runs before the program does.
+//
+// Buffers small enough to be handled without a loop never go through the
+// pointer; wider registers buy them little.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_SRC_STRING_MEMORY_UTILS_DISPATCH_H
+#define LLVM_LIBC_SRC_STRING_MEMORY_UTILS_DISPATCH_H
+
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+
+// The variants for 32 and 64-byte registers.
+#define LLVM_LIBC_HAS_MEMORY_DISPATCH 1
+#define LLVM_LIBC_TARGET_AVX2 __attribute__((__target__("avx2")))
+#define LLVM_LIBC_TARGET_AVX512 __attribute__((__target__("avx512f")))
+#else
+// Other targets only have the baseline variant: on AArch64 this uses the
+// 16-byte NEON registers every implementation has.
+#define LLVM_LIBC_HAS_MEMORY_DISPATCH 0
+#endif
+
+namespace __llvm_libc {
+
+#if LLVM_LIBC_HAS_MEMORY_DISPATCH
+
+// The widest vector registers the CPU has and the OS saves, in bytes.
+static inline unsigned vector_width() {
+  unsigned eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    return 16;
+  const bool osxsave = ecx & bit_OSXSAVE;
+  const bool avx = ecx & bit_AVX;
+  if (!osxsave || !avx)
+    return 16;
+  uint32_t xcr0_low, xcr0_high;
+  __asm__("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+  // The SSE and AVX state, then the AVX-512 opmask and upper ZMM state.
+  const bool ymm_enabled = (xcr0_low & 0x6) == 0x6;
+  const bool zmm_enabled = (xcr0_low & 0xe6) == 0xe6;
+  if (!ymm_enabled || !__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+    return 16;
+  if (zmm_enabled && (ebx & bit_AVX512F))
+    return 64;
+  if (ebx & bit_AVX2)
+    return 32;
+  return 16;
+}
+
+// Returns the variant for the vector width of the running CPU.
+template <typename Fn>
+static inline Fn select_variant(Fn baseline, Fn avx2, Fn avx512) {
+  switch (vector_width()) {
+  case 64:
+    return avx512;
+  case 32:
+    return avx2;
+  default:
+    return baseline;
+  }
+}
+
+// Threads racing through the resolver all store the same variant, so relaxed
+// accesses are enough.
+template <typename Fn> static inline Fn load_variant(Fn *variant) {
+  return __atomic_load_n(variant, __ATOMIC_RELAXED);
+}
+
+template <typename Fn> static inline void store_variant(Fn *variant, Fn fn) {
+  __atomic_store_n(variant, fn, __ATOMIC_RELAXED);
+}
+
+#endif // LLVM_LIBC_HAS_MEMORY_DISPATCH
+
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_SRC_STRING_MEMORY_UTILS_DISPATCH_H
@@ -0,0 +1,304 @@
+//===------------------- Building blocks of memory functions -------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// The memory functions are built from operations on blocks of a size known at
+// compile time, which the compiler lowers to single loads and stores of
+// registers that wide, or to a few narrower ones when the target has no such
+// registers. A buffer whose size is only known at run time is handled by two
+// blocks that overlap in the middle, or by a loop over blocks for larger
+// sizes, so no size needs a byte loop.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_SRC_STRING_MEMORY_UTILS_ELEMENTS_H
+#define LLVM_LIBC_SRC_STRING_MEMORY_UTILS_ELEMENTS_H
+
+#include "src/string/memory_utils/utils.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace __llvm_libc {
+
+// The type holding a block of kSize bytes. Blocks are never assumed to be
+// aligned, and may alias objects of any type.
+template <size_t kSize> struct BlockType {
+  static_assert(kSize >= 16 && is_power2(kSize), "unsupported block size");
+  typedef uint64_t type __attribute__((__vector_size__(kSize), __may_alias__,
+                                       __aligned__(1)));
+};
+template <> struct BlockType<1> { typedef uint8_t type; };
+template <> struct BlockType<2> {
+  typedef uint16_t type __attribute__((__may_alias__, __aligned__(1)));
+};
+template <> struct BlockType<4> {
+  typedef uint32_t type __attribute__((__may_alias__, __aligned__(1)));
+};
+template <> struct BlockType<8> {
+  typedef uint64_t type __attribute__((__may_alias__, __aligned__(1)));
+};
+
+template <size_t kSize> using Block = typename BlockType<kSize>::type;
+
+// The block at `ptr`. Blocks are only handled through references and local
+// variables, never passed by value, so the calling convention of vectors
+// wider than the baseline registers doesn't come into play.
+template <size_t kSize> LLVM_LIBC_INLINE Block<kSize> &block_at(char *ptr) {
+  return *reinterpret_cast<Block<kSize> *>(ptr);
+}
+
+template <size_t kSize>
+LLVM_LIBC_INLINE const Block<kSize> &block_at(const char *ptr) {
+  return *reinterpret_cast<const Block<kSize> *>(ptr);
+}
+
+// Copy
+
+// Copies kSize bytes.
+template <size_t kSize>
+LLVM_LIBC_INLINE void copy(char *__restrict dst, const char *__restrict src) {
+  block_at<kSize>(dst) = block_at<kSize>(src);
+}
+
+// Copies the last kSize bytes of a buffer of `count` bytes.
+template <size_t kSize>
+LLVM_LIBC_INLINE void copy_last(char *__restrict dst,
+                                const char *__restrict src, size_t count) {
+  copy<kSize>(dst + count - kSize, src + count - kSize);
+}
+
+// Copies kSize <= count <= 2 * kSize bytes.
+template <size_t kSize>
+LLVM_LIBC_INLINE void copy_overlap(char *__restrict dst,
+                                   const char *__restrict src, size_t count) {
+  copy<kSize>(dst, src);
+  copy_last<kSize>(dst, src, count);
+}
+
+// Copies count >= kSize bytes: a first unaligned block, then blocks aligned on
+// the destination, which avoids stores that straddle cache lines, and a last
+// unaligned block.
+template <size_t kSize>
+LLVM_LIBC_INLINE void copy_aligned_blocks(char *__restrict dst,
+                                          const char *__restrict src,
+                                          size_t count) {
+  copy<kSize>(dst, src);
+  for (size_t offset = offset_to_next_aligned<kSize>(dst + 1) + 1;
+       offset < count - kSize; offset += kSize)
+    copy<kSize>(dst + offset, src + offset);
+  copy_last<kSize>(dst, src, count);
+}
+
+// Move
+
+// Moves kSize <= count <= 2 * kSize bytes between buffers that may overlap.
+// Both blocks are loaded before either is stored.
+template <size_t kSize>
+LLVM_LIBC_INLINE void move_overlap(char *dst, const char *src, size_t count) {
+  const Block<kSize> head = block_at<kSize>(src);
+  const Block<kSize> tail = block_at<kSize>(src + count - kSize);
+  block_at<kSize>(dst) = head;
+  block_at<kSize>(dst + count - kSize) = tail;
+}
+
+// Moves count > kSize bytes to a destination before the source, front to
+// back. Each store only overwrites source bytes that were already loaded;
+// the first and last blocks are loaded up front as the aligned blocks may
+// overwrite them.
+template <size_t kSize>
+LLVM_LIBC_INLINE void move_forward_aligned_blocks(char *dst, const char *src,
+                                                  size_t count) {
+  const Block<kSize> head = block_at<kSize>(src);
+  const Block<kSize> tail = block_at<kSize>(src + count - kSize);
+  for (size_t offset = offset_to_next_aligned<kSize>(dst + 1) + 1;
+       offset < count - kSize; offset += kSize)
+    block_at<kSize>(dst + offset) = block_at<kSize>(src + offset);
+  block_at<kSize>(dst) = head;
+  block_at<kSize>(dst + count - kSize) = tail;
+}
+
+// Moves count > kSize bytes to a destination after the source, back to
+// front.
+template <size_t kSize>
+LLVM_LIBC_INLINE void move_backward_aligned_blocks(char *dst, const char *src,
+                                                   size_t count) {
+  const Block<kSize> head = block_at<kSize>(src);
+  const Block<kSize> tail = block_at<kSize>(src + count - kSize);
+  for (size_t end = count - offset_from_last_aligned<kSize>(dst + count - 1) -
+                    1;
+       end > kSize; end -= kSize)
+    block_at<kSize>(dst + end - kSize) = block_at<kSize>(src + end - kSize);
+  block_at<kSize>(dst + count - kSize) = tail;
+  block_at<kSize>(dst) = head;
+}
+
+// Set
+
+// Sets every byte of `block` to `value`. The block should fit in a register of
+// the target the caller is compiled for: compilers assemble wider vectors on
+// the stack.
+template <size_t kSize>
+LLVM_LIBC_INLINE void splat(uint8_t value, Block<kSize> &block) {
+  // Adding a scalar to a vector adds it to every lane.
+  block = Block<kSize>{} + value * 0x0101010101010101ULL;
+}
+
+// Sets kSize bytes to `value`.
+template <size_t kSize> LLVM_LIBC_INLINE void set(char *dst, uint8_t value) {
+  splat<kSize>(value, block_at<kSize>(dst));
+}
+
+// Sets kSize <= count <= 2 * kSize bytes to `value`, with stores of
+// kStoreSize bytes.
+template <size_t kSize, size_t kStoreSize = kSize>
+LLVM_LIBC_INLINE void set_overlap(char *dst, uint8_t value, size_t count) {
+  static_assert(kSize % kStoreSize == 0, "stores must tile the block");
+  Block<kStoreSize> block;
+  splat<kStoreSize>(value, block);
+  for (size_t offset = 0; offset < kSize; offset += kStoreSize) {
+    block_at<kStoreSize>(dst + offset) = block;
+    block_at<kStoreSize>(dst + count - kSize + offset) = block;
+  }
+}
+
+// Sets count >= kSize bytes to `value`, with stores aligned on the
+// destination between the first and last blocks.
+template <size_t kSize>
+LLVM_LIBC_INLINE void set_aligned_blocks(char *dst, uint8_t value,
+                                         size_t count) {
+  Block<kSize> block;
+  splat<kSize>(value, block);
+  block_at<kSize>(dst) = block;
+  for (size_t offset = offset_to_next_aligned<kSize>(dst + 1) + 1;
+       offset < count - kSize; offset += kSize)
+    block_at<kSize>(dst + offset) = block;
+  block_at<kSize>(dst + count - kSize) = block;
+}
+
+// Compare
+
+// Returns the bitwise OR of the 64-bit lanes of a block. Folding the halves of
+// the block together keeps the work in vector registers until one lane is
+// left.
+template <size_t kSize> struct Lanes {
+  static LLVM_LIBC_INLINE uint64_t reduce_or(const Block<kSize> &value) {
+    const char *halves = reinterpret_cast<const char *>(&value);
+    const Block<kSize / 2> folded = block_at<kSize / 2>(halves) |
+                                    block_at<kSize / 2>(halves + kSize / 2);
+    return Lanes<kSize / 2>::reduce_or(folded);
+  }
+};
+template <> struct Lanes<1> {
+  static LLVM_LIBC_INLINE uint64_t reduce_or(const Block<1> &value) {
+    return value;
+  }
+};
+template <> struct Lanes<2> {
+  static LLVM_LIBC_INLINE uint64_t reduce_or(const Block<2> &value) {
+    return value;
+  }
+};
+template <> struct Lanes<4> {
+  static LLVM_LIBC_INLINE uint64_t reduce_or(const Block<4> &value) {
+    return value;
+  }
+};
+template <> struct Lanes<8> {
+  static LLVM_LIBC_INLINE uint64_t reduce_or(const Block<8> &value) {
+    return value;
+  }
+};
+
+// Returns zero if and only if the kSize-byte blocks are equal.
+template <size_t kSize>
+LLVM_LIBC_INLINE uint64_t differ(const char *lhs, const char *rhs) {
+  const Block<kSize> difference = block_at<kSize>(lhs) ^ block_at<kSize>(rhs);
+  return Lanes<kSize>::reduce_or(difference);
+}
+
+// Same as `differ` for kSize <= count <= 2 * kSize bytes.
+template <size_t kSize>
+LLVM_LIBC_INLINE uint64_t differ_overlap(const char *lhs, const char *rhs,
+                                         size_t count) {
+  return differ<kSize>(lhs, rhs) |
+         differ<kSize>(lhs + count - kSize, rhs + count - kSize);
+}
+
+// Compares the kSize-byte blocks as memcmp does: loading them big-endian
+// orders them by their first differing byte.
+template <size_t kSize> struct Ordered;
+template <> struct Ordered<1> {
+  static LLVM_LIBC_INLINE int compare(const char *lhs, const char *rhs) {
+    return static_cast<int>(block_at<1>(lhs)) -
+           static_cast<int>(block_at<1>(rhs));
+  }
+};
+template <> struct Ordered<2> {
+  static LLVM_LIBC_INLINE int compare(const char *lhs, const char *rhs) {
+    return static_cast<int>(__builtin_bswap16(block_at<2>(lhs))) -
+           static_cast<int>(__builtin_bswap16(block_at<2>(rhs)));
+  }
+};
+template <> struct Ordered<4> {
+  static LLVM_LIBC_INLINE int compare(const char *lhs, const char *rhs) {
+    const uint32_t a = __builtin_bswap32(block_at<4>(lhs));
+    const uint32_t b = __builtin_bswap32(block_at<4>(rhs));
+    return a < b ? -1 : a != b;
+  }
+};
+template <> struct Ordered<8> {
+  static LLVM_LIBC_INLINE int compare(const char *lhs, const char *rhs) {
+    const uint64_t a = __builtin_bswap64(block_at<8>(lhs));
+    const uint64_t b = __builtin_bswap64(block_at<8>(rhs));
+    return a < b ? -1 : a != b;
+  }
+};
+template <size_t kSize> struct Ordered {
+  static LLVM_LIBC_INLINE int compare(const char *lhs, const char *rhs) {
+    if (!differ<kSize>(lhs, rhs))
+      return 0;
+    // Some 8-byte lane of the block differs.
+    for (size_t offset = 0;; offset += 8)
+      if (const int result = Ordered<8>::compare(lhs + offset, rhs + offset))
+        return result;
+  }
+};
+
+// Compares kSize <= count <= 2 * kSize bytes as memcmp does. When the first
+// blocks are equal, so is the part the last block shares with them.
+template <size_t kSize>
+LLVM_LIBC_INLINE int compare_overlap(const char *lhs, const char *rhs,
+                                     size_t count) {
+  if (const int result = Ordered<kSize>::compare(lhs, rhs))
+    return result;
+  return Ordered<kSize>::compare(lhs + count - kSize, rhs + count - kSize);
+}
+
+// Compares count >= kSize bytes as memcmp does, a block at a time.
+template <size_t kSize>
+LLVM_LIBC_INLINE int compare_blocks(const char *lhs, const char *rhs,
+                                    size_t count) {
+  for (size_t offset = 0; offset < count - kSize; offset += kSize)
+    if (differ<kSize>(lhs + offset, rhs + offset))
+      return Ordered<kSize>::compare(lhs + offset, rhs + offset);
+  return Ordered<kSize>::compare(lhs + count - kSize, rhs + count - kSize);
+}
+
+// Same as `differ` for count >= kSize bytes.
+template <size_t kSize>
+LLVM_LIBC_INLINE uint64_t differ_blocks(const char *lhs, const char *rhs,
+                                        size_t count) {
+  for (size_t offset = 0; offset < count - kSize; offset += kSize)
+    if (differ<kSize>(lhs + offset, rhs + offset))
+      return 1;
+  return differ<kSize>(lhs + count - kSize, rhs + count - kSize);
+}
+
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_SRC_STRING_MEMORY_UTILS_ELEMENTS_H
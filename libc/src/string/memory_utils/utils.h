@@ -0,0 +1,50 @@
+//===---------------------------- Memory utils ----------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_SRC_STRING_MEMORY_UTILS_UTILS_H
+#define LLVM_LIBC_SRC_STRING_MEMORY_UTILS_UTILS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The building blocks of the memory functions must be inlined into them: a
+// call would defeat the point, and the vector types they use are only
+// passed in registers with the target features of the caller.
+#define LLVM_LIBC_INLINE __attribute__((__always_inline__)) inline
+
+namespace __llvm_libc {
+
+// Returns whether `value` is zero or a power of two.
+static constexpr bool is_power2_or_zero(size_t value) {
+  return (value & (value - 1U)) == 0;
+}
+
+// Returns whether `value` is a power of two.
+static constexpr bool is_power2(size_t value) {
+  return value && is_power2_or_zero(value);
+}
+
+// Returns the number of bytes to add to `ptr` to make it a multiple of
+// `alignment`, which must be a power of two.
+template <size_t alignment>
+LLVM_LIBC_INLINE size_t offset_to_next_aligned(const void *ptr) {
+  static_assert(is_power2(alignment), "alignment must be a power of two");
+  return -reinterpret_cast<uintptr_t>(ptr) & (alignment - 1U);
+}
+
+// Returns the number of bytes to remove from `ptr` to make it a multiple of
+// `alignment`, which must be a power of two.
+template <size_t alignment>
+LLVM_LIBC_INLINE size_t offset_from_last_aligned(const void *ptr) {
+  static_assert(is_power2(alignment), "alignment must be a power of two");
+  return reinterpret_cast<uintptr_t>(ptr) & (alignment - 1U);
+}
+
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_SRC_STRING_MEMORY_UTILS_UTILS_H
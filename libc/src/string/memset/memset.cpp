@@ -0,0 +1,83 @@
+//===-------------------- Implementation of memset -----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/string/memset/memset.h"
+
+#include "src/__support/common.h"
+#include "src/string/memory_utils/dispatch.h"
+#include "src/string/memory_utils/elements.h"
+
+namespace __llvm_libc {
+
+// Sets more than 128 bytes, in blocks as wide as the vector registers of each
+// variant: the block holding `value` has to fit in one.
+static void set_large_baseline(char *dst, uint8_t value, size_t count) {
+  set_aligned_blocks<16>(dst, value, count);
+}
+
+#if LLVM_LIBC_HAS_MEMORY_DISPATCH
+using SetFn = void (*)(char *, uint8_t, size_t);
+
+LLVM_LIBC_TARGET_AVX2 static void set_large_avx2(char *dst, uint8_t value,
+                                                 size_t count) {
+  set_aligned_blocks<32>(dst, value, count);
+}
+
+LLVM_LIBC_TARGET_AVX512 static void set_large_avx512(char *dst, uint8_t value,
+                                                     size_t count) {
+  set_aligned_blocks<64>(dst, value, count);
+}
+
+static void set_large_resolver(char *dst, uint8_t value, size_t count);
+static SetFn set_large_variant = set_large_resolver;
+
+static void set_large_resolver(char *dst, uint8_t value, size_t count) {
+  const SetFn fn = select_variant<SetFn>(set_large_baseline, set_large_avx2,
+                                         set_large_avx512);
+  store_variant(&set_large_variant, fn);
+  fn(dst, value, count);
+}
+
+static inline void set_large(char *dst, uint8_t value, size_t count) {
+  load_variant(&set_large_variant)(dst, value, count);
+}
+#else
+static inline void set_large(char *dst, uint8_t value, size_t count) {
+  set_large_baseline(dst, value, count);
+}
+#endif
+
+static inline void inline_memset(char *dst, uint8_t value, size_t count) {
+  if (count == 0)
+    return;
+  if (count == 1)
+    return set<1>(dst, value);
+  if (count <= 4)
+    return set_overlap<2>(dst, value, count);
+  if (count <= 8)
+    return set_overlap<4>(dst, value, count);
+  if (count <= 16)
+    return set_overlap<8>(dst, value, count);
+  if (count <= 32)
+    return set_overlap<16>(dst, value, count);
+  // Wider sizes are stored 16 bytes at a time, the width of the baseline
+  // vector registers.
+  if (count <= 64)
+    return set_overlap<32, 16>(dst, value, count);
+  if (count <= 128)
+    return set_overlap<64, 16>(dst, value, count);
+  return set_large(dst, value, count);
+}
+
+void *LLVM_LIBC_ENTRYPOINT(memset)(void *dst, int value, size_t count) {
+  inline_memset(reinterpret_cast<char *>(dst), static_cast<uint8_t>(value),
+                count);
+  return dst;
+}
+
+} // namespace __llvm_libc
@@ -0,0 +1,40 @@
+//===----------------------- Unittests for memset -------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "src/string/memset/memset.h"
+#include "gtest/gtest.h"
+
+TEST(MemsetTest, SizesAndAlignments) {
+  const size_t kMaxSize = 400;
+  const size_t kMaxOffset = 64;
+  std::vector<char> dst(kMaxSize + 2 * kMaxOffset);
+  for (size_t size = 0; size <= kMaxSize; ++size) {
+    for (size_t offset : {size_t(0), size_t(1), size_t(9), size_t(33)}) {
+      std::fill(dst.begin(), dst.end(), 'x');
+      char *to = dst.data() + offset;
+      ASSERT_EQ(__llvm_libc::memset(to, 0x1a5, size), to);
+      for (size_t i = 0; i < dst.size(); ++i) {
+        // Only the low byte of the value is stored.
+        const char expected = i >= offset && i < offset + size ? '\xa5' : 'x';
+        ASSERT_EQ(dst[i], expected) << "size " << size << ", offset " << offset;
+      }
+    }
+  }
+}
+
+TEST(MemsetTest, Large) {
+  const size_t kSize = 1 << 20;
+  std::vector<char> dst(kSize + 2, 1);
+  __llvm_libc::memset(dst.data() + 1, 0, kSize);
+  ASSERT_EQ(dst[0], 1);
+  for (size_t i = 1; i <= kSize; ++i)
+    ASSERT_EQ(dst[i], 0);
+  ASSERT_EQ(dst[kSize + 1], 1);
+}
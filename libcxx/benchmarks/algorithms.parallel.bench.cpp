@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cstdint>
+#include <execution>
+#include <numeric>
+#include <vector>
+
+#include "CartesianBenchmarks.h"
+#include "GenerateInput.h"
+#include "benchmark/benchmark.h"
+
+// The parallel overloads are only available when libc++ is built with the
+// PSTL, or with a standard library that provides them.
+#if defined(_LIBCPP_HAS_PARALLEL_ALGORITHMS) || defined(__cpp_lib_execution)
+#define HAS_PARALLEL_ALGORITHMS
+#endif
+
+#ifdef HAS_PARALLEL_ALGORITHMS
+namespace {
+
+enum class Policy { Seq, Par, ParUnseq };
+struct AllPolicies : EnumValuesAsTuple<AllPolicies, Policy, 3> {
+  static constexpr const char* Names[] = {"seq", "par", "par_unseq"};
+};
+
+// Calls f with the execution policy object for P.
+template <class P, class F>
+void withPolicy(F f) {
+  if constexpr (P() == Policy::Seq)
+    f(std::execution::seq);
+  else if constexpr (P() == Policy::Par)
+    f(std::execution::par);
+  else
+    f(std::execution::par_unseq);
+}
+
+std::vector<uint32_t> generateValues(size_t N) {
+  std::vector<uint32_t> V(N);
+  std::generate(V.begin(), V.end(),
+                [] { return getRandomInteger<uint32_t>(); });
+  return V;
+}
+
+template <class P>
+struct ForEach {
+  size_t Quantity;
+
+  void run(benchmark::State& state) const {
+    std::vector<uint32_t> V = generateValues(Quantity);
+    for (auto _ : state) {
+      withPolicy<P>([&](auto&& Exec) {
+        std::for_each(Exec, V.begin(), V.end(), [](uint32_t& X) { X += 1; });
+      });
+      benchmark::DoNotOptimize(V.data());
+    }
+    state.SetItemsProcessed(state.iterations() * Quantity);
+  }
+
+  std::string name() const {
+    return "BM_ForEach" + P::name() + "_" + std::to_string(Quantity);
+  }
+};
+
+template <class P>
+struct TransformReduce {
+  size_t Quantity;
+
+  void run(benchmark::State& state) const {
+    std::vector<uint32_t> V = generateValues(Quantity);
+    for (auto _ : state) {
+      uint64_t Sum = 0;
+      withPolicy<P>([&](auto&& Exec) {
+        Sum = std::transform_reduce(Exec, V.begin(), V.end(), uint64_t(0),
+                                    std::plus<>(),
+                                    [](uint32_t X) { return uint64_t(X) * X; });
+      });
+      benchmark::DoNotOptimize(Sum);
+    }
+    state.SetItemsProcessed(state.iterations() * Quantity);
+  }
+
+  std::string name() const {
+    return "BM_TransformReduce" + P::name() + "_" + std::to_string(Quantity);
+  }
+};
+
+template <class P>
+struct Sort {
+  size_t Quantity;
+
+  void run(benchmark::State& state) const {
+    std::vector<uint32_t> Input = generateValues(Quantity);
+    std::vector<uint32_t> V(Quantity);
+    for (auto _ : state) {
+      state.PauseTiming();
+      std::copy(Input.begin(), Input.end(), V.begin());
+      state.ResumeTiming();
+      withPolicy<P>(
+          [&](auto&& Exec) { std::sort(Exec, V.begin(), V.end()); });
+      benchmark::DoNotOptimize(V.data());
+    }
+    state.SetItemsProcessed(state.iterations() * Quantity);
+  }
+
+  std::string name() const {
+    return "BM_Sort" + P::name() + "_" + std::to_string(Quantity);
+  }
+};
+
+} // namespace
+#endif // HAS_PARALLEL_ALGORITHMS
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+
+#ifdef HAS_PARALLEL_ALGORITHMS
+  const std::vector<size_t> Quantities = {1 << 10, 1 << 14, 1 << 18, 1 << 22};
+  makeCartesianProductBenchmark<ForEach, AllPolicies>(Quantities);
+  makeCartesianProductBenchmark<TransformReduce, AllPolicies>(Quantities);
+  makeCartesianProductBenchmark<Sort, AllPolicies>(Quantities);
+#endif
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -49,6 +49,35 @@ static void BM_StringFindMatch2(benchmark::State &state) {
 }
 BENCHMARK(BM_StringFindMatch2)->Range(1, MAX_STRING_LEN / 4);
 
+// Benchmark find_first_of when only the last character is in the set, for
+// sets of increasing size.
+static void BM_StringFindFirstOf(benchmark::State &state) {
+  std::string s1(MAX_STRING_LEN, '-');
+  s1.back() = '!';
+  std::string s2 = std::string(state.range(0) - 1, '*') + '!';
+  for (auto _ : state)
+    benchmark::DoNotOptimize(s1.find_first_of(s2));
+}
+BENCHMARK(BM_StringFindFirstOf)->Range(1, 64);
+
+static void BM_StringFindLastOf(benchmark::State &state) {
+  std::string s1(MAX_STRING_LEN, '-');
+  s1.front() = '!';
+  std::string s2 = std::string(state.range(0) - 1, '*') + '!';
+  for (auto _ : state)
+    benchmark::DoNotOptimize(s1.find_last_of(s2));
+}
+BENCHMARK(BM_StringFindLastOf)->Range(1, 64);
+
+static void BM_StringFindFirstNotOf(benchmark::State &state) {
+  std::string s1(MAX_STRING_LEN, '-');
+  s1.back() = '!';
+  std::string s2 = std::string(state.range(0) - 1, '*') + '-';
+  for (auto _ : state)
+    benchmark::DoNotOptimize(s1.find_first_not_of(s2));
+}
+BENCHMARK(BM_StringFindFirstNotOf)->Range(1, 64);
+
 static void BM_StringCtorDefault(benchmark::State &state) {
   for (auto _ : state) {
     std::string Default;
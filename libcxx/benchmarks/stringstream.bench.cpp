@@ -1,7 +1,14 @@
 #include "benchmark/benchmark.h"
 #include "test_macros.h"
 
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <sstream>
+#include <vector>
+
+#include "GenerateInput.h"
 
 TEST_NOINLINE double istream_numbers();
 
@@ -37,4 +44,112 @@ static void BM_Istream_numbers(benchmark::State &state) {
 }
 
 BENCHMARK(BM_Istream_numbers)->RangeMultiplier(2)->Range(1024, 4096);
+
+// Round-trip conversions of doubles spread over the whole exponent range,
+// through streams, the C library and <charconv>.
+static std::vector<double> makeDoubles() {
+  std::vector<double> V(1024);
+  for (double& D : V)
+    D = std::ldexp(getRandomInteger<uint64_t>() / 18446744073709551616.0,
+                   getRandomInteger<int>(-1000, 1000));
+  return V;
+}
+
+static void BM_Ostream_double(benchmark::State& state) {
+  std::vector<double> V = makeDoubles();
+  std::ostringstream S;
+  S.precision(17);
+  for (auto _ : state) {
+    for (double D : V) {
+      S.str(std::string());
+      S << D;
+      benchmark::DoNotOptimize(S);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * V.size());
+}
+BENCHMARK(BM_Ostream_double);
+
+static void BM_Snprintf_double(benchmark::State& state) {
+  std::vector<double> V = makeDoubles();
+  char Buf[64];
+  for (auto _ : state) {
+    for (double D : V) {
+      benchmark::DoNotOptimize(std::snprintf(Buf, sizeof(Buf), "%.17g", D));
+      benchmark::DoNotOptimize(Buf);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * V.size());
+}
+BENCHMARK(BM_Snprintf_double);
+
+static void BM_Istream_double(benchmark::State& state) {
+  std::vector<double> V = makeDoubles();
+  std::vector<std::string> Strings;
+  for (double D : V) {
+    std::ostringstream S;
+    S.precision(17);
+    S << D;
+    Strings.push_back(S.str());
+  }
+  for (auto _ : state) {
+    for (const std::string& Str : Strings) {
+      std::istringstream S(Str);
+      double D;
+      S >> D;
+      benchmark::DoNotOptimize(D);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * V.size());
+}
+BENCHMARK(BM_Istream_double);
+
+static void BM_Strtod_double(benchmark::State& state) {
+  std::vector<double> V = makeDoubles();
+  std::vector<std::string> Strings;
+  char Buf[64];
+  for (double D : V) {
+    std::snprintf(Buf, sizeof(Buf), "%.17g", D);
+    Strings.push_back(Buf);
+  }
+  for (auto _ : state) {
+    for (const std::string& Str : Strings)
+      benchmark::DoNotOptimize(std::strtod(Str.c_str(), nullptr));
+  }
+  state.SetItemsProcessed(state.iterations() * V.size());
+}
+BENCHMARK(BM_Strtod_double);
+
+#if defined(_LIBCPP_VERSION) || defined(__cpp_lib_to_chars)
+static void BM_ToChars_double(benchmark::State& state) {
+  std::vector<double> V = makeDoubles();
+  char Buf[64];
+  for (auto _ : state) {
+    for (double D : V) {
+      benchmark::DoNotOptimize(std::to_chars(Buf, Buf + sizeof(Buf), D));
+      benchmark::DoNotOptimize(Buf);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * V.size());
+}
+BENCHMARK(BM_ToChars_double);
+
+static void BM_FromChars_double(benchmark::State& state) {
+  std::vector<double> V = makeDoubles();
+  std::vector<std::string> Strings;
+  char Buf[64];
+  for (double D : V)
+    Strings.emplace_back(Buf, std::to_chars(Buf, Buf + sizeof(Buf), D).ptr);
+  for (auto _ : state) {
+    for (const std::string& Str : Strings) {
+      double D;
+      benchmark::DoNotOptimize(
+          std::from_chars(Str.data(), Str.data() + Str.size(), D));
+      benchmark::DoNotOptimize(D);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * V.size());
+}
+BENCHMARK(BM_FromChars_double);
+#endif
 BENCHMARK_MAIN();
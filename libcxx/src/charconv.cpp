@@ -6,9 +6,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "bit"
 #include "charconv"
+#include "cfloat"
+#include "locale"
+#include <stdlib.h>
 #include <string.h>
 
+#include "include/pow5_tables.h"
+
 _LIBCPP_BEGIN_NAMESPACE_STD
 
 namespace __itoa
@@ -157,4 +163,1002 @@ __u64toa(uint64_t value, char* buffer)
 
 }  // namespace __itoa
 
+#ifndef _LIBCPP_CXX03_LANG
+
+namespace __dtoa
+{
+
+template <class _Tp> struct __float_traits;
+
+template <>
+struct __float_traits<float>
+{
+    typedef uint32_t __bits_type;
+    static const int __mantissa_bits = 23;
+    static const int __exponent_bits = 8;
+    static const int __bias = 127;
+    // The powers of ten for which w * 10^q can fall exactly halfway between
+    // two values.
+    static const int __min_round_to_even = -17;
+    static const int __max_round_to_even = 10;
+};
+
+template <>
+struct __float_traits<double>
+{
+    typedef uint64_t __bits_type;
+    static const int __mantissa_bits = 52;
+    static const int __exponent_bits = 11;
+    static const int __bias = 1023;
+    static const int __min_round_to_even = -4;
+    static const int __max_round_to_even = 23;
+};
+
+// The IEEE fields of a floating-point value.
+struct __float_fields
+{
+    bool __negative;
+    uint64_t __mantissa;
+    uint32_t __exponent;
+    int __mantissa_bits;
+    int __bias;
+    bool __is_special;
+};
+
+template <class _Tp>
+static __float_fields
+__split(_Tp __value)
+{
+    typedef __float_traits<_Tp> _Traits;
+    typename _Traits::__bits_type __bits;
+    memcpy(&__bits, &__value, sizeof(__bits));
+    const uint32_t __max_exponent = (1u << _Traits::__exponent_bits) - 1;
+    __float_fields __f;
+    __f.__negative = (__bits >> (_Traits::__mantissa_bits +
+                                 _Traits::__exponent_bits)) != 0;
+    __f.__mantissa =
+        __bits & ((uint64_t(1) << _Traits::__mantissa_bits) - 1);
+    __f.__exponent = static_cast<uint32_t>(
+        (__bits >> _Traits::__mantissa_bits) & __max_exponent);
+    __f.__mantissa_bits = _Traits::__mantissa_bits;
+    __f.__bias = _Traits::__bias;
+    __f.__is_special = __f.__exponent == __max_exponent;
+    return __f;
+}
+
+// The binary significand and exponent of a finite value, so that it equals
+// __m * 2^__e.
+inline _LIBCPP_INLINE_VISIBILITY void
+__binary_value(const __float_fields& __f, uint64_t& __m, int32_t& __e)
+{
+    if (__f.__exponent == 0)
+    {
+        __m = __f.__mantissa;
+        __e = 1 - __f.__bias - __f.__mantissa_bits;
+    }
+    else
+    {
+        __m = (uint64_t(1) << __f.__mantissa_bits) | __f.__mantissa;
+        __e = static_cast<int32_t>(__f.__exponent) - __f.__bias -
+              __f.__mantissa_bits;
+    }
+}
+
+// ceil(log2(5^e)) for e > 0, and 1 for e == 0; valid for e <= 3528.
+inline _LIBCPP_INLINE_VISIBILITY int32_t
+__pow5bits(int32_t __e)
+{
+    return static_cast<int32_t>(
+        ((static_cast<uint32_t>(__e) * 1217359) >> 19) + 1);
+}
+
+// floor(log10(2^e)) for 0 <= e <= 1650.
+inline _LIBCPP_INLINE_VISIBILITY uint32_t
+__log10_pow2(int32_t __e)
+{
+    return (static_cast<uint32_t>(__e) * 78913) >> 18;
+}
+
+// floor(log10(5^e)) for 0 <= e <= 2620.
+inline _LIBCPP_INLINE_VISIBILITY uint32_t
+__log10_pow5(int32_t __e)
+{
+    return (static_cast<uint32_t>(__e) * 732923) >> 20;
+}
+
+inline _LIBCPP_INLINE_VISIBILITY bool
+__multiple_of_pow5(uint64_t __v, uint32_t __p)
+{
+    uint32_t __count = 0;
+    for (; __v % 5 == 0; __v /= 5)
+        ++__count;
+    return __count >= __p;
+}
+
+inline _LIBCPP_INLINE_VISIBILITY bool
+__multiple_of_pow2(uint64_t __v, uint32_t __p)
+{
+    return (__v & ((uint64_t(1) << __p) - 1)) == 0;
+}
+
+// The low half of __a * __b, storing the high half in *__high.
+inline _LIBCPP_INLINE_VISIBILITY uint64_t
+__umul128(uint64_t __a, uint64_t __b, uint64_t* __high)
+{
+#ifndef _LIBCPP_HAS_NO_INT128
+    const __uint128_t __p = static_cast<__uint128_t>(__a) * __b;
+    *__high = static_cast<uint64_t>(__p >> 64);
+    return static_cast<uint64_t>(__p);
+#else
+    const uint64_t __a_lo = static_cast<uint32_t>(__a);
+    const uint64_t __a_hi = __a >> 32;
+    const uint64_t __b_lo = static_cast<uint32_t>(__b);
+    const uint64_t __b_hi = __b >> 32;
+    const uint64_t __b00 = __a_lo * __b_lo;
+    const uint64_t __b01 = __a_lo * __b_hi;
+    const uint64_t __b10 = __a_hi * __b_lo;
+    const uint64_t __b11 = __a_hi * __b_hi;
+    const uint64_t __mid1 = __b10 + (__b00 >> 32);
+    const uint64_t __mid2 = __b01 + static_cast<uint32_t>(__mid1);
+    *__high = __b11 + (__mid1 >> 32) + (__mid2 >> 32);
+    return (__mid2 << 32) | static_cast<uint32_t>(__b00);
+#endif
+}
+
+// (__m * __mul) >> __j, where __mul is a {low, high} pair and
+// 64 < __j < 128.
+inline _LIBCPP_INLINE_VISIBILITY uint64_t
+__mul_shift(uint64_t __m, const uint64_t* __mul, int32_t __j)
+{
+#ifndef _LIBCPP_HAS_NO_INT128
+    const __uint128_t __low = static_cast<__uint128_t>(__m) * __mul[0];
+    const __uint128_t __high = static_cast<__uint128_t>(__m) * __mul[1];
+    return static_cast<uint64_t>(((__low >> 64) + __high) >> (__j - 64));
+#else
+    uint64_t __high1;
+    const uint64_t __low1 = __umul128(__m, __mul[1], &__high1);
+    uint64_t __high0;
+    (void)__umul128(__m, __mul[0], &__high0);
+    const uint64_t __sum = __high0 + __low1;
+    if (__sum < __high0)
+        ++__high1;
+    const int32_t __dist = __j - 64;
+    return (__high1 << (64 - __dist)) | (__sum >> __dist);
+#endif
+}
+
+// The shortest decimal __output * 10^__exponent that rounds back to a value.
+struct __decimal
+{
+    uint64_t __output;
+    int32_t __exponent;
+};
+
+// Ryu's shortest decimal for a finite, nonzero value.
+static __decimal
+__to_decimal(const __float_fields& __f)
+{
+    int32_t __e2;
+    uint64_t __m2;
+    __binary_value(__f, __m2, __e2);
+    // Work on 4 * m2 so the halfway points to the neighbours are integers.
+    __e2 -= 2;
+    const bool __accept_bounds = (__m2 & 1) == 0;
+    const uint64_t __mv = 4 * __m2;
+    const uint32_t __mm_shift = __f.__mantissa != 0 || __f.__exponent <= 1;
+
+    uint64_t __vr, __vp, __vm;
+    int32_t __e10;
+    bool __vm_trailing_zeros = false;
+    bool __vr_trailing_zeros = false;
+    if (__e2 >= 0)
+    {
+        // Keep one more digit than needed to round the result correctly.
+        const uint32_t __q = __log10_pow2(__e2) - (__e2 > 3);
+        __e10 = static_cast<int32_t>(__q);
+        const int32_t __k = 125 + __pow5bits(static_cast<int32_t>(__q)) - 1;
+        const int32_t __i = -__e2 + static_cast<int32_t>(__q) + __k;
+        const uint64_t* __mul = __double_pow5_inv_split[__q];
+        __vr = __mul_shift(__mv, __mul, __i);
+        __vp = __mul_shift(__mv + 2, __mul, __i);
+        __vm = __mul_shift(__mv - 1 - __mm_shift, __mul, __i);
+        if (__q <= 21)
+        {
+            // Only one of mp, mv and mm can be a multiple of 5.
+            if (__mv % 5 == 0)
+                __vr_trailing_zeros = __multiple_of_pow5(__mv, __q);
+            else if (__accept_bounds)
+                __vm_trailing_zeros =
+                    __multiple_of_pow5(__mv - 1 - __mm_shift, __q);
+            else
+                __vp -= __multiple_of_pow5(__mv + 2, __q);
+        }
+    }
+    else
+    {
+        const uint32_t __q = __log10_pow5(-__e2) - (-__e2 > 1);
+        __e10 = static_cast<int32_t>(__q) + __e2;
+        const int32_t __i = -__e2 - static_cast<int32_t>(__q);
+        const int32_t __k = __pow5bits(__i) - 125;
+        const int32_t __j = static_cast<int32_t>(__q) - __k;
+        const uint64_t* __mul = __double_pow5_split[__i];
+        __vr = __mul_shift(__mv, __mul, __j);
+        __vp = __mul_shift(__mv + 2, __mul, __j);
+        __vm = __mul_shift(__mv - 1 - __mm_shift, __mul, __j);
+        if (__q <= 1)
+        {
+            // mv = 4 * m2 has at least two trailing zero bits.
+            __vr_trailing_zeros = true;
+            if (__accept_bounds)
+                __vm_trailing_zeros = __mm_shift == 1;
+            else
+                --__vp;
+        }
+        else if (__q < 63)
+            __vr_trailing_zeros = __multiple_of_pow2(__mv, __q);
+    }
+
+    // Drop digits while the interval still holds more than one candidate.
+    int32_t __removed = 0;
+    uint8_t __last_removed_digit = 0;
+    uint64_t __output;
+    if (__vm_trailing_zeros || __vr_trailing_zeros)
+    {
+        for (; __vp / 10 > __vm / 10; ++__removed)
+        {
+            __vm_trailing_zeros &= __vm % 10 == 0;
+            __vr_trailing_zeros &= __last_removed_digit == 0;
+            __last_removed_digit = static_cast<uint8_t>(__vr % 10);
+            __vr /= 10;
+            __vp /= 10;
+            __vm /= 10;
+        }
+        if (__vm_trailing_zeros)
+        {
+            for (; __vm % 10 == 0; ++__removed)
+            {
+                __vr_trailing_zeros &= __last_removed_digit == 0;
+                __last_removed_digit = static_cast<uint8_t>(__vr % 10);
+                __vr /= 10;
+                __vp /= 10;
+                __vm /= 10;
+            }
+        }
+        // Round exact halves to even.
+        if (__vr_trailing_zeros && __last_removed_digit == 5 && __vr % 2 == 0)
+            __last_removed_digit = 4;
+        __output = __vr + ((__vr == __vm &&
+                            (!__accept_bounds || !__vm_trailing_zeros)) ||
+                           __last_removed_digit >= 5);
+    }
+    else
+    {
+        // The common case: no bound is exact, so only the last digit counts.
+        bool __round_up = false;
+        if (__vp / 100 > __vm / 100)
+        {
+            __round_up = __vr % 100 >= 50;
+            __vr /= 100;
+            __vp /= 100;
+            __vm /= 100;
+            __removed += 2;
+        }
+        for (; __vp / 10 > __vm / 10; ++__removed)
+        {
+            __round_up = __vr % 10 >= 5;
+            __vr /= 10;
+            __vp /= 10;
+            __vm /= 10;
+        }
+        __output = __vr + (__vr == __vm || __round_up);
+    }
+
+    __decimal __d;
+    __d.__output = __output;
+    __d.__exponent = __e10 + __removed;
+    return __d;
+}
+
+static to_chars_result
+__too_large(char* __last)
+{
+    return {__last, errc::value_too_large};
+}
+
+static to_chars_result
+__write_string(char* __first, char* __last, const char* __s, size_t __n)
+{
+    if (static_cast<size_t>(__last - __first) < __n)
+        return __too_large(__last);
+    memcpy(__first, __s, __n);
+    return {__first + __n, errc(0)};
+}
+
+static to_chars_result
+__write_special(char* __first, char* __last, const __float_fields& __f)
+{
+    if (__f.__mantissa != 0)
+        return __f.__negative ? __write_string(__first, __last, "-nan", 4)
+                              : __write_string(__first, __last, "nan", 3);
+    return __f.__negative ? __write_string(__first, __last, "-inf", 4)
+                          : __write_string(__first, __last, "inf", 3);
+}
+
+// Writes the decimal digits of the integer __m * 2^__e, which has at most
+// 309 digits, and returns the end of the digits.
+static char*
+__write_integer(char* __buffer, uint64_t __m, int32_t __e)
+{
+    if (__e <= 0)
+        return __itoa::__u64toa(__m >> -__e, __buffer);
+
+    // Little-endian base 2^32 words of the value.
+    uint32_t __words[36] = {};
+    int __n = __e / 32;
+    const int __shift = __e % 32;
+    __words[__n++] = static_cast<uint32_t>(__m << __shift);
+    __words[__n++] = static_cast<uint32_t>((__m << __shift) >> 32);
+    if (__shift != 0)
+        __words[__n++] = static_cast<uint32_t>(__m >> (64 - __shift));
+
+    // Base 10^9 chunks, least significant first.
+    uint32_t __chunks[40];
+    int __nchunks = 0;
+    while (__n > 0)
+    {
+        uint64_t __rem = 0;
+        for (int __i = __n - 1; __i >= 0; --__i)
+        {
+            const uint64_t __cur = (__rem << 32) | __words[__i];
+            __words[__i] = static_cast<uint32_t>(__cur / 1000000000);
+            __rem = __cur % 1000000000;
+        }
+        __chunks[__nchunks++] = static_cast<uint32_t>(__rem);
+        while (__n > 0 && __words[__n - 1] == 0)
+            --__n;
+    }
+
+    __buffer = __itoa::__u32toa(__chunks[--__nchunks], __buffer);
+    while (__nchunks > 0)
+    {
+        uint32_t __chunk = __chunks[--__nchunks];
+        for (int __i = 8; __i >= 0; --__i)
+        {
+            __buffer[__i] = static_cast<char>('0' + __chunk % 10);
+            __chunk /= 10;
+        }
+        __buffer += 9;
+    }
+    return __buffer;
+}
+
+static char*
+__write_exponent(char* __p, char __marker, int32_t __exp, int __min_digits)
+{
+    *__p++ = __marker;
+    *__p++ = __exp < 0 ? '-' : '+';
+    const uint32_t __abs = static_cast<uint32_t>(__exp < 0 ? -__exp : __exp);
+    if (__min_digits == 2 && __abs < 10)
+        *__p++ = '0';
+    return __itoa::__u32toa(__abs, __p);
+}
+
+// Writes the shortest decimal representation.  __plain is set for the
+// overload without a format, which picks the shorter of fixed and scientific.
+static to_chars_result
+__write_shortest(char* __first, char* __last, const __float_fields& __f,
+                 chars_format __fmt, bool __plain)
+{
+    char __digits[24];
+    int __olength = 1;
+    int32_t __exp = 0;
+    __digits[0] = '0';
+    if (__f.__exponent != 0 || __f.__mantissa != 0)
+    {
+        const __decimal __d = __to_decimal(__f);
+        __olength = static_cast<int>(
+            __itoa::__u64toa(__d.__output, __digits) - __digits);
+        __exp = __d.__exponent;
+    }
+
+    const int32_t __sci_exp = __exp + __olength - 1;
+    const size_t __sci_length = __f.__negative + __olength +
+                                (__olength > 1) + 2 +
+                                (__sci_exp <= -100 || __sci_exp >= 100 ? 3 : 2);
+    size_t __fixed_length;
+    if (__exp >= 0)
+        __fixed_length = __f.__negative + __olength + __exp;
+    else if (-__exp < __olength)
+        __fixed_length = __f.__negative + __olength + 1;
+    else
+        __fixed_length = __f.__negative + 2 - __exp;
+
+    bool __use_fixed;
+    if (__plain)
+        __use_fixed = __fixed_length <= __sci_length;
+    else if (__fmt == chars_format::general)
+        // As %g with the default precision of 6.
+        __use_fixed = -4 <= __sci_exp && __sci_exp < 6;
+    else
+        __use_fixed = __fmt == chars_format::fixed;
+
+    if (!__use_fixed)
+    {
+        if (static_cast<size_t>(__last - __first) < __sci_length)
+            return __too_large(__last);
+        char* __p = __first;
+        if (__f.__negative)
+            *__p++ = '-';
+        *__p++ = __digits[0];
+        if (__olength > 1)
+        {
+            *__p++ = '.';
+            memcpy(__p, __digits + 1, __olength - 1);
+            __p += __olength - 1;
+        }
+        return {__write_exponent(__p, 'e', __sci_exp, 2), errc(0)};
+    }
+
+    if (__exp > 0)
+    {
+        // The digits past the shortest ones are those of the exact value,
+        // as for printf("%.0f").
+        uint64_t __m;
+        int32_t __e;
+        __binary_value(__f, __m, __e);
+        char __buffer[320];
+        char* __p = __buffer;
+        if (__f.__negative)
+            *__p++ = '-';
+        __p = __write_integer(__p, __m, __e);
+        return __write_string(__first, __last, __buffer, __p - __buffer);
+    }
+
+    if (static_cast<size_t>(__last - __first) < __fixed_length)
+        return __too_large(__last);
+    char* __p = __first;
+    if (__f.__negative)
+        *__p++ = '-';
+    if (__exp == 0)
+    {
+        memcpy(__p, __digits, __olength);
+        __p += __olength;
+    }
+    else if (-__exp < __olength)
+    {
+        const int __int_length = __olength + __exp;
+        memcpy(__p, __digits, __int_length);
+        __p += __int_length;
+        *__p++ = '.';
+        memcpy(__p, __digits + __int_length, -__exp);
+        __p += -__exp;
+    }
+    else
+    {
+        *__p++ = '0';
+        *__p++ = '.';
+        memset(__p, '0', -__exp - __olength);
+        __p += -__exp - __olength;
+        memcpy(__p, __digits, __olength);
+        __p += __olength;
+    }
+    return {__p, errc(0)};
+}
+
+// Writes the shortest hexadecimal representation, as %a without the "0x".
+static to_chars_result
+__write_shortest_hex(char* __first, char* __last, const __float_fields& __f)
+{
+    // Align the fraction to whole hex digits.
+    const int __hex_digits = (__f.__mantissa_bits + 3) / 4;
+    uint64_t __fraction =
+        __f.__mantissa << (__hex_digits * 4 - __f.__mantissa_bits);
+    int32_t __exp;
+    char __lead;
+    if (__f.__exponent == 0)
+    {
+        __lead = '0';
+        __exp = __f.__mantissa == 0 ? 0 : 1 - __f.__bias;
+    }
+    else
+    {
+        __lead = '1';
+        __exp = static_cast<int32_t>(__f.__exponent) - __f.__bias;
+    }
+
+    char __buffer[32];
+    char* __p = __buffer;
+    if (__f.__negative)
+        *__p++ = '-';
+    *__p++ = __lead;
+    if (__fraction != 0)
+    {
+        int __n = __hex_digits;
+        for (; (__fraction & 0xf) == 0; __fraction >>= 4)
+            --__n;
+        *__p++ = '.';
+        for (int __i = __n - 1; __i >= 0; --__i)
+        {
+            __p[__i] = "0123456789abcdef"[__fraction & 0xf];
+            __fraction >>= 4;
+        }
+        __p += __n;
+    }
+    __p = __write_exponent(__p, 'p', __exp, 1);
+    return __write_string(__first, __last, __buffer, __p - __buffer);
+}
+
+template <class _Tp>
+static to_chars_result
+__to_chars_shortest(char* __first, char* __last, _Tp __value,
+                    chars_format __fmt, bool __plain)
+{
+    const __float_fields __f = __split(__value);
+    if (__f.__is_special)
+        return __write_special(__first, __last, __f);
+    if (__fmt == chars_format::hex)
+        return __write_shortest_hex(__first, __last, __f);
+    return __write_shortest(__first, __last, __f, __fmt, __plain);
+}
+
+// The overloads with a precision format as printf does, which already rounds
+// correctly for every precision.
+template <class _Tp>
+static to_chars_result
+__to_chars_precision(char* __first, char* __last, _Tp __value,
+                     chars_format __fmt, int __precision)
+{
+    const __float_fields __f = __split(__value);
+    if (__f.__is_special)
+        return __write_special(__first, __last, __f);
+    if (__precision < 0)
+        __precision = 6;
+
+    const char* __format;
+    switch (__fmt)
+    {
+    case chars_format::scientific: __format = "%.*e"; break;
+    case chars_format::fixed:      __format = "%.*f"; break;
+    case chars_format::hex:        __format = "%.*a"; break;
+    default:                       __format = "%.*g"; break;
+    }
+
+    const double __d = __value;
+    char __buffer[512];
+    char* __s = __buffer;
+    int __n = __libcpp_snprintf_l(__buffer, sizeof(__buffer),
+                                  _LIBCPP_GET_C_LOCALE, __format, __precision,
+                                  __d);
+    if (__n < 0)
+        return __too_large(__last);
+    if (static_cast<size_t>(__n) >= sizeof(__buffer))
+    {
+        __s = static_cast<char*>(malloc(__n + 1));
+        if (__s == nullptr)
+            return __too_large(__last);
+        __libcpp_snprintf_l(__s, __n + 1, _LIBCPP_GET_C_LOCALE, __format,
+                            __precision, __d);
+    }
+
+    // to_chars writes hex without the "0x" prefix.
+    size_t __length = static_cast<size_t>(__n);
+    if (__fmt == chars_format::hex)
+    {
+        const size_t __sign = *__s == '-';
+        memmove(__s + __sign, __s + __sign + 2, __length - __sign - 2);
+        __length -= 2;
+    }
+    const to_chars_result __result =
+        __write_string(__first, __last, __s, __length);
+    if (__s != __buffer)
+        free(__s);
+    return __result;
+}
+
+}  // namespace __dtoa
+
+namespace __dtoa
+{
+
+inline _LIBCPP_INLINE_VISIBILITY char
+__to_lower(char __c)
+{
+    return 'A' <= __c && __c <= 'Z' ? static_cast<char>(__c - 'A' + 'a') : __c;
+}
+
+static bool
+__starts_with(const char* __first, const char* __last, const char* __s)
+{
+    for (; *__s != '\0'; ++__first, ++__s)
+        if (__first == __last || __to_lower(*__first) != *__s)
+            return false;
+    return true;
+}
+
+inline _LIBCPP_INLINE_VISIBILITY int
+__digit_value(char __c, bool __hex)
+{
+    if ('0' <= __c && __c <= '9')
+        return __c - '0';
+    if (__hex)
+    {
+        const char __l = __to_lower(__c);
+        if ('a' <= __l && __l <= 'f')
+            return __l - 'a' + 10;
+    }
+    return -1;
+}
+
+template <class _Tp> struct __exact_powers;
+
+// Powers of ten, and the largest significand, that the format represents
+// exactly.
+template <>
+struct __exact_powers<float>
+{
+    static const int __max_exponent = 10;
+    static const uint64_t __max_significand = uint64_t(1) << 24;
+    static float __pow10(int __i)
+    {
+        static const float __table[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f,
+                                        1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+        return __table[__i];
+    }
+};
+
+template <>
+struct __exact_powers<double>
+{
+    static const int __max_exponent = 22;
+    static const uint64_t __max_significand = uint64_t(1) << 53;
+    static double __pow10(int __i)
+    {
+        static const double __table[] = {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+            1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+            1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        return __table[__i];
+    }
+};
+
+// Eisel-Lemire: the value nearest to __w * 10^__q, for a nonzero __w, as its
+// biased exponent and explicit mantissa bits.  Returns false in the rare
+// cases where the truncated product can't decide the rounding.
+template <class _Tp>
+static bool
+__eisel_lemire(uint64_t __w, long long __q, uint64_t& __mantissa,
+               int32_t& __exponent)
+{
+    typedef __float_traits<_Tp> _Traits;
+    const int __mb = _Traits::__mantissa_bits;
+    const int32_t __infinite = (1 << _Traits::__exponent_bits) - 1;
+    __mantissa = 0;
+    __exponent = 0;
+    if (__q < -342)
+        return true;
+    if (__q > 308)
+    {
+        __exponent = __infinite;
+        return true;
+    }
+
+    const int __lz = __libcpp_clz(static_cast<unsigned long long>(__w));
+    __w <<= __lz;
+    const uint64_t* __pow = __pow5_128[__q + 342];
+    uint64_t __high;
+    uint64_t __low = __umul128(__w, __pow[1], &__high);
+    const uint64_t __precision_mask = ~uint64_t(0) >> (__mb + 3);
+    if ((__high & __precision_mask) == __precision_mask)
+    {
+        // The bits past the ones kept might carry into them; refine with the
+        // low half of the power.
+        uint64_t __high2;
+        (void)__umul128(__w, __pow[0], &__high2);
+        __low += __high2;
+        if (__high2 > __low)
+            ++__high;
+    }
+    if (__low == ~uint64_t(0) && (__q < -27 || __q > 55))
+        return false;
+
+    const int __upper = static_cast<int>(__high >> 63);
+    const int __shift = __upper + 64 - __mb - 3;
+    uint64_t __m = __high >> __shift;
+    int32_t __e = static_cast<int32_t>(((217706 * __q) >> 16) + 63 + __upper -
+                                       __lz + _Traits::__bias);
+    if (__e <= 0)
+    {
+        // Subnormal, or zero.  Halfway cases can't occur this far from 10^0.
+        if (-__e + 1 >= 64)
+            return true;
+        __m >>= -__e + 1;
+        __m += __m & 1;
+        __m >>= 1;
+        __exponent = __m < (uint64_t(1) << __mb) ? 0 : 1;
+        __mantissa = __m & ((uint64_t(1) << __mb) - 1);
+        return true;
+    }
+    if (__low <= 1 && _Traits::__min_round_to_even <= __q &&
+        __q <= _Traits::__max_round_to_even && (__m & 3) == 1 &&
+        (__m << __shift) == __high)
+        __m &= ~uint64_t(1);  // Exactly halfway: round to even.
+    __m += __m & 1;
+    __m >>= 1;
+    if (__m >= (uint64_t(2) << __mb))
+    {
+        __m = uint64_t(1) << __mb;
+        ++__e;
+    }
+    if (__e >= __infinite)
+    {
+        __exponent = __infinite;
+        return true;
+    }
+    __exponent = __e;
+    __mantissa = __m & ((uint64_t(1) << __mb) - 1);
+    return true;
+}
+
+template <class _Tp>
+static from_chars_result
+__from_chars_floating(const char* __first, const char* __last, _Tp& __value,
+                      chars_format __fmt)
+{
+    const char* __p = __first;
+    const bool __negative = __p != __last && *__p == '-';
+    if (__negative)
+        ++__p;
+
+    if (__starts_with(__p, __last, "inf"))
+    {
+        __p += __starts_with(__p + 3, __last, "inity") ? 8 : 3;
+        __value = __negative ? -numeric_limits<_Tp>::infinity()
+                             : numeric_limits<_Tp>::infinity();
+        return {__p, errc(0)};
+    }
+    if (__starts_with(__p, __last, "nan"))
+    {
+        // Also consume an n-char-sequence in parentheses.
+        __p += 3;
+        if (__p != __last && *__p == '(')
+        {
+            const char* __q = __p + 1;
+            for (; __q != __last && (__digit_value(*__q, false) >= 0 ||
+                                     ('a' <= __to_lower(*__q) &&
+                                      __to_lower(*__q) <= 'z') ||
+                                     *__q == '_');
+                 ++__q)
+                ;
+            if (__q != __last && *__q == ')')
+                __p = __q + 1;
+        }
+        __value = __negative ? -numeric_limits<_Tp>::quiet_NaN()
+                             : numeric_limits<_Tp>::quiet_NaN();
+        return {__p, errc(0)};
+    }
+
+    // Collect the significant digits.  Past the limit, only whether any
+    // nonzero digit follows matters for rounding, so it is kept as a final
+    // sticky '1'.
+    const bool __hex = __fmt == chars_format::hex;
+    const int __max_digits = __hex ? 32 : 800;
+    const int __digit_bits = __hex ? 4 : 1;
+    char __digits[800 + 1];
+    int __ndigits = 0;
+    bool __sticky = false;
+    bool __any_digit = false;
+    long long __exp = 0;  // A power of 10, or of 2 for hex.
+
+    for (; __p != __last; ++__p)
+    {
+        const int __d = __digit_value(*__p, __hex);
+        if (__d < 0)
+            break;
+        __any_digit = true;
+        if (__ndigits == 0 && __d == 0)
+            continue;
+        if (__ndigits < __max_digits)
+            __digits[__ndigits++] = *__p;
+        else
+        {
+            __sticky |= __d != 0;
+            __exp += __digit_bits;
+        }
+    }
+    if (__p != __last && *__p == '.')
+    {
+        const char* __q = __p + 1;
+        for (; __q != __last; ++__q)
+        {
+            const int __d = __digit_value(*__q, __hex);
+            if (__d < 0)
+                break;
+            __any_digit = true;
+            if (__ndigits == 0 && __d == 0)
+                __exp -= __digit_bits;
+            else if (__ndigits < __max_digits)
+            {
+                __digits[__ndigits++] = *__q;
+                __exp -= __digit_bits;
+            }
+            else
+                __sticky |= __d != 0;
+        }
+        if (__any_digit)
+            __p = __q;
+    }
+    if (!__any_digit)
+        return {__first, errc::invalid_argument};
+
+    // The exponent is required for scientific, not allowed for fixed, and
+    // optional otherwise.
+    const char __marker = __hex ? 'p' : 'e';
+    bool __has_exponent = false;
+    if (__fmt != chars_format::fixed && __p != __last &&
+        __to_lower(*__p) == __marker)
+    {
+        const char* __q = __p + 1;
+        bool __exp_negative = false;
+        if (__q != __last && (*__q == '+' || *__q == '-'))
+            __exp_negative = *__q++ == '-';
+        if (__q != __last && __digit_value(*__q, false) >= 0)
+        {
+            long long __e = 0;
+            for (; __q != __last && __digit_value(*__q, false) >= 0; ++__q)
+                if (__e < 100000)
+                    __e = __e * 10 + (*__q - '0');
+            __exp += __exp_negative ? -__e : __e;
+            __has_exponent = true;
+            __p = __q;
+        }
+    }
+    if (__fmt == chars_format::scientific && !__has_exponent)
+        return {__first, errc::invalid_argument};
+
+    if (__ndigits == 0)
+    {
+        __value = __negative ? -_Tp(0) : _Tp(0);
+        return {__p, errc(0)};
+    }
+
+    if (!__hex)
+    {
+        // The value is within [w, w + 1] * 10^q.
+        const int __nw = __ndigits < 19 ? __ndigits : 19;
+        uint64_t __w = 0;
+        for (int __i = 0; __i < __nw; ++__i)
+            __w = __w * 10 + static_cast<uint64_t>(__digits[__i] - '0');
+        const long long __q = __exp + (__ndigits - __nw);
+        const bool __truncated = __sticky || __nw < __ndigits;
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+        // Clinger's fast path: when both the significand and the power of
+        // ten are exact, one correctly rounded operation gives the result.
+        typedef __exact_powers<_Tp> _Powers;
+        if (!__truncated && __w <= _Powers::__max_significand &&
+            -_Powers::__max_exponent <= __q && __q <= _Powers::__max_exponent)
+        {
+            _Tp __r = static_cast<_Tp>(__w);
+            if (__q < 0)
+                __r /= _Powers::__pow10(static_cast<int>(-__q));
+            else
+                __r *= _Powers::__pow10(static_cast<int>(__q));
+            __value = __negative ? -__r : __r;
+            return {__p, errc(0)};
+        }
+#endif
+
+        // Truncated digits still give the result when both ends of the
+        // interval round to the same value.
+        uint64_t __m, __m1;
+        int32_t __e, __e1;
+        if (__eisel_lemire<_Tp>(__w, __q, __m, __e) &&
+            (!__truncated ||
+             (__eisel_lemire<_Tp>(__w + 1, __q, __m1, __e1) && __m == __m1 &&
+              __e == __e1)))
+        {
+            typedef __float_traits<_Tp> _Traits;
+            if ((__m == 0 && __e == 0) ||
+                __e == (1 << _Traits::__exponent_bits) - 1)
+                return {__p, errc::result_out_of_range};
+            const typename _Traits::__bits_type __bits =
+                static_cast<typename _Traits::__bits_type>(
+                    __m | (static_cast<uint64_t>(__e) << _Traits::__mantissa_bits) |
+                    (static_cast<uint64_t>(__negative)
+                     << (_Traits::__mantissa_bits + _Traits::__exponent_bits)));
+            memcpy(&__value, &__bits, sizeof(__value));
+            return {__p, errc(0)};
+        }
+    }
+
+    // Otherwise hand the normalized digits to strtod, which rounds exactly.
+    if (__sticky)
+        __digits[__ndigits++] = '1';
+    if (__exp < -100000)
+        __exp = -100000;
+    else if (__exp > 100000)
+        __exp = 100000;
+    if (__sticky)
+        __exp -= __digit_bits;
+    char __buffer[2 + 800 + 1 + 2 + 16];
+    char* __b = __buffer;
+    if (__hex)
+    {
+        *__b++ = '0';
+        *__b++ = 'x';
+    }
+    memcpy(__b, __digits, __ndigits);
+    __b += __ndigits;
+    __b = __write_exponent(__b, __marker, static_cast<int32_t>(__exp), 1);
+    *__b = '\0';
+
+    const _Tp __r = __do_strtod<_Tp>(__buffer, nullptr);
+    if (__r == numeric_limits<_Tp>::infinity() || __r == 0)
+        return {__p, errc::result_out_of_range};
+    __value = __negative ? -__r : __r;
+    return {__p, errc(0)};
+}
+
+}  // namespace __dtoa
+
+to_chars_result
+to_chars(char* __first, char* __last, float __value)
+{
+    return __dtoa::__to_chars_shortest(__first, __last, __value,
+                                       chars_format::general, true);
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, double __value)
+{
+    return __dtoa::__to_chars_shortest(__first, __last, __value,
+                                       chars_format::general, true);
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, float __value, chars_format __fmt)
+{
+    return __dtoa::__to_chars_shortest(__first, __last, __value, __fmt,
+                                       false);
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, double __value, chars_format __fmt)
+{
+    return __dtoa::__to_chars_shortest(__first, __last, __value, __fmt,
+                                       false);
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, float __value, chars_format __fmt,
+         int __precision)
+{
+    return __dtoa::__to_chars_precision(__first, __last, __value, __fmt,
+                                        __precision);
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, double __value, chars_format __fmt,
+         int __precision)
+{
+    return __dtoa::__to_chars_precision(__first, __last, __value, __fmt,
+                                        __precision);
+}
+
+from_chars_result
+from_chars(const char* __first, const char* __last, float& __value,
+           chars_format __fmt)
+{
+    return __dtoa::__from_chars_floating(__first, __last, __value, __fmt);
+}
+
+from_chars_result
+from_chars(const char* __first, const char* __last, double& __value,
+           chars_format __fmt)
+{
+    return __dtoa::__from_chars_floating(__first, __last, __value, __fmt);
+}
+
+#endif  // _LIBCPP_CXX03_LANG
+
 _LIBCPP_END_NAMESPACE_STD
@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <algorithm>
+
+// sort and nth_element use a branchless block partition for arithmetic types
+// compared with their natural ordering. Check it against stable_sort on the
+// inputs its pattern detection special-cases.
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "test_macros.h"
+
+static_assert((std::__use_branchless_sort<std::__less<int>&, int*>::value), "");
+static_assert((std::__use_branchless_sort<std::greater<double>&, double*>::value), "");
+static_assert((!std::__use_branchless_sort<std::less<int> (&)(int, int), int*>::value), "");
+static_assert((!std::__use_branchless_sort<std::__less<int*>&, int**>::value), "");
+
+std::mt19937 randomness;
+
+enum Pattern {
+  Random,
+  Ascending,
+  Descending,
+  PipeOrgan,
+  AllEqual,
+  FewDistinct,
+  Sawtooth,
+  LastPattern
+};
+
+template <class T>
+std::vector<T> make_input(unsigned N, Pattern P) {
+  std::vector<T> V(N);
+  for (unsigned i = 0; i < N; ++i) {
+    switch (P) {
+    case Random:
+      V[i] = static_cast<T>(randomness() % 1000);
+      break;
+    case Ascending:
+      V[i] = static_cast<T>(i % 100);
+      std::sort(V.begin(), V.begin() + i + 1, std::less<int>());
+      break;
+    case Descending:
+      V[i] = static_cast<T>(N - i);
+      break;
+    case PipeOrgan:
+      V[i] = static_cast<T>(i < N / 2 ? i : N - i);
+      break;
+    case AllEqual:
+      V[i] = static_cast<T>(7);
+      break;
+    case FewDistinct:
+      V[i] = static_cast<T>(randomness() % 4);
+      break;
+    case Sawtooth:
+      V[i] = static_cast<T>(i % 64);
+      break;
+    default:
+      assert(false);
+    }
+  }
+  return V;
+}
+
+template <class T, class Compare>
+void test_one(unsigned N, Pattern P, Compare Comp) {
+  std::vector<T> Input = make_input<T>(N, P);
+  std::vector<T> Expected = Input;
+  std::stable_sort(Expected.begin(), Expected.end(), Comp);
+
+  std::vector<T> V = Input;
+  std::sort(V.begin(), V.end(), Comp);
+  assert(V == Expected);
+
+  const unsigned Nths[] = {0, 1, N / 4, N / 2, N - 2, N - 1};
+  for (unsigned k = 0; k < sizeof(Nths) / sizeof(Nths[0]); ++k) {
+    unsigned Nth = Nths[k];
+    if (Nth >= N)
+      continue;
+    V = Input;
+    std::nth_element(V.begin(), V.begin() + Nth, V.end(), Comp);
+    assert(V[Nth] == Expected[Nth]);
+    for (unsigned i = 0; i < Nth; ++i)
+      assert(!Comp(V[Nth], V[i]));
+    for (unsigned i = Nth + 1; i < N; ++i)
+      assert(!Comp(V[i], V[Nth]));
+  }
+}
+
+template <class T>
+void test_type() {
+  const unsigned Sizes[] = {0,   1,   2,   3,   5,   23,  24,  25,  64,
+                            65,  127, 128, 129, 130, 200, 257, 1000, 4099};
+  for (unsigned s = 0; s < sizeof(Sizes) / sizeof(Sizes[0]); ++s) {
+    for (int p = 0; p < LastPattern; ++p) {
+      test_one<T>(Sizes[s], Pattern(p), std::less<T>());
+      test_one<T>(Sizes[s], Pattern(p), std::greater<T>());
+    }
+  }
+
+  // The default ordering goes through __less.
+  std::vector<T> V = make_input<T>(5000, Random);
+  std::vector<T> Expected = V;
+  std::stable_sort(Expected.begin(), Expected.end());
+  std::sort(V.begin(), V.end());
+  assert(V == Expected);
+}
+
+int main(int, char**) {
+  test_type<int>();
+  test_type<unsigned char>();
+  test_type<long long>();
+  test_type<double>();
+  test_type<float>();
+
+  return 0;
+}
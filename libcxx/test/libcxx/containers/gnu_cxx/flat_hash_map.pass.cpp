@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+
+#include <ext/flat_hash_map>
+#include <cassert>
+#include <memory>
+#include <string>
+
+#include "test_macros.h"
+#include "count_new.h"
+
+void test_default_does_not_allocate() {
+  DisableAllocationGuard g;
+  ((void)g);
+  __gnu_cxx::flat_hash_map<int, int> h;
+  assert(h.bucket_count() == 0);
+  assert(h.find(1) == h.end());
+}
+
+void test_access() {
+  __gnu_cxx::flat_hash_map<int, std::string> m;
+  for (int i = 0; i < 1000; ++i)
+    m[i] = std::to_string(i);
+  assert(m.size() == 1000);
+  for (int i = 0; i < 1000; ++i)
+    assert(m.at(i) == std::to_string(i));
+  assert(!m.try_emplace(1, "x").second);
+  assert(m[1] == "1");
+  assert(!m.insert_or_assign(1, "one").second);
+  assert(m[1] == "one");
+  assert(m.insert({1000, "1000"}).second);
+  assert(m.emplace(1001, "1001").second);
+  assert(m.size() == 1002);
+  m.find(2)->second = "two";
+  assert(m.at(2) == "two");
+#ifndef TEST_HAS_NO_EXCEPTIONS
+  try {
+    m.at(-1);
+    assert(false);
+  } catch (const std::out_of_range&) {
+  }
+#endif
+}
+
+void test_move_only_values_survive_rehash() {
+  // Growing moves the elements, including their keys.
+  __gnu_cxx::flat_hash_map<std::string, std::unique_ptr<int> > m;
+  for (int i = 0; i < 100; ++i)
+    m.try_emplace(std::to_string(i), new int(i));
+  for (int i = 0; i < 100; ++i)
+    assert(*m.at(std::to_string(i)) == i);
+  assert(m.erase("7") == 1);
+  assert(!m.contains("7"));
+  auto n = std::move(m);
+  assert(n.size() == 99);
+  assert(m.empty());
+  assert(*n.at("8") == 8);
+}
+
+int main(int, char**) {
+  test_default_does_not_allocate();
+  test_access();
+  test_move_only_values_survive_rehash();
+  return 0;
+}
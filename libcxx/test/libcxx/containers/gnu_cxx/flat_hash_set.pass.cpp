@@ -0,0 +1,126 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+
+#include <ext/flat_hash_set>
+#include <cassert>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "test_macros.h"
+#include "count_new.h"
+
+void test_default_does_not_allocate() {
+  DisableAllocationGuard g;
+  ((void)g);
+  __gnu_cxx::flat_hash_set<int> h;
+  assert(h.bucket_count() == 0);
+  assert(h.find(1) == h.end());
+  assert(h.begin() == h.end());
+}
+
+// All elements are identical in the low bits of their hash, which makes them
+// share control bytes and probe the same groups.
+struct CollidingHash {
+  size_t operator()(int x) const { return size_t(x) << 8; }
+};
+
+void test_insert_find_erase() {
+  __gnu_cxx::flat_hash_set<int, CollidingHash> h;
+  for (int i = 0; i < 1000; ++i)
+    assert(h.insert(i).second);
+  assert(h.size() == 1000);
+  assert(!h.insert(5).second);
+  assert(h.load_factor() <= h.max_load_factor());
+  for (int i = 0; i < 1000; ++i)
+    assert(h.count(i) == 1);
+  assert(h.count(1000) == 0);
+
+  // Erase every other element, then check the others are still found past
+  // the freed slots.
+  for (int i = 0; i < 1000; i += 2)
+    assert(h.erase(i) == 1);
+  assert(h.erase(0) == 0);
+  assert(h.size() == 500);
+  for (int i = 0; i < 1000; ++i)
+    assert(h.contains(i) == (i % 2 == 1));
+
+  size_t n = 0;
+  for (int x : h) {
+    assert(x % 2 == 1);
+    ++n;
+  }
+  assert(n == h.size());
+
+  // Reusing deleted slots must not grow the table.
+  size_t buckets = h.bucket_count();
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < 1000; i += 2)
+      assert(h.insert(i).second);
+    for (int i = 0; i < 1000; i += 2)
+      assert(h.erase(i) == 1);
+  }
+  assert(h.bucket_count() == buckets);
+  assert(h.size() == 500);
+}
+
+void test_erase_iterator() {
+  __gnu_cxx::flat_hash_set<int> h = {1, 2, 3, 4, 5};
+  size_t n = 0;
+  for (auto i = h.begin(); i != h.end();) {
+    i = h.erase(i);
+    ++n;
+  }
+  assert(n == 5);
+  assert(h.empty());
+}
+
+void test_move_only_and_rehash() {
+  __gnu_cxx::flat_hash_set<std::string> h;
+  h.reserve(100);
+  size_t buckets = h.bucket_count();
+  for (int i = 0; i < 100; ++i)
+    h.emplace(std::to_string(i));
+  assert(h.bucket_count() == buckets);
+  h.rehash(1000);
+  assert(h.bucket_count() >= 1000);
+  for (int i = 0; i < 100; ++i)
+    assert(h.contains(std::to_string(i)));
+  h.clear();
+  h.rehash(0);
+  assert(h.bucket_count() == 0);
+}
+
+void test_copy_move_swap() {
+  __gnu_cxx::flat_hash_set<std::string> a = {"a", "b", "c"};
+  __gnu_cxx::flat_hash_set<std::string> b(a);
+  assert(a == b);
+  b.insert("d");
+  assert(a != b);
+  __gnu_cxx::flat_hash_set<std::string> c(std::move(b));
+  assert(b.empty());
+  assert(c.size() == 4);
+  c = a;
+  assert(c == a);
+  swap(b, c);
+  assert(c.empty());
+  assert(b == a);
+  c = std::move(b);
+  assert(c == a);
+}
+
+int main(int, char**) {
+  test_default_does_not_allocate();
+  test_insert_find_erase();
+  test_erase_iterator();
+  test_move_only_and_rehash();
+  test_copy_move_swap();
+  return 0;
+}
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <string>
+
+// The find_*_of searches of strings using char_traits<char> look characters
+// up in a table of the set. Check them against a plain search, including
+// characters that are negative as char, and check that other traits still
+// compare through the traits.
+
+#include <string>
+#include <cassert>
+#include <cstddef>
+
+#include "test_macros.h"
+
+struct nocase_traits : std::char_traits<char> {
+  static char lower(char c) { return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c; }
+  static bool eq(char a, char b) { return lower(a) == lower(b); }
+  static const char* find(const char* s, std::size_t n, char a) {
+    for (; n != 0; --n, ++s)
+      if (eq(*s, a))
+        return s;
+    return 0;
+  }
+};
+
+static bool in(const std::string& set, char c) {
+  return set.find(c) != std::string::npos;
+}
+
+static void test(const std::string& s, const std::string& set) {
+  for (std::size_t pos = 0; pos <= s.size() + 1; ++pos) {
+    std::size_t first_of = std::string::npos;
+    std::size_t first_not_of = std::string::npos;
+    for (std::size_t i = pos; i < s.size(); ++i) {
+      if (first_of == std::string::npos && in(set, s[i]))
+        first_of = i;
+      if (first_not_of == std::string::npos && !in(set, s[i]))
+        first_not_of = i;
+    }
+    std::size_t last_of = std::string::npos;
+    std::size_t last_not_of = std::string::npos;
+    for (std::size_t i = 0; i < s.size() && i <= pos; ++i) {
+      if (in(set, s[i]))
+        last_of = i;
+      else
+        last_not_of = i;
+    }
+    assert(s.find_first_of(set, pos) == first_of);
+    assert(s.find_first_not_of(set, pos) == first_not_of);
+    assert(s.find_last_of(set, pos) == last_of);
+    assert(s.find_last_not_of(set, pos) == last_not_of);
+  }
+}
+
+int main(int, char**) {
+  std::string s;
+  for (int i = 0; i < 300; ++i)
+    s += static_cast<char>(i * 37 + 11);
+  test(s, "");
+  test(s, "a");
+  test(s, "abc");
+  test(s, std::string("\x80\xff\x7f", 3));
+  test(s, s.substr(0, 100));
+  test(s.substr(0, 20), s.substr(5, 4));
+  test(std::string(40, 'x'), "xyz");
+  test(std::string(40, 'x'), std::string(1, '\0') + "x\x80");
+
+  typedef std::basic_string<char, nocase_traits> nocase_string;
+  nocase_string n("the quick brown fox jumps over the lazy dog");
+  assert(n.find_first_of("QRS") == 4);
+  assert(n.find_last_of("XYZ") == 38);
+  assert(n.find_first_not_of("THE Q") == 5);
+  assert(n.find_last_not_of("DOG YZ") == 36);
+
+#if TEST_STD_VER > 14
+  {
+    constexpr std::string_view sv("abcdefghijklmnopqrstuvwxyz");
+    static_assert(sv.find_first_of("zyx") == 23, "");
+    static_assert(sv.find_last_of("abc") == 2, "");
+    static_assert(sv.find_first_not_of("abcd") == 4, "");
+    static_assert(sv.find_last_not_of("wxyz") == 21, "");
+  }
+#endif
+
+  return 0;
+}
@@ -0,0 +1,154 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+// UNSUPPORTED: !libc++ && c++11
+// UNSUPPORTED: !libc++ && c++14
+
+// XFAIL: with_system_cxx_lib=macosx10.15
+// XFAIL: with_system_cxx_lib=macosx10.14
+// XFAIL: with_system_cxx_lib=macosx10.13
+// XFAIL: with_system_cxx_lib=macosx10.12
+// XFAIL: with_system_cxx_lib=macosx10.11
+// XFAIL: with_system_cxx_lib=macosx10.10
+// XFAIL: with_system_cxx_lib=macosx10.9
+// XFAIL: with_system_cxx_lib=macosx10.8
+// XFAIL: with_system_cxx_lib=macosx10.7
+
+// <charconv>
+
+// from_chars_result from_chars(const char* first, const char* last,
+//                              float& value,
+//                              chars_format fmt = chars_format::general);
+// from_chars_result from_chars(const char* first, const char* last,
+//                              double& value,
+//                              chars_format fmt = chars_format::general);
+
+#include <charconv>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "test_macros.h"
+
+template <class T>
+void test(const char* s, T expected, size_t used,
+          std::chars_format fmt = std::chars_format::general)
+{
+    const char* last = s + std::strlen(s);
+    T x = 0;
+    std::from_chars_result r = std::from_chars(s, last, x, fmt);
+    assert(r.ec == std::errc{});
+    assert(r.ptr == s + used);
+    assert(x == expected);
+    assert(std::signbit(x) == std::signbit(expected));
+}
+
+template <class T>
+void test_error(const char* s, std::errc ec, size_t used,
+                std::chars_format fmt = std::chars_format::general)
+{
+    const char* last = s + std::strlen(s);
+    T x = T(42);
+    std::from_chars_result r = std::from_chars(s, last, x, fmt);
+    assert(r.ec == ec);
+    assert(r.ptr == s + used);
+    assert(x == T(42));
+}
+
+template <class T>
+void test_basics()
+{
+    test<T>("0", T(0), 1);
+    test<T>("-0", -T(0), 2);
+    test<T>("1", T(1), 1);
+    test<T>("-2.5", T(-2.5), 4);
+    test<T>("1.", T(1), 2);
+    test<T>(".5", T(0.5), 2);
+    test<T>("0.125e3", T(125), 7);
+    test<T>("125E-3", T(0.125), 6);
+    test<T>("000001.50000", T(1.5), 12);
+    test<T>("1.5x", T(1.5), 3);
+
+    // An incomplete exponent is not part of the number.
+    test<T>("1e", T(1), 1);
+    test<T>("1e+", T(1), 1);
+    test<T>("1.5e3", T(1.5), 3, std::chars_format::fixed);
+    test<T>("1.5e3", T(1500), 5, std::chars_format::scientific);
+
+    test<T>("1.8p3", T(12), 5, std::chars_format::hex);
+    test<T>("-A.8", T(-10.5), 4, std::chars_format::hex);
+    test<T>("0x1p3", T(0), 1, std::chars_format::hex);
+
+    test<T>("inf", std::numeric_limits<T>::infinity(), 3);
+    test<T>("-Infinity", -std::numeric_limits<T>::infinity(), 9);
+    test<T>("infinit", std::numeric_limits<T>::infinity(), 3);
+
+    const char* nans[] = {"nan", "NaN", "nan(123_abc)", "-nan"};
+    for (const char* s : nans)
+    {
+        T x = 0;
+        std::from_chars_result r = std::from_chars(s, s + std::strlen(s), x);
+        assert(r.ec == std::errc{});
+        assert(r.ptr == s + std::strlen(s));
+        assert(std::isnan(x));
+    }
+    const char* partial = "nan(1";
+    T x = 0;
+    assert(std::from_chars(partial, partial + 5, x).ptr == partial + 3);
+
+    test_error<T>("", std::errc::invalid_argument, 0);
+    test_error<T>("-", std::errc::invalid_argument, 0);
+    test_error<T>(".", std::errc::invalid_argument, 0);
+    test_error<T>("+1", std::errc::invalid_argument, 0);
+    test_error<T>(" 1", std::errc::invalid_argument, 0);
+    test_error<T>("e5", std::errc::invalid_argument, 0);
+    test_error<T>("1.5", std::errc::invalid_argument, 0,
+                  std::chars_format::scientific);
+    test_error<T>("1e999", std::errc::result_out_of_range, 5);
+    test_error<T>("-1e-999", std::errc::result_out_of_range, 7);
+}
+
+void test_double()
+{
+    test<double>("0.1", 0.1, 3);
+    test<double>("1.7976931348623157e308", 1.7976931348623157e308, 22);
+    test<double>("4.9406564584124654e-324", 4.9406564584124654e-324, 23);
+    test<double>("1234567890123456789012345678901234567890", 1.2345678901234568e39,
+                 40);
+    test<double>("9007199254740993", 9007199254740992.0, 16);
+    // Just above the halfway point between 2^53 and its successor.
+    test<double>("9007199254740993.00000000000000000000000000000000000001",
+                 9007199254740994.0, 55);
+    test<double>("0.000000000000000000000000000000000000001e39", 1.0, 44);
+    test<double>("1.fffffffffffffp1023", 1.7976931348623157e308, 20,
+                 std::chars_format::hex);
+    test_error<double>("2.4703282292062327e-324",
+                       std::errc::result_out_of_range, 23);
+}
+
+void test_float()
+{
+    test<float>("0.1", 0.1f, 3);
+    test<float>("3.4028235e38", 3.4028235e38f, 12);
+    test<float>("1e-45", 1e-45f, 5);
+    test<float>("16777217", 16777216.0f, 8);
+    test<float>("16777217.000001", 16777218.0f, 15);
+    test_error<float>("3.5e38", std::errc::result_out_of_range, 6);
+}
+
+int main(int, char**)
+{
+    test_basics<float>();
+    test_basics<double>();
+    test_double();
+    test_float();
+
+    return 0;
+}
@@ -0,0 +1,216 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+// UNSUPPORTED: !libc++ && c++11
+// UNSUPPORTED: !libc++ && c++14
+
+// XFAIL: with_system_cxx_lib=macosx10.15
+// XFAIL: with_system_cxx_lib=macosx10.14
+// XFAIL: with_system_cxx_lib=macosx10.13
+// XFAIL: with_system_cxx_lib=macosx10.12
+// XFAIL: with_system_cxx_lib=macosx10.11
+// XFAIL: with_system_cxx_lib=macosx10.10
+// XFAIL: with_system_cxx_lib=macosx10.9
+// XFAIL: with_system_cxx_lib=macosx10.8
+// XFAIL: with_system_cxx_lib=macosx10.7
+
+// <charconv>
+
+// to_chars_result to_chars(char* first, char* last, float value);
+// to_chars_result to_chars(char* first, char* last, double value);
+// to_chars_result to_chars(char* first, char* last, float value,
+//                          chars_format fmt);
+// to_chars_result to_chars(char* first, char* last, double value,
+//                          chars_format fmt);
+// to_chars_result to_chars(char* first, char* last, float value,
+//                          chars_format fmt, int precision);
+// to_chars_result to_chars(char* first, char* last, double value,
+//                          chars_format fmt, int precision);
+
+#include <charconv>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include "test_macros.h"
+
+template <class T>
+void test(T value, const char* expected)
+{
+    char buf[400];
+    std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), value);
+    assert(r.ec == std::errc{});
+    assert(std::string(buf, r.ptr) == expected);
+
+    // The output must fit exactly, and not at all in one byte less.
+    size_t len = std::strlen(expected);
+    r = std::to_chars(buf, buf + len, value);
+    assert(r.ec == std::errc{});
+    assert(r.ptr == buf + len);
+    r = std::to_chars(buf, buf + len - 1, value);
+    assert(r.ec == std::errc::value_too_large);
+    assert(r.ptr == buf + len - 1);
+}
+
+template <class T>
+void test(T value, std::chars_format fmt, const char* expected)
+{
+    char buf[400];
+    std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), value, fmt);
+    assert(r.ec == std::errc{});
+    assert(std::string(buf, r.ptr) == expected);
+
+    size_t len = std::strlen(expected);
+    r = std::to_chars(buf, buf + len - 1, value, fmt);
+    assert(r.ec == std::errc::value_too_large);
+    assert(r.ptr == buf + len - 1);
+}
+
+template <class T>
+void test(T value, std::chars_format fmt, int precision, const char* expected)
+{
+    char buf[400];
+    std::to_chars_result r =
+        std::to_chars(buf, buf + sizeof(buf), value, fmt, precision);
+    assert(r.ec == std::errc{});
+    assert(std::string(buf, r.ptr) == expected);
+
+    size_t len = std::strlen(expected);
+    r = std::to_chars(buf, buf + len, value, fmt, precision);
+    assert(r.ec == std::errc{});
+    assert(r.ptr == buf + len);
+    r = std::to_chars(buf, buf + len - 1, value, fmt, precision);
+    assert(r.ec == std::errc::value_too_large);
+    assert(r.ptr == buf + len - 1);
+}
+
+// Every value written in the shortest form reads back as itself.
+template <class T>
+void test_round_trip(T value)
+{
+    const std::chars_format formats[] = {
+        std::chars_format::scientific, std::chars_format::fixed,
+        std::chars_format::general, std::chars_format::hex};
+    for (std::chars_format fmt : formats)
+    {
+        char buf[400];
+        std::to_chars_result r =
+            std::to_chars(buf, buf + sizeof(buf), value, fmt);
+        assert(r.ec == std::errc{});
+        T x = 0;
+        std::from_chars_result f = std::from_chars(buf, r.ptr, x, fmt);
+        assert(f.ec == std::errc{});
+        assert(f.ptr == r.ptr);
+        assert(x == value);
+    }
+}
+
+void test_double()
+{
+    test(0.0, "0");
+    test(-0.0, "-0");
+    test(1.0, "1");
+    test(0.1, "0.1");
+    test(-2.5, "-2.5");
+    test(123456.0, "123456");
+    test(1e21, "1e+21");
+    test(1.5e-5, "1.5e-05");
+    test(0.3, "0.3");
+    test(5e-324, "5e-324");
+    test(1.7976931348623157e308, "1.7976931348623157e+308");
+    test(std::numeric_limits<double>::infinity(), "inf");
+    test(-std::numeric_limits<double>::infinity(), "-inf");
+
+    test(0.0, std::chars_format::scientific, "0e+00");
+    test(1.0, std::chars_format::scientific, "1e+00");
+    test(123456.0, std::chars_format::scientific, "1.23456e+05");
+    test(1e100, std::chars_format::scientific, "1e+100");
+    test(2.2250738585072014e-308, std::chars_format::scientific,
+         "2.2250738585072014e-308");
+
+    // Fixed prints the exact digits of integral values.
+    test(0.1, std::chars_format::fixed, "0.1");
+    test(1e-5, std::chars_format::fixed, "0.00001");
+    test(1e22, std::chars_format::fixed, "10000000000000000000000");
+    test(1e23, std::chars_format::fixed, "99999999999999991611392");
+    test(123.456, std::chars_format::fixed, "123.456");
+
+    // General switches to scientific as %g does.
+    test(123456.0, std::chars_format::general, "123456");
+    test(1234567.0, std::chars_format::general, "1.234567e+06");
+    test(0.0001, std::chars_format::general, "0.0001");
+    test(0.00001, std::chars_format::general, "1e-05");
+
+    test(0.0, std::chars_format::hex, "0p+0");
+    test(1.0, std::chars_format::hex, "1p+0");
+    test(-2.5, std::chars_format::hex, "-1.4p+1");
+    test(0.1, std::chars_format::hex, "1.999999999999ap-4");
+    test(5e-324, std::chars_format::hex, "0.0000000000001p-1022");
+
+    test(1.0, std::chars_format::fixed, 3, "1.000");
+    test(0.125, std::chars_format::fixed, 2, "0.12");
+    test(123456.0, std::chars_format::scientific, 2, "1.23e+05");
+    test(123456.0, std::chars_format::general, 3, "1.23e+05");
+    test(0.5, std::chars_format::general, 3, "0.5");
+    test(1.0, std::chars_format::hex, 2, "1.00p+0");
+    test(-1.5, std::chars_format::hex, 1, "-1.8p+0");
+    test(1e300, std::chars_format::fixed, 0,
+         "1000000000000000052504760255204420248704468581108159154915854115511"
+         "8024579889081957863713750804478640437044438328838781769425232353604"
+         "3057564479218478670698284838720092657580373783023379478809005936895"
+         "3234970799945081119038967640880074652742780142494579258788820056842"
+         "838115669472196386865459400540160");
+
+    const double values[] = {0.1, 1.0 / 3, 2.0 / 3, 1e-300, 1e300, 4.35,
+                             9007199254740993.0, 5e-324,
+                             std::numeric_limits<double>::max(),
+                             std::numeric_limits<double>::min()};
+    for (double v : values)
+    {
+        test_round_trip(v);
+        test_round_trip(-v);
+    }
+}
+
+void test_float()
+{
+    test(0.0f, "0");
+    test(1.0f, "1");
+    test(0.1f, "0.1");
+    test(16777216.0f, "16777216");
+    test(1e-45f, "1e-45");
+    test(3.4028235e38f, "3.4028235e+38");
+
+    test(0.1f, std::chars_format::scientific, "1e-01");
+    test(0.1f, std::chars_format::fixed, "0.1");
+    test(1e10f, std::chars_format::fixed, "10000000000");
+    test(1e10f, std::chars_format::general, "1e+10");
+    test(0.1f, std::chars_format::hex, "1.99999ap-4");
+    test(1.0f, std::chars_format::hex, "1p+0");
+
+    test(0.1f, std::chars_format::scientific, 8, "1.00000001e-01");
+
+    const float values[] = {0.1f, 1.0f / 3, 1e-30f, 1e30f, 1e-45f,
+                            std::numeric_limits<float>::max(),
+                            std::numeric_limits<float>::min()};
+    for (float v : values)
+    {
+        test_round_trip(v);
+        test_round_trip(-v);
+    }
+}
+
+int main(int, char**)
+{
+    test_double();
+    test_float();
+
+    return 0;
+}
@@ -57,6 +57,7 @@
 #include "llvm/Support/JamCRC.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/ScopedPrinter.h"
+#include <atomic>
 #include <memory>
 
 using namespace lld;
@@ -71,6 +72,7 @@ static ExitOnError exitOnErr;
 static Timer totalPdbLinkTimer("PDB Emission (Cumulative)", Timer::root());
 
 static Timer addObjectsTimer("Add Objects", totalPdbLinkTimer);
+static Timer typeHashingTimer("Type Hashing", addObjectsTimer);
 static Timer typeMergingTimer("Type Merging", addObjectsTimer);
 static Timer symbolMergingTimer("Symbol Merging", addObjectsTimer);
 static Timer globalsLayoutTimer("Globals Stream Layout", totalPdbLinkTimer);
@@ -104,6 +106,11 @@ public:
   /// Link info for each import file in the symbol table into the PDB.
   void addImportFilesToPDB(ArrayRef<OutputSection *> outputSections);
 
+  /// Compute global type hashes of object files without .debug$H sections
+  /// in parallel, so that mergeDebugT doesn't have to compute them one
+  /// object file at a time.
+  void computeGlobalTypeHashes();
+
   /// Link CodeView from a single object file into the target (output) PDB.
   /// When a precompiled headers object is linked, its TPI map might be provided
   /// externally.
@@ -184,6 +191,9 @@ private:
   /// far.
   std::map<uint32_t, CVIndexMap> precompTypeIndexMappings;
 
+  /// Global type hashes computed by computeGlobalTypeHashes().
+  DenseMap<ObjFile *, std::vector<GloballyHashedType>> globalTypeHashes;
+
   // For statistics
   uint64_t globalSymbols = 0;
   uint64_t moduleSymbols = 0;
@@ -323,13 +333,29 @@ static void addTypeInfo(pdb::TpiStreamBuilder &tpiBuilder,
   // Start the TPI or IPI stream header.
   tpiBuilder.setVersionHeader(pdb::PdbTpiV80);
 
-  // Flatten the in memory type table and hash each type.
-  typeTable.ForEachRecord([&](TypeIndex ti, const CVType &type) {
-    auto hash = pdb::hashTypeRecord(type);
-    if (auto e = hash.takeError())
-      fatal("type hashing error");
-    tpiBuilder.addTypeRecord(type.RecordData, *hash);
+  // Flatten the in memory type table.
+  std::vector<CVType> types;
+  typeTable.ForEachRecord(
+      [&](TypeIndex ti, const CVType &type) { types.push_back(type); });
+
+  // Hash each type. This is done in parallel because there are usually
+  // millions of types in a large program.
+  std::vector<uint32_t> hashes(types.size());
+  std::atomic<bool> failed(false);
+  parallelForEachN(0, types.size(), [&](size_t i) {
+    Expected<uint32_t> hash = pdb::hashTypeRecord(types[i]);
+    if (hash)
+      hashes[i] = *hash;
+    else {
+      consumeError(hash.takeError());
+      failed = true;
+    }
   });
+  if (failed)
+    fatal("type hashing error");
+
+  for (size_t i = 0, e = types.size(); i != e; ++i)
+    tpiBuilder.addTypeRecord(types[i].RecordData, hashes[i]);
 }
 
 Expected<const CVIndexMap &>
@@ -393,18 +419,23 @@ PDBLinker::mergeDebugT(ObjFile *file, CVIndexMap *objectIndexMap) {
   if (config->debugGHashes) {
     ArrayRef<GloballyHashedType> hashes;
     std::vector<GloballyHashedType> ownedHashes;
-    if (Optional<ArrayRef<uint8_t>> debugH = getDebugH(file))
+    auto it = globalTypeHashes.find(file);
+    if (it != globalTypeHashes.end())
+      ownedHashes = std::move(it->second);
+    else if (Optional<ArrayRef<uint8_t>> debugH = getDebugH(file))
       hashes = getHashesFromDebugH(*debugH);
-    else {
+    else
       ownedHashes = GloballyHashedType::hashTypes(types);
+    if (!ownedHashes.empty())
       hashes = ownedHashes;
-    }
 
     if (auto err = mergeTypeAndIdRecords(
             tMerger.globalIDTable, tMerger.globalTypeTable,
             objectIndexMap->tpiMap, types, hashes, file->pchSignature))
       fatal("codeview::mergeTypeAndIdRecords failed: " +
             toString(std::move(err)));
+    if (it != globalTypeHashes.end())
+      globalTypeHashes.erase(it);
   } else {
     if (auto err = mergeTypeAndIdRecords(tMerger.iDTable, tMerger.typeTable,
                                          objectIndexMap->tpiMap, types,
@@ -1277,11 +1308,36 @@ static PublicSym32 createPublic(Defined *def) {
 
 // Add all object files to the PDB. Merge .debug$T sections into IpiData and
 // TpiData.
+void PDBLinker::computeGlobalTypeHashes() {
+  ScopedTimer t(typeHashingTimer);
+
+  // Objects that use precompiled headers or type server PDBs are hashed
+  // when they are merged because their type streams depend on other files.
+  std::vector<ObjFile *> files;
+  for (ObjFile *file : ObjFile::instances)
+    if (file->debugTypesObj &&
+        (file->debugTypesObj->kind == TpiSource::Regular ||
+         file->debugTypesObj->kind == TpiSource::PCH) &&
+        !getDebugH(file))
+      files.push_back(file);
+
+  std::vector<std::vector<GloballyHashedType>> hashes(files.size());
+  parallelForEachN(0, files.size(), [&](size_t i) {
+    hashes[i] = GloballyHashedType::hashTypes(*files[i]->debugTypes);
+  });
+
+  for (size_t i = 0, e = files.size(); i != e; ++i)
+    globalTypeHashes[files[i]] = std::move(hashes[i]);
+}
+
 void PDBLinker::addObjectsToPDB() {
   ScopedTimer t1(addObjectsTimer);
 
   createModuleDBI(builder);
 
+  if (config->debugGHashes)
+    computeGlobalTypeHashes();
+
   for (ObjFile *file : ObjFile::instances)
     addObjFile(file);
 
@@ -7,16 +7,26 @@
 //===----------------------------------------------------------------------===//
 
 #include "lld/Common/Memory.h"
+#include <mutex>
 
 using namespace llvm;
 using namespace lld;
 
-BumpPtrAllocator lld::bAlloc;
-StringSaver lld::saver{bAlloc};
+ThreadLocalBumpPtrAllocator lld::bAlloc;
+static BumpPtrAllocator saverAlloc;
+StringSaver lld::saver{saverAlloc};
 std::vector<SpecificAllocBase *> lld::SpecificAllocBase::instances;
 
+SpecificAllocBase::SpecificAllocBase() {
+  // make<T> for different types may be called concurrently.
+  static std::mutex mu;
+  std::lock_guard<std::mutex> lock(mu);
+  instances.push_back(this);
+}
+
 void lld::freeArena() {
   for (SpecificAllocBase *alloc : SpecificAllocBase::instances)
     alloc->reset();
   bAlloc.Reset();
+  saverAlloc.Reset();
 }
@@ -17,6 +17,7 @@
 #include "llvm/Support/CachePruning.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/Threading.h"
 #include <atomic>
 #include <vector>
 
@@ -64,6 +65,9 @@ enum class ARMVFPArgKind { Default, Base, VFP, ToolChain };
 // For -z noseparate-code, -z separate-code and -z separate-loadable-segments.
 enum class SeparateSegmentKind { None, Code, Loadable };
 
+// For --compress-debug-sections.
+enum class DebugCompressionKind { None, Zlib, Zstd };
+
 struct SymbolVersion {
   llvm::StringRef name;
   bool isExternCpp;
@@ -86,6 +90,7 @@ struct Configuration {
   uint8_t osabi = 0;
   uint32_t andFeatures = 0;
   llvm::CachePruningPolicy thinLTOCachePolicy;
+  llvm::ThreadPoolStrategy thinLTOJobs;
   llvm::StringMap<uint64_t> sectionStartMap;
   llvm::StringRef chroot;
   llvm::StringRef dynamicLinker;
@@ -93,6 +98,7 @@ struct Configuration {
   llvm::StringRef entry;
   llvm::StringRef emulation;
   llvm::StringRef fini;
+  llvm::StringRef incrementalState;
   llvm::StringRef init;
   llvm::StringRef ltoAAPipeline;
   llvm::StringRef ltoCSProfileFile;
@@ -110,6 +116,7 @@ struct Configuration {
   llvm::StringRef sysroot;
   llvm::StringRef thinLTOCacheDir;
   llvm::StringRef thinLTOIndexOnlyArg;
+  llvm::StringRef timeTraceFile;
   std::pair<llvm::StringRef, llvm::StringRef> thinLTOObjectSuffixReplace;
   std::pair<llvm::StringRef, llvm::StringRef> thinLTOPrefixReplace;
   std::string rpath;
@@ -135,8 +142,8 @@ struct Configuration {
   bool bsymbolicFunctions;
   bool callGraphProfileSort;
   bool checkSections;
-  bool compressDebugSections;
   bool cref;
+  bool debugNames;
   bool defineCommon;
   bool demangle = true;
   bool dependentLibraries;
@@ -176,6 +183,7 @@ struct Configuration {
   bool pie;
   bool printGcSections;
   bool printIcfSections;
+  bool printIcfStats;
   bool relocatable;
   bool relrPackDynRelocs;
   bool saveTemps;
@@ -184,6 +192,7 @@ struct Configuration {
   bool isStatic = false;
   bool sysvHash = false;
   bool target1Rel;
+  bool timeTraceEnabled;
   bool trace;
   bool thinLTOEmitImportsFiles;
   bool thinLTOIndexOnly;
@@ -224,18 +233,22 @@ struct Configuration {
   Target2Policy target2;
   ARMVFPArgKind armVFPArgs = ARMVFPArgKind::Default;
   BuildIdKind buildId = BuildIdKind::None;
+  DebugCompressionKind compressDebugSections;
   SeparateSegmentKind zSeparate;
   ELFKind ekind = ELFNoneKind;
   uint16_t emachine = llvm::ELF::EM_NONE;
   llvm::Optional<uint64_t> imageBase;
   uint64_t commonPageSize;
+  uint64_t incrementalArgsHash = 0;
   uint64_t maxPageSize;
   uint64_t mipsGotSize;
+  uint64_t zHotTextAlign;
   uint64_t zStackSize;
   unsigned ltoPartitions;
   unsigned ltoo;
+  unsigned thinLTOMemoryBudget;
   unsigned optimize;
-  unsigned thinLTOJobs;
+  unsigned timeTraceGranularity;
   int32_t splitStackAdjustSize;
 
   // The following config options do not directly correspond to any
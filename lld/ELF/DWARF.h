@@ -60,6 +60,10 @@ public:
     return gnuPubtypesSection;
   }
 
+  const llvm::DWARFSection &getNamesSection() const override {
+    return namesSection;
+  }
+
   StringRef getFileName() const override { return ""; }
   StringRef getAbbrevSection() const override { return abbrevSection; }
   StringRef getStrSection() const override { return strSection; }
@@ -86,6 +90,7 @@ private:
   LLDDWARFSection strOffsetsSection;
   LLDDWARFSection lineSection;
   LLDDWARFSection addrSection;
+  LLDDWARFSection namesSection;
   StringRef abbrevSection;
   StringRef strSection;
   StringRef lineStrSection;
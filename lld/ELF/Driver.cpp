@@ -27,6 +27,7 @@
 #include "ICF.h"
 #include "InputFiles.h"
 #include "InputSection.h"
+#include "LinkCache.h"
 #include "LinkerScript.h"
 #include "MarkLive.h"
 #include "OutputSections.h"
@@ -54,9 +55,12 @@
 #include "llvm/Support/GlobPattern.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/TarWriter.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
 #include <cstdlib>
 #include <utility>
 
@@ -97,6 +101,7 @@ bool link(ArrayRef<const char *> args, bool canExitEarly, raw_ostream &error) {
   symtab = make<SymbolTable>();
 
   tar = nullptr;
+  linkCache = nullptr;
   memset(&in, 0, sizeof(in));
 
   partitions = {Partition()};
@@ -330,6 +335,8 @@ static void checkOptions() {
       error("-r and --gc-sections may not be used together");
     if (config->gdbIndex)
       error("-r and --gdb-index may not be used together");
+    if (config->debugNames)
+      error("-r and --debug-names may not be used together");
     if (config->icf != ICFLevel::None)
       error("-r and --icf may not be used together");
     if (config->pie)
@@ -406,7 +413,8 @@ static bool isKnownZFlag(StringRef s) {
          s == "noseparate-code" || s == "notext" || s == "now" ||
          s == "origin" || s == "relro" || s == "retpolineplt" ||
          s == "rodynamic" || s == "text" || s == "undefs" || s == "wxneeded" ||
-         s.startswith("common-page-size=") || s.startswith("max-page-size=") ||
+         s.startswith("common-page-size=") ||
+         s.startswith("hot-text-align=") || s.startswith("max-page-size=") ||
          s.startswith("stack-size=");
 }
 
@@ -463,8 +471,19 @@ void LinkerDriver::main(ArrayRef<const char *> argsArr) {
     }
   }
 
+  // Input files are recorded for --link-cache-dir as they are read, so
+  // this has to be set up before reading any file.
+  if (auto *arg = args.getLastArg(OPT_link_cache_dir))
+    linkCache = std::make_unique<LinkCache>(
+        arg->getValue(), args.getLastArgValue(OPT_link_cache_policy));
+
   readConfigs(args);
 
+  // --incremental-state reuses the previous output only if it was created
+  // with the same command line.
+  if (!config->incrementalState.empty())
+    config->incrementalArgsHash = xxHash64(createResponseFile(args));
+
   // The behavior of -v or --version is a bit strange, but this is
   // needed for compatibility with GNU linkers.
   if (args.hasArg(OPT_v) && !args.hasArg(OPT_INPUT))
@@ -472,6 +491,22 @@ void LinkerDriver::main(ArrayRef<const char *> argsArr) {
   if (args.hasArg(OPT_version))
     return;
 
+  if (config->timeTraceEnabled)
+    timeTraceProfilerInitialize(config->timeTraceGranularity,
+                                config->progName);
+
+  {
+    llvm::TimeTraceScope timeScope("ExecuteLinker");
+    execute(args);
+  }
+
+  if (config->timeTraceEnabled) {
+    writeTimeTrace();
+    timeTraceProfilerCleanup();
+  }
+}
+
+void LinkerDriver::execute(opt::InputArgList &args) {
   initLLVM();
   createFiles(args);
   if (errorCount())
@@ -483,6 +518,10 @@ void LinkerDriver::main(ArrayRef<const char *> argsArr) {
   if (errorCount())
     return;
 
+  // If we have linked the same inputs before, copy the previous output.
+  if (linkCache && linkCache->lookup(args))
+    return;
+
   // The Target instance handles target-specific stuff, such as applying
   // relocations or writing a PLT section. It also contains target-dependent
   // values such as a default image base address.
@@ -491,19 +530,45 @@ void LinkerDriver::main(ArrayRef<const char *> argsArr) {
   switch (config->ekind) {
   case ELF32LEKind:
     link<ELF32LE>(args);
-    return;
+    break;
   case ELF32BEKind:
     link<ELF32BE>(args);
-    return;
+    break;
   case ELF64LEKind:
     link<ELF64LE>(args);
-    return;
+    break;
   case ELF64BEKind:
     link<ELF64BE>(args);
-    return;
+    break;
   default:
     llvm_unreachable("unknown Config->EKind");
   }
+
+  if (linkCache && !errorCount())
+    linkCache->insert();
+}
+
+// Records the current heap usage to the time trace so that memory usage
+// of each phase shows up next to the phases in the trace viewer.
+static void traceMemoryUsage() {
+  if (config->timeTraceEnabled)
+    timeTraceProfilerCounter("Memory", sys::Process::GetMallocUsage());
+}
+
+// Writes the time trace to the file given by --time-trace-file, or to
+// <output>.time-trace by default.
+void LinkerDriver::writeTimeTrace() {
+  traceMemoryUsage();
+  std::string path = config->timeTraceFile.empty()
+                         ? (config->outputFile + ".time-trace").str()
+                         : config->timeTraceFile.str();
+  std::error_code ec;
+  raw_fd_ostream os(path, ec, sys::fs::OF_Text);
+  if (ec) {
+    error("cannot open " + path + ": " + ec.message());
+    return;
+  }
+  timeTraceProfilerWrite(os);
 }
 
 static std::string getRpath(opt::InputArgList &args) {
@@ -761,15 +826,22 @@ template <class ELFT> static void readCallGraphsFromObjectFiles() {
   }
 }
 
-static bool getCompressDebugSections(opt::InputArgList &args) {
+static DebugCompressionKind getCompressDebugSections(opt::InputArgList &args) {
   StringRef s = args.getLastArgValue(OPT_compress_debug_sections, "none");
   if (s == "none")
-    return false;
-  if (s != "zlib")
-    error("unknown --compress-debug-sections value: " + s);
-  if (!zlib::isAvailable())
-    error("--compress-debug-sections: zlib is not available");
-  return true;
+    return DebugCompressionKind::None;
+  if (s == "zlib") {
+    if (!zlib::isAvailable())
+      error("--compress-debug-sections: zlib is not available");
+    return DebugCompressionKind::Zlib;
+  }
+  if (s == "zstd") {
+    if (!zstd::isAvailable())
+      error("--compress-debug-sections: zstd is not available");
+    return DebugCompressionKind::Zstd;
+  }
+  error("unknown --compress-debug-sections value: " + s);
+  return DebugCompressionKind::None;
 }
 
 static StringRef getAliasSpelling(opt::Arg *arg) {
@@ -820,6 +892,16 @@ static void readConfigs(opt::InputArgList &args) {
   errorHandler().vsDiagnostics =
       args.hasArg(OPT_visual_studio_diagnostics_format, false);
   threadsEnabled = args.hasFlag(OPT_threads, OPT_no_threads, true);
+  if (auto *arg = args.getLastArg(OPT_threads, OPT_no_threads, OPT_threads_eq))
+    if (arg->getOption().getID() == OPT_threads_eq) {
+      if (Optional<ThreadPoolStrategy> s =
+              get_threadpool_strategy(arg->getValue())) {
+        parallel::strategy = *s;
+        threadsEnabled = s->compute_thread_count() > 1;
+      } else {
+        error("--threads: invalid value: " + StringRef(arg->getValue()));
+      }
+    }
 
   config->allowMultipleDefinition =
       args.hasFlag(OPT_allow_multiple_definition,
@@ -836,6 +918,8 @@ static void readConfigs(opt::InputArgList &args) {
   config->chroot = args.getLastArgValue(OPT_chroot);
   config->compressDebugSections = getCompressDebugSections(args);
   config->cref = args.hasFlag(OPT_cref, OPT_no_cref, false);
+  config->debugNames =
+      args.hasFlag(OPT_debug_names, OPT_no_debug_names, false);
   config->defineCommon = args.hasFlag(OPT_define_common, OPT_no_define_common,
                                       !args.hasArg(OPT_relocatable));
   config->demangle = args.hasFlag(OPT_demangle, OPT_no_demangle, true);
@@ -871,6 +955,7 @@ static void readConfigs(opt::InputArgList &args) {
       args.hasArg(OPT_ignore_data_address_equality);
   config->ignoreFunctionAddressEquality =
       args.hasArg(OPT_ignore_function_address_equality);
+  config->incrementalState = args.getLastArgValue(OPT_incremental_state);
   config->init = args.getLastArgValue(OPT_init, "_init");
   config->ltoAAPipeline = args.getLastArgValue(OPT_lto_aa_pipeline);
   config->ltoCSProfileGenerate = args.hasArg(OPT_lto_cs_profile_generate);
@@ -902,6 +987,8 @@ static void readConfigs(opt::InputArgList &args) {
   config->pie = args.hasFlag(OPT_pie, OPT_no_pie, false);
   config->printIcfSections =
       args.hasFlag(OPT_print_icf_sections, OPT_no_print_icf_sections, false);
+  config->printIcfStats =
+      args.hasFlag(OPT_print_icf_stats, OPT_no_print_icf_stats, false);
   config->printGcSections =
       args.hasFlag(OPT_print_gc_sections, OPT_no_print_gc_sections, false);
   config->printSymbolOrder =
@@ -928,11 +1015,23 @@ static void readConfigs(opt::InputArgList &args) {
   config->thinLTOIndexOnly = args.hasArg(OPT_thinlto_index_only) ||
                              args.hasArg(OPT_thinlto_index_only_eq);
   config->thinLTOIndexOnlyArg = args.getLastArgValue(OPT_thinlto_index_only_eq);
-  config->thinLTOJobs = args::getInteger(args, OPT_thinlto_jobs, -1u);
+  if (Optional<ThreadPoolStrategy> s =
+          get_threadpool_strategy(args.getLastArgValue(OPT_thinlto_jobs),
+                                  heavyweight_hardware_concurrency_strategy()))
+    config->thinLTOJobs = *s;
+  else
+    error("--thinlto-jobs: invalid value: " +
+          args.getLastArgValue(OPT_thinlto_jobs));
+  config->thinLTOMemoryBudget =
+      args::getInteger(args, OPT_thinlto_memory_budget, 0);
   config->thinLTOObjectSuffixReplace =
       getOldNewOptions(args, OPT_thinlto_object_suffix_replace_eq);
   config->thinLTOPrefixReplace =
       getOldNewOptions(args, OPT_thinlto_prefix_replace_eq);
+  config->timeTraceEnabled = args.hasArg(OPT_time_trace);
+  config->timeTraceFile = args.getLastArgValue(OPT_time_trace_file_eq);
+  config->timeTraceGranularity =
+      args::getInteger(args, OPT_time_trace_granularity, 500);
   config->trace = args.hasArg(OPT_trace);
   config->undefined = args::getStrings(args, OPT_undefined);
   config->undefinedVersion =
@@ -986,8 +1085,6 @@ static void readConfigs(opt::InputArgList &args) {
     error("invalid optimization level for LTO: " + Twine(config->ltoo));
   if (config->ltoPartitions == 0)
     error("--lto-partitions: number of threads must be > 0");
-  if (config->thinLTOJobs == 0)
-    error("--thinlto-jobs: number of threads must be > 0");
 
   if (config->splitStackAdjustSize < 0)
     error("--split-stack-adjust-size: size must be >= 0");
@@ -1298,6 +1395,19 @@ static uint64_t getCommonPageSize(opt::InputArgList &args) {
   return val;
 }
 
+// Parse -z hot-text-align=<value>. The hot text gets a segment of its own,
+// aligned to this value, so it is at least the maximum page size.
+static uint64_t getHotTextAlign(opt::InputArgList &args) {
+  uint64_t val = args::getZOptionValue(args, OPT_z, "hot-text-align", 0);
+  if (val == 0)
+    return 0;
+  if (!isPowerOf2_64(val))
+    error("hot-text-align: value isn't a power of 2");
+  else if (val < config->maxPageSize)
+    error("hot-text-align: value is less than max-page-size");
+  return val;
+}
+
 // Parses -image-base option.
 static Optional<uint64_t> getImageBase(opt::InputArgList &args) {
   // Because we are using "Config->maxPageSize" here, this function has to be
@@ -1735,8 +1845,26 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
   // symbols that we need to the symbol table. This process might
   // add files to the link, via autolinking, these files are always
   // appended to the Files vector.
-  for (size_t i = 0; i < files.size(); ++i)
-    parseFile(files[i]);
+  //
+  // Symbol resolution is sequential, but we can prepare symbol table keys
+  // for object files and archives given directly on the command line in
+  // parallel beforehand.
+  if (threadsEnabled) {
+    llvm::TimeTraceScope timeScope("Compute symbol keys");
+    parallelForEach(files, [](InputFile *file) {
+      if (file->kind() == InputFile::ObjKind && file->ekind == config->ekind)
+        cast<ObjFile<ELFT>>(file)->computeSymbolKeys();
+      else if (auto *f = dyn_cast<ArchiveFile>(file))
+        f->computeSymbolKeys();
+    });
+  }
+
+  {
+    llvm::TimeTraceScope timeScope("Parse input files");
+    for (size_t i = 0; i < files.size(); ++i)
+      parseFile(files[i]);
+  }
+  traceMemoryUsage();
 
   // Now that we have every file, we can decide if we will need a
   // dynamic symbol table.
@@ -1828,7 +1956,11 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
   //
   // With this the symbol table should be complete. After this, no new names
   // except a few linker-synthesized ones will be added to the symbol table.
-  compileBitcodeFiles<ELFT>();
+  {
+    llvm::TimeTraceScope timeScope("LTO");
+    compileBitcodeFiles<ELFT>();
+  }
+  traceMemoryUsage();
   if (errorCount())
     return;
 
@@ -1896,6 +2028,9 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
   // optimizations such as DATA_SEGMENT_ALIGN in linker scripts. LLD's use of it
   // is limited to writing trap instructions on the last executable segment.
   config->commonPageSize = getCommonPageSize(args);
+  // -z hot-text-align is typically 2MB, so that the hot text can be backed by
+  // huge pages.
+  config->zHotTextAlign = getHotTextAlign(args);
 
   config->imageBase = getImageBase(args);
 
@@ -1917,9 +2052,16 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
 
   // Do size optimizations: garbage collection, merging of SHF_MERGE sections
   // and identical code folding.
-  splitSections<ELFT>();
-  markLive<ELFT>();
+  {
+    llvm::TimeTraceScope timeScope("Split sections");
+    splitSections<ELFT>();
+  }
+  {
+    llvm::TimeTraceScope timeScope("GC");
+    markLive<ELFT>();
+  }
   demoteSharedSymbols();
+  traceMemoryUsage();
 
   // Make copies of any input sections that need to be copied into each
   // partition.
@@ -1956,6 +2098,7 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
   // Two input sections with different output sections should not be folded.
   // ICF runs after processSectionCommands() so that we know the output sections.
   if (config->icf != ICFLevel::None) {
+    llvm::TimeTraceScope timeScope("ICF");
     findKeepUniqueSections<ELFT>(args);
     doIcf<ELFT>();
   }
@@ -1969,7 +2112,10 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
   }
 
   // Write the result to the file.
-  writeResult<ELFT>();
+  {
+    llvm::TimeTraceScope timeScope("Write output file");
+    writeResult<ELFT>();
+  }
 }
 
 } // namespace elf
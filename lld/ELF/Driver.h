@@ -31,6 +31,8 @@ public:
   void addLibrary(StringRef name);
 
 private:
+  void execute(llvm::opt::InputArgList &args);
+  void writeTimeTrace();
   void createFiles(llvm::opt::InputArgList &args);
   void inferMachineType();
   template <class ELFT> void link(llvm::opt::InputArgList &args);
@@ -85,8 +85,11 @@
 #include "llvm/BinaryFormat/ELF.h"
 #include "llvm/Object/ELF.h"
 #include "llvm/Support/xxhash.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/TimeProfiler.h"
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 
 using namespace llvm;
 using namespace llvm::ELF;
@@ -120,6 +123,10 @@ private:
 
   void forEachClass(llvm::function_ref<void(size_t, size_t)> fn);
 
+  size_t countClasses();
+  void printStat(StringRef phase,
+                 std::chrono::high_resolution_clock::time_point start);
+
   std::vector<InputSection *> sections;
 
   // We repeat the main loop while `Repeat` is true.
@@ -204,6 +211,15 @@ void ICF<ELFT>::segregate(size_t begin, size_t end, bool constant) {
   // issue in practice because the number of the distinct sections in
   // each range is usually very small.
 
+  // Sections in the same class have the same number of relocations after
+  // the first (constant) pass. If they have no relocations, they are
+  // already known to be identical, so there's nothing to compare.
+  if (!constant && sections[begin]->numRelocations == 0) {
+    for (size_t i = begin; i < end; ++i)
+      sections[i]->eqClass[next] = sections[i]->eqClass[current];
+    return;
+  }
+
   while (begin < end) {
     // Divide [Begin, End) into two. Let Mid be the start index of the
     // second group.
@@ -301,8 +317,10 @@ bool ICF<ELFT>::constantEq(const InputSection *secA, ArrayRef<RelTy> ra,
 // except relocation targets.
 template <class ELFT>
 bool ICF<ELFT>::equalsConstant(const InputSection *a, const InputSection *b) {
+  // Check the cheap properties first so that we compare section contents
+  // only when they may be the same.
   if (a->numRelocations != b->numRelocations || a->flags != b->flags ||
-      a->getSize() != b->getSize() || a->data() != b->data())
+      a->getSize() != b->getSize())
     return false;
 
   // If two sections have different output sections, we cannot merge them.
@@ -310,6 +328,9 @@ bool ICF<ELFT>::equalsConstant(const InputSection *a, const InputSection *b) {
   if (a->getParent() != b->getParent())
     return false;
 
+  if (a->data() != b->data())
+    return false;
+
   if (a->areRelocsRela)
     return constantEq(a, a->template relas<ELFT>(), b,
                       b->template relas<ELFT>());
@@ -416,6 +437,7 @@ void ICF<ELFT>::forEachClass(llvm::function_ref<void(size_t, size_t)> fn) {
   });
 
   parallelForEachN(1, numShards + 1, [&](size_t i) {
+    llvm::TimeTraceScope timeScope("ICF shard");
     if (boundaries[i - 1] < boundaries[i])
       forEachClassRange(boundaries[i - 1], boundaries[i], fn);
   });
@@ -443,8 +465,35 @@ static void print(const Twine &s) {
     message(s);
 }
 
+template <class ELFT> size_t ICF<ELFT>::countClasses() {
+  size_t n = 0;
+  forEachClassRange(0, sections.size(), [&](size_t, size_t) { ++n; });
+  return n;
+}
+
+// Prints out the elapsed time of a given phase and the number of
+// equivalence classes after that for --print-icf-stats.
+template <class ELFT>
+void ICF<ELFT>::printStat(
+    StringRef phase, std::chrono::high_resolution_clock::time_point start) {
+  if (!config->printIcfStats)
+    return;
+  double ms = std::chrono::duration_cast<
+                  std::chrono::duration<double, std::milli>>(
+                  std::chrono::high_resolution_clock::now() - start)
+                  .count();
+  SmallString<64> str;
+  raw_svector_ostream os(str);
+  os << format("ICF: %-24s %8.1f ms, ", phase.str().c_str(), ms)
+     << countClasses() << " classes";
+  message(str);
+}
+
 // The main function of ICF.
 template <class ELFT> void ICF<ELFT>::run() {
+  using Clock = std::chrono::high_resolution_clock;
+  Clock::time_point start = Clock::now();
+
   // Collect sections to merge.
   for (InputSectionBase *sec : inputSections) {
     auto *s = cast<InputSection>(sec);
@@ -452,6 +501,9 @@ template <class ELFT> void ICF<ELFT>::run() {
       sections.push_back(s);
   }
 
+  if (config->printIcfStats)
+    message("ICF: " + Twine(sections.size()) + " eligible sections");
+
   // Initially, we use hash values to partition sections.
   parallelForEach(sections, [&](InputSection *s) {
     s->eqClass[0] = xxHash64(s->data());
@@ -471,19 +523,27 @@ template <class ELFT> void ICF<ELFT>::run() {
   llvm::stable_sort(sections, [](const InputSection *a, const InputSection *b) {
     return a->eqClass[0] < b->eqClass[0];
   });
+  printStat("hashing", start);
 
   // Compare static contents and assign unique IDs for each static content.
+  start = Clock::now();
   forEachClass([&](size_t begin, size_t end) { segregate(begin, end, true); });
+  printStat("constant comparison", start);
 
   // Split groups by comparing relocations until convergence is obtained.
   do {
+    start = Clock::now();
     repeat = false;
     forEachClass(
         [&](size_t begin, size_t end) { segregate(begin, end, false); });
+    printStat(("iteration " + Twine(cnt)).str(), start);
   } while (repeat);
 
   log("ICF needed " + Twine(cnt) + " iterations");
 
+  size_t numFolded = 0;
+  uint64_t bytesFolded = 0;
+
   // Merge sections by the equivalence class.
   forEachClassRange(0, sections.size(), [&](size_t begin, size_t end) {
     if (end - begin == 1)
@@ -491,6 +551,8 @@ template <class ELFT> void ICF<ELFT>::run() {
     print("selected section " + toString(sections[begin]));
     for (size_t i = begin + 1; i < end; ++i) {
       print("  removing identical section " + toString(sections[i]));
+      ++numFolded;
+      bytesFolded += sections[i]->getSize();
       sections[begin]->replace(sections[i]);
 
       // At this point we know sections merged are fully identical and hence
@@ -501,6 +563,10 @@ template <class ELFT> void ICF<ELFT>::run() {
     }
   });
 
+  if (config->printIcfStats)
+    message("ICF: folded " + Twine(numFolded) + " sections (" +
+            Twine(bytesFolded) + " bytes)");
+
   // InputSectionDescription::sections is populated by processSectionCommands().
   // ICF may fold some input sections assigned to output sections. Remove them.
   for (BaseCommand *base : script->sectionCommands)
@@ -0,0 +1,251 @@
+//===- Incremental.cpp ----------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements --incremental-state=<file>.
+//
+// In a typical edit-compile-link loop, only one or a few object files
+// change between two consecutive links. If the change doesn't alter the
+// size of any section nor the address of any symbol, most bytes of the
+// output are identical to the previous output. We take advantage of that
+// by skipping OutputSection::writeTo for output sections whose inputs
+// haven't changed and copying their contents from the previous output
+// instead. That saves the cost of applying relocations, which dominates
+// the writer for large programs.
+//
+// This is safe only if a relocated output section is a pure function of
+// its inputs. We therefore compute two kinds of hash values:
+//
+//  - a layout hash, which covers the command line, the addresses, offsets
+//    and sizes of all output and input sections, and the values of all
+//    symbols. If it doesn't match the previous one, we write the output
+//    from scratch.
+//
+//  - a fingerprint for each output section, which covers the contents and
+//    relocations of its input sections. An output section can be reused
+//    if its fingerprint matches the previous one. Output sections that
+//    contain synthetic sections are always written because their contents
+//    are not known until they are written.
+//
+// The state file is a small text file containing these hash values.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Incremental.h"
+#include "Config.h"
+#include "InputFiles.h"
+#include "LinkerScript.h"
+#include "OutputSections.h"
+#include "Symbols.h"
+#include "SyntheticSections.h"
+#include "lld/Common/ErrorHandler.h"
+#include "lld/Common/Threads.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+using namespace llvm;
+using namespace llvm::ELF;
+using namespace llvm::object;
+
+namespace lld {
+namespace elf {
+
+static const char stateMagic[] = "lld-incremental-state-v1";
+
+namespace {
+// Accumulates integers and strings and computes a hash value of them.
+class Hasher {
+public:
+  void add(uint64_t v) { buf.push_back(v); }
+  void add(StringRef s) { buf.push_back(xxHash64(s)); }
+  void add(ArrayRef<uint8_t> a) { buf.push_back(xxHash64(a)); }
+
+  uint64_t get() const {
+    return xxHash64(makeArrayRef(reinterpret_cast<const uint8_t *>(buf.data()),
+                                 buf.size() * sizeof(uint64_t)));
+  }
+
+private:
+  std::vector<uint64_t> buf;
+};
+} // namespace
+
+static void addSymbol(Hasher &h, const Symbol *sym) {
+  if (auto *d = dyn_cast<Defined>(sym))
+    if (!d->section || d->section->repl->getOutputSection())
+      h.add(d->getVA());
+  h.add(sym->gotIndex);
+  h.add(sym->pltIndex);
+  h.add(sym->globalDynIndex);
+  h.add(sym->isPreemptible);
+}
+
+static uint64_t computeLayoutHash(uint64_t fileSize) {
+  Hasher h;
+  h.add(config->incrementalArgsHash);
+  h.add(fileSize);
+
+  for (OutputSection *sec : outputSections) {
+    h.add(sec->name);
+    h.add(sec->type);
+    h.add(sec->flags);
+    h.add(sec->addr);
+    h.add(sec->offset);
+    h.add(sec->size);
+
+    for (BaseCommand *base : sec->sectionCommands)
+      if (auto *isd = dyn_cast<InputSectionDescription>(base))
+        for (InputSection *isec : isd->sections) {
+          h.add(isec->outSecOff);
+          h.add(isec->getSize());
+        }
+  }
+
+  // Relocations in non-SHF_ALLOC sections are resolved using symbol values
+  // directly, so any change in symbol values invalidates the previous output.
+  for (InputFile *file : objectFiles)
+    for (Symbol *sym : file->getSymbols())
+      if (sym)
+        addSymbol(h, sym);
+  return h.get();
+}
+
+// Returns a fingerprint of a given output section's inputs, or 0 if the
+// output section has to be written from scratch.
+template <class ELFT> static uint64_t getFingerprint(OutputSection *sec) {
+  if (sec->type == SHT_NOBITS || sec->type == SHT_REL ||
+      sec->type == SHT_RELA)
+    return 0;
+
+  Hasher h;
+  for (BaseCommand *base : sec->sectionCommands) {
+    auto *isd = dyn_cast<InputSectionDescription>(base);
+    if (!isd) {
+      // BYTE() and similar commands are written by OutputSection::writeTo.
+      if (isa<ByteCommand>(base))
+        return 0;
+      continue;
+    }
+
+    for (InputSection *isec : isd->sections) {
+      if (isa<SyntheticSection>(isec))
+        return 0;
+
+      h.add(isec->data());
+      size_t relSize = isec->areRelocsRela ? sizeof(typename ELFT::Rela)
+                                           : sizeof(typename ELFT::Rel);
+      h.add(makeArrayRef(static_cast<const uint8_t *>(isec->firstRelocation),
+                         isec->numRelocations * relSize));
+
+      // Relocations in SHF_ALLOC sections may have been redirected to
+      // symbols that don't belong to any file, such as thunks.
+      for (const Relocation &rel : isec->relocations) {
+        h.add(rel.expr);
+        h.add(rel.type);
+        h.add(rel.offset);
+        h.add(rel.addend);
+        addSymbol(h, rel.sym);
+      }
+    }
+  }
+
+  // Make sure that a valid fingerprint is never 0.
+  return h.get() | 1;
+}
+
+template <class ELFT> void IncrementalState::prepare(uint64_t fileSize) {
+  layoutHash = computeLayoutHash(fileSize);
+  fingerprints.resize(outputSections.size());
+  parallelForEachN(0, outputSections.size(), [&](size_t i) {
+    fingerprints[i] = getFingerprint<ELFT>(outputSections[i]);
+  });
+
+  // Read the previous state. Any mismatch results in a full write.
+  ErrorOr<std::unique_ptr<MemoryBuffer>> mbOrErr =
+      MemoryBuffer::getFile(config->incrementalState);
+  if (!mbOrErr)
+    return;
+
+  SmallVector<StringRef, 0> lines;
+  (*mbOrErr)->getBuffer().split(lines, '\n', -1, false);
+  if (lines.size() != fingerprints.size() + 4 || lines[0] != stateMagic)
+    return;
+
+  uint64_t prevLayoutHash, prevFileSize, prevModTime;
+  if (lines[1].getAsInteger(16, prevLayoutHash) ||
+      lines[2].getAsInteger(10, prevFileSize) ||
+      lines[3].getAsInteger(10, prevModTime) || prevLayoutHash != layoutHash ||
+      prevFileSize != fileSize)
+    return;
+
+  // The previous output must be the one we wrote last time.
+  sys::fs::file_status st;
+  if (sys::fs::status(config->outputFile, st) || st.getSize() != fileSize ||
+      (uint64_t)st.getLastModificationTime().time_since_epoch().count() !=
+          prevModTime)
+    return;
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> outOrErr = MemoryBuffer::getFile(
+      config->outputFile, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+  if (!outOrErr || (*outOrErr)->getBufferSize() != fileSize)
+    return;
+  previousOutput = std::move(*outOrErr);
+
+  for (size_t i = 0, e = outputSections.size(); i != e; ++i) {
+    uint64_t prev;
+    if (!lines[i + 4].getAsInteger(16, prev) && fingerprints[i] &&
+        prev == fingerprints[i])
+      reusable.insert(outputSections[i]);
+  }
+
+  log("--incremental-state: reusing " + Twine(reusable.size()) + " out of " +
+      Twine(outputSections.size()) + " output sections");
+}
+
+void IncrementalState::copyPreviousOutput(uint8_t *buf) {
+  if (!previousOutput || reusable.empty())
+    return;
+  memcpy(buf, previousOutput->getBufferStart(),
+         previousOutput->getBufferSize());
+}
+
+void IncrementalState::save() {
+  // The previous output is no longer needed.
+  previousOutput.reset();
+
+  sys::fs::file_status st;
+  if (std::error_code ec = sys::fs::status(config->outputFile, st)) {
+    warn("--incremental-state: cannot stat " + config->outputFile + ": " +
+         ec.message());
+    return;
+  }
+
+  std::error_code ec;
+  raw_fd_ostream os(config->incrementalState, ec, sys::fs::OF_None);
+  if (ec) {
+    error("cannot open " + config->incrementalState + ": " + ec.message());
+    return;
+  }
+
+  os << stateMagic << "\n";
+  os << format_hex_no_prefix(layoutHash, 16) << "\n";
+  os << st.getSize() << "\n";
+  os << (uint64_t)st.getLastModificationTime().time_since_epoch().count()
+     << "\n";
+  for (uint64_t fp : fingerprints)
+    os << format_hex_no_prefix(fp, 16) << "\n";
+}
+
+template void IncrementalState::prepare<ELF32LE>(uint64_t);
+template void IncrementalState::prepare<ELF32BE>(uint64_t);
+template void IncrementalState::prepare<ELF64LE>(uint64_t);
+template void IncrementalState::prepare<ELF64BE>(uint64_t);
+
+} // namespace elf
+} // namespace lld
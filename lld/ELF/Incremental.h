@@ -0,0 +1,56 @@
+//===- Incremental.h --------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLD_ELF_INCREMENTAL_H
+#define LLD_ELF_INCREMENTAL_H
+
+#include "lld/Common/LLVM.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <memory>
+#include <vector>
+
+namespace lld {
+namespace elf {
+class OutputSection;
+
+// This class implements --incremental-state=<file>. If the option is
+// given, we record the file layout and a fingerprint of each output
+// section's inputs in the state file. On the next link, if the layout
+// and the symbol values turn out to be the same as the previous link,
+// we start from a copy of the previous output and write only the output
+// sections whose inputs have changed.
+class IncrementalState {
+public:
+  // Finds reusable output sections. This has to be called after file
+  // offsets are assigned and before the output file is opened because
+  // opening the output file removes the previous one.
+  template <class ELFT> void prepare(uint64_t fileSize);
+
+  // Copies the previous output to a given buffer if some output sections
+  // can be reused.
+  void copyPreviousOutput(uint8_t *buf);
+
+  bool canReuse(const OutputSection *sec) const {
+    return reusable.count(sec);
+  }
+
+  // Records the state of the current link to the state file.
+  void save();
+
+private:
+  uint64_t layoutHash = 0;
+  std::vector<uint64_t> fingerprints;
+  std::unique_ptr<MemoryBuffer> previousOutput;
+  llvm::DenseSet<const OutputSection *> reusable;
+};
+
+} // namespace elf
+} // namespace lld
+
+#endif
@@ -9,6 +9,7 @@
 #include "InputFiles.h"
 #include "Driver.h"
 #include "InputSection.h"
+#include "LinkCache.h"
 #include "LinkerScript.h"
 #include "SymbolTable.h"
 #include "Symbols.h"
@@ -117,10 +118,19 @@ Optional<MemoryBufferRef> readFile(StringRef path) {
 
   std::unique_ptr<MemoryBuffer> &mb = *mbOrErr;
   MemoryBufferRef mbref = mb->getMemBufferRef();
+
+  // We are going to read most of a non-archive input file, so start reading
+  // it in the background. This avoids blocking on page faults one page at a
+  // time if the file is not in the page cache. We do not do this for
+  // archives because we usually need only a few of their members.
+  if (identify_magic(mbref.getBuffer()) != file_magic::archive)
+    mb->advise(MemoryBuffer::Advice::WillNeed);
   make<std::unique_ptr<MemoryBuffer>>(std::move(mb)); // take MB ownership
 
   if (tar)
     tar->append(relativeToRoot(path), mbref.getBuffer());
+  if (linkCache)
+    linkCache->addInput(path, mbref);
   return mbref;
 }
 
@@ -459,6 +469,33 @@ template <class ELFT> void ObjFile<ELFT>::parse(bool ignoreComdats) {
   initializeSymbols();
 }
 
+// Symbol resolution has to be done sequentially in command line order to
+// make the output deterministic, but hashing symbol names doesn't have to.
+// For object files with many global symbols, computing the hash values is
+// a non-negligible part of the symbol table insertion cost, so we do that
+// for all files in parallel before starting symbol resolution.
+template <class ELFT> void ObjFile<ELFT>::computeSymbolKeys() {
+  ArrayRef<Elf_Sym> eSyms = this->getGlobalELFSyms<ELFT>();
+  symbolKeys.reserve(eSyms.size());
+
+  for (const Elf_Sym &eSym : eSyms) {
+    if (eSym.getBinding() == STB_LOCAL) {
+      symbolKeys.emplace_back(StringRef(), 0);
+      continue;
+    }
+
+    // If a name is broken, give up. initializeSymbols() will report
+    // the error in the usual way.
+    Expected<StringRef> nameOrErr = eSym.getName(this->stringTable);
+    if (!nameOrErr) {
+      consumeError(nameOrErr.takeError());
+      symbolKeys.clear();
+      return;
+    }
+    symbolKeys.push_back(SymbolTable::getKey(*nameOrErr));
+  }
+}
+
 // Sections with SHT_GROUP and comdat bits define comdat section groups.
 // They are identified and deduplicated by group name. This function
 // returns a group name.
@@ -943,7 +980,7 @@ InputSectionBase *ObjFile<ELFT>::createInputSection(const Elf_Shdr &sec) {
       target->numRelocations = rels.size();
       target->areRelocsRela = false;
     }
-    assert(isUInt<31>(target->numRelocations));
+    assert(isUInt<30>(target->numRelocations));
 
     // Relocation sections processed by the linker are usually removed
     // from the output, so returning `nullptr` for the normal case.
@@ -1051,10 +1088,16 @@ template <class ELFT> void ObjFile<ELFT>::initializeSymbols() {
 
   // Our symbol table may have already been partially initialized
   // because of LazyObjFile.
-  for (size_t i = 0, end = eSyms.size(); i != end; ++i)
-    if (!this->symbols[i] && eSyms[i].getBinding() != STB_LOCAL)
+  for (size_t i = 0, end = eSyms.size(); i != end; ++i) {
+    if (this->symbols[i] || eSyms[i].getBinding() == STB_LOCAL)
+      continue;
+    if (!symbolKeys.empty() && i >= this->firstGlobal)
+      this->symbols[i] = symtab->insert(symbolKeys[i - this->firstGlobal]);
+    else
       this->symbols[i] =
           symtab->insert(CHECK(eSyms[i].getName(this->stringTable), this));
+  }
+  symbolKeys = {};
 
   // Fill this->Symbols. A symbol is either local or global.
   for (size_t i = 0, end = eSyms.size(); i != end; ++i) {
@@ -1139,8 +1182,25 @@ ArchiveFile::ArchiveFile(std::unique_ptr<Archive> &&file)
       file(std::move(file)) {}
 
 void ArchiveFile::parse() {
+  if (symbolKeys.empty()) {
+    for (const Archive::Symbol &sym : file->symbols())
+      symtab->addSymbol(LazyArchive{*this, sym});
+    return;
+  }
+
+  size_t i = 0;
+  for (const Archive::Symbol &sym : file->symbols())
+    symtab->insert(symbolKeys[i++])->resolve(LazyArchive{*this, sym});
+  symbolKeys = {};
+}
+
+// Archive symbol tables of large libraries, such as libLLVM*.a, contain
+// hundreds of thousands of symbols. Creating lazy symbols for them has to
+// be done in command line order, but their names can be hashed for all
+// archives in parallel beforehand.
+void ArchiveFile::computeSymbolKeys() {
   for (const Archive::Symbol &sym : file->symbols())
-    symtab->addSymbol(LazyArchive{*this, sym});
+    symbolKeys.push_back(SymbolTable::getKey(sym.getName()));
 }
 
 // Returns a buffer pointing to a member file containing a given symbol.
@@ -205,6 +205,11 @@ public:
 
   void parse(bool ignoreComdats = false);
 
+  // Computes symbol table keys for global symbols ahead of parse(). This
+  // function doesn't mutate any global state, so it can be called for
+  // multiple files in parallel.
+  void computeSymbolKeys();
+
   StringRef getShtGroupSignature(ArrayRef<Elf_Shdr> sections,
                                  const Elf_Shdr &sec);
 
@@ -278,6 +283,11 @@ private:
   // .shstrtab contents.
   StringRef sectionStringTable;
 
+  // Symbol table keys of global symbols computed by computeSymbolKeys().
+  // The Nth element corresponds to the (firstGlobal + N)th ELF symbol.
+  // Empty if the keys have not been computed in advance.
+  std::vector<llvm::CachedHashStringRef> symbolKeys;
+
   // Debugging information to retrieve source file and line for error
   // reporting. Linker may find reasonable number of errors in a
   // single object file, so we cache debugging information in order to
@@ -324,6 +334,10 @@ public:
   static bool classof(const InputFile *f) { return f->kind() == ArchiveKind; }
   void parse();
 
+  // Computes symbol table keys for the archive symbol table ahead of
+  // parse(). Like ObjFile::computeSymbolKeys, this is thread-safe.
+  void computeSymbolKeys();
+
   // Pulls out an object file that contains a definition for Sym and
   // returns it. If the same file was instantiated before, this
   // function does nothing (so we don't instantiate the same file
@@ -333,6 +347,9 @@ public:
 private:
   std::unique_ptr<Archive> file;
   llvm::DenseSet<uint64_t> seen;
+
+  // Keys of the archive symbols in the archive symbol table order.
+  std::vector<llvm::CachedHashStringRef> symbolKeys;
 };
 
 class BitcodeFile : public InputFile {
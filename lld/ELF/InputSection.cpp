@@ -26,7 +26,6 @@
 #include "llvm/Support/Threading.h"
 #include "llvm/Support/xxhash.h"
 #include <algorithm>
-#include <mutex>
 #include <set>
 #include <vector>
 
@@ -70,6 +69,7 @@ InputSectionBase::InputSectionBase(InputFile *file, uint64_t flags,
 
   numRelocations = 0;
   areRelocsRela = false;
+  zstdCompressed = false;
 
   // The ELF spec states that a value of 0 means the section has
   // no alignment constraits.
@@ -78,16 +78,12 @@ InputSectionBase::InputSectionBase(InputFile *file, uint64_t flags,
     fatal(toString(this) + ": sh_addralign is not a power of 2");
   this->alignment = v;
 
-  // In ELF, each section can be compressed by zlib, and if compressed,
-  // section name may be mangled by appending "z" (e.g. ".zdebug_info").
-  // If that's the case, demangle section name so that we can handle a
-  // section as if it weren't compressed.
-  if ((flags & SHF_COMPRESSED) || name.startswith(".zdebug")) {
-    if (!zlib::isAvailable())
-      error(toString(file) + ": contains a compressed section, " +
-            "but zlib is not available");
+  // In ELF, each section can be compressed by zlib or zstd, and if
+  // compressed with zlib, section name may be mangled by appending "z" (e.g.
+  // ".zdebug_info"). If that's the case, demangle section name so that we can
+  // handle a section as if it weren't compressed.
+  if ((flags & SHF_COMPRESSED) || name.startswith(".zdebug"))
     parseCompressedHeader();
-  }
 }
 
 // Drop SHF_GROUP bit unless we are producing a re-linkable object file.
@@ -141,16 +137,18 @@ size_t InputSectionBase::getSize() const {
   return rawData.size();
 }
 
+static Error uncompressData(bool zstdCompressed, ArrayRef<uint8_t> data,
+                            char *buf, size_t &size) {
+  if (zstdCompressed)
+    return zstd::uncompress(toStringRef(data), buf, size);
+  return zlib::uncompress(toStringRef(data), buf, size);
+}
+
 void InputSectionBase::uncompress() const {
   size_t size = uncompressedSize;
-  char *uncompressedBuf;
-  {
-    static std::mutex mu;
-    std::lock_guard<std::mutex> lock(mu);
-    uncompressedBuf = bAlloc.Allocate<char>(size);
-  }
+  char *uncompressedBuf = bAlloc.Allocate<char>(size);
 
-  if (Error e = zlib::uncompress(toStringRef(rawData), uncompressedBuf, size))
+  if (Error e = uncompressData(zstdCompressed, rawData, uncompressedBuf, size))
     fatal(toString(this) +
           ": uncompress failed: " + llvm::toString(std::move(e)));
   rawData = makeArrayRef((uint8_t *)uncompressedBuf, size);
@@ -205,15 +203,42 @@ OutputSection *SectionBase::getOutputSection() {
   return sec ? sec->getParent() : nullptr;
 }
 
+// Records the algorithm a section is compressed with. Returns false, after
+// reporting an error, if the section cannot be uncompressed.
+bool InputSectionBase::setCompressionType(uint32_t chType) {
+  if (chType == ELFCOMPRESS_ZLIB) {
+    if (!zlib::isAvailable()) {
+      error(toString(file) + ": contains a compressed section, " +
+            "but zlib is not available");
+      return false;
+    }
+    zstdCompressed = false;
+    return true;
+  }
+  if (chType == ELFCOMPRESS_ZSTD) {
+    if (!zstd::isAvailable()) {
+      error(toString(file) + ": contains a compressed section, " +
+            "but zstd is not available");
+      return false;
+    }
+    zstdCompressed = true;
+    return true;
+  }
+  error(toString(this) + ": unsupported compression type");
+  return false;
+}
+
 // When a section is compressed, `rawData` consists with a header followed
-// by zlib-compressed data. This function parses a header to initialize
-// `uncompressedSize` member and remove the header from `rawData`.
+// by zlib- or zstd-compressed data. This function parses a header to
+// initialize `uncompressedSize` member and remove the header from `rawData`.
 void InputSectionBase::parseCompressedHeader() {
   using Chdr64 = typename ELF64LE::Chdr;
   using Chdr32 = typename ELF32LE::Chdr;
 
   // Old-style header
   if (name.startswith(".zdebug")) {
+    if (!setCompressionType(ELFCOMPRESS_ZLIB))
+      return;
     if (!toStringRef(rawData).startswith("ZLIB")) {
       error(toString(this) + ": corrupted compressed section header");
       return;
@@ -245,10 +270,8 @@ void InputSectionBase::parseCompressedHeader() {
     }
 
     auto *hdr = reinterpret_cast<const Chdr64 *>(rawData.data());
-    if (hdr->ch_type != ELFCOMPRESS_ZLIB) {
-      error(toString(this) + ": unsupported compression type");
+    if (!setCompressionType(hdr->ch_type))
       return;
-    }
 
     uncompressedSize = hdr->ch_size;
     alignment = std::max<uint32_t>(hdr->ch_addralign, 1);
@@ -263,10 +286,8 @@ void InputSectionBase::parseCompressedHeader() {
   }
 
   auto *hdr = reinterpret_cast<const Chdr32 *>(rawData.data());
-  if (hdr->ch_type != ELFCOMPRESS_ZLIB) {
-    error(toString(this) + ": unsupported compression type");
+  if (!setCompressionType(hdr->ch_type))
     return;
-  }
 
   uncompressedSize = hdr->ch_size;
   alignment = std::max<uint32_t>(hdr->ch_addralign, 1);
@@ -1121,8 +1142,8 @@ template <class ELFT> void InputSection::writeTo(uint8_t *buf) {
   // to the buffer.
   if (uncompressedSize >= 0) {
     size_t size = uncompressedSize;
-    if (Error e = zlib::uncompress(toStringRef(rawData),
-                                   (char *)(buf + outSecOff), size))
+    if (Error e = uncompressData(zstdCompressed, rawData,
+                                 (char *)(buf + outSecOff), size))
       fatal(toString(this) +
             ": uncompress failed: " + llvm::toString(std::move(e)));
     uint8_t *bufEnd = buf + outSecOff + size;
@@ -115,8 +115,11 @@ public:
   static bool classof(const SectionBase *s) { return s->kind() != Output; }
 
   // Relocations that refer to this section.
-  unsigned numRelocations : 31;
+  unsigned numRelocations : 30;
   unsigned areRelocsRela : 1;
+
+  // Whether rawData is compressed with zstd rather than zlib, if it is.
+  unsigned zstdCompressed : 1;
   const void *firstRelocation = nullptr;
 
   // The file which contains this section. Its dynamic type is always
@@ -202,6 +205,7 @@ public:
 
 protected:
   void parseCompressedHeader();
+  bool setCompressionType(uint32_t chType);
   void uncompress() const;
 
   mutable ArrayRef<uint8_t> rawData;
@@ -110,6 +110,7 @@ static lto::Config createConfig() {
 
   c.CSIRProfile = config->ltoCSProfileFile;
   c.RunCSIRInstr = config->ltoCSProfileGenerate;
+  c.ThinLTOMemoryBudget = size_t(config->thinLTOMemoryBudget) << 20;
 
   if (config->emitLLVM) {
     c.PostInternalizeModuleHook = [](size_t task, const Module &m) {
@@ -137,7 +138,7 @@ BitcodeCompiler::BitcodeCompiler() {
     backend = lto::createWriteIndexesThinBackend(
         config->thinLTOPrefixReplace.first, config->thinLTOPrefixReplace.second,
         config->thinLTOEmitImportsFiles, indexFile.get(), onIndexWrite);
-  } else if (config->thinLTOJobs != -1U) {
+  } else {
     backend = lto::createInProcessThinBackend(config->thinLTOJobs);
   }
 
@@ -0,0 +1,176 @@
+//===- LinkCache.cpp ------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements --link-cache-dir, which is useful when the same
+// link is run repeatedly, e.g. on different CI shards sharing a network
+// file system. The cache directory is managed by the same code as the
+// ThinLTO cache, so --link-cache-policy accepts the same pruning policy
+// strings as --thinlto-cache-policy.
+//
+// The cache key covers everything that may affect the output: the lld
+// version, the command line except options that only name the output,
+// and the name and contents of each file read by the linker. Links that
+// produce files other than the output file (e.g. -Map or --save-temps),
+// links with thin archives (whose members are read lazily) and links
+// with --build-id=uuid are not cached.
+//
+//===----------------------------------------------------------------------===//
+
+#include "LinkCache.h"
+#include "Config.h"
+#include "Driver.h"
+#include "lld/Common/ErrorHandler.h"
+#include "lld/Common/Threads.h"
+#include "lld/Common/Version.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/LTO/Caching.h"
+#include "llvm/Support/FileOutputBuffer.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/xxhash.h"
+
+using namespace llvm;
+using namespace llvm::sys;
+
+namespace lld {
+namespace elf {
+
+std::unique_ptr<LinkCache> linkCache;
+
+LinkCache::LinkCache(StringRef dir, StringRef policy)
+    : dir(dir), policy(CHECK(parseCachePruningPolicy(policy),
+                             "--link-cache-policy: invalid cache policy")) {}
+
+void LinkCache::addInput(StringRef path, MemoryBufferRef mb) {
+  inputs.push_back({path, mb});
+}
+
+// Returns a reason why the current link can't be cached, or an empty
+// string if it can.
+static StringRef getUncacheableReason(const opt::InputArgList &args) {
+  if (!config->mapFile.empty() || config->cref)
+    return "-Map or --cref";
+  if (config->printGcSections || config->printIcfSections ||
+      config->printIcfStats ||
+      !config->printSymbolOrder.empty() || config->trace ||
+      args.hasArg(OPT_trace_symbol))
+    return "an option that prints to stdout";
+  if (config->saveTemps || config->emitLLVM || config->thinLTOIndexOnly ||
+      !config->ltoObjPath.empty() || !config->optRemarksFilename.empty())
+    return "an LTO option that creates extra files";
+  if (config->buildId == BuildIdKind::Uuid)
+    return "--build-id=uuid";
+  return "";
+}
+
+std::string LinkCache::computeKey(const opt::InputArgList &args) {
+  SHA1 hasher;
+  hasher.update(getLLDVersion());
+  hasher.update(StringRef("\0", 1));
+
+  for (const opt::Arg *arg : args) {
+    switch (arg->getOption().getID()) {
+    case OPT_o:
+    case OPT_link_cache_dir:
+    case OPT_link_cache_policy:
+    case OPT_reproduce:
+    case OPT_time_trace:
+    case OPT_time_trace_file_eq:
+    case OPT_time_trace_granularity:
+      continue;
+    }
+    hasher.update(toString(*arg));
+    hasher.update(StringRef("\0", 1));
+  }
+
+  // The call graph ordering file is read after the cache lookup, so it
+  // hasn't been recorded yet.
+  if (auto *arg = args.getLastArg(OPT_call_graph_ordering_file))
+    if (ErrorOr<std::unique_ptr<MemoryBuffer>> mbOrErr =
+            MemoryBuffer::getFile(arg->getValue()))
+      hasher.update((*mbOrErr)->getBuffer());
+
+  // Hashing input files is the most expensive part. Do that in parallel.
+  std::vector<uint64_t> hashes(inputs.size());
+  parallelForEachN(0, inputs.size(), [&](size_t i) {
+    hashes[i] = xxHash64(inputs[i].second.getBuffer());
+  });
+
+  for (size_t i = 0, e = inputs.size(); i != e; ++i) {
+    hasher.update(inputs[i].first);
+    hasher.update(StringRef("\0", 1));
+    uint8_t buf[8];
+    support::endian::write64le(buf, hashes[i]);
+    hasher.update(buf);
+  }
+  return toHex(hasher.result());
+}
+
+bool LinkCache::lookup(const opt::InputArgList &args) {
+  StringRef reason = getUncacheableReason(args);
+  for (const std::pair<StringRef, MemoryBufferRef> &p : inputs)
+    if (p.second.getBuffer().startswith("!<thin>\n"))
+      reason = "thin archive";
+  if (!reason.empty()) {
+    log("--link-cache-dir: not caching a link with " + reason);
+    return false;
+  }
+
+  std::unique_ptr<MemoryBuffer> cached;
+  lto::NativeObjectCache cache =
+      CHECK(lto::localCache(dir,
+                            [&](size_t task, std::unique_ptr<MemoryBuffer> mb) {
+                              cached = std::move(mb);
+                            }),
+            "--link-cache-dir");
+
+  addStream = cache(0, computeKey(args));
+  if (!cached)
+    return false;
+
+  // Cache hit. Copy the cached output to the output file.
+  log("--link-cache-dir: cache hit");
+  unsigned flags = config->relocatable ? 0 : FileOutputBuffer::F_executable;
+  Expected<std::unique_ptr<FileOutputBuffer>> bufferOrErr =
+      FileOutputBuffer::create(config->outputFile, cached->getBufferSize(),
+                               flags);
+  if (!bufferOrErr) {
+    error("failed to open " + config->outputFile + ": " +
+          toString(bufferOrErr.takeError()));
+    return true;
+  }
+
+  std::unique_ptr<FileOutputBuffer> &buffer = *bufferOrErr;
+  memcpy(buffer->getBufferStart(), cached->getBufferStart(),
+         cached->getBufferSize());
+  if (Error e = buffer->commit())
+    error("failed to write to the output file: " + toString(std::move(e)));
+  return true;
+}
+
+void LinkCache::insert() {
+  if (!addStream)
+    return;
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> mbOrErr = MemoryBuffer::getFile(
+      config->outputFile, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+  if (!mbOrErr) {
+    warn("--link-cache-dir: cannot read " + config->outputFile + ": " +
+         mbOrErr.getError().message());
+    return;
+  }
+
+  // The stream commits the cache entry when it is destroyed.
+  {
+    std::unique_ptr<lto::NativeObjectStream> stream = addStream(0);
+    *stream->OS << (*mbOrErr)->getBuffer();
+  }
+  pruneCache(dir, policy);
+}
+
+} // namespace elf
+} // namespace lld
@@ -0,0 +1,58 @@
+//===- LinkCache.h ----------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLD_ELF_LINK_CACHE_H
+#define LLD_ELF_LINK_CACHE_H
+
+#include "lld/Common/LLVM.h"
+#include "llvm/LTO/LTO.h"
+#include "llvm/Option/ArgList.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lld {
+namespace elf {
+
+// This class implements --link-cache-dir=<dir>. The output of a link is a
+// function of the linker version, the command line and the contents of
+// the input files. We hash them and use the hash value as a key to look
+// up a cache directory. If there's an output for the same key, we copy it
+// to the output file and skip the link entirely.
+class LinkCache {
+public:
+  LinkCache(StringRef dir, StringRef policy);
+
+  // Records a file read by readFile(). All input files must be recorded
+  // before lookup() is called.
+  void addInput(StringRef path, MemoryBufferRef mb);
+
+  // Returns true if the output was found in the cache and has been written
+  // to the output file.
+  bool lookup(const llvm::opt::InputArgList &args);
+
+  // Adds the output file to the cache. Must be called after lookup().
+  void insert();
+
+private:
+  std::string computeKey(const llvm::opt::InputArgList &args);
+
+  StringRef dir;
+  llvm::CachePruningPolicy policy;
+  std::vector<std::pair<StringRef, MemoryBufferRef>> inputs;
+  llvm::lto::AddStreamFn addStream;
+};
+
+extern std::unique_ptr<LinkCache> linkCache;
+
+} // namespace elf
+} // namespace lld
+
+#endif
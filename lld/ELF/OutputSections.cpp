@@ -257,22 +257,41 @@ template <class ELFT> void OutputSection::maybeCompress() {
   using Elf_Chdr = typename ELFT::Chdr;
 
   // Compress only DWARF debug sections.
-  if (!config->compressDebugSections || (flags & SHF_ALLOC) ||
-      !name.startswith(".debug_"))
+  if (config->compressDebugSections == DebugCompressionKind::None ||
+      (flags & SHF_ALLOC) || !name.startswith(".debug_"))
     return;
+  bool useZstd = config->compressDebugSections == DebugCompressionKind::Zstd;
 
   // Create a section header.
   zDebugHeader.resize(sizeof(Elf_Chdr));
   auto *hdr = reinterpret_cast<Elf_Chdr *>(zDebugHeader.data());
-  hdr->ch_type = ELFCOMPRESS_ZLIB;
+  hdr->ch_type = useZstd ? ELFCOMPRESS_ZSTD : ELFCOMPRESS_ZLIB;
   hdr->ch_size = size;
   hdr->ch_addralign = alignment;
 
   // Write section contents to a temporary buffer and compress it.
   std::vector<uint8_t> buf(size);
   writeTo<ELFT>(buf.data());
-  if (Error e = zlib::compress(toStringRef(buf), compressedData))
-    fatal("compress failed: " + llvm::toString(std::move(e)));
+  if (!useZstd) {
+    if (Error e = zlib::compress(toStringRef(buf), compressedData))
+      fatal("compress failed: " + llvm::toString(std::move(e)));
+  } else {
+    // A zstd stream may consist of several frames, so the section is split
+    // into pieces that are compressed in parallel and then concatenated.
+    // There is always at least one frame, so that compressedData is not
+    // empty for an empty section.
+    const size_t pieceSize = 1 << 20;
+    size_t numPieces = std::max<size_t>(divideCeil(size, pieceSize), 1);
+    std::vector<SmallVector<char, 0>> pieces(numPieces);
+    parallelForEachN(0, numPieces, [&](size_t i) {
+      StringRef piece =
+          toStringRef(buf).slice(i * pieceSize, (i + 1) * pieceSize);
+      if (Error e = zstd::compress(piece, pieces[i]))
+        fatal("compress failed: " + llvm::toString(std::move(e)));
+    });
+    for (const SmallVector<char, 0> &piece : pieces)
+      compressedData.append(piece.begin(), piece.end());
+  }
 
   // Update section headers.
   size = sizeof(Elf_Chdr) + compressedData.size();
@@ -293,8 +312,16 @@ static void writeInt(uint8_t *buf, uint64_t data, uint64_t size) {
 }
 
 template <class ELFT> void OutputSection::writeTo(uint8_t *buf) {
+  std::vector<InputSection *> sections = beginWrite(buf);
+  parallelForEachN(0, sections.size(), [&](size_t i) {
+    writeInputSection<ELFT>(buf, sections, i);
+  });
+  endWrite(buf);
+}
+
+std::vector<InputSection *> OutputSection::beginWrite(uint8_t *buf) {
   if (type == SHT_NOBITS)
-    return;
+    return {};
 
   // If -compress-debug-section is specified and if this is a debug seciton,
   // we've already compressed section contents. If that's the case,
@@ -303,31 +330,40 @@ template <class ELFT> void OutputSection::writeTo(uint8_t *buf) {
     memcpy(buf, zDebugHeader.data(), zDebugHeader.size());
     memcpy(buf + zDebugHeader.size(), compressedData.data(),
            compressedData.size());
-    return;
+    return {};
   }
 
   // Write leading padding.
   std::vector<InputSection *> sections = getInputSections(this);
   std::array<uint8_t, 4> filler = getFiller();
-  bool nonZeroFiller = read32(filler.data()) != 0;
-  if (nonZeroFiller)
+  if (read32(filler.data()) != 0)
     fill(buf, sections.empty() ? size : sections[0]->outSecOff, filler);
+  return sections;
+}
 
-  parallelForEachN(0, sections.size(), [&](size_t i) {
-    InputSection *isec = sections[i];
-    isec->writeTo<ELFT>(buf);
-
-    // Fill gaps between sections.
-    if (nonZeroFiller) {
-      uint8_t *start = buf + isec->outSecOff + isec->getSize();
-      uint8_t *end;
-      if (i + 1 == sections.size())
-        end = buf + size;
-      else
-        end = buf + sections[i + 1]->outSecOff;
-      fill(start, end - start, filler);
-    }
-  });
+template <class ELFT>
+void OutputSection::writeInputSection(uint8_t *buf,
+                                      ArrayRef<InputSection *> sections,
+                                      size_t i) {
+  InputSection *isec = sections[i];
+  isec->writeTo<ELFT>(buf);
+
+  // Fill gaps between sections.
+  std::array<uint8_t, 4> filler = getFiller();
+  if (read32(filler.data()) != 0) {
+    uint8_t *start = buf + isec->outSecOff + isec->getSize();
+    uint8_t *end;
+    if (i + 1 == sections.size())
+      end = buf + size;
+    else
+      end = buf + sections[i + 1]->outSecOff;
+    fill(start, end - start, filler);
+  }
+}
+
+void OutputSection::endWrite(uint8_t *buf) {
+  if (type == SHT_NOBITS || !compressedData.empty())
+    return;
 
   // Linker scripts may have BYTE()-family commands with which you
   // can write arbitrary bytes to the output. Process them if any.
@@ -492,6 +528,15 @@ template void OutputSection::writeTo<ELF32BE>(uint8_t *Buf);
 template void OutputSection::writeTo<ELF64LE>(uint8_t *Buf);
 template void OutputSection::writeTo<ELF64BE>(uint8_t *Buf);
 
+template void OutputSection::writeInputSection<ELF32LE>(
+    uint8_t *, ArrayRef<InputSection *>, size_t);
+template void OutputSection::writeInputSection<ELF32BE>(
+    uint8_t *, ArrayRef<InputSection *>, size_t);
+template void OutputSection::writeInputSection<ELF64LE>(
+    uint8_t *, ArrayRef<InputSection *>, size_t);
+template void OutputSection::writeInputSection<ELF64BE>(
+    uint8_t *, ArrayRef<InputSection *>, size_t);
+
 template void OutputSection::maybeCompress<ELF32LE>();
 template void OutputSection::maybeCompress<ELF32BE>();
 template void OutputSection::maybeCompress<ELF64LE>();
@@ -104,6 +104,16 @@ public:
   template <class ELFT> void writeTo(uint8_t *buf);
   template <class ELFT> void maybeCompress();
 
+  // writeTo() consists of the following three steps. The writer calls
+  // them directly to write input sections of all output sections in a
+  // single parallel loop. beginWrite() returns the input sections to be
+  // written by writeInputSection().
+  std::vector<InputSection *> beginWrite(uint8_t *buf);
+  template <class ELFT>
+  void writeInputSection(uint8_t *buf, ArrayRef<InputSection *> sections,
+                         size_t i);
+  void endWrite(uint8_t *buf);
+
   void sort(llvm::function_ref<int(InputSectionBase *s)> order);
   void sortInitFini();
   void sortCtorsDtors();
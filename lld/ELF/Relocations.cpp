@@ -52,6 +52,7 @@
 #include "lld/Common/ErrorHandler.h"
 #include "lld/Common/Memory.h"
 #include "lld/Common/Strings.h"
+#include "lld/Common/Threads.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/raw_ostream.h"
@@ -1161,10 +1162,25 @@ static void processRelocAux(InputSectionBase &sec, RelExpr expr, RelType type,
               getLocation(sec, sym, offset));
 }
 
+namespace {
+// Properties of a relocation that depend only on the relocation itself and
+// the contents of the section it applies to. Unlike the rest of relocation
+// scanning, computing them doesn't mutate global state, so we compute them
+// for many sections in parallel beforehand. See scanRelocations().
+struct PreScannedReloc {
+  uint64_t offset;
+  int64_t addend;
+  RelExpr expr;
+};
+} // namespace
+
 template <class ELFT, class RelTy>
 static void scanReloc(InputSectionBase &sec, OffsetGetter &getOffset, RelTy *&i,
-                      RelTy *end) {
+                      RelTy *begin, RelTy *end,
+                      ArrayRef<PreScannedReloc> preScanned) {
   const RelTy &rel = *i;
+  const PreScannedReloc *pre =
+      preScanned.empty() ? nullptr : &preScanned[i - begin];
   uint32_t symIndex = rel.getSymbol(config->isMips64EL);
   Symbol &sym = sec.getFile<ELFT>()->getSymbol(symIndex);
   RelType type;
@@ -1178,7 +1194,7 @@ static void scanReloc(InputSectionBase &sec, OffsetGetter &getOffset, RelTy *&i,
   }
 
   // Get an offset in an output section this relocation is applied to.
-  uint64_t offset = getOffset.get(rel.r_offset);
+  uint64_t offset = pre ? pre->offset : getOffset.get(rel.r_offset);
   if (offset == uint64_t(-1))
     return;
 
@@ -1188,7 +1204,7 @@ static void scanReloc(InputSectionBase &sec, OffsetGetter &getOffset, RelTy *&i,
     return;
 
   const uint8_t *relocatedAddr = sec.data().begin() + rel.r_offset;
-  RelExpr expr = target->getRelExpr(type, sym, relocatedAddr);
+  RelExpr expr = pre ? pre->expr : target->getRelExpr(type, sym, relocatedAddr);
 
   // Ignore "hint" relocations because they are only markers for relaxation.
   if (oneof<R_HINT, R_NONE>(expr))
@@ -1216,7 +1232,8 @@ static void scanReloc(InputSectionBase &sec, OffsetGetter &getOffset, RelTy *&i,
   }
 
   // Read an addend.
-  int64_t addend = computeAddend<ELFT>(rel, end, sec, expr, sym.isLocal());
+  int64_t addend = pre ? pre->addend
+                       : computeAddend<ELFT>(rel, end, sec, expr, sym.isLocal());
 
   // Relax relocations.
   //
@@ -1385,14 +1402,15 @@ static void scanReloc(InputSectionBase &sec, OffsetGetter &getOffset, RelTy *&i,
 }
 
 template <class ELFT, class RelTy>
-static void scanRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels) {
+static void scanRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels,
+                       ArrayRef<PreScannedReloc> preScanned) {
   OffsetGetter getOffset(sec);
 
   // Not all relocations end up in Sec.Relocations, but a lot do.
   sec.relocations.reserve(rels.size());
 
   for (auto i = rels.begin(), end = rels.end(); i != end;)
-    scanReloc<ELFT>(sec, getOffset, i, end);
+    scanReloc<ELFT>(sec, getOffset, i, rels.begin(), end, preScanned);
 
   // Sort relocations by offset for more efficient searching for
   // R_RISCV_PCREL_HI20 and R_PPC64_ADDR64.
@@ -1404,11 +1422,90 @@ static void scanRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels) {
                       });
 }
 
-template <class ELFT> void scanRelocations(InputSectionBase &s) {
+template <class ELFT>
+static void scanRelocations(InputSectionBase &s,
+                            ArrayRef<PreScannedReloc> preScanned) {
   if (s.areRelocsRela)
-    scanRelocs<ELFT>(s, s.relas<ELFT>());
+    scanRelocs<ELFT>(s, s.relas<ELFT>(), preScanned);
   else
-    scanRelocs<ELFT>(s, s.rels<ELFT>());
+    scanRelocs<ELFT>(s, s.rels<ELFT>(), preScanned);
+}
+
+template <class ELFT> void scanRelocations(InputSectionBase &s) {
+  scanRelocations<ELFT>(s, {});
+}
+
+// Computes PreScannedReloc for each relocation. If a relocation looks
+// broken in a way that would be reported by scanReloc, leaves Out empty
+// so that the error is reported in the usual way.
+template <class ELFT, class RelTy>
+static void preScanRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels,
+                          std::vector<PreScannedReloc> &out) {
+  ObjFile<ELFT> *file = sec.getFile<ELFT>();
+  size_t numSyms = file->getSymbols().size();
+  const uint8_t *buf = sec.data().begin();
+
+  out.reserve(rels.size());
+  for (const RelTy &rel : rels) {
+    uint32_t symIndex = rel.getSymbol(config->isMips64EL);
+    if (symIndex >= numSyms) {
+      out.clear();
+      return;
+    }
+
+    Symbol &sym = *file->getSymbols()[symIndex];
+    RelType type = rel.getType(config->isMips64EL);
+    RelExpr expr = target->getRelExpr(type, sym, buf + rel.r_offset);
+    int64_t addend =
+        computeAddend<ELFT>(rel, rels.end(), sec, expr, sym.isLocal());
+    out.push_back({rel.r_offset, addend, expr});
+  }
+}
+
+// Scanning relocations consists of two parts. The first part classifies
+// each relocation, which involves reading the section contents to get
+// implicit addends and is a pure function of a relocation. The second
+// part creates GOT, PLT and dynamic relocations as needed, which mutates
+// synthetic sections and symbols and has to be done sequentially in a
+// deterministic order. For programs with many relocations, we do the
+// first part in parallel for a window of sections, and then do the second
+// part for the window in the usual order. The window keeps the memory
+// usage of the intermediate results bounded.
+template <class ELFT>
+void scanRelocations(ArrayRef<InputSectionBase *> sections) {
+  // MIPS relocations may have to be combined with their neighbors to be
+  // classified, so we don't pre-scan them.
+  if (!threadsEnabled || config->emachine == EM_MIPS) {
+    for (InputSectionBase *sec : sections)
+      scanRelocations<ELFT>(*sec);
+    return;
+  }
+
+  const size_t windowSize = 4096;
+  std::vector<std::vector<PreScannedReloc>> preScanned(
+      std::min(windowSize, sections.size()));
+
+  for (size_t begin = 0; begin < sections.size(); begin += windowSize) {
+    ArrayRef<InputSectionBase *> window = sections.slice(
+        begin, std::min(windowSize, sections.size() - begin));
+
+    parallelForEachN(0, window.size(), [&](size_t i) {
+      // EhInputSections need to translate offsets using OffsetGetter, so
+      // we don't pre-scan them.
+      InputSectionBase &sec = *window[i];
+      if (sec.numRelocations == 0 || !isa<InputSection>(sec))
+        return;
+      if (sec.areRelocsRela)
+        preScanRelocs<ELFT>(sec, sec.relas<ELFT>(), preScanned[i]);
+      else
+        preScanRelocs<ELFT>(sec, sec.rels<ELFT>(), preScanned[i]);
+    });
+
+    for (size_t i = 0; i < window.size(); ++i) {
+      scanRelocations<ELFT>(*window[i], preScanned[i]);
+      preScanned[i].clear();
+    }
+  }
 }
 
 static bool mergeCmp(const InputSection *a, const InputSection *b) {
@@ -1835,6 +1932,10 @@ template void scanRelocations<ELF32LE>(InputSectionBase &);
 template void scanRelocations<ELF32BE>(InputSectionBase &);
 template void scanRelocations<ELF64LE>(InputSectionBase &);
 template void scanRelocations<ELF64BE>(InputSectionBase &);
+template void scanRelocations<ELF32LE>(ArrayRef<InputSectionBase *>);
+template void scanRelocations<ELF32BE>(ArrayRef<InputSectionBase *>);
+template void scanRelocations<ELF64LE>(ArrayRef<InputSectionBase *>);
+template void scanRelocations<ELF64BE>(ArrayRef<InputSectionBase *>);
 template void reportUndefinedSymbols<ELF32LE>();
 template void reportUndefinedSymbols<ELF32BE>();
 template void reportUndefinedSymbols<ELF64LE>();
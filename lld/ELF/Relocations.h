@@ -112,6 +112,7 @@ struct Relocation {
 // Call reportUndefinedSymbols() after calling scanRelocations() to emit
 // the diagnostics.
 template <class ELFT> void scanRelocations(InputSectionBase &);
+template <class ELFT> void scanRelocations(ArrayRef<InputSectionBase *>);
 
 template <class ELFT> void reportUndefinedSymbols();
 
@@ -42,6 +42,13 @@ public:
   }
 
   Symbol *insert(StringRef name);
+  Symbol *insert(llvm::CachedHashStringRef key);
+
+  // Returns the key under which a symbol with a given name is stored.
+  // This function doesn't touch the symbol table, so it is safe to call
+  // from multiple threads. That allows us to hash symbol names in parallel
+  // even though symbol resolution itself is sequential.
+  static llvm::CachedHashStringRef getKey(StringRef name);
 
   Symbol *addSymbol(const Symbol &newSym);
 
@@ -30,12 +30,15 @@
 #include "llvm/ADT/SetOperations.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/BinaryFormat/Dwarf.h"
+#include "llvm/DebugInfo/DWARF/DWARFAcceleratorTable.h"
 #include "llvm/DebugInfo/DWARF/DWARFDebugPubTable.h"
 #include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Support/Compression.h"
+#include "llvm/Support/DJB.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/MD5.h"
+#include "llvm/Support/TimeProfiler.h"
 #include <cstdlib>
 #include <thread>
 
@@ -2803,6 +2806,336 @@ void GdbIndexSection::writeTo(uint8_t *buf) {
 
 bool GdbIndexSection::isNeeded() const { return !chunks.empty(); }
 
+DebugNamesSection::DebugNamesSection()
+    : SyntheticSection(0, SHT_PROGBITS, 4, ".debug_names") {}
+
+// Read the names of the .debug_names section of a single object file. The
+// compilation unit indices of the returned entries are indices into
+// chunk.cuOffsets.
+template <class ELFT>
+static std::vector<DebugNamesSection::NameEntry>
+readDebugNames(const LLDDwarfObj<ELFT> &obj, InputSection *sec,
+               InputSectionBase *strSec, DebugNamesSection::NamesChunk &chunk) {
+  std::vector<DebugNamesSection::NameEntry> ret;
+  DWARFDataExtractor namesData(obj, obj.getNamesSection(), config->isLE, 0);
+  DataExtractor strData(obj.getStrSection(), config->isLE, 0);
+  DWARFDebugNames debugNames(namesData, strData);
+  if (Error e = debugNames.extract()) {
+    error(toString(sec) + ": " + toString(std::move(e)));
+    return {};
+  }
+
+  DenseMap<uint64_t, uint32_t> cuIndices;
+  for (const DWARFDebugNames::NameIndex &ni : debugNames) {
+    // Map the compilation units of this name index to the ones of the chunk.
+    // An object file normally has a single name index, but may have one per
+    // compilation unit if it was created by a relocatable link.
+    std::vector<uint32_t> cuMap(ni.getCUCount());
+    for (uint32_t i = 0, e = ni.getCUCount(); i != e; ++i) {
+      uint64_t cuOffset = ni.getCUOffset(i);
+      auto it = cuIndices.insert({cuOffset, chunk.cuOffsets.size()});
+      if (it.second)
+        chunk.cuOffsets.push_back(cuOffset);
+      cuMap[i] = it.first->second;
+    }
+
+    for (const DWARFDebugNames::NameTableEntry &nte : ni) {
+      StringRef name = nte.getString();
+      DebugNamesSection::NameEntry ent{CachedHashStringRef(name),
+                                       caseFoldingDjbHash(name),
+                                       strSec,
+                                       nte.getStringOffset(),
+                                       {},
+                                       0};
+      uint64_t offset = nte.getEntryOffset();
+      Expected<DWARFDebugNames::Entry> entry = ni.getEntry(&offset);
+      for (; entry; entry = ni.getEntry(&offset)) {
+        // Entries of type units are dropped: the merged index only lists
+        // compilation units.
+        if (entry->lookup(dwarf::DW_IDX_type_unit))
+          continue;
+        Optional<uint64_t> cuIndex = entry->getCUIndex();
+        Optional<uint64_t> dieOffset = entry->getDIEUnitOffset();
+        if (!cuIndex || *cuIndex >= cuMap.size() || !dieOffset)
+          continue;
+        ent.entries.push_back(
+            {cuMap[*cuIndex], static_cast<uint32_t>(*dieOffset),
+             static_cast<uint32_t>(entry->tag())});
+      }
+      handleAllErrors(entry.takeError(),
+                      [](const DWARFDebugNames::SentinelError &) {},
+                      [&](const ErrorInfoBase &e) {
+                        error(toString(sec) + ": " + e.message());
+                      });
+      if (!ent.entries.empty())
+        ret.push_back(std::move(ent));
+    }
+  }
+  return ret;
+}
+
+// Merge the names of all chunks by uniquifying them by name.
+static std::vector<DebugNamesSection::NameEntry>
+mergeNames(MutableArrayRef<std::vector<DebugNamesSection::NameEntry>> nameVecs,
+           const std::vector<DebugNamesSection::NamesChunk> &chunks) {
+  using NameEntry = DebugNamesSection::NameEntry;
+
+  // For each chunk, compute the number of compilation units preceding it.
+  uint32_t cuIdx = 0;
+  std::vector<uint32_t> cuIdxs(chunks.size());
+  for (uint32_t i = 0, e = chunks.size(); i != e; ++i) {
+    cuIdxs[i] = cuIdx;
+    cuIdx += chunks[i].cuOffsets.size();
+  }
+
+  // Like the symbols of .gdb_index, there can be millions of names, so they
+  // are merged in shards using multiple threads. Each shard is processed by a
+  // single thread in input order, so the result doesn't depend on scheduling.
+  size_t numShards = 32;
+  size_t concurrency = 1;
+  if (threadsEnabled)
+    concurrency =
+        std::min<size_t>(PowerOf2Floor(hardware_concurrency()), numShards);
+
+  std::vector<DenseMap<CachedHashStringRef, size_t>> map(numShards);
+  size_t shift = 32 - countTrailingZeros(numShards);
+  std::vector<std::vector<NameEntry>> shards(numShards);
+  parallelForEachN(0, concurrency, [&](size_t threadId) {
+    for (size_t i = 0, e = nameVecs.size(); i != e; ++i) {
+      for (NameEntry &ent : nameVecs[i]) {
+        size_t shardId = ent.name.hash() >> shift;
+        if ((shardId & (concurrency - 1)) != threadId)
+          continue;
+
+        for (DebugNamesSection::IndexEntry &ie : ent.entries)
+          ie.cuIndex += cuIdxs[i];
+        size_t &idx = map[shardId][ent.name];
+        if (idx) {
+          std::vector<DebugNamesSection::IndexEntry> &entries =
+              shards[shardId][idx - 1].entries;
+          entries.insert(entries.end(), ent.entries.begin(),
+                         ent.entries.end());
+          continue;
+        }
+
+        idx = shards[shardId].size() + 1;
+        shards[shardId].push_back(std::move(ent));
+      }
+    }
+  });
+
+  size_t numNames = 0;
+  for (ArrayRef<NameEntry> v : shards)
+    numNames += v.size();
+
+  std::vector<NameEntry> ret;
+  ret.reserve(numNames);
+  for (std::vector<NameEntry> &vec : shards)
+    for (NameEntry &ent : vec)
+      ret.push_back(std::move(ent));
+  return ret;
+}
+
+// Returns a newly-created .debug_names section.
+template <class ELFT> DebugNamesSection *DebugNamesSection::create() {
+  std::vector<InputSection *> sections;
+  for (InputSectionBase *s : inputSections)
+    if (InputSection *isec = dyn_cast<InputSection>(s))
+      if (isec->name == ".debug_names" && isec->isLive())
+        sections.push_back(isec);
+
+  std::vector<NamesChunk> chunks(sections.size());
+  std::vector<std::vector<NameEntry>> nameVecs(sections.size());
+
+  parallelForEachN(0, sections.size(), [&](size_t i) {
+    ObjFile<ELFT> *file = sections[i]->getFile<ELFT>();
+    InputSectionBase *strSec = nullptr;
+    for (InputSectionBase *s : file->getSections()) {
+      if (!s)
+        continue;
+      if (s->name == ".debug_info")
+        chunks[i].infoSec = dyn_cast<InputSection>(s);
+      else if (s->name == ".debug_str")
+        strSec = s;
+    }
+    if (!chunks[i].infoSec || !strSec) {
+      error(toString(sections[i]) +
+            ": .debug_names requires .debug_info and .debug_str");
+      return;
+    }
+    DWARFContext dwarf(std::make_unique<LLDDwarfObj<ELFT>>(file));
+    nameVecs[i] = readDebugNames<ELFT>(
+        static_cast<const LLDDwarfObj<ELFT> &>(dwarf.getDWARFObj()),
+        sections[i], strSec, chunks[i]);
+  });
+
+  // The input name indices are replaced by the merged one.
+  for (InputSection *sec : sections)
+    sec->markDead();
+
+  auto *ret = make<DebugNamesSection>();
+  ret->names = mergeNames(nameVecs, chunks);
+  ret->chunks = std::move(chunks);
+  ret->initOutputSize();
+  return ret;
+}
+
+// Compute the hash table layout, the abbreviations and the output section
+// size.
+void DebugNamesSection::initOutputSize() {
+  for (NamesChunk &chunk : chunks)
+    numCUs += chunk.cuOffsets.size();
+
+  // Use the same bucket count heuristic as the compiler.
+  std::vector<uint32_t> hashes;
+  hashes.reserve(names.size());
+  for (NameEntry &ent : names)
+    hashes.push_back(ent.hashValue);
+  llvm::sort(hashes);
+  size_t uniqueHashCount =
+      std::unique(hashes.begin(), hashes.end()) - hashes.begin();
+  if (uniqueHashCount > 1024)
+    bucketCount = uniqueHashCount / 4;
+  else if (uniqueHashCount > 16)
+    bucketCount = uniqueHashCount / 2;
+  else
+    bucketCount = std::max<uint32_t>(uniqueHashCount, 1);
+
+  // Names of the same bucket must be adjacent. Sort them by hash within a
+  // bucket so that hash collisions end up together.
+  llvm::stable_sort(names, [&](const NameEntry &a, const NameEntry &b) {
+    return std::make_pair(a.hashValue % bucketCount, a.hashValue) <
+           std::make_pair(b.hashValue % bucketCount, b.hashValue);
+  });
+
+  // Each entry is an abbreviation code, a compilation unit index and a
+  // CU-relative DIE offset.
+  if (numCUs - 1 <= UINT8_MAX)
+    cuIndexSize = 1;
+  else if (numCUs - 1 <= UINT16_MAX)
+    cuIndexSize = 2;
+  else
+    cuIndexSize = 4;
+  DenseSet<uint32_t> tagSet;
+  for (NameEntry &ent : names)
+    for (IndexEntry &ie : ent.entries)
+      tagSet.insert(ie.tag);
+  tags.assign(tagSet.begin(), tagSet.end());
+  llvm::sort(tags);
+  DenseMap<uint32_t, uint32_t> tagSizes;
+  for (uint32_t i = 0, e = tags.size(); i != e; ++i)
+    tagSizes[tags[i]] = getULEB128Size(i + 1) + cuIndexSize + 4;
+
+  uint64_t entryPoolSize = 0;
+  for (NameEntry &ent : names) {
+    ent.entryOffset = entryPoolSize;
+    for (IndexEntry &ie : ent.entries)
+      entryPoolSize += tagSizes[ie.tag];
+    ++entryPoolSize;
+  }
+
+  // An abbreviation is its code and tag followed by two attribute and form
+  // pairs and a null pair. The table ends with a null code.
+  const dwarf::Form cuIndexForm = cuIndexSize == 1
+                                      ? dwarf::DW_FORM_data1
+                                      : cuIndexSize == 2 ? dwarf::DW_FORM_data2
+                                                         : dwarf::DW_FORM_data4;
+  abbrevTableSize = 1;
+  for (uint32_t i = 0, e = tags.size(); i != e; ++i)
+    abbrevTableSize += getULEB128Size(i + 1) + getULEB128Size(tags[i]) +
+                       getULEB128Size(dwarf::DW_IDX_compile_unit) +
+                       getULEB128Size(cuIndexForm) +
+                       getULEB128Size(dwarf::DW_IDX_die_offset) +
+                       getULEB128Size(dwarf::DW_FORM_ref4) + 2;
+
+  // The header is followed by the CU list, the buckets, the hashes, the
+  // string offsets, the entry offsets, the abbreviations and the entries.
+  size = 36 + numCUs * 4 + bucketCount * 4 + names.size() * 12 +
+         abbrevTableSize + entryPoolSize;
+  if (size > UINT32_MAX)
+    error(".debug_names: the merged index is too large");
+}
+
+void DebugNamesSection::writeTo(uint8_t *buf) {
+  // Write the header.
+  uint8_t *p = buf;
+  write32(p, size - 4);             // unit_length
+  write16(p + 4, 5);                // version
+  write16(p + 6, 0);                // padding
+  write32(p + 8, numCUs);           // comp_unit_count
+  write32(p + 12, 0);               // local_type_unit_count
+  write32(p + 16, 0);               // foreign_type_unit_count
+  write32(p + 20, bucketCount);     // bucket_count
+  write32(p + 24, names.size());    // name_count
+  write32(p + 28, abbrevTableSize); // abbrev_table_size
+  write32(p + 32, 0);               // augmentation_string_size
+  p += 36;
+
+  // Write the CU list.
+  for (NamesChunk &chunk : chunks) {
+    for (uint64_t cuOffset : chunk.cuOffsets) {
+      write32(p, chunk.infoSec->outSecOff + cuOffset);
+      p += 4;
+    }
+  }
+
+  // Write the buckets. Each one is the 1-based index of its first name.
+  uint8_t *buckets = p;
+  p += bucketCount * 4;
+  memset(buckets, 0, bucketCount * 4);
+  for (size_t i = names.size(); i != 0; --i)
+    write32(buckets + (names[i - 1].hashValue % bucketCount) * 4, i);
+
+  // Write the hashes, the string offsets and the entry offsets.
+  parallelForEachN(0, names.size(), [&](size_t i) {
+    const NameEntry &ent = names[i];
+    write32(p + i * 4, ent.hashValue);
+    write32(p + (names.size() + i) * 4, ent.strSec->getOffset(ent.strOffset));
+    write32(p + (names.size() * 2 + i) * 4, ent.entryOffset);
+  });
+  p += names.size() * 12;
+
+  // Write the abbreviations.
+  const dwarf::Form cuIndexForm = cuIndexSize == 1
+                                      ? dwarf::DW_FORM_data1
+                                      : cuIndexSize == 2 ? dwarf::DW_FORM_data2
+                                                         : dwarf::DW_FORM_data4;
+  DenseMap<uint32_t, uint32_t> codes;
+  for (uint32_t i = 0, e = tags.size(); i != e; ++i) {
+    codes[tags[i]] = i + 1;
+    p += encodeULEB128(i + 1, p);
+    p += encodeULEB128(tags[i], p);
+    p += encodeULEB128(dwarf::DW_IDX_compile_unit, p);
+    p += encodeULEB128(cuIndexForm, p);
+    p += encodeULEB128(dwarf::DW_IDX_die_offset, p);
+    p += encodeULEB128(dwarf::DW_FORM_ref4, p);
+    *p++ = 0;
+    *p++ = 0;
+  }
+  *p++ = 0;
+
+  // Write the entries. The names are independent of each other, so write
+  // them in parallel at the offsets computed beforehand.
+  parallelForEach(names, [&](const NameEntry &ent) {
+    uint8_t *q = p + ent.entryOffset;
+    for (const IndexEntry &ie : ent.entries) {
+      q += encodeULEB128(codes.lookup(ie.tag), q);
+      if (cuIndexSize == 1)
+        *q = ie.cuIndex;
+      else if (cuIndexSize == 2)
+        write16(q, ie.cuIndex);
+      else
+        write32(q, ie.cuIndex);
+      q += cuIndexSize;
+      write32(q, ie.dieOffset);
+      q += 4;
+    }
+    *q = 0;
+  });
+}
+
+bool DebugNamesSection::isNeeded() const { return !names.empty(); }
+
 EhFrameHeader::EhFrameHeader()
     : SyntheticSection(SHF_ALLOC, SHT_PROGBITS, 4, ".eh_frame_hdr") {}
 
@@ -3036,31 +3369,72 @@ void MergeSyntheticSection::addSection(MergeInputSection *ms) {
 
 MergeTailSection::MergeTailSection(StringRef name, uint32_t type,
                                    uint64_t flags, uint32_t alignment)
-    : MergeSyntheticSection(name, type, flags, alignment),
-      builder(StringTableBuilder::RAW, alignment) {}
+    : MergeSyntheticSection(name, type, flags, alignment) {}
 
-size_t MergeTailSection::getSize() const { return builder.getSize(); }
-
-void MergeTailSection::writeTo(uint8_t *buf) { builder.write(buf); }
+void MergeTailSection::writeTo(uint8_t *buf) {
+  for (size_t i = 0; i < numShards; ++i)
+    shards[i].write(buf + shardOffsets[i]);
+}
 
+// Tail merging sorts all strings by their reversed contents, which is
+// much slower than just deduplicating them. To use multiple cores, we
+// split strings into shards in such a way that a string and its suffixes
+// are always in the same shard, and tail-merge each shard independently.
+// Shard IDs are computed from contents, so the output doesn't depend on
+// the number of threads.
 void MergeTailSection::finalizeContents() {
-  // Add all string pieces to the string table builder to create section
-  // contents.
-  for (MergeInputSection *sec : sections)
-    for (size_t i = 0, e = sec->pieces.size(); i != e; ++i)
-      if (sec->pieces[i].live)
-        builder.add(sec->getData(i));
+  // Initializes string table builders.
+  for (size_t i = 0; i < numShards; ++i)
+    shards.emplace_back(StringTableBuilder::RAW, alignment);
+
+  // Concurrency level. Must be a power of 2 to avoid expensive modulo
+  // operations in the following tight loop.
+  size_t concurrency = 1;
+  if (threadsEnabled)
+    concurrency =
+        std::min<size_t>(PowerOf2Floor(hardware_concurrency()), numShards);
+
+  // Add all string pieces to the string table builders and fix their
+  // contents. After this, the contents will never change.
+  parallelForEachN(0, concurrency, [&](size_t threadId) {
+    llvm::TimeTraceScope timeScope("Tail merge strings", name);
+    for (MergeInputSection *sec : sections) {
+      for (size_t i = 0, e = sec->pieces.size(); i != e; ++i) {
+        if (!sec->pieces[i].live)
+          continue;
+        CachedHashStringRef s = sec->getData(i);
+        size_t shardId = getShardId(s.val());
+        if ((shardId & (concurrency - 1)) == threadId)
+          shards[shardId].add(s);
+      }
+    }
+    for (size_t i = threadId; i < numShards; i += concurrency)
+      shards[i].finalize();
+  });
 
-  // Fix the string table content. After this, the contents will never change.
-  builder.finalize();
+  // Compute an in-section offset for each shard.
+  size_t off = 0;
+  for (size_t i = 0; i < numShards; ++i) {
+    if (shards[i].getSize() > 0)
+      off = alignTo(off, alignment);
+    shardOffsets[i] = off;
+    off += shards[i].getSize();
+  }
+  size = off;
 
   // finalize() fixed tail-optimized strings, so we can now get
   // offsets of strings. Get an offset for each string and save it
   // to a corresponding SectionPiece for easy access.
-  for (MergeInputSection *sec : sections)
-    for (size_t i = 0, e = sec->pieces.size(); i != e; ++i)
-      if (sec->pieces[i].live)
-        sec->pieces[i].outputOff = builder.getOffset(sec->getData(i));
+  parallelForEach(sections, [&](MergeInputSection *sec) {
+    for (size_t i = 0, e = sec->pieces.size(); i != e; ++i) {
+      if (!sec->pieces[i].live)
+        continue;
+      CachedHashStringRef s = sec->getData(i);
+      size_t shardId = getShardId(s.val());
+      sec->pieces[i].outputOff =
+          shardOffsets[shardId] + shards[shardId].getOffset(s);
+    }
+  });
 }
 
 void MergeNoTailSection::writeTo(uint8_t *buf) {
@@ -3090,6 +3464,7 @@ void MergeNoTailSection::finalizeContents() {
 
   // Add section pieces to the builders.
   parallelForEachN(0, concurrency, [&](size_t threadId) {
+    llvm::TimeTraceScope timeScope("Merge strings", name);
     for (MergeInputSection *sec : sections) {
       for (size_t i = 0, e = sec->pieces.size(); i != e; ++i) {
         if (!sec->pieces[i].live)
@@ -3596,6 +3971,11 @@ template GdbIndexSection *GdbIndexSection::create<ELF32BE>();
 template GdbIndexSection *GdbIndexSection::create<ELF64LE>();
 template GdbIndexSection *GdbIndexSection::create<ELF64BE>();
 
+template DebugNamesSection *DebugNamesSection::create<ELF32LE>();
+template DebugNamesSection *DebugNamesSection::create<ELF32BE>();
+template DebugNamesSection *DebugNamesSection::create<ELF64LE>();
+template DebugNamesSection *DebugNamesSection::create<ELF64BE>();
+
 template void splitSections<ELF32LE>();
 template void splitSections<ELF32BE>();
 template void splitSections<ELF64LE>();
@@ -743,6 +743,62 @@ private:
   size_t size;
 };
 
+// --debug-names option tells linker to merge the DWARF v5 .debug_names
+// sections of the input files into a single name index, so that debuggers
+// don't have to look up each name in one index per object file.
+class DebugNamesSection final : public SyntheticSection {
+public:
+  // A DIE that a name refers to.
+  struct IndexEntry {
+    uint32_t cuIndex;
+    uint32_t dieOffset;
+    uint32_t tag;
+  };
+
+  struct NameEntry {
+    llvm::CachedHashStringRef name;
+    uint32_t hashValue;
+    // The string section and offset of the name in the first input file that
+    // has it. They are mapped to the output .debug_str offset when writing.
+    InputSectionBase *strSec;
+    uint64_t strOffset;
+    std::vector<IndexEntry> entries;
+    uint32_t entryOffset;
+  };
+
+  struct NamesChunk {
+    InputSection *infoSec = nullptr;
+    // Offsets of the indexed compilation units in infoSec.
+    std::vector<uint64_t> cuOffsets;
+  };
+
+  DebugNamesSection();
+  template <typename ELFT> static DebugNamesSection *create();
+  void writeTo(uint8_t *buf) override;
+  size_t getSize() const override { return size; }
+  bool isNeeded() const override;
+
+private:
+  void initOutputSize();
+
+  // Each chunk contains the compilation units indexed by the .debug_names
+  // section of a single object file.
+  std::vector<NamesChunk> chunks;
+
+  // The names of the merged index, sorted by bucket.
+  std::vector<NameEntry> names;
+
+  // The DIE tags of all entries. The abbreviation code of a tag is its index
+  // in this vector plus one.
+  std::vector<uint32_t> tags;
+
+  uint32_t numCUs = 0;
+  uint32_t bucketCount = 0;
+  uint32_t cuIndexSize = 0;
+  uint32_t abbrevTableSize = 0;
+  size_t size;
+};
+
 // --eh-frame-hdr option tells linker to construct a header for all the
 // .eh_frame sections. This header is placed to a section named .eh_frame_hdr
 // and also to a PT_GNU_EH_FRAME segment.
@@ -851,12 +907,26 @@ public:
   MergeTailSection(StringRef name, uint32_t type, uint64_t flags,
                    uint32_t alignment);
 
-  size_t getSize() const override;
+  size_t getSize() const override { return size; }
   void writeTo(uint8_t *buf) override;
   void finalizeContents() override;
 
 private:
-  llvm::StringTableBuilder builder;
+  // A string can be a suffix of another string only if their last non-null
+  // characters are the same, so we use that character as a shard ID. Each
+  // shard is tail-merged independently.
+  static size_t getShardId(StringRef s) {
+    s = s.rtrim('\0');
+    return s.empty() ? 0 : (uint8_t)s.back() % numShards;
+  }
+
+  // Section size
+  size_t size;
+
+  // String table contents
+  constexpr static size_t numShards = 32;
+  std::vector<llvm::StringTableBuilder> shards;
+  size_t shardOffsets[numShards];
 };
 
 class MergeNoTailSection final : public MergeSyntheticSection {
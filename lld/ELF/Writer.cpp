@@ -11,6 +11,7 @@
 #include "ARMErrataFix.h"
 #include "CallGraphSort.h"
 #include "Config.h"
+#include "Incremental.h"
 #include "LinkerScript.h"
 #include "MapFile.h"
 #include "OutputSections.h"
@@ -27,6 +28,7 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/RandomNumberGenerator.h"
 #include "llvm/Support/SHA1.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/xxhash.h"
 #include <climits>
 
@@ -56,7 +58,7 @@ private:
   void sortSections();
   void resolveShfLinkOrder();
   void finalizeAddressDependentContent();
-  void sortInputSections();
+  void sortInputSections(const DenseMap<const InputSectionBase *, int> &order);
   void finalizeSections();
   void checkExecuteOnly();
   void setReservedSymbolSections();
@@ -84,6 +86,12 @@ private:
 
   uint64_t fileSize;
   uint64_t sectionHeaderOff;
+
+  // The output section of the hot text if -z hot-text-align is in effect.
+  OutputSection *hotText = nullptr;
+
+  // Non-null if --incremental-state is in effect.
+  std::unique_ptr<IncrementalState> incremental;
 };
 } // anonymous namespace
 
@@ -497,6 +505,8 @@ template <class ELFT> void createSyntheticSections() {
 
   if (config->gdbIndex)
     add(GdbIndexSection::create<ELFT>());
+  if (config->debugNames)
+    add(DebugNamesSection::create<ELFT>());
 
   // We always need to add rel[a].plt to output if it has entries.
   // Even for static linking it can contain R_[*]_IRELATIVE relocations.
@@ -552,7 +562,10 @@ template <class ELFT> void Writer<ELFT>::run() {
   // completes section contents. For example, we need to add strings
   // to the string table, and add entries to .got and .plt.
   // finalizeSections does that.
-  finalizeSections();
+  {
+    llvm::TimeTraceScope timeScope("Finalize sections");
+    finalizeSections();
+  }
   checkExecuteOnly();
   if (errorCount())
     return;
@@ -590,23 +603,39 @@ template <class ELFT> void Writer<ELFT>::run() {
   // It does not make sense try to open the file if we have error already.
   if (errorCount())
     return;
+
+  // The previous output has to be examined before openFile() removes it.
+  if (!config->incrementalState.empty() && !config->oFormatBinary &&
+      !config->copyRelocs && config->emachine != EM_MIPS) {
+    incremental = std::make_unique<IncrementalState>();
+    incremental->prepare<ELFT>(fileSize);
+  }
+
   // Write the result down to a file.
   openFile();
   if (errorCount())
     return;
 
   if (!config->oFormatBinary) {
+    if (incremental)
+      incremental->copyPreviousOutput(Out::bufferStart);
     if (config->zSeparate != SeparateSegmentKind::None)
       writeTrapInstr();
     writeHeader();
-    writeSections();
+    {
+      llvm::TimeTraceScope timeScope("Write sections");
+      writeSections();
+    }
   } else {
     writeSectionsBinary();
   }
 
   // Backfill .note.gnu.build-id section content. This is done at last
   // because the content is usually a hash value of the entire output file.
-  writeBuildId();
+  {
+    llvm::TimeTraceScope timeScope("Write build ID");
+    writeBuildId();
+  }
   if (errorCount())
     return;
 
@@ -616,8 +645,13 @@ template <class ELFT> void Writer<ELFT>::run() {
   if (errorCount())
     return;
 
-  if (auto e = buffer->commit())
+  if (auto e = buffer->commit()) {
     error("failed to write to the output file: " + toString(std::move(e)));
+    return;
+  }
+
+  if (incremental)
+    incremental->save();
 }
 
 static bool shouldKeepInSymtab(const Defined &sym) {
@@ -1262,11 +1296,23 @@ sortISDBySectionOrder(InputSectionDescription *isd,
                       const DenseMap<const InputSectionBase *, int> &order) {
   std::vector<InputSection *> unorderedSections;
   std::vector<std::pair<InputSection *, int>> orderedSections;
+  std::vector<InputSection *> coldSections;
   uint64_t unorderedSize = 0;
 
+  // When sorting by call graph profile, the sections that the compiler found
+  // to be cold with the same profile are placed after all the other ones, so
+  // that they don't take up room in the pages and cache lines of the code
+  // that runs.
+  bool splitCold = !config->callGraphProfile.empty();
+
   for (InputSection *isec : isd->sections) {
     auto i = order.find(isec);
     if (i == order.end()) {
+      if (splitCold && (isec->name == ".text.unlikely" ||
+                        isec->name.startswith(".text.unlikely."))) {
+        coldSections.push_back(isec);
+        continue;
+      }
       unorderedSections.push_back(isec);
       unorderedSize += isec->getSize();
       continue;
@@ -1319,6 +1365,8 @@ sortISDBySectionOrder(InputSectionDescription *isd,
     isd->sections.push_back(p.first);
   for (InputSection *isec : makeArrayRef(unorderedSections).slice(insPt))
     isd->sections.push_back(isec);
+  for (InputSection *isec : coldSections)
+    isd->sections.push_back(isec);
 }
 
 static void sortSection(OutputSection *sec,
@@ -1372,15 +1420,75 @@ static void sortSection(OutputSection *sec,
 
 // If no layout was provided by linker script, we want to apply default
 // sorting for special input sections. This also handles --symbol-ordering-file.
-template <class ELFT> void Writer<ELFT>::sortInputSections() {
-  // Build the order once since it is expensive.
-  DenseMap<const InputSectionBase *, int> order = buildSectionOrder();
+template <class ELFT>
+void Writer<ELFT>::sortInputSections(
+    const DenseMap<const InputSectionBase *, int> &order) {
   for (BaseCommand *base : script->sectionCommands)
     if (auto *sec = dyn_cast<OutputSection>(base))
       sortSection(sec, order);
 }
 
+// For -z hot-text-align, moves the hot sections of .text to an output section
+// of their own in front of it, which is then given a segment aligned for huge
+// pages. The hot sections are those that --symbol-ordering-file or the call
+// graph profile order, and those the compiler put in .text.hot. Returns the
+// output section, or null if there is no hot text.
+static OutputSection *
+splitHotText(const DenseMap<const InputSectionBase *, int> &order) {
+  auto findSection = [](StringRef name) {
+    return llvm::find_if(script->sectionCommands, [=](BaseCommand *base) {
+      auto *sec = dyn_cast_or_null<OutputSection>(base);
+      return sec && sec->name == name && sec->partition == 1;
+    });
+  };
+  auto textIt = findSection(".text");
+  auto hotIt = findSection(".text.hot");
+  OutputSection *hot = hotIt == script->sectionCommands.end()
+                           ? nullptr
+                           : cast<OutputSection>(*hotIt);
+  if (textIt == script->sectionCommands.end())
+    return hot;
+
+  std::vector<InputSection *> hotSections;
+  for (BaseCommand *base : cast<OutputSection>(*textIt)->sectionCommands)
+    if (auto *isd = dyn_cast<InputSectionDescription>(base))
+      llvm::erase_if(isd->sections, [&](InputSection *isec) {
+        if (!order.count(isec) && isec->name != ".text.hot" &&
+            !isSectionPrefix(".text.hot.", isec->name))
+          return false;
+        hotSections.push_back(isec);
+        return true;
+      });
+  if (hotSections.empty())
+    return hot;
+
+  // -z keep-text-section-prefix may have created the section already.
+  if (!hot) {
+    hot = make<OutputSection>(".text.hot", SHT_PROGBITS,
+                              SHF_ALLOC | SHF_EXECINSTR);
+    hot->partition = 1;
+    script->sectionCommands.insert(textIt, hot);
+  }
+  auto *isd = make<InputSectionDescription>("");
+  hot->sectionCommands.push_back(isd);
+  for (InputSection *isec : hotSections) {
+    isd->sections.push_back(isec);
+    hot->commitSection(isec);
+  }
+  return hot;
+}
+
 template <class ELFT> void Writer<ELFT>::sortSections() {
+  // Build the order once since it is expensive.
+  DenseMap<const InputSectionBase *, int> order;
+  if (!config->relocatable) {
+    order = buildSectionOrder();
+    // Split before the empty sections are removed, in case .text is left
+    // empty. A linker script decides the layout itself.
+    if (config->zHotTextAlign && !script->hasSectionsCommand)
+      hotText = splitHotText(order);
+  }
+
   script->adjustSectionsBeforeSorting();
 
   // Don't sort if using -r. It is not necessary and we want to preserve the
@@ -1388,7 +1496,7 @@ template <class ELFT> void Writer<ELFT>::sortSections() {
   if (config->relocatable)
     return;
 
-  sortInputSections();
+  sortInputSections(order);
 
   for (BaseCommand *base : script->sectionCommands) {
     auto *os = dyn_cast<OutputSection>(base);
@@ -1746,7 +1854,10 @@ template <class ELFT> void Writer<ELFT>::finalizeSections() {
   // after processSymbolAssignments() because it needs to know whether a
   // linker-script-defined symbol is absolute.
   if (!config->relocatable) {
-    forEachRelSec(scanRelocations<ELFT>);
+    llvm::TimeTraceScope timeScope("Scan relocations");
+    std::vector<InputSectionBase *> relSecs;
+    forEachRelSec([&](InputSectionBase &sec) { relSecs.push_back(&sec); });
+    scanRelocations<ELFT>(relSecs);
     reportUndefinedSymbols<ELFT>();
   }
 
@@ -2138,11 +2249,17 @@ std::vector<PhdrEntry *> Writer<ELFT>::createPhdrs(Partition &part) {
           (sec->lmaRegion && (sec->lmaRegion != load->firstSec->lmaRegion))) &&
          load->lastSec != Out::programHeaders) ||
         sec->memRegion != load->firstSec->memRegion || flags != newFlags ||
-        sec == relroEnd) {
+        sec == relroEnd || (hotText && (sec == hotText ||
+                                        load->lastSec == hotText))) {
       load = addHdr(PT_LOAD, newFlags);
       flags = newFlags;
     }
 
+    // The hot text segment is aligned in the file too, so that the pages of
+    // the file can be mapped as huge pages.
+    if (sec == hotText)
+      load->p_align = std::max<uint64_t>(load->p_align, config->zHotTextAlign);
+
     load->add(sec);
   }
 
@@ -2241,7 +2358,15 @@ template <class ELFT> void Writer<ELFT>::fixSectionAlignments() {
       // maximum page size boundary so that we can find the ELF header at the
       // start. We cannot benefit from overlapping p_offset ranges with the
       // previous segment anyway.
-      if (config->zSeparate == SeparateSegmentKind::Loadable ||
+      //
+      // With -z hot-text-align, the hot text segment starts on a boundary of
+      // that alignment, and so does the next segment, so that the huge pages
+      // which hold it hold no other segment and can be remapped.
+      if (hotText && (cmd == hotText || (prev && prev->lastSec == hotText)))
+        cmd->addrExpr = [] {
+          return alignTo(script->getDot(), config->zHotTextAlign);
+        };
+      else if (config->zSeparate == SeparateSegmentKind::Loadable ||
           (config->zSeparate == SeparateSegmentKind::Code && prev &&
            (prev->p_flags & PF_X) != (p->p_flags & PF_X)) ||
           cmd->type == SHT_LLVM_PART_EHDR)
@@ -2656,9 +2781,35 @@ template <class ELFT> void Writer<ELFT>::writeSections() {
     if (sec->type == SHT_REL || sec->type == SHT_RELA)
       sec->writeTo<ELFT>(Out::bufferStart + sec->offset);
 
-  for (OutputSection *sec : outputSections)
-    if (sec->type != SHT_REL && sec->type != SHT_RELA)
-      sec->writeTo<ELFT>(Out::bufferStart + sec->offset);
+  // Writing each output section with its own parallel loop leaves most
+  // threads idle while small output sections are written, and makes a
+  // large output section at the end of the file wait for all preceding
+  // ones. Instead, we write input sections of all output sections in a
+  // single parallel loop.
+  std::vector<OutputSection *> secs;
+  std::vector<std::vector<InputSection *>> isecs;
+  for (OutputSection *sec : outputSections) {
+    if (sec->type == SHT_REL || sec->type == SHT_RELA ||
+        (incremental && incremental->canReuse(sec)))
+      continue;
+    secs.push_back(sec);
+    isecs.push_back(sec->beginWrite(Out::bufferStart + sec->offset));
+  }
+
+  std::vector<std::pair<size_t, size_t>> pieces;
+  for (size_t i = 0, e = secs.size(); i != e; ++i)
+    for (size_t j = 0, f = isecs[i].size(); j != f; ++j)
+      pieces.push_back({i, j});
+
+  parallelForEach(pieces, [&](std::pair<size_t, size_t> p) {
+    llvm::TimeTraceScope timeScope("Write input section");
+    OutputSection *sec = secs[p.first];
+    sec->writeInputSection<ELFT>(Out::bufferStart + sec->offset,
+                                 isecs[p.first], p.second);
+  });
+
+  for (OutputSection *sec : secs)
+    sec->endWrite(Out::bufferStart + sec->offset);
 }
 
 // Split one uint8 array into small pieces of uint8 arrays.
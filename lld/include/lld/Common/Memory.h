@@ -27,8 +27,11 @@
 
 namespace lld {
 
-// Use this arena if your object doesn't have a destructor.
-extern llvm::BumpPtrAllocator bAlloc;
+// Use this arena if your object doesn't have a destructor. It is safe to
+// allocate from multiple threads.
+extern llvm::ThreadLocalBumpPtrAllocator bAlloc;
+
+// Unlike bAlloc, this is not thread-safe.
 extern llvm::StringSaver saver;
 
 void freeArena();
@@ -36,22 +39,26 @@ void freeArena();
 // These two classes are hack to keep track of all
 // SpecificBumpPtrAllocator instances.
 struct SpecificAllocBase {
-  SpecificAllocBase() { instances.push_back(this); }
+  SpecificAllocBase();
   virtual ~SpecificAllocBase() = default;
   virtual void reset() = 0;
   static std::vector<SpecificAllocBase *> instances;
 };
 
 template <class T> struct SpecificAlloc : public SpecificAllocBase {
-  void reset() override { alloc.DestroyAll(); }
-  llvm::SpecificBumpPtrAllocator<T> alloc;
+  void reset() override {
+    alloc.forEach([](llvm::SpecificBumpPtrAllocator<T> &a) { a.DestroyAll(); });
+  }
+  llvm::ThreadLocalAllocator<llvm::SpecificBumpPtrAllocator<T>> alloc;
 };
 
 // Use this arena if your object has a destructor.
 // Your destructor will be invoked from freeArena().
+// It is safe to call this function from multiple threads.
 template <typename T, typename... U> T *make(U &&... args) {
   static SpecificAlloc<T> alloc;
-  return new (alloc.alloc.Allocate()) T(std::forward<U>(args)...);
+  return new (alloc.alloc.getThreadAllocator().Allocate())
+      T(std::forward<U>(args)...);
 }
 
 } // namespace lld
@@ -712,6 +712,14 @@ void LinkerDriver::link(ArrayRef<const char *> argsArr) {
 
   // Add all files to the symbol table. This will add almost all
   // symbols that we need to the symbol table.
+  //
+  // Symbol resolution is sequential, but decoding object files given
+  // directly on the command line can be done in parallel beforehand.
+  parallelForEach(files, [](InputFile *f) {
+    if (auto *obj = dyn_cast<ObjFile>(f))
+      obj->parseBinary();
+  });
+
   for (InputFile *f : files)
     symtab->addFile(f);
   if (errorCount())
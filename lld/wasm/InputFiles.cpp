@@ -234,19 +234,35 @@ static void setRelocs(const std::vector<T *> &chunks,
   }
 }
 
+void ObjFile::parseBinary() {
+  Expected<std::unique_ptr<Binary>> binOrErr = createBinary(mb);
+  if (!binOrErr) {
+    consumeError(binOrErr.takeError());
+    return;
+  }
+
+  auto *obj = dyn_cast<WasmObjectFile>(binOrErr->get());
+  if (obj && obj->isRelocatableObject()) {
+    binOrErr->release();
+    wasmObj.reset(obj);
+  }
+}
+
 void ObjFile::parse(bool ignoreComdats) {
-  // Parse a memory buffer as a wasm file.
+  // Parse a memory buffer as a wasm file unless parseBinary() already did.
   LLVM_DEBUG(dbgs() << "Parsing object: " << toString(this) << "\n");
-  std::unique_ptr<Binary> bin = CHECK(createBinary(mb), toString(this));
+  if (!wasmObj) {
+    std::unique_ptr<Binary> bin = CHECK(createBinary(mb), toString(this));
 
-  auto *obj = dyn_cast<WasmObjectFile>(bin.get());
-  if (!obj)
-    fatal(toString(this) + ": not a wasm file");
-  if (!obj->isRelocatableObject())
-    fatal(toString(this) + ": not a relocatable wasm file");
+    auto *obj = dyn_cast<WasmObjectFile>(bin.get());
+    if (!obj)
+      fatal(toString(this) + ": not a wasm file");
+    if (!obj->isRelocatableObject())
+      fatal(toString(this) + ": not a relocatable wasm file");
 
-  bin.release();
-  wasmObj.reset(obj);
+    bin.release();
+    wasmObj.reset(obj);
+  }
 
   // Build up a map of function indices to table indices for use when
   // verifying the existing table index relocations
@@ -97,6 +97,11 @@ public:
 
   void parse(bool ignoreComdats = false);
 
+  // Parses the underlying wasm file ahead of parse(). This doesn't access
+  // the symbol table, so it can be called for multiple files in parallel.
+  // Errors are ignored here and reported by parse().
+  void parseBinary();
+
   // Returns the underlying wasm file.
   const WasmObjectFile *getWasmObj() const { return wasmObj.get(); }
 
@@ -51,6 +51,8 @@ public:
 
   FileSpec GetClangModulesCachePath() const;
   bool SetClangModulesCachePath(llvm::StringRef path);
+  FileSpec GetIndexCachePath() const;
+  bool SetIndexCachePath(llvm::StringRef path);
   bool GetEnableExternalLookup() const;
   bool SetEnableExternalLookup(bool new_value);
 }; 
@@ -183,6 +185,11 @@ public:
 
   void LogUUIDAndPaths(Log *log, const char *prefix_cstr);
 
+  /// Preload the symbols of all modules in this list, in parallel.
+  ///
+  /// \see Module::PreloadSymbols()
+  void PreloadSymbols() const;
+
   std::recursive_mutex &GetMutex() const { return m_modules_mutex; }
 
   size_t GetIndexForModule(const Module *module) const;
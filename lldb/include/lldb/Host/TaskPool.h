@@ -82,6 +82,9 @@ template <> struct TaskPool::RunTaskImpl<> {
 // Run 'func' on every value from begin .. end-1.  Each worker will grab
 // 'batch_size' numbers at a time to work on, so for very fast functions, batch
 // should be large enough to avoid too much cache line contention.
+// Call func for each integer in [begin, end) on the task pool, and wait until
+// all calls are done. The calling thread runs some of the calls, so this can
+// be nested: func can itself call TaskMapOverInt.
 void TaskMapOverInt(size_t begin, size_t end,
                     const llvm::function_ref<void(size_t)> &func);
 
@@ -212,10 +212,16 @@ public:
 
   /// Locates or creates a module given by \p file and updates/loads the
   /// resulting module at the virtual base address \p base_addr.
+  ///
+  /// If \p notify is false, a module that is added to the target isn't
+  /// reported to it, and the caller must call Target::ModulesDidLoad() with
+  /// all the modules it loads. This lets the target preload the symbols of all
+  /// of them in parallel.
   virtual lldb::ModuleSP LoadModuleAtAddress(const lldb_private::FileSpec &file,
                                              lldb::addr_t link_map_addr,
                                              lldb::addr_t base_addr,
-                                             bool base_addr_is_offset);
+                                             bool base_addr_is_offset,
+                                             bool notify = true);
 
   /// Get information about the shared cache for a process, if possible.
   ///
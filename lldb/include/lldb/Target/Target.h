@@ -33,6 +33,7 @@
 #include "lldb/Utility/LLDBAssert.h"
 #include "lldb/Utility/Timeout.h"
 #include "lldb/lldb-public.h"
+#include "llvm/ADT/StringMap.h"
 
 namespace lldb_private {
 
@@ -135,6 +136,8 @@ public:
 
   bool GetEnableNotifyAboutFixIts() const;
 
+  bool GetEnableCacheExpressions() const;
+
   bool GetEnableSaveObjects() const;
 
   bool GetEnableSyntheticValue() const;
@@ -1044,6 +1047,21 @@ public:
                                const EvaluateExpressionOptions &options,
                                ValueObject *ctx_obj, Status &error);
 
+  /// Return the expression that an earlier evaluation parsed for \p key, if
+  /// it can run in \p exe_ctx.
+  ///
+  /// UserExpression::Evaluate() uses this to avoid parsing the same
+  /// expression again, e.g. when a breakpoint command evaluates it at each
+  /// stop. The cache is cleared when modules are loaded or unloaded, and when
+  /// the process goes away.
+  lldb::UserExpressionSP GetCachedUserExpression(llvm::StringRef key,
+                                                 ExecutionContext &exe_ctx);
+
+  void CacheUserExpression(llvm::StringRef key,
+                           const lldb::UserExpressionSP &user_expression_sp);
+
+  void ClearUserExpressionCache();
+
   // Creates a FunctionCaller for the given language, the rest of the
   // parameters have the same meaning as for the FunctionCaller constructor.
   // Since a FunctionCaller can't be
@@ -1320,6 +1338,9 @@ protected:
   lldb::ClangASTImporterSP m_ast_importer_sp;
   lldb::ClangModulesDeclVendorUP m_clang_modules_decl_vendor_up;
 
+  std::mutex m_user_expression_cache_mutex;
+  llvm::StringMap<lldb::UserExpressionSP> m_user_expression_cache;
+
   lldb::SourceManagerUP m_source_manager_up;
 
   typedef std::map<lldb::user_id_t, StopHookSP> StopHookCollection;
@@ -152,7 +152,8 @@ DynamicLoader::GetSectionListFromModule(const ModuleSP module) const {
 ModuleSP DynamicLoader::LoadModuleAtAddress(const FileSpec &file,
                                             addr_t link_map_addr,
                                             addr_t base_addr,
-                                            bool base_addr_is_offset) {
+                                            bool base_addr_is_offset,
+                                            bool notify) {
   Target &target = m_process->GetTarget();
   ModuleList &modules = target.GetImages();
   ModuleSpec module_spec(file, target.GetArchitecture());
@@ -164,8 +165,7 @@ ModuleSP DynamicLoader::LoadModuleAtAddress(const FileSpec &file,
     return module_sp;
   }
 
-  if ((module_sp = target.GetOrCreateModule(module_spec, 
-                                            true /* notify */))) {
+  if ((module_sp = target.GetOrCreateModule(module_spec, notify))) {
     UpdateLoadedSections(module_sp, link_map_addr, base_addr,
                          base_addr_is_offset);
     return module_sp;
@@ -201,8 +201,7 @@ ModuleSP DynamicLoader::LoadModuleAtAddress(const FileSpec &file,
         return module_sp;
       }
 
-      if ((module_sp = target.GetOrCreateModule(new_module_spec, 
-                                                true /* notify */))) {
+      if ((module_sp = target.GetOrCreateModule(new_module_spec, notify))) {
         UpdateLoadedSections(module_sp, link_map_addr, base_addr, false);
         return module_sp;
       }
@@ -211,7 +210,7 @@ ModuleSP DynamicLoader::LoadModuleAtAddress(const FileSpec &file,
 
   if ((module_sp = m_process->ReadModuleFromMemory(file, base_addr))) {
     UpdateLoadedSections(module_sp, link_map_addr, base_addr, false);
-    target.GetImages().AppendIfNeeded(module_sp);
+    target.GetImages().AppendIfNeeded(module_sp, notify);
   }
 
   return module_sp;
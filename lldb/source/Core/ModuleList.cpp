@@ -11,6 +11,7 @@
 #include "lldb/Core/Module.h"
 #include "lldb/Core/ModuleSpec.h"
 #include "lldb/Host/FileSystem.h"
+#include "lldb/Host/TaskPool.h"
 #include "lldb/Interpreter/OptionValueFileSpec.h"
 #include "lldb/Interpreter/OptionValueProperties.h"
 #include "lldb/Interpreter/Property.h"
@@ -106,6 +107,18 @@ bool ModuleListProperties::SetClangModulesCachePath(llvm::StringRef path) {
       nullptr, ePropertyClangModulesCachePath, path);
 }
 
+FileSpec ModuleListProperties::GetIndexCachePath() const {
+  return m_collection_sp
+      ->GetPropertyAtIndexAsOptionValueFileSpec(nullptr, false,
+                                                ePropertyIndexCachePath)
+      ->GetCurrentValue();
+}
+
+bool ModuleListProperties::SetIndexCachePath(llvm::StringRef path) {
+  return m_collection_sp->SetPropertyAtIndexAsString(
+      nullptr, ePropertyIndexCachePath, path);
+}
+
 ModuleList::ModuleList()
     : m_modules(), m_modules_mutex(), m_notifier(nullptr) {}
 
@@ -612,6 +625,20 @@ void ModuleList::Dump(Stream *s) const {
   }
 }
 
+void ModuleList::PreloadSymbols() const {
+  // Don't hold the list's mutex while the symbols are loaded.
+  collection modules;
+  {
+    std::lock_guard<std::recursive_mutex> guard(m_modules_mutex);
+    modules = m_modules;
+  }
+  // Each module is locked while its symbols are loaded, so modules can be
+  // preloaded in parallel. Loading the symbols of a module is parallel too,
+  // which TaskMapOverInt supports.
+  TaskMapOverInt(0, modules.size(),
+                 [&modules](size_t i) { modules[i]->PreloadSymbols(); });
+}
+
 void ModuleList::LogUUIDAndPaths(Log *log, const char *prefix_cstr) {
   if (log != nullptr) {
     std::lock_guard<std::recursive_mutex> guard(m_modules_mutex);
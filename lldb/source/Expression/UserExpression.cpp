@@ -138,6 +138,42 @@ lldb::addr_t UserExpression::GetObjectPointer(lldb::StackFrameSP frame_sp,
   return ret;
 }
 
+/// Return the key the expression is cached under in the target, or an empty
+/// string if its parse can't be reused.
+static std::string GetExpressionCacheKey(
+    ExecutionContext &exe_ctx, const EvaluateExpressionOptions &options,
+    llvm::StringRef expr, llvm::StringRef prefix, lldb::LanguageType language,
+    Expression::ResultType desired_type, ExecutionPolicy execution_policy,
+    ValueObject *ctx_obj) {
+  // Expressions that declare persistent variables or types ($-names) or are
+  // top level have effects at parse time, which reusing them would skip.
+  if (ctx_obj || options.GetREPLEnabled() ||
+      execution_policy == eExecutionPolicyTopLevel || expr.contains('$') ||
+      prefix.contains('$'))
+    return std::string();
+
+  // The names in the expression are looked up in the scope of the frame.
+  const void *block = nullptr;
+  const void *function = nullptr;
+  const void *symbol = nullptr;
+  if (StackFrame *frame = exe_ctx.GetFramePtr()) {
+    const SymbolContext &sc = frame->GetSymbolContext(
+        lldb::eSymbolContextFunction | lldb::eSymbolContextBlock |
+        lldb::eSymbolContextSymbol);
+    block = sc.block;
+    function = sc.function;
+    symbol = sc.symbol;
+  }
+
+  std::string key;
+  llvm::raw_string_ostream os(key);
+  os << block << ',' << function << ',' << symbol << ',' << language << ','
+     << desired_type << ',' << execution_policy << ','
+     << options.GetGenerateDebugInfo() << ',' << options.IsForUtilityExpr()
+     << ',' << prefix.size() << ',' << prefix << expr;
+  return os.str();
+}
+
 lldb::ExpressionResults UserExpression::Evaluate(
     ExecutionContext &exe_ctx, const EvaluateExpressionOptions &options,
     llvm::StringRef expr, llvm::StringRef prefix,
@@ -219,21 +255,36 @@ lldb::ExpressionResults UserExpression::Evaluate(
       language = frame->GetLanguage();
   }
 
-  lldb::UserExpressionSP user_expression_sp(
-      target->GetUserExpressionForLanguage(expr, full_prefix, language,
-                                           desired_type, options, ctx_obj,
-                                           error));
-  if (error.Fail()) {
+  // Evaluating the same expression again in the same scope, as a breakpoint
+  // command does on every stop, reuses what the previous evaluation parsed.
+  const std::string cache_key =
+      GetExpressionCacheKey(exe_ctx, options, expr, full_prefix, language,
+                            desired_type, execution_policy, ctx_obj);
+  lldb::UserExpressionSP user_expression_sp;
+  if (!cache_key.empty())
+    user_expression_sp = target->GetCachedUserExpression(cache_key, exe_ctx);
+  const bool is_cached = bool(user_expression_sp);
+
+  if (is_cached) {
+    LLDB_LOGF(log, "== [UserExpression::Evaluate] Reusing parsed expression "
+                   "%s ==",
+              expr.str().c_str());
+  } else {
+    user_expression_sp.reset(target->GetUserExpressionForLanguage(
+        expr, full_prefix, language, desired_type, options, ctx_obj, error));
+    if (error.Fail()) {
+      if (log)
+        LLDB_LOGF(log,
+                  "== [UserExpression::Evaluate] Getting expression: %s ==",
+                  error.AsCString());
+      return lldb::eExpressionSetupError;
+    }
+
     if (log)
-      LLDB_LOGF(log, "== [UserExpression::Evaluate] Getting expression: %s ==",
-                error.AsCString());
-    return lldb::eExpressionSetupError;
+      LLDB_LOGF(log, "== [UserExpression::Evaluate] Parsing expression %s ==",
+                expr.str().c_str());
   }
 
-  if (log)
-    LLDB_LOGF(log, "== [UserExpression::Evaluate] Parsing expression %s ==",
-              expr.str().c_str());
-
   const bool keep_expression_in_memory = true;
   const bool generate_debug_info = options.GetGenerateDebugInfo();
 
@@ -247,6 +298,7 @@ lldb::ExpressionResults UserExpression::Evaluate(
   DiagnosticManager diagnostic_manager;
 
   bool parse_success =
+      is_cached ||
       user_expression_sp->Parse(diagnostic_manager, exe_ctx, execution_policy,
                                 keep_expression_in_memory, generate_debug_info);
 
@@ -301,6 +353,11 @@ lldb::ExpressionResults UserExpression::Evaluate(
   }
 
   if (parse_success) {
+    // Only cache the expression as it was written, not a fixed version of it.
+    if (!is_cached && !cache_key.empty() &&
+        (fixed_expression == nullptr || fixed_expression->empty()))
+      target->CacheUserExpression(cache_key, user_expression_sp);
+
     // If a pointer to a lldb::ModuleSP was passed in, return the JIT'ed module
     // if one was created
     if (jit_module_sp_ptr)
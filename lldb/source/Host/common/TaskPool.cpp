@@ -10,6 +10,7 @@
 #include "lldb/Host/ThreadLauncher.h"
 #include "lldb/Utility/Log.h"
 
+#include <condition_variable>
 #include <cstdint>
 #include <queue>
 #include <thread>
@@ -102,24 +103,53 @@ void TaskPoolImpl::Worker(TaskPoolImpl *pool) {
 
 void TaskMapOverInt(size_t begin, size_t end,
                     const llvm::function_ref<void(size_t)> &func) {
-  const size_t num_workers = std::min<size_t>(end, GetHardwareConcurrencyHint());
-  std::atomic<size_t> idx{begin};
-  
-  auto wrapper = [&idx, end, &func]() {
+  if (begin >= end)
+    return;
+
+  // The calling thread processes indexes too, and then only waits for the
+  // indexes that other threads are processing, never for a task that is still
+  // queued. This makes it safe to call from a task running on the pool (e.g.
+  // to index the DWARF of modules that are preloaded in parallel): the tasks
+  // that haven't started when all indexes are done find nothing left to do,
+  // and only touch the state they share ownership of.
+  struct State {
+    std::atomic<size_t> idx;
+    const size_t end;
+    const llvm::function_ref<void(size_t)> func;
+    std::mutex mutex;
+    std::condition_variable done_cv;
+    size_t num_done = 0;
+
+    State(size_t begin, size_t end, llvm::function_ref<void(size_t)> func)
+        : idx(begin), end(end), func(func) {}
+  };
+  auto state = std::make_shared<State>(begin, end, func);
+
+  auto wrapper = [state]() {
+    size_t num_done = 0;
     while (true) {
-      size_t i = idx.fetch_add(1);
-      if (i >= end)
+      size_t i = state->idx.fetch_add(1);
+      if (i >= state->end)
         break;
-      func(i);
+      state->func(i);
+      ++num_done;
+    }
+    if (num_done) {
+      std::lock_guard<std::mutex> guard(state->mutex);
+      state->num_done += num_done;
+      state->done_cv.notify_all();
     }
   };
 
-  std::vector<std::future<void>> futures;
-  futures.reserve(num_workers);
-  for (size_t i = 0; i < num_workers; i++)
-    futures.push_back(TaskPool::AddTask(wrapper));
-  for (size_t i = 0; i < num_workers; i++)
-    futures[i].wait();
+  const size_t num_workers =
+      std::min<size_t>(end - begin, GetHardwareConcurrencyHint());
+  for (size_t i = 1; i < num_workers; i++)
+    TaskPool::AddTask(wrapper);
+  wrapper();
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->done_cv.wait(lock,
+                      [&] { return state->num_done == end - begin; });
 }
 
 } // namespace lldb_private
@@ -419,10 +419,13 @@ void DynamicLoaderPOSIXDYLD::RefreshModules() {
   if (m_rendezvous.ModulesDidLoad()) {
     ModuleList new_modules;
 
+    // The target is notified of all the new modules at once, so that their
+    // symbols are preloaded in parallel.
     E = m_rendezvous.loaded_end();
     for (I = m_rendezvous.loaded_begin(); I != E; ++I) {
       ModuleSP module_sp =
-          LoadModuleAtAddress(I->file_spec, I->link_addr, I->base_addr, true);
+          LoadModuleAtAddress(I->file_spec, I->link_addr, I->base_addr, true,
+                              /*notify=*/false);
       if (module_sp.get()) {
         loaded_modules.AppendIfNeeded(module_sp);
         new_modules.Append(module_sp);
@@ -574,9 +577,12 @@ void DynamicLoaderPOSIXDYLD::LoadAllCurrentModules() {
   m_process->PrefetchModuleSpecs(
       module_names, m_process->GetTarget().GetArchitecture().GetTriple());
 
+  // The target is notified of all the modules at once, so that their symbols
+  // are preloaded in parallel.
   for (I = m_rendezvous.begin(), E = m_rendezvous.end(); I != E; ++I) {
     ModuleSP module_sp =
-        LoadModuleAtAddress(I->file_spec, I->link_addr, I->base_addr, true);
+        LoadModuleAtAddress(I->file_spec, I->link_addr, I->base_addr, true,
+                            /*notify=*/false);
     if (module_sp.get()) {
       LLDB_LOG(log, "LoadAllCurrentModules loading module: {0}",
                I->file_spec.GetFilename());
@@ -13,14 +13,26 @@
 #include "Plugins/SymbolFile/DWARF/LogChannelDWARF.h"
 #include "Plugins/SymbolFile/DWARF/SymbolFileDWARFDwo.h"
 #include "lldb/Core/Module.h"
+#include "lldb/Core/ModuleList.h"
+#include "lldb/Host/FileSystem.h"
 #include "lldb/Host/TaskPool.h"
 #include "lldb/Symbol/ObjectFile.h"
+#include "lldb/Utility/DataBufferLLVM.h"
+#include "lldb/Utility/Log.h"
 #include "lldb/Utility/Stream.h"
 #include "lldb/Utility/Timer.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/xxhash.h"
 
 using namespace lldb_private;
 using namespace lldb;
 
+static const uint32_t g_cache_magic = 0x58444c4c; // "LLDX"
+// Bump this whenever the contents of the index, or its encoding, change.
+static const uint32_t g_cache_version = 1;
+
 void ManualDWARFIndex::Index() {
   if (!m_debug_info)
     return;
@@ -31,6 +43,12 @@ void ManualDWARFIndex::Index() {
   static Timer::Category func_cat(LLVM_PRETTY_FUNCTION);
   Timer scoped_timer(func_cat, "%p", static_cast<void *>(&debug_info));
 
+  std::string cache_key;
+  llvm::SmallString<128> cache_path;
+  const bool use_cache = GetCacheFile(cache_key, cache_path);
+  if (use_cache && LoadFromCache(cache_path, cache_key))
+    return;
+
   std::vector<DWARFUnit *> units_to_index;
   units_to_index.reserve(debug_info.GetNumUnits());
   for (size_t U = 0; U < debug_info.GetNumUnits(); ++U) {
@@ -77,14 +95,181 @@ void ManualDWARFIndex::Index() {
     result.Finalize();
   };
 
-  TaskPool::RunTasks([&]() { finalize_fn(&IndexSet::function_basenames); },
-                     [&]() { finalize_fn(&IndexSet::function_fullnames); },
-                     [&]() { finalize_fn(&IndexSet::function_methods); },
-                     [&]() { finalize_fn(&IndexSet::function_selectors); },
-                     [&]() { finalize_fn(&IndexSet::objc_class_selectors); },
-                     [&]() { finalize_fn(&IndexSet::globals); },
-                     [&]() { finalize_fn(&IndexSet::types); },
-                     [&]() { finalize_fn(&IndexSet::namespaces); });
+  // TaskMapOverInt, unlike TaskPool::RunTasks, can be used from a task
+  // running on the pool, which is where this runs when modules are preloaded
+  // in parallel.
+  llvm::ArrayRef<NameToDIE IndexSet::*> indexes = GetCachedIndexes();
+  TaskMapOverInt(0, indexes.size(),
+                 [&](size_t i) { finalize_fn(indexes[i]); });
+
+  if (use_cache)
+    SaveToCache(cache_path, cache_key);
+}
+
+llvm::ArrayRef<NameToDIE ManualDWARFIndex::IndexSet::*>
+ManualDWARFIndex::GetCachedIndexes() {
+  static NameToDIE IndexSet::*const indexes[] = {
+      &IndexSet::function_basenames, &IndexSet::function_fullnames,
+      &IndexSet::function_methods,   &IndexSet::function_selectors,
+      &IndexSet::objc_class_selectors, &IndexSet::globals,
+      &IndexSet::types,              &IndexSet::namespaces};
+  return indexes;
+}
+
+bool ManualDWARFIndex::GetCacheFile(std::string &key,
+                                    llvm::SmallVectorImpl<char> &path) {
+  FileSpec cache_dir =
+      ModuleList::GetGlobalModuleListProperties().GetIndexCachePath();
+  if (!cache_dir)
+    return false;
+
+  // The key identifies the module and the version of it, and the units that
+  // are indexed. It is stored in the cache file, and checked when loading it,
+  // so that a collision in the file name hash doesn't matter.
+  llvm::raw_string_ostream os(key);
+  const FileSpec &module_file = m_module.GetFileSpec();
+  os << module_file.GetPath() << '('
+     << m_module.GetObjectName().GetStringRef() << ')' << '\0'
+     << m_module.GetArchitecture().GetTriple().str() << '\0'
+     << m_module.GetUUID().GetAsString() << '\0'
+     << m_module.GetModificationTime().time_since_epoch().count() << '\0';
+  // The DWARF may be in a separate symbol file, which can change on its own.
+  if (FileSpec symbol_file = m_module.GetSymbolFileFileSpec())
+    os << symbol_file.GetPath() << '\0'
+       << FileSystem::Instance()
+              .GetModificationTime(symbol_file)
+              .time_since_epoch()
+              .count()
+       << '\0';
+  std::vector<dw_offset_t> units_to_avoid(m_units_to_avoid.begin(),
+                                          m_units_to_avoid.end());
+  llvm::sort(units_to_avoid);
+  for (dw_offset_t offset : units_to_avoid)
+    os << offset << ',';
+  os.flush();
+
+  cache_dir.GetPath(path);
+  llvm::sys::path::append(
+      path, module_file.GetFilename().GetStringRef() + "-" +
+                llvm::utohexstr(llvm::xxHash64(key)) + ".dwarf-index");
+  return true;
+}
+
+bool ManualDWARFIndex::LoadFromCache(llvm::StringRef path,
+                                     llvm::StringRef key) {
+  FileSystem &fs = FileSystem::Instance();
+  if (!fs.Exists(path))
+    return false;
+  // The file is memory mapped when it is large enough.
+  std::shared_ptr<DataBufferLLVM> buffer = fs.CreateDataBuffer(path);
+  if (!buffer)
+    return false;
+
+  Log *log = LogChannelDWARF::GetLogIfAll(DWARF_LOG_LOOKUPS);
+  llvm::DataExtractor data(
+      llvm::StringRef(reinterpret_cast<const char *>(buffer->GetBytes()),
+                      buffer->GetByteSize()),
+      /*IsLittleEndian=*/true, /*AddressSize=*/8);
+  uint64_t offset = 0;
+  if (!data.isValidOffsetForDataOfSize(offset, 12) ||
+      data.getU32(&offset) != g_cache_magic ||
+      data.getU32(&offset) != g_cache_version) {
+    LLDB_LOG(log, "ignoring DWARF index cache file {0}: bad header", path);
+    return false;
+  }
+  const uint32_t key_size = data.getU32(&offset);
+  if (!data.isValidOffsetForDataOfSize(offset, key_size) ||
+      data.getData().substr(offset, key_size) != key) {
+    LLDB_LOG(log, "ignoring DWARF index cache file {0}: different module",
+             path);
+    return false;
+  }
+  offset += key_size;
+
+  if (!data.isValidOffsetForDataOfSize(offset, 4))
+    return false;
+  const uint32_t num_strings = data.getU32(&offset);
+  std::vector<ConstString> strings;
+  strings.reserve(num_strings);
+  for (uint32_t i = 0; i < num_strings; ++i) {
+    const char *str = data.getCStr(&offset);
+    if (!str)
+      return false;
+    strings.emplace_back(str);
+  }
+
+  IndexSet set;
+  for (NameToDIE IndexSet::*index : GetCachedIndexes()) {
+    if (!(set.*index).Decode(data, offset, strings)) {
+      LLDB_LOG(log, "ignoring DWARF index cache file {0}: truncated", path);
+      return false;
+    }
+  }
+  for (NameToDIE IndexSet::*index : GetCachedIndexes()) {
+    m_set.*index = std::move(set.*index);
+    (m_set.*index).Finalize();
+  }
+  LLDB_LOG(log, "loaded DWARF index for {0} from {1}",
+           m_module.GetFileSpec(), path);
+  return true;
+}
+
+void ManualDWARFIndex::SaveToCache(llvm::StringRef path,
+                                   llvm::StringRef key) {
+  // Names are written once, in a string table, and referred to by index.
+  llvm::DenseMap<ConstString, uint32_t> string_indexes;
+  std::vector<ConstString> strings;
+  auto get_string_index = [&](ConstString str) {
+    auto insertion = string_indexes.try_emplace(str, strings.size());
+    if (insertion.second)
+      strings.push_back(str);
+    return insertion.first->second;
+  };
+  llvm::SmallString<0> indexes;
+  llvm::raw_svector_ostream indexes_os(indexes);
+  llvm::support::endian::Writer indexes_writer(indexes_os,
+                                               llvm::support::little);
+  for (NameToDIE IndexSet::*index : GetCachedIndexes())
+    (m_set.*index).Encode(indexes_writer, get_string_index);
+
+  // Write to a temporary file that is renamed once complete, so that other
+  // sessions never see a partially written index.
+  Log *log = LogChannelDWARF::GetLogIfAll(DWARF_LOG_LOOKUPS);
+  llvm::StringRef cache_dir = llvm::sys::path::parent_path(path);
+  llvm::SmallString<128> temp_model(cache_dir);
+  llvm::sys::path::append(temp_model, "dwarf-index-%%%%%%%%.tmp");
+  llvm::SmallString<128> temp_path;
+  int fd;
+  std::error_code ec = llvm::sys::fs::create_directories(cache_dir);
+  if (!ec)
+    ec = llvm::sys::fs::createUniqueFile(temp_model, fd, temp_path);
+  if (ec) {
+    LLDB_LOG(log, "failed to create DWARF index cache file in {0}: {1}",
+             cache_dir, ec.message());
+    return;
+  }
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    llvm::support::endian::Writer writer(os, llvm::support::little);
+    writer.write<uint32_t>(g_cache_magic);
+    writer.write<uint32_t>(g_cache_version);
+    writer.write<uint32_t>(key.size());
+    os << key;
+    writer.write<uint32_t>(strings.size());
+    for (ConstString str : strings)
+      os << str.GetStringRef() << '\0';
+    os << indexes;
+    os.close();
+    ec = os.error();
+    os.clear_error();
+  }
+  if (!ec)
+    ec = llvm::sys::fs::rename(temp_path, path);
+  if (ec) {
+    LLDB_LOG(log, "failed to write DWARF index cache file {0}: {1}", path,
+             ec.message());
+    llvm::sys::fs::remove(temp_path);
+  }
 }
 
 void ManualDWARFIndex::IndexUnit(DWARFUnit &unit, IndexSet &set) {
@@ -62,6 +62,24 @@ private:
                             const lldb::LanguageType cu_language,
                             IndexSet &set);
 
+  /// The index can be cached in the directory given by the
+  /// symbols.index-cache-path setting, so that later sessions don't have to
+  /// parse all the DIEs again.
+  /// \{
+
+  /// The indexes of an IndexSet, in the order they are written to the cache.
+  static llvm::ArrayRef<NameToDIE IndexSet::*> GetCachedIndexes();
+
+  /// Get the path of the cache file for this index, and the key identifying
+  /// the module, and its version, it is built from.
+  ///
+  /// \return false if caching is disabled.
+  bool GetCacheFile(std::string &key, llvm::SmallVectorImpl<char> &path);
+  /// \return true if the index was loaded from the cache file at \p path.
+  bool LoadFromCache(llvm::StringRef path, llvm::StringRef key);
+  void SaveToCache(llvm::StringRef path, llvm::StringRef key);
+  /// \}
+
   /// Non-null value means we haven't built the index yet.
   DWARFDebugInfo *m_debug_info;
   /// Which dwarf units should we skip while building the index.
@@ -69,6 +69,56 @@ void NameToDIE::ForEach(
   }
 }
 
+// A DIERef is encoded as a word holding the section, the dwo number and
+// whether it is valid, followed by the DIE offset.
+static uint32_t EncodeDIERefUnit(const DIERef &die_ref) {
+  uint32_t value = die_ref.section() == DIERef::DebugTypes ? 1u << 30 : 0;
+  if (llvm::Optional<uint32_t> dwo_num = die_ref.dwo_num())
+    value |= 1u << 31 | *dwo_num;
+  return value;
+}
+
+static DIERef DecodeDIERef(uint32_t unit, dw_offset_t die_offset) {
+  llvm::Optional<uint32_t> dwo_num;
+  if (unit & 1u << 31)
+    dwo_num = unit & ((1u << 30) - 1);
+  DIERef::Section section =
+      unit & 1u << 30 ? DIERef::DebugTypes : DIERef::DebugInfo;
+  return DIERef(dwo_num, section, die_offset);
+}
+
+void NameToDIE::Encode(
+    llvm::support::endian::Writer &writer,
+    llvm::function_ref<uint32_t(ConstString)> get_string_index) const {
+  const uint32_t size = m_map.GetSize();
+  writer.write<uint32_t>(size);
+  for (uint32_t i = 0; i < size; ++i) {
+    const DIERef &die_ref = m_map.GetValueAtIndexUnchecked(i);
+    writer.write<uint32_t>(
+        get_string_index(m_map.GetCStringAtIndexUnchecked(i)));
+    writer.write<uint32_t>(EncodeDIERefUnit(die_ref));
+    writer.write<uint32_t>(die_ref.die_offset());
+  }
+}
+
+bool NameToDIE::Decode(const llvm::DataExtractor &data, uint64_t &offset,
+                       llvm::ArrayRef<ConstString> strings) {
+  if (!data.isValidOffsetForDataOfSize(offset, 4))
+    return false;
+  const uint32_t size = data.getU32(&offset);
+  if (!data.isValidOffsetForDataOfSize(offset, uint64_t(size) * 12))
+    return false;
+  for (uint32_t i = 0; i < size; ++i) {
+    const uint32_t string_index = data.getU32(&offset);
+    const uint32_t unit = data.getU32(&offset);
+    const dw_offset_t die_offset = data.getU32(&offset);
+    if (string_index >= strings.size())
+      return false;
+    m_map.Append(strings[string_index], DecodeDIERef(unit, die_offset));
+  }
+  return true;
+}
+
 void NameToDIE::Append(const NameToDIE &other) {
   const uint32_t size = other.m_map.GetSize();
   for (uint32_t i = 0; i < size; ++i) {
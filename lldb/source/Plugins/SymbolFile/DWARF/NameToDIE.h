@@ -15,6 +15,10 @@
 #include "lldb/Core/UniqueCStringMap.h"
 #include "lldb/Core/dwarf.h"
 #include "lldb/lldb-defines.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/EndianStream.h"
 
 class DWARFUnit;
 
@@ -46,6 +50,21 @@ public:
                              const DIERef &die_ref)> const
               &callback) const;
 
+  /// Write all entries to \p writer, for a later Decode(). Names are written
+  /// as the index \p get_string_index returns for them.
+  void Encode(llvm::support::endian::Writer &writer,
+              llvm::function_ref<uint32_t(lldb_private::ConstString)>
+                  get_string_index) const;
+
+  /// Append the entries written by Encode() at \p offset in \p data, with
+  /// \p strings giving the name for each string index. Finalize() must be
+  /// called before searching the map.
+  ///
+  /// \return false if the data is truncated or refers to a string that
+  /// isn't in \p strings.
+  bool Decode(const llvm::DataExtractor &data, uint64_t &offset,
+              llvm::ArrayRef<lldb_private::ConstString> strings);
+
 protected:
   lldb_private::UniqueCStringMap<DIERef> m_map;
 };
@@ -178,6 +178,8 @@ void Target::CleanupProcess() {
 
 void Target::DeleteCurrentProcess() {
   if (m_process_sp) {
+    // The code of the cached expressions lives in the process.
+    ClearUserExpressionCache();
     m_section_load_history.Clear();
     if (m_process_sp->IsAlive())
       m_process_sp->Destroy(false);
@@ -1373,6 +1375,7 @@ void Target::ClearModules(bool delete_locations) {
   ModulesDidUnload(m_images, delete_locations);
   m_section_load_history.Clear();
   m_images.Clear();
+  ClearUserExpressionCache();
   m_scratch_type_system_map.Clear();
   m_ast_importer_sp.reset();
 }
@@ -1605,6 +1608,12 @@ void Target::NotifyModulesRemoved(lldb_private::ModuleList &module_list) {
 void Target::ModulesDidLoad(ModuleList &module_list) {
   const size_t num_images = module_list.GetSize();
   if (m_valid && num_images) {
+    // Load the symbols first, since resolving breakpoints in the new modules
+    // needs them. This does nothing for modules that are already preloaded.
+    if (GetPreloadSymbols())
+      module_list.PreloadSymbols();
+    // Names in cached expressions may resolve differently now.
+    ClearUserExpressionCache();
     for (size_t idx = 0; idx < num_images; ++idx) {
       ModuleSP module_sp(module_list.GetModuleAtIndex(idx));
       LoadScriptingResourceForModule(module_sp, this);
@@ -1636,6 +1645,7 @@ void Target::SymbolsDidLoad(ModuleList &module_list) {
 
 void Target::ModulesDidUnload(ModuleList &module_list, bool delete_locations) {
   if (m_valid && module_list.GetSize()) {
+    ClearUserExpressionCache();
     UnloadModuleSections(module_list);
     m_breakpoint_list.UpdateBreakpoints(module_list, false, delete_locations);
     m_internal_breakpoint_list.UpdateBreakpoints(module_list, false,
@@ -2069,9 +2079,10 @@ ModuleSP Target::GetOrCreateModule(const ModuleSpec &module_spec, bool notify,
           }
         }
 
-        // Preload symbols outside of any lock, so hopefully we can do this for
-        // each library in parallel.
-        if (GetPreloadSymbols())
+        // Preload symbols outside of any lock. When the caller doesn't ask
+        // for notifications, it calls ModulesDidLoad() with all the modules
+        // it added, which preloads them in parallel.
+        if (notify && GetPreloadSymbols())
           module_sp->PreloadSymbols();
 
         if (old_module_sp && m_images.GetIndexForModule(old_module_sp.get()) !=
@@ -2211,6 +2222,45 @@ UserExpression *Target::GetUserExpressionForLanguage(
   return user_expr;
 }
 
+lldb::UserExpressionSP
+Target::GetCachedUserExpression(llvm::StringRef key,
+                                ExecutionContext &exe_ctx) {
+  if (!GetEnableCacheExpressions())
+    return lldb::UserExpressionSP();
+  std::lock_guard<std::mutex> guard(m_user_expression_cache_mutex);
+  auto pos = m_user_expression_cache.find(key);
+  if (pos == m_user_expression_cache.end())
+    return lldb::UserExpressionSP();
+  // The expression was parsed for another process.
+  if (!pos->second->MatchesContext(exe_ctx)) {
+    m_user_expression_cache.erase(pos);
+    return lldb::UserExpressionSP();
+  }
+  return pos->second;
+}
+
+void Target::CacheUserExpression(
+    llvm::StringRef key, const lldb::UserExpressionSP &user_expression_sp) {
+  if (!GetEnableCacheExpressions())
+    return;
+  // Every cached expression holds on to its JIT'ed code, so don't let the
+  // cache grow without bounds.
+  static const size_t g_max_cached_user_expressions = 128;
+  std::lock_guard<std::mutex> guard(m_user_expression_cache_mutex);
+  if (m_user_expression_cache.size() >= g_max_cached_user_expressions)
+    m_user_expression_cache.clear();
+  m_user_expression_cache[key] = user_expression_sp;
+}
+
+void Target::ClearUserExpressionCache() {
+  // Destroy the expressions outside of the lock.
+  llvm::StringMap<lldb::UserExpressionSP> cache;
+  {
+    std::lock_guard<std::mutex> guard(m_user_expression_cache_mutex);
+    std::swap(cache, m_user_expression_cache);
+  }
+}
+
 FunctionCaller *Target::GetFunctionCallerForLanguage(
     lldb::LanguageType language, const CompilerType &return_type,
     const Address &function_address, const ValueList &arg_value_list,
@@ -3777,6 +3827,12 @@ bool TargetProperties::GetEnableNotifyAboutFixIts() const {
       nullptr, idx, g_target_properties[idx].default_uint_value != 0);
 }
 
+bool TargetProperties::GetEnableCacheExpressions() const {
+  const uint32_t idx = ePropertyCacheExpressions;
+  return m_collection_sp->GetPropertyAtIndexAsBoolean(
+      nullptr, idx, g_target_properties[idx].default_uint_value != 0);
+}
+
 bool TargetProperties::GetEnableSaveObjects() const {
   const uint32_t idx = ePropertySaveObjects;
   return m_collection_sp->GetPropertyAtIndexAsBoolean(
@@ -43,3 +43,18 @@ TEST(TaskPoolTest, TaskMap) {
   ASSERT_EQ(data[2], 4);
   ASSERT_EQ(data[3], 9);
 }
+
+TEST(TaskPoolTest, NestedTaskMap) {
+  // More outer tasks than worker threads, each of them waiting for inner
+  // tasks.
+  const size_t outer = 4 * GetHardwareConcurrencyHint();
+  const size_t inner = 16;
+  std::vector<int> data(outer * inner);
+  TaskMapOverInt(0, outer, [&](size_t i) {
+    TaskMapOverInt(0, inner, [&](size_t j) { data[i * inner + j] = i + j; });
+  });
+
+  for (size_t i = 0; i < outer; ++i)
+    for (size_t j = 0; j < inner; ++j)
+      ASSERT_EQ(int(i + j), data[i * inner + j]);
+}
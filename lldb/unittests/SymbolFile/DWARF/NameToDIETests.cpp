@@ -0,0 +1,74 @@
+//===-- NameToDIETests.cpp --------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Plugins/SymbolFile/DWARF/NameToDIE.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+TEST(NameToDIETest, EncodeDecode) {
+  NameToDIE map;
+  map.Insert(ConstString("foo"), DIERef(llvm::None, DIERef::DebugInfo, 0x10));
+  map.Insert(ConstString("bar"), DIERef(3, DIERef::DebugTypes, 0x20));
+  map.Insert(ConstString("foo"), DIERef(0, DIERef::DebugInfo, 0x30));
+  map.Finalize();
+
+  llvm::DenseMap<ConstString, uint32_t> string_indexes;
+  std::vector<ConstString> strings;
+  std::string bytes;
+  llvm::raw_string_ostream os(bytes);
+  llvm::support::endian::Writer writer(os, llvm::support::little);
+  map.Encode(writer, [&](ConstString str) {
+    auto insertion = string_indexes.try_emplace(str, strings.size());
+    if (insertion.second)
+      strings.push_back(str);
+    return insertion.first->second;
+  });
+  os.flush();
+  EXPECT_EQ(2u, strings.size());
+
+  llvm::DataExtractor data(bytes, /*IsLittleEndian=*/true, 8);
+  uint64_t offset = 0;
+  NameToDIE decoded;
+  ASSERT_TRUE(decoded.Decode(data, offset, strings));
+  EXPECT_EQ(bytes.size(), offset);
+  decoded.Finalize();
+
+  DIEArray foo;
+  decoded.Find(ConstString("foo"), foo);
+  ASSERT_EQ(2u, foo.size());
+  for (const DIERef &ref : foo) {
+    EXPECT_EQ(DIERef::DebugInfo, ref.section());
+    if (ref.die_offset() == 0x10)
+      EXPECT_EQ(llvm::None, ref.dwo_num());
+    else
+      EXPECT_EQ(0x30u, ref.die_offset());
+  }
+
+  DIEArray bar;
+  decoded.Find(ConstString("bar"), bar);
+  ASSERT_EQ(1u, bar.size());
+  EXPECT_EQ(DIERef::DebugTypes, bar[0].section());
+  EXPECT_EQ(llvm::Optional<uint32_t>(3), bar[0].dwo_num());
+  EXPECT_EQ(0x20u, bar[0].die_offset());
+
+  // Truncated data and unknown strings are rejected.
+  offset = 0;
+  NameToDIE truncated;
+  EXPECT_FALSE(truncated.Decode(
+      llvm::DataExtractor(llvm::StringRef(bytes).drop_back(), true, 8), offset,
+      strings));
+  offset = 0;
+  NameToDIE unknown_string;
+  EXPECT_FALSE(unknown_string.Decode(
+      data, offset, llvm::makeArrayRef(strings).drop_back()));
+}
@@ -0,0 +1,93 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Bitstream/BitstreamReader.h"
+#include "llvm/Bitstream/BitstreamWriter.h"
+#include <random>
+
+using namespace llvm;
+
+namespace {
+
+const unsigned BlockID = bitc::FIRST_APPLICATION_BLOCKID;
+const unsigned RecordCode = 1;
+
+// A block of records shaped like those of a bitcode module: a few scalar
+// operands, mostly small relative value numbers, followed by an array.
+static SmallVector<char, 0> writeRecords(bool Abbreviated,
+                                         unsigned NumRecords) {
+  SmallVector<char, 0> Buffer;
+  BitstreamWriter Stream(Buffer);
+  Stream.EnterSubblock(BlockID, 3);
+  unsigned AbbrevID = 0;
+  if (Abbreviated) {
+    auto Abbrev = std::make_shared<BitCodeAbbrev>();
+    Abbrev->Add(BitCodeAbbrevOp(RecordCode));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 4));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));
+    AbbrevID = Stream.EmitAbbrev(std::move(Abbrev));
+  }
+
+  std::mt19937 Generator(42);
+  std::geometric_distribution<uint64_t> Operand(0.05);
+  SmallVector<uint64_t, 16> Vals;
+  for (unsigned I = 0; I != NumRecords; ++I) {
+    Vals.clear();
+    Vals.push_back(Operand(Generator));
+    Vals.push_back(I % 16);
+    for (unsigned J = 0, E = I % 8 + 1; J != E; ++J)
+      Vals.push_back(Operand(Generator));
+    Stream.EmitRecord(RecordCode, Vals, AbbrevID);
+  }
+  Stream.ExitBlock();
+  return Buffer;
+}
+
+static void BM_ReadRecords(benchmark::State &State) {
+  const unsigned NumRecords = 100000;
+  SmallVector<char, 0> Buffer = writeRecords(State.range(0), NumRecords);
+  SmallVector<uint64_t, 16> Vals;
+  for (auto _ : State) {
+    BitstreamCursor Stream(
+        ArrayRef<uint8_t>((const uint8_t *)Buffer.data(), Buffer.size()));
+    cantFail(Stream.advance());
+    cantFail(Stream.EnterSubBlock(BlockID));
+    for (unsigned I = 0; I != NumRecords; ++I) {
+      BitstreamEntry Entry = cantFail(Stream.advance());
+      Vals.clear();
+      cantFail(Stream.readRecord(Entry.ID, Vals));
+      benchmark::DoNotOptimize(Vals.data());
+    }
+  }
+  State.SetBytesProcessed(State.iterations() * Buffer.size());
+  State.SetItemsProcessed(State.iterations() * NumRecords);
+}
+BENCHMARK(BM_ReadRecords)->Arg(0)->Arg(1);
+
+static void BM_ReadVBR(benchmark::State &State) {
+  const unsigned NumValues = 1 << 20;
+  SmallVector<char, 0> Buffer;
+  {
+    BitstreamWriter Stream(Buffer);
+    std::mt19937 Generator(42);
+    std::geometric_distribution<uint64_t> Value(0.01);
+    for (unsigned I = 0; I != NumValues; ++I)
+      Stream.EmitVBR64(Value(Generator), 6);
+    Stream.FlushToWord();
+  }
+  for (auto _ : State) {
+    SimpleBitstreamCursor Cursor(
+        ArrayRef<uint8_t>((const uint8_t *)Buffer.data(), Buffer.size()));
+    uint64_t Sum = 0;
+    for (unsigned I = 0; I != NumValues; ++I)
+      Sum += cantFail(Cursor.ReadVBR64(6));
+    benchmark::DoNotOptimize(Sum);
+  }
+  State.SetItemsProcessed(State.iterations() * NumValues);
+}
+BENCHMARK(BM_ReadVBR);
+
+} // namespace
+
+BENCHMARK_MAIN();
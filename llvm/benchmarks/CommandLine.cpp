@@ -0,0 +1,37 @@
+#include "benchmark/benchmark.h"
+#include "llvm/Support/CommandLine.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+// Models tool startup: a few thousand options are constructed, and the
+// command line, if any, mentions only a few of them.
+static void registerOptions(benchmark::State &State, bool Parse) {
+  std::vector<std::string> Names;
+  for (int64_t I = 0; I < State.range(0); ++I)
+    Names.push_back("bench-option-" + std::to_string(I));
+  const char *Argv[] = {"bench", "-bench-option-0"};
+
+  for (auto _ : State) {
+    std::vector<std::unique_ptr<cl::opt<bool>>> Opts;
+    for (const std::string &Name : Names)
+      Opts.push_back(std::make_unique<cl::opt<bool>>(StringRef(Name)));
+    if (Parse)
+      cl::ParseCommandLineOptions(2, Argv, "", &nulls());
+    cl::ResetCommandLineParser();
+  }
+}
+
+static void BM_RegisterOptions(benchmark::State &State) {
+  registerOptions(State, /*Parse=*/false);
+}
+BENCHMARK(BM_RegisterOptions)->Arg(1000)->Arg(5000);
+
+static void BM_RegisterAndParseOptions(benchmark::State &State) {
+  registerOptions(State, /*Parse=*/true);
+}
+BENCHMARK(BM_RegisterAndParseOptions)->Arg(1000)->Arg(5000);
+
+BENCHMARK_MAIN();
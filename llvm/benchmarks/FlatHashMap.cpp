@@ -0,0 +1,92 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/FlatHashMap.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace llvm;
+
+// Pointer-like keys, as in the value numbering and instruction maps of the
+// optimizer: aligned, and allocated close to each other.
+static std::vector<int *> makeKeys(size_t NumKeys, unsigned Seed) {
+  std::vector<int *> Keys;
+  for (size_t I = 0; I != NumKeys; ++I) {
+    uintptr_t Addr = 0x10000 + (I + Seed * NumKeys) * 64;
+    Keys.push_back(reinterpret_cast<int *>(Addr));
+  }
+  std::mt19937 Rng(Seed);
+  std::shuffle(Keys.begin(), Keys.end(), Rng);
+  return Keys;
+}
+
+template <typename MapT> static void BM_Insert(benchmark::State &State) {
+  std::vector<int *> Keys = makeKeys(State.range(0), 1);
+  for (auto _ : State) {
+    MapT M;
+    for (int *K : Keys)
+      M[K] = 1;
+    benchmark::DoNotOptimize(M.size());
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+
+template <typename MapT> static void BM_LookupHit(benchmark::State &State) {
+  std::vector<int *> Keys = makeKeys(State.range(0), 1);
+  MapT M;
+  for (int *K : Keys)
+    M[K] = 1;
+  for (auto _ : State) {
+    unsigned Sum = 0;
+    for (int *K : Keys)
+      Sum += M.find(K)->second;
+    benchmark::DoNotOptimize(Sum);
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+
+template <typename MapT> static void BM_LookupMiss(benchmark::State &State) {
+  std::vector<int *> Keys = makeKeys(State.range(0), 1);
+  std::vector<int *> Missing = makeKeys(State.range(0), 2);
+  MapT M;
+  for (int *K : Keys)
+    M[K] = 1;
+  for (auto _ : State) {
+    unsigned Count = 0;
+    for (int *K : Missing)
+      Count += M.count(K);
+    benchmark::DoNotOptimize(Count);
+  }
+  State.SetItemsProcessed(State.iterations() * Missing.size());
+}
+
+// Erases and inserts keys in a map of constant size, which fills DenseMap
+// with tombstones.
+template <typename MapT> static void BM_Churn(benchmark::State &State) {
+  std::vector<int *> Keys = makeKeys(State.range(0) * 2, 1);
+  size_t Half = State.range(0);
+  MapT M;
+  for (size_t I = 0; I != Half; ++I)
+    M[Keys[I]] = 1;
+  size_t Next = 0;
+  for (auto _ : State) {
+    M.erase(Keys[Next]);
+    M[Keys[(Next + Half) % Keys.size()]] = 1;
+    Next = (Next + 1) % Keys.size();
+  }
+  State.SetItemsProcessed(State.iterations());
+}
+
+using DenseMapT = DenseMap<int *, unsigned>;
+using FlatHashMapT = FlatHashMap<int *, unsigned>;
+
+#define MAP_BENCHMARK(Name)                                                    \
+  BENCHMARK_TEMPLATE(Name, DenseMapT)->Arg(64)->Arg(4096)->Arg(262144);        \
+  BENCHMARK_TEMPLATE(Name, FlatHashMapT)->Arg(64)->Arg(4096)->Arg(262144)
+
+MAP_BENCHMARK(BM_Insert);
+MAP_BENCHMARK(BM_LookupHit);
+MAP_BENCHMARK(BM_LookupMiss);
+MAP_BENCHMARK(BM_Churn);
+
+BENCHMARK_MAIN();
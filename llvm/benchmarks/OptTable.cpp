@@ -0,0 +1,94 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Option/ArgList.h"
+#include "llvm/Option/OptTable.h"
+#include "llvm/Option/Option.h"
+#include <string>
+#include <vector>
+
+using namespace llvm;
+using namespace llvm::opt;
+
+namespace {
+
+// A table shaped like the clang driver's: a few thousand flags and joined
+// options under "-" and "--", sorted the way OptParserEmitter sorts them.
+class BenchOptTable : public OptTable {
+public:
+  BenchOptTable(ArrayRef<Info> Infos) : OptTable(Infos) {}
+};
+
+// The order of OptTable: case-insensitive, with the end of a name after every
+// character.
+static bool optionNameLess(const std::string &A, const std::string &B) {
+  for (size_t I = 0;; ++I) {
+    if (I == A.size() || I == B.size())
+      return I != A.size();
+    char LowerA = toLower(A[I]), LowerB = toLower(B[I]);
+    if (LowerA != LowerB)
+      return LowerA < LowerB;
+  }
+}
+
+static const char *const Dash[] = {"-", nullptr};
+static const char *const DashDash[] = {"-", "--", nullptr};
+
+struct Options {
+  std::vector<std::string> Names;
+  std::vector<OptTable::Info> Infos;
+
+  explicit Options(size_t NumOptions) {
+    for (size_t I = 0; I < NumOptions; ++I)
+      Names.push_back("fbench-option-" + std::to_string(I));
+    Names.push_back("D");
+    Names.push_back("I");
+    llvm::sort(Names, optionNameLess);
+
+    unsigned ID = 0;
+    Infos.push_back({nullptr, "<input>", nullptr, nullptr, ++ID,
+                     Option::InputClass, 0, 0, 0, 0, nullptr, nullptr});
+    Infos.push_back({nullptr, "<unknown>", nullptr, nullptr, ++ID,
+                     Option::UnknownClass, 0, 0, 0, 0, nullptr, nullptr});
+    for (const std::string &Name : Names) {
+      bool Joined = Name.size() == 1;
+      Infos.push_back({Joined ? Dash : DashDash, Name.c_str(), nullptr,
+                       nullptr, ++ID,
+                       static_cast<unsigned char>(Joined ? Option::JoinedClass
+                                                         : Option::FlagClass),
+                       0, 0, 0, 0, nullptr, nullptr});
+    }
+  }
+};
+
+} // end anonymous namespace
+
+// Models a build system's command line: mostly -D and -I options, whose
+// names are prefixes of the arguments, and a few flags.
+static void BM_ParseArgs(benchmark::State &State) {
+  Options Opts(State.range(0));
+  BenchOptTable Table(Opts.Infos);
+
+  std::vector<std::string> Strings;
+  for (int I = 0; I < 2000; ++I) {
+    if (I % 10 == 0)
+      Strings.push_back("-fbench-option-" + std::to_string(I));
+    else if (I % 2)
+      Strings.push_back("-DMACRO_" + std::to_string(I) + "=1");
+    else
+      Strings.push_back("-I/path/to/include/" + std::to_string(I));
+  }
+  std::vector<const char *> Argv;
+  for (const std::string &S : Strings)
+    Argv.push_back(S.c_str());
+
+  for (auto _ : State) {
+    unsigned MissingArgIndex, MissingArgCount;
+    InputArgList Args =
+        Table.ParseArgs(Argv, MissingArgIndex, MissingArgCount);
+    benchmark::DoNotOptimize(Args.size());
+  }
+}
+BENCHMARK(BM_ParseArgs)->Arg(1000)->Arg(5000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,52 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/DJB.h"
+#include "llvm/Support/xxhash.h"
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+static std::string makeKey(int64_t Len, unsigned Seed) {
+  std::string S(Len, 'a');
+  for (int64_t I = 0; I < Len; ++I)
+    S[I] = 'a' + (Seed * 31 + I * 7) % 26;
+  return S;
+}
+
+static void BM_DJBHash(benchmark::State &State) {
+  std::string S = makeKey(State.range(0), 0);
+  for (auto _ : State)
+    benchmark::DoNotOptimize(djbHash(S, 0));
+  State.SetBytesProcessed(State.iterations() * State.range(0));
+}
+BENCHMARK(BM_DJBHash)->RangeMultiplier(2)->Range(4, 256);
+
+static void BM_XXHash64(benchmark::State &State) {
+  std::string S = makeKey(State.range(0), 0);
+  for (auto _ : State)
+    benchmark::DoNotOptimize(xxHash64(S));
+  State.SetBytesProcessed(State.iterations() * State.range(0));
+}
+BENCHMARK(BM_XXHash64)->RangeMultiplier(2)->Range(4, 256);
+
+// Looks up symbol-like keys in a map of Arg(0) entries. Half of the lookups
+// miss.
+static void BM_StringMapLookup(benchmark::State &State) {
+  std::vector<std::string> Keys;
+  for (unsigned I = 0; I < State.range(0) * 2; ++I)
+    Keys.push_back("_ZN4llvm" + makeKey(8 + I % 24, I) + std::to_string(I));
+  StringMap<unsigned> Map;
+  for (unsigned I = 0; I < State.range(0); ++I)
+    Map[Keys[I]] = I;
+
+  size_t I = 0;
+  for (auto _ : State) {
+    benchmark::DoNotOptimize(Map.find(Keys[I]));
+    if (++I == Keys.size())
+      I = 0;
+  }
+}
+BENCHMARK(BM_StringMapLookup)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,92 @@
+#include "benchmark/benchmark.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace llvm;
+
+// Builds a function whose first argument has NumUsers users. If NumArgs is
+// zero, the users are binary operators; otherwise they are calls that pass the
+// argument first, followed by NumArgs - 1 other arguments. The users are
+// shuffled within the block so that the use list of the argument is not in
+// allocation order, as it is after the optimizer has rewritten a function.
+static std::unique_ptr<Module> buildModule(LLVMContext &Ctx, int64_t NumUsers,
+                                           int64_t NumArgs) {
+  auto M = std::make_unique<Module>("bench", Ctx);
+  Type *I64 = Type::getInt64Ty(Ctx);
+  auto *F = Function::Create(FunctionType::get(I64, {I64, I64}, false),
+                             GlobalValue::ExternalLinkage, "f", M.get());
+  FunctionCallee Callee = M->getOrInsertFunction(
+      "g", FunctionType::get(I64, SmallVector<Type *, 16>(NumArgs, I64),
+                             false));
+  BasicBlock *BB = BasicBlock::Create(Ctx, "entry", F);
+  IRBuilder<> B(BB);
+  Value *X = F->arg_begin();
+  Value *Y = F->arg_begin() + 1;
+  std::vector<Instruction *> Insts;
+  for (int64_t I = 0; I < NumUsers; ++I) {
+    Value *Other = B.CreateMul(Y, B.getInt64(I + 2));
+    if (!NumArgs) {
+      Insts.push_back(cast<Instruction>(B.CreateAdd(Other, X)));
+      continue;
+    }
+    SmallVector<Value *, 16> Args(NumArgs, Other);
+    Args[0] = X;
+    Insts.push_back(B.CreateCall(Callee, Args));
+  }
+  B.CreateRet(X);
+
+  std::mt19937 Rng(42);
+  std::shuffle(Insts.begin(), Insts.end(), Rng);
+  for (Instruction *I : Insts)
+    I->moveBefore(BB->getTerminator());
+  return M;
+}
+
+// Arguments are the number of users and the number of call arguments, as for
+// buildModule.
+static void BM_WalkUsers(benchmark::State &State) {
+  LLVMContext Ctx;
+  std::unique_ptr<Module> M =
+      buildModule(Ctx, State.range(0), State.range(1));
+  Value *X = M->getFunction("f")->arg_begin();
+  for (auto _ : State) {
+    unsigned NumCalls = 0;
+    for (User *U : X->users())
+      NumCalls += isa<CallInst>(U);
+    benchmark::DoNotOptimize(NumCalls);
+  }
+  State.SetItemsProcessed(State.iterations() * State.range(0));
+}
+BENCHMARK(BM_WalkUsers)
+    ->Args({1000, 0})
+    ->Args({100000, 0})
+    ->Args({1000, 16})
+    ->Args({100000, 16});
+
+static void BM_WalkUsesOperandNo(benchmark::State &State) {
+  LLVMContext Ctx;
+  std::unique_ptr<Module> M =
+      buildModule(Ctx, State.range(0), State.range(1));
+  Value *X = M->getFunction("f")->arg_begin();
+  for (auto _ : State) {
+    unsigned Sum = 0;
+    for (const Use &U : X->uses())
+      Sum += U.getOperandNo();
+    benchmark::DoNotOptimize(Sum);
+  }
+  State.SetItemsProcessed(State.iterations() * State.range(0));
+}
+BENCHMARK(BM_WalkUsesOperandNo)
+    ->Args({1000, 0})
+    ->Args({100000, 0})
+    ->Args({1000, 16})
+    ->Args({100000, 16});
+
+BENCHMARK_MAIN();
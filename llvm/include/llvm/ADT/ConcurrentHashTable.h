@@ -0,0 +1,184 @@
+//===- llvm/ADT/ConcurrentHashTable.h - Thread-safe hash table --*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines ConcurrentHashTable, a hash table that multiple threads
+// can insert into and look up concurrently, and ConcurrentStringMap, which
+// interns string keys like StringMap.
+//
+// The table is split into shards, each a DenseMap protected by its own mutex.
+// A key is assigned to a shard by the high bits of its (mixed) hash value, so
+// threads inserting different keys rarely contend for a lock. Entries are
+// allocated in per-shard arenas and never move, so references returned by
+// try_emplace() and find() remain valid until the table is destroyed.
+//
+// The order in which entries are inserted depends on thread scheduling. Use
+// getSortedEntries() to visit entries in a deterministic order once all
+// insertions are done.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_CONCURRENTHASHTABLE_H
+#define LLVM_ADT_CONCURRENTHASHTABLE_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/MathExtras.h"
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+
+template <typename KeyT, typename ValueT,
+          typename KeyInfoT = DenseMapInfo<KeyT>>
+class ConcurrentHashTable {
+public:
+  using value_type = std::pair<KeyT, ValueT>;
+
+  /// Creates a table with \p NumShards shards, rounded up to a power of two.
+  /// More shards reduce lock contention at the cost of some memory.
+  explicit ConcurrentHashTable(unsigned NumShards = 64)
+      : ShardBits(Log2_32_Ceil(std::max(NumShards, 1U))),
+        Shards(new Shard[size_t(1) << ShardBits]) {}
+
+  ConcurrentHashTable(const ConcurrentHashTable &) = delete;
+  ConcurrentHashTable &operator=(const ConcurrentHashTable &) = delete;
+
+  /// Inserts an entry for \p Key whose value is constructed from \p Args,
+  /// unless the table already contains \p Key. Returns the entry for \p Key
+  /// and whether it was inserted.
+  template <typename... Ts>
+  std::pair<value_type *, bool> try_emplace(const KeyT &Key, Ts &&... Args) {
+    Shard &S = getShard(Key);
+    std::lock_guard<std::mutex> Lock(S.Mutex);
+    auto Ins = S.Map.try_emplace(Key, nullptr);
+    if (!Ins.second)
+      return {Ins.first->second, false};
+    value_type *E = new (S.Alloc.Allocate()) value_type(
+        std::piecewise_construct, std::forward_as_tuple(Key),
+        std::forward_as_tuple(std::forward<Ts>(Args)...));
+    Ins.first->second = E;
+    return {E, true};
+  }
+
+  /// Returns the entry for \p Key, or nullptr if there is none.
+  value_type *find(const KeyT &Key) const {
+    Shard &S = getShard(Key);
+    std::lock_guard<std::mutex> Lock(S.Mutex);
+    auto It = S.Map.find(Key);
+    return It == S.Map.end() ? nullptr : It->second;
+  }
+
+  size_t size() const {
+    size_t Ret = 0;
+    for (size_t I = 0, E = getNumShards(); I != E; ++I) {
+      std::lock_guard<std::mutex> Lock(Shards[I].Mutex);
+      Ret += Shards[I].Map.size();
+    }
+    return Ret;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  /// Calls \p F on each entry in an unspecified order. This must not be
+  /// called concurrently with insertions.
+  template <typename FnT> void forEach(FnT F) const {
+    for (size_t I = 0, E = getNumShards(); I != E; ++I)
+      for (auto &KV : Shards[I].Map)
+        F(*KV.second);
+  }
+
+  /// Returns all entries sorted by their keys. The result does not depend on
+  /// the order of insertions. This must not be called concurrently with
+  /// insertions.
+  template <typename CompareT = std::less<KeyT>>
+  std::vector<value_type *> getSortedEntries(CompareT Cmp = CompareT()) const {
+    std::vector<value_type *> V;
+    V.reserve(size());
+    forEach([&](value_type &E) { V.push_back(&E); });
+    llvm::sort(V, [&](const value_type *A, const value_type *B) {
+      return Cmp(A->first, B->first);
+    });
+    return V;
+  }
+
+private:
+  struct Shard {
+    mutable std::mutex Mutex;
+    DenseMap<KeyT, value_type *, KeyInfoT> Map;
+    SpecificBumpPtrAllocator<value_type> Alloc;
+  };
+
+  size_t getNumShards() const { return size_t(1) << ShardBits; }
+
+  Shard &getShard(const KeyT &Key) const {
+    if (ShardBits == 0)
+      return Shards[0];
+    // DenseMap uses the low bits of the hash value, so use the high bits of
+    // a mixed hash value to pick a shard.
+    uint64_t H = uint64_t(KeyInfoT::getHashValue(Key)) * 0x9E3779B97F4A7C15ULL;
+    return Shards[H >> (64 - ShardBits)];
+  }
+
+  const unsigned ShardBits;
+  std::unique_ptr<Shard[]> Shards;
+};
+
+/// A ConcurrentHashTable with string keys. Like StringMap, it owns copies of
+/// its keys, so callers can pass temporary strings.
+template <typename ValueT> class ConcurrentStringMap {
+  using TableT = ConcurrentHashTable<StringRef, ValueT>;
+
+public:
+  using value_type = typename TableT::value_type;
+
+  explicit ConcurrentStringMap(unsigned NumShards = 64) : Table(NumShards) {}
+
+  /// Inserts an entry for \p Key whose value is constructed from \p Args,
+  /// unless the map already contains \p Key. Returns the entry for \p Key and
+  /// whether it was inserted. The key of the returned entry points to memory
+  /// owned by the map.
+  template <typename... Ts>
+  std::pair<value_type *, bool> try_emplace(StringRef Key, Ts &&... Args) {
+    if (value_type *E = Table.find(Key))
+      return {E, false};
+    // If another thread inserts the same key first, the copy is wasted,
+    // which is cheaper than copying under the shard lock.
+    return Table.try_emplace(copyKey(Key), std::forward<Ts>(Args)...);
+  }
+
+  value_type *find(StringRef Key) const { return Table.find(Key); }
+  size_t size() const { return Table.size(); }
+  bool empty() const { return Table.empty(); }
+  template <typename FnT> void forEach(FnT F) const { Table.forEach(F); }
+  std::vector<value_type *> getSortedEntries() const {
+    return Table.getSortedEntries();
+  }
+
+private:
+  StringRef copyKey(StringRef Key) {
+    if (Key.empty())
+      return StringRef();
+    char *P = KeyAlloc.Allocate<char>(Key.size());
+    memcpy(P, Key.data(), Key.size());
+    return StringRef(P, Key.size());
+  }
+
+  TableT Table;
+  ThreadLocalBumpPtrAllocator KeyAlloc;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_ADT_CONCURRENTHASHTABLE_H
@@ -0,0 +1,704 @@
+//===- llvm/ADT/FlatHashMap.h - Open-addressing hash map --------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines FlatHashMap, a hash map with the same interface as
+// DenseMap that keeps a control byte per bucket to speed up probing.
+//
+// The control byte of a bucket says whether it is empty, deleted (a
+// tombstone) or full, and for full buckets holds 7 bits of the hash value of
+// the key. A lookup compares the control bytes of a group of 16 buckets (8
+// without SSE2) against those bits at once and compares keys only for the
+// buckets that match, which is almost always just the bucket being looked
+// for. The probe sequence visits groups rather than buckets, so that maps can
+// be filled to 7/8 of their capacity.
+//
+// Unlike DenseMap, FlatHashMap does not need empty and tombstone keys, only
+// KeyInfoT::getHashValue and KeyInfoT::isEqual. As with DenseMap, insertions
+// and erasures invalidate iterators, and references to elements are
+// invalidated when the map grows.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_FLATHASHMAP_H
+#define LLVM_ADT_FLATHASHMAP_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/EpochTracker.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemAlloc.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace llvm {
+
+namespace flat_hash_map_detail {
+
+/// The control byte of a bucket: kEmpty, kDeleted, kSentinel, or the low 7
+/// bits of the hash value of the key in a full bucket.
+using ctrl_t = int8_t;
+enum : ctrl_t { kEmpty = -128, kDeleted = -2, kSentinel = -1 };
+
+inline bool isFull(ctrl_t C) { return C >= 0; }
+inline bool isEmptyOrDeleted(ctrl_t C) { return C < kSentinel; }
+
+/// A mask with one bit, or one byte if Shift is 3, for each of the Width
+/// buckets of a group. Iterating over it yields the indices of the set bits.
+template <typename T, unsigned Width, unsigned Shift = 0> class BitMask {
+public:
+  explicit BitMask(T Mask) : Mask(Mask) {}
+
+  explicit operator bool() const { return Mask != 0; }
+  unsigned operator*() const { return countTrailingZeros(Mask) >> Shift; }
+  BitMask &operator++() {
+    Mask &= Mask - 1;
+    return *this;
+  }
+  bool operator!=(const BitMask &RHS) const { return Mask != RHS.Mask; }
+  BitMask begin() const { return *this; }
+  BitMask end() const { return BitMask(0); }
+
+  /// The number of buckets before the first set bit.
+  unsigned trailingZeros() const { return countTrailingZeros(Mask) >> Shift; }
+
+  /// The number of buckets after the last set bit.
+  unsigned leadingZeros() const {
+    constexpr unsigned ExtraBits = sizeof(T) * 8 - (Width << Shift);
+    return countLeadingZeros(T(Mask << ExtraBits)) >> Shift;
+  }
+
+private:
+  T Mask;
+};
+
+#ifdef __SSE2__
+/// The control bytes of 16 consecutive buckets, compared with SSE2.
+struct Group {
+  static constexpr unsigned Width = 16;
+  using MaskT = BitMask<uint32_t, Width>;
+
+  explicit Group(const ctrl_t *Pos)
+      : Ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(Pos))) {}
+
+  MaskT match(ctrl_t H2) const {
+    return MaskT(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(H2), Ctrl)));
+  }
+  MaskT matchEmpty() const {
+    return MaskT(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(kEmpty), Ctrl)));
+  }
+  MaskT matchEmptyOrDeleted() const {
+    return MaskT(
+        _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(kSentinel), Ctrl)));
+  }
+
+  __m128i Ctrl;
+};
+#else
+/// The control bytes of 8 consecutive buckets, compared as a 64-bit word.
+/// Each match sets the most significant bit of the matching byte.
+struct Group {
+  static constexpr unsigned Width = 8;
+  using MaskT = BitMask<uint64_t, Width, 3>;
+
+  explicit Group(const ctrl_t *Pos)
+      : Ctrl(support::endian::read64le(Pos)) {}
+
+  MaskT match(ctrl_t H2) const {
+    // Bytes of X are zero where the control byte equals H2. This may report
+    // a false match right after a true one, which the caller's key
+    // comparison filters out.
+    uint64_t X = Ctrl ^ (LSBs * uint8_t(H2));
+    return MaskT((X - LSBs) & ~X & MSBs);
+  }
+  MaskT matchEmpty() const { return MaskT((Ctrl & (~Ctrl << 6)) & MSBs); }
+  MaskT matchEmptyOrDeleted() const {
+    return MaskT((Ctrl & (~Ctrl << 7)) & MSBs);
+  }
+
+  static constexpr uint64_t LSBs = 0x0101010101010101ULL;
+  static constexpr uint64_t MSBs = 0x8080808080808080ULL;
+  uint64_t Ctrl;
+};
+#endif
+
+/// The control bytes of a map without buckets: a sentinel followed by empty
+/// bytes, so that lookups need no special case.
+inline ctrl_t *getEmptyGroup() {
+  alignas(16) static const ctrl_t EmptyGroup[Group::Width] = {
+      kSentinel, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+#ifdef __SSE2__
+      kEmpty,    kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+#endif
+  };
+  return const_cast<ctrl_t *>(EmptyGroup);
+}
+
+/// Returns the number of elements a map with \p Capacity buckets can hold.
+inline size_t capacityToGrowth(size_t Capacity) {
+  if (Group::Width == 8 && Capacity == 7)
+    return 6;
+  return Capacity - Capacity / 8;
+}
+
+/// Returns the smallest valid capacity for \p NumEntries elements.
+inline size_t growthToCapacity(size_t NumEntries) {
+  if (NumEntries == 0)
+    return 0;
+  size_t MinCapacity = NumEntries + (NumEntries - 1) / 7;
+  if (Group::Width == 8 && NumEntries == 7)
+    MinCapacity = 8;
+  // Capacities are of the form 2^N - 1.
+  return ~size_t(0) >> countLeadingZeros(MinCapacity);
+}
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename BucketT,
+          bool IsConst>
+class FlatHashMapIterator;
+
+} // end namespace flat_hash_map_detail
+
+template <typename KeyT, typename ValueT,
+          typename KeyInfoT = DenseMapInfo<KeyT>,
+          typename BucketT = llvm::detail::DenseMapPair<KeyT, ValueT>>
+class FlatHashMap : public DebugEpochBase {
+  using ctrl_t = flat_hash_map_detail::ctrl_t;
+  using Group = flat_hash_map_detail::Group;
+
+  template <typename T>
+  using const_arg_type_t = typename const_pointer_or_const_ref<T>::type;
+
+public:
+  using size_type = unsigned;
+  using key_type = KeyT;
+  using mapped_type = ValueT;
+  using value_type = BucketT;
+
+  using iterator = flat_hash_map_detail::FlatHashMapIterator<KeyT, ValueT,
+                                                             KeyInfoT, BucketT,
+                                                             false>;
+  using const_iterator =
+      flat_hash_map_detail::FlatHashMapIterator<KeyT, ValueT, KeyInfoT,
+                                                BucketT, true>;
+
+  /// Create a map that can hold \p InitialReserve elements without growing.
+  explicit FlatHashMap(unsigned InitialReserve = 0) {
+    if (InitialReserve)
+      allocate(flat_hash_map_detail::growthToCapacity(InitialReserve));
+  }
+
+  FlatHashMap(const FlatHashMap &Other) : DebugEpochBase() {
+    copyFrom(Other);
+  }
+
+  FlatHashMap(FlatHashMap &&Other) : DebugEpochBase() { swap(Other); }
+
+  template <typename InputIt> FlatHashMap(const InputIt &I, const InputIt &E) {
+    reserve(std::distance(I, E));
+    insert(I, E);
+  }
+
+  FlatHashMap(std::initializer_list<value_type> Vals)
+      : FlatHashMap(Vals.begin(), Vals.end()) {}
+
+  ~FlatHashMap() {
+    destroyAll();
+    deallocate();
+  }
+
+  FlatHashMap &operator=(const FlatHashMap &Other) {
+    if (&Other != this) {
+      incrementEpoch();
+      destroyAll();
+      deallocate();
+      copyFrom(Other);
+    }
+    return *this;
+  }
+
+  FlatHashMap &operator=(FlatHashMap &&Other) {
+    if (&Other != this) {
+      incrementEpoch();
+      destroyAll();
+      deallocate();
+      resetToEmpty();
+      swap(Other);
+    }
+    return *this;
+  }
+
+  void swap(FlatHashMap &RHS) {
+    incrementEpoch();
+    RHS.incrementEpoch();
+    std::swap(Ctrl, RHS.Ctrl);
+    std::swap(Buckets, RHS.Buckets);
+    std::swap(Capacity, RHS.Capacity);
+    std::swap(NumEntries, RHS.NumEntries);
+    std::swap(GrowthLeft, RHS.GrowthLeft);
+  }
+
+  iterator begin() { return makeIterator(0, /*Skip=*/true); }
+  iterator end() { return makeIterator(Capacity); }
+  const_iterator begin() const { return makeConstIterator(0, /*Skip=*/true); }
+  const_iterator end() const { return makeConstIterator(Capacity); }
+
+  LLVM_NODISCARD bool empty() const { return NumEntries == 0; }
+  unsigned size() const { return NumEntries; }
+
+  /// Grow the map so that it can contain at least \p NumEntries items before
+  /// resizing again.
+  void reserve(size_type NumEntries) {
+    incrementEpoch();
+    if (NumEntries > this->NumEntries + GrowthLeft)
+      resize(flat_hash_map_detail::growthToCapacity(NumEntries));
+  }
+
+  void clear() {
+    incrementEpoch();
+    destroyAll();
+    // If the map is large, release its memory rather than clearing all the
+    // control bytes, like DenseMap::shrink_and_clear does.
+    if (Capacity > 127) {
+      deallocate();
+      resetToEmpty();
+      return;
+    }
+    NumEntries = 0;
+    resetCtrl();
+  }
+
+  /// Return 1 if the specified key is in the map, 0 otherwise.
+  size_type count(const_arg_type_t<KeyT> Val) const {
+    return findBucket(Val) != Capacity ? 1 : 0;
+  }
+
+  iterator find(const_arg_type_t<KeyT> Val) {
+    return makeIterator(findBucket(Val));
+  }
+  const_iterator find(const_arg_type_t<KeyT> Val) const {
+    return makeConstIterator(findBucket(Val));
+  }
+
+  /// Alternate version of find() which allows a different, and possibly less
+  /// expensive, key type. The DenseMapInfo is responsible for supplying
+  /// methods getHashValue(LookupKeyT) and isEqual(LookupKeyT, KeyT) for each
+  /// key type used.
+  template <class LookupKeyT> iterator find_as(const LookupKeyT &Val) {
+    return makeIterator(findBucket(Val));
+  }
+  template <class LookupKeyT>
+  const_iterator find_as(const LookupKeyT &Val) const {
+    return makeConstIterator(findBucket(Val));
+  }
+
+  /// Return the entry for the specified key, or a default constructed value
+  /// if no such entry exists.
+  ValueT lookup(const_arg_type_t<KeyT> Val) const {
+    size_t I = findBucket(Val);
+    if (I != Capacity)
+      return Buckets[I].getSecond();
+    return ValueT();
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // If the key is already in the map, it returns false and doesn't update the
+  // value.
+  std::pair<iterator, bool> insert(const std::pair<KeyT, ValueT> &KV) {
+    return try_emplace(KV.first, KV.second);
+  }
+
+  std::pair<iterator, bool> insert(std::pair<KeyT, ValueT> &&KV) {
+    return try_emplace(std::move(KV.first), std::move(KV.second));
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // The value is constructed in-place if the key is not in the map, otherwise
+  // it is not moved.
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(KeyT &&Key, Ts &&... Args) {
+    return tryEmplaceImpl(std::move(Key), std::forward<Ts>(Args)...);
+  }
+
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(const KeyT &Key, Ts &&... Args) {
+    return tryEmplaceImpl(Key, std::forward<Ts>(Args)...);
+  }
+
+  /// insert - Range insertion of pairs.
+  template <typename InputIt> void insert(InputIt I, InputIt E) {
+    for (; I != E; ++I)
+      insert(*I);
+  }
+
+  bool erase(const KeyT &Val) {
+    size_t I = findBucket(Val);
+    if (I == Capacity)
+      return false;
+    eraseBucket(I);
+    return true;
+  }
+
+  void erase(iterator I) { eraseBucket(I.Ptr - Buckets); }
+
+  value_type &FindAndConstruct(const KeyT &Key) {
+    return *try_emplace(Key).first;
+  }
+
+  ValueT &operator[](const KeyT &Key) { return FindAndConstruct(Key).second; }
+
+  value_type &FindAndConstruct(KeyT &&Key) {
+    return *try_emplace(std::move(Key)).first;
+  }
+
+  ValueT &operator[](KeyT &&Key) {
+    return FindAndConstruct(std::move(Key)).second;
+  }
+
+  /// Return the approximate size (in bytes) of the actual map.
+  /// This is just the raw memory used by FlatHashMap.
+  /// If entries are pointers to objects, the size of the referenced objects
+  /// are not included.
+  size_t getMemorySize() const { return Capacity ? getAllocSize(Capacity) : 0; }
+
+private:
+  friend class flat_hash_map_detail::FlatHashMapIterator<
+      KeyT, ValueT, KeyInfoT, BucketT, false>;
+  friend class flat_hash_map_detail::FlatHashMapIterator<
+      KeyT, ValueT, KeyInfoT, BucketT, true>;
+
+  // Control bytes cloned after the sentinel, so that a group can be loaded
+  // from any bucket without wrapping around.
+  static constexpr size_t NumClonedBytes = Group::Width - 1;
+
+  template <typename LookupKeyT> static size_t getHash(const LookupKeyT &Val) {
+    // DenseMapInfo hash values are often weak in the high bits, and the
+    // control bytes need well-distributed low bits independent of the bits
+    // used to pick the first group, so mix them.
+    uint64_t H = uint64_t(KeyInfoT::getHashValue(Val)) * 0x9E3779B97F4A7C15ULL;
+    return size_t(H ^ (H >> 32));
+  }
+  static ctrl_t getH2(size_t Hash) { return ctrl_t(Hash & 0x7F); }
+
+  static size_t getBucketOffset(size_t Capacity) {
+    return alignTo(Capacity + NumClonedBytes + 1, alignof(BucketT));
+  }
+  static size_t getAllocSize(size_t Capacity) {
+    return getBucketOffset(Capacity) + Capacity * sizeof(BucketT);
+  }
+  static size_t getAllocAlign() {
+    return std::max<size_t>(alignof(BucketT), alignof(size_t));
+  }
+
+  /// Return the index of the bucket holding \p Val, or Capacity if there is
+  /// none.
+  template <typename LookupKeyT>
+  size_t findBucket(const LookupKeyT &Val) const {
+    size_t Hash = getHash(Val);
+    ctrl_t H2 = getH2(Hash);
+    size_t Offset = (Hash >> 7) & Capacity;
+    for (size_t Step = Group::Width;; Step += Group::Width) {
+      Group G(Ctrl + Offset);
+      for (unsigned I : G.match(H2)) {
+        size_t Pos = (Offset + I) & Capacity;
+        if (LLVM_LIKELY(KeyInfoT::isEqual(Val, Buckets[Pos].getFirst())))
+          return Pos;
+      }
+      if (LLVM_LIKELY(G.matchEmpty()))
+        return Capacity;
+      // Triangular probing visits every group once if the table has a power
+      // of two number of groups.
+      Offset = (Offset + Step) & Capacity;
+      assert(Step <= Capacity + Group::Width && "full table!");
+    }
+  }
+
+  /// Return the first empty or deleted bucket on the probe sequence of
+  /// \p Hash.
+  size_t findFirstNonFull(size_t Hash) const {
+    size_t Offset = (Hash >> 7) & Capacity;
+    for (size_t Step = Group::Width;; Step += Group::Width) {
+      auto Mask = Group(Ctrl + Offset).matchEmptyOrDeleted();
+      if (Mask)
+        return (Offset + *Mask) & Capacity;
+      Offset = (Offset + Step) & Capacity;
+      assert(Step <= Capacity + Group::Width && "full table!");
+    }
+  }
+
+  template <typename KeyArg, typename... Ts>
+  std::pair<iterator, bool> tryEmplaceImpl(KeyArg &&Key, Ts &&... Args) {
+    size_t I = findBucket(Key);
+    if (I != Capacity)
+      return std::make_pair(makeIterator(I), false);
+
+    size_t Hash = getHash(Key);
+    I = findFirstNonFull(Hash);
+    if (LLVM_UNLIKELY(GrowthLeft == 0 &&
+                      Ctrl[I] != flat_hash_map_detail::kDeleted)) {
+      grow();
+      I = findFirstNonFull(Hash);
+    }
+    incrementEpoch();
+    ++NumEntries;
+    GrowthLeft -= Ctrl[I] == flat_hash_map_detail::kEmpty;
+    setCtrl(I, getH2(Hash));
+    BucketT *B = Buckets + I;
+    ::new (&B->getFirst()) KeyT(std::forward<KeyArg>(Key));
+    ::new (&B->getSecond()) ValueT(std::forward<Ts>(Args)...);
+    return std::make_pair(makeIterator(I), true);
+  }
+
+  void eraseBucket(size_t I) {
+    incrementEpoch();
+    Buckets[I].getSecond().~ValueT();
+    Buckets[I].getFirst().~KeyT();
+    --NumEntries;
+
+    // If no probe sequence can have passed bucket I while it was full, that
+    // is, if there are fewer than Group::Width full or deleted buckets in a
+    // row around it, it can become empty rather than deleted.
+    size_t Before = (I - Group::Width) & Capacity;
+    auto EmptyAfter = Group(Ctrl + I).matchEmpty();
+    auto EmptyBefore = Group(Ctrl + Before).matchEmpty();
+    bool WasNeverFull =
+        EmptyBefore && EmptyAfter &&
+        EmptyAfter.trailingZeros() + EmptyBefore.leadingZeros() < Group::Width;
+    setCtrl(I, WasNeverFull ? flat_hash_map_detail::kEmpty
+                            : flat_hash_map_detail::kDeleted);
+    GrowthLeft += WasNeverFull;
+  }
+
+  /// Set the control byte of bucket \p I and its clone.
+  void setCtrl(size_t I, ctrl_t H) {
+    Ctrl[I] = H;
+    Ctrl[((I - NumClonedBytes) & Capacity) + (NumClonedBytes & Capacity)] = H;
+  }
+
+  void resetCtrl() {
+    std::memset(Ctrl, flat_hash_map_detail::kEmpty,
+                Capacity + NumClonedBytes + 1);
+    Ctrl[Capacity] = flat_hash_map_detail::kSentinel;
+    GrowthLeft = flat_hash_map_detail::capacityToGrowth(Capacity) - NumEntries;
+  }
+
+  void resetToEmpty() {
+    Ctrl = flat_hash_map_detail::getEmptyGroup();
+    Buckets = nullptr;
+    Capacity = 0;
+    NumEntries = 0;
+    GrowthLeft = 0;
+  }
+
+  /// Allocate \p NewCapacity buckets, all empty, for a map with no buckets.
+  void allocate(size_t NewCapacity) {
+    assert(isPowerOf2_64(NewCapacity + 1) && "invalid capacity");
+    char *Mem =
+        static_cast<char *>(allocate_buffer(getAllocSize(NewCapacity),
+                                            getAllocAlign()));
+    Ctrl = reinterpret_cast<ctrl_t *>(Mem);
+    Buckets = reinterpret_cast<BucketT *>(Mem + getBucketOffset(NewCapacity));
+    Capacity = NewCapacity;
+    resetCtrl();
+  }
+
+  void deallocate() {
+    if (Capacity)
+      deallocate_buffer(Ctrl, getAllocSize(Capacity), getAllocAlign());
+  }
+
+  void destroyAll() {
+    if (std::is_trivially_destructible<KeyT>::value &&
+        std::is_trivially_destructible<ValueT>::value)
+      return;
+    for (size_t I = 0; I != Capacity; ++I) {
+      if (flat_hash_map_detail::isFull(Ctrl[I])) {
+        Buckets[I].getSecond().~ValueT();
+        Buckets[I].getFirst().~KeyT();
+      }
+    }
+  }
+
+  void copyFrom(const FlatHashMap &Other) {
+    if (!Other.Capacity) {
+      resetToEmpty();
+      return;
+    }
+    NumEntries = Other.NumEntries;
+    allocate(Other.Capacity);
+    std::memcpy(Ctrl, Other.Ctrl, Capacity + NumClonedBytes + 1);
+    GrowthLeft = Other.GrowthLeft;
+    for (size_t I = 0; I != Capacity; ++I) {
+      if (flat_hash_map_detail::isFull(Ctrl[I])) {
+        ::new (&Buckets[I].getFirst()) KeyT(Other.Buckets[I].getFirst());
+        ::new (&Buckets[I].getSecond()) ValueT(Other.Buckets[I].getSecond());
+      }
+    }
+  }
+
+  /// Make room for one more element, by growing the map or, if many buckets
+  /// are deleted, by rehashing it in place.
+  void grow() {
+    if (Capacity == 0)
+      resize(Group::Width - 1);
+    else if (Capacity > Group::Width && uint64_t(NumEntries) * 32 <=
+                                            uint64_t(Capacity) * 25)
+      resize(Capacity);
+    else
+      resize(Capacity * 2 + 1);
+  }
+
+  void resize(size_t NewCapacity) {
+    ctrl_t *OldCtrl = Ctrl;
+    BucketT *OldBuckets = Buckets;
+    size_t OldCapacity = Capacity;
+
+    allocate(NewCapacity);
+    for (size_t I = 0; I != OldCapacity; ++I) {
+      if (!flat_hash_map_detail::isFull(OldCtrl[I]))
+        continue;
+      BucketT &Old = OldBuckets[I];
+      size_t Hash = getHash(Old.getFirst());
+      size_t J = findFirstNonFull(Hash);
+      setCtrl(J, getH2(Hash));
+      ::new (&Buckets[J].getFirst()) KeyT(std::move(Old.getFirst()));
+      ::new (&Buckets[J].getSecond()) ValueT(std::move(Old.getSecond()));
+      Old.getSecond().~ValueT();
+      Old.getFirst().~KeyT();
+    }
+    GrowthLeft = flat_hash_map_detail::capacityToGrowth(Capacity) - NumEntries;
+
+    if (OldCapacity)
+      deallocate_buffer(OldCtrl, getAllocSize(OldCapacity), getAllocAlign());
+  }
+
+  iterator makeIterator(size_t I, bool Skip = false) {
+    return iterator(Ctrl + I, Buckets + I, *this, Skip);
+  }
+  const_iterator makeConstIterator(size_t I, bool Skip = false) const {
+    return const_iterator(Ctrl + I, Buckets + I, *this, Skip);
+  }
+
+  ctrl_t *Ctrl = flat_hash_map_detail::getEmptyGroup();
+  BucketT *Buckets = nullptr;
+  /// The number of buckets, which is zero or one less than a power of two.
+  size_t Capacity = 0;
+  unsigned NumEntries = 0;
+  /// The number of empty buckets that can be filled before growing.
+  size_t GrowthLeft = 0;
+};
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename BucketT>
+inline void swap(FlatHashMap<KeyT, ValueT, KeyInfoT, BucketT> &LHS,
+                 FlatHashMap<KeyT, ValueT, KeyInfoT, BucketT> &RHS) {
+  LHS.swap(RHS);
+}
+
+namespace flat_hash_map_detail {
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename Bucket,
+          bool IsConst>
+class FlatHashMapIterator : DebugEpochBase::HandleBase {
+  friend class FlatHashMapIterator<KeyT, ValueT, KeyInfoT, Bucket, true>;
+  friend class FlatHashMapIterator<KeyT, ValueT, KeyInfoT, Bucket, false>;
+  friend class FlatHashMap<KeyT, ValueT, KeyInfoT, Bucket>;
+
+  using ConstIterator =
+      FlatHashMapIterator<KeyT, ValueT, KeyInfoT, Bucket, true>;
+
+public:
+  using difference_type = ptrdiff_t;
+  using value_type =
+      typename std::conditional<IsConst, const Bucket, Bucket>::type;
+  using pointer = value_type *;
+  using reference = value_type &;
+  using iterator_category = std::forward_iterator_tag;
+
+private:
+  const ctrl_t *Ctrl = nullptr;
+  pointer Ptr = nullptr;
+
+public:
+  FlatHashMapIterator() = default;
+
+  FlatHashMapIterator(const ctrl_t *Ctrl, pointer Ptr,
+                      const DebugEpochBase &Epoch, bool Skip = false)
+      : DebugEpochBase::HandleBase(&Epoch), Ctrl(Ctrl), Ptr(Ptr) {
+    if (Skip)
+      skipEmptyOrDeleted();
+  }
+
+  // Converting ctor from non-const iterators to const iterators. SFINAE'd out
+  // for const iterator destinations so it doesn't end up as a user defined
+  // copy constructor.
+  template <bool IsConstSrc,
+            typename = typename std::enable_if<!IsConstSrc && IsConst>::type>
+  FlatHashMapIterator(
+      const FlatHashMapIterator<KeyT, ValueT, KeyInfoT, Bucket, IsConstSrc> &I)
+      : DebugEpochBase::HandleBase(I), Ctrl(I.Ctrl), Ptr(I.Ptr) {}
+
+  reference operator*() const {
+    assert(isHandleInSync() && "invalid iterator access!");
+    return *Ptr;
+  }
+  pointer operator->() const {
+    assert(isHandleInSync() && "invalid iterator access!");
+    return Ptr;
+  }
+
+  bool operator==(const ConstIterator &RHS) const {
+    assert((!Ptr || isHandleInSync()) && "handle not in sync!");
+    assert((!RHS.Ptr || RHS.isHandleInSync()) && "handle not in sync!");
+    assert(getEpochAddress() == RHS.getEpochAddress() &&
+           "comparing incomparable iterators!");
+    return Ctrl == RHS.Ctrl;
+  }
+  bool operator!=(const ConstIterator &RHS) const {
+    return !(*this == RHS);
+  }
+
+  inline FlatHashMapIterator &operator++() { // Preincrement
+    assert(isHandleInSync() && "invalid iterator access!");
+    ++Ctrl;
+    ++Ptr;
+    skipEmptyOrDeleted();
+    return *this;
+  }
+  FlatHashMapIterator operator++(int) { // Postincrement
+    assert(isHandleInSync() && "invalid iterator access!");
+    FlatHashMapIterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+private:
+  /// Advance to the next full bucket or to the sentinel.
+  void skipEmptyOrDeleted() {
+    while (isEmptyOrDeleted(*Ctrl)) {
+      ++Ctrl;
+      ++Ptr;
+    }
+  }
+};
+
+} // end namespace flat_hash_map_detail
+
+} // end namespace llvm
+
+#endif // LLVM_ADT_FLATHASHMAP_H
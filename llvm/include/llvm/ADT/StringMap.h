@@ -107,6 +107,9 @@ public:
   unsigned getNumBuckets() const { return NumBuckets; }
   unsigned getNumItems() const { return NumItems; }
 
+  /// Returns the hash value that StringMap uses for \p Key.
+  static uint32_t hash(StringRef Key);
+
   bool empty() const { return NumItems == 0; }
   unsigned size() const { return NumItems; }
 
@@ -484,6 +484,19 @@ public:
   void releaseMemory();
 
 private:
+  // These variants share the alias analysis caches of \p BatchAA with the
+  // other queries of a walk, which must not modify the IR.
+  MemDepResult getPointerDependencyFrom(const MemoryLocation &Loc, bool isLoad,
+                                        BasicBlock::iterator ScanIt,
+                                        BasicBlock *BB, Instruction *QueryInst,
+                                        unsigned *Limit, OrderedBasicBlock *OBB,
+                                        BatchAAResults &BatchAA);
+  MemDepResult
+  getSimplePointerDependencyFrom(const MemoryLocation &MemLoc, bool isLoad,
+                                 BasicBlock::iterator ScanIt, BasicBlock *BB,
+                                 Instruction *QueryInst, unsigned *Limit,
+                                 OrderedBasicBlock *OBB,
+                                 BatchAAResults &BatchAA);
   MemDepResult getCallDependencyFrom(CallBase *Call, bool isReadOnlyCall,
                                      BasicBlock::iterator ScanIt,
                                      BasicBlock *BB);
@@ -493,11 +506,13 @@ private:
                                    BasicBlock *BB,
                                    SmallVectorImpl<NonLocalDepResult> &Result,
                                    DenseMap<BasicBlock *, Value *> &Visited,
+                                   BatchAAResults &BatchAA,
                                    bool SkipFirstBlock = false);
   MemDepResult GetNonLocalInfoForBlock(Instruction *QueryInst,
                                        const MemoryLocation &Loc, bool isLoad,
                                        BasicBlock *BB, NonLocalDepInfo *Cache,
-                                       unsigned NumSortedEntries);
+                                       unsigned NumSortedEntries,
+                                       BatchAAResults &BatchAA);
 
   void RemoveCachedNonLocalPointerDependencies(ValueIsLoadPair P);
 
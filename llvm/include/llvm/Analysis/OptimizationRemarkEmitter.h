@@ -84,6 +84,24 @@ public:
     }
   }
 
+  /// Take the name of the emitting pass, the block the remark is about, and a
+  /// lambda that returns a remark which will be emitted. Knowing the pass and
+  /// the block up front lets us skip building the remark when the remarks of
+  /// the pass aren't enabled or filtered out, or when the block doesn't meet
+  /// the hotness threshold.
+  template <typename T>
+  void emit(StringRef PassName, const BasicBlock *Block, T RemarkBuilder,
+            decltype(RemarkBuilder()) * = nullptr) {
+    if (!enabled(PassName) || !meetsHotnessThreshold(Block))
+      return;
+    auto R = RemarkBuilder();
+    emit((DiagnosticInfoOptimizationBase &)R);
+  }
+
+  /// Whether remarks of the pass \p PassName are enabled, either in the
+  /// diagnostic handler or in the remark streamer and its pass filter.
+  bool enabled(StringRef PassName) const;
+
   /// Whether we allow for extra compile-time budget to perform more
   /// analysis to produce fewer false positives.
   ///
@@ -92,8 +110,7 @@ public:
   /// provide more context so that non-trivial false positives can be quickly
   /// detected by the user.
   bool allowExtraAnalysis(StringRef PassName) const {
-    return (F->getContext().getRemarkStreamer() ||
-            F->getContext().getDiagHandlerPtr()->isAnyRemarkEnabled(PassName));
+    return enabled(PassName);
   }
 
 private:
@@ -111,6 +128,9 @@ private:
   /// Similar but use value from \p OptDiag and update hotness there.
   void computeHotness(DiagnosticInfoIROptimization &OptDiag);
 
+  /// Whether a remark about \p V would meet the hotness threshold.
+  bool meetsHotnessThreshold(const Value *V);
+
   /// Only allow verbose messages if we know we're filtering by hotness
   /// (BFI is only set in this case).
   bool shouldEmitVerbose() { return BFI != nullptr; }
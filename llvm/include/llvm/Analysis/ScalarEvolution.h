@@ -796,6 +796,13 @@ public:
   // bodies).
   void forgetAllLoops();
 
+  /// Forget all loops as forgetAllLoops does, and also free all SCEV
+  /// expressions and predicates, so that the memory of a function with many
+  /// expressions can be reused. All SCEVs and SCEVPredicates previously
+  /// returned by this ScalarEvolution are dangling afterwards, so this should
+  /// only be called by a client that does not hold on to any of them.
+  void forgetAllExpressions();
+
   /// This method should be called by the client when it has changed a loop in
   /// a way that may effect ScalarEvolution's ability to compute a trip count,
   /// or if the loop is deleted.  This call is potentially expensive for large
@@ -1355,6 +1362,11 @@ private:
     /// subexpression.
     bool hasOperand(const SCEV *S, ScalarEvolution *SE) const;
 
+    /// Return true if any backedge taken count expressions refer to any of
+    /// the given subexpressions.
+    bool hasAnyOperand(const SmallPtrSetImpl<const SCEV *> &Ops,
+                       ScalarEvolution *SE) const;
+
     /// Invalidate this result and free associated memory.
     void clear();
   };
@@ -1766,6 +1778,10 @@ private:
   /// Drop memoized information computed for S.
   void forgetMemoizedResults(const SCEV *S);
 
+  /// Drop memoized information computed for all of \p SCEVs. This scans the
+  /// caches indexed by loop once for all of them.
+  void forgetMemoizedResults(ArrayRef<const SCEV *> SCEVs);
+
   /// Return an existing SCEV for V if there is one, otherwise return nullptr.
   const SCEV *getExistingSCEV(Value *V);
 
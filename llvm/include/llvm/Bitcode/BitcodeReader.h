@@ -30,6 +30,7 @@ namespace llvm {
 
 class LLVMContext;
 class Module;
+class LazyMetadataIndexCache;
 
   // These functions are for converting Expected/Error values to
   // ErrorOr/std::error_code for compatibility with legacy clients. FIXME:
@@ -68,10 +69,14 @@ class Module;
     // The bitstream location of this module's MODULE_BLOCK.
     uint64_t ModuleBit;
 
+    // The index of the module-level metadata built when the module is lazily
+    // loaded for importing. It only depends on the bitcode, so it is shared by
+    // the copies of this module and by the modules loaded from it in any
+    // context, e.g. by the ThinLTO backends importing from it in parallel.
+    std::shared_ptr<LazyMetadataIndexCache> MetadataIndexCache;
+
     BitcodeModule(ArrayRef<uint8_t> Buffer, StringRef ModuleIdentifier,
-                  uint64_t IdentificationBit, uint64_t ModuleBit)
-        : Buffer(Buffer), ModuleIdentifier(ModuleIdentifier),
-          IdentificationBit(IdentificationBit), ModuleBit(ModuleBit) {}
+                  uint64_t IdentificationBit, uint64_t ModuleBit);
 
     // Calls the ctor.
     friend Expected<BitcodeFileContents>
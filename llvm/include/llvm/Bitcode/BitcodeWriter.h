@@ -26,10 +26,12 @@ namespace llvm {
 
 class BitstreamWriter;
 class Module;
+class raw_fd_stream;
 class raw_ostream;
 
   class BitcodeWriter {
     SmallVectorImpl<char> &Buffer;
+    raw_fd_stream *FS;
     std::unique_ptr<BitstreamWriter> Stream;
 
     StringTableBuilder StrtabBuilder{StringTableBuilder::RAW};
@@ -46,7 +48,14 @@ class raw_ostream;
 
   public:
     /// Create a BitcodeWriter that writes to Buffer.
-    BitcodeWriter(SmallVectorImpl<char> &Buffer);
+    ///
+    /// If \p FS is not null, completed blocks are flushed from Buffer to \p FS
+    /// once Buffer grows past -bitcode-flush-threshold, so Buffer only holds
+    /// the tail of the bitcode. The caller must write the rest of Buffer to
+    /// \p FS when it is done, must not write to \p FS in the meantime, and
+    /// cannot ask writeModule() to generate a module hash, which is computed
+    /// from Buffer.
+    BitcodeWriter(SmallVectorImpl<char> &Buffer, raw_fd_stream *FS = nullptr);
 
     ~BitcodeWriter();
 
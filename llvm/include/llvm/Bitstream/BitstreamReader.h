@@ -229,7 +229,34 @@ public:
     return R;
   }
 
+  /// Decode a VBR from the bits already in CurWord, without refilling it or
+  /// going through Expected for each chunk. Returns false, consuming nothing,
+  /// if the value runs past those bits.
+  bool readVBRFromCurWord(unsigned NumBits, uint64_t &Result) {
+    const word_t ContinueBit = word_t(1) << (NumBits - 1);
+    word_t Word = CurWord;
+    uint64_t Value = 0;
+    for (unsigned Used = NumBits, Shift = 0; Used <= BitsInCurWord;
+         Used += NumBits, Shift += NumBits - 1) {
+      Value |= uint64_t(Word & (ContinueBit - 1)) << Shift;
+      if (!(Word & ContinueBit)) {
+        // Used is the whole word only when BitsInCurWord is zero afterwards,
+        // in which case what is left in CurWord does not matter.
+        CurWord >>= (Used & (MaxChunkSize - 1));
+        BitsInCurWord -= Used;
+        Result = Value;
+        return true;
+      }
+      Word >>= (NumBits & (MaxChunkSize - 1));
+    }
+    return false;
+  }
+
   Expected<uint32_t> ReadVBR(unsigned NumBits) {
+    uint64_t Value;
+    if (readVBRFromCurWord(NumBits, Value))
+      return uint32_t(Value);
+
     Expected<unsigned> MaybeRead = Read(NumBits);
     if (!MaybeRead)
       return MaybeRead;
@@ -257,6 +284,10 @@ public:
   // Read a VBR that may have a value up to 64-bits in size. The chunk size of
   // the VBR must still be <= 32 bits though.
   Expected<uint64_t> ReadVBR64(unsigned NumBits) {
+    uint64_t Value;
+    if (readVBRFromCurWord(NumBits, Value))
+      return Value;
+
     Expected<uint64_t> MaybeRead = Read(NumBits);
     if (!MaybeRead)
       return MaybeRead;
@@ -20,13 +20,28 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Bitstream/BitCodes.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <vector>
 
 namespace llvm {
 
 class BitstreamWriter {
+  /// Out - The buffer that keeps unflushed bytes.
   SmallVectorImpl<char> &Out;
 
+  /// FS - The file stream that Out flushes to. If FS is nullptr, Out is never
+  /// flushed and holds the whole bitstream.
+  raw_fd_stream *FS;
+
+  /// FlushThreshold - If FS is valid, Out is flushed to FS once it holds this
+  /// many bytes at the end of a block.
+  const uint64_t FlushThreshold;
+
+  /// FSStartPos - The position of FS when this writer was created. Byte
+  /// offsets in the bitstream are relative to it.
+  const uint64_t FSStartPos;
+
   /// CurBit - Always between 0 and 31 inclusive, specifies the next bit to use.
   unsigned CurBit;
 
@@ -72,17 +87,43 @@ class BitstreamWriter {
                reinterpret_cast<const char *>(&Value + 1));
   }
 
-  size_t GetBufferOffset() const { return Out.size(); }
+  uint64_t GetNumOfFlushedBytes() const {
+    return FS ? FS->tell() - FSStartPos : 0;
+  }
+
+  uint64_t GetBufferOffset() const {
+    return Out.size() + GetNumOfFlushedBytes();
+  }
 
   size_t GetWordIndex() const {
-    size_t Offset = GetBufferOffset();
+    uint64_t Offset = GetBufferOffset();
     assert((Offset & 3) == 0 && "Not 32-bit aligned");
     return Offset / 4;
   }
 
+  /// If the related file stream supports reading, seeking and writing, flush
+  /// the buffer if its size is above a threshold.
+  void FlushToFile() {
+    if (!FS || Out.size() < FlushThreshold)
+      return;
+    FS->write(Out.data(), Out.size());
+    Out.clear();
+  }
+
 public:
-  explicit BitstreamWriter(SmallVectorImpl<char> &O)
-    : Out(O), CurBit(0), CurValue(0), CurCodeSize(2) {}
+  /// Create a BitstreamWriter that writes to Buffer \p O.
+  ///
+  /// \p FS is the file stream that \p O flushes to incrementally. If \p FS is
+  /// null, \p O does not flush incrementally, but writes to disk at the end.
+  ///
+  /// \p FlushThreshold is the threshold (unit M) to flush \p O if \p FS is
+  /// valid.
+  explicit BitstreamWriter(SmallVectorImpl<char> &O,
+                           raw_fd_stream *FS = nullptr,
+                           uint32_t FlushThreshold = 512)
+      : Out(O), FS(FS), FlushThreshold(uint64_t(FlushThreshold) << 20),
+        FSStartPos(FS ? FS->tell() : 0), CurBit(0), CurValue(0),
+        CurCodeSize(2) {}
 
   ~BitstreamWriter() {
     assert(CurBit == 0 && "Unflushed data remaining");
@@ -103,12 +144,52 @@ public:
   /// with the specified value.
   void BackpatchWord(uint64_t BitNo, unsigned NewWord) {
     using namespace llvm::support;
-    unsigned ByteNo = BitNo / 8;
+    uint64_t ByteNo = BitNo / 8;
+    uint64_t StartBit = BitNo & 7;
+    uint64_t NumOfFlushedBytes = GetNumOfFlushedBytes();
+
+    if (ByteNo >= NumOfFlushedBytes) {
+      assert((!endian::readAtBitAlignment<uint32_t, little, unaligned>(
+                 &Out[ByteNo - NumOfFlushedBytes], StartBit)) &&
+             "Expected to be patching over 0-value placeholders");
+      endian::writeAtBitAlignment<uint32_t, little, unaligned>(
+          &Out[ByteNo - NumOfFlushedBytes], NewWord, StartBit);
+      return;
+    }
+
+    // The word to patch has been flushed to the file, at least partially.
+    // Read the flushed bytes back, patch them, and write them out again. The
+    // remaining bytes, if any, are still at the start of Out.
+    uint64_t CurPos = FS->tell();
+
+    // writeAtBitAlignment accesses two words, even though an unaligned word
+    // only spans five bytes.
+    char Bytes[8] = {0};
+    size_t BytesNum = StartBit ? 5 : 4;
+    size_t BytesFromDisk =
+        std::min(static_cast<uint64_t>(BytesNum), NumOfFlushedBytes - ByteNo);
+    size_t BytesFromBuffer = BytesNum - BytesFromDisk;
+
+    FS->seek(FSStartPos + ByteNo);
+    ssize_t BytesRead = FS->read(Bytes, BytesFromDisk);
+    (void)BytesRead; // silence warning
+    assert(BytesRead >= 0 && static_cast<size_t>(BytesRead) == BytesFromDisk);
+    if (BytesFromBuffer)
+      memcpy(Bytes + BytesFromDisk, Out.data(), BytesFromBuffer);
+
     assert((!endian::readAtBitAlignment<uint32_t, little, unaligned>(
-               &Out[ByteNo], BitNo & 7)) &&
+               Bytes, StartBit)) &&
            "Expected to be patching over 0-value placeholders");
-    endian::writeAtBitAlignment<uint32_t, little, unaligned>(
-        &Out[ByteNo], NewWord, BitNo & 7);
+    endian::writeAtBitAlignment<uint32_t, little, unaligned>(Bytes, NewWord,
+                                                             StartBit);
+
+    FS->seek(FSStartPos + ByteNo);
+    FS->write(Bytes, BytesFromDisk);
+    if (BytesFromBuffer)
+      memcpy(Out.data(), Bytes + BytesFromDisk, BytesFromBuffer);
+
+    // Restore the file position.
+    FS->seek(CurPos);
   }
 
   void BackpatchWord64(uint64_t BitNo, uint64_t Val) {
@@ -245,6 +326,7 @@ public:
     CurCodeSize = B.PrevCodeSize;
     CurAbbrevs = std::move(B.PrevAbbrevs);
     BlockScope.pop_back();
+    FlushToFile();
   }
 
   //===--------------------------------------------------------------------===//
@@ -1130,6 +1130,9 @@ public:
   /// Determine what action should be taken to legalize the described
   /// instruction. Requires computeTables to have been called.
   ///
+  /// The rules are functions of the query, so the result is cached and
+  /// repeated queries do not walk the rules again.
+  ///
   /// \returns a description of the next legalization step to perform.
   LegalizeActionStep getAction(const LegalityQuery &Query) const;
 
@@ -1321,6 +1324,40 @@ private:
   std::pair<LegalizeAction, LLT>
   findVectorLegalAction(const InstrAspect &Aspect) const;
 
+  /// Determine the action for \p Query from the rules, without the cache.
+  LegalizeActionStep computeAction(const LegalityQuery &Query) const;
+
+  /// The key of a cached query: its opcode, types, and memory descriptions.
+  /// Queries with more types or memory operands than it holds aren't cached.
+  struct CachedQuery {
+    static const unsigned MaxTypes = 4;
+    static const unsigned MaxMemDescs = 2;
+
+    unsigned Opcode = 0;
+    unsigned NumTypes = 0;
+    unsigned NumMemDescs = 0;
+    LLT Types[MaxTypes];
+    LegalityQuery::MemDesc MMODescrs[MaxMemDescs];
+  };
+
+  struct CachedQueryInfo {
+    static CachedQuery getEmptyKey() {
+      CachedQuery Key;
+      Key.Opcode = ~0U;
+      return Key;
+    }
+    static CachedQuery getTombstoneKey() {
+      CachedQuery Key;
+      Key.Opcode = ~0U - 1;
+      return Key;
+    }
+    static unsigned getHashValue(const CachedQuery &Key);
+    static bool isEqual(const CachedQuery &LHS, const CachedQuery &RHS);
+  };
+
+  /// Fill in \p Key for \p Query. Returns false if the query doesn't fit.
+  static bool getCachedQuery(const LegalityQuery &Query, CachedQuery &Key);
+
   static const int FirstOp = TargetOpcode::PRE_ISEL_GENERIC_OPCODE_START;
   static const int LastOp = TargetOpcode::PRE_ISEL_GENERIC_OPCODE_END;
 
@@ -1342,6 +1379,11 @@ private:
       NumElements2Actions[LastOp - FirstOp + 1];
 
   LegalizeRuleSet RulesForOpcode[LastOp - FirstOp + 1];
+
+  /// The results of previous calls to getAction. Like the rest of the
+  /// subtarget that owns it, a LegalizerInfo is used by one thread at a time.
+  mutable DenseMap<CachedQuery, LegalizeActionStep, CachedQueryInfo>
+      ActionCache;
 };
 
 #ifndef NDEBUG
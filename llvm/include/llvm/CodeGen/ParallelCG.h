@@ -29,7 +29,9 @@ class raw_pwrite_stream;
 /// factory function for the TargetMachine TMFactory. Writes OSs.size() output
 /// files to the output streams in OSs. The resulting output files if linked
 /// together are intended to be equivalent to the single output file that would
-/// have been code generated from M.
+/// have been code generated from M. Each partition holds consecutive
+/// functions of M of about the same total size, so linking the output files in
+/// the order of OSs keeps the function order of M.
 ///
 /// Writes bitcode for individual partitions into output streams in BCOSs, if
 /// BCOSs is not empty.
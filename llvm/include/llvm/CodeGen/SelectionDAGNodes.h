@@ -611,6 +611,11 @@ private:
   /// Unique id per SDNode in the DAG.
   int NodeId = -1;
 
+  /// Position of the node in the worklist of the DAG combiner, -1 if it has
+  /// not been on the worklist of the current combine, or -2 if it has been
+  /// combined since it was last removed from the worklist.
+  int CombinerWorklistIndex = -1;
+
   /// The values that are used by this operation.
   SDUse *OperandList = nullptr;
 
@@ -756,6 +761,10 @@ public:
   /// Set unique node id.
   void setNodeId(int Id) { NodeId = Id; }
 
+  /// Get and set the state of the node in the DAG combiner worklist.
+  int getCombinerWorklistIndex() const { return CombinerWorklistIndex; }
+  void setCombinerWorklistIndex(int Index) { CombinerWorklistIndex = Index; }
+
   /// Return the node ordering.
   unsigned getIROrder() const { return IROrder; }
 
@@ -181,6 +181,9 @@ struct DIDumpOptions {
   bool SummarizeTypes = false;
   bool Verbose = false;
   bool DisplayRawContents = false;
+  /// The number of threads verify() may use to check units when the context
+  /// is thread safe, or 0 for one per hardware thread.
+  unsigned NumThreads = 1;
 
   /// Return default option set for printing a single DIE without children.
   static DIDumpOptions getForSingleDIE() {
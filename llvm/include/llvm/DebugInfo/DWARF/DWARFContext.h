@@ -36,10 +36,12 @@
 #include "llvm/Support/DataExtractor.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/Host.h"
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
 
 namespace llvm {
 
@@ -55,6 +57,12 @@ enum class ErrorPolicy { Halt, Continue };
 /// DWARFContext
 /// This data structure is the top level entity that deals with dwarf debug
 /// information parsing. The actual data is supplied through DWARFObj.
+///
+/// Most of the sections and units are parsed on demand. A context created as
+/// thread safe serializes that parsing, so that several threads can query it
+/// at once, e.g. each working on different compile units. The units of a
+/// thread safe context extract all of their DIEs the first time any of them is
+/// needed, and the abbreviations are parsed up front and shared read-only.
 class DWARFContext : public DIContext {
   DWARFUnitVector NormalUnits;
   std::unique_ptr<DWARFUnitIndex> CUIndex;
@@ -91,6 +99,15 @@ class DWARFContext : public DIContext {
 
   std::unique_ptr<MCRegisterInfo> RegInfo;
 
+  /// Whether this context may be queried from several threads at once.
+  bool ThreadSafe;
+  /// Serializes the parsing done on demand, if the context is thread safe.
+  mutable std::recursive_mutex Mutex;
+  /// Set once the units were parsed, so that they can then be accessed
+  /// without locking.
+  std::atomic<bool> NormalUnitsParsed{false};
+  std::atomic<bool> DWOUnitsParsed{false};
+
   /// Read compile units from the debug_info section (if necessary)
   /// and type units from the debug_types sections (if necessary)
   /// and store them in NormalUnits.
@@ -107,7 +124,7 @@ class DWARFContext : public DIContext {
 
 public:
   DWARFContext(std::unique_ptr<const DWARFObject> DObj,
-               std::string DWPName = "");
+               std::string DWPName = "", bool ThreadSafe = false);
   ~DWARFContext();
 
   DWARFContext(DWARFContext &) = delete;
@@ -115,6 +132,19 @@ public:
 
   const DWARFObject &getDWARFObj() const { return *DObj; }
 
+  /// \returns true if this context may be queried from several threads at
+  /// once.
+  bool isThreadSafe() const { return ThreadSafe; }
+
+  /// Lock the state of this context that is parsed on demand, if the context
+  /// is thread safe. Code that locks both the context and one of its units
+  /// must lock the context first.
+  std::unique_lock<std::recursive_mutex> lockIfThreadSafe() const {
+    if (!ThreadSafe)
+      return std::unique_lock<std::recursive_mutex>();
+    return std::unique_lock<std::recursive_mutex>(Mutex);
+  }
+
   static bool classof(const DIContext *DICtx) {
     return DICtx->getKind() == CK_DWARF;
   }
@@ -349,11 +379,12 @@ public:
   static std::unique_ptr<DWARFContext>
   create(const object::ObjectFile &Obj, const LoadedObjectInfo *L = nullptr,
          function_ref<ErrorPolicy(Error)> HandleError = defaultErrorHandler,
-         std::string DWPName = "");
+         std::string DWPName = "", bool ThreadSafe = false);
 
   static std::unique_ptr<DWARFContext>
   create(const StringMap<std::unique_ptr<MemoryBuffer>> &Sections,
-         uint8_t AddrSize, bool isLittleEndian = sys::IsLittleEndianHost);
+         uint8_t AddrSize, bool isLittleEndian = sys::IsLittleEndianHost,
+         bool ThreadSafe = false);
 
   /// Loads register info for the architecture of the provided object file.
   /// Improves readability of dumped DWARF expressions. Requires the caller to
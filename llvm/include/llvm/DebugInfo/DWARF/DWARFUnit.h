@@ -25,11 +25,13 @@
 #include "llvm/DebugInfo/DWARF/DWARFUnitIndex.h"
 #include "llvm/Support/DataExtractor.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 
@@ -236,6 +238,15 @@ class DWARFUnit {
 
   std::shared_ptr<DWARFUnit> DWO;
 
+  /// When the context is thread safe, serializes the extraction of the DIEs
+  /// and of the other state of the unit that is computed on demand.
+  std::recursive_mutex LazyStateMutex;
+  /// Set once all DIEs were extracted in a thread safe context. After that
+  /// DieArray and the state read from the unit DIE no longer change.
+  std::atomic<bool> AllDIEsExtracted{false};
+  /// Set once parseDWO() was attempted in a thread safe context.
+  std::atomic<bool> DWOParsed{false};
+
   uint32_t getDIEIndex(const DWARFDebugInfoEntry *Die) {
     auto First = DieArray.data();
     assert(Die >= First && Die < First + DieArray.size());
@@ -510,6 +521,9 @@ private:
   /// hasn't already been done
   void extractDIEsIfNeeded(bool CUDieOnly);
 
+  /// Does the work of tryExtractDIEsIfNeeded() without any locking.
+  Error extractDIEsIfNeededImpl(bool CUDieOnly);
+
   /// extractDIEsToVector - Appends all parsed DIEs to a vector.
   void extractDIEsToVector(bool AppendCUDie, bool AppendNonCUDIEs,
                            std::vector<DWARFDebugInfoEntry> &DIEs) const;
@@ -520,6 +534,7 @@ private:
   /// parseDWO - Parses .dwo file for current compile unit. Returns true if
   /// it was actually constructed.
   bool parseDWO();
+  bool parseDWOImpl();
 };
 
 } // end namespace llvm
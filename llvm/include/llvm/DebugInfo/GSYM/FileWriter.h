@@ -109,6 +109,9 @@ public:
   ///         file position.
   uint64_t tell();
 
+  /// Return the stream that this object writes to.
+  llvm::raw_pwrite_stream &get_stream() { return OS; }
+
 private:
   FileWriter(const FileWriter &rhs) = delete;
   void operator=(const FileWriter &rhs) = delete;
@@ -13,12 +13,15 @@
 #ifndef LLVM_DEBUGINFO_SYMBOLIZE_SYMBOLIZE_H
 #define LLVM_DEBUGINFO_SYMBOLIZE_SYMBOLIZE_H
 
+#include "llvm/ADT/ilist_node.h"
+#include "llvm/ADT/simple_ilist.h"
 #include "llvm/DebugInfo/Symbolize/SymbolizableModule.h"
 #include "llvm/Object/Binary.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/Error.h"
 #include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -32,6 +35,31 @@ using namespace object;
 
 using FunctionNameKind = DILineInfoSpecifier::FunctionNameKind;
 
+/// A binary loaded by the symbolizer, along with the actions that drop the
+/// cached state that refers to it when it is evicted from the cache.
+class CachedBinary : public ilist_node<CachedBinary> {
+public:
+  CachedBinary() = default;
+  CachedBinary(OwningBinary<Binary> Bin) : Bin(std::move(Bin)) {}
+
+  OwningBinary<Binary> &operator*() { return Bin; }
+  OwningBinary<Binary> *operator->() { return &Bin; }
+
+  /// \returns the number of bytes of the file this binary was loaded from.
+  size_t size() const;
+
+  /// Add an action to run when this binary is evicted. Actions run in the
+  /// reverse order of their addition.
+  void pushEvictor(std::function<void()> Evictor);
+
+  /// Run the eviction actions. This may destroy the CachedBinary itself.
+  void evict();
+
+private:
+  OwningBinary<Binary> Bin;
+  std::function<void()> Evictor;
+};
+
 class LLVMSymbolizer {
 public:
   struct Options {
@@ -44,6 +72,11 @@ public:
     std::vector<std::string> DsymHints;
     std::string FallbackDebugPath;
     std::string DWPName;
+    /// The size in bytes of the binaries to keep loaded across calls to
+    /// pruneCache(). The most recently used binary is always kept.
+    size_t MaxCacheSize = sizeof(size_t) == 4
+                              ? 512 * 1024 * 1024 /* 512 MiB */
+                              : static_cast<size_t>(4ULL << 30) /* 4 GiB */;
   };
 
   LLVMSymbolizer() = default;
@@ -67,6 +100,14 @@ public:
                  object::SectionedAddress ModuleOffset);
   void flush();
 
+  /// Evict the least recently used binaries, and everything that was built
+  /// from them, until the loaded binaries fit in Options::MaxCacheSize.
+  ///
+  /// Clients that serve many requests, e.g. one per line of input, should
+  /// call this between requests so that memory stays bounded while the
+  /// binaries that are used repeatedly stay loaded.
+  void pruneCache();
+
   static std::string
   DemangleName(const std::string &Name,
                const SymbolizableModule *DbiModuleDescriptor);
@@ -109,6 +150,12 @@ private:
   Expected<ObjectFile *> getOrCreateObject(const std::string &Path,
                                           const std::string &ArchName);
 
+  /// Mark the binaries of \p Objects as the most recently used.
+  void recordAccess(const ObjectPair &Objects);
+
+  /// Run \p Evictor when either of the binaries of \p Objects is evicted.
+  void pushEvictor(const ObjectPair &Objects, std::function<void()> Evictor);
+
   std::map<std::string, std::unique_ptr<SymbolizableModule>> Modules;
 
   /// Contains cached results of getOrCreateObjectPair().
@@ -116,7 +163,13 @@ private:
       ObjectPairForPathArch;
 
   /// Contains parsed binary for each path, or parsing error.
-  std::map<std::string, OwningBinary<Binary>> BinaryForPath;
+  std::map<std::string, CachedBinary> BinaryForPath;
+
+  /// The loaded binaries, from the least to the most recently used.
+  simple_ilist<CachedBinary> LRUBinaries;
+
+  /// The sum of the sizes of the binaries in LRUBinaries.
+  size_t CacheSize = 0;
 
   /// Parsed object file for path/architecture pair, where "path" refers
   /// to Mach-O universal binary.
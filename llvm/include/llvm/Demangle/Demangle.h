@@ -98,6 +98,36 @@ private:
   void *RootNode;
   void *Context;
 };
+
+/// A demangler for tools that demangle many names, such as all the symbols of
+/// a binary. Unlike itaniumDemangle, it keeps its memory from one name to the
+/// next: the AST of a name is allocated in an arena that is recycled rather
+/// than freed, and the name is printed into a buffer owned by the demangler.
+///
+/// It can also remember the result for each name, for inputs where the same
+/// names come up again and again. The memory this takes grows with the number
+/// of distinct names.
+///
+/// A demangler must not be used by several threads at once.
+struct ItaniumDemangleContext {
+  explicit ItaniumDemangleContext(bool CacheResults = false);
+
+  ItaniumDemangleContext(ItaniumDemangleContext &&Other);
+  ItaniumDemangleContext &operator=(ItaniumDemangleContext &&Other);
+
+  /// Demangle MangledName, setting *Status like itaniumDemangle does.
+  /// \return the demangled name, which is only valid until the next call to
+  /// this demangler, or nullptr on error
+  const char *demangle(const char *MangledName, int *Status = nullptr);
+
+  /// Demangle MangledName into Buf. The parameters and the result behave like
+  /// those of itaniumDemangle.
+  char *demangle(const char *MangledName, char *Buf, size_t *N, int *Status);
+
+  ~ItaniumDemangleContext();
+private:
+  void *Context;
+};
 } // namespace llvm
 
 #endif
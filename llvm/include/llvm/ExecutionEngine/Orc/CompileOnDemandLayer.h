@@ -94,6 +94,13 @@ public:
 
   /// Sets the ImplSymbolMap
   void setImplMap(ImplSymbolMap *Imp);
+
+  /// Points the stub for Name at NewAddr, e.g. to install a recompiled body
+  /// for the function. ImplD must be an implementation dylib created by this
+  /// layer, i.e. the dylib that the original body was emitted into.
+  Error redirectStub(JITDylib &ImplD, const SymbolStringPtr &Name,
+                     JITTargetAddress NewAddr);
+
   /// Emits the given module. This should not be called by clients: it will be
   /// called by the JIT when a definition added via the add method is requested.
   void emit(MaterializationResponsibility R, ThreadSafeModule TSM) override;
@@ -15,11 +15,13 @@
 
 #include "llvm/ADT/BitmaskEnum.h"
 #include "llvm/ADT/FunctionExtras.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ExecutionEngine/JITSymbol.h"
 #include "llvm/ExecutionEngine/Orc/SymbolStringPool.h"
 #include "llvm/ExecutionEngine/OrcV1Deprecation.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/RWMutex.h"
 
 #include <memory>
 #include <vector>
@@ -301,6 +303,15 @@ public:
                                               std::move(K)));
   }
 
+  /// Called by materialization dispatchers that drop this MaterializationUnit
+  /// without materializing it (e.g. because its task was cancelled). All
+  /// symbols provided by this unit are moved to the error state, and any
+  /// queries waiting on them fail.
+  void doFail(JITDylib &JD) {
+    MaterializationResponsibility(JD, std::move(SymbolFlags), std::move(K))
+        .failMaterialization();
+  }
+
   /// Called by JITDylibs to notify MaterializationUnits that the given symbol
   /// has been overridden.
   void doDiscard(const JITDylib &JD, const SymbolStringPtr &Name) {
@@ -748,9 +759,25 @@ private:
       std::vector<std::pair<JITDylib *, SymbolStringPtr>>;
   static void notifyFailed(FailedSymbolsWorklist FailedSymbols);
 
+  /// Look up Name among the symbols of this dylib that are known to be ready,
+  /// without taking the session lock. Returns None if Name is not known to be
+  /// ready, even if it is defined here.
+  Optional<JITEvaluatedSymbol> lookupReadySymbol(const SymbolStringPtr &Name);
+
+  /// Record that Name has reached the Ready state. Called with the session
+  /// lock held.
+  void addReadySymbol(const SymbolStringPtr &Name, JITEvaluatedSymbol Sym);
+
   ExecutionSession &ES;
   std::string JITDylibName;
   SymbolTable Symbols;
+
+  // A copy of the Ready part of Symbols that lookups can search concurrently.
+  // Ready symbols only change when they are removed, so this is read-mostly.
+  // Writes happen with the session lock held as well as ReadySymbolsMutex.
+  sys::RWMutex ReadySymbolsMutex;
+  DenseMap<SymbolStringPtr, JITEvaluatedSymbol> ReadySymbols;
+
   UnmaterializedInfosMap UnmaterializedInfos;
   MaterializingInfosMap MaterializingInfos;
   std::vector<std::unique_ptr<DefinitionGenerator>> DefGenerators;
@@ -925,6 +952,12 @@ private:
 
   void runOutstandingMUs();
 
+  /// Resolve Symbols from the ready symbols of the JITDylibs in SearchOrder
+  /// without taking the session lock. If any symbol can not be resolved this
+  /// way, returns None and the caller must fall back to a full lookup.
+  Optional<SymbolMap> lookupReadySymbols(const JITDylibSearchList &SearchOrder,
+                                         const SymbolNameSet &Symbols);
+
   mutable std::recursive_mutex SessionMutex;
   std::shared_ptr<SymbolStringPool> SSP;
   VModuleKey LastKey = 0;
@@ -13,6 +13,7 @@
 #ifndef LLVM_EXECUTIONENGINE_ORC_LLJIT_H
 #define LLVM_EXECUTIONENGINE_ORC_LLJIT_H
 
+#include "llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h"
 #include "llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
@@ -20,8 +21,8 @@
 #include "llvm/ExecutionEngine/Orc/IRTransformLayer.h"
 #include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
 #include "llvm/ExecutionEngine/Orc/ObjectTransformLayer.h"
+#include "llvm/ExecutionEngine/Orc/TaskDispatch.h"
 #include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
-#include "llvm/Support/ThreadPool.h"
 
 namespace llvm {
 namespace orc {
@@ -137,7 +138,8 @@ protected:
   JITDylib &Main;
 
   DataLayout DL;
-  std::unique_ptr<ThreadPool> CompileThreads;
+  std::unique_ptr<TaskDispatcher> Dispatcher;
+  std::unique_ptr<ObjectCache> ObjCache;
 
   std::unique_ptr<ObjectLayer> ObjLinkingLayer;
   std::unique_ptr<IRCompileLayer> CompileLayer;
@@ -196,6 +198,8 @@ public:
   ObjectLinkingLayerCreator CreateObjectLinkingLayer;
   CompileFunctionCreator CreateCompileFunction;
   unsigned NumCompileThreads = 0;
+  std::unique_ptr<TaskDispatcher> Dispatcher;
+  std::unique_ptr<ObjectCache> ObjCache;
 
   /// Called prior to JIT class construcion to fix up defaults.
   Error prepareForConstruction();
@@ -245,7 +249,8 @@ public:
   ///
   /// If set to zero, compilation will be performed on the execution thread when
   /// JITing in-process. If set to any other number N, a thread pool of N
-  /// threads will be created for compilation.
+  /// threads will be created for compilation. The pool starts on-demand
+  /// materializations before speculative ones.
   ///
   /// If this method is not called, behavior will be as if it were called with
   /// a zero argument.
@@ -254,6 +259,24 @@ public:
     return impl();
   }
 
+  /// Set a dispatcher for materialization tasks, e.g. one that hands them to
+  /// an executor owned by the client. This overrides setNumCompileThreads.
+  ///
+  /// The dispatcher may run tasks concurrently, so the JIT is configured as
+  /// it would be for a non-zero number of compile threads.
+  SetterImpl &setTaskDispatcher(std::unique_ptr<TaskDispatcher> Dispatcher) {
+    impl().Dispatcher = std::move(Dispatcher);
+    return impl();
+  }
+
+  /// Set an ObjectCache for the default compile function to consult before
+  /// compiling each module, e.g. an OnDiskObjectCache. Ignored if a
+  /// CompileFunctionCreator is set.
+  SetterImpl &setObjectCache(std::unique_ptr<ObjectCache> ObjCache) {
+    impl().ObjCache = std::move(ObjCache);
+    return impl();
+  }
+
   /// Create an instance of the JIT.
   Expected<std::unique_ptr<JITType>> create() {
     if (auto Err = impl().prepareForConstruction())
@@ -0,0 +1,90 @@
+//===-- OnDiskObjectCache.h - Persistent object cache for ORC ---*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// An ObjectCache that keeps compiled objects in a directory, so that they can
+// be reused by later runs of a JIT.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_ONDISKOBJECTCACHE_H
+#define LLVM_EXECUTIONENGINE_ORC_ONDISKOBJECTCACHE_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/Error.h"
+
+#include <mutex>
+#include <string>
+
+namespace llvm {
+namespace orc {
+
+class JITTargetMachineBuilder;
+
+/// A content-addressed ObjectCache backed by a directory.
+///
+/// Entries are keyed by a hash of the module's bitcode together with a key
+/// for the target and code generation options, so a cached object is only
+/// reused for an identical module compiled the same way. Entries are written
+/// atomically, and the directory may be shared by concurrent JIT processes.
+///
+/// The cache is safe to use from concurrent compile threads.
+class OnDiskObjectCache : public ObjectCache {
+public:
+  /// Create a cache in directory Dir, creating the directory if needed, for
+  /// objects compiled by target machines built by JTMB.
+  ///
+  /// If Policy is given, the directory is pruned according to it after each
+  /// new entry is written.
+  static Expected<std::unique_ptr<OnDiskObjectCache>>
+  Create(StringRef Dir, const JITTargetMachineBuilder &JTMB,
+         Optional<CachePruningPolicy> Policy = None);
+
+  /// Create a cache in directory Dir with an explicit TargetKey. Objects are
+  /// only shared between caches created with the same key.
+  static Expected<std::unique_ptr<OnDiskObjectCache>>
+  Create(StringRef Dir, std::string TargetKey,
+         Optional<CachePruningPolicy> Policy = None);
+
+  /// Returns a key describing the target and the code generation options of
+  /// JTMB, and the version of LLVM.
+  ///
+  /// Only the commonly varied TargetOptions are part of the key. Clients that
+  /// vary others should append them to the key and use the TargetKey
+  /// overload of Create.
+  static std::string getTargetKey(const JITTargetMachineBuilder &JTMB);
+
+  void notifyObjectCompiled(const Module *M, MemoryBufferRef Obj) override;
+  std::unique_ptr<MemoryBuffer> getObject(const Module *M) override;
+
+private:
+  OnDiskObjectCache(std::string Dir, std::string TargetKey,
+                    Optional<CachePruningPolicy> Policy)
+      : Dir(std::move(Dir)), TargetKey(std::move(TargetKey)),
+        Policy(std::move(Policy)) {}
+
+  std::string computeKey(const Module &M) const;
+  std::string getEntryPath(StringRef Key) const;
+
+  std::string Dir;
+  std::string TargetKey;
+  Optional<CachePruningPolicy> Policy;
+
+  // Compilers may change the module between getObject and
+  // notifyObjectCompiled, so the key is computed in getObject and remembered
+  // here for the store.
+  std::mutex PendingKeysMutex;
+  DenseMap<const Module *, std::string> PendingKeys;
+};
+
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_ONDISKOBJECTCACHE_H
@@ -19,9 +19,11 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ExecutionEngine/JITLink/JITLinkMemoryManager.h"
 #include "llvm/ExecutionEngine/JITSymbol.h"
 #include "llvm/ExecutionEngine/Orc/IndirectionUtils.h"
 #include "llvm/ExecutionEngine/Orc/OrcRemoteTargetRPCAPI.h"
+#include "llvm/ExecutionEngine/Orc/SharedMemory.h"
 #include "llvm/ExecutionEngine/RuntimeDyld.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Error.h"
@@ -29,6 +31,7 @@
 #include "llvm/Support/Format.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/Memory.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -329,6 +332,170 @@ public:
     std::vector<EHFrame> RegisteredEHFrames;
   };
 
+  /// Remote-mapped JITLink memory manager that shares memory with the remote
+  /// instead of copying into it.
+  ///
+  /// Each segment is backed by its own named shared memory object, mapped
+  /// read/write here and read-only on the remote. The linker writes straight
+  /// into the local view. Finalization unmaps the local view and then applies
+  /// the segment's protections to the remote view, so no process ever holds
+  /// a mapping of JIT'd code that is both writable and executable.
+  class RemoteJITLinkMemoryManager : public jitlink::JITLinkMemoryManager {
+    friend class OrcRemoteTargetClient;
+
+  public:
+    ~RemoteJITLinkMemoryManager() {
+      Client.destroyRemoteAllocator(Id);
+      LLVM_DEBUG(dbgs() << "Destroyed remote allocator " << Id << "\n");
+    }
+
+    RemoteJITLinkMemoryManager(const RemoteJITLinkMemoryManager &) = delete;
+    RemoteJITLinkMemoryManager &
+    operator=(const RemoteJITLinkMemoryManager &) = delete;
+
+    Expected<std::unique_ptr<Allocation>>
+    allocate(const SegmentsRequestMap &Request) override {
+      if (!isSharedMemorySupported())
+        return make_error<StringError>("Shared memory is not supported on "
+                                       "this host",
+                                       inconvertibleErrorCode());
+
+      // Segments get separate page-aligned mappings so that each one can be
+      // given its own protections on the remote.
+      uint64_t PageSize =
+          std::max<uint64_t>(Client.getPageSize(),
+                             sys::Process::getPageSizeEstimate());
+
+      std::unique_ptr<SharedAlloc> Alloc(new SharedAlloc(Client, Id));
+      for (auto &KV : Request) {
+        auto &Seg = KV.second;
+
+        if (Seg.getAlignment() > PageSize) {
+          auto Err = make_error<StringError>("Cannot request higher than page "
+                                             "alignment",
+                                             inconvertibleErrorCode());
+          return joinErrors(std::move(Err), Alloc->deallocate());
+        }
+
+        uint64_t Size = Seg.getContentSize() + Seg.getZeroFillSize();
+        if (auto Err = Alloc->addSegment(
+                KV.first, std::max<uint64_t>(alignTo(Size, PageSize),
+                                             PageSize)))
+          return joinErrors(std::move(Err), Alloc->deallocate());
+      }
+
+      LLVM_DEBUG({
+        dbgs() << "Allocator " << Id << " mapped shared segments:\n";
+        for (auto &KV : Alloc->Segments)
+          dbgs() << "  " << static_cast<void *>(KV.second.Local.base())
+                 << " -> " << format("0x%016" PRIx64, KV.second.Remote) << " ("
+                 << KV.second.Local.allocatedSize() << " bytes)\n";
+      });
+
+      return std::unique_ptr<Allocation>(std::move(Alloc));
+    }
+
+  private:
+    class SharedAlloc : public Allocation {
+      friend class RemoteJITLinkMemoryManager;
+
+    public:
+      SharedAlloc(OrcRemoteTargetClient &Client, ResourceIdMgr::ResourceId Id)
+          : Client(Client), Id(Id) {}
+
+      ~SharedAlloc() override {
+        for (auto &KV : Segments)
+          releaseLocal(KV.second);
+      }
+
+      MutableArrayRef<char> getWorkingMemory(ProtectionFlags Seg) override {
+        assert(Segments.count(Seg) && "No allocation for segment");
+        auto &Local = Segments[Seg].Local;
+        assert(Local.base() && "Segment has already been finalized");
+        return {static_cast<char *>(Local.base()), Local.allocatedSize()};
+      }
+
+      JITTargetAddress getTargetMemory(ProtectionFlags Seg) override {
+        assert(Segments.count(Seg) && "No allocation for segment");
+        return Segments[Seg].Remote;
+      }
+
+      void finalizeAsync(FinalizeContinuation OnFinalize) override {
+        // The shared memory already holds the linked content, so all that is
+        // left is to drop the writable view and protect the remote one.
+        Error Err = Error::success();
+        for (auto &KV : Segments) {
+          Err = joinErrors(std::move(Err), releaseLocal(KV.second));
+          Err = joinErrors(std::move(Err),
+                           Client.callB<mem::SetProtections>(
+                               Id, KV.second.Remote, KV.first));
+        }
+        OnFinalize(std::move(Err));
+      }
+
+      Error deallocate() override {
+        Error Err = Error::success();
+        for (auto &KV : Segments) {
+          Err = joinErrors(std::move(Err), releaseLocal(KV.second));
+          if (KV.second.Remote)
+            Err = joinErrors(std::move(Err), Client.callB<mem::ReleaseMem>(
+                                                 Id, KV.second.Remote));
+        }
+        Segments.clear();
+        return Err;
+      }
+
+    private:
+      struct Segment {
+        sys::MemoryBlock Local;
+        JITTargetAddress Remote = 0;
+      };
+
+      Error addSegment(unsigned Prot, uint64_t Size) {
+        auto Name = getUniqueSharedMemoryName();
+        auto Local = createSharedMemory(Name, Size);
+        if (!Local)
+          return Local.takeError();
+        auto &Seg = Segments[Prot];
+        Seg.Local = *Local;
+
+        // New shared memory is zero-filled, so neither side has to clear the
+        // zero-fill part of the segment.
+        auto Remote = Client.callB<mem::MapSharedMem>(Id, Name, Size);
+
+        // Both sides have mapped the object (or failed to), so its name is no
+        // longer needed. Removing it now means nothing leaks if either
+        // process dies before the memory is released.
+        auto UnlinkErr = unlinkSharedMemory(Name);
+        if (!Remote)
+          return joinErrors(Remote.takeError(), std::move(UnlinkErr));
+        Seg.Remote = *Remote;
+        return UnlinkErr;
+      }
+
+      static Error releaseLocal(Segment &Seg) {
+        if (!Seg.Local.base())
+          return Error::success();
+        auto EC = sys::Memory::releaseMappedMemory(Seg.Local);
+        Seg.Local = sys::MemoryBlock();
+        return errorCodeToError(EC);
+      }
+
+      OrcRemoteTargetClient &Client;
+      ResourceIdMgr::ResourceId Id;
+      DenseMap<unsigned, Segment> Segments;
+    };
+
+    RemoteJITLinkMemoryManager(OrcRemoteTargetClient &Client,
+                               ResourceIdMgr::ResourceId Id)
+        : Client(Client), Id(Id) {
+      LLVM_DEBUG(dbgs() << "Created remote allocator " << Id << "\n");
+    }
+
+    OrcRemoteTargetClient &Client;
+    ResourceIdMgr::ResourceId Id;
+  };
+
   /// Remote indirect stubs manager.
   class RemoteIndirectStubsManager : public IndirectStubsManager {
   public:
@@ -546,6 +713,17 @@ public:
         new RemoteRTDyldMemoryManager(*this, Id));
   }
 
+  /// Create a JITLinkMemoryManager whose allocations are shared with the
+  /// remote target rather than copied to it.
+  Expected<std::unique_ptr<RemoteJITLinkMemoryManager>>
+  createRemoteJITLinkMemoryManager() {
+    auto Id = AllocatorIds.getNext();
+    if (auto Err = callB<mem::CreateRemoteAllocator>(Id))
+      return std::move(Err);
+    return std::unique_ptr<RemoteJITLinkMemoryManager>(
+        new RemoteJITLinkMemoryManager(*this, Id));
+  }
+
   /// Create an RCIndirectStubsManager that will allocate stubs on the remote
   /// target.
   Expected<std::unique_ptr<RemoteIndirectStubsManager>>
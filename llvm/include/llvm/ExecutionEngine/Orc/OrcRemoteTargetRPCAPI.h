@@ -234,6 +234,18 @@ namespace mem {
     static const char *getName() { return "DestroyRemoteAllocator"; }
   };
 
+  /// Map a named shared memory object created by the client into the remote
+  /// via the given allocator. The remote mapping is read-only until its
+  /// protections are set with SetProtections.
+  class MapSharedMem
+      : public rpc::Function<MapSharedMem,
+                             JITTargetAddress(ResourceIdMgr::ResourceId AllocID,
+                                              std::string Name,
+                                              uint64_t Size)> {
+  public:
+    static const char *getName() { return "MapSharedMem"; }
+  };
+
   /// Read a remote memory block.
   class ReadMem
       : public rpc::Function<ReadMem, std::vector<uint8_t>(JITTargetAddress Src,
@@ -242,6 +254,15 @@ namespace mem {
     static const char *getName() { return "ReadMem"; }
   };
 
+  /// Release a block of memory reserved or mapped by the given allocator.
+  class ReleaseMem
+      : public rpc::Function<ReleaseMem,
+                             void(ResourceIdMgr::ResourceId AllocID,
+                                  JITTargetAddress Addr)> {
+  public:
+    static const char *getName() { return "ReleaseMem"; }
+  };
+
   /// Reserve a block of memory on the remote via the given allocator.
   class ReserveMem
       : public rpc::Function<ReserveMem,
@@ -17,6 +17,7 @@
 #include "llvm/ExecutionEngine/JITSymbol.h"
 #include "llvm/ExecutionEngine/Orc/OrcError.h"
 #include "llvm/ExecutionEngine/Orc/OrcRemoteTargetRPCAPI.h"
+#include "llvm/ExecutionEngine/Orc/SharedMemory.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/Format.h"
@@ -68,7 +69,9 @@ public:
                                            &ThisT::handleCreateRemoteAllocator);
     addHandler<mem::DestroyRemoteAllocator>(
         *this, &ThisT::handleDestroyRemoteAllocator);
+    addHandler<mem::MapSharedMem>(*this, &ThisT::handleMapSharedMem);
     addHandler<mem::ReadMem>(*this, &ThisT::handleReadMem);
+    addHandler<mem::ReleaseMem>(*this, &ThisT::handleReleaseMem);
     addHandler<mem::ReserveMem>(*this, &ThisT::handleReserveMem);
     addHandler<mem::SetProtections>(*this, &ThisT::handleSetProtections);
     addHandler<mem::WriteMem>(*this, &ThisT::handleWriteMem);
@@ -131,6 +134,27 @@ private:
       return Error::success();
     }
 
+    Error mapShared(void *&Addr, StringRef Name, uint64_t Size) {
+      auto MB = mapSharedMemory(Name, Size, sys::Memory::MF_READ);
+      if (!MB)
+        return MB.takeError();
+
+      Addr = MB->base();
+      assert(Allocs.find(MB->base()) == Allocs.end() && "Duplicate alloc");
+      Allocs[MB->base()] = std::move(*MB);
+      return Error::success();
+    }
+
+    Error release(void *block) {
+      auto I = Allocs.find(block);
+      if (I == Allocs.end())
+        return errorCodeToError(
+            orcError(OrcErrorCode::RemoteMProtectAddrUnrecognized));
+      auto EC = sys::Memory::releaseMappedMemory(I->second);
+      Allocs.erase(I);
+      return errorCodeToError(EC);
+    }
+
     Error setProtections(void *block, unsigned Flags) {
       auto I = Allocs.find(block);
       if (I == Allocs.end())
@@ -349,6 +373,25 @@ private:
                            IndirectStubSize);
   }
 
+  Expected<JITTargetAddress> handleMapSharedMem(ResourceIdMgr::ResourceId Id,
+                                                std::string Name,
+                                                uint64_t Size) {
+    auto I = Allocators.find(Id);
+    if (I == Allocators.end())
+      return errorCodeToError(
+               orcError(OrcErrorCode::RemoteAllocatorDoesNotExist));
+    auto &Allocator = I->second;
+    void *LocalAllocAddr = nullptr;
+    if (auto Err = Allocator.mapShared(LocalAllocAddr, Name, Size))
+      return std::move(Err);
+
+    LLVM_DEBUG(dbgs() << "  Allocator " << Id << " mapped " << Name << " at "
+                      << LocalAllocAddr << " (" << Size << " bytes)\n");
+
+    return static_cast<JITTargetAddress>(
+        reinterpret_cast<uintptr_t>(LocalAllocAddr));
+  }
+
   Expected<std::vector<uint8_t>> handleReadMem(JITTargetAddress RSrc,
                                                uint64_t Size) {
     uint8_t *Src = reinterpret_cast<uint8_t *>(static_cast<uintptr_t>(RSrc));
@@ -373,6 +416,17 @@ private:
     return Error::success();
   }
 
+  Error handleReleaseMem(ResourceIdMgr::ResourceId Id, JITTargetAddress Addr) {
+    auto I = Allocators.find(Id);
+    if (I == Allocators.end())
+      return errorCodeToError(
+               orcError(OrcErrorCode::RemoteAllocatorDoesNotExist));
+    void *LocalAddr = reinterpret_cast<void *>(static_cast<uintptr_t>(Addr));
+    LLVM_DEBUG(dbgs() << "  Allocator " << Id << " released " << LocalAddr
+                      << "\n");
+    return I->second.release(LocalAddr);
+  }
+
   Expected<JITTargetAddress> handleReserveMem(ResourceIdMgr::ResourceId Id,
                                               uint64_t Size, uint32_t Align) {
     auto I = Allocators.find(Id);
@@ -0,0 +1,57 @@
+//===--- SharedMemory.h - Named shared memory for remote JITing -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Utilities for mapping one named shared memory object into both the JIT
+// process and an executor process, so that linked code can be written through
+// one view and executed through another without being copied.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_SHAREDMEMORY_H
+#define LLVM_EXECUTIONENGINE_ORC_SHAREDMEMORY_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/Memory.h"
+#include <cstdint>
+#include <string>
+
+namespace llvm {
+namespace orc {
+
+/// Returns true if named shared memory is supported on this host.
+bool isSharedMemorySupported();
+
+/// Returns a shared memory object name that is unique within this process
+/// and, because it includes the process ID, across processes on this host.
+std::string getUniqueSharedMemoryName();
+
+/// Create a new shared memory object called Name that is Size bytes long and
+/// map it read/write into this process. Fails if the name is already in use.
+///
+/// The returned block should be released with
+/// sys::Memory::releaseMappedMemory.
+Expected<sys::MemoryBlock> createSharedMemory(StringRef Name, uint64_t Size);
+
+/// Map the first Size bytes of the existing shared memory object called Name
+/// into this process with the protections in Flags. The protections of the
+/// mapping can later be changed with sys::Memory::protectMappedMemory.
+///
+/// The returned block should be released with
+/// sys::Memory::releaseMappedMemory.
+Expected<sys::MemoryBlock> mapSharedMemory(StringRef Name, uint64_t Size,
+                                           unsigned Flags);
+
+/// Remove the name of a shared memory object. Existing mappings remain valid,
+/// and the memory is freed once the last of them is released.
+Error unlinkSharedMemory(StringRef Name);
+
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_SHAREDMEMORY_H
@@ -14,6 +14,7 @@
 #define LLVM_EXECUTIONENGINE_ORC_SYMBOLSTRINGPOOL_H
 
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/StringMap.h"
 #include <atomic>
 #include <mutex>
@@ -24,6 +25,9 @@ namespace orc {
 class SymbolStringPtr;
 
 /// String pool for symbol names used by the JIT.
+///
+/// The pool is split into shards, each with its own lock, so that threads
+/// interning different strings rarely contend.
 class SymbolStringPool {
   friend class SymbolStringPtr;
 public:
@@ -42,8 +46,17 @@ private:
   using RefCountType = std::atomic<size_t>;
   using PoolMap = StringMap<RefCountType>;
   using PoolMapEntry = StringMapEntry<RefCountType>;
-  mutable std::mutex PoolMutex;
-  PoolMap Pool;
+
+  struct Shard {
+    mutable std::mutex PoolMutex;
+    PoolMap Pool;
+  };
+
+  static constexpr size_t NumShards = 16;
+
+  Shard &getShard(StringRef S) { return Shards[hash_value(S) % NumShards]; }
+
+  Shard Shards[NumShards];
 };
 
 /// Pointer to a pooled string representing a symbol name.
@@ -56,15 +69,15 @@ public:
   SymbolStringPtr(const SymbolStringPtr &Other)
     : S(Other.S) {
     if (isRealPoolEntry(S))
-      ++S->getValue();
+      retain(S);
   }
 
   SymbolStringPtr& operator=(const SymbolStringPtr &Other) {
     if (isRealPoolEntry(S))
-      --S->getValue();
+      release(S);
     S = Other.S;
     if (isRealPoolEntry(S))
-      ++S->getValue();
+      retain(S);
     return *this;
   }
 
@@ -74,7 +87,7 @@ public:
 
   SymbolStringPtr& operator=(SymbolStringPtr &&Other) {
     if (isRealPoolEntry(S))
-      --S->getValue();
+      release(S);
     S = nullptr;
     std::swap(S, Other.S);
     return *this;
@@ -82,7 +95,7 @@ public:
 
   ~SymbolStringPtr() {
     if (isRealPoolEntry(S))
-      --S->getValue();
+      release(S);
   }
 
   StringRef operator*() const { return S->first(); }
@@ -108,7 +121,18 @@ private:
   SymbolStringPtr(SymbolStringPool::PoolMapEntry *S)
       : S(S) {
     if (isRealPoolEntry(S))
-      ++S->getValue();
+      retain(S);
+  }
+
+  // Taking a reference needs no ordering, as the caller already holds one
+  // (or the pool lock). Dropping one must be ordered before clearDeadEntries
+  // frees the entry.
+  static void retain(PoolEntryPtr P) {
+    P->getValue().fetch_add(1, std::memory_order_relaxed);
+  }
+
+  static void release(PoolEntryPtr P) {
+    P->getValue().fetch_sub(1, std::memory_order_release);
   }
 
   // Returns false for null, empty, and tombstone values, true otherwise.
@@ -143,30 +167,37 @@ private:
 inline SymbolStringPool::~SymbolStringPool() {
 #ifndef NDEBUG
   clearDeadEntries();
-  assert(Pool.empty() && "Dangling references at pool destruction time");
+  assert(empty() && "Dangling references at pool destruction time");
 #endif // NDEBUG
 }
 
 inline SymbolStringPtr SymbolStringPool::intern(StringRef S) {
-  std::lock_guard<std::mutex> Lock(PoolMutex);
+  auto &Sh = getShard(S);
+  std::lock_guard<std::mutex> Lock(Sh.PoolMutex);
   PoolMap::iterator I;
   bool Added;
-  std::tie(I, Added) = Pool.try_emplace(S, 0);
+  std::tie(I, Added) = Sh.Pool.try_emplace(S, 0);
   return SymbolStringPtr(&*I);
 }
 
 inline void SymbolStringPool::clearDeadEntries() {
-  std::lock_guard<std::mutex> Lock(PoolMutex);
-  for (auto I = Pool.begin(), E = Pool.end(); I != E;) {
-    auto Tmp = I++;
-    if (Tmp->second == 0)
-      Pool.erase(Tmp);
+  for (auto &Sh : Shards) {
+    std::lock_guard<std::mutex> Lock(Sh.PoolMutex);
+    for (auto I = Sh.Pool.begin(), E = Sh.Pool.end(); I != E;) {
+      auto Tmp = I++;
+      if (Tmp->second.load(std::memory_order_acquire) == 0)
+        Sh.Pool.erase(Tmp);
+    }
   }
 }
 
 inline bool SymbolStringPool::empty() const {
-  std::lock_guard<std::mutex> Lock(PoolMutex);
-  return Pool.empty();
+  for (auto &Sh : Shards) {
+    std::lock_guard<std::mutex> Lock(Sh.PoolMutex);
+    if (!Sh.Pool.empty())
+      return false;
+  }
+  return true;
 }
 
 } // end namespace orc
@@ -0,0 +1,202 @@
+//===--- TaskDispatch.h - Dispatching of materialization work ---*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Task dispatchers decide where and when the MaterializationUnits dispatched
+// by an ExecutionSession are run.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_TASKDISPATCH_H
+#define LLVM_EXECUTIONENGINE_ORC_TASKDISPATCH_H
+
+#include "llvm/ADT/FunctionExtras.h"
+#include "llvm/ExecutionEngine/Orc/Core.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace llvm {
+namespace orc {
+
+/// How urgently the symbols of a materialization are needed. Lower values are
+/// more urgent.
+enum class MaterializationPriority : uint8_t {
+  /// A lookup is waiting for the symbols.
+  OnDemand,
+  /// The symbols are compiled ahead of need, e.g. by a Speculator.
+  Speculative
+};
+
+/// Returns the priority given to materializations dispatched by this thread.
+/// This is OnDemand, unless changed by a MaterializationPriorityScope.
+MaterializationPriority getCurrentMaterializationPriority();
+
+/// Sets the priority given to materializations dispatched by this thread for
+/// the lifetime of the scope object.
+class MaterializationPriorityScope {
+public:
+  MaterializationPriorityScope(MaterializationPriority P);
+  MaterializationPriorityScope(const MaterializationPriorityScope &) = delete;
+  MaterializationPriorityScope &
+  operator=(const MaterializationPriorityScope &) = delete;
+  ~MaterializationPriorityScope();
+
+private:
+  MaterializationPriority Prev;
+};
+
+/// A MaterializationUnit that has been dispatched for a JITDylib.
+class MaterializationTask {
+public:
+  using ClockT = std::chrono::steady_clock;
+
+  MaterializationTask(JITDylib &JD, std::unique_ptr<MaterializationUnit> MU,
+                      MaterializationPriority Priority);
+
+  JITDylib &getJITDylib() const { return JD; }
+
+  /// Returns the name of the unit. This stays valid after the task has run.
+  StringRef getName() const { return Name; }
+
+  MaterializationPriority getPriority() const { return Priority; }
+
+  ClockT::time_point getDispatchTime() const { return DispatchTime; }
+
+  /// Materialize the unit. Materializations dispatched while it runs get the
+  /// priority of this task.
+  void run();
+
+  /// Drop the unit without materializing it. See
+  /// MaterializationUnit::doFail.
+  void cancel();
+
+private:
+  JITDylib &JD;
+  std::unique_ptr<MaterializationUnit> MU;
+  std::string Name;
+  MaterializationPriority Priority;
+  ClockT::time_point DispatchTime;
+};
+
+/// Decides where and when materialization tasks are run. See
+/// useTaskDispatcher.
+class TaskDispatcher {
+public:
+  /// Called after each task has run, with the time it waited to be started
+  /// and the time it took to run.
+  using TraceFunction = std::function<void(const MaterializationTask &T,
+                                           std::chrono::nanoseconds QueueTime,
+                                           std::chrono::nanoseconds RunTime)>;
+
+  virtual ~TaskDispatcher();
+
+  /// Take ownership of T and arrange for it to be run.
+  virtual void dispatch(std::unique_ptr<MaterializationTask> T) = 0;
+
+  /// Cancel every task that has not started running, e.g. when shutting
+  /// down. Returns the number of tasks cancelled.
+  virtual size_t cancelPendingTasks() = 0;
+
+  /// Block until every dispatched task has run or been cancelled. Must not
+  /// be called from a task.
+  virtual void wait() = 0;
+
+  /// Set the trace function. This must be done before any tasks are
+  /// dispatched.
+  void setTraceFunction(TraceFunction Trace) { this->Trace = std::move(Trace); }
+
+protected:
+  /// Run T, and report it to the trace function.
+  void runTask(MaterializationTask &T);
+
+private:
+  TraceFunction Trace;
+};
+
+/// Runs each task on the thread that dispatches it.
+class InPlaceTaskDispatcher : public TaskDispatcher {
+public:
+  void dispatch(std::unique_ptr<MaterializationTask> T) override {
+    runTask(*T);
+  }
+  size_t cancelPendingTasks() override { return 0; }
+  void wait() override {}
+};
+
+/// Runs tasks on a fixed set of threads. On-demand tasks are started before
+/// speculative ones, and tasks of the same priority in the order they were
+/// dispatched.
+class PriorityThreadPoolTaskDispatcher : public TaskDispatcher {
+public:
+  PriorityThreadPoolTaskDispatcher(unsigned NumThreads);
+
+  /// Runs the remaining tasks, then stops the threads.
+  ~PriorityThreadPoolTaskDispatcher() override;
+
+  void dispatch(std::unique_ptr<MaterializationTask> T) override;
+  size_t cancelPendingTasks() override;
+  void wait() override;
+
+private:
+  static constexpr unsigned NumPriorities = 2;
+
+  bool hasPendingTasks() const;
+  void work();
+
+  std::mutex QueueMutex;
+  std::condition_variable QueueChanged;
+  std::condition_variable Idle;
+  std::deque<std::unique_ptr<MaterializationTask>> Queues[NumPriorities];
+  unsigned NumRunning = 0;
+  bool Stopping = false;
+  std::vector<std::thread> Threads;
+};
+
+/// Hands each task to an executor owned by the client, e.g. the thread pool
+/// of the application embedding the JIT.
+class ExternalTaskDispatcher : public TaskDispatcher {
+public:
+  /// Run Work on any thread. The executor may use Priority to order work.
+  /// Every work item must eventually be run, and the dispatcher must outlive
+  /// them. Items for cancelled tasks return immediately.
+  using ExecutorFunction = std::function<void(MaterializationPriority Priority,
+                                              unique_function<void()> Work)>;
+
+  ExternalTaskDispatcher(ExecutorFunction Executor)
+      : Executor(std::move(Executor)) {}
+
+  void dispatch(std::unique_ptr<MaterializationTask> T) override;
+  size_t cancelPendingTasks() override;
+  void wait() override;
+
+private:
+  void runPendingTask(uint64_t Id);
+
+  ExecutorFunction Executor;
+  std::mutex PendingMutex;
+  std::condition_variable Idle;
+  std::map<uint64_t, std::unique_ptr<MaterializationTask>> Pending;
+  uint64_t NextId = 0;
+  unsigned NumRunning = 0;
+};
+
+/// Make ES dispatch materialization to D. Each unit becomes a task with the
+/// priority of the thread dispatching it. D must outlive ES, or at least any
+/// further materialization by it.
+void useTaskDispatcher(ExecutionSession &ES, TaskDispatcher &D);
+
+} // End namespace orc
+} // End namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_TASKDISPATCH_H
@@ -0,0 +1,126 @@
+//===-- TieredCompilation.h - Recompile hot functions -----------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Contains the definitions to support tiered compilation: functions are first
+// compiled cheaply, then recompiled by an optimizing layer once they are hot.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_TIEREDCOMPILATION_H
+#define LLVM_EXECUTIONENGINE_ORC_TIEREDCOMPILATION_H
+
+#include "llvm/ExecutionEngine/Orc/Core.h"
+#include "llvm/ExecutionEngine/Orc/Layer.h"
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
+#include "llvm/Support/ThreadPool.h"
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace llvm {
+namespace orc {
+
+/// Recompiles hot functions with an optimizing layer on a background thread
+/// and redirects their stubs to the new bodies.
+///
+/// Functions are registered as candidates by an IRTieringLayer, which keeps
+/// an uninstrumented copy of each one. When instrumented code reports that a
+/// function has become hot, the copy is renamed to <name>.tier1, added to the
+/// optimizing layer in the dylib that held the original body, and the stub
+/// that callers go through is pointed at the result.
+class TieredCompiler {
+public:
+  using FunctionId = uint64_t;
+
+  /// Point the stub for the function Name, whose body is defined in ImplJD,
+  /// at NewAddr. CompileOnDemandLayer::redirectStub can be used here.
+  using RedirectFunction =
+      std::function<Error(JITDylib &ImplJD, const SymbolStringPtr &Name,
+                          JITTargetAddress NewAddr)>;
+
+  TieredCompiler(ExecutionSession &ES, IRLayer &OptimizeLayer,
+                 MangleAndInterner &Mangle, RedirectFunction Redirect,
+                 unsigned NumRecompileThreads = 1);
+  TieredCompiler(const TieredCompiler &) = delete;
+  TieredCompiler(TieredCompiler &&) = delete;
+  TieredCompiler &operator=(const TieredCompiler &) = delete;
+  TieredCompiler &operator=(TieredCompiler &&) = delete;
+
+  /// Waits for any recompilations that are still running.
+  ~TieredCompiler();
+
+  /// Define symbols for this TieredCompiler object (__orc_tiering_manager)
+  /// and the tier-up runtime entry point symbol (__orc_tier_up) in the given
+  /// JITDylib.
+  Error addTieringRuntime(JITDylib &JD);
+
+  /// Register the function Name, defined in ImplJD, for recompilation. TSM
+  /// must contain an uninstrumented definition of the function.
+  FunctionId addCandidate(JITDylib &ImplJD, StringRef Name,
+                          ThreadSafeModule TSM);
+
+  /// Queue the recompilation of the given candidate. Called by instrumented
+  /// code the first time the function is found to be hot.
+  void tierUp(FunctionId Id);
+
+  /// Block until all queued recompilations have finished.
+  void waitForRecompiles() { RecompileThreads.wait(); }
+
+  ExecutionSession &getES() { return ES; }
+
+private:
+  struct Candidate {
+    JITDylib *ImplJD;
+    std::string Name;
+    ThreadSafeModule TSM;
+  };
+
+  static void tierUpEntryPoint(TieredCompiler *Ptr, uint64_t Id);
+  void recompile(JITDylib &ImplJD, StringRef Name, ThreadSafeModule TSM);
+
+  std::mutex TieringMutex;
+  ExecutionSession &ES;
+  IRLayer &OptimizeLayer;
+  MangleAndInterner &Mangle;
+  RedirectFunction Redirect;
+  std::vector<Candidate> Candidates;
+  ThreadPool RecompileThreads;
+};
+
+/// Instruments each function with a call counter before passing the module
+/// on to the base layer, which should compile quickly (e.g. at -O0). The
+/// HotCallCount'th call of a function asks the TieredCompiler to recompile
+/// it.
+///
+/// Callers must reach the functions through stubs, and the functions must
+/// refer to other globals by external names, as they do in the partitions
+/// that CompileOnDemandLayer emits. Functions with local linkage are not
+/// instrumented.
+class IRTieringLayer : public IRLayer {
+public:
+  IRTieringLayer(ExecutionSession &ES, IRLayer &BaseLayer,
+                 TieredCompiler &Tiers, uint64_t HotCallCount)
+      : IRLayer(ES), BaseLayer(BaseLayer), Tiers(Tiers),
+        HotCallCount(HotCallCount) {
+    assert(HotCallCount > 0 && "Functions can not be hot before any calls");
+  }
+
+  void emit(MaterializationResponsibility R, ThreadSafeModule TSM) override;
+
+private:
+  IRLayer &BaseLayer;
+  TieredCompiler &Tiers;
+  uint64_t HotCallCount;
+};
+
+} // namespace orc
+} // namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_TIEREDCOMPILATION_H
@@ -124,6 +124,27 @@ public:
   /// Remove the GC for a function
   void deleteGC(const Function &Fn);
 
+  /// Charge \p Work units of work to the compile-time budget of \p Fn, where
+  /// a unit is roughly the cost of visiting one instruction. Return false if
+  /// \p Fn or this context has used up its budget; expensive optimizations
+  /// should then skip optional work on \p Fn. Budgets are unlimited unless
+  /// set by setCompileTimeBudget() or by the -function-compile-time-budget
+  /// and -compile-time-budget options.
+  bool consumeCompileTimeBudget(const Function &Fn, uint64_t Work);
+
+  /// Return true if neither \p Fn nor this context has used up its budget.
+  bool hasCompileTimeBudget(const Function &Fn) const;
+
+  /// Return the work charged to a function so far
+  uint64_t getCompileTimeUsed(const Function &Fn) const;
+
+  /// Set the budget for each function and for all functions of this context
+  /// together. Zero means unlimited.
+  void setCompileTimeBudget(uint64_t PerFunction, uint64_t Total);
+
+  /// Remove the work charged to a function
+  void deleteCompileTimeUsed(const Function &Fn);
+
   /// Return true if the Context runtime configuration is set to discard all
   /// value names. When true, only GlobalValue names will be available in the
   /// IR.
@@ -134,6 +155,24 @@ public:
   /// especially in release mode.
   void setDiscardValueNames(bool Discard);
 
+  /// Whether the tables that unique types, constants, attributes and metadata
+  /// are protected by locks, so that several threads can create these
+  /// objects in this context at the same time. Off by default, because
+  /// locking slows down single-threaded clients.
+  ///
+  /// This covers uniquing only. Use lists, value names, value handles and
+  /// metadata attachments are still not synchronized, so threads must not
+  /// update IR that other threads can reach, including the use lists of
+  /// shared constants and globals.
+  bool isThreadSafeUniquing() const;
+  void setThreadSafeUniquing(bool Enable);
+
+  /// Return the number of bytes that the bump-pointer allocators of this
+  /// context have obtained from the system, for example for metadata and
+  /// uniqued strings. Instructions, constants and other values are allocated
+  /// with operator new and are not included.
+  size_t getAllocatorMemory() const;
+
   /// Whether there is a string map for uniquing debug info
   /// identifiers across the context.  Off by default.
   bool isODRUniquingDebugTypes() const;
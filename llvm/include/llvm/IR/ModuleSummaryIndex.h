@@ -749,7 +749,8 @@ using VTableFuncList = std::vector<VirtFuncOffset>;
 class GlobalVarSummary : public GlobalValueSummary {
 private:
   /// For vtable definitions this holds the list of functions and
-  /// their corresponding offsets within the initializer array.
+  /// their corresponding offsets within the initializer array, sorted by
+  /// offset so that the functions in a slot can be found by binary search.
   std::unique_ptr<VTableFuncList> VTableFuncs;
 
 public:
@@ -782,6 +783,12 @@ public:
 
   void setVTableFuncs(VTableFuncList Funcs) {
     assert(!VTableFuncs);
+    auto ByOffset = [](const VirtFuncOffset &A, const VirtFuncOffset &B) {
+      return A.VTableOffset < B.VTableOffset;
+    };
+    // Functions are found in initializer order, which is usually sorted.
+    if (!std::is_sorted(Funcs.begin(), Funcs.end(), ByOffset))
+      llvm::stable_sort(Funcs, ByOffset);
     VTableFuncs = std::make_unique<VTableFuncList>(std::move(Funcs));
   }
 
@@ -790,6 +797,19 @@ public:
       return *VTableFuncs;
     return {};
   }
+
+  /// Return the functions at \p Offset in the vtable.
+  ArrayRef<VirtFuncOffset> vTableFuncsAt(uint64_t Offset) const {
+    ArrayRef<VirtFuncOffset> Funcs = vTableFuncs();
+    auto Lower = llvm::lower_bound(Funcs, Offset,
+                                   [](const VirtFuncOffset &F, uint64_t Off) {
+                                     return F.VTableOffset < Off;
+                                   });
+    auto Upper = Lower;
+    while (Upper != Funcs.end() && Upper->VTableOffset == Offset)
+      ++Upper;
+    return makeArrayRef(Lower, Upper);
+  }
 };
 
 struct TypeTestResolution {
@@ -38,6 +38,7 @@
 #define LLVM_IR_PASSMANAGER_H
 
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/TinyPtrVector.h"
@@ -438,6 +439,14 @@ getAnalysisResult(AnalysisManager<IRUnitT, AnalysisArgTs...> &AM, IRUnitT &IR,
                            std::index_sequence_for<AnalysisArgTs...>{});
 }
 
+/// Returns a fingerprint of \p IR that changes whenever a pass changes \p IR,
+/// if -preserve-analyses-on-unchanged-ir is given. Only functions have
+/// fingerprints.
+template <typename IRUnitT> Optional<uint64_t> getIRFingerprint(IRUnitT &IR) {
+  return None;
+}
+Optional<uint64_t> getIRFingerprint(Function &F);
+
 } // namespace detail
 
 // Forward declare the pass instrumentation analysis explicitly queried in
@@ -500,6 +509,9 @@ public:
     if (DebugLogging)
       dbgs() << "Starting " << getTypeName<IRUnitT>() << " pass manager run.\n";
 
+    // The fingerprint of IR before the next pass, if fingerprints are enabled.
+    Optional<uint64_t> Fingerprint;
+
     for (unsigned Idx = 0, Size = Passes.size(); Idx != Size; ++Idx) {
       auto *P = Passes[Idx].get();
       if (DebugLogging)
@@ -512,12 +524,28 @@ public:
       if (!PI.runBeforePass<IRUnitT>(*P, IR))
         continue;
 
+      if (!Fingerprint)
+        Fingerprint = detail::getIRFingerprint(IR);
+
       PreservedAnalyses PassPA = P->run(IR, AM, ExtraArgs...);
 
       // Call onto PassInstrumentation's AfterPass callbacks immediately after
       // running the pass.
       PI.runAfterPass<IRUnitT>(*P, IR);
 
+      // A pass may report a change without making one. If the IR is the same
+      // as before, every analysis result is still valid.
+      if (Fingerprint && !PassPA.areAllPreserved()) {
+        Optional<uint64_t> NewFingerprint = detail::getIRFingerprint(IR);
+        if (NewFingerprint == Fingerprint) {
+          if (DebugLogging)
+            dbgs() << "Pass " << P->name() << " left " << IR.getName()
+                   << " unchanged, preserving all analyses\n";
+          PassPA = PreservedAnalyses::all();
+        }
+        Fingerprint = NewFingerprint;
+      }
+
       // Update the analysis manager as each pass runs and potentially
       // invalidates analyses.
       AM.invalidate(IR, PassPA);
@@ -1278,6 +1306,13 @@ using ModuleAnalysisManagerFunctionProxy =
 /// Note that although function passes can access module analyses, module
 /// analyses are not invalidated while the function passes are running, so they
 /// may be stale.  Function analyses will not be stale.
+///
+/// FIXME: Functions are visited one at a time. Even for passes that follow the
+/// rules above, visiting several functions concurrently is not safe yet: all
+/// functions share one LLVMContext, whose constant, type and metadata uniquing
+/// tables are not synchronized, and the use lists of globals and constants are
+/// updated without locking. Until that changes, parallelism has to come from
+/// separate contexts, e.g. ThinLTO backends or llvm::splitCodeGen().
 template <typename FunctionPassT>
 class ModuleToFunctionPassAdaptor
     : public PassInfoMixin<ModuleToFunctionPassAdaptor<FunctionPassT>> {
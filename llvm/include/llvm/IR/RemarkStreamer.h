@@ -51,6 +51,10 @@ public:
   /// Set a pass filter based on a regex \p Filter.
   /// Returns an error if the regex is invalid.
   Error setFilter(StringRef Filter);
+  /// Return true if the remarks of the pass \p PassName make it through the
+  /// pass filter. This can be used to avoid building remarks that would be
+  /// dropped.
+  bool matchesFilter(StringRef PassName) const;
   /// Emit a diagnostic through the streamer.
   void emit(const DiagnosticInfoOptimizationBase &Diag);
 };
@@ -0,0 +1,36 @@
+//===- llvm/IR/StructuralHash.h - Hash of a function's IR -------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file provides hashing of the LLVM IR structure of a function, to detect
+// whether a pass has changed it.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_IR_STRUCTURALHASH_H
+#define LLVM_IR_STRUCTURALHASH_H
+
+#include <cstdint>
+
+namespace llvm {
+
+class Function;
+
+/// Returns a hash of everything about \p F that an analysis can depend on:
+/// its basic blocks and instructions, their operands and operation-specific
+/// state, their metadata attachments, and the attributes of \p F and its
+/// calls.
+///
+/// Values are identified by their addresses rather than by their position in
+/// \p F. If the hash does not change across a transformation, the function
+/// still consists of the same objects in the same configuration, so analysis
+/// results that point into it remain valid.
+uint64_t StructuralHash(const Function &F);
+
+} // end namespace llvm
+
+#endif
@@ -33,6 +33,36 @@ using AddBufferFn =
 Expected<NativeObjectCache> localCache(StringRef CacheDirectoryPath,
                                        AddBufferFn AddBuffer);
 
+/// A store of native objects shared between links, for example on a server
+/// or a network file system, addressed by the keys of computeLTOCacheKey.
+/// Its methods may be called from several threads at the same time.
+class CacheStore {
+public:
+  virtual ~CacheStore();
+
+  /// Return the object stored under \p Key, or nullptr if there is none.
+  virtual Expected<std::unique_ptr<MemoryBuffer>> get(StringRef Key) = 0;
+
+  /// Store \p Object under \p Key.
+  virtual Error put(StringRef Key, MemoryBufferRef Object) = 0;
+};
+
+/// Create a store in the directory \p DirectoryPath, which may be shared
+/// between machines. Its entries are named like those of localCache(), so
+/// the directory can be pruned with pruneCache(). This function also creates
+/// the directory if it does not already exist.
+Expected<std::shared_ptr<CacheStore>>
+createDirectoryCacheStore(StringRef DirectoryPath);
+
+/// Create a cache that looks objects up in the local cache in
+/// \p CacheDirectoryPath first, then in \p Store. Objects found in the store
+/// are added to the local cache, and objects built by the link are added to
+/// both. Errors from the store are reported as warnings and otherwise treated
+/// as cache misses, so that an unavailable store does not fail the link.
+Expected<NativeObjectCache> sharedCache(StringRef CacheDirectoryPath,
+                                        std::shared_ptr<CacheStore> Store,
+                                        AddBufferFn AddBuffer);
+
 } // namespace lto
 } // namespace llvm
 
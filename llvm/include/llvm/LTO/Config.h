@@ -117,6 +117,16 @@ struct Config {
   /// Statistics output file path.
   std::string StatsFile;
 
+  /// Print the peak resident memory and the heap usage of the process after
+  /// each stage of LTO: adding the input modules, the regular LTO module, the
+  /// thin link and each ThinLTO backend.
+  bool PrintMemoryUsage = false;
+
+  /// If nonzero, the in-process ThinLTO backend does not start a job while
+  /// the heap usage of the process is above this many bytes, unless no other
+  /// job is running.
+  size_t ThinLTOMemoryBudget = 0;
+
   bool ShouldDiscardValueNames = true;
   DiagnosticHandlerFunction DiagHandler;
 
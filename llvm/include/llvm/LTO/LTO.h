@@ -25,6 +25,7 @@
 #include "llvm/Linker/IRMover.h"
 #include "llvm/Object/IRSymtab.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/thread.h"
 #include "llvm/Target/TargetOptions.h"
@@ -35,6 +36,7 @@ namespace llvm {
 class BitcodeModule;
 class Error;
 class LLVMContext;
+class MemoryBuffer;
 class MemoryBufferRef;
 class Module;
 class Target;
@@ -229,6 +231,10 @@ using ThinBackend = std::function<std::unique_ptr<ThinBackendProc>(
 /// This ThinBackend runs the individual backend jobs in-process.
 ThinBackend createInProcessThinBackend(unsigned ParallelismLevel);
 
+/// This ThinBackend runs the individual backend jobs in-process, on threads
+/// created according to \p Parallelism.
+ThinBackend createInProcessThinBackend(ThreadPoolStrategy Parallelism);
+
 /// This ThinBackend writes individual module indexes to files, instead of
 /// running the individual backend jobs. This backend is for distributed builds
 /// where separate processes will invoke the real backends.
@@ -249,6 +255,54 @@ ThinBackend createWriteIndexesThinBackend(std::string OldPrefix,
                                           raw_fd_ostream *LinkedObjectsFile,
                                           IndexWriteCallback OnWrite);
 
+/// A ThinLTO backend job for a worker outside of the linker process.
+struct RemoteBackendJob {
+  /// The task of the job, as passed to AddStream.
+  unsigned Task;
+
+  /// The identifier of the module, as it appears in the combined index.
+  std::string ModuleID;
+
+  /// The bitcode of the module.
+  StringRef ModuleBitcode;
+
+  /// The index slice with the summaries that the backend of the module needs,
+  /// as written for -thinlto-index by the distributed backend.
+  std::string IndexSlice;
+
+  /// The identifiers of the modules that the module imports from.
+  std::vector<std::string> ImportedModules;
+
+  /// The estimated cost of the job: the number of instructions in the
+  /// functions of the module and in the functions it imports.
+  uint64_t Cost;
+};
+
+/// A function that runs \p Job on a worker and returns its native object.
+/// It may be called concurrently from several threads.
+using RemoteBackendExecutor =
+    std::function<Expected<std::unique_ptr<MemoryBuffer>>(
+        const RemoteBackendJob &Job)>;
+
+/// This ThinBackend ships the individual backend jobs to workers through
+/// \p Executor, instead of running them in-process. Up to \p MaxJobs jobs run
+/// at the same time, or one per hardware thread if it is 0, and jobs start in decreasing order of their estimated
+/// cost, so that the slowest ones do not start last. As with the in-process
+/// backend, native objects found in the cache are not rebuilt, and the
+/// objects built by the workers are added to the cache.
+ThinBackend createRemoteThinBackend(RemoteBackendExecutor Executor,
+                                    unsigned MaxJobs);
+
+/// Return an executor that runs each job with the command \p Program
+/// \p Args, followed by the paths of three files: the module bitcode, its
+/// index slice and the native object that the command must write. The
+/// command may compile the module itself, as with
+/// "clang -c -x ir <module> -fthinlto-index=<index> -o <object>", or send the
+/// files to a remote machine; it must exit with status 0 on success.
+RemoteBackendExecutor
+createCommandRemoteBackendExecutor(std::string Program,
+                                   std::vector<std::string> Args);
+
 /// This class implements a resolution-based interface to LLVM's LTO
 /// functionality. It supports regular LTO, parallel LTO code generation and
 /// ThinLTO. You can use it from a linker in the following way:
@@ -154,6 +154,16 @@ private:
 
   VersionInfoType VersionInfo;
 
+  /// The number of section relaxations in the current layout.
+  unsigned NumSectionRelaxations = 0;
+
+  /// For each section by ordinal, the value of NumSectionRelaxations when the
+  /// layout last found none of its fragments to need relaxation. A section is
+  /// only revisited once the fragments of some section have changed since.
+  std::vector<unsigned> SectionStableAt;
+  static const unsigned NeverRelaxes = ~0U;
+  static const unsigned NotYetLaidOut = ~0U - 1;
+
   /// Evaluate a fixup to a relocatable expression and the value which should be
   /// placed into the fixup.
   ///
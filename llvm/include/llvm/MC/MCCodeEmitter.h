@@ -35,6 +35,12 @@ public:
   virtual void encodeInstruction(const MCInst &Inst, raw_ostream &OS,
                                  SmallVectorImpl<MCFixup> &Fixups,
                                  const MCSubtargetInfo &STI) const = 0;
+
+  /// Return true if encodeInstruction can write to the end of a stream that
+  /// already holds other bytes, so that object streamers can encode directly
+  /// into their fragments: the offsets of the fixups must be relative to the
+  /// start of the instruction, and not use the position of the stream.
+  virtual bool canEncodeInPlace() const { return false; }
 };
 
 } // end namespace llvm
@@ -111,6 +111,17 @@ public:
   /// Return true if given frgment has FT_Dummy type.
   bool isDummy() const { return Kind == FT_Dummy; }
 
+  /// Return the bytes of memory used by this fragment, including the storage
+  /// of its contents and fixups outside of the fragment.
+  size_t getMemorySize() const;
+
+  /// Return the bytes of the storage of the contents and fixups of this
+  /// fragment that are allocated outside of the fragment.
+  size_t getOutOfLineMemorySize() const;
+
+  /// Return the name of the fragment class of \p Kind.
+  static StringRef getKindName(FragmentType Kind);
+
   void dump() const;
 };
 
@@ -240,10 +251,12 @@ public:
 
 /// Fragment for data and encoded instructions.
 ///
-class MCDataFragment : public MCEncodedFragmentWithFixups<32, 4> {
+/// Only one fixup is kept inline: with one section per function or object,
+/// data fragments are numerous, and many of them have no fixups at all.
+class MCDataFragment : public MCEncodedFragmentWithFixups<32, 1> {
 public:
   MCDataFragment(MCSection *Sec = nullptr)
-      : MCEncodedFragmentWithFixups<32, 4>(FT_Data, false, Sec) {}
+      : MCEncodedFragmentWithFixups<32, 1>(FT_Data, false, Sec) {}
 
   static bool classof(const MCFragment *F) {
     return F->getKind() == MCFragment::FT_Data;
@@ -89,6 +89,13 @@ public:
 protected:
   bool changeSectionImpl(MCSection *Section, const MCExpr *Subsection);
 
+  /// Encode \p Inst at the end of \p Contents, and append its fixups to
+  /// \p Fixups with offsets relative to the start of \p Contents. The
+  /// instruction is encoded in place if the code emitter supports it.
+  void encodeInstruction(const MCInst &Inst, const MCSubtargetInfo &STI,
+                         SmallVectorImpl<char> &Contents,
+                         SmallVectorImpl<MCFixup> &Fixups);
+
   /// If any labels have been emitted but not assigned fragments, ensure that
   /// they get assigned, either to F if possible or to a new data fragment.
   /// Optionally, it is also possible to provide an offset \p FOffset, which
@@ -13,6 +13,7 @@
 #ifndef LLVM_OBJECT_ARCHIVEWRITER_H
 #define LLVM_OBJECT_ARCHIVEWRITER_H
 
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Object/Archive.h"
 #include "llvm/Support/Error.h"
@@ -25,6 +26,10 @@ struct NewArchiveMember {
   StringRef MemberName;
   sys::TimePoint<std::chrono::seconds> ModTime;
   unsigned UID = 0, GID = 0, Perms = 0644;
+  /// The names of the archive symbols of the member, when they are already
+  /// known, e.g. from the symbol table of the archive it is taken from. The
+  /// member is then not parsed again when writing the symbol table.
+  Optional<std::vector<StringRef>> Symbols;
 
   NewArchiveMember() = default;
   NewArchiveMember(MemoryBufferRef BufRef);
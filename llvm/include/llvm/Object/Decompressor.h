@@ -58,6 +58,9 @@ private:
 
   StringRef SectionData;
   uint64_t DecompressedSize;
+  /// The section is compressed with zstd rather than zlib. The GNU style is
+  /// always zlib.
+  bool IsZstd = false;
 };
 
 } // end namespace object
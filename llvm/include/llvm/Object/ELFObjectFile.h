@@ -14,8 +14,10 @@
 #define LLVM_OBJECT_ELFOBJECTFILE_H
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/ADT/iterator_range.h"
@@ -36,6 +38,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include <cassert>
 #include <cstdint>
+#include <memory>
 #include <system_error>
 
 namespace llvm {
@@ -238,6 +241,8 @@ public:
   using Elf_Rel = typename ELFT::Rel;
   using Elf_Rela = typename ELFT::Rela;
   using Elf_Dyn = typename ELFT::Dyn;
+  using Elf_Shdr_Range = typename ELFT::ShdrRange;
+  using Elf_Sym_Range = typename ELFT::SymRange;
 
   SectionRef toSectionRef(const Elf_Shdr *Sec) const {
     return SectionRef(toDRI(Sec), this);
@@ -255,6 +260,30 @@ protected:
   const Elf_Shdr *DotSymtabSec = nullptr; // Symbol table section.
   ArrayRef<Elf_Word> ShndxTable;
 
+  // The section header table and the symbol tables, validated once when the
+  // object is created rather than on each access. A symbol table that fails
+  // validation is left empty, so that accesses to it take the slow path and
+  // report why.
+  struct SymbolTableView {
+    uint32_t Index = 0;
+    Elf_Sym_Range Symbols;
+    StringRef StrTab;
+  };
+  Elf_Shdr_Range Sections;
+  SymbolTableView DotSymtab;
+  SymbolTableView DotDynSym;
+
+  // Maps names to symbols, built by the first call to findSymbol.
+  mutable std::unique_ptr<StringMap<DataRefImpl>> SymbolsByName;
+
+  SymbolTableView getSymbolTableView(const Elf_Shdr *SymTab) const;
+  const SymbolTableView *getSymbolTableView(DataRefImpl Sym) const {
+    for (const SymbolTableView *View : {&DotSymtab, &DotDynSym})
+      if (Sym.d.a == View->Index && Sym.d.b < View->Symbols.size())
+        return View;
+    return nullptr;
+  }
+
   void moveSymbolNext(DataRefImpl &Symb) const override;
   Expected<StringRef> getSymbolName(DataRefImpl Symb) const override;
   Expected<uint64_t> getSymbolAddress(DataRefImpl Symb) const override;
@@ -320,13 +349,12 @@ protected:
     assert(SymTable->sh_type == ELF::SHT_SYMTAB ||
            SymTable->sh_type == ELF::SHT_DYNSYM);
 
-    auto SectionsOrErr = EF.sections();
-    if (!SectionsOrErr) {
+    if (Sections.empty()) {
       DRI.d.a = 0;
       DRI.d.b = 0;
       return DRI;
     }
-    uintptr_t SHT = reinterpret_cast<uintptr_t>((*SectionsOrErr).begin());
+    uintptr_t SHT = reinterpret_cast<uintptr_t>(Sections.begin());
     unsigned SymTableIndex =
         (reinterpret_cast<uintptr_t>(SymTable) - SHT) / sizeof(Elf_Shdr);
 
@@ -399,6 +427,8 @@ public:
   const Elf_Rela *getRela(DataRefImpl Rela) const;
 
   const Elf_Sym *getSymbol(DataRefImpl Sym) const {
+    if (const SymbolTableView *View = getSymbolTableView(Sym))
+      return &View->Symbols[Sym.d.b];
     auto Ret = EF.template getEntry<Elf_Sym>(Sym.d.a, Sym.d.b);
     if (!Ret)
       report_fatal_error(errorToErrorCode(Ret.takeError()).message());
@@ -437,6 +467,13 @@ public:
 
   elf_symbol_iterator_range getDynamicSymbolIterators() const override;
 
+  /// Returns the symbol named \p Name, looking in the symbol table and then
+  /// in the dynamic symbol table. When several symbols have that name, a
+  /// defined one is preferred over an undefined one, and a global one over a
+  /// local one. The first call builds an index of all the symbols, so that
+  /// lookups take constant time; it is not thread safe.
+  Expected<Optional<ELFSymbolRef>> findSymbol(StringRef Name) const;
+
   bool isRelocatableObject() const override;
 };
 
@@ -453,6 +490,13 @@ void ELFObjectFile<ELFT>::moveSymbolNext(DataRefImpl &Sym) const {
 template <class ELFT>
 Expected<StringRef> ELFObjectFile<ELFT>::getSymbolName(DataRefImpl Sym) const {
   const Elf_Sym *ESym = getSymbol(Sym);
+  if (const SymbolTableView *View = getSymbolTableView(Sym)) {
+    if (ESym->st_name < View->StrTab.size()) {
+      StringRef Name(View->StrTab.data() + ESym->st_name);
+      if (!Name.empty() || ESym->getType() != ELF::STT_SECTION)
+        return Name;
+    }
+  }
   auto SymTabOrErr = EF.getSection(Sym.d.a);
   if (!SymTabOrErr)
     return SymTabOrErr.takeError();
@@ -989,12 +1033,90 @@ ELFObjectFile<ELFT>::ELFObjectFile(MemoryBufferRef Object, ELFFile<ELFT> EF,
           getELFType(ELFT::TargetEndianness == support::little, ELFT::Is64Bits),
           Object),
       EF(EF), DotDynSymSec(DotDynSymSec), DotSymtabSec(DotSymtabSec),
-      ShndxTable(ShndxTable) {}
+      ShndxTable(ShndxTable) {
+  // create() has validated the section header table already.
+  if (auto SectionsOrErr = this->EF.sections())
+    Sections = *SectionsOrErr;
+  else
+    consumeError(SectionsOrErr.takeError());
+  DotSymtab = getSymbolTableView(DotSymtabSec);
+  DotDynSym = getSymbolTableView(DotDynSymSec);
+}
 
 template <class ELFT>
 ELFObjectFile<ELFT>::ELFObjectFile(ELFObjectFile<ELFT> &&Other)
     : ELFObjectFile(Other.Data, Other.EF, Other.DotDynSymSec,
-                    Other.DotSymtabSec, Other.ShndxTable) {}
+                    Other.DotSymtabSec, Other.ShndxTable) {
+  SymbolsByName = std::move(Other.SymbolsByName);
+}
+
+template <class ELFT>
+typename ELFObjectFile<ELFT>::SymbolTableView
+ELFObjectFile<ELFT>::getSymbolTableView(const Elf_Shdr *SymTab) const {
+  SymbolTableView View;
+  if (!SymTab || Sections.empty())
+    return View;
+  auto SymbolsOrErr = EF.symbols(SymTab);
+  auto StrTabOrErr = EF.getStringTableForSymtab(*SymTab, Sections);
+  if (!SymbolsOrErr || !StrTabOrErr) {
+    consumeError(SymbolsOrErr.takeError());
+    consumeError(StrTabOrErr.takeError());
+    return View;
+  }
+  View.Index = SymTab - Sections.begin();
+  View.Symbols = *SymbolsOrErr;
+  View.StrTab = *StrTabOrErr;
+  return View;
+}
+
+template <class ELFT>
+Expected<Optional<ELFSymbolRef>>
+ELFObjectFile<ELFT>::findSymbol(StringRef Name) const {
+  if (!SymbolsByName) {
+    auto Index = std::make_unique<StringMap<DataRefImpl>>();
+    // Whether symbol A is a better match for its name than symbol B.
+    auto IsBetter = [](const Elf_Sym &A, const Elf_Sym &B) {
+      if (A.isDefined() != B.isDefined())
+        return A.isDefined();
+      return A.getBinding() != ELF::STB_LOCAL &&
+             B.getBinding() == ELF::STB_LOCAL;
+    };
+    for (const Elf_Shdr *SymTab : {DotSymtabSec, DotDynSymSec}) {
+      if (!SymTab)
+        continue;
+      auto SymbolsOrErr = EF.symbols(SymTab);
+      if (!SymbolsOrErr)
+        return SymbolsOrErr.takeError();
+      auto StrTabOrErr = EF.getStringTableForSymtab(*SymTab, Sections);
+      if (!StrTabOrErr)
+        return StrTabOrErr.takeError();
+      // The first symbol is the null symbol.
+      for (size_t I = 1, E = SymbolsOrErr->size(); I < E; ++I) {
+        const Elf_Sym &ESym = (*SymbolsOrErr)[I];
+        // Section symbols are named after their section; look those up as
+        // sections.
+        if (ESym.getType() == ELF::STT_SECTION)
+          continue;
+        Expected<StringRef> SymName = ESym.getName(*StrTabOrErr);
+        if (!SymName)
+          return SymName.takeError();
+        if (SymName->empty())
+          continue;
+        DataRefImpl Sym = toDRI(SymTab, I);
+        auto Inserted = Index->try_emplace(*SymName, Sym);
+        if (!Inserted.second &&
+            IsBetter(ESym, *getSymbol(Inserted.first->second)))
+          Inserted.first->second = Sym;
+      }
+    }
+    SymbolsByName = std::move(Index);
+  }
+
+  auto It = SymbolsByName->find(Name);
+  if (It == SymbolsByName->end())
+    return None;
+  return ELFSymbolRef(SymbolRef(It->second, this));
+}
 
 template <class ELFT>
 basic_symbol_iterator ELFObjectFile<ELFT>::symbol_begin() const {
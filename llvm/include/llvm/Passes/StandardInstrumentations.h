@@ -15,16 +15,21 @@
 #ifndef LLVM_PASSES_STANDARDINSTRUMENTATIONS_H
 #define LLVM_PASSES_STANDARDINSTRUMENTATIONS_H
 
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/IR/PassInstrumentation.h"
 #include "llvm/IR/PassTimingInfo.h"
 
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace llvm {
 
+class LLVMContext;
 class Module;
+class raw_ostream;
 
 /// Instrumentation to print IR before/after passes.
 ///
@@ -53,11 +58,79 @@ private:
   bool StoreModuleDesc = false;
 };
 
+/// Instrumentation to report how much each pass changes the size of the IR
+/// and the memory in use, for -pass-memory-report=<file>.
+///
+/// For every run of a pass, this records the change in the number of
+/// instructions of the IR unit that the pass ran on, in the memory that the
+/// LLVMContext has allocated (see LLVMContext::getAllocatorMemory), and in
+/// the memory in use by malloc. The report is a JSON array with one object
+/// per pass, in the order the passes first ran, that sums these changes over
+/// all runs of the pass. Pass managers and adaptors are not reported, since
+/// the passes that they run are.
+class PassMemoryInstrumentation {
+public:
+  /// Enabled if -pass-memory-report is given.
+  PassMemoryInstrumentation();
+
+  /// Destructor handles the print action if it has not been handled before.
+  ~PassMemoryInstrumentation() { print(); }
+
+  PassMemoryInstrumentation(const PassMemoryInstrumentation &) = delete;
+  void operator=(const PassMemoryInstrumentation &) = delete;
+
+  void registerCallbacks(PassInstrumentationCallbacks &PIC);
+
+  /// Set a custom output stream for subsequent reporting. This also enables
+  /// the instrumentation.
+  void setOutStream(raw_ostream &OS);
+
+  /// Prints the report, if any pass has run, and then clears it.
+  void print();
+
+private:
+  struct Sample {
+    StringRef PassID;
+    const LLVMContext *Context;
+    int64_t Instructions;
+    int64_t ContextBytes;
+    int64_t MallocBytes;
+  };
+
+  struct PassTotals {
+    std::string PassID;
+    unsigned Runs = 0;
+    int64_t Instructions = 0;
+    int64_t MaxInstructions = 0;
+    int64_t ContextBytes = 0;
+    int64_t MallocBytes = 0;
+  };
+
+  void runBeforePass(StringRef PassID, Any IR);
+  void runAfterPass(StringRef PassID, Any IR);
+  void runAfterPassInvalidated(StringRef PassID);
+  Optional<Sample> popSample(StringRef PassID);
+  void record(const Sample &Before, Optional<int64_t> Instructions);
+
+  /// Samples taken before the passes that are currently running.
+  SmallVector<Sample, 4> Stack;
+
+  std::vector<PassTotals> Totals;
+  StringMap<unsigned> TotalsIndex;
+
+  /// Custom output stream to print the report into. By default (== nullptr)
+  /// the report is written to the file named by -pass-memory-report.
+  raw_ostream *OutStream = nullptr;
+
+  bool Enabled;
+};
+
 /// This class provides an interface to register all the standard pass
 /// instrumentations and manages their state (if any).
 class StandardInstrumentations {
   PrintIRInstrumentation PrintIR;
   TimePassesHandler TimePasses;
+  PassMemoryInstrumentation PassMemory;
 
 public:
   StandardInstrumentations() = default;
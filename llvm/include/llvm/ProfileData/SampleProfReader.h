@@ -527,6 +527,16 @@ private:
   virtual std::error_code readOneSection(const uint8_t *Start, uint64_t Size,
                                          SecType Type) override;
   std::error_code readProfileSymbolList(uint64_t Size);
+  std::error_code readFuncOffsetTable();
+  std::error_code readFuncProfiles(const uint8_t *Start, uint64_t Size);
+
+  /// The table mapping from function name to the offset of its FunctionSample
+  /// towards the start of the SecLBRProfile section.
+  DenseMap<StringRef, uint64_t> FuncOffsetTable;
+  /// The set containing the functions to use when compiling a module.
+  DenseSet<StringRef> FuncsToUse;
+  /// Use all functions from the input profile.
+  bool UseAllFuncs = true;
 
 public:
   SampleProfileReaderExtBinary(std::unique_ptr<MemoryBuffer> B, LLVMContext &C,
@@ -539,6 +549,10 @@ public:
   virtual std::unique_ptr<ProfileSymbolList> getProfileSymbolList() override {
     return std::move(ProfSymList);
   };
+
+  /// Collect functions to be used when compiling Module \p M. Only their
+  /// profiles are read when the profile has a function offset table.
+  void collectFuncsToUse(const Module &M) override;
 };
 
 class SampleProfileReaderCompactBinary : public SampleProfileReaderBinary {
@@ -196,20 +196,33 @@ public:
     initSectionLayout();
   }
 
+  virtual std::error_code writeSample(const FunctionSamples &S) override;
+
   virtual void setProfileSymbolList(ProfileSymbolList *PSL) override {
     ProfSymList = PSL;
   };
 
 private:
+  // The function offset table is laid out before the function profiles so
+  // that the reader knows which profiles to skip when it reaches them, even
+  // though the offsets are only known once the profiles are written.
   virtual void initSectionLayout() override {
     SectionLayout = {{SecProfSummary, 0, 0, 0},
                      {SecNameTable, 0, 0, 0},
+                     {SecFuncOffsetTable, 0, 0, 0},
                      {SecLBRProfile, 0, 0, 0},
                      {SecProfileSymbolList, 0, 0, 0}};
   };
   virtual std::error_code
   writeSections(const StringMap<FunctionSamples> &ProfileMap) override;
+  std::error_code writeFuncOffsetTable();
   ProfileSymbolList *ProfSymList = nullptr;
+
+  /// The table mapping from function name to the offset of its FunctionSample
+  /// towards the start of the (uncompressed) SecLBRProfile section.
+  MapVector<StringRef, uint64_t> FuncOffsetTable;
+  /// The start of the SecLBRProfile data in the stream being written.
+  uint64_t SecLBRProfileStart = 0;
 };
 
 // CompactBinary is a compact format of binary profile which both reduces
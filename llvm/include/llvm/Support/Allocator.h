@@ -27,11 +27,15 @@
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemAlloc.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <type_traits>
 #include <utility>
 
@@ -490,6 +494,109 @@ public:
   T *Allocate(size_t num = 1) { return Allocator.Allocate<T>(num); }
 };
 
+namespace detail {
+
+/// Returns a small integer that identifies the calling thread. Indices are
+/// assigned in the order in which threads first call this function and are
+/// never reused.
+unsigned getThreadIndex();
+
+} // end namespace detail
+
+/// An allocator that keeps a separate \p AllocatorT for each thread using it,
+/// so that threads can allocate concurrently without locking. Memory is freed
+/// all at once by Reset() or when the allocator is destroyed.
+///
+/// Allocation is thread-safe. Reset(), forEach(), the statistics functions and
+/// the destructor must not be called concurrently with allocations.
+template <typename AllocatorT = BumpPtrAllocator>
+class ThreadLocalAllocator
+    : public AllocatorBase<ThreadLocalAllocator<AllocatorT>> {
+public:
+  ThreadLocalAllocator() = default;
+  ThreadLocalAllocator(const ThreadLocalAllocator &) = delete;
+  ThreadLocalAllocator &operator=(const ThreadLocalAllocator &) = delete;
+
+  ~ThreadLocalAllocator() {
+    for (std::atomic<AllocatorT *> &Slot : Slots)
+      delete Slot.load(std::memory_order_relaxed);
+  }
+
+  /// Returns the allocator of the calling thread.
+  AllocatorT &getThreadAllocator() {
+    unsigned Index = detail::getThreadIndex();
+    if (Index < NumSlots)
+      if (AllocatorT *A = Slots[Index].load(std::memory_order_acquire))
+        return *A;
+    return createThreadAllocator(Index);
+  }
+
+  LLVM_ATTRIBUTE_RETURNS_NONNULL void *Allocate(size_t Size,
+                                                size_t Alignment) {
+    return getThreadAllocator().Allocate(Size, Alignment);
+  }
+
+  // Pull in base class overloads.
+  using AllocatorBase<ThreadLocalAllocator>::Allocate;
+
+  // Memory is only freed in bulk.
+  void Deallocate(const void *Ptr, size_t Size) {}
+
+  // Pull in base class overloads.
+  using AllocatorBase<ThreadLocalAllocator>::Deallocate;
+
+  /// Calls \p F on the allocator of each thread that has allocated memory.
+  template <typename FnT> void forEach(FnT F) const {
+    for (const std::atomic<AllocatorT *> &Slot : Slots)
+      if (AllocatorT *A = Slot.load(std::memory_order_acquire))
+        F(*A);
+    for (const auto &KV : Overflow)
+      F(*KV.second);
+  }
+
+  /// Resets the allocators of all threads.
+  void Reset() {
+    forEach([](AllocatorT &A) { A.Reset(); });
+  }
+
+  size_t getBytesAllocated() const {
+    size_t Ret = 0;
+    forEach([&](AllocatorT &A) { Ret += A.getBytesAllocated(); });
+    return Ret;
+  }
+
+  size_t getTotalMemory() const {
+    size_t Ret = 0;
+    forEach([&](AllocatorT &A) { Ret += A.getTotalMemory(); });
+    return Ret;
+  }
+
+private:
+  // The number of threads whose allocators can be found without locking.
+  static constexpr unsigned NumSlots = 256;
+
+  AllocatorT &createThreadAllocator(unsigned Index) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (Index < NumSlots) {
+      AllocatorT *A = new AllocatorT();
+      Slots[Index].store(A, std::memory_order_release);
+      return *A;
+    }
+    std::unique_ptr<AllocatorT> &A = Overflow[Index];
+    if (!A)
+      A.reset(new AllocatorT());
+    return *A;
+  }
+
+  std::atomic<AllocatorT *> Slots[NumSlots] = {};
+
+  // Allocators of threads whose index is NumSlots or larger.
+  std::mutex Mutex;
+  std::map<unsigned, std::unique_ptr<AllocatorT>> Overflow;
+};
+
+typedef ThreadLocalAllocator<> ThreadLocalBumpPtrAllocator;
+
 } // end namespace llvm
 
 template <typename AllocatorT, size_t SlabSize, size_t SizeThreshold>
@@ -1165,6 +1165,15 @@ public:
     priv ///< May modify via data, but changes are lost on destruction.
   };
 
+  /// Access patterns that can be passed to advise().
+  enum advice {
+    normal,     ///< No special treatment.
+    sequential, ///< Read ahead aggressively; pages may be freed after use.
+    random,     ///< Do not read ahead.
+    willneed,   ///< Start reading the pages in the background.
+    hugepage    ///< Back the mapping with huge pages if possible.
+  };
+
 private:
   /// Platform-specific mapping state.
   size_t Size;
@@ -1194,6 +1203,12 @@ public:
   /// behavior.
   const char *const_data() const;
 
+  /// Tells the operating system how the bytes in [\p Offset, \p Offset +
+  /// \p Len) of the mapping are going to be accessed. The range is extended
+  /// to page boundaries and clipped to the mapping. This is only a hint, so
+  /// callers can ignore errors.
+  std::error_code advise(advice A, size_t Offset, size_t Len) const;
+
   /// \returns The minimum alignment offset must be.
   static int alignment();
 };
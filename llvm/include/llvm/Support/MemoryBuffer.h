@@ -68,6 +68,32 @@ public:
   /// from.
   virtual StringRef getBufferIdentifier() const { return "Unknown buffer"; }
 
+  /// How the contents of a buffer are going to be accessed.
+  enum class Advice {
+    Normal,     ///< No special treatment.
+    Sequential, ///< Read ahead aggressively.
+    Random,     ///< Do not read ahead.
+    WillNeed,   ///< Start reading the contents in the background.
+    HugePage    ///< Back the buffer with huge pages if possible.
+  };
+
+  /// Tells the operating system how the bytes in [\p Offset, \p Offset +
+  /// \p Size) of this buffer are going to be accessed, so that it can tune
+  /// read-ahead. This is a no-op unless the buffer is memory-mapped: other
+  /// buffers are read into memory when they are created.
+  virtual void advise(Advice A, size_t Offset, size_t Size) const {}
+
+  /// Applies \p A to the whole buffer.
+  void advise(Advice A) const { advise(A, 0, getBufferSize()); }
+
+  /// Starts reading [\p Offset, \p Offset + \p Size) of a memory-mapped
+  /// buffer in the background, so that later accesses to it don't block on
+  /// I/O. This is useful for large inputs on cold caches or network file
+  /// systems.
+  void prefetch(size_t Offset, size_t Size) const {
+    advise(Advice::WillNeed, Offset, Size);
+  }
+
   /// Open the specified file as a MemoryBuffer, returning a new MemoryBuffer
   /// if successful, otherwise returning null. If FileSize is specified, this
   /// means that the client knows that the file exists and that it has the
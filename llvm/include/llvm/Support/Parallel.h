@@ -12,6 +12,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Threading.h"
 
 #include <algorithm>
 #include <condition_variable>
@@ -29,6 +30,10 @@
 namespace llvm {
 
 namespace parallel {
+// The strategy the default executor uses to create its threads. It has to be
+// set before the first parallel algorithm is run.
+extern ThreadPoolStrategy strategy;
+
 struct sequential_execution_policy {};
 struct parallel_execution_policy {};
 
@@ -69,19 +74,24 @@ public:
     std::unique_lock<std::mutex> lock(Mutex);
     Cond.wait(lock, [&] { return Count == 0; });
   }
+
+  bool isZero() const {
+    std::lock_guard<std::mutex> lock(Mutex);
+    return Count == 0;
+  }
 };
 
+/// A group of tasks running on the default executor. TaskGroups can be
+/// nested; a thread waiting for a group runs other pending tasks meanwhile.
 class TaskGroup {
   Latch L;
-  bool Parallel;
 
 public:
-  TaskGroup();
   ~TaskGroup();
 
   void spawn(std::function<void()> f);
 
-  void sync() const { L.sync(); }
+  void sync() const;
 };
 
 #if defined(_MSC_VER)
@@ -0,0 +1,68 @@
+//===- llvm/Support/SuffixArray.h - Suffix array ----------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a suffix array with a longest common prefix array over a
+// string of unsigned integers, used to find repeated substrings in a string
+// with less memory than a suffix tree.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_SUFFIXARRAY_H
+#define LLVM_SUPPORT_SUFFIXARRAY_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include <vector>
+
+namespace llvm {
+
+/// A substring that occurs more than once in a string.
+struct RepeatedSubstring {
+  /// The length of the string.
+  unsigned Length;
+
+  /// The start indices of each occurrence.
+  std::vector<unsigned> StartIndices;
+};
+
+/// The suffixes of a string in lexicographic order, and the lengths of the
+/// common prefixes of neighboring suffixes.
+///
+/// Construction takes O(N log N) time by prefix doubling, and the result
+/// takes 8 bytes per character of the string.
+class SuffixArray {
+public:
+  /// Construct the suffix array of \p Str, which must outlive it.
+  explicit SuffixArray(ArrayRef<unsigned> Str);
+
+  /// The start indices of the suffixes of the string in lexicographic order.
+  ArrayRef<unsigned> getSuffixes() const { return Suffixes; }
+
+  /// The I-th element is the length of the longest common prefix of the
+  /// suffixes I - 1 and I in lexicographic order, and 0 for I = 0.
+  ArrayRef<unsigned> getLCP() const { return LCP; }
+
+  /// Find the repeated substrings of the string of at least \p MinLength
+  /// characters that a suffix tree would report for its internal nodes: for
+  /// each such node, the occurrences of its string that are not followed by
+  /// the string of a longer repeated substring. Each occurrence of a repeated
+  /// substring is reported at most once, so the result takes O(N) memory.
+  ///
+  /// The start indices of each substring are in increasing order, and
+  /// substrings are reported before the shorter substrings they extend.
+  std::vector<RepeatedSubstring>
+  findRepeatedSubstrings(unsigned MinLength) const;
+
+private:
+  ArrayRef<unsigned> Str;
+  std::vector<unsigned> Suffixes;
+  std::vector<unsigned> LCP;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_SUFFIXARRAY_H
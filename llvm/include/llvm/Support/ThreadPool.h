@@ -14,6 +14,7 @@
 #define LLVM_SUPPORT_THREAD_POOL_H
 
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/thread.h"
 
 #include <future>
@@ -42,9 +43,13 @@ public:
   /// hardware_concurrency().
   ThreadPool();
 
-  /// Construct a pool of \p ThreadCount threads
+  /// Construct a pool of \p ThreadCount threads, or of hardware_concurrency()
+  /// threads if \p ThreadCount is 0.
   ThreadPool(unsigned ThreadCount);
 
+  /// Construct a pool whose size and thread placement follow \p S.
+  ThreadPool(ThreadPoolStrategy S);
+
   /// Blocking destructor: the pool will wait for all the threads to complete.
   ~ThreadPool();
 
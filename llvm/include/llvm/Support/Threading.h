@@ -14,7 +14,9 @@
 #ifndef LLVM_SUPPORT_THREADING_H
 #define LLVM_SUPPORT_THREADING_H
 
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Config/llvm-config.h" // for LLVM_ON_UNIX
 #include "llvm/Support/Compiler.h"
 #include <ciso646> // So we can check the C++ standard lib macros.
@@ -130,18 +132,77 @@ void llvm_execute_on_thread(void (*UserFn)(void *), void *UserData,
   /// Get the amount of currency to use for tasks requiring significant
   /// memory or other resources. Currently based on physical cores, if
   /// available for the host system, otherwise falls back to
-  /// thread::hardware_concurrency().
+  /// thread::hardware_concurrency(), and capped like hardware_concurrency().
   /// Returns 1 when LLVM is configured with LLVM_ENABLE_THREADS=OFF
   unsigned heavyweight_hardware_concurrency();
 
   /// Get the number of threads that the current program can execute
   /// concurrently. On some systems std::thread::hardware_concurrency() returns
   /// the total number of cores, without taking affinity into consideration.
+  /// On Linux, the result is also capped by the CPU quota of the process'
+  /// cgroup, if any.
   /// Returns 1 when LLVM is configured with LLVM_ENABLE_THREADS=OFF.
   /// Fallback to std::thread::hardware_concurrency() if sched_getaffinity is
   /// not available.
   unsigned hardware_concurrency();
 
+  /// This tells how a thread pool will be used: how many threads it creates
+  /// and on which CPUs they run.
+  class ThreadPoolStrategy {
+  public:
+    /// The number of threads requested. 0 means as many as the host allows,
+    /// see compute_thread_count().
+    unsigned ThreadsRequested = 0;
+
+    /// If false, use at most one thread per physical core.
+    bool UseHyperThreads = true;
+
+    /// If true, apply_thread_strategy() binds each thread to the CPUs of a
+    /// single processor package (socket), distributing threads evenly over
+    /// the sockets. This avoids cross-socket memory traffic on NUMA hosts.
+    /// Only implemented on Linux; ignored elsewhere.
+    bool PinToSockets = false;
+
+    /// Returns the number of threads a pool following this strategy should
+    /// create. Unless ThreadsRequested is set, this is hardware_concurrency()
+    /// or heavyweight_hardware_concurrency() depending on UseHyperThreads.
+    /// Returns 1 when LLVM is configured with LLVM_ENABLE_THREADS=OFF.
+    unsigned compute_thread_count() const;
+
+    /// Assigns the current thread, which is the \p ThreadPoolNum'th thread of
+    /// a pool created with this strategy, to its CPUs.
+    void apply_thread_strategy(unsigned ThreadPoolNum) const;
+  };
+
+  /// Returns a strategy that uses all hardware threads, or \p ThreadCount
+  /// threads if it is not 0.
+  inline ThreadPoolStrategy
+  hardware_concurrency_strategy(unsigned ThreadCount = 0) {
+    ThreadPoolStrategy S;
+    S.ThreadsRequested = ThreadCount;
+    return S;
+  }
+
+  /// Returns a strategy for tasks requiring significant memory or other
+  /// resources, which uses one thread per physical core, or \p ThreadCount
+  /// threads if it is not 0.
+  inline ThreadPoolStrategy
+  heavyweight_hardware_concurrency_strategy(unsigned ThreadCount = 0) {
+    ThreadPoolStrategy S;
+    S.ThreadsRequested = ThreadCount;
+    S.UseHyperThreads = false;
+    return S;
+  }
+
+  /// Parses a thread count as given to options such as -threads=. \p Spec is
+  /// "all" (one thread per hardware thread), "physical" (one thread per
+  /// physical core) or a positive number, optionally followed by ",pin" to
+  /// set PinToSockets. An empty \p Spec returns \p Default. Returns None if
+  /// \p Spec is malformed.
+  Optional<ThreadPoolStrategy>
+  get_threadpool_strategy(StringRef Spec,
+                          ThreadPoolStrategy Default = ThreadPoolStrategy());
+
   /// Return the current thread id, as used in various OS system calls.
   /// Note that not all platforms guarantee that the value returned will be
   /// unique across the entire system, so portable code should not assume
@@ -18,6 +18,7 @@
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/Chrono.h"
@@ -29,6 +30,7 @@
 #include <cstdint>
 #include <ctime>
 #include <memory>
+#include <mutex>
 #include <stack>
 #include <string>
 #include <system_error>
@@ -404,6 +406,52 @@ private:
   virtual void anchor();
 };
 
+/// A file system that caches the results of status() and directory listings
+/// of another file system, usually the real one, so that tools that look up
+/// the same paths many times don't repeat the system calls. Lookups of paths
+/// that don't exist are cached too, which makes repeated header search and
+/// openFileForRead() of missing files cheap.
+///
+/// The cache assumes that the underlying file system doesn't change. Clients
+/// that watch for changes, for example with clang's DirectoryWatcher, should
+/// call invalidate() for the paths that have changed.
+///
+/// This class is thread-safe.
+class CachingFileSystem : public ProxyFileSystem {
+public:
+  explicit CachingFileSystem(IntrusiveRefCntPtr<FileSystem> FS)
+      : ProxyFileSystem(std::move(FS)) {}
+
+  llvm::ErrorOr<Status> status(const Twine &Path) override;
+  llvm::ErrorOr<std::unique_ptr<File>>
+  openFileForRead(const Twine &Path) override;
+  directory_iterator dir_begin(const Twine &Dir, std::error_code &EC) override;
+
+  /// Forgets the cached status of \p Path, its cached listing if it is a
+  /// directory, and the cached listing of its parent directory.
+  void invalidate(const Twine &Path);
+
+  /// Forgets everything that has been cached.
+  void invalidateAll();
+
+private:
+  using DirListing = std::vector<std::pair<std::string, sys::fs::file_type>>;
+
+  /// Returns the absolute path that \p Path is cached under, or an empty
+  /// string if \p Path cannot be made absolute.
+  std::string getCacheKey(const Twine &Path) const;
+
+  /// Returns true and sets \p Result if the status of \p Key is cached.
+  bool lookupStatus(StringRef Key, llvm::ErrorOr<Status> &Result);
+
+  /// Caches \p Result unless it is an error other than a missing file.
+  void cacheStatus(StringRef Key, const llvm::ErrorOr<Status> &Result);
+
+  std::mutex Mutex;
+  StringMap<llvm::ErrorOr<Status>> StatusCache;
+  StringMap<std::shared_ptr<const DirListing>> DirCache;
+};
+
 namespace detail {
 
 class InMemoryDirectory;
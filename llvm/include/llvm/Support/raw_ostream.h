@@ -15,10 +15,12 @@
 
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <string>
 #include <system_error>
 
@@ -70,6 +72,16 @@ private:
     ExternalBuffer
   } BufferMode;
 
+public:
+  /// The kind of the stream, used for LLVM-style RTTI.
+  enum class OStreamKind {
+    OK_OStream,
+    OK_FDStream,
+  };
+
+private:
+  const OStreamKind Kind;
+
 public:
   // color order matches ANSI escape sequence, don't change
   enum class Colors {
@@ -96,8 +108,9 @@ public:
   static const Colors SAVEDCOLOR = Colors::SAVEDCOLOR;
   static const Colors RESET = Colors::RESET;
 
-  explicit raw_ostream(bool unbuffered = false)
-      : BufferMode(unbuffered ? Unbuffered : InternalBuffer) {
+  explicit raw_ostream(bool unbuffered = false,
+                       OStreamKind K = OStreamKind::OK_OStream)
+      : BufferMode(unbuffered ? Unbuffered : InternalBuffer), Kind(K) {
     // Start out ready to flush.
     OutBufStart = OutBufEnd = OutBufCur = nullptr;
   }
@@ -107,6 +120,8 @@ public:
 
   virtual ~raw_ostream();
 
+  OStreamKind get_kind() const { return Kind; }
+
   /// tell - Return the current offset with the file.
   uint64_t tell() const { return current_pos() + GetNumBytesInBuffer(); }
 
@@ -361,8 +376,9 @@ class raw_pwrite_stream : public raw_ostream {
   void anchor() override;
 
 public:
-  explicit raw_pwrite_stream(bool Unbuffered = false)
-      : raw_ostream(Unbuffered) {}
+  explicit raw_pwrite_stream(bool Unbuffered = false,
+                             OStreamKind K = OStreamKind::OK_OStream)
+      : raw_ostream(Unbuffered, K) {}
   void pwrite(const char *Ptr, size_t Size, uint64_t Offset) {
 #ifndef NDEBUG
     uint64_t Pos = tell();
@@ -397,11 +413,19 @@ class raw_fd_ostream : public raw_pwrite_stream {
 
   uint64_t pos;
 
+  /// State of the background writer, if enableWriteBehind() was called.
+  struct WriteBehindState;
+  std::unique_ptr<WriteBehindState> WriteBehind;
+
   /// See raw_ostream::write_impl.
   void write_impl(const char *Ptr, size_t Size) override;
 
   void pwrite_impl(const char *Ptr, size_t Size, uint64_t Offset) override;
 
+  /// Stop the background writer, if any, after it has written all pending
+  /// buffers.
+  void stopWriteBehind();
+
   /// Return the current position within the stream, not counting the bytes
   /// currently in the buffer.
   uint64_t current_pos() const override { return pos; }
@@ -409,10 +433,15 @@ class raw_fd_ostream : public raw_pwrite_stream {
   /// Determine an efficient buffer size.
   size_t preferred_buffer_size() const override;
 
+  void anchor() override;
+
+protected:
   /// Set the flag indicating that an output error has been encountered.
   void error_detected(std::error_code EC) { this->EC = EC; }
 
-  void anchor() override;
+  /// Advance the tracked file position by \p Delta bytes, for subclasses that
+  /// move the file position themselves.
+  void inc_pos(uint64_t Delta) { pos += Delta; }
 
 public:
   /// Open the specified file for writing. If an error occurs, information
@@ -437,7 +466,8 @@ public:
   /// FD is the file descriptor that this writes to.  If ShouldClose is true,
   /// this closes the file when the stream is destroyed. If FD is for stdout or
   /// stderr, it will not be closed.
-  raw_fd_ostream(int fd, bool shouldClose, bool unbuffered=false);
+  raw_fd_ostream(int fd, bool shouldClose, bool unbuffered=false,
+                 OStreamKind K = OStreamKind::OK_OStream);
 
   ~raw_fd_ostream() override;
 
@@ -445,7 +475,27 @@ public:
   /// fsync.
   void close();
 
-  bool supportsSeeking() { return SupportsSeeking; }
+  bool supportsSeeking() const { return SupportsSeeking; }
+
+  /// Return the file descriptor that this stream writes to.
+  int get_fd() const { return FD; }
+
+  /// Write to the file descriptor on a background thread, so that the caller
+  /// does not wait for I/O to complete. Each flush of the stream buffer
+  /// copies the data into one of \p NumBuffers buffers of \p BufferSize
+  /// bytes, and blocks only if all of them are waiting to be written. This
+  /// also sets the stream buffer size to \p BufferSize.
+  ///
+  /// With write-behind enabled, flush() no longer waits for data to reach
+  /// the file, and write errors are detected only by waitForWrites(),
+  /// seek(), close() and the destructor. This does nothing if LLVM was built
+  /// without thread support or if the stream refers to a Windows console.
+  void enableWriteBehind(unsigned NumBuffers = 4,
+                         size_t BufferSize = 1024 * 1024);
+
+  /// Flush the stream and wait for the background writer to write all
+  /// pending data. Updates the error flag if a write failed.
+  void waitForWrites();
 
   /// Flushes the stream and repositions the underlying file descriptor position
   /// to the offset specified from the beginning of the file.
@@ -483,6 +533,27 @@ public:
   void clear_error() { EC = std::error_code(); }
 };
 
+/// A raw_fd_ostream that can also be read from and seeked in, so that data
+/// written earlier can be patched in place. This lets writers such as the
+/// bitcode writer stream most of their output to the file instead of
+/// holding all of it in memory.
+class raw_fd_stream : public raw_fd_ostream {
+public:
+  /// Open the specified file for reading and writing. If an error occurs,
+  /// information about the error is put into EC, and the stream should be
+  /// immediately destroyed. Unlike raw_fd_ostream, "-" is not accepted
+  /// because standard output does not support seeking.
+  raw_fd_stream(StringRef Filename, std::error_code &EC);
+
+  /// Flush the stream and read up to \p Size bytes from the current file
+  /// position into \p Ptr. Returns the number of bytes read, or -1 on error,
+  /// in which case the error flag is set.
+  ssize_t read(char *Ptr, size_t Size);
+
+  /// Check if \p OS is a pointer of type raw_fd_stream*.
+  static bool classof(const raw_ostream *OS);
+};
+
 /// This returns a reference to a raw_ostream for standard output. Use it like:
 /// outs() << "foo" << "bar";
 raw_ostream &outs();
@@ -13,6 +13,10 @@
 #ifndef LLVM_TABLEGEN_MAIN_H
 #define LLVM_TABLEGEN_MAIN_H
 
+#include "llvm/ADT/ArrayRef.h"
+#include <functional>
+#include <string>
+
 namespace llvm {
 
 class raw_ostream;
@@ -24,6 +28,16 @@ using TableGenMainFn = bool (raw_ostream &OS, RecordKeeper &Records);
 
 int TableGenMain(char *argv0, TableGenMainFn *MainFn);
 
+/// A backend to run on the records, and the file to write its output to.
+struct TableGenOutput {
+  std::string Filename;
+  std::function<bool(raw_ostream &OS, RecordKeeper &Records)> MainFn;
+};
+
+/// Parse the input once and run each backend of Outputs on the records, up to
+/// Jobs of them at a time. Returns non-zero if any backend fails.
+int TableGenMain(char *argv0, ArrayRef<TableGenOutput> Outputs, unsigned Jobs);
+
 } // end namespace llvm
 
 #endif // LLVM_TABLEGEN_MAIN_H
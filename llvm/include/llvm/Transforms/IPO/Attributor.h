@@ -766,10 +766,12 @@ struct Attributor {
   /// with the TrackDependence flag passed to the method set to false. This can
   /// be beneficial to avoid false dependences but it requires the users of
   /// `getAAFor` to explicitly record true dependences through this method.
+  ///
+  /// Dependences are only kept until \p FromAA changes: \p ToAA is then
+  /// updated and records again the dependences it still has. No dependence is
+  /// recorded on an attribute in a fixpoint state, as it cannot change.
   void recordDependence(const AbstractAttribute &FromAA,
-                        const AbstractAttribute &ToAA) {
-    QueryMap[&FromAA].insert(const_cast<AbstractAttribute *>(&ToAA));
-  }
+                        const AbstractAttribute &ToAA);
 
   /// Introduce a new abstract attribute into the fixpoint analysis.
   ///
@@ -925,7 +927,7 @@ private:
       AA.update(*this);
 
     if (TrackDependence && AA.getState().isValidState())
-      QueryMap[&AA].insert(const_cast<AbstractAttribute *>(QueryingAA));
+      recordDependence(AA, *QueryingAA);
     return AA;
   }
 
@@ -947,7 +949,7 @@ private:
             KindToAbstractAttributeMap.lookup(&AAType::ID))) {
       // Do not register a dependence on an attribute with an invalid state.
       if (TrackDependence && AA->getState().isValidState())
-        QueryMap[AA].insert(const_cast<AbstractAttribute *>(QueryingAA));
+        recordDependence(*AA, *QueryingAA);
       return AA;
     }
     return nullptr;
@@ -969,7 +971,7 @@ private:
   ///}
 
   /// A map from abstract attributes to the ones that queried them through calls
-  /// to the getAAFor<...>(...) method.
+  /// to the getAAFor<...>(...) method since they last changed.
   ///{
   using QueryMapTy =
       MapVector<const AbstractAttribute *, SetVector<AbstractAttribute *>>;
@@ -0,0 +1,58 @@
+//===- FunctionCache.h - Cache for function pass pipelines ------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines FunctionCachePass, which runs a function pass pipeline on
+// each function of a module like ModuleToFunctionPassAdaptor, but reuses the
+// result of a previous run from an on-disk cache if the function and
+// everything the pipeline can see of the rest of the module are unchanged.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_IPO_FUNCTIONCACHE_H
+#define LLVM_TRANSFORMS_IPO_FUNCTIONCACHE_H
+
+#include "llvm/IR/PassManager.h"
+#include <string>
+
+namespace llvm {
+
+class Module;
+
+/// Runs a function pass pipeline on each function of a module, caching the
+/// optimized functions in a directory.
+///
+/// The cache key of a function is a hash of the pipeline, the function, the
+/// declarations of the functions and globals it refers to, and the
+/// initializers of the constants it refers to. Function passes cannot look
+/// at anything else in the module, except through module analyses such as
+/// GlobalsAA; the key does not cover those, so pipelines that use them
+/// should not be cached.
+///
+/// Functions with debug info or references to unnamed globals are not
+/// cached. If \p CacheDir is empty, this pass is equivalent to
+/// ModuleToFunctionPassAdaptor.
+class FunctionCachePass : public PassInfoMixin<FunctionCachePass> {
+public:
+  /// \p PipelineKey identifies \p Pipeline and its options. Entries are only
+  /// reused by passes with the same key.
+  FunctionCachePass(FunctionPassManager Pipeline, std::string CacheDir,
+                    std::string PipelineKey)
+      : Pipeline(std::move(Pipeline)), CacheDir(std::move(CacheDir)),
+        PipelineKey(std::move(PipelineKey)) {}
+
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
+
+private:
+  FunctionPassManager Pipeline;
+  std::string CacheDir;
+  std::string PipelineKey;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_TRANSFORMS_IPO_FUNCTIONCACHE_H
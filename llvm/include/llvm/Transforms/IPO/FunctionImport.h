@@ -62,7 +62,9 @@ public:
     // This corresponds to NoInline being set on the function summary,
     // which will happen if it is known that the inliner will not be able
     // to inline the function (e.g. it is marked with a NoInline attribute).
-    NoInline
+    NoInline,
+    // Instruction count over what is left of the import budget of the module.
+    OverBudget
   };
 
   /// Information optionally tracked for candidates the importer decided
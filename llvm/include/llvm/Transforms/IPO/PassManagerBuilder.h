@@ -170,6 +170,12 @@ public:
   unsigned LicmMssaOptCap;
   unsigned LicmMssaNoAccForPromotionCap;
 
+  /// If true, populateLTOPassManager leaves out the function simplification
+  /// passes that follow the interprocedural passes of the LTO pipeline, so
+  /// that populateLTOFunctionSimplificationPassManager can run them on
+  /// partitions of the module in parallel.
+  bool DeferLTOFunctionSimplification;
+
   /// Enable profile instrumentation pass.
   bool EnablePGOInstrGen;
   /// Enable profile context sensitive instrumentation pass.
@@ -202,6 +208,7 @@ private:
   void addInitialAliasAnalysisPasses(legacy::PassManagerBase &PM) const;
   void addLTOOptimizationPasses(legacy::PassManagerBase &PM);
   void addLateLTOOptimizationPasses(legacy::PassManagerBase &PM);
+  void addLTOFunctionSimplificationPasses(legacy::PassManagerBase &PM);
   void addPGOInstrPasses(legacy::PassManagerBase &MPM, bool IsCS);
   void addFunctionSimplificationPasses(legacy::PassManagerBase &MPM);
   void addInstructionCombiningPass(legacy::PassManagerBase &MPM) const;
@@ -215,6 +222,12 @@ public:
   /// populateModulePassManager - This sets up the primary pass manager.
   void populateModulePassManager(legacy::PassManagerBase &MPM);
   void populateLTOPassManager(legacy::PassManagerBase &PM);
+
+  /// Add the function simplification passes of the LTO pipeline, for a module
+  /// that went through populateLTOPassManager with
+  /// DeferLTOFunctionSimplification set.
+  void populateLTOFunctionSimplificationPassManager(
+      legacy::PassManagerBase &PM);
   void populateThinLTOPassManager(legacy::PassManagerBase &PM);
 };
 
@@ -22,15 +22,22 @@
 
 namespace llvm {
 
+/// The default limit of instruction combining iterations over a function.
+/// Each iteration after the first one usually only confirms the fixed point.
+static constexpr unsigned InstCombineDefaultMaxIterations = 1000;
+
 class InstCombinePass : public PassInfoMixin<InstCombinePass> {
   InstCombineWorklist Worklist;
-  bool ExpensiveCombines;
+  const bool ExpensiveCombines;
+  const unsigned MaxIterations;
 
 public:
   static StringRef name() { return "InstCombinePass"; }
 
-  explicit InstCombinePass(bool ExpensiveCombines = true)
-      : ExpensiveCombines(ExpensiveCombines) {}
+  explicit InstCombinePass(
+      bool ExpensiveCombines = true,
+      unsigned MaxIterations = InstCombineDefaultMaxIterations)
+      : ExpensiveCombines(ExpensiveCombines), MaxIterations(MaxIterations) {}
 
   PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
 };
@@ -42,12 +49,16 @@ public:
 class InstructionCombiningPass : public FunctionPass {
   InstCombineWorklist Worklist;
   const bool ExpensiveCombines;
+  const unsigned MaxIterations;
 
 public:
   static char ID; // Pass identification, replacement for typeid
 
-  InstructionCombiningPass(bool ExpensiveCombines = true)
-      : FunctionPass(ID), ExpensiveCombines(ExpensiveCombines) {
+  InstructionCombiningPass(
+      bool ExpensiveCombines = true,
+      unsigned MaxIterations = InstCombineDefaultMaxIterations)
+      : FunctionPass(ID), ExpensiveCombines(ExpensiveCombines),
+        MaxIterations(MaxIterations) {
     initializeInstructionCombiningPassPass(*PassRegistry::getPassRegistry());
   }
 
@@ -68,6 +79,8 @@ public:
 //    %Z = add int 2, %X
 //
 FunctionPass *createInstructionCombiningPass(bool ExpensiveCombines = true);
+FunctionPass *createInstructionCombiningPass(bool ExpensiveCombines,
+                                             unsigned MaxIterations);
 }
 
 #endif
@@ -11,6 +11,7 @@
 
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/Support/Compiler.h"
@@ -26,6 +27,11 @@ namespace llvm {
 class InstCombineWorklist {
   SmallVector<Instruction*, 256> Worklist;
   DenseMap<Instruction*, unsigned> WorklistMap;
+  /// Instructions created while combining an instruction, in the order they
+  /// were created. They are moved to the worklist before the next instruction
+  /// is removed from it, so that they are visited in that order, operands
+  /// before their users.
+  SmallSetVector<Instruction *, 16> Deferred;
 
 public:
   InstCombineWorklist() = default;
@@ -33,7 +39,7 @@ public:
   InstCombineWorklist(InstCombineWorklist &&) = default;
   InstCombineWorklist &operator=(InstCombineWorklist &&) = default;
 
-  bool isEmpty() const { return Worklist.empty(); }
+  bool isEmpty() const { return Worklist.empty() && Deferred.empty(); }
 
   /// Add - Add the specified instruction to the worklist if it isn't already
   /// in it.
@@ -44,6 +50,14 @@ public:
     }
   }
 
+  /// AddDeferred - Add the specified instruction to the worklist before the
+  /// next instruction is removed from it. Instructions added this way are
+  /// visited in the order they were added.
+  void AddDeferred(Instruction *I) {
+    if (Deferred.insert(I))
+      LLVM_DEBUG(dbgs() << "IC: ADD DEFERRED: " << *I << '\n');
+  }
+
   void AddValue(Value *V) {
     if (Instruction *I = dyn_cast<Instruction>(V))
       Add(I);
@@ -53,7 +67,7 @@ public:
   /// which should only be done when the worklist is empty and when the group
   /// has no duplicates.
   void AddInitialGroup(ArrayRef<Instruction *> List) {
-    assert(Worklist.empty() && "Worklist must be empty to add initial group");
+    assert(isEmpty() && "Worklist must be empty to add initial group");
     Worklist.reserve(List.size()+16);
     WorklistMap.reserve(List.size());
     LLVM_DEBUG(dbgs() << "IC: ADDING: " << List.size()
@@ -67,6 +81,7 @@ public:
 
   // Remove - remove I from the worklist if it exists.
   void Remove(Instruction *I) {
+    Deferred.remove(I);
     DenseMap<Instruction*, unsigned>::iterator It = WorklistMap.find(I);
     if (It == WorklistMap.end()) return; // Not in worklist.
 
@@ -77,6 +92,11 @@ public:
   }
 
   Instruction *RemoveOne() {
+    // The deferred instructions are pushed in reverse, so that the first one
+    // is removed first.
+    for (Instruction *I : reverse(Deferred))
+      Add(I);
+    Deferred.clear();
     Instruction *I = Worklist.pop_back_val();
     WorklistMap.erase(I);
     return I;
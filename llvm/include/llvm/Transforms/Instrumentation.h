@@ -152,6 +152,10 @@ ModulePass *createInstrProfilingLegacyPass(
 
 ModulePass *createInstrOrderFilePass();
 
+// Record the profile counts of the call graph edges in the "CG Profile"
+// module flag, which is emitted in the .llvm.call-graph-profile section.
+ModulePass *createCGProfileLegacyPass();
+
 // Insert DataFlowSanitizer (dynamic data flow analysis) instrumentation
 ModulePass *createDataFlowSanitizerPass(
     const std::vector<std::string> &ABIListFiles = std::vector<std::string>(),
@@ -50,6 +50,7 @@ private:
   struct PerFunctionProfileData {
     uint32_t NumValueSites[IPVK_Last + 1];
     GlobalVariable *RegionCounters = nullptr;
+    GlobalVariable *CounterShards = nullptr;
     GlobalVariable *DataVar = nullptr;
 
     PerFunctionProfileData() {
@@ -68,6 +69,10 @@ private:
   // vector of counter load/store pairs to be register promoted.
   std::vector<LoadStorePair> PromotionCandidates;
 
+  // The load of the counter bias in each function, if counters are relocated
+  // at runtime.
+  DenseMap<const Function *, LoadInst *> FunctionToProfileBiasMap;
+
   // The start value of precise value profile range for memory intrinsic sizes.
   int64_t MemOPSizeRangeStart;
   // The end value of precise value profile range for memory intrinsic sizes.
@@ -85,15 +90,30 @@ private:
   /// Returns true if profile counter update register promotion is enabled.
   bool isCounterPromotionEnabled() const;
 
+  /// Returns true if the counters are accessed through a bias that the
+  /// runtime can change.
+  bool isRuntimeCounterRelocationEnabled() const;
+
+  /// Returns true if each thread counts in its own copy of the counters and
+  /// only adds them to the shared counters now and then.
+  bool isCounterShardingEnabled() const;
+
   /// Count the number of instrumented value sites for the function.
   void computeNumValueSiteCounts(InstrProfValueProfileInst *Ins);
 
   /// Replace instrprof_value_profile with a call to runtime library.
   void lowerValueProfileInst(InstrProfValueProfileInst *Ins);
 
+  /// Get the address of the counter that \p Inc updates.
+  Value *getCounterAddress(InstrProfIncrementInst *Inc);
+
   /// Replace instrprof_increment with an increment of the appropriate value.
   void lowerIncrement(InstrProfIncrementInst *Inc);
 
+  /// Replace instrprof_increment with an increment of the thread-local copy
+  /// of the counter, which is added to the counter when it is full.
+  void lowerIncrementToShard(InstrProfIncrementInst *Inc);
+
   /// Force emitting of name vars for unused functions.
   void lowerCoverageData(GlobalVariable *CoverageNamesVar);
 
@@ -103,6 +123,10 @@ private:
   /// referring to them will also be created.
   GlobalVariable *getOrCreateRegionCounters(InstrProfIncrementInst *Inc);
 
+  /// Get the thread-local copies of the region counters for an increment,
+  /// creating them if necessary.
+  GlobalVariable *getOrCreateCounterShards(InstrProfIncrementInst *Inc);
+
   /// Emit the section with compressed function names.
   void emitNameData();
 
@@ -24,7 +24,8 @@ namespace llvm {
 class Function;
 
 /// This class implements a trivial dead store elimination. We consider
-/// only the redundant stores that are local to a single Basic Block.
+/// only the redundant stores that are local to a single Basic Block, unless
+/// the MemorySSA-based implementation is enabled with -enable-dse-memoryssa.
 class DSEPass : public PassInfoMixin<DSEPass> {
 public:
   PreservedAnalyses run(Function &F, FunctionAnalysisManager &FAM);
@@ -16,6 +16,7 @@
 #define LLVM_TRANSFORMS_SCALAR_GVN_H
 
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/FlatHashMap.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SetVector.h"
@@ -88,7 +89,9 @@ public:
   /// two values.
   class ValueTable {
     DenseMap<Value *, uint32_t> valueNumbering;
-    DenseMap<Expression, uint32_t> expressionNumbering;
+    // Expressions are expensive to construct and compare, so use a map that
+    // neither fills empty buckets with keys nor compares keys on collisions.
+    FlatHashMap<Expression, uint32_t> expressionNumbering;
 
     // Expressions is the vector of Expression. ExprIdx is the mapping from
     // value number to the index of Expression in Expressions. We use it
@@ -25,6 +25,11 @@ class Module;
 /// Splits the module M into N linkable partitions. The function ModuleCallback
 /// is called N times passing each individual partition as the MPart argument.
 ///
+/// If PreserveOrder is true, the partitions hold consecutive runs of the
+/// definitions of M, balanced by size, so that linking them in order keeps
+/// the order of definitions of M, except that members of a comdat and locals
+/// are kept with the first definition that needs them.
+///
 /// FIXME: This function does not deal with the somewhat subtle symbol
 /// visibility issues around module splitting, including (but not limited to):
 ///
@@ -35,7 +40,7 @@ class Module;
 void SplitModule(
     std::unique_ptr<Module> M, unsigned N,
     function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback,
-    bool PreserveLocals = false);
+    bool PreserveLocals = false, bool PreserveOrder = false);
 
 } // end namespace llvm
 
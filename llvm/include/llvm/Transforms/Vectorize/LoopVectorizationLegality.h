@@ -327,6 +327,13 @@ private:
   /// is not a supported induction or if we fail to find an induction.
   bool setupOuterLoopInductions();
 
+  /// Return true if all the instructions of the outer loop nest can be
+  /// widened by the VPlan-native path: calls must have a vector form, memory
+  /// accesses must be simple, the types must be vectorizable and only the
+  /// outer loop inductions may be used outside the loop. Must be called after
+  /// setupOuterLoopInductions.
+  bool canVectorizeOuterLoopInstrs();
+
   /// Return true if the pre-header, exiting and latch blocks of \p Lp
   /// (non-recursive) are considered legal for vectorization.
   /// Temporarily taking UseVPlanNativePath parameter. If true, take
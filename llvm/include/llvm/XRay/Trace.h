@@ -15,6 +15,7 @@
 #include <cstdint>
 #include <vector>
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/DataExtractor.h"
 #include "llvm/Support/Error.h"
@@ -74,6 +75,26 @@ Expected<Trace> loadTraceFile(StringRef Filename, bool Sort = false);
 /// DataExtractor.
 Expected<Trace> loadTrace(const DataExtractor &Extractor, bool Sort = false);
 
+/// The callback type used when streaming the records of a trace. Returning an
+/// error stops the processing of the trace, and that error is returned to the
+/// caller.
+using RecordCallback = function_ref<Error(const XRayRecord &)>;
+
+/// This function will read the XRay trace records from the provided
+/// |Filename| and hand them to |Callback| one at a time, without keeping them
+/// all in memory. |Header| is filled in before the first record is delivered.
+///
+/// Records of FDR mode logs are delivered one thread at a time, in the same
+/// order loadTraceFile() would return them unsorted. Use loadTraceFile() when
+/// the records need to be sorted by timestamp.
+Error processTraceFile(StringRef Filename, XRayFileHeader &Header,
+                       RecordCallback Callback);
+
+/// This function will read the XRay trace records from the provided
+/// DataExtractor and hand them to |Callback| one at a time.
+Error processTrace(const DataExtractor &Extractor, XRayFileHeader &Header,
+                   RecordCallback Callback);
+
 } // namespace xray
 } // namespace llvm
 
@@ -18,6 +18,7 @@
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/Dominators.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/RemarkStreamer.h"
 
 using namespace llvm;
 
@@ -69,6 +70,21 @@ void OptimizationRemarkEmitter::computeHotness(
     OptDiag.setHotness(computeHotness(V));
 }
 
+bool OptimizationRemarkEmitter::meetsHotnessThreshold(const Value *V) {
+  uint64_t Threshold = F->getContext().getDiagnosticsHotnessThreshold();
+  if (!Threshold)
+    return true;
+  // Remarks without a code region have no hotness.
+  return V && computeHotness(V).getValueOr(0) >= Threshold;
+}
+
+bool OptimizationRemarkEmitter::enabled(StringRef PassName) const {
+  if (const RemarkStreamer *RS = F->getContext().getRemarkStreamer())
+    if (RS->matchesFilter(PassName))
+      return true;
+  return F->getContext().getDiagHandlerPtr()->isAnyRemarkEnabled(PassName);
+}
+
 void OptimizationRemarkEmitter::emit(
     DiagnosticInfoOptimizationBase &OptDiagBase) {
   auto &OptDiag = cast<DiagnosticInfoIROptimization>(OptDiagBase);
@@ -145,6 +145,9 @@ STATISTIC(NumTripCountsNotComputed,
           "Number of loops without predictable loop counts");
 STATISTIC(NumBruteForceTripCountsComputed,
           "Number of loops with trip counts computed by force");
+STATISTIC(NumSCEVExprs, "Number of SCEV expressions created");
+STATISTIC(MaxSCEVExprsPerFunction,
+          "Maximum number of SCEV expressions created for a function");
 
 static cl::opt<unsigned>
 MaxBruteForceIterations("scalar-evolution-max-iterations", cl::ReallyHidden,
@@ -6754,6 +6757,12 @@ ScalarEvolution::getBackedgeTakenInfo(const Loop *L) {
   return BackedgeTakenCounts.find(L)->second = std::move(Result);
 }
 
+/// Count the expressions of a ScalarEvolution that is destroyed or reset.
+static void countSCEVExprs(unsigned NumExprs) {
+  NumSCEVExprs += NumExprs;
+  MaxSCEVExprsPerFunction.updateMax(NumExprs);
+}
+
 void ScalarEvolution::forgetAllLoops() {
   // This method is intended to forget all info about loops. It should
   // invalidate caches as if the following happened:
@@ -6776,6 +6785,27 @@ void ScalarEvolution::forgetAllLoops() {
   PredicatedSCEVRewrites.clear();
 }
 
+void ScalarEvolution::forgetAllExpressions() {
+  assert(PendingLoopPredicates.empty() && PendingPhiRanges.empty() &&
+         PendingMerges.empty() && "Cannot reset while computing!");
+  forgetAllLoops();
+  LoopUsers.clear();
+  countSCEVExprs(UniqueSCEVs.size());
+
+  // The SCEVUnknowns hold value handles, which must be released before their
+  // memory is.
+  for (SCEVUnknown *U = FirstUnknown; U;) {
+    SCEVUnknown *Tmp = U;
+    U = U->Next;
+    Tmp->~SCEVUnknown();
+  }
+  FirstUnknown = nullptr;
+
+  UniqueSCEVs.clear();
+  UniquePreds.clear();
+  SCEVAllocator.Reset();
+}
+
 void ScalarEvolution::forgetLoop(const Loop *L) {
   // Drop any stored trip count value.
   auto RemoveLoopFromBackedgeMap =
@@ -6788,30 +6818,25 @@ void ScalarEvolution::forgetLoop(const Loop *L) {
       };
 
   SmallVector<const Loop *, 16> LoopWorklist(1, L);
+  SmallPtrSet<const Loop *, 16> LoopsInNest;
   SmallVector<Instruction *, 32> Worklist;
   SmallPtrSet<Instruction *, 16> Visited;
+  // The expressions to forget for the whole loop nest. Forgetting them at once
+  // scans the caches indexed by loop once, instead of once per expression.
+  SmallVector<const SCEV *, 32> ToForget;
 
   // Iterate over all the loops and sub-loops to drop SCEV information.
   while (!LoopWorklist.empty()) {
     auto *CurrL = LoopWorklist.pop_back_val();
+    LoopsInNest.insert(CurrL);
 
     RemoveLoopFromBackedgeMap(BackedgeTakenCounts, CurrL);
     RemoveLoopFromBackedgeMap(PredicatedBackedgeTakenCounts, CurrL);
 
-    // Drop information about predicated SCEV rewrites for this loop.
-    for (auto I = PredicatedSCEVRewrites.begin();
-         I != PredicatedSCEVRewrites.end();) {
-      std::pair<const SCEV *, const Loop *> Entry = I->first;
-      if (Entry.second == CurrL)
-        PredicatedSCEVRewrites.erase(I++);
-      else
-        ++I;
-    }
-
     auto LoopUsersItr = LoopUsers.find(CurrL);
     if (LoopUsersItr != LoopUsers.end()) {
-      for (auto *S : LoopUsersItr->second)
-        forgetMemoizedResults(S);
+      ToForget.append(LoopUsersItr->second.begin(),
+                      LoopUsersItr->second.end());
       LoopUsers.erase(LoopUsersItr);
     }
 
@@ -6826,8 +6851,8 @@ void ScalarEvolution::forgetLoop(const Loop *L) {
       ValueExprMapType::iterator It =
           ValueExprMap.find_as(static_cast<Value *>(I));
       if (It != ValueExprMap.end()) {
+        ToForget.push_back(It->second);
         eraseValueFromMap(It->first);
-        forgetMemoizedResults(It->second);
         if (PHINode *PN = dyn_cast<PHINode>(I))
           ConstantEvolutionLoopExitValue.erase(PN);
       }
@@ -6840,6 +6865,18 @@ void ScalarEvolution::forgetLoop(const Loop *L) {
     // ValuesAtScopes map.
     LoopWorklist.append(CurrL->begin(), CurrL->end());
   }
+
+  // Drop information about predicated SCEV rewrites for the loop nest.
+  for (auto I = PredicatedSCEVRewrites.begin();
+       I != PredicatedSCEVRewrites.end();) {
+    std::pair<const SCEV *, const Loop *> Entry = I->first;
+    if (LoopsInNest.count(Entry.second))
+      PredicatedSCEVRewrites.erase(I++);
+    else
+      ++I;
+  }
+
+  forgetMemoizedResults(ToForget);
 }
 
 void ScalarEvolution::forgetTopmostLoop(const Loop *L) {
@@ -6857,6 +6894,7 @@ void ScalarEvolution::forgetValue(Value *V) {
   Worklist.push_back(I);
 
   SmallPtrSet<Instruction *, 8> Visited;
+  SmallVector<const SCEV *, 8> ToForget;
   while (!Worklist.empty()) {
     I = Worklist.pop_back_val();
     if (!Visited.insert(I).second)
@@ -6865,14 +6903,15 @@ void ScalarEvolution::forgetValue(Value *V) {
     ValueExprMapType::iterator It =
       ValueExprMap.find_as(static_cast<Value *>(I));
     if (It != ValueExprMap.end()) {
+      ToForget.push_back(It->second);
       eraseValueFromMap(It->first);
-      forgetMemoizedResults(It->second);
       if (PHINode *PN = dyn_cast<PHINode>(I))
         ConstantEvolutionLoopExitValue.erase(PN);
     }
 
     PushDefUseChildren(I, Worklist);
   }
+  forgetMemoizedResults(ToForget);
 }
 
 /// Get the exact loop backedge taken count considering all loop exits. A
@@ -6962,6 +7001,21 @@ bool ScalarEvolution::BackedgeTakenInfo::hasOperand(const SCEV *S,
   return false;
 }
 
+bool ScalarEvolution::BackedgeTakenInfo::hasAnyOperand(
+    const SmallPtrSetImpl<const SCEV *> &Ops, ScalarEvolution *SE) const {
+  auto IsOp = [&](const SCEV *X) { return Ops.count(X); };
+  if (getMax() && getMax() != SE->getCouldNotCompute() &&
+      SCEVExprContains(getMax(), IsOp))
+    return true;
+
+  for (auto &ENT : ExitNotTaken)
+    if (ENT.ExactNotTaken != SE->getCouldNotCompute() &&
+        SCEVExprContains(ENT.ExactNotTaken, IsOp))
+      return true;
+
+  return false;
+}
+
 ScalarEvolution::ExitLimit::ExitLimit(const SCEV *E)
     : ExactNotTaken(E), MaxNotTaken(E) {
   assert((isa<SCEVCouldNotCompute>(MaxNotTaken) ||
@@ -11394,6 +11448,8 @@ ScalarEvolution::ScalarEvolution(ScalarEvolution &&Arg)
 }
 
 ScalarEvolution::~ScalarEvolution() {
+  countSCEVExprs(UniqueSCEVs.size());
+
   // Iterate through all the SCEVUnknown instances and call their
   // destructors, so that they release their references to their values.
   for (SCEVUnknown *U = FirstUnknown; U;) {
@@ -11801,29 +11857,39 @@ bool ScalarEvolution::ExitLimit::hasOperand(const SCEV *S) const {
 
 void
 ScalarEvolution::forgetMemoizedResults(const SCEV *S) {
-  ValuesAtScopes.erase(S);
-  LoopDispositions.erase(S);
-  BlockDispositions.erase(S);
-  UnsignedRanges.erase(S);
-  SignedRanges.erase(S);
-  ExprValueMap.erase(S);
-  HasRecMap.erase(S);
-  MinTrailingZerosCache.erase(S);
+  forgetMemoizedResults(makeArrayRef(S));
+}
+
+void ScalarEvolution::forgetMemoizedResults(ArrayRef<const SCEV *> SCEVs) {
+  if (SCEVs.empty())
+    return;
+
+  SmallPtrSet<const SCEV *, 8> ToForget(SCEVs.begin(), SCEVs.end());
+  for (const SCEV *S : ToForget) {
+    ValuesAtScopes.erase(S);
+    LoopDispositions.erase(S);
+    BlockDispositions.erase(S);
+    UnsignedRanges.erase(S);
+    SignedRanges.erase(S);
+    ExprValueMap.erase(S);
+    HasRecMap.erase(S);
+    MinTrailingZerosCache.erase(S);
+  }
 
   for (auto I = PredicatedSCEVRewrites.begin();
        I != PredicatedSCEVRewrites.end();) {
     std::pair<const SCEV *, const Loop *> Entry = I->first;
-    if (Entry.first == S)
+    if (ToForget.count(Entry.first))
       PredicatedSCEVRewrites.erase(I++);
     else
       ++I;
   }
 
   auto RemoveSCEVFromBackedgeMap =
-      [S, this](DenseMap<const Loop *, BackedgeTakenInfo> &Map) {
+      [&ToForget, this](DenseMap<const Loop *, BackedgeTakenInfo> &Map) {
         for (auto I = Map.begin(), E = Map.end(); I != E;) {
           BackedgeTakenInfo &BEInfo = I->second;
-          if (BEInfo.hasOperand(S, this)) {
+          if (BEInfo.hasAnyOperand(ToForget, this)) {
             BEInfo.clear();
             Map.erase(I++);
           } else
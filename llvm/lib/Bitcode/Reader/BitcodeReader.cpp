@@ -579,7 +579,8 @@ public:
   /// Main interface to parsing a bitcode buffer.
   /// \returns true if an error occurred.
   Error parseBitcodeInto(Module *M, bool ShouldLazyLoadMetadata = false,
-                         bool IsImporting = false);
+                         bool IsImporting = false,
+                         LazyMetadataIndexCache *MetadataIndexCache = nullptr);
 
   static uint64_t decodeSignRotatedValue(uint64_t V);
 
@@ -3656,11 +3657,13 @@ Error BitcodeReader::parseModule(uint64_t ResumeBit,
   }
 }
 
-Error BitcodeReader::parseBitcodeInto(Module *M, bool ShouldLazyLoadMetadata,
-                                      bool IsImporting) {
+Error BitcodeReader::parseBitcodeInto(
+    Module *M, bool ShouldLazyLoadMetadata, bool IsImporting,
+    LazyMetadataIndexCache *MetadataIndexCache) {
   TheModule = M;
-  MDLoader = MetadataLoader(Stream, *M, ValueList, IsImporting,
-                            [&](unsigned ID) { return getTypeByID(ID); });
+  MDLoader = MetadataLoader(
+      Stream, *M, ValueList, IsImporting,
+      [&](unsigned ID) { return getTypeByID(ID); }, MetadataIndexCache);
   return parseModule(0, ShouldLazyLoadMetadata);
 }
 
@@ -5218,6 +5221,12 @@ SyncScope::ID BitcodeReader::getDecodedSyncScopeID(unsigned Val) {
 // GVMaterializer implementation
 //===----------------------------------------------------------------------===//
 
+// FIXME: Function bodies are parsed one at a time, on the calling thread.
+// Parsing them concurrently would need more than separate bitstream cursors:
+// parseFunctionBody() creates instructions that use module-level constants and
+// globals, which updates their use lists, and it shares ValueList and
+// MetadataList with the module-level parser. Neither is thread-safe, even with
+// LLVMContext::setThreadSafeUniquing().
 Error BitcodeReader::materialize(GlobalValue *GV) {
   Function *F = dyn_cast<Function>(GV);
   // If it's not a function or is already material, ignore the request.
@@ -6439,6 +6448,13 @@ llvm::getBitcodeFileContents(MemoryBufferRef Buffer) {
 ///
 /// \param[in] MaterializeAll Set to \c true if we should materialize
 /// everything.
+BitcodeModule::BitcodeModule(ArrayRef<uint8_t> Buffer,
+                             StringRef ModuleIdentifier,
+                             uint64_t IdentificationBit, uint64_t ModuleBit)
+    : Buffer(Buffer), ModuleIdentifier(ModuleIdentifier),
+      IdentificationBit(IdentificationBit), ModuleBit(ModuleBit),
+      MetadataIndexCache(std::make_shared<LazyMetadataIndexCache>()) {}
+
 Expected<std::unique_ptr<Module>>
 BitcodeModule::getModuleImpl(LLVMContext &Context, bool MaterializeAll,
                              bool ShouldLazyLoadMetadata, bool IsImporting) {
@@ -6466,8 +6482,8 @@ BitcodeModule::getModuleImpl(LLVMContext &Context, bool MaterializeAll,
   M->setMaterializer(R);
 
   // Delay parsing Metadata if ShouldLazyLoadMetadata is true.
-  if (Error Err =
-          R->parseBitcodeInto(M.get(), ShouldLazyLoadMetadata, IsImporting))
+  if (Error Err = R->parseBitcodeInto(M.get(), ShouldLazyLoadMetadata,
+                                     IsImporting, MetadataIndexCache.get()))
     return std::move(Err);
 
   if (MaterializeAll) {
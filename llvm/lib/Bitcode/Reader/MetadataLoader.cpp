@@ -89,6 +89,8 @@ using namespace llvm;
 STATISTIC(NumMDStringLoaded, "Number of MDStrings loaded");
 STATISTIC(NumMDNodeTemporary, "Number of MDNode::Temporary created");
 STATISTIC(NumMDRecordLoaded, "Number of Metadata records loaded");
+STATISTIC(NumMDIndexShared,
+          "Number of lazy-loading metadata indexes shared between readers");
 
 /// Flag whether we need to import full type definitions for ThinLTO.
 /// Currently needed for Darwin and LLDB.
@@ -432,19 +434,24 @@ class MetadataLoader::MetadataLoaderImpl {
   BitstreamCursor IndexCursor;
 
   /// Index that keeps track of MDString values.
-  std::vector<StringRef> MDStringRef;
+  ArrayRef<StringRef> MDStringRef;
 
   /// On-demand loading of a single MDString. Requires the index above to be
   /// populated.
   MDString *lazyLoadOneMDString(unsigned Idx);
 
   /// Index that keeps track of where to find a metadata record in the stream.
-  std::vector<uint64_t> GlobalMetadataBitPosIndex;
+  ArrayRef<uint64_t> GlobalMetadataBitPosIndex;
 
-  /// Populate the index above to enable lazily loading of metadata, and load
-  /// the named metadata as well as the transitively referenced global
-  /// Metadata.
-  Expected<bool> lazyLoadModuleMetadataBlock();
+  /// The storage of the indexes above, shared with the other readers of the
+  /// same bitcode module through IndexCache.
+  std::shared_ptr<const LazyMetadataIndex> LazyIndex;
+  LazyMetadataIndexCache *IndexCache;
+
+  /// Populate the indexes above to enable lazily loading of the metadata
+  /// block at \p BlockBit, and load the named metadata as well as the
+  /// transitively referenced global Metadata.
+  Expected<bool> lazyLoadModuleMetadataBlock(uint64_t BlockBit);
 
   /// On-demand loading of a single metadata. Requires the index above to be
   /// populated.
@@ -635,11 +642,11 @@ public:
   MetadataLoaderImpl(BitstreamCursor &Stream, Module &TheModule,
                      BitcodeReaderValueList &ValueList,
                      std::function<Type *(unsigned)> getTypeByID,
-                     bool IsImporting)
+                     bool IsImporting, LazyMetadataIndexCache *IndexCache)
       : MetadataList(TheModule.getContext(), Stream.SizeInBytes()),
         ValueList(ValueList), Stream(Stream), Context(TheModule.getContext()),
         TheModule(TheModule), getTypeByID(std::move(getTypeByID)),
-        IsImporting(IsImporting) {}
+        IndexCache(IndexCache), IsImporting(IsImporting) {}
 
   Error parseMetadata(bool ModuleLevel);
 
@@ -681,9 +688,21 @@ public:
 };
 
 Expected<bool>
-MetadataLoader::MetadataLoaderImpl::lazyLoadModuleMetadataBlock() {
+MetadataLoader::MetadataLoaderImpl::lazyLoadModuleMetadataBlock(
+    uint64_t BlockBit) {
   IndexCursor = Stream;
   SmallVector<uint64_t, 64> Record;
+  // Reuse the strings and the record positions if another reader already
+  // decoded them, and only read the records that are loaded eagerly.
+  std::shared_ptr<const LazyMetadataIndex> SharedIndex =
+      IndexCache ? IndexCache->lookup(BlockBit) : nullptr;
+  std::shared_ptr<LazyMetadataIndex> NewIndex;
+  if (SharedIndex) {
+    ++NumMDIndexShared;
+  } else {
+    NewIndex = std::make_shared<LazyMetadataIndex>();
+    NewIndex->BlockBit = BlockBit;
+  }
   // Get the abbrevs, and preload record positions to make them lazy-loadable.
   while (true) {
     Expected<BitstreamEntry> MaybeEntry = IndexCursor.advanceSkippingSubblocks(
@@ -697,6 +716,14 @@ MetadataLoader::MetadataLoaderImpl::lazyLoadModuleMetadataBlock() {
     case BitstreamEntry::Error:
       return error("Malformed block");
     case BitstreamEntry::EndBlock: {
+      if (NewIndex) {
+        if (IndexCache)
+          IndexCache->insert(NewIndex);
+        SharedIndex = std::move(NewIndex);
+      }
+      LazyIndex = std::move(SharedIndex);
+      MDStringRef = LazyIndex->MDStrings;
+      GlobalMetadataBitPosIndex = LazyIndex->RecordBitPos;
       return true;
     }
     case BitstreamEntry::Record: {
@@ -709,6 +736,8 @@ MetadataLoader::MetadataLoaderImpl::lazyLoadModuleMetadataBlock() {
       unsigned Code = MaybeCode.get();
       switch (Code) {
       case bitc::METADATA_STRINGS: {
+        if (SharedIndex)
+          break;
         // Rewind and parse the strings.
         if (Error Err = IndexCursor.JumpToBit(CurrentPos))
           return std::move(Err);
@@ -720,9 +749,9 @@ MetadataLoader::MetadataLoaderImpl::lazyLoadModuleMetadataBlock() {
         else
           return MaybeRecord.takeError();
         unsigned NumStrings = Record[0];
-        MDStringRef.reserve(NumStrings);
+        NewIndex->MDStrings.reserve(NumStrings);
         auto IndexNextMDString = [&](StringRef Str) {
-          MDStringRef.push_back(Str);
+          NewIndex->MDStrings.push_back(Str);
         };
         if (auto Err = parseMetadataStrings(Record, Blob, IndexNextMDString))
           return std::move(Err);
@@ -754,6 +783,11 @@ MetadataLoader::MetadataLoaderImpl::lazyLoadModuleMetadataBlock() {
         assert(Entry.Kind == BitstreamEntry::Record &&
                "Corrupted bitcode: Expected `Record` when trying to find the "
                "Metadata index");
+        if (SharedIndex) {
+          if (Error Err = IndexCursor.JumpToBit(SharedIndex->IndexEndBit))
+            return std::move(Err);
+          break;
+        }
         Record.clear();
         if (Expected<unsigned> MaybeCode =
                 IndexCursor.readRecord(Entry.ID, Record))
@@ -764,11 +798,12 @@ MetadataLoader::MetadataLoaderImpl::lazyLoadModuleMetadataBlock() {
           return MaybeCode.takeError();
         // Delta unpack
         auto CurrentValue = BeginPos;
-        GlobalMetadataBitPosIndex.reserve(Record.size());
+        NewIndex->RecordBitPos.reserve(Record.size());
         for (auto &Elt : Record) {
           CurrentValue += Elt;
-          GlobalMetadataBitPosIndex.push_back(CurrentValue);
+          NewIndex->RecordBitPos.push_back(CurrentValue);
         }
+        NewIndex->IndexEndBit = IndexCursor.GetCurrentBitNo();
         break;
       }
       case bitc::METADATA_INDEX:
@@ -877,8 +912,6 @@ MetadataLoader::MetadataLoaderImpl::lazyLoadModuleMetadataBlock() {
       case bitc::METADATA_GLOBAL_VAR_EXPR:
         // We don't expect to see any of these, if we see one, give up on
         // lazy-loading and fallback.
-        MDStringRef.clear();
-        GlobalMetadataBitPosIndex.clear();
         return false;
       }
       break;
@@ -907,7 +940,7 @@ Error MetadataLoader::MetadataLoaderImpl::parseMetadata(bool ModuleLevel) {
   // then load individual record as needed, starting with the named metadata.
   if (ModuleLevel && IsImporting && MetadataList.empty() &&
       !DisableLazyLoading) {
-    auto SuccessOrErr = lazyLoadModuleMetadataBlock();
+    auto SuccessOrErr = lazyLoadModuleMetadataBlock(EntryPos);
     if (!SuccessOrErr)
       return SuccessOrErr.takeError();
     if (SuccessOrErr.get()) {
@@ -2132,9 +2165,11 @@ MetadataLoader::~MetadataLoader() = default;
 MetadataLoader::MetadataLoader(BitstreamCursor &Stream, Module &TheModule,
                                BitcodeReaderValueList &ValueList,
                                bool IsImporting,
-                               std::function<Type *(unsigned)> getTypeByID)
-    : Pimpl(std::make_unique<MetadataLoaderImpl>(
-          Stream, TheModule, ValueList, std::move(getTypeByID), IsImporting)) {}
+                               std::function<Type *(unsigned)> getTypeByID,
+                               LazyMetadataIndexCache *IndexCache)
+    : Pimpl(std::make_unique<MetadataLoaderImpl>(Stream, TheModule, ValueList,
+                                                 std::move(getTypeByID),
+                                                 IsImporting, IndexCache)) {}
 
 Error MetadataLoader::parseMetadata(bool ModuleLevel) {
   return Pimpl->parseMetadata(ModuleLevel);
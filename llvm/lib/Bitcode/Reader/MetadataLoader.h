@@ -14,10 +14,13 @@
 #define LLVM_LIB_BITCODE_READER_METADATALOADER_H
 
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace llvm {
 class BitcodeReaderValueList;
@@ -31,6 +34,47 @@ class MDNode;
 class Module;
 class Type;
 
+/// The index of a module-level metadata block built to lazily load it. It only
+/// depends on the bitcode: the strings point into the bitcode buffer.
+struct LazyMetadataIndex {
+  /// The bit position of the metadata block.
+  uint64_t BlockBit = 0;
+
+  /// The bit position right after the METADATA_INDEX record, where the
+  /// records that are not lazily loaded start.
+  uint64_t IndexEndBit = 0;
+
+  /// The MDStrings, which come first in the metadata IDs.
+  std::vector<StringRef> MDStrings;
+
+  /// The bit position of the records of the other metadata.
+  std::vector<uint64_t> RecordBitPos;
+};
+
+/// Shares the index of the module-level metadata block of a bitcode module
+/// between the readers that lazily load it, possibly from several threads.
+class LazyMetadataIndexCache {
+  std::mutex Mutex;
+  std::shared_ptr<const LazyMetadataIndex> Index;
+
+public:
+  /// Return the index of the metadata block at \p BlockBit, or null if it was
+  /// not built yet.
+  std::shared_ptr<const LazyMetadataIndex> lookup(uint64_t BlockBit) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (Index && Index->BlockBit == BlockBit)
+      return Index;
+    return nullptr;
+  }
+
+  /// Record \p NewIndex, unless another reader already did.
+  void insert(std::shared_ptr<const LazyMetadataIndex> NewIndex) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (!Index)
+      Index = std::move(NewIndex);
+  }
+};
+
 /// Helper class that handles loading Metadatas and keeping them available.
 class MetadataLoader {
   class MetadataLoaderImpl;
@@ -41,7 +85,8 @@ public:
   ~MetadataLoader();
   MetadataLoader(BitstreamCursor &Stream, Module &TheModule,
                  BitcodeReaderValueList &ValueList, bool IsImporting,
-                 std::function<Type *(unsigned)> getTypeByID);
+                 std::function<Type *(unsigned)> getTypeByID,
+                 LazyMetadataIndexCache *IndexCache = nullptr);
   MetadataLoader &operator=(MetadataLoader &&);
   MetadataLoader(MetadataLoader &&);
 
@@ -86,6 +86,10 @@ static cl::opt<unsigned>
                    cl::desc("Number of metadatas above which we emit an index "
                             "to enable lazy-loading"));
 
+static cl::opt<uint32_t> FlushThreshold(
+    "bitcode-flush-threshold", cl::Hidden, cl::init(512),
+    cl::desc("The threshold (unit M) for flushing LLVM bitcode."));
+
 static cl::opt<bool> WriteRelBFToSummary(
     "write-relbf-to-summary", cl::Hidden, cl::init(false),
     cl::desc("Write relative block frequency to function summary "));
@@ -4355,8 +4359,9 @@ static void writeBitcodeHeader(BitstreamWriter &Stream) {
   Stream.Emit(0xD, 4);
 }
 
-BitcodeWriter::BitcodeWriter(SmallVectorImpl<char> &Buffer)
-    : Buffer(Buffer), Stream(new BitstreamWriter(Buffer)) {
+BitcodeWriter::BitcodeWriter(SmallVectorImpl<char> &Buffer, raw_fd_stream *FS)
+    : Buffer(Buffer), FS(FS),
+      Stream(new BitstreamWriter(Buffer, FS, FlushThreshold)) {
   writeBitcodeHeader(*Stream);
 }
 
@@ -4431,6 +4436,8 @@ void BitcodeWriter::writeModule(const Module &M,
                                 const ModuleSummaryIndex *Index,
                                 bool GenerateHash, ModuleHash *ModHash) {
   assert(!WroteStrtab);
+  assert(!(GenerateHash && FS) &&
+         "Cannot generate a module hash while streaming to a file");
 
   // The Mods vector is used by irsymtab::build, which requires non-const
   // Modules in case it needs to materialize metadata. But the bitcode writer
@@ -4464,20 +4471,29 @@ void llvm::WriteBitcodeToFile(const Module &M, raw_ostream &Out,
   // If this is darwin or another generic macho target, reserve space for the
   // header.
   Triple TT(M.getTargetTriple());
-  if (TT.isOSDarwin() || TT.isOSBinFormatMachO())
+  bool IsMachO = TT.isOSDarwin() || TT.isOSBinFormatMachO();
+  if (IsMachO)
     Buffer.insert(Buffer.begin(), BWH_HeaderSize, 0);
 
-  BitcodeWriter Writer(Buffer);
+  // If the output is a file that can be read back and patched, flush the
+  // bitcode to it as blocks complete instead of holding all of it in memory.
+  // The module hash and the Darwin wrapper header are computed from the whole
+  // buffer, so those still need the bitcode in memory.
+  raw_fd_stream *FS = nullptr;
+  if (!GenerateHash && !IsMachO)
+    FS = dyn_cast<raw_fd_stream>(&Out);
+
+  BitcodeWriter Writer(Buffer, FS);
   Writer.writeModule(M, ShouldPreserveUseListOrder, Index, GenerateHash,
                      ModHash);
   Writer.writeSymtab();
   Writer.writeStrtab();
 
-  if (TT.isOSDarwin() || TT.isOSBinFormatMachO())
+  if (IsMachO)
     emitDarwinBCHeaderAndTrailer(Buffer, TT);
 
   // Write the generated bitstream to "Out".
-  Out.write((char*)&Buffer.front(), Buffer.size());
+  Out.write(Buffer.data(), Buffer.size());
 }
 
 void IndexBitcodeWriter::write() {
@@ -4504,11 +4520,11 @@ void llvm::WriteIndexToFile(
   SmallVector<char, 0> Buffer;
   Buffer.reserve(256 * 1024);
 
-  BitcodeWriter Writer(Buffer);
+  BitcodeWriter Writer(Buffer, dyn_cast<raw_fd_stream>(&Out));
   Writer.writeIndex(&Index, ModuleToSummariesForIndex);
   Writer.writeStrtab();
 
-  Out.write((char *)&Buffer.front(), Buffer.size());
+  Out.write(Buffer.data(), Buffer.size());
 }
 
 namespace {
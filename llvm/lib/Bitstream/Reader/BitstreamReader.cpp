@@ -8,7 +8,9 @@
 
 #include "llvm/Bitstream/BitstreamReader.h"
 #include "llvm/ADT/StringRef.h"
+#include <algorithm>
 #include <cassert>
+#include <climits>
 #include <string>
 
 using namespace llvm;
@@ -119,6 +121,17 @@ static Error skipAbbreviatedField(BitstreamCursor &Cursor,
   return ErrorSuccess();
 }
 
+/// Make room in Vals for the NumElts elements of an array, each of which takes
+/// at least EltBits bits (a zero-width field still counts as one). A corrupt count only gets as much room as the rest of
+/// the stream could hold.
+static void reserveElements(const BitstreamCursor &Cursor,
+                            SmallVectorImpl<uint64_t> &Vals, uint64_t NumElts,
+                            unsigned EltBits) {
+  uint64_t BitsLeft =
+      Cursor.SizeInBytes() * CHAR_BIT - Cursor.GetCurrentBitNo();
+  Vals.reserve(Vals.size() + std::min(NumElts, BitsLeft / std::max(EltBits, 1u)));
+}
+
 /// skipRecord - Read the current record and discard it.
 Expected<unsigned> BitstreamCursor::skipRecord(unsigned AbbrevID) {
   // Skip unabbreviated records by reading past their entries.
@@ -244,6 +257,7 @@ Expected<unsigned> BitstreamCursor::readRecord(unsigned AbbrevID,
     if (!MaybeNumElts)
       return MaybeNumElts.takeError();
     uint32_t NumElts = MaybeNumElts.get();
+    reserveElements(*this, Vals, NumElts, 6);
 
     for (unsigned i = 0; i != NumElts; ++i)
       if (Expected<uint64_t> MaybeVal = ReadVBR64(6))
@@ -307,6 +321,7 @@ Expected<unsigned> BitstreamCursor::readRecord(unsigned AbbrevID,
       default:
         report_fatal_error("Array element type can't be an Array or a Blob");
       case BitCodeAbbrevOp::Fixed:
+        reserveElements(*this, Vals, NumElts, EltEnc.getEncodingData());
         for (; NumElts; --NumElts)
           if (Expected<SimpleBitstreamCursor::word_t> MaybeVal =
                   Read((unsigned)EltEnc.getEncodingData()))
@@ -315,6 +330,7 @@ Expected<unsigned> BitstreamCursor::readRecord(unsigned AbbrevID,
             return MaybeVal.takeError();
         break;
       case BitCodeAbbrevOp::VBR:
+        reserveElements(*this, Vals, NumElts, EltEnc.getEncodingData());
         for (; NumElts; --NumElts)
           if (Expected<uint64_t> MaybeVal =
                   ReadVBR64((unsigned)EltEnc.getEncodingData()))
@@ -323,6 +339,7 @@ Expected<unsigned> BitstreamCursor::readRecord(unsigned AbbrevID,
             return MaybeVal.takeError();
         break;
       case BitCodeAbbrevOp::Char6:
+        reserveElements(*this, Vals, NumElts, 6);
         for (; NumElts; --NumElts)
           if (Expected<SimpleBitstreamCursor::word_t> MaybeVal = Read(6))
             Vals.push_back(BitCodeAbbrevOp::DecodeChar6(MaybeVal.get()));
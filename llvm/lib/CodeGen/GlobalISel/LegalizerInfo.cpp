@@ -17,6 +17,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/CodeGen/GlobalISel/LegalizerInfo.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallBitVector.h"
 #include "llvm/CodeGen/GlobalISel/GISelChangeObserver.h"
 #include "llvm/CodeGen/MachineInstr.h"
@@ -42,6 +43,10 @@ cl::opt<bool> llvm::DisableGISelLegalityCheck(
     cl::desc("Don't verify that MIR is fully legal between GlobalISel passes"),
     cl::Hidden);
 
+static cl::opt<bool> CacheLegalityQueries(
+    "legalizer-cache-queries", cl::init(true), cl::Hidden,
+    cl::desc("Cache the legalizer actions of each distinct legality query"));
+
 raw_ostream &llvm::operator<<(raw_ostream &OS, LegalizeAction Action) {
   switch (Action) {
   case Legal:
@@ -283,6 +288,7 @@ LegalizerInfo::LegalizerInfo() : TablesInitialized(false) {
 
 void LegalizerInfo::computeTables() {
   assert(TablesInitialized == false);
+  ActionCache.clear();
 
   for (unsigned OpcodeIdx = 0; OpcodeIdx <= LastOp - FirstOp; ++OpcodeIdx) {
     const unsigned Opcode = FirstOp + OpcodeIdx;
@@ -452,8 +458,70 @@ void LegalizerInfo::aliasActionDefinitions(unsigned OpcodeTo,
   RulesForOpcode[OpcodeFromIdx].aliasTo(OpcodeTo);
 }
 
+unsigned
+LegalizerInfo::CachedQueryInfo::getHashValue(const CachedQuery &Key) {
+  hash_code Hash = hash_value(Key.Opcode);
+  for (unsigned I = 0; I != Key.NumTypes; ++I)
+    Hash = hash_combine(Hash, DenseMapInfo<LLT>::getHashValue(Key.Types[I]));
+  for (unsigned I = 0; I != Key.NumMemDescs; ++I) {
+    const LegalityQuery::MemDesc &MMO = Key.MMODescrs[I];
+    Hash = hash_combine(Hash, MMO.SizeInBits, MMO.AlignInBits,
+                        unsigned(MMO.Ordering));
+  }
+  return Hash;
+}
+
+bool LegalizerInfo::CachedQueryInfo::isEqual(const CachedQuery &LHS,
+                                             const CachedQuery &RHS) {
+  if (LHS.Opcode != RHS.Opcode || LHS.NumTypes != RHS.NumTypes ||
+      LHS.NumMemDescs != RHS.NumMemDescs)
+    return false;
+  for (unsigned I = 0; I != LHS.NumTypes; ++I)
+    if (LHS.Types[I] != RHS.Types[I])
+      return false;
+  for (unsigned I = 0; I != LHS.NumMemDescs; ++I) {
+    const LegalityQuery::MemDesc &L = LHS.MMODescrs[I];
+    const LegalityQuery::MemDesc &R = RHS.MMODescrs[I];
+    if (L.SizeInBits != R.SizeInBits || L.AlignInBits != R.AlignInBits ||
+        L.Ordering != R.Ordering)
+      return false;
+  }
+  return true;
+}
+
+bool LegalizerInfo::getCachedQuery(const LegalityQuery &Query,
+                                   CachedQuery &Key) {
+  if (Query.Types.size() > CachedQuery::MaxTypes ||
+      Query.MMODescrs.size() > CachedQuery::MaxMemDescs)
+    return false;
+  Key.Opcode = Query.Opcode;
+  Key.NumTypes = Query.Types.size();
+  Key.NumMemDescs = Query.MMODescrs.size();
+  std::copy(Query.Types.begin(), Query.Types.end(), Key.Types);
+  std::copy(Query.MMODescrs.begin(), Query.MMODescrs.end(), Key.MMODescrs);
+  return true;
+}
+
 LegalizeActionStep
 LegalizerInfo::getAction(const LegalityQuery &Query) const {
+  CachedQuery Key;
+  if (!CacheLegalityQueries || !getCachedQuery(Query, Key))
+    return computeAction(Query);
+
+  auto It = ActionCache.find(Key);
+  if (It != ActionCache.end()) {
+    LLVM_DEBUG(dbgs() << ".. cached: " << It->second.Action << ", "
+                      << It->second.TypeIdx << ", " << It->second.NewType
+                      << "\n");
+    return It->second;
+  }
+  LegalizeActionStep Step = computeAction(Query);
+  ActionCache.insert({Key, Step});
+  return Step;
+}
+
+LegalizeActionStep
+LegalizerInfo::computeAction(const LegalityQuery &Query) const {
   LegalizeActionStep Step = getActionDefinitions(Query.Opcode).apply(Query);
   if (Step.Action != LegalizeAction::UseLegacyRules) {
     return Step;
@@ -478,7 +546,6 @@ LegalizerInfo::getAction(const MachineInstr &MI,
   SmallVector<LLT, 2> Types;
   SmallBitVector SeenTypes(8);
   const MCOperandInfo *OpInfo = MI.getDesc().OpInfo;
-  // FIXME: probably we'll need to cache the results here somehow?
   for (unsigned i = 0; i < MI.getDesc().getNumOperands(); ++i) {
     if (!OpInfo[i].isGenericType())
       continue;
@@ -71,6 +71,7 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/SuffixArray.h"
 #include "llvm/Support/raw_ostream.h"
 #include <functional>
 #include <tuple>
@@ -96,6 +97,14 @@ static cl::opt<bool> EnableLinkOnceODROutlining(
     cl::desc("Enable the machine outliner on linkonceodr functions"),
     cl::init(false));
 
+// The suffix array finds the same repeated sequences as the suffix tree with
+// a fraction of its memory, which matters for large modules in (Thin)LTO.
+static cl::opt<bool> UseSuffixArray(
+    "outliner-use-suffix-array", cl::Hidden,
+    cl::desc("Find repeated sequences with a suffix array instead of a "
+             "suffix tree"),
+    cl::init(false));
+
 namespace {
 
 /// Represents an undefined index in the suffix tree.
@@ -219,13 +228,7 @@ public:
   ArrayRef<unsigned> Str;
 
   /// A repeated substring in the tree.
-  struct RepeatedSubstring {
-    /// The length of the string.
-    unsigned Length;
-
-    /// The start indices of each occurrence.
-    std::vector<unsigned> StartIndices;
-  };
+  using RepeatedSubstring = llvm::RepeatedSubstring;
 
 private:
   /// Maintains each node in the tree.
@@ -1007,14 +1010,22 @@ void
 MachineOutliner::findCandidates(InstructionMapper &Mapper,
                                 std::vector<OutlinedFunction> &FunctionList) {
   FunctionList.clear();
-  SuffixTree ST(Mapper.UnsignedVec);
 
   // First, find dall of the repeated substrings in the tree of minimum length
   // 2.
+  std::vector<RepeatedSubstring> RepeatedSubstrings;
+  if (UseSuffixArray) {
+    RepeatedSubstrings =
+        SuffixArray(Mapper.UnsignedVec).findRepeatedSubstrings(2);
+  } else {
+    SuffixTree ST(Mapper.UnsignedVec);
+    for (auto It = ST.begin(), Et = ST.end(); It != Et; ++It)
+      RepeatedSubstrings.push_back(std::move(*It));
+  }
+
   std::vector<Candidate> CandidatesForRepeatedSeq;
-  for (auto It = ST.begin(), Et = ST.end(); It != Et; ++It) {
+  for (const RepeatedSubstring &RS : RepeatedSubstrings) {
     CandidatesForRepeatedSeq.clear();
-    SuffixTree::RepeatedSubstring RS = *It;
     unsigned StringLen = RS.Length;
     for (const unsigned &StartIdx : RS.StartIndices) {
       unsigned EndIdx = StartIdx + StringLen - 1;
@@ -18,6 +18,7 @@
 #include "llvm/ADT/PriorityQueue.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/CodeGen/LiveInterval.h"
@@ -56,6 +57,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/GraphWriter.h"
 #include "llvm/Support/MachineValueType.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -72,6 +74,11 @@ using namespace llvm;
 
 #define DEBUG_TYPE "machine-scheduler"
 
+STATISTIC(NumRegionsPartitioned,
+          "Number of scheduling regions split for exceeding the size limit");
+STATISTIC(NumFastRegions,
+          "Number of scheduling regions scheduled with the fast heuristic");
+
 namespace llvm {
 
 cl::opt<bool> ForceTopDown("misched-topdown", cl::Hidden,
@@ -126,6 +133,21 @@ static cl::opt<bool> EnableMemOpCluster("misched-cluster", cl::Hidden,
                                         cl::desc("Enable memop clustering."),
                                         cl::init(true));
 
+/// Avoid quadratic complexity in huge straight-line blocks by splitting their
+/// scheduling regions. The instruction between two parts of a region stays in
+/// place, like a scheduling boundary.
+static cl::opt<unsigned> MaxRegionInstrs("misched-max-region-instrs",
+  cl::Hidden, cl::init(0),
+  cl::desc("Split scheduling regions into parts of at most N instructions "
+           "(0 = no limit)"));
+
+/// Above this size, the generic scheduler only schedules bottom-up and does
+/// not track register pressure.
+static cl::opt<unsigned> FastRegionInstrs("misched-fast-region-instrs",
+  cl::Hidden, cl::init(0),
+  cl::desc("Use a cheaper scheduling heuristic for regions of more than N "
+           "instructions (0 = never)"));
+
 // DAG subtrees must have at least this many nodes.
 static const unsigned MinSubtreeSize = 8;
 
@@ -488,6 +510,13 @@ getSchedRegions(MachineBasicBlock *MBB,
       MachineInstr &MI = *std::prev(I);
       if (isSchedBoundary(&MI, &*MBB, MF, TII))
         break;
+      // Once this part of the region is full, the next instruction ends the
+      // part above it.
+      if (MaxRegionInstrs && NumRegionInstrs == MaxRegionInstrs &&
+          !MI.isDebugInstr()) {
+        ++NumRegionsPartitioned;
+        break;
+      }
       if (!MI.isDebugInstr()) {
         // MBB::size() uses instr_iterator to count. Here we need a bundle to
         // count as a single instruction.
@@ -573,7 +602,16 @@ void MachineSchedulerBase::scheduleRegions(ScheduleDAGInstrs &Scheduler,
 
       // Schedule a region: possibly reorder instructions.
       // This invalidates the original region iterators.
-      Scheduler.schedule();
+      {
+        TimeTraceScope Scope("MachineSchedulerRegion", [&] {
+          std::string Detail;
+          raw_string_ostream OS(Detail);
+          OS << MF->getName() << ':' << printMBBReference(*MBB) << " ("
+             << NumRegionInstrs << " instrs)";
+          return OS.str();
+        });
+        Scheduler.schedule();
+      }
 
       // Close the current region.
       Scheduler.exitRegion();
@@ -2774,6 +2812,16 @@ void GenericScheduler::initPolicy(MachineBasicBlock::iterator Begin,
     RegionPolicy.ShouldTrackLaneMasks = false;
   }
 
+  // Huge regions are scheduled in one direction without pressure tracking,
+  // which would otherwise dominate their scheduling time.
+  if (FastRegionInstrs && NumRegionInstrs > FastRegionInstrs) {
+    ++NumFastRegions;
+    RegionPolicy.ShouldTrackPressure = false;
+    RegionPolicy.ShouldTrackLaneMasks = false;
+    RegionPolicy.OnlyBottomUp = true;
+    RegionPolicy.OnlyTopDown = false;
+  }
+
   // Check -misched-topdown/bottomup can force or unforce scheduling direction.
   // e.g. -misched-bottomup=false allows scheduling in both directions.
   assert((!ForceTopDown || !ForceBottomUp) &&
@@ -66,6 +66,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
@@ -84,6 +85,10 @@ using namespace llvm;
 STATISTIC(NumGlobalSplits, "Number of split global live ranges");
 STATISTIC(NumLocalSplits,  "Number of split local live ranges");
 STATISTIC(NumEvicted,      "Number of interferences evicted");
+STATISTIC(NumSpilled,      "Number of live ranges spilled");
+STATISTIC(NumSplitsCapped, "Number of live ranges spilled without splitting "
+                           "in fast mode");
+STATISTIC(NumEvictionChainsCut, "Number of evictions refused in fast mode");
 
 static cl::opt<SplitEditor::ComplementSpillMode> SplitSpillMode(
     "split-spill-mode", cl::Hidden,
@@ -136,6 +141,23 @@ CSRFirstTimeCost("regalloc-csr-first-time-cost",
               cl::desc("Cost for first time use of callee-saved register."),
               cl::init(0), cl::Hidden);
 
+static cl::opt<bool> FastGreedy(
+    "fast-greedy", cl::Hidden,
+    cl::desc("Bound the splitting and eviction work for each live range, "
+             "trading allocation quality for compile time"),
+    cl::init(false));
+
+static cl::opt<unsigned> FastGreedyMaxSplits(
+    "fast-greedy-max-splits", cl::Hidden,
+    cl::desc("Maximum number of times a live range and the ranges split from "
+             "it are split in fast mode"),
+    cl::init(2));
+
+static cl::opt<unsigned> FastGreedyMaxEvictions(
+    "fast-greedy-max-evictions", cl::Hidden,
+    cl::desc("Maximum length of an eviction chain in fast mode"),
+    cl::init(4));
+
 static cl::opt<bool> ConsiderLocalIntervalCost(
     "consider-local-interval-cost", cl::Hidden,
     cl::desc("Consider the cost of local intervals created by a split "
@@ -247,6 +269,12 @@ class RAGreedy : public MachineFunctionPass,
     // Cascade - Eviction loop prevention. See canEvictInterference().
     unsigned Cascade = 0;
 
+    // Splits - The number of splits that produced this live range, and
+    // EvictionDepth - the number of evictions that led to its eviction. Both
+    // are only bounded in fast mode.
+    unsigned Splits = 0;
+    unsigned EvictionDepth = 0;
+
     RegInfo() = default;
   };
 
@@ -889,6 +917,12 @@ bool RAGreedy::canEvictInterference(LiveInterval &VirtReg, unsigned PhysReg,
   if (!Cascade)
     Cascade = NextCascade;
 
+  // In fast mode, a live range that was evicted at the end of a long enough
+  // eviction chain may not extend it further, unless it is urgent.
+  bool EndsEvictionChain =
+      FastGreedy &&
+      ExtraRegInfo[VirtReg.reg].EvictionDepth >= FastGreedyMaxEvictions;
+
   EvictionCost Cost;
   for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units) {
     LiveIntervalUnion::Query &Q = Matrix->query(VirtReg, *Units);
@@ -921,6 +955,10 @@ bool RAGreedy::canEvictInterference(LiveInterval &VirtReg, unsigned PhysReg,
         (Intf->isSpillable() ||
          RegClassInfo.getNumAllocatableRegs(MRI->getRegClass(VirtReg.reg)) <
          RegClassInfo.getNumAllocatableRegs(MRI->getRegClass(Intf->reg)));
+      if (EndsEvictionChain && !Urgent) {
+        ++NumEvictionChainsCut;
+        return false;
+      }
       // Only evict older cascades or live ranges without a cascade.
       unsigned IntfCascade = ExtraRegInfo[Intf->reg].Cascade;
       if (Cascade <= IntfCascade) {
@@ -1084,6 +1122,8 @@ void RAGreedy::evictInterference(LiveInterval &VirtReg, unsigned PhysReg,
             VirtReg.isSpillable() < Intf->isSpillable()) &&
            "Cannot decrease cascade number, illegal eviction");
     ExtraRegInfo[Intf->reg].Cascade = Cascade;
+    ExtraRegInfo[Intf->reg].EvictionDepth =
+        ExtraRegInfo[VirtReg.reg].EvictionDepth + 1;
     ++NumEvicted;
     NewVRegs.push_back(Intf->reg);
   }
@@ -1110,6 +1150,7 @@ unsigned RAGreedy::tryEvict(LiveInterval &VirtReg,
                             const SmallVirtRegSet &FixedRegisters) {
   NamedRegionTimer T("evict", "Evict", TimerGroupName, TimerGroupDescription,
                      TimePassesIsEnabled);
+  TimeTraceScope TimeScope("RegAllocEvict");
 
   // Keep track of the cheapest interference seen so far.
   EvictionCost BestCost;
@@ -2468,6 +2509,7 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
   if (LIS->intervalIsInOneMBB(VirtReg)) {
     NamedRegionTimer T("local_split", "Local Splitting", TimerGroupName,
                        TimerGroupDescription, TimePassesIsEnabled);
+    TimeTraceScope TimeScope("RegAllocLocalSplit");
     SA->analyze(&VirtReg);
     unsigned PhysReg = tryLocalSplit(VirtReg, Order, NewVRegs);
     if (PhysReg || !NewVRegs.empty())
@@ -2477,6 +2519,7 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
 
   NamedRegionTimer T("global_split", "Global Splitting", TimerGroupName,
                      TimerGroupDescription, TimePassesIsEnabled);
+  TimeTraceScope TimeScope("RegAllocGlobalSplit");
 
   SA->analyze(&VirtReg);
 
@@ -3093,13 +3136,23 @@ unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
     return 0;
   }
 
-  if (Stage < RS_Spill) {
+  // In fast mode, spill live ranges that were split often enough already.
+  // Unspillable ranges must still be split to make progress.
+  if (FastGreedy && Stage < RS_Spill && VirtReg.isSpillable() &&
+      ExtraRegInfo[VirtReg.reg].Splits >= FastGreedyMaxSplits) {
+    LLVM_DEBUG(dbgs() << "split too often, spilling\n");
+    ++NumSplitsCapped;
+  } else if (Stage < RS_Spill) {
     // Try splitting VirtReg or interferences.
     unsigned NewVRegSizeBefore = NewVRegs.size();
     unsigned PhysReg = trySplit(VirtReg, Order, NewVRegs, FixedRegisters);
     if (PhysReg || (NewVRegs.size() - NewVRegSizeBefore)) {
       // If VirtReg got split, the eviction info is no longre relevant.
       LastEvicted.clearEvicteeInfo(VirtReg.reg);
+      unsigned Splits = ExtraRegInfo[VirtReg.reg].Splits + 1;
+      ExtraRegInfo.resize(MRI->getNumVirtRegs());
+      for (unsigned I = NewVRegSizeBefore, E = NewVRegs.size(); I != E; ++I)
+        ExtraRegInfo[NewVRegs[I]].Splits = Splits;
       return PhysReg;
     }
   }
@@ -3122,8 +3175,10 @@ unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
   } else {
     NamedRegionTimer T("spill", "Spiller", TimerGroupName,
                        TimerGroupDescription, TimePassesIsEnabled);
+    TimeTraceScope TimeScope("RegAllocSpill");
     LiveRangeEdit LRE(&VirtReg, NewVRegs, *MF, *LIS, VRM, this, &DeadRemats);
     spiller().spill(LRE);
+    ++NumSpilled;
     setStage(NewVRegs.begin(), NewVRegs.end(), RS_Done);
 
     if (VerifyEnabled)
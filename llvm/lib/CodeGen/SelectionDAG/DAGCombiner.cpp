@@ -57,14 +57,18 @@
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/KnownBits.h"
 #include "llvm/Support/MachineValueType.h"
+#include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <iterator>
@@ -77,6 +81,8 @@ using namespace llvm;
 #define DEBUG_TYPE "dagcombine"
 
 STATISTIC(NodesCombined   , "Number of dag nodes combined");
+STATISTIC(NodesVisited    , "Number of dag nodes visited by the combiner");
+STATISTIC(MaxNodesVisited , "Largest number of dag nodes visited in one run");
 STATISTIC(PreIndexedNodes , "Number of pre-indexed nodes created");
 STATISTIC(PostIndexedNodes, "Number of post-indexed nodes created");
 STATISTIC(OpsNarrowed     , "Number of load/op/store narrowed");
@@ -124,6 +130,91 @@ static cl::opt<unsigned> StoreMergeDependenceLimit(
     cl::desc("Limit the number of times for the same StoreNode and RootNode "
              "to bail out in store merging dependence check"));
 
+static cl::opt<bool> ProfileCombines(
+    "combiner-profile", cl::Hidden, cl::init(false),
+    cl::desc("Report how often the DAG combiner visits the nodes of each "
+             "opcode, how often it changes them, and the time spent on them"));
+
+namespace {
+
+/// The DAG combiner counters of one opcode, for -combiner-profile.
+struct CombineProfileEntry {
+  std::string Name;
+  uint64_t Visits = 0;
+  uint64_t Hits = 0;
+  double Seconds = 0;
+};
+
+using CombineProfileMap = DenseMap<unsigned, CombineProfileEntry>;
+
+/// The counters of all DAG combiner runs in the process, which are reported
+/// on shutdown like the timers.
+class CombineProfile {
+  sys::SmartMutex<true> Lock;
+  CombineProfileMap Entries;
+
+public:
+  ~CombineProfile() { print(); }
+
+  /// Add the counters of one run, which may happen on any thread.
+  void merge(const CombineProfileMap &RunEntries);
+
+  void print();
+};
+
+} // end anonymous namespace
+
+static ManagedStatic<CombineProfile> TheCombineProfile;
+
+void CombineProfile::merge(const CombineProfileMap &RunEntries) {
+  sys::SmartScopedLock<true> Guard(Lock);
+  for (const auto &KV : RunEntries) {
+    CombineProfileEntry &E = Entries[KV.first];
+    if (E.Name.empty())
+      E.Name = KV.second.Name;
+    E.Visits += KV.second.Visits;
+    E.Hits += KV.second.Hits;
+    E.Seconds += KV.second.Seconds;
+  }
+}
+
+void CombineProfile::print() {
+  if (Entries.empty())
+    return;
+
+  std::vector<const CombineProfileEntry *> Sorted;
+  CombineProfileEntry Total;
+  for (const auto &KV : Entries) {
+    Sorted.push_back(&KV.second);
+    Total.Visits += KV.second.Visits;
+    Total.Hits += KV.second.Hits;
+    Total.Seconds += KV.second.Seconds;
+  }
+  llvm::sort(Sorted, [](const CombineProfileEntry *A,
+                        const CombineProfileEntry *B) {
+    if (A->Seconds != B->Seconds)
+      return A->Seconds > B->Seconds;
+    return A->Name < B->Name;
+  });
+
+  std::unique_ptr<raw_fd_ostream> OS = CreateInfoOutputFile();
+  *OS << "===" << std::string(73, '-') << "===\n"
+      << "                          DAG combiner profile\n"
+      << "===" << std::string(73, '-') << "===\n"
+      << "      Visits        Hits      Misses    Time (s)  Opcode\n";
+  auto PrintEntry = [&](const CombineProfileEntry &E, StringRef Name) {
+    *OS << format("%12llu%12llu%12llu%12.4f  ", (unsigned long long)E.Visits,
+                  (unsigned long long)E.Hits,
+                  (unsigned long long)(E.Visits - E.Hits), E.Seconds)
+        << Name << '\n';
+  };
+  for (const CombineProfileEntry *E : Sorted)
+    PrintEntry(*E, E->Name);
+  PrintEntry(Total, "Total");
+  *OS << '\n';
+  OS->flush();
+}
+
 namespace {
 
   class DAGCombiner {
@@ -141,26 +232,18 @@ namespace {
     /// back and when processing we pop off of the back.
     ///
     /// The worklist will not contain duplicates but may contain null entries
-    /// due to nodes being deleted from the underlying DAG.
+    /// due to nodes being deleted from the underlying DAG. The position of
+    /// each node on the worklist is kept in the node itself, which is used to
+    /// find and remove nodes from the worklist (by nulling them) when they are
+    /// deleted, and to avoid queueing them twice. It relies on stable indices
+    /// of nodes within the worklist.
     SmallVector<SDNode *, 64> Worklist;
 
-    /// Mapping from an SDNode to its position on the worklist.
-    ///
-    /// This is used to find and remove nodes from the worklist (by nulling
-    /// them) when they are deleted from the underlying DAG. It relies on
-    /// stable indices of nodes within the worklist.
-    DenseMap<SDNode *, unsigned> WorklistMap;
     /// This records all nodes attempted to add to the worklist since we
     /// considered a new worklist entry. As we keep do not add duplicate nodes
     /// in the worklist, this is different from the tail of the worklist.
     SmallSetVector<SDNode *, 32> PruningList;
 
-    /// Set of nodes which have been combined (at least once).
-    ///
-    /// This is used to allow us to reliably add any operands of a DAG node
-    /// which have not yet been combined to the worklist.
-    SmallPtrSet<SDNode *, 32> CombinedNodes;
-
     /// Map from candidate StoreNode to the pair of RootNode and count.
     /// The count is used to track how many times we have seen the StoreNode
     /// with the same RootNode bail out in dependence check. If we have seen
@@ -169,6 +252,9 @@ namespace {
     /// candidate again.
     DenseMap<SDNode *, std::pair<SDNode *, unsigned>> StoreRootCountMap;
 
+    /// The counters of this run for -combiner-profile, by opcode.
+    CombineProfileMap ProfileEntries;
+
     // AA - Used for DAG load/store alias analysis.
     AliasAnalysis *AA;
 
@@ -202,10 +288,10 @@ namespace {
       }
 
       if (N) {
-        bool GoodWorklistEntry = WorklistMap.erase(N);
-        (void)GoodWorklistEntry;
-        assert(GoodWorklistEntry &&
-               "Found a worklist entry without a corresponding map entry!");
+        assert(N->getCombinerWorklistIndex() >= 0 &&
+               "Found a worklist entry without a corresponding index!");
+        // Set as combined now, since the caller combines it right away.
+        N->setCombinerWorklistIndex(-2);
       }
       return N;
     }
@@ -233,8 +319,9 @@ namespace {
     }
 
     /// Add to the worklist making sure its instance is at the back (next to be
-    /// processed.)
-    void AddToWorklist(SDNode *N) {
+    /// processed.) If \p SkipIfCombinedBefore is set, nodes that have already
+    /// been combined are only queued again when a combine changes them.
+    void AddToWorklist(SDNode *N, bool SkipIfCombinedBefore = false) {
       assert(N->getOpcode() != ISD::DELETED_NODE &&
              "Deleted Node added to Worklist");
 
@@ -243,25 +330,32 @@ namespace {
       if (N->getOpcode() == ISD::HANDLENODE)
         return;
 
+      if (SkipIfCombinedBefore && N->getCombinerWorklistIndex() == -2)
+        return;
+
       ConsiderForPruning(N);
 
-      if (WorklistMap.insert(std::make_pair(N, Worklist.size())).second)
+      if (N->getCombinerWorklistIndex() < 0) {
+        N->setCombinerWorklistIndex(Worklist.size());
         Worklist.push_back(N);
+      }
     }
 
     /// Remove all instances of N from the worklist.
     void removeFromWorklist(SDNode *N) {
-      CombinedNodes.erase(N);
       PruningList.remove(N);
       StoreRootCountMap.erase(N);
 
-      auto It = WorklistMap.find(N);
-      if (It == WorklistMap.end())
+      int WorklistIndex = N->getCombinerWorklistIndex();
+      // If not in the worklist, the index might be -1 or -2 (was combined
+      // before). As the node gets deleted anyway, there's no need to update
+      // the index.
+      if (WorklistIndex < 0)
         return; // Not in the worklist.
 
       // Null out the entry rather than erasing it to avoid a linear operation.
-      Worklist[It->second] = nullptr;
-      WorklistMap.erase(It);
+      Worklist[WorklistIndex] = nullptr;
+      N->setCombinerWorklistIndex(-1);
     }
 
     void deleteAndRecombine(SDNode *N);
@@ -1408,7 +1502,9 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
   HandleSDNode Dummy(DAG.getRoot());
 
   // While we have a valid worklist entry node, try to combine it.
+  unsigned NumVisited = 0;
   while (SDNode *N = getNextWorklistEntry()) {
+    ++NumVisited;
     // If N has no uses, it is dead.  Make sure to revisit all N's operands once
     // N is deleted from the DAG, since they too may now be dead or may have a
     // reduced number of uses, allowing other xforms.
@@ -1436,12 +1532,25 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
     // Add any operands of the new node which have not yet been combined to the
     // worklist as well. Because the worklist uniques things already, this
     // won't repeatedly process the same operand.
-    CombinedNodes.insert(N);
     for (const SDValue &ChildN : N->op_values())
-      if (!CombinedNodes.count(ChildN.getNode()))
-        AddToWorklist(ChildN.getNode());
-
-    SDValue RV = combine(N);
+      AddToWorklist(ChildN.getNode(), /*SkipIfCombinedBefore=*/true);
+
+    SDValue RV;
+    if (LLVM_UNLIKELY(ProfileCombines)) {
+      // Record the opcode up front: the combine may delete the node.
+      CombineProfileEntry &E = ProfileEntries[N->getOpcode()];
+      if (E.Name.empty())
+        E.Name = N->getOperationName(&DAG);
+      auto Start = std::chrono::steady_clock::now();
+      RV = combine(N);
+      std::chrono::duration<double> Elapsed =
+          std::chrono::steady_clock::now() - Start;
+      ++E.Visits;
+      E.Hits += RV.getNode() != nullptr;
+      E.Seconds += Elapsed.count();
+    } else {
+      RV = combine(N);
+    }
 
     if (!RV.getNode())
       continue;
@@ -1480,6 +1589,13 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
     recursivelyDeleteUnusedNodes(N);
   }
 
+  NodesVisited += NumVisited;
+  MaxNodesVisited.updateMax(NumVisited);
+  if (!ProfileEntries.empty()) {
+    TheCombineProfile->merge(ProfileEntries);
+    ProfileEntries.clear();
+  }
+
   // If the root changed (e.g. it was a dead load, update the root).
   DAG.setRoot(Dummy.getValue());
   DAG.RemoveDeadNodes();
@@ -1026,8 +1026,15 @@ SelectionDAG::~SelectionDAG() {
 void SelectionDAG::allnodes_clear() {
   assert(&*AllNodes.begin() == &EntryNode);
   AllNodes.remove(AllNodes.begin());
-  while (!AllNodes.empty())
-    DeallocateNode(&AllNodes.front());
+  // Both callers release all operand lists and debug values afterwards, so
+  // skip the bookkeeping DeallocateNode does for them. The nodes go back to
+  // the free list of NodeAllocator, so the next DAG reuses their memory.
+  while (!AllNodes.empty()) {
+    SDNode *N = AllNodes.remove(AllNodes.begin());
+    NodeAllocator.Deallocate(N);
+    __asan_unpoison_memory_region(&N->NodeType, sizeof(N->NodeType));
+    N->NodeType = ISD::DELETED_NODE;
+  }
 #ifndef NDEBUG
   NextPersistentId = 0;
 #endif
@@ -1074,10 +1081,21 @@ SDNode *SelectionDAG::FindNodeOrInsertPos(const FoldingSetNodeID &ID,
 }
 
 void SelectionDAG::clear() {
+  unsigned NumCSENodes = CSEMap.size();
   allnodes_clear();
   OperandRecycler.clear(OperandAllocator);
   OperandAllocator.Reset();
-  CSEMap.clear();
+
+  // Clearing the CSE map takes time proportional to its number of buckets,
+  // which only ever grows. If one huge block made it much larger than the
+  // block just selected needed, start over with a smaller map, so that the
+  // huge block does not slow down every later block of the compilation.
+  if (CSEMap.capacity() > 8 * std::max(NumCSENodes, 1024u)) {
+    CSEMap = FoldingSet<SDNode>();
+    CSEMap.reserve(NumCSENodes);
+  } else {
+    CSEMap.clear();
+  }
 
   ExtendedValueTypeNodes.clear();
   ExternalSymbols.clear();
@@ -22,6 +22,8 @@
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/BranchProbabilityInfo.h"
@@ -84,8 +86,12 @@
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/KnownBits.h"
 #include "llvm/Support/MachineValueType.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetIntrinsicInfo.h"
@@ -110,6 +116,9 @@ STATISTIC(NumFastIselFailures, "Number of instructions fast isel failed on");
 STATISTIC(NumFastIselSuccess, "Number of instructions fast isel selected");
 STATISTIC(NumFastIselBlocks, "Number of blocks selected entirely by fast isel");
 STATISTIC(NumDAGBlocks, "Number of blocks selected using DAG");
+STATISTIC(NumDAGNodes, "Number of nodes in DAGs at instruction selection");
+STATISTIC(MaxDAGNodes, "Largest number of nodes in a DAG at instruction "
+                       "selection");
 STATISTIC(NumDAGIselRetries,"Number of times dag isel has to try another path");
 STATISTIC(NumEntryBlocks, "Number of entry blocks encountered");
 STATISTIC(NumFastIselFailLowerArguments,
@@ -128,6 +137,11 @@ static cl::opt<bool> EnableFastISelFallbackReport(
     cl::desc("Emit a diagnostic when \"fast\" instruction selection "
              "falls back to SelectionDAG."));
 
+static cl::opt<bool> EnableFastISelFallbackStats(
+    "fast-isel-report-fallbacks", cl::Hidden,
+    cl::desc("Print, at exit, how many times \"fast\" instruction selection "
+             "fell back to SelectionDAG for each kind of instruction."));
+
 static cl::opt<bool>
 UseMBPI("use-mbpi",
         cl::desc("use Machine Branch Probability Info"),
@@ -695,6 +709,62 @@ bool SelectionDAGISel::runOnMachineFunction(MachineFunction &mf) {
   return true;
 }
 
+namespace {
+
+/// Counts the FastISel fallbacks of the whole process by instruction kind, so
+/// that the kinds worth adding to a target's FastISel stand out. The table is
+/// printed when the counts are destroyed, at llvm_shutdown.
+class FastISelFallbackCounts {
+  sys::SmartMutex<true> Lock;
+  StringMap<unsigned> Counts;
+
+public:
+  void add(StringRef Kind) {
+    sys::SmartScopedLock<true> Guard(Lock);
+    ++Counts[Kind];
+  }
+
+  ~FastISelFallbackCounts() {
+    if (Counts.empty())
+      return;
+    std::vector<std::pair<StringRef, unsigned>> Sorted;
+    for (const auto &Entry : Counts)
+      Sorted.emplace_back(Entry.getKey(), Entry.getValue());
+    llvm::sort(Sorted, [](const std::pair<StringRef, unsigned> &A,
+                          const std::pair<StringRef, unsigned> &B) {
+      return A.second != B.second ? A.second > B.second : A.first < B.first;
+    });
+    raw_ostream &OS = errs();
+    OS << "===" << std::string(73, '-') << "===\n"
+       << "                      FastISel fallbacks to SelectionDAG\n"
+       << "===" << std::string(73, '-') << "===\n";
+    for (const auto &Entry : Sorted)
+      OS << right_justify(utostr(Entry.second), 10) << " " << Entry.first
+         << "\n";
+  }
+};
+
+} // end anonymous namespace
+
+static ManagedStatic<FastISelFallbackCounts> FastISelFallbacks;
+
+/// Record a fallback of \p Inst, or of the argument lowering when it is null,
+/// for -fast-isel-report-fallbacks. Calls are counted by intrinsic, since the
+/// intrinsics are what a target's FastISel selects one by one.
+static void countFastISelFallback(const Instruction *Inst) {
+  if (!EnableFastISelFallbackStats)
+    return;
+  if (!Inst) {
+    FastISelFallbacks->add("<arguments>");
+    return;
+  }
+  if (const auto *II = dyn_cast<IntrinsicInst>(Inst)) {
+    FastISelFallbacks->add(("call " + II->getCalledFunction()->getName()).str());
+    return;
+  }
+  FastISelFallbacks->add(Inst->getOpcodeName());
+}
+
 static void reportFastISelFailure(MachineFunction &MF,
                                   OptimizationRemarkEmitter &ORE,
                                   OptimizationRemarkMissed &R,
@@ -961,6 +1031,13 @@ void SelectionDAGISel::CodeGenAndEmitDAG() {
   if (ViewISelDAGs && MatchFilterBB)
     CurDAG->viewGraph("isel input for " + BlockName);
 
+  // Record the size of the DAG, which bounds the node memory the DAG keeps
+  // for reuse by the following blocks.
+  unsigned NumNodes = CurDAG->allnodes_size();
+  NumDAGNodes += NumNodes;
+  MaxDAGNodes.updateMax(NumNodes);
+  timeTraceProfilerCounter("DAGNodes", NumNodes);
+
   // Third, instruction select all of the operations to machine code, adding the
   // code to the MachineBasicBlock.
   {
@@ -1363,6 +1440,7 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
       FastISelFailed = true;
       // Fast isel failed to lower these arguments
       ++NumFastIselFailLowerArguments;
+      countFastISelFallback(nullptr);
 
       OptimizationRemarkMissed R("sdagisel", "FastISelFailure",
                                  Fn.getSubprogram(),
@@ -1487,6 +1565,7 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
         }
 
         FastISelFailed = true;
+        countFastISelFallback(Inst);
 
         // Then handle certain instructions as single-LLVM-Instruction blocks.
         // We cannot separate out GCrelocates to their own blocks since we need
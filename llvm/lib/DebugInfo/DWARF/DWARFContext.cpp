@@ -66,8 +66,9 @@ using FileLineInfoKind = DILineInfoSpecifier::FileLineInfoKind;
 using FunctionNameKind = DILineInfoSpecifier::FunctionNameKind;
 
 DWARFContext::DWARFContext(std::unique_ptr<const DWARFObject> DObj,
-                           std::string DWPName)
-    : DIContext(CK_DWARF), DWPName(std::move(DWPName)), DObj(std::move(DObj)) {}
+                           std::string DWPName, bool ThreadSafe)
+    : DIContext(CK_DWARF), DWPName(std::move(DWPName)), ThreadSafe(ThreadSafe),
+      DObj(std::move(DObj)) {}
 
 DWARFContext::~DWARFContext() = default;
 
@@ -605,6 +606,7 @@ void DWARFContext::dump(
 }
 
 DWARFCompileUnit *DWARFContext::getDWOCompileUnitForHash(uint64_t Hash) {
+  auto Lock = lockIfThreadSafe();
   parseDWOUnits(LazyParse);
 
   if (const auto &CUI = getCUIndex()) {
@@ -655,6 +657,7 @@ bool DWARFContext::verify(raw_ostream &OS, DIDumpOptions DumpOpts) {
 }
 
 const DWARFUnitIndex &DWARFContext::getCUIndex() {
+  auto Lock = lockIfThreadSafe();
   if (CUIndex)
     return *CUIndex;
 
@@ -666,6 +669,7 @@ const DWARFUnitIndex &DWARFContext::getCUIndex() {
 }
 
 const DWARFUnitIndex &DWARFContext::getTUIndex() {
+  auto Lock = lockIfThreadSafe();
   if (TUIndex)
     return *TUIndex;
 
@@ -677,6 +681,7 @@ const DWARFUnitIndex &DWARFContext::getTUIndex() {
 }
 
 DWARFGdbIndex &DWARFContext::getGdbIndex() {
+  auto Lock = lockIfThreadSafe();
   if (GdbIndex)
     return *GdbIndex;
 
@@ -687,6 +692,7 @@ DWARFGdbIndex &DWARFContext::getGdbIndex() {
 }
 
 const DWARFDebugAbbrev *DWARFContext::getDebugAbbrev() {
+  auto Lock = lockIfThreadSafe();
   if (Abbrev)
     return Abbrev.get();
 
@@ -694,20 +700,27 @@ const DWARFDebugAbbrev *DWARFContext::getDebugAbbrev() {
 
   Abbrev.reset(new DWARFDebugAbbrev());
   Abbrev->extract(abbrData);
+  // Parse all abbreviations now so that the threads only read them.
+  if (ThreadSafe)
+    Abbrev->parse();
   return Abbrev.get();
 }
 
 const DWARFDebugAbbrev *DWARFContext::getDebugAbbrevDWO() {
+  auto Lock = lockIfThreadSafe();
   if (AbbrevDWO)
     return AbbrevDWO.get();
 
   DataExtractor abbrData(DObj->getAbbrevDWOSection(), isLittleEndian(), 0);
   AbbrevDWO.reset(new DWARFDebugAbbrev());
   AbbrevDWO->extract(abbrData);
+  if (ThreadSafe)
+    AbbrevDWO->parse();
   return AbbrevDWO.get();
 }
 
 const DWARFDebugLoc *DWARFContext::getDebugLoc() {
+  auto Lock = lockIfThreadSafe();
   if (Loc)
     return Loc.get();
 
@@ -722,6 +735,7 @@ const DWARFDebugLoc *DWARFContext::getDebugLoc() {
 }
 
 const DWARFDebugLoclists *DWARFContext::getDebugLocDWO() {
+  auto Lock = lockIfThreadSafe();
   if (LocDWO)
     return LocDWO.get();
 
@@ -738,6 +752,7 @@ const DWARFDebugLoclists *DWARFContext::getDebugLocDWO() {
 }
 
 const DWARFDebugAranges *DWARFContext::getDebugAranges() {
+  auto Lock = lockIfThreadSafe();
   if (Aranges)
     return Aranges.get();
 
@@ -747,6 +762,7 @@ const DWARFDebugAranges *DWARFContext::getDebugAranges() {
 }
 
 const DWARFDebugFrame *DWARFContext::getDebugFrame() {
+  auto Lock = lockIfThreadSafe();
   if (DebugFrame)
     return DebugFrame.get();
 
@@ -767,6 +783,7 @@ const DWARFDebugFrame *DWARFContext::getDebugFrame() {
 }
 
 const DWARFDebugFrame *DWARFContext::getEHFrame() {
+  auto Lock = lockIfThreadSafe();
   if (EHFrame)
     return EHFrame.get();
 
@@ -778,6 +795,7 @@ const DWARFDebugFrame *DWARFContext::getEHFrame() {
 }
 
 const DWARFDebugMacro *DWARFContext::getDebugMacro() {
+  auto Lock = lockIfThreadSafe();
   if (Macro)
     return Macro.get();
 
@@ -802,27 +820,32 @@ static T &getAccelTable(std::unique_ptr<T> &Cache, const DWARFObject &Obj,
 }
 
 const DWARFDebugNames &DWARFContext::getDebugNames() {
+  auto Lock = lockIfThreadSafe();
   return getAccelTable(Names, *DObj, DObj->getNamesSection(),
                        DObj->getStrSection(), isLittleEndian());
 }
 
 const AppleAcceleratorTable &DWARFContext::getAppleNames() {
+  auto Lock = lockIfThreadSafe();
   return getAccelTable(AppleNames, *DObj, DObj->getAppleNamesSection(),
                        DObj->getStrSection(), isLittleEndian());
 }
 
 const AppleAcceleratorTable &DWARFContext::getAppleTypes() {
+  auto Lock = lockIfThreadSafe();
   return getAccelTable(AppleTypes, *DObj, DObj->getAppleTypesSection(),
                        DObj->getStrSection(), isLittleEndian());
 }
 
 const AppleAcceleratorTable &DWARFContext::getAppleNamespaces() {
+  auto Lock = lockIfThreadSafe();
   return getAccelTable(AppleNamespaces, *DObj,
                        DObj->getAppleNamespacesSection(),
                        DObj->getStrSection(), isLittleEndian());
 }
 
 const AppleAcceleratorTable &DWARFContext::getAppleObjC() {
+  auto Lock = lockIfThreadSafe();
   return getAccelTable(AppleObjC, *DObj, DObj->getAppleObjCSection(),
                        DObj->getStrSection(), isLittleEndian());
 }
@@ -840,9 +863,6 @@ DWARFContext::getLineTableForUnit(DWARFUnit *U) {
 
 Expected<const DWARFDebugLine::LineTable *> DWARFContext::getLineTableForUnit(
     DWARFUnit *U, std::function<void(Error)> RecoverableErrorCallback) {
-  if (!Line)
-    Line.reset(new DWARFDebugLine);
-
   auto UnitDIE = U->getUnitDIE();
   if (!UnitDIE)
     return nullptr;
@@ -851,6 +871,10 @@ Expected<const DWARFDebugLine::LineTable *> DWARFContext::getLineTableForUnit(
   if (!Offset)
     return nullptr; // No line table for this compile unit.
 
+  auto Lock = lockIfThreadSafe();
+  if (!Line)
+    Line.reset(new DWARFDebugLine);
+
   uint64_t stmtOffset = *Offset + U->getLineTableOffset();
   // See if the line table is cached.
   if (const DWARFLineTable *lt = Line->getLineTable(stmtOffset))
@@ -868,6 +892,9 @@ Expected<const DWARFDebugLine::LineTable *> DWARFContext::getLineTableForUnit(
 }
 
 void DWARFContext::parseNormalUnits() {
+  if (NormalUnitsParsed.load(std::memory_order_acquire))
+    return;
+  auto Lock = lockIfThreadSafe();
   if (!NormalUnits.empty())
     return;
   DObj->forEachInfoSections([&](const DWARFSection &S) {
@@ -877,11 +904,19 @@ void DWARFContext::parseNormalUnits() {
   DObj->forEachTypesSections([&](const DWARFSection &S) {
     NormalUnits.addUnitsForSection(*this, S, DW_SECT_TYPES);
   });
+  NormalUnitsParsed.store(true, std::memory_order_release);
 }
 
 void DWARFContext::parseDWOUnits(bool Lazy) {
+  if (DWOUnitsParsed.load(std::memory_order_acquire))
+    return;
+  auto Lock = lockIfThreadSafe();
   if (!DWOUnits.empty())
     return;
+  // Lazily parsed units are added to DWOUnits as they are looked up, which
+  // would change it under the threads using it.
+  if (ThreadSafe)
+    Lazy = false;
   DObj->forEachInfoDWOSections([&](const DWARFSection &S) {
     DWOUnits.addUnitsForDWOSection(*this, S, DW_SECT_INFO, Lazy);
   });
@@ -889,6 +924,7 @@ void DWARFContext::parseDWOUnits(bool Lazy) {
   DObj->forEachTypesDWOSections([&](const DWARFSection &S) {
     DWOUnits.addUnitsForDWOSection(*this, S, DW_SECT_TYPES, Lazy);
   });
+  DWOUnitsParsed.store(true, std::memory_order_release);
 }
 
 DWARFCompileUnit *DWARFContext::getCompileUnitForOffset(uint64_t Offset) {
@@ -1219,6 +1255,7 @@ DWARFContext::getInliningInfoForAddress(object::SectionedAddress Address,
 
 std::shared_ptr<DWARFContext>
 DWARFContext::getDWOContext(StringRef AbsolutePath) {
+  auto Lock = lockIfThreadSafe();
   if (auto S = DWP.lock()) {
     DWARFContext *Ctxt = S->Context.get();
     return std::shared_ptr<DWARFContext>(std::move(S), Ctxt);
@@ -1260,7 +1297,8 @@ DWARFContext::getDWOContext(StringRef AbsolutePath) {
 
   auto S = std::make_shared<DWOFile>();
   S->File = std::move(Obj.get());
-  S->Context = DWARFContext::create(*S->File.getBinary());
+  S->Context = DWARFContext::create(*S->File.getBinary(), nullptr,
+                                    defaultErrorHandler, "", ThreadSafe);
   *Entry = S;
   auto *Ctxt = S->Context.get();
   return std::shared_ptr<DWARFContext>(std::move(S), Ctxt);
@@ -1802,17 +1840,18 @@ public:
 std::unique_ptr<DWARFContext>
 DWARFContext::create(const object::ObjectFile &Obj, const LoadedObjectInfo *L,
                      function_ref<ErrorPolicy(Error)> HandleError,
-                     std::string DWPName) {
+                     std::string DWPName, bool ThreadSafe) {
   auto DObj = std::make_unique<DWARFObjInMemory>(Obj, L, HandleError);
-  return std::make_unique<DWARFContext>(std::move(DObj), std::move(DWPName));
+  return std::make_unique<DWARFContext>(std::move(DObj), std::move(DWPName),
+                                        ThreadSafe);
 }
 
 std::unique_ptr<DWARFContext>
 DWARFContext::create(const StringMap<std::unique_ptr<MemoryBuffer>> &Sections,
-                     uint8_t AddrSize, bool isLittleEndian) {
+                     uint8_t AddrSize, bool isLittleEndian, bool ThreadSafe) {
   auto DObj =
       std::make_unique<DWARFObjInMemory>(Sections, AddrSize, isLittleEndian);
-  return std::make_unique<DWARFContext>(std::move(DObj), "");
+  return std::make_unique<DWARFContext>(std::move(DObj), "", ThreadSafe);
 }
 
 Error DWARFContext::loadRegisterInfo(const object::ObjectFile &Obj) {
@@ -188,10 +188,22 @@ DWARFUnit::DWARFUnit(DWARFContext &DC, const DWARFSection &Section,
       if (const auto *C = IndexEntry->getOffset(DW_SECT_LOC))
         LocSectionData = LocSectionData.substr(C->Offset, C->Length);
   }
+  // Units of a thread safe context are created while the context is locked,
+  // so look up the shared abbreviations here rather than on demand.
+  if (DC.isThreadSafe())
+    Abbrevs = Abbrev->getAbbreviationDeclarationSet(Header.getAbbrOffset());
 }
 
 DWARFUnit::~DWARFUnit() = default;
 
+/// Lock \p Mutex if \p Context is thread safe.
+static std::unique_lock<std::recursive_mutex>
+lockIfThreadSafe(const DWARFContext &Context, std::recursive_mutex &Mutex) {
+  if (!Context.isThreadSafe())
+    return std::unique_lock<std::recursive_mutex>();
+  return std::unique_lock<std::recursive_mutex>(Mutex);
+}
+
 DWARFDataExtractor DWARFUnit::getDebugInfoExtractor() const {
   return DWARFDataExtractor(Context.getDWARFObj(), InfoSection, isLittleEndian,
                             getAddressByteSize());
@@ -409,6 +421,23 @@ void DWARFUnit::extractDIEsIfNeeded(bool CUDieOnly) {
 }
 
 Error DWARFUnit::tryExtractDIEsIfNeeded(bool CUDieOnly) {
+  if (!Context.isThreadSafe())
+    return extractDIEsIfNeededImpl(CUDieOnly);
+
+  // A thread safe context extracts all DIEs at once: extracting the other DIEs
+  // after the unit DIE would move the unit DIE, which other threads may be
+  // using.
+  if (AllDIEsExtracted.load(std::memory_order_acquire))
+    return Error::success();
+  std::lock_guard<std::recursive_mutex> Lock(LazyStateMutex);
+  if (AllDIEsExtracted.load(std::memory_order_relaxed))
+    return Error::success();
+  Error Err = extractDIEsIfNeededImpl(/*CUDieOnly=*/false);
+  AllDIEsExtracted.store(true, std::memory_order_release);
+  return Err;
+}
+
+Error DWARFUnit::extractDIEsIfNeededImpl(bool CUDieOnly) {
   if ((CUDieOnly && !DieArray.empty()) ||
       DieArray.size() > 1)
     return Error::success(); // Already parsed.
@@ -493,6 +522,22 @@ Error DWARFUnit::tryExtractDIEsIfNeeded(bool CUDieOnly) {
 }
 
 bool DWARFUnit::parseDWO() {
+  if (!Context.isThreadSafe())
+    return parseDWOImpl();
+  if (IsDWO || DWOParsed.load(std::memory_order_acquire))
+    return false;
+  // Looking for the DWO unit goes through the context, so lock the context
+  // before the unit, like everything that locks both.
+  auto ContextLock = Context.lockIfThreadSafe();
+  std::lock_guard<std::recursive_mutex> Lock(LazyStateMutex);
+  if (DWOParsed.load(std::memory_order_relaxed))
+    return false;
+  bool Parsed = parseDWOImpl();
+  DWOParsed.store(true, std::memory_order_release);
+  return Parsed;
+}
+
+bool DWARFUnit::parseDWOImpl() {
   if (IsDWO)
     return false;
   if (DWO.get())
@@ -632,6 +677,7 @@ void DWARFUnit::updateAddressDieMap(DWARFDie Die) {
 
 DWARFDie DWARFUnit::getSubroutineForAddress(uint64_t Address) {
   extractDIEsIfNeeded(false);
+  auto Lock = lockIfThreadSafe(Context, LazyStateMutex);
   if (AddrDieMap.empty())
     updateAddressDieMap(getUnitDIE());
   auto R = AddrDieMap.upper_bound(Address);
@@ -759,12 +805,14 @@ DWARFDie DWARFUnit::getLastChild(const DWARFDebugInfoEntry *Die) {
 }
 
 const DWARFAbbreviationDeclarationSet *DWARFUnit::getAbbreviations() const {
-  if (!Abbrevs)
+  // The abbreviations of a thread safe context were looked up on creation.
+  if (!Abbrevs && !Context.isThreadSafe())
     Abbrevs = Abbrev->getAbbreviationDeclarationSet(Header.getAbbrOffset());
   return Abbrevs;
 }
 
 llvm::Optional<object::SectionedAddress> DWARFUnit::getBaseAddress() {
+  auto Lock = lockIfThreadSafe(Context, LazyStateMutex);
   if (BaseAddr)
     return BaseAddr;
 
@@ -16,6 +16,7 @@
 #include "llvm/DebugInfo/DWARF/DWARFSection.h"
 #include "llvm/Support/DJB.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <map>
@@ -282,10 +283,31 @@ unsigned DWARFVerifier::verifyUnitSection(const DWARFSection &S,
   bool hasDIE = DebugInfoData.isValidOffset(Offset);
   DWARFUnitVector TypeUnitVector;
   DWARFUnitVector CompileUnitVector;
+
+  // When the context can be queried concurrently, the unit contents are
+  // verified in parallel. Each unit then reports to its own buffer through its
+  // own verifier, and the buffers are printed in unit order once all of them
+  // are done, so the output is the same as when verifying serially.
+  struct PendingUnit {
+    std::string Output;
+    raw_string_ostream OS{Output};
+    DWARFVerifier Verifier;
+    DWARFUnit *Unit = nullptr;
+    unsigned NumErrors = 0;
+
+    PendingUnit(DWARFContext &DCtx, const DIDumpOptions &DumpOpts)
+        : Verifier(OS, DCtx, DumpOpts) {}
+  };
+  const bool Parallel = DCtx.isThreadSafe() && DumpOpts.NumThreads != 1;
+  std::vector<std::unique_ptr<PendingUnit>> PendingUnits;
+
   while (hasDIE) {
     OffsetStart = Offset;
-    if (!verifyUnitHeader(DebugInfoData, &Offset, UnitIdx, UnitType,
-                          isUnitDWARF64)) {
+    if (Parallel)
+      PendingUnits.push_back(std::make_unique<PendingUnit>(DCtx, DumpOpts));
+    DWARFVerifier &V = Parallel ? PendingUnits.back()->Verifier : *this;
+    if (!V.verifyUnitHeader(DebugInfoData, &Offset, UnitIdx, UnitType,
+                            isUnitDWARF64)) {
       isHeaderChainValid = false;
       if (isUnitDWARF64)
         break;
@@ -320,11 +342,30 @@ unsigned DWARFVerifier::verifyUnitSection(const DWARFSection &S,
       }
       default: { llvm_unreachable("Invalid UnitType."); }
       }
-      NumDebugInfoErrors += verifyUnitContents(*Unit);
+      if (Parallel)
+        PendingUnits.back()->Unit = Unit;
+      else
+        NumDebugInfoErrors += verifyUnitContents(*Unit);
     }
     hasDIE = DebugInfoData.isValidOffset(Offset);
     ++UnitIdx;
   }
+  if (Parallel) {
+    ThreadPool Pool(hardware_concurrency_strategy(DumpOpts.NumThreads));
+    for (auto &P : PendingUnits)
+      if (P->Unit)
+        Pool.async([&P] {
+          P->NumErrors = P->Verifier.verifyUnitContents(*P->Unit);
+        });
+    Pool.wait();
+    for (auto &P : PendingUnits) {
+      OS << P->OS.str();
+      NumDebugInfoErrors += P->NumErrors;
+      for (const auto &Ref : P->Verifier.ReferenceToDIEOffsets)
+        ReferenceToDIEOffsets[Ref.first].insert(Ref.second.begin(),
+                                                Ref.second.end());
+    }
+  }
   if (UnitIdx == 0 && !hasDIE) {
     warn() << "Section is empty.\n";
     isHeaderChainValid = true;
@@ -0,0 +1,252 @@
+//===- GsymReader.cpp -----------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/DebugInfo/GSYM/GsymReader.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+using namespace llvm;
+using namespace gsym;
+
+GsymReader::GsymReader(std::unique_ptr<MemoryBuffer> Buffer)
+    : MemBuffer(std::move(Buffer)),
+      Endian(support::endian::system_endianness()) {}
+
+GsymReader::GsymReader(GsymReader &&RHS) = default;
+
+GsymReader::~GsymReader() = default;
+
+llvm::Expected<GsymReader> GsymReader::openFile(StringRef Filename) {
+  // Don't require a null terminator so that large files are memory mapped.
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BuffOrErr = MemoryBuffer::getFile(
+      Filename, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+  auto Err = BuffOrErr.getError();
+  if (Err)
+    return llvm::errorCodeToError(Err);
+  return create(BuffOrErr.get());
+}
+
+llvm::Expected<GsymReader> GsymReader::copyBuffer(StringRef Bytes) {
+  auto MemBuffer = MemoryBuffer::getMemBufferCopy(Bytes, "GSYM bytes");
+  return create(MemBuffer);
+}
+
+llvm::Expected<llvm::gsym::GsymReader>
+GsymReader::create(std::unique_ptr<MemoryBuffer> &MemBuffer) {
+  if (!MemBuffer.get())
+    return createStringError(std::errc::invalid_argument,
+                             "invalid memory buffer");
+  GsymReader GR(std::move(MemBuffer));
+  llvm::Error Err = GR.parse();
+  if (Err)
+    return std::move(Err);
+  return std::move(GR);
+}
+
+/// Decode \p Count address offsets of type \p T from \p Data into \p Bytes,
+/// using the endianness of the host.
+template <class T>
+static void decodeAddrOffsets(DataExtractor &Data, uint64_t &Offset,
+                              uint32_t Count, std::vector<uint8_t> &Bytes) {
+  Bytes.resize(uint64_t(Count) * sizeof(T));
+  for (uint32_t I = 0; I < Count; ++I) {
+    T Value = static_cast<T>(Data.getUnsigned(&Offset, sizeof(T)));
+    memcpy(Bytes.data() + uint64_t(I) * sizeof(T), &Value, sizeof(T));
+  }
+}
+
+llvm::Error GsymReader::parse() {
+  GsymBytes = MemBuffer->getBuffer();
+  if (GsymBytes.size() < sizeof(Header))
+    return createStringError(std::errc::invalid_argument,
+                             "not enough data for a GSYM header");
+  const uint32_t Magic =
+      support::endian::read32(GsymBytes.data(), Endian);
+  if (Magic != GSYM_MAGIC) {
+    if (Magic != sys::getSwappedBytes(GSYM_MAGIC))
+      return createStringError(std::errc::invalid_argument,
+                               "not a GSYM file");
+    Endian = Endian == support::big ? support::little : support::big;
+  }
+  // The tables are used in place when the file matches the host, and decoded
+  // otherwise. Buffers are normally aligned, but copy the tables if this one
+  // isn't.
+  const bool UseInPlace =
+      Endian == support::endian::system_endianness() &&
+      reinterpret_cast<uintptr_t>(GsymBytes.data()) % alignof(Header) == 0;
+  if (!UseInPlace)
+    Swap.reset(new SwappedData);
+
+  DataExtractor Data(GsymBytes, Endian == support::little, 4);
+  Expected<Header> ExpectedHdr = Header::decode(Data);
+  if (!ExpectedHdr)
+    return ExpectedHdr.takeError();
+  if (Swap) {
+    Swap->Hdr = *ExpectedHdr;
+    Hdr = &Swap->Hdr;
+  } else {
+    Hdr = reinterpret_cast<const Header *>(GsymBytes.data());
+  }
+
+  // Read the address offsets.
+  uint64_t Offset = alignTo(sizeof(Header), Hdr->AddrOffSize);
+  const uint64_t AddrOffsetsSize =
+      uint64_t(Hdr->NumAddresses) * Hdr->AddrOffSize;
+  if (!Data.isValidOffsetForDataOfSize(Offset, AddrOffsetsSize))
+    return createStringError(std::errc::invalid_argument,
+                             "failed to read address table");
+  if (!Swap) {
+    AddrOffsets = makeArrayRef(GsymBytes.bytes_begin() + Offset,
+                               AddrOffsetsSize);
+    Offset += AddrOffsetsSize;
+  } else {
+    switch (Hdr->AddrOffSize) {
+    case 1:
+      decodeAddrOffsets<uint8_t>(Data, Offset, Hdr->NumAddresses,
+                                 Swap->AddrOffsets);
+      break;
+    case 2:
+      decodeAddrOffsets<uint16_t>(Data, Offset, Hdr->NumAddresses,
+                                  Swap->AddrOffsets);
+      break;
+    case 4:
+      decodeAddrOffsets<uint32_t>(Data, Offset, Hdr->NumAddresses,
+                                  Swap->AddrOffsets);
+      break;
+    case 8:
+      decodeAddrOffsets<uint64_t>(Data, Offset, Hdr->NumAddresses,
+                                  Swap->AddrOffsets);
+      break;
+    }
+    AddrOffsets = Swap->AddrOffsets;
+  }
+
+  // Read the address info offsets.
+  Offset = alignTo(Offset, 4);
+  if (!Data.isValidOffsetForDataOfSize(Offset,
+                                       uint64_t(Hdr->NumAddresses) * 4))
+    return createStringError(std::errc::invalid_argument,
+                             "failed to read address info offsets table");
+  if (!Swap) {
+    AddrInfoOffsets = makeArrayRef(
+        reinterpret_cast<const uint32_t *>(GsymBytes.data() + Offset),
+        Hdr->NumAddresses);
+    Offset += uint64_t(Hdr->NumAddresses) * 4;
+  } else {
+    Swap->AddrInfoOffsets.resize(Hdr->NumAddresses);
+    for (uint32_t &AddrInfoOffset : Swap->AddrInfoOffsets)
+      AddrInfoOffset = Data.getU32(&Offset);
+    AddrInfoOffsets = Swap->AddrInfoOffsets;
+  }
+
+  // Read the file table.
+  if (!Data.isValidOffsetForDataOfSize(Offset, 4))
+    return createStringError(std::errc::invalid_argument,
+                             "failed to read file table count");
+  const uint32_t NumFiles = Data.getU32(&Offset);
+  if (!Data.isValidOffsetForDataOfSize(Offset, uint64_t(NumFiles) * 8))
+    return createStringError(std::errc::invalid_argument,
+                             "failed to read file table");
+  if (!Swap) {
+    Files = makeArrayRef(
+        reinterpret_cast<const FileEntry *>(GsymBytes.data() + Offset),
+        NumFiles);
+  } else {
+    Swap->Files.resize(NumFiles);
+    for (FileEntry &File : Swap->Files) {
+      File.Dir = Data.getU32(&Offset);
+      File.Base = Data.getU32(&Offset);
+    }
+    Files = Swap->Files;
+  }
+
+  // Get the string table.
+  if (!Data.isValidOffsetForDataOfSize(Hdr->StrtabOffset, Hdr->StrtabSize))
+    return createStringError(std::errc::invalid_argument,
+                             "failed to read string table");
+  StrTab.Data = GsymBytes.substr(Hdr->StrtabOffset, Hdr->StrtabSize);
+  return Error::success();
+}
+
+const Header &GsymReader::getHeader() const {
+  // The only way to get a GsymReader is from GsymReader::openFile(...) or
+  // GsymReader::copyBuffer() and the header must be valid and initialized to
+  // a valid pointer value, so the assert below should not trigger.
+  assert(Hdr);
+  return *Hdr;
+}
+
+Optional<uint64_t> GsymReader::getAddress(size_t Index) const {
+  switch (Hdr->AddrOffSize) {
+  case 1: return addressForIndex<uint8_t>(Index);
+  case 2: return addressForIndex<uint16_t>(Index);
+  case 4: return addressForIndex<uint32_t>(Index);
+  case 8: return addressForIndex<uint64_t>(Index);
+  }
+  return llvm::None;
+}
+
+Optional<uint64_t> GsymReader::getAddressInfoOffset(size_t Index) const {
+  const auto NumAddrInfoOffsets = AddrInfoOffsets.size();
+  if (Index < NumAddrInfoOffsets)
+    return AddrInfoOffsets[Index];
+  return llvm::None;
+}
+
+Expected<uint64_t>
+GsymReader::getAddressIndex(const uint64_t Addr) const {
+  if (Addr >= Hdr->BaseAddress) {
+    const uint64_t AddrOffset = Addr - Hdr->BaseAddress;
+    Optional<uint64_t> AddrOffsetIndex;
+    switch (Hdr->AddrOffSize) {
+    case 1:
+      AddrOffsetIndex = getAddressOffsetIndex<uint8_t>(AddrOffset);
+      break;
+    case 2:
+      AddrOffsetIndex = getAddressOffsetIndex<uint16_t>(AddrOffset);
+      break;
+    case 4:
+      AddrOffsetIndex = getAddressOffsetIndex<uint32_t>(AddrOffset);
+      break;
+    case 8:
+      AddrOffsetIndex = getAddressOffsetIndex<uint64_t>(AddrOffset);
+      break;
+    }
+    if (AddrOffsetIndex)
+      return *AddrOffsetIndex;
+  }
+  return createStringError(std::errc::invalid_argument,
+                           "address 0x%" PRIx64 " is not in GSYM", Addr);
+}
+
+llvm::Expected<FunctionInfo> GsymReader::getFunctionInfo(uint64_t Addr) const {
+  Expected<uint64_t> AddressIndex = getAddressIndex(Addr);
+  if (!AddressIndex)
+    return AddressIndex.takeError();
+  Optional<uint64_t> AddrInfoOffset = getAddressInfoOffset(*AddressIndex);
+  Optional<uint64_t> FuncAddr = getAddress(*AddressIndex);
+  if (!AddrInfoOffset || !FuncAddr || *AddrInfoOffset >= GsymBytes.size())
+    return createStringError(std::errc::invalid_argument,
+                             "failed to extract address[%" PRIu64 "]",
+                             *AddressIndex);
+  DataExtractor Data(GsymBytes.substr(*AddrInfoOffset),
+                     Endian == support::little, 4);
+  auto ExpectedFI = FunctionInfo::decode(Data, *FuncAddr);
+  if (!ExpectedFI)
+    return ExpectedFI.takeError();
+  // Symbols from a symbol table may not have a size, they cover the addresses
+  // up to the next function.
+  if (ExpectedFI->Range.contains(Addr) || ExpectedFI->Range.size() == 0)
+    return ExpectedFI;
+  return createStringError(std::errc::invalid_argument,
+                           "address 0x%" PRIx64 " is not in GSYM", Addr);
+}
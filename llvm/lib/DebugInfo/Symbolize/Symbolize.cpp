@@ -178,6 +178,8 @@ LLVMSymbolizer::symbolizeFrame(const std::string &ModuleName,
 
 void LLVMSymbolizer::flush() {
   ObjectForUBPathAndArch.clear();
+  LRUBinaries.clear();
+  CacheSize = 0;
   BinaryForPath.clear();
   ObjectPairForPathArch.clear();
   Modules.clear();
@@ -352,8 +354,10 @@ Expected<LLVMSymbolizer::ObjectPair>
 LLVMSymbolizer::getOrCreateObjectPair(const std::string &Path,
                                       const std::string &ArchName) {
   auto I = ObjectPairForPathArch.find(std::make_pair(Path, ArchName));
-  if (I != ObjectPairForPathArch.end())
+  if (I != ObjectPairForPathArch.end()) {
+    recordAccess(I->second);
     return I->second;
+  }
 
   auto ObjOrErr = getOrCreateObject(Path, ArchName);
   if (!ObjOrErr) {
@@ -373,7 +377,9 @@ LLVMSymbolizer::getOrCreateObjectPair(const std::string &Path,
   if (!DbgObj)
     DbgObj = Obj;
   ObjectPair Res = std::make_pair(Obj, DbgObj);
-  ObjectPairForPathArch.emplace(std::make_pair(Path, ArchName), Res);
+  auto Key = std::make_pair(Path, ArchName);
+  ObjectPairForPathArch.emplace(Key, Res);
+  pushEvictor(Res, [this, Key]() { ObjectPairForPathArch.erase(Key); });
   return Res;
 }
 
@@ -381,15 +387,24 @@ Expected<ObjectFile *>
 LLVMSymbolizer::getOrCreateObject(const std::string &Path,
                                   const std::string &ArchName) {
   Binary *Bin;
-  auto Pair = BinaryForPath.emplace(Path, OwningBinary<Binary>());
+  auto Pair = BinaryForPath.emplace(Path, CachedBinary());
+  CachedBinary &CachedBin = Pair.first->second;
   if (!Pair.second) {
-    Bin = Pair.first->second.getBinary();
+    Bin = CachedBin->getBinary();
+    // Binaries that failed to load are not in the LRU list.
+    if (Bin) {
+      LRUBinaries.remove(CachedBin);
+      LRUBinaries.push_back(CachedBin);
+    }
   } else {
     Expected<OwningBinary<Binary>> BinOrErr = createBinary(Path);
     if (!BinOrErr)
       return BinOrErr.takeError();
-    Pair.first->second = std::move(BinOrErr.get());
-    Bin = Pair.first->second.getBinary();
+    *CachedBin = std::move(BinOrErr.get());
+    CachedBin.pushEvictor([this, I = Pair.first]() { BinaryForPath.erase(I); });
+    LRUBinaries.push_back(CachedBin);
+    CacheSize += CachedBin.size();
+    Bin = CachedBin->getBinary();
   }
 
   if (!Bin)
@@ -400,6 +415,9 @@ LLVMSymbolizer::getOrCreateObject(const std::string &Path,
     if (I != ObjectForUBPathAndArch.end())
       return I->second.get();
 
+    auto Key = std::make_pair(Path, ArchName);
+    CachedBin.pushEvictor(
+        [this, Key]() { ObjectForUBPathAndArch.erase(Key); });
     Expected<std::unique_ptr<ObjectFile>> ObjOrErr =
         UB->getMachOObjectForArch(ArchName);
     if (!ObjOrErr) {
@@ -437,10 +455,6 @@ LLVMSymbolizer::createModuleInfo(const ObjectFile *Obj,
 
 Expected<SymbolizableModule *>
 LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
-  auto I = Modules.find(ModuleName);
-  if (I != Modules.end())
-    return I->second.get();
-
   std::string BinaryName = ModuleName;
   std::string ArchName = Opts.DefaultArch;
   size_t ColonPos = ModuleName.find_last_of(':');
@@ -452,6 +466,17 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
       ArchName = ArchStr;
     }
   }
+
+  auto I = Modules.find(ModuleName);
+  if (I != Modules.end()) {
+    // Keep the binaries the module was built from loaded.
+    auto Objects =
+        ObjectPairForPathArch.find(std::make_pair(BinaryName, ArchName));
+    if (Objects != ObjectPairForPathArch.end())
+      recordAccess(Objects->second);
+    return I->second.get();
+  }
+
   auto ObjectsOrErr = getOrCreateObjectPair(BinaryName, ArchName);
   if (!ObjectsOrErr) {
     // Failed to find valid object file.
@@ -483,7 +508,75 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
     Context =
         DWARFContext::create(*Objects.second, nullptr,
                              DWARFContext::defaultErrorHandler, Opts.DWPName);
-  return createModuleInfo(Objects.first, std::move(Context), ModuleName);
+  auto ModuleOrErr =
+      createModuleInfo(Objects.first, std::move(Context), ModuleName);
+  pushEvictor(Objects, [this, ModuleName]() { Modules.erase(ModuleName); });
+  return ModuleOrErr;
+}
+
+void LLVMSymbolizer::recordAccess(const ObjectPair &Objects) {
+  for (const ObjectFile *Obj : {Objects.first, Objects.second}) {
+    if (!Obj)
+      continue;
+    auto I = BinaryForPath.find(Obj->getFileName());
+    if (I == BinaryForPath.end() || !I->second->getBinary())
+      continue;
+    LRUBinaries.remove(I->second);
+    LRUBinaries.push_back(I->second);
+  }
+}
+
+void LLVMSymbolizer::pushEvictor(const ObjectPair &Objects,
+                                 std::function<void()> Evictor) {
+  // Entries are evicted by key, so running Evictor more than once, or after
+  // the entry was recreated, only drops state that can be rebuilt.
+  auto I = BinaryForPath.find(Objects.first->getFileName());
+  if (I != BinaryForPath.end())
+    I->second.pushEvictor(Evictor);
+  if (Objects.second == Objects.first)
+    return;
+  I = BinaryForPath.find(Objects.second->getFileName());
+  if (I != BinaryForPath.end())
+    I->second.pushEvictor(Evictor);
+}
+
+void LLVMSymbolizer::pruneCache() {
+  // Evict the least recently used binary until the cache fits, but always keep
+  // the most recently used one so that a binary that is larger than the cache
+  // by itself isn't reloaded on every request.
+  while (CacheSize > Opts.MaxCacheSize && !LRUBinaries.empty() &&
+         std::next(LRUBinaries.begin()) != LRUBinaries.end()) {
+    CachedBinary &Bin = LRUBinaries.front();
+    CacheSize -= Bin.size();
+    LRUBinaries.pop_front();
+    Bin.evict();
+  }
+}
+
+size_t CachedBinary::size() const {
+  const Binary *B = Bin.getBinary();
+  return B ? B->getData().size() : 0;
+}
+
+void CachedBinary::pushEvictor(std::function<void()> NewEvictor) {
+  if (!Evictor) {
+    Evictor = std::move(NewEvictor);
+    return;
+  }
+  Evictor = [OldEvictor = std::move(Evictor),
+             NewEvictor = std::move(NewEvictor)]() {
+    NewEvictor();
+    OldEvictor();
+  };
+}
+
+void CachedBinary::evict() {
+  // The last action erases this binary from the cache, so run the actions
+  // from a local copy.
+  std::function<void()> Actions = std::move(Evictor);
+  Evictor = nullptr;
+  if (Actions)
+    Actions();
 }
 
 namespace {
@@ -20,6 +20,8 @@
 #include <cstring>
 #include <functional>
 #include <numeric>
+#include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -585,3 +587,211 @@ bool ItaniumPartialDemangler::isSpecialName() const {
 bool ItaniumPartialDemangler::isData() const {
   return !isFunction() && !isSpecialName();
 }
+
+namespace {
+/// A bump pointer allocator that keeps its blocks when it is reset, so that
+/// the parser does not call malloc again once the blocks have grown large
+/// enough for the names it sees.
+class ReusableBumpPointerAllocator {
+  static constexpr size_t BlockSize = 4096;
+
+  std::vector<char *> Blocks;
+  // Allocations larger than a block, which are freed on reset.
+  std::vector<char *> MassiveAllocs;
+  size_t CurrentBlock = 0;
+  size_t Current = 0;
+
+  static char *allocateBlock(size_t Size) {
+    char *Block = static_cast<char *>(std::malloc(Size));
+    if (Block == nullptr)
+      std::terminate();
+    return Block;
+  }
+
+public:
+  ReusableBumpPointerAllocator() { Blocks.push_back(allocateBlock(BlockSize)); }
+
+  ReusableBumpPointerAllocator(const ReusableBumpPointerAllocator &) = delete;
+  ReusableBumpPointerAllocator &
+  operator=(const ReusableBumpPointerAllocator &) = delete;
+
+  void *allocate(size_t N) {
+    N = (N + 15u) & ~15u;
+    if (N > BlockSize) {
+      MassiveAllocs.push_back(allocateBlock(N));
+      return MassiveAllocs.back();
+    }
+    if (Current + N > BlockSize) {
+      if (++CurrentBlock == Blocks.size())
+        Blocks.push_back(allocateBlock(BlockSize));
+      Current = 0;
+    }
+    Current += N;
+    return Blocks[CurrentBlock] + Current - N;
+  }
+
+  void reset() {
+    for (char *Alloc : MassiveAllocs)
+      std::free(Alloc);
+    MassiveAllocs.clear();
+    CurrentBlock = 0;
+    Current = 0;
+  }
+
+  ~ReusableBumpPointerAllocator() {
+    reset();
+    for (char *Block : Blocks)
+      std::free(Block);
+  }
+};
+
+class ReusableAllocator {
+  ReusableBumpPointerAllocator Alloc;
+
+public:
+  void reset() { Alloc.reset(); }
+
+  template<typename T, typename ...Args> T *makeNode(Args &&...args) {
+    return new (Alloc.allocate(sizeof(T)))
+        T(std::forward<Args>(args)...);
+  }
+
+  void *allocateNodeArray(size_t sz) {
+    return Alloc.allocate(sizeof(Node *) * sz);
+  }
+};
+
+struct DemangleContextState {
+  itanium_demangle::ManglingParser<ReusableAllocator> Parser{nullptr, nullptr};
+
+  // The buffer names are printed into.
+  char *Buf = nullptr;
+  size_t BufSize = 0;
+
+  struct CachedResult {
+    std::string MangledName;
+    std::string DemangledName;
+    int Status;
+  };
+  bool CacheResults;
+  // The results so far by the hash of the mangled name, which can be looked
+  // up without copying the name.
+  std::unordered_multimap<size_t, CachedResult> Cache;
+
+  explicit DemangleContextState(bool CacheResults)
+      : CacheResults(CacheResults) {}
+  ~DemangleContextState() { std::free(Buf); }
+};
+} // namespace
+
+// FNV-1a.
+static size_t hashName(const char *Name, size_t Len) {
+  uint64_t Hash = 14695981039346656037ULL;
+  for (size_t I = 0; I < Len; ++I)
+    Hash = (Hash ^ static_cast<unsigned char>(Name[I])) * 1099511628211ULL;
+  return static_cast<size_t>(Hash);
+}
+
+ItaniumDemangleContext::ItaniumDemangleContext(bool CacheResults)
+    : Context(new DemangleContextState(CacheResults)) {}
+
+ItaniumDemangleContext::~ItaniumDemangleContext() {
+  delete static_cast<DemangleContextState *>(Context);
+}
+
+ItaniumDemangleContext::ItaniumDemangleContext(ItaniumDemangleContext &&Other)
+    : Context(Other.Context) {
+  Other.Context = nullptr;
+}
+
+ItaniumDemangleContext &ItaniumDemangleContext::
+operator=(ItaniumDemangleContext &&Other) {
+  std::swap(Context, Other.Context);
+  return *this;
+}
+
+const char *ItaniumDemangleContext::demangle(const char *MangledName,
+                                             int *Status) {
+  if (MangledName == nullptr) {
+    if (Status)
+      *Status = demangle_invalid_args;
+    return nullptr;
+  }
+
+  DemangleContextState &State = *static_cast<DemangleContextState *>(Context);
+  size_t Len = std::strlen(MangledName);
+  size_t Hash = 0;
+  if (State.CacheResults) {
+    Hash = hashName(MangledName, Len);
+    auto Range = State.Cache.equal_range(Hash);
+    for (auto I = Range.first; I != Range.second; ++I) {
+      const DemangleContextState::CachedResult &Result = I->second;
+      if (Result.MangledName != MangledName)
+        continue;
+      if (Status)
+        *Status = Result.Status;
+      return Result.Status == demangle_success ? Result.DemangledName.c_str()
+                                               : nullptr;
+    }
+  }
+
+  int InternalStatus = demangle_success;
+  State.Parser.reset(MangledName, MangledName + Len);
+  // A failed parse may have left some behind.
+  State.Parser.ForwardTemplateRefs.clear();
+  OutputStream S;
+
+  Node *AST = State.Parser.parse();
+
+  if (AST == nullptr)
+    InternalStatus = demangle_invalid_mangled_name;
+  else if (!initializeOutputStream(State.Buf, &State.BufSize, S, 1024))
+    InternalStatus = demangle_memory_alloc_failure;
+  else {
+    assert(State.Parser.ForwardTemplateRefs.empty());
+    AST->print(S);
+    S += '\0';
+    State.Buf = S.getBuffer();
+    State.BufSize = S.getBufferCapacity();
+  }
+
+  if (Status)
+    *Status = InternalStatus;
+  const char *Demangled =
+      InternalStatus == demangle_success ? State.Buf : nullptr;
+  if (!State.CacheResults)
+    return Demangled;
+
+  auto I = State.Cache.emplace(
+      Hash, DemangleContextState::CachedResult{
+                MangledName, Demangled ? Demangled : "", InternalStatus});
+  return Demangled ? I->second.DemangledName.c_str() : nullptr;
+}
+
+char *ItaniumDemangleContext::demangle(const char *MangledName, char *Buf,
+                                       size_t *N, int *Status) {
+  if (MangledName == nullptr || (Buf != nullptr && N == nullptr)) {
+    if (Status)
+      *Status = demangle_invalid_args;
+    return nullptr;
+  }
+
+  const char *Demangled = demangle(MangledName, Status);
+  if (Demangled == nullptr)
+    return nullptr;
+
+  size_t Size = std::strlen(Demangled) + 1;
+  if (Buf == nullptr || *N < Size) {
+    char *NewBuf = static_cast<char *>(std::realloc(Buf, Size));
+    if (NewBuf == nullptr) {
+      if (Status)
+        *Status = demangle_memory_alloc_failure;
+      return nullptr;
+    }
+    Buf = NewBuf;
+  }
+  std::memcpy(Buf, Demangled, Size);
+  if (N != nullptr)
+    *N = Size;
+  return Buf;
+}
@@ -0,0 +1,77 @@
+//===---------------- ELF.cpp - JIT linker function for ELF ---------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// ELF jit-link function.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/JITLink/ELF.h"
+
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/ExecutionEngine/JITLink/ELF_x86_64.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "jitlink"
+
+namespace llvm {
+namespace jitlink {
+
+void jitLink_ELF(std::unique_ptr<JITLinkContext> Ctx) {
+
+  // We don't want to do full ELF validation here. Just parse enough of the
+  // header to find out what ELF linker to use.
+
+  StringRef Data = Ctx->getObjectBuffer().getBuffer();
+  if (Data.size() < sizeof(ELF::Elf64_Ehdr)) {
+    Ctx->notifyFailed(make_error<JITLinkError>("Truncated ELF buffer"));
+    return;
+  }
+
+  uint8_t Class = Data[ELF::EI_CLASS];
+  uint8_t Encoding = Data[ELF::EI_DATA];
+  LLVM_DEBUG({
+    dbgs() << "jitLink_ELF: class = " << format("0x%02" PRIx8, Class)
+           << ", data = " << format("0x%02" PRIx8, Encoding)
+           << ", identifier = \""
+           << Ctx->getObjectBuffer().getBufferIdentifier() << "\"\n";
+  });
+
+  if (Class != ELF::ELFCLASS64) {
+    Ctx->notifyFailed(
+        make_error<JITLinkError>("ELF 32-bit platforms not supported"));
+    return;
+  }
+  if (Encoding != ELF::ELFDATA2LSB) {
+    Ctx->notifyFailed(
+        make_error<JITLinkError>("Big-endian ELF platforms not supported"));
+    return;
+  }
+
+  ELF::Elf64_Ehdr Header;
+  memcpy(&Header, Data.data(), sizeof(ELF::Elf64_Ehdr));
+  uint16_t Machine = support::endian::byte_swap<uint16_t, support::little>(
+      Header.e_machine);
+
+  LLVM_DEBUG({
+    dbgs() << "jitLink_ELF: machine = " << format("0x%04" PRIx16, Machine)
+           << "\n";
+  });
+
+  switch (Machine) {
+  case ELF::EM_X86_64:
+    return jitLink_ELF_x86_64(std::move(Ctx));
+  }
+  Ctx->notifyFailed(make_error<JITLinkError>("ELF machine type not valid"));
+}
+
+} // end namespace jitlink
+} // end namespace llvm
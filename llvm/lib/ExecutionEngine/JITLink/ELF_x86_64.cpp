@@ -0,0 +1,614 @@
+//===----- ELF_x86_64.cpp - JIT linker implementation for ELF/x86-64 ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// ELF/x86-64 jit-link implementation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/JITLink/ELF_x86_64.h"
+
+#include "BasicGOTAndStubsBuilder.h"
+#include "JITLinkGeneric.h"
+#include "llvm/Object/ELF.h"
+#include "llvm/Support/FormatVariadic.h"
+
+#define DEBUG_TYPE "jitlink"
+
+using namespace llvm;
+using namespace llvm::jitlink;
+using namespace llvm::jitlink::ELF_x86_64_Edges;
+
+namespace {
+
+constexpr StringRef ELFGOTSectionName = "$__GOT";
+constexpr StringRef ELFStubsSectionName = "$__STUBS";
+constexpr StringRef ELFCommonSectionName = "$__COMMON";
+
+/// Builds a LinkGraph from an ELF x86-64 relocatable object.
+///
+/// Each allocatable section becomes a single block. Relocations refer to
+/// symbols by symbol table index, so unlike MachO no address-based symbol
+/// lookup is needed: section symbols are mapped to an anonymous symbol at the
+/// start of their section's block.
+class ELFLinkGraphBuilder_x86_64 {
+  using ELFT = object::ELF64LE;
+  using Elf_Shdr = ELFT::Shdr;
+  using Elf_Sym = ELFT::Sym;
+  using Elf_Rela = ELFT::Rela;
+
+public:
+  ELFLinkGraphBuilder_x86_64(StringRef FileName,
+                             const object::ELFFile<ELFT> &Obj)
+      : Obj(Obj), G(std::make_unique<LinkGraph>(FileName.str(), 8,
+                                                support::little)) {}
+
+  Expected<std::unique_ptr<LinkGraph>> buildGraph() {
+    if (Obj.getHeader()->e_type != ELF::ET_REL)
+      return make_error<JITLinkError>("Object is not a relocatable ELF");
+
+    if (auto SectionsOrErr = Obj.sections())
+      Sections = *SectionsOrErr;
+    else
+      return SectionsOrErr.takeError();
+
+    if (auto Err = graphifySections())
+      return std::move(Err);
+
+    if (auto Err = graphifySymbols())
+      return std::move(Err);
+
+    if (auto Err = addRelocations())
+      return std::move(Err);
+
+    return std::move(G);
+  }
+
+private:
+  static sys::Memory::ProtectionFlags getProt(const Elf_Shdr &Sec) {
+    unsigned Prot = sys::Memory::MF_READ;
+    if (Sec.sh_flags & ELF::SHF_WRITE)
+      Prot |= sys::Memory::MF_WRITE;
+    if (Sec.sh_flags & ELF::SHF_EXECINSTR)
+      Prot |= sys::Memory::MF_EXEC;
+    return static_cast<sys::Memory::ProtectionFlags>(Prot);
+  }
+
+  static Linkage getLinkage(const Elf_Sym &Sym) {
+    return Sym.getBinding() == ELF::STB_WEAK ? Linkage::Weak : Linkage::Strong;
+  }
+
+  static Scope getScope(const Elf_Sym &Sym) {
+    if (Sym.getBinding() == ELF::STB_LOCAL)
+      return Scope::Local;
+    if (Sym.getVisibility() == ELF::STV_HIDDEN ||
+        Sym.getVisibility() == ELF::STV_INTERNAL)
+      return Scope::Hidden;
+    return Scope::Default;
+  }
+
+  Section &getCommonSection() {
+    if (!CommonSection) {
+      auto Prot = static_cast<sys::Memory::ProtectionFlags>(
+          sys::Memory::MF_READ | sys::Memory::MF_WRITE);
+      CommonSection = &G->createSection(ELFCommonSectionName, Prot);
+    }
+    return *CommonSection;
+  }
+
+  Error graphifySections() {
+    SectionBlocks.resize(Sections.size(), nullptr);
+
+    // ELF relocatable objects leave every sh_addr at zero. Lay the blocks out
+    // one after another so that addresses in debugging output are unique.
+    JITTargetAddress NextAddress = 0;
+
+    for (unsigned I = 0, E = Sections.size(); I != E; ++I) {
+      const Elf_Shdr &Sec = Sections[I];
+      if (!(Sec.sh_flags & ELF::SHF_ALLOC) || Sec.sh_size == 0)
+        continue;
+
+      auto Name = Obj.getSectionName(&Sec);
+      if (!Name)
+        return Name.takeError();
+
+      if (Sec.sh_flags & ELF::SHF_TLS)
+        return make_error<JITLinkError>("Unsupported TLS section " + *Name);
+
+      uint64_t Alignment = std::max<uint64_t>(Sec.sh_addralign, 1);
+      NextAddress = alignTo(NextAddress, Alignment);
+
+      auto &GraphSec = G->createSection(*Name, getProt(Sec));
+      Block *B;
+      if (Sec.sh_type == ELF::SHT_NOBITS)
+        B = &G->createZeroFillBlock(GraphSec, Sec.sh_size, NextAddress,
+                                    Alignment, 0);
+      else {
+        auto Content = Obj.getSectionContents(&Sec);
+        if (!Content)
+          return Content.takeError();
+        B = &G->createContentBlock(
+            GraphSec,
+            StringRef(reinterpret_cast<const char *>(Content->data()),
+                      Content->size()),
+            NextAddress, Alignment, 0);
+      }
+      NextAddress += Sec.sh_size;
+
+      LLVM_DEBUG({
+        dbgs() << "  Created block for " << *Name << ": " << *B << "\n";
+      });
+      SectionBlocks[I] = B;
+
+      // Nothing references the unwind info, so keep it alive explicitly.
+      if (*Name == ".eh_frame")
+        getSectionSymbol(I).setLive(true);
+    }
+
+    return Error::success();
+  }
+
+  Symbol &getSectionSymbol(unsigned SecIndex) {
+    assert(SectionBlocks[SecIndex] && "Section has no block");
+    auto &Sym = SectionSymbols[SecIndex];
+    if (!Sym)
+      Sym = &G->addAnonymousSymbol(*SectionBlocks[SecIndex], 0, 0, false,
+                                   false);
+    return *Sym;
+  }
+
+  Error graphifySymbols() {
+    const Elf_Shdr *SymTab = nullptr;
+    for (auto &Sec : Sections)
+      if (Sec.sh_type == ELF::SHT_SYMTAB) {
+        SymTab = &Sec;
+        break;
+      }
+    if (!SymTab)
+      return Error::success();
+
+    auto Symbols = Obj.symbols(SymTab);
+    if (!Symbols)
+      return Symbols.takeError();
+    auto StrTab = Obj.getStringTableForSymtab(*SymTab, Sections);
+    if (!StrTab)
+      return StrTab.takeError();
+
+    GraphSymbols.resize(Symbols->size(), nullptr);
+
+    // Index zero is the null symbol.
+    for (unsigned I = 1, E = Symbols->size(); I != E; ++I) {
+      const Elf_Sym &Sym = (*Symbols)[I];
+
+      auto Name = Sym.getName(*StrTab);
+      if (!Name)
+        return Name.takeError();
+
+      switch (Sym.getType()) {
+      case ELF::STT_FILE:
+        continue;
+      case ELF::STT_TLS:
+        return make_error<JITLinkError>("Unsupported TLS symbol " + *Name);
+      case ELF::STT_GNU_IFUNC:
+        return make_error<JITLinkError>("Unsupported ifunc symbol " + *Name);
+      }
+
+      if (Sym.isUndefined()) {
+        if (Name->empty())
+          return make_error<JITLinkError>(
+              "Undefined symbol at index " + formatv("{0:d}", I) +
+              " has no name");
+        GraphSymbols[I] = &G->addExternalSymbol(*Name, Sym.st_size);
+        continue;
+      }
+
+      if (Sym.isAbsolute()) {
+        GraphSymbols[I] =
+            &G->addAbsoluteSymbol(*Name, Sym.st_value, Sym.st_size,
+                                  getLinkage(Sym), getScope(Sym), false);
+        continue;
+      }
+
+      if (Sym.isCommon()) {
+        // For common symbols st_value holds the required alignment.
+        GraphSymbols[I] = &G->addCommonSymbol(
+            *Name, getScope(Sym), getCommonSection(), 0, Sym.st_size,
+            std::max<uint64_t>(Sym.st_value, 1), false);
+        continue;
+      }
+
+      if (Sym.st_shndx >= ELF::SHN_LORESERVE)
+        return make_error<JITLinkError>(
+            "Unsupported section index " + formatv("{0:x4}", Sym.st_shndx) +
+            " for symbol " + *Name);
+
+      // Symbols in sections that do not get loaded (debug info, for
+      // example) are left out of the graph.
+      if (Sym.st_shndx >= SectionBlocks.size() ||
+          !SectionBlocks[Sym.st_shndx])
+        continue;
+
+      if (Sym.getType() == ELF::STT_SECTION) {
+        GraphSymbols[I] = &getSectionSymbol(Sym.st_shndx);
+        continue;
+      }
+
+      Block &B = *SectionBlocks[Sym.st_shndx];
+      if (Sym.st_value + Sym.st_size > B.getSize())
+        return make_error<JITLinkError>("Symbol " + *Name +
+                                        " extends past end of its section");
+
+      bool IsCallable = Sym.getType() == ELF::STT_FUNC;
+      if (Name->empty())
+        GraphSymbols[I] = &G->addAnonymousSymbol(B, Sym.st_value, Sym.st_size,
+                                                 IsCallable, false);
+      else
+        GraphSymbols[I] =
+            &G->addDefinedSymbol(B, Sym.st_value, *Name, Sym.st_size,
+                                 getLinkage(Sym), getScope(Sym), IsCallable,
+                                 false);
+    }
+
+    return Error::success();
+  }
+
+  static Expected<ELFX86RelocationKind> getRelocationKind(uint32_t Type) {
+    switch (Type) {
+    case ELF::R_X86_64_64:
+      return Pointer64;
+    case ELF::R_X86_64_32:
+      return Pointer32;
+    case ELF::R_X86_64_32S:
+      return Pointer32Signed;
+    case ELF::R_X86_64_PC32:
+      return PCRel32;
+    case ELF::R_X86_64_PC64:
+      return PCRel64;
+    case ELF::R_X86_64_PLT32:
+      return Branch32;
+    case ELF::R_X86_64_GOTPCREL:
+      return PCRel32GOTLoad;
+    case ELF::R_X86_64_GOTPCRELX:
+    case ELF::R_X86_64_REX_GOTPCRELX:
+      return PCRel32GOTLoadRelaxable;
+    }
+    return make_error<JITLinkError>("Unsupported x86-64 relocation type " +
+                                    formatv("{0:d}", Type));
+  }
+
+  static unsigned getFixupSize(ELFX86RelocationKind Kind) {
+    return (Kind == Pointer64 || Kind == PCRel64) ? 8 : 4;
+  }
+
+  Error addRelocations() {
+    for (auto &Sec : Sections) {
+      if (Sec.sh_type == ELF::SHT_REL)
+        return make_error<JITLinkError>("SHT_REL relocations are not "
+                                        "supported on x86-64");
+      if (Sec.sh_type != ELF::SHT_RELA)
+        continue;
+
+      // Relocations for sections we did not load (debug info) are dropped.
+      if (Sec.sh_info >= SectionBlocks.size() || !SectionBlocks[Sec.sh_info])
+        continue;
+      Block &BlockToFix = *SectionBlocks[Sec.sh_info];
+
+      auto Relocs = Obj.relas(&Sec);
+      if (!Relocs)
+        return Relocs.takeError();
+
+      for (const Elf_Rela &R : *Relocs) {
+        uint32_t Type = R.getType(false);
+        if (Type == ELF::R_X86_64_NONE)
+          continue;
+
+        auto Kind = getRelocationKind(Type);
+        if (!Kind)
+          return Kind.takeError();
+
+        uint32_t SymIndex = R.getSymbol(false);
+        if (SymIndex >= GraphSymbols.size() || !GraphSymbols[SymIndex])
+          return make_error<JITLinkError>(
+              "Relocation at offset " + formatv("{0:x8}", R.r_offset) +
+              " in " + BlockToFix.getSection().getName() +
+              " refers to unsupported symbol " + formatv("{0:d}", SymIndex));
+        Symbol &TargetSymbol = *GraphSymbols[SymIndex];
+
+        if (R.r_offset + getFixupSize(*Kind) > BlockToFix.getSize())
+          return make_error<JITLinkError>(
+              "Relocation extends past end of fixup block");
+
+        LLVM_DEBUG({
+          Edge GE(*Kind, R.r_offset, TargetSymbol, R.r_addend);
+          printEdge(dbgs(), BlockToFix, GE, getELFX86RelocationKindName(*Kind));
+          dbgs() << "\n";
+        });
+        BlockToFix.addEdge(*Kind, R.r_offset, TargetSymbol, R.r_addend);
+      }
+    }
+    return Error::success();
+  }
+
+  const object::ELFFile<ELFT> &Obj;
+  std::unique_ptr<LinkGraph> G;
+  ArrayRef<Elf_Shdr> Sections;
+  std::vector<Block *> SectionBlocks;
+  DenseMap<unsigned, Symbol *> SectionSymbols;
+  std::vector<Symbol *> GraphSymbols;
+  Section *CommonSection = nullptr;
+};
+
+class ELF_x86_64_GOTAndStubsBuilder
+    : public BasicGOTAndStubsBuilder<ELF_x86_64_GOTAndStubsBuilder> {
+public:
+  ELF_x86_64_GOTAndStubsBuilder(LinkGraph &G)
+      : BasicGOTAndStubsBuilder<ELF_x86_64_GOTAndStubsBuilder>(G) {}
+
+  bool isGOTEdge(Edge &E) const {
+    return E.getKind() == PCRel32GOTLoad ||
+           E.getKind() == PCRel32GOTLoadRelaxable;
+  }
+
+  Symbol &createGOTEntry(Symbol &Target) {
+    auto &GOTEntryBlock = G.createContentBlock(
+        getGOTSection(), getGOTEntryBlockContent(), 0, 8, 0);
+    GOTEntryBlock.addEdge(Pointer64, 0, Target, 0);
+    return G.addAnonymousSymbol(GOTEntryBlock, 0, 8, false, false);
+  }
+
+  void fixGOTEdge(Edge &E, Symbol &GOTEntry) {
+    assert(isGOTEdge(E) && "Not a GOT edge?");
+    // Keep the edge kind: relaxable loads may still be rewritten to address
+    // the target directly once addresses are known.
+    E.setTarget(GOTEntry);
+  }
+
+  bool isExternalBranchEdge(Edge &E) {
+    return E.getKind() == Branch32 && !E.getTarget().isDefined();
+  }
+
+  Symbol &createStub(Symbol &Target) {
+    auto &StubContentBlock =
+        G.createContentBlock(getStubsSection(), getStubBlockContent(), 0, 1, 0);
+    // Re-use GOT entries for stub targets.
+    auto &GOTEntrySymbol = getGOTEntrySymbol(Target);
+    StubContentBlock.addEdge(PCRel32, 2, GOTEntrySymbol, -4);
+    return G.addAnonymousSymbol(StubContentBlock, 0, 6, true, false);
+  }
+
+  void fixExternalBranchEdge(Edge &E, Symbol &Stub) {
+    assert(E.getKind() == Branch32 && "Not a Branch32 edge?");
+    E.setTarget(Stub);
+  }
+
+private:
+  Section &getGOTSection() {
+    if (!GOTSection)
+      GOTSection = &G.createSection(ELFGOTSectionName, sys::Memory::MF_READ);
+    return *GOTSection;
+  }
+
+  Section &getStubsSection() {
+    if (!StubsSection) {
+      auto StubsProt = static_cast<sys::Memory::ProtectionFlags>(
+          sys::Memory::MF_READ | sys::Memory::MF_EXEC);
+      StubsSection = &G.createSection(ELFStubsSectionName, StubsProt);
+    }
+    return *StubsSection;
+  }
+
+  StringRef getGOTEntryBlockContent() {
+    return StringRef(reinterpret_cast<const char *>(NullGOTEntryContent),
+                     sizeof(NullGOTEntryContent));
+  }
+
+  StringRef getStubBlockContent() {
+    return StringRef(reinterpret_cast<const char *>(StubContent),
+                     sizeof(StubContent));
+  }
+
+  static const uint8_t NullGOTEntryContent[8];
+  static const uint8_t StubContent[6];
+  Section *GOTSection = nullptr;
+  Section *StubsSection = nullptr;
+};
+
+const uint8_t ELF_x86_64_GOTAndStubsBuilder::NullGOTEntryContent[8] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+const uint8_t ELF_x86_64_GOTAndStubsBuilder::StubContent[6] = {
+    0xFF, 0x25, 0x00, 0x00, 0x00, 0x00};
+} // namespace
+
+namespace llvm {
+namespace jitlink {
+
+class ELFJITLinker_x86_64 : public JITLinker<ELFJITLinker_x86_64> {
+  friend class JITLinker<ELFJITLinker_x86_64>;
+
+public:
+  ELFJITLinker_x86_64(std::unique_ptr<JITLinkContext> Ctx,
+                      PassConfiguration PassConfig)
+      : JITLinker(std::move(Ctx), std::move(PassConfig)) {}
+
+private:
+  StringRef getEdgeKindName(Edge::Kind R) const override {
+    return getELFX86RelocationKindName(R);
+  }
+
+  Expected<std::unique_ptr<LinkGraph>>
+  buildGraph(MemoryBufferRef ObjBuffer) override {
+    auto ELFObj = object::ELFFile<object::ELF64LE>::create(
+        ObjBuffer.getBuffer());
+    if (!ELFObj)
+      return ELFObj.takeError();
+    return ELFLinkGraphBuilder_x86_64(ObjBuffer.getBufferIdentifier(),
+                                      *ELFObj)
+        .buildGraph();
+  }
+
+  static Error targetOutOfRangeError(const Block &B, const Edge &E) {
+    std::string ErrMsg;
+    {
+      raw_string_ostream ErrStream(ErrMsg);
+      ErrStream << "Relocation target out of range: ";
+      printEdge(ErrStream, B, E, getELFX86RelocationKindName(E.getKind()));
+      ErrStream << "\n";
+    }
+    return make_error<JITLinkError>(std::move(ErrMsg));
+  }
+
+  static bool isInt32(int64_t Value) {
+    return Value >= std::numeric_limits<int32_t>::min() &&
+           Value <= std::numeric_limits<int32_t>::max();
+  }
+
+  /// If Sym is a GOT entry or a stub created by the GOT-and-stubs builder,
+  /// return the symbol that it resolves to.
+  static Symbol *getIndirectionTarget(Symbol &Sym, StringRef SectionName) {
+    if (!Sym.isDefined() ||
+        Sym.getBlock().getSection().getName() != SectionName)
+      return nullptr;
+    auto &B = Sym.getBlock();
+    if (B.edges_size() != 1)
+      return nullptr;
+    return &B.edges().begin()->getTarget();
+  }
+
+  Error applyFixup(Block &B, const Edge &E, char *BlockWorkingMem) const {
+
+    using namespace support;
+
+    char *FixupPtr = BlockWorkingMem + E.getOffset();
+    JITTargetAddress FixupAddress = B.getAddress() + E.getOffset();
+
+    switch (E.getKind()) {
+    case Branch32: {
+      // Branch straight to an external target when it ended up close enough,
+      // skipping the stub and its GOT load.
+      if (auto *GOTEntry =
+              getIndirectionTarget(E.getTarget(), ELFStubsSectionName))
+        if (auto *Target = getIndirectionTarget(*GOTEntry, ELFGOTSectionName)) {
+          int64_t Value =
+              Target->getAddress() + E.getAddend() - FixupAddress;
+          if (isInt32(Value)) {
+            *(little32_t *)FixupPtr = Value;
+            break;
+          }
+        }
+      LLVM_FALLTHROUGH;
+    }
+    case PCRel32:
+    case PCRel32GOTLoad: {
+      int64_t Value = E.getTarget().getAddress() + E.getAddend() - FixupAddress;
+      if (!isInt32(Value))
+        return targetOutOfRangeError(B, E);
+      *(little32_t *)FixupPtr = Value;
+      break;
+    }
+    case PCRel32GOTLoadRelaxable: {
+      // Relax 'movq foo@GOTPCREL(%rip), %reg' to 'leaq foo(%rip), %reg' when
+      // foo is in range, as static linkers do for GOTPCRELX relocations.
+      if (E.getOffset() >= 2 &&
+          static_cast<uint8_t>(FixupPtr[-2]) == 0x8b)
+        if (auto *Target =
+                getIndirectionTarget(E.getTarget(), ELFGOTSectionName)) {
+          int64_t Value =
+              Target->getAddress() + E.getAddend() - FixupAddress;
+          if (isInt32(Value)) {
+            FixupPtr[-2] = static_cast<char>(0x8d);
+            *(little32_t *)FixupPtr = Value;
+            break;
+          }
+        }
+      int64_t Value = E.getTarget().getAddress() + E.getAddend() - FixupAddress;
+      if (!isInt32(Value))
+        return targetOutOfRangeError(B, E);
+      *(little32_t *)FixupPtr = Value;
+      break;
+    }
+    case PCRel64: {
+      int64_t Value = E.getTarget().getAddress() + E.getAddend() - FixupAddress;
+      *(little64_t *)FixupPtr = Value;
+      break;
+    }
+    case Pointer64: {
+      uint64_t Value = E.getTarget().getAddress() + E.getAddend();
+      *(ulittle64_t *)FixupPtr = Value;
+      break;
+    }
+    case Pointer32: {
+      uint64_t Value = E.getTarget().getAddress() + E.getAddend();
+      if (Value > std::numeric_limits<uint32_t>::max())
+        return targetOutOfRangeError(B, E);
+      *(ulittle32_t *)FixupPtr = Value;
+      break;
+    }
+    case Pointer32Signed: {
+      int64_t Value = E.getTarget().getAddress() + E.getAddend();
+      if (!isInt32(Value))
+        return targetOutOfRangeError(B, E);
+      *(little32_t *)FixupPtr = Value;
+      break;
+    }
+    default:
+      llvm_unreachable("Unrecognized edge kind");
+    }
+
+    return Error::success();
+  }
+};
+
+void jitLink_ELF_x86_64(std::unique_ptr<JITLinkContext> Ctx) {
+  PassConfiguration Config;
+  Triple TT("x86_64-unknown-linux");
+
+  if (Ctx->shouldAddDefaultTargetPasses(TT)) {
+    // Add a mark-live pass.
+    if (auto MarkLive = Ctx->getMarkLivePass(TT))
+      Config.PrePrunePasses.push_back(std::move(MarkLive));
+    else
+      Config.PrePrunePasses.push_back(markAllSymbolsLive);
+
+    // Add an in-place GOT/Stubs pass.
+    Config.PostPrunePasses.push_back([](LinkGraph &G) -> Error {
+      ELF_x86_64_GOTAndStubsBuilder(G).run();
+      return Error::success();
+    });
+  }
+
+  if (auto Err = Ctx->modifyPassConfig(TT, Config))
+    return Ctx->notifyFailed(std::move(Err));
+
+  // Construct a JITLinker and run the link function.
+  ELFJITLinker_x86_64::link(std::move(Ctx), std::move(Config));
+}
+
+StringRef getELFX86RelocationKindName(Edge::Kind R) {
+  switch (R) {
+  case Branch32:
+    return "Branch32";
+  case Pointer32:
+    return "Pointer32";
+  case Pointer32Signed:
+    return "Pointer32Signed";
+  case Pointer64:
+    return "Pointer64";
+  case PCRel32:
+    return "PCRel32";
+  case PCRel64:
+    return "PCRel64";
+  case PCRel32GOTLoad:
+    return "PCRel32GOTLoad";
+  case PCRel32GOTLoadRelaxable:
+    return "PCRel32GOTLoadRelaxable";
+  default:
+    return getGenericEdgeKindName(static_cast<Edge::Kind>(R));
+  }
+}
+
+} // end namespace jitlink
+} // end namespace llvm
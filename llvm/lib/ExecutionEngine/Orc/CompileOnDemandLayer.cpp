@@ -121,6 +121,25 @@ void CompileOnDemandLayer::setPartitionFunction(PartitionFunction Partition) {
 void CompileOnDemandLayer::setImplMap(ImplSymbolMap *Imp) {
   this->AliaseeImpls = Imp;
 }
+
+Error CompileOnDemandLayer::redirectStub(JITDylib &ImplD,
+                                         const SymbolStringPtr &Name,
+                                         JITTargetAddress NewAddr) {
+  std::lock_guard<std::mutex> Lock(CODLayerMutex);
+  for (auto &KV : DylibResources) {
+    auto &PDR = KV.second;
+    if (&PDR.getImplDylib() != &ImplD)
+      continue;
+    if (!PDR.getISManager().findPointer(*Name))
+      return make_error<StringError>("No stub for " + *Name + " in " +
+                                         KV.first->getName(),
+                                     inconvertibleErrorCode());
+    return PDR.getISManager().updatePointer(*Name, NewAddr);
+  }
+  return make_error<StringError>(ImplD.getName() +
+                                     " is not an implementation dylib",
+                                 inconvertibleErrorCode());
+}
 void CompileOnDemandLayer::emit(MaterializationResponsibility R,
                                 ThreadSafeModule TSM) {
   assert(TSM && "Null module");
@@ -169,6 +188,7 @@ void CompileOnDemandLayer::emit(MaterializationResponsibility R,
 
 CompileOnDemandLayer::PerDylibResources &
 CompileOnDemandLayer::getPerDylibResources(JITDylib &TargetD) {
+  std::lock_guard<std::mutex> Lock(CODLayerMutex);
   auto I = DylibResources.find(&TargetD);
   if (I == DylibResources.end()) {
     auto &ImplD = getExecutionSession().createJITDylib(
@@ -1089,6 +1089,8 @@ Error JITDylib::emit(const SymbolFlagsMap &Emitted) {
             // Since this dependant is now ready, we erase its MaterializingInfo
             // and update its materializing state.
             DependantSymEntry.setState(SymbolState::Ready);
+            DependantJD.addReadySymbol(DependantName,
+                                       DependantSymEntry.getSymbol());
 
             for (auto &Q : DependantMI.takeQueriesMeeting(SymbolState::Ready)) {
               Q->notifySymbolMetRequiredState(
@@ -1106,6 +1108,7 @@ Error JITDylib::emit(const SymbolFlagsMap &Emitted) {
       MI.Dependants.clear();
       if (MI.UnemittedDependencies.empty()) {
         SymI->second.setState(SymbolState::Ready);
+        addReadySymbol(Name, SymI->second.getSymbol());
         for (auto &Q : MI.takeQueriesMeeting(SymbolState::Ready)) {
           Q->notifySymbolMetRequiredState(Name, SymI->second.getSymbol());
           if (Q->isComplete())
@@ -1339,6 +1342,10 @@ Error JITDylib::remove(const SymbolNameSet &Names) {
       }
 
       auto SymI = SymbolMaterializerItrPair.first;
+      if (SymI->second.getState() == SymbolState::Ready) {
+        sys::ScopedWriter Lock(ReadySymbolsMutex);
+        ReadySymbols.erase(SymI->first);
+      }
       Symbols.erase(SymI);
     }
 
@@ -1638,6 +1645,21 @@ bool JITDylib::lookupImpl(
   return QueryComplete;
 }
 
+Optional<JITEvaluatedSymbol>
+JITDylib::lookupReadySymbol(const SymbolStringPtr &Name) {
+  sys::ScopedReader Lock(ReadySymbolsMutex);
+  auto I = ReadySymbols.find(Name);
+  if (I == ReadySymbols.end())
+    return None;
+  return I->second;
+}
+
+void JITDylib::addReadySymbol(const SymbolStringPtr &Name,
+                              JITEvaluatedSymbol Sym) {
+  sys::ScopedWriter Lock(ReadySymbolsMutex);
+  ReadySymbols[Name] = Sym;
+}
+
 void JITDylib::dump(raw_ostream &OS) {
   ES.runSessionLocked([&, this]() {
     OS << "JITDylib \"" << JITDylibName << "\" (ES: "
@@ -1931,6 +1953,30 @@ Expected<SymbolMap> ExecutionSession::legacyLookup(
 #endif
 }
 
+Optional<SymbolMap>
+ExecutionSession::lookupReadySymbols(const JITDylibSearchList &SearchOrder,
+                                     const SymbolNameSet &Symbols) {
+  SymbolMap Result;
+  for (auto &Name : Symbols) {
+    bool Found = false;
+    for (auto &KV : SearchOrder) {
+      auto Sym = KV.first->lookupReadySymbol(Name);
+      // The symbol may still be defined, but not ready, in this dylib. Only
+      // the full lookup can tell, so give up.
+      if (!Sym)
+        return None;
+      if (!Sym->getFlags().isExported() && !KV.second)
+        continue;
+      Result[Name] = *Sym;
+      Found = true;
+      break;
+    }
+    if (!Found)
+      return None;
+  }
+  return std::move(Result);
+}
+
 void ExecutionSession::lookup(
     const JITDylibSearchList &SearchOrder, SymbolNameSet Symbols,
     SymbolState RequiredState, SymbolsResolvedCallback NotifyComplete,
@@ -1943,6 +1989,13 @@ void ExecutionSession::lookup(
     });
   });
 
+  // Ready symbols meet every required state and have no dependencies to
+  // register, so lookups of ready symbols can skip the session lock.
+  if (auto Result = lookupReadySymbols(SearchOrder, Symbols)) {
+    NotifyComplete(std::move(*Result));
+    return;
+  }
+
   // lookup can be re-entered recursively if running on a single thread. Run any
   // outstanding MUs in case this query depends on them, otherwise this lookup
   // will starve waiting for a result from an MU that is stuck in the queue.
@@ -2027,6 +2080,10 @@ ExecutionSession::lookup(const JITDylibSearchList &SearchOrder,
                          const SymbolNameSet &Symbols,
                          SymbolState RequiredState,
                          RegisterDependenciesFunction RegisterDependencies) {
+  // Avoid the cost of an asynchronous query for symbols that are ready.
+  if (auto Result = lookupReadySymbols(SearchOrder, Symbols))
+    return std::move(*Result);
+
 #if LLVM_ENABLE_THREADS
   // In the threaded case we use promises to return the results.
   std::promise<SymbolMap> PromisedResult;
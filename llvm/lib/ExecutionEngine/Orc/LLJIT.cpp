@@ -28,8 +28,8 @@ Error LLJITBuilderState::prepareForConstruction() {
 }
 
 LLJIT::~LLJIT() {
-  if (CompileThreads)
-    CompileThreads->wait();
+  if (Dispatcher)
+    Dispatcher->wait();
 }
 
 Error LLJIT::defineAbsolute(StringRef Name, JITEvaluatedSymbol Sym) {
@@ -91,14 +91,14 @@ LLJIT::createCompileFunction(LLJITBuilderState &S,
 
   // Otherwise default to creating a SimpleCompiler, or ConcurrentIRCompiler,
   // depending on the number of threads requested.
-  if (S.NumCompileThreads > 0)
-    return ConcurrentIRCompiler(std::move(JTMB));
+  if (S.NumCompileThreads > 0 || S.Dispatcher)
+    return ConcurrentIRCompiler(std::move(JTMB), S.ObjCache.get());
 
   auto TM = JTMB.createTargetMachine();
   if (!TM)
     return TM.takeError();
 
-  return TMOwningSimpleCompiler(std::move(*TM));
+  return TMOwningSimpleCompiler(std::move(*TM), S.ObjCache.get());
 }
 
 LLJIT::LLJIT(LLJITBuilderState &S, Error &Err)
@@ -125,18 +125,19 @@ LLJIT::LLJIT(LLJITBuilderState &S, Error &Err)
     }
     CompileLayer = std::make_unique<IRCompileLayer>(
         *ES, *ObjLinkingLayer, std::move(*CompileFunction));
+    // The compile function refers to the cache, so keep it alive with us.
+    ObjCache = std::move(S.ObjCache);
   }
 
-  if (S.NumCompileThreads > 0) {
+  if (S.Dispatcher)
+    Dispatcher = std::move(S.Dispatcher);
+  else if (S.NumCompileThreads > 0)
+    Dispatcher =
+        std::make_unique<PriorityThreadPoolTaskDispatcher>(S.NumCompileThreads);
+
+  if (Dispatcher) {
     CompileLayer->setCloneToNewContextOnEmit(true);
-    CompileThreads = std::make_unique<ThreadPool>(S.NumCompileThreads);
-    ES->setDispatchMaterialization(
-        [this](JITDylib &JD, std::unique_ptr<MaterializationUnit> MU) {
-          // FIXME: Switch to move capture once we have c++14.
-          auto SharedMU = std::shared_ptr<MaterializationUnit>(std::move(MU));
-          auto Work = [SharedMU, &JD]() { SharedMU->doMaterialize(JD); };
-          CompileThreads->async(std::move(Work));
-        });
+    useTaskDispatcher(*ES, *Dispatcher);
   }
 }
 
@@ -232,7 +233,7 @@ LLLazyJIT::LLLazyJIT(LLLazyJITBuilderState &S, Error &Err) : LLJIT(S, Err) {
   CODLayer = std::make_unique<CompileOnDemandLayer>(
       *ES, *TransformLayer, *LCTMgr, std::move(ISMBuilder));
 
-  if (S.NumCompileThreads > 0)
+  if (Dispatcher)
     CODLayer->setCloneToNewContextOnEmit(true);
 }
 
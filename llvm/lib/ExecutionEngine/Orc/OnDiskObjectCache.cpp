@@ -0,0 +1,171 @@
+//===--------- OnDiskObjectCache.cpp - Persistent object cache for ORC ----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/OnDiskObjectCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/Errc.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+
+#define DEBUG_TYPE "orc"
+
+namespace llvm {
+namespace orc {
+
+Expected<std::unique_ptr<OnDiskObjectCache>>
+OnDiskObjectCache::Create(StringRef Dir, const JITTargetMachineBuilder &JTMB,
+                          Optional<CachePruningPolicy> Policy) {
+  return Create(Dir, getTargetKey(JTMB), std::move(Policy));
+}
+
+Expected<std::unique_ptr<OnDiskObjectCache>>
+OnDiskObjectCache::Create(StringRef Dir, std::string TargetKey,
+                          Optional<CachePruningPolicy> Policy) {
+  if (auto EC = sys::fs::create_directories(Dir))
+    return createFileError(Dir, EC);
+  return std::unique_ptr<OnDiskObjectCache>(
+      new OnDiskObjectCache(Dir, std::move(TargetKey), std::move(Policy)));
+}
+
+std::string
+OnDiskObjectCache::getTargetKey(const JITTargetMachineBuilder &JTMB) {
+  std::string Key;
+  raw_string_ostream OS(Key);
+  OS << "llvm-" << LLVM_VERSION_STRING << ";" << JTMB.getTargetTriple().str()
+     << ";" << JTMB.getCPU() << ";" << JTMB.getFeatures().getString() << ";";
+
+  if (auto &RM = JTMB.getRelocationModel())
+    OS << "rm" << static_cast<int>(*RM);
+  OS << ";";
+  if (auto &CM = JTMB.getCodeModel())
+    OS << "cm" << static_cast<int>(*CM);
+  OS << ";O" << static_cast<int>(JTMB.getCodeGenOptLevel()) << ";";
+
+  auto &Options = JTMB.getOptions();
+  OS << Options.UnsafeFPMath << Options.NoInfsFPMath << Options.NoNaNsFPMath
+     << Options.NoTrappingFPMath << Options.NoSignedZerosFPMath
+     << Options.GuaranteedTailCallOpt << Options.EnableFastISel
+     << Options.EnableGlobalISel << Options.FunctionSections
+     << Options.DataSections << Options.EmulatedTLS
+     << Options.ExplicitEmulatedTLS << ";"
+     << static_cast<int>(Options.FloatABIType) << ","
+     << static_cast<int>(Options.AllowFPOpFusion) << ","
+     << static_cast<int>(Options.ThreadModel) << ","
+     << static_cast<int>(Options.ExceptionModel) << ","
+     << static_cast<int>(Options.EABIVersion);
+  return OS.str();
+}
+
+std::string OnDiskObjectCache::computeKey(const Module &M) const {
+  SmallVector<char, 0> Buffer;
+  {
+    raw_svector_ostream OS(Buffer);
+    WriteBitcodeToFile(M, OS);
+  }
+
+  SHA1 Hasher;
+  Hasher.update(TargetKey);
+  Hasher.update(StringRef(Buffer.data(), Buffer.size()));
+  return toHex(Hasher.final());
+}
+
+std::string OnDiskObjectCache::getEntryPath(StringRef Key) const {
+  // This choice of file name allows the cache to be pruned (see pruneCache()
+  // in include/llvm/Support/CachePruning.h).
+  SmallString<128> EntryPath;
+  sys::path::append(EntryPath, Dir, "llvmcache-" + Key);
+  return EntryPath.str();
+}
+
+std::unique_ptr<MemoryBuffer> OnDiskObjectCache::getObject(const Module *M) {
+  std::string Key = computeKey(*M);
+  std::string EntryPath = getEntryPath(Key);
+
+  // Update the access time so that the pruner keeps recently used entries.
+  Expected<sys::fs::file_t> FDOrErr =
+      sys::fs::openNativeFileForRead(EntryPath, sys::fs::OF_UpdateAtime);
+  if (FDOrErr) {
+    auto MBOrErr = MemoryBuffer::getOpenFile(*FDOrErr, EntryPath,
+                                             /*FileSize=*/-1,
+                                             /*RequiresNullTerminator=*/false);
+    sys::fs::closeFile(*FDOrErr);
+    if (MBOrErr) {
+      LLVM_DEBUG(dbgs() << "Object cache hit for " << M->getModuleIdentifier()
+                        << "\n");
+      return std::move(*MBOrErr);
+    }
+  } else
+    consumeError(FDOrErr.takeError());
+
+  // Treat unreadable entries as misses: they are replaced by the store below.
+  LLVM_DEBUG(dbgs() << "Object cache miss for " << M->getModuleIdentifier()
+                    << "\n");
+  std::lock_guard<std::mutex> Lock(PendingKeysMutex);
+  PendingKeys[M] = std::move(Key);
+  return nullptr;
+}
+
+void OnDiskObjectCache::notifyObjectCompiled(const Module *M,
+                                             MemoryBufferRef Obj) {
+  std::string Key;
+  {
+    std::lock_guard<std::mutex> Lock(PendingKeysMutex);
+    auto I = PendingKeys.find(M);
+    if (I == PendingKeys.end())
+      return;
+    Key = std::move(I->second);
+    PendingKeys.erase(I);
+  }
+
+  // Failing to store an object only costs a recompile later, so errors are
+  // not reported to the JIT.
+  auto LogError = [&](Error Err) {
+    LLVM_DEBUG(dbgs() << "Could not store object for "
+                      << M->getModuleIdentifier() << ": " << Err << "\n");
+    consumeError(std::move(Err));
+  };
+
+  // Write to a temporary file first, so that other processes never see a
+  // partial entry.
+  SmallString<128> TempFilenameModel;
+  sys::path::append(TempFilenameModel, Dir, "Orc-%%%%%%.tmp.o");
+  auto Temp = sys::fs::TempFile::create(
+      TempFilenameModel, sys::fs::owner_read | sys::fs::owner_write);
+  if (!Temp)
+    return LogError(Temp.takeError());
+
+  {
+    raw_fd_ostream OS(Temp->FD, /*shouldClose=*/false);
+    OS << Obj.getBuffer();
+    OS.flush();
+    if (OS.has_error()) {
+      std::error_code EC = OS.error();
+      OS.clear_error();
+      consumeError(Temp->discard());
+      return LogError(createFileError(Temp->TmpName, EC));
+    }
+  }
+
+  if (auto Err = Temp->keep(getEntryPath(Key)))
+    return LogError(std::move(Err));
+
+  if (Policy)
+    pruneCache(Dir, *Policy);
+}
+
+} // end namespace orc
+} // end namespace llvm
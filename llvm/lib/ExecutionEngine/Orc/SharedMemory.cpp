@@ -0,0 +1,124 @@
+//===------- SharedMemory.cpp - Named shared memory for remote JITing -----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/SharedMemory.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/Errno.h"
+#include <atomic>
+
+#ifdef LLVM_ON_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace llvm {
+namespace orc {
+
+#ifdef LLVM_ON_UNIX
+
+static int getMMapProtFlags(unsigned Flags) {
+  int Prot = PROT_NONE;
+  if (Flags & sys::Memory::MF_READ)
+    Prot |= PROT_READ;
+  if (Flags & sys::Memory::MF_WRITE)
+    Prot |= PROT_WRITE;
+  if (Flags & sys::Memory::MF_EXEC)
+    Prot |= PROT_EXEC;
+  return Prot;
+}
+
+static Error sharedMemoryError(const Twine &Msg, StringRef Name) {
+  int ErrNo = errno;
+  return make_error<StringError>(
+      Msg + " \"" + Name + "\": " + sys::StrError(ErrNo),
+      std::error_code(ErrNo, std::generic_category()));
+}
+
+// Map Size bytes of the shared memory object open as FD, and close FD.
+static Expected<sys::MemoryBlock> mapAndClose(int FD, StringRef Name,
+                                              uint64_t Size, unsigned Flags) {
+  void *Addr =
+      ::mmap(nullptr, Size, getMMapProtFlags(Flags), MAP_SHARED, FD, 0);
+  if (Addr == MAP_FAILED) {
+    auto Err = sharedMemoryError("Could not map shared memory", Name);
+    ::close(FD);
+    return std::move(Err);
+  }
+  ::close(FD);
+  return sys::MemoryBlock(Addr, Size);
+}
+
+bool isSharedMemorySupported() { return true; }
+
+std::string getUniqueSharedMemoryName() {
+  static std::atomic<uint64_t> NextID(0);
+  return "/llvm-orc-" + std::to_string(::getpid()) + "-" +
+         std::to_string(NextID++);
+}
+
+Expected<sys::MemoryBlock> createSharedMemory(StringRef Name, uint64_t Size) {
+  std::string NameStr = Name.str();
+  int FD = ::shm_open(NameStr.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (FD < 0)
+    return sharedMemoryError("Could not create shared memory", Name);
+  if (::ftruncate(FD, Size) < 0) {
+    auto Err = sharedMemoryError("Could not size shared memory", Name);
+    ::close(FD);
+    ::shm_unlink(NameStr.c_str());
+    return std::move(Err);
+  }
+  auto MB = mapAndClose(FD, Name, Size,
+                        sys::Memory::MF_READ | sys::Memory::MF_WRITE);
+  if (!MB)
+    ::shm_unlink(NameStr.c_str());
+  return MB;
+}
+
+Expected<sys::MemoryBlock> mapSharedMemory(StringRef Name, uint64_t Size,
+                                           unsigned Flags) {
+  // Open read/write even for a read-only mapping so that the protections can
+  // be raised later with mprotect.
+  int FD = ::shm_open(Name.str().c_str(), O_RDWR, 0600);
+  if (FD < 0)
+    return sharedMemoryError("Could not open shared memory", Name);
+  return mapAndClose(FD, Name, Size, Flags);
+}
+
+Error unlinkSharedMemory(StringRef Name) {
+  if (::shm_unlink(Name.str().c_str()) < 0)
+    return sharedMemoryError("Could not unlink shared memory", Name);
+  return Error::success();
+}
+
+#else
+
+static Error sharedMemoryUnsupported() {
+  return make_error<StringError>("Shared memory is not supported on this host",
+                                 inconvertibleErrorCode());
+}
+
+bool isSharedMemorySupported() { return false; }
+
+std::string getUniqueSharedMemoryName() { return std::string(); }
+
+Expected<sys::MemoryBlock> createSharedMemory(StringRef Name, uint64_t Size) {
+  return sharedMemoryUnsupported();
+}
+
+Expected<sys::MemoryBlock> mapSharedMemory(StringRef Name, uint64_t Size,
+                                           unsigned Flags) {
+  return sharedMemoryUnsupported();
+}
+
+Error unlinkSharedMemory(StringRef Name) { return sharedMemoryUnsupported(); }
+
+#endif
+
+} // end namespace orc
+} // end namespace llvm
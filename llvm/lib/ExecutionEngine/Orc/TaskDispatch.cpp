@@ -0,0 +1,229 @@
+//===------------ TaskDispatch.cpp - Materialization dispatchers ----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/TaskDispatch.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "orc"
+
+namespace llvm {
+namespace orc {
+
+static LLVM_THREAD_LOCAL MaterializationPriority CurrentPriority =
+    MaterializationPriority::OnDemand;
+
+MaterializationPriority getCurrentMaterializationPriority() {
+  return CurrentPriority;
+}
+
+MaterializationPriorityScope::MaterializationPriorityScope(
+    MaterializationPriority P)
+    : Prev(CurrentPriority) {
+  CurrentPriority = P;
+}
+
+MaterializationPriorityScope::~MaterializationPriorityScope() {
+  CurrentPriority = Prev;
+}
+
+MaterializationTask::MaterializationTask(
+    JITDylib &JD, std::unique_ptr<MaterializationUnit> MU,
+    MaterializationPriority Priority)
+    : JD(JD), MU(std::move(MU)), Name(this->MU->getName()),
+      Priority(Priority), DispatchTime(ClockT::now()) {}
+
+void MaterializationTask::run() {
+  assert(MU && "Task has already been run or cancelled");
+  MaterializationPriorityScope Scope(Priority);
+  MU->doMaterialize(JD);
+  // Release whatever the unit holds (e.g. a module) as soon as possible.
+  MU.reset();
+}
+
+void MaterializationTask::cancel() {
+  assert(MU && "Task has already been run or cancelled");
+  LLVM_DEBUG(dbgs() << "Cancelling " << Name << " for " << JD.getName()
+                    << "\n");
+  MU->doFail(JD);
+  MU.reset();
+}
+
+TaskDispatcher::~TaskDispatcher() {}
+
+void TaskDispatcher::runTask(MaterializationTask &T) {
+  if (!Trace) {
+    T.run();
+    return;
+  }
+
+  auto Start = MaterializationTask::ClockT::now();
+  T.run();
+  auto End = MaterializationTask::ClockT::now();
+  Trace(T, Start - T.getDispatchTime(), End - Start);
+}
+
+PriorityThreadPoolTaskDispatcher::PriorityThreadPoolTaskDispatcher(
+    unsigned NumThreads) {
+  assert(NumThreads > 0 && "Can not run tasks without threads");
+  Threads.reserve(NumThreads);
+  for (unsigned I = 0; I != NumThreads; ++I)
+    Threads.emplace_back([this]() { work(); });
+}
+
+PriorityThreadPoolTaskDispatcher::~PriorityThreadPoolTaskDispatcher() {
+  // Running tasks may dispatch more work, so let everything finish before
+  // telling the threads to stop.
+  wait();
+  {
+    std::lock_guard<std::mutex> Lock(QueueMutex);
+    Stopping = true;
+  }
+  QueueChanged.notify_all();
+  for (auto &T : Threads)
+    T.join();
+}
+
+void PriorityThreadPoolTaskDispatcher::dispatch(
+    std::unique_ptr<MaterializationTask> T) {
+  {
+    std::lock_guard<std::mutex> Lock(QueueMutex);
+    assert(!Stopping && "Dispatch after shutdown");
+    Queues[static_cast<unsigned>(T->getPriority())].push_back(std::move(T));
+  }
+  QueueChanged.notify_one();
+}
+
+size_t PriorityThreadPoolTaskDispatcher::cancelPendingTasks() {
+  std::vector<std::unique_ptr<MaterializationTask>> Cancelled;
+  {
+    std::lock_guard<std::mutex> Lock(QueueMutex);
+    for (auto &Q : Queues) {
+      for (auto &T : Q)
+        Cancelled.push_back(std::move(T));
+      Q.clear();
+    }
+  }
+
+  // Failing the symbols notifies queries, which may dispatch more work, so
+  // this is done without holding the lock.
+  for (auto &T : Cancelled)
+    T->cancel();
+
+  {
+    std::lock_guard<std::mutex> Lock(QueueMutex);
+    if (NumRunning == 0 && !hasPendingTasks())
+      Idle.notify_all();
+  }
+  return Cancelled.size();
+}
+
+void PriorityThreadPoolTaskDispatcher::wait() {
+  std::unique_lock<std::mutex> Lock(QueueMutex);
+  Idle.wait(Lock, [this]() { return NumRunning == 0 && !hasPendingTasks(); });
+}
+
+bool PriorityThreadPoolTaskDispatcher::hasPendingTasks() const {
+  for (auto &Q : Queues)
+    if (!Q.empty())
+      return true;
+  return false;
+}
+
+void PriorityThreadPoolTaskDispatcher::work() {
+  while (true) {
+    std::unique_ptr<MaterializationTask> T;
+    {
+      std::unique_lock<std::mutex> Lock(QueueMutex);
+      QueueChanged.wait(Lock,
+                        [this]() { return Stopping || hasPendingTasks(); });
+      // Only stop once the queues have been drained.
+      if (!hasPendingTasks())
+        return;
+      for (auto &Q : Queues)
+        if (!Q.empty()) {
+          T = std::move(Q.front());
+          Q.pop_front();
+          break;
+        }
+      ++NumRunning;
+    }
+
+    runTask(*T);
+    T.reset();
+
+    std::lock_guard<std::mutex> Lock(QueueMutex);
+    if (--NumRunning == 0 && !hasPendingTasks())
+      Idle.notify_all();
+  }
+}
+
+void ExternalTaskDispatcher::dispatch(std::unique_ptr<MaterializationTask> T) {
+  auto Priority = T->getPriority();
+  uint64_t Id;
+  {
+    std::lock_guard<std::mutex> Lock(PendingMutex);
+    Id = NextId++;
+    Pending[Id] = std::move(T);
+  }
+  Executor(Priority, [this, Id]() { runPendingTask(Id); });
+}
+
+size_t ExternalTaskDispatcher::cancelPendingTasks() {
+  std::map<uint64_t, std::unique_ptr<MaterializationTask>> Cancelled;
+  {
+    std::lock_guard<std::mutex> Lock(PendingMutex);
+    std::swap(Cancelled, Pending);
+  }
+
+  for (auto &KV : Cancelled)
+    KV.second->cancel();
+
+  {
+    std::lock_guard<std::mutex> Lock(PendingMutex);
+    if (NumRunning == 0 && Pending.empty())
+      Idle.notify_all();
+  }
+  return Cancelled.size();
+}
+
+void ExternalTaskDispatcher::wait() {
+  std::unique_lock<std::mutex> Lock(PendingMutex);
+  Idle.wait(Lock, [this]() { return NumRunning == 0 && Pending.empty(); });
+}
+
+void ExternalTaskDispatcher::runPendingTask(uint64_t Id) {
+  std::unique_ptr<MaterializationTask> T;
+  {
+    std::lock_guard<std::mutex> Lock(PendingMutex);
+    auto I = Pending.find(Id);
+    if (I == Pending.end())
+      return;
+    T = std::move(I->second);
+    Pending.erase(I);
+    ++NumRunning;
+  }
+
+  runTask(*T);
+  T.reset();
+
+  std::lock_guard<std::mutex> Lock(PendingMutex);
+  if (--NumRunning == 0 && Pending.empty())
+    Idle.notify_all();
+}
+
+void useTaskDispatcher(ExecutionSession &ES, TaskDispatcher &D) {
+  ES.setDispatchMaterialization(
+      [&D](JITDylib &JD, std::unique_ptr<MaterializationUnit> MU) {
+        D.dispatch(std::make_unique<MaterializationTask>(
+            JD, std::move(MU), getCurrentMaterializationPriority()));
+      });
+}
+
+} // End namespace orc
+} // End namespace llvm
@@ -0,0 +1,207 @@
+//===------ TieredCompilation.cpp - Utilities for tiered compilation ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/TieredCompilation.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/MDBuilder.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Type.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "orc"
+
+namespace llvm {
+namespace orc {
+
+TieredCompiler::TieredCompiler(ExecutionSession &ES, IRLayer &OptimizeLayer,
+                               MangleAndInterner &Mangle,
+                               RedirectFunction Redirect,
+                               unsigned NumRecompileThreads)
+    : ES(ES), OptimizeLayer(OptimizeLayer), Mangle(Mangle),
+      Redirect(std::move(Redirect)), RecompileThreads(NumRecompileThreads) {
+  assert(NumRecompileThreads > 0 && "Tiering needs a recompile thread");
+}
+
+TieredCompiler::~TieredCompiler() { waitForRecompiles(); }
+
+void TieredCompiler::tierUpEntryPoint(TieredCompiler *Ptr, uint64_t Id) {
+  assert(Ptr && " Null Address Received in orc_tier_up ");
+  Ptr->tierUp(Id);
+}
+
+Error TieredCompiler::addTieringRuntime(JITDylib &JD) {
+  JITEvaluatedSymbol ThisPtr(pointerToJITTargetAddress(this),
+                             JITSymbolFlags::Exported);
+  JITEvaluatedSymbol TierUpEntryPtr(
+      pointerToJITTargetAddress(&tierUpEntryPoint), JITSymbolFlags::Exported);
+  return JD.define(absoluteSymbols({
+      {Mangle("__orc_tiering_manager"), ThisPtr}, // Data Symbol
+      {Mangle("__orc_tier_up"), TierUpEntryPtr}   // Callable Symbol
+  }));
+}
+
+TieredCompiler::FunctionId
+TieredCompiler::addCandidate(JITDylib &ImplJD, StringRef Name,
+                             ThreadSafeModule TSM) {
+  std::lock_guard<std::mutex> Lock(TieringMutex);
+  Candidates.push_back({&ImplJD, Name, std::move(TSM)});
+  return Candidates.size() - 1;
+}
+
+void TieredCompiler::tierUp(FunctionId Id) {
+  JITDylib *ImplJD;
+  std::string Name;
+  ThreadSafeModule TSM;
+  {
+    std::lock_guard<std::mutex> Lock(TieringMutex);
+    assert(Id < Candidates.size() && "Unknown tiering candidate");
+    auto &C = Candidates[Id];
+    // Only the first report for a candidate starts a recompile.
+    if (!C.TSM)
+      return;
+    ImplJD = C.ImplJD;
+    Name = C.Name;
+    TSM = std::move(C.TSM);
+  }
+
+  LLVM_DEBUG(dbgs() << "Tiering up " << Name << " in " << ImplJD->getName()
+                    << "\n");
+
+  // This runs on the thread that reported the function hot, so leave the
+  // compile to the pool. ThreadPool tasks must be copyable, so the module is
+  // handed over through a shared_ptr.
+  auto SharedTSM = std::make_shared<ThreadSafeModule>(std::move(TSM));
+  RecompileThreads.async([this, ImplJD, Name, SharedTSM]() {
+    recompile(*ImplJD, Name, std::move(*SharedTSM));
+  });
+}
+
+void TieredCompiler::recompile(JITDylib &ImplJD, StringRef Name,
+                               ThreadSafeModule TSM) {
+  // Give the optimized body its own name so that it can live in the same
+  // dylib as the original, and resolve its references the same way.
+  std::string TierName = (Name + ".tier1").str();
+  TSM.withModuleDo([&](Module &M) {
+    auto *F = M.getFunction(Name);
+    assert(F && !F->isDeclaration() && "Candidate body not in module?");
+    F->setName(TierName);
+  });
+
+  if (auto Err = OptimizeLayer.add(ImplJD, std::move(TSM))) {
+    ES.reportError(std::move(Err));
+    return;
+  }
+
+  auto TierSym = ES.lookup(JITDylibSearchList({{&ImplJD, true}}),
+                           Mangle(TierName));
+  if (!TierSym) {
+    ES.reportError(TierSym.takeError());
+    return;
+  }
+
+  // Callers that are already in the old body finish there; new calls go
+  // through the stub to the optimized body.
+  if (auto Err = Redirect(ImplJD, Mangle(Name), TierSym->getAddress()))
+    ES.reportError(std::move(Err));
+}
+
+/// Count calls to F in a per-function counter, and report F to the tiering
+/// manager when the count reaches HotCallCount. The counter is bumped with an
+/// atomic add so that exactly one call, even among concurrent ones, sees the
+/// hot count.
+static void instrumentForTiering(Function &F, uint64_t HotCallCount,
+                                 TieredCompiler::FunctionId Id,
+                                 FunctionCallee TierUp, Constant *Manager) {
+  auto &MContext = F.getContext();
+  auto *CounterTy = Type::getInt64Ty(MContext);
+  auto *Counter = new GlobalVariable(
+      *F.getParent(), CounterTy, false, GlobalValue::InternalLinkage,
+      ConstantInt::get(CounterTy, 0), "__orc_tiering.count.for." + F.getName());
+  Counter->setAlignment(MaybeAlign(8));
+  Counter->setUnnamedAddr(GlobalValue::UnnamedAddr::Local);
+
+  // Keep the entry block's static allocas where they are, and count calls
+  // right after them.
+  BasicBlock &Entry = F.getEntryBlock();
+  auto SplitPt = Entry.begin();
+  while (isa<AllocaInst>(*SplitPt))
+    ++SplitPt;
+  BasicBlock *Body = Entry.splitBasicBlock(SplitPt, "__orc_tiering.body");
+  Entry.getTerminator()->eraseFromParent();
+  BasicBlock *TierUpBlock =
+      BasicBlock::Create(MContext, "__orc_tiering.tier_up", &F, Body);
+
+  IRBuilder<> Mutator(&Entry);
+  auto *OldCount =
+      Mutator.CreateAtomicRMW(AtomicRMWInst::Add, Counter,
+                              ConstantInt::get(CounterTy, 1),
+                              AtomicOrdering::Monotonic);
+  auto *IsHot = Mutator.CreateICmpEQ(
+      OldCount, ConstantInt::get(CounterTy, HotCallCount - 1), "is.hot");
+  Mutator.CreateCondBr(IsHot, TierUpBlock, Body,
+                       MDBuilder(MContext).createBranchWeights(1, 1 << 20));
+
+  Mutator.SetInsertPoint(TierUpBlock);
+  Mutator.CreateCall(TierUp, {Manager, ConstantInt::get(CounterTy, Id)});
+  Mutator.CreateBr(Body);
+}
+
+void IRTieringLayer::emit(MaterializationResponsibility R,
+                          ThreadSafeModule TSM) {
+  assert(TSM && "Tiering Layer received Null Module ?");
+
+  std::vector<std::string> FunctionNames;
+  TSM.withModuleDo([&](Module &M) {
+    for (auto &F : M.functions())
+      if (!F.isDeclaration() && !F.hasLocalLinkage() &&
+          !F.hasAvailableExternallyLinkage())
+        FunctionNames.push_back(F.getName());
+  });
+
+  if (FunctionNames.empty()) {
+    BaseLayer.emit(std::move(R), std::move(TSM));
+    return;
+  }
+
+  // Keep an uninstrumented copy of each function to recompile from. Each
+  // copy lives on its own context, so recompiles don't need the lock for
+  // this module.
+  std::vector<TieredCompiler::FunctionId> Ids;
+  for (auto &Name : FunctionNames) {
+    auto Copy = cloneToNewContext(
+        TSM, [&](const GlobalValue &GV) { return GV.getName() == Name; });
+    Ids.push_back(
+        Tiers.addCandidate(R.getTargetJITDylib(), Name, std::move(Copy)));
+  }
+
+  TSM.withModuleDo([&](Module &M) {
+    auto &MContext = M.getContext();
+    auto *ManagerTy = StructType::create(MContext, "Class.TieredCompiler");
+    auto TierUp = M.getOrInsertFunction(
+        "__orc_tier_up", Type::getVoidTy(MContext), ManagerTy->getPointerTo(),
+        Type::getInt64Ty(MContext));
+    auto *Manager = M.getOrInsertGlobal("__orc_tiering_manager", ManagerTy);
+
+    for (size_t I = 0; I != FunctionNames.size(); ++I)
+      instrumentForTiering(*M.getFunction(FunctionNames[I]), HotCallCount,
+                           Ids[I], TierUp, Manager);
+  });
+
+  assert(!TSM.withModuleDo([](const Module &M) { return verifyModule(M); }) &&
+         "Tiering Instrumentation breaks IR?");
+
+  BaseLayer.emit(std::move(R), std::move(TSM));
+}
+
+} // namespace orc
+} // namespace llvm
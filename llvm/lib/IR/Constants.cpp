@@ -608,6 +608,7 @@ ConstantInt::ConstantInt(IntegerType *Ty, const APInt &V)
 
 ConstantInt *ConstantInt::getTrue(LLVMContext &Context) {
   LLVMContextImpl *pImpl = Context.pImpl;
+  UniquingLock Lock(pImpl, pImpl->ConstantsMutex);
   if (!pImpl->TheTrueVal)
     pImpl->TheTrueVal = ConstantInt::get(Type::getInt1Ty(Context), 1);
   return pImpl->TheTrueVal;
@@ -615,6 +616,7 @@ ConstantInt *ConstantInt::getTrue(LLVMContext &Context) {
 
 ConstantInt *ConstantInt::getFalse(LLVMContext &Context) {
   LLVMContextImpl *pImpl = Context.pImpl;
+  UniquingLock Lock(pImpl, pImpl->ConstantsMutex);
   if (!pImpl->TheFalseVal)
     pImpl->TheFalseVal = ConstantInt::get(Type::getInt1Ty(Context), 0);
   return pImpl->TheFalseVal;
@@ -640,6 +642,7 @@ Constant *ConstantInt::getFalse(Type *Ty) {
 ConstantInt *ConstantInt::get(LLVMContext &Context, const APInt &V) {
   // get an existing value or the insertion position
   LLVMContextImpl *pImpl = Context.pImpl;
+  UniquingLock Lock(pImpl, pImpl->ConstantsMutex);
   std::unique_ptr<ConstantInt> &Slot = pImpl->IntConstants[V];
   if (!Slot) {
     // Get the corresponding integer type for the bit width of the value.
@@ -810,6 +813,7 @@ Constant *ConstantFP::getZeroValueForNegation(Type *Ty) {
 // ConstantFP accessors.
 ConstantFP* ConstantFP::get(LLVMContext &Context, const APFloat& V) {
   LLVMContextImpl* pImpl = Context.pImpl;
+  UniquingLock Lock(pImpl, pImpl->ConstantsMutex);
 
   std::unique_ptr<ConstantFP> &Slot = pImpl->FPConstants[V];
 
@@ -1160,6 +1164,7 @@ Constant *ConstantVector::getSplat(unsigned NumElts, Constant *V) {
 
 ConstantTokenNone *ConstantTokenNone::get(LLVMContext &Context) {
   LLVMContextImpl *pImpl = Context.pImpl;
+  UniquingLock Lock(pImpl, pImpl->ConstantsMutex);
   if (!pImpl->TheNoneToken)
     pImpl->TheNoneToken.reset(new ConstantTokenNone(Context));
   return pImpl->TheNoneToken.get();
@@ -1364,6 +1369,8 @@ ConstantAggregateZero *ConstantAggregateZero::get(Type *Ty) {
   assert((Ty->isStructTy() || Ty->isArrayTy() || Ty->isVectorTy()) &&
          "Cannot create an aggregate zero of non-aggregate type!");
 
+  LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  UniquingLock Lock(pImpl, pImpl->ConstantsMutex);
   std::unique_ptr<ConstantAggregateZero> &Entry =
       Ty->getContext().pImpl->CAZConstants[Ty];
   if (!Entry)
@@ -1374,7 +1381,14 @@ ConstantAggregateZero *ConstantAggregateZero::get(Type *Ty) {
 
 /// Remove the constant from the constant table.
 void ConstantAggregateZero::destroyConstantImpl() {
-  getContext().pImpl->CAZConstants.erase(getType());
+  // Delete the constant after releasing the lock, because its destructor may
+  // update metadata.
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  std::unique_ptr<ConstantAggregateZero> Self;
+  UniquingLock Lock(pImpl, pImpl->ConstantsMutex);
+  auto I = pImpl->CAZConstants.find(getType());
+  Self = std::move(I->second);
+  pImpl->CAZConstants.erase(I);
 }
 
 /// Remove the constant from the constant table.
@@ -1430,6 +1444,8 @@ const APInt &Constant::getUniqueInteger() const {
 //
 
 ConstantPointerNull *ConstantPointerNull::get(PointerType *Ty) {
+  LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  UniquingLock Lock(pImpl, pImpl->ConstantsMutex);
   std::unique_ptr<ConstantPointerNull> &Entry =
       Ty->getContext().pImpl->CPNConstants[Ty];
   if (!Entry)
@@ -1440,10 +1456,19 @@ ConstantPointerNull *ConstantPointerNull::get(PointerType *Ty) {
 
 /// Remove the constant from the constant table.
 void ConstantPointerNull::destroyConstantImpl() {
-  getContext().pImpl->CPNConstants.erase(getType());
+  // Delete the constant after releasing the lock, because its destructor may
+  // update metadata.
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  std::unique_ptr<ConstantPointerNull> Self;
+  UniquingLock Lock(pImpl, pImpl->ConstantsMutex);
+  auto I = pImpl->CPNConstants.find(getType());
+  Self = std::move(I->second);
+  pImpl->CPNConstants.erase(I);
 }
 
 UndefValue *UndefValue::get(Type *Ty) {
+  LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  UniquingLock Lock(pImpl, pImpl->ConstantsMutex);
   std::unique_ptr<UndefValue> &Entry = Ty->getContext().pImpl->UVConstants[Ty];
   if (!Entry)
     Entry.reset(new UndefValue(Ty));
@@ -1453,8 +1478,14 @@ UndefValue *UndefValue::get(Type *Ty) {
 
 /// Remove the constant from the constant table.
 void UndefValue::destroyConstantImpl() {
-  // Free the constant and any dangling references to it.
-  getContext().pImpl->UVConstants.erase(getType());
+  // Free the constant and any dangling references to it. Delete the constant
+  // after releasing the lock, because its destructor may update metadata.
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  std::unique_ptr<UndefValue> Self;
+  UniquingLock Lock(pImpl, pImpl->ConstantsMutex);
+  auto I = pImpl->UVConstants.find(getType());
+  Self = std::move(I->second);
+  pImpl->UVConstants.erase(I);
 }
 
 BlockAddress *BlockAddress::get(BasicBlock *BB) {
@@ -2491,6 +2522,8 @@ Constant *ConstantDataSequential::getImpl(StringRef Elements, Type *Ty) {
     return ConstantAggregateZero::get(Ty);
 
   // Do a lookup to see if we have already formed one of these.
+  LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  UniquingLock Lock(pImpl, pImpl->ConstantsMutex);
   auto &Slot =
       *Ty->getContext()
            .pImpl->CDSConstants.insert(std::make_pair(Elements, nullptr))
@@ -2517,6 +2550,8 @@ Constant *ConstantDataSequential::getImpl(StringRef Elements, Type *Ty) {
 
 void ConstantDataSequential::destroyConstantImpl() {
   // Remove the constant from the StringMap.
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  UniquingLock Lock(pImpl, pImpl->ConstantsMutex);
   StringMap<ConstantDataSequential*> &CDSConstants =
     getType()->getContext().pImpl->CDSConstants;
 
@@ -34,6 +34,7 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <mutex>
 #include <utility>
 
 #define DEBUG_TYPE "ir"
@@ -567,6 +568,25 @@ struct ConstantExprKeyType {
   }
 };
 
+class LLVMContextImpl;
+
+/// Holds one of the uniquing mutexes of an LLVMContextImpl for the lifetime of
+/// this object, if thread-safe uniquing is enabled for the context. The
+/// constructor is defined in LLVMContextImpl.h.
+class UniquingLock {
+  std::recursive_mutex *M;
+
+public:
+  inline UniquingLock(const LLVMContextImpl *Impl,
+                      std::recursive_mutex &Mutex);
+  UniquingLock(const UniquingLock &) = delete;
+  UniquingLock &operator=(const UniquingLock &) = delete;
+  ~UniquingLock() {
+    if (M)
+      M->unlock();
+  }
+};
+
 template <class ConstantClass> class ConstantUniqueMap {
 public:
   using ValType = typename ConstantInfo<ConstantClass>::ValType;
@@ -646,6 +666,8 @@ private:
 public:
   /// Return the specified constant from the map, creating it if necessary.
   ConstantClass *getOrCreate(TypeClass *Ty, ValType V) {
+    auto *Impl = Ty->getContext().pImpl;
+    UniquingLock Lock(Impl, Impl->ConstantsMutex);
     LookupKey Key(Ty, V);
     /// Hash once, and reuse it for the lookup and the insertion if needed.
     LookupKeyHashed Lookup(MapInfo::getHashValue(Key), Key);
@@ -664,6 +686,8 @@ public:
 
   /// Remove this constant from the map
   void remove(ConstantClass *CP) {
+    auto *Impl = CP->getContext().pImpl;
+    UniquingLock Lock(Impl, Impl->ConstantsMutex);
     typename MapTy::iterator I = Map.find(CP);
     assert(I != Map.end() && "Constant not found in constant table!");
     assert(*I == CP && "Didn't find correct element?");
@@ -674,6 +698,8 @@ public:
                                         ConstantClass *CP, Value *From,
                                         Constant *To, unsigned NumUpdated = 0,
                                         unsigned OperandNo = ~0u) {
+    auto *Impl = CP->getContext().pImpl;
+    UniquingLock Lock(Impl, Impl->ConstantsMutex);
     LookupKey Key(CP->getType(), ValType(Operands, CP));
     /// Hash once, and reuse it for the lookup and the insertion if needed.
     LookupKeyHashed Lookup(MapInfo::getHashValue(Key), Key);
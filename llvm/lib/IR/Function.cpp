@@ -277,6 +277,10 @@ Function::~Function() {
 
   // Remove the function from the on-the-side GC table.
   clearGC();
+
+  // Forget the work charged to the function, so that a function allocated at
+  // the same address starts with a full budget.
+  getContext().deleteCompileTimeUsed(*this);
 }
 
 void Function::BuildLazyArguments() const {
@@ -198,8 +198,11 @@ void GlobalValue::setPartition(StringRef S) {
 
   // Get or create a stable partition name string and put it in the table in the
   // context.
-  if (!S.empty())
-    S = getContext().pImpl->Saver.save(S);
+  if (!S.empty()) {
+    LLVMContextImpl *pImpl = getContext().pImpl;
+    UniquingLock Lock(pImpl, pImpl->TypesMutex);
+    S = pImpl->Saver.save(S);
+  }
   getContext().pImpl->GlobalValuePartitions[this] = S;
 
   // Update the HasPartition field. Setting the partition to the empty string
@@ -219,8 +222,11 @@ void GlobalObject::setSection(StringRef S) {
 
   // Get or create a stable section name string and put it in the table in the
   // context.
-  if (!S.empty())
-    S = getContext().pImpl->Saver.save(S);
+  if (!S.empty()) {
+    LLVMContextImpl *pImpl = getContext().pImpl;
+    UniquingLock Lock(pImpl, pImpl->TypesMutex);
+    S = pImpl->Saver.save(S);
+  }
   getContext().pImpl->GlobalObjectSections[this] = S;
 
   // Update the HasSectionHashEntryBit. Setting the section to the empty string
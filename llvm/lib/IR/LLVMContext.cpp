@@ -23,6 +23,7 @@
 #include "llvm/IR/Module.h"
 #include "llvm/IR/RemarkStreamer.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cassert>
@@ -32,7 +33,20 @@
 
 using namespace llvm;
 
+static cl::opt<uint64_t> FunctionCompileTimeBudget(
+    "function-compile-time-budget", cl::init(0), cl::Hidden,
+    cl::desc("Cap the work expensive optimizations do on each function, in "
+             "units of roughly one instruction visited (0 = unlimited)"));
+
+static cl::opt<uint64_t> CompileTimeBudget(
+    "compile-time-budget", cl::init(0), cl::Hidden,
+    cl::desc("Cap the work expensive optimizations do on all functions "
+             "together, in units of roughly one instruction visited "
+             "(0 = unlimited)"));
+
 LLVMContext::LLVMContext() : pImpl(new LLVMContextImpl(*this)) {
+  setCompileTimeBudget(FunctionCompileTimeBudget, CompileTimeBudget);
+
   // Create the fixed metadata kinds. This is done in the same order as the
   // MD_* enum values so that they correspond.
   std::pair<unsigned, StringRef> MDKinds[] = {
@@ -290,6 +304,35 @@ void LLVMContext::deleteGC(const Function &Fn) {
   pImpl->GCNames.erase(&Fn);
 }
 
+bool LLVMContext::consumeCompileTimeBudget(const Function &Fn, uint64_t Work) {
+  if (!pImpl->FunctionCompileTimeBudget && !pImpl->TotalCompileTimeBudget)
+    return true;
+  pImpl->CompileTimeUsed[&Fn] += Work;
+  pImpl->TotalCompileTimeUsed += Work;
+  return hasCompileTimeBudget(Fn);
+}
+
+bool LLVMContext::hasCompileTimeBudget(const Function &Fn) const {
+  if (pImpl->TotalCompileTimeBudget &&
+      pImpl->TotalCompileTimeUsed > pImpl->TotalCompileTimeBudget)
+    return false;
+  return !pImpl->FunctionCompileTimeBudget ||
+         getCompileTimeUsed(Fn) <= pImpl->FunctionCompileTimeBudget;
+}
+
+uint64_t LLVMContext::getCompileTimeUsed(const Function &Fn) const {
+  return pImpl->CompileTimeUsed.lookup(&Fn);
+}
+
+void LLVMContext::setCompileTimeBudget(uint64_t PerFunction, uint64_t Total) {
+  pImpl->FunctionCompileTimeBudget = PerFunction;
+  pImpl->TotalCompileTimeBudget = Total;
+}
+
+void LLVMContext::deleteCompileTimeUsed(const Function &Fn) {
+  pImpl->CompileTimeUsed.erase(&Fn);
+}
+
 bool LLVMContext::shouldDiscardValueNames() const {
   return pImpl->DiscardValueNames;
 }
@@ -309,6 +352,19 @@ void LLVMContext::setDiscardValueNames(bool Discard) {
   pImpl->DiscardValueNames = Discard;
 }
 
+size_t LLVMContext::getAllocatorMemory() const {
+  return pImpl->Alloc.getTotalMemory() +
+         pImpl->MDStringCache.getAllocator().getTotalMemory();
+}
+
+bool LLVMContext::isThreadSafeUniquing() const {
+  return pImpl->ThreadSafeUniquing;
+}
+
+void LLVMContext::setThreadSafeUniquing(bool Enable) {
+  pImpl->ThreadSafeUniquing = Enable;
+}
+
 OptPassGate &LLVMContext::getOptPassGate() const {
   return pImpl->getOptPassGate();
 }
@@ -1398,10 +1398,33 @@ public:
   /// clients which do use GC.
   DenseMap<const Function*, std::string> GCNames;
 
+  /// The work charged to each function and to all functions by
+  /// LLVMContext::consumeCompileTimeBudget(), and the budgets they are
+  /// checked against. A budget of zero is unlimited.
+  DenseMap<const Function *, uint64_t> CompileTimeUsed;
+  uint64_t TotalCompileTimeUsed = 0;
+  uint64_t FunctionCompileTimeBudget = 0;
+  uint64_t TotalCompileTimeBudget = 0;
+
   /// Flag to indicate if Value (other than GlobalValue) retains their name or
   /// not.
   bool DiscardValueNames = false;
 
+  /// Set by LLVMContext::setThreadSafeUniquing(). If true, the uniquing
+  /// tables above are accessed only while holding the corresponding mutex
+  /// below; see UniquingLock.
+  bool ThreadSafeUniquing = false;
+
+  /// Protects the type tables, NamedStructTypes, and Alloc and Saver.
+  std::recursive_mutex TypesMutex;
+  /// Protects the constant tables, TheTrueVal and TheFalseVal.
+  std::recursive_mutex ConstantsMutex;
+  /// Protects AttrsSet, AttrsLists and AttrsSetNodes.
+  std::recursive_mutex AttrsMutex;
+  /// Protects MDStringCache, ValuesAsMetadata, MetadataAsValues,
+  /// DistinctMDNodes, DITypeMap and the MDNode tables.
+  std::recursive_mutex MetadataMutex;
+
   LLVMContextImpl(LLVMContext &C);
   ~LLVMContextImpl();
 
@@ -1422,6 +1445,13 @@ public:
   void setOptPassGate(OptPassGate&);
 };
 
+inline UniquingLock::UniquingLock(const LLVMContextImpl *Impl,
+                                  std::recursive_mutex &Mutex)
+    : M(Impl->ThreadSafeUniquing ? &Mutex : nullptr) {
+  if (M)
+    M->lock();
+}
+
 } // end namespace llvm
 
 #endif // LLVM_LIB_IR_LLVMCONTEXTIMPL_H
@@ -65,7 +65,9 @@ MetadataAsValue::MetadataAsValue(Type *Ty, Metadata *MD)
 }
 
 MetadataAsValue::~MetadataAsValue() {
-  getType()->getContext().pImpl->MetadataAsValues.erase(MD);
+  LLVMContextImpl *pImpl = getType()->getContext().pImpl;
+  UniquingLock Lock(pImpl, pImpl->MetadataMutex);
+  pImpl->MetadataAsValues.erase(MD);
   untrack();
 }
 
@@ -104,6 +106,7 @@ static Metadata *canonicalizeMetadataForValue(LLVMContext &Context,
 
 MetadataAsValue *MetadataAsValue::get(LLVMContext &Context, Metadata *MD) {
   MD = canonicalizeMetadataForValue(Context, MD);
+  UniquingLock Lock(Context.pImpl, Context.pImpl->MetadataMutex);
   auto *&Entry = Context.pImpl->MetadataAsValues[MD];
   if (!Entry)
     Entry = new MetadataAsValue(Type::getMetadataTy(Context), MD);
@@ -113,6 +116,7 @@ MetadataAsValue *MetadataAsValue::get(LLVMContext &Context, Metadata *MD) {
 MetadataAsValue *MetadataAsValue::getIfExists(LLVMContext &Context,
                                               Metadata *MD) {
   MD = canonicalizeMetadataForValue(Context, MD);
+  UniquingLock Lock(Context.pImpl, Context.pImpl->MetadataMutex);
   auto &Store = Context.pImpl->MetadataAsValues;
   return Store.lookup(MD);
 }
@@ -120,6 +124,7 @@ MetadataAsValue *MetadataAsValue::getIfExists(LLVMContext &Context,
 void MetadataAsValue::handleChangedMetadata(Metadata *MD) {
   LLVMContext &Context = getContext();
   MD = canonicalizeMetadataForValue(Context, MD);
+  UniquingLock Lock(Context.pImpl, Context.pImpl->MetadataMutex);
   auto &Store = Context.pImpl->MetadataAsValues;
 
   // Stop tracking the old metadata.
@@ -349,6 +354,7 @@ ValueAsMetadata *ValueAsMetadata::get(Value *V) {
   assert(V && "Unexpected null Value");
 
   auto &Context = V->getContext();
+  UniquingLock Lock(Context.pImpl, Context.pImpl->MetadataMutex);
   auto *&Entry = Context.pImpl->ValuesAsMetadata[V];
   if (!Entry) {
     assert((isa<Constant>(V) || isa<Argument>(V) || isa<Instruction>(V)) &&
@@ -366,13 +372,17 @@ ValueAsMetadata *ValueAsMetadata::get(Value *V) {
 
 ValueAsMetadata *ValueAsMetadata::getIfExists(Value *V) {
   assert(V && "Unexpected null Value");
-  return V->getContext().pImpl->ValuesAsMetadata.lookup(V);
+  LLVMContextImpl *pImpl = V->getContext().pImpl;
+  UniquingLock Lock(pImpl, pImpl->MetadataMutex);
+  return pImpl->ValuesAsMetadata.lookup(V);
 }
 
 void ValueAsMetadata::handleDeletion(Value *V) {
   assert(V && "Expected valid value");
 
-  auto &Store = V->getType()->getContext().pImpl->ValuesAsMetadata;
+  LLVMContextImpl *pImpl = V->getType()->getContext().pImpl;
+  UniquingLock Lock(pImpl, pImpl->MetadataMutex);
+  auto &Store = pImpl->ValuesAsMetadata;
   auto I = Store.find(V);
   if (I == Store.end())
     return;
@@ -395,6 +405,7 @@ void ValueAsMetadata::handleRAUW(Value *From, Value *To) {
   assert(From->getType() == To->getType() && "Unexpected type change");
 
   LLVMContext &Context = From->getType()->getContext();
+  UniquingLock Lock(Context.pImpl, Context.pImpl->MetadataMutex);
   auto &Store = Context.pImpl->ValuesAsMetadata;
   auto I = Store.find(From);
   if (I == Store.end()) {
@@ -451,6 +462,7 @@ void ValueAsMetadata::handleRAUW(Value *From, Value *To) {
 //
 
 MDString *MDString::get(LLVMContext &Context, StringRef Str) {
+  UniquingLock Lock(Context.pImpl, Context.pImpl->MetadataMutex);
   auto &Store = Context.pImpl->MDStringCache;
   auto I = Store.try_emplace(Str);
   auto &MapEntry = I.first->getValue();
@@ -780,6 +792,7 @@ template <class NodeTy> struct MDNode::HasCachedHash {
 
 MDNode *MDNode::uniquify() {
   assert(!hasSelfReference(this) && "Cannot uniquify a self-referencing node");
+  UniquingLock Lock(getContext().pImpl, getContext().pImpl->MetadataMutex);
 
   // Try to insert into uniquing store.
   switch (getMetadataID()) {
@@ -798,6 +811,7 @@ MDNode *MDNode::uniquify() {
 }
 
 void MDNode::eraseFromStore() {
+  UniquingLock Lock(getContext().pImpl, getContext().pImpl->MetadataMutex);
   switch (getMetadataID()) {
   default:
     llvm_unreachable("Invalid or non-uniquable subclass of MDNode");
@@ -812,6 +826,7 @@ void MDNode::eraseFromStore() {
 MDTuple *MDTuple::getImpl(LLVMContext &Context, ArrayRef<Metadata *> MDs,
                           StorageType Storage, bool ShouldCreate) {
   unsigned Hash = 0;
+  UniquingLock Lock(Context.pImpl, Context.pImpl->MetadataMutex);
   if (Storage == Uniqued) {
     MDTupleInfo::KeyTy Key(MDs);
     if (auto *N = getUniqued(Context.pImpl->MDTuples, Key))
@@ -852,6 +867,7 @@ void MDNode::storeDistinctInContext() {
 #include "llvm/IR/Metadata.def"
   }
 
+  UniquingLock Lock(getContext().pImpl, getContext().pImpl->MetadataMutex);
   getContext().pImpl->DistinctMDNodes.push_back(this);
 }
 
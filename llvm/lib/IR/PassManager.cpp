@@ -9,9 +9,23 @@
 #include "llvm/IR/PassManager.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/StructuralHash.h"
+#include "llvm/Support/CommandLine.h"
 
 using namespace llvm;
 
+static cl::opt<bool> PreserveAnalysesOnUnchangedIR(
+    "preserve-analyses-on-unchanged-ir", cl::Hidden, cl::init(false),
+    cl::desc("Hash each function before and after each function pass, and "
+             "keep all analyses of the function if the pass did not change "
+             "it, even if the pass reported a change"));
+
+Optional<uint64_t> llvm::detail::getIRFingerprint(Function &F) {
+  if (!PreserveAnalysesOnUnchangedIR)
+    return None;
+  return StructuralHash(F);
+}
+
 // Explicit template instantiations and specialization defininitions for core
 // template typedefs.
 namespace llvm {
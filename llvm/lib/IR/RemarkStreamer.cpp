@@ -37,6 +37,12 @@ Error RemarkStreamer::setFilter(StringRef Filter) {
   return Error::success();
 }
 
+bool RemarkStreamer::matchesFilter(StringRef PassName) const {
+  if (const Optional<Regex> &Filter = PassFilter)
+    return Filter->match(PassName);
+  return true;
+}
+
 /// DiagnosticKind -> remarks::Type
 static remarks::Type toRemarkType(enum DiagnosticKind Kind) {
   switch (Kind) {
@@ -94,9 +100,8 @@ RemarkStreamer::toRemark(const DiagnosticInfoOptimizationBase &Diag) {
 }
 
 void RemarkStreamer::emit(const DiagnosticInfoOptimizationBase &Diag) {
-  if (Optional<Regex> &Filter = PassFilter)
-    if (!Filter->match(Diag.getPassName()))
-      return;
+  if (!matchesFilter(Diag.getPassName()))
+    return;
 
   // First, convert the diagnostic to a remark.
   remarks::Remark R = toRemark(Diag);
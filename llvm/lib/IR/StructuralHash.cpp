@@ -0,0 +1,131 @@
+//===- StructuralHash.cpp - Hash of a function's IR -----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/IR/StructuralHash.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/Instructions.h"
+
+using namespace llvm;
+
+namespace {
+
+class StructuralHashImpl {
+  uint64_t Hash = 0x6acaa36bef8325c5ULL;
+
+  void hash(uint64_t V) { Hash = hashing::detail::hash_16_bytes(Hash, V); }
+  void hashPtr(const void *P) { hash(reinterpret_cast<uintptr_t>(P)); }
+
+  void hashMetadata(const Instruction &I) {
+    SmallVector<std::pair<unsigned, MDNode *>, 4> MDs;
+    I.getAllMetadata(MDs);
+    hash(MDs.size());
+    for (const auto &MD : MDs) {
+      hash(MD.first);
+      hashPtr(MD.second);
+    }
+  }
+
+  // Hashes the state of an instruction that is not stored in its operands.
+  void hashOperation(const Instruction &I) {
+    if (const auto *CI = dyn_cast<CmpInst>(&I)) {
+      hash(CI->getPredicate());
+    } else if (const auto *LI = dyn_cast<LoadInst>(&I)) {
+      hash(LI->isVolatile());
+      hash(LI->getAlignment());
+      hash(unsigned(LI->getOrdering()));
+      hash(LI->getSyncScopeID());
+    } else if (const auto *SI = dyn_cast<StoreInst>(&I)) {
+      hash(SI->isVolatile());
+      hash(SI->getAlignment());
+      hash(unsigned(SI->getOrdering()));
+      hash(SI->getSyncScopeID());
+    } else if (const auto *AI = dyn_cast<AllocaInst>(&I)) {
+      hashPtr(AI->getAllocatedType());
+      hash(AI->getAlignment());
+      hash(AI->isUsedWithInAlloca());
+      hash(AI->isSwiftError());
+    } else if (const auto *GEP = dyn_cast<GetElementPtrInst>(&I)) {
+      hashPtr(GEP->getSourceElementType());
+    } else if (const auto *CB = dyn_cast<CallBase>(&I)) {
+      hashPtr(CB->getFunctionType());
+      hash(CB->getCallingConv());
+      hashPtr(CB->getAttributes().getRawPointer());
+      hash(CB->getNumOperandBundles());
+      for (unsigned Idx = 0, E = CB->getNumOperandBundles(); Idx != E; ++Idx)
+        hash(CB->getOperandBundleAt(Idx).getTagID());
+      if (const auto *Call = dyn_cast<CallInst>(&I))
+        hash(Call->getTailCallKind());
+    } else if (const auto *PN = dyn_cast<PHINode>(&I)) {
+      for (const BasicBlock *BB : PN->blocks())
+        hashPtr(BB);
+    } else if (const auto *EVI = dyn_cast<ExtractValueInst>(&I)) {
+      for (unsigned Idx : EVI->indices())
+        hash(Idx);
+    } else if (const auto *IVI = dyn_cast<InsertValueInst>(&I)) {
+      for (unsigned Idx : IVI->indices())
+        hash(Idx);
+    } else if (const auto *RMWI = dyn_cast<AtomicRMWInst>(&I)) {
+      hash(RMWI->getOperation());
+      hash(RMWI->isVolatile());
+      hash(unsigned(RMWI->getOrdering()));
+      hash(RMWI->getSyncScopeID());
+    } else if (const auto *CXI = dyn_cast<AtomicCmpXchgInst>(&I)) {
+      hash(CXI->isVolatile());
+      hash(CXI->isWeak());
+      hash(unsigned(CXI->getSuccessOrdering()));
+      hash(unsigned(CXI->getFailureOrdering()));
+      hash(CXI->getSyncScopeID());
+    } else if (const auto *FI = dyn_cast<FenceInst>(&I)) {
+      hash(unsigned(FI->getOrdering()));
+      hash(FI->getSyncScopeID());
+    } else if (const auto *LPI = dyn_cast<LandingPadInst>(&I)) {
+      hash(LPI->isCleanup());
+    }
+  }
+
+public:
+  void update(const Instruction &I) {
+    hashPtr(&I);
+    hash(I.getOpcode());
+    hashPtr(I.getType());
+    hash(I.getRawSubclassOptionalData());
+    hash(I.getNumOperands());
+    for (const Use &Op : I.operands())
+      hashPtr(Op.get());
+    hashOperation(I);
+    hashMetadata(I);
+  }
+
+  void update(const Function &F) {
+    hashPtr(&F);
+    hashPtr(F.getFunctionType());
+    hash(F.getCallingConv());
+    hashPtr(F.getAttributes().getRawPointer());
+    // The personality, prefix and prologue data are operands of F.
+    for (const Use &Op : F.operands())
+      hashPtr(Op.get());
+
+    for (const BasicBlock &BB : F) {
+      hashPtr(&BB);
+      for (const Instruction &I : BB)
+        update(I);
+    }
+  }
+
+  uint64_t getHash() const { return Hash; }
+};
+
+} // end anonymous namespace
+
+uint64_t llvm::StructuralHash(const Function &F) {
+  StructuralHashImpl H;
+  H.update(F);
+  return H.getHash();
+}
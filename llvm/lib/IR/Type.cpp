@@ -257,6 +257,7 @@ IntegerType *IntegerType::get(LLVMContext &C, unsigned NumBits) {
     break;
   }
 
+  UniquingLock Lock(C.pImpl, C.pImpl->TypesMutex);
   IntegerType *&Entry = C.pImpl->IntegerTypes[NumBits];
 
   if (!Entry)
@@ -303,6 +304,7 @@ FunctionType *FunctionType::get(Type *ReturnType,
   LLVMContextImpl *pImpl = ReturnType->getContext().pImpl;
   const FunctionTypeKeyInfo::KeyTy Key(ReturnType, Params, isVarArg);
   FunctionType *FT;
+  UniquingLock Lock(pImpl, pImpl->TypesMutex);
   // Since we only want to allocate a fresh function type in case none is found
   // and we don't want to perform two lookups (one for checking if existent and
   // one for inserting the newly allocated one), here we instead lookup based on
@@ -349,6 +351,7 @@ StructType *StructType::get(LLVMContext &Context, ArrayRef<Type*> ETypes,
   const AnonStructTypeKeyInfo::KeyTy Key(ETypes, isPacked);
 
   StructType *ST;
+  UniquingLock Lock(pImpl, pImpl->TypesMutex);
   // Since we only want to allocate a fresh struct type in case none is found
   // and we don't want to perform two lookups (one for checking if existent and
   // one for inserting the newly allocated one), here we instead lookup based on
@@ -384,12 +387,15 @@ void StructType::setBody(ArrayRef<Type*> Elements, bool isPacked) {
     return;
   }
 
-  ContainedTys = Elements.copy(getContext().pImpl->Alloc).data();
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  UniquingLock Lock(pImpl, pImpl->TypesMutex);
+  ContainedTys = Elements.copy(pImpl->Alloc).data();
 }
 
 void StructType::setName(StringRef Name) {
   if (Name == getName()) return;
 
+  UniquingLock Lock(getContext().pImpl, getContext().pImpl->TypesMutex);
   StringMap<StructType *> &SymbolTable = getContext().pImpl->NamedStructTypes;
 
   using EntryTy = StringMap<StructType *>::MapEntryTy;
@@ -439,7 +445,11 @@ void StructType::setName(StringRef Name) {
 // StructType Helper functions.
 
 StructType *StructType::create(LLVMContext &Context, StringRef Name) {
-  StructType *ST = new (Context.pImpl->Alloc) StructType(Context);
+  StructType *ST;
+  {
+    UniquingLock Lock(Context.pImpl, Context.pImpl->TypesMutex);
+    ST = new (Context.pImpl->Alloc) StructType(Context);
+  }
   if (!Name.empty())
     ST->setName(Name);
   return ST;
@@ -526,7 +536,9 @@ bool StructType::isLayoutIdentical(StructType *Other) const {
 }
 
 StructType *Module::getTypeByName(StringRef Name) const {
-  return getContext().pImpl->NamedStructTypes.lookup(Name);
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  UniquingLock Lock(pImpl, pImpl->TypesMutex);
+  return pImpl->NamedStructTypes.lookup(Name);
 }
 
 //===----------------------------------------------------------------------===//
@@ -588,6 +600,7 @@ ArrayType *ArrayType::get(Type *ElementType, uint64_t NumElements) {
   assert(isValidElementType(ElementType) && "Invalid type for array element!");
 
   LLVMContextImpl *pImpl = ElementType->getContext().pImpl;
+  UniquingLock Lock(pImpl, pImpl->TypesMutex);
   ArrayType *&Entry =
     pImpl->ArrayTypes[std::make_pair(ElementType, NumElements)];
 
@@ -618,8 +631,8 @@ VectorType *VectorType::get(Type *ElementType, ElementCount EC) {
                                             "pointer type.");
 
   LLVMContextImpl *pImpl = ElementType->getContext().pImpl;
-  VectorType *&Entry = ElementType->getContext().pImpl
-                                 ->VectorTypes[std::make_pair(ElementType, EC)];
+  UniquingLock Lock(pImpl, pImpl->TypesMutex);
+  VectorType *&Entry = pImpl->VectorTypes[std::make_pair(ElementType, EC)];
   if (!Entry)
     Entry = new (pImpl->Alloc) VectorType(ElementType, EC);
   return Entry;
@@ -639,6 +652,7 @@ PointerType *PointerType::get(Type *EltTy, unsigned AddressSpace) {
   assert(isValidElementType(EltTy) && "Invalid type for pointer element!");
 
   LLVMContextImpl *CImpl = EltTy->getContext().pImpl;
+  UniquingLock Lock(CImpl, CImpl->TypesMutex);
 
   // Since AddressSpace #0 is the common case, we special case it.
   PointerType *&Entry = AddressSpace == 0 ? CImpl->PointerTypes[EltTy]
@@ -37,12 +37,14 @@ void Use::swap(Use &RHS) {
   }
 }
 
+#ifndef LLVM_ENABLE_USE_PARENT_POINTERS
 User *Use::getUser() const {
   const Use *End = getImpliedUser();
   const UserRef *ref = reinterpret_cast<const UserRef *>(End);
   return ref->getInt() ? ref->getPointer()
                        : reinterpret_cast<User *>(const_cast<Use *>(End));
 }
+#endif
 
 unsigned Use::getOperandNo() const {
   return this - getUser()->op_begin();
@@ -53,7 +55,10 @@ unsigned Use::getOperandNo() const {
 //
 //   http://www.llvm.org/docs/ProgrammersManual.html#the-waymarking-algorithm
 //
-Use *Use::initTags(Use *const Start, Use *Stop) {
+Use *Use::initTags(Use *const Start, Use *Stop, User *Parent) {
+  if (!Parent)
+    Parent = reinterpret_cast<User *>(Stop);
+
   ptrdiff_t Done = 0;
   while (Done < 20) {
     if (Start == Stop--)
@@ -63,18 +68,18 @@ Use *Use::initTags(Use *const Start, Use *Stop) {
         stopTag,      zeroDigitTag, oneDigitTag,  oneDigitTag, stopTag,
         zeroDigitTag, oneDigitTag,  zeroDigitTag, oneDigitTag, stopTag,
         oneDigitTag,  oneDigitTag,  oneDigitTag,  oneDigitTag, stopTag};
-    new (Stop) Use(tags[Done++]);
+    new (Stop) Use(tags[Done++], Parent);
   }
 
   ptrdiff_t Count = Done;
   while (Start != Stop) {
     --Stop;
     if (!Count) {
-      new (Stop) Use(stopTag);
+      new (Stop) Use(stopTag, Parent);
       ++Done;
       Count = Done;
     } else {
-      new (Stop) Use(PrevPtrTag(Count & 1));
+      new (Stop) Use(PrevPtrTag(Count & 1), Parent);
       Count >>= 1;
       ++Done;
     }
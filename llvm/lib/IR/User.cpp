@@ -52,7 +52,7 @@ void User::allocHungoffUses(unsigned N, bool IsPhi) {
   Use *Begin = static_cast<Use*>(::operator new(size));
   Use *End = Begin + N;
   (void) new(End) Use::UserRef(const_cast<User*>(this), 1);
-  setOperandList(Use::initTags(Begin, End));
+  setOperandList(Use::initTags(Begin, End, this));
 }
 
 void User::growHungoffUses(unsigned NewNumUses, bool IsPhi) {
@@ -13,6 +13,7 @@
 #include "llvm/LTO/Caching.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Errc.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
@@ -148,3 +149,119 @@ Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
     };
   };
 }
+
+CacheStore::~CacheStore() = default;
+
+namespace {
+class DirectoryCacheStore : public CacheStore {
+  std::string DirectoryPath;
+
+public:
+  DirectoryCacheStore(StringRef DirectoryPath) : DirectoryPath(DirectoryPath) {}
+
+  Expected<std::unique_ptr<MemoryBuffer>> get(StringRef Key) override {
+    SmallString<64> EntryPath;
+    sys::path::append(EntryPath, DirectoryPath, "llvmcache-" + Key);
+    ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+        MemoryBuffer::getFile(EntryPath, /*FileSize=*/-1,
+                              /*RequiresNullTerminator=*/false);
+    if (MBOrErr)
+      return std::move(*MBOrErr);
+    if (MBOrErr.getError() == errc::no_such_file_or_directory)
+      return nullptr;
+    return createFileError(EntryPath, MBOrErr.getError());
+  }
+
+  Error put(StringRef Key, MemoryBufferRef Object) override {
+    // Write to a temporary file first, so that other links never see a
+    // partial entry.
+    SmallString<64> TempFilenameModel, EntryPath;
+    sys::path::append(TempFilenameModel, DirectoryPath, "Thin-%%%%%%.tmp.o");
+    sys::path::append(EntryPath, DirectoryPath, "llvmcache-" + Key);
+    Expected<sys::fs::TempFile> Temp = sys::fs::TempFile::create(
+        TempFilenameModel, sys::fs::owner_read | sys::fs::owner_write);
+    if (!Temp)
+      return Temp.takeError();
+    {
+      raw_fd_ostream OS(Temp->FD, /*shouldClose=*/false);
+      OS << Object.getBuffer();
+      OS.flush();
+      if (OS.has_error()) {
+        std::error_code EC = OS.error();
+        OS.clear_error();
+        consumeError(Temp->discard());
+        return createFileError(Temp->TmpName, EC);
+      }
+    }
+    return Temp->keep(EntryPath);
+  }
+};
+} // end anonymous namespace
+
+Expected<std::shared_ptr<CacheStore>>
+lto::createDirectoryCacheStore(StringRef DirectoryPath) {
+  if (std::error_code EC = sys::fs::create_directories(DirectoryPath))
+    return errorCodeToError(EC);
+  return std::make_shared<DirectoryCacheStore>(DirectoryPath);
+}
+
+static void warnCacheStoreError(StringRef Action, StringRef Key, Error E) {
+  errs() << "warning: could not " << Action << " cache entry " << Key
+         << " in the shared cache: " << toString(std::move(E)) << '\n';
+}
+
+Expected<NativeObjectCache>
+lto::sharedCache(StringRef CacheDirectoryPath,
+                 std::shared_ptr<CacheStore> Store, AddBufferFn AddBuffer) {
+  Expected<NativeObjectCache> LocalOrErr =
+      localCache(CacheDirectoryPath, AddBuffer);
+  if (!LocalOrErr)
+    return LocalOrErr.takeError();
+  NativeObjectCache Local = std::move(*LocalOrErr);
+
+  return [=](unsigned Task, StringRef Key) -> AddStreamFn {
+    AddStreamFn LocalAddStream = Local(Task, Key);
+    if (!LocalAddStream)
+      return AddStreamFn();
+
+    // On a hit in the store, add the object to the local cache, which also
+    // adds it to the link.
+    Expected<std::unique_ptr<MemoryBuffer>> MBOrErr = Store->get(Key);
+    if (!MBOrErr)
+      warnCacheStoreError("read", Key, MBOrErr.takeError());
+    else if (*MBOrErr) {
+      *LocalAddStream(Task)->OS << (*MBOrErr)->getBuffer();
+      return AddStreamFn();
+    }
+
+    // This native object stream keeps a copy of the object, to add it to the
+    // store once it is committed to the local cache.
+    struct SharedCacheStream : NativeObjectStream {
+      SmallString<0> Object;
+      std::unique_ptr<NativeObjectStream> LocalStream;
+      std::shared_ptr<CacheStore> Store;
+      std::string Key;
+
+      SharedCacheStream(std::unique_ptr<NativeObjectStream> LocalStream,
+                        std::shared_ptr<CacheStore> Store, std::string Key)
+          : NativeObjectStream(nullptr), LocalStream(std::move(LocalStream)),
+            Store(std::move(Store)), Key(std::move(Key)) {
+        OS = std::make_unique<raw_svector_ostream>(Object);
+      }
+
+      ~SharedCacheStream() {
+        OS.reset();
+        *LocalStream->OS << Object;
+        LocalStream.reset();
+        if (Error E = Store->put(Key, MemoryBufferRef(Object, Key)))
+          warnCacheStoreError("write", Key, std::move(E));
+      }
+    };
+
+    std::string KeyStr = Key;
+    return [=](size_t Task) -> std::unique_ptr<NativeObjectStream> {
+      return std::make_unique<SharedCacheStream>(LocalAddStream(Task), Store,
+                                                 KeyStr);
+    };
+  };
+}
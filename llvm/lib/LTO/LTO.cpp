@@ -30,14 +30,19 @@
 #include "llvm/Linker/IRMover.h"
 #include "llvm/Object/IRObjectFile.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/SHA1.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/Threading.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/VCSRevision.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
@@ -48,6 +53,7 @@
 #include "llvm/Transforms/Utils/FunctionImportUtils.h"
 #include "llvm/Transforms/Utils/SplitModule.h"
 
+#include <condition_variable>
 #include <set>
 
 using namespace llvm;
@@ -65,6 +71,20 @@ cl::opt<bool> EnableLTOInternalization(
     "enable-lto-internalization", cl::init(true), cl::Hidden,
     cl::desc("Enable global value internalization in LTO"));
 
+/// Print the peak resident set size and the current heap usage of the process
+/// after \p Stage if requested by the config.
+static void reportMemoryUsage(const Config &Conf, const Twine &Stage) {
+  if (!Conf.PrintMemoryUsage)
+    return;
+  // Build the line first so that lines from backend threads do not interleave.
+  std::string Line;
+  raw_string_ostream OS(Line);
+  OS << "LTO memory usage after " << Stage << ": peak RSS "
+     << (sys::Process::GetPeakMemoryUsage() >> 20) << " MiB, heap "
+     << (sys::Process::GetMallocUsage() >> 20) << " MiB\n";
+  errs() << OS.str();
+}
+
 // Computes a unique hash for the Module considering the current list of
 // export/import and other global analysis results.
 // The hash is produced in \p Key.
@@ -474,7 +494,7 @@ LTO::ThinLTOState::ThinLTOState(ThinBackend Backend)
     : Backend(Backend), CombinedIndex(/*HaveGVs*/ false) {
   if (!Backend)
     this->Backend =
-        createInProcessThinBackend(llvm::heavyweight_hardware_concurrency());
+        createInProcessThinBackend(heavyweight_hardware_concurrency_strategy());
 }
 
 LTO::LTO(Config Conf, ThinBackend Backend,
@@ -939,7 +959,10 @@ Error LTO::run(AddStreamFn AddStream, NativeObjectCache Cache) {
   if (Error Err = checkPartiallySplit())
     return Err;
 
+  reportMemoryUsage(Conf, "adding modules");
+
   Error Result = runRegularLTO(AddStream);
+  reportMemoryUsage(Conf, "regular LTO");
   if (!Result)
     Result = runThinLTO(AddStream, Cache, GUIDPreservedSymbols);
 
@@ -1044,6 +1067,25 @@ public:
   virtual Error wait() = 0;
 };
 
+/// Estimate the time to run the backend of a module from its summary: the
+/// number of instructions in the functions it defines and in the functions it
+/// imports.
+static uint64_t
+estimateThinBackendCost(const ModuleSummaryIndex &Index,
+                        const GVSummaryMapTy &DefinedGlobals,
+                        const FunctionImporter::ImportMapTy &ImportList) {
+  uint64_t Cost = 0;
+  for (auto &GVS : DefinedGlobals)
+    if (auto *FS = dyn_cast<FunctionSummary>(GVS.second))
+      Cost += FS->instCount();
+  for (auto &ModuleImports : ImportList)
+    for (GlobalValue::GUID GUID : ModuleImports.second)
+      if (auto *FS = dyn_cast_or_null<FunctionSummary>(
+              Index.findSummaryInModule(GUID, ModuleImports.first())))
+        Cost += FS->instCount();
+  return Cost;
+}
+
 namespace {
 class InProcessThinBackend : public ThinBackendProc {
   ThreadPool BackendThreadPool;
@@ -1052,17 +1094,56 @@ class InProcessThinBackend : public ThinBackendProc {
   std::set<GlobalValue::GUID> CfiFunctionDefs;
   std::set<GlobalValue::GUID> CfiFunctionDecls;
 
+  /// A backend job, queued until wait() so that the jobs can be started in
+  /// decreasing order of their estimated cost.
+  struct BackendJob {
+    unsigned Task;
+    BitcodeModule BM;
+    const FunctionImporter::ImportMapTy *ImportList;
+    const FunctionImporter::ExportSetTy *ExportList;
+    const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes> *ResolvedODR;
+    const GVSummaryMapTy *DefinedGlobals;
+    MapVector<StringRef, BitcodeModule> *ModuleMap;
+    uint64_t Cost;
+  };
+  std::vector<BackendJob> Jobs;
+
   Optional<Error> Err;
   std::mutex ErrMu;
 
+  /// The number of running backend jobs. With a memory budget, a job only
+  /// starts while the heap usage is below the budget, or if no other job is
+  /// running so that progress is guaranteed.
+  unsigned RunningJobs = 0;
+  std::mutex AdmissionMu;
+  std::condition_variable AdmissionCV;
+
+  void admitJob() {
+    std::unique_lock<std::mutex> L(AdmissionMu);
+    if (Conf.ThinLTOMemoryBudget)
+      AdmissionCV.wait(L, [&]() {
+        return RunningJobs == 0 ||
+               sys::Process::GetMallocUsage() <= Conf.ThinLTOMemoryBudget;
+      });
+    ++RunningJobs;
+  }
+
+  void retireJob() {
+    {
+      std::unique_lock<std::mutex> L(AdmissionMu);
+      --RunningJobs;
+    }
+    AdmissionCV.notify_all();
+  }
+
 public:
   InProcessThinBackend(
       Config &Conf, ModuleSummaryIndex &CombinedIndex,
-      unsigned ThinLTOParallelismLevel,
+      ThreadPoolStrategy ThinLTOParallelism,
       const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
       AddStreamFn AddStream, NativeObjectCache Cache)
       : ThinBackendProc(Conf, CombinedIndex, ModuleToDefinedGVSummaries),
-        BackendThreadPool(ThinLTOParallelismLevel),
+        BackendThreadPool(ThinLTOParallelism),
         AddStream(std::move(AddStream)), Cache(std::move(Cache)) {
     for (auto &Name : CombinedIndex.cfiFunctionDefs())
       CfiFunctionDefs.insert(
@@ -1091,6 +1172,13 @@ public:
     };
 
     auto ModuleID = BM.getModuleIdentifier();
+    TimeTraceScope TimeScope("ThinLTO backend", [&]() {
+      return (ModuleID + " (estimated cost " +
+              Twine(estimateThinBackendCost(CombinedIndex, DefinedGlobals,
+                                            ImportList)) +
+              ")")
+          .str();
+    });
 
     if (!Cache || !CombinedIndex.modulePaths().count(ModuleID) ||
         all_of(CombinedIndex.getModuleHash(ModuleID),
@@ -1120,31 +1208,41 @@ public:
     assert(ModuleToDefinedGVSummaries.count(ModulePath));
     const GVSummaryMapTy &DefinedGlobals =
         ModuleToDefinedGVSummaries.find(ModulePath)->second;
-    BackendThreadPool.async(
-        [=](BitcodeModule BM, ModuleSummaryIndex &CombinedIndex,
-            const FunctionImporter::ImportMapTy &ImportList,
-            const FunctionImporter::ExportSetTy &ExportList,
-            const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes>
-                &ResolvedODR,
-            const GVSummaryMapTy &DefinedGlobals,
-            MapVector<StringRef, BitcodeModule> &ModuleMap) {
-          Error E = runThinLTOBackendThread(
-              AddStream, Cache, Task, BM, CombinedIndex, ImportList, ExportList,
-              ResolvedODR, DefinedGlobals, ModuleMap);
-          if (E) {
-            std::unique_lock<std::mutex> L(ErrMu);
-            if (Err)
-              Err = joinErrors(std::move(*Err), std::move(E));
-            else
-              Err = std::move(E);
-          }
-        },
-        BM, std::ref(CombinedIndex), std::ref(ImportList), std::ref(ExportList),
-        std::ref(ResolvedODR), std::ref(DefinedGlobals), std::ref(ModuleMap));
+    Jobs.push_back({Task, BM, &ImportList, &ExportList, &ResolvedODR,
+                    &DefinedGlobals, &ModuleMap,
+                    estimateThinBackendCost(CombinedIndex, DefinedGlobals,
+                                            ImportList)});
     return Error::success();
   }
 
   Error wait() override {
+    // Start the most expensive jobs first, so that a large module does not
+    // start last and keep a single thread busy after all others are done.
+    llvm::stable_sort(Jobs, [](const BackendJob &A, const BackendJob &B) {
+      return A.Cost > B.Cost;
+    });
+    for (const BackendJob &J : Jobs) {
+      BackendThreadPool.async([=]() {
+        admitJob();
+        // The module, its context and the target machine of the job are freed
+        // when it returns, before the next job is admitted.
+        Error E = runThinLTOBackendThread(
+            AddStream, Cache, J.Task, J.BM, CombinedIndex, *J.ImportList,
+            *J.ExportList, *J.ResolvedODR, *J.DefinedGlobals, *J.ModuleMap);
+        reportMemoryUsage(Conf, "ThinLTO backend for " +
+                                    J.BM.getModuleIdentifier());
+        retireJob();
+        if (E) {
+          std::unique_lock<std::mutex> L(ErrMu);
+          if (Err)
+            Err = joinErrors(std::move(*Err), std::move(E));
+          else
+            Err = std::move(E);
+        }
+      });
+    }
+    Jobs.clear();
+
     BackendThreadPool.wait();
     if (Err)
       return std::move(*Err);
@@ -1155,11 +1253,16 @@ public:
 } // end anonymous namespace
 
 ThinBackend lto::createInProcessThinBackend(unsigned ParallelismLevel) {
+  return createInProcessThinBackend(
+      hardware_concurrency_strategy(ParallelismLevel));
+}
+
+ThinBackend lto::createInProcessThinBackend(ThreadPoolStrategy Parallelism) {
   return [=](Config &Conf, ModuleSummaryIndex &CombinedIndex,
              const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
              AddStreamFn AddStream, NativeObjectCache Cache) {
     return std::make_unique<InProcessThinBackend>(
-        Conf, CombinedIndex, ParallelismLevel, ModuleToDefinedGVSummaries,
+        Conf, CombinedIndex, Parallelism, ModuleToDefinedGVSummaries,
         AddStream, Cache);
   };
 }
@@ -1220,8 +1323,7 @@ public:
                                      ImportList, ModuleToSummariesForIndex);
 
     std::error_code EC;
-    raw_fd_ostream OS(NewModulePath + ".thinlto.bc", EC,
-                      sys::fs::OpenFlags::OF_None);
+    raw_fd_stream OS(NewModulePath + ".thinlto.bc", EC);
     if (EC)
       return errorCodeToError(EC);
     WriteIndexToFile(CombinedIndex, OS, &ModuleToSummariesForIndex);
@@ -1254,6 +1356,197 @@ ThinBackend lto::createWriteIndexesThinBackend(
   };
 }
 
+namespace {
+class RemoteThinBackend : public ThinBackendProc {
+  RemoteBackendExecutor Executor;
+  unsigned MaxJobs;
+  AddStreamFn AddStream;
+  NativeObjectCache Cache;
+  std::set<GlobalValue::GUID> CfiFunctionDefs;
+  std::set<GlobalValue::GUID> CfiFunctionDecls;
+
+  /// The jobs to run, with the streams to write their objects to.
+  using JobEntry = std::pair<RemoteBackendJob, AddStreamFn>;
+  std::vector<JobEntry> Jobs;
+
+  Optional<Error> Err;
+  std::mutex ErrMu;
+
+public:
+  RemoteThinBackend(Config &Conf, ModuleSummaryIndex &CombinedIndex,
+                    const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
+                    RemoteBackendExecutor Executor, unsigned MaxJobs,
+                    AddStreamFn AddStream, NativeObjectCache Cache)
+      : ThinBackendProc(Conf, CombinedIndex, ModuleToDefinedGVSummaries),
+        Executor(std::move(Executor)), MaxJobs(MaxJobs),
+        AddStream(std::move(AddStream)), Cache(std::move(Cache)) {
+    for (auto &Name : CombinedIndex.cfiFunctionDefs())
+      CfiFunctionDefs.insert(
+          GlobalValue::getGUID(GlobalValue::dropLLVMManglingEscape(Name)));
+    for (auto &Name : CombinedIndex.cfiFunctionDecls())
+      CfiFunctionDecls.insert(
+          GlobalValue::getGUID(GlobalValue::dropLLVMManglingEscape(Name)));
+  }
+
+  Error start(
+      unsigned Task, BitcodeModule BM,
+      const FunctionImporter::ImportMapTy &ImportList,
+      const FunctionImporter::ExportSetTy &ExportList,
+      const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes> &ResolvedODR,
+      MapVector<StringRef, BitcodeModule> &ModuleMap) override {
+    StringRef ModuleID = BM.getModuleIdentifier();
+    assert(ModuleToDefinedGVSummaries.count(ModuleID));
+    const GVSummaryMapTy &DefinedGlobals =
+        ModuleToDefinedGVSummaries.find(ModuleID)->second;
+
+    // Look the object up in the cache first, as the in-process backend does.
+    AddStreamFn JobAddStream = AddStream;
+    if (Cache && CombinedIndex.modulePaths().count(ModuleID) &&
+        !all_of(CombinedIndex.getModuleHash(ModuleID),
+                [](uint32_t V) { return V == 0; })) {
+      SmallString<40> Key;
+      computeLTOCacheKey(Key, Conf, CombinedIndex, ModuleID, ImportList,
+                         ExportList, ResolvedODR, DefinedGlobals,
+                         CfiFunctionDefs, CfiFunctionDecls);
+      JobAddStream = Cache(Task, Key);
+      if (!JobAddStream)
+        return Error::success();
+    }
+
+    std::map<std::string, GVSummaryMapTy> ModuleToSummariesForIndex;
+    gatherImportedSummariesForModule(ModuleID, ModuleToDefinedGVSummaries,
+                                     ImportList, ModuleToSummariesForIndex);
+
+    RemoteBackendJob Job;
+    Job.Task = Task;
+    Job.ModuleID = ModuleID;
+    Job.ModuleBitcode = BM.getBuffer();
+    {
+      raw_string_ostream OS(Job.IndexSlice);
+      WriteIndexToFile(CombinedIndex, OS, &ModuleToSummariesForIndex);
+    }
+    for (auto &ModuleSummaries : ModuleToSummariesForIndex)
+      if (ModuleSummaries.first != ModuleID)
+        Job.ImportedModules.push_back(ModuleSummaries.first);
+    Job.Cost =
+        estimateThinBackendCost(CombinedIndex, DefinedGlobals, ImportList);
+    Jobs.emplace_back(std::move(Job), std::move(JobAddStream));
+    return Error::success();
+  }
+
+  Error runJob(const RemoteBackendJob &Job, const AddStreamFn &JobAddStream) {
+    Expected<std::unique_ptr<MemoryBuffer>> ObjOrErr = Executor(Job);
+    if (!ObjOrErr)
+      return createStringError(inconvertibleErrorCode(),
+                               "remote ThinLTO backend failed for " +
+                                   Job.ModuleID + ": " +
+                                   toString(ObjOrErr.takeError()));
+    std::unique_ptr<NativeObjectStream> Stream = JobAddStream(Job.Task);
+    *Stream->OS << (*ObjOrErr)->getBuffer();
+    return Error::success();
+  }
+
+  Error wait() override {
+    // Start the most expensive jobs first, so that a large module that would
+    // otherwise be started last does not delay the link on its own.
+    llvm::stable_sort(Jobs, [](const JobEntry &A, const JobEntry &B) {
+      return A.first.Cost > B.first.Cost;
+    });
+
+    ThreadPool Pool(hardware_concurrency_strategy(MaxJobs));
+    for (auto &J : Jobs) {
+      Pool.async([&]() {
+        if (Error E = runJob(J.first, J.second)) {
+          std::unique_lock<std::mutex> L(ErrMu);
+          if (Err)
+            Err = joinErrors(std::move(*Err), std::move(E));
+          else
+            Err = std::move(E);
+        }
+      });
+    }
+    Pool.wait();
+    Jobs.clear();
+
+    if (Err)
+      return std::move(*Err);
+    return Error::success();
+  }
+};
+} // end anonymous namespace
+
+ThinBackend lto::createRemoteThinBackend(RemoteBackendExecutor Executor,
+                                         unsigned MaxJobs) {
+  return [=](Config &Conf, ModuleSummaryIndex &CombinedIndex,
+             const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
+             AddStreamFn AddStream, NativeObjectCache Cache) {
+    return std::make_unique<RemoteThinBackend>(
+        Conf, CombinedIndex, ModuleToDefinedGVSummaries, Executor, MaxJobs,
+        AddStream, Cache);
+  };
+}
+
+/// Write \p Data to a new temporary file with the extension \p Suffix, and
+/// return its path in \p Path.
+static Error writeTemporaryFile(StringRef Suffix, StringRef Data,
+                                SmallVectorImpl<char> &Path) {
+  int FD;
+  if (std::error_code EC =
+          sys::fs::createTemporaryFile("thinlto-remote", Suffix, FD, Path))
+    return errorCodeToError(EC);
+  raw_fd_ostream OS(FD, /*shouldClose=*/true);
+  OS << Data;
+  OS.close();
+  if (OS.has_error())
+    return errorCodeToError(OS.error());
+  return Error::success();
+}
+
+RemoteBackendExecutor
+lto::createCommandRemoteBackendExecutor(std::string Program,
+                                        std::vector<std::string> Args) {
+  return [=](const RemoteBackendJob &Job)
+             -> Expected<std::unique_ptr<MemoryBuffer>> {
+    SmallString<128> ModulePath, IndexPath, ObjectPath;
+    if (Error E = writeTemporaryFile("bc", Job.ModuleBitcode, ModulePath))
+      return std::move(E);
+    FileRemover RemoveModule(ModulePath);
+    if (Error E = writeTemporaryFile("thinlto.bc", Job.IndexSlice, IndexPath))
+      return std::move(E);
+    FileRemover RemoveIndex(IndexPath);
+    if (std::error_code EC =
+            sys::fs::createTemporaryFile("thinlto-remote", "o", ObjectPath))
+      return errorCodeToError(EC);
+    FileRemover RemoveObject(ObjectPath);
+
+    SmallVector<StringRef, 8> Argv;
+    Argv.push_back(Program);
+    for (const std::string &Arg : Args)
+      Argv.push_back(Arg);
+    Argv.push_back(ModulePath);
+    Argv.push_back(IndexPath);
+    Argv.push_back(ObjectPath);
+
+    std::string ErrMsg;
+    int Status = sys::ExecuteAndWait(Program, Argv, /*Env=*/None,
+                                     /*Redirects=*/{}, /*SecondsToWait=*/0,
+                                     /*MemoryLimit=*/0, &ErrMsg);
+    if (Status != 0)
+      return createStringError(inconvertibleErrorCode(),
+                               ErrMsg.empty() ? "'" + Program +
+                                                    "' exited with status " +
+                                                    Twine(Status).str()
+                                              : ErrMsg);
+
+    ErrorOr<std::unique_ptr<MemoryBuffer>> ObjOrErr =
+        MemoryBuffer::getFile(ObjectPath, /*FileSize=*/-1,
+                              /*RequiresNullTerminator=*/false);
+    if (!ObjOrErr)
+      return errorCodeToError(ObjOrErr.getError());
+    return std::move(*ObjOrErr);
+  };
+}
+
 Error LTO::runThinLTO(AddStreamFn AddStream, NativeObjectCache Cache,
                       const DenseSet<GlobalValue::GUID> &GUIDPreservedSymbols) {
   if (ThinLTO.ModuleMap.empty())
@@ -1353,6 +1646,7 @@ Error LTO::runThinLTO(AddStreamFn AddStream, NativeObjectCache Cache,
   };
   thinLTOResolvePrevailingInIndex(ThinLTO.CombinedIndex, isPrevailing,
                                   recordNewLinkage, GUIDPreservedSymbols);
+  reportMemoryUsage(Conf, "ThinLTO thin link");
 
   std::unique_ptr<ThinBackendProc> BackendProc =
       ThinLTO.Backend(Conf, ThinLTO.CombinedIndex, ModuleToDefinedGVSummaries,
@@ -29,6 +29,7 @@
 #include "llvm/Object/ModuleSymbolTable.h"
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Passes/StandardInstrumentations.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -47,6 +48,12 @@
 using namespace llvm;
 using namespace lto;
 
+static cl::opt<bool> LTOParallelOpt(
+    "lto-parallel-opt", cl::init(false), cl::Hidden,
+    cl::desc("With parallel code generation in regular LTO, run the function "
+             "simplification passes that follow the interprocedural passes "
+             "on each code generation partition in parallel"));
+
 LLVM_ATTRIBUTE_NORETURN static void reportOpenError(StringRef Path, Twine Msg) {
   errs() << "failed to open " << Path << ": " << Msg << '\n';
   errs().flush();
@@ -84,7 +91,7 @@ Error Config::addSaveTemps(std::string OutputFileName,
         PathPrefix = M.getModuleIdentifier() + ".";
       std::string Path = PathPrefix + PathSuffix + ".bc";
       std::error_code EC;
-      raw_fd_ostream OS(Path, EC, sys::fs::OpenFlags::OF_None);
+      raw_fd_stream OS(Path, EC);
       // Because -save-temps is a debugging feature, we report the error
       // directly and exit.
       if (EC)
@@ -104,7 +111,7 @@ Error Config::addSaveTemps(std::string OutputFileName,
   CombinedIndexHook = [=](const ModuleSummaryIndex &Index) {
     std::string Path = OutputFileName + "index.bc";
     std::error_code EC;
-    raw_fd_ostream OS(Path, EC, sys::fs::OpenFlags::OF_None);
+    raw_fd_stream OS(Path, EC);
     // Because -save-temps is a debugging feature, we report the error
     // directly and exit.
     if (EC)
@@ -266,24 +273,31 @@ static void runNewPMCustomPasses(Module &Mod, TargetMachine *TM,
   MPM.run(Mod, MAM);
 }
 
+static void initOldPMBuilder(Config &Conf, TargetMachine *TM,
+                             PassManagerBuilder &PMB) {
+  PMB.LibraryInfo = new TargetLibraryInfoImpl(Triple(TM->getTargetTriple()));
+  PMB.VerifyOutput = !Conf.DisableVerify;
+  PMB.LoopVectorize = true;
+  PMB.SLPVectorize = true;
+  PMB.OptLevel = Conf.OptLevel;
+}
+
 static void runOldPMPasses(Config &Conf, Module &Mod, TargetMachine *TM,
                            bool IsThinLTO, ModuleSummaryIndex *ExportSummary,
-                           const ModuleSummaryIndex *ImportSummary) {
+                           const ModuleSummaryIndex *ImportSummary,
+                           bool DeferFunctionSimplification) {
   legacy::PassManager passes;
   passes.add(createTargetTransformInfoWrapperPass(TM->getTargetIRAnalysis()));
 
   PassManagerBuilder PMB;
-  PMB.LibraryInfo = new TargetLibraryInfoImpl(Triple(TM->getTargetTriple()));
+  initOldPMBuilder(Conf, TM, PMB);
   PMB.Inliner = createFunctionInliningPass();
   PMB.ExportSummary = ExportSummary;
   PMB.ImportSummary = ImportSummary;
   // Unconditionally verify input since it is not verified before this
   // point and has unknown origin.
   PMB.VerifyInput = true;
-  PMB.VerifyOutput = !Conf.DisableVerify;
-  PMB.LoopVectorize = true;
-  PMB.SLPVectorize = true;
-  PMB.OptLevel = Conf.OptLevel;
+  PMB.DeferLTOFunctionSimplification = DeferFunctionSimplification;
   PMB.PGOSampleUse = Conf.SampleProfile;
   PMB.EnablePGOCSInstrGen = Conf.RunCSIRInstr;
   if (!Conf.RunCSIRInstr && !Conf.CSIRProfile.empty()) {
@@ -297,9 +311,23 @@ static void runOldPMPasses(Config &Conf, Module &Mod, TargetMachine *TM,
   passes.run(Mod);
 }
 
+/// Run the function simplification passes that runOldPMPasses left out of the
+/// regular LTO pipeline on a code generation partition.
+static void runOldPMPartitionPasses(Config &Conf, Module &Mod,
+                                    TargetMachine *TM) {
+  legacy::PassManager passes;
+  passes.add(createTargetTransformInfoWrapperPass(TM->getTargetIRAnalysis()));
+
+  PassManagerBuilder PMB;
+  initOldPMBuilder(Conf, TM, PMB);
+  PMB.populateLTOFunctionSimplificationPassManager(passes);
+  passes.run(Mod);
+}
+
 bool opt(Config &Conf, TargetMachine *TM, unsigned Task, Module &Mod,
          bool IsThinLTO, ModuleSummaryIndex *ExportSummary,
-         const ModuleSummaryIndex *ImportSummary) {
+         const ModuleSummaryIndex *ImportSummary,
+         bool DeferFunctionSimplification = false) {
   // FIXME: Plumb the combined index into the new pass manager.
   if (!Conf.OptPipeline.empty())
     runNewPMCustomPasses(Mod, TM, Conf.OptPipeline, Conf.AAPipeline,
@@ -308,7 +336,8 @@ bool opt(Config &Conf, TargetMachine *TM, unsigned Task, Module &Mod,
     runNewPMPasses(Conf, Mod, TM, Conf.OptLevel, IsThinLTO, ExportSummary,
                    ImportSummary);
   else
-    runOldPMPasses(Conf, Mod, TM, IsThinLTO, ExportSummary, ImportSummary);
+    runOldPMPasses(Conf, Mod, TM, IsThinLTO, ExportSummary, ImportSummary,
+                   DeferFunctionSimplification);
   return !Conf.PostOptModuleHook || Conf.PostOptModuleHook(Task, Mod);
 }
 
@@ -352,7 +381,7 @@ void codegen(Config &Conf, TargetMachine *TM, AddStreamFn AddStream,
 
 void splitCodeGen(Config &C, TargetMachine *TM, AddStreamFn AddStream,
                   unsigned ParallelCodeGenParallelismLevel,
-                  std::unique_ptr<Module> Mod) {
+                  std::unique_ptr<Module> Mod, bool OptimizePartitions) {
   ThreadPool CodegenThreadPool(ParallelCodeGenParallelismLevel);
   unsigned ThreadCount = 0;
   const Target *T = &TM->getTarget();
@@ -384,6 +413,9 @@ void splitCodeGen(Config &C, TargetMachine *TM, AddStreamFn AddStream,
               std::unique_ptr<TargetMachine> TM =
                   createTargetMachine(C, T, *MPartInCtx);
 
+              if (OptimizePartitions)
+                runOldPMPartitionPasses(C, *MPartInCtx, TM.get());
+
               codegen(C, TM.get(), AddStream, ThreadId, *MPartInCtx);
             },
             // Pass BC using std::move to ensure that it get moved rather than
@@ -442,9 +474,18 @@ Error lto::backend(Config &C, AddStreamFn AddStream,
     return DiagFileOrErr.takeError();
   auto DiagnosticOutputFile = std::move(*DiagFileOrErr);
 
+  // With -lto-parallel-opt, only the interprocedural part of the pipeline runs
+  // on the whole module, and the function simplification passes after it
+  // run on the code generation partitions. The legacy pipeline is the only
+  // one that can be split this way.
+  bool OptimizePartitions = LTOParallelOpt && !C.CodeGenOnly &&
+                            ParallelCodeGenParallelismLevel > 1 &&
+                            C.OptPipeline.empty() && !C.UseNewPM;
+
   if (!C.CodeGenOnly) {
     if (!opt(C, TM.get(), 0, *Mod, /*IsThinLTO=*/false,
-             /*ExportSummary=*/&CombinedIndex, /*ImportSummary=*/nullptr))
+             /*ExportSummary=*/&CombinedIndex, /*ImportSummary=*/nullptr,
+             /*DeferFunctionSimplification=*/OptimizePartitions))
       return finalizeOptimizationRemarks(std::move(DiagnosticOutputFile));
   }
 
@@ -452,7 +493,7 @@ Error lto::backend(Config &C, AddStreamFn AddStream,
     codegen(C, TM.get(), AddStream, 0, *Mod);
   } else {
     splitCodeGen(C, TM.get(), AddStream, ParallelCodeGenParallelismLevel,
-                 std::move(Mod));
+                 std::move(Mod), OptimizePartitions);
   }
   return finalizeOptimizationRemarks(std::move(DiagnosticOutputFile));
 }
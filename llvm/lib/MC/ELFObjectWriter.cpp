@@ -39,6 +39,7 @@
 #include "llvm/Support/Alignment.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
@@ -46,6 +47,7 @@
 #include "llvm/Support/Host.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/SMLoc.h"
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/SwapByteOrder.h"
@@ -65,6 +67,11 @@ using namespace llvm;
 #undef  DEBUG_TYPE
 #define DEBUG_TYPE "reloc-info"
 
+static cl::opt<bool> ParallelWrite(
+    "elf-parallel-write", cl::Hidden, cl::init(false),
+    cl::desc("Render section contents, compress debug sections and encode "
+             "relocations on multiple threads before writing them in order"));
+
 namespace {
 
 using SectionIndexMapTy = DenseMap<const MCSectionELF *, uint32_t>;
@@ -158,7 +165,7 @@ struct ELFWriter {
 
   void align(unsigned Alignment);
 
-  bool maybeWriteCompression(uint64_t Size,
+  bool maybeWriteCompression(raw_ostream &OS, uint64_t Size,
                              SmallVectorImpl<char> &CompressedContents,
                              bool ZLibStyle, unsigned Alignment);
 
@@ -215,12 +222,31 @@ public:
   void writeSectionData(const MCAssembler &Asm, MCSection &Sec,
                         const MCAsmLayout &Layout);
 
+  /// Whether the contents of \p Section are compressed when possible.
+  static bool shouldCompress(const MCAssembler &Asm,
+                             const MCSectionELF &Section);
+
+  /// Append the contents of a section to compress to \p Contents, with the
+  /// compression header if compressing makes it smaller. Returns true if the
+  /// contents are compressed. This doesn't modify the section, so sections
+  /// can be rendered concurrently.
+  bool renderCompressedSectionData(const MCAssembler &Asm, MCSection &Sec,
+                                   const MCAsmLayout &Layout,
+                                   SmallVectorImpl<char> &Contents);
+
+  /// Update the flags or the name of a section with compressed contents.
+  void markCompressed(const MCAssembler &Asm, MCSection &Sec);
+
   void WriteSecHdrEntry(uint32_t Name, uint32_t Type, uint64_t Flags,
                         uint64_t Address, uint64_t Offset, uint64_t Size,
                         uint32_t Link, uint32_t Info, uint64_t Alignment,
                         uint64_t EntrySize);
 
-  void writeRelocations(const MCAssembler &Asm, const MCSectionELF &Sec);
+  /// Write the relocation entries of \p Sec to \p OS. This only reads the
+  /// state of the writer, so the relocations of several sections can be
+  /// encoded concurrently.
+  void writeRelocations(const MCAssembler &Asm, const MCSectionELF &Sec,
+                        raw_ostream &OS);
 
   uint64_t writeObject(MCAssembler &Asm, const MCAsmLayout &Layout);
   void writeSection(const SectionIndexMapTy &SectionIndexMap,
@@ -830,8 +856,9 @@ MCSectionELF *ELFWriter::createRelocationSection(MCContext &Ctx,
 
 // Include the debug info compression header.
 bool ELFWriter::maybeWriteCompression(
-    uint64_t Size, SmallVectorImpl<char> &CompressedContents, bool ZLibStyle,
-    unsigned Alignment) {
+    raw_ostream &OS, uint64_t Size, SmallVectorImpl<char> &CompressedContents,
+    bool ZLibStyle, unsigned Alignment) {
+  support::endian::Writer HW(OS, W.Endian);
   if (ZLibStyle) {
     uint64_t HdrSize =
         is64Bit() ? sizeof(ELF::Elf32_Chdr) : sizeof(ELF::Elf64_Chdr);
@@ -840,15 +867,15 @@ bool ELFWriter::maybeWriteCompression(
     // Platform specific header is followed by compressed data.
     if (is64Bit()) {
       // Write Elf64_Chdr header.
-      write(static_cast<ELF::Elf64_Word>(ELF::ELFCOMPRESS_ZLIB));
-      write(static_cast<ELF::Elf64_Word>(0)); // ch_reserved field.
-      write(static_cast<ELF::Elf64_Xword>(Size));
-      write(static_cast<ELF::Elf64_Xword>(Alignment));
+      HW.write(static_cast<ELF::Elf64_Word>(ELF::ELFCOMPRESS_ZLIB));
+      HW.write(static_cast<ELF::Elf64_Word>(0)); // ch_reserved field.
+      HW.write(static_cast<ELF::Elf64_Xword>(Size));
+      HW.write(static_cast<ELF::Elf64_Xword>(Alignment));
     } else {
       // Write Elf32_Chdr header otherwise.
-      write(static_cast<ELF::Elf32_Word>(ELF::ELFCOMPRESS_ZLIB));
-      write(static_cast<ELF::Elf32_Word>(Size));
-      write(static_cast<ELF::Elf32_Word>(Alignment));
+      HW.write(static_cast<ELF::Elf32_Word>(ELF::ELFCOMPRESS_ZLIB));
+      HW.write(static_cast<ELF::Elf32_Word>(Size));
+      HW.write(static_cast<ELF::Elf32_Word>(Alignment));
     }
     return true;
   }
@@ -858,55 +885,59 @@ bool ELFWriter::maybeWriteCompression(
   const StringRef Magic = "ZLIB";
   if (Size <= Magic.size() + sizeof(Size) + CompressedContents.size())
     return false;
-  W.OS << Magic;
-  support::endian::write(W.OS, Size, support::big);
+  OS << Magic;
+  support::endian::write(OS, Size, support::big);
   return true;
 }
 
-void ELFWriter::writeSectionData(const MCAssembler &Asm, MCSection &Sec,
-                                 const MCAsmLayout &Layout) {
-  MCSectionELF &Section = static_cast<MCSectionELF &>(Sec);
-  StringRef SectionName = Section.getSectionName();
-
-  auto &MC = Asm.getContext();
-  const auto &MAI = MC.getAsmInfo();
-
+bool ELFWriter::shouldCompress(const MCAssembler &Asm,
+                               const MCSectionELF &Section) {
   // Compressing debug_frame requires handling alignment fragments which is
   // more work (possibly generalizing MCAssembler.cpp:writeFragment to allow
   // for writing to arbitrary buffers) for little benefit.
-  bool CompressionEnabled =
-      MAI->compressDebugSections() != DebugCompressionType::None;
-  if (!CompressionEnabled || !SectionName.startswith(".debug_") ||
-      SectionName == ".debug_frame") {
-    Asm.writeSectionData(W.OS, &Section, Layout);
-    return;
-  }
+  const MCAsmInfo *MAI = Asm.getContext().getAsmInfo();
+  StringRef SectionName = Section.getSectionName();
+  return MAI->compressDebugSections() != DebugCompressionType::None &&
+         SectionName.startswith(".debug_") && SectionName != ".debug_frame";
+}
 
+bool ELFWriter::renderCompressedSectionData(const MCAssembler &Asm,
+                                            MCSection &Sec,
+                                            const MCAsmLayout &Layout,
+                                            SmallVectorImpl<char> &Contents) {
+  const MCAsmInfo *MAI = Asm.getContext().getAsmInfo();
   assert((MAI->compressDebugSections() == DebugCompressionType::Z ||
           MAI->compressDebugSections() == DebugCompressionType::GNU) &&
          "expected zlib or zlib-gnu style compression");
 
   SmallVector<char, 128> UncompressedData;
   raw_svector_ostream VecOS(UncompressedData);
-  Asm.writeSectionData(VecOS, &Section, Layout);
+  Asm.writeSectionData(VecOS, &Sec, Layout);
 
   SmallVector<char, 128> CompressedContents;
   if (Error E = zlib::compress(
           StringRef(UncompressedData.data(), UncompressedData.size()),
           CompressedContents)) {
     consumeError(std::move(E));
-    W.OS << UncompressedData;
-    return;
+    Contents.append(UncompressedData.begin(), UncompressedData.end());
+    return false;
   }
 
   bool ZlibStyle = MAI->compressDebugSections() == DebugCompressionType::Z;
-  if (!maybeWriteCompression(UncompressedData.size(), CompressedContents,
+  raw_svector_ostream OS(Contents);
+  if (!maybeWriteCompression(OS, UncompressedData.size(), CompressedContents,
                              ZlibStyle, Sec.getAlignment())) {
-    W.OS << UncompressedData;
-    return;
+    OS << UncompressedData;
+    return false;
   }
+  OS << CompressedContents;
+  return true;
+}
 
-  if (ZlibStyle) {
+void ELFWriter::markCompressed(const MCAssembler &Asm, MCSection &Sec) {
+  MCSectionELF &Section = static_cast<MCSectionELF &>(Sec);
+  MCContext &MC = Asm.getContext();
+  if (MC.getAsmInfo()->compressDebugSections() == DebugCompressionType::Z) {
     // Set the compressed flag. That is zlib style.
     Section.setFlags(Section.getFlags() | ELF::SHF_COMPRESSED);
     // Alignment field should reflect the requirements of
@@ -914,9 +945,23 @@ void ELFWriter::writeSectionData(const MCAssembler &Asm, MCSection &Sec,
     Section.setAlignment(is64Bit() ? Align(8) : Align(4));
   } else {
     // Add "z" prefix to section name. This is zlib-gnu style.
-    MC.renameELFSection(&Section, (".z" + SectionName.drop_front(1)).str());
+    MC.renameELFSection(&Section,
+                        (".z" + Section.getSectionName().drop_front(1)).str());
   }
-  W.OS << CompressedContents;
+}
+
+void ELFWriter::writeSectionData(const MCAssembler &Asm, MCSection &Sec,
+                                 const MCAsmLayout &Layout) {
+  MCSectionELF &Section = static_cast<MCSectionELF &>(Sec);
+  if (!shouldCompress(Asm, Section)) {
+    Asm.writeSectionData(W.OS, &Section, Layout);
+    return;
+  }
+
+  SmallVector<char, 128> Contents;
+  if (renderCompressedSectionData(Asm, Section, Layout, Contents))
+    markCompressed(Asm, Section);
+  W.OS << Contents;
 }
 
 void ELFWriter::WriteSecHdrEntry(uint32_t Name, uint32_t Type, uint64_t Flags,
@@ -936,8 +981,12 @@ void ELFWriter::WriteSecHdrEntry(uint32_t Name, uint32_t Type, uint64_t Flags,
 }
 
 void ELFWriter::writeRelocations(const MCAssembler &Asm,
-                                       const MCSectionELF &Sec) {
-  std::vector<ELFRelocationEntry> &Relocs = OWriter.Relocations[&Sec];
+                                 const MCSectionELF &Sec, raw_ostream &OS) {
+  auto RelocsIt = OWriter.Relocations.find(&Sec);
+  assert(RelocsIt != OWriter.Relocations.end() &&
+         "relocation section without relocations");
+  std::vector<ELFRelocationEntry> &Relocs = RelocsIt->second;
+  support::endian::Writer RW(OS, W.Endian);
 
   // We record relocations by pushing to the end of a vector. Reverse the vector
   // to get the relocations in the order they were created.
@@ -953,47 +1002,47 @@ void ELFWriter::writeRelocations(const MCAssembler &Asm,
     unsigned Index = Entry.Symbol ? Entry.Symbol->getIndex() : 0;
 
     if (is64Bit()) {
-      write(Entry.Offset);
+      RW.write(Entry.Offset);
       if (OWriter.TargetObjectWriter->getEMachine() == ELF::EM_MIPS) {
-        write(uint32_t(Index));
+        RW.write(uint32_t(Index));
 
-        write(OWriter.TargetObjectWriter->getRSsym(Entry.Type));
-        write(OWriter.TargetObjectWriter->getRType3(Entry.Type));
-        write(OWriter.TargetObjectWriter->getRType2(Entry.Type));
-        write(OWriter.TargetObjectWriter->getRType(Entry.Type));
+        RW.write(OWriter.TargetObjectWriter->getRSsym(Entry.Type));
+        RW.write(OWriter.TargetObjectWriter->getRType3(Entry.Type));
+        RW.write(OWriter.TargetObjectWriter->getRType2(Entry.Type));
+        RW.write(OWriter.TargetObjectWriter->getRType(Entry.Type));
       } else {
         struct ELF::Elf64_Rela ERE64;
         ERE64.setSymbolAndType(Index, Entry.Type);
-        write(ERE64.r_info);
+        RW.write(ERE64.r_info);
       }
       if (hasRelocationAddend())
-        write(Entry.Addend);
+        RW.write(Entry.Addend);
     } else {
-      write(uint32_t(Entry.Offset));
+      RW.write(uint32_t(Entry.Offset));
 
       struct ELF::Elf32_Rela ERE32;
       ERE32.setSymbolAndType(Index, Entry.Type);
-      write(ERE32.r_info);
+      RW.write(ERE32.r_info);
 
       if (hasRelocationAddend())
-        write(uint32_t(Entry.Addend));
+        RW.write(uint32_t(Entry.Addend));
 
       if (OWriter.TargetObjectWriter->getEMachine() == ELF::EM_MIPS) {
         if (uint32_t RType =
                 OWriter.TargetObjectWriter->getRType2(Entry.Type)) {
-          write(uint32_t(Entry.Offset));
+          RW.write(uint32_t(Entry.Offset));
 
           ERE32.setSymbolAndType(0, RType);
-          write(ERE32.r_info);
-          write(uint32_t(0));
+          RW.write(ERE32.r_info);
+          RW.write(uint32_t(0));
         }
         if (uint32_t RType =
                 OWriter.TargetObjectWriter->getRType3(Entry.Type)) {
-          write(uint32_t(Entry.Offset));
+          RW.write(uint32_t(Entry.Offset));
 
           ERE32.setSymbolAndType(0, RType);
-          write(ERE32.r_info);
-          write(uint32_t(0));
+          RW.write(ERE32.r_info);
+          RW.write(uint32_t(0));
         }
       }
     }
@@ -1106,23 +1155,60 @@ uint64_t ELFWriter::writeObject(MCAssembler &Asm, const MCAsmLayout &Layout) {
   writeHeader(Asm);
 
   // ... then the sections ...
-  SectionOffsetsTy SectionOffsets;
-  std::vector<MCSectionELF *> Groups;
-  std::vector<MCSectionELF *> Relocations;
+  std::vector<MCSectionELF *> Sections;
   for (MCSection &Sec : Asm) {
     MCSectionELF &Section = static_cast<MCSectionELF &>(Sec);
     if (Mode == NonDwoOnly && isDwoSection(Section))
       continue;
     if (Mode == DwoOnly && !isDwoSection(Section))
       continue;
+    Sections.push_back(&Section);
+  }
+
+  // The layout is final, so the contents of the sections can be rendered
+  // concurrently. Only writing them, and the updates of compressed sections,
+  // must happen in order.
+  struct RenderedSection {
+    SmallVector<char, 0> Contents;
+    bool Compressed = false;
+  };
+  std::vector<RenderedSection> Rendered;
+  if (ParallelWrite) {
+    Rendered.resize(Sections.size());
+    auto Render = [&](size_t I) {
+      MCSectionELF &Section = *Sections[I];
+      RenderedSection &R = Rendered[I];
+      if (shouldCompress(Asm, Section)) {
+        R.Compressed =
+            renderCompressedSectionData(Asm, Section, Layout, R.Contents);
+      } else {
+        raw_svector_ostream OS(R.Contents);
+        Asm.writeSectionData(OS, &Section, Layout);
+      }
+    };
+    parallel::for_each_n(parallel::par, size_t(0), Sections.size(), Render);
+  }
 
+  SectionOffsetsTy SectionOffsets;
+  std::vector<MCSectionELF *> Groups;
+  std::vector<MCSectionELF *> Relocations;
+  for (size_t I = 0, E = Sections.size(); I != E; ++I) {
+    MCSectionELF &Section = *Sections[I];
     align(Section.getAlignment());
 
     // Remember the offset into the file for this section.
     uint64_t SecStart = W.OS.tell();
 
     const MCSymbolELF *SignatureSymbol = Section.getGroup();
-    writeSectionData(Asm, Section, Layout);
+    if (ParallelWrite) {
+      RenderedSection &R = Rendered[I];
+      if (R.Compressed)
+        markCompressed(Asm, Section);
+      W.OS << R.Contents;
+      R.Contents = SmallVector<char, 0>();
+    } else {
+      writeSectionData(Asm, Section, Layout);
+    }
 
     uint64_t SecEnd = W.OS.tell();
     SectionOffsets[&Section] = std::make_pair(SecStart, SecEnd);
@@ -1196,14 +1282,35 @@ uint64_t ELFWriter::writeObject(MCAssembler &Asm, const MCAsmLayout &Layout) {
     computeSymbolTable(Asm, Layout, SectionIndexMap, RevGroupMap,
                        SectionOffsets);
 
-    for (MCSectionELF *RelSection : Relocations) {
+    // Symbol indices are final now, so the relocations can be encoded.
+    std::vector<SmallVector<char, 0>> EncodedRelocations;
+    if (ParallelWrite) {
+      EncodedRelocations.resize(Relocations.size());
+      auto Encode = [&](size_t I) {
+        raw_svector_ostream OS(EncodedRelocations[I]);
+        writeRelocations(
+            Asm, cast<MCSectionELF>(*Relocations[I]->getAssociatedSection()),
+            OS);
+      };
+      parallel::for_each_n(parallel::par, size_t(0), Relocations.size(),
+                           Encode);
+    }
+
+    for (size_t I = 0, E = Relocations.size(); I != E; ++I) {
+      MCSectionELF *RelSection = Relocations[I];
       align(RelSection->getAlignment());
 
       // Remember the offset into the file for this section.
       uint64_t SecStart = W.OS.tell();
 
-      writeRelocations(Asm,
-                       cast<MCSectionELF>(*RelSection->getAssociatedSection()));
+      if (ParallelWrite) {
+        W.OS << EncodedRelocations[I];
+        EncodedRelocations[I] = SmallVector<char, 0>();
+      } else {
+        writeRelocations(
+            Asm, cast<MCSectionELF>(*RelSection->getAssociatedSection()),
+            W.OS);
+      }
 
       uint64_t SecEnd = W.OS.tell();
       SectionOffsets[RelSection] = std::make_pair(SecStart, SecEnd);
@@ -32,12 +32,15 @@
 #include "llvm/MC/MCValue.h"
 #include "llvm/Support/Alignment.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cassert>
+#include <cinttypes>
 #include <cstdint>
 #include <cstring>
 #include <tuple>
@@ -67,15 +70,27 @@ STATISTIC(evaluateFixup, "Number of evaluated fixups");
 STATISTIC(FragmentLayouts, "Number of fragment layouts");
 STATISTIC(ObjectBytes, "Number of emitted object file bytes");
 STATISTIC(RelaxationSteps, "Number of assembler layout and relaxation steps");
+STATISTIC(StableSectionLayouts,
+          "Number of section layouts skipped as the section is stable");
 STATISTIC(RelaxedInstructions, "Number of relaxed instructions");
 STATISTIC(PaddingFragmentsRelaxations,
           "Number of Padding Fragments relaxations");
 STATISTIC(PaddingFragmentsBytes,
           "Total size of all padding from adding Fragments");
+STATISTIC(FragmentBytes, "Number of bytes used by assembler fragments");
+STATISTIC(FragmentHeapBytes,
+          "Number of bytes used by fragment contents and fixups outside of "
+          "the fragments");
 
 } // end namespace stats
 } // end anonymous namespace
 
+static cl::opt<bool>
+    PrintMCMemory("print-mc-memory", cl::Hidden,
+                  cl::desc("Print the memory used by the assembler fragments "
+                           "of each kind before the object file is written"),
+                  cl::init(false));
+
 // FIXME FIXME FIXME: There are number of places in this file where we convert
 // what is a 64-bit assembler value used for computation into a value in the
 // object file, which may truncate it. We should detect that truncation where
@@ -755,6 +770,22 @@ MCAssembler::handleFixup(const MCAsmLayout &Layout, MCFragment &F,
   return std::make_tuple(Target, FixedValue, IsResolved);
 }
 
+/// Whether layoutSectionOnce may change the size of \p F.
+static bool mayNeedRelaxation(const MCFragment &F) {
+  switch (F.getKind()) {
+  case MCFragment::FT_Relaxable:
+  case MCFragment::FT_Dwarf:
+  case MCFragment::FT_DwarfFrame:
+  case MCFragment::FT_LEB:
+  case MCFragment::FT_Padding:
+  case MCFragment::FT_CVInlineLines:
+  case MCFragment::FT_CVDefRange:
+    return true;
+  default:
+    return false;
+  }
+}
+
 void MCAssembler::layout(MCAsmLayout &Layout) {
   assert(getBackendPtr() && "Expected assembler backend");
   DEBUG_WITH_TYPE("mc-dump", {
@@ -772,14 +803,22 @@ void MCAssembler::layout(MCAsmLayout &Layout) {
     Sec.setOrdinal(SectionIndex++);
   }
 
-  // Assign layout order indices to sections and fragments.
+  // Assign layout order indices to sections and fragments, and find the
+  // sections that need to be considered for relaxation.
+  NumSectionRelaxations = 0;
+  SectionStableAt.assign(SectionIndex, unsigned(NeverRelaxes));
   for (unsigned i = 0, e = Layout.getSectionOrder().size(); i != e; ++i) {
     MCSection *Sec = Layout.getSectionOrder()[i];
     Sec->setLayoutOrder(i);
 
     unsigned FragmentIndex = 0;
-    for (MCFragment &Frag : *Sec)
+    bool MayRelax = false;
+    for (MCFragment &Frag : *Sec) {
       Frag.setLayoutOrder(FragmentIndex++);
+      MayRelax |= mayNeedRelaxation(Frag);
+    }
+    if (MayRelax)
+      SectionStableAt[Sec->getOrdinal()] = NotYetLaidOut;
   }
 
   // Layout until everything fits.
@@ -860,11 +899,61 @@ void MCAssembler::layout(MCAsmLayout &Layout) {
   }
 }
 
+/// Tally the memory used by the fragments of \p Asm, and print it by fragment
+/// kind if -print-mc-memory is given.
+static void reportFragmentMemory(MCAssembler &Asm) {
+  struct KindInfo {
+    uint64_t Count = 0;
+    uint64_t Bytes = 0;
+    uint64_t HeapBytes = 0;
+  };
+  KindInfo Kinds[MCFragment::FT_Dummy + 1];
+  for (MCSection &Sec : Asm) {
+    for (const MCFragment &F : Sec) {
+      size_t Bytes = F.getMemorySize();
+      size_t HeapBytes = F.getOutOfLineMemorySize();
+      KindInfo &K = Kinds[F.getKind()];
+      ++K.Count;
+      K.Bytes += Bytes;
+      K.HeapBytes += HeapBytes;
+      stats::FragmentBytes += Bytes;
+      stats::FragmentHeapBytes += HeapBytes;
+    }
+  }
+  if (!PrintMCMemory)
+    return;
+
+  std::unique_ptr<raw_fd_ostream> OS = CreateInfoOutputFile();
+  *OS << "===" << std::string(73, '-') << "===\n"
+      << "                      Assembler fragment memory\n"
+      << "===" << std::string(73, '-') << "===\n";
+  *OS << "     Count        Bytes   Heap bytes  Kind\n";
+  KindInfo Total;
+  for (unsigned Kind = 0; Kind <= MCFragment::FT_Dummy; ++Kind) {
+    const KindInfo &K = Kinds[Kind];
+    if (!K.Count)
+      continue;
+    *OS << format("%10" PRIu64 " %12" PRIu64 " %12" PRIu64 "  ", K.Count,
+                  K.Bytes, K.HeapBytes)
+        << MCFragment::getKindName(MCFragment::FragmentType(Kind)) << '\n';
+    Total.Count += K.Count;
+    Total.Bytes += K.Bytes;
+    Total.HeapBytes += K.HeapBytes;
+  }
+  *OS << format("%10" PRIu64 " %12" PRIu64 " %12" PRIu64 "  ", Total.Count,
+                Total.Bytes, Total.HeapBytes)
+      << "Total\n";
+  OS->flush();
+}
+
 void MCAssembler::Finish() {
   // Create the layout object.
   MCAsmLayout Layout(*this);
   layout(Layout);
 
+  if (PrintMCMemory || AreStatisticsEnabled())
+    reportFragmentMemory(*this);
+
   // Write the object file.
   stats::ObjectBytes += getWriter().writeObject(*this, Layout);
 }
@@ -1112,8 +1201,19 @@ bool MCAssembler::layoutOnce(MCAsmLayout &Layout) {
   bool WasRelaxed = false;
   for (iterator it = begin(), ie = end(); it != ie; ++it) {
     MCSection &Sec = *it;
-    while (layoutSectionOnce(Layout, Sec))
+    // The relaxation of a section only depends on the sizes of fragments, so
+    // if no section has changed since this one was last found stable, it is
+    // still stable.
+    unsigned &StableAt = SectionStableAt[Sec.getOrdinal()];
+    if (StableAt == NeverRelaxes || StableAt == NumSectionRelaxations) {
+      ++stats::StableSectionLayouts;
+      continue;
+    }
+    while (layoutSectionOnce(Layout, Sec)) {
       WasRelaxed = true;
+      ++NumSectionRelaxations;
+    }
+    StableAt = NumSectionRelaxations;
   }
 
   return WasRelaxed;
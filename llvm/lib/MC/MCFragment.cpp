@@ -295,6 +295,96 @@ void MCFragment::destroy() {
   }
 }
 
+/// Return the bytes of \p V stored outside of \p F, which contains it.
+template <typename FragT, typename VectorT>
+static size_t getOutOfLineSize(const FragT &F, const VectorT &V) {
+  const char *Data = reinterpret_cast<const char *>(V.data());
+  const char *Begin = reinterpret_cast<const char *>(&F);
+  if (Data >= Begin && Data < Begin + sizeof(FragT))
+    return 0;
+  return V.capacity() * sizeof(*V.data());
+}
+
+template <typename FragT>
+static size_t getEncodedFragmentOutOfLineSize(const FragT &F) {
+  return getOutOfLineSize(F, F.getContents()) +
+         getOutOfLineSize(F, F.getFixups());
+}
+
+size_t MCFragment::getOutOfLineMemorySize() const {
+  switch (Kind) {
+  case FT_Data:
+    return getEncodedFragmentOutOfLineSize(*cast<MCDataFragment>(this));
+  case FT_CompactEncodedInst: {
+    const auto &F = *cast<MCCompactEncodedInstFragment>(this);
+    return getOutOfLineSize(F, F.getContents());
+  }
+  case FT_Relaxable:
+    return getEncodedFragmentOutOfLineSize(*cast<MCRelaxableFragment>(this));
+  case FT_Dwarf:
+    return getEncodedFragmentOutOfLineSize(
+        *cast<MCDwarfLineAddrFragment>(this));
+  case FT_DwarfFrame:
+    return getEncodedFragmentOutOfLineSize(
+        *cast<MCDwarfCallFrameFragment>(this));
+  case FT_LEB: {
+    const auto &F = *cast<MCLEBFragment>(this);
+    return getOutOfLineSize(F, F.getContents());
+  }
+  case FT_CVInlineLines: {
+    const auto &F = *cast<MCCVInlineLineTableFragment>(this);
+    return getOutOfLineSize(F, F.getContents());
+  }
+  case FT_CVDefRange:
+    return getEncodedFragmentOutOfLineSize(*cast<MCCVDefRangeFragment>(this));
+  default:
+    return 0;
+  }
+}
+
+size_t MCFragment::getMemorySize() const {
+  size_t Size = 0;
+  switch (Kind) {
+  case FT_Align: Size = sizeof(MCAlignFragment); break;
+  case FT_Data: Size = sizeof(MCDataFragment); break;
+  case FT_CompactEncodedInst:
+    Size = sizeof(MCCompactEncodedInstFragment);
+    break;
+  case FT_Fill: Size = sizeof(MCFillFragment); break;
+  case FT_Relaxable: Size = sizeof(MCRelaxableFragment); break;
+  case FT_Org: Size = sizeof(MCOrgFragment); break;
+  case FT_Dwarf: Size = sizeof(MCDwarfLineAddrFragment); break;
+  case FT_DwarfFrame: Size = sizeof(MCDwarfCallFrameFragment); break;
+  case FT_LEB: Size = sizeof(MCLEBFragment); break;
+  case FT_Padding: Size = sizeof(MCPaddingFragment); break;
+  case FT_SymbolId: Size = sizeof(MCSymbolIdFragment); break;
+  case FT_CVInlineLines: Size = sizeof(MCCVInlineLineTableFragment); break;
+  case FT_CVDefRange: Size = sizeof(MCCVDefRangeFragment); break;
+  case FT_Dummy: Size = sizeof(MCDummyFragment); break;
+  }
+  return Size + getOutOfLineMemorySize();
+}
+
+StringRef MCFragment::getKindName(FragmentType Kind) {
+  switch (Kind) {
+  case FT_Align: return "MCAlignFragment";
+  case FT_Data: return "MCDataFragment";
+  case FT_CompactEncodedInst: return "MCCompactEncodedInstFragment";
+  case FT_Fill: return "MCFillFragment";
+  case FT_Relaxable: return "MCRelaxableFragment";
+  case FT_Org: return "MCOrgFragment";
+  case FT_Dwarf: return "MCDwarfFragment";
+  case FT_DwarfFrame: return "MCDwarfCallFrameFragment";
+  case FT_LEB: return "MCLEBFragment";
+  case FT_Padding: return "MCPaddingFragment";
+  case FT_SymbolId: return "MCSymbolIdFragment";
+  case FT_CVInlineLines: return "MCCVInlineLineTableFragment";
+  case FT_CVDefRange: return "MCCVDefRangeTableFragment";
+  case FT_Dummy: return "MCDummyFragment";
+  }
+  llvm_unreachable("Unknown fragment kind");
+}
+
 // Debugging methods
 
 namespace llvm {
@@ -312,24 +402,7 @@ raw_ostream &operator<<(raw_ostream &OS, const MCFixup &AF) {
 LLVM_DUMP_METHOD void MCFragment::dump() const {
   raw_ostream &OS = errs();
 
-  OS << "<";
-  switch (getKind()) {
-  case MCFragment::FT_Align: OS << "MCAlignFragment"; break;
-  case MCFragment::FT_Data:  OS << "MCDataFragment"; break;
-  case MCFragment::FT_CompactEncodedInst:
-    OS << "MCCompactEncodedInstFragment"; break;
-  case MCFragment::FT_Fill:  OS << "MCFillFragment"; break;
-  case MCFragment::FT_Relaxable:  OS << "MCRelaxableFragment"; break;
-  case MCFragment::FT_Org:   OS << "MCOrgFragment"; break;
-  case MCFragment::FT_Dwarf: OS << "MCDwarfFragment"; break;
-  case MCFragment::FT_DwarfFrame: OS << "MCDwarfCallFrameFragment"; break;
-  case MCFragment::FT_LEB:   OS << "MCLEBFragment"; break;
-  case MCFragment::FT_Padding: OS << "MCPaddingFragment"; break;
-  case MCFragment::FT_SymbolId:    OS << "MCSymbolIdFragment"; break;
-  case MCFragment::FT_CVInlineLines: OS << "MCCVInlineLineTableFragment"; break;
-  case MCFragment::FT_CVDefRange: OS << "MCCVDefRangeTableFragment"; break;
-  case MCFragment::FT_Dummy: OS << "MCDummyFragment"; break;
-  }
+  OS << "<" << getKindName(getKind());
 
   OS << "<MCFragment " << (const void *)this << " LayoutOrder:" << LayoutOrder
      << " Offset:" << Offset << " HasInstructions:" << hasInstructions();
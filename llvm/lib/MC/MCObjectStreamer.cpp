@@ -367,11 +367,31 @@ void MCObjectStreamer::EmitInstToFragment(const MCInst &Inst,
   MCRelaxableFragment *IF = new MCRelaxableFragment(Inst, STI);
   insert(IF);
 
-  SmallString<128> Code;
-  raw_svector_ostream VecOS(Code);
-  getAssembler().getEmitter().encodeInstruction(Inst, VecOS, IF->getFixups(),
-                                                STI);
-  IF->getContents().append(Code.begin(), Code.end());
+  encodeInstruction(Inst, STI, IF->getContents(), IF->getFixups());
+}
+
+void MCObjectStreamer::encodeInstruction(const MCInst &Inst,
+                                         const MCSubtargetInfo &STI,
+                                         SmallVectorImpl<char> &Contents,
+                                         SmallVectorImpl<MCFixup> &Fixups) {
+  MCCodeEmitter &Emitter = getAssembler().getEmitter();
+  size_t Offset = Contents.size();
+  size_t FirstFixup = Fixups.size();
+  if (Emitter.canEncodeInPlace()) {
+    raw_svector_ostream VecOS(Contents);
+    Emitter.encodeInstruction(Inst, VecOS, Fixups, STI);
+  } else {
+    SmallVector<MCFixup, 4> NewFixups;
+    SmallString<256> Code;
+    raw_svector_ostream VecOS(Code);
+    Emitter.encodeInstruction(Inst, VecOS, NewFixups, STI);
+    Fixups.append(NewFixups.begin(), NewFixups.end());
+    Contents.append(Code.begin(), Code.end());
+  }
+
+  if (Offset)
+    for (size_t I = FirstFixup, E = Fixups.size(); I != E; ++I)
+      Fixups[I].setOffset(Fixups[I].getOffset() + Offset);
 }
 
 #ifndef NDEBUG
@@ -51,19 +51,8 @@ MCWinCOFFStreamer::MCWinCOFFStreamer(MCContext &Context,
 void MCWinCOFFStreamer::EmitInstToData(const MCInst &Inst,
                                        const MCSubtargetInfo &STI) {
   MCDataFragment *DF = getOrCreateDataFragment();
-
-  SmallVector<MCFixup, 4> Fixups;
-  SmallString<256> Code;
-  raw_svector_ostream VecOS(Code);
-  getAssembler().getEmitter().encodeInstruction(Inst, VecOS, Fixups, STI);
-
-  // Add the fixups and data.
-  for (unsigned i = 0, e = Fixups.size(); i != e; ++i) {
-    Fixups[i].setOffset(Fixups[i].getOffset() + DF->getContents().size());
-    DF->getFixups().push_back(Fixups[i]);
-  }
+  encodeInstruction(Inst, STI, DF->getContents(), DF->getFixups());
   DF->setHasInstructions(STI);
-  DF->getContents().append(Code.begin(), Code.end());
 }
 
 void MCWinCOFFStreamer::InitSections(bool NoExecStack) {
@@ -24,11 +24,13 @@
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <map>
+#include <mutex>
 
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
 #include <unistd.h>
@@ -346,10 +348,30 @@ static void writeSymbolTable(raw_ostream &Out, object::Archive::Kind Kind,
     Out.write(uint8_t(0));
 }
 
-static Expected<std::vector<unsigned>>
-getSymbols(MemoryBufferRef Buf, raw_ostream &SymNames, bool &HasObject) {
-  std::vector<unsigned> Ret;
+namespace {
+// The archive symbols of one member. Members are read independently of each
+// other, so their names are only appended to the symbol table afterwards.
+struct MemberSymbols {
+  // The names, each followed by a NUL.
+  std::string Names;
+  // The offset of each name in Names.
+  std::vector<unsigned> Offsets;
+  bool IsObject = false;
+};
+} // namespace
+
+static Error getSymbols(const NewArchiveMember &M, MemberSymbols &Ret) {
+  raw_string_ostream SymNames(Ret.Names);
+  if (M.Symbols) {
+    Ret.IsObject = true;
+    for (StringRef Name : *M.Symbols) {
+      Ret.Offsets.push_back(SymNames.tell());
+      SymNames << Name << '\0';
+    }
+    return Error::success();
+  }
 
+  MemoryBufferRef Buf = M.Buf->getMemBufferRef();
   // In the scenario when LLVMContext is populated SymbolicFile will contain a
   // reference to it, thus SymbolicFile should be destroyed first.
   LLVMContext Context;
@@ -360,7 +382,7 @@ getSymbols(MemoryBufferRef Buf, raw_ostream &SymNames, bool &HasObject) {
     if (!ObjOrErr) {
       // FIXME: check only for "not an object file" errors.
       consumeError(ObjOrErr.takeError());
-      return Ret;
+      return Error::success();
     }
     Obj = std::move(*ObjOrErr);
   } else {
@@ -368,27 +390,55 @@ getSymbols(MemoryBufferRef Buf, raw_ostream &SymNames, bool &HasObject) {
     if (!ObjOrErr) {
       // FIXME: check only for "not an object file" errors.
       consumeError(ObjOrErr.takeError());
-      return Ret;
+      return Error::success();
     }
     Obj = std::move(*ObjOrErr);
   }
 
-  HasObject = true;
+  Ret.IsObject = true;
   for (const object::BasicSymbolRef &S : Obj->symbols()) {
     if (!isArchiveSymbol(S))
       continue;
-    Ret.push_back(SymNames.tell());
+    Ret.Offsets.push_back(SymNames.tell());
     if (Error E = S.printName(SymNames))
-      return std::move(E);
+      return E;
     SymNames << '\0';
   }
-  return Ret;
+  return Error::success();
+}
+
+// Reads the symbols of all the members in parallel. Each member gets its own
+// LLVMContext, so bitcode members don't serialize on a shared one.
+static Expected<std::vector<MemberSymbols>>
+getMemberSymbols(ArrayRef<NewArchiveMember> NewMembers) {
+  std::vector<MemberSymbols> Symbols(NewMembers.size());
+  // Reports the error of the first member in archive order, whichever thread
+  // finds one first.
+  std::mutex ErrMutex;
+  Optional<std::pair<size_t, Error>> FirstErr;
+  parallel::for_each_n(
+      parallel::par, size_t(0), NewMembers.size(), [&](size_t I) {
+        Error E = getSymbols(NewMembers[I], Symbols[I]);
+        if (!E)
+          return;
+        std::lock_guard<std::mutex> Lock(ErrMutex);
+        if (FirstErr && FirstErr->first < I) {
+          consumeError(std::move(E));
+          return;
+        }
+        if (FirstErr)
+          consumeError(std::move(FirstErr->second));
+        FirstErr.emplace(I, std::move(E));
+      });
+  if (FirstErr)
+    return std::move(FirstErr->second);
+  return std::move(Symbols);
 }
 
 static Expected<std::vector<MemberData>>
 computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
                   object::Archive::Kind Kind, bool Thin, bool Deterministic,
-                  ArrayRef<NewArchiveMember> NewMembers) {
+                  bool NeedSymbols, ArrayRef<NewArchiveMember> NewMembers) {
   static char PaddingData[8] = {'\n', '\n', '\n', '\n', '\n', '\n', '\n', '\n'};
 
   // This ignores the symbol table, but we only need the value mod 8 and the
@@ -398,6 +448,15 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
   std::vector<MemberData> Ret;
   bool HasObject = false;
 
+  std::vector<MemberSymbols> Symbols;
+  if (NeedSymbols) {
+    Expected<std::vector<MemberSymbols>> SymbolsOrErr =
+        getMemberSymbols(NewMembers);
+    if (!SymbolsOrErr)
+      return SymbolsOrErr.takeError();
+    Symbols = std::move(*SymbolsOrErr);
+  }
+
   // Deduplicate long member names in the string table and reuse earlier name
   // offsets. This especially saves space for COFF Import libraries where all
   // members have the same name.
@@ -453,7 +512,8 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
       Entry.second = Entry.second > 1 ? 1 : 0;
   }
 
-  for (const NewArchiveMember &M : NewMembers) {
+  for (size_t I = 0, E = NewMembers.size(); I != E; ++I) {
+    const NewArchiveMember &M = NewMembers[I];
     std::string Header;
     raw_string_ostream Out(Header);
 
@@ -489,13 +549,19 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
                       ModTime, Size);
     Out.flush();
 
-    Expected<std::vector<unsigned>> Symbols =
-        getSymbols(Buf, SymNames, HasObject);
-    if (auto E = Symbols.takeError())
-      return std::move(E);
+    // Rebase the offsets of the names on the symbol table.
+    std::vector<unsigned> Offsets;
+    if (NeedSymbols) {
+      MemberSymbols &S = Symbols[I];
+      HasObject |= S.IsObject;
+      unsigned Base = SymNames.tell();
+      for (unsigned Offset : S.Offsets)
+        Offsets.push_back(Base + Offset);
+      SymNames << S.Names;
+    }
 
     Pos += Header.size() + Data.size() + Padding.size();
-    Ret.push_back({std::move(*Symbols), std::move(Header), Data, Padding});
+    Ret.push_back({std::move(Offsets), std::move(Header), Data, Padding});
   }
   // If there are no symbols, emit an empty symbol table, to satisfy Solaris
   // tools, older versions of which expect a symbol table in a non-empty
@@ -560,7 +626,8 @@ Error writeArchive(StringRef ArcName, ArrayRef<NewArchiveMember> NewMembers,
   raw_svector_ostream StringTable(StringTableBuf);
 
   Expected<std::vector<MemberData>> DataOrErr = computeMemberData(
-      StringTable, SymNames, Kind, Thin, Deterministic, NewMembers);
+      StringTable, SymNames, Kind, Thin, Deterministic, WriteSymtab,
+      NewMembers);
   if (Error E = DataOrErr.takeError())
     return E;
   std::vector<MemberData> &Data = *DataOrErr;
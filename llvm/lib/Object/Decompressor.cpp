@@ -19,14 +19,14 @@ using namespace object;
 
 Expected<Decompressor> Decompressor::create(StringRef Name, StringRef Data,
                                             bool IsLE, bool Is64Bit) {
-  if (!zlib::isAvailable())
-    return createError("zlib is not available");
-
   Decompressor D(Data);
   Error Err = isGnuStyle(Name) ? D.consumeCompressedGnuHeader()
                                : D.consumeCompressedZLibHeader(Is64Bit, IsLE);
   if (Err)
     return std::move(Err);
+  if (D.IsZstd ? !zstd::isAvailable() : !zlib::isAvailable())
+    return createError(D.IsZstd ? "zstd is not available"
+                                : "zlib is not available");
   return D;
 }
 
@@ -57,10 +57,11 @@ Error Decompressor::consumeCompressedZLibHeader(bool Is64Bit,
 
   DataExtractor Extractor(SectionData, IsLittleEndian, 0);
   uint64_t Offset = 0;
-  if (Extractor.getUnsigned(&Offset, Is64Bit ? sizeof(Elf64_Word)
-                                             : sizeof(Elf32_Word)) !=
-      ELFCOMPRESS_ZLIB)
+  uint64_t Type = Extractor.getUnsigned(
+      &Offset, Is64Bit ? sizeof(Elf64_Word) : sizeof(Elf32_Word));
+  if (Type != ELFCOMPRESS_ZLIB && Type != ELFCOMPRESS_ZSTD)
     return createError("unsupported compression type");
+  IsZstd = Type == ELFCOMPRESS_ZSTD;
 
   // Skip Elf64_Chdr::ch_reserved field.
   if (Is64Bit)
@@ -94,5 +95,7 @@ bool Decompressor::isCompressedELFSection(uint64_t Flags, StringRef Name) {
 
 Error Decompressor::decompress(MutableArrayRef<char> Buffer) {
   size_t Size = Buffer.size();
+  if (IsZstd)
+    return zstd::uncompress(SectionData, Buffer.data(), Size);
   return zlib::uncompress(SectionData, Buffer.data(), Size);
 }
@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Option/Arg.h"
@@ -193,6 +194,41 @@ static unsigned matchOption(const OptTable::Info *I, StringRef Str,
   return 0;
 }
 
+/// Append to \p Candidates the indices of the options in [Begin, End) whose
+/// names, ignoring case, start \p Rest.
+///
+/// The sorted table is walked like a trie: the options whose names share
+/// their first K characters form a range, in which those whose names go on
+/// come in the order of their K-th character, and those whose names end there
+/// come last.
+static void findOptionsStarting(ArrayRef<OptTable::Info> Infos, size_t Begin,
+                                size_t End, StringRef Rest,
+                                SmallVectorImpl<unsigned> &Candidates) {
+  auto Key = [](char C) -> int {
+    return C == '\0' ? 256 : static_cast<char>(tolower(C));
+  };
+  const OptTable::Info *First = Infos.data() + Begin;
+  const OptTable::Info *Last = Infos.data() + End;
+  for (size_t K = 0; First != Last; ++K) {
+    const OptTable::Info *Ends =
+        std::partition_point(First, Last, [K](const OptTable::Info &I) {
+          return I.Name[K] != '\0';
+        });
+    for (const OptTable::Info *I = Ends; I != Last; ++I)
+      Candidates.push_back(I - Infos.data());
+    if (K == Rest.size())
+      break;
+
+    int C = Key(Rest[K]);
+    First = std::partition_point(First, Ends, [&](const OptTable::Info &I) {
+      return Key(I.Name[K]) < C;
+    });
+    Last = std::partition_point(First, Ends, [&](const OptTable::Info &I) {
+      return Key(I.Name[K]) == C;
+    });
+  }
+}
+
 // Returns true if one of the Prefixes + In.Names matches Option
 static bool optionMatches(const OptTable::Info &In, StringRef Option) {
   if (In.Prefixes)
@@ -350,22 +386,26 @@ Arg *OptTable::ParseOneArg(const ArgList &Args, unsigned &Index,
 
   // Options are stored in sorted order, with '\0' at the end of the
   // alphabet. Since the only options which can accept a string must
-  // prefix it, we iteratively search for the next option which could
-  // be a prefix.
-  //
-  // FIXME: This is searching much more than necessary, but I am
-  // blanking on the simplest way to make it fast. We can solve this
-  // problem when we move to TableGen.
-  for (; Start != End; ++Start) {
-    unsigned ArgSize = 0;
-    // Scan for first option which is a proper prefix.
-    for (; Start != End; ++Start)
-      if ((ArgSize = matchOption(Start, Str, IgnoreCase)))
-        break;
-    if (Start == End)
-      break;
+  // prefix it, find those whose names start the string after each of the
+  // prefixes it starts with, and try them in table order.
+  SmallVector<unsigned, 8> Candidates;
+  for (const auto &Prefix : PrefixesUnion) {
+    StringRef Rest(Str);
+    if (Rest.consume_front(Prefix.getKey()))
+      findOptionsStarting(OptionInfos, Start - OptionInfos.data(),
+                          OptionInfos.size(), Rest, Candidates);
+  }
+  llvm::sort(Candidates);
+  Candidates.erase(std::unique(Candidates.begin(), Candidates.end()),
+                   Candidates.end());
+
+  for (unsigned Candidate : Candidates) {
+    // The name may have matched after a prefix this option doesn't have.
+    unsigned ArgSize = matchOption(&OptionInfos[Candidate], Str, IgnoreCase);
+    if (!ArgSize)
+      continue;
 
-    Option Opt(Start, this);
+    Option Opt(&OptionInfos[Candidate], this);
 
     if (FlagsToInclude && !Opt.hasFlag(FlagsToInclude))
       continue;
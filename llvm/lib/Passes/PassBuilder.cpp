@@ -76,6 +76,7 @@
 #include "llvm/Transforms/IPO/ElimAvailExtern.h"
 #include "llvm/Transforms/IPO/ForceFunctionAttrs.h"
 #include "llvm/Transforms/IPO/FunctionAttrs.h"
+#include "llvm/Transforms/IPO/FunctionCache.h"
 #include "llvm/Transforms/IPO/FunctionImport.h"
 #include "llvm/Transforms/IPO/GlobalDCE.h"
 #include "llvm/Transforms/IPO/GlobalOpt.h"
@@ -139,6 +140,7 @@
 #include "llvm/Transforms/Scalar/LoopSimplifyCFG.h"
 #include "llvm/Transforms/Scalar/LoopSink.h"
 #include "llvm/Transforms/Scalar/LoopStrengthReduce.h"
+#include "llvm/Transforms/Scalar/LoopTiling.h"
 #include "llvm/Transforms/Scalar/LoopUnrollAndJamPass.h"
 #include "llvm/Transforms/Scalar/LoopUnrollPass.h"
 #include "llvm/Transforms/Scalar/LowerAtomic.h"
@@ -210,6 +212,11 @@ static cl::opt<bool> EnableSyntheticCounts(
     cl::desc("Run synthetic function entry count generation "
              "pass"));
 
+static cl::opt<std::string> FunctionCacheDir(
+    "function-cache-dir", cl::Hidden,
+    cl::desc("Directory in which function-cache(...) pipelines cache "
+             "optimized functions"));
+
 static const Regex DefaultAliasRegex(
     "^(default|thinlto-pre-link|thinlto|lto-pre-link|lto)<(O[0123sz])>$");
 
@@ -1379,6 +1386,20 @@ AAManager PassBuilder::buildDefaultAAPipeline() {
   return AA;
 }
 
+/// Prints a parsed pipeline back in the textual form it was parsed from.
+static std::string
+printPipeline(ArrayRef<PassBuilder::PipelineElement> Pipeline) {
+  std::string Text;
+  for (const auto &E : Pipeline) {
+    if (!Text.empty())
+      Text += ',';
+    Text += E.Name;
+    if (!E.InnerPipeline.empty())
+      Text += "(" + printPipeline(E.InnerPipeline) + ")";
+  }
+  return Text;
+}
+
 static Optional<int> parseRepeatPassName(StringRef Name) {
   if (!Name.consume_front("repeat<") || !Name.consume_back(">"))
     return None;
@@ -1653,6 +1674,8 @@ static bool isModulePassName(StringRef Name, CallbacksT &Callbacks) {
     return true;
   if (Name == "function")
     return true;
+  if (Name == "function-cache")
+    return true;
 
   // Explicitly handle custom-parsed pass names.
   if (parseRepeatPassName(Name))
@@ -1833,6 +1856,15 @@ Error PassBuilder::parseModulePass(ModulePassManager &MPM,
       MPM.addPass(createModuleToFunctionPassAdaptor(std::move(FPM)));
       return Error::success();
     }
+    if (Name == "function-cache") {
+      FunctionPassManager FPM(DebugLogging);
+      if (auto Err = parseFunctionPassPipeline(FPM, InnerPipeline,
+                                               VerifyEachPass, DebugLogging))
+        return Err;
+      MPM.addPass(FunctionCachePass(std::move(FPM), FunctionCacheDir,
+                                    printPipeline(InnerPipeline)));
+      return Error::success();
+    }
     if (auto Count = parseRepeatPassName(Name)) {
       ModulePassManager NestedMPM(DebugLogging);
       if (auto Err = parseModulePassPipeline(NestedMPM, InnerPipeline,
@@ -21,12 +21,21 @@
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/PassInstrumentation.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
 
+static cl::opt<std::string> PassMemoryReport(
+    "pass-memory-report", cl::Hidden, cl::value_desc("filename"),
+    cl::desc("Write a JSON report of how much each pass changes the number "
+             "of instructions and the memory in use"));
+
 namespace {
 
 /// Extracting Module out of \p IR unit. Also fills a textual description
@@ -235,8 +244,172 @@ void PrintIRInstrumentation::registerCallbacks(
   }
 }
 
+static bool isPassManagerOrAdaptor(StringRef PassID) {
+  return PassID.startswith("PassManager<") || PassID.contains("PassAdaptor<");
+}
+
+/// Returns the context of \p IR and the number of instructions in it.
+static std::pair<const LLVMContext *, int64_t> getContextAndSize(Any IR) {
+  if (any_isa<const Module *>(IR)) {
+    const Module *M = any_cast<const Module *>(IR);
+    int64_t Size = 0;
+    for (const Function &F : *M)
+      Size += F.getInstructionCount();
+    return {&M->getContext(), Size};
+  }
+
+  if (any_isa<const Function *>(IR)) {
+    const Function *F = any_cast<const Function *>(IR);
+    return {&F->getContext(), F->getInstructionCount()};
+  }
+
+  if (any_isa<const LazyCallGraph::SCC *>(IR)) {
+    const LazyCallGraph::SCC *C = any_cast<const LazyCallGraph::SCC *>(IR);
+    const LLVMContext *Ctx = nullptr;
+    int64_t Size = 0;
+    for (const LazyCallGraph::Node &N : *C) {
+      Ctx = &N.getFunction().getContext();
+      Size += N.getFunction().getInstructionCount();
+    }
+    return {Ctx, Size};
+  }
+
+  if (any_isa<const Loop *>(IR)) {
+    const Loop *L = any_cast<const Loop *>(IR);
+    int64_t Size = 0;
+    for (const BasicBlock *BB : L->blocks())
+      Size += BB->size();
+    return {&L->getHeader()->getContext(), Size};
+  }
+
+  llvm_unreachable("Unknown IR unit");
+}
+
+PassMemoryInstrumentation::PassMemoryInstrumentation()
+    : Enabled(!PassMemoryReport.empty()) {}
+
+void PassMemoryInstrumentation::setOutStream(raw_ostream &OS) {
+  OutStream = &OS;
+  Enabled = true;
+}
+
+void PassMemoryInstrumentation::runBeforePass(StringRef PassID, Any IR) {
+  if (isPassManagerOrAdaptor(PassID))
+    return;
+  const LLVMContext *Ctx;
+  int64_t Size;
+  std::tie(Ctx, Size) = getContextAndSize(IR);
+  Stack.push_back({PassID, Ctx, Size,
+                   Ctx ? int64_t(Ctx->getAllocatorMemory()) : 0,
+                   int64_t(sys::Process::GetMallocUsage())});
+}
+
+void PassMemoryInstrumentation::runAfterPass(StringRef PassID, Any IR) {
+  if (isPassManagerOrAdaptor(PassID))
+    return;
+  if (Optional<Sample> Before = popSample(PassID))
+    record(*Before, getContextAndSize(IR).second);
+}
+
+void PassMemoryInstrumentation::runAfterPassInvalidated(StringRef PassID) {
+  if (isPassManagerOrAdaptor(PassID))
+    return;
+  // The IR unit may no longer exist, so its size is unknown.
+  if (Optional<Sample> Before = popSample(PassID))
+    record(*Before, None);
+}
+
+Optional<PassMemoryInstrumentation::Sample>
+PassMemoryInstrumentation::popSample(StringRef PassID) {
+  // Another before-pass callback may have skipped a pass after its sample was
+  // taken, in which case no after-pass callback runs for it. Drop the samples
+  // of such passes.
+  while (!Stack.empty()) {
+    Sample S = Stack.pop_back_val();
+    if (S.PassID == PassID)
+      return S;
+  }
+  return None;
+}
+
+void PassMemoryInstrumentation::record(const Sample &Before,
+                                       Optional<int64_t> Instructions) {
+  auto Ins = TotalsIndex.try_emplace(Before.PassID, Totals.size());
+  if (Ins.second) {
+    Totals.emplace_back();
+    Totals.back().PassID = Before.PassID;
+  }
+  PassTotals &T = Totals[Ins.first->second];
+
+  ++T.Runs;
+  if (Instructions) {
+    int64_t Delta = *Instructions - Before.Instructions;
+    T.Instructions += Delta;
+    T.MaxInstructions = std::max(T.MaxInstructions, Delta);
+  }
+  if (Before.Context)
+    T.ContextBytes +=
+        int64_t(Before.Context->getAllocatorMemory()) - Before.ContextBytes;
+  T.MallocBytes += int64_t(sys::Process::GetMallocUsage()) - Before.MallocBytes;
+}
+
+void PassMemoryInstrumentation::print() {
+  if (!Enabled || Totals.empty())
+    return;
+
+  std::unique_ptr<raw_fd_ostream> File;
+  raw_ostream *OS = OutStream;
+  if (!OS) {
+    std::error_code EC;
+    File = std::make_unique<raw_fd_ostream>(PassMemoryReport, EC,
+                                            sys::fs::OF_Text);
+    if (EC) {
+      errs() << "Could not open " << PassMemoryReport << ": " << EC.message()
+             << "\n";
+      Totals.clear();
+      TotalsIndex.clear();
+      return;
+    }
+    OS = File.get();
+  }
+
+  json::OStream J(*OS, /*IndentSize=*/2);
+  J.array([&] {
+    for (const PassTotals &T : Totals)
+      J.object([&] {
+        J.attribute("pass", T.PassID);
+        J.attribute("runs", int64_t(T.Runs));
+        J.attribute("instructions", T.Instructions);
+        J.attribute("max-instructions", T.MaxInstructions);
+        J.attribute("context-bytes", T.ContextBytes);
+        J.attribute("malloc-bytes", T.MallocBytes);
+      });
+  });
+  *OS << "\n";
+  OS->flush();
+
+  Totals.clear();
+  TotalsIndex.clear();
+}
+
+void PassMemoryInstrumentation::registerCallbacks(
+    PassInstrumentationCallbacks &PIC) {
+  if (!Enabled)
+    return;
+
+  PIC.registerBeforePassCallback([this](StringRef P, Any IR) {
+    this->runBeforePass(P, IR);
+    return true;
+  });
+  PIC.registerAfterPassCallback(
+      [this](StringRef P, Any IR) { this->runAfterPass(P, IR); });
+  PIC.registerAfterPassInvalidatedCallback(
+      [this](StringRef P) { this->runAfterPassInvalidated(P); });
+}
+
 void StandardInstrumentations::registerCallbacks(
     PassInstrumentationCallbacks &PIC) {
   PrintIR.registerCallbacks(PIC);
   TimePasses.registerCallbacks(PIC);
+  PassMemory.registerCallbacks(PIC);
 }
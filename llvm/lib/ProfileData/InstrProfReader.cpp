@@ -38,9 +38,10 @@
 using namespace llvm;
 
 static Expected<std::unique_ptr<MemoryBuffer>>
-setupMemoryBuffer(const Twine &Path) {
+setupMemoryBuffer(const Twine &Path, bool RequiresNullTerminator = true) {
   ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
-      MemoryBuffer::getFileOrSTDIN(Path);
+      MemoryBuffer::getFileOrSTDIN(Path, /*FileSize=*/-1,
+                                   RequiresNullTerminator);
   if (std::error_code EC = BufferOrErr.getError())
     return errorCodeToError(EC);
   return std::move(BufferOrErr.get());
@@ -90,8 +91,12 @@ InstrProfReader::create(std::unique_ptr<MemoryBuffer> Buffer) {
 
 Expected<std::unique_ptr<IndexedInstrProfReader>>
 IndexedInstrProfReader::create(const Twine &Path, const Twine &RemappingPath) {
-  // Set up the buffer to read.
-  auto BufferOrError = setupMemoryBuffer(Path);
+  // Set up the buffer to read. Indexed profiles are looked up in place through
+  // the on-disk hash table, so don't require a null terminator: that lets
+  // large files be memory mapped instead of read in full, and only the pages
+  // holding the header and the records looked up are touched.
+  auto BufferOrError =
+      setupMemoryBuffer(Path, /*RequiresNullTerminator=*/false);
   if (Error E = BufferOrError.takeError())
     return std::move(E);
 
@@ -830,6 +835,12 @@ Error IndexedInstrProfReader::readHeader() {
     return error(instrprof_error::unsupported_hash_type);
 
   uint64_t HashOffset = endian::byte_swap<uint64_t, little>(Header->HashOffset);
+  // The records are only decoded when they are looked up, so at least check
+  // that the summaries and the hash table header are within the buffer.
+  const unsigned char *End = (const unsigned char *)DataBuffer->getBufferEnd();
+  if (Cur > End || HashOffset > uint64_t(End - Start) ||
+      uint64_t(End - Start) - HashOffset < 2 * sizeof(uint64_t))
+    return error(instrprof_error::truncated);
 
   // The rest of the file is an on disk hash table.
   auto IndexPtr =
@@ -483,21 +483,70 @@ SampleProfileReaderExtBinary::readOneSection(const uint8_t *Start,
       return EC;
     break;
   case SecLBRProfile:
-    while (Data < Start + Size) {
-      if (std::error_code EC = readFuncProfile())
-        return EC;
-    }
+    if (std::error_code EC = readFuncProfiles(Start, Size))
+      return EC;
     break;
   case SecProfileSymbolList:
     if (std::error_code EC = readProfileSymbolList(Size))
       return EC;
     break;
+  case SecFuncOffsetTable:
+    if (std::error_code EC = readFuncOffsetTable())
+      return EC;
+    break;
   default:
     break;
   }
   return sampleprof_error::success;
 }
 
+std::error_code SampleProfileReaderExtBinary::readFuncOffsetTable() {
+  auto Size = readNumber<uint64_t>();
+  if (std::error_code EC = Size.getError())
+    return EC;
+
+  FuncOffsetTable.reserve(*Size);
+  for (uint32_t I = 0; I < *Size; ++I) {
+    auto FName(readStringFromTable());
+    if (std::error_code EC = FName.getError())
+      return EC;
+
+    auto Offset = readNumber<uint64_t>();
+    if (std::error_code EC = Offset.getError())
+      return EC;
+
+    FuncOffsetTable[*FName] = *Offset;
+  }
+  return sampleprof_error::success;
+}
+
+std::error_code
+SampleProfileReaderExtBinary::readFuncProfiles(const uint8_t *Start,
+                                               uint64_t Size) {
+  // Read every profile if they are all used, or if the profile was written
+  // before the function offset table existed.
+  if (UseAllFuncs || FuncOffsetTable.empty()) {
+    while (Data < Start + Size) {
+      if (std::error_code EC = readFuncProfile())
+        return EC;
+    }
+    return sampleprof_error::success;
+  }
+
+  for (auto Name : FuncsToUse) {
+    auto Iter = FuncOffsetTable.find(Name);
+    if (Iter == FuncOffsetTable.end())
+      continue;
+    if (Iter->second >= Size)
+      return sampleprof_error::malformed;
+    Data = Start + Iter->second;
+    if (std::error_code EC = readFuncProfile())
+      return EC;
+  }
+  Data = Start + Size;
+  return sampleprof_error::success;
+}
+
 std::error_code
 SampleProfileReaderExtBinary::readProfileSymbolList(uint64_t Size) {
   if (!ProfSymList)
@@ -812,6 +861,13 @@ std::error_code SampleProfileReaderCompactBinary::readFuncOffsetTable() {
   return sampleprof_error::success;
 }
 
+void SampleProfileReaderExtBinary::collectFuncsToUse(const Module &M) {
+  UseAllFuncs = false;
+  FuncsToUse.clear();
+  for (auto &F : M)
+    FuncsToUse.insert(FunctionSamples::getCanonicalFnName(F));
+}
+
 void SampleProfileReaderCompactBinary::collectFuncsToUse(const Module &M) {
   UseAllFuncs = false;
   FuncsToUse.clear();
@@ -26,6 +26,15 @@ void printBumpPtrAllocatorStats(unsigned NumSlabs, size_t BytesAllocated,
          << " (includes alignment, etc)\n";
 }
 
+unsigned getThreadIndex() {
+  static std::atomic<unsigned> NextIndex(0);
+  // 0 means that the current thread has no index yet.
+  static LLVM_THREAD_LOCAL unsigned IndexPlusOne = 0;
+  if (!IndexPlusOne)
+    IndexPlusOne = ++NextIndex;
+  return IndexPlusOne - 1;
+}
+
 } // End namespace detail.
 
 void PrintRecyclerStats(size_t Size,
@@ -150,6 +150,12 @@ public:
   // This collects the different subcommands that have been registered.
   SmallPtrSet<SubCommand *, 4> RegisteredSubCommands;
 
+  // Options whose constructors have run but that have not been added to
+  // their SubCommands yet. Most tools construct thousands of options as
+  // static globals but look up few of them, if any, so we defer building the
+  // option tables until they are needed. See materializeOptions().
+  std::vector<Option *> PendingOptions;
+
   CommandLineParser() : ActiveSubCommand(nullptr) {
     registerSubCommand(&*TopLevelSubCommand);
     registerSubCommand(&*AllSubCommands);
@@ -182,6 +188,7 @@ public:
   }
 
   void addLiteralOption(Option &Opt, StringRef Name) {
+    materializeOptions();
     if (Opt.Subs.empty())
       addLiteralOption(Opt, &*TopLevelSubCommand, Name);
     else {
@@ -237,6 +244,21 @@ public:
     }
   }
 
+  // Registers an option. The option is added to its SubCommands when the
+  // option tables are first needed.
+  void addPendingOption(Option *O) { PendingOptions.push_back(O); }
+
+  // Adds all pending options to their SubCommands. This must be called
+  // before accessing the option tables of any SubCommand.
+  void materializeOptions() {
+    // addOption() may report errors, which may print options, so empty the
+    // list first.
+    std::vector<Option *> Options;
+    Options.swap(PendingOptions);
+    for (Option *O : Options)
+      addOption(O);
+  }
+
   void addOption(Option *O, bool ProcessDefaultOption = false) {
     if (!ProcessDefaultOption && O->isDefaultOption()) {
       DefaultOptions.push_back(O);
@@ -285,6 +307,13 @@ public:
   }
 
   void removeOption(Option *O) {
+    // Options are usually destroyed in the reverse order of construction, so
+    // an option that was never materialized is typically the last one.
+    if (!PendingOptions.empty() && PendingOptions.back() == O) {
+      PendingOptions.pop_back();
+      return;
+    }
+    materializeOptions();
     if (O->Subs.empty())
       removeOption(O, &*TopLevelSubCommand);
     else {
@@ -304,6 +333,8 @@ public:
   }
 
   bool hasOptions() const {
+    if (!PendingOptions.empty())
+      return true;
     for (const auto &S : RegisteredSubCommands) {
       if (hasOptions(*S))
         return true;
@@ -324,6 +355,7 @@ public:
   }
 
   void updateArgStr(Option *O, StringRef NewName) {
+    materializeOptions();
     if (O->Subs.empty())
       updateArgStr(O, NewName, &*TopLevelSubCommand);
     else {
@@ -356,6 +388,9 @@ public:
                              (Sub->getName() == sub->getName());
                     }) == 0 &&
            "Duplicate subcommands");
+    // Pending options registered for all subcommands are added to this one
+    // below, so materialize them before this subcommand becomes visible.
+    materializeOptions();
     RegisteredSubCommands.insert(sub);
 
     // For all options that have been registered for all subcommands, add the
@@ -392,6 +427,7 @@ public:
 
     ResetAllOptionOccurrences();
     RegisteredSubCommands.clear();
+    PendingOptions.clear();
 
     TopLevelSubCommand->reset();
     AllSubCommands->reset();
@@ -428,7 +464,7 @@ extrahelp::extrahelp(StringRef Help) : morehelp(Help) {
 }
 
 void Option::addArgument() {
-  GlobalParser->addOption(this);
+  GlobalParser->addPendingOption(this);
   FullyInitialized = true;
 }
 
@@ -1246,6 +1282,10 @@ bool cl::ParseCommandLineOptions(int argc, const char *const *argv,
 void CommandLineParser::ResetAllOptionOccurrences() {
   // So that we can parse different command lines multiple times in succession
   // we reset all option values to look like they have never been seen before.
+  // Options that have not been materialized yet are reset in place.
+  for (Option *O : PendingOptions)
+    if (!O->ArgStr.empty())
+      O->reset();
   for (auto SC : RegisteredSubCommands) {
     for (auto &O : SC->OptionsMap)
       O.second->reset();
@@ -1258,6 +1298,7 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
                                                 raw_ostream *Errs,
                                                 bool LongOptionsUseDoubleDash) {
   assert(hasOptions() && "No options specified!");
+  materializeOptions();
 
   // Expand response files.
   SmallVector<const char *, 20> newArgv(argv, argv + argc);
@@ -2088,6 +2129,7 @@ public:
   }
 
   void printHelp() {
+    GlobalParser->materializeOptions();
     SubCommand *Sub = GlobalParser->getActiveSubCommand();
     auto &OptionsMap = Sub->OptionsMap;
     auto &PositionalOpts = Sub->PositionalOpts;
@@ -2346,6 +2388,7 @@ void cl::PrintOptionValues() { GlobalParser->printOptionValues(); }
 void CommandLineParser::printOptionValues() {
   if (!PrintOptions && !PrintAllOptions)
     return;
+  materializeOptions();
 
   SmallVector<std::pair<const char *, Option *>, 128> Opts;
   sortOpts(ActiveSubCommand->OptionsMap, Opts, /*ShowHidden*/ true);
@@ -2452,6 +2495,7 @@ void cl::AddExtraVersionPrinter(VersionPrinterTy func) {
 }
 
 StringMap<Option *> &cl::getRegisteredOptions(SubCommand &Sub) {
+  GlobalParser->materializeOptions();
   auto &Subs = GlobalParser->RegisteredSubCommands;
   (void)Subs;
   assert(is_contained(Subs, &Sub));
@@ -2464,6 +2508,7 @@ cl::getRegisteredSubcommands() {
 }
 
 void cl::HideUnrelatedOptions(cl::OptionCategory &Category, SubCommand &Sub) {
+  GlobalParser->materializeOptions();
   for (auto &I : Sub.OptionsMap) {
     for (auto &Cat : I.second->Categories) {
       if (Cat != &Category &&
@@ -2475,6 +2520,7 @@ void cl::HideUnrelatedOptions(cl::OptionCategory &Category, SubCommand &Sub) {
 
 void cl::HideUnrelatedOptions(ArrayRef<const cl::OptionCategory *> Categories,
                               SubCommand &Sub) {
+  GlobalParser->materializeOptions();
   for (auto &I : Sub.OptionsMap) {
     for (auto &Cat : I.second->Categories) {
       if (find(Categories, Cat) == Categories.end() && Cat != &GenericCategory)
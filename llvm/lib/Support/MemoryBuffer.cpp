@@ -204,6 +204,34 @@ public:
   MemoryBuffer::BufferKind getBufferKind() const override {
     return MemoryBuffer::MemoryBuffer_MMap;
   }
+
+  void advise(MemoryBuffer::Advice A, size_t Offset,
+              size_t Size) const override {
+    using Region = sys::fs::mapped_file_region;
+    Region::advice FSAdvice;
+    switch (A) {
+    case MemoryBuffer::Advice::Normal:
+      FSAdvice = Region::normal;
+      break;
+    case MemoryBuffer::Advice::Sequential:
+      FSAdvice = Region::sequential;
+      break;
+    case MemoryBuffer::Advice::Random:
+      FSAdvice = Region::random;
+      break;
+    case MemoryBuffer::Advice::WillNeed:
+      FSAdvice = Region::willneed;
+      break;
+    case MemoryBuffer::Advice::HugePage:
+      FSAdvice = Region::hugepage;
+      break;
+    }
+    // The buffer may start in the middle of the first page of the mapping.
+    size_t Delta = this->getBufferStart() - MFR.const_data();
+    Offset = std::min(Offset, this->getBufferSize());
+    Size = std::min(Size, this->getBufferSize() - Offset);
+    (void)MFR.advise(FSAdvice, Delta + Offset, Size);
+  }
 };
 }
 
@@ -9,13 +9,16 @@
 #include "llvm/Support/Parallel.h"
 #include "llvm/Config/llvm-config.h"
 
+llvm::ThreadPoolStrategy llvm::parallel::strategy;
+
 #if LLVM_ENABLE_THREADS
 
 #include "llvm/Support/Threading.h"
 
 #include <atomic>
-#include <stack>
+#include <deque>
 #include <thread>
+#include <vector>
 
 namespace llvm {
 namespace parallel {
@@ -29,6 +32,10 @@ public:
   virtual ~Executor() = default;
   virtual void add(std::function<void()> func) = 0;
 
+  /// Runs one of the pending tasks on the current thread. Returns false if
+  /// there was no task to run.
+  virtual bool runPendingTask() { return false; }
+
   static Executor *getDefaultExecutor();
 };
 
@@ -60,19 +67,34 @@ Executor *Executor::getDefaultExecutor() {
 }
 
 #else
-/// An implementation of an Executor that runs closures on a thread pool
-///   in filo order.
+/// An implementation of an Executor that runs closures on a thread pool.
+///
+/// Each worker thread has its own task queue. A worker pushes tasks it
+/// spawns to the back of its own queue and pops them from the back, so
+/// that it works on the most recently spawned (and usually smallest,
+/// cache-hot) task first. An idle worker steals from the front of other
+/// workers' queues. Tasks added by non-worker threads are distributed
+/// to the queues in round-robin order.
+///
+/// A thread waiting for a TaskGroup runs pending tasks instead of just
+/// blocking, so nested parallel algorithms neither deadlock nor leave
+/// threads idle.
 class ThreadPoolExecutor : public Executor {
 public:
-  explicit ThreadPoolExecutor(unsigned ThreadCount = hardware_concurrency())
-      : Done(ThreadCount) {
+  explicit ThreadPoolExecutor(ThreadPoolStrategy S = strategy)
+      : Queues(S.compute_thread_count()), Done(Queues.size()) {
     // Spawn all but one of the threads in another thread as spawning threads
     // can take a while.
-    std::thread([&, ThreadCount] {
-      for (size_t i = 1; i < ThreadCount; ++i) {
-        std::thread([=] { work(); }).detach();
+    unsigned N = Queues.size();
+    std::thread([&, S, N] {
+      for (unsigned I = 1; I < N; ++I) {
+        std::thread([=] {
+          S.apply_thread_strategy(I);
+          work(I);
+        }).detach();
       }
-      work();
+      S.apply_thread_strategy(0);
+      work(0);
     }).detach();
   }
 
@@ -85,34 +107,104 @@ public:
   }
 
   void add(std::function<void()> F) override {
-    std::unique_lock<std::mutex> Lock(Mutex);
-    WorkStack.push(F);
-    Lock.unlock();
+    int Self = getWorkerIndex();
+    Queue &Q = Queues[Self >= 0 ? Self : NextQueue++ % Queues.size()];
+    ++Pending;
+    {
+      std::lock_guard<std::mutex> Lock(Q.Mutex);
+      Q.Tasks.push_back(std::move(F));
+    }
+
+    // Taking the lock makes sure that a worker that has just found no task
+    // is either already waiting (and will be notified) or will see the
+    // incremented counter.
+    { std::lock_guard<std::mutex> Lock(Mutex); }
     Cond.notify_one();
   }
 
+  bool runPendingTask() override {
+    std::function<void()> Task;
+    if (!getTask(Task))
+      return false;
+    Task();
+    return true;
+  }
+
 private:
-  void work() {
+  struct Queue {
+    std::mutex Mutex;
+    std::deque<std::function<void()>> Tasks;
+  };
+
+  // Returns the index of the current thread's queue, or -1 if the current
+  // thread is not a worker of this executor.
+  int getWorkerIndex() const {
+    return CurrentExecutor == this ? CurrentWorkerIndex : -1;
+  }
+
+  // Pops a task from the current thread's queue, or steals one from
+  // another queue.
+  bool getTask(std::function<void()> &Task) {
+    if (Pending == 0)
+      return false;
+
+    int Self = getWorkerIndex();
+    size_t N = Queues.size();
+    if (Self >= 0) {
+      Queue &Q = Queues[Self];
+      std::lock_guard<std::mutex> Lock(Q.Mutex);
+      if (!Q.Tasks.empty()) {
+        Task = std::move(Q.Tasks.back());
+        Q.Tasks.pop_back();
+        --Pending;
+        return true;
+      }
+    }
+
+    size_t Start = Self >= 0 ? Self + 1 : NextQueue.load();
+    for (size_t I = 0; I < N; ++I) {
+      Queue &Q = Queues[(Start + I) % N];
+      std::lock_guard<std::mutex> Lock(Q.Mutex);
+      if (!Q.Tasks.empty()) {
+        Task = std::move(Q.Tasks.front());
+        Q.Tasks.pop_front();
+        --Pending;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void work(unsigned Index) {
+    CurrentExecutor = this;
+    CurrentWorkerIndex = Index;
     while (true) {
+      if (runPendingTask())
+        continue;
       std::unique_lock<std::mutex> Lock(Mutex);
-      Cond.wait(Lock, [&] { return Stop || !WorkStack.empty(); });
+      Cond.wait(Lock, [&] { return Stop || Pending > 0; });
       if (Stop)
         break;
-      auto Task = WorkStack.top();
-      WorkStack.pop();
-      Lock.unlock();
-      Task();
     }
     Done.dec();
   }
 
+  static LLVM_THREAD_LOCAL ThreadPoolExecutor *CurrentExecutor;
+  static LLVM_THREAD_LOCAL int CurrentWorkerIndex;
+
+  std::vector<Queue> Queues;
+  std::atomic<size_t> NextQueue{0};
+  std::atomic<size_t> Pending{0};
   std::atomic<bool> Stop{false};
-  std::stack<std::function<void()>> WorkStack;
   std::mutex Mutex;
   std::condition_variable Cond;
   parallel::detail::Latch Done;
 };
 
+LLVM_THREAD_LOCAL ThreadPoolExecutor *ThreadPoolExecutor::CurrentExecutor =
+    nullptr;
+LLVM_THREAD_LOCAL int ThreadPoolExecutor::CurrentWorkerIndex = -1;
+
 Executor *Executor::getDefaultExecutor() {
   static ThreadPoolExecutor exec;
   return &exec;
@@ -120,25 +212,23 @@ Executor *Executor::getDefaultExecutor() {
 #endif
 }
 
-static std::atomic<int> TaskGroupInstances;
-
-// Latch::sync() called by the dtor may cause one thread to block. If is a dead
-// lock if all threads in the default executor are blocked. To prevent the dead
-// lock, only allow the first TaskGroup to run tasks parallelly. In the scenario
-// of nested parallel_for_each(), only the outermost one runs parallelly.
-TaskGroup::TaskGroup() : Parallel(TaskGroupInstances++ == 0) {}
-TaskGroup::~TaskGroup() { --TaskGroupInstances; }
+TaskGroup::~TaskGroup() { sync(); }
 
 void TaskGroup::spawn(std::function<void()> F) {
-  if (Parallel) {
-    L.inc();
-    Executor::getDefaultExecutor()->add([&, F] {
-      F();
-      L.dec();
-    });
-  } else {
+  L.inc();
+  Executor::getDefaultExecutor()->add([&, F] {
     F();
-  }
+    L.dec();
+  });
+}
+
+void TaskGroup::sync() const {
+  // Run pending tasks while waiting. If there's no pending task, all tasks
+  // of this group have been started by other threads, so just wait for them.
+  Executor *E = Executor::getDefaultExecutor();
+  while (!L.isZero())
+    if (!E->runPendingTask())
+      L.sync();
 }
 
 } // namespace detail
@@ -0,0 +1,138 @@
+//===- llvm/Support/SuffixArray.cpp - Suffix array ------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/SuffixArray.h"
+#include "llvm/ADT/STLExtras.h"
+#include <numeric>
+
+using namespace llvm;
+
+SuffixArray::SuffixArray(ArrayRef<unsigned> Str) : Str(Str) {
+  unsigned N = Str.size();
+  Suffixes.resize(N);
+  LCP.resize(N);
+  if (N == 0)
+    return;
+
+  // Sort the suffixes by their first character, and rank them so that equal
+  // prefixes have equal ranks.
+  std::vector<unsigned> Rank(N), NewRank(N), Tmp(N), Count;
+  std::iota(Suffixes.begin(), Suffixes.end(), 0);
+  llvm::sort(Suffixes, [&](unsigned A, unsigned B) {
+    return Str[A] < Str[B] || (Str[A] == Str[B] && A < B);
+  });
+  Rank[Suffixes[0]] = 0;
+  for (unsigned I = 1; I != N; ++I)
+    Rank[Suffixes[I]] =
+        Rank[Suffixes[I - 1]] + (Str[Suffixes[I]] != Str[Suffixes[I - 1]]);
+
+  // Each round sorts the suffixes by their first 2 * K characters, as pairs
+  // of the ranks of their first K characters and of the K characters after
+  // those, using a counting sort.
+  for (unsigned K = 1; Rank[Suffixes[N - 1]] != N - 1; K *= 2) {
+    // Order by the second rank. Suffixes shorter than K + 1 characters come
+    // first, since they have nothing after their first K characters.
+    unsigned Pos = 0;
+    for (unsigned I = N - std::min(K, N); I != N; ++I)
+      Tmp[Pos++] = I;
+    for (unsigned S : Suffixes)
+      if (S >= K)
+        Tmp[Pos++] = S - K;
+
+    // Stable counting sort by the first rank.
+    Count.assign(Rank[Suffixes[N - 1]] + 1, 0);
+    for (unsigned I = 0; I != N; ++I)
+      ++Count[Rank[I]];
+    unsigned Sum = 0;
+    for (unsigned &C : Count) {
+      unsigned Next = Sum + C;
+      C = Sum;
+      Sum = Next;
+    }
+    for (unsigned S : Tmp)
+      Suffixes[Count[Rank[S]]++] = S;
+
+    auto SecondRank = [&](unsigned S) -> unsigned {
+      return S + K < N ? Rank[S + K] + 1 : 0;
+    };
+    NewRank[Suffixes[0]] = 0;
+    for (unsigned I = 1; I != N; ++I) {
+      unsigned A = Suffixes[I - 1], B = Suffixes[I];
+      NewRank[B] = NewRank[A] + (Rank[A] != Rank[B] ||
+                                 SecondRank(A) != SecondRank(B));
+    }
+    Rank.swap(NewRank);
+  }
+
+  // Kasai's algorithm: the common prefix of a suffix and its predecessor is at
+  // most one shorter than that of the next longer suffix and its predecessor.
+  unsigned H = 0;
+  for (unsigned S = 0; S != N; ++S) {
+    unsigned R = Rank[S];
+    if (R == 0) {
+      H = 0;
+      continue;
+    }
+    unsigned Prev = Suffixes[R - 1];
+    while (S + H < N && Prev + H < N && Str[S + H] == Str[Prev + H])
+      ++H;
+    LCP[R] = H;
+    if (H)
+      --H;
+  }
+}
+
+std::vector<RepeatedSubstring>
+SuffixArray::findRepeatedSubstrings(unsigned MinLength) const {
+  std::vector<RepeatedSubstring> Result;
+  unsigned N = Suffixes.size();
+  if (N == 0)
+    return Result;
+
+  // Walk the LCP intervals bottom-up. The suffixes in an interval share a
+  // prefix of its length, and correspond to the leaves below the node of that
+  // prefix in the suffix tree. A suffix is a leaf child of the deepest
+  // interval that contains it, which is always on top of the stack when the
+  // suffix is reached, so the leaves of all open intervals can share a stack.
+  struct Interval {
+    unsigned Length;
+    unsigned FirstLeaf;
+  };
+  std::vector<Interval> Intervals;
+  std::vector<unsigned> Leaves;
+  Intervals.push_back({0, 0});
+  for (unsigned I = 1; I <= N; ++I) {
+    unsigned Length = I < N ? LCP[I] : 0;
+    // The suffix is a leaf of the open interval it shares a prefix with if
+    // that is at least as long as the one it shares with the next suffix, and
+    // the first leaf of a new, deeper interval otherwise.
+    unsigned S = Suffixes[I - 1];
+    bool IsNewInterval = Length > Intervals.back().Length;
+    if (!IsNewInterval)
+      Leaves.push_back(S);
+
+    while (Length < Intervals.back().Length) {
+      Interval Top = Intervals.back();
+      Intervals.pop_back();
+      if (Top.Length >= MinLength && Leaves.size() - Top.FirstLeaf >= 2) {
+        Result.push_back({Top.Length, {}});
+        std::vector<unsigned> &StartIndices = Result.back().StartIndices;
+        StartIndices.assign(Leaves.begin() + Top.FirstLeaf, Leaves.end());
+        llvm::sort(StartIndices);
+      }
+      Leaves.resize(Top.FirstLeaf);
+    }
+
+    // A closed interval may be nested in an interval that starts with it.
+    if (Length > Intervals.back().Length)
+      Intervals.push_back({Length, unsigned(Leaves.size())});
+    if (IsNewInterval)
+      Leaves.push_back(S);
+  }
+  return Result;
+}
@@ -24,12 +24,17 @@ using namespace llvm;
 ThreadPool::ThreadPool() : ThreadPool(hardware_concurrency()) {}
 
 ThreadPool::ThreadPool(unsigned ThreadCount)
+    : ThreadPool(hardware_concurrency_strategy(ThreadCount)) {}
+
+ThreadPool::ThreadPool(ThreadPoolStrategy S)
     : ActiveThreads(0), EnableFlag(true) {
-  // Create ThreadCount threads that will loop forever, wait on QueueCondition
-  // for tasks to be queued or the Pool to be destroyed.
+  // Create threads that will loop forever, wait on QueueCondition for tasks
+  // to be queued or the Pool to be destroyed.
+  unsigned ThreadCount = S.compute_thread_count();
   Threads.reserve(ThreadCount);
   for (unsigned ThreadID = 0; ThreadID < ThreadCount; ++ThreadID) {
-    Threads.emplace_back([&] {
+    Threads.emplace_back([&, S, ThreadID] {
+      S.apply_thread_strategy(ThreadID);
       while (true) {
         PackagedTaskTy Task;
         {
@@ -110,6 +115,8 @@ ThreadPool::~ThreadPool() {
 
 ThreadPool::ThreadPool() : ThreadPool(0) {}
 
+ThreadPool::ThreadPool(ThreadPoolStrategy S) : ThreadPool(S.ThreadsRequested) {}
+
 // No threads are launched, issue a warning if ThreadCount is not 0
 ThreadPool::ThreadPool(unsigned ThreadCount)
     : ActiveThreads(0) {
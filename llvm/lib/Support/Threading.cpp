@@ -15,10 +15,12 @@
 #include "llvm/Config/config.h"
 #include "llvm/Support/Host.h"
 
+#include <algorithm>
 #include <cassert>
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <tuple>
 
 using namespace llvm;
 
@@ -35,6 +37,31 @@ bool llvm::llvm_is_multithreaded() {
 #endif
 }
 
+Optional<ThreadPoolStrategy>
+llvm::get_threadpool_strategy(StringRef Spec, ThreadPoolStrategy Default) {
+  if (Spec.empty())
+    return Default;
+  StringRef Count;
+  StringRef Modifier;
+  std::tie(Count, Modifier) = Spec.split(',');
+  ThreadPoolStrategy S = Default;
+  if (Count == "all") {
+    S.ThreadsRequested = 0;
+    S.UseHyperThreads = true;
+  } else if (Count == "physical") {
+    S.ThreadsRequested = 0;
+    S.UseHyperThreads = false;
+  } else if (Count.getAsInteger(10, S.ThreadsRequested) ||
+             S.ThreadsRequested == 0) {
+    return None;
+  }
+  if (Modifier == "pin")
+    S.PinToSockets = true;
+  else if (!Modifier.empty())
+    return None;
+  return S;
+}
+
 #if LLVM_ENABLE_THREADS == 0 ||                                                \
     (!defined(_WIN32) && !defined(HAVE_PTHREAD_H))
 // Support for non-Win32, non-pthread implementation.
@@ -48,6 +75,10 @@ unsigned llvm::heavyweight_hardware_concurrency() { return 1; }
 
 unsigned llvm::hardware_concurrency() { return 1; }
 
+unsigned ThreadPoolStrategy::compute_thread_count() const { return 1; }
+
+void ThreadPoolStrategy::apply_thread_strategy(unsigned ThreadPoolNum) const {}
+
 uint64_t llvm::get_threadid() { return 0; }
 
 uint32_t llvm::get_max_thread_name_length() { return 0; }
@@ -59,6 +90,17 @@ void llvm::get_thread_name(SmallVectorImpl<char> &Name) { Name.clear(); }
 #else
 
 #include <thread>
+
+// Implemented in the platform-specific parts below.
+static unsigned getCPUQuota();
+static void setSocketAffinity(unsigned ThreadPoolNum);
+
+// Caps N to the number of CPUs the process is allowed to use.
+static unsigned capToCPUQuota(unsigned N) {
+  static unsigned Quota = getCPUQuota();
+  return Quota ? std::min(N, Quota) : N;
+}
+
 unsigned llvm::heavyweight_hardware_concurrency() {
   // Since we can't get here unless LLVM_ENABLE_THREADS == 1, it is safe to use
   // `std::thread` directly instead of `llvm::thread` (and indeed, doing so
@@ -68,22 +110,35 @@ unsigned llvm::heavyweight_hardware_concurrency() {
   // ADL.
   int NumPhysical = sys::getHostNumPhysicalCores();
   if (NumPhysical == -1)
-    return std::thread::hardware_concurrency();
-  return NumPhysical;
+    return capToCPUQuota(std::thread::hardware_concurrency());
+  return capToCPUQuota(NumPhysical);
 }
 
 unsigned llvm::hardware_concurrency() {
 #if defined(HAVE_SCHED_GETAFFINITY) && defined(HAVE_CPU_COUNT)
   cpu_set_t Set;
-  if (sched_getaffinity(0, sizeof(Set), &Set))
-    return CPU_COUNT(&Set);
+  if (sched_getaffinity(0, sizeof(Set), &Set) == 0)
+    return capToCPUQuota(CPU_COUNT(&Set));
 #endif
   // Guard against std::thread::hardware_concurrency() returning 0.
   if (unsigned Val = std::thread::hardware_concurrency())
-    return Val;
+    return capToCPUQuota(Val);
   return 1;
 }
 
+unsigned ThreadPoolStrategy::compute_thread_count() const {
+  if (ThreadsRequested)
+    return ThreadsRequested;
+  unsigned N = UseHyperThreads ? hardware_concurrency()
+                               : heavyweight_hardware_concurrency();
+  return std::max(N, 1U);
+}
+
+void ThreadPoolStrategy::apply_thread_strategy(unsigned ThreadPoolNum) const {
+  if (PinToSockets)
+    setSocketAffinity(ThreadPoolNum);
+}
+
 // Include the platform-specific parts of this class.
 #ifdef LLVM_ON_UNIX
 #include "Unix/Threading.inc"
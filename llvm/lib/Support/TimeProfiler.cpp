@@ -6,7 +6,9 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// This file implements hierarchical time profiler.
+// This file implements hierarchical time profiler. Time sections may be
+// recorded from any thread; each thread's sections are emitted as a
+// separate track.
 //
 //===----------------------------------------------------------------------===//
 
@@ -15,8 +17,11 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/JSON.h"
+#include "llvm/Support/Threading.h"
+#include <atomic>
 #include <cassert>
 #include <chrono>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -58,81 +63,187 @@ struct Entry {
   }
 };
 
+// The events recorded by one thread. Each thread has its own stack of
+// open entries so that threads don't need to synchronize with each other
+// except when they register themselves to the profiler.
+struct ThreadTrace {
+  ThreadTrace(uint64_t Tid) : Tid(Tid) {}
+
+  // Records a finished section. With a nonzero \p MaxEntries, Entries is a
+  // ring buffer that keeps the last \p MaxEntries sections, the oldest of
+  // which is at Entries[Oldest].
+  void addEntry(Entry &&E, size_t MaxEntries) {
+    if (MaxEntries == 0 || Entries.size() < MaxEntries) {
+      Entries.push_back(std::move(E));
+      return;
+    }
+    Entries[Oldest] = std::move(E);
+    if (++Oldest == MaxEntries)
+      Oldest = 0;
+  }
+
+  const Entry &lastEntry() const {
+    return Entries[(Oldest + Entries.size() - 1) % Entries.size()];
+  }
+
+  SmallVector<Entry, 16> Stack;
+  SmallVector<Entry, 128> Entries;
+  size_t Oldest = 0;
+  StringMap<CountAndDurationType> CountAndTotalPerName;
+  uint64_t Tid;
+};
+
+struct Counter {
+  TimePointType Time;
+  std::string Name;
+  int64_t Value;
+};
+
+// Each profiler has a unique generation number so that a thread can tell
+// whether its cached ThreadTrace belongs to the current profiler.
+static std::atomic<uint64_t> NextGeneration(1);
+static LLVM_THREAD_LOCAL ThreadTrace *CurrentThreadTrace = nullptr;
+static LLVM_THREAD_LOCAL uint64_t CurrentGeneration = 0;
+
 struct TimeTraceProfiler {
-  TimeTraceProfiler() {
-    StartTime = steady_clock::now();
+  TimeTraceProfiler(unsigned TimeTraceGranularity, StringRef ProcName,
+                    unsigned MaxEntriesPerThread)
+      : StartTime(steady_clock::now()), ProcName(ProcName),
+        Generation(NextGeneration++),
+        TimeTraceGranularity(TimeTraceGranularity),
+        MaxEntriesPerThread(MaxEntriesPerThread) {}
+
+  // Returns the ThreadTrace of the current thread, creating one if the
+  // thread hasn't recorded anything yet.
+  ThreadTrace &getThreadTrace() {
+    if (CurrentGeneration != Generation) {
+      std::lock_guard<std::mutex> Guard(Lock);
+      Threads.push_back(std::make_unique<ThreadTrace>(get_threadid()));
+      CurrentThreadTrace = Threads.back().get();
+      CurrentGeneration = Generation;
+    }
+    return *CurrentThreadTrace;
   }
 
   void begin(std::string Name, llvm::function_ref<std::string()> Detail) {
-    Stack.emplace_back(steady_clock::now(), TimePointType(), std::move(Name),
-                       Detail());
+    getThreadTrace().Stack.emplace_back(steady_clock::now(), TimePointType(),
+                                        std::move(Name), Detail());
   }
 
   void end() {
-    assert(!Stack.empty() && "Must call begin() first");
-    auto &E = Stack.back();
+    ThreadTrace &T = getThreadTrace();
+    assert(!T.Stack.empty() && "Must call begin() first");
+    auto &E = T.Stack.back();
     E.End = steady_clock::now();
 
     // Check that end times monotonically increase.
-    assert((Entries.empty() ||
+    assert((T.Entries.empty() ||
             (E.getFlameGraphStartUs(StartTime) + E.getFlameGraphDurUs() >=
-             Entries.back().getFlameGraphStartUs(StartTime) +
-                 Entries.back().getFlameGraphDurUs())) &&
+             T.lastEntry().getFlameGraphStartUs(StartTime) +
+                 T.lastEntry().getFlameGraphDurUs())) &&
            "TimeProfiler scope ended earlier than previous scope");
 
     // Calculate duration at full precision for overall counts.
     DurationType Duration = E.End - E.Start;
 
-    // Only include sections longer or equal to TimeTraceGranularity msec.
-    if (duration_cast<microseconds>(Duration).count() >= TimeTraceGranularity)
-      Entries.emplace_back(E);
-
     // Track total time taken by each "name", but only the topmost levels of
     // them; e.g. if there's a template instantiation that instantiates other
     // templates from within, we only want to add the topmost one. "topmost"
     // happens to be the ones that don't have any currently open entries above
     // itself.
-    if (std::find_if(++Stack.rbegin(), Stack.rend(), [&](const Entry &Val) {
-          return Val.Name == E.Name;
-        }) == Stack.rend()) {
-      auto &CountAndTotal = CountAndTotalPerName[E.Name];
+    if (std::find_if(++T.Stack.rbegin(), T.Stack.rend(),
+                     [&](const Entry &Val) { return Val.Name == E.Name; }) ==
+        T.Stack.rend()) {
+      auto &CountAndTotal = T.CountAndTotalPerName[E.Name];
       CountAndTotal.first++;
       CountAndTotal.second += Duration;
     }
 
-    Stack.pop_back();
+    // Only include sections longer or equal to TimeTraceGranularity msec.
+    // The entry is done with, so its strings are moved rather than copied.
+    if (duration_cast<microseconds>(Duration).count() >= TimeTraceGranularity)
+      T.addEntry(std::move(E), MaxEntriesPerThread);
+
+    T.Stack.pop_back();
+  }
+
+  void addCounter(StringRef Name, int64_t Value) {
+    std::lock_guard<std::mutex> Guard(Lock);
+    Counters.push_back({steady_clock::now(), Name, Value});
   }
 
   void Write(raw_pwrite_stream &OS) {
-    assert(Stack.empty() &&
-           "All profiler sections should be ended when calling Write");
+    std::lock_guard<std::mutex> Guard(Lock);
     json::OStream J(OS);
     J.objectBegin();
     J.attributeBegin("traceEvents");
     J.arrayBegin();
 
-    // Emit all events for the main flame graph.
-    for (const auto &E : Entries) {
-      auto StartUs = E.getFlameGraphStartUs(StartTime);
-      auto DurUs = E.getFlameGraphDurUs();
+    // Emit all events for the main flame graph. Each thread that recorded
+    // anything gets its own track; the thread that initialized the profiler
+    // comes first.
+    StringMap<CountAndDurationType> AllCountAndTotalPerName;
+    int Tid = 0;
+    for (const std::unique_ptr<ThreadTrace> &T : Threads) {
+      assert(T->Stack.empty() &&
+             "All profiler sections should be ended when calling Write");
+      // Sections are emitted oldest first, from where the ring buffer wraps.
+      for (size_t I = 0, N = T->Entries.size(); I != N; ++I) {
+        const Entry &E = T->Entries[(T->Oldest + I) % N];
+        auto StartUs = E.getFlameGraphStartUs(StartTime);
+        auto DurUs = E.getFlameGraphDurUs();
+
+        J.object([&]{
+          J.attribute("pid", 1);
+          J.attribute("tid", Tid);
+          J.attribute("ph", "X");
+          J.attribute("ts", StartUs);
+          J.attribute("dur", DurUs);
+          J.attribute("name", E.Name);
+          J.attributeObject("args", [&] { J.attribute("detail", E.Detail); });
+        });
+      }
+
+      for (const auto &E : T->CountAndTotalPerName) {
+        auto &CountAndTotal = AllCountAndTotalPerName[E.getKey()];
+        CountAndTotal.first += E.getValue().first;
+        CountAndTotal.second += E.getValue().second;
+      }
+
+      if (Tid != 0)
+        J.object([&] {
+          J.attribute("cat", "");
+          J.attribute("pid", 1);
+          J.attribute("tid", Tid);
+          J.attribute("ts", 0);
+          J.attribute("ph", "M");
+          J.attribute("name", "thread_name");
+          J.attributeObject("args", [&] {
+            J.attribute("name", "thread " + std::to_string(T->Tid));
+          });
+        });
+      ++Tid;
+    }
 
-      J.object([&]{
+    // Emit counters such as memory usage.
+    for (const Counter &C : Counters) {
+      J.object([&] {
         J.attribute("pid", 1);
         J.attribute("tid", 0);
-        J.attribute("ph", "X");
-        J.attribute("ts", StartUs);
-        J.attribute("dur", DurUs);
-        J.attribute("name", E.Name);
-        J.attributeObject("args", [&] { J.attribute("detail", E.Detail); });
+        J.attribute("ph", "C");
+        J.attribute("ts", (time_point_cast<microseconds>(C.Time) -
+                           time_point_cast<microseconds>(StartTime))
+                              .count());
+        J.attribute("name", C.Name);
+        J.attributeObject("args", [&] { J.attribute(C.Name, C.Value); });
       });
     }
 
     // Emit totals by section name as additional "thread" events, sorted from
     // longest one.
-    int Tid = 1;
     std::vector<NameAndCountAndDurationType> SortedTotals;
-    SortedTotals.reserve(CountAndTotalPerName.size());
-    for (const auto &E : CountAndTotalPerName)
+    SortedTotals.reserve(AllCountAndTotalPerName.size());
+    for (const auto &E : AllCountAndTotalPerName)
       SortedTotals.emplace_back(E.getKey(), E.getValue());
 
     llvm::sort(SortedTotals.begin(), SortedTotals.end(),
@@ -142,7 +253,7 @@ struct TimeTraceProfiler {
                });
     for (const auto &E : SortedTotals) {
       auto DurUs = duration_cast<microseconds>(E.second.second).count();
-      auto Count = CountAndTotalPerName[E.first].first;
+      auto Count = AllCountAndTotalPerName[E.first].first;
 
       J.object([&]{
         J.attribute("pid", 1);
@@ -168,7 +279,7 @@ struct TimeTraceProfiler {
       J.attribute("ts", 0);
       J.attribute("ph", "M");
       J.attribute("name", "process_name");
-      J.attributeObject("args", [&] { J.attribute("name", "clang"); });
+      J.attributeObject("args", [&] { J.attribute("name", ProcName); });
     });
 
     J.arrayEnd();
@@ -176,20 +287,30 @@ struct TimeTraceProfiler {
     J.objectEnd();
   }
 
-  SmallVector<Entry, 16> Stack;
-  SmallVector<Entry, 128> Entries;
-  StringMap<CountAndDurationType> CountAndTotalPerName;
+  std::mutex Lock;
+  std::vector<std::unique_ptr<ThreadTrace>> Threads;
+  std::vector<Counter> Counters;
   TimePointType StartTime;
+  std::string ProcName;
+  uint64_t Generation;
 
   // Minimum time granularity (in microseconds)
   unsigned TimeTraceGranularity;
+
+  // Maximum number of sections kept by each thread, or 0 for no limit.
+  unsigned MaxEntriesPerThread;
 };
 
-void timeTraceProfilerInitialize(unsigned TimeTraceGranularity) {
+void timeTraceProfilerInitialize(unsigned TimeTraceGranularity,
+                                 StringRef ProcName,
+                                 unsigned MaxEntriesPerThread) {
   assert(TimeTraceProfilerInstance == nullptr &&
          "Profiler should not be initialized");
-  TimeTraceProfilerInstance = new TimeTraceProfiler();
-  TimeTraceProfilerInstance->TimeTraceGranularity = TimeTraceGranularity;
+  TimeTraceProfilerInstance = new TimeTraceProfiler(
+      TimeTraceGranularity, ProcName, MaxEntriesPerThread);
+
+  // Register the calling thread first so that it gets the first track.
+  TimeTraceProfilerInstance->getThreadTrace();
 }
 
 void timeTraceProfilerCleanup() {
@@ -219,4 +340,9 @@ void timeTraceProfilerEnd() {
     TimeTraceProfilerInstance->end();
 }
 
+void timeTraceProfilerCounter(StringRef Name, int64_t Value) {
+  if (TimeTraceProfilerInstance != nullptr)
+    TimeTraceProfilerInstance->addCounter(Name, Value);
+}
+
 } // namespace llvm
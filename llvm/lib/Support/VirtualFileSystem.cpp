@@ -520,6 +520,158 @@ directory_iterator OverlayFileSystem::dir_begin(const Twine &Dir,
 
 void ProxyFileSystem::anchor() {}
 
+//===-----------------------------------------------------------------------===/
+// CachingFileSystem implementation
+//===-----------------------------------------------------------------------===/
+
+namespace {
+
+/// Iterates over a cached directory listing.
+class CachedDirIterImpl : public llvm::vfs::detail::DirIterImpl {
+  using DirListing = std::vector<std::pair<std::string, sys::fs::file_type>>;
+
+  std::string Dir;
+  std::shared_ptr<const DirListing> Entries;
+  size_t Index = 0;
+
+  void setCurrentEntry() {
+    if (Index == Entries->size()) {
+      CurrentEntry = directory_entry();
+      return;
+    }
+    SmallString<256> Path(Dir);
+    llvm::sys::path::append(Path, (*Entries)[Index].first);
+    CurrentEntry = directory_entry(Path.str(), (*Entries)[Index].second);
+  }
+
+public:
+  CachedDirIterImpl(std::string Dir, std::shared_ptr<const DirListing> Entries)
+      : Dir(std::move(Dir)), Entries(std::move(Entries)) {
+    setCurrentEntry();
+  }
+
+  std::error_code increment() override {
+    ++Index;
+    setCurrentEntry();
+    return {};
+  }
+};
+
+} // namespace
+
+std::string CachingFileSystem::getCacheKey(const Twine &Path) const {
+  SmallString<256> Key;
+  Path.toVector(Key);
+  if (makeAbsolute(Key))
+    return "";
+  // Removing ".." would be wrong in the presence of symlinks.
+  llvm::sys::path::remove_dots(Key, /*remove_dot_dot=*/false);
+  return Key.str();
+}
+
+bool CachingFileSystem::lookupStatus(StringRef Key,
+                                     llvm::ErrorOr<Status> &Result) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  auto It = StatusCache.find(Key);
+  if (It == StatusCache.end())
+    return false;
+  Result = It->second;
+  return true;
+}
+
+void CachingFileSystem::cacheStatus(StringRef Key,
+                                    const llvm::ErrorOr<Status> &Result) {
+  if (!Result && Result.getError() != errc::no_such_file_or_directory)
+    return;
+  std::lock_guard<std::mutex> Lock(Mutex);
+  StatusCache.insert({Key, Result});
+}
+
+llvm::ErrorOr<Status> CachingFileSystem::status(const Twine &Path) {
+  std::string Key = getCacheKey(Path);
+  if (Key.empty())
+    return ProxyFileSystem::status(Path);
+
+  llvm::ErrorOr<Status> Result = std::error_code();
+  if (!lookupStatus(Key, Result)) {
+    Result = ProxyFileSystem::status(Path);
+    cacheStatus(Key, Result);
+  }
+  if (!Result)
+    return Result.getError();
+  // The name of a status is the path it was requested with.
+  return Status::copyWithNewName(*Result, Path.str());
+}
+
+llvm::ErrorOr<std::unique_ptr<File>>
+CachingFileSystem::openFileForRead(const Twine &Path) {
+  std::string Key = getCacheKey(Path);
+  if (Key.empty())
+    return ProxyFileSystem::openFileForRead(Path);
+
+  llvm::ErrorOr<Status> Cached = std::error_code();
+  if (lookupStatus(Key, Cached) && !Cached)
+    return Cached.getError();
+
+  auto Result = ProxyFileSystem::openFileForRead(Path);
+  if (!Result && Result.getError() == errc::no_such_file_or_directory)
+    cacheStatus(Key, Result.getError());
+  return Result;
+}
+
+directory_iterator CachingFileSystem::dir_begin(const Twine &Dir,
+                                                std::error_code &EC) {
+  std::string Key = getCacheKey(Dir);
+  if (Key.empty())
+    return ProxyFileSystem::dir_begin(Dir, EC);
+
+  std::shared_ptr<const DirListing> Entries;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto It = DirCache.find(Key);
+    if (It != DirCache.end())
+      Entries = It->second;
+  }
+
+  if (!Entries) {
+    // Read the whole directory. If anything fails, don't cache the listing
+    // and let the caller see the error from the underlying file system.
+    auto Listing = std::make_shared<DirListing>();
+    directory_iterator I = ProxyFileSystem::dir_begin(Dir, EC);
+    for (directory_iterator E; !EC && I != E; I.increment(EC))
+      Listing->push_back(
+          {llvm::sys::path::filename(I->path()).str(), I->type()});
+    if (EC)
+      return ProxyFileSystem::dir_begin(Dir, EC);
+
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Entries = DirCache.insert({Key, std::move(Listing)}).first->second;
+  }
+
+  EC = {};
+  return directory_iterator(
+      std::make_shared<CachedDirIterImpl>(Dir.str(), std::move(Entries)));
+}
+
+void CachingFileSystem::invalidate(const Twine &Path) {
+  std::string Key = getCacheKey(Path);
+  std::lock_guard<std::mutex> Lock(Mutex);
+  if (Key.empty()) {
+    StatusCache.clear();
+    DirCache.clear();
+    return;
+  }
+  StatusCache.erase(Key);
+  DirCache.erase(Key);
+  DirCache.erase(llvm::sys::path::parent_path(Key));
+}
+
+void CachingFileSystem::invalidateAll() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  StatusCache.clear();
+  DirCache.clear();
+}
+
 namespace llvm {
 namespace vfs {
 
@@ -15,6 +15,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Config/config.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
@@ -32,6 +33,14 @@
 #include <sys/stat.h>
 #include <system_error>
 
+#if LLVM_ENABLE_THREADS
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
+
 // <fcntl.h> may provide O_BINARY.
 #if defined(HAVE_FCNTL_H)
 # include <fcntl.h>
@@ -570,8 +579,9 @@ raw_fd_ostream::raw_fd_ostream(StringRef Filename, std::error_code &EC,
 
 /// FD is the file descriptor that this writes to.  If ShouldClose is true, this
 /// closes the file when the stream is destroyed.
-raw_fd_ostream::raw_fd_ostream(int fd, bool shouldClose, bool unbuffered)
-    : raw_pwrite_stream(unbuffered), FD(fd), ShouldClose(shouldClose) {
+raw_fd_ostream::raw_fd_ostream(int fd, bool shouldClose, bool unbuffered,
+                               OStreamKind K)
+    : raw_pwrite_stream(unbuffered, K), FD(fd), ShouldClose(shouldClose) {
   if (FD < 0 ) {
     ShouldClose = false;
     return;
@@ -611,6 +621,7 @@ raw_fd_ostream::raw_fd_ostream(int fd, bool shouldClose, bool unbuffered)
 raw_fd_ostream::~raw_fd_ostream() {
   if (FD >= 0) {
     flush();
+    stopWriteBehind();
     if (ShouldClose) {
       if (auto EC = sys::Process::SafelyCloseFileDescriptor(FD))
         error_detected(EC);
@@ -684,18 +695,9 @@ static bool write_console_impl(int FD, StringRef Data) {
 }
 #endif
 
-void raw_fd_ostream::write_impl(const char *Ptr, size_t Size) {
-  assert(FD >= 0 && "File already closed.");
-  pos += Size;
-
-#if defined(_WIN32)
-  // If this is a Windows console device, try re-encoding from UTF-8 to UTF-16
-  // and using WriteConsoleW. If that fails, fall back to plain write().
-  if (IsWindowsConsole)
-    if (write_console_impl(FD, StringRef(Ptr, Size)))
-      return;
-#endif
-
+// Writes all of the given data to FD, retrying interrupted and partial
+// writes.
+static std::error_code writeToFD(int FD, const char *Ptr, size_t Size) {
   // The maximum write size is limited to INT32_MAX. A write
   // greater than SSIZE_MAX is implementation-defined in POSIX,
   // and Windows _write requires 32 bit input.
@@ -728,8 +730,7 @@ void raw_fd_ostream::write_impl(const char *Ptr, size_t Size) {
         continue;
 
       // Otherwise it's a non-recoverable error. Note it and quit.
-      error_detected(std::error_code(errno, std::generic_category()));
-      break;
+      return std::error_code(errno, std::generic_category());
     }
 
     // The write may have written some or all of the data. Update the
@@ -738,12 +739,179 @@ void raw_fd_ostream::write_impl(const char *Ptr, size_t Size) {
     Ptr += ret;
     Size -= ret;
   } while (Size > 0);
+  return std::error_code();
+}
+
+#if LLVM_ENABLE_THREADS
+// The buffers handed to the background writer of a raw_fd_ostream. Buffers
+// move from Free to Pending when they are filled, and back to Free when they
+// have been written. At most NumBuffers buffers are ever allocated.
+struct raw_fd_ostream::WriteBehindState {
+  struct Buffer {
+    std::unique_ptr<char[]> Data;
+    size_t Size = 0;
+  };
+
+  WriteBehindState(int FD, unsigned NumBuffers, size_t BufferSize)
+      : FD(FD), NumBuffers(NumBuffers), BufferSize(BufferSize),
+        Worker([this] { run(); }) {}
+
+  ~WriteBehindState() {
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      Stop = true;
+    }
+    CV.notify_all();
+    Worker.join();
+  }
+
+  // Copies the data into free buffers and queues them for writing.
+  void write(const char *Ptr, size_t Size) {
+    while (Size > 0) {
+      Buffer B = getFreeBuffer();
+      B.Size = std::min(Size, BufferSize);
+      memcpy(B.Data.get(), Ptr, B.Size);
+      Ptr += B.Size;
+      Size -= B.Size;
+
+      {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Pending.push_back(std::move(B));
+      }
+      CV.notify_all();
+    }
+  }
+
+  // Waits until all queued buffers have been written and returns the first
+  // error encountered since the last call, if any.
+  std::error_code wait() {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    CV.wait(Lock, [&] { return Pending.empty() && !Busy; });
+    std::error_code Ret = EC;
+    EC = std::error_code();
+    return Ret;
+  }
+
+private:
+  Buffer getFreeBuffer() {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    if (Free.empty() && NumAllocated < NumBuffers) {
+      ++NumAllocated;
+      Buffer B;
+      B.Data.reset(new char[BufferSize]);
+      return B;
+    }
+    CV.wait(Lock, [&] { return !Free.empty(); });
+    Buffer B = std::move(Free.back());
+    Free.pop_back();
+    return B;
+  }
+
+  void run() {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    for (;;) {
+      CV.wait(Lock, [&] { return Stop || !Pending.empty(); });
+      if (Pending.empty())
+        return;
+      Buffer B = std::move(Pending.front());
+      Pending.pop_front();
+      Busy = true;
+
+      // Once a write has failed, the file contents are unusable, so drop
+      // the remaining data.
+      if (!EC) {
+        Lock.unlock();
+        std::error_code WriteEC = writeToFD(FD, B.Data.get(), B.Size);
+        Lock.lock();
+        if (WriteEC && !EC)
+          EC = WriteEC;
+      }
+
+      Free.push_back(std::move(B));
+      Busy = false;
+      CV.notify_all();
+    }
+  }
+
+  const int FD;
+  const unsigned NumBuffers;
+  const size_t BufferSize;
+  unsigned NumAllocated = 0;
+
+  std::mutex Mutex;
+  std::condition_variable CV;
+  std::deque<Buffer> Pending;
+  std::vector<Buffer> Free;
+  bool Busy = false;
+  bool Stop = false;
+  std::error_code EC;
+
+  std::thread Worker;
+};
+#else
+struct raw_fd_ostream::WriteBehindState {};
+#endif
+
+void raw_fd_ostream::enableWriteBehind(unsigned NumBuffers,
+                                       size_t BufferSize) {
+  assert(FD >= 0 && "File already closed.");
+  assert(NumBuffers > 0 && BufferSize > 0 && "Invalid write-behind buffers");
+#if LLVM_ENABLE_THREADS
+#ifdef _WIN32
+  if (IsWindowsConsole)
+    return;
+#endif
+  waitForWrites();
+  WriteBehind.reset();
+  SetBufferSize(BufferSize);
+  WriteBehind = std::make_unique<WriteBehindState>(FD, NumBuffers, BufferSize);
+#endif
+}
+
+void raw_fd_ostream::waitForWrites() {
+  flush();
+#if LLVM_ENABLE_THREADS
+  if (WriteBehind)
+    if (std::error_code WriteEC = WriteBehind->wait())
+      error_detected(WriteEC);
+#endif
+}
+
+void raw_fd_ostream::stopWriteBehind() {
+  if (!WriteBehind)
+    return;
+  waitForWrites();
+  WriteBehind.reset();
+}
+
+void raw_fd_ostream::write_impl(const char *Ptr, size_t Size) {
+  assert(FD >= 0 && "File already closed.");
+  pos += Size;
+
+#if LLVM_ENABLE_THREADS
+  if (WriteBehind) {
+    WriteBehind->write(Ptr, Size);
+    return;
+  }
+#endif
+
+#if defined(_WIN32)
+  // If this is a Windows console device, try re-encoding from UTF-8 to UTF-16
+  // and using WriteConsoleW. If that fails, fall back to plain write().
+  if (IsWindowsConsole)
+    if (write_console_impl(FD, StringRef(Ptr, Size)))
+      return;
+#endif
+
+  if (std::error_code EC = writeToFD(FD, Ptr, Size))
+    error_detected(EC);
 }
 
 void raw_fd_ostream::close() {
   assert(ShouldClose);
   ShouldClose = false;
   flush();
+  stopWriteBehind();
   if (auto EC = sys::Process::SafelyCloseFileDescriptor(FD))
     error_detected(EC);
   FD = -1;
@@ -751,7 +919,7 @@ void raw_fd_ostream::close() {
 
 uint64_t raw_fd_ostream::seek(uint64_t off) {
   assert(SupportsSeeking && "Stream does not support seeking!");
-  flush();
+  waitForWrites();
 #ifdef _WIN32
   pos = ::_lseeki64(FD, off, SEEK_SET);
 #elif defined(HAVE_LSEEK64)
@@ -863,6 +1031,39 @@ bool raw_fd_ostream::has_colors() const {
 
 void raw_fd_ostream::anchor() {}
 
+//===----------------------------------------------------------------------===//
+//  raw_fd_stream
+//===----------------------------------------------------------------------===//
+
+raw_fd_stream::raw_fd_stream(StringRef Filename, std::error_code &EC)
+    : raw_fd_ostream(getFD(Filename, EC, sys::fs::CD_CreateAlways,
+                           sys::fs::FA_Write | sys::fs::FA_Read,
+                           sys::fs::OF_None),
+                     true, false, OStreamKind::OK_FDStream) {
+  if (EC)
+    return;
+
+  // Standard output cannot be read back, and other files that do not
+  // support seeking cannot be patched.
+  if (Filename == "-" || !supportsSeeking())
+    EC = std::make_error_code(std::errc::invalid_argument);
+}
+
+ssize_t raw_fd_stream::read(char *Ptr, size_t Size) {
+  assert(get_fd() >= 0 && "File already closed.");
+  waitForWrites();
+  ssize_t Ret = ::read(get_fd(), (void *)Ptr, Size);
+  if (Ret >= 0)
+    inc_pos(Ret);
+  else
+    error_detected(std::error_code(errno, std::generic_category()));
+  return Ret;
+}
+
+bool raw_fd_stream::classof(const raw_ostream *OS) {
+  return OS->get_kind() == OStreamKind::OK_FDStream;
+}
+
 //===----------------------------------------------------------------------===//
 //  outs(), errs(), nulls()
 //===----------------------------------------------------------------------===//
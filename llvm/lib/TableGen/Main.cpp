@@ -17,6 +17,7 @@
 #include "llvm/TableGen/Main.h"
 #include "TGParser.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -24,8 +25,14 @@
 #include "llvm/TableGen/Error.h"
 #include "llvm/TableGen/Record.h"
 #include <algorithm>
+#include <cerrno>
 #include <cstdio>
+#include <cstring>
 #include <system_error>
+#ifdef LLVM_ON_UNIX
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 using namespace llvm;
 
 static cl::opt<std::string>
@@ -62,16 +69,14 @@ static int reportError(const char *ProgName, Twine Msg) {
 ///
 /// This functionality is really only for the benefit of the build system.
 /// It is similar to GCC's `-M*` family of options.
-static int createDependencyFile(const TGParser &Parser, const char *argv0) {
-  if (OutputFilename == "-")
-    return reportError(argv0, "the option -d must be used together with -o\n");
-
+static int createDependencyFile(const TGParser &Parser, const char *argv0,
+                                StringRef Targets) {
   std::error_code EC;
   ToolOutputFile DepOut(DependFilename, EC, sys::fs::OF_None);
   if (EC)
     return reportError(argv0, "error opening " + DependFilename + ":" +
                                   EC.message() + "\n");
-  DepOut.os() << OutputFilename << ":";
+  DepOut.os() << Targets << ":";
   for (const auto &Dep : Parser.getDependencies()) {
     DepOut.os() << ' ' << Dep.first;
   }
@@ -80,10 +85,8 @@ static int createDependencyFile(const TGParser &Parser, const char *argv0) {
   return 0;
 }
 
-int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn) {
-  RecordKeeper Records;
-
-  // Parse the input file.
+/// Hand the input file over to SrcMgr, which is where TGParser reads it from.
+static int addInputFile(const char *argv0) {
   ErrorOr<std::unique_ptr<MemoryBuffer>> FileOrErr =
       MemoryBuffer::getFileOrSTDIN(InputFilename);
   if (std::error_code EC = FileOrErr.getError())
@@ -96,9 +99,41 @@ int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn) {
   // Record the location of the include directory so that the lexer can find
   // it later.
   SrcMgr.setIncludeDirs(IncludeDirs);
+  return 0;
+}
 
-  TGParser Parser(SrcMgr, MacroNames, Records);
+/// Write the output of a backend to Filename.
+static int writeOutput(const char *argv0, StringRef Filename,
+                       StringRef Contents) {
+  if (WriteIfChanged) {
+    // Only updates the real output file if there are any differences.
+    // This prevents recompilation of all the files depending on it if there
+    // aren't any.
+    if (auto ExistingOrErr = MemoryBuffer::getFile(Filename))
+      if (std::move(ExistingOrErr.get())->getBuffer() == Contents)
+        return 0;
+  }
 
+  std::error_code EC;
+  ToolOutputFile OutFile(Filename, EC, sys::fs::OF_None);
+  if (EC)
+    return reportError(argv0, "error opening " + Filename + ":" +
+                                  EC.message() + "\n");
+  OutFile.os() << Contents;
+
+  if (ErrorsPrinted > 0)
+    return reportError(argv0, Twine(ErrorsPrinted) + " errors.\n");
+
+  // Declare success.
+  OutFile.keep();
+  return 0;
+}
+
+int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn) {
+  RecordKeeper Records;
+  if (int Ret = addInputFile(argv0))
+    return Ret;
+  TGParser Parser(SrcMgr, MacroNames, Records);
   if (Parser.ParseFile())
     return 1;
 
@@ -113,30 +148,109 @@ int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn) {
   // the early exit below and someone deleted the .inc.d file but not the .inc
   // file, tablegen would never write the depfile.
   if (!DependFilename.empty()) {
-    if (int Ret = createDependencyFile(Parser, argv0))
+    if (OutputFilename == "-")
+      return reportError(argv0,
+                         "the option -d must be used together with -o\n");
+    if (int Ret = createDependencyFile(Parser, argv0, OutputFilename))
       return Ret;
   }
 
-  if (WriteIfChanged) {
-    // Only updates the real output file if there are any differences.
-    // This prevents recompilation of all the files depending on it if there
-    // aren't any.
-    if (auto ExistingOrErr = MemoryBuffer::getFile(OutputFilename))
-      if (std::move(ExistingOrErr.get())->getBuffer() == Out.str())
-        return 0;
+  return writeOutput(argv0, OutputFilename, Out.str());
+}
+
+/// Run a backend and write its output.
+static int runBackend(const char *argv0, const TableGenOutput &Output,
+                      RecordKeeper &Records) {
+  std::string OutString;
+  raw_string_ostream Out(OutString);
+  if (Output.MainFn(Out, Records))
+    return 1;
+  return writeOutput(argv0, Output.Filename, Out.str());
+}
+
+/// Run the backends of Outputs, up to Jobs at a time.
+///
+/// The values records are made of are uniqued in global pools that backends
+/// keep adding to, so backends cannot run concurrently in one address space.
+/// Instead, each one runs in a process forked once the records are resolved,
+/// which only copies the pages it writes to. Hosts without fork run the
+/// backends one after the other.
+static int runBackends(const char *argv0, ArrayRef<TableGenOutput> Outputs,
+                       RecordKeeper &Records, unsigned Jobs) {
+#ifdef LLVM_ON_UNIX
+  if (Jobs > 1 && Outputs.size() > 1) {
+    outs().flush();
+    errs().flush();
+    int Result = 0;
+    size_t Next = 0;
+    unsigned Running = 0;
+    while (Next < Outputs.size() || Running > 0) {
+      if (Next < Outputs.size() && Running < Jobs) {
+        pid_t Pid = fork();
+        if (Pid == 0) {
+          int Ret = runBackend(argv0, Outputs[Next], Records);
+          outs().flush();
+          errs().flush();
+          // The records are not worth freeing on the way out.
+          _exit(Ret);
+        }
+        if (Pid < 0) {
+          Result = reportError(argv0, "unable to start a backend: " +
+                                          Twine(strerror(errno)) + "\n");
+          // Let the backends already running finish.
+          Next = Outputs.size();
+          continue;
+        }
+        ++Next;
+        ++Running;
+        continue;
+      }
+      int Status;
+      if (wait(&Status) < 0) {
+        if (errno == EINTR)
+          continue;
+        return reportError(argv0, "unable to wait for a backend: " +
+                                      Twine(strerror(errno)) + "\n");
+      }
+      --Running;
+      if (!WIFEXITED(Status) || WEXITSTATUS(Status) != 0)
+        Result = 1;
+    }
+    return Result;
   }
+#endif
+  for (const TableGenOutput &Output : Outputs)
+    if (int Ret = runBackend(argv0, Output, Records))
+      return Ret;
+  return 0;
+}
 
-  std::error_code EC;
-  ToolOutputFile OutFile(OutputFilename, EC, sys::fs::OF_None);
-  if (EC)
-    return reportError(argv0, "error opening " + OutputFilename + ":" +
-                                  EC.message() + "\n");
-  OutFile.os() << Out.str();
+int llvm::TableGenMain(char *argv0, ArrayRef<TableGenOutput> Outputs,
+                       unsigned Jobs) {
+  for (const TableGenOutput &Output : Outputs)
+    if (Output.Filename.empty() || Output.Filename == "-")
+      return reportError(argv0, "each backend needs an output file\n");
 
-  if (ErrorsPrinted > 0)
-    return reportError(argv0, Twine(ErrorsPrinted) + " errors.\n");
+  RecordKeeper Records;
+  if (int Ret = addInputFile(argv0))
+    return Ret;
+  TGParser Parser(SrcMgr, MacroNames, Records);
+  if (Parser.ParseFile())
+    return 1;
 
-  // Declare success.
-  OutFile.keep();
+  if (int Ret = runBackends(argv0, Outputs, Records, Jobs))
+    return Ret;
+
+  // The depfile is written last, so that it only exists once all the outputs
+  // it names do.
+  if (!DependFilename.empty()) {
+    std::string Targets;
+    for (const TableGenOutput &Output : Outputs) {
+      if (!Targets.empty())
+        Targets += ' ';
+      Targets += Output.Filename;
+    }
+    return createDependencyFile(Parser, argv0, Targets);
+  }
   return 0;
 }
@@ -2800,6 +2800,32 @@ bool X86FastISel::fastLowerIntrinsicCall(const IntrinsicInst *II) {
     BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc, TII.get(X86::TRAP));
     return true;
   }
+  case Intrinsic::debugtrap: {
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc, TII.get(X86::INT3));
+    return true;
+  }
+  case Intrinsic::bswap:
+  case Intrinsic::ctpop: {
+    // These map onto a single node, which the generated patterns select when
+    // the subtarget has an instruction for it (POPCNT for ctpop).
+    MVT VT;
+    if (!isTypeLegal(II->getType(), VT))
+      return false;
+
+    unsigned SrcReg = getRegForValue(II->getArgOperand(0));
+    if (SrcReg == 0)
+      return false;
+    bool SrcIsKill = hasTrivialKill(II->getArgOperand(0));
+
+    unsigned Opc = II->getIntrinsicID() == Intrinsic::bswap ? ISD::BSWAP
+                                                             : ISD::CTPOP;
+    unsigned ResultReg = fastEmit_r(VT, VT, Opc, SrcReg, SrcIsKill);
+    if (ResultReg == 0)
+      return false;
+
+    updateValueMap(II, ResultReg);
+    return true;
+  }
   case Intrinsic::sqrt: {
     if (!Subtarget->hasSSE1())
       return false;
@@ -53,6 +53,13 @@ STATISTIC(NumAttributesValidFixpoint,
           "Number of abstract attributes in a valid fixpoint state");
 STATISTIC(NumAttributesManifested,
           "Number of abstract attributes manifested in IR");
+STATISTIC(NumAttributesOverBudget,
+          "Number of abstract attributes fixed because their function ran out "
+          "of updates");
+STATISTIC(NumAttributeUpdates, "Number of abstract attribute updates");
+STATISTIC(NumFixpointIterations, "Number of fixpoint iterations");
+STATISTIC(MaxFixpointIterationsPerRun,
+          "Maximal number of fixpoint iterations in one run");
 
 // Some helper macros to deal with statistics tracking.
 //
@@ -131,10 +138,19 @@ static cl::opt<bool> VerifyAttributor(
              "manifestation of attributes -- may issue false-positive errors"),
     cl::init(false));
 
+// Dependences are dropped when the queried attribute changes and recorded again
+// by the next update of the querying one, so they do not need to be recomputed
+// periodically by updating all attributes.
 static cl::opt<unsigned> DepRecInterval(
     "attributor-dependence-recompute-interval", cl::Hidden,
     cl::desc("Number of iterations until dependences are recomputed."),
-    cl::init(4));
+    cl::init(0));
+
+static cl::opt<unsigned> MaxUpdatesPerFunction(
+    "attributor-max-updates-per-function", cl::Hidden,
+    cl::desc("Maximal number of abstract attribute updates in a function "
+             "before its attributes are fixed pessimistically (0 = no limit)."),
+    cl::init(0));
 
 static cl::opt<bool> EnableHeapToStack("enable-heap-to-stack-conversion",
                                        cl::init(true), cl::Hidden);
@@ -4098,6 +4114,13 @@ void AAMemoryBehaviorFloating::analyzeUseIn(Attributor &A, const Use *U,
 ///                               Attributor
 /// ----------------------------------------------------------------------------
 
+void Attributor::recordDependence(const AbstractAttribute &FromAA,
+                                  const AbstractAttribute &ToAA) {
+  if (FromAA.getState().isAtFixpoint())
+    return;
+  QueryMap[&FromAA].insert(const_cast<AbstractAttribute *>(&ToAA));
+}
+
 bool Attributor::isAssumedDead(const AbstractAttribute &AA,
                                const AAIsDead *LivenessAA) {
   const Instruction *CtxI = AA.getIRPosition().getCtxI();
@@ -4333,6 +4356,7 @@ ChangeStatus Attributor::run(Module &M) {
   Worklist.insert(AllAbstractAttributes.begin(), AllAbstractAttributes.end());
 
   bool RecomputeDependences = false;
+  DenseMap<const Function *, unsigned> NumUpdatesPerFunction;
 
   do {
     // Remember the size to determine new attributes.
@@ -4352,10 +4376,12 @@ ChangeStatus Attributor::run(Module &M) {
     }
 
     // Add all abstract attributes that are potentially dependent on one that
-    // changed to the work list.
+    // changed to the work list. Their dependences are dropped, the update
+    // records the ones they still have.
     for (AbstractAttribute *ChangedAA : ChangedAAs) {
       auto &QuerriedAAs = QueryMap[ChangedAA];
       Worklist.insert(QuerriedAAs.begin(), QuerriedAAs.end());
+      QuerriedAAs.clear();
     }
 
     LLVM_DEBUG(dbgs() << "[Attributor] #Iteration: " << IterationCounter
@@ -4366,11 +4392,26 @@ ChangeStatus Attributor::run(Module &M) {
     ChangedAAs.clear();
 
     // Update all abstract attribute in the work list and record the ones that
-    // changed.
-    for (AbstractAttribute *AA : Worklist)
-      if (!isAssumedDead(*AA, nullptr))
-        if (AA->update(*this) == ChangeStatus::CHANGED)
+    // changed. Once a function used up its updates, the attributes in it are
+    // fixed in their pessimistic state, which is sound without further
+    // iterations.
+    for (AbstractAttribute *AA : Worklist) {
+      if (isAssumedDead(*AA, nullptr))
+        continue;
+      const Function *AnchorScope = AA->getIRPosition().getAnchorScope();
+      if (MaxUpdatesPerFunction && AnchorScope &&
+          ++NumUpdatesPerFunction[AnchorScope] > MaxUpdatesPerFunction) {
+        if (!AA->getState().isAtFixpoint()) {
+          AA->getState().indicatePessimisticFixpoint();
           ChangedAAs.push_back(AA);
+          ++NumAttributesOverBudget;
+        }
+        continue;
+      }
+      ++NumAttributeUpdates;
+      if (AA->update(*this) == ChangeStatus::CHANGED)
+        ChangedAAs.push_back(AA);
+    }
 
     // Check if we recompute the dependences in the next iteration.
     RecomputeDependences = (DepRecomputeInterval > 0 &&
@@ -4392,6 +4433,8 @@ ChangeStatus Attributor::run(Module &M) {
   LLVM_DEBUG(dbgs() << "\n[Attributor] Fixpoint iteration done after: "
                     << IterationCounter << "/" << MaxFixpointIterations
                     << " iterations\n");
+  NumFixpointIterations += IterationCounter;
+  MaxFixpointIterationsPerRun.updateMax(IterationCounter);
 
   size_t NumFinalAAs = AllAbstractAttributes.size();
 
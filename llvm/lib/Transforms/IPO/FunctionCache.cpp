@@ -0,0 +1,453 @@
+//===- FunctionCache.cpp - Cache for function pass pipelines --------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements FunctionCachePass.
+//
+// For each function, we build a small module containing a copy of the
+// function and declarations of the globals it refers to, and hash its bitcode
+// to get the cache key. On a miss, we run the pipeline and store the
+// optimized function the same way. On a hit, we link the cached function into
+// the module with IRMover and move its body into the original function, so
+// that the Function object and its uses stay the same.
+//
+// In cached modules, the globals of the original module are all external
+// declarations because IRMover only links declarations to definitions by
+// name if both are external. Local globals of the original module are
+// therefore made external while a cached function is linked in.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO/FunctionCache.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassInstrumentation.h"
+#include "llvm/Linker/IRMover.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "function-cache"
+
+STATISTIC(NumCacheHits, "Number of functions restored from the cache");
+STATISTIC(NumCacheMisses, "Number of functions optimized and cached");
+STATISTIC(NumUncacheable, "Number of functions that could not be cached");
+
+// The name of the function in a cache entry. It is private, so it does not
+// clash with anything, and can be found after it has been linked in.
+static const char CachedFunctionName[] = "__llvm_function_cache_entry";
+
+// Adds the global values that C refers to to Globals. Initializers of global
+// variables for which FollowInit returns true are followed as well.
+static void
+collectGlobals(const Constant *C, SetVector<GlobalValue *> &Globals,
+               SmallPtrSetImpl<const Constant *> &Visited,
+               function_ref<bool(const GlobalVariable &)> FollowInit) {
+  SmallVector<const Constant *, 16> Worklist = {C};
+  while (!Worklist.empty()) {
+    const Constant *C = Worklist.pop_back_val();
+    if (!Visited.insert(C).second)
+      continue;
+    if (auto *GV = dyn_cast<GlobalValue>(C)) {
+      Globals.insert(const_cast<GlobalValue *>(GV));
+      auto *GVar = dyn_cast<GlobalVariable>(GV);
+      if (GVar && GVar->hasInitializer() && FollowInit(*GVar))
+        Worklist.push_back(GVar->getInitializer());
+      continue;
+    }
+    for (const Use &Op : C->operands())
+      if (auto *OpC = dyn_cast<Constant>(Op))
+        Worklist.push_back(OpC);
+  }
+}
+
+// Returns the global values that F refers to, from instructions or from
+// metadata, or None if F cannot be cached.
+static Optional<SetVector<GlobalValue *>>
+getReferencedGlobals(const Function &F,
+                     function_ref<bool(const GlobalVariable &)> FollowInit) {
+  // We cannot restore debug info without duplicating its compile unit, data
+  // that the cloning utilities do not handle, or blocks that may be
+  // referenced from elsewhere.
+  if (F.getSubprogram() || F.hasPrefixData() || F.hasPrologueData())
+    return None;
+
+  SetVector<GlobalValue *> Globals;
+  SmallPtrSet<const Constant *, 32> Visited;
+  SmallPtrSet<const MDNode *, 32> VisitedMD;
+  SmallVector<const MDNode *, 16> MDWorklist;
+  SmallVector<std::pair<unsigned, MDNode *>, 4> MDs;
+  auto AddMetadata = [&](const Value &V) {
+    MDs.clear();
+    if (auto *I = dyn_cast<Instruction>(&V))
+      I->getAllMetadata(MDs);
+    else
+      cast<GlobalObject>(V).getAllMetadata(MDs);
+    for (auto &MD : MDs)
+      MDWorklist.push_back(MD.second);
+  };
+
+  if (F.hasPersonalityFn())
+    collectGlobals(F.getPersonalityFn(), Globals, Visited, FollowInit);
+  AddMetadata(F);
+  for (const BasicBlock &BB : F) {
+    if (BB.hasAddressTaken())
+      return None;
+    for (const Instruction &I : BB) {
+      for (const Use &Op : I.operands()) {
+        if (auto *C = dyn_cast<Constant>(Op))
+          collectGlobals(C, Globals, Visited, FollowInit);
+        else if (auto *MAV = dyn_cast<MetadataAsValue>(Op))
+          if (auto *N = dyn_cast<MDNode>(MAV->getMetadata()))
+            MDWorklist.push_back(N);
+      }
+      AddMetadata(I);
+    }
+  }
+
+  while (!MDWorklist.empty()) {
+    const MDNode *N = MDWorklist.pop_back_val();
+    if (!VisitedMD.insert(N).second)
+      continue;
+    for (const MDOperand &Op : N->operands()) {
+      if (auto *C = dyn_cast_or_null<ConstantAsMetadata>(Op.get()))
+        collectGlobals(C->getValue(), Globals, Visited, FollowInit);
+      else if (auto *OpN = dyn_cast_or_null<MDNode>(Op.get()))
+        MDWorklist.push_back(OpN);
+    }
+  }
+
+  // Cached functions are linked in by name. A function taking the address of
+  // a block of another function cannot be separated from it.
+  for (GlobalValue *GV : Globals) {
+    if (!GV->hasName() || GV->getName() == CachedFunctionName)
+      return None;
+    if (GV != &F)
+      for (const User *U : GV->users())
+        if (isa<BlockAddress>(U))
+          return None;
+  }
+  return std::move(Globals);
+}
+
+// Returns a module containing a copy of F named Name with linkage Linkage,
+// and declarations of the globals it refers to. Global variables for which
+// KeepDefinition returns true keep their linkage and initializers.
+static std::unique_ptr<Module>
+extractFunction(Function &F, const SetVector<GlobalValue *> &Globals,
+                StringRef Name, GlobalValue::LinkageTypes Linkage,
+                function_ref<bool(const GlobalVariable &)> KeepDefinition) {
+  const Module &M = *F.getParent();
+  auto NewM = std::make_unique<Module>("", F.getContext());
+  NewM->setDataLayout(M.getDataLayout());
+  NewM->setTargetTriple(M.getTargetTriple());
+
+  ValueToValueMapTy VMap;
+  for (GlobalValue *GV : Globals) {
+    if (GV == &F)
+      continue;
+    GlobalValue *NewGV;
+    unsigned AddrSpace = GV->getAddressSpace();
+    if (auto *GVar = dyn_cast<GlobalVariable>(GV)) {
+      auto *NewGVar = new GlobalVariable(
+          *NewM, GVar->getValueType(), GVar->isConstant(),
+          GlobalValue::ExternalLinkage, nullptr, GVar->getName(), nullptr,
+          GVar->getThreadLocalMode(), AddrSpace);
+      NewGVar->copyAttributesFrom(GVar);
+      NewGV = NewGVar;
+    } else if (auto *Fn = dyn_cast<Function>(GV)) {
+      auto *NewFn = Function::Create(Fn->getFunctionType(),
+                                     GlobalValue::ExternalLinkage, AddrSpace,
+                                     Fn->getName(), NewM.get());
+      NewFn->copyAttributesFrom(Fn);
+      // Personality functions are not valid on declarations.
+      NewFn->setPersonalityFn(nullptr);
+      NewGV = NewFn;
+    } else {
+      // Aliases and ifuncs are declared as what they point to.
+      Type *Ty = GV->getValueType();
+      if (auto *FTy = dyn_cast<FunctionType>(Ty))
+        NewGV = Function::Create(FTy, GlobalValue::ExternalLinkage, AddrSpace,
+                                 GV->getName(), NewM.get());
+      else
+        NewGV = new GlobalVariable(*NewM, Ty, /*isConstant=*/false,
+                                   GlobalValue::ExternalLinkage, nullptr,
+                                   GV->getName(), nullptr,
+                                   GV->getThreadLocalMode(), AddrSpace);
+      NewGV->setVisibility(GV->getVisibility());
+      NewGV->setDSOLocal(GV->isDSOLocal());
+    }
+    NewGV->setLinkage(GlobalValue::ExternalLinkage);
+    VMap[GV] = NewGV;
+  }
+
+  for (GlobalValue *GV : Globals) {
+    auto *GVar = dyn_cast<GlobalVariable>(GV);
+    if (!GVar || !GVar->hasInitializer() || !KeepDefinition(*GVar))
+      continue;
+    auto *NewGVar = cast<GlobalVariable>(VMap[GVar]);
+    NewGVar->setLinkage(GVar->getLinkage());
+    NewGVar->setInitializer(MapValue(GVar->getInitializer(), VMap));
+  }
+
+  Function *NewF =
+      Function::Create(F.getFunctionType(), Linkage, F.getAddressSpace(), Name,
+                       NewM.get());
+  VMap[&F] = NewF;
+  auto NewArg = NewF->arg_begin();
+  for (Argument &Arg : F.args()) {
+    NewArg->setName(Arg.getName());
+    VMap[&Arg] = &*NewArg++;
+  }
+  SmallVector<ReturnInst *, 8> Returns;
+  CloneFunctionInto(NewF, &F, VMap, /*ModuleLevelChanges=*/true, Returns);
+  NewF->setLinkage(Linkage);
+  if (NewF->hasLocalLinkage())
+    NewF->setVisibility(GlobalValue::DefaultVisibility);
+  return NewM;
+}
+
+static std::string getEntryPath(StringRef CacheDir, StringRef Key) {
+  SmallString<128> Path(CacheDir);
+  sys::path::append(Path, "llvmfcache-" + Key);
+  return Path.str();
+}
+
+// Writes M to the cache entry for Key. The entry is written to a temporary
+// file first, so that concurrent readers never see a partial entry.
+static void writeEntry(StringRef CacheDir, StringRef Key, const Module &M) {
+  SmallString<128> TempPath;
+  int FD;
+  if (sys::fs::createUniqueFile(getEntryPath(CacheDir, "%%%%%%%%.tmp"), FD,
+                                TempPath))
+    return;
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    WriteBitcodeToFile(M, OS);
+    if (OS.has_error()) {
+      OS.clear_error();
+      sys::fs::remove(TempPath);
+      return;
+    }
+  }
+  if (sys::fs::rename(TempPath, getEntryPath(CacheDir, Key)))
+    sys::fs::remove(TempPath);
+}
+
+// Replaces the body of F by the function in the cache entry Buffer. Returns
+// false, leaving F alone, if the entry cannot be read or linked.
+static bool restoreFunction(Function &F, MemoryBufferRef Buffer,
+                            IRMover &Mover) {
+  Module &M = *F.getParent();
+  if (M.getNamedValue(CachedFunctionName))
+    return false;
+  Expected<std::unique_ptr<Module>> SrcOrErr =
+      parseBitcodeFile(Buffer, F.getContext());
+  if (!SrcOrErr) {
+    consumeError(SrcOrErr.takeError());
+    return false;
+  }
+  std::unique_ptr<Module> Src = std::move(*SrcOrErr);
+  Function *SrcF = Src->getFunction(CachedFunctionName);
+  if (!SrcF || SrcF->isDeclaration())
+    return false;
+
+  // Make the local globals that the entry refers to external for IRMover.
+  SmallVector<std::pair<GlobalValue *, GlobalValue::LinkageTypes>, 8> Locals;
+  for (GlobalValue &SrcGV : Src->global_values()) {
+    if (!SrcGV.isDeclaration())
+      continue;
+    GlobalValue *GV = M.getNamedValue(SrcGV.getName());
+    if (GV && GV->hasLocalLinkage()) {
+      Locals.push_back({GV, GV->getLinkage()});
+      GV->setLinkage(GlobalValue::ExternalLinkage);
+    }
+  }
+  Error E = Mover.move(std::move(Src), {SrcF},
+                       [](GlobalValue &, IRMover::ValueAdder) {},
+                       /*IsPerformingImport=*/false);
+  for (auto &Local : Locals)
+    Local.first->setLinkage(Local.second);
+  if (E) {
+    LLVM_DEBUG(dbgs() << "function-cache: cannot link entry for "
+                      << F.getName() << ": " << toString(std::move(E))
+                      << "\n");
+    consumeError(std::move(E));
+    if (Function *NewF = M.getFunction(CachedFunctionName))
+      NewF->eraseFromParent();
+    return false;
+  }
+
+  Function *NewF = M.getFunction(CachedFunctionName);
+  if (!NewF)
+    return false;
+  if (NewF->getType() != F.getType()) {
+    NewF->eraseFromParent();
+    return false;
+  }
+
+  // Move the body and everything that Function::dropAllReferences clears.
+  F.dropAllReferences();
+  F.getBasicBlockList().splice(F.end(), NewF->getBasicBlockList());
+  for (auto Args : zip(NewF->args(), F.args())) {
+    std::get<0>(Args).replaceAllUsesWith(&std::get<1>(Args));
+    std::get<1>(Args).takeName(&std::get<0>(Args));
+  }
+  F.setAttributes(NewF->getAttributes());
+  if (NewF->hasPersonalityFn())
+    F.setPersonalityFn(NewF->getPersonalityFn());
+  SmallVector<std::pair<unsigned, MDNode *>, 4> MDs;
+  NewF->getAllMetadata(MDs);
+  for (auto &MD : MDs)
+    F.setMetadata(MD.first, MD.second);
+
+  NewF->replaceAllUsesWith(&F);
+  NewF->eraseFromParent();
+  return true;
+}
+
+PreservedAnalyses FunctionCachePass::run(Module &M,
+                                         ModuleAnalysisManager &AM) {
+  FunctionAnalysisManager &FAM =
+      AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+  PassInstrumentation PI = AM.getResult<PassInstrumentationAnalysis>(M);
+
+  bool UseCache = !CacheDir.empty();
+  if (UseCache) {
+    if (std::error_code EC = sys::fs::create_directories(CacheDir)) {
+      LLVM_DEBUG(dbgs() << "function-cache: cannot create " << CacheDir
+                        << ": " << EC.message() << "\n");
+      UseCache = false;
+    }
+  }
+
+  // Everything that affects the pipeline but not a particular function.
+  SHA1 ModuleHasher;
+  ModuleHasher.update(LLVM_VERSION_STRING);
+  ModuleHasher.update(ArrayRef<uint8_t>{0});
+  ModuleHasher.update(PipelineKey);
+  ModuleHasher.update(ArrayRef<uint8_t>{0});
+  if (NamedMDNode *Flags = M.getModuleFlagsMetadata()) {
+    std::string Str;
+    raw_string_ostream OS(Str);
+    Flags->print(OS);
+    ModuleHasher.update(OS.str());
+  }
+  StringRef ModuleHash = ModuleHasher.result();
+
+  // The IRMover is created on the first hit because it visits all types in
+  // the module.
+  std::unique_ptr<IRMover> Mover;
+
+  PreservedAnalyses PA = PreservedAnalyses::all();
+  for (Function &F : M) {
+    if (F.isDeclaration())
+      continue;
+
+    std::string Key;
+    if (UseCache) {
+      auto FollowConstants = [](const GlobalVariable &GV) {
+        return GV.isConstant();
+      };
+      if (auto Globals = getReferencedGlobals(F, FollowConstants)) {
+        std::unique_ptr<Module> KeyM = extractFunction(
+            F, *Globals, F.getName(), F.getLinkage(), FollowConstants);
+        SmallVector<char, 0> Buffer;
+        raw_svector_ostream OS(Buffer);
+        WriteBitcodeToFile(*KeyM, OS);
+        SHA1 Hasher;
+        Hasher.update(ModuleHash);
+        Hasher.update(
+            ArrayRef<uint8_t>((const uint8_t *)Buffer.data(), Buffer.size()));
+        Key = toHex(Hasher.result());
+      } else {
+        ++NumUncacheable;
+      }
+    }
+
+    if (!Key.empty()) {
+      if (ErrorOr<std::unique_ptr<MemoryBuffer>> Entry =
+              MemoryBuffer::getFile(getEntryPath(CacheDir, Key), -1, false)) {
+        // The body is about to be replaced.
+        FAM.invalidate(F, PreservedAnalyses::none());
+        if (!Mover)
+          Mover = std::make_unique<IRMover>(M);
+        if (restoreFunction(F, **Entry, *Mover)) {
+          LLVM_DEBUG(dbgs() << "function-cache: restored " << F.getName()
+                            << "\n");
+          ++NumCacheHits;
+          PA.intersect(PreservedAnalyses::none());
+          continue;
+        }
+      }
+    }
+
+    if (!PI.runBeforePass<Function>(Pipeline, F))
+      continue;
+
+    // Globals created by the pipeline are appended to the module.
+    size_t NumGlobals = M.getGlobalList().size();
+    PreservedAnalyses PassPA = Pipeline.run(F, FAM);
+    PI.runAfterPass(Pipeline, F);
+    FAM.invalidate(F, PassPA);
+    PA.intersect(std::move(PassPA));
+
+    if (Key.empty())
+      continue;
+
+    // Globals created by the pipeline, such as string constants, must be
+    // restored with the function, but only local ones can be.
+    SmallPtrSet<const GlobalVariable *, 4> NewGlobals;
+    bool HasNewExternalDefinition = false;
+    auto It = M.global_end();
+    for (size_t I = NumGlobals, E = M.getGlobalList().size(); I < E; ++I) {
+      --It;
+      NewGlobals.insert(&*It);
+      HasNewExternalDefinition |=
+          !It->isDeclaration() && !It->hasLocalLinkage();
+    }
+    if (HasNewExternalDefinition) {
+      ++NumUncacheable;
+      continue;
+    }
+    auto IsNew = [&](const GlobalVariable &GV) {
+      return NewGlobals.count(&GV) != 0;
+    };
+    auto Globals = getReferencedGlobals(F, IsNew);
+    if (!Globals) {
+      ++NumUncacheable;
+      continue;
+    }
+    writeEntry(CacheDir, Key,
+               *extractFunction(F, *Globals, CachedFunctionName,
+                                GlobalValue::PrivateLinkage, IsNew));
+    ++NumCacheMisses;
+  }
+
+  // As in ModuleToFunctionPassAdaptor, we assume that no functions were added
+  // or removed, and we already invalidated the analyses of each function.
+  PA.preserveSet<AllAnalysesOn<Function>>();
+  PA.preserve<FunctionAnalysisManagerModuleProxy>();
+  return PA;
+}
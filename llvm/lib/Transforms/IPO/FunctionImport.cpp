@@ -41,14 +41,18 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/IPO/Internalize.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 #include "llvm/Transforms/Utils/FunctionImportUtils.h"
 #include "llvm/Transforms/Utils/ValueMapper.h"
+#include <atomic>
 #include <cassert>
 #include <memory>
+#include <queue>
 #include <set>
 #include <string>
 #include <system_error>
@@ -112,6 +116,17 @@ static cl::opt<float> ImportColdMultiplier(
     "import-cold-multiplier", cl::init(0), cl::Hidden, cl::value_desc("N"),
     cl::desc("Multiply the `import-instr-limit` threshold for cold callsites"));
 
+static cl::opt<unsigned> ImportModuleBudget(
+    "import-module-budget", cl::init(0), cl::Hidden, cl::value_desc("N"),
+    cl::desc("If N>0, import at most N instructions into each module, "
+             "choosing callees greedily by hotness and benefit per "
+             "instruction instead of with per-callsite thresholds"));
+
+static cl::opt<std::string> ImportReport(
+    "import-report", cl::Hidden, cl::value_desc("filename"),
+    cl::desc("Write the functions the thin link decided to import into each "
+             "module or not, and why, to a JSON file"));
+
 static cl::opt<bool> PrintImports("print-imports", cl::init(false), cl::Hidden,
                                   cl::desc("Print imported functions"));
 
@@ -119,6 +134,11 @@ static cl::opt<bool> PrintImportFailures(
     "print-import-failures", cl::init(false), cl::Hidden,
     cl::desc("Print information for functions rejected for importing"));
 
+static cl::opt<unsigned> ImportThreads(
+    "thinlto-import-threads", cl::init(0), cl::Hidden,
+    cl::desc("Number of threads to compute the imports of the modules of the "
+             "thin link with, or 0 for one per hardware thread"));
+
 static cl::opt<bool> ComputeDead("compute-dead", cl::init(true), cl::Hidden,
                                  cl::desc("Compute dead symbols"));
 
@@ -262,8 +282,86 @@ namespace {
 using EdgeInfo = std::tuple<const FunctionSummary *, unsigned /* Threshold */,
                             GlobalValue::GUID>;
 
+/// A function the thin link decided to import into a module or not, for the
+/// import report.
+struct ImportDecision {
+  ValueInfo VI;
+  /// The imported summary, or null if the function is not imported.
+  const FunctionSummary *Summary;
+  FunctionImporter::ImportFailureReason Reason;
+  CalleeInfo::HotnessType Hotness;
+  /// The instruction count threshold, or what was left of the budget, when
+  /// the function was last considered.
+  unsigned Threshold;
+  /// The priority of the function in the budget mode, or 0.
+  float Score;
+  unsigned Attempts;
+};
+
 } // anonymous namespace
 
+/// Whether to keep the reasons for not importing candidates.
+static bool shouldTrackImportFailures() {
+  return PrintImportFailures || !ImportReport.empty();
+}
+
+/// The multiplier of the import thresholds, or of the priority of a callee in
+/// the budget mode, for calls with \p Hotness.
+static float getBonusMultiplier(CalleeInfo::HotnessType Hotness) {
+  if (Hotness == CalleeInfo::HotnessType::Hot)
+    return ImportHotMultiplier;
+  if (Hotness == CalleeInfo::HotnessType::Cold)
+    return ImportColdMultiplier;
+  if (Hotness == CalleeInfo::HotnessType::Critical)
+    return ImportCriticalMultiplier;
+  return 1.0;
+}
+
+/// Record the decision to import \p CalleeSummary, the definition of \p GUID,
+/// from its module, and the symbols it makes its module export. Returns false
+/// if it was already imported.
+static bool addImport(const FunctionSummary &CalleeSummary,
+                      GlobalValue::GUID GUID,
+                      CalleeInfo::HotnessType Hotness,
+                      FunctionImporter::ImportMapTy &ImportList,
+                      StringMap<FunctionImporter::ExportSetTy> *ExportLists) {
+  auto ExportModulePath = CalleeSummary.modulePath();
+  auto ILI = ImportList[ExportModulePath].insert(GUID);
+  // We previously decided to import this GUID definition if it was already
+  // inserted in the set of imports from the exporting module.
+  bool PreviouslyImported = !ILI.second;
+  if (!PreviouslyImported) {
+    NumImportedFunctionsThinLink++;
+    if (Hotness == CalleeInfo::HotnessType::Hot)
+      NumImportedHotFunctionsThinLink++;
+    if (Hotness == CalleeInfo::HotnessType::Critical)
+      NumImportedCriticalFunctionsThinLink++;
+  }
+
+  // Make exports in the source module.
+  if (ExportLists) {
+    auto &ExportList = (*ExportLists)[ExportModulePath];
+    ExportList.insert(GUID);
+    if (!PreviouslyImported) {
+      // This is the first time this function was exported from its source
+      // module, so mark all functions and globals it references as exported
+      // to the outside if they are defined in the same source module.
+      // For efficiency, we unconditionally add all the referenced GUIDs
+      // to the ExportList for this module, and will prune out any not
+      // defined in the module later in a single pass.
+      for (auto &Edge : CalleeSummary.calls()) {
+        auto CalleeGUID = Edge.first.getGUID();
+        ExportList.insert(CalleeGUID);
+      }
+      for (auto &Ref : CalleeSummary.refs()) {
+        auto GUID = Ref.getGUID();
+        ExportList.insert(GUID);
+      }
+    }
+  }
+  return !PreviouslyImported;
+}
+
 static ValueInfo
 updateValueInfoForIndirectCalls(const ModuleSummaryIndex &Index, ValueInfo VI) {
   if (!VI.getSummaryList().empty())
@@ -337,6 +435,8 @@ getFailureName(FunctionImporter::ImportFailureReason Reason) {
     return "NotEligible";
   case FunctionImporter::ImportFailureReason::NoInline:
     return "NoInline";
+  case FunctionImporter::ImportFailureReason::OverBudget:
+    return "OverBudget";
   }
   llvm_unreachable("invalid reason");
 }
@@ -353,7 +453,7 @@ static void computeImportForFunction(
     FunctionImporter::ImportThresholdsTy &ImportThresholds) {
   computeImportForReferencedGlobals(Summary, DefinedGVSummaries, ImportList,
                                     ExportLists);
-  static int ImportCount = 0;
+  static std::atomic<int> ImportCount(0);
   for (auto &Edge : Summary.calls()) {
     ValueInfo VI = Edge.first;
     LLVM_DEBUG(dbgs() << " edge -> " << VI << " Threshold:" << Threshold
@@ -374,18 +474,8 @@ static void computeImportForFunction(
       continue;
     }
 
-    auto GetBonusMultiplier = [](CalleeInfo::HotnessType Hotness) -> float {
-      if (Hotness == CalleeInfo::HotnessType::Hot)
-        return ImportHotMultiplier;
-      if (Hotness == CalleeInfo::HotnessType::Cold)
-        return ImportColdMultiplier;
-      if (Hotness == CalleeInfo::HotnessType::Critical)
-        return ImportCriticalMultiplier;
-      return 1.0;
-    };
-
     const auto NewThreshold =
-        Threshold * GetBonusMultiplier(Edge.second.getHotness());
+        Threshold * getBonusMultiplier(Edge.second.getHotness());
 
     auto IT = ImportThresholds.insert(std::make_pair(
         VI.getGUID(), std::make_tuple(NewThreshold, nullptr, nullptr)));
@@ -396,8 +486,6 @@ static void computeImportForFunction(
 
     bool IsHotCallsite =
         Edge.second.getHotness() == CalleeInfo::HotnessType::Hot;
-    bool IsCriticalCallsite =
-        Edge.second.getHotness() == CalleeInfo::HotnessType::Critical;
 
     const FunctionSummary *ResolvedCalleeSummary = nullptr;
     if (CalleeSummary) {
@@ -422,7 +510,7 @@ static void computeImportForFunction(
         LLVM_DEBUG(
             dbgs() << "ignored! Target was already rejected with Threshold "
             << ProcessedThreshold << "\n");
-        if (PrintImportFailures) {
+        if (shouldTrackImportFailures()) {
           assert(FailureInfo &&
                  "Expected FailureInfo for previously rejected candidate");
           FailureInfo->Attempts++;
@@ -439,7 +527,7 @@ static void computeImportForFunction(
         // update failure info if requested.
         if (PreviouslyVisited) {
           ProcessedThreshold = NewThreshold;
-          if (PrintImportFailures) {
+          if (shouldTrackImportFailures()) {
             assert(FailureInfo &&
                    "Expected FailureInfo for previously rejected candidate");
             FailureInfo->Reason = Reason;
@@ -447,7 +535,7 @@ static void computeImportForFunction(
             FailureInfo->MaxHotness =
                 std::max(FailureInfo->MaxHotness, Edge.second.getHotness());
           }
-        } else if (PrintImportFailures) {
+        } else if (shouldTrackImportFailures()) {
           assert(!FailureInfo &&
                  "Expected no FailureInfo for newly rejected candidate");
           FailureInfo = std::make_unique<FunctionImporter::ImportFailureInfo>(
@@ -465,40 +553,8 @@ static void computeImportForFunction(
       assert(ResolvedCalleeSummary->instCount() <= NewThreshold &&
              "selectCallee() didn't honor the threshold");
 
-      auto ExportModulePath = ResolvedCalleeSummary->modulePath();
-      auto ILI = ImportList[ExportModulePath].insert(VI.getGUID());
-      // We previously decided to import this GUID definition if it was already
-      // inserted in the set of imports from the exporting module.
-      bool PreviouslyImported = !ILI.second;
-      if (!PreviouslyImported) {
-        NumImportedFunctionsThinLink++;
-        if (IsHotCallsite)
-          NumImportedHotFunctionsThinLink++;
-        if (IsCriticalCallsite)
-          NumImportedCriticalFunctionsThinLink++;
-      }
-
-      // Make exports in the source module.
-      if (ExportLists) {
-        auto &ExportList = (*ExportLists)[ExportModulePath];
-        ExportList.insert(VI.getGUID());
-        if (!PreviouslyImported) {
-          // This is the first time this function was exported from its source
-          // module, so mark all functions and globals it references as exported
-          // to the outside if they are defined in the same source module.
-          // For efficiency, we unconditionally add all the referenced GUIDs
-          // to the ExportList for this module, and will prune out any not
-          // defined in the module later in a single pass.
-          for (auto &Edge : ResolvedCalleeSummary->calls()) {
-            auto CalleeGUID = Edge.first.getGUID();
-            ExportList.insert(CalleeGUID);
-          }
-          for (auto &Ref : ResolvedCalleeSummary->refs()) {
-            auto GUID = Ref.getGUID();
-            ExportList.insert(GUID);
-          }
-        }
-      }
+      addImport(*ResolvedCalleeSummary, VI.getGUID(), Edge.second.getHotness(),
+                ImportList, ExportLists);
     }
 
     auto GetAdjustedThreshold = [](unsigned Threshold, bool IsHotCallsite) {
@@ -519,13 +575,157 @@ static void computeImportForFunction(
   }
 }
 
+static void printImportFailure(const ValueInfo &VI,
+                               FunctionImporter::ImportFailureReason Reason,
+                               unsigned Threshold,
+                               CalleeInfo::HotnessType MaxHotness,
+                               unsigned Attempts) {
+  FunctionSummary *FS = nullptr;
+  if (!VI.getSummaryList().empty())
+    FS = dyn_cast<FunctionSummary>(VI.getSummaryList()[0]->getBaseObject());
+  dbgs() << VI << ": Reason = " << getFailureName(Reason)
+         << ", Threshold = " << Threshold
+         << ", Size = " << (FS ? (int)FS->instCount() : -1)
+         << ", MaxHotness = " << getHotnessName(MaxHotness)
+         << ", Attempts = " << Attempts << "\n";
+}
+
+/// Compute the imports of a module greedily, within a budget of imported
+/// instructions. The callees of the functions of the module, and of the
+/// functions imported into it, are imported by decreasing score as long as
+/// they fit in what is left of the budget. The score of a callee is the
+/// hotness multiplier and the relative block frequency of the call divided by
+/// the size of the callee, decayed by the evolution factors for each level of
+/// imported callers.
+static void computeBudgetedImportForModule(
+    const GVSummaryMapTy &DefinedGVSummaries, const ModuleSummaryIndex &Index,
+    StringRef ModName, FunctionImporter::ImportMapTy &ImportList,
+    StringMap<FunctionImporter::ExportSetTy> *ExportLists,
+    std::vector<ImportDecision> *Decisions) {
+  struct Candidate {
+    float Score;
+    // What the scores of the callees of the candidate are multiplied by.
+    float Factor;
+    ValueInfo VI;
+    const FunctionSummary *Summary;
+    CalleeInfo::HotnessType Hotness;
+  };
+  // Break ties by GUID so that the imports do not depend on the order of the
+  // summaries.
+  auto LowerScore = [](const Candidate &A, const Candidate &B) {
+    if (A.Score != B.Score)
+      return A.Score < B.Score;
+    return A.VI.getGUID() > B.VI.getGUID();
+  };
+  std::priority_queue<Candidate, std::vector<Candidate>, decltype(LowerScore)>
+      Queue(LowerScore);
+  // The callees already considered. A decision is final once the callee is
+  // imported or rejected, i.e. once its Summary or Reason is set.
+  DenseMap<GlobalValue::GUID, ImportDecision> Considered;
+  unsigned Remaining = ImportModuleBudget;
+
+  auto AddCallees = [&](const FunctionSummary &Caller, float Factor) {
+    computeImportForReferencedGlobals(Caller, DefinedGVSummaries, ImportList,
+                                      ExportLists);
+    for (auto &Edge : Caller.calls()) {
+      ValueInfo VI = updateValueInfoForIndirectCalls(Index, Edge.first);
+      if (!VI || DefinedGVSummaries.count(VI.getGUID()))
+        continue;
+      CalleeInfo::HotnessType Hotness = Edge.second.getHotness();
+      auto It = Considered.insert(
+          {VI.getGUID(),
+           {VI, nullptr, FunctionImporter::ImportFailureReason::None, Hotness,
+            Remaining, 0, 0}});
+      ImportDecision &D = It.first->second;
+      D.Hotness = std::max(D.Hotness, Hotness);
+      D.Attempts++;
+      if (D.Summary || D.Reason != FunctionImporter::ImportFailureReason::None)
+        continue;
+
+      float Weight = getBonusMultiplier(Hotness) *
+                     (1 + float(Edge.second.RelBlockFreq) /
+                              (1 << CalleeInfo::ScaleShift));
+      if (Weight <= 0) {
+        // Like a threshold of 0 in the default mode, e.g. for cold calls.
+        D.Reason = FunctionImporter::ImportFailureReason::TooLarge;
+        D.Threshold = 0;
+        continue;
+      }
+      FunctionImporter::ImportFailureReason Reason;
+      const GlobalValueSummary *CalleeSummary =
+          selectCallee(Index, VI.getSummaryList(), Remaining,
+                       Caller.modulePath(), Reason, VI.getGUID());
+      if (!CalleeSummary) {
+        if (Reason == FunctionImporter::ImportFailureReason::TooLarge)
+          Reason = FunctionImporter::ImportFailureReason::OverBudget;
+        D.Reason = Reason;
+        D.Threshold = Remaining;
+        continue;
+      }
+      auto *Summary = cast<FunctionSummary>(CalleeSummary->getBaseObject());
+      Queue.push({Weight * Factor / std::max(1u, Summary->instCount()), Factor,
+                  VI, Summary, Hotness});
+    }
+  };
+
+  for (auto &GVSummary : DefinedGVSummaries) {
+    if (!Index.isGlobalValueLive(GVSummary.second))
+      continue;
+    if (auto *FuncSummary =
+            dyn_cast<FunctionSummary>(GVSummary.second->getBaseObject()))
+      AddCallees(*FuncSummary, 1.0);
+  }
+
+  while (!Queue.empty()) {
+    Candidate C = Queue.top();
+    Queue.pop();
+    ImportDecision &D = Considered.find(C.VI.getGUID())->second;
+    if (D.Summary || D.Reason != FunctionImporter::ImportFailureReason::None)
+      continue;
+    D.Threshold = Remaining;
+    if (C.Summary->instCount() > Remaining) {
+      D.Reason = FunctionImporter::ImportFailureReason::OverBudget;
+      continue;
+    }
+    LLVM_DEBUG(dbgs() << "Import " << C.VI << " with score " << C.Score
+                      << " and budget " << Remaining << "\n");
+    Remaining -= C.Summary->instCount();
+    D.Summary = C.Summary;
+    D.Score = C.Score;
+    addImport(*C.Summary, C.VI.getGUID(), C.Hotness, ImportList, ExportLists);
+    AddCallees(*C.Summary,
+               C.Factor * (C.Hotness == CalleeInfo::HotnessType::Hot
+                               ? ImportHotInstrFactor
+                               : ImportInstrFactor));
+  }
+
+  if (PrintImportFailures) {
+    dbgs() << "Missed imports into module " << ModName << "\n";
+    for (auto &I : Considered)
+      if (!I.second.Summary)
+        printImportFailure(I.second.VI, I.second.Reason, I.second.Threshold,
+                           I.second.Hotness, I.second.Attempts);
+  }
+  if (Decisions)
+    for (auto &I : Considered)
+      Decisions->push_back(I.second);
+}
+
 /// Given the list of globals defined in a module, compute the list of imports
 /// as well as the list of "exports", i.e. the list of symbols referenced from
-/// another module (that may require promotion).
+/// another module (that may require promotion). The decisions made for the
+/// callees that were considered are added to \p Decisions if not null.
 static void ComputeImportForModule(
     const GVSummaryMapTy &DefinedGVSummaries, const ModuleSummaryIndex &Index,
     StringRef ModName, FunctionImporter::ImportMapTy &ImportList,
-    StringMap<FunctionImporter::ExportSetTy> *ExportLists = nullptr) {
+    StringMap<FunctionImporter::ExportSetTy> *ExportLists = nullptr,
+    std::vector<ImportDecision> *Decisions = nullptr) {
+  if (ImportModuleBudget) {
+    computeBudgetedImportForModule(DefinedGVSummaries, Index, ModName,
+                                   ImportList, ExportLists, Decisions);
+    return;
+  }
+
   // Worklist contains the list of function imported in this module, for which
   // we will analyse the callees and may import further down the callgraph.
   SmallVector<EdgeInfo, 128> Worklist;
@@ -576,20 +776,105 @@ static void ComputeImportForModule(
       if (CalleeSummary)
         continue; // We are going to import.
       assert(FailureInfo);
-      FunctionSummary *FS = nullptr;
-      if (!FailureInfo->VI.getSummaryList().empty())
-        FS = dyn_cast<FunctionSummary>(
-            FailureInfo->VI.getSummaryList()[0]->getBaseObject());
-      dbgs() << FailureInfo->VI
-             << ": Reason = " << getFailureName(FailureInfo->Reason)
-             << ", Threshold = " << ProcessedThreshold
-             << ", Size = " << (FS ? (int)FS->instCount() : -1)
-             << ", MaxHotness = " << getHotnessName(FailureInfo->MaxHotness)
-             << ", Attempts = " << FailureInfo->Attempts << "\n";
+      printImportFailure(FailureInfo->VI, FailureInfo->Reason,
+                         ProcessedThreshold, FailureInfo->MaxHotness,
+                         FailureInfo->Attempts);
+    }
+  }
+
+  if (Decisions) {
+    for (auto &I : ImportThresholds) {
+      auto &ProcessedThreshold = std::get<0>(I.second);
+      auto &CalleeSummary = std::get<1>(I.second);
+      auto &FailureInfo = std::get<2>(I.second);
+      if (CalleeSummary) {
+        Decisions->push_back({Index.getValueInfo(I.first),
+                              cast<FunctionSummary>(CalleeSummary),
+                              FunctionImporter::ImportFailureReason::None,
+                              CalleeInfo::HotnessType::Unknown,
+                              ProcessedThreshold, 0, 0});
+        continue;
+      }
+      assert(FailureInfo);
+      Decisions->push_back({FailureInfo->VI, nullptr, FailureInfo->Reason,
+                            FailureInfo->MaxHotness, ProcessedThreshold, 0,
+                            FailureInfo->Attempts});
     }
   }
 }
 
+/// Write the decisions of the thin link to import functions into each module
+/// or not to the file of -import-report.
+static void writeImportReport(
+    ArrayRef<std::pair<StringRef, std::vector<ImportDecision> *>> Modules) {
+  ExitOnError ExitOnErr("-import-report: " + ImportReport + ": ");
+  std::error_code EC;
+  raw_fd_ostream OS(ImportReport, EC, sys::fs::OF_Text);
+  ExitOnErr(errorCodeToError(EC));
+
+  auto WriteFunction = [](json::OStream &J, const ImportDecision &D,
+                          const FunctionSummary *FS) {
+    J.attribute("name", D.VI.name());
+    J.attribute("guid", std::to_string(D.VI.getGUID()));
+    if (FS)
+      J.attribute("instrs", int64_t(FS->instCount()));
+    J.attribute("hotness", getHotnessName(D.Hotness));
+    J.attribute("threshold", int64_t(D.Threshold));
+  };
+
+  json::OStream J(OS, 2);
+  J.object([&] {
+    if (ImportModuleBudget)
+      J.attribute("budget", int64_t(ImportModuleBudget));
+    J.attributeArray("modules", [&] {
+      for (auto &M : Modules) {
+        std::vector<ImportDecision> &Decisions = *M.second;
+        llvm::sort(Decisions,
+                   [](const ImportDecision &A, const ImportDecision &B) {
+                     return A.VI.getGUID() < B.VI.getGUID();
+                   });
+        uint64_t ImportedInstrs = 0;
+        for (const ImportDecision &D : Decisions)
+          if (D.Summary)
+            ImportedInstrs += D.Summary->instCount();
+
+        J.object([&] {
+          J.attribute("module", M.first);
+          J.attribute("imported_instrs", int64_t(ImportedInstrs));
+          J.attributeArray("imports", [&] {
+            for (const ImportDecision &D : Decisions) {
+              if (!D.Summary)
+                continue;
+              J.object([&] {
+                WriteFunction(J, D, D.Summary);
+                J.attribute("from", D.Summary->modulePath());
+                if (ImportModuleBudget)
+                  J.attribute("score", D.Score);
+              });
+            }
+          });
+          J.attributeArray("rejected", [&] {
+            for (const ImportDecision &D : Decisions) {
+              if (D.Summary)
+                continue;
+              const FunctionSummary *FS = nullptr;
+              if (!D.VI.getSummaryList().empty())
+                FS = dyn_cast<FunctionSummary>(
+                    D.VI.getSummaryList()[0]->getBaseObject());
+              J.object([&] {
+                WriteFunction(J, D, FS);
+                J.attribute("reason", getFailureName(D.Reason));
+                J.attribute("attempts", int64_t(D.Attempts));
+              });
+            }
+          });
+        });
+      }
+    });
+  });
+  OS << "\n";
+}
+
 #ifndef NDEBUG
 static bool isGlobalVarSummary(const ModuleSummaryIndex &Index,
                                GlobalValue::GUID G) {
@@ -621,29 +906,70 @@ void llvm::ComputeCrossModuleImport(
     StringMap<FunctionImporter::ImportMapTy> &ImportLists,
     StringMap<FunctionImporter::ExportSetTy> &ExportLists) {
   // For each module that has function defined, compute the import/export lists.
-  for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries) {
-    auto &ImportList = ImportLists[DefinedGVSummaries.first()];
-    LLVM_DEBUG(dbgs() << "Computing import for Module '"
-                      << DefinedGVSummaries.first() << "'\n");
-    ComputeImportForModule(DefinedGVSummaries.second, Index,
-                           DefinedGVSummaries.first(), ImportList,
-                           &ExportLists);
+  // Each module only reads the index, so their imports are computed in
+  // parallel, with the exports they cause recorded separately for each module
+  // and merged in a deterministic order afterwards.
+  struct ModuleImports {
+    StringRef ModulePath;
+    const GVSummaryMapTy *DefinedGVSummaries;
+    FunctionImporter::ImportMapTy *ImportList;
+    StringMap<FunctionImporter::ExportSetTy> ExportLists;
+    std::vector<ImportDecision> Decisions;
+  };
+  std::vector<ModuleImports> Modules;
+  Modules.reserve(ModuleToDefinedGVSummaries.size());
+  for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries)
+    Modules.push_back({DefinedGVSummaries.first(), &DefinedGVSummaries.second,
+                       &ImportLists[DefinedGVSummaries.first()], {}, {}});
+
+  auto ComputeModuleImports = [&](ModuleImports &M) {
+    LLVM_DEBUG(dbgs() << "Computing import for Module '" << M.ModulePath
+                      << "'\n");
+    ComputeImportForModule(*M.DefinedGVSummaries, Index, M.ModulePath,
+                           *M.ImportList, &M.ExportLists,
+                           ImportReport.empty() ? nullptr : &M.Decisions);
+
+    // When computing imports we added all GUIDs referenced by anything
+    // imported from the module to its ExportList. Now we prune each ExportList
+    // of any not defined in that module. This is more efficient than checking
+    // while computing imports because some of the summary lists may be long
+    // due to linkonce (comdat) copies.
+    for (auto &ELI : M.ExportLists) {
+      auto DefinedIt = ModuleToDefinedGVSummaries.find(ELI.first());
+      for (auto EI = ELI.second.begin(); EI != ELI.second.end();) {
+        if (DefinedIt == ModuleToDefinedGVSummaries.end() ||
+            !DefinedIt->second.count(*EI))
+          EI = ELI.second.erase(EI);
+        else
+          ++EI;
+      }
+    }
+  };
+
+  // Debugging output and -import-cutoff depend on the order of the imports.
+  if (DebugFlag || PrintImportFailures || ImportCutoff >= 0 ||
+      ImportThreads == 1 || Modules.size() < 2) {
+    for (ModuleImports &M : Modules)
+      ComputeModuleImports(M);
+  } else {
+    ThreadPool Pool(hardware_concurrency_strategy(ImportThreads));
+    for (ModuleImports &M : Modules)
+      Pool.async(ComputeModuleImports, std::ref(M));
+    Pool.wait();
   }
 
-  // When computing imports we added all GUIDs referenced by anything
-  // imported from the module to its ExportList. Now we prune each ExportList
-  // of any not defined in that module. This is more efficient than checking
-  // while computing imports because some of the summary lists may be long
-  // due to linkonce (comdat) copies.
-  for (auto &ELI : ExportLists) {
-    const auto &DefinedGVSummaries =
-        ModuleToDefinedGVSummaries.lookup(ELI.first());
-    for (auto EI = ELI.second.begin(); EI != ELI.second.end();) {
-      if (!DefinedGVSummaries.count(*EI))
-        EI = ELI.second.erase(EI);
-      else
-        ++EI;
-    }
+  for (ModuleImports &M : Modules) {
+    for (auto &ELI : M.ExportLists)
+      ExportLists[ELI.first()].insert(ELI.second.begin(), ELI.second.end());
+    M.ExportLists.clear();
+  }
+
+  if (!ImportReport.empty()) {
+    std::vector<std::pair<StringRef, std::vector<ImportDecision> *>> Reports;
+    for (ModuleImports &M : Modules)
+      Reports.push_back({M.ModulePath, &M.Decisions});
+    llvm::sort(Reports, less_first());
+    writeImportReport(Reports);
   }
 
 #ifndef NDEBUG
@@ -84,6 +84,17 @@ static cl::opt<int>
                        cl::desc("Base penalty for splitting cold code (as a "
                                 "multiple of TCC_Basic)"));
 
+static cl::opt<bool> EnableColdSection(
+    "enable-cold-section", cl::init(false), cl::Hidden,
+    cl::desc("Place the functions extracted by hot-cold splitting in a "
+             "separate section instead of the unlikely text section"));
+
+static cl::opt<std::string>
+    ColdSectionName("hotcoldsplit-cold-section-name", cl::init(".text.split"),
+                    cl::Hidden,
+                    cl::desc("Name of the section that contains the functions "
+                             "extracted by hot-cold splitting"));
+
 namespace {
 // Same as blockEndsInUnreachable in CodeGen/BranchFolding.cpp. Do not modify
 // this function unless you modify the MBB version as well.
@@ -328,6 +339,17 @@ Function *HotColdSplitting::extractColdRegion(
 
     markFunctionCold(*OutF, BFI != nullptr);
 
+    // Keep the cold code away from the hot code. A function in an explicit
+    // section keeps its cold code with it. Otherwise the cold code goes to
+    // the unlikely text section, which the linker groups separately from the
+    // hot text, even without a profile that would put it there.
+    if (OrigF->hasSection())
+      OutF->setSection(OrigF->getSection());
+    else if (EnableColdSection)
+      OutF->setSection(ColdSectionName);
+    else
+      OutF->setSectionPrefix(".unlikely");
+
     LLVM_DEBUG(llvm::dbgs() << "Outlined Region: " << *OutF);
     ORE.emit([&]() {
       return OptimizationRemark(DEBUG_TYPE, "HotColdSplit",
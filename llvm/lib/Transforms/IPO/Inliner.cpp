@@ -82,6 +82,10 @@ STATISTIC(NumMergedAllocas, "Number of allocas merged together");
 // if those would be more profitable and blocked inline steps.
 STATISTIC(NumCallerCallersAnalyzed, "Number of caller-callers analyzed");
 
+STATISTIC(NumInlineCostCacheHits, "Number of inline costs found in the cache");
+STATISTIC(NumInlineCostCacheMisses,
+          "Number of inline costs computed for the cache");
+
 /// Flag to disable manual alloca merging.
 ///
 /// Merging of allocas was originally done as a stack-size saving technique
@@ -120,6 +124,81 @@ static cl::opt<bool>
                                    " callsites processed by inliner but decided"
                                    " to be not inlined"));
 
+static cl::opt<bool>
+    EnableInlineCostCache("inliner-cache-inline-cost", cl::init(true),
+                          cl::Hidden,
+                          cl::desc("Reuse the inline cost of a call site while "
+                                   "its caller and callee are unchanged"));
+
+namespace {
+
+/// Caches the inline costs of call sites during one run of the inliner.
+///
+/// The cost of a call site depends on its arguments, on the bodies of its
+/// caller and callee, and on the number of uses of the callee, so it can only
+/// be reused while none of these change. Each function has a version that the
+/// inliner bumps whenever it changes one of these, and each entry records the
+/// versions of the caller and callee it was computed for. Call sites are
+/// queried repeatedly when they are revisited after other calls were inlined
+/// and when deciding whether to defer inlining into their callee.
+class InlineCostCache {
+public:
+  /// Return the cost of \p CS, computing it with \p GetInlineCost if it is
+  /// not cached or its caller or callee changed since it was cached.
+  InlineCost get(CallSite CS,
+                 function_ref<InlineCost(CallSite CS)> GetInlineCost);
+
+  /// Invalidate the costs of the calls in and to \p F.
+  void invalidate(Function *F) {
+    if (F)
+      Versions[F] = ++LastVersion;
+  }
+
+private:
+  struct Entry {
+    Function *Caller;
+    Function *Callee;
+    unsigned CallerVersion;
+    unsigned CalleeVersion;
+    InlineCost Cost;
+  };
+
+  DenseMap<const Function *, unsigned> Versions;
+  DenseMap<const Instruction *, Entry> Entries;
+  unsigned LastVersion = 0;
+};
+
+} // end anonymous namespace
+
+InlineCost
+InlineCostCache::get(CallSite CS,
+                     function_ref<InlineCost(CallSite CS)> GetInlineCost) {
+  if (!EnableInlineCostCache)
+    return GetInlineCost(CS);
+
+  Function *Caller = CS.getCaller();
+  Function *Callee = CS.getCalledFunction();
+  unsigned CallerVersion = Versions.lookup(Caller);
+  unsigned CalleeVersion = Versions.lookup(Callee);
+  auto It = Entries.find(CS.getInstruction());
+  if (It != Entries.end() && It->second.Caller == Caller &&
+      It->second.Callee == Callee &&
+      It->second.CallerVersion == CallerVersion &&
+      It->second.CalleeVersion == CalleeVersion) {
+    ++NumInlineCostCacheHits;
+    return It->second.Cost;
+  }
+
+  ++NumInlineCostCacheMisses;
+  InlineCost IC = GetInlineCost(CS);
+  Entry E = {Caller, Callee, CallerVersion, CalleeVersion, IC};
+  if (It != Entries.end())
+    It->second = E;
+  else
+    Entries.insert({CS.getInstruction(), E});
+  return IC;
+}
+
 LegacyInlinerBase::LegacyInlinerBase(char &ID) : CallGraphSCCPass(ID) {}
 
 LegacyInlinerBase::LegacyInlinerBase(char &ID, bool InsertLifetime)
@@ -434,7 +513,7 @@ shouldInline(CallSite CS, function_ref<InlineCost(CallSite CS)> GetInlineCost,
   if (IC.isNever()) {
     LLVM_DEBUG(dbgs() << "    NOT Inlining " << inlineCostStr(IC)
                       << ", Call: " << *CS.getInstruction() << "\n");
-    ORE.emit([&]() {
+    ORE.emit(DEBUG_TYPE, Call->getParent(), [&]() {
       return OptimizationRemarkMissed(DEBUG_TYPE, "NeverInline", Call)
              << NV("Callee", Callee) << " not inlined into "
              << NV("Caller", Caller) << " because it should never be inlined "
@@ -446,7 +525,7 @@ shouldInline(CallSite CS, function_ref<InlineCost(CallSite CS)> GetInlineCost,
   if (!IC) {
     LLVM_DEBUG(dbgs() << "    NOT Inlining " << inlineCostStr(IC)
                       << ", Call: " << *CS.getInstruction() << "\n");
-    ORE.emit([&]() {
+    ORE.emit(DEBUG_TYPE, Call->getParent(), [&]() {
       return OptimizationRemarkMissed(DEBUG_TYPE, "TooCostly", Call)
              << NV("Callee", Callee) << " not inlined into "
              << NV("Caller", Caller) << " because too costly to inline " << IC;
@@ -459,7 +538,7 @@ shouldInline(CallSite CS, function_ref<InlineCost(CallSite CS)> GetInlineCost,
     LLVM_DEBUG(dbgs() << "    NOT Inlining: " << *CS.getInstruction()
                       << " Cost = " << IC.getCost()
                       << ", outer Cost = " << TotalSecondaryCost << '\n');
-    ORE.emit([&]() {
+    ORE.emit(DEBUG_TYPE, Call->getParent(), [&]() {
       return OptimizationRemarkMissed(DEBUG_TYPE, "IncreaseCostInOtherContexts",
                                       Call)
              << "Not inlining. Cost of inlining " << NV("Callee", Callee)
@@ -507,7 +586,7 @@ bool LegacyInlinerBase::runOnSCC(CallGraphSCC &SCC) {
 static void emit_inlined_into(OptimizationRemarkEmitter &ORE, DebugLoc &DLoc,
                               const BasicBlock *Block, const Function &Callee,
                               const Function &Caller, const InlineCost &IC) {
-  ORE.emit([&]() {
+  ORE.emit(DEBUG_TYPE, Block, [&]() {
     bool AlwaysInline = IC.isAlways();
     StringRef RemarkName = AlwaysInline ? "AlwaysInline" : "Inlined";
     return OptimizationRemark(DEBUG_TYPE, RemarkName, DLoc, Block)
@@ -606,6 +685,11 @@ inlineCallsImpl(CallGraphSCC &SCC, CallGraph &CG,
   InlinedArrayAllocasTy InlinedArrayAllocas;
   InlineFunctionInfo InlineInfo(&CG, &GetAssumptionCache, PSI);
 
+  InlineCostCache CostCache;
+  auto GetCachedInlineCost = [&](CallSite CS) {
+    return CostCache.get(CS, GetInlineCost);
+  };
+
   // Now that we have all of the call sites, loop over them and inline them if
   // it looks profitable to do so.
   bool Changed = false;
@@ -650,7 +734,7 @@ inlineCallsImpl(CallGraphSCC &SCC, CallGraph &CG,
       // just become a regular analysis dependency.
       OptimizationRemarkEmitter ORE(Caller);
 
-      Optional<InlineCost> OIC = shouldInline(CS, GetInlineCost, ORE);
+      Optional<InlineCost> OIC = shouldInline(CS, GetCachedInlineCost, ORE);
       // If the policy determines that we should inline this function,
       // delete the call instead.
       if (!OIC.hasValue()) {
@@ -676,6 +760,8 @@ inlineCallsImpl(CallGraphSCC &SCC, CallGraph &CG,
         CG[Caller]->removeCallEdgeFor(*cast<CallBase>(CS.getInstruction()));
         Instr->eraseFromParent();
         ++NumCallsDeleted;
+        CostCache.invalidate(Caller);
+        CostCache.invalidate(Callee);
       } else {
         // Get DebugLoc to report. CS will be invalid after Inliner.
         DebugLoc DLoc = CS->getDebugLoc();
@@ -699,6 +785,13 @@ inlineCallsImpl(CallGraphSCC &SCC, CallGraph &CG,
         }
         ++NumInlined;
 
+        // The caller changed, the callee lost a use, and the callees of the
+        // inlined calls gained one.
+        CostCache.invalidate(Caller);
+        CostCache.invalidate(Callee);
+        for (Value *Ptr : InlineInfo.InlinedCalls)
+          CostCache.invalidate(CallSite(Ptr).getCalledFunction());
+
         emit_inlined_into(ORE, DLoc, Block, *Callee, *Caller, *OIC);
 
         // If inlining this function gave us any new call sites, throw them
@@ -967,6 +1060,8 @@ PreservedAnalyses InlinerPass::run(LazyCallGraph::SCC &InitialC,
   // defer deleting these to make it easier to handle the call graph updates.
   SmallVector<Function *, 4> DeadFunctions;
 
+  InlineCostCache CostCache;
+
   // Loop forward over all of the calls. Note that we cannot cache the size as
   // inlining can introduce new calls that need to be processed.
   for (int i = 0; i < (int)Calls.size(); ++i) {
@@ -1017,6 +1112,9 @@ PreservedAnalyses InlinerPass::run(LazyCallGraph::SCC &InitialC,
                            CalleeTTI, GetAssumptionCache, {GetBFI}, PSI,
                            RemarksEnabled ? &ORE : nullptr);
     };
+    auto GetCachedInlineCost = [&](CallSite CS) {
+      return CostCache.get(CS, GetInlineCost);
+    };
 
     // Now process as many calls as we have within this caller in the sequnece.
     // We bail out as soon as the caller has to change so we can update the
@@ -1048,7 +1146,7 @@ PreservedAnalyses InlinerPass::run(LazyCallGraph::SCC &InitialC,
         continue;
       }
 
-      Optional<InlineCost> OIC = shouldInline(CS, GetInlineCost, ORE);
+      Optional<InlineCost> OIC = shouldInline(CS, GetCachedInlineCost, ORE);
       // Check whether we want to inline this callsite.
       if (!OIC.hasValue()) {
         setInlineRemark(CS, "deferred");
@@ -1088,6 +1186,13 @@ PreservedAnalyses InlinerPass::run(LazyCallGraph::SCC &InitialC,
       DidInline = true;
       InlinedCallees.insert(&Callee);
 
+      // The caller changed, the callee lost a use, and the callees of the
+      // inlined calls gained one.
+      CostCache.invalidate(&F);
+      CostCache.invalidate(&Callee);
+      for (CallSite &CS : IFI.InlinedCallSites)
+        CostCache.invalidate(CS.getCalledFunction());
+
       ++NumInlined;
 
       emit_inlined_into(ORE, DLoc, Block, Callee, F, *OIC);
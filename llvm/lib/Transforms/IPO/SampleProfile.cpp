@@ -1682,7 +1682,11 @@ bool SampleProfileLoader::doInitialization(Module &M) {
     return false;
   }
   Reader = std::move(ReaderOrErr.get());
-  Reader->collectFuncsToUse(M);
+  // Only the profiles of the functions in the module are read when the format
+  // allows it. Remapped names can't be matched against the module, so read
+  // all of the profiles when a remapping file is used.
+  if (RemappingFilename.empty())
+    Reader->collectFuncsToUse(M);
   ProfileIsValid = (Reader->read() == sampleprof_error::success);
   PSL = Reader->getProfileSymbolList();
 
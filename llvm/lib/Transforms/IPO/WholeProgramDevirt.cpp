@@ -87,6 +87,7 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/FunctionAttrs.h"
 #include "llvm/Transforms/Utils/Evaluator.h"
@@ -132,6 +133,12 @@ static cl::opt<bool>
                        cl::init(false), cl::ZeroOrMore,
                        cl::desc("Print index-based devirtualization messages"));
 
+static cl::opt<unsigned> ClIndexThreads(
+    "wholeprogramdevirt-index-threads", cl::Hidden, cl::init(0),
+    cl::desc("Number of threads to find the targets of the virtual calls of "
+             "index-based devirtualization with, or 0 for one per hardware "
+             "thread"));
+
 // Find the minimum offset that we may store a value of size Size bits at. If
 // IsAfter is set, look for an offset before the object, otherwise look for an
 // offset after the object.
@@ -602,7 +609,7 @@ struct DevirtIndex {
         LocalWPDTargetsMap(LocalWPDTargetsMap) {}
 
   bool tryFindVirtualCallTargets(std::vector<ValueInfo> &TargetsForSlot,
-                                 const TypeIdCompatibleVtableInfo TIdInfo,
+                                 const TypeIdCompatibleVtableInfo &TIdInfo,
                                  uint64_t ByteOffset);
 
   bool trySingleImplDevirt(MutableArrayRef<ValueInfo> TargetsForSlot,
@@ -874,9 +881,9 @@ bool DevirtModule::tryFindVirtualCallTargets(
 }
 
 bool DevirtIndex::tryFindVirtualCallTargets(
-    std::vector<ValueInfo> &TargetsForSlot, const TypeIdCompatibleVtableInfo TIdInfo,
-    uint64_t ByteOffset) {
-  for (const TypeIdOffsetVtableInfo P : TIdInfo) {
+    std::vector<ValueInfo> &TargetsForSlot,
+    const TypeIdCompatibleVtableInfo &TIdInfo, uint64_t ByteOffset) {
+  for (const TypeIdOffsetVtableInfo &P : TIdInfo) {
     // VTable initializer should have only one summary, or all copies must be
     // linkonce/weak ODR.
     assert(P.VTableVI.getSummaryList().size() == 1 ||
@@ -889,12 +896,9 @@ bool DevirtIndex::tryFindVirtualCallTargets(
     const auto *VS = cast<GlobalVarSummary>(P.VTableVI.getSummaryList()[0].get());
     if (!P.VTableVI.getSummaryList()[0]->isLive())
       continue;
-    for (auto VTP : VS->vTableFuncs()) {
-      if (VTP.VTableOffset != P.AddressPointOffset + ByteOffset)
-        continue;
-
+    for (const VirtFuncOffset &VTP :
+         VS->vTableFuncsAt(P.AddressPointOffset + ByteOffset))
       TargetsForSlot.push_back(VTP.FuncVI);
-    }
   }
 
   // Give up if we couldn't find any targets.
@@ -1989,17 +1993,37 @@ void DevirtIndex::run() {
     }
   }
 
+  // For each (type, offset) pair, search each of the members of the type
+  // identifier for the virtual function implementation at offset
+  // ByteOffset. This only reads the index, so the slots are searched in
+  // parallel, in batches to amortize the cost of a task.
+  std::vector<std::vector<ValueInfo>> TargetsForSlots(CallSlots.size());
+  auto FindTargets = [&](size_t Begin, size_t End) {
+    for (size_t I = Begin; I != End; ++I) {
+      const VTableSlotSummary &Slot = CallSlots.begin()[I].first;
+      auto TidSummary =
+          ExportSummary.typeIdCompatibleVtableMap().find(Slot.TypeID);
+      assert(TidSummary != ExportSummary.typeIdCompatibleVtableMap().end());
+      tryFindVirtualCallTargets(TargetsForSlots[I], TidSummary->second,
+                                Slot.ByteOffset);
+    }
+  };
+  const size_t BatchSize = 256;
+  if (ClIndexThreads == 1 || CallSlots.size() <= BatchSize) {
+    FindTargets(0, CallSlots.size());
+  } else {
+    ThreadPool Pool(hardware_concurrency_strategy(ClIndexThreads));
+    for (size_t I = 0; I < CallSlots.size(); I += BatchSize)
+      Pool.async(FindTargets, I, std::min(I + BatchSize, CallSlots.size()));
+    Pool.wait();
+  }
+
+  // Resolve the slots in order, since that updates the index.
   std::set<ValueInfo> DevirtTargets;
-  // For each (type, offset) pair:
-  for (auto &S : CallSlots) {
-    // Search each of the members of the type identifier for the virtual
-    // function implementation at offset S.first.ByteOffset, and add to
-    // TargetsForSlot.
-    std::vector<ValueInfo> TargetsForSlot;
-    auto TidSummary = ExportSummary.getTypeIdCompatibleVtableSummary(S.first.TypeID);
-    assert(TidSummary);
-    if (tryFindVirtualCallTargets(TargetsForSlot, *TidSummary,
-                                  S.first.ByteOffset)) {
+  for (size_t I = 0, E = CallSlots.size(); I != E; ++I) {
+    auto &S = CallSlots.begin()[I];
+    std::vector<ValueInfo> &TargetsForSlot = TargetsForSlots[I];
+    if (!TargetsForSlot.empty()) {
       WholeProgramDevirtResolution *Res =
           &ExportSummary.getOrInsertTypeIdSummary(S.first.TypeID)
                .WPDRes[S.first.ByteOffset];
@@ -252,6 +252,13 @@ static cl::opt<uint32_t> ClMaxInlinePoisoningSize(
         "Inline shadow poisoning for blocks up to the given size in bytes."),
     cl::Hidden, cl::init(64));
 
+static cl::opt<uint32_t> ClMaxInlinePoisoningStoreSize(
+    "asan-max-inline-poisoning-store-size",
+    cl::desc("Largest store in bytes used to poison stack shadow inline, or 0 "
+             "to use 16 byte vector stores on targets that always have them "
+             "and pointer-sized stores elsewhere."),
+    cl::Hidden, cl::init(0));
+
 static cl::opt<bool> ClUseAfterReturn("asan-use-after-return",
                                       cl::desc("Check stack-use-after-return"),
                                       cl::Hidden, cl::init(true));
@@ -2796,8 +2803,14 @@ void FunctionStackPoisoner::copyToShadowInline(ArrayRef<uint8_t> ShadowMask,
   if (Begin >= End)
     return;
 
-  const size_t LargestStoreSizeInBytes =
-      std::min<size_t>(sizeof(uint64_t), ASan.LongSize / 8);
+  size_t LargestStoreSizeInBytes = ClMaxInlinePoisoningStoreSize;
+  if (!LargestStoreSizeInBytes || !isPowerOf2_64(LargestStoreSizeInBytes)) {
+    // SSE2 and NEON are part of the base x86-64 and AArch64 ISAs.
+    Triple::ArchType Arch = ASan.TargetTriple.getArch();
+    LargestStoreSizeInBytes = Arch == Triple::x86_64 || Arch == Triple::aarch64
+                                  ? 16
+                                  : ASan.LongSize / 8;
+  }
 
   const bool IsLittleEndian = F.getParent()->getDataLayout().isLittleEndian();
 
@@ -2823,16 +2836,24 @@ void FunctionStackPoisoner::copyToShadowInline(ArrayRef<uint8_t> ShadowMask,
         StoreSizeInBytes /= 2;
     }
 
-    uint64_t Val = 0;
-    for (size_t j = 0; j < StoreSizeInBytes; j++) {
-      if (IsLittleEndian)
-        Val |= (uint64_t)ShadowBytes[i + j] << (8 * j);
-      else
-        Val = (Val << 8) | ShadowBytes[i + j];
+    Value *Poison;
+    if (StoreSizeInBytes > sizeof(uint64_t)) {
+      // Wider than any integer store, use a byte vector, whose layout doesn't
+      // depend on endianness.
+      Poison = ConstantDataVector::get(*C,
+                                       ShadowBytes.slice(i, StoreSizeInBytes));
+    } else {
+      uint64_t Val = 0;
+      for (size_t j = 0; j < StoreSizeInBytes; j++) {
+        if (IsLittleEndian)
+          Val |= (uint64_t)ShadowBytes[i + j] << (8 * j);
+        else
+          Val = (Val << 8) | ShadowBytes[i + j];
+      }
+      Poison = IRB.getIntN(StoreSizeInBytes * 8, Val);
     }
 
     Value *Ptr = IRB.CreateAdd(ShadowBase, ConstantInt::get(IntptrTy, i));
-    Value *Poison = IRB.getIntN(StoreSizeInBytes * 8, Val);
     IRB.CreateAlignedStore(
         Poison, IRB.CreateIntToPtr(Ptr, Poison->getType()->getPointerTo()), 1);
 
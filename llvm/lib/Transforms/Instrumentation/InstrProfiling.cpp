@@ -35,6 +35,7 @@
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Type.h"
 #include "llvm/Pass.h"
@@ -108,6 +109,25 @@ cl::opt<bool> AtomicCounterUpdatePromoted(
              " for promoted counters only"),
     cl::init(false));
 
+// The runtime can only keep the counters in a mapping of the profile file
+// (continuous mode) when the instrumented code accesses them through a bias.
+cl::opt<bool> RuntimeCounterRelocation(
+    "runtime-counter-relocation", cl::ZeroOrMore,
+    cl::desc("Access the profile counters through a bias that the profile "
+             "runtime sets, so that it can relocate them"),
+    cl::init(false));
+
+// Updating a hot counter from many threads makes its cache line bounce between
+// the cores. With a period N greater than 1, each thread counts in its own
+// copy of the counters and adds N to the shared counter every N times it
+// reaches it. The counts that a thread hasn't added yet when the profile is
+// written are lost, so each counter can be short by up to N - 1 per thread.
+cl::opt<unsigned> CounterShardFlushPeriod(
+    "instrprof-counter-shard-period", cl::ZeroOrMore,
+    cl::desc("Count in thread-local copies of the profile counters and add "
+             "them to the counters every N increments (0 to disable)"),
+    cl::init(0));
+
 // If the option is not specified, the default behavior about whether
 // counter promotion is done depends on how instrumentaiton lowering
 // pipeline is setup, i.e., the default value of true of this option
@@ -164,7 +184,9 @@ public:
   }
 
   void getAnalysisUsage(AnalysisUsage &AU) const override {
-    AU.setPreservesCFG();
+    // Lowering the increments to per-thread counters adds blocks.
+    if (CounterShardFlushPeriod <= 1)
+      AU.setPreservesCFG();
     AU.addRequired<TargetLibraryInfoWrapperPass>();
   }
 };
@@ -407,25 +429,24 @@ static InstrProfIncrementInst *castToIncrementInst(Instruction *Instr) {
 }
 
 bool InstrProfiling::lowerIntrinsics(Function *F) {
-  bool MadeChange = false;
   PromotionCandidates.clear();
-  for (BasicBlock &BB : *F) {
-    for (auto I = BB.begin(), E = BB.end(); I != E;) {
-      auto Instr = I++;
-      InstrProfIncrementInst *Inc = castToIncrementInst(&*Instr);
-      if (Inc) {
-        lowerIncrement(Inc);
-        MadeChange = true;
-      } else if (auto *Ind = dyn_cast<InstrProfValueProfileInst>(Instr)) {
-        lowerValueProfileInst(Ind);
-        MadeChange = true;
-      }
-    }
-  }
-
-  if (!MadeChange)
+  // Collect the intrinsics first, lowering an increment may split its block.
+  SmallVector<IntrinsicInst *, 16> Intrinsics;
+  for (BasicBlock &BB : *F)
+    for (Instruction &I : BB)
+      if (castToIncrementInst(&I) || isa<InstrProfValueProfileInst>(I))
+        Intrinsics.push_back(cast<IntrinsicInst>(&I));
+
+  if (Intrinsics.empty())
     return false;
 
+  for (IntrinsicInst *I : Intrinsics) {
+    if (InstrProfIncrementInst *Inc = castToIncrementInst(I))
+      lowerIncrement(Inc);
+    else
+      lowerValueProfileInst(cast<InstrProfValueProfileInst>(I));
+  }
+
   promoteCounterLoadStores(F);
   return true;
 }
@@ -437,6 +458,14 @@ bool InstrProfiling::isCounterPromotionEnabled() const {
   return Options.DoCounterPromotion;
 }
 
+bool InstrProfiling::isRuntimeCounterRelocationEnabled() const {
+  return RuntimeCounterRelocation;
+}
+
+bool InstrProfiling::isCounterShardingEnabled() const {
+  return CounterShardFlushPeriod > 1;
+}
+
 void InstrProfiling::promoteCounterLoadStores(Function *F) {
   if (!isCounterPromotionEnabled())
     return;
@@ -496,6 +525,7 @@ bool InstrProfiling::run(
   NamesVar = nullptr;
   NamesSize = 0;
   ProfileDataMap.clear();
+  FunctionToProfileBiasMap.clear();
   UsedVars.clear();
   getMemOPSizeRangeFromOption(MemOPSizeRange, MemOPSizeRangeStart,
                               MemOPSizeRangeLast);
@@ -632,14 +662,48 @@ void InstrProfiling::lowerValueProfileInst(InstrProfValueProfileInst *Ind) {
   Ind->eraseFromParent();
 }
 
-void InstrProfiling::lowerIncrement(InstrProfIncrementInst *Inc) {
+Value *InstrProfiling::getCounterAddress(InstrProfIncrementInst *Inc) {
   GlobalVariable *Counters = getOrCreateRegionCounters(Inc);
 
   IRBuilder<> Builder(Inc);
   uint64_t Index = Inc->getIndex()->getZExtValue();
   Value *Addr = Builder.CreateConstInBoundsGEP2_64(Counters->getValueType(),
                                                    Counters, 0, Index);
+  if (!isRuntimeCounterRelocationEnabled())
+    return Addr;
+
+  Type *IntPtrTy = M->getDataLayout().getIntPtrType(M->getContext());
+  Function *Fn = Inc->getParent()->getParent();
+  LoadInst *&BiasLI = FunctionToProfileBiasMap[Fn];
+  if (!BiasLI) {
+    GlobalVariable *Bias =
+        M->getGlobalVariable(getInstrProfCounterBiasVarName());
+    if (!Bias) {
+      Bias = new GlobalVariable(
+          *M, IntPtrTy, false, GlobalValue::LinkOnceODRLinkage,
+          Constant::getNullValue(IntPtrTy), getInstrProfCounterBiasVarName());
+      Bias->setVisibility(GlobalVariable::HiddenVisibility);
+    }
+    IRBuilder<> EntryBuilder(&*Fn->getEntryBlock().getFirstInsertionPt());
+    BiasLI = EntryBuilder.CreateLoad(IntPtrTy, Bias, "profc_bias");
+  }
+  // Compute the address in the entry block as well, so that it dominates the
+  // updates that counter promotion sinks to the exits of loops.
+  IRBuilder<> BiasBuilder(BiasLI->getNextNode());
+  Value *Add =
+      BiasBuilder.CreateAdd(BiasBuilder.CreatePtrToInt(Addr, IntPtrTy), BiasLI);
+  return BiasBuilder.CreateIntToPtr(Add, Addr->getType());
+}
 
+void InstrProfiling::lowerIncrement(InstrProfIncrementInst *Inc) {
+  if (isCounterShardingEnabled()) {
+    lowerIncrementToShard(Inc);
+    return;
+  }
+
+  Value *Addr = getCounterAddress(Inc);
+
+  IRBuilder<> Builder(Inc);
   if (Options.Atomic || AtomicCounterUpdateAll) {
     Builder.CreateAtomicRMW(AtomicRMWInst::Add, Addr, Inc->getStep(),
                             AtomicOrdering::Monotonic);
@@ -654,6 +718,40 @@ void InstrProfiling::lowerIncrement(InstrProfIncrementInst *Inc) {
   Inc->eraseFromParent();
 }
 
+void InstrProfiling::lowerIncrementToShard(InstrProfIncrementInst *Inc) {
+  GlobalVariable *Shards = getOrCreateCounterShards(Inc);
+
+  IRBuilder<> Builder(Inc);
+  Type *Int32Ty = Builder.getInt32Ty();
+  uint64_t Index = Inc->getIndex()->getZExtValue();
+  Value *ShardAddr = Builder.CreateConstInBoundsGEP2_64(Shards->getValueType(),
+                                                        Shards, 0, Index);
+  Value *Shard = Builder.CreateLoad(Int32Ty, ShardAddr, "pgoshard");
+  Value *Count =
+      Builder.CreateAdd(Shard, Builder.CreateTrunc(Inc->getStep(), Int32Ty));
+  Value *IsFull =
+      Builder.CreateICmpUGE(Count, Builder.getInt32(CounterShardFlushPeriod));
+  Builder.CreateStore(Builder.CreateSelect(IsFull, Builder.getInt32(0), Count),
+                      ShardAddr);
+
+  // Only touch the shared counter when the thread-local one is full.
+  MDNode *Weights = MDBuilder(M->getContext())
+                        .createBranchWeights(1, CounterShardFlushPeriod - 1);
+  Instruction *ThenTerm =
+      SplitBlockAndInsertIfThen(IsFull, Inc, /*Unreachable=*/false, Weights);
+  Value *Addr = getCounterAddress(Inc);
+  Builder.SetInsertPoint(ThenTerm);
+  Value *Step = Builder.CreateZExt(Count, Inc->getStep()->getType());
+  if (Options.Atomic || AtomicCounterUpdateAll) {
+    Builder.CreateAtomicRMW(AtomicRMWInst::Add, Addr, Step,
+                            AtomicOrdering::Monotonic);
+  } else {
+    Value *Load = Builder.CreateLoad(Step->getType(), Addr, "pgocount");
+    Builder.CreateStore(Builder.CreateAdd(Load, Step), Addr);
+  }
+  Inc->eraseFromParent();
+}
+
 void InstrProfiling::lowerCoverageData(GlobalVariable *CoverageNamesVar) {
   ConstantArray *Names =
       cast<ConstantArray>(CoverageNamesVar->getInitializer());
@@ -686,6 +784,28 @@ static std::string getVarName(InstrProfIncrementInst *Inc, StringRef Prefix) {
   return (Prefix + Name + "." + Twine(FuncHash)).str();
 }
 
+GlobalVariable *
+InstrProfiling::getOrCreateCounterShards(InstrProfIncrementInst *Inc) {
+  // This creates the profile data of the function if needed.
+  getOrCreateRegionCounters(Inc);
+  PerFunctionProfileData &PD = ProfileDataMap[Inc->getName()];
+  if (PD.CounterShards)
+    return PD.CounterShards;
+
+  // The shards aren't part of the profile, so every module that has a copy of
+  // the function can have its own.
+  uint64_t NumCounters = Inc->getNumCounters()->getZExtValue();
+  ArrayType *ShardsTy =
+      ArrayType::get(Type::getInt32Ty(M->getContext()), NumCounters);
+  PD.CounterShards = new GlobalVariable(
+      *M, ShardsTy, false, GlobalValue::InternalLinkage,
+      Constant::getNullValue(ShardsTy),
+      getVarName(Inc, getInstrProfCounterShardsVarPrefix()), nullptr,
+      GlobalVariable::GeneralDynamicTLSModel);
+  PD.CounterShards->setAlignment(4);
+  return PD.CounterShards;
+}
+
 static inline bool shouldRecordFunctionAddr(Function *F) {
   // Check the linkage
   bool HasAvailableExternallyLinkage = F->hasAvailableExternallyLinkage();
@@ -28,7 +28,10 @@
 #include "llvm/Analysis/MemoryBuiltins.h"
 #include "llvm/Analysis/MemoryDependenceAnalysis.h"
 #include "llvm/Analysis/MemoryLocation.h"
+#include "llvm/Analysis/MemorySSA.h"
+#include "llvm/Analysis/MemorySSAUpdater.h"
 #include "llvm/Analysis/OrderedBasicBlock.h"
+#include "llvm/Analysis/PostDominators.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/Argument.h"
@@ -74,6 +77,8 @@ STATISTIC(NumFastStores, "Number of stores deleted");
 STATISTIC(NumFastOther, "Number of other instrs removed");
 STATISTIC(NumCompletePartials, "Number of stores dead by later partials");
 STATISTIC(NumModifiedStores, "Number of stores modified");
+STATISTIC(NumCrossBlockStores,
+          "Number of stores deleted because of a store in another block");
 
 static cl::opt<bool>
 EnablePartialOverwriteTracking("enable-dse-partial-overwrite-tracking",
@@ -85,6 +90,17 @@ EnablePartialStoreMerging("enable-dse-partial-store-merging",
   cl::init(true), cl::Hidden,
   cl::desc("Enable partial store merging in DSE"));
 
+static cl::opt<bool>
+    EnableMemorySSA("enable-dse-memoryssa", cl::init(false), cl::Hidden,
+                    cl::desc("Use the MemorySSA-based DSE, which also removes "
+                             "stores overwritten in other blocks"));
+
+static cl::opt<unsigned>
+    MemorySSAScanLimit("dse-memoryssa-scanlimit", cl::init(150), cl::Hidden,
+                       cl::desc("The number of memory accesses to walk past, "
+                                "or to check for reads of a store, in the "
+                                "MemorySSA-based DSE (default = 150)"));
+
 //===----------------------------------------------------------------------===//
 // Helper functions
 //===----------------------------------------------------------------------===//
@@ -1023,12 +1039,11 @@ static bool removePartiallyOverlappedStores(AliasAnalysis *AA,
   return Changed;
 }
 
-static bool eliminateNoopStore(Instruction *Inst, BasicBlock::iterator &BBI,
-                               AliasAnalysis *AA, MemoryDependenceResults *MD,
-                               const DataLayout &DL,
-                               const TargetLibraryInfo *TLI,
-                               InstOverlapIntervalsTy &IOL,
-                               OrderedBasicBlock &OBB) {
+/// Return true if \p Inst is a store that does not change memory: a store of
+/// a value loaded from the same pointer, or of null to calloc'ed memory, that
+/// is not modified in between.
+static bool isNoopStore(Instruction *Inst, AliasAnalysis *AA,
+                        const DataLayout &DL, const TargetLibraryInfo *TLI) {
   // Must be a store instruction.
   StoreInst *SI = dyn_cast<StoreInst>(Inst);
   if (!SI)
@@ -1043,9 +1058,6 @@ static bool eliminateNoopStore(Instruction *Inst, BasicBlock::iterator &BBI,
       LLVM_DEBUG(
           dbgs() << "DSE: Remove Store Of Load from same pointer:\n  LOAD: "
                  << *DepLoad << "\n  STORE: " << *SI << '\n');
-
-      deleteDeadInstruction(SI, &BBI, *MD, *TLI, IOL, OBB);
-      ++NumRedundantStores;
       return true;
     }
   }
@@ -1061,15 +1073,26 @@ static bool eliminateNoopStore(Instruction *Inst, BasicBlock::iterator &BBI,
       LLVM_DEBUG(
           dbgs() << "DSE: Remove null store to the calloc'ed object:\n  DEAD: "
                  << *Inst << "\n  OBJECT: " << *UnderlyingPointer << '\n');
-
-      deleteDeadInstruction(SI, &BBI, *MD, *TLI, IOL, OBB);
-      ++NumRedundantStores;
       return true;
     }
   }
   return false;
 }
 
+static bool eliminateNoopStore(Instruction *Inst, BasicBlock::iterator &BBI,
+                               AliasAnalysis *AA, MemoryDependenceResults *MD,
+                               const DataLayout &DL,
+                               const TargetLibraryInfo *TLI,
+                               InstOverlapIntervalsTy &IOL,
+                               OrderedBasicBlock &OBB) {
+  if (!isNoopStore(Inst, AA, DL, TLI))
+    return false;
+
+  deleteDeadInstruction(Inst, &BBI, *MD, *TLI, IOL, OBB);
+  ++NumRedundantStores;
+  return true;
+}
+
 static bool eliminateDeadStores(BasicBlock &BB, AliasAnalysis *AA,
                                 MemoryDependenceResults *MD, DominatorTree *DT,
                                 const TargetLibraryInfo *TLI) {
@@ -1322,22 +1345,275 @@ static bool eliminateDeadStores(Function &F, AliasAnalysis *AA,
   return MadeChange;
 }
 
+//===----------------------------------------------------------------------===//
+// MemorySSA-based DSE
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// Dead store elimination over MemorySSA. A store is dead if a later write that
+/// post-dominates it overwrites its location and nothing may read the location
+/// in between, even if the two are in different blocks, or if it writes to a
+/// stack object that is never read afterwards. Unlike MemoryDependenceAnalysis,
+/// MemorySSA is kept up to date, so later passes reuse its clobber walks.
+class MemorySSADSE {
+  Function &F;
+  AliasAnalysis &AA;
+  MemorySSA &MSSA;
+  PostDominatorTree &PDT;
+  const TargetLibraryInfo &TLI;
+  const DataLayout &DL;
+  MemorySSAUpdater MSSAU;
+
+  /// The reachable instructions with an analyzable memory write, in block
+  /// order.
+  SmallVector<Instruction *, 64> Writes;
+  SmallPtrSet<Instruction *, 32> Deleted;
+  bool AnyMayThrow = false;
+
+public:
+  MemorySSADSE(Function &F, AliasAnalysis &AA, MemorySSA &MSSA,
+               DominatorTree &DT, PostDominatorTree &PDT,
+               const TargetLibraryInfo &TLI)
+      : F(F), AA(AA), MSSA(MSSA), PDT(PDT), TLI(TLI),
+        DL(F.getParent()->getDataLayout()), MSSAU(&MSSA) {
+    for (BasicBlock &BB : F) {
+      // Dead blocks may have strange pointer cycles that will confuse alias
+      // analysis.
+      if (!DT.isReachableFromEntry(&BB))
+        continue;
+      for (Instruction &I : BB) {
+        AnyMayThrow |= I.mayThrow();
+        if (hasAnalyzableMemoryWrite(&I, TLI) &&
+            isa_and_nonnull<MemoryDef>(MSSA.getMemoryAccess(&I)))
+          Writes.push_back(&I);
+      }
+    }
+  }
+
+  bool run() {
+    bool MadeChange = false;
+    for (Instruction *I : Writes) {
+      if (Deleted.count(I))
+        continue;
+      if (isNoopStore(I, &AA, DL, &TLI)) {
+        deleteDeadInstruction(I);
+        ++NumRedundantStores;
+        MadeChange = true;
+        continue;
+      }
+      MadeChange |= eliminateOverwrittenBy(I);
+    }
+
+    // Stores to stack objects that are never read again are dead, whether the
+    // function returns or unwinds.
+    for (Instruction *I : Writes) {
+      if (Deleted.count(I) || !isRemovable(I))
+        continue;
+      MemoryLocation Loc = getLocForWrite(I);
+      if (!Loc.Ptr || !isa<AllocaInst>(GetUnderlyingObject(Loc.Ptr, DL)))
+        continue;
+      if (mayBeReadAfter(cast<MemoryDef>(MSSA.getMemoryAccess(I)), Loc,
+                         /*Kill=*/nullptr))
+        continue;
+      LLVM_DEBUG(dbgs() << "DSE: Dead Store to stack object never read:\n  "
+                        << "DEAD: " << *I << '\n');
+      deleteDeadInstruction(I);
+      ++NumFastStores;
+      MadeChange = true;
+    }
+    return MadeChange;
+  }
+
+private:
+  /// Delete \p I and the instructions only used to compute its operands, and
+  /// remove their memory accesses from MemorySSA.
+  void deleteDeadInstruction(Instruction *I) {
+    SmallVector<Instruction *, 32> NowDeadInsts;
+    NowDeadInsts.push_back(I);
+    --NumFastOther;
+
+    do {
+      Instruction *DeadInst = NowDeadInsts.pop_back_val();
+      ++NumFastOther;
+
+      // Try to preserve debug information attached to the dead instruction.
+      salvageDebugInfo(*DeadInst);
+      MSSAU.removeMemoryAccess(DeadInst);
+
+      for (Use &Op : DeadInst->operands()) {
+        Instruction *OpI = dyn_cast<Instruction>(Op);
+        Op.set(nullptr);
+        if (OpI && OpI->use_empty() && isInstructionTriviallyDead(OpI, &TLI))
+          NowDeadInsts.push_back(OpI);
+      }
+
+      Deleted.insert(DeadInst);
+      DeadInst->eraseFromParent();
+    } while (!NowDeadInsts.empty());
+  }
+
+  /// Return true if the location \p Ptr points to is the same in every
+  /// iteration of any loop, so that a store to it in a loop and one outside
+  /// refer to the same memory.
+  static bool isGuaranteedLoopInvariant(const Value *Ptr) {
+    Ptr = Ptr->stripPointerCasts();
+    if (auto *GEP = dyn_cast<GEPOperator>(Ptr))
+      if (GEP->hasAllConstantIndices())
+        Ptr = GEP->getPointerOperand()->stripPointerCasts();
+    auto *I = dyn_cast<Instruction>(Ptr);
+    return !I || I->getParent() == &I->getFunction()->getEntryBlock();
+  }
+
+  /// Return true if a store to \p DeadLoc is not observable if the function
+  /// unwinds.
+  bool isInvisibleOnUnwind(const MemoryLocation &DeadLoc) const {
+    const Value *Underlying = GetUnderlyingObject(DeadLoc.Ptr, DL);
+    return isa<AllocaInst>(Underlying) ||
+           (isAllocLikeFn(Underlying, &TLI) &&
+            !PointerMayBeCaptured(Underlying, false, true));
+  }
+
+  /// Return true if an access that may be reached from \p Dead without going
+  /// through \p Kill may read \p DeadLoc. If \p Kill is null, check all
+  /// accesses that may be reached from \p Dead.
+  bool mayBeReadAfter(MemoryDef *Dead, const MemoryLocation &DeadLoc,
+                      MemoryDef *Kill) {
+    SmallVector<MemoryAccess *, 16> Worklist(1, Dead);
+    SmallPtrSet<MemoryAccess *, 16> Visited;
+    Visited.insert(Dead);
+    // Nothing changes during the walk, so its queries can share AA caches.
+    BatchAAResults BatchAA(AA);
+    unsigned Budget = MemorySSAScanLimit;
+    while (!Worklist.empty()) {
+      MemoryAccess *MA = Worklist.pop_back_val();
+      for (User *U : MA->users()) {
+        auto *UseAccess = cast<MemoryAccess>(U);
+        if (UseAccess == Kill || !Visited.insert(UseAccess).second)
+          continue;
+        if (Budget-- == 0)
+          return true;
+        if (auto *UseOrDef = dyn_cast<MemoryUseOrDef>(UseAccess))
+          if (isRefSet(
+                  BatchAA.getModRefInfo(UseOrDef->getMemoryInst(), DeadLoc)))
+            return true;
+        if (!isa<MemoryUse>(UseAccess))
+          Worklist.push_back(UseAccess);
+      }
+    }
+    return false;
+  }
+
+  /// Remove the stores that \p KillI completely overwrites.
+  bool eliminateOverwrittenBy(Instruction *KillI) {
+    MemoryLocation KillLoc = getLocForWrite(KillI);
+    if (!KillLoc.Ptr)
+      return false;
+
+    bool MadeChange = false;
+    auto *Kill = cast<MemoryDef>(MSSA.getMemoryAccess(KillI));
+    MemoryAccess *Current = Kill->getDefiningAccess();
+    for (unsigned Scanned = 0; Scanned != MemorySSAScanLimit; ++Scanned) {
+      // The nearest earlier access that may write to the killed location.
+      auto *Dead = dyn_cast<MemoryDef>(
+          MSSA.getWalker()->getClobberingMemoryAccess(Current, KillLoc));
+      if (!Dead || MSSA.isLiveOnEntryDef(Dead))
+        break;
+      Instruction *DeadI = Dead->getMemoryInst();
+      if (!hasAnalyzableMemoryWrite(DeadI, TLI))
+        break;
+      MemoryLocation DeadLoc = getLocForWrite(DeadI);
+      if (!DeadLoc.Ptr)
+        break;
+
+      if (isDeadBecauseOf(DeadI, DeadLoc, Dead, KillI, KillLoc, Kill)) {
+        LLVM_DEBUG(dbgs() << "DSE: Remove Dead Store:\n  DEAD: " << *DeadI
+                          << "\n  KILLER: " << *KillI << '\n');
+        if (DeadI->getParent() != KillI->getParent())
+          ++NumCrossBlockStores;
+        deleteDeadInstruction(DeadI);
+        ++NumFastStores;
+        MadeChange = true;
+        // Removing the dead store made its defining access the one of Kill.
+        Current = Kill->getDefiningAccess();
+        continue;
+      }
+
+      // Keep looking past a write that may alias the killed location, as long
+      // as it does not read it.
+      if (isRefSet(AA.getModRefInfo(DeadI, KillLoc)))
+        break;
+      Current = Dead->getDefiningAccess();
+    }
+    return MadeChange;
+  }
+
+  /// Return true if the write \p DeadI is dead because \p KillI overwrites
+  /// it before it may be read.
+  bool isDeadBecauseOf(Instruction *DeadI, const MemoryLocation &DeadLoc,
+                       MemoryDef *Dead, Instruction *KillI,
+                       const MemoryLocation &KillLoc, MemoryDef *Kill) {
+    if (!isRemovable(DeadI) ||
+        isPossibleSelfRead(KillI, KillLoc, DeadI, TLI, AA))
+      return false;
+
+    // Every path from the dead store must go through the killing one. A store
+    // in a loop only overwrites one outside of it if it writes the same
+    // location in every iteration.
+    BasicBlock *DeadBB = DeadI->getParent(), *KillBB = KillI->getParent();
+    if (DeadBB != KillBB &&
+        (!PDT.dominates(KillBB, DeadBB) ||
+         !isGuaranteedLoopInvariant(DeadLoc.Ptr) ||
+         !isGuaranteedLoopInvariant(KillLoc.Ptr)))
+      return false;
+
+    // The dead store is observable if anything unwinds before the killing one.
+    if (AnyMayThrow && !isInvisibleOnUnwind(DeadLoc))
+      return false;
+
+    int64_t KillOffset, DeadOffset;
+    InstOverlapIntervalsTy IOL;
+    if (isOverwrite(KillLoc, DeadLoc, DL, TLI, DeadOffset, KillOffset, DeadI,
+                    IOL, AA, &F) != OW_Complete)
+      return false;
+
+    return !mayBeReadAfter(Dead, DeadLoc, Kill);
+  }
+};
+
+} // end anonymous namespace
+
+static bool eliminateDeadStoresMemorySSA(Function &F, AliasAnalysis &AA,
+                                         MemorySSA &MSSA, DominatorTree &DT,
+                                         PostDominatorTree &PDT,
+                                         const TargetLibraryInfo &TLI) {
+  return MemorySSADSE(F, AA, MSSA, DT, PDT, TLI).run();
+}
+
 //===----------------------------------------------------------------------===//
 // DSE Pass
 //===----------------------------------------------------------------------===//
 PreservedAnalyses DSEPass::run(Function &F, FunctionAnalysisManager &AM) {
   AliasAnalysis *AA = &AM.getResult<AAManager>(F);
   DominatorTree *DT = &AM.getResult<DominatorTreeAnalysis>(F);
-  MemoryDependenceResults *MD = &AM.getResult<MemoryDependenceAnalysis>(F);
   const TargetLibraryInfo *TLI = &AM.getResult<TargetLibraryAnalysis>(F);
 
-  if (!eliminateDeadStores(F, AA, MD, DT, TLI))
-    return PreservedAnalyses::all();
-
   PreservedAnalyses PA;
+  if (EnableMemorySSA) {
+    MemorySSA &MSSA = AM.getResult<MemorySSAAnalysis>(F).getMSSA();
+    PostDominatorTree &PDT = AM.getResult<PostDominatorTreeAnalysis>(F);
+    if (!eliminateDeadStoresMemorySSA(F, *AA, MSSA, *DT, PDT, *TLI))
+      return PreservedAnalyses::all();
+    PA.preserve<MemorySSAAnalysis>();
+  } else {
+    MemoryDependenceResults *MD = &AM.getResult<MemoryDependenceAnalysis>(F);
+    if (!eliminateDeadStores(F, AA, MD, DT, TLI))
+      return PreservedAnalyses::all();
+    PA.preserve<MemoryDependenceAnalysis>();
+  }
+
   PA.preserveSet<CFGAnalyses>();
   PA.preserve<GlobalsAA>();
-  PA.preserve<MemoryDependenceAnalysis>();
   return PA;
 }
 
@@ -1358,11 +1634,18 @@ public:
 
     DominatorTree *DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
     AliasAnalysis *AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
-    MemoryDependenceResults *MD =
-        &getAnalysis<MemoryDependenceWrapperPass>().getMemDep();
     const TargetLibraryInfo *TLI =
         &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI(F);
 
+    if (EnableMemorySSA) {
+      MemorySSA &MSSA = getAnalysis<MemorySSAWrapperPass>().getMSSA();
+      PostDominatorTree &PDT =
+          getAnalysis<PostDominatorTreeWrapperPass>().getPostDomTree();
+      return eliminateDeadStoresMemorySSA(F, *AA, MSSA, *DT, PDT, *TLI);
+    }
+
+    MemoryDependenceResults *MD =
+        &getAnalysis<MemoryDependenceWrapperPass>().getMemDep();
     return eliminateDeadStores(F, AA, MD, DT, TLI);
   }
 
@@ -1370,11 +1653,17 @@ public:
     AU.setPreservesCFG();
     AU.addRequired<DominatorTreeWrapperPass>();
     AU.addRequired<AAResultsWrapperPass>();
-    AU.addRequired<MemoryDependenceWrapperPass>();
     AU.addRequired<TargetLibraryInfoWrapperPass>();
     AU.addPreserved<DominatorTreeWrapperPass>();
     AU.addPreserved<GlobalsAAWrapperPass>();
-    AU.addPreserved<MemoryDependenceWrapperPass>();
+    if (EnableMemorySSA) {
+      AU.addRequired<PostDominatorTreeWrapperPass>();
+      AU.addRequired<MemorySSAWrapperPass>();
+      AU.addPreserved<MemorySSAWrapperPass>();
+    } else {
+      AU.addRequired<MemoryDependenceWrapperPass>();
+      AU.addPreserved<MemoryDependenceWrapperPass>();
+    }
   }
 };
 
@@ -1388,6 +1677,8 @@ INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(GlobalsAAWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(MemoryDependenceWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(MemorySSAWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(PostDominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
 INITIALIZE_PASS_END(DSELegacyPass, "dse", "Dead Store Elimination", false,
                     false)
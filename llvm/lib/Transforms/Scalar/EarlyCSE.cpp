@@ -778,7 +778,9 @@ bool EarlyCSE::isSameMemGeneration(unsigned EarlierGeneration,
   // EarlierInst and LaterInst and neither can any other write that potentially
   // clobbers LaterInst.
   MemoryAccess *LaterDef;
-  if (ClobberCounter < EarlyCSEMssaOptCap) {
+  const Function &F = *LaterInst->getFunction();
+  if (ClobberCounter < EarlyCSEMssaOptCap &&
+      F.getContext().consumeCompileTimeBudget(F, 1)) {
     LaterDef = MSSA->getWalker()->getClobberingMemoryAccess(LaterInst);
     ClobberCounter++;
   } else
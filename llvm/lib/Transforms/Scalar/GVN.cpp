@@ -2117,12 +2117,15 @@ bool GVN::runImpl(Function &F, AssumptionCache &RunAC, DominatorTree &RunDT,
     ++Iteration;
   }
 
-  if (EnablePRE) {
+  // PRE needs value numbers for all instructions, which we don't have if the
+  // compile-time budget ran out in the middle of an iteration.
+  if (EnablePRE && F.getContext().hasCompileTimeBudget(F)) {
     // Fabricate val-num for dead-code in order to suppress assertion in
     // performPRE().
     assignValNumForDeadCode();
     bool PREChanged = true;
-    while (PREChanged) {
+    while (PREChanged && F.getContext().consumeCompileTimeBudget(
+                             F, F.getInstructionCount())) {
       PREChanged = performPRE(F);
       Changed |= PREChanged;
     }
@@ -2481,8 +2484,12 @@ bool GVN::iterateOnFunction(Function &F) {
   // processBlock.
   ReversePostOrderTraversal<Function *> RPOT(&F);
 
-  for (BasicBlock *BB : RPOT)
+  LLVMContext &Ctx = F.getContext();
+  for (BasicBlock *BB : RPOT) {
+    if (!Ctx.consumeCompileTimeBudget(F, BB->size()))
+      break;
     Changed |= processBlock(BB);
+  }
 
   return Changed;
 }
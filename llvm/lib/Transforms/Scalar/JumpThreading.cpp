@@ -392,6 +392,8 @@ bool JumpThreadingPass::runImpl(Function &F, TargetLibraryInfo *TLI_,
   do {
     Changed = false;
     for (auto &BB : F) {
+      if (!F.getContext().consumeCompileTimeBudget(F, BB.size()))
+        break;
       if (Unreachable.count(&BB))
         continue;
       while (ProcessBlock(&BB)) // Thread all of the branches we can over BB.
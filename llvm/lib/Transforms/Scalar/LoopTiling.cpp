@@ -0,0 +1,513 @@
+//===- LoopTiling.cpp - Loop Tiling Pass ----------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements the loop tiling pass.
+///
+/// The pass tiles perfect nests of two loops for cache locality. When the data
+/// an inner loop touches in one iteration of the outer loop does not fit in the
+/// data cache, but part of it is reused by every iteration of the outer loop,
+/// the nest
+///
+///   for (i = 0; i < N; ++i)
+///     for (j = 0; j < M; ++j)
+///       A[i][j] += B[j];
+///
+/// is rewritten so that the inner loop runs over one tile of its iterations at
+/// a time, and a new outermost loop steps over the tiles:
+///
+///   for (jj = 0; jj < M; jj += TileSize)
+///     for (i = 0; i < N; ++i)
+///       for (j = jj; j < min(jj + TileSize, M); ++j)
+///         A[i][j] += B[j];
+///
+/// The tile size is chosen from the cache size reported by TTI so that the
+/// data the inner loop touches for one tile stays in the cache across the
+/// iterations of the outer loop. The footprint of the inner loop is estimated
+/// with the reference costs of LoopCacheAnalysis, and DependenceAnalysis proves
+/// that moving the tiles outside the outer loop preserves all dependences.
+///
+/// The pass runs after loop interchange, which picks the loop order, and
+/// before unroll and jam, which can then jam the copies of the new inner loop.
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Scalar/LoopTiling.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/DependenceAnalysis.h"
+#include "llvm/Analysis/LoopCacheAnalysis.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpander.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils.h"
+#include "llvm/Transforms/Utils/Local.h"
+#include "llvm/Transforms/Utils/LoopUtils.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "loop-tiling"
+
+STATISTIC(NumTiled, "Number of loop nests tiled");
+STATISTIC(NumCandidates, "Number of candidate loop nests for tiling");
+STATISTIC(NotSimplifiedForm, "Loop is not in simplified form");
+STATISTIC(NoInductionVariable, "Inner loop has no simple induction variable");
+STATISTIC(UncomputableTripCount, "SCEV cannot compute trip count of loop");
+STATISTIC(UnsafeInstructions, "Loop nest has unsafe instructions");
+STATISTIC(InvalidDependencies, "Dependencies prevent tiling");
+STATISTIC(TilingNotBeneficial, "Tiling is not beneficial");
+
+static cl::opt<unsigned>
+    TileSizeOpt("loop-tiling-tile-size", cl::init(0), cl::Hidden,
+                cl::desc("Tile the inner loop by this many iterations instead "
+                         "of using the cost model (0 to use the cost model)"));
+
+static cl::opt<unsigned> CacheSizeOpt(
+    "loop-tiling-cache-size", cl::init(0), cl::Hidden,
+    cl::desc("Size in bytes of the data cache to tile for (0 to use the L1 "
+             "data cache size of the target)"));
+
+static cl::opt<unsigned> CacheLineSizeOpt(
+    "loop-tiling-cache-line-size", cl::init(0), cl::Hidden,
+    cl::desc("Size in bytes of a cache line (0 to use the cache line size of "
+             "the target)"));
+
+/// Loop metadata marking a nest that was already tiled.
+static const char *const LLVMLoopTileDisable = "llvm.loop.tile.disable";
+
+namespace {
+
+/// A perfect nest of two loops that can be tiled, and how to tile it.
+struct TilingCandidate {
+  Loop &Outer;
+  Loop &Inner;
+  PHINode &IndVar;
+  Loop::LoopBounds Bounds;
+  /// The number of iterations of the inner loop per iteration of the outer
+  /// loop, in the type of the induction variable.
+  const SCEV *TripCount;
+  SmallVector<Instruction *, 8> MemInsts;
+};
+
+class LoopTiler {
+public:
+  LoopTiler(LoopInfo &LI, DominatorTree &DT, ScalarEvolution &SE,
+            DependenceInfo &DI, const TargetTransformInfo &TTI,
+            OptimizationRemarkEmitter &ORE, const DataLayout &DL)
+      : LI(LI), DT(DT), SE(SE), DI(DI), TTI(TTI), ORE(ORE), DL(DL) {}
+
+  bool tileLoops(Function &F) {
+    if (F.hasOptSize())
+      return false;
+
+    // Collect the nests first, tiling one adds a loop.
+    SmallVector<Loop *, 8> Nests;
+    for (Loop *L : LI.getLoopsInPreorder())
+      if (L->getSubLoops().size() == 1 && L->getSubLoops()[0]->empty())
+        Nests.push_back(L);
+
+    bool Changed = false;
+    for (Loop *L : Nests) {
+      ++NumCandidates;
+      Optional<TilingCandidate> TC = analyzeNest(*L);
+      if (!TC)
+        continue;
+      if (!isLegal(*TC)) {
+        ++InvalidDependencies;
+        continue;
+      }
+      unsigned TileSize = getTileSize(*TC);
+      if (!TileSize) {
+        ++TilingNotBeneficial;
+        continue;
+      }
+      tile(*TC, TileSize);
+      Changed = true;
+    }
+    return Changed;
+  }
+
+private:
+  /// Check that \p Outer and its only subloop form a nest this pass can tile,
+  /// and collect what tiling needs to know about it.
+  Optional<TilingCandidate> analyzeNest(Loop &Outer);
+
+  /// Return true if running the tiles of the inner loop outside the outer
+  /// loop preserves all dependences of the nest.
+  bool isLegal(TilingCandidate &TC);
+
+  /// Return the number of inner loop iterations in a tile, or 0 if tiling
+  /// the nest is not beneficial.
+  unsigned getTileSize(TilingCandidate &TC);
+
+  /// Tile the inner loop of the nest by \p TileSize iterations.
+  void tile(TilingCandidate &TC, unsigned TileSize);
+
+  LoopInfo &LI;
+  DominatorTree &DT;
+  ScalarEvolution &SE;
+  DependenceInfo &DI;
+  const TargetTransformInfo &TTI;
+  OptimizationRemarkEmitter &ORE;
+  const DataLayout &DL;
+};
+
+} // end anonymous namespace
+
+Optional<TilingCandidate> LoopTiler::analyzeNest(Loop &Outer) {
+  Loop &Inner = *Outer.getSubLoops()[0];
+  if (findStringMetadataForLoop(&Outer, LLVMLoopTileDisable) ||
+      hasDisableAllTransformsHint(&Outer) ||
+      hasDisableAllTransformsHint(&Inner))
+    return None;
+
+  for (Loop *L : {&Outer, &Inner})
+    if (!L->isLoopSimplifyForm() || !L->getExitBlock() ||
+        L->getExitingBlock() != L->getLoopLatch()) {
+      ++NotSimplifiedForm;
+      return None;
+    }
+
+  // The inner loop must count its iterations with a constant step, and it
+  // must not carry any other value from one iteration to the next.
+  PHINode *IndVar = Inner.getInductionVariable(SE);
+  Optional<Loop::LoopBounds> Bounds = Inner.getBounds(SE);
+  if (!IndVar || !Bounds ||
+      !isa_and_nonnull<ConstantInt>(Bounds->getStepValue()) ||
+      cast<ConstantInt>(Bounds->getStepValue())->isZero() ||
+      &*Inner.getHeader()->phis().begin() != IndVar ||
+      std::next(Inner.getHeader()->phis().begin()) !=
+          Inner.getHeader()->phis().end()) {
+    ++NoInductionVariable;
+    return None;
+  }
+
+  // The inner loop must run in every iteration of the outer loop, for the same
+  // number of iterations, so that its trip count bounds the tiles.
+  if (!DT.dominates(Inner.getHeader(), Outer.getLoopLatch())) {
+    ++UncomputableTripCount;
+    return None;
+  }
+  const SCEV *BTC = SE.getBackedgeTakenCount(&Inner);
+  if (isa<SCEVCouldNotCompute>(BTC) || !SE.isLoopInvariant(BTC, &Outer) ||
+      BTC->getType() != IndVar->getType()) {
+    ++UncomputableTripCount;
+    return None;
+  }
+  const SCEV *TripCount = SE.getAddExpr(BTC, SE.getOne(BTC->getType()));
+  if (!isSafeToExpandAt(TripCount, Outer.getLoopPreheader()->getTerminator(),
+                        SE)) {
+    ++UncomputableTripCount;
+    return None;
+  }
+
+  // The rest of the outer loop runs once per tile instead of once, so it must
+  // not have side effects or read memory the inner loop writes. No value of
+  // the inner loop may be used outside of it, since only the last tile would
+  // see its final value.
+  TilingCandidate TC = {Outer, Inner, *IndVar, *Bounds, TripCount, {}};
+  for (BasicBlock *BB : Outer.blocks()) {
+    bool InInner = Inner.contains(BB);
+    for (Instruction &I : *BB) {
+      if (InInner) {
+        if (any_of(I.users(), [&](User *U) {
+              return !Inner.contains(cast<Instruction>(U));
+            })) {
+          ++UnsafeInstructions;
+          return None;
+        }
+        if (auto *Load = dyn_cast<LoadInst>(&I)) {
+          if (Load->isSimple()) {
+            TC.MemInsts.push_back(Load);
+            continue;
+          }
+        } else if (auto *Store = dyn_cast<StoreInst>(&I)) {
+          if (Store->isSimple()) {
+            TC.MemInsts.push_back(Store);
+            continue;
+          }
+        }
+      }
+      if (I.mayReadOrWriteMemory() || I.mayHaveSideEffects()) {
+        LLVM_DEBUG(dbgs() << "Cannot tile, unsafe instruction: " << I << "\n");
+        ++UnsafeInstructions;
+        return None;
+      }
+    }
+  }
+  return TC;
+}
+
+bool LoopTiler::isLegal(TilingCandidate &TC) {
+  // Tiling runs iteration (i, j) before (i', j') if j is in an earlier tile
+  // than j', even if i' < i. A dependence that goes forward in the outer loop
+  // and backward in the inner loop would be reversed.
+  unsigned OuterLevel = TC.Outer.getLoopDepth();
+  unsigned InnerLevel = TC.Inner.getLoopDepth();
+  for (unsigned I = 0, E = TC.MemInsts.size(); I != E; ++I) {
+    for (unsigned J = I; J != E; ++J) {
+      Instruction *Src = TC.MemInsts[I];
+      Instruction *Dst = TC.MemInsts[J];
+      if (!isa<StoreInst>(Src) && !isa<StoreInst>(Dst))
+        continue;
+      std::unique_ptr<Dependence> D = DI.depends(Src, Dst, true);
+      if (!D)
+        continue;
+      if (D->isConfused() || D->getLevels() < InnerLevel) {
+        LLVM_DEBUG(dbgs() << "Cannot tile, unknown dependence between "
+                          << *Src << " and " << *Dst << "\n");
+        return false;
+      }
+      unsigned OuterDir = D->getDirection(OuterLevel);
+      unsigned InnerDir = D->getDirection(InnerLevel);
+      if (((OuterDir & Dependence::DVEntry::LT) &&
+           (InnerDir & Dependence::DVEntry::GT)) ||
+          ((OuterDir & Dependence::DVEntry::GT) &&
+           (InnerDir & Dependence::DVEntry::LT))) {
+        LLVM_DEBUG(dbgs() << "Cannot tile, dependence between " << *Src
+                          << " and " << *Dst << " would be reversed\n");
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+unsigned LoopTiler::getTileSize(TilingCandidate &TC) {
+  unsigned MaxTripCount = ~0U;
+  if (auto *C = dyn_cast<SCEVConstant>(TC.TripCount))
+    MaxTripCount = C->getAPInt().getLimitedValue(~0U);
+  if (TileSizeOpt)
+    return TileSizeOpt < MaxTripCount ? TileSizeOpt : 0;
+
+  unsigned CLS =
+      CacheLineSizeOpt ? unsigned(CacheLineSizeOpt) : TTI.getCacheLineSize();
+  unsigned CacheSize = CacheSizeOpt;
+  if (!CacheSize)
+    CacheSize = TTI.getCacheSize(TargetTransformInfo::CacheLevel::L1D)
+                    .getValueOr(0);
+  if (!CLS || !CacheSize || MaxTripCount == ~0U)
+    return 0;
+
+  // Add up the cache lines each reference touches in one execution of the
+  // inner loop, and look for references that every iteration of the outer
+  // loop repeats.
+  uint64_t Footprint = 0;
+  bool HasReuse = false;
+  for (Instruction *I : TC.MemInsts) {
+    IndexedReference R(*I, LI, SE);
+    if (!R.isValid())
+      return 0;
+    CacheCostTy Cost = R.computeRefCost(TC.Inner, CLS);
+    if (Cost == CacheCost::InvalidCost)
+      return 0;
+    Footprint += uint64_t(Cost) * CLS;
+
+    auto *Ptr =
+        dyn_cast<SCEVAddRecExpr>(SE.getSCEV(getLoadStorePointerOperand(I)));
+    if (Ptr && Ptr->getLoop() == &TC.Inner &&
+        SE.isLoopInvariant(Ptr->getStart(), &TC.Outer))
+      HasReuse = true;
+  }
+  LLVM_DEBUG(dbgs() << "Inner loop footprint: " << Footprint
+                    << " bytes, cache size: " << CacheSize << "\n");
+  if (!HasReuse || Footprint <= CacheSize)
+    return 0;
+
+  // Leave half of the cache to the data that is not reused.
+  uint64_t TileSize = PowerOf2Floor(uint64_t(MaxTripCount) * CacheSize / 2 /
+                                    Footprint);
+  return TileSize >= 2 && TileSize < MaxTripCount ? TileSize : 0;
+}
+
+void LoopTiler::tile(TilingCandidate &TC, unsigned TileSize) {
+  Loop &Outer = TC.Outer;
+  Loop &Inner = TC.Inner;
+  BasicBlock *Preheader = Outer.getLoopPreheader();
+  BasicBlock *Header = Outer.getHeader();
+  BasicBlock *Latch = Outer.getLoopLatch();
+  BasicBlock *Exit = Outer.getExitBlock();
+  Function *F = Header->getParent();
+  Type *Ty = TC.IndVar.getType();
+  LLVM_DEBUG(dbgs() << "Tiling " << Outer << " by " << TileSize << "\n");
+
+  SE.forgetLoop(&Outer);
+
+  SCEVExpander Expander(SE, DL, "tile");
+  Value *TripCount =
+      Expander.expandCodeFor(TC.TripCount, Ty, Preheader->getTerminator());
+  Value *Size = ConstantInt::get(Ty, TileSize);
+
+  // The tile loop steps T by TileSize while T + TileSize < TripCount. The
+  // tile ends at T + umin(TileSize, TripCount - T), which cannot overflow.
+  BasicBlock *TileHeader =
+      BasicBlock::Create(F->getContext(), "tile.header", F, Header);
+  BasicBlock *TileLatch =
+      BasicBlock::Create(F->getContext(), "tile.latch", F, Exit);
+  IRBuilder<> Builder(TileHeader);
+  PHINode *Tile = Builder.CreatePHI(Ty, 2, "tile");
+  Value *Remaining = Builder.CreateSub(TripCount, Tile, "tile.remaining");
+  Value *IsLast = Builder.CreateICmpULE(Remaining, Size);
+  Value *TileEnd = Builder.CreateAdd(
+      Tile, Builder.CreateSelect(IsLast, Remaining, Size), "tile.end");
+  Builder.CreateBr(Header);
+
+  Builder.SetInsertPoint(TileLatch);
+  Value *NextTile = Builder.CreateAdd(Tile, Size, "tile.next");
+  Value *HasNext = Builder.CreateICmpULT(Size, Remaining, "tile.cond");
+  Builder.CreateCondBr(HasNext, TileHeader, Exit);
+  Tile->addIncoming(ConstantInt::get(Ty, 0), Preheader);
+  Tile->addIncoming(NextTile, TileLatch);
+
+  Preheader->getTerminator()->replaceUsesOfWith(Header, TileHeader);
+  Header->replacePhiUsesWith(Preheader, TileHeader);
+  Latch->getTerminator()->replaceUsesOfWith(Exit, TileLatch);
+  Exit->replacePhiUsesWith(Latch, TileLatch);
+
+  // Run the inner loop from the start to the end of the tile.
+  BasicBlock *InnerPreheader = Inner.getLoopPreheader();
+  BasicBlock *InnerLatch = Inner.getLoopLatch();
+  Value *Step = TC.Bounds.getStepValue();
+  Value &Init = TC.Bounds.getInitialIVValue();
+  Builder.SetInsertPoint(InnerPreheader->getTerminator());
+  Value *Start = Builder.CreateAdd(&Init, Builder.CreateMul(Tile, Step),
+                                   "tile.iv.start");
+  Value *End = Builder.CreateAdd(&Init, Builder.CreateMul(TileEnd, Step),
+                                 "tile.iv.end");
+  TC.IndVar.setIncomingValueForBlock(InnerPreheader, Start);
+
+  auto *LatchBr = cast<BranchInst>(InnerLatch->getTerminator());
+  Value *OldCond = LatchBr->getCondition();
+  Builder.SetInsertPoint(LatchBr);
+  LatchBr->setCondition(
+      LatchBr->getSuccessor(0) == Inner.getHeader()
+          ? Builder.CreateICmpNE(&TC.Bounds.getStepInst(), End)
+          : Builder.CreateICmpEQ(&TC.Bounds.getStepInst(), End));
+  RecursivelyDeleteTriviallyDeadInstructions(OldCond);
+
+  // Update the dominator tree and the loop info.
+  DT.addNewBlock(TileHeader, Preheader);
+  DT.changeImmediateDominator(Header, TileHeader);
+  DT.addNewBlock(TileLatch, Latch);
+  DT.changeImmediateDominator(Exit, TileLatch);
+
+  Loop *TileLoop = LI.AllocateLoop();
+  if (Loop *Parent = Outer.getParentLoop())
+    Parent->replaceChildLoopWith(&Outer, TileLoop);
+  else
+    LI.changeTopLevelLoop(&Outer, TileLoop);
+  TileLoop->addChildLoop(&Outer);
+  TileLoop->addBasicBlockToLoop(TileHeader, LI);
+  for (BasicBlock *BB : Outer.blocks())
+    TileLoop->addBlockEntry(BB);
+  TileLoop->addBasicBlockToLoop(TileLatch, LI);
+  formLCSSARecursively(*TileLoop, DT, &LI, &SE);
+
+  addStringMetadataToLoop(&Outer, LLVMLoopTileDisable);
+
+  ++NumTiled;
+  ORE.emit([&]() {
+    return OptimizationRemark(DEBUG_TYPE, "Tiled", Outer.getStartLoc(),
+                              Outer.getHeader())
+           << "tiled loop nest by " << ore::NV("TileSize", TileSize);
+  });
+}
+
+namespace {
+
+struct LoopTilingLegacy : public FunctionPass {
+
+  static char ID;
+
+  LoopTilingLegacy() : FunctionPass(ID) {
+    initializeLoopTilingLegacyPass(*PassRegistry::getPassRegistry());
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequiredID(LoopSimplifyID);
+    AU.addRequiredID(LCSSAID);
+    AU.addRequired<ScalarEvolutionWrapperPass>();
+    AU.addRequired<LoopInfoWrapperPass>();
+    AU.addRequired<DominatorTreeWrapperPass>();
+    AU.addRequired<OptimizationRemarkEmitterWrapperPass>();
+    AU.addRequired<DependenceAnalysisWrapperPass>();
+    AU.addRequired<TargetTransformInfoWrapperPass>();
+
+    AU.addPreservedID(LoopSimplifyID);
+    AU.addPreservedID(LCSSAID);
+    AU.addPreserved<ScalarEvolutionWrapperPass>();
+    AU.addPreserved<LoopInfoWrapperPass>();
+    AU.addPreserved<DominatorTreeWrapperPass>();
+  }
+
+  bool runOnFunction(Function &F) override {
+    if (skipFunction(F))
+      return false;
+    auto &LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+    auto &DT = getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+    auto &DI = getAnalysis<DependenceAnalysisWrapperPass>().getDI();
+    auto &SE = getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+    auto &TTI = getAnalysis<TargetTransformInfoWrapperPass>().getTTI(F);
+    auto &ORE = getAnalysis<OptimizationRemarkEmitterWrapperPass>().getORE();
+
+    const DataLayout &DL = F.getParent()->getDataLayout();
+    LoopTiler LT(LI, DT, SE, DI, TTI, ORE, DL);
+    return LT.tileLoops(F);
+  }
+};
+} // namespace
+
+PreservedAnalyses LoopTilingPass::run(Function &F,
+                                      FunctionAnalysisManager &AM) {
+  auto &LI = AM.getResult<LoopAnalysis>(F);
+  auto &DT = AM.getResult<DominatorTreeAnalysis>(F);
+  auto &DI = AM.getResult<DependenceAnalysis>(F);
+  auto &SE = AM.getResult<ScalarEvolutionAnalysis>(F);
+  auto &TTI = AM.getResult<TargetIRAnalysis>(F);
+  auto &ORE = AM.getResult<OptimizationRemarkEmitterAnalysis>(F);
+
+  const DataLayout &DL = F.getParent()->getDataLayout();
+  LoopTiler LT(LI, DT, SE, DI, TTI, ORE, DL);
+  if (!LT.tileLoops(F))
+    return PreservedAnalyses::all();
+
+  PreservedAnalyses PA;
+  PA.preserve<DominatorTreeAnalysis>();
+  PA.preserve<ScalarEvolutionAnalysis>();
+  PA.preserve<LoopAnalysis>();
+  return PA;
+}
+
+char LoopTilingLegacy::ID = 0;
+
+INITIALIZE_PASS_BEGIN(LoopTilingLegacy, "loop-tiling", "Loop Tiling", false,
+                      false)
+INITIALIZE_PASS_DEPENDENCY(LoopSimplify)
+INITIALIZE_PASS_DEPENDENCY(LCSSAWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(DependenceAnalysisWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(OptimizationRemarkEmitterWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(TargetTransformInfoWrapperPass)
+INITIALIZE_PASS_END(LoopTilingLegacy, "loop-tiling", "Loop Tiling", false,
+                    false)
+
+FunctionPass *llvm::createLoopTilingPass() { return new LoopTilingLegacy(); }
@@ -91,18 +91,9 @@ static void addAllGlobalValueUsers(ClusterMapType &GVtoClusterMap,
   }
 }
 
-// Find partitions for module in the way that no locals need to be
-// globalized.
-// Try to balance pack those partitions into N files since this roughly equals
-// thread balancing for the backend codegen step.
-static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
-                           unsigned N) {
-  // At this point module should have the proper mix of globals and locals.
-  // As we attempt to partition this module, we must not change any
-  // locals to globals.
-  LLVM_DEBUG(dbgs() << "Partition module with (" << M->size()
-                    << ")functions\n");
-  ClusterMapType GVtoClusterMap;
+// Group the globals of M that must be in the same partition: members of a
+// comdat, aliases and their aliasees, and locals and their users.
+static void findClusters(Module *M, ClusterMapType &GVtoClusterMap) {
   ComdatMembersType ComdatMembers;
 
   auto recordGVSet = [&GVtoClusterMap, &ComdatMembers](GlobalValue &GV) {
@@ -147,6 +138,21 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
   llvm::for_each(M->functions(), recordGVSet);
   llvm::for_each(M->globals(), recordGVSet);
   llvm::for_each(M->aliases(), recordGVSet);
+}
+
+// Find partitions for module in the way that no locals need to be
+// globalized.
+// Try to balance pack those partitions into N files since this roughly equals
+// thread balancing for the backend codegen step.
+static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
+                           unsigned N) {
+  // At this point module should have the proper mix of globals and locals.
+  // As we attempt to partition this module, we must not change any
+  // locals to globals.
+  LLVM_DEBUG(dbgs() << "Partition module with (" << M->size()
+                    << ")functions\n");
+  ClusterMapType GVtoClusterMap;
+  findClusters(M, GVtoClusterMap);
 
   // Assigned all GVs to merged clusters while balancing number of objects in
   // each.
@@ -212,6 +218,60 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
   }
 }
 
+// Assign the definitions of M to N partitions such that each partition holds
+// a run of consecutive functions of about the same total size, and likewise
+// for global variables and aliases. Clusters that must not be split go to the
+// partition of their first member.
+static void findOrderedPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
+                                  unsigned N) {
+  LLVM_DEBUG(dbgs() << "Partition module with (" << M->size()
+                    << ")functions in order\n");
+  ClusterMapType GVtoClusterMap;
+  findClusters(M, GVtoClusterMap);
+
+  // Functions are weighted by their size, which roughly predicts the time
+  // the backend spends on them; everything else has the same weight. Each
+  // kind of global is balanced on its own, and a cluster counts towards its
+  // partition when its first member is reached.
+  auto AssignInOrder = [&](auto &&GVs,
+                           function_ref<uint64_t(const GlobalValue &)> Weight) {
+    uint64_t TotalWeight = 0;
+    for (const GlobalValue &GV : GVs)
+      if (!GV.isDeclaration())
+        TotalWeight += Weight(GV);
+    uint64_t AssignedWeight = 0;
+    for (const GlobalValue &GV : GVs) {
+      if (GV.isDeclaration() || ClusterIDMap.count(&GV))
+        continue;
+      unsigned ID = std::min<uint64_t>(AssignedWeight * N / TotalWeight, N - 1);
+      auto I = GVtoClusterMap.findValue(&GV);
+      if (I == GVtoClusterMap.end()) {
+        ClusterIDMap[&GV] = ID;
+        AssignedWeight += Weight(GV);
+        continue;
+      }
+      for (ClusterMapType::member_iterator MI = GVtoClusterMap.findLeader(I);
+           MI != GVtoClusterMap.member_end(); ++MI) {
+        LLVM_DEBUG(dbgs() << "Root[" << ID << "] ----> " << (*MI)->getName()
+                          << "\n");
+        ClusterIDMap[*MI] = ID;
+        AssignedWeight += Weight(**MI);
+      }
+    }
+  };
+  AssignInOrder(M->functions(), [](const GlobalValue &GV) -> uint64_t {
+    if (auto *F = dyn_cast<Function>(&GV))
+      return F->isDeclaration() ? 0 : F->getInstructionCount() + 1;
+    return 0;
+  });
+  AssignInOrder(M->globals(), [](const GlobalValue &GV) -> uint64_t {
+    return isa<GlobalVariable>(GV) && !GV.isDeclaration();
+  });
+  AssignInOrder(M->aliases(), [](const GlobalValue &GV) -> uint64_t {
+    return isa<GlobalAlias>(GV);
+  });
+}
+
 static void externalize(GlobalValue *GV) {
   if (GV->hasLocalLinkage()) {
     GV->setLinkage(GlobalValue::ExternalLinkage);
@@ -249,7 +309,7 @@ static bool isInPartition(const GlobalValue *GV, unsigned I, unsigned N) {
 void llvm::SplitModule(
     std::unique_ptr<Module> M, unsigned N,
     function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback,
-    bool PreserveLocals) {
+    bool PreserveLocals, bool PreserveOrder) {
   if (!PreserveLocals) {
     for (Function &F : *M)
       externalize(&F);
@@ -264,7 +324,10 @@ void llvm::SplitModule(
   // This performs splitting without a need for externalization, which might not
   // always be possible.
   ClusterIDMapType ClusterIDMap;
-  findPartitions(M.get(), ClusterIDMap, N);
+  if (PreserveOrder)
+    findOrderedPartitions(M.get(), ClusterIDMap, N);
+  else
+    findPartitions(M.get(), ClusterIDMap, N);
 
   // FIXME: We should be able to reuse M as the last partition instead of
   // cloning it.
@@ -484,9 +484,81 @@ bool LoopVectorizationLegality::canVectorizeOuterLoop() {
       return false;
   }
 
+  // Check whether the instructions of the loop nest can be widened.
+  if (!canVectorizeOuterLoopInstrs()) {
+    if (DoExtraAnalysis)
+      Result = false;
+    else
+      return false;
+  }
+
   return Result;
 }
 
+bool LoopVectorizationLegality::canVectorizeOuterLoopInstrs() {
+  for (BasicBlock *BB : TheLoop->blocks()) {
+    for (Instruction &I : *BB) {
+      // Only the outer loop inductions are fixed up after vectorization, so
+      // no other value may be live out of the loop nest.
+      if (!AllowedExit.count(&I) && any_of(I.users(), [&](User *U) {
+            return !TheLoop->contains(cast<Instruction>(U));
+          })) {
+        reportVectorizationFailure("Value used outside the outer loop",
+            "value that is not an induction is used outside the loop",
+            "ValueUsedOutsideLoop", ORE, TheLoop, &I);
+        return false;
+      }
+
+      // Calls are widened to a vector intrinsic or a vector library call.
+      if (auto *CI = dyn_cast<CallInst>(&I)) {
+        if (isa<DbgInfoIntrinsic>(CI))
+          continue;
+        if (!CI->getCalledFunction() ||
+            (!getVectorIntrinsicIDForCall(CI, TLI) &&
+             !(TLI && TLI->isFunctionVectorizable(
+                          CI->getCalledFunction()->getName())))) {
+          reportVectorizationFailure("Found a non-intrinsic callsite",
+                                     "call instruction cannot be vectorized",
+                                     "CantVectorizeLibcall", ORE, TheLoop, CI);
+          return false;
+        }
+      } else if (auto *LD = dyn_cast<LoadInst>(&I)) {
+        if (!LD->isSimple()) {
+          reportVectorizationFailure("Found a non-simple load",
+                                     "load instruction cannot be vectorized",
+                                     "CantVectorizeLoad", ORE, TheLoop, LD);
+          return false;
+        }
+      } else if (auto *ST = dyn_cast<StoreInst>(&I)) {
+        if (!ST->isSimple() ||
+            !VectorType::isValidElementType(
+                ST->getValueOperand()->getType())) {
+          reportVectorizationFailure("Store instruction cannot be vectorized",
+                                     "store instruction cannot be vectorized",
+                                     "CantVectorizeStore", ORE, TheLoop, ST);
+          return false;
+        }
+      } else if (I.mayHaveSideEffects() || I.mayReadFromMemory()) {
+        reportVectorizationFailure("Found an unsupported memory instruction",
+            "instruction cannot be vectorized",
+            "CantVectorizeInstruction", ORE, TheLoop, &I);
+        return false;
+      }
+
+      if ((!VectorType::isValidElementType(I.getType()) &&
+           !I.getType()->isVoidTy()) ||
+          isa<ExtractElementInst>(I) || isa<InsertElementInst>(I) ||
+          isa<ShuffleVectorInst>(I)) {
+        reportVectorizationFailure("Found unvectorizable type",
+            "instruction return type cannot be vectorized",
+            "CantVectorizeInstructionReturnType", ORE, TheLoop, &I);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 void LoopVectorizationLegality::addInductionPhi(
     PHINode *Phi, const InductionDescriptor &ID,
     SmallPtrSetImpl<Value *> &AllowedExit) {
@@ -953,6 +953,19 @@ public:
   /// possible.
   VectorizationFactor selectVectorizationFactor(unsigned MaxVF);
 
+  /// \return The most profitable vectorization factor and the cost of that VF
+  /// for the outer loop in the VPlan-native path, where every instruction of
+  /// the loop nest is widened and every memory access becomes a gather or a
+  /// scatter. If \p UserVF is not zero, only that factor is considered. A
+  /// factor is only chosen if every call in the loop nest can be widened for
+  /// it, as calls are never scalarized in that path.
+  VectorizationFactor selectOuterLoopVectorizationFactor(unsigned MaxVF,
+                                                         unsigned UserVF);
+
+  /// Returns true if every call in the loop can be widened to a vector
+  /// intrinsic or a vector library call for \p VF.
+  bool canWidenCalls(unsigned VF);
+
   /// Setup cost-based decisions for user vectorization factor.
   void selectUserVectorizationFactor(unsigned UserVF) {
     collectUniformsAndScalars(UserVF);
@@ -5034,6 +5047,66 @@ LoopVectorizationCostModel::selectVectorizationFactor(unsigned MaxVF) {
   return Factor;
 }
 
+bool LoopVectorizationCostModel::canWidenCalls(unsigned VF) {
+  for (BasicBlock *BB : TheLoop->blocks())
+    for (Instruction &I : *BB) {
+      auto *CI = dyn_cast<CallInst>(&I);
+      if (!CI || isa<DbgInfoIntrinsic>(CI))
+        continue;
+      bool NeedToScalarize;
+      unsigned CallCost = getVectorCallCost(CI, VF, NeedToScalarize);
+      bool UseVectorIntrinsic = getVectorIntrinsicIDForCall(CI, TLI) &&
+                                getVectorIntrinsicCost(CI, VF) <= CallCost;
+      if (!UseVectorIntrinsic && NeedToScalarize)
+        return false;
+    }
+  return true;
+}
+
+VectorizationFactor
+LoopVectorizationCostModel::selectOuterLoopVectorizationFactor(
+    unsigned MaxVF, unsigned UserVF) {
+  assert(!TheLoop->empty() && "Outer loop expected.");
+  const float ScalarCost = expectedCost(1).first;
+  LLVM_DEBUG(dbgs() << "LV: Scalar outer loop costs: " << (int)ScalarCost
+                    << ".\n");
+
+  // Outer loops are only vectorized with an explicit hint, but keep the same
+  // rule as for inner loops in case that changes.
+  bool ForceVectorization = Hints->getForce() == LoopVectorizeHints::FK_Enabled;
+  float Cost = ForceVectorization ? std::numeric_limits<float>::max()
+                                  : ScalarCost;
+  unsigned Width = 1;
+  unsigned MinVF = UserVF ? UserVF : 2;
+  if (UserVF)
+    MaxVF = UserVF;
+  for (unsigned VF = MinVF; VF <= MaxVF; VF *= 2) {
+    if (!canWidenCalls(VF)) {
+      LLVM_DEBUG(dbgs() << "LV: Not considering outer loop vector width " << VF
+                        << " because a call would need to be scalarized.\n");
+      continue;
+    }
+    float VectorCost = expectedCost(VF).first / (float)VF;
+    LLVM_DEBUG(dbgs() << "LV: Vector outer loop of width " << VF
+                      << " costs: " << (int)VectorCost << ".\n");
+    if (VectorCost < Cost) {
+      Cost = VectorCost;
+      Width = VF;
+    }
+  }
+
+  if (Width == 1) {
+    LLVM_DEBUG(dbgs() << "LV: Not vectorizing the outer loop: no profitable "
+                         "vectorization factor.\n");
+    return VectorizationFactor::Disabled();
+  }
+  LLVM_DEBUG(if (Cost >= ScalarCost) dbgs()
+             << "LV: Outer loop vectorization seems to be not beneficial, "
+             << "but was forced by a user.\n");
+  LLVM_DEBUG(dbgs() << "LV: Selecting outer loop VF: " << Width << ".\n");
+  return {Width, (unsigned)(Width * Cost)};
+}
+
 std::pair<unsigned, unsigned>
 LoopVectorizationCostModel::getSmallestAndWidestTypes() {
   unsigned MinWidth = -1U;
@@ -5792,6 +5865,10 @@ unsigned LoopVectorizationCostModel::getMemoryInstructionCost(Instruction *I,
     return TTI.getAddressComputationCost(ValTy) +
            TTI.getMemoryOpCost(I->getOpcode(), ValTy, Alignment, AS, I);
   }
+  // The VPlan-native path widens every access to a gather or a scatter, see
+  // getWideningDecision.
+  if (EnableVPlanNativePath)
+    return getGatherScatterCost(I, VF);
   return getWideningCost(I, VF);
 }
 
@@ -6061,7 +6138,8 @@ unsigned LoopVectorizationCostModel::getInstructionCost(Instruction *I,
     // Phi nodes in non-header blocks (not inductions, reductions, etc.) are
     // converted into select instructions. We require N - 1 selects per phi
     // node, where N is the number of incoming values.
-    if (VF > 1 && Phi->getParent() != TheLoop->getHeader())
+    // Loop header phis of an outer loop nest are widened as phis.
+    if (VF > 1 && !LI->isLoopHeader(Phi->getParent()))
       return (Phi->getNumIncomingValues() - 1) *
              TTI.getCmpSelInstrCost(
                  Instruction::Select, ToVectorTy(Phi->getType(), VF),
@@ -6313,29 +6391,40 @@ LoopVectorizationPlanner::planInVPlanNativePath(unsigned UserVF) {
   // the vectorization pipeline.
   if (!OrigLoop->empty()) {
     // If the user doesn't provide a vectorization factor, determine a
-    // reasonable one.
+    // reasonable upper bound for the cost model.
+    unsigned MaxVF = UserVF;
     if (!UserVF) {
-      VF = determineVPlanVF(TTI->getRegisterBitWidth(true /* Vector*/), CM);
-      LLVM_DEBUG(dbgs() << "LV: VPlan computed VF " << VF << ".\n");
+      MaxVF = determineVPlanVF(TTI->getRegisterBitWidth(true /* Vector*/), CM);
+      LLVM_DEBUG(dbgs() << "LV: VPlan computed max VF " << MaxVF << ".\n");
 
       // Make sure we have a VF > 1 for stress testing.
-      if (VPlanBuildStressTest && VF < 2) {
+      if (VPlanBuildStressTest && MaxVF < 2) {
         LLVM_DEBUG(dbgs() << "LV: VPlan stress testing: "
                           << "overriding computed VF.\n");
-        VF = 4;
+        MaxVF = 4;
       }
     }
+
     assert(EnableVPlanNativePath && "VPlan-native path is not enabled.");
+
+    // For VPlan build stress testing, build the plan for the computed VF and
+    // bail out after VPlan construction, without running the cost model.
+    if (VPlanBuildStressTest) {
+      assert(isPowerOf2_32(MaxVF) && "VF needs to be a power of two");
+      buildVPlans(MaxVF, MaxVF);
+      return VectorizationFactor::Disabled();
+    }
+
+    VectorizationFactor Selected =
+        CM.selectOuterLoopVectorizationFactor(MaxVF, UserVF);
+    if (Selected == VectorizationFactor::Disabled())
+      return Selected;
+    VF = Selected.Width;
     assert(isPowerOf2_32(VF) && "VF needs to be a power of two");
     LLVM_DEBUG(dbgs() << "LV: Using " << (UserVF ? "user " : "") << "VF " << VF
                       << " to build VPlans.\n");
     buildVPlans(VF, VF);
-
-    // For VPlan build stress testing, we bail out after VPlan construction.
-    if (VPlanBuildStressTest)
-      return VectorizationFactor::Disabled();
-
-    return {VF, 0};
+    return Selected;
   }
 
   LLVM_DEBUG(
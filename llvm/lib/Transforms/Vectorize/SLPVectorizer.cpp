@@ -123,6 +123,11 @@ static cl::opt<bool> ShouldStartVectorizeHorAtStore(
     cl::desc(
         "Attempt to vectorize horizontal reductions feeding into a store"));
 
+static cl::opt<bool> VectorizeNonPowerOf2(
+    "slp-vectorize-non-power-of-2", cl::init(false), cl::Hidden,
+    cl::desc("Try to vectorize store chains and lists of a length that is not "
+             "a power of two with a single vector of that length"));
+
 static cl::opt<int>
 MaxVectorRegSizeOption("slp-max-reg-size", cl::init(128), cl::Hidden,
     cl::desc("Attempt to vectorize for this register size in bits"));
@@ -5255,6 +5260,8 @@ bool SLPVectorizerPass::runImpl(Function &F, ScalarEvolution *SE_,
 
   // Scan the blocks in the function in post order.
   for (auto BB : post_order(&F.getEntryBlock())) {
+    if (!F.getContext().consumeCompileTimeBudget(F, BB->size()))
+      break;
     collectSeedInstructions(BB);
 
     // Vectorize trees that end at stores.
@@ -5286,14 +5293,11 @@ bool SLPVectorizerPass::runImpl(Function &F, ScalarEvolution *SE_,
 }
 
 bool SLPVectorizerPass::vectorizeStoreChain(ArrayRef<Value *> Chain, BoUpSLP &R,
-                                            unsigned VecRegSize) {
+                                            unsigned VF) {
   const unsigned ChainLen = Chain.size();
   LLVM_DEBUG(dbgs() << "SLP: Analyzing a store chain of length " << ChainLen
                     << "\n");
-  const unsigned Sz = R.getVectorElementSize(Chain[0]);
-  const unsigned VF = VecRegSize / Sz;
-
-  if (!isPowerOf2_32(Sz) || VF < 2)
+  if (VF < 2)
     return false;
 
   bool Changed = false;
@@ -5395,11 +5399,27 @@ bool SLPVectorizerPass::vectorizeStores(ArrayRef<StoreInst *> Stores,
       I = ConsecutiveChain[I];
     }
 
+    const unsigned Sz = R.getVectorElementSize(Operands[0]);
+    if (!isPowerOf2_32(Sz))
+      continue;
+
+    // A chain that does not have a power-of-two length, such as the fields of
+    // a 3- or 6-element struct, is first tried as a single vector, which the
+    // backend pads to a legal type.
+    const unsigned ChainLen = Operands.size();
+    if (VectorizeNonPowerOf2 && ChainLen > 2 && !isPowerOf2_32(ChainLen) &&
+        ChainLen * Sz <= R.getMaxVecRegSize() &&
+        vectorizeStoreChain(Operands, R, ChainLen)) {
+      VectorizedStores.insert(Operands.begin(), Operands.end());
+      Changed = true;
+      continue;
+    }
+
     // FIXME: Is division-by-2 the correct step? Should we assert that the
     // register size is a power-of-2?
     for (unsigned Size = R.getMaxVecRegSize(); Size >= R.getMinVecRegSize();
          Size /= 2) {
-      if (vectorizeStoreChain(Operands, R, Size)) {
+      if (vectorizeStoreChain(Operands, R, Size / Sz)) {
         // Mark the vectorized stores so that we don't vectorize them again.
         VectorizedStores.insert(Operands.begin(), Operands.end());
         Changed = true;
@@ -5471,6 +5491,13 @@ bool SLPVectorizerPass::tryToVectorizeList(ArrayRef<Value *> VL, BoUpSLP &R,
   unsigned Sz = R.getVectorElementSize(I0);
   unsigned MinVF = std::max(2U, R.getMinVecRegSize() / Sz);
   unsigned MaxVF = std::max<unsigned>(PowerOf2Floor(VL.size()), MinVF);
+  // Try the whole list first if it does not have a power-of-two length but
+  // fits a vector register, then fall back to power-of-two factors.
+  if (VectorizeNonPowerOf2 && VL.size() > 2 && !isPowerOf2_32(VL.size()) &&
+      VL.size() * Sz <= R.getMaxVecRegSize()) {
+    MaxVF = VL.size();
+    MinVF = std::min<unsigned>(MinVF, MaxVF);
+  }
   if (MaxVF < 2) {
     R.getORE()->emit([&]() {
       return OptimizationRemarkMissed(SV_NAME, "SmallVF", I0)
@@ -5502,7 +5529,8 @@ bool SLPVectorizerPass::tryToVectorizeList(ArrayRef<Value *> VL, BoUpSLP &R,
   int MinCost = SLPCostThreshold;
 
   unsigned NextInst = 0, MaxInst = VL.size();
-  for (unsigned VF = MaxVF; NextInst + 1 < MaxInst && VF >= MinVF; VF /= 2) {
+  for (unsigned VF = MaxVF; NextInst + 1 < MaxInst && VF >= MinVF;
+       VF = isPowerOf2_32(VF) ? VF / 2 : PowerOf2Floor(VF)) {
     // No actual vectorization should happen, if number of parts is the same as
     // provided vectorization factor (i.e. the scalar type is used for vector
     // code during codegen).
@@ -5517,7 +5545,7 @@ bool SLPVectorizerPass::tryToVectorizeList(ArrayRef<Value *> VL, BoUpSLP &R,
       else
         OpsWidth = VF;
 
-      if (!isPowerOf2_32(OpsWidth) || OpsWidth < 2)
+      if (OpsWidth < 2 || (!isPowerOf2_32(OpsWidth) && OpsWidth != VF))
         break;
 
       ArrayRef<Value *> Ops = VL.slice(I, OpsWidth);
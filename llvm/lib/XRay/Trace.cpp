@@ -10,13 +10,13 @@
 //
 //===----------------------------------------------------------------------===//
 #include "llvm/XRay/Trace.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/DataExtractor.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
-#include "llvm/XRay/BlockIndexer.h"
 #include "llvm/XRay/BlockVerifier.h"
-#include "llvm/XRay/FDRRecordConsumer.h"
 #include "llvm/XRay/FDRRecordProducer.h"
 #include "llvm/XRay/FDRRecords.h"
 #include "llvm/XRay/FDRTraceExpander.h"
@@ -34,8 +34,7 @@ using XRayRecordStorage =
     std::aligned_storage<sizeof(XRayRecord), alignof(XRayRecord)>::type;
 
 Error loadNaiveFormatLog(StringRef Data, bool IsLittleEndian,
-                         XRayFileHeader &FileHeader,
-                         std::vector<XRayRecord> &Records) {
+                         XRayFileHeader &FileHeader, RecordCallback Callback) {
   if (Data.size() < 32)
     return make_error<StringError>(
         "Not enough bytes for an XRay log.",
@@ -63,6 +62,11 @@ Error loadNaiveFormatLog(StringRef Data, bool IsLittleEndian,
   //   (4)   uint32 : thread id
   //   (4)   uint32 : process id
   //   (8)   -      : padding
+  //
+  // Arg payload records follow the record they belong to, so we only hand a
+  // record to the callback once we've seen the next one.
+  XRayRecord Record;
+  bool HasRecord = false;
   while (Reader.isValidOffset(OffsetPtr)) {
     if (!Reader.isValidOffsetForDataOfSize(OffsetPtr, 32))
       return createStringError(
@@ -78,8 +82,11 @@ Error loadNaiveFormatLog(StringRef Data, bool IsLittleEndian,
 
     switch (RecordType) {
     case 0: { // Normal records.
-      Records.emplace_back();
-      auto &Record = Records.back();
+      if (HasRecord)
+        if (auto E = Callback(Record))
+          return E;
+      Record = XRayRecord();
+      HasRecord = true;
       Record.RecordType = RecordType;
 
       PreReadOffset = OffsetPtr;
@@ -148,7 +155,12 @@ Error loadNaiveFormatLog(StringRef Data, bool IsLittleEndian,
       break;
     }
     case 1: { // Arg payload record.
-      auto &Record = Records.back();
+      if (!HasRecord)
+        return createStringError(
+            std::make_error_code(std::errc::executable_format_error),
+            "Found an arg payload without a function record at offset %" PRId64
+            ".",
+            OffsetPtr);
 
       // We skip the next two bytes of the record, because we don't need the
       // type and the CPU record for arg payloads.
@@ -207,6 +219,81 @@ Error loadNaiveFormatLog(StringRef Data, bool IsLittleEndian,
     // basic mode logs.
     OffsetPtr += 8;
   }
+  if (HasRecord)
+    return Callback(Record);
+  return Error::success();
+}
+
+// To avoid keeping all the records of a large FDR log in memory, we read the
+// log twice: the first pass only finds the extents of the blocks (a NewBuffer
+// record and the records that follow it) of each process+thread, and the
+// second pass reads the records of one block at a time from those offsets.
+struct BlockExtent {
+  // Offset of the first record of the block. This is the BufferExtents record
+  // preceding the block's NewBuffer record when there is one, so that a
+  // record producer starting there knows the size of the buffer.
+  uint64_t Start;
+  // Offset just past the last record of the block.
+  uint64_t End;
+  uint64_t Seconds;
+  uint32_t Nanos;
+};
+
+using BlockExtentIndex =
+    DenseMap<std::pair<uint64_t, int32_t>, std::vector<BlockExtent>>;
+
+Error indexFDRBlocks(const XRayFileHeader &FileHeader, DataExtractor &DE,
+                     uint64_t OffsetPtr, BlockExtentIndex &Index) {
+  // Like the BlockIndexer, records that appear before the first NewBuffer
+  // record belong to a block for process 0 and thread 0.
+  uint64_t ProcessID = 0;
+  int32_t ThreadID = 0;
+  BlockExtent Current{OffsetPtr, OffsetPtr, 0, 0};
+  bool HasRecords = false;
+  Optional<uint64_t> ExtentsOffset;
+
+  FileBasedRecordProducer P(FileHeader, DE, OffsetPtr);
+  while (DE.isValidOffsetForDataOfSize(OffsetPtr, 1)) {
+    auto PreReadOffset = OffsetPtr;
+    auto R = P.produce();
+    if (!R)
+      return R.takeError();
+    Record *Rec = R->get();
+
+    if (isa<BufferExtents>(Rec)) {
+      // The producer may skip garbage to find a BufferExtents record, so work
+      // back from where the 16 byte metadata record ends.
+      ExtentsOffset = OffsetPtr - 16;
+      continue;
+    }
+
+    if (auto *NB = dyn_cast<NewBufferRecord>(Rec)) {
+      // From version 3 on, the producer only reads records that are within a
+      // buffer, so a block has to start at its buffer's extents to be read
+      // again.
+      if (FileHeader.Version >= 3 && !ExtentsOffset)
+        return createStringError(
+            std::make_error_code(std::errc::executable_format_error),
+            "Found a NewBuffer record that doesn't start a buffer at offset "
+            "%" PRId64 ".",
+            PreReadOffset);
+      if (HasRecords)
+        Index[{ProcessID, ThreadID}].push_back(Current);
+      Current = {ExtentsOffset.getValueOr(PreReadOffset), OffsetPtr, 0, 0};
+      ProcessID = 0;
+      ThreadID = NB->tid();
+    } else if (auto *PR = dyn_cast<PIDRecord>(Rec)) {
+      ProcessID = PR->pid();
+    } else if (auto *WR = dyn_cast<WallclockRecord>(Rec)) {
+      Current.Seconds = WR->seconds();
+      Current.Nanos = WR->nanos();
+    }
+    ExtentsOffset.reset();
+    HasRecords = true;
+    Current.End = OffsetPtr;
+  }
+  if (HasRecords)
+    Index[{ProcessID, ThreadID}].push_back(Current);
   return Error::success();
 }
 
@@ -265,7 +352,7 @@ Error loadNaiveFormatLog(StringRef Data, bool IsLittleEndian,
 /// id in the CustomEventRecord.
 ///
 Error loadFDRLog(StringRef Data, bool IsLittleEndian,
-                 XRayFileHeader &FileHeader, std::vector<XRayRecord> &Records) {
+                 XRayFileHeader &FileHeader, RecordCallback Callback) {
 
   if (Data.size() < 32)
     return createStringError(std::make_error_code(std::errc::invalid_argument),
@@ -278,77 +365,63 @@ Error loadFDRLog(StringRef Data, bool IsLittleEndian,
     return FileHeaderOrError.takeError();
   FileHeader = std::move(FileHeaderOrError.get());
 
-  // First we load the records into memory.
-  std::vector<std::unique_ptr<Record>> FDRRecords;
-
-  {
-    FileBasedRecordProducer P(FileHeader, DE, OffsetPtr);
-    LogBuilderConsumer C(FDRRecords);
-    while (DE.isValidOffsetForDataOfSize(OffsetPtr, 1)) {
-      auto R = P.produce();
-      if (!R)
-        return R.takeError();
-      if (auto E = C.consume(std::move(R.get())))
-        return E;
-    }
-  }
-
-  // Next we index the records into blocks.
-  BlockIndexer::Index Index;
-  {
-    BlockIndexer Indexer(Index);
-    for (auto &R : FDRRecords)
-      if (auto E = R->apply(Indexer))
-        return E;
-    if (auto E = Indexer.flush())
-      return E;
-  }
-
-  // Then we verify the consistency of the blocks.
-  {
-    for (auto &PTB : Index) {
-      auto &Blocks = PTB.second;
-      for (auto &B : Blocks) {
-        BlockVerifier Verifier;
-        for (auto *R : B.Records)
-          if (auto E = R->apply(Verifier))
-            return E;
-        if (auto E = Verifier.verify())
-          return E;
-      }
-    }
-  }
+  // First we find the blocks of each process+thread, without keeping any of
+  // the records.
+  BlockExtentIndex Index;
+  if (auto E = indexFDRBlocks(FileHeader, DE, OffsetPtr, Index))
+    return E;
 
   // This is now the meat of the algorithm. Here we sort the blocks according to
   // the Walltime record in each of the blocks for the same thread. This allows
   // us to more consistently recreate the execution trace in temporal order.
-  // After the sort, we then reconstitute `Trace` records using a stateful
+  // After the sort, we then read the records of each block again, verify the
+  // consistency of the block, and reconstitute `Trace` records using a stateful
   // visitor associated with a single process+thread pair.
-  {
-    for (auto &PTB : Index) {
-      auto &Blocks = PTB.second;
-      llvm::sort(Blocks, [](const BlockIndexer::Block &L,
-                            const BlockIndexer::Block &R) {
-        return (L.WallclockTime->seconds() < R.WallclockTime->seconds() &&
-                L.WallclockTime->nanos() < R.WallclockTime->nanos());
-      });
-      auto Adder = [&](const XRayRecord &R) { Records.push_back(R); };
-      TraceExpander Expander(Adder, FileHeader.Version);
-      for (auto &B : Blocks) {
-        for (auto *R : B.Records)
-          if (auto E = R->apply(Expander))
-            return E;
+  for (auto &PTB : Index) {
+    auto &Blocks = PTB.second;
+    llvm::sort(Blocks, [](const BlockExtent &L, const BlockExtent &R) {
+      return (L.Seconds < R.Seconds && L.Nanos < R.Nanos);
+    });
+
+    // The expander can't return the callback's errors, so we hold on to the
+    // first one and stop once we see it.
+    Error CallbackErr = Error::success();
+    auto Adder = [&](const XRayRecord &R) {
+      if (!CallbackErr)
+        CallbackErr = Callback(R);
+    };
+    TraceExpander Expander(Adder, FileHeader.Version);
+    for (auto &B : Blocks) {
+      uint64_t BlockOffset = B.Start;
+      FileBasedRecordProducer P(FileHeader, DE, BlockOffset);
+      BlockVerifier Verifier;
+      while (BlockOffset < B.End) {
+        auto R = P.produce();
+        if (!R)
+          return joinErrors(std::move(CallbackErr), R.takeError());
+        if (isa<BufferExtents>(R->get()))
+          continue;
+        if (auto E = (*R)->apply(Verifier))
+          return joinErrors(std::move(CallbackErr), std::move(E));
+        if (auto E = (*R)->apply(Expander))
+          return joinErrors(std::move(CallbackErr), std::move(E));
+        if (CallbackErr)
+          return CallbackErr;
       }
-      if (auto E = Expander.flush())
-        return E;
+      if (auto E = Verifier.verify())
+        return joinErrors(std::move(CallbackErr), std::move(E));
     }
+    if (auto E = Expander.flush())
+      return joinErrors(std::move(CallbackErr), std::move(E));
+    if (CallbackErr)
+      return CallbackErr;
   }
 
   return Error::success();
 }
 
 Error loadYAMLLog(StringRef Data, XRayFileHeader &FileHeader,
-                  std::vector<XRayRecord> &Records) {
+                  RecordCallback Callback) {
   YAMLXRayTrace Trace;
   Input In(Data);
   In >> Trace;
@@ -366,18 +439,16 @@ Error loadYAMLLog(StringRef Data, XRayFileHeader &FileHeader,
         Twine("Unsupported XRay file version: ") + Twine(FileHeader.Version),
         std::make_error_code(std::errc::invalid_argument));
 
-  Records.clear();
-  std::transform(Trace.Records.begin(), Trace.Records.end(),
-                 std::back_inserter(Records), [&](const YAMLXRayRecord &R) {
-                   return XRayRecord{R.RecordType, R.CPU,      R.Type,
-                                     R.FuncId,     R.TSC,      R.TId,
-                                     R.PId,        R.CallArgs, R.Data};
-                 });
+  // YAML traces are parsed as a whole, so we only stream the conversion.
+  for (const YAMLXRayRecord &R : Trace.Records)
+    if (auto E = Callback(XRayRecord{R.RecordType, R.CPU, R.Type, R.FuncId,
+                                     R.TSC, R.TId, R.PId, R.CallArgs, R.Data}))
+      return E;
   return Error::success();
 }
-} // namespace
 
-Expected<Trace> llvm::xray::loadTraceFile(StringRef Filename, bool Sort) {
+/// Maps the file into memory and hands its contents to |F|.
+Error withMappedFile(StringRef Filename, function_ref<Error(StringRef)> F) {
   Expected<sys::fs::file_t> FdOrErr = sys::fs::openNativeFileForRead(Filename);
   if (!FdOrErr)
     return FdOrErr.takeError();
@@ -403,19 +474,49 @@ Expected<Trace> llvm::xray::loadTraceFile(StringRef Filename, bool Sort) {
     return make_error<StringError>(
         Twine("Cannot read log from '") + Filename + "'", EC);
   }
-  auto Data = StringRef(MappedFile.data(), MappedFile.size());
-
-  // TODO: Lift the endianness and implementation selection here.
-  DataExtractor LittleEndianDE(Data, true, 8);
-  auto TraceOrError = loadTrace(LittleEndianDE, Sort);
-  if (!TraceOrError) {
-    DataExtractor BigEndianDE(Data, false, 8);
-    TraceOrError = loadTrace(BigEndianDE, Sort);
-  }
-  return TraceOrError;
+  return F(StringRef(MappedFile.data(), MappedFile.size()));
 }
+} // namespace
 
-Expected<Trace> llvm::xray::loadTrace(const DataExtractor &DE, bool Sort) {
+Expected<Trace> llvm::xray::loadTraceFile(StringRef Filename, bool Sort) {
+  Optional<Trace> T;
+  if (auto E = withMappedFile(Filename, [&](StringRef Data) -> Error {
+        // TODO: Lift the endianness and implementation selection here.
+        DataExtractor LittleEndianDE(Data, true, 8);
+        auto TraceOrError = loadTrace(LittleEndianDE, Sort);
+        if (!TraceOrError) {
+          DataExtractor BigEndianDE(Data, false, 8);
+          TraceOrError = loadTrace(BigEndianDE, Sort);
+        }
+        if (!TraceOrError)
+          return TraceOrError.takeError();
+        T = std::move(*TraceOrError);
+        return Error::success();
+      }))
+    return std::move(E);
+  return std::move(*T);
+}
+
+Error llvm::xray::processTraceFile(StringRef Filename, XRayFileHeader &Header,
+                                   RecordCallback Callback) {
+  return withMappedFile(Filename, [&](StringRef Data) -> Error {
+    // Like loadTraceFile(), we try big endian when reading the file as little
+    // endian fails, but only as long as no record has been handed out.
+    bool Delivered = false;
+    auto E = processTrace(DataExtractor(Data, true, 8), Header,
+                          [&](const XRayRecord &R) {
+                            Delivered = true;
+                            return Callback(R);
+                          });
+    if (!E || Delivered)
+      return E;
+    consumeError(std::move(E));
+    return processTrace(DataExtractor(Data, false, 8), Header, Callback);
+  });
+}
+
+Error llvm::xray::processTrace(const DataExtractor &DE, XRayFileHeader &Header,
+                               RecordCallback Callback) {
   // Attempt to detect the file type using file magic. We have a slight bias
   // towards the binary format, and we do this by making sure that the first 4
   // bytes of the binary file is some combination of the following byte
@@ -437,35 +538,33 @@ Expected<Trace> llvm::xray::loadTrace(const DataExtractor &DE, bool Sort) {
 
   enum BinaryFormatType { NAIVE_FORMAT = 0, FLIGHT_DATA_RECORDER_FORMAT = 1 };
 
-  Trace T;
   switch (Type) {
   case NAIVE_FORMAT:
-    if (Version == 1 || Version == 2 || Version == 3) {
-      if (auto E = loadNaiveFormatLog(DE.getData(), DE.isLittleEndian(),
-                                      T.FileHeader, T.Records))
-        return std::move(E);
-    } else {
-      return make_error<StringError>(
-          Twine("Unsupported version for Basic/Naive Mode logging: ") +
-              Twine(Version),
-          std::make_error_code(std::errc::executable_format_error));
-    }
-    break;
+    if (Version == 1 || Version == 2 || Version == 3)
+      return loadNaiveFormatLog(DE.getData(), DE.isLittleEndian(), Header,
+                                Callback);
+    return make_error<StringError>(
+        Twine("Unsupported version for Basic/Naive Mode logging: ") +
+            Twine(Version),
+        std::make_error_code(std::errc::executable_format_error));
   case FLIGHT_DATA_RECORDER_FORMAT:
-    if (Version >= 1 && Version <= 5) {
-      if (auto E = loadFDRLog(DE.getData(), DE.isLittleEndian(), T.FileHeader,
-                              T.Records))
-        return std::move(E);
-    } else {
-      return make_error<StringError>(
-          Twine("Unsupported version for FDR Mode logging: ") + Twine(Version),
-          std::make_error_code(std::errc::executable_format_error));
-    }
-    break;
+    if (Version >= 1 && Version <= 5)
+      return loadFDRLog(DE.getData(), DE.isLittleEndian(), Header, Callback);
+    return make_error<StringError>(
+        Twine("Unsupported version for FDR Mode logging: ") + Twine(Version),
+        std::make_error_code(std::errc::executable_format_error));
   default:
-    if (auto E = loadYAMLLog(DE.getData(), T.FileHeader, T.Records))
-      return std::move(E);
+    return loadYAMLLog(DE.getData(), Header, Callback);
   }
+}
+
+Expected<Trace> llvm::xray::loadTrace(const DataExtractor &DE, bool Sort) {
+  Trace T;
+  if (auto E = processTrace(DE, T.FileHeader, [&](const XRayRecord &R) {
+        T.Records.push_back(R);
+        return Error::success();
+      }))
+    return std::move(E);
 
   if (Sort)
     llvm::stable_sort(T.Records, [&](const XRayRecord &L, const XRayRecord &R) {
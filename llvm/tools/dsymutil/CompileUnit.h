@@ -9,6 +9,7 @@
 #ifndef LLVM_TOOLS_DSYMUTIL_COMPILEUNIT_H
 #define LLVM_TOOLS_DSYMUTIL_COMPILEUNIT_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/IntervalMap.h"
 #include "llvm/CodeGen/DIE.h"
 #include "llvm/DebugInfo/DWARF/DWARFUnit.h"
@@ -251,6 +252,22 @@ public:
   MCSymbol *getLabelBegin() { return LabelBegin; }
   void setLabelBegin(MCSymbol *S) { LabelBegin = S; }
 
+  /// Remember that the DIE at index \p Idx is in the context \p Ctxt.
+  /// \returns the index of the first DIE of this unit in the same context, or
+  /// None if this is the first one.
+  Optional<uint32_t> noteDeclContext(const DeclContext *Ctxt, uint32_t Idx) {
+    auto It = SeenDeclContexts.try_emplace(Ctxt, Idx);
+    if (It.second)
+      return None;
+    return It.first->second;
+  }
+
+  /// Free the contexts recorded by noteDeclContext() once the unit has been
+  /// analyzed.
+  void forgetDeclContexts() {
+    DenseMap<const DeclContext *, uint32_t>().swap(SeenDeclContexts);
+  }
+
 private:
   DWARFUnit &OrigUnit;
   unsigned ID;
@@ -312,6 +329,11 @@ private:
   /// for the purposes of getting a unique address for each string.
   std::vector<StringRef> ResolvedPaths;
 
+  /// The index of the first DIE of this unit in each context. These are kept
+  /// per unit rather than in the shared contexts so that the units can be
+  /// analyzed concurrently.
+  DenseMap<const DeclContext *, uint32_t> SeenDeclContexts;
+
   /// Is this unit subject to the ODR rule?
   bool HasODR;
 
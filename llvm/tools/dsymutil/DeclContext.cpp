@@ -14,8 +14,8 @@
 namespace llvm {
 namespace dsymutil {
 
-/// Set the last DIE/CU a context was seen in and, possibly invalidate the
-/// context if it is ambiguous.
+/// Record that a context was seen in the DIE of a CU and, possibly invalidate
+/// the context if it is ambiguous.
 ///
 /// In the current implementation, we don't handle overloaded functions well,
 /// because the argument types are not taken into account when computing the
@@ -29,15 +29,11 @@ namespace dsymutil {
 /// If a context that is not a namespace appears twice in the same CU, we know
 /// it is ambiguous. Make it invalid.
 bool DeclContext::setLastSeenDIE(CompileUnit &U, const DWARFDie &Die) {
-  if (LastSeenCompileUnitID == U.getUniqueID()) {
-    DWARFUnit &OrigUnit = U.getOrigUnit();
-    uint32_t FirstIdx = OrigUnit.getDIEIndex(LastSeenDIE);
-    U.getInfo(FirstIdx).Ctxt = nullptr;
+  if (Optional<uint32_t> FirstIdx =
+          U.noteDeclContext(this, U.getOrigUnit().getDIEIndex(Die))) {
+    U.getInfo(*FirstIdx).Ctxt = nullptr;
     return false;
   }
-
-  LastSeenCompileUnitID = U.getUniqueID();
-  LastSeenDIE = Die;
   return true;
 }
 
@@ -87,17 +83,20 @@ PointerIntPair<DeclContext *, 1> DeclContextTree::getChildDeclContext(
   StringRef ShortNameRef;
   StringRef FileRef;
 
-  if (Name)
-    NameRef = StringPool.internString(Name);
-  else if (Tag == dwarf::DW_TAG_namespace)
-    // FIXME: For dsymutil-classic compatibility. I think uniquing within
-    // anonymous namespaces is wrong. There is no ODR guarantee there.
-    NameRef = StringPool.internString("(anonymous namespace)");
-
-  if (ShortName && ShortName != Name)
-    ShortNameRef = StringPool.internString(ShortName);
-  else
-    ShortNameRef = NameRef;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (Name)
+      NameRef = StringPool.internString(Name);
+    else if (Tag == dwarf::DW_TAG_namespace)
+      // FIXME: For dsymutil-classic compatibility. I think uniquing within
+      // anonymous namespaces is wrong. There is no ODR guarantee there.
+      NameRef = StringPool.internString("(anonymous namespace)");
+
+    if (ShortName && ShortName != Name)
+      ShortNameRef = StringPool.internString(ShortName);
+    else
+      ShortNameRef = NameRef;
+  }
 
   if (Tag != dwarf::DW_TAG_class_type && Tag != dwarf::DW_TAG_structure_type &&
       Tag != dwarf::DW_TAG_union_type &&
@@ -146,6 +145,7 @@ PointerIntPair<DeclContext *, 1> DeclContextTree::getChildDeclContext(
               assert(FoundFileName && "Must get file name from line table");
               // Second level of caching, this time based on the file's parent
               // path.
+              std::lock_guard<std::mutex> Lock(Mutex);
               FileRef = PathResolver.resolve(File, StringPool);
               U.setResolvedPath(FileNum, FileRef);
             }
@@ -176,18 +176,20 @@ PointerIntPair<DeclContext *, 1> DeclContextTree::getChildDeclContext(
     Hash = hash_combine(Hash, FileRef);
 
   // Now look if this context already exists.
+  std::lock_guard<std::mutex> Lock(Mutex);
   DeclContext Key(Hash, Line, ByteSize, Tag, NameRef, FileRef, Context);
   auto ContextIter = Contexts.find(&Key);
 
   if (ContextIter == Contexts.end()) {
     // The context wasn't found.
     bool Inserted;
-    DeclContext *NewContext =
-        new (Allocator) DeclContext(Hash, Line, ByteSize, Tag, NameRef, FileRef,
-                                    Context, DIE, U.getUniqueID());
+    DeclContext *NewContext = new (Allocator)
+        DeclContext(Hash, Line, ByteSize, Tag, NameRef, FileRef, Context);
     std::tie(ContextIter, Inserted) = Contexts.insert(NewContext);
     assert(Inserted && "Failed to insert DeclContext");
     (void)Inserted;
+    if (Tag != dwarf::DW_TAG_namespace)
+      NewContext->setLastSeenDIE(U, DIE);
   } else if (Tag != dwarf::DW_TAG_namespace &&
              !(*ContextIter)->setLastSeenDIE(U, DIE)) {
     // The context was found, but it is ambiguous with another context
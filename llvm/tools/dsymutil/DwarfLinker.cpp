@@ -2675,6 +2675,17 @@ bool DwarfLinker::link(const DebugMap &Map) {
     }
   }
 
+  // Number the compile units of the objects up front, so that the objects can
+  // be analyzed concurrently.
+  for (LinkContext &LinkContext : ObjectContexts) {
+    if (!LinkContext.ObjectFile || !LinkContext.DwarfContext)
+      continue;
+    LinkContext.FirstUnitID = UnitID;
+    UnitID += LinkContext.DwarfContext->getNumCompileUnits();
+    for (const auto &CU : LinkContext.DwarfContext->compile_units())
+      updateDwarfVersion(CU->getVersion());
+  }
+
   // If we haven't seen any CUs, pick an arbitrary valid Dwarf version anyway.
   if (MaxDwarfVersion == 0)
     MaxDwarfVersion = 3;
@@ -2691,17 +2702,22 @@ bool DwarfLinker::link(const DebugMap &Map) {
   std::mutex ProcessedFilesMutex;
   std::condition_variable ProcessedFilesConditionVariable;
   BitVector ProcessedFiles(NumObjects, false);
+  // Serializes the lookups of the clang modules by the analysis.
+  std::mutex ModulesMutex;
 
   //  Analyzing the context info is particularly expensive so it is executed in
-  //  parallel with emitting the previous compile unit.
+  //  parallel with emitting the previous compile unit. The objects are
+  //  analyzed concurrently: the DeclContextTree is shared, but everything that
+  //  depends on the order of the objects is either recorded per unit or done
+  //  when cloning.
   auto AnalyzeLambda = [&](size_t i) {
     auto &LinkContext = ObjectContexts[i];
 
     if (!LinkContext.ObjectFile || !LinkContext.DwarfContext)
       return;
 
+    unsigned ObjectUnitID = LinkContext.FirstUnitID;
     for (const auto &CU : LinkContext.DwarfContext->compile_units()) {
-      updateDwarfVersion(CU->getVersion());
       // The !registerModuleReference() condition effectively skips
       // over fully resolved skeleton units. This second pass of
       // registerModuleReferences doesn't do any new work, but it
@@ -2709,14 +2725,17 @@ bool DwarfLinker::link(const DebugMap &Map) {
       // warnings were already displayed in the first iteration.
       bool Quiet = true;
       auto CUDie = CU->getUnitDIE(false);
-      if (!CUDie || LLVM_UNLIKELY(Options.Update) ||
-          !registerModuleReference(CUDie, *CU, ModuleMap, LinkContext.DMO,
-                                   LinkContext.Ranges, OffsetsStringPool,
-                                   UniquingStringPool, ODRContexts,
-                                   ModulesEndOffset, UnitID, Quiet)) {
-        LinkContext.CompileUnits.push_back(std::make_unique<CompileUnit>(
-            *CU, UnitID++, !Options.NoODR && !Options.Update, ""));
+      bool IsModuleReference = false;
+      if (CUDie && !LLVM_UNLIKELY(Options.Update)) {
+        std::lock_guard<std::mutex> LockGuard(ModulesMutex);
+        IsModuleReference = registerModuleReference(
+            CUDie, *CU, ModuleMap, LinkContext.DMO, LinkContext.Ranges,
+            OffsetsStringPool, UniquingStringPool, ODRContexts,
+            ModulesEndOffset, ObjectUnitID, Quiet);
       }
+      if (!IsModuleReference)
+        LinkContext.CompileUnits.push_back(std::make_unique<CompileUnit>(
+            *CU, ObjectUnitID++, !Options.NoODR && !Options.Update, ""));
     }
 
     // Now build the DIE parent links that we will use during the next phase.
@@ -2727,10 +2746,11 @@ bool DwarfLinker::link(const DebugMap &Map) {
       analyzeContextInfo(CurrentUnit->getOrigUnit().getUnitDIE(), 0,
                          *CurrentUnit, &ODRContexts.getRoot(),
                          UniquingStringPool, ODRContexts, ModulesEndOffset,
-                         ParseableSwiftInterfaces,
+                         LinkContext.ParseableSwiftInterfaces,
                          [&](const Twine &Warning, const DWARFDie &DIE) {
                            reportWarning(Warning, LinkContext.DMO, &DIE);
                          });
+      CurrentUnit->forgetDeclContexts();
     }
   };
 
@@ -2743,6 +2763,18 @@ bool DwarfLinker::link(const DebugMap &Map) {
     if (!LinkContext.ObjectFile)
       return;
 
+    // Merge the Swift interfaces in the order of the objects, so that the
+    // conflicts are resolved the same way whatever the order of the analysis.
+    for (const auto &NameAndPath : LinkContext.ParseableSwiftInterfaces) {
+      auto &Entry = ParseableSwiftInterfaces[NameAndPath.first];
+      if (!Entry.empty() && Entry != NameAndPath.second)
+        reportWarning(
+            Twine("Conflicting parseable interfaces for Swift Module ") +
+                NameAndPath.first + ": " + Entry + " and " + NameAndPath.second,
+            LinkContext.DMO);
+      Entry = NameAndPath.second;
+    }
+
     // Then mark all the DIEs that need to be present in the linked output
     // and collect some information about them.
     // Note that this loop can not be merged with the previous one because
@@ -2802,14 +2834,12 @@ bool DwarfLinker::link(const DebugMap &Map) {
     }
   };
 
-  auto AnalyzeAll = [&]() {
-    for (unsigned i = 0, e = NumObjects; i != e; ++i) {
-      AnalyzeLambda(i);
+  auto AnalyzeAndNotify = [&](size_t i) {
+    AnalyzeLambda(i);
 
-      std::unique_lock<std::mutex> LockGuard(ProcessedFilesMutex);
-      ProcessedFiles.set(i);
-      ProcessedFilesConditionVariable.notify_one();
-    }
+    std::unique_lock<std::mutex> LockGuard(ProcessedFilesMutex);
+    ProcessedFiles.set(i);
+    ProcessedFilesConditionVariable.notify_one();
   };
 
   auto CloneAll = [&]() {
@@ -2837,9 +2867,13 @@ bool DwarfLinker::link(const DebugMap &Map) {
     }
     EmitLambda();
   } else {
-    ThreadPool pool(2);
-    pool.async(AnalyzeAll);
+    // A single thread clones the objects in their order in the debug map, as
+    // the output offsets and the ODR uniquing of the types depend on it. The
+    // other threads analyze the objects ahead of it.
+    ThreadPool pool(std::max(2u, Options.Threads));
     pool.async(CloneAll);
+    for (unsigned i = 0, e = NumObjects; i != e; ++i)
+      pool.async(AnalyzeAndNotify, i);
     pool.wait();
   }
 
@@ -147,6 +147,11 @@ private:
     std::unique_ptr<DWARFContext> DwarfContext;
     RangesTy Ranges;
     UnitListTy CompileUnits;
+    /// The unique ID of the first compile unit of the object.
+    unsigned FirstUnitID = 0;
+    /// The .swiftinterface files referenced by the object, merged into
+    /// DwarfLinker::ParseableSwiftInterfaces in the order of the objects.
+    std::map<std::string, std::string> ParseableSwiftInterfaces;
 
     LinkContext(const DebugMap &Map, DwarfLinker &Linker, DebugMapObject &DMO)
         : DMO(DMO), RelocMgr(Linker) {
@@ -166,6 +171,7 @@ private:
       DwarfContext.reset(nullptr);
       CompileUnits.clear();
       Ranges.clear();
+      ParseableSwiftInterfaces.clear();
     }
   };
 
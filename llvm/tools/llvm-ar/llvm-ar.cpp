@@ -11,6 +11,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/IR/LLVMContext.h"
@@ -733,6 +734,29 @@ static InsertAction computeInsertAction(ArchiveOperation Operation,
   llvm_unreachable("No such operation");
 }
 
+// Reads the symbol table of an archive that is being updated, as the names of
+// the archive symbols of each member by the offset of the member. Members
+// that are kept don't need to be parsed again to write the new table. The
+// table of a thin archive describes files that may have changed since, so it
+// isn't used.
+static DenseMap<uint64_t, std::vector<StringRef>>
+getOldMemberSymbols(const object::Archive &OldArchive) {
+  DenseMap<uint64_t, std::vector<StringRef>> Ret;
+  if (!Symtab || OldArchive.isThin() || !OldArchive.hasSymbolTable())
+    return Ret;
+  for (const object::Archive::Symbol &Sym : OldArchive.symbols()) {
+    Expected<object::Archive::Child> ChildOrErr = Sym.getMember();
+    if (!ChildOrErr) {
+      // Parse the members rather than trust a broken table.
+      consumeError(ChildOrErr.takeError());
+      Ret.clear();
+      return Ret;
+    }
+    Ret[ChildOrErr->getChildOffset()].push_back(Sym.getName());
+  }
+  return Ret;
+}
+
 // We have to walk this twice and computing it is not trivial, so creating an
 // explicit std::vector is actually fairly efficient.
 static std::vector<NewArchiveMember>
@@ -743,6 +767,17 @@ computeNewArchiveMembers(ArchiveOperation Operation,
   int InsertPos = -1;
   if (OldArchive) {
     std::string PosName = normalizePath(RelPos);
+    DenseMap<uint64_t, std::vector<StringRef>> OldSymbols =
+        getOldMemberSymbols(*OldArchive);
+    // The old archive is not thin when there are symbols to reuse, so a
+    // child adds exactly one member.
+    auto AddOldMember = [&](std::vector<NewArchiveMember> &Members,
+                            const object::Archive::Child &Child) {
+      addChildMember(Members, Child, /*FlattenArchive=*/Thin);
+      auto It = OldSymbols.find(Child.getChildOffset());
+      if (It != OldSymbols.end())
+        Members.back().Symbols = std::move(It->second);
+    };
     Error Err = Error::success();
     StringMap<int> MemberCount;
     for (auto &Child : OldArchive->children(Err)) {
@@ -763,7 +798,7 @@ computeNewArchiveMembers(ArchiveOperation Operation,
           computeInsertAction(Operation, Child, Name, MemberI, MemberCount);
       switch (Action) {
       case IA_AddOldMember:
-        addChildMember(Ret, Child, /*FlattenArchive=*/Thin);
+        AddOldMember(Ret, Child);
         break;
       case IA_AddNewMember:
         addMember(Ret, *MemberI);
@@ -771,7 +806,7 @@ computeNewArchiveMembers(ArchiveOperation Operation,
       case IA_Delete:
         break;
       case IA_MoveOldMember:
-        addChildMember(Moved, Child, /*FlattenArchive=*/Thin);
+        AddOldMember(Moved, Child);
         break;
       case IA_MoveNewMember:
         addMember(Moved, *MemberI);
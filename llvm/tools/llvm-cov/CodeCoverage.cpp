@@ -151,9 +151,10 @@ private:
   /// A lock which guards printing to stderr.
   std::mutex ErrsLock;
 
-  /// A container for input source file buffers.
+  /// A container for input source file buffers, keyed by the unique ID of
+  /// the file so that equivalent paths share a buffer.
   std::mutex LoadedSourceFilesLock;
-  std::vector<std::pair<std::string, std::unique_ptr<MemoryBuffer>>>
+  std::map<sys::fs::UniqueID, std::unique_ptr<MemoryBuffer>>
       LoadedSourceFiles;
 
   /// Whitelist from -name-whitelist to be used for filtering.
@@ -230,22 +231,36 @@ void CodeCoverageTool::collectPaths(const std::string &Path) {
 ErrorOr<const MemoryBuffer &>
 CodeCoverageTool::getSourceFile(StringRef SourceFile) {
   // If we've remapped filenames, look up the real location for this file.
-  std::unique_lock<std::mutex> Guard{LoadedSourceFilesLock};
   if (!RemappedFilenames.empty()) {
     auto Loc = RemappedFilenames.find(SourceFile);
     if (Loc != RemappedFilenames.end())
       SourceFile = Loc->second;
   }
-  for (const auto &Files : LoadedSourceFiles)
-    if (sys::fs::equivalent(SourceFile, Files.first))
-      return *Files.second;
+  // Look the file up by its unique ID instead of comparing it with each of
+  // the loaded files, which is quadratic in the number of files.
+  sys::fs::UniqueID ID;
+  if (std::error_code EC = sys::fs::getUniqueID(SourceFile, ID)) {
+    error(EC.message(), SourceFile);
+    return EC;
+  }
+  {
+    std::lock_guard<std::mutex> Guard(LoadedSourceFilesLock);
+    auto It = LoadedSourceFiles.find(ID);
+    if (It != LoadedSourceFiles.end())
+      return *It->second;
+  }
+  // Read the file without holding the lock so that the threads rendering
+  // different files don't wait on each other.
   auto Buffer = MemoryBuffer::getFile(SourceFile);
   if (auto EC = Buffer.getError()) {
     error(EC.message(), SourceFile);
     return EC;
   }
-  LoadedSourceFiles.emplace_back(SourceFile, std::move(Buffer.get()));
-  return *LoadedSourceFiles.back().second;
+  std::lock_guard<std::mutex> Guard(LoadedSourceFilesLock);
+  std::unique_ptr<MemoryBuffer> &Loaded = LoadedSourceFiles[ID];
+  if (!Loaded)
+    Loaded = std::move(Buffer.get());
+  return *Loaded;
 }
 
 void CodeCoverageTool::attachExpansionSubViews(
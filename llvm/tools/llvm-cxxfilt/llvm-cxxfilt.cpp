@@ -56,6 +56,8 @@ static cl::extrahelp
     HelpResponse("\nPass @FILE as argument to read options from FILE.\n");
 
 static std::string demangle(llvm::raw_ostream &OS, const std::string &Mangled) {
+  // Reuses its memory from one name to the next.
+  static ItaniumDemangleContext Demangler;
   int Status;
 
   const char *DecoratedStr = Mangled.c_str();
@@ -64,22 +66,20 @@ static std::string demangle(llvm::raw_ostream &OS, const std::string &Mangled) {
       ++DecoratedStr;
   size_t DecoratedLength = strlen(DecoratedStr);
 
-  char *Undecorated = nullptr;
+  const char *Undecorated = nullptr;
 
   if (Types ||
       ((DecoratedLength >= 2 && strncmp(DecoratedStr, "_Z", 2) == 0) ||
        (DecoratedLength >= 4 && strncmp(DecoratedStr, "___Z", 4) == 0)))
-    Undecorated = itaniumDemangle(DecoratedStr, nullptr, nullptr, &Status);
+    Undecorated = Demangler.demangle(DecoratedStr, &Status);
 
   if (!Undecorated &&
       (DecoratedLength > 6 && strncmp(DecoratedStr, "__imp_", 6) == 0)) {
     OS << "import thunk for ";
-    Undecorated = itaniumDemangle(DecoratedStr + 6, nullptr, nullptr, &Status);
+    Undecorated = Demangler.demangle(DecoratedStr + 6, &Status);
   }
 
-  std::string Result(Undecorated ? Undecorated : Mangled);
-  free(Undecorated);
-  return Result;
+  return Undecorated ? Undecorated : Mangled;
 }
 
 // Split 'Source' on any character that fails to pass 'IsLegalChar'.  The
@@ -6,6 +6,7 @@
 #include "llvm/DebugInfo/DWARF/DWARFDebugLoc.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/JSON.h"
+#include "llvm/Support/ThreadPool.h"
 
 #define DEBUG_TYPE "dwarfdump"
 using namespace llvm;
@@ -133,6 +134,75 @@ struct LocationStats {
   unsigned NumVar = 0;
 };
 
+/// Holds the statistics collected for one compile unit, to be merged into the
+/// totals once all units are processed.
+struct UnitStats {
+  StringMap<PerFunctionStats> FnStatMap;
+  GlobalStats Global;
+  LocationStats Loc;
+};
+
+/// Accumulate \p Src into \p Dst. Every field is either a count or a flag, so
+/// merging the statistics of several units gives the same result as
+/// collecting them all into one set.
+/// \{
+static void merge(PerFunctionStats &Dst, const PerFunctionStats &Src) {
+  Dst.NumFnInlined += Src.NumFnInlined;
+  Dst.NumAbstractOrigins += Src.NumAbstractOrigins;
+  Dst.TotalVarWithLoc += Src.TotalVarWithLoc;
+  Dst.ConstantMembers += Src.ConstantMembers;
+  for (const auto &Var : Src.VarsInFunction)
+    Dst.VarsInFunction.insert(Var.getKey());
+  Dst.IsFunction |= Src.IsFunction;
+  Dst.HasPCAddresses |= Src.HasPCAddresses;
+  Dst.HasSourceLocation |= Src.HasSourceLocation;
+  Dst.NumParams += Src.NumParams;
+  Dst.NumParamSourceLocations += Src.NumParamSourceLocations;
+  Dst.NumParamTypes += Src.NumParamTypes;
+  Dst.NumParamLocations += Src.NumParamLocations;
+  Dst.NumVars += Src.NumVars;
+  Dst.NumVarSourceLocations += Src.NumVarSourceLocations;
+  Dst.NumVarTypes += Src.NumVarTypes;
+  Dst.NumVarLocations += Src.NumVarLocations;
+}
+
+static void merge(GlobalStats &Dst, const GlobalStats &Src) {
+  Dst.ScopeBytesCovered += Src.ScopeBytesCovered;
+  Dst.ScopeBytesFromFirstDefinition += Src.ScopeBytesFromFirstDefinition;
+  Dst.ScopeEntryValueBytesCovered += Src.ScopeEntryValueBytesCovered;
+  Dst.ParamScopeBytesCovered += Src.ParamScopeBytesCovered;
+  Dst.ParamScopeBytesFromFirstDefinition +=
+      Src.ParamScopeBytesFromFirstDefinition;
+  Dst.ParamScopeEntryValueBytesCovered += Src.ParamScopeEntryValueBytesCovered;
+  Dst.VarScopeBytesCovered += Src.VarScopeBytesCovered;
+  Dst.VarScopeBytesFromFirstDefinition += Src.VarScopeBytesFromFirstDefinition;
+  Dst.VarScopeEntryValueBytesCovered += Src.VarScopeEntryValueBytesCovered;
+  Dst.CallSiteEntries += Src.CallSiteEntries;
+  Dst.CallSiteDIEs += Src.CallSiteDIEs;
+  Dst.CallSiteParamDIEs += Src.CallSiteParamDIEs;
+  Dst.FunctionSize += Src.FunctionSize;
+  Dst.InlineFunctionSize += Src.InlineFunctionSize;
+}
+
+static void merge(std::vector<unsigned> &Dst,
+                  const std::vector<unsigned> &Src) {
+  for (unsigned I = 0; I < NumOfCoverageCategories; ++I)
+    Dst[I] += Src[I];
+}
+
+static void merge(LocationStats &Dst, const LocationStats &Src) {
+  merge(Dst.VarParamLocStats, Src.VarParamLocStats);
+  merge(Dst.VarParamNonEntryValLocStats, Src.VarParamNonEntryValLocStats);
+  merge(Dst.ParamLocStats, Src.ParamLocStats);
+  merge(Dst.ParamNonEntryValLocStats, Src.ParamNonEntryValLocStats);
+  merge(Dst.VarLocStats, Src.VarLocStats);
+  merge(Dst.VarNonEntryValLocStats, Src.VarNonEntryValLocStats);
+  Dst.NumVarParam += Src.NumVarParam;
+  Dst.NumParam += Src.NumParam;
+  Dst.NumVar += Src.NumVar;
+}
+/// \}
+
 /// Extract the low pc from a Die.
 static uint64_t getLowPC(DWARFDie Die) {
   auto RangesOrError = Die.getAddressRanges();
@@ -487,16 +557,43 @@ static void printLocationStats(raw_ostream &OS,
 /// of particular optimizations. The raw numbers themselves are not particularly
 /// useful, only the delta between compiling the same program with different
 /// compilers is.
+///
+/// When \p DICtx is thread safe and \p NumThreads isn't 1, the compile units
+/// are processed concurrently and their statistics merged in unit order.
 bool collectStatsForObjectFile(ObjectFile &Obj, DWARFContext &DICtx,
-                               Twine Filename, raw_ostream &OS) {
+                               Twine Filename, raw_ostream &OS,
+                               unsigned NumThreads) {
   StringRef FormatName = Obj.getFileFormatName();
   GlobalStats GlobalStats;
   LocationStats LocStats;
   StringMap<PerFunctionStats> Statistics;
-  for (const auto &CU : static_cast<DWARFContext *>(&DICtx)->compile_units())
-    if (DWARFDie CUDie = CU->getNonSkeletonUnitDIE(false))
-      collectStatsRecursive(CUDie, getLowPC(CUDie), "/", "g", 0, 0, 0,
-                            Statistics, GlobalStats, LocStats);
+  if (DICtx.isThreadSafe() && NumThreads != 1) {
+    std::vector<UnitStats> PerUnit(DICtx.getNumCompileUnits());
+    {
+      ThreadPool Pool(hardware_concurrency_strategy(NumThreads));
+      unsigned Index = 0;
+      for (const auto &CU : DICtx.compile_units()) {
+        UnitStats &Stats = PerUnit[Index++];
+        DWARFUnit *U = CU.get();
+        Pool.async([U, &Stats] {
+          if (DWARFDie CUDie = U->getNonSkeletonUnitDIE(false))
+            collectStatsRecursive(CUDie, getLowPC(CUDie), "/", "g", 0, 0, 0,
+                                  Stats.FnStatMap, Stats.Global, Stats.Loc);
+        });
+      }
+    }
+    for (UnitStats &Stats : PerUnit) {
+      for (auto &Entry : Stats.FnStatMap)
+        merge(Statistics[Entry.getKey()], Entry.getValue());
+      merge(GlobalStats, Stats.Global);
+      merge(LocStats, Stats.Loc);
+    }
+  } else {
+    for (const auto &CU : DICtx.compile_units())
+      if (DWARFDie CUDie = CU->getNonSkeletonUnitDIE(false))
+        collectStatsRecursive(CUDie, getLowPC(CUDie), "/", "g", 0, 0, 0,
+                              Statistics, GlobalStats, LocStats);
+  }
 
   /// The version number should be increased every time the algorithm is changed
   /// (including bug fixes). New metrics may be added without increasing the
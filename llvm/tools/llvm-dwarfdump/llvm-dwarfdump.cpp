@@ -212,6 +212,14 @@ static opt<bool> Verify("verify", desc("Verify the DWARF debug info."),
                         cat(DwarfDumpCategory));
 static opt<bool> Quiet("quiet", desc("Use with -verify to not emit to STDOUT."),
                        cat(DwarfDumpCategory));
+static opt<unsigned>
+    NumThreads("num-threads",
+               desc("Number of threads used by -verify and -statistics to "
+                    "process the units of an object file concurrently. 0 "
+                    "means one thread per hardware thread. Defaults to 1."),
+               cat(DwarfDumpCategory), init(1), value_desc("N"));
+static alias NumThreadsAlias("j", desc("Alias for -num-threads."),
+                             aliasopt(NumThreads));
 static opt<bool> DumpUUID("uuid", desc("Show the UUID for each architecture."),
                           cat(DwarfDumpCategory));
 static alias DumpUUIDAlias("u", desc("Alias for -uuid."), aliasopt(DumpUUID));
@@ -244,6 +252,7 @@ static DIDumpOptions getDumpOpts() {
   DumpOpts.ShowForm = ShowForm;
   DumpOpts.SummarizeTypes = SummarizeTypes;
   DumpOpts.Verbose = Verbose;
+  DumpOpts.NumThreads = NumThreads;
   // In -verify mode, print DIEs without children in error messages.
   if (Verify)
     return DumpOpts.noImplicitRecursion();
@@ -411,7 +420,8 @@ static bool lookup(ObjectFile &Obj, DWARFContext &DICtx, uint64_t Address,
 }
 
 bool collectStatsForObjectFile(ObjectFile &Obj, DWARFContext &DICtx,
-                               Twine Filename, raw_ostream &OS);
+                               Twine Filename, raw_ostream &OS,
+                               unsigned NumThreads);
 
 static bool dumpObjectFile(ObjectFile &Obj, DWARFContext &DICtx, Twine Filename,
                            raw_ostream &OS) {
@@ -482,6 +492,15 @@ static bool handleArchive(StringRef Filename, Archive &Arch,
   return Result;
 }
 
+/// Create the context for \p Obj. The units are only processed concurrently by
+/// -verify and -statistics, and only those need a thread safe context.
+static std::unique_ptr<DWARFContext> createContext(const ObjectFile &Obj) {
+  bool ThreadSafe = NumThreads != 1 && (Verify || Statistics);
+  return DWARFContext::create(Obj, nullptr,
+                              DWARFContext::defaultErrorHandler, "",
+                              ThreadSafe);
+}
+
 static bool handleBuffer(StringRef Filename, MemoryBufferRef Buffer,
                          HandlerFn HandleObj, raw_ostream &OS) {
   Expected<std::unique_ptr<Binary>> BinOrErr = object::createBinary(Buffer);
@@ -490,7 +509,7 @@ static bool handleBuffer(StringRef Filename, MemoryBufferRef Buffer,
   bool Result = true;
   if (auto *Obj = dyn_cast<ObjectFile>(BinOrErr->get())) {
     if (filterArch(*Obj)) {
-      std::unique_ptr<DWARFContext> DICtx = DWARFContext::create(*Obj);
+      std::unique_ptr<DWARFContext> DICtx = createContext(*Obj);
       Result = HandleObj(*Obj, *DICtx, Filename, OS);
     }
   }
@@ -501,7 +520,7 @@ static bool handleBuffer(StringRef Filename, MemoryBufferRef Buffer,
       if (auto MachOOrErr = ObjForArch.getAsObjectFile()) {
         auto &Obj = **MachOOrErr;
         if (filterArch(Obj)) {
-          std::unique_ptr<DWARFContext> DICtx = DWARFContext::create(Obj);
+          std::unique_ptr<DWARFContext> DICtx = createContext(Obj);
           Result &= HandleObj(Obj, *DICtx, ObjName, OS);
         }
         continue;
@@ -637,7 +656,13 @@ int main(int argc, char **argv) {
       return 1;
   } else if (Statistics)
     for (auto Object : Objects)
-      handleFile(Object, collectStatsForObjectFile, OutputFile.os());
+      handleFile(Object,
+                 [](ObjectFile &Obj, DWARFContext &DICtx, Twine Filename,
+                    raw_ostream &OS) {
+                   return collectStatsForObjectFile(Obj, DICtx, Filename, OS,
+                                                    NumThreads);
+                 },
+                 OutputFile.os());
   else
     for (auto Object : Objects)
       handleFile(Object, dumpObjectFile, OutputFile.os());
@@ -39,6 +39,8 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
@@ -61,37 +63,73 @@ static cl::opt<std::string> OutputFilename(cl::Required, "o",
                                            cl::value_desc("filename"),
                                            cl::cat(DwpCategory));
 
-static void writeStringsAndOffsets(MCStreamer &Out, DWPStringPool &Strings,
-                                   MCSection *StrOffsetSection,
-                                   StringRef CurStrSection,
-                                   StringRef CurStrOffsetSection) {
+static cl::opt<unsigned> NumThreads(
+    "num-threads",
+    cl::desc("Number of threads used to read the input files. The output is "
+             "the same for any number of threads. 0 means use all available "
+             "hardware threads (default)."),
+    cl::init(0), cl::cat(DwpCategory));
+static cl::alias NumThreadsAlias("j", cl::desc("Alias for --num-threads"),
+                                 cl::aliasopt(NumThreads));
+
+/// Return the DWARF version of the first unit in \p Info.
+static uint16_t getUnitVersion(StringRef Info) {
+  DataExtractor InfoData(Info, true, 0);
+  uint64_t Offset = 0;
+  if (InfoData.getU32(&Offset) == 0xffffffffU)
+    InfoData.getU64(&Offset);
+  return InfoData.getU16(&Offset);
+}
+
+static Error writeStringsAndOffsets(MCStreamer &Out, DWPStringPool &Strings,
+                                    MCSection *StrOffsetSection,
+                                    ArrayRef<CachedHashStringRef> CurStrings,
+                                    StringRef CurStrOffsetSection,
+                                    uint16_t Version) {
   // Could possibly produce an error or warning if one of these was non-null but
   // the other was null.
-  if (CurStrSection.empty() || CurStrOffsetSection.empty())
-    return;
+  if (CurStrings.empty() || CurStrOffsetSection.empty())
+    return Error::success();
 
   DenseMap<uint64_t, uint32_t> OffsetRemapping;
+  OffsetRemapping.reserve(CurStrings.size());
 
-  DataExtractor Data(CurStrSection, true, 0);
   uint64_t LocalOffset = 0;
-  uint64_t PrevOffset = 0;
-  while (const char *s = Data.getCStr(&LocalOffset)) {
-    OffsetRemapping[PrevOffset] =
-        Strings.getOffset(s, LocalOffset - PrevOffset);
-    PrevOffset = LocalOffset;
+  for (CachedHashStringRef S : CurStrings) {
+    OffsetRemapping[LocalOffset] = Strings.getOffset(S);
+    LocalOffset += S.size() + 1;
   }
 
-  Data = DataExtractor(CurStrOffsetSection, true, 0);
+  DataExtractor Data(CurStrOffsetSection, true, 0);
 
   Out.SwitchSection(StrOffsetSection);
 
   uint64_t Offset = 0;
   uint64_t Size = CurStrOffsetSection.size();
   while (Offset < Size) {
-    auto OldOffset = Data.getU32(&Offset);
-    auto NewOffset = OffsetRemapping[OldOffset];
-    Out.EmitIntValue(NewOffset, 4);
+    // In DWARF v5 the section is made of contributions that each start with a
+    // header. The header is copied as is and only the offsets are remapped.
+    uint64_t End = Size;
+    if (Version >= 5) {
+      uint64_t ContributionLength = Data.getU32(&Offset);
+      if (ContributionLength == 0xffffffffU)
+        return make_error<DWPError>(
+            "DWARF64 .debug_str_offsets.dwo contributions are not supported");
+      End = Offset + ContributionLength;
+      if (ContributionLength < 4 || End > Size)
+        return make_error<DWPError>(
+            "invalid .debug_str_offsets.dwo contribution length");
+      Out.EmitIntValue(ContributionLength, 4);
+      Out.EmitIntValue(Data.getU16(&Offset), 2); // Version
+      Out.EmitIntValue(Data.getU16(&Offset), 2); // Padding
+    }
+    while (Offset < End) {
+      auto OldOffset = Data.getU32(&Offset);
+      auto NewOffset = OffsetRemapping[OldOffset];
+      Out.EmitIntValue(NewOffset, 4);
+    }
   }
+  return Error::success();
 }
 
 static uint64_t getCUAbbrev(StringRef Abbrev, uint64_t AbbrCode) {
@@ -118,15 +156,36 @@ struct CompileUnitIdentifiers {
 
 static Expected<const char *>
 getIndexedString(dwarf::Form Form, DataExtractor InfoData,
-                 uint64_t &InfoOffset, StringRef StrOffsets, StringRef Str) {
-  if (Form == dwarf::DW_FORM_string)
+                 uint64_t &InfoOffset, StringRef StrOffsets, StringRef Str,
+                 uint16_t Version) {
+  uint64_t StrIndex;
+  switch (Form) {
+  case dwarf::DW_FORM_string:
     return InfoData.getCStr(&InfoOffset);
-  if (Form != dwarf::DW_FORM_GNU_str_index)
+  case dwarf::DW_FORM_GNU_str_index:
+  case dwarf::DW_FORM_strx:
+    StrIndex = InfoData.getULEB128(&InfoOffset);
+    break;
+  case dwarf::DW_FORM_strx1:
+    StrIndex = InfoData.getU8(&InfoOffset);
+    break;
+  case dwarf::DW_FORM_strx2:
+    StrIndex = InfoData.getU16(&InfoOffset);
+    break;
+  case dwarf::DW_FORM_strx3:
+    StrIndex = InfoData.getU24(&InfoOffset);
+    break;
+  case dwarf::DW_FORM_strx4:
+    StrIndex = InfoData.getU32(&InfoOffset);
+    break;
+  default:
     return make_error<DWPError>(
-        "string field encoded without DW_FORM_string or DW_FORM_GNU_str_index");
-  auto StrIndex = InfoData.getULEB128(&InfoOffset);
+        "string field encoded without DW_FORM_string, DW_FORM_strx or "
+        "DW_FORM_GNU_str_index");
+  }
   DataExtractor StrOffsetsData(StrOffsets, true, 0);
-  uint64_t StrOffsetsOffset = 4 * StrIndex;
+  // In DWARF v5 the offsets of a split unit follow the contribution header.
+  uint64_t StrOffsetsOffset = (Version >= 5 ? 8 : 0) + 4 * StrIndex;
   uint64_t StrOffset = StrOffsetsData.getU32(&StrOffsetsOffset);
   DataExtractor StrData(Str, true, 0);
   return StrData.getCStr(&StrOffset);
@@ -147,8 +206,19 @@ static Expected<CompileUnitIdentifiers> getCUIdentifiers(StringRef Abbrev,
     Length = InfoData.getU64(&Offset);
   }
   uint16_t Version = InfoData.getU16(&Offset);
-  InfoData.getU32(&Offset); // Abbrev offset (should be zero)
-  uint8_t AddrSize = InfoData.getU8(&Offset);
+  uint8_t AddrSize;
+  Optional<uint64_t> Signature = None;
+  if (Version >= 5) {
+    auto UnitType = InfoData.getU8(&Offset);
+    AddrSize = InfoData.getU8(&Offset);
+    InfoData.getU32(&Offset); // Abbrev offset (should be zero)
+    if (UnitType != dwarf::DW_UT_split_compile)
+      return make_error<DWPError>("unit is not a split compile unit");
+    Signature = InfoData.getU64(&Offset);
+  } else {
+    InfoData.getU32(&Offset); // Abbrev offset (should be zero)
+    AddrSize = InfoData.getU8(&Offset);
+  }
 
   uint32_t AbbrCode = InfoData.getULEB128(&Offset);
 
@@ -162,22 +232,22 @@ static Expected<CompileUnitIdentifiers> getCUIdentifiers(StringRef Abbrev,
   uint32_t Name;
   dwarf::Form Form;
   CompileUnitIdentifiers ID;
-  Optional<uint64_t> Signature = None;
   while ((Name = AbbrevData.getULEB128(&AbbrevOffset)) |
          (Form = static_cast<dwarf::Form>(AbbrevData.getULEB128(&AbbrevOffset))) &&
          (Name != 0 || Form != 0)) {
     switch (Name) {
     case dwarf::DW_AT_name: {
       Expected<const char *> EName =
-          getIndexedString(Form, InfoData, Offset, StrOffsets, Str);
+          getIndexedString(Form, InfoData, Offset, StrOffsets, Str, Version);
       if (!EName)
         return EName.takeError();
       ID.Name = *EName;
       break;
     }
+    case dwarf::DW_AT_dwo_name:
     case dwarf::DW_AT_GNU_dwo_name: {
       Expected<const char *> EName =
-          getIndexedString(Form, InfoData, Offset, StrOffsets, Str);
+          getIndexedString(Form, InfoData, Offset, StrOffsets, Str, Version);
       if (!EName)
         return EName.takeError();
       ID.DWOName = *EName;
@@ -389,41 +459,85 @@ handleCompressedSection(std::deque<SmallString<32>> &UncompressedSections,
   return Error::success();
 }
 
-static Error handleSection(
+/// An input file, along with the parts of it that are read before it is
+/// written to the output. Inputs are loaded on a thread pool ahead of the one
+/// being written, and released as soon as they have been written.
+struct DWOInput {
+  OwningBinary<object::ObjectFile> Binary;
+  std::deque<SmallString<32>> UncompressedSections;
+  /// The known sections of the input, with their names normalized and their
+  /// contents decompressed, in the order they appear in the file.
+  std::vector<std::pair<StringRef, StringRef>> Sections;
+  /// The strings of the string section, with their hashes.
+  std::vector<CachedHashStringRef> Strings;
+  Error Err = Error::success();
+
+  // The error is checked when the input is written, but inputs loaded ahead
+  // of a failure are discarded without being looked at.
+  ~DWOInput() { consumeError(std::move(Err)); }
+};
+
+static Error loadInput(
+    StringRef Input,
     const StringMap<std::pair<MCSection *, DWARFSectionKind>> &KnownSections,
-    const MCSection *StrSection, const MCSection *StrOffsetSection,
-    const MCSection *TypesSection, const MCSection *CUIndexSection,
-    const MCSection *TUIndexSection, const SectionRef &Section, MCStreamer &Out,
-    std::deque<SmallString<32>> &UncompressedSections,
-    uint32_t (&ContributionOffsets)[8], UnitIndexEntry &CurEntry,
-    StringRef &CurStrSection, StringRef &CurStrOffsetSection,
-    std::vector<StringRef> &CurTypesSection, StringRef &InfoSection,
-    StringRef &AbbrevSection, StringRef &CurCUIndexSection,
-    StringRef &CurTUIndexSection) {
-  if (Section.isBSS())
-    return Error::success();
+    DWOInput &Loaded) {
+  auto ErrOrObj = object::ObjectFile::createObjectFile(Input);
+  if (!ErrOrObj)
+    return ErrOrObj.takeError();
+  Loaded.Binary = std::move(*ErrOrObj);
 
-  if (Section.isVirtual())
-    return Error::success();
+  for (const auto &Section : Loaded.Binary.getBinary()->sections()) {
+    if (Section.isBSS())
+      continue;
 
-  Expected<StringRef> NameOrErr = Section.getName();
-  if (!NameOrErr)
-    return NameOrErr.takeError();
-  StringRef Name = *NameOrErr;
+    if (Section.isVirtual())
+      continue;
+
+    Expected<StringRef> NameOrErr = Section.getName();
+    if (!NameOrErr)
+      return NameOrErr.takeError();
+    StringRef Name = *NameOrErr;
 
-  Expected<StringRef> ContentsOrErr = Section.getContents();
-  if (!ContentsOrErr)
-    return ContentsOrErr.takeError();
-  StringRef Contents = *ContentsOrErr;
+    Expected<StringRef> ContentsOrErr = Section.getContents();
+    if (!ContentsOrErr)
+      return ContentsOrErr.takeError();
+    StringRef Contents = *ContentsOrErr;
 
-  if (auto Err = handleCompressedSection(UncompressedSections, Name, Contents))
-    return Err;
+    if (auto Err = handleCompressedSection(Loaded.UncompressedSections, Name,
+                                           Contents))
+      return Err;
 
-  Name = Name.substr(Name.find_first_not_of("._"));
+    Name = Name.substr(Name.find_first_not_of("._"));
 
+    if (!KnownSections.count(Name))
+      continue;
+    Loaded.Sections.emplace_back(Name, Contents);
+
+    if (Name == "debug_str.dwo") {
+      DataExtractor Data(Contents, true, 0);
+      uint64_t Offset = 0;
+      uint64_t PrevOffset = 0;
+      while (const char *S = Data.getCStr(&Offset)) {
+        Loaded.Strings.emplace_back(StringRef(S, Offset - PrevOffset - 1));
+        PrevOffset = Offset;
+      }
+    }
+  }
+  return Error::success();
+}
+
+static void handleSection(
+    const StringMap<std::pair<MCSection *, DWARFSectionKind>> &KnownSections,
+    const MCSection *StrSection, const MCSection *StrOffsetSection,
+    const MCSection *TypesSection, const MCSection *CUIndexSection,
+    const MCSection *TUIndexSection, StringRef Name, StringRef Contents,
+    MCStreamer &Out, uint32_t (&ContributionOffsets)[8],
+    UnitIndexEntry &CurEntry, StringRef &CurStrSection,
+    StringRef &CurStrOffsetSection, std::vector<StringRef> &CurTypesSection,
+    StringRef &InfoSection, StringRef &AbbrevSection,
+    StringRef &CurCUIndexSection, StringRef &CurTUIndexSection) {
   auto SectionPair = KnownSections.find(Name);
-  if (SectionPair == KnownSections.end())
-    return Error::success();
+  assert(SectionPair != KnownSections.end() && "unknown section");
 
   if (DWARFSectionKind Kind = SectionPair->second.second) {
     auto Index = Kind - DW_SECT_INFO;
@@ -460,7 +574,6 @@ static Error handleSection(
     Out.SwitchSection(OutSection);
     Out.EmitBytes(Contents);
   }
-  return Error::success();
 }
 
 static Error
@@ -527,18 +640,36 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
 
   DWPStringPool Strings(Out, StrSection);
 
-  SmallVector<OwningBinary<object::ObjectFile>, 128> Objects;
-  Objects.reserve(Inputs.size());
-
-  std::deque<SmallString<32>> UncompressedSections;
-
-  for (const auto &Input : Inputs) {
-    auto ErrOrObj = object::ObjectFile::createObjectFile(Input);
-    if (!ErrOrObj)
-      return ErrOrObj.takeError();
-
-    auto &Obj = *ErrOrObj->getBinary();
-    Objects.push_back(std::move(*ErrOrObj));
+  // Inputs are opened, decompressed and have their strings hashed on a thread
+  // pool, up to Window inputs ahead of the one being written. Everything is
+  // written in input order, so the output doesn't depend on the number of
+  // threads, and an input is released once written so that only the inputs in
+  // the window are kept in memory.
+  ThreadPoolStrategy Strategy = hardware_concurrency_strategy(NumThreads);
+  const size_t Window = 2 * Strategy.compute_thread_count();
+  std::vector<std::unique_ptr<DWOInput>> Loaded(Inputs.size());
+  std::vector<std::shared_future<void>> Ready(Inputs.size());
+  // Declared last so that it waits for pending loads before they are freed.
+  ThreadPool Pool(Strategy);
+  auto Load = [&](size_t I) {
+    Loaded[I] = std::make_unique<DWOInput>();
+    DWOInput *L = Loaded[I].get();
+    StringRef Input = Inputs[I];
+    Ready[I] = Pool.async(
+        [=, &KnownSections] { L->Err = loadInput(Input, KnownSections, *L); });
+  };
+  for (size_t I = 0, E = std::min(Window, Inputs.size()); I != E; ++I)
+    Load(I);
+
+  for (size_t InputIndex = 0; InputIndex != Inputs.size(); ++InputIndex) {
+    StringRef Input = Inputs[InputIndex];
+    Ready[InputIndex].wait();
+    std::unique_ptr<DWOInput> CurInput = std::move(Loaded[InputIndex]);
+    if (InputIndex + Window < Inputs.size())
+      Load(InputIndex + Window);
+    if (CurInput->Err)
+      return std::move(CurInput->Err);
+    auto &Obj = *CurInput->Binary.getBinary();
 
     UnitIndexEntry CurEntry = {};
 
@@ -550,20 +681,21 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
     StringRef CurCUIndexSection;
     StringRef CurTUIndexSection;
 
-    for (const auto &Section : Obj.sections())
-      if (auto Err = handleSection(
-              KnownSections, StrSection, StrOffsetSection, TypesSection,
-              CUIndexSection, TUIndexSection, Section, Out,
-              UncompressedSections, ContributionOffsets, CurEntry,
-              CurStrSection, CurStrOffsetSection, CurTypesSection, InfoSection,
-              AbbrevSection, CurCUIndexSection, CurTUIndexSection))
-        return Err;
+    for (const auto &Section : CurInput->Sections)
+      handleSection(KnownSections, StrSection, StrOffsetSection, TypesSection,
+                    CUIndexSection, TUIndexSection, Section.first,
+                    Section.second, Out, ContributionOffsets, CurEntry,
+                    CurStrSection, CurStrOffsetSection, CurTypesSection,
+                    InfoSection, AbbrevSection, CurCUIndexSection,
+                    CurTUIndexSection);
 
     if (InfoSection.empty())
       continue;
 
-    writeStringsAndOffsets(Out, Strings, StrOffsetSection, CurStrSection,
-                           CurStrOffsetSection);
+    if (auto Err = writeStringsAndOffsets(
+            Out, Strings, StrOffsetSection, CurInput->Strings,
+            CurStrOffsetSection, getUnitVersion(InfoSection)))
+      return createFileError(Input, std::move(Err));
 
     if (CurCUIndexSection.empty()) {
       Expected<CompileUnitIdentifiers> EID = getCUIdentifiers(
@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <array>
+#include <mutex>
 #include <string>
 
 #include "Assembler.h"
@@ -32,6 +33,31 @@ BenchmarkRunner::BenchmarkRunner(const LLVMState &State,
 BenchmarkRunner::~BenchmarkRunner() = default;
 
 namespace {
+// Crash recovery installs process-wide signal handlers, while snippets may run
+// on several threads at once: the handlers stay installed as long as one of
+// them is running a snippet.
+class CrashRecoveryScope {
+public:
+  CrashRecoveryScope() {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (NumScopes++ == 0)
+      llvm::CrashRecoveryContext::Enable();
+  }
+
+  ~CrashRecoveryScope() {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (--NumScopes == 0)
+      llvm::CrashRecoveryContext::Disable();
+  }
+
+private:
+  static std::mutex Mutex;
+  static unsigned NumScopes;
+};
+
+std::mutex CrashRecoveryScope::Mutex;
+unsigned CrashRecoveryScope::NumScopes = 0;
+
 class FunctionExecutorImpl : public BenchmarkRunner::FunctionExecutor {
 public:
   FunctionExecutorImpl(const LLVMState &State,
@@ -58,14 +84,13 @@ private:
       pfm::Counter Counter(PerfEvent);
       Scratch->clear();
       {
+        const CrashRecoveryScope Scope;
         llvm::CrashRecoveryContext CRC;
-        llvm::CrashRecoveryContext::Enable();
         const bool Crashed = !CRC.RunSafely([this, &Counter, ScratchPtr]() {
           Counter.start();
           this->Function(ScratchPtr);
           Counter.stop();
         });
-        llvm::CrashRecoveryContext::Disable();
         // FIXME: Better diagnosis.
         if (Crashed)
           return make_error<Failure>("snippet crashed while running");
@@ -80,9 +105,9 @@ private:
 };
 } // namespace
 
-InstructionBenchmark BenchmarkRunner::runConfiguration(
-    const BenchmarkCode &BC, unsigned NumRepetitions,
-    const SnippetRepetitor &Repetitor, bool DumpObjectToDisk) const {
+InstructionBenchmark
+BenchmarkRunner::getBenchmarkSetup(const BenchmarkCode &BC,
+                                   unsigned NumRepetitions) const {
   InstructionBenchmark InstrBenchmark;
   InstrBenchmark.Mode = Mode;
   InstrBenchmark.CpuName = State.getTargetMachine().getTargetCPU();
@@ -90,10 +115,16 @@ InstructionBenchmark BenchmarkRunner::runConfiguration(
       State.getTargetMachine().getTargetTriple().normalize();
   InstrBenchmark.NumRepetitions = NumRepetitions;
   InstrBenchmark.Info = BC.Info;
+  InstrBenchmark.Key = BC.Key;
+  return InstrBenchmark;
+}
 
-  const std::vector<llvm::MCInst> &Instructions = BC.Key.Instructions;
+InstructionBenchmark BenchmarkRunner::runConfiguration(
+    const BenchmarkCode &BC, unsigned NumRepetitions,
+    const SnippetRepetitor &Repetitor, bool DumpObjectToDisk) const {
+  InstructionBenchmark InstrBenchmark = getBenchmarkSetup(BC, NumRepetitions);
 
-  InstrBenchmark.Key = BC.Key;
+  const std::vector<llvm::MCInst> &Instructions = BC.Key.Instructions;
 
   // Assemble at least kMinInstructionsForSnippet instructions by repeating the
   // snippet for debug/analysis. This is so that the user clearly understands
@@ -38,6 +38,11 @@ public:
 
   virtual ~BenchmarkRunner();
 
+  // The fields of the result of running `Configuration` that are known before
+  // it runs: everything the measurements depend on.
+  InstructionBenchmark getBenchmarkSetup(const BenchmarkCode &Configuration,
+                                         unsigned NumRepetitions) const;
+
   InstructionBenchmark runConfiguration(const BenchmarkCode &Configuration,
                                         unsigned NumRepetitions,
                                         const SnippetRepetitor &Repetitor,
@@ -0,0 +1,77 @@
+//===-- CpuAffinity.cpp -----------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "CpuAffinity.h"
+#include "Error.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace llvm {
+namespace exegesis {
+
+llvm::Expected<std::vector<unsigned>> parseCpuList(llvm::StringRef List) {
+  std::vector<unsigned> Cpus;
+  llvm::SmallVector<llvm::StringRef, 8> Ranges;
+  List.trim().split(Ranges, ',', /* MaxSplit */ -1, /* KeepEmpty */ false);
+  for (llvm::StringRef Range : Ranges) {
+    llvm::StringRef First, Last;
+    std::tie(First, Last) = Range.split('-');
+    unsigned FirstCpu = 0, LastCpu = 0;
+    if (First.trim().getAsInteger(10, FirstCpu))
+      return make_error<Failure>("invalid CPU list '" + List + "'");
+    LastCpu = FirstCpu;
+    const bool IsRange = Range.contains('-');
+    if (IsRange && Last.trim().getAsInteger(10, LastCpu))
+      return make_error<Failure>("invalid CPU list '" + List + "'");
+    if (LastCpu < FirstCpu)
+      return make_error<Failure>("invalid CPU range '" + Range + "'");
+    for (unsigned Cpu = FirstCpu; Cpu <= LastCpu; ++Cpu)
+      Cpus.push_back(Cpu);
+  }
+  llvm::sort(Cpus);
+  Cpus.erase(std::unique(Cpus.begin(), Cpus.end()), Cpus.end());
+  return Cpus;
+}
+
+llvm::Expected<std::vector<unsigned>> getIsolatedCpus() {
+  constexpr const char kIsolatedCpus[] = "/sys/devices/system/cpu/isolated";
+  auto Buffer = llvm::MemoryBuffer::getFileAsStream(kIsolatedCpus);
+  if (!Buffer)
+    return make_error<Failure>(llvm::Twine("cannot read ") + kIsolatedCpus +
+                               ": " + Buffer.getError().message());
+  return parseCpuList((*Buffer)->getBuffer());
+}
+
+llvm::Error pinCurrentThreadToCpu(unsigned Cpu) {
+#ifdef __linux__
+  if (Cpu >= CPU_SETSIZE)
+    return make_error<Failure>("no such CPU " + llvm::Twine(Cpu));
+  cpu_set_t CpuSet;
+  CPU_ZERO(&CpuSet);
+  CPU_SET(Cpu, &CpuSet);
+  // 0 is the calling thread.
+  if (sched_setaffinity(0, sizeof(CpuSet), &CpuSet) != 0)
+    return make_error<Failure>("cannot run on CPU " + llvm::Twine(Cpu) + ": " +
+                               std::strerror(errno));
+  return llvm::Error::success();
+#else
+  return make_error<Failure>("pinning threads to CPUs is only supported on "
+                             "Linux");
+#endif
+}
+
+} // namespace exegesis
+} // namespace llvm
@@ -0,0 +1,38 @@
+//===-- CpuAffinity.h -------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Utilities to run measurement workers on CPUs of their own.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TOOLS_LLVM_EXEGESIS_CPUAFFINITY_H
+#define LLVM_TOOLS_LLVM_EXEGESIS_CPUAFFINITY_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include <vector>
+
+namespace llvm {
+namespace exegesis {
+
+// Parses a list of CPUs in the format of the kernel, e.g. "0,2-4,7". Returns
+// the CPUs in increasing order, without duplicates.
+llvm::Expected<std::vector<unsigned>> parseCpuList(llvm::StringRef List);
+
+// Returns the CPUs the kernel keeps other threads off (see `isolcpus`), which
+// makes them the least noisy ones to measure on.
+llvm::Expected<std::vector<unsigned>> getIsolatedCpus();
+
+// Restricts the calling thread to running on `Cpu`.
+llvm::Error pinCurrentThreadToCpu(unsigned Cpu);
+
+} // namespace exegesis
+} // namespace llvm
+
+#endif // LLVM_TOOLS_LLVM_EXEGESIS_CPUAFFINITY_H
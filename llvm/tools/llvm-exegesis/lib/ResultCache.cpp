@@ -0,0 +1,85 @@
+//===-- ResultCache.cpp -----------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "ResultCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace llvm {
+namespace exegesis {
+
+llvm::Expected<std::string>
+ResultCache::getKey(const LLVMState &State, InstructionBenchmark Setup,
+                    InstructionBenchmark::RepetitionModeE RepetitionMode) {
+  // The serialized setup names the instructions, registers and CPU the same
+  // way across runs.
+  std::string Serialized;
+  llvm::raw_string_ostream OS(Serialized);
+  if (llvm::Error E = Setup.writeYamlTo(State, OS))
+    return std::move(E);
+  OS << "repetition_mode: "
+     << (RepetitionMode == InstructionBenchmark::Loop ? "loop" : "duplicate")
+     << "\n";
+  OS.flush();
+  llvm::MD5 Hash;
+  Hash.update(Serialized);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  return Result.digest().str();
+}
+
+std::string ResultCache::getPath(llvm::StringRef Key) const {
+  llvm::SmallString<256> Path(Directory);
+  llvm::sys::path::append(Path, Key + ".yaml");
+  return Path.str();
+}
+
+llvm::Optional<InstructionBenchmark>
+ResultCache::lookup(const LLVMState &State, llvm::StringRef Key) const {
+  const std::string Path = getPath(Key);
+  if (!llvm::sys::fs::exists(Path))
+    return llvm::None;
+  auto Result = InstructionBenchmark::readYaml(State, Path);
+  if (!Result) {
+    // Measuring again replaces the unreadable entry.
+    llvm::consumeError(Result.takeError());
+    return llvm::None;
+  }
+  return std::move(*Result);
+}
+
+llvm::Error ResultCache::store(const LLVMState &State, llvm::StringRef Key,
+                               InstructionBenchmark &Result) const {
+  if (!Result.Error.empty())
+    return llvm::Error::success();
+  if (std::error_code EC = llvm::sys::fs::create_directories(Directory))
+    return llvm::errorCodeToError(EC);
+  int FD;
+  llvm::SmallString<256> TempPath;
+  if (std::error_code EC = llvm::sys::fs::createUniqueFile(
+          getPath(Key) + "-%%%%%%.tmp", FD, TempPath))
+    return llvm::errorCodeToError(EC);
+  {
+    llvm::raw_fd_ostream OS(FD, true /*ShouldClose*/);
+    if (llvm::Error E = Result.writeYamlTo(State, OS)) {
+      llvm::sys::fs::remove(TempPath);
+      return E;
+    }
+  }
+  if (std::error_code EC = llvm::sys::fs::rename(TempPath, getPath(Key))) {
+    llvm::sys::fs::remove(TempPath);
+    return llvm::errorCodeToError(EC);
+  }
+  return llvm::Error::success();
+}
+
+} // namespace exegesis
+} // namespace llvm
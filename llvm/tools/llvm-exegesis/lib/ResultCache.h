@@ -0,0 +1,61 @@
+//===-- ResultCache.h -------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// A cache of benchmark results on disk, so that runs on the same CPU model
+/// don't measure a snippet again.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TOOLS_LLVM_EXEGESIS_RESULTCACHE_H
+#define LLVM_TOOLS_LLVM_EXEGESIS_RESULTCACHE_H
+
+#include "BenchmarkResult.h"
+#include "LlvmState.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include <string>
+
+namespace llvm {
+namespace exegesis {
+
+// Results are stored one per file, named after their key. Files are written
+// under temporary names and renamed into place, so several processes can share
+// a cache.
+class ResultCache {
+public:
+  explicit ResultCache(std::string Directory)
+      : Directory(std::move(Directory)) {}
+
+  // The key of the benchmark set up as `Setup` (see
+  // BenchmarkRunner::getBenchmarkSetup) and repeated with `RepetitionMode`. It
+  // covers the snippet, the way it is run and the CPU it is run on.
+  static llvm::Expected<std::string>
+  getKey(const LLVMState &State, InstructionBenchmark Setup,
+         InstructionBenchmark::RepetitionModeE RepetitionMode);
+
+  // Returns the result stored for `Key`, if any.
+  llvm::Optional<InstructionBenchmark> lookup(const LLVMState &State,
+                                              llvm::StringRef Key) const;
+
+  // Stores `Result` for `Key`. Results with an error are not stored, as the
+  // error may not happen again.
+  llvm::Error store(const LLVMState &State, llvm::StringRef Key,
+                    InstructionBenchmark &Result) const;
+
+private:
+  std::string getPath(llvm::StringRef Key) const;
+
+  const std::string Directory;
+};
+
+} // namespace exegesis
+} // namespace llvm
+
+#endif // LLVM_TOOLS_LLVM_EXEGESIS_RESULTCACHE_H
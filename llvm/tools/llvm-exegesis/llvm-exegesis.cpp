@@ -15,9 +15,11 @@
 #include "lib/BenchmarkResult.h"
 #include "lib/BenchmarkRunner.h"
 #include "lib/Clustering.h"
+#include "lib/CpuAffinity.h"
 #include "lib/Error.h"
 #include "lib/LlvmState.h"
 #include "lib/PerfHelper.h"
+#include "lib/ResultCache.h"
 #include "lib/SnippetFile.h"
 #include "lib/SnippetRepetitor.h"
 #include "lib/Target.h"
@@ -38,7 +40,10 @@
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <string>
+#include <thread>
 
 namespace llvm {
 namespace exegesis {
@@ -101,6 +106,19 @@ static cl::opt<unsigned> MaxConfigsPerOpcode(
         "allow to snippet generator to generate at most that many configs"),
     cl::cat(BenchmarkOptions), cl::init(1));
 
+static cl::opt<std::string> BenchmarkCpus(
+    "benchmark-cpus",
+    cl::desc("measure in parallel, with a worker pinned to each CPU of this "
+             "list (e.g. '2,4-7'), or to each isolated CPU with 'isolated'; "
+             "objects are not dumped to disk in this mode"),
+    cl::cat(BenchmarkOptions), cl::init(""));
+
+static cl::opt<std::string> BenchmarkCacheDir(
+    "benchmark-cache-dir",
+    cl::desc("reuse the results of previous runs stored in this directory, "
+             "and store the new ones there"),
+    cl::cat(BenchmarkOptions), cl::init(""));
+
 static cl::opt<bool> IgnoreInvalidSchedClass(
     "ignore-invalid-sched-class",
     cl::desc("ignore instructions that do not define a sched class"),
@@ -230,6 +248,69 @@ generateSnippets(const LLVMState &State, unsigned Opcode,
   return Generator->generateConfigurations(Instr, ForbiddenRegs);
 }
 
+// Measures `Configuration`, unless `Cache` has a result for it.
+static InstructionBenchmark
+measureConfiguration(const LLVMState &State, const BenchmarkRunner &Runner,
+                     const SnippetRepetitor &Repetitor,
+                     const ResultCache *Cache,
+                     const BenchmarkCode &Configuration,
+                     bool DumpObjectToDisk) {
+  std::string Key;
+  if (Cache) {
+    Key = ExitOnErr(ResultCache::getKey(
+        State, Runner.getBenchmarkSetup(Configuration, NumRepetitions),
+        RepetitionMode));
+    if (auto Cached = Cache->lookup(State, Key))
+      return std::move(*Cached);
+  }
+  InstructionBenchmark Result = Runner.runConfiguration(
+      Configuration, NumRepetitions, Repetitor, DumpObjectToDisk);
+  if (Cache)
+    ExitOnErr(Cache->store(State, Key, Result));
+  return Result;
+}
+
+// Measures the configurations on a worker thread per CPU, each pinned to its
+// CPU and with a target machine and scratch space of its own. The workers
+// take the next configuration as they finish one, and pass the results to
+// `WriteResult` in the order they complete.
+static void benchmarkOnCpus(
+    llvm::ArrayRef<unsigned> Cpus,
+    llvm::ArrayRef<BenchmarkCode> Configurations, const ResultCache *Cache,
+    llvm::function_ref<void(InstructionBenchmark &)> WriteResult) {
+  std::atomic<size_t> NextConfiguration(0);
+  std::vector<std::thread> Workers;
+  for (const unsigned Cpu : Cpus) {
+    Workers.emplace_back([&, Cpu] {
+      ExitOnErr(pinCurrentThreadToCpu(Cpu));
+      const LLVMState State(CpuName);
+      const std::unique_ptr<BenchmarkRunner> Runner =
+          State.getExegesisTarget().createBenchmarkRunner(BenchmarkMode,
+                                                          State);
+      const auto Repetitor = SnippetRepetitor::Create(RepetitionMode, State);
+      for (size_t I = NextConfiguration++; I < Configurations.size();
+           I = NextConfiguration++) {
+        // The messages about dumped objects would interleave.
+        InstructionBenchmark Result =
+            measureConfiguration(State, *Runner, *Repetitor, Cache,
+                                 Configurations[I], /*DumpObjectToDisk=*/false);
+        WriteResult(Result);
+      }
+    });
+  }
+  for (std::thread &Worker : Workers)
+    Worker.join();
+}
+
+static std::vector<unsigned> getBenchmarkCpusOrDie() {
+  const std::vector<unsigned> Cpus =
+      ExitOnErr(BenchmarkCpus == "isolated" ? getIsolatedCpus()
+                                            : parseCpuList(BenchmarkCpus));
+  if (Cpus.empty())
+    llvm::report_fatal_error("--benchmark-cpus has no CPUs");
+  return Cpus;
+}
+
 void benchmarkMain() {
 #ifndef HAVE_LIBPFM
   llvm::report_fatal_error(
@@ -288,10 +369,38 @@ void benchmarkMain() {
   if (BenchmarkFile.empty())
     BenchmarkFile = "-";
 
-  for (const BenchmarkCode &Conf : Configurations) {
-    InstructionBenchmark Result = Runner->runConfiguration(
-        Conf, NumRepetitions, *Repetitor, DumpObjectToDisk);
-    ExitOnErr(Result.writeYaml(State, BenchmarkFile));
+  // Results are written as soon as they are measured, so that they can be
+  // followed during long runs.
+  std::unique_ptr<llvm::raw_fd_ostream> BenchmarkFileOS;
+  if (BenchmarkFile != "-") {
+    std::error_code ErrorCode;
+    BenchmarkFileOS = std::make_unique<llvm::raw_fd_ostream>(
+        BenchmarkFile, ErrorCode, llvm::sys::fs::OF_Text);
+    if (ErrorCode)
+      llvm::report_fatal_error("cannot open benchmarks file: " +
+                               BenchmarkFile);
+  }
+  llvm::raw_ostream &OS = BenchmarkFileOS ? *BenchmarkFileOS : llvm::outs();
+  std::mutex OSMutex;
+  const auto WriteResult = [&](InstructionBenchmark &Result) {
+    std::lock_guard<std::mutex> Lock(OSMutex);
+    ExitOnErr(Result.writeYamlTo(State, OS));
+  };
+
+  std::unique_ptr<ResultCache> Cache;
+  if (!BenchmarkCacheDir.empty())
+    Cache = std::make_unique<ResultCache>(BenchmarkCacheDir);
+
+  if (BenchmarkCpus.empty()) {
+    for (const BenchmarkCode &Conf : Configurations) {
+      InstructionBenchmark Result =
+          measureConfiguration(State, *Runner, *Repetitor, Cache.get(), Conf,
+                               DumpObjectToDisk);
+      WriteResult(Result);
+    }
+  } else {
+    benchmarkOnCpus(getBenchmarkCpusOrDie(), Configurations, Cache.get(),
+                    WriteResult);
   }
   exegesis::pfm::pfmTerminate();
 }
@@ -29,12 +29,14 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/SystemUtils.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Transforms/IPO/FunctionImport.h"
 #include "llvm/Transforms/IPO/Internalize.h"
 #include "llvm/Transforms/Utils/FunctionImportUtils.h"
 
+#include <atomic>
 #include <memory>
 #include <utility>
 using namespace llvm;
@@ -91,6 +93,16 @@ static cl::opt<bool>
 static cl::opt<bool>
 Verbose("v", cl::desc("Print information about actions taken"));
 
+static cl::opt<bool> TreeLink(
+    "tree-link",
+    cl::desc("Link the input files by linking adjacent pairs of modules in "
+             "parallel, each pair in its own context, until one is left"));
+
+static cl::opt<unsigned> TreeLinkThreads(
+    "tree-link-threads", cl::init(0),
+    cl::desc("Number of threads for -tree-link, or 0 for one per hardware "
+             "thread"));
+
 static cl::opt<bool>
 DumpAsm("d", cl::desc("Print assembly as linked"), cl::Hidden);
 
@@ -345,6 +357,110 @@ static bool linkFiles(const char *argv0, LLVMContext &Context, Linker &L,
   return true;
 }
 
+namespace {
+/// An input of a level of the tree link: an input file, or the bitcode of the
+/// module linked from a range of input files at the previous level.
+struct TreeLinkInput {
+  std::string File;
+  SmallVector<char, 0> Bitcode;
+};
+} // anonymous namespace
+
+static std::unique_ptr<Module> loadTreeLinkInput(const char *argv0,
+                                                 const TreeLinkInput &Input,
+                                                 LLVMContext &Context) {
+  if (Input.Bitcode.empty()) {
+    std::unique_ptr<Module> M = loadFile(argv0, Input.File, Context);
+    if (!M) {
+      errs() << argv0 << ": ";
+      WithColor::error() << " loading file '" << Input.File << "'\n";
+      return nullptr;
+    }
+    if (DisableDITypeMap && verifyModule(*M, &errs())) {
+      errs() << argv0 << ": " << Input.File << ": ";
+      WithColor::error() << "input module is broken!\n";
+      return nullptr;
+    }
+    return M;
+  }
+
+  Expected<std::unique_ptr<Module>> MOrErr = parseBitcodeFile(
+      MemoryBufferRef(StringRef(Input.Bitcode.data(), Input.Bitcode.size()),
+                      Input.File),
+      Context);
+  if (!MOrErr) {
+    WithColor::error() << toString(MOrErr.takeError()) << '\n';
+    return nullptr;
+  }
+  return std::move(*MOrErr);
+}
+
+/// Link \p Src into \p Dst, which is replaced by the bitcode of the result.
+static bool linkTreeLinkInputs(const char *argv0, TreeLinkInput &Dst,
+                               TreeLinkInput &Src) {
+  LLVMContext Context;
+  Context.setDiagnosticHandler(std::make_unique<LLVMLinkDiagnosticHandler>(),
+                               true);
+  if (!DisableDITypeMap)
+    Context.enableDebugTypeODRUniquing();
+
+  std::unique_ptr<Module> DstM = loadTreeLinkInput(argv0, Dst, Context);
+  std::unique_ptr<Module> SrcM =
+      DstM ? loadTreeLinkInput(argv0, Src, Context) : nullptr;
+  if (!SrcM)
+    return false;
+  if (Verbose)
+    errs() << "Linking '" << Src.File << "' into '" << Dst.File << "'\n";
+  if (Linker::linkModules(*DstM, std::move(SrcM)))
+    return false;
+
+  Src.Bitcode.clear();
+  Dst.Bitcode.clear();
+  raw_svector_ostream OS(Dst.Bitcode);
+  WriteBitcodeToFile(*DstM, OS, PreserveBitcodeUseListOrder);
+  return true;
+}
+
+/// Link \p Files with -tree-link. Since the modules of the earlier files are
+/// always the destination, symbols are resolved as when linking the files one
+/// by one, as long as no option depends on the order the files are linked in.
+static bool treeLinkFiles(const char *argv0, LLVMContext &Context, Linker &L,
+                          const cl::list<std::string> &Files) {
+  if (OnlyNeeded || Internalize || !SummaryIndex.empty()) {
+    WithColor::error() << "-tree-link cannot be used with -only-needed, "
+                          "-internalize or -summary-index\n";
+    return false;
+  }
+
+  std::vector<TreeLinkInput> Inputs(Files.size());
+  for (unsigned I = 0, E = Files.size(); I != E; ++I)
+    Inputs[I].File = Files[I];
+
+  ThreadPool Pool(hardware_concurrency_strategy(TreeLinkThreads));
+  std::atomic<bool> Failed(false);
+  while (Inputs.size() > 1) {
+    for (size_t I = 0; I + 1 < Inputs.size(); I += 2)
+      Pool.async([&, I] {
+        if (!linkTreeLinkInputs(argv0, Inputs[I], Inputs[I + 1]))
+          Failed = true;
+      });
+    Pool.wait();
+    if (Failed)
+      return false;
+
+    // Keep the results, and the last input if it had no pair.
+    std::vector<TreeLinkInput> Next;
+    for (size_t I = 0; I < Inputs.size(); I += 2)
+      Next.push_back(std::move(Inputs[I]));
+    Inputs = std::move(Next);
+  }
+
+  std::unique_ptr<Module> M = loadTreeLinkInput(argv0, Inputs[0], Context);
+  if (!M)
+    return false;
+  return !L.linkInModule(std::move(M));
+}
+
 int main(int argc, char **argv) {
   InitLLVM X(argc, argv);
   ExitOnErr.setBanner(std::string(argv[0]) + ": ");
@@ -365,8 +481,12 @@ int main(int argc, char **argv) {
     Flags |= Linker::Flags::LinkOnlyNeeded;
 
   // First add all the regular input files
-  if (!linkFiles(argv[0], Context, L, InputFilenames, Flags))
+  if (TreeLink) {
+    if (!treeLinkFiles(argv[0], Context, L, InputFilenames))
+      return 1;
+  } else if (!linkFiles(argv[0], Context, L, InputFilenames, Flags)) {
     return 1;
+  }
 
   // Next the -override ones.
   if (!linkFiles(argv[0], Context, L, OverridingInputs,
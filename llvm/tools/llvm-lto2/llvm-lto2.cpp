@@ -49,6 +49,11 @@ static cl::opt<std::string> OutputFilename("o", cl::Required,
 static cl::opt<std::string> CacheDir("cache-dir", cl::desc("Cache Directory"),
                                      cl::value_desc("directory"));
 
+static cl::opt<std::string>
+    SharedCacheDir("shared-cache-dir",
+                   cl::desc("Shared cache directory, used behind -cache-dir"),
+                   cl::value_desc("directory"));
+
 static cl::opt<std::string> OptPipeline("opt-pipeline",
                                         cl::desc("Optimizer Pipeline"),
                                         cl::value_desc("pipeline"));
@@ -68,6 +73,17 @@ static cl::opt<bool>
 static cl::opt<int> Threads("thinlto-threads",
                             cl::init(llvm::heavyweight_hardware_concurrency()));
 
+static cl::opt<std::string> ThinLTORemoteWorker(
+    "thinlto-remote-worker",
+    cl::desc("Run the ThinLTO backend jobs with this program, followed by the "
+             "paths of the module, its index and the object to write"),
+    cl::value_desc("program"));
+
+static cl::list<std::string>
+    ThinLTORemoteWorkerArgs("thinlto-remote-worker-arg",
+                            cl::desc("Pass an argument to the ThinLTO remote "
+                                     "worker, before the paths"));
+
 static cl::list<std::string> SymbolResolutions(
     "r",
     cl::desc("Specify a symbol resolution: filename,symbolname,resolution\n"
@@ -137,6 +153,15 @@ static cl::opt<bool>
 static cl::opt<std::string>
     StatsFile("stats-file", cl::desc("Filename to write statistics to"));
 
+static cl::opt<bool>
+    PrintMemoryUsage("lto-print-memory-usage", cl::init(false),
+                     cl::desc("Print the memory usage after each LTO stage"));
+
+static cl::opt<unsigned> ThinLTOMemoryBudget(
+    "thinlto-memory-budget", cl::init(0),
+    cl::desc("Do not start a ThinLTO backend job while the heap usage is "
+             "above this many megabytes (0 = no limit)"));
+
 static void check(Error E, std::string Msg) {
   if (!E)
     return;
@@ -270,6 +295,8 @@ static int run(int argc, char **argv) {
   Conf.OverrideTriple = OverrideTriple;
   Conf.DefaultTriple = DefaultTriple;
   Conf.StatsFile = StatsFile;
+  Conf.PrintMemoryUsage = PrintMemoryUsage;
+  Conf.ThinLTOMemoryBudget = size_t(ThinLTOMemoryBudget) << 20;
 
   ThinBackend Backend;
   if (ThinLTODistributedIndexes)
@@ -278,6 +305,11 @@ static int run(int argc, char **argv) {
                                             /* ShouldEmitImportsFiles */ true,
                                             /* LinkedObjectsFile */ nullptr,
                                             /* OnWrite */ {});
+  else if (!ThinLTORemoteWorker.empty())
+    Backend = createRemoteThinBackend(
+        createCommandRemoteBackendExecutor(ThinLTORemoteWorker,
+                                           ThinLTORemoteWorkerArgs),
+        Threads);
   else
     Backend = createInProcessThinBackend(Threads);
   LTO Lto(std::move(Conf), std::move(Backend));
@@ -343,7 +375,13 @@ static int run(int argc, char **argv) {
   };
 
   NativeObjectCache Cache;
-  if (!CacheDir.empty())
+  if (!CacheDir.empty() && !SharedCacheDir.empty())
+    Cache = check(sharedCache(CacheDir,
+                              check(createDirectoryCacheStore(SharedCacheDir),
+                                    "failed to create shared cache"),
+                              AddBuffer),
+                  "failed to create cache");
+  else if (!CacheDir.empty())
     Cache = check(localCache(CacheDir, AddBuffer), "failed to create cache");
 
   check(Lto.run(AddStream, Cache), "LTO::run failed");
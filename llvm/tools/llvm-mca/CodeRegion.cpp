@@ -113,5 +113,16 @@ void CodeRegions::addInstruction(const MCInst &Instruction) {
       Region->addInstruction(Instruction);
 }
 
+void CodeRegions::addRegion(StringRef Description,
+                            ArrayRef<MCInst> Instructions) {
+  if (Regions.size() == 1 && Regions[0]->empty() &&
+      Regions[0]->getDescription().empty() &&
+      !Regions[0]->startLoc().isValid() && !Regions[0]->endLoc().isValid())
+    Regions.clear();
+  Regions.emplace_back(std::make_unique<CodeRegion>(Description, SMLoc()));
+  for (const MCInst &Instruction : Instructions)
+    Regions.back()->addInstruction(Instruction);
+}
+
 } // namespace mca
 } // namespace llvm
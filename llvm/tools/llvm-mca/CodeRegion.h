@@ -107,6 +107,10 @@ public:
   void beginRegion(llvm::StringRef Description, llvm::SMLoc Loc);
   void endRegion(llvm::StringRef Description, llvm::SMLoc Loc);
   void addInstruction(const llvm::MCInst &Instruction);
+  // Adds a region for an input without source locations, such as the code of
+  // an object file. The first one replaces the default region.
+  void addRegion(llvm::StringRef Description,
+                 llvm::ArrayRef<llvm::MCInst> Instructions);
   llvm::SourceMgr &getSourceMgr() const { return SM; }
 
   llvm::ArrayRef<llvm::MCInst> getInstructionSequence(unsigned Idx) const {
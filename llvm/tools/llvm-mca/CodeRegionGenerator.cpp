@@ -16,11 +16,18 @@
 #include "CodeRegionGenerator.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/MC/MCParser/MCTargetAsmParser.h"
 #include "llvm/MC/MCStreamer.h"
 #include "llvm/MC/MCTargetOptions.h"
+#include "llvm/Object/SymbolSize.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/SMLoc.h"
+#include "llvm/Support/WithColor.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cinttypes>
 #include <memory>
 
 namespace llvm {
@@ -136,5 +143,132 @@ Expected<const CodeRegions &> AsmCodeRegionGenerator::parseCodeRegions() {
   return Regions;
 }
 
+namespace {
+struct DecodedInstruction {
+  uint64_t Address;
+  uint64_t Size;
+  MCInst Inst;
+};
+} // namespace
+
+Error ObjectCodeRegionGenerator::addFunction(const MCDisassembler &Disassembler,
+                                             StringRef Name,
+                                             ArrayRef<uint8_t> Bytes,
+                                             uint64_t Address) {
+  const uint64_t EndAddress = Address + Bytes.size();
+  std::vector<DecodedInstruction> Decoded;
+  // The addresses the basic blocks start at, and the [start, end) address
+  // ranges of the loops.
+  std::vector<uint64_t> Leaders = {Address};
+  std::vector<std::pair<uint64_t, uint64_t>> Loops;
+  for (uint64_t Offset = 0; Offset < Bytes.size();) {
+    DecodedInstruction I;
+    I.Address = Address + Offset;
+    if (Disassembler.getInstruction(I.Inst, I.Size, Bytes.slice(Offset),
+                                    I.Address, nulls(),
+                                    nulls()) != MCDisassembler::Success ||
+        I.Size == 0)
+      return createStringError(inconvertibleErrorCode(),
+                               "%s: unable to decode the instruction at "
+                               "offset 0x%" PRIx64,
+                               Name.str().c_str(), Offset);
+    Offset += I.Size;
+
+    const MCInstrDesc &Desc = MCII.get(I.Inst.getOpcode());
+    if (Desc.isTerminator() || Desc.isBranch())
+      Leaders.push_back(I.Address + I.Size);
+    uint64_t Target;
+    if (MCIA && Desc.isBranch() &&
+        MCIA->evaluateBranch(I.Inst, I.Address, I.Size, Target) &&
+        Target >= Address && Target < EndAddress) {
+      Leaders.push_back(Target);
+      if (Target <= I.Address)
+        Loops.emplace_back(Target, I.Address + I.Size);
+    }
+    Decoded.push_back(std::move(I));
+  }
+  llvm::sort(Leaders);
+  llvm::sort(Loops);
+  Loops.erase(std::unique(Loops.begin(), Loops.end()), Loops.end());
+
+  auto AddRegion = [&](uint64_t Begin, uint64_t End, bool IsLoop) {
+    SmallVector<MCInst, 16> Instructions;
+    for (const DecodedInstruction &I : Decoded)
+      if (I.Address >= Begin && I.Address < End)
+        Instructions.push_back(I.Inst);
+    if (Instructions.empty())
+      return;
+    std::string Description;
+    raw_string_ostream OS(Description);
+    OS << Name << '+' << format_hex(Begin - Address, 0);
+    if (IsLoop)
+      OS << " (loop)";
+    Regions.addRegion(Saver.save(OS.str()), Instructions);
+  };
+
+  // Leaders that are not on an instruction boundary, such as the targets of
+  // branches into the middle of an instruction, are ignored.
+  std::vector<std::pair<uint64_t, uint64_t>> Blocks;
+  for (const DecodedInstruction &I : Decoded)
+    if (I.Address == Address ||
+        std::binary_search(Leaders.begin(), Leaders.end(), I.Address)) {
+      if (!Blocks.empty())
+        Blocks.back().second = I.Address;
+      Blocks.emplace_back(I.Address, EndAddress);
+    }
+  for (const std::pair<uint64_t, uint64_t> &Block : Blocks)
+    AddRegion(Block.first, Block.second, is_contained(Loops, Block));
+  // Loops of a single block were reported with it.
+  for (const std::pair<uint64_t, uint64_t> &Loop : Loops)
+    if (!is_contained(Blocks, Loop))
+      AddRegion(Loop.first, Loop.second, /*IsLoop=*/true);
+  return Error::success();
+}
+
+Expected<const CodeRegions &> ObjectCodeRegionGenerator::parseCodeRegions() {
+  std::unique_ptr<MCDisassembler> Disassembler(
+      TheTarget.createMCDisassembler(STI, Ctx));
+  if (!Disassembler)
+    return make_error<StringError>(
+        "This target does not support disassembly.", inconvertibleErrorCode());
+
+  for (const std::pair<object::SymbolRef, uint64_t> &SymbolAndSize :
+       object::computeSymbolSizes(Obj)) {
+    const object::SymbolRef &Symbol = SymbolAndSize.first;
+    Expected<object::SymbolRef::Type> Type = Symbol.getType();
+    if (!Type)
+      return Type.takeError();
+    if (*Type != object::SymbolRef::ST_Function)
+      continue;
+    Expected<StringRef> Name = Symbol.getName();
+    if (!Name)
+      return Name.takeError();
+    if (!Functions.empty() && !is_contained(Functions, *Name))
+      continue;
+    Expected<object::section_iterator> Section = Symbol.getSection();
+    if (!Section)
+      return Section.takeError();
+    if (*Section == Obj.section_end() || !(*Section)->isText())
+      continue;
+    Expected<uint64_t> Address = Symbol.getAddress();
+    if (!Address)
+      return Address.takeError();
+    Expected<StringRef> Contents = (*Section)->getContents();
+    if (!Contents)
+      return Contents.takeError();
+
+    const uint64_t Offset = *Address - (*Section)->getAddress();
+    if (Offset >= Contents->size())
+      continue;
+    ArrayRef<uint8_t> Bytes =
+        arrayRefFromStringRef(Contents->substr(Offset, SymbolAndSize.second));
+    // A function that cannot be decoded, for example because it embeds data,
+    // does not prevent the others from being analyzed.
+    if (Error Err = addFunction(*Disassembler, *Name, Bytes, *Address))
+      WithColor::warning() << toString(std::move(Err)) << '\n';
+  }
+  return Regions;
+}
+
 } // namespace mca
 } // namespace llvm
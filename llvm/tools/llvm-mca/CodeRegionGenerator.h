@@ -19,11 +19,17 @@
 #include "CodeRegion.h"
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCDisassembler/MCDisassembler.h"
+#include "llvm/MC/MCInstrAnalysis.h"
 #include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/StringSaver.h"
 #include "llvm/Support/TargetRegistry.h"
 #include <memory>
+#include <string>
 
 namespace llvm {
 namespace mca {
@@ -63,6 +69,46 @@ public:
   Expected<const CodeRegions &> parseCodeRegions() override;
 };
 
+/// This class is responsible for disassembling the functions of an object
+/// file and generating a CodeRegions instance with a region per basic block
+/// and per loop.
+///
+/// Basic blocks start at the entry of a function, at the targets of its
+/// branches and after its terminators. A branch back to an earlier block
+/// closes a loop, whose region is the code from that block to the branch.
+/// The region of a loop is simulated in address order, so both sides of a
+/// branch in its body are executed on each iteration. That overestimates the
+/// cost of such bodies, but it lets the simulation see the dependencies that
+/// one iteration of the loop carries over to the next, which the regions of
+/// its blocks alone do not.
+class ObjectCodeRegionGenerator final : public CodeRegionGenerator {
+  const Target &TheTarget;
+  const object::ObjectFile &Obj;
+  MCContext &Ctx;
+  const MCSubtargetInfo &STI;
+  const MCInstrInfo &MCII;
+  const MCInstrAnalysis *MCIA;
+  // The functions to analyze, or all of them if empty.
+  ArrayRef<std::string> Functions;
+  // Owns the descriptions of the regions.
+  BumpPtrAllocator Allocator;
+  StringSaver Saver;
+
+  Error addFunction(const MCDisassembler &Disassembler, StringRef Name,
+                    ArrayRef<uint8_t> Bytes, uint64_t Address);
+
+public:
+  ObjectCodeRegionGenerator(const Target &T, SourceMgr &SM,
+                            const object::ObjectFile &O, MCContext &C,
+                            const MCSubtargetInfo &S, const MCInstrInfo &I,
+                            const MCInstrAnalysis *IA,
+                            ArrayRef<std::string> F)
+      : CodeRegionGenerator(SM), TheTarget(T), Obj(O), Ctx(C), STI(S),
+        MCII(I), MCIA(IA), Functions(F), Saver(Allocator) {}
+
+  Expected<const CodeRegions &> parseCodeRegions() override;
+};
+
 } // namespace mca
 } // namespace llvm
 
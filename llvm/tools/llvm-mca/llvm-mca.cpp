@@ -32,6 +32,7 @@
 #include "Views/SchedulerStatistics.h"
 #include "Views/SummaryView.h"
 #include "Views/TimelineView.h"
+#include "llvm/BinaryFormat/Magic.h"
 #include "llvm/MC/MCAsmBackend.h"
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/MC/MCCodeEmitter.h"
@@ -47,6 +48,7 @@
 #include "llvm/MCA/Stages/EntryStage.h"
 #include "llvm/MCA/Stages/InstructionTables.h"
 #include "llvm/MCA/Support.h"
+#include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ErrorOr.h"
@@ -57,6 +59,7 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/WithColor.h"
 
@@ -208,6 +211,20 @@ static cl::opt<bool> EnableBottleneckAnalysis(
     cl::desc("Enable bottleneck analysis (disabled by default)"),
     cl::cat(ViewOptions), cl::init(false));
 
+static cl::list<std::string>
+    FunctionNames("functions", cl::CommaSeparated,
+                  cl::desc("The functions of an object file to analyze "
+                           "(default: all)"),
+                  cl::cat(ToolOptions));
+
+static cl::opt<unsigned>
+    NumThreads("num-threads",
+               cl::desc("Number of threads to simulate the code regions on "
+                        "(0 = one per core)"),
+               cl::cat(ToolOptions), cl::init(1));
+static cl::alias NumThreadsA("j", cl::desc("Alias for --num-threads"),
+                             cl::aliasopt(NumThreads));
+
 static cl::opt<bool> ShowEncoding(
     "show-encoding",
     cl::desc("Print encoding information in the instruction info view"),
@@ -274,23 +291,164 @@ static void processViewOptions() {
 }
 
 // Returns true on success.
-static bool runPipeline(mca::Pipeline &P) {
+static bool runPipeline(mca::Pipeline &P, raw_ostream &Errs) {
   // Handle pipeline errors here.
   Expected<unsigned> Cycles = P.run();
   if (!Cycles) {
-    WithColor::error() << toString(Cycles.takeError());
+    WithColor::error(Errs) << toString(Cycles.takeError());
     return false;
   }
   return true;
 }
 
+namespace {
+// The target objects shared by the analyses of all the code regions. They are
+// only read from, so that regions can be analyzed concurrently.
+struct AnalysisContext {
+  const Target &TheTarget;
+  const MCSubtargetInfo &STI;
+  const MCRegisterInfo &MRI;
+  const MCAsmInfo &MAI;
+  const MCInstrInfo &MCII;
+  const MCInstrAnalysis *MCIA;
+  MCContext &Ctx;
+  const MCTargetOptions &MCOptions;
+  const mca::PipelineOptions &PO;
+  unsigned AssemblerDialect;
+};
+} // end of anonymous namespace
+
+// Simulates a code region and prints its views to OS, or why it could not be
+// simulated to Errs. The objects that keep state across calls, such as the
+// instruction builder and its descriptor cache, are created for each region.
+// Returns true on success.
+static bool analyzeRegion(const AnalysisContext &AC,
+                          const mca::CodeRegion &Region, raw_ostream &OS,
+                          raw_ostream &Errs) {
+  const MCSubtargetInfo &STI = AC.STI;
+  const MCSchedModel &SM = STI.getSchedModel();
+  std::unique_ptr<MCInstPrinter> IP(AC.TheTarget.createMCInstPrinter(
+      Triple(TripleName), AC.AssemblerDialect, AC.MAI, AC.MCII, AC.MRI));
+  IP->setPrintImmHex(PrintImmHex);
+  std::unique_ptr<MCCodeEmitter> MCE(
+      AC.TheTarget.createMCCodeEmitter(AC.MCII, AC.MRI, AC.Ctx));
+  std::unique_ptr<MCAsmBackend> MAB(
+      AC.TheTarget.createMCAsmBackend(STI, AC.MRI, AC.MCOptions));
+
+  // Create an instruction builder.
+  mca::InstrBuilder IB(STI, AC.MCII, AC.MRI, AC.MCIA);
+
+  // Create a context to control ownership of the pipeline hardware.
+  mca::Context MCA(AC.MRI, STI);
+
+  // Lower the MCInst sequence into an mca::Instruction sequence.
+  ArrayRef<MCInst> Insts = Region.getInstructions();
+  mca::CodeEmitter CE(STI, *MAB, *MCE, Insts);
+  std::vector<std::unique_ptr<mca::Instruction>> LoweredSequence;
+  for (const MCInst &MCI : Insts) {
+    Expected<std::unique_ptr<mca::Instruction>> Inst =
+        IB.createInstruction(MCI);
+    if (!Inst) {
+      if (auto NewE = handleErrors(
+              Inst.takeError(),
+              [&IP, &STI, &Errs](const mca::InstructionError<MCInst> &IE) {
+                std::string InstructionStr;
+                raw_string_ostream SS(InstructionStr);
+                WithColor::error(Errs) << IE.Message << '\n';
+                IP->printInst(&IE.Inst, SS, "", STI);
+                SS.flush();
+                WithColor::note(Errs)
+                    << "instruction: " << InstructionStr << '\n';
+              })) {
+        // Default case.
+        WithColor::error(Errs) << toString(std::move(NewE));
+      }
+      return false;
+    }
+
+    LoweredSequence.emplace_back(std::move(Inst.get()));
+  }
+
+  mca::SourceMgr S(LoweredSequence, PrintInstructionTables ? 1 : Iterations);
+
+  if (PrintInstructionTables) {
+    //  Create a pipeline, stages, and a printer.
+    auto P = std::make_unique<mca::Pipeline>();
+    P->appendStage(std::make_unique<mca::EntryStage>(S));
+    P->appendStage(std::make_unique<mca::InstructionTables>(SM));
+    mca::PipelinePrinter Printer(*P);
+
+    // Create the views for this pipeline, execute, and emit a report.
+    if (PrintInstructionInfoView) {
+      Printer.addView(std::make_unique<mca::InstructionInfoView>(
+          STI, AC.MCII, CE, ShowEncoding, Insts, *IP));
+    }
+    Printer.addView(
+        std::make_unique<mca::ResourcePressureView>(STI, *IP, Insts));
+
+    if (!runPipeline(*P, Errs))
+      return false;
+
+    Printer.printReport(OS);
+    return true;
+  }
+
+  // Create a basic pipeline simulating an out-of-order backend.
+  auto P = MCA.createDefaultPipeline(AC.PO, S);
+  mca::PipelinePrinter Printer(*P);
+
+  if (PrintSummaryView)
+    Printer.addView(
+        std::make_unique<mca::SummaryView>(SM, Insts, DispatchWidth));
+
+  if (EnableBottleneckAnalysis) {
+    Printer.addView(std::make_unique<mca::BottleneckAnalysis>(
+        STI, *IP, Insts, S.getNumIterations()));
+  }
+
+  if (PrintInstructionInfoView)
+    Printer.addView(std::make_unique<mca::InstructionInfoView>(
+        STI, AC.MCII, CE, ShowEncoding, Insts, *IP));
+
+  if (PrintDispatchStats)
+    Printer.addView(std::make_unique<mca::DispatchStatistics>());
+
+  if (PrintSchedulerStats)
+    Printer.addView(std::make_unique<mca::SchedulerStatistics>(STI));
+
+  if (PrintRetireStats)
+    Printer.addView(std::make_unique<mca::RetireControlUnitStatistics>(SM));
+
+  if (PrintRegisterFileStats)
+    Printer.addView(std::make_unique<mca::RegisterFileStatistics>(STI));
+
+  if (PrintResourcePressureView)
+    Printer.addView(
+        std::make_unique<mca::ResourcePressureView>(STI, *IP, Insts));
+
+  if (PrintTimelineView) {
+    unsigned TimelineIterations =
+        TimelineMaxIterations ? TimelineMaxIterations : 10;
+    Printer.addView(std::make_unique<mca::TimelineView>(
+        STI, *IP, Insts, std::min(TimelineIterations, S.getNumIterations()),
+        TimelineMaxCycles));
+  }
+
+  if (!runPipeline(*P, Errs))
+    return false;
+
+  Printer.printReport(OS);
+  return true;
+}
+
 int main(int argc, char **argv) {
   InitLLVM X(argc, argv);
 
-  // Initialize targets and assembly parsers.
+  // Initialize targets, assembly parsers and disassemblers.
   InitializeAllTargetInfos();
   InitializeAllTargetMCs();
   InitializeAllAsmParsers();
+  InitializeAllDisassemblers();
 
   // Enable printing of available targets when flag --version is specified.
   cl::AddExtraVersionPrinter(TargetRegistry::printRegisteredTargetsForVersion);
@@ -301,6 +459,29 @@ int main(int argc, char **argv) {
   cl::ParseCommandLineOptions(argc, argv,
                               "llvm machine code performance analyzer.\n");
 
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferPtr =
+      MemoryBuffer::getFileOrSTDIN(InputFilename);
+  if (std::error_code EC = BufferPtr.getError()) {
+    WithColor::error() << InputFilename << ": " << EC.message() << '\n';
+    return 1;
+  }
+
+  // Object files are disassembled rather than parsed, and give the default
+  // triple.
+  std::unique_ptr<object::ObjectFile> Obj;
+  if (identify_magic((*BufferPtr)->getBuffer()) != file_magic::unknown) {
+    Expected<std::unique_ptr<object::ObjectFile>> ObjOrErr =
+        object::ObjectFile::createObjectFile((*BufferPtr)->getMemBufferRef());
+    if (!ObjOrErr) {
+      WithColor::error() << InputFilename << ": "
+                         << toString(ObjOrErr.takeError()) << '\n';
+      return 1;
+    }
+    Obj = std::move(*ObjOrErr);
+    if (TripleName.empty())
+      TripleName = Obj->makeTriple().normalize();
+  }
+
   // Get the target from the triple. If a triple is not specified, then select
   // the default triple for the host. If the triple doesn't correspond to any
   // registered target, then exit with an error message.
@@ -313,13 +494,6 @@ int main(int argc, char **argv) {
   // For safety, reconstruct the Triple object.
   Triple TheTriple(TripleName);
 
-  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferPtr =
-      MemoryBuffer::getFileOrSTDIN(InputFilename);
-  if (std::error_code EC = BufferPtr.getError()) {
-    WithColor::error() << InputFilename << ": " << EC.message() << '\n';
-    return 1;
-  }
-
   // Apply overrides to llvm-mca specific options.
   processViewOptions();
 
@@ -360,22 +534,30 @@ int main(int argc, char **argv) {
   SourceMgr SrcMgr;
 
   // Tell SrcMgr about this buffer, which is what the parser will pick up.
-  SrcMgr.AddNewSourceBuffer(std::move(*BufferPtr), SMLoc());
+  if (!Obj)
+    SrcMgr.AddNewSourceBuffer(std::move(*BufferPtr), SMLoc());
 
   MCContext Ctx(MAI.get(), MRI.get(), &MOFI, &SrcMgr);
 
   MOFI.InitMCObjectFileInfo(TheTriple, /* PIC= */ false, Ctx);
 
-  std::unique_ptr<buffer_ostream> BOS;
-
   std::unique_ptr<MCInstrInfo> MCII(TheTarget->createMCInstrInfo());
 
   std::unique_ptr<MCInstrAnalysis> MCIA(
       TheTarget->createMCInstrAnalysis(MCII.get()));
 
-  // Parse the input and create CodeRegions that llvm-mca can analyze.
-  mca::AsmCodeRegionGenerator CRG(*TheTarget, SrcMgr, Ctx, *MAI, *STI, *MCII);
-  Expected<const mca::CodeRegions &> RegionsOrErr = CRG.parseCodeRegions();
+  // Parse or disassemble the input and create CodeRegions that llvm-mca can
+  // analyze.
+  std::unique_ptr<mca::CodeRegionGenerator> CRG;
+  unsigned AssemblerDialect = MAI->getAssemblerDialect();
+  if (Obj) {
+    CRG = std::make_unique<mca::ObjectCodeRegionGenerator>(
+        *TheTarget, SrcMgr, *Obj, Ctx, *STI, *MCII, MCIA.get(), FunctionNames);
+  } else {
+    CRG = std::make_unique<mca::AsmCodeRegionGenerator>(*TheTarget, SrcMgr,
+                                                         Ctx, *MAI, *STI, *MCII);
+  }
+  Expected<const mca::CodeRegions &> RegionsOrErr = CRG->parseCodeRegions();
   if (!RegionsOrErr) {
     if (auto Err =
             handleErrors(RegionsOrErr.takeError(), [](const StringError &E) {
@@ -404,7 +586,9 @@ int main(int argc, char **argv) {
     return 1;
   }
 
-  unsigned AssemblerDialect = CRG.getAssemblerDialect();
+  if (!Obj)
+    AssemblerDialect =
+        static_cast<mca::AsmCodeRegionGenerator &>(*CRG).getAssemblerDialect();
   if (OutputAsmVariant >= 0)
     AssemblerDialect = static_cast<unsigned>(OutputAsmVariant);
   std::unique_ptr<MCInstPrinter> IP(TheTarget->createMCInstPrinter(
@@ -417,147 +601,68 @@ int main(int argc, char **argv) {
     return 1;
   }
 
-  // Set the display preference for hex vs. decimal immediates.
-  IP->setPrintImmHex(PrintImmHex);
-
   std::unique_ptr<ToolOutputFile> TOF = std::move(*OF);
 
-  const MCSchedModel &SM = STI->getSchedModel();
-
-  // Create an instruction builder.
-  mca::InstrBuilder IB(*STI, *MCII, *MRI, MCIA.get());
-
-  // Create a context to control ownership of the pipeline hardware.
-  mca::Context MCA(*MRI, *STI);
-
   mca::PipelineOptions PO(MicroOpQueue, DecoderThroughput, DispatchWidth,
                           RegisterFileSize, LoadQueueSize, StoreQueueSize,
                           AssumeNoAlias, EnableBottleneckAnalysis);
 
+  const MCTargetOptions MCOptions = InitMCTargetOptionsFromFlags();
+  const AnalysisContext AC = {*TheTarget, *STI,      *MRI,
+                              *MAI,       *MCII,     MCIA.get(),
+                              Ctx,        MCOptions, PO,
+                              AssemblerDialect};
+
+  // Skip empty code regions.
+  std::vector<const mca::CodeRegion *> NonEmptyRegions;
+  for (const std::unique_ptr<mca::CodeRegion> &Region : Regions)
+    if (!Region->empty())
+      NonEmptyRegions.push_back(Region.get());
+
+  // The reports of the regions are printed in order, up to the first region
+  // that fails. With several threads, all the regions are simulated first.
+  struct RegionReport {
+    std::string Output;
+    std::string Errors;
+    bool Success = false;
+  };
+  std::vector<RegionReport> Reports(NonEmptyRegions.size());
+  auto Analyze = [&](size_t I) {
+    raw_string_ostream OS(Reports[I].Output);
+    raw_string_ostream Errs(Reports[I].Errors);
+    Reports[I].Success = analyzeRegion(AC, *NonEmptyRegions[I], OS, Errs);
+  };
+  if (NumThreads != 1) {
+    ThreadPool Pool(NumThreads);
+    for (size_t I = 0; I < NonEmptyRegions.size(); ++I)
+      Pool.async(Analyze, I);
+    Pool.wait();
+  }
+
   // Number each region in the sequence.
   unsigned RegionIdx = 0;
 
-  std::unique_ptr<MCCodeEmitter> MCE(
-      TheTarget->createMCCodeEmitter(*MCII, *MRI, Ctx));
-
-  std::unique_ptr<MCAsmBackend> MAB(TheTarget->createMCAsmBackend(
-      *STI, *MRI, InitMCTargetOptionsFromFlags()));
-
-  for (const std::unique_ptr<mca::CodeRegion> &Region : Regions) {
-    // Skip empty code regions.
-    if (Region->empty())
-      continue;
+  for (size_t I = 0; I < NonEmptyRegions.size(); ++I) {
+    const mca::CodeRegion &Region = *NonEmptyRegions[I];
+    if (NumThreads == 1)
+      Analyze(I);
 
     // Don't print the header of this region if it is the default region, and
     // it doesn't have an end location.
-    if (Region->startLoc().isValid() || Region->endLoc().isValid()) {
+    StringRef Desc = Region.getDescription();
+    if (Region.startLoc().isValid() || Region.endLoc().isValid() ||
+        !Desc.empty()) {
       TOF->os() << "\n[" << RegionIdx++ << "] Code Region";
-      StringRef Desc = Region->getDescription();
       if (!Desc.empty())
         TOF->os() << " - " << Desc;
       TOF->os() << "\n\n";
     }
 
-    // Lower the MCInst sequence into an mca::Instruction sequence.
-    ArrayRef<MCInst> Insts = Region->getInstructions();
-    mca::CodeEmitter CE(*STI, *MAB, *MCE, Insts);
-    std::vector<std::unique_ptr<mca::Instruction>> LoweredSequence;
-    for (const MCInst &MCI : Insts) {
-      Expected<std::unique_ptr<mca::Instruction>> Inst =
-          IB.createInstruction(MCI);
-      if (!Inst) {
-        if (auto NewE = handleErrors(
-                Inst.takeError(),
-                [&IP, &STI](const mca::InstructionError<MCInst> &IE) {
-                  std::string InstructionStr;
-                  raw_string_ostream SS(InstructionStr);
-                  WithColor::error() << IE.Message << '\n';
-                  IP->printInst(&IE.Inst, SS, "", *STI);
-                  SS.flush();
-                  WithColor::note()
-                      << "instruction: " << InstructionStr << '\n';
-                })) {
-          // Default case.
-          WithColor::error() << toString(std::move(NewE));
-        }
-        return 1;
-      }
-
-      LoweredSequence.emplace_back(std::move(Inst.get()));
-    }
-
-    mca::SourceMgr S(LoweredSequence, PrintInstructionTables ? 1 : Iterations);
-
-    if (PrintInstructionTables) {
-      //  Create a pipeline, stages, and a printer.
-      auto P = std::make_unique<mca::Pipeline>();
-      P->appendStage(std::make_unique<mca::EntryStage>(S));
-      P->appendStage(std::make_unique<mca::InstructionTables>(SM));
-      mca::PipelinePrinter Printer(*P);
-
-      // Create the views for this pipeline, execute, and emit a report.
-      if (PrintInstructionInfoView) {
-        Printer.addView(std::make_unique<mca::InstructionInfoView>(
-            *STI, *MCII, CE, ShowEncoding, Insts, *IP));
-      }
-      Printer.addView(
-          std::make_unique<mca::ResourcePressureView>(*STI, *IP, Insts));
-
-      if (!runPipeline(*P))
-        return 1;
-
-      Printer.printReport(TOF->os());
-      continue;
-    }
-
-    // Create a basic pipeline simulating an out-of-order backend.
-    auto P = MCA.createDefaultPipeline(PO, S);
-    mca::PipelinePrinter Printer(*P);
-
-    if (PrintSummaryView)
-      Printer.addView(
-          std::make_unique<mca::SummaryView>(SM, Insts, DispatchWidth));
-
-    if (EnableBottleneckAnalysis) {
-      Printer.addView(std::make_unique<mca::BottleneckAnalysis>(
-          *STI, *IP, Insts, S.getNumIterations()));
-    }
-
-    if (PrintInstructionInfoView)
-      Printer.addView(std::make_unique<mca::InstructionInfoView>(
-          *STI, *MCII, CE, ShowEncoding, Insts, *IP));
-
-    if (PrintDispatchStats)
-      Printer.addView(std::make_unique<mca::DispatchStatistics>());
-
-    if (PrintSchedulerStats)
-      Printer.addView(std::make_unique<mca::SchedulerStatistics>(*STI));
-
-    if (PrintRetireStats)
-      Printer.addView(std::make_unique<mca::RetireControlUnitStatistics>(SM));
-
-    if (PrintRegisterFileStats)
-      Printer.addView(std::make_unique<mca::RegisterFileStatistics>(*STI));
-
-    if (PrintResourcePressureView)
-      Printer.addView(
-          std::make_unique<mca::ResourcePressureView>(*STI, *IP, Insts));
-
-    if (PrintTimelineView) {
-      unsigned TimelineIterations =
-          TimelineMaxIterations ? TimelineMaxIterations : 10;
-      Printer.addView(std::make_unique<mca::TimelineView>(
-          *STI, *IP, Insts, std::min(TimelineIterations, S.getNumIterations()),
-          TimelineMaxCycles));
-    }
-
-    if (!runPipeline(*P))
+    TOF->os() << Reports[I].Output;
+    if (!Reports[I].Success) {
+      errs() << Reports[I].Errors;
       return 1;
-
-    Printer.printReport(TOF->os());
-
-    // Clear the InstrBuilder internal state in preparation for another round.
-    IB.clear();
+    }
   }
 
   TOF->keep();
@@ -692,15 +692,13 @@ static Optional<std::string> demangle(StringRef Name, bool StripUnderscore) {
   if (!Name.startswith("_Z"))
     return None;
 
-  int Status;
-  char *Undecorated =
-      itaniumDemangle(Name.str().c_str(), nullptr, nullptr, &Status);
-  if (Status != 0)
+  // The names of the symbols an archive uses come up in most of its members.
+  static ItaniumDemangleContext Demangler(/*CacheResults=*/true);
+  const char *Undecorated = Demangler.demangle(Name.str().c_str());
+  if (!Undecorated)
     return None;
 
-  std::string S(Undecorated);
-  free(Undecorated);
-  return S;
+  return std::string(Undecorated);
 }
 
 static bool symbolIsDefined(const NMSymbol &Sym) {
@@ -13,6 +13,7 @@
 #include "llvm-objcopy.h"
 
 #include "llvm/ADT/BitmaskEnum.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
@@ -33,11 +34,13 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/Memory.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <mutex>
 #include <functional>
 #include <iterator>
 #include <memory>
@@ -310,6 +313,38 @@ static bool isCompressable(const SectionBase &Sec) {
          StringRef(Sec.Name).startswith(".debug");
 }
 
+// Compresses the sections that --compress-debug-sections replaces. zlib is
+// by far the most expensive part of the copy, so the sections are compressed
+// in parallel.
+static Error
+compressDebugSections(const Object &Obj,
+                      DenseMap<const SectionBase *, SmallVector<char, 128>>
+                          &CompressedData) {
+  std::vector<const SectionBase *> ToCompress;
+  for (const SectionBase &Sec : Obj.sections())
+    if (isCompressable(Sec))
+      ToCompress.push_back(&Sec);
+  std::vector<SmallVector<char, 128>> Compressed(ToCompress.size());
+
+  std::mutex ErrMutex;
+  Error Err = Error::success();
+  parallel::for_each_n(
+      parallel::par, size_t(0), ToCompress.size(), [&](size_t I) {
+        ArrayRef<uint8_t> Data = ToCompress[I]->OriginalData;
+        if (Error E = zlib::compress(toStringRef(Data), Compressed[I])) {
+          std::lock_guard<std::mutex> Lock(ErrMutex);
+          Err = joinErrors(std::move(Err),
+                           createFileError(ToCompress[I]->Name, std::move(E)));
+        }
+      });
+  if (Err)
+    return Err;
+
+  for (size_t I = 0; I < ToCompress.size(); ++I)
+    CompressedData[ToCompress[I]] = std::move(Compressed[I]);
+  return Error::success();
+}
+
 static void replaceDebugSections(
     Object &Obj, SectionPred &RemovePred,
     function_ref<bool(const SectionBase &)> shouldReplace,
@@ -565,13 +600,17 @@ static Error replaceAndRemoveSections(const CopyConfig &Config, Object &Obj) {
     };
   }
 
-  if (Config.CompressionType != DebugCompressionType::None)
-    replaceDebugSections(Obj, RemovePred, isCompressable, 
-                         [&Config, &Obj](const SectionBase *S) {
+  if (Config.CompressionType != DebugCompressionType::None) {
+    DenseMap<const SectionBase *, SmallVector<char, 128>> CompressedData;
+    if (Error E = compressDebugSections(Obj, CompressedData))
+      return E;
+    replaceDebugSections(Obj, RemovePred, isCompressable,
+                         [&Config, &Obj, &CompressedData](const SectionBase *S) {
                            return &Obj.addSection<CompressedSection>(
-                                *S, Config.CompressionType);
-                        });
-  else if (Config.DecompressDebugSections)
+                               *S, Config.CompressionType,
+                               std::move(CompressedData[S]));
+                         });
+  } else if (Config.DecompressDebugSections)
     replaceDebugSections(
         Obj, RemovePred,
         [](const SectionBase &S) { return isa<CompressedSection>(&S); },
@@ -430,13 +430,14 @@ void ELFSectionWriter<ELFT>::visit(const DecompressedSection &Sec) {
       reinterpret_cast<const char *>(Sec.OriginalData.data()) + DataOffset,
       Sec.OriginalData.size() - DataOffset);
 
-  SmallVector<char, 128> DecompressedContent;
-  if (Error E = zlib::uncompress(CompressedContent, DecompressedContent,
-                                 static_cast<size_t>(Sec.Size)))
+  // Decompress straight into the output, which is zero filled past the end
+  // of the data if it is shorter than the header says.
+  size_t DecompressedSize = static_cast<size_t>(Sec.Size);
+  if (Error E = zlib::uncompress(
+          CompressedContent,
+          reinterpret_cast<char *>(Out.getBufferStart() + Sec.Offset),
+          DecompressedSize))
     reportError(Sec.Name, std::move(E));
-
-  uint8_t *Buf = Out.getBufferStart() + Sec.Offset;
-  std::copy(DecompressedContent.begin(), DecompressedContent.end(), Buf);
 }
 
 void BinarySectionWriter::visit(const DecompressedSection &Sec) {
@@ -501,15 +502,11 @@ void ELFSectionWriter<ELFT>::visit(const CompressedSection &Sec) {
 }
 
 CompressedSection::CompressedSection(const SectionBase &Sec,
-                                     DebugCompressionType CompressionType)
+                                     DebugCompressionType CompressionType,
+                                     SmallVector<char, 128> &&CompressedData)
     : SectionBase(Sec), CompressionType(CompressionType),
-      DecompressedSize(Sec.OriginalData.size()), DecompressedAlign(Sec.Align) {
-  if (Error E = zlib::compress(
-          StringRef(reinterpret_cast<const char *>(OriginalData.data()),
-                    OriginalData.size()),
-          CompressedData))
-    reportError(Name, std::move(E));
-
+      DecompressedSize(Sec.OriginalData.size()), DecompressedAlign(Sec.Align),
+      CompressedData(std::move(CompressedData)) {
   size_t ChdrSize;
   if (CompressionType == DebugCompressionType::GNU) {
     Name = ".z" + Sec.Name.substr(1);
@@ -522,7 +519,7 @@ CompressedSection::CompressedSection(const SectionBase &Sec,
                  std::max(sizeof(object::Elf_Chdr_Impl<object::ELF32LE>),
                           sizeof(object::Elf_Chdr_Impl<object::ELF32BE>)));
   }
-  Size = ChdrSize + CompressedData.size();
+  Size = ChdrSize + this->CompressedData.size();
   Align = 8;
 }
 
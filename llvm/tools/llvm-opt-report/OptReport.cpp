@@ -7,9 +7,10 @@
 //===----------------------------------------------------------------------===//
 ///
 /// \file
-/// This file implements a tool that can parse the YAML optimization
-/// records and generate an optimization summary annotated source listing
-/// report.
+/// This file implements a tool that can parse the YAML or bitstream
+/// optimization records and generate an optimization summary annotated source
+/// listing report. When given several record files, such as the ones of a
+/// whole build, they are parsed in parallel and their records are merged.
 ///
 //===----------------------------------------------------------------------===//
 
@@ -27,6 +28,8 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdlib>
@@ -40,9 +43,9 @@ using namespace llvm;
 static cl::OptionCategory
     OptReportCategory("llvm-opt-report options");
 
-static cl::opt<std::string>
-  InputFileName(cl::Positional, cl::desc("<input>"), cl::init("-"),
-                cl::cat(OptReportCategory));
+static cl::list<std::string>
+  InputFileNames(cl::Positional, cl::desc("<input>..."), cl::ZeroOrMore,
+                 cl::cat(OptReportCategory));
 
 static cl::opt<std::string>
   OutputFileName("o", cl::desc("Output file"), cl::init("-"),
@@ -65,6 +68,14 @@ static cl::opt<std::string> ParserFormat("format",
                                          cl::init("yaml"),
                                          cl::cat(OptReportCategory));
 
+static cl::opt<unsigned>
+  NumThreads("num-threads", cl::init(0),
+             cl::desc("Number of threads used to read the inputs "
+                      "(default: autodetect)"),
+             cl::cat(OptReportCategory));
+static cl::alias NumThreadsA("j", cl::desc("Alias for --num-threads"),
+                             cl::aliasopt(NumThreads));
+
 namespace {
 // For each location in the source file, the common per-transformation state
 // collected.
@@ -145,33 +156,23 @@ typedef std::map<std::string, std::map<int, std::map<std::string, std::map<int,
           OptReportLocationInfo>>>> LocationInfoTy;
 } // anonymous namespace
 
-static bool readLocationInfo(LocationInfoTy &LocationInfo) {
+static Error readLocationInfo(StringRef InputFileName,
+                              LocationInfoTy &LocationInfo) {
   ErrorOr<std::unique_ptr<MemoryBuffer>> Buf =
-      MemoryBuffer::getFile(InputFileName.c_str());
-  if (std::error_code EC = Buf.getError()) {
-    WithColor::error() << "Can't open file " << InputFileName << ": "
-                       << EC.message() << "\n";
-    return false;
-  }
+      MemoryBuffer::getFile(InputFileName);
+  if (std::error_code EC = Buf.getError())
+    return createStringError(EC, "Can't open file %s: %s",
+                             InputFileName.str().c_str(),
+                             EC.message().c_str());
 
   Expected<remarks::Format> Format = remarks::parseFormat(ParserFormat);
-  if (!Format) {
-    handleAllErrors(Format.takeError(), [&](const ErrorInfoBase &PE) {
-      PE.log(WithColor::error());
-      errs() << '\n';
-    });
-    return false;
-  }
+  if (!Format)
+    return Format.takeError();
 
   Expected<std::unique_ptr<remarks::RemarkParser>> MaybeParser =
       remarks::createRemarkParserFromMeta(*Format, (*Buf)->getBuffer());
-  if (!MaybeParser) {
-    handleAllErrors(MaybeParser.takeError(), [&](const ErrorInfoBase &PE) {
-      PE.log(WithColor::error());
-      errs() << '\n';
-    });
-    return false;
-  }
+  if (!MaybeParser)
+    return MaybeParser.takeError();
   remarks::RemarkParser &Parser = **MaybeParser;
 
   while (true) {
@@ -183,11 +184,7 @@ static bool readLocationInfo(LocationInfoTy &LocationInfo) {
         consumeError(std::move(E));
         break;
       }
-      handleAllErrors(std::move(E), [&](const ErrorInfoBase &PE) {
-        PE.log(WithColor::error());
-        errs() << '\n';
-      });
-      return false;
+      return E;
     }
 
     const remarks::Remark &Remark = **MaybeRemark;
@@ -239,7 +236,58 @@ static bool readLocationInfo(LocationInfoTy &LocationInfo) {
     }
   }
 
-  return true;
+  return Error::success();
+}
+
+static void mergeLocationInfo(LocationInfoTy &To, const LocationInfoTy &From) {
+  for (const auto &FI : From)
+    for (const auto &LI : FI.second)
+      for (const auto &FuncI : LI.second)
+        for (const auto &CI : FuncI.second)
+          To[FI.first][LI.first][FuncI.first][CI.first] |= CI.second;
+}
+
+static bool readAllLocationInfo(LocationInfoTy &LocationInfo) {
+  if (InputFileNames.size() == 1) {
+    if (Error E = readLocationInfo(InputFileNames[0], LocationInfo)) {
+      handleAllErrors(std::move(E), [&](const ErrorInfoBase &PE) {
+        PE.log(WithColor::error());
+        errs() << '\n';
+      });
+      return false;
+    }
+    return true;
+  }
+
+  // Every input is read into its own map, and the maps are merged in the
+  // order of the inputs, so that the report doesn't depend on the threads.
+  std::vector<LocationInfoTy> PerInputInfo(InputFileNames.size());
+  std::vector<std::string> ErrorMessages(InputFileNames.size());
+  {
+    unsigned Threads = NumThreads;
+    if (Threads == 0)
+      Threads = std::min<size_t>(heavyweight_hardware_concurrency(),
+                                 InputFileNames.size());
+    ThreadPool Pool(Threads);
+    for (size_t I = 0, E = InputFileNames.size(); I < E; ++I)
+      Pool.async([&, I]() {
+        if (Error E = readLocationInfo(InputFileNames[I], PerInputInfo[I]))
+          ErrorMessages[I] = toString(std::move(E));
+      });
+    Pool.wait();
+  }
+
+  bool Success = true;
+  for (size_t I = 0, E = InputFileNames.size(); I < E; ++I) {
+    if (!ErrorMessages[I].empty()) {
+      WithColor::error() << ErrorMessages[I] << '\n';
+      Success = false;
+      continue;
+    }
+    mergeLocationInfo(LocationInfo, PerInputInfo[I]);
+    PerInputInfo[I].clear();
+  }
+  return Success;
 }
 
 static bool writeReport(LocationInfoTy &LocationInfo) {
@@ -461,11 +509,14 @@ int main(int argc, const char **argv) {
   cl::HideUnrelatedOptions(OptReportCategory);
   cl::ParseCommandLineOptions(
       argc, argv,
-      "A tool to generate an optimization report from YAML optimization"
-      " record files.\n");
+      "A tool to generate an optimization report from YAML or bitstream"
+      " optimization record files.\n");
+
+  if (InputFileNames.empty())
+    InputFileNames.push_back("-");
 
   LocationInfoTy LocationInfo;
-  if (!readLocationInfo(LocationInfo))
+  if (!readAllLocationInfo(LocationInfo))
     return 1;
   if (!writeReport(LocationInfo))
     return 1;
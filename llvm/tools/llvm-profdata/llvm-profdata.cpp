@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
@@ -219,10 +220,18 @@ static void overlapInput(const std::string &BaseFilename,
   }
 }
 
-/// Load an input into a writer context.
+/// Load an input into the writer contexts.
+///
+/// The functions are partitioned between the contexts by the hash of their
+/// name, so that every function is only kept in memory once however many
+/// contexts there are. The errors are recorded in the first context.
 static void loadInput(const WeightedFile &Input, SymbolRemapper *Remapper,
-                      WriterContext *WC) {
-  std::unique_lock<std::mutex> CtxGuard{WC->Lock};
+                      ArrayRef<std::unique_ptr<WriterContext>> Contexts) {
+  WriterContext *ErrWC = Contexts[0].get();
+  auto AddError = [&](Error E, const std::string &Filename) {
+    std::unique_lock<std::mutex> CtxGuard{ErrWC->Lock};
+    ErrWC->Errors.emplace_back(std::move(E), Filename);
+  };
 
   // Copy the filename, because llvm::ThreadPool copied the input "const
   // WeightedFile &" by value, making a reference to the filename within it
@@ -234,44 +243,63 @@ static void loadInput(const WeightedFile &Input, SymbolRemapper *Remapper,
     // Skip the empty profiles by returning sliently.
     instrprof_error IPE = InstrProfError::take(std::move(E));
     if (IPE != instrprof_error::empty_raw_profile)
-      WC->Errors.emplace_back(make_error<InstrProfError>(IPE), Filename);
+      AddError(make_error<InstrProfError>(IPE), Filename);
     return;
   }
 
+  // Every input sets the kind of the first context first, so only that one
+  // can be incompatible with this input.
   auto Reader = std::move(ReaderOrErr.get());
   bool IsIRProfile = Reader->isIRLevelProfile();
   bool HasCSIRProfile = Reader->hasCSIRLevelProfile();
-  if (WC->Writer.setIsIRLevelProfile(IsIRProfile, HasCSIRProfile)) {
-    WC->Errors.emplace_back(
-        make_error<StringError>(
-            "Merge IR generated profile with Clang generated profile.",
-            std::error_code()),
-        Filename);
-    return;
+  for (const std::unique_ptr<WriterContext> &WC : Contexts) {
+    std::unique_lock<std::mutex> CtxGuard{WC->Lock};
+    if (WC->Writer.setIsIRLevelProfile(IsIRProfile, HasCSIRProfile)) {
+      CtxGuard.unlock();
+      AddError(make_error<StringError>(
+                   "Merge IR generated profile with Clang generated profile.",
+                   std::error_code()),
+               Filename);
+      return;
+    }
   }
 
+  // Read the records first, so that each context is locked only once.
+  std::vector<std::vector<NamedInstrProfRecord>> Partitions(Contexts.size());
   for (auto &I : *Reader) {
     if (Remapper)
       I.Name = (*Remapper)(I.Name);
-    const StringRef FuncName = I.Name;
-    bool Reported = false;
-    WC->Writer.addRecord(std::move(I), Input.Weight, [&](Error E) {
-      if (Reported) {
-        consumeError(std::move(E));
-        return;
-      }
-      Reported = true;
-      // Only show hint the first time an error occurs.
-      instrprof_error IPE = InstrProfError::take(std::move(E));
-      std::unique_lock<std::mutex> ErrGuard{WC->ErrLock};
-      bool firstTime = WC->WriterErrorCodes.insert(IPE).second;
-      handleMergeWriterError(make_error<InstrProfError>(IPE), Input.Filename,
-                             FuncName, firstTime);
-    });
+    Partitions[hash_value(I.Name) % Contexts.size()].push_back(std::move(I));
   }
   if (Reader->hasError())
     if (Error E = Reader->getError())
-      WC->Errors.emplace_back(std::move(E), Filename);
+      AddError(std::move(E), Filename);
+
+  for (unsigned Part = 0, E = Contexts.size(); Part != E; ++Part) {
+    if (Partitions[Part].empty())
+      continue;
+    WriterContext *WC = Contexts[Part].get();
+    std::unique_lock<std::mutex> CtxGuard{WC->Lock};
+    for (auto &I : Partitions[Part]) {
+      const StringRef FuncName = I.Name;
+      bool Reported = false;
+      WC->Writer.addRecord(std::move(I), Input.Weight, [&](Error E) {
+        if (Reported) {
+          consumeError(std::move(E));
+          return;
+        }
+        Reported = true;
+        // Only show hint the first time an error occurs.
+        instrprof_error IPE = InstrProfError::take(std::move(E));
+        std::unique_lock<std::mutex> ErrGuard{WC->ErrLock};
+        bool firstTime = WC->WriterErrorCodes.insert(IPE).second;
+        handleMergeWriterError(make_error<InstrProfError>(IPE), Input.Filename,
+                               FuncName, firstTime);
+      });
+    }
+    // Free the records of this partition as soon as they are merged.
+    std::vector<NamedInstrProfRecord>().swap(Partitions[Part]);
+  }
 }
 
 /// Merge the \p Src writer context into \p Dst.
@@ -317,35 +345,19 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
 
   if (NumThreads == 1) {
     for (const auto &Input : Inputs)
-      loadInput(Input, Remapper, Contexts[0].get());
+      loadInput(Input, Remapper, Contexts);
   } else {
     ThreadPool Pool(NumThreads);
 
     // Load the inputs in parallel (N/NumThreads serial steps).
-    unsigned Ctx = 0;
-    for (const auto &Input : Inputs) {
-      Pool.async(loadInput, Input, Remapper, Contexts[Ctx].get());
-      Ctx = (Ctx + 1) % NumThreads;
-    }
+    for (const auto &Input : Inputs)
+      Pool.async(loadInput, Input, Remapper, makeArrayRef(Contexts));
     Pool.wait();
 
-    // Merge the writer contexts together (~ lg(NumThreads) serial steps).
-    unsigned Mid = Contexts.size() / 2;
-    unsigned End = Contexts.size();
-    assert(Mid > 0 && "Expected more than one context");
-    do {
-      for (unsigned I = 0; I < Mid; ++I)
-        Pool.async(mergeWriterContexts, Contexts[I].get(),
-                   Contexts[I + Mid].get());
-      Pool.wait();
-      if (End & 1) {
-        Pool.async(mergeWriterContexts, Contexts[0].get(),
-                   Contexts[End - 1].get());
-        Pool.wait();
-      }
-      End = Mid;
-      Mid /= 2;
-    } while (Mid > 0);
+    // The contexts have no function in common, so this just moves their
+    // records into the first one.
+    for (unsigned I = 1; I < NumThreads; ++I)
+      mergeWriterContexts(Contexts[0].get(), Contexts[I].get());
   }
 
   // Handle deferred errors encountered during merging. If the number of errors
@@ -361,18 +373,29 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
       (NumErrors > 0 && FailMode == failIfAnyAreInvalid))
     exitWithError("No profiles could be merged.");
 
-  std::error_code EC;
-  raw_fd_ostream Output(OutputFilename.data(), EC, sys::fs::OF_None);
-  if (EC)
-    exitWithErrorCode(EC, OutputFilename);
-
-  InstrProfWriter &Writer = Contexts[0]->Writer;
-  if (OutputFormat == PF_Text) {
-    if (Error E = Writer.writeText(Output))
-      exitWithError(std::move(E));
-  } else {
-    Writer.write(Output);
+  // Write to a temporary file that replaces the output when it is complete,
+  // so that the output can also be one of the inputs, for merging new
+  // profiles into an existing one.
+  Expected<sys::fs::TempFile> Temp =
+      sys::fs::TempFile::create(OutputFilename + "-%%%%%%.tmp");
+  if (!Temp)
+    exitWithError(Temp.takeError(), OutputFilename);
+
+  {
+    raw_fd_ostream Output(Temp->FD, /*shouldClose=*/false);
+    InstrProfWriter &Writer = Contexts[0]->Writer;
+    if (OutputFormat == PF_Text) {
+      if (Error E = Writer.writeText(Output)) {
+        consumeError(Temp->discard());
+        exitWithError(std::move(E));
+      }
+    } else {
+      Writer.write(Output);
+    }
   }
+
+  if (Error E = Temp->keep(OutputFilename))
+    exitWithError(std::move(E), OutputFilename);
 }
 
 /// Make a copy of the given function samples with all symbol names remapped
@@ -698,7 +721,8 @@ static void overlapInstrProfile(const std::string &BaseFilename,
                                 raw_fd_ostream &OS, bool IsCS) {
   std::mutex ErrorLock;
   SmallSet<instrprof_error, 4> WriterErrorCodes;
-  WriterContext Context(false, ErrorLock, WriterErrorCodes);
+  auto Context =
+      std::make_unique<WriterContext>(false, ErrorLock, WriterErrorCodes);
   WeightedFile WeightedInput{BaseFilename, 1};
   OverlapStats Overlap;
   Error E = Overlap.accumulateCounts(BaseFilename, TestFilename, IsCS);
@@ -712,9 +736,9 @@ static void overlapInstrProfile(const std::string &BaseFilename,
     OS << "Sum of edge counts for profile " << TestFilename << " is 0.\n";
     exit(0);
   }
-  loadInput(WeightedInput, nullptr, &Context);
-  overlapInput(BaseFilename, TestFilename, &Context, Overlap, FuncFilter, OS,
-               IsCS);
+  loadInput(WeightedInput, nullptr, makeArrayRef(Context));
+  overlapInput(BaseFilename, TestFilename, Context.get(), Overlap, FuncFilter,
+               OS, IsCS);
   Overlap.dump(OS);
 }
 
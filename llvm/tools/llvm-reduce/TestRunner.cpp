@@ -7,12 +7,14 @@
 //===----------------------------------------------------------------------===//
 
 #include "TestRunner.h"
+#include "llvm/Support/ThreadPool.h"
 
 using namespace llvm;
 
-TestRunner::TestRunner(StringRef TestName, const std::vector<std::string> &TestArgs)
-    : TestName(TestName), TestArgs(TestArgs) {
-}
+TestRunner::TestRunner(StringRef TestName,
+                       const std::vector<std::string> &TestArgs,
+                       unsigned NumJobs)
+    : TestName(TestName), TestArgs(TestArgs), NumJobs(std::max(NumJobs, 1u)) {}
 
 /// Runs the interestingness test, passes file to be tested as first argument
 /// and other specified test arguments after that.
@@ -40,3 +42,26 @@ int TestRunner::run(StringRef Filename) {
 
   return !Result;
 }
+
+std::vector<bool> TestRunner::runAll(ArrayRef<std::string> Filenames) {
+  // std::vector<bool> packs its elements, so the threads write to a vector of
+  // chars instead.
+  std::vector<char> Interesting(Filenames.size());
+  if (NumJobs <= 1 || Filenames.size() <= 1) {
+    for (size_t I = 0; I < Filenames.size(); ++I)
+      Interesting[I] = run(Filenames[I]);
+  } else {
+    ThreadPool Pool(std::min<size_t>(NumJobs, Filenames.size()));
+    for (size_t I = 0; I < Filenames.size(); ++I)
+      Pool.async([&, I] { Interesting[I] = run(Filenames[I]); });
+    Pool.wait();
+  }
+  return std::vector<bool>(Interesting.begin(), Interesting.end());
+}
+
+Optional<bool> TestRunner::getCachedResult(const MD5::MD5Result &Hash) const {
+  auto It = Results.find(Hash.words());
+  if (It == Results.end())
+    return None;
+  return It->second;
+}
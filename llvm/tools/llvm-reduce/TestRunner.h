@@ -9,10 +9,14 @@
 #ifndef LLVM_TOOLS_LLVMREDUCE_TESTRUNNER_H
 #define LLVM_TOOLS_LLVMREDUCE_TESTRUNNER_H
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
 #include <vector>
@@ -24,12 +28,28 @@ namespace llvm {
 // respective filename.
 class TestRunner {
 public:
-  TestRunner(StringRef TestName, const std::vector<std::string> &TestArgs);
+  TestRunner(StringRef TestName, const std::vector<std::string> &TestArgs,
+             unsigned NumJobs = 1);
 
   /// Runs the interesting-ness test for the specified file
   /// @returns 0 if test was successful, 1 if otherwise
   int run(StringRef Filename);
 
+  /// Runs the interesting-ness test for each of the files, up to NumJobs of
+  /// them at a time.
+  /// @returns whether each file is interesting
+  std::vector<bool> runAll(ArrayRef<std::string> Filenames);
+
+  /// The number of tests that may run at the same time.
+  unsigned getNumJobs() const { return NumJobs; }
+
+  /// Returns the result of an earlier test of a file with the given hash.
+  Optional<bool> getCachedResult(const MD5::MD5Result &Hash) const;
+
+  void cacheResult(const MD5::MD5Result &Hash, bool Interesting) {
+    Results[Hash.words()] = Interesting;
+  }
+
   /// Returns the most reduced version of the original testcase
   Module *getProgram() const { return Program.get(); }
 
@@ -38,7 +58,10 @@ public:
 private:
   StringRef TestName;
   const std::vector<std::string> &TestArgs;
+  unsigned NumJobs;
   std::unique_ptr<Module> Program;
+  /// The results of the tests run so far, by the hash of the file tested.
+  DenseMap<std::pair<uint64_t, uint64_t>, bool> Results;
 };
 
 } // namespace llvm
@@ -16,43 +16,80 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Transforms/Utils/Cloning.h"
-#include <fstream>
 #include <set>
 
 using namespace llvm;
 
-bool IsReduced(Module &M, TestRunner &Test, SmallString<128> &CurrentFilepath) {
-  // Write Module to tmp file
-  int FD;
-  std::error_code EC =
-      sys::fs::createTemporaryFile("llvm-reduce", "ll", FD, CurrentFilepath);
-  if (EC) {
-    errs() << "Error making unique filename: " << EC.message() << "!\n";
-    exit(1);
-  }
-
-  ToolOutputFile Out(CurrentFilepath, FD);
-  M.print(Out.os(), /*AnnotationWriter=*/nullptr);
-  Out.os().close();
-  if (Out.os().has_error()) {
-    errs() << "Error emitting bitcode to file '" << CurrentFilepath << "'!\n";
-    exit(1);
-  }
-
-  // Current Chunks aren't interesting
-  return Test.run(CurrentFilepath);
-}
+namespace {
+/// The outcome of the interesting-ness test on a version of the program.
+struct TestResult {
+  bool Interesting = false;
+  /// The lines of the program as given to the test.
+  size_t Lines = 0;
+};
+
+/// A version of the program without one more chunk, waiting to be tested.
+struct Candidate {
+  /// The index of the chunk that was removed.
+  int Index;
+  std::unique_ptr<Module> Program;
+};
+} // namespace
+
+/// Runs the interesting-ness test on each of the programs, up to the number of
+/// jobs of \p Test at a time. A program that prints the same as one tested
+/// before gets the earlier result without running the test again.
+static std::vector<TestResult> runTests(TestRunner &Test,
+                                        ArrayRef<const Module *> Programs) {
+  std::vector<TestResult> Results(Programs.size());
+  // The files to test, and the program and hash of each.
+  std::vector<std::unique_ptr<ToolOutputFile>> Files;
+  std::vector<std::string> Filenames;
+  std::vector<std::pair<size_t, MD5::MD5Result>> Pending;
+  for (size_t I = 0; I < Programs.size(); ++I) {
+    std::string Text;
+    raw_string_ostream OS(Text);
+    Programs[I]->print(OS, /*AnnotationWriter=*/nullptr);
+    OS.flush();
+    Results[I].Lines = count(Text, '\n');
+    MD5 Hasher;
+    Hasher.update(Text);
+    MD5::MD5Result Hash;
+    Hasher.final(Hash);
+    if (Optional<bool> Cached = Test.getCachedResult(Hash)) {
+      Results[I].Interesting = *Cached;
+      continue;
+    }
 
-/// Counts the amount of lines for a given file
-static int getLines(StringRef Filepath) {
-  int Lines = 0;
-  std::string CurrLine;
-  std::ifstream FileStream(Filepath);
+    // Write Module to tmp file
+    int FD;
+    SmallString<128> CurrentFilepath;
+    std::error_code EC =
+        sys::fs::createTemporaryFile("llvm-reduce", "ll", FD, CurrentFilepath);
+    if (EC) {
+      errs() << "Error making unique filename: " << EC.message() << "!\n";
+      exit(1);
+    }
 
-  while (std::getline(FileStream, CurrLine))
-    ++Lines;
+    Files.push_back(std::make_unique<ToolOutputFile>(CurrentFilepath, FD));
+    raw_fd_ostream &Out = Files.back()->os();
+    Out << Text;
+    Out.close();
+    if (Out.has_error()) {
+      errs() << "Error emitting bitcode to file '" << CurrentFilepath
+             << "'!\n";
+      exit(1);
+    }
+    Filenames.push_back(CurrentFilepath.str());
+    Pending.push_back({I, Hash});
+  }
 
-  return Lines;
+  std::vector<bool> Interesting = Test.runAll(Filenames);
+  for (size_t J = 0; J < Pending.size(); ++J) {
+    Results[Pending[J].first].Interesting = Interesting[J];
+    Test.cacheResult(Pending[J].second, Interesting[J]);
+  }
+  return Results;
 }
 
 /// Splits Chunks in half and prints them.
@@ -98,8 +135,7 @@ void llvm::runDeltaPass(
   }
 
   if (Module *Program = Test.getProgram()) {
-    SmallString<128> CurrentFilepath;
-    if (!IsReduced(*Program, Test, CurrentFilepath)) {
+    if (!runTests(Test, ArrayRef<const Module *>(Program))[0].Interesting) {
       errs() << "\nInput isn't interesting! Verify interesting-ness test\n";
       exit(1);
     }
@@ -116,37 +152,53 @@ void llvm::runDeltaPass(
 
   do {
     UninterestingChunks = {};
-    for (int I = Chunks.size() - 1; I >= 0; --I) {
-      std::vector<Chunk> CurrentChunks;
-
-      for (auto C : Chunks)
-        if (!UninterestingChunks.count(C) && C != Chunks[I])
-          CurrentChunks.push_back(C);
-
-      if (CurrentChunks.empty())
-        continue;
-
-      // Clone module before hacking it up..
-      std::unique_ptr<Module> Clone = CloneModule(*Test.getProgram());
-      // Generate Module with only Targets inside Current Chunks
-      ExtractChunksFromModule(CurrentChunks, Clone.get());
-
-      errs() << "Ignoring: ";
-      Chunks[I].print();
-      for (auto C : UninterestingChunks)
-        C.print();
-
-
-
-      SmallString<128> CurrentFilepath;
-      if (!IsReduced(*Clone, Test, CurrentFilepath)) {
-        errs() << "\n";
-        continue;
+    for (int I = Chunks.size() - 1; I >= 0;) {
+      // Speculatively try removing each of the next chunks on top of those
+      // found uninteresting so far, one test per job.
+      std::vector<Candidate> Candidates;
+      for (; I >= 0 && Candidates.size() < Test.getNumJobs(); --I) {
+        std::vector<Chunk> CurrentChunks;
+
+        for (auto C : Chunks)
+          if (!UninterestingChunks.count(C) && C != Chunks[I])
+            CurrentChunks.push_back(C);
+
+        if (CurrentChunks.empty())
+          continue;
+
+        // Clone module before hacking it up..
+        std::unique_ptr<Module> Clone = CloneModule(*Test.getProgram());
+        // Generate Module with only Targets inside Current Chunks
+        ExtractChunksFromModule(CurrentChunks, Clone.get());
+        Candidates.push_back({I, std::move(Clone)});
       }
 
-      UninterestingChunks.insert(Chunks[I]);
-      ReducedProgram = std::move(Clone);
-      errs() << " **** SUCCESS | lines: " << getLines(CurrentFilepath) << "\n";
+      std::vector<const Module *> Programs;
+      for (const Candidate &C : Candidates)
+        Programs.push_back(C.Program.get());
+      std::vector<TestResult> Results = runTests(Test, Programs);
+
+      // Accept the first interesting candidate, as testing them one by one
+      // would. The candidates after it assumed it was not, so its successors
+      // are tried again on top of it.
+      for (size_t J = 0; J < Candidates.size(); ++J) {
+        Candidate &C = Candidates[J];
+        errs() << "Ignoring: ";
+        Chunks[C.Index].print();
+        for (auto UC : UninterestingChunks)
+          UC.print();
+
+        if (!Results[J].Interesting) {
+          errs() << "\n";
+          continue;
+        }
+
+        UninterestingChunks.insert(Chunks[C.Index]);
+        ReducedProgram = std::move(C.Program);
+        errs() << " **** SUCCESS | lines: " << Results[J].Lines << "\n";
+        I = C.Index - 1;
+        break;
+      }
     }
     // Delete uninteresting chunks
     erase_if(Chunks, [&UninterestingChunks](const Chunk &C) {
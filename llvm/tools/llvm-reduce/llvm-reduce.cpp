@@ -42,6 +42,11 @@ static cl::list<std::string>
     TestArguments("test-arg", cl::ZeroOrMore,
                   cl::desc("Arguments passed onto the interesting-ness test"));
 
+static cl::opt<unsigned>
+    NumJobs("j", cl::init(1),
+            cl::desc("Number of interesting-ness tests to run in parallel. "
+                     "Tests of independent chunks are run speculatively"));
+
 static cl::opt<std::string>
     OutputFilename("output",
                    cl::desc("Specify the output file. default: reduced.ll"));
@@ -81,7 +86,7 @@ int main(int argc, char **argv) {
       parseInputFile(InputFilename, Context);
 
   // Initialize test environment
-  TestRunner Tester(TestFilename, TestArguments);
+  TestRunner Tester(TestFilename, TestArguments, NumJobs);
   Tester.setProgram(std::move(OriginalProgram));
 
   // Try to reduce code
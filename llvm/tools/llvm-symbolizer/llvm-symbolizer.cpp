@@ -150,6 +150,11 @@ static cl::opt<std::string>
     ClFallbackDebugPath("fallback-debug-path", cl::init(""),
                         cl::desc("Fallback path for debug binaries."));
 
+static cl::opt<uint64_t>
+    ClCacheSize("cache-size", cl::init(0), cl::value_desc("bytes"),
+                cl::desc("Max size in bytes of the binaries to keep loaded "
+                         "between inputs (0 means the default)"));
+
 static cl::opt<DIPrinter::OutputStyle>
     ClOutputStyle("output-style", cl::init(DIPrinter::OutputStyle::LLVM),
                   cl::desc("Specify print style"),
@@ -299,6 +304,8 @@ int main(int argc, char **argv) {
   Opts.DefaultArch = ClDefaultArch;
   Opts.FallbackDebugPath = ClFallbackDebugPath;
   Opts.DWPName = ClDwpName;
+  if (ClCacheSize)
+    Opts.MaxCacheSize = ClCacheSize;
 
   for (const auto &hint : ClDsymHint) {
     if (sys::path::extension(hint) == ".dSYM") {
@@ -321,10 +328,13 @@ int main(int argc, char **argv) {
     while (fgets(InputString, sizeof(InputString), stdin)) {
       symbolizeInput(InputString, Symbolizer, Printer);
       outs().flush();
+      Symbolizer.pruneCache();
     }
   } else {
-    for (StringRef Address : ClInputAddresses)
+    for (StringRef Address : ClInputAddresses) {
       symbolizeInput(Address, Symbolizer, Printer);
+      Symbolizer.pruneCache();
+    }
   }
 
   return 0;
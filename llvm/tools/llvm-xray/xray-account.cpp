@@ -431,18 +431,14 @@ static CommandRegistration Unused(&Account, []() -> Error {
   llvm::xray::FuncIdConversionHelper FuncIdHelper(AccountInstrMap, Symbolizer,
                                                   FunctionAddresses);
   xray::LatencyAccountant FCA(FuncIdHelper, AccountDeduceSiblingCalls);
-  auto TraceOrErr = loadTraceFile(AccountInput);
-  if (!TraceOrErr)
-    return joinErrors(
-        make_error<StringError>(
-            Twine("Failed loading input file '") + AccountInput + "'",
-            std::make_error_code(std::errc::executable_format_error)),
-        TraceOrErr.takeError());
 
-  auto &T = *TraceOrErr;
-  for (const auto &Record : T) {
+  // Account for the records as they are read, so that we never have the whole
+  // trace in memory.
+  XRayFileHeader Header;
+  bool AccountingFailed = false;
+  auto AccountRecord = [&](const XRayRecord &Record) -> Error {
     if (FCA.accountRecord(Record))
-      continue;
+      return Error::success();
     errs()
         << "Error processing record: "
         << llvm::formatv(
@@ -461,18 +457,31 @@ static CommandRegistration Unused(&Account, []() -> Error {
         errs() << "  #" << Level-- << "\t"
                << FuncIdHelper.SymbolOrNumber(Entry.first) << '\n';
     }
-    if (!AccountKeepGoing)
+    if (!AccountKeepGoing) {
+      AccountingFailed = true;
       return make_error<StringError>(
           Twine("Failed accounting function calls in file '") + AccountInput +
               "'.",
           std::make_error_code(std::errc::executable_format_error));
+    }
+    return Error::success();
+  };
+  if (auto Err = processTraceFile(AccountInput, Header, AccountRecord)) {
+    if (AccountingFailed)
+      return Err;
+    return joinErrors(
+        make_error<StringError>(
+            Twine("Failed loading input file '") + AccountInput + "'",
+            std::make_error_code(std::errc::executable_format_error)),
+        std::move(Err));
   }
+
   switch (AccountOutputFormat) {
   case AccountOutputFormats::TEXT:
-    FCA.exportStatsAsText(OS, T.getFileHeader());
+    FCA.exportStatsAsText(OS, Header);
     break;
   case AccountOutputFormats::CSV:
-    FCA.exportStatsAsCSV(OS, T.getFileHeader());
+    FCA.exportStatsAsCSV(OS, Header);
     break;
   }
 
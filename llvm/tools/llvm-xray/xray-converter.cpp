@@ -97,11 +97,11 @@ void TraceConverter::exportAsYAML(const Trace &Records, raw_ostream &OS) {
   Out << Trace;
 }
 
-void TraceConverter::exportAsRAWv1(const Trace &Records, raw_ostream &OS) {
+void TraceConverter::writeRAWv1Header(const XRayFileHeader &FH,
+                                      raw_ostream &OS) {
   // First write out the file header, in the correct endian-appropriate format
   // (XRay assumes currently little endian).
   support::endian::Writer Writer(OS, support::endianness::little);
-  const auto &FH = Records.getFileHeader();
   Writer.write(FH.Version);
   Writer.write(FH.Type);
   uint32_t Bitfield{0};
@@ -118,44 +118,54 @@ void TraceConverter::exportAsRAWv1(const Trace &Records, raw_ostream &OS) {
   Writer.write(Padding4B);
   Writer.write(Padding4B);
   Writer.write(Padding4B);
+}
 
-  // Then write out the rest of the records, still in an endian-appropriate
-  // format.
-  for (const auto &R : Records) {
-    switch (R.Type) {
-    case RecordTypes::ENTER:
-    case RecordTypes::ENTER_ARG:
-      Writer.write(R.RecordType);
-      Writer.write(static_cast<uint8_t>(R.CPU));
-      Writer.write(uint8_t{0});
-      break;
-    case RecordTypes::EXIT:
-      Writer.write(R.RecordType);
-      Writer.write(static_cast<uint8_t>(R.CPU));
-      Writer.write(uint8_t{1});
-      break;
-    case RecordTypes::TAIL_EXIT:
-      Writer.write(R.RecordType);
-      Writer.write(static_cast<uint8_t>(R.CPU));
-      Writer.write(uint8_t{2});
-      break;
-    case RecordTypes::CUSTOM_EVENT:
-    case RecordTypes::TYPED_EVENT:
-      // Skip custom and typed event records for v1 logs.
-      continue;
-    }
-    Writer.write(R.FuncId);
-    Writer.write(R.TSC);
-    Writer.write(R.TId);
-
-    if (FH.Version >= 3)
-      Writer.write(R.PId);
-    else
-      Writer.write(Padding4B);
+void TraceConverter::writeRAWv1Record(const XRayFileHeader &FH,
+                                      const XRayRecord &R, raw_ostream &OS) {
+  // Records are written in the same endian-appropriate format as the header.
+  support::endian::Writer Writer(OS, support::endianness::little);
+  static constexpr uint32_t Padding4B = 0;
+  switch (R.Type) {
+  case RecordTypes::ENTER:
+  case RecordTypes::ENTER_ARG:
+    Writer.write(R.RecordType);
+    Writer.write(static_cast<uint8_t>(R.CPU));
+    Writer.write(uint8_t{0});
+    break;
+  case RecordTypes::EXIT:
+    Writer.write(R.RecordType);
+    Writer.write(static_cast<uint8_t>(R.CPU));
+    Writer.write(uint8_t{1});
+    break;
+  case RecordTypes::TAIL_EXIT:
+    Writer.write(R.RecordType);
+    Writer.write(static_cast<uint8_t>(R.CPU));
+    Writer.write(uint8_t{2});
+    break;
+  case RecordTypes::CUSTOM_EVENT:
+  case RecordTypes::TYPED_EVENT:
+    // Skip custom and typed event records for v1 logs.
+    return;
+  }
+  Writer.write(R.FuncId);
+  Writer.write(R.TSC);
+  Writer.write(R.TId);
 
+  if (FH.Version >= 3)
+    Writer.write(R.PId);
+  else
     Writer.write(Padding4B);
-    Writer.write(Padding4B);
-  }
+
+  Writer.write(Padding4B);
+  Writer.write(Padding4B);
+}
+
+void TraceConverter::exportAsRAWv1(const Trace &Records, raw_ostream &OS) {
+  // First write out the file header, then the rest of the records.
+  const auto &FH = Records.getFileHeader();
+  writeRAWv1Header(FH, OS);
+  for (const auto &R : Records)
+    writeRAWv1Record(FH, R, OS);
 }
 
 namespace {
@@ -393,6 +403,30 @@ static CommandRegistration Unused(&Convert, []() -> Error {
     return make_error<StringError>(
         Twine("Cannot open file '") + ConvertOutput + "' for writing.", EC);
 
+  // Unsorted raw output can be written while the records are read, without
+  // having the whole trace in memory.
+  if (ConvertOutputFormat == ConvertFormats::BINARY && !ConvertSortInput) {
+    XRayFileHeader Header;
+    bool WroteHeader = false;
+    auto ConvertRecord = [&](const XRayRecord &R) {
+      if (!WroteHeader) {
+        TC.writeRAWv1Header(Header, OS);
+        WroteHeader = true;
+      }
+      TC.writeRAWv1Record(Header, R, OS);
+      return Error::success();
+    };
+    if (auto Err = processTraceFile(ConvertInput, Header, ConvertRecord))
+      return joinErrors(
+          make_error<StringError>(
+              Twine("Failed loading input file '") + ConvertInput + "'.",
+              std::make_error_code(std::errc::executable_format_error)),
+          std::move(Err));
+    if (!WroteHeader)
+      TC.writeRAWv1Header(Header, OS);
+    return Error::success();
+  }
+
   auto TraceOrErr = loadTraceFile(ConvertInput, ConvertSortInput);
   if (!TraceOrErr)
     return joinErrors(
@@ -31,6 +31,11 @@ public:
   void exportAsYAML(const Trace &Records, raw_ostream &OS);
   void exportAsRAWv1(const Trace &Records, raw_ostream &OS);
 
+  /// The pieces of exportAsRAWv1, to convert a trace while it is being read.
+  void writeRAWv1Header(const XRayFileHeader &FH, raw_ostream &OS);
+  void writeRAWv1Record(const XRayFileHeader &FH, const XRayRecord &R,
+                        raw_ostream &OS);
+
   /// For this conversion, the Function records within each thread are expected
   /// to be in sorted TSC order. The trace event format encodes stack traces, so
   /// the linear history is essential for correct output.
@@ -724,29 +724,35 @@ static CommandRegistration Unused(&Stack, []() -> Error {
   // TODO: Someday, support output to files instead of just directly to
   // standard output.
   for (const auto &Filename : StackInputs) {
-    auto TraceOrErr = loadTraceFile(Filename);
-    if (!TraceOrErr) {
-      if (!StackKeepGoing)
-        return joinErrors(
-            make_error<StringError>(
-                Twine("Failed loading input file '") + Filename + "'",
-                std::make_error_code(std::errc::invalid_argument)),
-            TraceOrErr.takeError());
-      logAllUnhandledErrors(TraceOrErr.takeError(), errs());
-      continue;
-    }
-    auto &T = *TraceOrErr;
+    // The records are accounted for as they are read, so that we never have
+    // the whole trace in memory.
+    XRayFileHeader Header;
     StackTrie::AccountRecordState AccountRecordState =
         StackTrie::AccountRecordState::CreateInitialState();
-    for (const auto &Record : T) {
+    bool AccountingFailed = false;
+    auto AccountRecord = [&](const XRayRecord &Record) -> Error {
       auto error = ST.accountRecord(Record, &AccountRecordState);
       if (error != StackTrie::AccountRecordStatus::OK) {
-        if (!StackKeepGoing)
+        if (!StackKeepGoing) {
+          AccountingFailed = true;
           return make_error<StringError>(
               CreateErrorMessage(error, Record, FuncIdHelper),
               make_error_code(errc::illegal_byte_sequence));
+        }
         errs() << CreateErrorMessage(error, Record, FuncIdHelper);
       }
+      return Error::success();
+    };
+    if (auto Err = processTraceFile(Filename, Header, AccountRecord)) {
+      if (AccountingFailed)
+        return Err;
+      if (!StackKeepGoing)
+        return joinErrors(
+            make_error<StringError>(
+                Twine("Failed loading input file '") + Filename + "'",
+                std::make_error_code(std::errc::invalid_argument)),
+            std::move(Err));
+      logAllUnhandledErrors(std::move(Err), errs());
     }
   }
   if (ST.isEmpty()) {
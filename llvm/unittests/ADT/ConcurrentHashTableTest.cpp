@@ -0,0 +1,97 @@
+//===- ConcurrentHashTableTest.cpp - ConcurrentHashTable unit tests -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/ConcurrentHashTable.h"
+#include "llvm/Config/llvm-config.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <thread>
+
+using namespace llvm;
+
+namespace {
+
+TEST(ConcurrentHashTableTest, Basic) {
+  ConcurrentHashTable<unsigned, int> Table;
+  EXPECT_TRUE(Table.empty());
+
+  auto R = Table.try_emplace(1, 10);
+  EXPECT_TRUE(R.second);
+  EXPECT_EQ(1U, R.first->first);
+  EXPECT_EQ(10, R.first->second);
+
+  auto R2 = Table.try_emplace(1, 20);
+  EXPECT_FALSE(R2.second);
+  EXPECT_EQ(R.first, R2.first);
+  EXPECT_EQ(10, R2.first->second);
+
+  EXPECT_EQ(R.first, Table.find(1));
+  EXPECT_EQ(nullptr, Table.find(2));
+  EXPECT_EQ(1U, Table.size());
+}
+
+TEST(ConcurrentHashTableTest, SingleShard) {
+  ConcurrentHashTable<unsigned, unsigned> Table(1);
+  for (unsigned I = 0; I < 100; ++I)
+    Table.try_emplace(I, I * 2);
+  EXPECT_EQ(100U, Table.size());
+  for (unsigned I = 0; I < 100; ++I)
+    EXPECT_EQ(I * 2, Table.find(I)->second);
+}
+
+TEST(ConcurrentHashTableTest, SortedEntries) {
+  ConcurrentHashTable<unsigned, unsigned> Table;
+  for (unsigned I : {5, 3, 9, 1, 7})
+    Table.try_emplace(I, I);
+  std::vector<std::pair<unsigned, unsigned> *> V = Table.getSortedEntries();
+  ASSERT_EQ(5U, V.size());
+  for (unsigned I = 0; I < 5; ++I)
+    EXPECT_EQ(I * 2 + 1, V[I]->first);
+}
+
+TEST(ConcurrentStringMapTest, OwnsKeys) {
+  ConcurrentStringMap<int> Map;
+  std::string S = "foo";
+  auto R = Map.try_emplace(S, 1);
+  EXPECT_TRUE(R.second);
+  EXPECT_NE(S.data(), R.first->first.data());
+  S = "bar";
+  EXPECT_EQ("foo", R.first->first);
+  EXPECT_EQ(R.first, Map.find("foo"));
+  EXPECT_FALSE(Map.try_emplace("foo", 2).second);
+  EXPECT_TRUE(Map.try_emplace("", 3).second);
+  EXPECT_EQ(3, Map.find("")->second);
+}
+
+#if LLVM_ENABLE_THREADS
+TEST(ConcurrentStringMapTest, Concurrent) {
+  ConcurrentStringMap<unsigned> Map(8);
+  const unsigned NumThreads = 8;
+  const unsigned NumKeys = 1000;
+  std::vector<std::thread> Threads;
+  // All threads insert the same keys, so each key is inserted exactly once.
+  for (unsigned I = 0; I < NumThreads; ++I)
+    Threads.emplace_back([&] {
+      for (unsigned J = 0; J < NumKeys; ++J)
+        Map.try_emplace(std::to_string(J), J);
+    });
+  for (std::thread &T : Threads)
+    T.join();
+
+  EXPECT_EQ(NumKeys, Map.size());
+  for (unsigned J = 0; J < NumKeys; ++J)
+    EXPECT_EQ(J, Map.find(std::to_string(J))->second);
+
+  std::vector<std::pair<StringRef, unsigned> *> V = Map.getSortedEntries();
+  ASSERT_EQ(NumKeys, V.size());
+  for (size_t I = 1; I < V.size(); ++I)
+    EXPECT_LT(V[I - 1]->first, V[I]->first);
+}
+#endif
+
+} // end anonymous namespace
@@ -0,0 +1,194 @@
+//===- llvm/unittest/ADT/FlatHashMapTest.cpp - FlatHashMap unit tests -----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/FlatHashMap.h"
+#include "llvm/ADT/Hashing.h"
+#include "gtest/gtest.h"
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+
+using namespace llvm;
+
+namespace {
+
+TEST(FlatHashMapTest, EmptyMap) {
+  FlatHashMap<int, int> M;
+  EXPECT_TRUE(M.empty());
+  EXPECT_EQ(0u, M.size());
+  EXPECT_TRUE(M.begin() == M.end());
+  EXPECT_EQ(0u, M.count(0));
+  EXPECT_TRUE(M.find(0) == M.end());
+  EXPECT_EQ(0, M.lookup(0));
+  EXPECT_FALSE(M.erase(0));
+  EXPECT_EQ(0u, M.getMemorySize());
+}
+
+TEST(FlatHashMapTest, InsertFindErase) {
+  FlatHashMap<int, int> M;
+  EXPECT_TRUE(M.insert(std::make_pair(1, 10)).second);
+  EXPECT_FALSE(M.insert(std::make_pair(1, 11)).second);
+  EXPECT_TRUE(M.try_emplace(2, 20).second);
+  M[3] = 30;
+
+  EXPECT_EQ(3u, M.size());
+  EXPECT_EQ(10, M.lookup(1));
+  EXPECT_EQ(20, M.find(2)->second);
+  EXPECT_EQ(30, M[3]);
+  EXPECT_EQ(0u, M.count(4));
+
+  EXPECT_TRUE(M.erase(1));
+  EXPECT_FALSE(M.erase(1));
+  M.erase(M.find(2));
+  EXPECT_EQ(1u, M.size());
+  EXPECT_EQ(0u, M.count(1));
+  EXPECT_EQ(0u, M.count(2));
+  EXPECT_EQ(1u, M.count(3));
+}
+
+TEST(FlatHashMapTest, Growth) {
+  FlatHashMap<unsigned, unsigned> M;
+  for (unsigned I = 0; I != 10000; ++I)
+    M[I] = I * 3;
+  EXPECT_EQ(10000u, M.size());
+  for (unsigned I = 0; I != 10000; ++I)
+    EXPECT_EQ(I * 3, M.lookup(I));
+  EXPECT_EQ(0u, M.count(10000));
+
+  unsigned Sum = 0, NumElts = 0;
+  for (auto &KV : M) {
+    Sum += KV.second;
+    ++NumElts;
+  }
+  EXPECT_EQ(10000u, NumElts);
+  EXPECT_EQ(3u * (10000u * 9999u / 2), Sum);
+}
+
+TEST(FlatHashMapTest, Reserve) {
+  FlatHashMap<int, int> M(100);
+  size_t MemorySize = M.getMemorySize();
+  EXPECT_NE(0u, MemorySize);
+  for (int I = 0; I != 100; ++I)
+    M[I] = I;
+  EXPECT_EQ(MemorySize, M.getMemorySize());
+
+  M.reserve(1000);
+  EXPECT_LT(MemorySize, M.getMemorySize());
+  for (int I = 0; I != 100; ++I)
+    EXPECT_EQ(I, M.lookup(I));
+}
+
+// Erasing and inserting different keys must reuse the deleted buckets rather
+// than growing the map forever.
+TEST(FlatHashMapTest, Churn) {
+  FlatHashMap<int, int> M;
+  for (int I = 0; I != 100; ++I)
+    M[I] = I;
+  size_t MemorySize = M.getMemorySize();
+  for (int I = 100; I != 100000; ++I) {
+    EXPECT_TRUE(M.erase(I - 100));
+    M[I] = I;
+  }
+  EXPECT_EQ(100u, M.size());
+  EXPECT_EQ(MemorySize, M.getMemorySize());
+  for (int I = 99900; I != 100000; ++I)
+    EXPECT_EQ(I, M.lookup(I));
+}
+
+// FlatHashMap does not need empty and tombstone keys.
+struct StringInfo {
+  static unsigned getHashValue(const std::string &Val) {
+    return hash_value(Val);
+  }
+  static bool isEqual(const std::string &LHS, const std::string &RHS) {
+    return LHS == RHS;
+  }
+};
+
+TEST(FlatHashMapTest, NonTrivialTypes) {
+  FlatHashMap<std::string, std::unique_ptr<int>, StringInfo> M;
+  for (int I = 0; I != 1000; ++I)
+    M.try_emplace(std::to_string(I), std::make_unique<int>(I));
+  EXPECT_EQ(1000u, M.size());
+  for (int I = 0; I != 1000; I += 2)
+    EXPECT_TRUE(M.erase(std::to_string(I)));
+  EXPECT_EQ(500u, M.size());
+  for (int I = 1; I < 1000; I += 2)
+    EXPECT_EQ(I, *M.find(std::to_string(I))->second);
+  M.clear();
+  EXPECT_TRUE(M.empty());
+  EXPECT_TRUE(M.find("1") == M.end());
+}
+
+TEST(FlatHashMapTest, CopyAndMove) {
+  FlatHashMap<int, std::string> M = {{1, "one"}, {2, "two"}};
+  FlatHashMap<int, std::string> Copy(M);
+  EXPECT_EQ(2u, Copy.size());
+  EXPECT_EQ("one", Copy.lookup(1));
+  Copy[3] = "three";
+  EXPECT_EQ(0u, M.count(3));
+
+  FlatHashMap<int, std::string> Moved(std::move(Copy));
+  EXPECT_EQ(3u, Moved.size());
+  EXPECT_EQ("three", Moved.lookup(3));
+
+  M = Moved;
+  EXPECT_EQ(3u, M.size());
+  Moved = FlatHashMap<int, std::string>();
+  EXPECT_TRUE(Moved.empty());
+
+  swap(M, Moved);
+  EXPECT_TRUE(M.empty());
+  EXPECT_EQ("two", Moved.lookup(2));
+}
+
+TEST(FlatHashMapTest, ConstIterator) {
+  FlatHashMap<int, int> M;
+  M[1] = 2;
+  const FlatHashMap<int, int> &CM = M;
+  FlatHashMap<int, int>::const_iterator I = CM.find(1);
+  EXPECT_TRUE(I == M.find(1));
+  EXPECT_EQ(2, I->second);
+  EXPECT_TRUE(++I == CM.end());
+}
+
+// Compares FlatHashMap with std::map on a random sequence of operations over a
+// small key space, so that keys are erased and inserted again many times.
+TEST(FlatHashMapTest, RandomOperations) {
+  std::mt19937 Rng(0);
+  FlatHashMap<unsigned, unsigned> M;
+  std::map<unsigned, unsigned> Ref;
+  for (unsigned I = 0; I != 100000; ++I) {
+    unsigned Key = Rng() % 2000;
+    switch (Rng() % 4) {
+    case 0:
+    case 1:
+      M[Key] = I;
+      Ref[Key] = I;
+      break;
+    case 2:
+      EXPECT_EQ(Ref.erase(Key) != 0, M.erase(Key));
+      break;
+    case 3:
+      EXPECT_EQ(Ref.count(Key), M.count(Key));
+      break;
+    }
+    ASSERT_EQ(Ref.size(), M.size());
+  }
+  for (auto &KV : Ref)
+    EXPECT_EQ(KV.second, M.lookup(KV.first));
+  unsigned NumElts = 0;
+  for (auto &KV : M) {
+    EXPECT_EQ(Ref[KV.first], KV.second);
+    ++NumElts;
+  }
+  EXPECT_EQ(Ref.size(), NumElts);
+}
+
+} // namespace
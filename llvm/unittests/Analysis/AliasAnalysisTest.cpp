@@ -13,6 +13,7 @@
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/AsmParser/Parser.h"
 #include "llvm/IR/Constants.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/InstIterator.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/LLVMContext.h"
@@ -205,6 +206,52 @@ TEST_F(AliasAnalysisTest, getModRefInfo) {
   EXPECT_EQ(AA.getModRefInfo(AtomicRMW, None), ModRefInfo::ModRef);
 }
 
+TEST_F(AliasAnalysisTest, BatchAAResults) {
+  SMDiagnostic Err;
+  std::unique_ptr<Module> PM = parseAssemblyString(R"(
+    declare void @g(i32* nocapture)
+
+    define void @f(i32* %p) {
+      %a = alloca i32
+      %b = alloca i32
+      store i32 0, i32* %a
+      call void @g(i32* %b)
+      store i32 1, i32* %b
+      ret void
+    }
+  )", Err, C);
+  ASSERT_TRUE(PM);
+  Function *F = PM->getFunction("f");
+  auto &AA = getAAResults(*F);
+  DominatorTree DT(*F);
+
+  auto I = F->getEntryBlock().begin();
+  Value *P = F->getArg(0);
+  Instruction *A = &*I++;
+  Instruction *B = &*I++;
+  ++I;
+  Instruction *Call = &*I;
+  MemoryLocation LocA(A, LocationSize::precise(4));
+  MemoryLocation LocB(B, LocationSize::precise(4));
+  MemoryLocation LocP(P, LocationSize::precise(4));
+
+  // The batch gives the same answers as the individual queries, also when
+  // they are repeated and hit its caches.
+  BatchAAResults BatchAA(AA);
+  for (unsigned Round = 0; Round != 2; ++Round) {
+    EXPECT_EQ(AA.alias(LocA, LocB), BatchAA.alias(LocA, LocB));
+    EXPECT_EQ(NoAlias, BatchAA.alias(LocA, LocB));
+    EXPECT_TRUE(BatchAA.isNoAlias(LocP, LocA));
+    EXPECT_TRUE(BatchAA.isMustAlias(LocA, LocA));
+    EXPECT_TRUE(BatchAA.pointsToConstantMemory(A, /*OrLocal=*/true));
+    EXPECT_EQ(AA.getModRefInfo(Call, LocA), BatchAA.getModRefInfo(Call, LocA));
+    EXPECT_EQ(AA.callCapturesBefore(Call, LocA, &DT),
+              BatchAA.callCapturesBefore(Call, LocA, &DT));
+    EXPECT_EQ(ModRefInfo::NoModRef,
+              BatchAA.callCapturesBefore(Call, LocA, &DT));
+  }
+}
+
 class AAPassInfraTest : public testing::Test {
 protected:
   LLVMContext C;
@@ -1745,6 +1745,65 @@ TEST_F(ScalarEvolutionsTest, SCEVComputeConstantDifference) {
   });
 }
 
+// Forgetting a loop nest drops the exit counts of all loops in it, and
+// forgetting all expressions recomputes everything from the IR.
+TEST_F(ScalarEvolutionsTest, SCEVForgetLoopNestAndAllExpressions) {
+  LLVMContext C;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(
+      "define void @foo(i32 %n) { "
+      "entry: "
+      "  br label %outer "
+      "outer: "
+      "  %i = phi i32 [ 0, %entry ], [ %i.next, %outer.latch ] "
+      "  br label %inner "
+      "inner: "
+      "  %j = phi i32 [ 0, %outer ], [ %j.next, %inner ] "
+      "  %j.next = add nuw nsw i32 %j, 1 "
+      "  %inner.cond = icmp ult i32 %j.next, 10 "
+      "  br i1 %inner.cond, label %inner, label %outer.latch "
+      "outer.latch: "
+      "  %i.next = add nuw nsw i32 %i, 1 "
+      "  %outer.cond = icmp ult i32 %i.next, 20 "
+      "  br i1 %outer.cond, label %outer, label %exit "
+      "exit: "
+      "  ret void "
+      "} ",
+      Err, C);
+
+  ASSERT_TRUE(M && "Could not parse module?");
+  ASSERT_TRUE(!verifyModule(*M) && "Must have been well formed!");
+
+  runWithSE(*M, "foo", [](Function &F, LoopInfo &LI, ScalarEvolution &SE) {
+    Instruction *J = getInstructionByName(F, "j");
+    const Loop *Inner = LI.getLoopFor(J->getParent());
+    const Loop *Outer = Inner->getParentLoop();
+    ASSERT_NE(Outer, nullptr);
+
+    auto ExpectTripCounts = [&]() {
+      const SCEV *InnerBTC = SE.getBackedgeTakenCount(Inner);
+      const SCEV *OuterBTC = SE.getBackedgeTakenCount(Outer);
+      ASSERT_TRUE(isa<SCEVConstant>(InnerBTC));
+      ASSERT_TRUE(isa<SCEVConstant>(OuterBTC));
+      EXPECT_EQ(cast<SCEVConstant>(InnerBTC)->getAPInt(), 9u);
+      EXPECT_EQ(cast<SCEVConstant>(OuterBTC)->getAPInt(), 19u);
+      EXPECT_TRUE(isa<SCEVAddRecExpr>(SE.getSCEV(J)));
+    };
+
+    ExpectTripCounts();
+    EXPECT_TRUE(SE.hasLoopInvariantBackedgeTakenCount(Inner));
+
+    SE.forgetLoop(Outer);
+    ExpectTripCounts();
+
+    SE.forgetAllExpressions();
+    ExpectTripCounts();
+    auto *AR = cast<SCEVAddRecExpr>(SE.getSCEV(J));
+    EXPECT_EQ(AR->getLoop(), Inner);
+    EXPECT_EQ(AR->getStart(), SE.getZero(J->getType()));
+  });
+}
+
 // Test expansion of nested addrecs in CanonicalMode.
 // Expanding nested addrecs in canonical mode requiers a canonical IV of a
 // type wider than the type of the addrec itself. Currently, SCEVExpander
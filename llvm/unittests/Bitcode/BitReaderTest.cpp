@@ -8,12 +8,14 @@
 
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/AsmParser/Parser.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -190,4 +192,51 @@ TEST(BitReaderTest, MaterializeFunctionsForBlockAddrInFunctionAfter) {
   EXPECT_FALSE(verifyModule(*M, &dbgs()));
 }
 
+// Tests that the modules lazily loaded for importing from the same bitcode
+// module in different contexts, which share the index of its metadata, load
+// the same metadata.
+TEST(BitReaderTest, LazyLoadMetadataForImportingInTwoContexts) {
+  // Enough metadata for the writer to emit an index of the metadata block.
+  std::string Assembly = "define void @f() {\n"
+                         "  ret void, !attach !3\n"
+                         "}\n"
+                         "!named = !{";
+  std::string Nodes;
+  for (unsigned I = 0; I != 40; ++I) {
+    Assembly += (I ? ", !" : "!") + utostr(I);
+    Nodes += "!" + utostr(I) + " = !{!\"s" + utostr(I) + "\"}\n";
+  }
+  Assembly += "}\n" + Nodes;
+
+  SmallString<1024> Mem;
+  LLVMContext WriterContext;
+  writeModuleToBuffer(parseAssembly(WriterContext, Assembly.c_str()), Mem);
+  Expected<std::vector<BitcodeModule>> BMsOrErr =
+      getBitcodeModuleList(MemoryBufferRef(Mem.str(), "test"));
+  ASSERT_TRUE(!!BMsOrErr);
+  ASSERT_EQ(1u, BMsOrErr->size());
+  BitcodeModule &BM = BMsOrErr->front();
+
+  auto LoadAndPrint = [&](LLVMContext &Context) {
+    Expected<std::unique_ptr<Module>> MOrErr =
+        BM.getLazyModule(Context, /*ShouldLazyLoadMetadata=*/true,
+                         /*IsImporting=*/true);
+    if (!MOrErr)
+      report_fatal_error("Could not parse bitcode module");
+    Module &M = **MOrErr;
+    EXPECT_FALSE(M.getFunction("f")->materialize());
+    EXPECT_FALSE(M.materializeMetadata());
+    EXPECT_FALSE(verifyModule(M, &dbgs()));
+    std::string Str;
+    raw_string_ostream OS(Str);
+    M.print(OS, nullptr);
+    return OS.str();
+  };
+  LLVMContext Context1, Context2;
+  std::string First = LoadAndPrint(Context1);
+  EXPECT_NE(std::string::npos, First.find("!attach !3"));
+  EXPECT_NE(std::string::npos, First.find("!39 = !{!\"s39\"}"));
+  EXPECT_EQ(First, LoadAndPrint(Context2));
+}
+
 } // end namespace
@@ -161,6 +161,45 @@ TEST(BitstreamReaderTest, shortRead) {
   }
 }
 
+TEST(BitstreamReaderTest, readVBR) {
+  // Values of every length, written after a run of bits that shifts them to
+  // every position in a word, so that some straddle two words.
+  std::vector<uint64_t> Values;
+  for (unsigned Bits = 0; Bits != 64; ++Bits)
+    Values.push_back((uint64_t(1) << Bits) |
+                     (0x9e3779b97f4a7c15ULL & ((uint64_t(1) << Bits) - 1)));
+  for (unsigned ChunkBits : {2u, 5u, 6u, 8u, 16u}) {
+    for (unsigned Skip = 0; Skip < 32; Skip += 3) {
+      SmallVector<char, 0> Buffer;
+      {
+        BitstreamWriter Stream(Buffer);
+        if (Skip)
+          Stream.Emit(0, Skip);
+        for (uint64_t Value : Values)
+          Stream.EmitVBR64(Value, ChunkBits);
+        Stream.FlushToWord();
+      }
+
+      SimpleBitstreamCursor Cursor(
+          ArrayRef<uint8_t>((const uint8_t *)Buffer.begin(), Buffer.size()));
+      if (Skip)
+        ASSERT_TRUE((bool)Cursor.Read(Skip));
+      for (uint64_t Value : Values) {
+        Expected<uint64_t> MaybeRead = Cursor.ReadVBR64(ChunkBits);
+        ASSERT_TRUE((bool)MaybeRead);
+        EXPECT_EQ(Value, MaybeRead.get());
+      }
+    }
+  }
+
+  // A VBR cut short by the end of the stream is an error.
+  uint8_t Bytes[] = {0xff, 0xff, 0xff, 0xff};
+  SimpleBitstreamCursor Cursor(Bytes);
+  Expected<uint64_t> MaybeRead = Cursor.ReadVBR64(6);
+  EXPECT_FALSE((bool)MaybeRead);
+  consumeError(MaybeRead.takeError());
+}
+
 static_assert(is_trivially_copyable<BitCodeAbbrevOp>::value,
               "trivially copyable");
 
@@ -9,6 +9,11 @@
 #include "llvm/Bitstream/BitstreamWriter.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -55,4 +60,55 @@ TEST(BitstreamWriterTest, emitBlob4ByteAligned) {
   EXPECT_EQ(StringRef("str0"), Buffer);
 }
 
+// Write nested blocks that are large enough to be flushed before the size
+// fields of their enclosing blocks are backpatched.
+static void writeNestedBlocks(BitstreamWriter &W) {
+  W.EnterSubblock(8, 3);
+  // Emit an unaligned placeholder that is patched after it has been flushed.
+  W.Emit(1, 5);
+  uint64_t PatchBit = W.GetCurrentBitNo();
+  W.Emit(0, 32);
+  for (unsigned I = 0; I != 3; ++I) {
+    W.EnterSubblock(9 + I, 4);
+    for (unsigned J = 0; J != 200000; ++J)
+      W.EmitRecord(1, ArrayRef<uint64_t>{J, I});
+    W.ExitBlock();
+  }
+  W.BackpatchWord(PatchBit, 0xdeadbeef);
+  W.ExitBlock();
+}
+
+TEST(BitstreamWriterTest, streamToFile) {
+  SmallString<0> Expected;
+  {
+    BitstreamWriter W(Expected);
+    writeNestedBlocks(W);
+  }
+  // Each inner block is larger than the flush threshold of 1 MB.
+  ASSERT_GT(Expected.size(), 3u << 20);
+
+  SmallString<64> Path;
+  int FD;
+  ASSERT_FALSE(
+      sys::fs::createTemporaryFile("bitstream_writer_test", "bc", FD, Path));
+  ASSERT_FALSE(sys::Process::SafelyCloseFileDescriptor(FD));
+  FileRemover Cleanup(Path);
+  {
+    std::error_code EC;
+    raw_fd_stream OS(Path, EC);
+    ASSERT_FALSE(EC);
+    SmallString<0> Buffer;
+    {
+      BitstreamWriter W(Buffer, &OS, /*FlushThreshold=*/1);
+      writeNestedBlocks(W);
+    }
+    EXPECT_LT(Buffer.size(), Expected.size());
+    OS.write(Buffer.data(), Buffer.size());
+  }
+
+  auto Buf = MemoryBuffer::getFile(Path);
+  ASSERT_TRUE(bool(Buf));
+  EXPECT_TRUE(StringRef(Expected) == (*Buf)->getBuffer());
+}
+
 } // end namespace
@@ -405,3 +405,42 @@ TEST(LegalizerInfoTest, MMOAlignment) {
                                   32, 8, AtomicOrdering::NotAtomic }));
   }
 }
+
+// Repeated queries are answered from the cache, which must tell apart queries
+// that only differ in their types or memory operands.
+TEST(LegalizerInfoTest, CachedQueries) {
+  using namespace TargetOpcode;
+
+  const LLT s16 = LLT::scalar(16);
+  const LLT s32 = LLT::scalar(32);
+  const LLT s64 = LLT::scalar(64);
+  const LLT p0 = LLT::pointer(0, 64);
+
+  LegalizerInfo LI;
+  LI.getActionDefinitionsBuilder(G_ADD)
+    .legalFor({s32})
+    .clampScalar(0, s32, s32);
+  LI.getActionDefinitionsBuilder(G_LOAD)
+    .lowerIf(LegalityPredicates::atomicOrderingAtLeastOrStrongerThan(
+        0, AtomicOrdering::Acquire))
+    .legalForTypesWithMemDesc({{s32, p0, 32, 32}});
+  LI.computeTables();
+
+  for (unsigned Iter = 0; Iter != 2; ++Iter) {
+    EXPECT_ACTION(Legal, 0, LLT(), LegalityQuery(G_ADD, {s32}));
+    EXPECT_ACTION(WidenScalar, 0, s32, LegalityQuery(G_ADD, {s16}));
+    EXPECT_ACTION(NarrowScalar, 0, s32, LegalityQuery(G_ADD, {s64}));
+    EXPECT_ACTION(Legal, 0, LLT(),
+                  LegalityQuery(G_LOAD, {s32, p0},
+                                LegalityQuery::MemDesc{
+                                  32, 32, AtomicOrdering::NotAtomic}));
+    EXPECT_ACTION(Unsupported, 0, LLT(),
+                  LegalityQuery(G_LOAD, {s32, p0},
+                                LegalityQuery::MemDesc{
+                                  32, 16, AtomicOrdering::NotAtomic}));
+    EXPECT_ACTION(Lower, 0, LLT(),
+                  LegalityQuery(G_LOAD, {s32, p0},
+                                LegalityQuery::MemDesc{
+                                  32, 32, AtomicOrdering::Acquire}));
+  }
+}
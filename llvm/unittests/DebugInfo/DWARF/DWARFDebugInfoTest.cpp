@@ -29,6 +29,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Testing/Support/Error.h"
 #include "gtest/gtest.h"
 #include <string>
@@ -1400,6 +1401,132 @@ TEST(DWARFDebugInfo, TestEmptyChildren) {
   EXPECT_EQ(CUDie.begin(), CUDie.end());
 }
 
+TEST(DWARFDebugInfo, TestThreadSafeContext) {
+  // Look up the functions of several compile units from several threads at
+  // once. None of the units is extracted before the threads start.
+  const char *yamldata = R"(
+    debug_str:
+      - ''
+      - f0
+      - f1
+      - f2
+      - f3
+    debug_abbrev:
+      - Code:            0x00000001
+        Tag:             DW_TAG_compile_unit
+        Children:        DW_CHILDREN_yes
+        Attributes:
+          - Attribute:       DW_AT_low_pc
+            Form:            DW_FORM_addr
+          - Attribute:       DW_AT_high_pc
+            Form:            DW_FORM_data4
+      - Code:            0x00000002
+        Tag:             DW_TAG_subprogram
+        Children:        DW_CHILDREN_no
+        Attributes:
+          - Attribute:       DW_AT_name
+            Form:            DW_FORM_strp
+          - Attribute:       DW_AT_low_pc
+            Form:            DW_FORM_addr
+          - Attribute:       DW_AT_high_pc
+            Form:            DW_FORM_data4
+    debug_info:
+      - Length:
+          TotalLength:     0
+        Version:         4
+        AbbrOffset:      0
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000001000
+              - Value:           0x0000000000000100
+          - AbbrCode:        0x00000002
+            Values:
+              - Value:           0x0000000000000001
+              - Value:           0x0000000000001000
+              - Value:           0x0000000000000100
+          - AbbrCode:        0x00000000
+            Values:
+      - Length:
+          TotalLength:     0
+        Version:         4
+        AbbrOffset:      0
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000002000
+              - Value:           0x0000000000000100
+          - AbbrCode:        0x00000002
+            Values:
+              - Value:           0x0000000000000004
+              - Value:           0x0000000000002000
+              - Value:           0x0000000000000100
+          - AbbrCode:        0x00000000
+            Values:
+      - Length:
+          TotalLength:     0
+        Version:         4
+        AbbrOffset:      0
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000003000
+              - Value:           0x0000000000000100
+          - AbbrCode:        0x00000002
+            Values:
+              - Value:           0x0000000000000007
+              - Value:           0x0000000000003000
+              - Value:           0x0000000000000100
+          - AbbrCode:        0x00000000
+            Values:
+      - Length:
+          TotalLength:     0
+        Version:         4
+        AbbrOffset:      0
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000004000
+              - Value:           0x0000000000000100
+          - AbbrCode:        0x00000002
+            Values:
+              - Value:           0x000000000000000A
+              - Value:           0x0000000000004000
+              - Value:           0x0000000000000100
+          - AbbrCode:        0x00000000
+            Values:
+  )";
+  auto ErrOrSections = DWARFYAML::EmitDebugSections(StringRef(yamldata), true);
+  ASSERT_TRUE((bool)ErrOrSections);
+  std::unique_ptr<DWARFContext> DwarfContext = DWARFContext::create(
+      *ErrOrSections, 8, sys::IsLittleEndianHost, /*ThreadSafe=*/true);
+  ASSERT_TRUE(DwarfContext->isThreadSafe());
+
+  const unsigned NumCUs = 4;
+  std::vector<std::string> Names(NumCUs * 16);
+  {
+    ThreadPool Pool(4);
+    for (unsigned I = 0; I < Names.size(); ++I)
+      Pool.async([&, I]() {
+        uint64_t Address = 0x1000 * (I % NumCUs + 1) + I;
+        DWARFDie Function =
+            DwarfContext->getDIEsForAddress(Address).FunctionDIE;
+        if (const char *Name = Function.getName(DINameKind::ShortName))
+          Names[I] = Name;
+      });
+  }
+  for (unsigned I = 0; I < Names.size(); ++I)
+    EXPECT_EQ(Names[I], "f" + std::to_string(I % NumCUs));
+
+  // All DIEs of the units were extracted at once.
+  for (unsigned I = 0; I < NumCUs; ++I)
+    EXPECT_EQ(DwarfContext->getUnitAtIndex(I)->getNumDIEs(), 3u);
+}
+
 TEST(DWARFDebugInfo, TestAttributeIterators) {
   Triple Triple = getNormalizedDefaultTargetTriple();
   if (!isConfigurationSupported(Triple))
@@ -2131,6 +2258,104 @@ TEST(DWARFDebugInfo, TestDwarfVerifyInvalidRefAddrBetween) {
       "error: invalid DIE reference 0x00000011. Offset is in between DIEs:");
 }
 
+TEST(DWARFDebugInfo, TestDwarfVerifyParallel) {
+  // Create three compile units whose functions have DW_FORM_ref_addr types:
+  // the first refers to a DIE, the second to an offset in between DIEs, and
+  // the third to an offset beyond .debug_info. Verifying them in parallel must
+  // report the same errors, in the same order, as verifying them serially.
+  const char *yamldata = R"(
+    debug_str:
+      - ''
+      - /tmp/main.c
+      - main
+    debug_abbrev:
+      - Code:            0x00000001
+        Tag:             DW_TAG_compile_unit
+        Children:        DW_CHILDREN_yes
+        Attributes:
+          - Attribute:       DW_AT_name
+            Form:            DW_FORM_strp
+      - Code:            0x00000002
+        Tag:             DW_TAG_subprogram
+        Children:        DW_CHILDREN_no
+        Attributes:
+          - Attribute:       DW_AT_name
+            Form:            DW_FORM_strp
+          - Attribute:       DW_AT_type
+            Form:            DW_FORM_ref_addr
+    debug_info:
+      - Length:
+          TotalLength:     22
+        Version:         4
+        AbbrOffset:      0
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000000001
+          - AbbrCode:        0x00000002
+            Values:
+              - Value:           0x000000000000000D
+              - Value:           0x000000000000000B
+          - AbbrCode:        0x00000000
+            Values:
+      - Length:
+          TotalLength:     22
+        Version:         4
+        AbbrOffset:      0
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000000001
+          - AbbrCode:        0x00000002
+            Values:
+              - Value:           0x000000000000000D
+              - Value:           0x0000000000000011
+          - AbbrCode:        0x00000000
+            Values:
+      - Length:
+          TotalLength:     22
+        Version:         4
+        AbbrOffset:      0
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000000001
+          - AbbrCode:        0x00000002
+            Values:
+              - Value:           0x000000000000000D
+              - Value:           0x0000000000001000
+          - AbbrCode:        0x00000000
+            Values:
+  )";
+  auto ErrOrSections = DWARFYAML::EmitDebugSections(StringRef(yamldata));
+  ASSERT_TRUE((bool)ErrOrSections);
+  std::unique_ptr<DWARFContext> SerialContext =
+      DWARFContext::create(*ErrOrSections, 8);
+  std::unique_ptr<DWARFContext> ParallelContext = DWARFContext::create(
+      *ErrOrSections, 8, sys::IsLittleEndianHost, /*ThreadSafe=*/true);
+
+  DIDumpOptions DumpOpts;
+  DumpOpts.DumpType = DIDT_DebugInfo;
+  std::string SerialOutput;
+  raw_string_ostream SerialStrm(SerialOutput);
+  EXPECT_FALSE(SerialContext->verify(SerialStrm, DumpOpts));
+  DumpOpts.NumThreads = 4;
+  std::string ParallelOutput;
+  raw_string_ostream ParallelStrm(ParallelOutput);
+  EXPECT_FALSE(ParallelContext->verify(ParallelStrm, DumpOpts));
+
+  EXPECT_TRUE(StringRef(SerialStrm.str())
+                  .contains("error: invalid DIE reference 0x00000011. Offset "
+                            "is in between DIEs:"));
+  EXPECT_TRUE(StringRef(SerialStrm.str())
+                  .contains("error: DW_FORM_ref_addr offset beyond "
+                            ".debug_info bounds:"));
+  EXPECT_EQ(SerialStrm.str(), ParallelStrm.str());
+}
+
 TEST(DWARFDebugInfo, TestDwarfVerifyInvalidLineSequence) {
   // Create a single compile unit whose line table has a sequence in it where
   // the address decreases.
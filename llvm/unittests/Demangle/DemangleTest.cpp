@@ -8,6 +8,7 @@
 
 #include "llvm/Demangle/Demangle.h"
 #include "gmock/gmock.h"
+#include <cstdlib>
 
 using namespace llvm;
 
@@ -22,3 +23,37 @@ TEST(Demangle, demangleTest) {
   EXPECT_EQ(demangle("?foo@@YAXH@Z"), "void __cdecl foo(int)");
   EXPECT_EQ(demangle("foo"), "foo");
 }
+
+TEST(Demangle, itaniumDemangleContextTest) {
+  for (bool CacheResults : {false, true}) {
+    ItaniumDemangleContext Demangler(CacheResults);
+    int Status;
+    // Long enough for the AST to take several blocks of the arena.
+    std::string Long = "_Z3foo";
+    for (int I = 0; I < 200; ++I)
+      Long += "PFvvE";
+    for (int Round = 0; Round < 2; ++Round) {
+      EXPECT_STREQ(Demangler.demangle("_Z3fooi", &Status), "foo(int)");
+      EXPECT_EQ(Status, demangle_success);
+      EXPECT_EQ(Demangler.demangle("foo", &Status), nullptr);
+      EXPECT_EQ(Status, demangle_invalid_mangled_name);
+      const char *Demangled = Demangler.demangle(Long.c_str(), &Status);
+      ASSERT_NE(Demangled, nullptr);
+      char *Expected = itaniumDemangle(Long.c_str(), nullptr, nullptr, nullptr);
+      EXPECT_STREQ(Demangled, Expected);
+      std::free(Expected);
+    }
+    EXPECT_EQ(Demangler.demangle(nullptr, &Status), nullptr);
+    EXPECT_EQ(Status, demangle_invalid_args);
+
+    // Into a buffer of the caller, which grows when it is too small.
+    size_t N = 4;
+    char *Buf = static_cast<char *>(std::malloc(N));
+    Buf = Demangler.demangle("_Z3barv", Buf, &N, &Status);
+    ASSERT_NE(Buf, nullptr);
+    EXPECT_EQ(Status, demangle_success);
+    EXPECT_STREQ(Buf, "bar()");
+    EXPECT_EQ(N, 6u);
+    std::free(Buf);
+  }
+}
@@ -0,0 +1,217 @@
+//===---------- ELF_x86_64.cpp - Tests for JITLink ELF/x86-64 -------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "JITLinkTestCommon.h"
+
+#include "llvm/ExecutionEngine/JITLink/ELF_x86_64.h"
+#include "llvm/Testing/Support/Error.h"
+
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::jitlink;
+using namespace llvm::jitlink::ELF_x86_64_Edges;
+
+namespace {
+
+class JITLinkTest_ELF_x86_64 : public JITLinkTestCommon,
+                               public testing::Test {
+public:
+  using BasicVerifyGraphFunction =
+      std::function<void(LinkGraph &, const MCDisassembler &)>;
+
+  void runBasicVerifyGraphTest(StringRef AsmSrc, StringRef Triple,
+                               StringMap<JITEvaluatedSymbol> Externals,
+                               bool PIC, bool LargeCodeModel,
+                               MCTargetOptions Options,
+                               BasicVerifyGraphFunction RunGraphTest) {
+    auto TR = getTestResources(AsmSrc, Triple, PIC, LargeCodeModel,
+                               std::move(Options));
+    if (!TR) {
+      dbgs() << "Skipping JITLInk unit test: " << toString(TR.takeError())
+             << "\n";
+      return;
+    }
+
+    auto JTCtx = std::make_unique<TestJITLinkContext>(
+        **TR, [&](LinkGraph &G) { RunGraphTest(G, (*TR)->getDisassembler()); });
+
+    JTCtx->externals() = std::move(Externals);
+
+    jitLink_ELF_x86_64(std::move(JTCtx));
+  }
+
+protected:
+  /// Each ELF section is a single block, so edges are found by the offset of
+  /// the symbol that they fix up.
+  static Edge *findEdgeAfter(Symbol &Sym) {
+    for (auto &E : Sym.getBlock().edges())
+      if (E.getOffset() >= Sym.getOffset() &&
+          E.getOffset() < Sym.getOffset() + 16)
+        return &E;
+    return nullptr;
+  }
+
+  static void verifyIsPointerTo(LinkGraph &G, Block &B, Symbol &Target) {
+    EXPECT_EQ(B.edges_size(), 1U) << "Incorrect number of edges for pointer";
+    if (B.edges_size() != 1U)
+      return;
+    auto &E = *B.edges().begin();
+    EXPECT_EQ(E.getOffset(), 0U) << "Expected edge offset of zero";
+    EXPECT_EQ(E.getKind(), Pointer64)
+        << "Expected pointer to have a pointer64 relocation";
+    EXPECT_EQ(&E.getTarget(), &Target) << "Expected edge to point at target";
+    EXPECT_THAT_EXPECTED(readInt<uint64_t>(G, B), HasValue(Target.getAddress()))
+        << "Pointer does not point to target";
+  }
+
+  static int64_t pcRelDelta(Block &B, Edge &E, JITTargetAddress Target) {
+    return Target + E.getAddend() - (B.getAddress() + E.getOffset());
+  }
+};
+
+} // end anonymous namespace
+
+TEST_F(JITLinkTest_ELF_x86_64, BasicRelocations) {
+  runBasicVerifyGraphTest(
+      R"(
+            .text
+            .globl  bar
+            .p2align        4, 0x90
+            .type   bar,@function
+    bar:
+            callq   baz@PLT
+
+            .globl  foo
+            .p2align        4, 0x90
+            .type   foo,@function
+    foo:
+            callq   bar@PLT
+            .globl  foo.1
+    foo.1:
+            movq    y@GOTPCREL(%rip), %rcx
+            .globl  foo.2
+    foo.2:
+            movq    p(%rip), %rdx
+            .globl  foo.3
+    foo.3:
+            movq    x@GOTPCREL(%rip), %rax
+
+            .data
+            .globl  x
+            .p2align        2
+    x:
+            .long   42
+
+            .globl  p
+            .p2align        3
+    p:
+            .quad   x)",
+      "x86_64-unknown-linux",
+      {{"y", JITEvaluatedSymbol(0xdeadbeef, JITSymbolFlags::Exported)},
+       {"baz", JITEvaluatedSymbol(0xcafef00d, JITSymbolFlags::Exported)}},
+      true, false, MCTargetOptions(),
+      [](LinkGraph &G, const MCDisassembler &Dis) {
+        // Name the symbols in the asm above.
+        auto &Baz = symbol(G, "baz");
+        auto &Y = symbol(G, "y");
+        auto &Bar = symbol(G, "bar");
+        auto &Foo = symbol(G, "foo");
+        auto &Foo_1 = symbol(G, "foo.1");
+        auto &Foo_2 = symbol(G, "foo.2");
+        auto &Foo_3 = symbol(G, "foo.3");
+        auto &X = symbol(G, "x");
+        auto &P = symbol(G, "p");
+
+        // Check the absolute pointer in p.
+        {
+          auto *E = findEdgeAfter(P);
+          ASSERT_NE(E, nullptr) << "No relocation for p";
+          EXPECT_EQ(E->getKind(), Pointer64) << "Unexpected edge kind for p";
+          EXPECT_THAT_EXPECTED(
+              readInt<uint64_t>(G, P.getBlock(), E->getOffset()),
+              HasValue(X.getAddress()))
+              << "Pointer64 relocation did not apply correctly";
+        }
+
+        // Check that bar calls baz through a stub that jumps via a GOT entry
+        // for baz. The linker may bypass the stub if baz is in range.
+        {
+          auto *E = findEdgeAfter(Bar);
+          ASSERT_NE(E, nullptr) << "No relocation for bar";
+          EXPECT_EQ(E->getKind(), Branch32) << "Unexpected edge kind for bar";
+          auto &Stub = E->getTarget();
+          ASSERT_TRUE(Stub.isDefined()) << "Call to baz does not use a stub";
+          auto &StubBlock = Stub.getBlock();
+          ASSERT_EQ(StubBlock.edges_size(), 1U)
+              << "Expected one edge from stub to target";
+          auto &StubEdge = *StubBlock.edges().begin();
+          EXPECT_EQ(StubEdge.getKind(), PCRel32);
+          ASSERT_TRUE(StubEdge.getTarget().isDefined());
+          verifyIsPointerTo(G, StubEdge.getTarget().getBlock(), Baz);
+
+          auto Disp = readInt<int32_t>(G, Bar.getBlock(), E->getOffset());
+          ASSERT_THAT_EXPECTED(Disp, Succeeded());
+          int64_t ToStub = pcRelDelta(Bar.getBlock(), *E, Stub.getAddress());
+          int64_t ToBaz = pcRelDelta(Bar.getBlock(), *E, Baz.getAddress());
+          EXPECT_TRUE(*Disp == ToStub || *Disp == ToBaz)
+              << "Call does not reference the stub or baz";
+        }
+
+        // Check that foo is a direct call to bar.
+        {
+          auto *E = findEdgeAfter(Foo);
+          ASSERT_NE(E, nullptr) << "No relocation for foo";
+          EXPECT_EQ(E->getKind(), Branch32);
+          EXPECT_EQ(&E->getTarget(), &Bar) << "Call to bar uses a stub";
+          EXPECT_THAT_EXPECTED(
+              decodeImmediateOperand(Dis, Foo.getBlock(), 0,
+                                     E->getOffset() - 1),
+              HasValue(pcRelDelta(Foo.getBlock(), *E, Bar.getAddress())));
+        }
+
+        // Check the GOT load of the external y in foo.1.
+        {
+          auto *E = findEdgeAfter(Foo_1);
+          ASSERT_NE(E, nullptr) << "No relocation for foo.1";
+          EXPECT_TRUE(E->getKind() == PCRel32GOTLoad ||
+                      E->getKind() == PCRel32GOTLoadRelaxable)
+              << "foo.1 is not a GOT load";
+          ASSERT_TRUE(E->getTarget().isDefined())
+              << "GOT entry should be a defined symbol";
+          verifyIsPointerTo(G, E->getTarget().getBlock(), Y);
+        }
+
+        // Check the PC-relative load of p in foo.2.
+        {
+          auto *E = findEdgeAfter(Foo_2);
+          ASSERT_NE(E, nullptr) << "No relocation for foo.2";
+          EXPECT_EQ(E->getKind(), PCRel32);
+          EXPECT_THAT_EXPECTED(
+              readInt<int32_t>(G, Foo_2.getBlock(), E->getOffset()),
+              HasValue(pcRelDelta(Foo_2.getBlock(), *E, P.getAddress())))
+              << "PCRel load does not reference expected target";
+        }
+
+        // Check that the GOT load of the local x in foo.3 was relaxed to a
+        // lea of x.
+        {
+          auto *E = findEdgeAfter(Foo_3);
+          ASSERT_NE(E, nullptr) << "No relocation for foo.3";
+          EXPECT_EQ(E->getKind(), PCRel32GOTLoadRelaxable);
+          EXPECT_THAT_EXPECTED(
+              readInt<uint8_t>(G, Foo_3.getBlock(), E->getOffset() - 2),
+              HasValue(0x8d))
+              << "GOT load was not relaxed to a lea";
+          EXPECT_THAT_EXPECTED(
+              readInt<int32_t>(G, Foo_3.getBlock(), E->getOffset()),
+              HasValue(pcRelDelta(Foo_3.getBlock(), *E, X.getAddress())))
+              << "Relaxed load does not reference x";
+        }
+      });
+}
@@ -210,6 +210,40 @@ TEST_F(CoreAPIsStandardTest, LookupWithHiddenSymbols) {
       << "Wrong result for \"Bar\"";
 }
 
+TEST_F(CoreAPIsStandardTest, LookupOfReadySymbols) {
+  // Repeated lookups of ready symbols take a faster path. Check that it
+  // gives the same answers as the first lookup, and forgets removed symbols.
+  auto BarHiddenFlags = BarSym.getFlags() & ~JITSymbolFlags::Exported;
+  auto BarHiddenSym = JITEvaluatedSymbol(BarSym.getAddress(), BarHiddenFlags);
+
+  cantFail(JD.define(absoluteSymbols({{Foo, FooSym}, {Bar, BarHiddenSym}})));
+
+  auto &JD2 = ES.createJITDylib("JD2");
+  cantFail(JD2.define(absoluteSymbols({{Bar, QuxSym}, {Baz, BazSym}})));
+
+  JITDylibSearchList SearchOrder({{&JD, false}, {&JD2, false}});
+  for (unsigned I = 0; I != 2; ++I) {
+    auto Result = cantFail(ES.lookup(SearchOrder, {Foo, Bar, Baz}));
+    EXPECT_EQ(Result.size(), 3U) << "Unexpected number of results";
+    EXPECT_EQ(Result[Foo].getAddress(), FooSym.getAddress())
+        << "Wrong result for \"Foo\"";
+    EXPECT_EQ(Result[Bar].getAddress(), QuxSym.getAddress())
+        << "Wrong result for \"Bar\"";
+    EXPECT_EQ(Result[Baz].getAddress(), BazSym.getAddress())
+        << "Wrong result for \"Baz\"";
+  }
+
+  auto HiddenBar =
+      cantFail(ES.lookup(JITDylibSearchList({{&JD, true}}), Bar));
+  EXPECT_EQ(HiddenBar.getAddress(), BarSym.getAddress())
+      << "Hidden \"Bar\" should be found when matching non-exported symbols";
+
+  cantFail(JD.remove({Foo}));
+  auto Result = ES.lookup(SearchOrder, Foo);
+  EXPECT_THAT_EXPECTED(std::move(Result), Failed<SymbolsNotFound>())
+      << "Removed \"Foo\" should not be found";
+}
+
 TEST_F(CoreAPIsStandardTest, LookupFlagsTest) {
   // Test that lookupFlags works on a predefined symbol, and does not trigger
   // materialization of a lazy symbol. Make the lazy symbol weak to test that
@@ -0,0 +1,102 @@
+//===------- OnDiskObjectCacheTest.cpp - Unit tests for the object cache --===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/OnDiskObjectCache.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+class OnDiskObjectCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(sys::fs::createUniqueDirectory("orc-object-cache", CacheDir));
+  }
+
+  void TearDown() override { sys::fs::remove_directories(CacheDir); }
+
+  std::unique_ptr<Module> parse(const char *IR) {
+    SMDiagnostic Err;
+    auto M = parseAssemblyString(IR, Err, Context);
+    EXPECT_TRUE(!!M) << "Could not parse test IR";
+    return M;
+  }
+
+  std::unique_ptr<OnDiskObjectCache> createCache(std::string TargetKey) {
+    return cantFail(OnDiskObjectCache::Create(CacheDir, std::move(TargetKey)));
+  }
+
+  LLVMContext Context;
+  SmallString<128> CacheDir;
+};
+
+const char *FooIR = R"(
+  define i32 @foo() {
+    ret i32 42
+  })";
+
+TEST_F(OnDiskObjectCacheTest, StoreAndReload) {
+  auto M = parse(FooIR);
+  auto Cache = createCache("key");
+  EXPECT_EQ(Cache->getObject(M.get()), nullptr) << "Empty cache should miss";
+  Cache->notifyObjectCompiled(M.get(), MemoryBufferRef("foo-object", "foo"));
+
+  // An identical module in a later run of the JIT finds the object.
+  auto Reloaded = parse(FooIR);
+  auto Obj = createCache("key")->getObject(Reloaded.get());
+  ASSERT_NE(Obj, nullptr) << "Stored object was not found";
+  EXPECT_EQ(Obj->getBuffer(), "foo-object");
+
+  EXPECT_EQ(createCache("other-key")->getObject(Reloaded.get()), nullptr)
+      << "Objects should not be shared between targets";
+
+  auto Changed = parse(R"(
+    define i32 @foo() {
+      ret i32 43
+    })");
+  EXPECT_EQ(Cache->getObject(Changed.get()), nullptr)
+      << "Objects should not be shared between different modules";
+}
+
+TEST_F(OnDiskObjectCacheTest, KeyIsComputedBeforeCompile) {
+  auto M = parse(FooIR);
+  auto Cache = createCache("key");
+  EXPECT_EQ(Cache->getObject(M.get()), nullptr);
+
+  // Code generation may change the module before the object is stored.
+  M->getFunction("foo")->setName("bar");
+  Cache->notifyObjectCompiled(M.get(), MemoryBufferRef("foo-object", "foo"));
+
+  auto Reloaded = parse(FooIR);
+  auto Obj = Cache->getObject(Reloaded.get());
+  ASSERT_NE(Obj, nullptr) << "Object was stored under the wrong key";
+  EXPECT_EQ(Obj->getBuffer(), "foo-object");
+}
+
+TEST_F(OnDiskObjectCacheTest, TargetKey) {
+  JITTargetMachineBuilder X86(Triple("x86_64-pc-linux-gnu"));
+  JITTargetMachineBuilder AArch64(Triple("aarch64-pc-linux-gnu"));
+  EXPECT_NE(OnDiskObjectCache::getTargetKey(X86),
+            OnDiskObjectCache::getTargetKey(AArch64));
+
+  auto X86Key = OnDiskObjectCache::getTargetKey(X86);
+  X86.setCodeGenOptLevel(CodeGenOpt::Aggressive);
+  EXPECT_NE(OnDiskObjectCache::getTargetKey(X86), X86Key)
+      << "Optimization level should be part of the key";
+}
+
+} // end anonymous namespace
@@ -0,0 +1,125 @@
+//===----------------- RemoteJITLinkMemoryManagerTest.cpp -----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/OrcABISupport.h"
+#include "llvm/ExecutionEngine/Orc/OrcRemoteTargetClient.h"
+#include "llvm/ExecutionEngine/Orc/OrcRemoteTargetServer.h"
+#include "llvm/ExecutionEngine/Orc/SharedMemory.h"
+#include "QueueChannel.h"
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <thread>
+
+using namespace llvm;
+using namespace llvm::jitlink;
+using namespace llvm::orc;
+
+namespace {
+
+TEST(SharedMemoryTest, TwoViews) {
+  if (!isSharedMemorySupported())
+    return;
+
+  auto Name = getUniqueSharedMemoryName();
+  const uint64_t Size = sys::Process::getPageSizeEstimate();
+  auto RW = createSharedMemory(Name, Size);
+  ASSERT_TRUE(!!RW) << toString(RW.takeError());
+  auto RO = mapSharedMemory(Name, Size, sys::Memory::MF_READ);
+  ASSERT_TRUE(!!RO) << toString(RO.takeError());
+
+  // A name can only be created once while it exists.
+  auto Dup = createSharedMemory(Name, Size);
+  EXPECT_FALSE(!!Dup) << "Created the same shared memory object twice";
+  consumeError(Dup.takeError());
+  cantFail(unlinkSharedMemory(Name));
+
+  char *Writable = static_cast<char *>(RW->base());
+  const char *Readable = static_cast<const char *>(RO->base());
+  EXPECT_NE(Writable, Readable) << "Expected distinct mappings";
+  EXPECT_EQ(Readable[0], 0) << "Shared memory should start out zeroed";
+  strcpy(Writable, "shared");
+  EXPECT_STREQ(Readable, "shared") << "Write was not visible in other view";
+
+  EXPECT_FALSE(sys::Memory::releaseMappedMemory(*RO));
+  EXPECT_FALSE(sys::Memory::releaseMappedMemory(*RW));
+}
+
+TEST(RemoteJITLinkMemoryManagerTest, SharedSegments) {
+  if (!isSharedMemorySupported())
+    return;
+
+  rpc::registerStringError<rpc::RawByteChannel>();
+  auto Channels = createPairedQueueChannels();
+
+  // The server maps the same shared memory objects into this process, at
+  // different addresses, standing in for an executor process.
+  using ServerT =
+      remote::OrcRemoteTargetServer<rpc::RawByteChannel, OrcGenericABI>;
+  auto ServerThread = std::thread([&]() {
+    ServerT Server(
+        *Channels.second,
+        [](const std::string &Name) -> JITTargetAddress { return 0; },
+        [](uint8_t *Addr, uint32_t Size) {},
+        [](uint8_t *Addr, uint32_t Size) {});
+    while (!Server.receivedTerminate())
+      cantFail(Server.handleOne());
+  });
+
+  ExecutionSession ES;
+  auto Client =
+      cantFail(remote::OrcRemoteTargetClient::Create(*Channels.first, ES));
+
+  {
+    auto MemMgr = cantFail(Client->createRemoteJITLinkMemoryManager());
+
+    const auto RX = static_cast<sys::Memory::ProtectionFlags>(
+        sys::Memory::MF_READ | sys::Memory::MF_EXEC);
+    const auto RW = static_cast<sys::Memory::ProtectionFlags>(
+        sys::Memory::MF_READ | sys::Memory::MF_WRITE);
+
+    JITLinkMemoryManager::SegmentsRequestMap Request;
+    Request[RX] = JITLinkMemoryManager::SegmentRequest(16, 4, 0);
+    Request[RW] = JITLinkMemoryManager::SegmentRequest(8, 8, 24);
+    auto Alloc = cantFail(MemMgr->allocate(Request));
+
+    auto Code = Alloc->getWorkingMemory(RX);
+    auto Data = Alloc->getWorkingMemory(RW);
+    ASSERT_GE(Code.size(), 4U);
+    ASSERT_GE(Data.size(), 32U);
+    memcpy(Code.data(), "\xc3\xc3\xc3\xc3", 4);
+    memcpy(Data.data(), "deadbeef", 8);
+
+    auto *RemoteCode = reinterpret_cast<const char *>(
+        static_cast<uintptr_t>(Alloc->getTargetMemory(RX)));
+    auto *RemoteData = reinterpret_cast<const char *>(
+        static_cast<uintptr_t>(Alloc->getTargetMemory(RW)));
+    EXPECT_NE(RemoteCode, Code.data()) << "Remote view should be separate";
+    EXPECT_NE(RemoteData, Data.data()) << "Remote view should be separate";
+
+    bool Finalized = false;
+    Alloc->finalizeAsync([&](Error Err) {
+      EXPECT_FALSE(!!Err) << toString(std::move(Err));
+      Finalized = true;
+    });
+    EXPECT_TRUE(Finalized) << "Finalization did not complete";
+
+    // The content reached the remote views without being written over RPC.
+    EXPECT_EQ(memcmp(RemoteCode, "\xc3\xc3\xc3\xc3", 4), 0);
+    EXPECT_EQ(memcmp(RemoteData, "deadbeef", 8), 0);
+    for (unsigned I = 8; I != 32; ++I)
+      EXPECT_EQ(RemoteData[I], 0) << "Zero-fill byte " << I << " not zeroed";
+
+    cantFail(Alloc->deallocate());
+  }
+
+  cantFail(Client->terminateSession());
+  ServerThread.join();
+}
+
+} // end anonymous namespace
@@ -7,8 +7,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ExecutionEngine/Orc/SymbolStringPool.h"
+#include "llvm/Config/llvm-config.h"
 #include "gtest/gtest.h"
 
+#include <thread>
+
 using namespace llvm;
 using namespace llvm::orc;
 
@@ -50,4 +53,32 @@ TEST(SymbolStringPool, ClearDeadEntries) {
   EXPECT_TRUE(SP.empty()) << "pool should be empty";
 }
 
+#if LLVM_ENABLE_THREADS
+TEST(SymbolStringPool, ConcurrentIntern) {
+  SymbolStringPool SP;
+  constexpr unsigned NumThreads = 4;
+  constexpr unsigned NumStrings = 1000;
+
+  // Every thread interns the same strings, so they must all get the same
+  // entries.
+  std::vector<std::vector<SymbolStringPtr>> Ptrs(NumThreads);
+  std::vector<std::thread> Threads;
+  for (unsigned T = 0; T != NumThreads; ++T)
+    Threads.emplace_back([&, T]() {
+      for (unsigned I = 0; I != NumStrings; ++I)
+        Ptrs[T].push_back(SP.intern("sym" + std::to_string(I)));
+    });
+  for (auto &T : Threads)
+    T.join();
+
+  for (unsigned T = 1; T != NumThreads; ++T)
+    EXPECT_EQ(Ptrs[T], Ptrs[0]) << "Thread " << T << " got different entries";
+  EXPECT_EQ(*Ptrs[0][42], "sym42") << "Wrong string for entry";
+
+  Ptrs.clear();
+  SP.clearDeadEntries();
+  EXPECT_TRUE(SP.empty()) << "pool should be empty";
+}
+#endif
+
 }
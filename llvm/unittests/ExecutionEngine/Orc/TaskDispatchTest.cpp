@@ -0,0 +1,149 @@
+//===----------- TaskDispatchTest.cpp - Test materialization dispatch -----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "OrcTestCommon.h"
+#include "llvm/ExecutionEngine/Orc/TaskDispatch.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gtest/gtest.h"
+
+#include <future>
+
+using namespace llvm;
+using namespace llvm::orc;
+
+class TaskDispatchTest : public CoreAPIsBasedStandardTest {
+protected:
+  std::unique_ptr<SimpleMaterializationUnit>
+  createMU(SymbolStringPtr Name, JITEvaluatedSymbol Sym,
+           std::function<void()> OnMaterialize = std::function<void()>()) {
+    return std::make_unique<SimpleMaterializationUnit>(
+        SymbolFlagsMap({{Name, Sym.getFlags()}}),
+        [=](MaterializationResponsibility R) {
+          if (OnMaterialize)
+            OnMaterialize();
+          cantFail(R.notifyResolved({{Name, Sym}}));
+          cantFail(R.notifyEmitted());
+        });
+  }
+
+  void lookupAsync(SymbolStringPtr Name,
+                   SymbolsResolvedCallback OnComplete =
+                       [](Expected<SymbolMap> Result) {
+                         cantFail(std::move(Result));
+                       }) {
+    ES.lookup(JITDylibSearchList({{&JD, false}}), {Name}, SymbolState::Ready,
+              std::move(OnComplete), NoDependenciesToRegister);
+  }
+};
+
+TEST_F(TaskDispatchTest, OnDemandBeforeSpeculative) {
+  PriorityThreadPoolTaskDispatcher D(1);
+  useTaskDispatcher(ES, D);
+
+  std::mutex OrderMutex;
+  std::vector<SymbolStringPtr> Order;
+  auto Record = [&](SymbolStringPtr Name) {
+    return [&, Name]() {
+      std::lock_guard<std::mutex> Lock(OrderMutex);
+      Order.push_back(Name);
+    };
+  };
+
+  // Keep the only thread busy with foo while bar and baz are queued.
+  std::promise<void> ReleaseFoo;
+  auto FooReleased = ReleaseFoo.get_future().share();
+  auto RecordFoo = Record(Foo);
+  cantFail(JD.define(createMU(Foo, FooSym, [&, FooReleased]() {
+    FooReleased.wait();
+    RecordFoo();
+  })));
+  cantFail(JD.define(createMU(Bar, BarSym, Record(Bar))));
+  cantFail(JD.define(createMU(Baz, BazSym, Record(Baz))));
+
+  lookupAsync(Foo);
+  {
+    MaterializationPriorityScope Speculating(
+        MaterializationPriority::Speculative);
+    lookupAsync(Bar);
+  }
+  lookupAsync(Baz);
+
+  ReleaseFoo.set_value();
+  D.wait();
+
+  std::vector<SymbolStringPtr> Expected({Foo, Baz, Bar});
+  EXPECT_EQ(Order, Expected) << "Speculative bar should run last";
+}
+
+TEST_F(TaskDispatchTest, ExternalExecutorAndTrace) {
+  std::vector<std::pair<MaterializationPriority, unique_function<void()>>>
+      Work;
+  ExternalTaskDispatcher D(
+      [&](MaterializationPriority Priority, unique_function<void()> W) {
+        Work.push_back({Priority, std::move(W)});
+      });
+
+  std::vector<MaterializationPriority> Traced;
+  D.setTraceFunction([&](const MaterializationTask &T,
+                         std::chrono::nanoseconds QueueTime,
+                         std::chrono::nanoseconds RunTime) {
+    EXPECT_EQ(&T.getJITDylib(), &JD) << "Traced task for the wrong dylib";
+    EXPECT_EQ(T.getName(), "<Simple>") << "Traced task has the wrong name";
+    EXPECT_GE(QueueTime.count(), 0) << "Negative queue time";
+    EXPECT_GE(RunTime.count(), 0) << "Negative run time";
+    Traced.push_back(T.getPriority());
+  });
+  useTaskDispatcher(ES, D);
+
+  bool FooReady = false;
+  cantFail(JD.define(createMU(Foo, FooSym)));
+  {
+    MaterializationPriorityScope Speculating(
+        MaterializationPriority::Speculative);
+    lookupAsync(Foo, [&](Expected<SymbolMap> Result) {
+      EXPECT_THAT_EXPECTED(std::move(Result), Succeeded());
+      FooReady = true;
+    });
+  }
+
+  ASSERT_EQ(Work.size(), 1U) << "Expected foo on the executor";
+  EXPECT_EQ(Work[0].first, MaterializationPriority::Speculative);
+  EXPECT_FALSE(FooReady) << "Foo materialized before the executor ran it";
+  Work[0].second();
+  D.wait();
+
+  EXPECT_TRUE(FooReady) << "Foo not materialized by the executor";
+  ASSERT_EQ(Traced.size(), 1U) << "Expected one traced task";
+  EXPECT_EQ(Traced[0], MaterializationPriority::Speculative);
+}
+
+TEST_F(TaskDispatchTest, CancelPendingTasks) {
+  std::vector<unique_function<void()>> Work;
+  ExternalTaskDispatcher D(
+      [&](MaterializationPriority, unique_function<void()> W) {
+        Work.push_back(std::move(W));
+      });
+  useTaskDispatcher(ES, D);
+
+  bool BarMaterialized = false;
+  bool BarFailed = false;
+  cantFail(JD.define(createMU(Bar, BarSym, [&]() { BarMaterialized = true; })));
+  lookupAsync(Bar, [&](Expected<SymbolMap> Result) {
+    EXPECT_THAT_EXPECTED(std::move(Result), Failed());
+    BarFailed = true;
+  });
+
+  EXPECT_EQ(D.cancelPendingTasks(), 1U) << "Expected bar to be cancelled";
+  EXPECT_TRUE(BarFailed) << "Query for cancelled bar did not fail";
+
+  // Work for cancelled tasks does nothing when the executor gets to it.
+  ASSERT_EQ(Work.size(), 1U);
+  Work[0]();
+  D.wait();
+  EXPECT_FALSE(BarMaterialized) << "Cancelled bar was materialized";
+}
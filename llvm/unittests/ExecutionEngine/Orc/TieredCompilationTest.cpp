@@ -0,0 +1,129 @@
+//===----------- TieredCompilationTest.cpp - Unit tests for tiering -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/TieredCompilation.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+/// Stands in for a compile layer: resolves every symbol in the module to
+/// Addr after letting the test inspect the module.
+class FakeCompileLayer : public IRLayer {
+public:
+  FakeCompileLayer(ExecutionSession &ES, JITTargetAddress Addr,
+                   std::function<void(Module &)> OnEmit)
+      : IRLayer(ES), Addr(Addr), OnEmit(std::move(OnEmit)) {}
+
+  void emit(MaterializationResponsibility R, ThreadSafeModule TSM) override {
+    TSM.withModuleDo(OnEmit);
+    SymbolMap Symbols;
+    for (auto &KV : R.getSymbols())
+      Symbols[KV.first] = JITEvaluatedSymbol(Addr, KV.second);
+    cantFail(R.notifyResolved(Symbols));
+    cantFail(R.notifyEmitted());
+  }
+
+private:
+  JITTargetAddress Addr;
+  std::function<void(Module &)> OnEmit;
+};
+
+TEST(TieredCompilationTest, HotFunctionIsRecompiled) {
+  ExecutionSession ES;
+  auto &JD = ES.createJITDylib("main");
+  DataLayout DL("");
+  MangleAndInterner Mangle(ES, DL);
+
+  ThreadSafeContext TSCtx(std::make_unique<LLVMContext>());
+  SMDiagnostic Diag;
+  auto M = parseAssemblyString(R"(
+    define i32 @foo(i32 %x) {
+    entry:
+      %a = alloca i32
+      store i32 %x, i32* %a
+      %v = load i32, i32* %a
+      ret i32 %v
+    }
+
+    define internal void @helper() {
+      ret void
+    })",
+                               Diag, *TSCtx.getContext());
+  ASSERT_TRUE(!!M) << "Could not parse test IR";
+
+  // Check the instrumentation, and find the id that foo reports itself with.
+  TieredCompiler::FunctionId FooId = ~0ULL;
+  FakeCompileLayer Tier0(ES, 0x1000, [&](Module &M) {
+    auto &Entry = M.getFunction("foo")->getEntryBlock();
+    EXPECT_TRUE(isa<AllocaInst>(Entry.front()))
+        << "Static allocas should stay in the entry block";
+    const AtomicRMWInst *Count = nullptr;
+    for (auto &I : Entry)
+      if (auto *RMW = dyn_cast<AtomicRMWInst>(&I))
+        Count = RMW;
+    EXPECT_NE(Count, nullptr) << "foo does not count its calls";
+
+    for (auto &BB : *M.getFunction("foo"))
+      for (auto &I : BB)
+        if (auto *Call = dyn_cast<CallInst>(&I))
+          if (Call->getCalledFunction() &&
+              Call->getCalledFunction()->getName() == "__orc_tier_up")
+            FooId = cast<ConstantInt>(Call->getArgOperand(1))->getZExtValue();
+
+    EXPECT_EQ(M.getFunction("helper")->size(), 1U)
+        << "Local functions should not be instrumented";
+  });
+
+  std::vector<std::string> Optimized;
+  FakeCompileLayer Tier1(ES, 0x2000, [&](Module &M) {
+    EXPECT_EQ(M.getFunction("__orc_tier_up"), nullptr)
+        << "Optimized code should not be instrumented";
+    for (auto &F : M)
+      if (!F.isDeclaration())
+        Optimized.push_back(F.getName());
+  });
+
+  std::vector<std::pair<SymbolStringPtr, JITTargetAddress>> Redirects;
+  TieredCompiler Tiers(
+      ES, Tier1, Mangle,
+      [&](JITDylib &ImplJD, const SymbolStringPtr &Name,
+          JITTargetAddress NewAddr) {
+        EXPECT_EQ(&ImplJD, &JD) << "Redirect for the wrong dylib";
+        Redirects.push_back({Name, NewAddr});
+        return Error::success();
+      });
+  IRTieringLayer Tiering(ES, Tier0, Tiers, 10);
+
+  cantFail(Tiers.addTieringRuntime(JD));
+  cantFail(Tiering.add(JD, ThreadSafeModule(std::move(M), TSCtx)));
+
+  auto Foo = cantFail(ES.lookup({&JD}, Mangle("foo")));
+  EXPECT_EQ(Foo.getAddress(), 0x1000U) << "foo should start at tier 0";
+  ASSERT_NE(FooId, ~0ULL) << "foo does not report itself hot";
+
+  // Only the first report starts a recompile.
+  Tiers.tierUp(FooId);
+  Tiers.tierUp(FooId);
+  Tiers.waitForRecompiles();
+
+  ASSERT_EQ(Optimized.size(), 1U) << "Expected one recompiled function";
+  EXPECT_EQ(Optimized[0], "foo.tier1");
+  ASSERT_EQ(Redirects.size(), 1U) << "Expected foo to be redirected once";
+  EXPECT_EQ(Redirects[0].first, Mangle("foo"));
+  EXPECT_EQ(Redirects[0].second, 0x2000U);
+}
+
+} // end anonymous namespace
@@ -9,13 +9,19 @@
 #include "llvm/IR/Constants.h"
 #include "llvm-c/Core.h"
 #include "llvm/AsmParser/Parser.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/Attributes.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/InstrTypes.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Support/SourceMgr.h"
 #include "gtest/gtest.h"
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace llvm {
 namespace {
@@ -583,5 +589,44 @@ TEST(ConstantsTest, FoldGlobalVariablePtr) {
       Instruction::And, TheConstantExpr, TheConstant)->isNullValue());
 }
 
+#if LLVM_ENABLE_THREADS
+TEST(ConstantsTest, ThreadSafeUniquing) {
+  LLVMContext Context;
+  Context.setThreadSafeUniquing(true);
+
+  // All threads create the same types, constants, attributes and metadata,
+  // and must get the same objects back. None of these objects has uses, so
+  // no use lists are updated.
+  const unsigned NumThreads = 4;
+  std::vector<std::vector<const void *>> Results(NumThreads);
+  std::vector<std::thread> Threads;
+  for (unsigned T = 0; T != NumThreads; ++T) {
+    Threads.emplace_back([&, T] {
+      std::vector<const void *> &R = Results[T];
+      for (unsigned I = 0; I != 200; ++I) {
+        IntegerType *Ty = IntegerType::get(Context, 7 + I);
+        R.push_back(Ty);
+        R.push_back(ConstantInt::get(Ty, I));
+        R.push_back(ConstantFP::get(Context, APFloat(double(I))));
+        R.push_back(ArrayType::get(Ty, I + 1));
+        R.push_back(
+            StructType::get(Context, {Ty, PointerType::getUnqual(Ty)}));
+        R.push_back(
+            Attribute::get(Context, Attribute::Alignment, 1ULL << (I % 16))
+                .getRawPointer());
+        MDString *S = MDString::get(Context, "md" + std::to_string(I));
+        R.push_back(S);
+        R.push_back(MDTuple::get(Context, {S}));
+      }
+    });
+  }
+  for (std::thread &T : Threads)
+    T.join();
+
+  for (unsigned T = 1; T != NumThreads; ++T)
+    EXPECT_EQ(Results[0], Results[T]);
+}
+#endif
+
 }  // end anonymous namespace
 }  // end namespace llvm
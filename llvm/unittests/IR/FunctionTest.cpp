@@ -162,4 +162,35 @@ TEST(FunctionTest, GetPointerAlignment) {
   EXPECT_EQ(4U, Func->getPointerAlignment(DataLayout("Fn32")));
 }
 
+TEST(FunctionTest, CompileTimeBudget) {
+  LLVMContext C;
+  FunctionType *FTy = FunctionType::get(Type::getVoidTy(C), false);
+  std::unique_ptr<Function> F1(
+      Function::Create(FTy, GlobalValue::ExternalLinkage, "F1"));
+  std::unique_ptr<Function> F2(
+      Function::Create(FTy, GlobalValue::ExternalLinkage, "F2"));
+
+  // Budgets are unlimited by default, and no work is recorded.
+  EXPECT_TRUE(C.consumeCompileTimeBudget(*F1, 1000000));
+  EXPECT_EQ(0u, C.getCompileTimeUsed(*F1));
+
+  C.setCompileTimeBudget(/*PerFunction=*/10, /*Total=*/15);
+  EXPECT_TRUE(C.consumeCompileTimeBudget(*F1, 10));
+  EXPECT_FALSE(C.consumeCompileTimeBudget(*F1, 1));
+  EXPECT_FALSE(C.hasCompileTimeBudget(*F1));
+  EXPECT_EQ(11u, C.getCompileTimeUsed(*F1));
+
+  // F2 has a budget of its own, but little of the total budget is left.
+  EXPECT_TRUE(C.hasCompileTimeBudget(*F2));
+  EXPECT_TRUE(C.consumeCompileTimeBudget(*F2, 4));
+  EXPECT_FALSE(C.consumeCompileTimeBudget(*F2, 1));
+
+  // Deleting a function forgets its work, but not the total.
+  const Function *Deleted = F1.get();
+  F1.reset();
+  EXPECT_EQ(0u, C.getCompileTimeUsed(*Deleted));
+  C.setCompileTimeBudget(10, 0);
+  EXPECT_TRUE(C.hasCompileTimeBudget(*F2));
+}
+
 } // end namespace
@@ -11,6 +11,7 @@
 #include "llvm/IR/Function.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/SourceMgr.h"
 #include "gtest/gtest.h"
 
@@ -780,4 +781,63 @@ TEST_F(PassManagerTest, IndirectAnalysisInvalidation) {
   // three functions.
   EXPECT_EQ(3 * 4 * 3, FunctionCount);
 }
+
+// A test function pass that deletes the first instruction of a function with
+// a specific name and reports that it changed every function it saw.
+struct TestEraseFirstInstPass : PassInfoMixin<TestEraseFirstInstPass> {
+  TestEraseFirstInstPass(StringRef FunctionName) : Name(FunctionName) {}
+
+  PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM) {
+    if (F.getName() == Name)
+      F.getEntryBlock().front().eraseFromParent();
+    return PreservedAnalyses::none();
+  }
+
+  StringRef Name;
+};
+
+TEST_F(PassManagerTest, PreserveAnalysesOnUnchangedIR) {
+  auto &Opt = static_cast<cl::opt<bool> &>(
+      *cl::getRegisteredOptions()["preserve-analyses-on-unchanged-ir"]);
+  Opt = true;
+
+  FunctionAnalysisManager FAM(/*DebugLogging*/ true);
+  int FunctionAnalysisRuns = 0;
+  FAM.registerPass([&] { return TestFunctionAnalysis(FunctionAnalysisRuns); });
+
+  ModuleAnalysisManager MAM(/*DebugLogging*/ true);
+  int ModuleAnalysisRuns = 0;
+  MAM.registerPass([&] { return TestModuleAnalysis(ModuleAnalysisRuns); });
+  MAM.registerPass([&] { return FunctionAnalysisManagerModuleProxy(FAM); });
+  FAM.registerPass([&] { return ModuleAnalysisManagerFunctionProxy(MAM); });
+  MAM.registerPass([&] { return PassInstrumentationAnalysis(); });
+  FAM.registerPass([&] { return PassInstrumentationAnalysis(); });
+
+  int FunctionPassRunCount = 0;
+  int AnalyzedInstrCount = 0;
+  int AnalyzedFunctionCount = 0;
+  FunctionPassManager FPM(/*DebugLogging*/ true);
+  FPM.addPass(TestFunctionPass(FunctionPassRunCount, AnalyzedInstrCount,
+                               AnalyzedFunctionCount));
+  // Reports a change for @f without making one.
+  FPM.addPass(TestInvalidationFunctionPass("f"));
+  FPM.addPass(TestFunctionPass(FunctionPassRunCount, AnalyzedInstrCount,
+                               AnalyzedFunctionCount));
+  // Changes @f and reports a change for every function.
+  FPM.addPass(TestEraseFirstInstPass("f"));
+  FPM.addPass(TestFunctionPass(FunctionPassRunCount, AnalyzedInstrCount,
+                               AnalyzedFunctionCount));
+
+  ModulePassManager MPM(/*DebugLogging*/ true);
+  MPM.addPass(createModuleToFunctionPassAdaptor(std::move(FPM)));
+  MPM.run(*M, MAM);
+  Opt = false;
+
+  // Only the actual change to @f invalidates its analysis.
+  EXPECT_EQ(3 * 3, FunctionPassRunCount);
+  EXPECT_EQ(4, FunctionAnalysisRuns);
+  // @f has 3 instructions before the erasure and 2 after it; @g and @h have
+  // one each.
+  EXPECT_EQ(3 + 3 + 2 + 1 * 3 + 1 * 3, AnalyzedInstrCount);
+}
 }
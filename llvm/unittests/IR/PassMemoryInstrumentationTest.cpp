@@ -0,0 +1,90 @@
+//===- unittests/IR/PassMemoryInstrumentationTest.cpp ---------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassInstrumentation.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/Passes/StandardInstrumentations.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+class GrowPass : public PassInfoMixin<GrowPass> {};
+class ShrinkPass : public PassInfoMixin<ShrinkPass> {};
+
+TEST(PassMemoryInstrumentationTest, Report) {
+  PassInstrumentationCallbacks PIC;
+  PassInstrumentation PI(&PIC);
+
+  LLVMContext Context;
+  Module M("TestModule", Context);
+  Type *I32 = Type::getInt32Ty(Context);
+  Function *F =
+      Function::Create(FunctionType::get(Type::getVoidTy(Context), false),
+                       GlobalValue::ExternalLinkage, "f", M);
+  BasicBlock *BB = BasicBlock::Create(Context, "entry", F);
+  Instruction *Ret = ReturnInst::Create(Context, BB);
+
+  SmallString<0> ReportStr;
+  raw_svector_ostream ReportStream(ReportStr);
+  PassMemoryInstrumentation PassMemory;
+  PassMemory.setOutStream(ReportStream);
+  PassMemory.registerCallbacks(PIC);
+
+  // Pretend that GrowPass runs twice on the function and adds two
+  // instructions the first time, and that ShrinkPass runs on the module and
+  // removes one of them.
+  GrowPass Grow;
+  ShrinkPass Shrink;
+  PI.runBeforePass(Grow, *F);
+  Instruction *A = new AllocaInst(I32, 0, "a", Ret);
+  new AllocaInst(I32, 0, "b", Ret);
+  PI.runAfterPass(Grow, *F);
+  PI.runBeforePass(Grow, *F);
+  PI.runAfterPass(Grow, *F);
+  PI.runBeforePass(Shrink, M);
+  A->eraseFromParent();
+  PI.runAfterPass(Shrink, M);
+
+  PassMemory.print();
+
+  Expected<json::Value> Report = json::parse(ReportStr);
+  ASSERT_TRUE(bool(Report)) << toString(Report.takeError());
+  const json::Array *Passes = Report->getAsArray();
+  ASSERT_TRUE(Passes);
+  ASSERT_EQ(2u, Passes->size());
+
+  const json::Object *GrowEntry = (*Passes)[0].getAsObject();
+  ASSERT_TRUE(GrowEntry);
+  EXPECT_TRUE(GrowEntry->getString("pass")->contains("GrowPass"));
+  EXPECT_EQ(2, *GrowEntry->getInteger("runs"));
+  EXPECT_EQ(2, *GrowEntry->getInteger("instructions"));
+  EXPECT_EQ(2, *GrowEntry->getInteger("max-instructions"));
+
+  const json::Object *ShrinkEntry = (*Passes)[1].getAsObject();
+  ASSERT_TRUE(ShrinkEntry);
+  EXPECT_TRUE(ShrinkEntry->getString("pass")->contains("ShrinkPass"));
+  EXPECT_EQ(1, *ShrinkEntry->getInteger("runs"));
+  EXPECT_EQ(-1, *ShrinkEntry->getInteger("instructions"));
+
+  // The report is cleared after printing.
+  ReportStr.clear();
+  PassMemory.print();
+  EXPECT_TRUE(ReportStr.empty());
+}
+
+} // end anonymous namespace
@@ -0,0 +1,144 @@
+//===- ELFObjectFileTest.cpp - Tests for ELFObjectFile --------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Object/ELFObjectFile.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gtest/gtest.h"
+
+#include <cstring>
+
+using namespace llvm;
+using namespace llvm::object;
+
+namespace {
+
+// A relocatable object with a .text section and these symbols:
+//   [1] foo    local,  defined at 0
+//   [2] .text  local,  the section symbol
+//   [3] foo    global, defined at 8
+//   [4] bar    global, undefined
+class ELFObjectFileTest : public ::testing::Test {
+protected:
+  using Ehdr = ELF64LE::Ehdr;
+  using Shdr = ELF64LE::Shdr;
+  using Sym = ELF64LE::Sym;
+
+  void SetUp() override {
+    const char StrTab[] = "\0foo\0bar";
+    const char ShStrTab[] = "\0.text\0.strtab\0.symtab\0.shstrtab";
+    const size_t TextOffset = sizeof(Ehdr);
+    const size_t StrTabOffset = TextOffset + 16;
+    const size_t SymTabOffset = alignTo(StrTabOffset + sizeof(StrTab), 8);
+    const size_t ShStrTabOffset = SymTabOffset + 5 * sizeof(Sym);
+    const size_t ShOffset = alignTo(ShStrTabOffset + sizeof(ShStrTab), 8);
+    Storage.assign((ShOffset + 5 * sizeof(Shdr)) / 8, 0);
+    uint8_t *Base = reinterpret_cast<uint8_t *>(Storage.data());
+
+    Ehdr &Header = *reinterpret_cast<Ehdr *>(Base);
+    memcpy(Header.e_ident, ELF::ElfMagic, strlen(ELF::ElfMagic));
+    Header.e_ident[ELF::EI_CLASS] = ELF::ELFCLASS64;
+    Header.e_ident[ELF::EI_DATA] = ELF::ELFDATA2LSB;
+    Header.e_ident[ELF::EI_VERSION] = ELF::EV_CURRENT;
+    Header.e_type = ELF::ET_REL;
+    Header.e_machine = ELF::EM_X86_64;
+    Header.e_version = ELF::EV_CURRENT;
+    Header.e_shoff = ShOffset;
+    Header.e_ehsize = sizeof(Ehdr);
+    Header.e_shentsize = sizeof(Shdr);
+    Header.e_shnum = 5;
+    Header.e_shstrndx = 4;
+
+    memcpy(Base + StrTabOffset, StrTab, sizeof(StrTab));
+    memcpy(Base + ShStrTabOffset, ShStrTab, sizeof(ShStrTab));
+
+    Sym *Symbols = reinterpret_cast<Sym *>(Base + SymTabOffset);
+    Symbols[1].st_name = 1;
+    Symbols[1].setBindingAndType(ELF::STB_LOCAL, ELF::STT_FUNC);
+    Symbols[1].st_shndx = 1;
+    Symbols[2].setBindingAndType(ELF::STB_LOCAL, ELF::STT_SECTION);
+    Symbols[2].st_shndx = 1;
+    Symbols[3].st_name = 1;
+    Symbols[3].setBindingAndType(ELF::STB_GLOBAL, ELF::STT_FUNC);
+    Symbols[3].st_shndx = 1;
+    Symbols[3].st_value = 8;
+    Symbols[4].st_name = 5;
+    Symbols[4].setBindingAndType(ELF::STB_GLOBAL, ELF::STT_NOTYPE);
+
+    Shdr *Sections = reinterpret_cast<Shdr *>(Base + ShOffset);
+    Sections[1].sh_name = 1;
+    Sections[1].sh_type = ELF::SHT_PROGBITS;
+    Sections[1].sh_flags = ELF::SHF_ALLOC | ELF::SHF_EXECINSTR;
+    Sections[1].sh_offset = TextOffset;
+    Sections[1].sh_size = 16;
+    Sections[2].sh_name = 7;
+    Sections[2].sh_type = ELF::SHT_STRTAB;
+    Sections[2].sh_offset = StrTabOffset;
+    Sections[2].sh_size = sizeof(StrTab);
+    Sections[3].sh_name = 15;
+    Sections[3].sh_type = ELF::SHT_SYMTAB;
+    Sections[3].sh_offset = SymTabOffset;
+    Sections[3].sh_size = 5 * sizeof(Sym);
+    Sections[3].sh_entsize = sizeof(Sym);
+    Sections[3].sh_link = 2;
+    Sections[3].sh_info = 3;
+    Sections[4].sh_name = 23;
+    Sections[4].sh_type = ELF::SHT_STRTAB;
+    Sections[4].sh_offset = ShStrTabOffset;
+    Sections[4].sh_size = sizeof(ShStrTab);
+  }
+
+  MemoryBufferRef getBuffer() const {
+    return MemoryBufferRef(
+        StringRef(reinterpret_cast<const char *>(Storage.data()),
+                  Storage.size() * 8),
+        "test.o");
+  }
+
+  // Keeps the image aligned for the headers.
+  std::vector<uint64_t> Storage;
+};
+
+TEST_F(ELFObjectFileTest, SymbolNames) {
+  Expected<ELF64LEObjectFile> Obj = ELF64LEObjectFile::create(getBuffer());
+  ASSERT_THAT_EXPECTED(Obj, Succeeded());
+  std::vector<std::string> Names;
+  for (const SymbolRef &Symbol : Obj->symbols()) {
+    Expected<StringRef> Name = Symbol.getName();
+    ASSERT_THAT_EXPECTED(Name, Succeeded());
+    Names.push_back(Name->str());
+  }
+  EXPECT_EQ(Names, (std::vector<std::string>{"foo", ".text", "foo", "bar"}));
+}
+
+TEST_F(ELFObjectFileTest, FindSymbol) {
+  Expected<ELF64LEObjectFile> Obj = ELF64LEObjectFile::create(getBuffer());
+  ASSERT_THAT_EXPECTED(Obj, Succeeded());
+
+  // The global definition wins over the local one.
+  Expected<Optional<ELFSymbolRef>> Foo = Obj->findSymbol("foo");
+  ASSERT_THAT_EXPECTED(Foo, Succeeded());
+  ASSERT_TRUE(Foo->hasValue());
+  EXPECT_EQ((*Foo)->getBinding(), ELF::STB_GLOBAL);
+  EXPECT_EQ((*Foo)->getValue(), 8u);
+
+  Expected<Optional<ELFSymbolRef>> Bar = Obj->findSymbol("bar");
+  ASSERT_THAT_EXPECTED(Bar, Succeeded());
+  ASSERT_TRUE(Bar->hasValue());
+  Expected<uint32_t> Flags = (*Bar)->getFlags();
+  ASSERT_THAT_EXPECTED(Flags, Succeeded());
+  EXPECT_TRUE(*Flags & SymbolRef::SF_Undefined);
+
+  // Section symbols are not indexed.
+  for (StringRef Name : {"baz", ".text", ""}) {
+    Expected<Optional<ELFSymbolRef>> Missing = Obj->findSymbol(Name);
+    ASSERT_THAT_EXPECTED(Missing, Succeeded());
+    EXPECT_FALSE(Missing->hasValue()) << Name;
+  }
+}
+
+} // namespace
@@ -179,6 +179,23 @@ TEST(Option, DoNotIgnoreCase) {
   EXPECT_FALSE(AL.hasArg(OPT_B));
 }
 
+TEST(Option, OptionNamePrefixes) {
+  TestOptTable T;
+  unsigned MAI, MAC;
+
+  // Each argument starts with the names of several options.
+  const char *MyArgs[] = {"-Blorp", "-blorp", "--blurmp=", "--blurmp",
+                          "/cramb:x"};
+  InputArgList AL = T.ParseArgs(MyArgs, MAI, MAC);
+  ASSERT_EQ(5u, AL.size());
+  EXPECT_TRUE(AL.getArgs()[0]->getOption().matches(OPT_B));
+  EXPECT_EQ("lorp", AL.getLastArgValue(OPT_B));
+  EXPECT_TRUE(AL.getArgs()[1]->getOption().matches(OPT_Blorp));
+  EXPECT_TRUE(AL.getArgs()[2]->getOption().matches(OPT_Blurmpq_eq));
+  EXPECT_TRUE(AL.getArgs()[3]->getOption().matches(OPT_Blurmpq));
+  EXPECT_EQ("x", AL.getLastArgValue(OPT_Cramb));
+}
+
 TEST(Option, SlurpEmpty) {
   TestOptTable T;
   unsigned MAI, MAC;
@@ -285,6 +285,39 @@ struct SampleProfTest : ::testing::Test {
       ASSERT_EQ(I->getValue(), Esamples);
     }
   }
+
+  void testFuncsToUse(SampleProfileFormat Format) {
+    SmallVector<char, 128> ProfilePath;
+    std::error_code EC;
+    EC = llvm::sys::fs::createTemporaryFile("profile", "", ProfilePath);
+    ASSERT_TRUE(NoError(EC));
+    StringRef ProfileFile(ProfilePath.data(), ProfilePath.size());
+
+    StringMap<FunctionSamples> ProfMap;
+    addFunctionSamples(&ProfMap, "foo", uint64_t(20301), uint64_t(1437));
+    addFunctionSamples(&ProfMap, "bar", uint64_t(20303), uint64_t(1439));
+    addFunctionSamples(&ProfMap, "baz", uint64_t(20305), uint64_t(1441));
+
+    createWriter(Format, ProfileFile);
+    EC = Writer->write(ProfMap);
+    ASSERT_TRUE(NoError(EC));
+    Writer->getOutputStream().flush();
+
+    // Only the profiles of the functions in the module are read.
+    Module M("my_module", Context);
+    FunctionType *FnType =
+        FunctionType::get(Type::getVoidTy(Context), {}, false);
+    M.getOrInsertFunction("bar", FnType);
+    readProfile(M, ProfileFile);
+    EC = Reader->read();
+    ASSERT_TRUE(NoError(EC));
+
+    ASSERT_EQ(1u, Reader->getProfiles().size());
+    FunctionSamples *Samples = Reader->getSamplesFor("bar");
+    ASSERT_TRUE(Samples != nullptr);
+    ASSERT_EQ(20303u, Samples->getTotalSamples());
+    ASSERT_EQ(1439u, Samples->getHeadSamples());
+  }
 };
 
 TEST_F(SampleProfTest, roundtrip_text_profile) {
@@ -303,6 +336,14 @@ TEST_F(SampleProfTest, roundtrip_ext_binary_profile) {
   testRoundTrip(SampleProfileFormat::SPF_Ext_Binary, false);
 }
 
+TEST_F(SampleProfTest, funcs_to_use_compact_binary_profile) {
+  testFuncsToUse(SampleProfileFormat::SPF_Compact_Binary);
+}
+
+TEST_F(SampleProfTest, funcs_to_use_ext_binary_profile) {
+  testFuncsToUse(SampleProfileFormat::SPF_Ext_Binary);
+}
+
 TEST_F(SampleProfTest, remap_text_profile) {
   testRoundTrip(SampleProfileFormat::SPF_Text, true);
 }
@@ -7,8 +7,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Allocator.h"
+#include "llvm/Config/llvm-config.h"
 #include "gtest/gtest.h"
 #include <cstdlib>
+#include <thread>
+#include <vector>
 
 using namespace llvm;
 
@@ -184,4 +187,59 @@ TEST(AllocatorTest, TestBigAlignment) {
   EXPECT_GT(MockSlabAllocator::GetLastSlabSize(), 4096u);
 }
 
+TEST(AllocatorTest, ThreadLocalBasics) {
+  ThreadLocalBumpPtrAllocator Alloc;
+  int *a = Alloc.Allocate<int>();
+  int *b = Alloc.Allocate<int>(10);
+  *a = 1;
+  b[9] = 2;
+  EXPECT_EQ(1, *a);
+  EXPECT_EQ(2, b[9]);
+  EXPECT_EQ(&Alloc.getThreadAllocator(), &Alloc.getThreadAllocator());
+  EXPECT_EQ(11 * sizeof(int), Alloc.getBytesAllocated());
+
+  Alloc.Reset();
+  EXPECT_EQ(0U, Alloc.getBytesAllocated());
+}
+
+#if LLVM_ENABLE_THREADS
+TEST(AllocatorTest, ThreadLocalConcurrent) {
+  ThreadLocalBumpPtrAllocator Alloc;
+  const unsigned NumThreads = 8;
+  const unsigned NumAllocs = 1000;
+  std::vector<std::vector<unsigned *>> Ptrs(NumThreads);
+  std::vector<std::thread> Threads;
+  for (unsigned I = 0; I < NumThreads; ++I)
+    Threads.emplace_back([&, I] {
+      for (unsigned J = 0; J < NumAllocs; ++J) {
+        unsigned *P = Alloc.Allocate<unsigned>();
+        *P = I * NumAllocs + J;
+        Ptrs[I].push_back(P);
+      }
+    });
+  for (std::thread &T : Threads)
+    T.join();
+
+  for (unsigned I = 0; I < NumThreads; ++I)
+    for (unsigned J = 0; J < NumAllocs; ++J)
+      EXPECT_EQ(I * NumAllocs + J, *Ptrs[I][J]);
+  EXPECT_EQ(NumThreads * NumAllocs * sizeof(unsigned),
+            Alloc.getBytesAllocated());
+}
+#endif
+
+TEST(AllocatorTest, ThreadLocalSpecific) {
+  struct Counted {
+    int *Count;
+    ~Counted() { ++*Count; }
+  };
+  int Count = 0;
+  {
+    ThreadLocalAllocator<SpecificBumpPtrAllocator<Counted>> Alloc;
+    for (int I = 0; I < 3; ++I)
+      new (Alloc.getThreadAllocator().Allocate()) Counted{&Count};
+  }
+  EXPECT_EQ(3, Count);
+}
+
 }  // anonymous namespace
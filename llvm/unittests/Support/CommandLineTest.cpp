@@ -545,6 +545,32 @@ TEST(CommandLineTest, ReparseCommandLineOptions) {
   EXPECT_TRUE(TopLevelOpt);
 }
 
+TEST(CommandLineTest, LazyRegistration) {
+  cl::ResetCommandLineParser();
+
+  StackOption<bool> First("lazy-first", cl::init(false));
+  {
+    // An option that is destroyed before the option tables are built must
+    // never show up in them.
+    StackOption<bool> Temp("lazy-temp", cl::init(false));
+  }
+  StackOption<bool> Second("lazy-second", cl::init(false));
+
+  StringMap<cl::Option *> &Map =
+      cl::getRegisteredOptions(*cl::TopLevelSubCommand);
+  EXPECT_EQ(1u, Map.count("lazy-first"));
+  EXPECT_EQ(1u, Map.count("lazy-second"));
+  EXPECT_EQ(0u, Map.count("lazy-temp"));
+
+  // Options constructed after the tables are built are still found.
+  StackOption<bool> Third("lazy-third", cl::init(false));
+  const char *args[] = {"prog", "-lazy-third"};
+  EXPECT_TRUE(
+      cl::ParseCommandLineOptions(2, args, StringRef(), &llvm::nulls()));
+  EXPECT_FALSE(First);
+  EXPECT_TRUE(Third);
+}
+
 TEST(CommandLineTest, RemoveFromRegularSubCommand) {
   cl::ResetCommandLineParser();
 
@@ -319,6 +319,40 @@ TEST_F(MemoryBufferTest, slice) {
   EXPECT_TRUE(BufData2.substr(0x2FF8,8).equals("abcdefgh"));
 }
 
+TEST_F(MemoryBufferTest, advise) {
+  int FD;
+  SmallString<64> TestPath;
+  sys::fs::createTemporaryFile("MemoryBufferTest_Advise", "temp", FD,
+                               TestPath);
+  FileRemover Cleanup(TestPath);
+  raw_fd_ostream OF(FD, true, /*unbuffered=*/true);
+  for (unsigned i = 0; i < 0x10000 / 8; ++i)
+    OF << "12345678";
+  OF.close();
+
+  // Use a non-page-aligned slice so that the buffer doesn't start at the
+  // beginning of the mapping.
+  ErrorOr<OwningBuffer> MB =
+      MemoryBuffer::getFileSlice(TestPath.str(), 0x8000, 0x1008);
+  ASSERT_FALSE(MB.getError());
+  const MemoryBuffer &Buf = **MB;
+  Buf.advise(MemoryBuffer::Advice::Sequential);
+  Buf.advise(MemoryBuffer::Advice::Random, 0x100, 0x2000);
+  Buf.advise(MemoryBuffer::Advice::HugePage);
+  Buf.prefetch(0x1000, 0x4000);
+  // Out-of-range requests are clipped.
+  Buf.prefetch(0x7000, 0x4000);
+  Buf.prefetch(0x10000, 1);
+  Buf.advise(MemoryBuffer::Advice::Normal);
+  EXPECT_EQ(0x8000UL, Buf.getBufferSize());
+  EXPECT_EQ("12345678", Buf.getBuffer().substr(0x7FF8, 8));
+
+  // Buffers that are not memory-mapped ignore the hints.
+  OwningBuffer MemBuf = MemoryBuffer::getMemBuffer(data);
+  MemBuf->prefetch(0, MemBuf->getBufferSize());
+  EXPECT_EQ(data, MemBuf->getBuffer());
+}
+
 TEST_F(MemoryBufferTest, writableSlice) {
   // Create a file initialized with some data
   int FD;
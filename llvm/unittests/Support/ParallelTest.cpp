@@ -14,7 +14,9 @@
 #include "llvm/Support/Parallel.h"
 #include "gtest/gtest.h"
 #include <array>
+#include <atomic>
 #include <random>
+#include <vector>
 
 uint32_t array[1024 * 1024];
 
@@ -49,4 +51,31 @@ TEST(Parallel, parallel_for) {
   ASSERT_EQ(range[2049], 1u);
 }
 
+TEST(Parallel, nested_parallel_for) {
+  // Nested parallel loops must neither deadlock nor skip any iteration.
+  std::atomic<uint32_t> count(0);
+  for_each_n(parallel::par, 0, 64, [&](size_t I) {
+    for_each_n(parallel::par, 0, 2048, [&](size_t J) { ++count; });
+  });
+  ASSERT_EQ(count, 64u * 2048u);
+}
+
+TEST(Parallel, nested_sort) {
+  std::vector<std::vector<uint32_t>> vecs(16);
+  std::mt19937 randEngine;
+  std::uniform_int_distribution<uint32_t> dist;
+  for (std::vector<uint32_t> &v : vecs) {
+    v.resize(16 * 1024);
+    for (uint32_t &i : v)
+      i = dist(randEngine);
+  }
+
+  for_each(parallel::par, vecs.begin(), vecs.end(),
+           [](std::vector<uint32_t> &v) {
+             sort(parallel::par, v.begin(), v.end());
+           });
+  for (std::vector<uint32_t> &v : vecs)
+    ASSERT_TRUE(std::is_sorted(v.begin(), v.end()));
+}
+
 #endif
@@ -8,6 +8,7 @@
 
 #include "llvm/Support/Process.h"
 #include "gtest/gtest.h"
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -25,6 +26,16 @@ TEST(ProcessTest, GetRandomNumberTest) {
   EXPECT_NE((r1 | r2), 0u);
 }
 
+TEST(ProcessTest, GetPeakMemoryUsage) {
+  // The peak usage is at least the memory in use.
+  std::vector<char> Memory(16 << 20, 1);
+  size_t Peak = Process::GetPeakMemoryUsage();
+#if defined(LLVM_ON_UNIX) || defined(_WIN32)
+  EXPECT_GE(Peak, Memory.size());
+#endif
+  EXPECT_LE(Peak, Process::GetPeakMemoryUsage());
+}
+
 #ifdef _MSC_VER
 #define setenv(name, var, ignore) _putenv_s(name, var)
 #endif
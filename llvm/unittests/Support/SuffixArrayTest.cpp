@@ -0,0 +1,124 @@
+//===- unittests/Support/SuffixArrayTest.cpp - suffix array tests ---------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/SuffixArray.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <map>
+#include <random>
+
+using namespace llvm;
+
+namespace {
+
+// For each position, the longest prefix of its suffix that occurs elsewhere
+// in Str, grouped by that prefix: the leaf children of each internal node of
+// the suffix tree of Str, when the last character of Str is unique.
+std::vector<RepeatedSubstring>
+findRepeatedSubstringsNaive(const std::vector<unsigned> &Str,
+                            unsigned MinLength) {
+  unsigned N = Str.size();
+  std::map<std::vector<unsigned>, std::vector<unsigned>> Groups;
+  for (unsigned I = 0; I != N; ++I) {
+    unsigned Longest = 0;
+    for (unsigned J = 0; J != N; ++J) {
+      if (J == I)
+        continue;
+      unsigned L = 0;
+      while (I + L < N && J + L < N && Str[I + L] == Str[J + L])
+        ++L;
+      Longest = std::max(Longest, L);
+    }
+    if (Longest >= MinLength)
+      Groups[std::vector<unsigned>(Str.begin() + I,
+                                   Str.begin() + I + Longest)]
+          .push_back(I);
+  }
+  std::vector<RepeatedSubstring> Result;
+  for (auto &G : Groups)
+    if (G.second.size() >= 2)
+      Result.push_back({unsigned(G.first.size()), G.second});
+  return Result;
+}
+
+// Repeated substrings sorted by their first occurrence, and the length of
+// each followed by its occurrences.
+std::vector<std::vector<unsigned>>
+flatten(const std::vector<RepeatedSubstring> &RS) {
+  std::vector<std::vector<unsigned>> Result;
+  for (const RepeatedSubstring &R : RS) {
+    Result.push_back({R.Length});
+    Result.back().insert(Result.back().end(), R.StartIndices.begin(),
+                         R.StartIndices.end());
+  }
+  std::sort(Result.begin(), Result.end(),
+            [](const std::vector<unsigned> &A, const std::vector<unsigned> &B) {
+              return A[1] < B[1];
+            });
+  return Result;
+}
+
+TEST(SuffixArrayTest, Empty) {
+  std::vector<unsigned> Str;
+  SuffixArray SA(Str);
+  EXPECT_TRUE(SA.getSuffixes().empty());
+  EXPECT_TRUE(SA.findRepeatedSubstrings(1).empty());
+}
+
+TEST(SuffixArrayTest, Banana) {
+  // "banana$"
+  std::vector<unsigned> Str = {2, 1, 3, 1, 3, 1, 0};
+  SuffixArray SA(Str);
+  EXPECT_EQ(std::vector<unsigned>({6, 5, 3, 1, 0, 4, 2}),
+            std::vector<unsigned>(SA.getSuffixes().begin(),
+                                  SA.getSuffixes().end()));
+  EXPECT_EQ(std::vector<unsigned>({0, 0, 1, 3, 0, 0, 2}),
+            std::vector<unsigned>(SA.getLCP().begin(), SA.getLCP().end()));
+
+  // "ana" at 1 and 3, "na" at 2 and 4. "a" at 5 is a leaf of "a", which has
+  // only one leaf child.
+  std::vector<std::vector<unsigned>> RS =
+      flatten(SA.findRepeatedSubstrings(1));
+  ASSERT_EQ(2u, RS.size());
+  EXPECT_EQ(std::vector<unsigned>({3, 1, 3}), RS[0]);
+  EXPECT_EQ(std::vector<unsigned>({2, 2, 4}), RS[1]);
+
+  EXPECT_EQ(1u, SA.findRepeatedSubstrings(3).size());
+}
+
+// Compares the suffix array and the repeated substrings with naive versions
+// on random strings over small alphabets, terminated by a unique character as
+// in the machine outliner.
+TEST(SuffixArrayTest, RandomStrings) {
+  std::mt19937 Rng(0);
+  for (unsigned Iter = 0; Iter != 200; ++Iter) {
+    unsigned Alphabet = 1 + Rng() % 4;
+    std::vector<unsigned> Str(Rng() % 60);
+    for (unsigned &C : Str)
+      C = Rng() % Alphabet;
+    Str.push_back(~0U);
+
+    SuffixArray SA(Str);
+    std::vector<unsigned> Expected(Str.size());
+    for (unsigned I = 0; I != Str.size(); ++I)
+      Expected[I] = I;
+    std::sort(Expected.begin(), Expected.end(), [&](unsigned A, unsigned B) {
+      return std::lexicographical_compare(Str.begin() + A, Str.end(),
+                                          Str.begin() + B, Str.end());
+    });
+    ASSERT_EQ(Expected, std::vector<unsigned>(SA.getSuffixes().begin(),
+                                              SA.getSuffixes().end()));
+
+    for (unsigned MinLength : {1, 2, 4}) {
+      EXPECT_EQ(flatten(findRepeatedSubstringsNaive(Str, MinLength)),
+                flatten(SA.findRepeatedSubstrings(MinLength)));
+    }
+  }
+}
+
+} // end anonymous namespace
@@ -21,4 +21,37 @@ TEST(Threading, PhysicalConcurrency) {
   ASSERT_LE(Num, thread::hardware_concurrency());
 }
 
+TEST(Threading, ThreadPoolStrategy) {
+  EXPECT_EQ(4U, hardware_concurrency_strategy(4).compute_thread_count());
+  EXPECT_LE(heavyweight_hardware_concurrency_strategy().compute_thread_count(),
+            hardware_concurrency_strategy().compute_thread_count());
+  EXPECT_GE(heavyweight_hardware_concurrency_strategy().compute_thread_count(),
+            1U);
+}
+
+TEST(Threading, GetThreadPoolStrategy) {
+  Optional<ThreadPoolStrategy> S = get_threadpool_strategy("8");
+  ASSERT_TRUE(S.hasValue());
+  EXPECT_EQ(8U, S->ThreadsRequested);
+  EXPECT_FALSE(S->PinToSockets);
+
+  S = get_threadpool_strategy("physical,pin");
+  ASSERT_TRUE(S.hasValue());
+  EXPECT_EQ(0U, S->ThreadsRequested);
+  EXPECT_FALSE(S->UseHyperThreads);
+  EXPECT_TRUE(S->PinToSockets);
+
+  S = get_threadpool_strategy("all");
+  ASSERT_TRUE(S.hasValue());
+  EXPECT_TRUE(S->UseHyperThreads);
+
+  S = get_threadpool_strategy("", heavyweight_hardware_concurrency_strategy());
+  ASSERT_TRUE(S.hasValue());
+  EXPECT_FALSE(S->UseHyperThreads);
+
+  EXPECT_FALSE(get_threadpool_strategy("0").hasValue());
+  EXPECT_FALSE(get_threadpool_strategy("x").hasValue());
+  EXPECT_FALSE(get_threadpool_strategy("4,x").hasValue());
+}
+
 } // end anon namespace
@@ -0,0 +1,108 @@
+//===- unittests/TimeProfilerTest.cpp - TimeProfiler tests ----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/JSON.h"
+#include "gtest/gtest.h"
+#include <thread>
+
+using namespace llvm;
+
+namespace {
+
+// Runs the profiler, calls Fn and returns the parsed trace events.
+template <typename Fn>
+json::Array getTraceEvents(Fn F, unsigned MaxEntriesPerThread = 0) {
+  timeTraceProfilerInitialize(/*TimeTraceGranularity=*/0, "test",
+                              MaxEntriesPerThread);
+  F();
+  SmallString<256> Buf;
+  raw_svector_ostream OS(Buf);
+  timeTraceProfilerWrite(OS);
+  timeTraceProfilerCleanup();
+
+  Expected<json::Value> V = json::parse(Buf);
+  EXPECT_TRUE(bool(V));
+  if (!V)
+    return {};
+  return *V->getAsObject()->getArray("traceEvents");
+}
+
+int countEvents(const json::Array &Events, StringRef Name, StringRef Ph) {
+  int N = 0;
+  for (const json::Value &E : Events) {
+    const json::Object *O = E.getAsObject();
+    if (O->getString("name") == Name && O->getString("ph") == Ph)
+      ++N;
+  }
+  return N;
+}
+
+TEST(TimeProfiler, Basic) {
+  json::Array Events = getTraceEvents([] {
+    TimeTraceScope Outer("Outer");
+    { TimeTraceScope Inner("Inner", StringRef("detail")); }
+    timeTraceProfilerCounter("Memory", 42);
+  });
+
+  EXPECT_EQ(1, countEvents(Events, "Outer", "X"));
+  EXPECT_EQ(1, countEvents(Events, "Inner", "X"));
+  EXPECT_EQ(1, countEvents(Events, "Total Outer", "X"));
+  EXPECT_EQ(1, countEvents(Events, "Memory", "C"));
+  EXPECT_EQ(1, countEvents(Events, "process_name", "M"));
+}
+
+TEST(TimeProfiler, RingBuffer) {
+  json::Array Events = getTraceEvents(
+      [] {
+        for (int I = 0; I != 10; ++I)
+          TimeTraceScope S("Old");
+        for (int I = 0; I != 3; ++I)
+          TimeTraceScope S("New", StringRef(std::to_string(I)));
+      },
+      /*MaxEntriesPerThread=*/3);
+
+  // Only the last sections are kept, in order, but the totals count them all.
+  EXPECT_EQ(0, countEvents(Events, "Old", "X"));
+  EXPECT_EQ(3, countEvents(Events, "New", "X"));
+  std::string Details;
+  for (const json::Value &E : Events) {
+    const json::Object *O = E.getAsObject();
+    if (O->getString("name") == StringRef("New"))
+      Details += O->getObject("args")->getString("detail")->str();
+    if (O->getString("name") == StringRef("Total Old"))
+      EXPECT_EQ(10, *O->getObject("args")->getInteger("count"));
+  }
+  EXPECT_EQ("012", Details);
+}
+
+#if LLVM_ENABLE_THREADS
+TEST(TimeProfiler, MultipleThreads) {
+  json::Array Events = getTraceEvents([] {
+    TimeTraceScope Main("Main");
+    std::thread T1([] { TimeTraceScope S("Work"); });
+    std::thread T2([] { TimeTraceScope S("Work"); });
+    T1.join();
+    T2.join();
+  });
+
+  // Each thread gets its own track.
+  EXPECT_EQ(2, countEvents(Events, "Work", "X"));
+  EXPECT_EQ(2, countEvents(Events, "thread_name", "M"));
+  EXPECT_EQ(1, countEvents(Events, "Total Work", "X"));
+  for (const json::Value &E : Events) {
+    const json::Object *O = E.getAsObject();
+    if (O->getString("name") == StringRef("Work"))
+      EXPECT_NE(0, *O->getInteger("tid"));
+  }
+}
+#endif
+
+} // end anonymous namespace
@@ -459,6 +459,105 @@ struct ScopedFile {
 };
 } // end anonymous namespace
 
+namespace {
+// Counts the calls that reach the underlying file system.
+class CountingFileSystem : public vfs::ProxyFileSystem {
+public:
+  explicit CountingFileSystem(IntrusiveRefCntPtr<vfs::FileSystem> FS)
+      : ProxyFileSystem(std::move(FS)) {}
+
+  ErrorOr<vfs::Status> status(const Twine &Path) override {
+    ++NumStatus;
+    return ProxyFileSystem::status(Path);
+  }
+  ErrorOr<std::unique_ptr<vfs::File>>
+  openFileForRead(const Twine &Path) override {
+    ++NumOpen;
+    return ProxyFileSystem::openFileForRead(Path);
+  }
+  vfs::directory_iterator dir_begin(const Twine &Dir,
+                                    std::error_code &EC) override {
+    ++NumDirBegin;
+    return ProxyFileSystem::dir_begin(Dir, EC);
+  }
+
+  int NumStatus = 0;
+  int NumOpen = 0;
+  int NumDirBegin = 0;
+};
+} // namespace
+
+TEST(VirtualFileSystemTest, CachingStatus) {
+  IntrusiveRefCntPtr<DummyFileSystem> D(new DummyFileSystem());
+  D->addRegularFile("/foo");
+  IntrusiveRefCntPtr<CountingFileSystem> C(new CountingFileSystem(D));
+  vfs::CachingFileSystem FS(C);
+
+  ErrorOr<vfs::Status> S = FS.status("/foo");
+  ASSERT_FALSE(S.getError());
+  EXPECT_TRUE(S->isRegularFile());
+  S = FS.status("/./foo");
+  ASSERT_FALSE(S.getError());
+  EXPECT_EQ("/./foo", S->getName());
+  EXPECT_EQ(1, C->NumStatus);
+
+  // Missing files are cached too, for both status and open.
+  EXPECT_EQ(errc::no_such_file_or_directory, FS.status("/bar").getError());
+  EXPECT_EQ(errc::no_such_file_or_directory, FS.status("/bar").getError());
+  EXPECT_EQ(errc::no_such_file_or_directory,
+            FS.openFileForRead("/bar").getError());
+  EXPECT_EQ(2, C->NumStatus);
+  EXPECT_EQ(0, C->NumOpen);
+
+  EXPECT_EQ(errc::no_such_file_or_directory,
+            FS.openFileForRead("/baz").getError());
+  EXPECT_EQ(errc::no_such_file_or_directory, FS.status("/baz").getError());
+  EXPECT_EQ(1, C->NumOpen);
+  EXPECT_EQ(2, C->NumStatus);
+
+  D->addRegularFile("/bar");
+  EXPECT_TRUE(FS.status("/bar").getError());
+  FS.invalidate("/bar");
+  EXPECT_FALSE(FS.status("/bar").getError());
+  EXPECT_EQ(3, C->NumStatus);
+}
+
+TEST(VirtualFileSystemTest, CachingDirListing) {
+  IntrusiveRefCntPtr<DummyFileSystem> D(new DummyFileSystem());
+  D->addDirectory("/dir");
+  D->addRegularFile("/dir/a");
+  D->addDirectory("/dir/b");
+  IntrusiveRefCntPtr<CountingFileSystem> C(new CountingFileSystem(D));
+  vfs::CachingFileSystem FS(C);
+
+  auto List = [&](StringRef Dir) {
+    std::vector<std::string> Names;
+    std::error_code EC;
+    for (vfs::directory_iterator I = FS.dir_begin(Dir, EC), E;
+         !EC && I != E; I.increment(EC))
+      Names.push_back(I->path());
+    EXPECT_FALSE(EC);
+    return Names;
+  };
+
+  std::vector<std::string> Expected = {"/dir/a", "/dir/b"};
+  EXPECT_EQ(Expected, List("/dir"));
+  EXPECT_EQ(Expected, List("/dir"));
+  EXPECT_EQ(1, C->NumDirBegin);
+
+  // A change in the directory is seen after invalidation of the new file.
+  D->addRegularFile("/dir/c");
+  EXPECT_EQ(Expected, List("/dir"));
+  FS.invalidate("/dir/c");
+  Expected.push_back("/dir/c");
+  EXPECT_EQ(Expected, List("/dir"));
+  EXPECT_EQ(2, C->NumDirBegin);
+
+  FS.invalidateAll();
+  EXPECT_EQ(Expected, List("/dir"));
+  EXPECT_EQ(3, C->NumDirBegin);
+}
+
 TEST(VirtualFileSystemTest, BasicRealFSIteration) {
   ScopedDir TestDirectory("virtual-file-system-test", /*Unique*/ true);
   IntrusiveRefCntPtr<vfs::FileSystem> FS = vfs::getRealFileSystem();
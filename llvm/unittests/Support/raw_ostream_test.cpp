@@ -8,7 +8,10 @@
 
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
@@ -342,4 +345,72 @@ TEST(raw_fd_ostreamTest, multiple_raw_fd_ostream_to_stdout) {
   { raw_fd_ostream("-", EC, sys::fs::OpenFlags::OF_None); }
   { raw_fd_ostream("-", EC, sys::fs::OpenFlags::OF_None); }
 }
+
+TEST(raw_fd_ostreamTest, write_behind) {
+  SmallString<64> Path;
+  int FD;
+  ASSERT_FALSE(sys::fs::createTemporaryFile("raw_fd_ostream_test", "tmp", FD,
+                                            Path));
+  std::string Expected;
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    // Use small buffers so that the writer has to recycle them.
+    OS.enableWriteBehind(/*NumBuffers=*/2, /*BufferSize=*/16);
+    for (int I = 0; I < 1000; ++I) {
+      std::string Line = "line " + std::to_string(I) + "\n";
+      OS << Line;
+      Expected += Line;
+    }
+    EXPECT_EQ(Expected.size(), OS.tell());
+
+    // seek() waits for pending writes.
+    OS.seek(0);
+    OS << "LINE";
+    Expected.replace(0, 4, "LINE");
+    OS.waitForWrites();
+    EXPECT_FALSE(OS.has_error());
+  }
+
+  auto Buf = MemoryBuffer::getFile(Path);
+  ASSERT_TRUE(bool(Buf));
+  EXPECT_EQ(Expected, (*Buf)->getBuffer());
+  sys::fs::remove(Path);
+}
+
+TEST(raw_fd_streamTest, ReadAfterWrite) {
+  SmallString<64> Path;
+  int FD;
+  ASSERT_FALSE(sys::fs::createTemporaryFile("foo", "bar", FD, Path));
+  ASSERT_FALSE(sys::Process::SafelyCloseFileDescriptor(FD));
+  FileRemover Cleanup(Path);
+  std::error_code EC;
+  raw_fd_stream OS(Path, EC);
+  EXPECT_TRUE(!EC);
+  EXPECT_TRUE(isa<raw_fd_stream>(static_cast<raw_ostream &>(OS)));
+
+  char Bytes[8];
+
+  OS.write("01234567", 8);
+
+  OS.seek(3);
+  EXPECT_EQ(OS.read(Bytes, 2), 2);
+  EXPECT_EQ(std::string(Bytes, 2), "34");
+  EXPECT_EQ(OS.tell(), 5u);
+
+  OS.seek(4);
+  OS.write("xx", 2);
+  OS.seek(0);
+  EXPECT_EQ(OS.read(Bytes, 8), 8);
+  EXPECT_EQ(std::string(Bytes, 8), "0123xx67");
+  EXPECT_EQ(OS.read(Bytes, 8), 0);
+}
+
+TEST(raw_fd_streamTest, StdoutIsRejected) {
+  std::error_code EC;
+  raw_fd_stream OS("-", EC);
+  EXPECT_EQ(std::errc::invalid_argument, EC);
+
+  raw_fd_ostream FOS("-", EC, sys::fs::OF_None);
+  EXPECT_FALSE(isa<raw_fd_stream>(static_cast<raw_ostream &>(FOS)));
+}
 }
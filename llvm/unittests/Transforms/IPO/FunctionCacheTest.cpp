@@ -0,0 +1,126 @@
+//===- FunctionCacheTest.cpp - Unit tests for the function cache ----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO/FunctionCache.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+// Makes each function return 42 and print its name first, which adds a
+// declaration and a string constant to the module.
+struct TestFunctionPass : PassInfoMixin<TestFunctionPass> {
+  TestFunctionPass(int &Runs) : Runs(Runs) {}
+
+  PreservedAnalyses run(Function &F, FunctionAnalysisManager &) {
+    ++Runs;
+    auto *Ret = cast<ReturnInst>(F.getEntryBlock().getTerminator());
+    IRBuilder<> B(Ret);
+    FunctionCallee Puts = F.getParent()->getOrInsertFunction(
+        "puts", B.getInt32Ty(), B.getInt8PtrTy());
+    B.CreateCall(Puts, B.CreateGlobalStringPtr(F.getName(), ".str"));
+    Ret->setOperand(0, B.getInt32(42));
+    return PreservedAnalyses::none();
+  }
+
+  int &Runs;
+};
+
+class FunctionCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(sys::fs::createUniqueDirectory("function-cache", CacheDir));
+  }
+
+  void TearDown() override { sys::fs::remove_directories(CacheDir); }
+
+  // Runs TestFunctionPass on IR through the cache and returns the result.
+  std::string run(const char *IR) {
+    SMDiagnostic Err;
+    std::unique_ptr<Module> M = parseAssemblyString(IR, Err, Context);
+    EXPECT_TRUE(M);
+
+    FunctionAnalysisManager FAM;
+    ModuleAnalysisManager MAM;
+    MAM.registerPass([&] { return FunctionAnalysisManagerModuleProxy(FAM); });
+    FAM.registerPass([&] { return ModuleAnalysisManagerFunctionProxy(MAM); });
+    MAM.registerPass([&] { return PassInstrumentationAnalysis(); });
+    FAM.registerPass([&] { return PassInstrumentationAnalysis(); });
+
+    FunctionPassManager FPM;
+    FPM.addPass(TestFunctionPass(Runs));
+    ModulePassManager MPM;
+    MPM.addPass(FunctionCachePass(std::move(FPM),
+                                  UseCache ? CacheDir.str().str() : "",
+                                  "test"));
+    MPM.run(*M, MAM);
+
+    EXPECT_FALSE(verifyModule(*M, &errs()));
+    std::string Str;
+    raw_string_ostream OS(Str);
+    M->print(OS, nullptr);
+    return OS.str();
+  }
+
+  LLVMContext Context;
+  SmallString<128> CacheDir;
+  bool UseCache = true;
+  int Runs = 0;
+};
+
+const char *TestIR = "@g = internal global i32 0\n"
+                     "@c = private constant i32 7\n"
+                     "define internal i32 @f(i32 %x) {\n"
+                     "  %v = load i32, i32* @g\n"
+                     "  store i32 %x, i32* @g\n"
+                     "  ret i32 %v\n"
+                     "}\n"
+                     "define i32 @h() {\n"
+                     "  %v = load i32, i32* @c\n"
+                     "  %r = call i32 @f(i32 %v)\n"
+                     "  ret i32 %r\n"
+                     "}\n";
+
+TEST_F(FunctionCacheTest, ReuseUnchangedFunctions) {
+  std::string First = run(TestIR);
+  EXPECT_EQ(2, Runs);
+  EXPECT_NE(std::string::npos, First.find("ret i32 42"));
+
+  // Both functions are restored from the cache.
+  std::string Second = run(TestIR);
+  EXPECT_EQ(2, Runs);
+  EXPECT_EQ(First, Second);
+}
+
+TEST_F(FunctionCacheTest, ChangedConstant) {
+  run(TestIR);
+  EXPECT_EQ(2, Runs);
+
+  // @h refers to a constant with a different value now, so it is optimized
+  // again, but @f is not.
+  std::string IR = TestIR;
+  IR.replace(IR.find("i32 7"), 5, "i32 8");
+  run(IR.c_str());
+  EXPECT_EQ(3, Runs);
+}
+
+TEST_F(FunctionCacheTest, NoCacheDirectory) {
+  UseCache = false;
+  run(TestIR);
+  run(TestIR);
+  EXPECT_EQ(4, Runs);
+}
+
+} // end anonymous namespace
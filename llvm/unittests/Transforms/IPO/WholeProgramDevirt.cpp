@@ -8,6 +8,7 @@
 
 #include "llvm/Transforms/IPO/WholeProgramDevirt.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/IR/ModuleSummaryIndex.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -162,3 +163,81 @@ TEST(WholeProgramDevirt, setReturnValues) {
   EXPECT_EQ((std::vector<uint8_t>{0x81, 0xff, 0xff, 0xff}),
             VT2.After.BytesUsed);
 }
+
+// Index-based devirtualization of the virtual calls to each slot of a vtable,
+// with enough slots for the targets to be found in parallel, and vtable
+// functions that are not in offset order.
+TEST(WholeProgramDevirt, runOnIndex) {
+  const unsigned NumSlots = 600;
+  ModuleSummaryIndex Index(/*HaveGVs=*/false);
+  GlobalValueSummary::GVFlags Flags(GlobalValue::ExternalLinkage,
+                                    /*NotEligibleToImport=*/false,
+                                    /*Live=*/true, /*IsLocal=*/false,
+                                    /*CanAutoHide=*/false);
+  FunctionSummary::FFlags FunFlags{};
+  std::vector<std::string> Names;
+  for (unsigned I = 0; I != NumSlots; ++I)
+    Names.push_back("impl" + std::to_string(I));
+
+  VTableFuncList VTableFuncs;
+  std::vector<FunctionSummary::VFuncId> VCalls;
+  GlobalValue::GUID TypeID = GlobalValue::getGUID("_ZTS1A");
+  for (unsigned I = 0; I != NumSlots; ++I) {
+    unsigned Slot = (I * 7) % NumSlots;
+    ValueInfo VI =
+        Index.getOrInsertValueInfo(GlobalValue::getGUID(Names[Slot]),
+                                   Names[Slot]);
+    Index.addGlobalValueSummary(
+        VI, std::make_unique<FunctionSummary>(
+                Flags, 1, FunFlags, 0, std::vector<ValueInfo>{},
+                std::vector<FunctionSummary::EdgeTy>{},
+                std::vector<GlobalValue::GUID>{},
+                std::vector<FunctionSummary::VFuncId>{},
+                std::vector<FunctionSummary::VFuncId>{},
+                std::vector<FunctionSummary::ConstVCall>{},
+                std::vector<FunctionSummary::ConstVCall>{}));
+    // The address point is at offset 16.
+    VTableFuncs.push_back({VI, 16 + 8 * uint64_t(Slot)});
+    VCalls.push_back({TypeID, 8 * uint64_t(I)});
+  }
+
+  ValueInfo VTableVI =
+      Index.getOrInsertValueInfo(GlobalValue::getGUID("_ZTV1A"), "_ZTV1A");
+  auto VTable = std::make_unique<GlobalVarSummary>(
+      Flags, GlobalVarSummary::GVarFlags(false, false),
+      std::vector<ValueInfo>{});
+  VTable->setVTableFuncs(VTableFuncs);
+  Index.addGlobalValueSummary(VTableVI, std::move(VTable));
+  Index.getOrInsertTypeIdCompatibleVtableSummary("_ZTS1A").push_back(
+      {16, VTableVI});
+
+  ValueInfo CallerVI =
+      Index.getOrInsertValueInfo(GlobalValue::getGUID("caller"), "caller");
+  Index.addGlobalValueSummary(
+      CallerVI,
+      std::make_unique<FunctionSummary>(
+          Flags, 1, FunFlags, 0, std::vector<ValueInfo>{},
+          std::vector<FunctionSummary::EdgeTy>{},
+          std::vector<GlobalValue::GUID>{TypeID}, std::move(VCalls),
+          std::vector<FunctionSummary::VFuncId>{},
+          std::vector<FunctionSummary::ConstVCall>{},
+          std::vector<FunctionSummary::ConstVCall>{}));
+
+  std::set<GlobalValue::GUID> ExportedGUIDs;
+  std::map<ValueInfo, std::vector<VTableSlotSummary>> LocalWPDTargetsMap;
+  runWholeProgramDevirtOnIndex(Index, ExportedGUIDs, LocalWPDTargetsMap);
+
+  const TypeIdSummary *TidSummary = Index.getTypeIdSummary("_ZTS1A");
+  ASSERT_TRUE(TidSummary);
+  ASSERT_EQ(NumSlots, TidSummary->WPDRes.size());
+  for (unsigned Slot = 0; Slot != NumSlots; ++Slot) {
+    auto Res = TidSummary->WPDRes.find(8 * uint64_t(Slot));
+    ASSERT_NE(TidSummary->WPDRes.end(), Res);
+    EXPECT_EQ(WholeProgramDevirtResolution::SingleImpl, Res->second.TheKind);
+    EXPECT_EQ(Names[Slot], Res->second.SingleImplName);
+  }
+  auto *Caller =
+      cast<FunctionSummary>(CallerVI.getSummaryList().front().get());
+  EXPECT_EQ(NumSlots, Caller->calls().size());
+  EXPECT_TRUE(ExportedGUIDs.empty());
+}
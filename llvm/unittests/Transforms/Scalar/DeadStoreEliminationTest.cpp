@@ -0,0 +1,159 @@
+//===- DeadStoreEliminationTest.cpp - DSE unit tests ----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Scalar/DeadStoreElimination.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/BasicAliasAnalysis.h"
+#include "llvm/Analysis/MemoryDependenceAnalysis.h"
+#include "llvm/Analysis/MemorySSA.h"
+#include "llvm/Analysis/PostDominators.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+const char *IR = R"(
+  declare void @may_throw() readnone
+  declare void @g()
+
+  define void @cross_block(i32* %p, i1 %c) {
+  entry:
+    store i32 1, i32* %p
+    br i1 %c, label %a, label %b
+  a:
+    br label %exit
+  b:
+    br label %exit
+  exit:
+    store i32 2, i32* %p
+    ret void
+  }
+
+  define i32 @read_on_one_path(i32* %p, i1 %c) {
+  entry:
+    store i32 1, i32* %p
+    br i1 %c, label %a, label %exit
+  a:
+    %v = load i32, i32* %p
+    br label %exit
+  exit:
+    %r = phi i32 [ 0, %entry ], [ %v, %a ]
+    store i32 2, i32* %p
+    ret i32 %r
+  }
+
+  define void @not_post_dominated(i32* %p, i1 %c) {
+  entry:
+    store i32 1, i32* %p
+    br i1 %c, label %a, label %exit
+  a:
+    store i32 2, i32* %p
+    br label %exit
+  exit:
+    ret void
+  }
+
+  define void @visible_on_unwind(i32* %p) {
+    store i32 1, i32* %p
+    call void @may_throw()
+    store i32 2, i32* %p
+    ret void
+  }
+
+  define void @stack_never_read() {
+    %a = alloca i32
+    store i32 1, i32* %a
+    call void @g()
+    ret void
+  }
+)";
+
+class DSETest : public testing::Test {
+protected:
+  LLVMContext Context;
+  std::unique_ptr<Module> M;
+  FunctionAnalysisManager FAM;
+  cl::opt<bool> &EnableMemorySSA;
+
+  DSETest()
+      : EnableMemorySSA(static_cast<cl::opt<bool> &>(
+            *cl::getRegisteredOptions()["enable-dse-memoryssa"])) {
+    SMDiagnostic Err;
+    M = parseAssemblyString(IR, Err, Context);
+    if (!M)
+      Err.print("DeadStoreEliminationTest", errs());
+
+    FAM.registerPass([] {
+      AAManager AA;
+      AA.registerFunctionAnalysis<BasicAA>();
+      return AA;
+    });
+    FAM.registerPass([] { return AssumptionAnalysis(); });
+    FAM.registerPass([] { return BasicAA(); });
+    FAM.registerPass([] { return DominatorTreeAnalysis(); });
+    FAM.registerPass([] { return MemoryDependenceAnalysis(); });
+    FAM.registerPass([] { return MemorySSAAnalysis(); });
+    FAM.registerPass([] { return PostDominatorTreeAnalysis(); });
+    FAM.registerPass([] { return TargetLibraryAnalysis(); });
+  }
+
+  ~DSETest() { EnableMemorySSA = false; }
+
+  // Runs DSE on the function and returns the number of stores left.
+  unsigned runDSE(StringRef Name, bool UseMemorySSA) {
+    EnableMemorySSA = UseMemorySSA;
+    Function *F = M->getFunction(Name);
+    DSEPass().run(*F, FAM);
+    if (UseMemorySSA)
+      FAM.getResult<MemorySSAAnalysis>(*F).getMSSA().verifyMemorySSA();
+    unsigned NumStores = 0;
+    for (Instruction &I : instructions(*F))
+      NumStores += isa<StoreInst>(I);
+    return NumStores;
+  }
+};
+
+TEST_F(DSETest, CrossBlockOverwrite) {
+  ASSERT_TRUE(M);
+  EXPECT_EQ(2u, runDSE("cross_block", /*UseMemorySSA=*/false));
+  EXPECT_EQ(1u, runDSE("cross_block", /*UseMemorySSA=*/true));
+}
+
+TEST_F(DSETest, ReadOnOnePath) {
+  ASSERT_TRUE(M);
+  EXPECT_EQ(2u, runDSE("read_on_one_path", /*UseMemorySSA=*/true));
+}
+
+TEST_F(DSETest, NotPostDominated) {
+  ASSERT_TRUE(M);
+  EXPECT_EQ(2u, runDSE("not_post_dominated", /*UseMemorySSA=*/true));
+}
+
+TEST_F(DSETest, VisibleOnUnwind) {
+  ASSERT_TRUE(M);
+  EXPECT_EQ(2u, runDSE("visible_on_unwind", /*UseMemorySSA=*/true));
+}
+
+TEST_F(DSETest, StackObjectNeverRead) {
+  ASSERT_TRUE(M);
+  EXPECT_EQ(0u, runDSE("stack_never_read", /*UseMemorySSA=*/true));
+}
+
+} // end anonymous namespace
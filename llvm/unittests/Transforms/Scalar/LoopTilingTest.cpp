@@ -0,0 +1,180 @@
+//===- LoopTilingTest.cpp - Loop tiling unit tests ------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Scalar/LoopTiling.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/BasicAliasAnalysis.h"
+#include "llvm/Analysis/DependenceAnalysis.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+
+using namespace llvm;
+
+namespace {
+
+// A[i][j] += B[j] over 64 rows of 4096 floats: B is reused by every row, and
+// a row of A and B take 48KB of cache lines.
+const char *IR = R"(
+  define void @reuse(float* noalias %A, float* noalias %B, i64 %n) {
+  entry:
+    br label %outer
+  outer:
+    %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+    %row = mul i64 %i, %n
+    br label %inner
+  inner:
+    %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]
+    %idx = add i64 %row, %j
+    %a.addr = getelementptr inbounds float, float* %A, i64 %idx
+    %b.addr = getelementptr inbounds float, float* %B, i64 %j
+    %a = load float, float* %a.addr
+    %b = load float, float* %b.addr
+    %sum = fadd float %a, %b
+    store float %sum, float* %a.addr
+    %j.next = add nuw nsw i64 %j, 1
+    %inner.cond = icmp ult i64 %j.next, 4096
+    br i1 %inner.cond, label %inner, label %outer.latch
+  outer.latch:
+    %i.next = add nuw nsw i64 %i, 1
+    %outer.cond = icmp ult i64 %i.next, 64
+    br i1 %outer.cond, label %outer, label %exit
+  exit:
+    ret void
+  }
+
+  ; A[i + 1][j] = A[i][j + 1] reads in iteration (i + 1, j - 1) what iteration
+  ; (i, j) writes, which tiling would reorder.
+  define void @reversed_dependence(float* noalias %A, i64 %n) {
+  entry:
+    br label %outer
+  outer:
+    %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+    %row = mul i64 %i, %n
+    %i.next = add nuw nsw i64 %i, 1
+    %next.row = mul i64 %i.next, %n
+    br label %inner
+  inner:
+    %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]
+    %j.next = add nuw nsw i64 %j, 1
+    %src.idx = add i64 %row, %j.next
+    %dst.idx = add i64 %next.row, %j
+    %src = getelementptr inbounds float, float* %A, i64 %src.idx
+    %dst = getelementptr inbounds float, float* %A, i64 %dst.idx
+    %v = load float, float* %src
+    store float %v, float* %dst
+    %inner.cond = icmp ult i64 %j.next, 4096
+    br i1 %inner.cond, label %inner, label %outer.latch
+  outer.latch:
+    %outer.cond = icmp ult i64 %i.next, 64
+    br i1 %outer.cond, label %outer, label %exit
+  exit:
+    ret void
+  }
+)";
+
+class LoopTilingTest : public testing::Test {
+protected:
+  LLVMContext Context;
+  std::unique_ptr<Module> M;
+  FunctionAnalysisManager FAM;
+  cl::opt<unsigned> &CacheSize;
+  cl::opt<unsigned> &CacheLineSize;
+  cl::opt<unsigned> &TileSize;
+
+  static cl::opt<unsigned> &getOption(StringRef Name) {
+    return static_cast<cl::opt<unsigned> &>(*cl::getRegisteredOptions()[Name]);
+  }
+
+  LoopTilingTest()
+      : CacheSize(getOption("loop-tiling-cache-size")),
+        CacheLineSize(getOption("loop-tiling-cache-line-size")),
+        TileSize(getOption("loop-tiling-tile-size")) {
+    SMDiagnostic Err;
+    M = parseAssemblyString(IR, Err, Context);
+    if (!M)
+      Err.print("LoopTilingTest", errs());
+
+    FAM.registerPass([] {
+      AAManager AA;
+      AA.registerFunctionAnalysis<BasicAA>();
+      return AA;
+    });
+    FAM.registerPass([] { return AssumptionAnalysis(); });
+    FAM.registerPass([] { return BasicAA(); });
+    FAM.registerPass([] { return DependenceAnalysis(); });
+    FAM.registerPass([] { return DominatorTreeAnalysis(); });
+    FAM.registerPass([] { return LoopAnalysis(); });
+    FAM.registerPass([] { return OptimizationRemarkEmitterAnalysis(); });
+    FAM.registerPass([] { return ScalarEvolutionAnalysis(); });
+    FAM.registerPass([] { return TargetIRAnalysis(); });
+    FAM.registerPass([] { return TargetLibraryAnalysis(); });
+
+    CacheSize = 16 * 1024;
+    CacheLineSize = 64;
+  }
+
+  ~LoopTilingTest() {
+    CacheSize = 0;
+    CacheLineSize = 0;
+    TileSize = 0;
+  }
+
+  // Runs loop tiling on the function and returns its loop nest depth.
+  unsigned runLoopTiling(StringRef Name) {
+    Function *F = M->getFunction(Name);
+    FAM.invalidate(*F, LoopTilingPass().run(*F, FAM));
+    EXPECT_FALSE(verifyFunction(*F, &errs()));
+
+    // The updated loop info must match the loops of the new CFG.
+    DominatorTree DT(*F);
+    LoopInfo LI(DT);
+    LoopInfo &UpdatedLI = FAM.getResult<LoopAnalysis>(*F);
+    UpdatedLI.verify(DT);
+    unsigned Depth = 0;
+    for (BasicBlock &BB : *F) {
+      EXPECT_EQ(LI.getLoopDepth(&BB), UpdatedLI.getLoopDepth(&BB));
+      Depth = std::max(Depth, LI.getLoopDepth(&BB));
+    }
+    return Depth;
+  }
+};
+
+TEST_F(LoopTilingTest, TilesForReuse) {
+  ASSERT_TRUE(M);
+  EXPECT_EQ(3u, runLoopTiling("reuse"));
+  // The nest is not tiled again.
+  EXPECT_EQ(3u, runLoopTiling("reuse"));
+}
+
+TEST_F(LoopTilingTest, FitsInCache) {
+  ASSERT_TRUE(M);
+  CacheSize = 64 * 1024;
+  EXPECT_EQ(2u, runLoopTiling("reuse"));
+}
+
+TEST_F(LoopTilingTest, ReversedDependence) {
+  ASSERT_TRUE(M);
+  TileSize = 64;
+  EXPECT_EQ(2u, runLoopTiling("reversed_dependence"));
+}
+
+} // end anonymous namespace
@@ -0,0 +1,134 @@
+//===- SplitModuleTest.cpp - Unit tests for SplitModule -------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Utils/SplitModule.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+std::unique_ptr<Module> parseIR(LLVMContext &C, const char *IR) {
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(IR, Err, C);
+  if (!M)
+    Err.print("SplitModuleTest", errs());
+  return M;
+}
+
+// Returns the names of the functions defined in each partition.
+std::vector<std::vector<std::string>>
+splitFunctions(std::unique_ptr<Module> M, unsigned N, bool PreserveLocals) {
+  std::vector<std::vector<std::string>> Partitions;
+  SplitModule(
+      std::move(M), N,
+      [&](std::unique_ptr<Module> MPart) {
+        EXPECT_FALSE(verifyModule(*MPart, &errs()));
+        Partitions.emplace_back();
+        for (Function &F : *MPart)
+          if (!F.isDeclaration())
+            Partitions.back().push_back(F.getName());
+      },
+      PreserveLocals, /*PreserveOrder=*/true);
+  return Partitions;
+}
+
+const char *OrderIR = "define void @a() {\n"
+                      "  ret void\n"
+                      "}\n"
+                      "define void @b() {\n"
+                      "  ret void\n"
+                      "}\n"
+                      "define void @c() {\n"
+                      "  ret void\n"
+                      "}\n"
+                      "define void @d() {\n"
+                      "  ret void\n"
+                      "}\n";
+
+TEST(SplitModuleTest, PreserveOrder) {
+  LLVMContext C;
+  auto Partitions = splitFunctions(parseIR(C, OrderIR), 2, false);
+  ASSERT_EQ(2u, Partitions.size());
+  EXPECT_EQ(std::vector<std::string>({"a", "b"}), Partitions[0]);
+  EXPECT_EQ(std::vector<std::string>({"c", "d"}), Partitions[1]);
+}
+
+// Partitions are balanced by the size of their functions.
+TEST(SplitModuleTest, PreserveOrderBalancesSize) {
+  LLVMContext C;
+  auto Partitions = splitFunctions(parseIR(C, R"(
+    define i32 @big(i32 %x) {
+      %a = add i32 %x, 1
+      %b = add i32 %a, 2
+      %c = add i32 %b, 3
+      %d = add i32 %c, 4
+      %e = add i32 %d, 5
+      ret i32 %e
+    }
+    define void @small1() {
+      ret void
+    }
+    define void @small2() {
+      ret void
+    }
+    define void @small3() {
+      ret void
+    }
+  )"), 2, false);
+  ASSERT_EQ(2u, Partitions.size());
+  EXPECT_EQ(std::vector<std::string>({"big"}), Partitions[0]);
+  EXPECT_EQ(std::vector<std::string>({"small1", "small2", "small3"}),
+            Partitions[1]);
+}
+
+// Without externalization, a local stays with the first function that uses
+// it, and so do the other users of the local.
+TEST(SplitModuleTest, PreserveOrderKeepsLocalsTogether) {
+  LLVMContext C;
+  auto Partitions = splitFunctions(parseIR(C, R"(
+    define void @a() {
+      call void @local()
+      ret void
+    }
+    define void @b() {
+      ret void
+    }
+    define void @c() {
+      ret void
+    }
+    define void @d() {
+      call void @local()
+      ret void
+    }
+    define internal void @local() {
+      ret void
+    }
+  )"), 2, true);
+  ASSERT_EQ(2u, Partitions.size());
+  EXPECT_EQ(std::vector<std::string>({"a", "d", "local"}), Partitions[0]);
+  EXPECT_EQ(std::vector<std::string>({"b", "c"}), Partitions[1]);
+}
+
+// More partitions than functions leaves some partitions empty.
+TEST(SplitModuleTest, PreserveOrderMorePartitions) {
+  LLVMContext C;
+  auto Partitions = splitFunctions(parseIR(C, OrderIR), 8, false);
+  ASSERT_EQ(8u, Partitions.size());
+  std::vector<std::string> All;
+  for (auto &P : Partitions)
+    All.insert(All.end(), P.begin(), P.end());
+  EXPECT_EQ(std::vector<std::string>({"a", "b", "c", "d"}), All);
+}
+
+} // end anonymous namespace
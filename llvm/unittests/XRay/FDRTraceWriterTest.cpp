@@ -118,6 +118,79 @@ TEST(FDRTraceWriterTest, WriteToStringBufferVersion2) {
                           Field(&XRayRecord::Type, Eq(RecordTypes::EXIT))));
 }
 
+// Streaming the records of a trace hands out the same records as loading it,
+// with each thread's buffers read again from the log.
+TEST(FDRTraceWriterTest, ProcessMultipleBuffersVersion3) {
+  std::string Data;
+  raw_string_ostream OS(Data);
+  XRayFileHeader H;
+  H.Version = 3;
+  H.Type = 1;
+  H.ConstantTSC = true;
+  H.NonstopTSC = true;
+  H.CycleFrequency = 3e9;
+  FDRTraceWriter Writer(OS, H);
+  auto L = LogBuilder()
+               .add<BufferExtents>(80)
+               .add<NewBufferRecord>(1)
+               .add<WallclockRecord>(1, 1)
+               .add<PIDRecord>(1)
+               .add<NewCPUIDRecord>(1, 2)
+               .add<FunctionRecord>(RecordTypes::ENTER, 1, 1)
+               .add<FunctionRecord>(RecordTypes::EXIT, 1, 100)
+               .add<BufferExtents>(80)
+               .add<NewBufferRecord>(2)
+               .add<WallclockRecord>(1, 2)
+               .add<PIDRecord>(1)
+               .add<NewCPUIDRecord>(2, 3)
+               .add<FunctionRecord>(RecordTypes::ENTER, 2, 1)
+               .add<FunctionRecord>(RecordTypes::EXIT, 2, 100)
+               .add<BufferExtents>(80)
+               .add<NewBufferRecord>(1)
+               .add<WallclockRecord>(2, 1)
+               .add<PIDRecord>(1)
+               .add<NewCPUIDRecord>(1, 200)
+               .add<FunctionRecord>(RecordTypes::ENTER, 3, 1)
+               .add<FunctionRecord>(RecordTypes::EXIT, 3, 100)
+               .consume();
+  for (auto &P : L)
+    ASSERT_FALSE(errorToBool(P->apply(Writer)));
+  OS.flush();
+
+  DataExtractor DE(Data, sys::IsLittleEndianHost, 8);
+  auto TraceOrErr = loadTrace(DE);
+  if (!TraceOrErr)
+    FAIL() << TraceOrErr.takeError();
+  auto &Trace = TraceOrErr.get();
+  ASSERT_THAT(Trace.size(), Eq(6u));
+
+  XRayFileHeader Header;
+  std::vector<XRayRecord> Records;
+  auto E = processTrace(DE, Header, [&](const XRayRecord &R) {
+    Records.push_back(R);
+    return Error::success();
+  });
+  if (E)
+    FAIL() << std::move(E);
+  EXPECT_THAT(Header.Version, Eq(3u));
+  ASSERT_THAT(Records.size(), Eq(Trace.size()));
+  for (size_t I = 0; I < Records.size(); ++I) {
+    EXPECT_THAT(Records[I].FuncId, Eq(Trace.begin()[I].FuncId));
+    EXPECT_THAT(Records[I].TId, Eq(Trace.begin()[I].TId));
+    EXPECT_THAT(Records[I].TSC, Eq(Trace.begin()[I].TSC));
+  }
+
+  // An error from the callback stops the processing.
+  size_t Seen = 0;
+  E = processTrace(DE, Header, [&](const XRayRecord &) -> Error {
+    if (++Seen == 3)
+      return createStringError(std::errc::invalid_argument, "stop");
+    return Error::success();
+  });
+  EXPECT_TRUE(errorToBool(std::move(E)));
+  EXPECT_THAT(Seen, Eq(3u));
+}
+
 // This covers version 1 of the log, without a BufferExtents record but has an
 // explicit EndOfBuffer record.
 TEST(FDRTraceWriterTest, WriteToStringBufferVersion1) {
@@ -0,0 +1,40 @@
+//===-- CpuAffinityTest.cpp -------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "CpuAffinity.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace llvm {
+namespace exegesis {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(CpuAffinityTest, ParsesCpuLists) {
+  EXPECT_THAT_EXPECTED(parseCpuList("3"), HasValue(ElementsAre(3)));
+  EXPECT_THAT_EXPECTED(parseCpuList("0,2-4,7\n"),
+                       HasValue(ElementsAre(0, 2, 3, 4, 7)));
+  // The kernel writes an empty line when no CPU is isolated.
+  EXPECT_THAT_EXPECTED(parseCpuList("\n"), HasValue(IsEmpty()));
+  EXPECT_THAT_EXPECTED(parseCpuList("5,1-2,2"),
+                       HasValue(ElementsAre(1, 2, 5)));
+}
+
+TEST(CpuAffinityTest, RejectsInvalidCpuLists) {
+  EXPECT_THAT_EXPECTED(parseCpuList("a"), Failed());
+  EXPECT_THAT_EXPECTED(parseCpuList("1-"), Failed());
+  EXPECT_THAT_EXPECTED(parseCpuList("4-2"), Failed());
+  EXPECT_THAT_EXPECTED(parseCpuList("1;2"), Failed());
+}
+
+} // namespace
+} // namespace exegesis
+} // namespace llvm
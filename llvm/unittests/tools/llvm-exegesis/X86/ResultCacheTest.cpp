@@ -0,0 +1,102 @@
+//===-- ResultCacheTest.cpp -------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "ResultCache.h"
+#include "X86InstrInfo.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/MC/MCInstBuilder.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/TargetSelect.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace llvm {
+namespace exegesis {
+namespace {
+
+class ResultCacheTest : public ::testing::Test {
+protected:
+  ResultCacheTest() : State("x86_64-unknown-linux", "haswell") {}
+
+  static void SetUpTestCase() {
+    LLVMInitializeX86TargetInfo();
+    LLVMInitializeX86Target();
+    LLVMInitializeX86TargetMC();
+  }
+
+  InstructionBenchmark makeSetup(unsigned Opcode) const {
+    InstructionBenchmark Setup;
+    Setup.Key.Instructions.push_back(llvm::MCInstBuilder(Opcode)
+                                         .addReg(llvm::X86::EAX)
+                                         .addReg(llvm::X86::EAX)
+                                         .addReg(llvm::X86::ECX));
+    Setup.Mode = InstructionBenchmark::Latency;
+    Setup.CpuName = "haswell";
+    Setup.LLVMTriple = "x86_64-unknown-linux";
+    Setup.NumRepetitions = 100;
+    return Setup;
+  }
+
+  std::string getKey(const InstructionBenchmark &Setup,
+                     InstructionBenchmark::RepetitionModeE Mode =
+                         InstructionBenchmark::Duplicate) const {
+    return ExitOnErr(ResultCache::getKey(State, Setup, Mode));
+  }
+
+  const LLVMState State;
+  llvm::ExitOnError ExitOnErr;
+};
+
+TEST_F(ResultCacheTest, KeysCoverTheSetup) {
+  const InstructionBenchmark Setup = makeSetup(llvm::X86::ADD32rr);
+  EXPECT_EQ(getKey(Setup), getKey(makeSetup(llvm::X86::ADD32rr)));
+  EXPECT_NE(getKey(Setup), getKey(makeSetup(llvm::X86::SUB32rr)));
+  EXPECT_NE(getKey(Setup), getKey(Setup, InstructionBenchmark::Loop));
+
+  InstructionBenchmark OtherCpu = Setup;
+  OtherCpu.CpuName = "skylake";
+  EXPECT_NE(getKey(Setup), getKey(OtherCpu));
+  InstructionBenchmark OtherRepetitions = Setup;
+  OtherRepetitions.NumRepetitions = 200;
+  EXPECT_NE(getKey(Setup), getKey(OtherRepetitions));
+}
+
+TEST_F(ResultCacheTest, StoresAndLooksUpResults) {
+  llvm::SmallString<64> Directory;
+  ASSERT_FALSE(
+      llvm::sys::fs::createUniqueDirectory("ResultCacheTestDir", Directory));
+  const ResultCache Cache(Directory.str());
+
+  const InstructionBenchmark Setup = makeSetup(llvm::X86::ADD32rr);
+  const std::string Key = getKey(Setup);
+  EXPECT_FALSE(Cache.lookup(State, Key).hasValue());
+
+  InstructionBenchmark Result = Setup;
+  Result.Measurements.push_back(BenchmarkMeasure::Create("latency", 1.0));
+  ExitOnErr(Cache.store(State, Key, Result));
+  const auto Cached = Cache.lookup(State, Key);
+  ASSERT_TRUE(Cached.hasValue());
+  EXPECT_EQ(Cached->CpuName, Setup.CpuName);
+  ASSERT_EQ(Cached->Measurements.size(), 1u);
+  EXPECT_EQ(Cached->Measurements[0].Key, "latency");
+  EXPECT_EQ(Cached->Measurements[0].PerInstructionValue, 1.0);
+
+  // Errors are not cached.
+  const std::string OtherKey = getKey(makeSetup(llvm::X86::SUB32rr));
+  InstructionBenchmark Failed = makeSetup(llvm::X86::SUB32rr);
+  Failed.Error = "snippet crashed while running";
+  ExitOnErr(Cache.store(State, OtherKey, Failed));
+  EXPECT_FALSE(Cache.lookup(State, OtherKey).hasValue());
+
+  llvm::sys::fs::remove_directories(Directory);
+}
+
+} // namespace
+} // namespace exegesis
+} // namespace llvm
@@ -139,7 +139,18 @@ cl::opt<bool, true>
                    cl::desc("Time regions of tablegens execution"),
                    cl::location(TimeRegions));
 
-bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
+cl::list<std::string>
+    EmitOutputs("emit",
+                cl::desc("Perform an action and write its output to a file. "
+                         "May be repeated: the input is then parsed once for "
+                         "all the actions"),
+                cl::value_desc("action=filename"));
+
+cl::opt<unsigned> Jobs("j",
+                       cl::desc("Number of -emit actions to perform at once"),
+                       cl::value_desc("N"), cl::init(1));
+
+bool performAction(ActionType Action, raw_ostream &OS, RecordKeeper &Records) {
   switch (Action) {
   case PrintRecords:
     OS << Records;           // No argument, dump all contents
@@ -259,6 +270,10 @@ bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
 
   return false;
 }
+
+bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
+  return performAction(Action, OS, Records);
+}
 }
 
 int main(int argc, char **argv) {
@@ -268,7 +283,27 @@ int main(int argc, char **argv) {
 
   llvm_shutdown_obj Y;
 
-  return TableGenMain(argv[0], &LLVMTableGenMain);
+  if (EmitOutputs.empty())
+    return TableGenMain(argv[0], &LLVMTableGenMain);
+
+  std::vector<TableGenOutput> Outputs;
+  auto &Parser = Action.getParser();
+  for (StringRef Emit : EmitOutputs) {
+    StringRef Name, Filename;
+    std::tie(Name, Filename) = Emit.split('=');
+    ActionType EmitAction;
+    if (Filename.empty() || Parser.findOption(Name) == Parser.getNumOptions() ||
+        Parser.parse(Action, Name, "", EmitAction)) {
+      errs() << argv[0] << ": invalid -emit '" << Emit
+             << "', expected <action>=<filename>\n";
+      return 1;
+    }
+    Outputs.push_back({Filename.str(), [EmitAction](raw_ostream &OS,
+                                                    RecordKeeper &Records) {
+                         return performAction(EmitAction, OS, Records);
+                       }});
+  }
+  return TableGenMain(argv[0], Outputs, Jobs);
 }
 
 #ifndef __has_feature
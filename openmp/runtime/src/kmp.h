@@ -788,6 +788,8 @@ extern int __kmp_affinity_respect_mask; // Respect process' init affinity mask?
 extern char *__kmp_affinity_proclist; /* proc ID list */
 extern kmp_affin_mask_t *__kmp_affinity_masks;
 extern unsigned __kmp_affinity_num_masks;
+/* Package of each place, NULL if there is only one package */
+extern int *__kmp_affinity_place_package;
 extern void __kmp_affinity_bind_thread(int which);
 
 extern kmp_affin_mask_t *__kmp_affin_fullMask;
@@ -2841,6 +2843,8 @@ extern kmp_uint32 __kmp_barrier_gather_branch_bits[bs_last_barrier];
 extern kmp_uint32 __kmp_barrier_release_branch_bits[bs_last_barrier];
 extern kmp_bar_pat_e __kmp_barrier_gather_pattern[bs_last_barrier];
 extern kmp_bar_pat_e __kmp_barrier_release_pattern[bs_last_barrier];
+/* TRUE if the pattern was set by KMP_*_BARRIER_PATTERN */
+extern int __kmp_barrier_pattern_set[bs_last_barrier];
 extern char const *__kmp_barrier_branch_bit_env_name[bs_last_barrier];
 extern char const *__kmp_barrier_pattern_env_name[bs_last_barrier];
 extern char const *__kmp_barrier_type_name[bs_last_barrier];
@@ -3332,6 +3336,7 @@ extern char *__kmp_affinity_print_mask(char *buf, int buf_len,
 extern kmp_str_buf_t *__kmp_affinity_str_buf_mask(kmp_str_buf_t *buf,
                                                   kmp_affin_mask_t *mask);
 extern void __kmp_affinity_initialize(void);
+extern void __kmp_affinity_set_barrier_patterns(void);
 extern void __kmp_affinity_uninitialize(void);
 extern void __kmp_affinity_set_init_mask(
     int gtid, int isa_root); /* set affinity according to KMP_AFFINITY */
@@ -4646,6 +4646,31 @@ static void __kmp_aux_affinity_initialize(void) {
 }
 #undef KMP_EXIT_AFF_NONE
 
+// Record the package of every place, so that the tasking code can prefer
+// stealing from threads on the same package. A place is attributed to the
+// package of its first processor.
+static void __kmp_affinity_find_place_packages() {
+  KMP_DEBUG_ASSERT(__kmp_affinity_place_package == NULL);
+  if (__kmp_affinity_type == affinity_none ||
+      __kmp_affinity_type == affinity_disabled || address2os == NULL ||
+      __kmp_affinity_masks == NULL || nPackages <= 1 ||
+      address2os[0].first.depth <= 1)
+    return;
+  __kmp_affinity_place_package =
+      (int *)__kmp_allocate(sizeof(int) * __kmp_affinity_num_masks);
+  for (unsigned place = 0; place < __kmp_affinity_num_masks; ++place) {
+    kmp_affin_mask_t *mask = KMP_CPU_INDEX(__kmp_affinity_masks, place);
+    int osId = mask->begin();
+    __kmp_affinity_place_package[place] = -1;
+    for (int i = 0; i < __kmp_avail_proc; ++i) {
+      if ((int)address2os[i].second == osId) {
+        __kmp_affinity_place_package[place] = address2os[i].first.labels[0];
+        break;
+      }
+    }
+  }
+}
+
 void __kmp_affinity_initialize(void) {
   // Much of the code above was written assumming that if a machine was not
   // affinity capable, then __kmp_affinity_type == affinity_none.  We now
@@ -4666,6 +4691,31 @@ void __kmp_affinity_initialize(void) {
   if (disabled) {
     __kmp_affinity_type = affinity_disabled;
   }
+  __kmp_affinity_find_place_packages();
+}
+
+// On machines with more than one package, threads bound to places are spread
+// over several sockets, and the flat tree and hyper barriers make every
+// thread touch flags owned by threads on other sockets. The hierarchical
+// barrier builds its tree from the machine topology instead, so threads first
+// synchronize (and combine reduction data) with the threads on their own core
+// and package, and only one thread per package crosses the interconnect.
+// Barriers whose pattern was set explicitly are left alone.
+void __kmp_affinity_set_barrier_patterns(void) {
+  if (!KMP_AFFINITY_CAPABLE() || __kmp_affinity_type == affinity_none ||
+      __kmp_affinity_type == affinity_disabled)
+    return;
+  if (nPackages <= 1)
+    return;
+  for (int i = bs_plain_barrier; i < bs_last_barrier; i++) {
+    if (__kmp_barrier_pattern_set[i])
+      continue;
+    __kmp_barrier_gather_pattern[i] = bp_hierarchical_bar;
+    __kmp_barrier_release_pattern[i] = bp_hierarchical_bar;
+    KA_TRACE(10, ("__kmp_affinity_set_barrier_patterns: %s barrier uses "
+                  "hierarchical pattern for %d packages\n",
+                  __kmp_barrier_type_name[i], nPackages));
+  }
 }
 
 void __kmp_affinity_uninitialize(void) {
@@ -4677,6 +4727,10 @@ void __kmp_affinity_uninitialize(void) {
     KMP_CPU_FREE(__kmp_affin_fullMask);
     __kmp_affin_fullMask = NULL;
   }
+  if (__kmp_affinity_place_package != NULL) {
+    __kmp_free(__kmp_affinity_place_package);
+    __kmp_affinity_place_package = NULL;
+  }
   __kmp_affinity_num_masks = 0;
   __kmp_affinity_type = affinity_default;
   __kmp_affinity_num_places = 0;
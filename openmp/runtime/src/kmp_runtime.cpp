@@ -6788,6 +6788,9 @@ static void __kmp_do_middle_initialize(void) {
   // number of cores on the machine.
   __kmp_affinity_initialize();
 
+  // Now that the topology is known, pick barrier patterns that follow it.
+  __kmp_affinity_set_barrier_patterns();
+
   // Run through the __kmp_threads array and set the affinity mask
   // for each root thread that is currently registered with the RTL.
   for (i = 0; i < __kmp_threads_capacity; i++) {
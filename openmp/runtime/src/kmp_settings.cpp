@@ -1601,6 +1601,8 @@ static void __kmp_stg_parse_barrier_pattern(char const *name, char const *value,
       int j;
       char *comma = CCAST(char *, strchr(value, ','));
 
+      __kmp_barrier_pattern_set[i] = TRUE;
+
       /* handle first parameter: gather pattern */
       for (j = bp_linear_bar; j < bp_last_bar; j++) {
         if (__kmp_match_with_sentinel(__kmp_barrier_pattern_name[j], value, 1,
@@ -20,6 +20,12 @@
 #define KMP_ACQUIRE_DEPNODE(gtid, n) __kmp_acquire_lock(&(n)->dn.lock, (gtid))
 #define KMP_RELEASE_DEPNODE(gtid, n) __kmp_release_lock(&(n)->dn.lock, (gtid))
 
+#define ENTRY_LAST_INS 0
+#define ENTRY_LAST_MTXS 1
+
+// Largest number of entries __kmp_dephash_reset_entries keeps for reuse
+#define KMP_DEPHASH_MAX_KEPT_ENTRIES 8192
+
 static inline void __kmp_node_deref(kmp_info_t *thread, kmp_depnode_t *node) {
   if (!node)
     return;
@@ -74,6 +80,33 @@ static inline void __kmp_dephash_free_entries(kmp_info_t *thread,
       h->buckets[i] = 0;
     }
   }
+  h->nelements = 0;
+  h->nconflicts = 0;
+}
+
+// Drop the dependences recorded in h, but keep its entries and their locks.
+// Parallel regions of iterative codes usually submit tasks that depend on the
+// same addresses as in the previous region, and then find the entries already
+// in the table instead of allocating and inserting them again. Tables that
+// have grown large are emptied instead, to bound the memory kept.
+static inline void __kmp_dephash_reset_entries(kmp_info_t *thread,
+                                               kmp_dephash_t *h) {
+  if (h->nelements > KMP_DEPHASH_MAX_KEPT_ENTRIES) {
+    __kmp_dephash_free_entries(thread, h);
+    return;
+  }
+  for (size_t i = 0; i < h->size; i++) {
+    for (kmp_dephash_entry_t *entry = h->buckets[i]; entry;
+         entry = entry->next_in_bucket) {
+      __kmp_depnode_list_free(thread, entry->last_ins);
+      __kmp_depnode_list_free(thread, entry->last_mtxs);
+      __kmp_node_deref(thread, entry->last_out);
+      entry->last_ins = NULL;
+      entry->last_mtxs = NULL;
+      entry->last_out = NULL;
+      entry->last_flag = ENTRY_LAST_INS;
+    }
+  }
 }
 
 static inline void __kmp_dephash_free(kmp_info_t *thread, kmp_dephash_t *h) {
@@ -777,7 +777,7 @@ static void __kmp_free_task_and_ancestors(kmp_int32 gtid,
                            "dephash of implicit task %p\n",
                            gtid, taskdata));
             // cleanup dephash of finished implicit task
-            __kmp_dephash_free_entries(thread, taskdata->td_dephash);
+            __kmp_dephash_reset_entries(thread, taskdata->td_dephash);
           }
         }
       }
@@ -1109,7 +1109,7 @@ void __kmp_finish_implicit_task(kmp_info_t *thread) {
         KA_TRACE(100, ("__kmp_finish_implicit_task: T#%d cleans "
                        "dephash of implicit task %p\n",
                        thread->th.th_info.ds.ds_gtid, task));
-        __kmp_dephash_free_entries(thread, task->td_dephash);
+        __kmp_dephash_reset_entries(thread, task->td_dephash);
       }
     }
   }
@@ -2638,6 +2638,47 @@ static kmp_task_t *__kmp_remove_my_task(kmp_info_t *thread, kmp_int32 gtid,
   return task;
 }
 
+#if KMP_AFFINITY_SUPPORTED
+// __kmp_task_thread_is_remote: TRUE if the two threads are bound to places on
+// different packages
+static inline bool __kmp_task_thread_is_remote(kmp_info_t *thread,
+                                               kmp_info_t *other) {
+  int *place_package = __kmp_affinity_place_package;
+  if (place_package == NULL)
+    return false;
+  int place = thread->th.th_current_place;
+  int other_place = other->th.th_current_place;
+  if (place < 0 || other_place < 0)
+    return false;
+  return place_package[place] != place_package[other_place];
+}
+#endif // KMP_AFFINITY_SUPPORTED
+
+// Number of random picks made to find a victim on the thief's own package
+// before a victim on another package is accepted.
+#define KMP_TASK_LOCAL_STEAL_TRIES 4
+
+// __kmp_select_victim: pick a random thread of the team other than tid to
+// steal from. Stealing from another package moves the victim's deque and the
+// task's data across the interconnect, so victims on the thief's package are
+// preferred.
+static inline kmp_int32 __kmp_select_victim(kmp_info_t *thread,
+                                            kmp_thread_data_t *threads_data,
+                                            kmp_int32 tid, kmp_int32 nthreads) {
+  for (int tries = 1;; ++tries) {
+    kmp_int32 victim_tid = __kmp_get_random(thread) % (nthreads - 1);
+    if (victim_tid >= tid) {
+      ++victim_tid; // Adjusts random distribution to exclude self
+    }
+#if KMP_AFFINITY_SUPPORTED
+    if (tries < KMP_TASK_LOCAL_STEAL_TRIES &&
+        __kmp_task_thread_is_remote(thread, threads_data[victim_tid].td.td_thr))
+      continue;
+#endif
+    return victim_tid;
+  }
+}
+
 // __kmp_steal_task: remove a task from another thread's deque
 // Assume that calling thread has already checked existence of
 // task_team thread_data before calling this routine.
@@ -2760,6 +2801,10 @@ static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
   __kmp_release_bootstrap_lock(&victim_td->td.td_deque_lock);
 
   KMP_COUNT_BLOCK(TASK_stolen);
+#if KMP_AFFINITY_SUPPORTED && KMP_STATS_ENABLED
+  if (__kmp_task_thread_is_remote(__kmp_threads[gtid], victim_thr))
+    KMP_COUNT_BLOCK(TASK_stolen_remote);
+#endif
   KA_TRACE(10,
            ("__kmp_steal_task(exit #5): T#%d stole task %p from T#%d: "
             "task_team=%p ntasks=%d head=%u tail=%u\n",
@@ -2837,10 +2882,8 @@ static inline int __kmp_execute_tasks_template(
             // Pick a random thread. Initial plan was to cycle through all the
             // threads, and only return if we tried to steal from every thread,
             // and failed.  Arch says that's not such a great idea.
-            victim_tid = __kmp_get_random(thread) % (nthreads - 1);
-            if (victim_tid >= tid) {
-              ++victim_tid; // Adjusts random distribution to exclude self
-            }
+            victim_tid = __kmp_select_victim(thread, threads_data, tid,
+                                             nthreads);
             // Found a potential victim
             other_thread = threads_data[victim_tid].td.td_thr;
             // There is a slight chance that __kmp_enable_tasking() did not wake
@@ -2884,6 +2927,8 @@ static inline int __kmp_execute_tasks_template(
             new_victim = 1;
           }
         } else { // No tasks found; unset last_stolen
+          if (!asleep)
+            KMP_COUNT_BLOCK(TASK_steal_failed);
           KMP_CHECK_UPDATE(threads_data[tid].td.td_deque_last_stolen, -1);
           victim_tid = -2; // no successful victim found
         }
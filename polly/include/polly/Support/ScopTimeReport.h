@@ -0,0 +1,46 @@
+//===- ScopTimeReport.h - Compile time spent on each SCoP -------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Accounts for the compile time spent on each SCoP, so that -polly-report-time
+// can list the most expensive ones when the compiler exits.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef POLLY_SUPPORT_SCOPTIMEREPORT_H
+#define POLLY_SUPPORT_SCOPTIMEREPORT_H
+
+#include "llvm/ADT/StringRef.h"
+#include <chrono>
+
+namespace llvm {
+class Region;
+} // namespace llvm
+
+namespace polly {
+
+/// Adds the time from its construction to its destruction to a phase of the
+/// SCoP of a region, e.g. "ScopInfo" or "Schedule", which must be a string
+/// literal. Does nothing unless -polly-report-time is given.
+///
+/// The phases of a SCoP are added up, so timers must not be nested.
+class ScopTimer {
+public:
+  ScopTimer(const llvm::Region &R, llvm::StringRef Phase);
+  ~ScopTimer();
+
+  ScopTimer(const ScopTimer &) = delete;
+  ScopTimer &operator=(const ScopTimer &) = delete;
+
+private:
+  const llvm::Region *R = nullptr;
+  llvm::StringRef Phase;
+  std::chrono::steady_clock::time_point Start;
+};
+} // namespace polly
+
+#endif // POLLY_SUPPORT_SCOPTIMEREPORT_H
@@ -25,6 +25,7 @@
 #include "polly/ScopInfo.h"
 #include "polly/Support/GICHelper.h"
 #include "polly/Support/ISLTools.h"
+#include "polly/Support/ScopTimeReport.h"
 #include "llvm/Support/Debug.h"
 #include "isl/aff.h"
 #include "isl/ctx.h"
@@ -309,6 +310,7 @@ static __isl_give isl_union_flow *buildFlow(__isl_keep isl_union_map *Snk,
 }
 
 void Dependences::calculateDependences(Scop &S) {
+  ScopTimer Timer(S.getRegion(), "Dependences");
   isl_union_map *Read, *MustWrite, *MayWrite, *ReductionTagMap;
   isl_schedule *Schedule;
   isl_union_set *TaggedStmtDomain;
@@ -922,8 +924,11 @@ const Dependences &DependenceInfoWrapperPass::recomputeDependences(
     Scop *S, Dependences::AnalysisLevel Level) {
   std::unique_ptr<Dependences> D(new Dependences(S->getSharedIslCtx(), Level));
   D->calculateDependences(*S);
-  auto Inserted = ScopToDepsMap.insert(std::make_pair(S, std::move(D)));
-  return *Inserted.first->second;
+  // Replace the dependences of another level, or outdated ones, rather than
+  // keep returning them.
+  std::unique_ptr<Dependences> &Entry = ScopToDepsMap[S];
+  Entry = std::move(D);
+  return *Entry;
 }
 
 bool DependenceInfoWrapperPass::runOnFunction(Function &F) {
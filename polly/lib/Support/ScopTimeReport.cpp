@@ -0,0 +1,128 @@
+//===- ScopTimeReport.cpp - Compile time spent on each SCoP ---------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Accounts for the compile time spent on each SCoP, so that -polly-report-time
+// can list the most expensive ones when the compiler exits.
+//
+//===----------------------------------------------------------------------===//
+
+#include "polly/Support/ScopTimeReport.h"
+#include "polly/Options.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Analysis/RegionInfo.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+using namespace polly;
+
+static cl::opt<bool>
+    ReportTime("polly-report-time",
+               cl::desc("Print the compile time of the SCoPs that took "
+                        "longest when the compiler exits"),
+               cl::init(false), cl::ZeroOrMore, cl::cat(PollyCategory));
+
+static cl::opt<unsigned> ReportTimeNumScops(
+    "polly-report-time-scops",
+    cl::desc("The number of SCoPs listed by -polly-report-time"),
+    cl::init(10), cl::ZeroOrMore, cl::cat(PollyCategory));
+
+namespace {
+/// The time spent on each phase of the processing of a SCoP, in seconds.
+struct ScopTimes {
+  std::vector<double> Phases;
+  double Total = 0;
+};
+
+class TimeReport {
+public:
+  ~TimeReport() { print(errs()); }
+
+  void add(StringRef Function, StringRef Region, StringRef Phase,
+           double Seconds) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto PhaseIt = find(Phases, Phase);
+    size_t PhaseIdx = PhaseIt - Phases.begin();
+    if (PhaseIt == Phases.end())
+      Phases.push_back(Phase);
+    ScopTimes &Times = Scops[{Function.str(), Region.str()}];
+    Times.Phases.resize(Phases.size());
+    Times.Phases[PhaseIdx] += Seconds;
+    Times.Total += Seconds;
+  }
+
+private:
+  void print(raw_ostream &OS);
+
+  std::mutex Mutex;
+  /// The phases, in the order they were first timed.
+  std::vector<StringRef> Phases;
+  /// The SCoPs by function and region.
+  std::map<std::pair<std::string, std::string>, ScopTimes> Scops;
+};
+} // namespace
+
+void TimeReport::print(raw_ostream &OS) {
+  if (Scops.empty())
+    return;
+
+  using ScopEntry = const decltype(Scops)::value_type *;
+  std::vector<ScopEntry> Sorted;
+  for (const auto &Entry : Scops)
+    Sorted.push_back(&Entry);
+  // The most expensive first; std::map keeps the rest in a stable order.
+  std::stable_sort(Sorted.begin(), Sorted.end(), [](ScopEntry A, ScopEntry B) {
+    return A->second.Total > B->second.Total;
+  });
+  if (Sorted.size() > ReportTimeNumScops)
+    Sorted.resize(ReportTimeNumScops);
+
+  OS << "===" << std::string(73, '-') << "===\n"
+     << "                 Polly - The SCoPs that took longest to compile\n"
+     << "===" << std::string(73, '-') << "===\n";
+  OS << right_justify("Total", 12);
+  for (StringRef Phase : Phases)
+    OS << right_justify(Phase, 14);
+  OS << "  SCoP\n";
+  for (ScopEntry Entry : Sorted) {
+    const ScopTimes &Times = Entry->second;
+    OS << format("%11.4fs", Times.Total);
+    for (size_t I = 0; I < Phases.size(); ++I)
+      OS << format("%13.4fs", I < Times.Phases.size() ? Times.Phases[I] : 0.0);
+    OS << "  " << Entry->first.first << ": " << Entry->first.second << "\n";
+  }
+  OS << "\n";
+  OS.flush();
+}
+
+static ManagedStatic<TimeReport> Report;
+
+ScopTimer::ScopTimer(const Region &R, StringRef Phase) {
+  if (!ReportTime)
+    return;
+  this->R = &R;
+  this->Phase = Phase;
+  Start = std::chrono::steady_clock::now();
+}
+
+ScopTimer::~ScopTimer() {
+  if (!R)
+    return;
+  std::chrono::duration<double> Elapsed =
+      std::chrono::steady_clock::now() - Start;
+  Report->add(R->getEntry()->getParent()->getName(), R->getNameStr(), Phase,
+              Elapsed.count());
+}
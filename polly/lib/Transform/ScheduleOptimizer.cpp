@@ -54,7 +54,9 @@
 #include "polly/ScopInfo.h"
 #include "polly/ScopPass.h"
 #include "polly/Simplify.h"
+#include "polly/Support/GICHelper.h"
 #include "polly/Support/ISLOStream.h"
+#include "polly/Support/ScopTimeReport.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/IR/Function.h"
@@ -260,6 +262,13 @@ static cl::opt<bool>
                 cl::desc("Perform optimizations based on pattern matching"),
                 cl::init(true), cl::ZeroOrMore, cl::cat(PollyCategory));
 
+static cl::opt<int> OptComputeOut(
+    "polly-opt-computeout",
+    cl::desc("Bound the scheduler by a maximal amount of computational steps. "
+             "SCoPs that exceed it keep their original schedule (0 means no "
+             "bound)"),
+    cl::Hidden, cl::init(0), cl::ZeroOrMore, cl::cat(PollyCategory));
+
 static cl::opt<bool> OptimizedScops(
     "polly-optimized-scops",
     cl::desc("Polly - Dump polyhedral description of Scops optimized with "
@@ -270,6 +279,8 @@ static cl::opt<bool> OptimizedScops(
 STATISTIC(ScopsProcessed, "Number of scops processed");
 STATISTIC(ScopsRescheduled, "Number of scops rescheduled");
 STATISTIC(ScopsOptimized, "Number of scops optimized");
+STATISTIC(ScopsOutOfQuota,
+          "Number of scops not rescheduled because max_operations was reached");
 
 STATISTIC(NumAffineLoopsOptimized, "Number of affine loops optimized");
 STATISTIC(NumBoxedLoopsOptimized, "Number of boxed loops optimized");
@@ -1488,6 +1499,8 @@ bool IslScheduleOptimizer::runOnScop(Scop &S) {
   if (!D.hasValidDependences())
     return false;
 
+  ScopTimer Timer(S.getRegion(), "Schedule");
+
   isl_schedule_free(LastSchedule);
   LastSchedule = nullptr;
 
@@ -1593,7 +1606,23 @@ bool IslScheduleOptimizer::runOnScop(Scop &S) {
   SC = SC.set_proximity(Proximity);
   SC = SC.set_validity(Validity);
   SC = SC.set_coincidence(Validity);
-  auto Schedule = SC.compute_schedule();
+  isl::schedule Schedule;
+  {
+    IslMaxOperationsGuard MaxOpGuard(Ctx, OptComputeOut);
+    Schedule = SC.compute_schedule();
+    if (MaxOpGuard.hasQuotaExceeded()) {
+      ScopsOutOfQuota++;
+      LLVM_DEBUG(dbgs() << "Schedule optimizer calculation exceeds ISL quota\n");
+      DebugLoc Begin, End;
+      getDebugLocations(getBBPairForRegion(&S.getRegion()), Begin, End);
+      OptimizationRemarkAnalysis R(DEBUG_TYPE, "OutOfQuota", Begin,
+                                   S.getEntry());
+      R << "maximal number of operations exceeded while scheduling; keeping "
+           "the original schedule";
+      S.getFunction().getContext().diagnose(R);
+      Schedule = nullptr;
+    }
+  }
   isl_options_set_on_error(Ctx, OnErrorStatus);
 
   walkScheduleTreeForStatistics(Schedule, 1);